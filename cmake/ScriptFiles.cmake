@@ -48,10 +48,13 @@ set(SOURCE_FILES
     bgw_scheduler.sql
     metadata.sql
     dist_internal.sql
+    hypertable_stats.sql
     views.sql
     views_experimental.sql
     gapfill.sql
     maintenance_utils.sql
+    planner_stats.sql
+    wait_stats.sql
     partialize_finalize.sql
     restoring.sql
     job_api.sql
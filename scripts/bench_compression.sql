@@ -0,0 +1,39 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+-- Micro-benchmark for the compression algorithms. Needs a debug build, or a
+-- release build with -DTS_COMPRESSION_BENCHMARK=1 in CFLAGS, and the
+-- timescaledb extension created in the current database.
+--
+-- Run with: psql -X -v iterations=10000 -f scripts/bench_compression.sql
+--
+-- The dataset can also be the absolute path of a compressed data file in the
+-- format of the fuzzing corpus (tsl/test/fuzzing/compression), e.g.
+-- SELECT * FROM ts_bench_compression('gorilla', 'float8', '/path/to/file', 1000);
+
+\set ON_ERROR_STOP 1
+
+\if :{?iterations}
+\else
+\set iterations 1000
+\endif
+SELECT '$libdir/timescaledb-tsl-' || extversion AS tsl_module
+FROM pg_extension WHERE extname = 'timescaledb' \gset
+
+CREATE OR REPLACE FUNCTION pg_temp.ts_bench_compression(algorithm cstring, type regtype,
+    dataset cstring, iterations int)
+RETURNS TABLE(phase text, "values" bigint, uncompressed_bytes bigint, compressed_bytes bigint,
+    ratio float8, ns_per_value float8, mb_per_s float8)
+AS :'tsl_module', 'ts_bench_compression' LANGUAGE C STRICT;
+
+SELECT algorithm, type, dataset, b.phase, b.ratio::numeric(10, 2) AS ratio,
+    b.ns_per_value::numeric(10, 2) AS ns_per_value, b.mb_per_s::numeric(10, 1) AS mb_per_s
+FROM (VALUES ('deltadelta', 'int8'), ('deltadelta', 'timestamptz'), ('gorilla', 'float8'),
+    ('bitpacking', 'int8'), ('dictionary', 'text'), ('array', 'text'), ('array', 'int8'))
+    AS algos(algorithm, type),
+    unnest(array['sequential', 'timestamps', 'random', 'repeated', 'low_cardinality',
+        'sparse']) AS dataset,
+    LATERAL pg_temp.ts_bench_compression(algorithm::cstring, type::regtype, dataset::cstring,
+        :iterations) b
+ORDER BY algorithm, type, dataset, b.phase;
@@ -21,6 +21,15 @@ CREATE OR REPLACE FUNCTION _timescaledb_functions.calculate_chunk_interval(
         chunk_target_size BIGINT
 ) RETURNS BIGINT AS '@MODULE_PATHNAME@', 'ts_calculate_chunk_interval' LANGUAGE C;
 
+-- Alternative chunk sizing function that estimates the new interval from
+-- the ingest rate (bytes per unit of the dimension) of the preceding chunks,
+-- without scanning them. Use with set_adaptive_chunking().
+CREATE OR REPLACE FUNCTION _timescaledb_functions.calculate_chunk_interval_by_ingest_rate(
+        dimension_id INTEGER,
+        dimension_coord BIGINT,
+        chunk_target_size BIGINT
+) RETURNS BIGINT AS '@MODULE_PATHNAME@', 'ts_calculate_chunk_interval_by_ingest_rate' LANGUAGE C;
+
 -- Get the status of the chunk
 CREATE OR REPLACE FUNCTION _timescaledb_functions.chunk_status(REGCLASS) RETURNS INT
 AS '@MODULE_PATHNAME@', 'ts_chunk_status' LANGUAGE C;
@@ -100,3 +109,11 @@ CREATE OR REPLACE FUNCTION _timescaledb_functions.attach_osm_table_chunk(
    hypertable REGCLASS,
    chunk REGCLASS)
 RETURNS BOOL AS '@MODULE_PATHNAME@', 'ts_chunk_attach_osm_table_chunk' LANGUAGE C VOLATILE;
+
+-- internal API used by OSM extension to set the time range of the data in the
+-- OSM chunk, so that the chunk can be excluded by the planner. NULL resets the range.
+CREATE OR REPLACE FUNCTION _timescaledb_functions.hypertable_osm_range_update(
+   hypertable REGCLASS,
+   range_start ANYELEMENT = NULL::BIGINT,
+   range_end ANYELEMENT = NULL)
+RETURNS BOOL AS '@MODULE_PATHNAME@', 'ts_chunk_osm_range_update' LANGUAGE C VOLATILE;
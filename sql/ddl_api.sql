@@ -90,6 +90,54 @@ CREATE OR REPLACE FUNCTION @extschema@.set_number_partitions(
     dimension_name          NAME = NULL
 ) RETURNS VOID AS '@MODULE_PATHNAME@', 'ts_dimension_set_num_slices' LANGUAGE C VOLATILE;
 
+-- Map the partitions of the space dimension to fewer chunks per time
+-- interval. Each element is the partition at which the range of a chunk
+-- starts; NULL gives each partition its own chunk. Only new chunks are
+-- affected.
+CREATE OR REPLACE FUNCTION @extschema@.set_partition_mapping(
+    hypertable              REGCLASS,
+    partition_starts        INTEGER[] = NULL
+) RETURNS VOID AS '@MODULE_PATHNAME@', 'ts_dimension_partition_set_mapping' LANGUAGE C VOLATILE;
+
+-- Keep the latest row of each series of the hypertable in a separate
+-- table, so that queries for the current value of every series, of the
+-- form "SELECT DISTINCT ON (<series key>) ... ORDER BY <series key>,
+-- <time> DESC", don't have to scan the chunks. The cache is maintained by
+-- inserts into the hypertable. Updates, deletes, drop_chunks and truncate
+-- invalidate it until it is refreshed.
+CREATE OR REPLACE FUNCTION @extschema@.add_last_point_cache(
+    hypertable              REGCLASS,
+    series_key              NAME[],
+    if_not_exists           BOOLEAN = FALSE
+) RETURNS VOID AS '@MODULE_PATHNAME@', 'ts_last_point_cache_add' LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE FUNCTION @extschema@.remove_last_point_cache(
+    hypertable              REGCLASS,
+    if_exists               BOOLEAN = FALSE
+) RETURNS VOID AS '@MODULE_PATHNAME@', 'ts_last_point_cache_remove' LANGUAGE C VOLATILE;
+
+-- Rebuild the last point cache of the hypertable from its data, and make
+-- it valid again.
+CREATE OR REPLACE FUNCTION @extschema@.refresh_last_point_cache(
+    hypertable              REGCLASS
+) RETURNS VOID AS '@MODULE_PATHNAME@', 'ts_last_point_cache_refresh' LANGUAGE C VOLATILE;
+
+-- Track the range of a column that is not a dimension in each chunk, so that
+-- queries that restrict the column can skip the chunks outside of the range.
+-- The range of a chunk is computed when the chunk is compressed, and is used
+-- until the chunk is modified.
+CREATE OR REPLACE FUNCTION @extschema@.enable_chunk_skipping(
+    hypertable              REGCLASS,
+    column_name             NAME,
+    if_not_exists           BOOLEAN = FALSE
+) RETURNS VOID AS '@MODULE_PATHNAME@', 'ts_chunk_column_stats_enable' LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE FUNCTION @extschema@.disable_chunk_skipping(
+    hypertable              REGCLASS,
+    column_name             NAME,
+    if_exists               BOOLEAN = FALSE
+) RETURNS VOID AS '@MODULE_PATHNAME@', 'ts_chunk_column_stats_disable' LANGUAGE C VOLATILE;
+
 -- Drop chunks older than the given timestamp for the specific
 -- hypertable or continuous aggregate.
 CREATE OR REPLACE FUNCTION @extschema@.drop_chunks(
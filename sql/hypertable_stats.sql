@@ -0,0 +1,28 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- The cumulative runtime statistics of the hypertables of the current
+-- database, collected when timescaledb.enable_hypertable_stats is on. See
+-- timescaledb_information.hypertable_stats.
+CREATE OR REPLACE FUNCTION _timescaledb_functions.hypertable_stats()
+RETURNS TABLE (
+    hypertable_id               integer,
+    rows_inserted               bigint,
+    rows_copied                 bigint,
+    rows_compressed_chunks      bigint,
+    chunks_created              bigint,
+    chunks_excluded_plan        bigint,
+    chunks_excluded_startup     bigint,
+    chunks_excluded_runtime     bigint,
+    batches_decompressed        bigint,
+    bytes_decompressed          bigint,
+    hypertable_cache_hits       bigint,
+    hypertable_cache_misses     bigint,
+    chunk_cache_hits            bigint,
+    chunk_cache_misses          bigint)
+AS '@MODULE_PATHNAME@', 'ts_hypertable_stats' LANGUAGE C VOLATILE STRICT;
+
+CREATE OR REPLACE FUNCTION _timescaledb_functions.hypertable_stats_reset()
+RETURNS VOID
+AS '@MODULE_PATHNAME@', 'ts_hypertable_stats_reset' LANGUAGE C VOLATILE STRICT;
@@ -42,6 +42,47 @@ CREATE OR REPLACE FUNCTION @extschema@.decompress_chunk(
     if_compressed BOOLEAN = false
 ) RETURNS REGCLASS AS '@MODULE_PATHNAME@', 'ts_decompress_chunk' LANGUAGE C STRICT VOLATILE;
 
+-- Merge two chunks that are adjacent on the primary dimension into one and
+-- return the merged chunk. Either both or none of the chunks must be compressed.
+CREATE OR REPLACE FUNCTION @extschema@.merge_chunks(
+    chunk REGCLASS,
+    merge_chunk REGCLASS
+) RETURNS REGCLASS AS '@MODULE_PATHNAME@', 'ts_chunk_merge_chunks' LANGUAGE C STRICT VOLATILE;
+
+-- Estimate the compression of a chunk for each combination of the candidate
+-- segmentby and orderby settings, which use the format of the
+-- compress_segmentby and compress_orderby options. NULL candidates default to
+-- the current settings of the hypertable. A sample of about sample_rows rows
+-- is compressed with each algorithm that supports the type of the column;
+-- is_default marks the algorithm that compression would use.
+CREATE OR REPLACE FUNCTION @extschema@.compression_advisor(
+    chunk REGCLASS,
+    segmentby TEXT[] = NULL,
+    orderby TEXT[] = NULL,
+    sample_rows INTEGER = 10000
+) RETURNS TABLE (
+    segmentby TEXT,
+    orderby TEXT,
+    column_name NAME,
+    algorithm TEXT,
+    is_default BOOLEAN,
+    sampled_rows BIGINT,
+    batches BIGINT,
+    uncompressed_bytes BIGINT,
+    compressed_bytes BIGINT,
+    compression_ratio FLOAT8,
+    decompress_ns_per_value FLOAT8
+) AS '@MODULE_PATHNAME@', 'ts_compression_advisor' LANGUAGE C VOLATILE;
+
+-- Export the compressed data of a chunk as an Arrow IPC stream: the schema
+-- message, one record batch per compressed batch, and the end-of-stream
+-- marker, one message per row. The stream is the concatenation of the rows.
+-- The rows of a partially compressed chunk that are not compressed yet are
+-- not exported.
+CREATE OR REPLACE FUNCTION @extschema@.export_chunk_arrow_ipc(
+    chunk REGCLASS
+) RETURNS SETOF BYTEA AS '@MODULE_PATHNAME@', 'ts_export_chunk_arrow_ipc' LANGUAGE C STRICT VOLATILE;
+
 CREATE OR REPLACE FUNCTION _timescaledb_internal.recompress_chunk_segmentwise(
     uncompressed_chunk REGCLASS,
     if_compressed BOOLEAN = false
@@ -52,6 +93,12 @@ CREATE OR REPLACE FUNCTION _timescaledb_internal.recompress_chunk_segmentwise(
 CREATE OR REPLACE FUNCTION _timescaledb_internal.get_compressed_chunk_index_for_recompression(
     uncompressed_chunk REGCLASS
 ) RETURNS REGCLASS AS '@MODULE_PATHNAME@', 'ts_get_compressed_chunk_index_for_recompression' LANGUAGE C STRICT VOLATILE;
+
+-- check whether the bloom filter metadata of a compressed batch might contain the value
+CREATE OR REPLACE FUNCTION _timescaledb_functions.bloom1_contains(
+    bloom BYTEA,
+    value ANYELEMENT
+) RETURNS BOOLEAN AS '@MODULE_PATHNAME@', 'ts_bloom1_contains' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 -- Recompress a chunk
 --
 -- Will give an error if the chunk was not already compressed. In this
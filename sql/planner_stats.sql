@@ -0,0 +1,17 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- The time spent in the phases of planning hypertable queries in the current
+-- session, collected when timescaledb.enable_planner_stats is on
+CREATE OR REPLACE FUNCTION _timescaledb_functions.planner_stats()
+RETURNS TABLE (
+    phase       text,
+    calls       bigint,
+    items       bigint,
+    total_time  double precision)
+AS '@MODULE_PATHNAME@', 'ts_planner_stats' LANGUAGE C VOLATILE STRICT;
+
+CREATE OR REPLACE FUNCTION _timescaledb_functions.planner_stats_reset()
+RETURNS VOID
+AS '@MODULE_PATHNAME@', 'ts_planner_stats_reset' LANGUAGE C VOLATILE STRICT;
@@ -43,6 +43,26 @@ CREATE OR REPLACE FUNCTION @extschema@.remove_reorder_policy(hypertable REGCLASS
 AS '@MODULE_PATHNAME@', 'ts_policy_reorder_remove'
 LANGUAGE C VOLATILE STRICT;
 
+/* maintenance policy */
+-- Add a policy that analyzes the active chunks of a hypertable once more than
+-- analyze_scale_factor of their rows changed, and freezes up to
+-- max_vacuums_per_run closed or compressed chunks per run.
+CREATE OR REPLACE FUNCTION @extschema@.add_maintenance_policy(
+    hypertable REGCLASS,
+    analyze_scale_factor FLOAT8 = 0.02,
+    max_vacuums_per_run INTEGER = 1,
+    if_not_exists BOOL = false,
+    schedule_interval INTERVAL = '15 minutes',
+    initial_start TIMESTAMPTZ = NULL,
+    timezone TEXT = NULL
+) RETURNS INTEGER
+AS '@MODULE_PATHNAME@', 'ts_policy_maintenance_add'
+LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE FUNCTION @extschema@.remove_maintenance_policy(hypertable REGCLASS, if_exists BOOL = false) RETURNS BOOL
+AS '@MODULE_PATHNAME@', 'ts_policy_maintenance_remove'
+LANGUAGE C VOLATILE STRICT;
+
 /* compression policy */
 CREATE OR REPLACE FUNCTION @extschema@.add_compression_policy(
     hypertable REGCLASS, compress_after "any",
@@ -59,6 +79,216 @@ CREATE OR REPLACE FUNCTION @extschema@.remove_compression_policy(hypertable REGC
 AS '@MODULE_PATHNAME@', 'ts_policy_compression_remove'
 LANGUAGE C VOLATILE STRICT;
 
+/* merge chunks policy */
+-- Add a policy that merges the adjacent chunks older than merge_after into
+-- chunks that cover at most max_chunk_interval on the primary dimension.
+-- Both have the type of the lag of the other policies: INTERVAL for time
+-- based hypertables and an integer type for integer based ones.
+CREATE OR REPLACE FUNCTION @extschema@.add_merge_chunks_policy(
+    hypertable REGCLASS,
+    merge_after ANYELEMENT,
+    max_chunk_interval ANYELEMENT,
+    if_not_exists BOOL = false,
+    schedule_interval INTERVAL = '1 day'
+) RETURNS INTEGER AS $$
+DECLARE
+  htid     INTEGER;
+  dimtype  REGTYPE;
+  job      INTEGER;
+BEGIN
+  SELECT ht.id, dim.column_type INTO htid, dimtype
+  FROM _timescaledb_catalog.hypertable ht
+    INNER JOIN pg_namespace pgns ON pgns.nspname = ht.schema_name
+    INNER JOIN pg_class pgc ON pgc.relname = ht.table_name AND pgc.relnamespace = pgns.oid
+    INNER JOIN _timescaledb_catalog.dimension dim ON dim.hypertable_id = ht.id
+  WHERE pgc.oid = hypertable
+  ORDER BY dim.id
+  LIMIT 1;
+
+  IF htid IS NULL THEN
+    RAISE EXCEPTION 'table "%" is not a hypertable', hypertable
+      USING ERRCODE = 'TS001';
+  END IF;
+
+  IF dimtype IN ('TIMESTAMP'::regtype, 'TIMESTAMPTZ'::regtype, 'DATE'::regtype) THEN
+    IF pg_typeof(merge_after) <> 'INTERVAL'::regtype THEN
+      RAISE EXCEPTION 'invalid value for merge_after and max_chunk_interval'
+        USING ERRCODE = 'invalid_parameter_value',
+              HINT = 'Use an INTERVAL for hypertables with a time dimension.';
+    END IF;
+  ELSIF pg_typeof(merge_after) NOT IN ('BIGINT'::regtype, 'INTEGER'::regtype, 'SMALLINT'::regtype) THEN
+    RAISE EXCEPTION 'invalid value for merge_after and max_chunk_interval'
+      USING ERRCODE = 'invalid_parameter_value',
+            HINT = 'Use an integer for hypertables with an integer dimension.';
+  END IF;
+
+  SELECT id INTO job
+  FROM _timescaledb_config.bgw_job
+  WHERE proc_schema = '_timescaledb_functions'
+    AND proc_name = 'policy_merge_chunks'
+    AND (config->>'hypertable_id')::INTEGER = htid;
+
+  IF job IS NOT NULL THEN
+    IF if_not_exists THEN
+      RAISE NOTICE 'merge chunks policy already exists for hypertable "%", skipping', hypertable;
+      RETURN -1;
+    END IF;
+    RAISE EXCEPTION 'merge chunks policy already exists for hypertable "%"', hypertable
+      USING ERRCODE = 'duplicate_object';
+  END IF;
+
+  RETURN @extschema@.add_job(
+    '_timescaledb_functions.policy_merge_chunks'::regproc,
+    schedule_interval,
+    config => jsonb_build_object(
+      'hypertable_id', htid,
+      'merge_after', merge_after,
+      'max_chunk_interval', max_chunk_interval
+    )
+  );
+END;
+$$ LANGUAGE PLPGSQL VOLATILE SET search_path TO pg_catalog, pg_temp;
+
+CREATE OR REPLACE FUNCTION @extschema@.remove_merge_chunks_policy(
+    hypertable REGCLASS,
+    if_exists BOOL = false
+) RETURNS BOOL AS $$
+DECLARE
+  job  INTEGER;
+BEGIN
+  SELECT j.id INTO job
+  FROM _timescaledb_config.bgw_job j
+    INNER JOIN _timescaledb_catalog.hypertable ht ON ht.id = (j.config->>'hypertable_id')::INTEGER
+    INNER JOIN pg_namespace pgns ON pgns.nspname = ht.schema_name
+    INNER JOIN pg_class pgc ON pgc.relname = ht.table_name AND pgc.relnamespace = pgns.oid
+  WHERE j.proc_schema = '_timescaledb_functions'
+    AND j.proc_name = 'policy_merge_chunks'
+    AND pgc.oid = hypertable;
+
+  IF job IS NULL THEN
+    IF if_exists THEN
+      RAISE NOTICE 'merge chunks policy not found for hypertable "%", skipping', hypertable;
+      RETURN false;
+    END IF;
+    RAISE EXCEPTION 'merge chunks policy not found for hypertable "%"', hypertable
+      USING ERRCODE = 'undefined_object';
+  END IF;
+
+  PERFORM @extschema@.delete_job(job);
+  RETURN true;
+END;
+$$ LANGUAGE PLPGSQL VOLATILE STRICT SET search_path TO pg_catalog, pg_temp;
+
+/* rebalance data nodes policy */
+-- Add a policy that moves chunks of a distributed hypertable between its data
+-- nodes until the bytes stored on them differ by at most max_skew of the
+-- average. Each run moves at most max_moves_per_run chunks, one at a time,
+-- and copies at most max_bytes_per_run bytes when it is set.
+CREATE OR REPLACE FUNCTION @extschema@.add_rebalance_policy(
+    hypertable REGCLASS,
+    max_moves_per_run INTEGER = 1,
+    max_skew FLOAT8 = 0.1,
+    max_bytes_per_run BIGINT = NULL,
+    if_not_exists BOOL = false,
+    schedule_interval INTERVAL = '1 hour'
+) RETURNS INTEGER AS $$
+DECLARE
+  htid           INTEGER;
+  distributed    BOOL;
+  job            INTEGER;
+BEGIN
+  SELECT ht.id, ht.replication_factor > 0 INTO htid, distributed
+  FROM _timescaledb_catalog.hypertable ht
+    INNER JOIN pg_namespace pgns ON pgns.nspname = ht.schema_name
+    INNER JOIN pg_class pgc ON pgc.relname = ht.table_name AND pgc.relnamespace = pgns.oid
+  WHERE pgc.oid = hypertable;
+
+  IF htid IS NULL THEN
+    RAISE EXCEPTION 'table "%" is not a hypertable', hypertable
+      USING ERRCODE = 'TS001';
+  END IF;
+
+  IF NOT distributed THEN
+    RAISE EXCEPTION 'hypertable "%" is not distributed', hypertable
+      USING ERRCODE = 'feature_not_supported';
+  END IF;
+
+  IF max_moves_per_run IS NULL OR max_moves_per_run < 1 THEN
+    RAISE EXCEPTION 'invalid value for max_moves_per_run'
+      USING ERRCODE = 'invalid_parameter_value',
+            HINT = 'Use a positive number of chunks.';
+  END IF;
+
+  IF max_skew IS NULL OR max_skew < 0 THEN
+    RAISE EXCEPTION 'invalid value for max_skew'
+      USING ERRCODE = 'invalid_parameter_value',
+            HINT = 'Use a non-negative fraction of the average data node size.';
+  END IF;
+
+  IF max_bytes_per_run <= 0 THEN
+    RAISE EXCEPTION 'invalid value for max_bytes_per_run'
+      USING ERRCODE = 'invalid_parameter_value',
+            HINT = 'Use a positive number of bytes, or NULL for no limit.';
+  END IF;
+
+  SELECT id INTO job
+  FROM _timescaledb_config.bgw_job
+  WHERE proc_schema = '_timescaledb_functions'
+    AND proc_name = 'policy_rebalance_data_nodes'
+    AND (config->>'hypertable_id')::INTEGER = htid;
+
+  IF job IS NOT NULL THEN
+    IF if_not_exists THEN
+      RAISE NOTICE 'rebalance policy already exists for hypertable "%", skipping', hypertable;
+      RETURN -1;
+    END IF;
+    RAISE EXCEPTION 'rebalance policy already exists for hypertable "%"', hypertable
+      USING ERRCODE = 'duplicate_object';
+  END IF;
+
+  RETURN @extschema@.add_job(
+    '_timescaledb_functions.policy_rebalance_data_nodes'::regproc,
+    schedule_interval,
+    config => jsonb_strip_nulls(jsonb_build_object(
+      'hypertable_id', htid,
+      'max_moves_per_run', max_moves_per_run,
+      'max_skew', max_skew,
+      'max_bytes_per_run', max_bytes_per_run
+    ))
+  );
+END;
+$$ LANGUAGE PLPGSQL VOLATILE SET search_path TO pg_catalog, pg_temp;
+
+CREATE OR REPLACE FUNCTION @extschema@.remove_rebalance_policy(
+    hypertable REGCLASS,
+    if_exists BOOL = false
+) RETURNS BOOL AS $$
+DECLARE
+  job  INTEGER;
+BEGIN
+  SELECT j.id INTO job
+  FROM _timescaledb_config.bgw_job j
+    INNER JOIN _timescaledb_catalog.hypertable ht ON ht.id = (j.config->>'hypertable_id')::INTEGER
+    INNER JOIN pg_namespace pgns ON pgns.nspname = ht.schema_name
+    INNER JOIN pg_class pgc ON pgc.relname = ht.table_name AND pgc.relnamespace = pgns.oid
+  WHERE j.proc_schema = '_timescaledb_functions'
+    AND j.proc_name = 'policy_rebalance_data_nodes'
+    AND pgc.oid = hypertable;
+
+  IF job IS NULL THEN
+    IF if_exists THEN
+      RAISE NOTICE 'rebalance policy not found for hypertable "%", skipping', hypertable;
+      RETURN false;
+    END IF;
+    RAISE EXCEPTION 'rebalance policy not found for hypertable "%"', hypertable
+      USING ERRCODE = 'undefined_object';
+  END IF;
+
+  PERFORM @extschema@.delete_job(job);
+  RETURN true;
+END;
+$$ LANGUAGE PLPGSQL VOLATILE STRICT SET search_path TO pg_catalog, pg_temp;
+
 /* continuous aggregates policy */
 CREATE OR REPLACE FUNCTION @extschema@.add_continuous_aggregate_policy(
     continuous_aggregate REGCLASS, start_offset "any",
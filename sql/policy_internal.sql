@@ -18,6 +18,14 @@ CREATE OR REPLACE FUNCTION _timescaledb_internal.policy_reorder_check(config JSO
 RETURNS void AS '@MODULE_PATHNAME@', 'ts_policy_reorder_check'
 LANGUAGE C;
 
+CREATE OR REPLACE PROCEDURE _timescaledb_internal.policy_maintenance(job_id INTEGER, config JSONB)
+AS '@MODULE_PATHNAME@', 'ts_policy_maintenance_proc'
+LANGUAGE C;
+
+CREATE OR REPLACE FUNCTION _timescaledb_internal.policy_maintenance_check(config JSONB)
+RETURNS void AS '@MODULE_PATHNAME@', 'ts_policy_maintenance_check'
+LANGUAGE C;
+
 CREATE OR REPLACE PROCEDURE _timescaledb_internal.policy_recompression(job_id INTEGER, config JSONB)
 AS '@MODULE_PATHNAME@', 'ts_policy_recompression_proc'
 LANGUAGE C;
@@ -34,6 +42,15 @@ CREATE OR REPLACE FUNCTION _timescaledb_internal.policy_refresh_continuous_aggre
 RETURNS void AS '@MODULE_PATHNAME@', 'ts_policy_refresh_cagg_check'
 LANGUAGE C;
 
+CREATE OR REPLACE FUNCTION _timescaledb_functions.policy_compression_parallel(
+  job_id              INTEGER,
+  chunks              REGCLASS[],
+  numworkers          INTEGER,
+  verbose_log         BOOLEAN,
+  recompress_enabled  BOOLEAN)
+RETURNS BOOLEAN AS '@MODULE_PATHNAME@', 'ts_policy_compression_parallel'
+LANGUAGE C VOLATILE;
+
 CREATE OR REPLACE PROCEDURE
 _timescaledb_internal.policy_compression_execute(
   job_id              INTEGER,
@@ -41,11 +58,14 @@ _timescaledb_internal.policy_compression_execute(
   lag                 ANYELEMENT,
   maxchunks           INTEGER,
   verbose_log         BOOLEAN,
-  recompress_enabled  BOOLEAN)
+  recompress_enabled  BOOLEAN,
+  numworkers          INTEGER = 1)
 AS $$
 DECLARE
   htoid       REGCLASS;
   chunk_rec   RECORD;
+  chunk_oids  REGCLASS[];
+  orig_lag    lag%TYPE := lag;
   numchunks   INTEGER := 1;
   _message     text;
   _detail      text;
@@ -90,6 +110,15 @@ BEGIN
         )
       )
   LOOP
+    -- with several workers, the chunks are compressed after the loop
+    IF numworkers > 1 THEN
+      chunk_oids := array_append(chunk_oids, chunk_rec.oid::regclass);
+      numchunks := numchunks + 1;
+      IF maxchunks > 0 AND numchunks >= maxchunks THEN
+        EXIT;
+      END IF;
+      CONTINUE;
+    END IF;
     IF chunk_rec.status = 0 THEN
       BEGIN
         PERFORM @extschema@.compress_chunk( chunk_rec.oid );
@@ -141,6 +170,20 @@ BEGIN
          EXIT;
     END IF;
   END LOOP;
+
+  IF numworkers > 1 AND chunk_oids IS NOT NULL THEN
+    -- the workers cannot compress the chunks while we hold locks on them
+    COMMIT;
+    SET LOCAL search_path TO pg_catalog, pg_temp;
+    IF NOT _timescaledb_functions.policy_compression_parallel(
+      job_id, chunk_oids, numworkers, verbose_log, recompress_enabled
+    ) THEN
+      -- no worker could be started, so compress the chunks one by one
+      CALL _timescaledb_internal.policy_compression_execute(
+        job_id, htid, orig_lag, maxchunks, verbose_log, recompress_enabled, 1
+      );
+    END IF;
+  END IF;
 END;
 $$ LANGUAGE PLPGSQL;
 
@@ -157,6 +200,7 @@ DECLARE
   chunk_rec           RECORD;
   verbose_log         BOOL;
   maxchunks           INTEGER := 0;
+  numworkers          INTEGER := 1;
   numchunks           INTEGER := 1;
   recompress_enabled  BOOL;
 BEGIN
@@ -177,6 +221,7 @@ BEGIN
   verbose_log         := COALESCE(jsonb_object_field_text(config, 'verbose_log')::BOOLEAN, FALSE);
   maxchunks           := COALESCE(jsonb_object_field_text(config, 'maxchunks_to_compress')::INTEGER, 0);
   recompress_enabled  := COALESCE(jsonb_object_field_text(config, 'recompress')::BOOLEAN, TRUE);
+  numworkers          := COALESCE(jsonb_object_field_text(config, 'parallel_workers')::INTEGER, 1);
   compress_after      := jsonb_object_field_text(config, 'compress_after');
 
   IF compress_after IS NULL THEN
@@ -198,23 +243,351 @@ BEGIN
     WHEN 'TIMESTAMP'::regtype, 'TIMESTAMPTZ'::regtype, 'DATE'::regtype THEN
       CALL _timescaledb_internal.policy_compression_execute(
         job_id, htid, lag_value::INTERVAL,
-        maxchunks, verbose_log, recompress_enabled
+        maxchunks, verbose_log, recompress_enabled, numworkers
       );
     WHEN 'BIGINT'::regtype THEN
       CALL _timescaledb_internal.policy_compression_execute(
         job_id, htid, lag_value::BIGINT,
-        maxchunks, verbose_log, recompress_enabled
+        maxchunks, verbose_log, recompress_enabled, numworkers
       );
     WHEN 'INTEGER'::regtype THEN
       CALL _timescaledb_internal.policy_compression_execute(
         job_id, htid, lag_value::INTEGER,
-        maxchunks, verbose_log, recompress_enabled
+        maxchunks, verbose_log, recompress_enabled, numworkers
       );
     WHEN 'SMALLINT'::regtype THEN
       CALL _timescaledb_internal.policy_compression_execute(
         job_id, htid, lag_value::SMALLINT,
-        maxchunks, verbose_log, recompress_enabled
+        maxchunks, verbose_log, recompress_enabled, numworkers
       );
   END CASE;
 END;
 $$ LANGUAGE PLPGSQL;
+
+-- Merge the adjacent chunks older than lag into chunks that cover at most
+-- max_chunk_interval (in the internal time format) on the primary dimension.
+-- Chunks are only merged with chunks that have the same slices on the other
+-- dimensions and the same compression state.
+CREATE OR REPLACE PROCEDURE
+_timescaledb_functions.policy_merge_chunks_execute(
+  job_id              INTEGER,
+  htid                INTEGER,
+  lag                 ANYELEMENT,
+  max_chunk_interval  BIGINT,
+  verbose_log         BOOLEAN)
+AS $$
+DECLARE
+  htoid           REGCLASS;
+  dimid           INTEGER;
+  chunk_rec       RECORD;
+  merge_oid       REGCLASS;
+  merge_start     BIGINT;
+  merge_end       BIGINT;
+  merge_slices    INTEGER[];
+  merge_compressed BOOLEAN;
+  merged          BOOLEAN;
+  _message        text;
+  _detail         text;
+  -- chunk status bits:
+  bit_compressed int := 1;
+  bit_frozen int := 4;
+BEGIN
+
+  -- procedures with SET clause cannot execute transaction
+  -- control so we adjust search_path in procedure body
+  SET LOCAL search_path TO pg_catalog, pg_temp;
+
+  SELECT format('%I.%I', schema_name, table_name) INTO htoid
+  FROM _timescaledb_catalog.hypertable
+  WHERE id = htid;
+
+  SELECT id INTO dimid
+  FROM _timescaledb_catalog.dimension
+  WHERE hypertable_id = htid AND interval_length IS NOT NULL
+  ORDER BY id
+  LIMIT 1;
+
+  -- for the integer cases, we have to compute the lag w.r.t
+  -- the integer_now function and then pass on to show_chunks
+  IF pg_typeof(lag) IN ('BIGINT'::regtype, 'INTEGER'::regtype, 'SMALLINT'::regtype) THEN
+    lag := _timescaledb_functions.subtract_integer_from_now(htoid, lag::BIGINT);
+  END IF;
+
+  FOR chunk_rec IN
+    SELECT
+      show.oid, ch.status, ds.range_start, ds.range_end,
+      ARRAY(
+        SELECT cc_other.dimension_slice_id
+        FROM _timescaledb_catalog.chunk_constraint cc_other
+          INNER JOIN _timescaledb_catalog.dimension_slice ds_other ON ds_other.id = cc_other.dimension_slice_id
+        WHERE cc_other.chunk_id = ch.id AND ds_other.dimension_id <> dimid
+        ORDER BY ds_other.dimension_id
+      ) AS other_slices
+    FROM
+      @extschema@.show_chunks(htoid, older_than => lag) AS show(oid)
+      INNER JOIN pg_class pgc ON pgc.oid = show.oid
+      INNER JOIN pg_namespace pgns ON pgc.relnamespace = pgns.oid
+      INNER JOIN _timescaledb_catalog.chunk ch ON ch.table_name = pgc.relname AND ch.schema_name = pgns.nspname AND ch.hypertable_id = htid
+      INNER JOIN _timescaledb_catalog.chunk_constraint cc ON cc.chunk_id = ch.id
+      INNER JOIN _timescaledb_catalog.dimension_slice ds ON ds.id = cc.dimension_slice_id AND ds.dimension_id = dimid
+    WHERE
+      ch.dropped IS FALSE
+      AND ch.osm_chunk IS FALSE
+      AND ch.status & bit_frozen = 0
+    ORDER BY other_slices, ds.range_start
+  LOOP
+    merged := false;
+    IF merge_oid IS NOT NULL
+      AND chunk_rec.other_slices = merge_slices
+      AND chunk_rec.range_start = merge_end
+      AND (chunk_rec.status & bit_compressed > 0) = merge_compressed
+      AND chunk_rec.range_end - merge_start <= max_chunk_interval THEN
+      BEGIN
+        PERFORM @extschema@.merge_chunks(merge_oid, chunk_rec.oid);
+        merged := true;
+      EXCEPTION WHEN OTHERS THEN
+        GET STACKED DIAGNOSTICS
+            _message = MESSAGE_TEXT,
+            _detail = PG_EXCEPTION_DETAIL;
+        RAISE WARNING 'merging chunk "%" into chunk "%" failed when merge chunks policy is executed', chunk_rec.oid::regclass::text, merge_oid::regclass::text
+            USING DETAIL = format('Message: (%s), Detail: (%s).', _message, _detail),
+                  ERRCODE = sqlstate;
+      END;
+    END IF;
+
+    IF merged THEN
+      merge_end := chunk_rec.range_end;
+      COMMIT;
+      -- SET LOCAL is only active until end of transaction.
+      -- While we could use SET at the start of the function we do not
+      -- want to bleed out search_path to caller, so we do SET LOCAL
+      -- again after COMMIT
+      SET LOCAL search_path TO pg_catalog, pg_temp;
+      IF verbose_log THEN
+        RAISE LOG 'job % merged chunk % into chunk %', job_id, chunk_rec.oid::regclass::text, merge_oid::regclass::text;
+      END IF;
+    ELSE
+      -- start merging into this chunk
+      merge_oid := chunk_rec.oid;
+      merge_start := chunk_rec.range_start;
+      merge_end := chunk_rec.range_end;
+      merge_slices := chunk_rec.other_slices;
+      merge_compressed := chunk_rec.status & bit_compressed > 0;
+    END IF;
+  END LOOP;
+END;
+$$ LANGUAGE PLPGSQL;
+
+CREATE OR REPLACE PROCEDURE
+_timescaledb_functions.policy_merge_chunks(job_id INTEGER, config JSONB)
+AS $$
+DECLARE
+  dimtype             REGTYPE;
+  lag_value           TEXT;
+  max_interval_value  TEXT;
+  htid                INTEGER;
+  verbose_log         BOOL;
+BEGIN
+
+  -- procedures with SET clause cannot execute transaction
+  -- control so we adjust search_path in procedure body
+  SET LOCAL search_path TO pg_catalog, pg_temp;
+
+  IF config IS NULL THEN
+    RAISE EXCEPTION 'job % has null config', job_id;
+  END IF;
+
+  htid := jsonb_object_field_text(config, 'hypertable_id')::INTEGER;
+  IF htid is NULL THEN
+    RAISE EXCEPTION 'job % config must have hypertable_id', job_id;
+  END IF;
+
+  verbose_log         := COALESCE(jsonb_object_field_text(config, 'verbose_log')::BOOLEAN, FALSE);
+  lag_value           := jsonb_object_field_text(config, 'merge_after');
+  max_interval_value  := jsonb_object_field_text(config, 'max_chunk_interval');
+
+  IF lag_value IS NULL THEN
+    RAISE EXCEPTION 'job % config must have merge_after', job_id;
+  END IF;
+
+  IF max_interval_value IS NULL THEN
+    RAISE EXCEPTION 'job % config must have max_chunk_interval', job_id;
+  END IF;
+
+  -- find primary dimension type --
+  SELECT dim.column_type INTO dimtype
+  FROM  _timescaledb_catalog.hypertable ht
+        JOIN _timescaledb_catalog.dimension dim ON ht.id = dim.hypertable_id
+  WHERE ht.id = htid
+  ORDER BY dim.id
+  LIMIT 1;
+
+  -- execute the properly type casts for the lag value
+  CASE dimtype
+    WHEN 'TIMESTAMP'::regtype, 'TIMESTAMPTZ'::regtype, 'DATE'::regtype THEN
+      CALL _timescaledb_functions.policy_merge_chunks_execute(
+        job_id, htid, lag_value::INTERVAL,
+        _timescaledb_functions.interval_to_usec(max_interval_value::INTERVAL), verbose_log
+      );
+    WHEN 'BIGINT'::regtype THEN
+      CALL _timescaledb_functions.policy_merge_chunks_execute(
+        job_id, htid, lag_value::BIGINT, max_interval_value::BIGINT, verbose_log
+      );
+    WHEN 'INTEGER'::regtype THEN
+      CALL _timescaledb_functions.policy_merge_chunks_execute(
+        job_id, htid, lag_value::INTEGER, max_interval_value::BIGINT, verbose_log
+      );
+    WHEN 'SMALLINT'::regtype THEN
+      CALL _timescaledb_functions.policy_merge_chunks_execute(
+        job_id, htid, lag_value::SMALLINT, max_interval_value::BIGINT, verbose_log
+      );
+  END CASE;
+END;
+$$ LANGUAGE PLPGSQL;
+
+-- Move chunks of a distributed hypertable from the data node that stores the
+-- most bytes of it to the one that stores the least, until the difference is
+-- at most max_skew of the average or max_moves_per_run chunks have been moved.
+-- The moves run one at a time, and max_bytes_per_run bounds the data copied
+-- in one run. Chunks in the latest slice of the primary dimension are still
+-- written to, so they are not moved. The newer closed chunks are moved first,
+-- since they see most of the reads.
+--
+-- move_chunk runs in its own transactions, so it cannot be called in an
+-- exception block: a failed move fails the job, and the copy operation is
+-- left for cleanup_copy_chunk_operation.
+CREATE OR REPLACE PROCEDURE
+_timescaledb_functions.policy_rebalance_data_nodes(job_id INTEGER, config JSONB)
+AS $$
+DECLARE
+  htid               INTEGER;
+  htoid              REGCLASS;
+  dimid              INTEGER;
+  latest_start       BIGINT;
+  max_moves          INTEGER;
+  max_skew           FLOAT8;
+  max_bytes          BIGINT;
+  moved_bytes        BIGINT := 0;
+  src_node           NAME;
+  src_bytes          BIGINT;
+  dst_node           NAME;
+  dst_bytes          BIGINT;
+  avg_bytes          FLOAT8;
+  chunk_rec          RECORD;
+  verbose_log        BOOL;
+BEGIN
+
+  -- procedures with SET clause cannot execute transaction
+  -- control so we adjust search_path in procedure body
+  SET LOCAL search_path TO pg_catalog, pg_temp;
+
+  IF config IS NULL THEN
+    RAISE EXCEPTION 'job % has null config', job_id;
+  END IF;
+
+  htid := jsonb_object_field_text(config, 'hypertable_id')::INTEGER;
+  IF htid is NULL THEN
+    RAISE EXCEPTION 'job % config must have hypertable_id', job_id;
+  END IF;
+
+  verbose_log := COALESCE(jsonb_object_field_text(config, 'verbose_log')::BOOLEAN, FALSE);
+  max_moves   := COALESCE(jsonb_object_field_text(config, 'max_moves_per_run')::INTEGER, 1);
+  max_skew    := COALESCE(jsonb_object_field_text(config, 'max_skew')::FLOAT8, 0.1);
+  max_bytes   := jsonb_object_field_text(config, 'max_bytes_per_run')::BIGINT;
+
+  SELECT format('%I.%I', schema_name, table_name) INTO htoid
+  FROM _timescaledb_catalog.hypertable
+  WHERE id = htid AND replication_factor > 0;
+
+  IF htoid IS NULL THEN
+    RAISE EXCEPTION 'job % config has no distributed hypertable with id %', job_id, htid;
+  END IF;
+
+  SELECT id INTO dimid
+  FROM _timescaledb_catalog.dimension
+  WHERE hypertable_id = htid AND interval_length IS NOT NULL
+  ORDER BY id
+  LIMIT 1;
+
+  SELECT max(sl.range_start) INTO latest_start
+  FROM _timescaledb_catalog.chunk ch
+    INNER JOIN _timescaledb_catalog.chunk_constraint cc ON cc.chunk_id = ch.id
+    INNER JOIN _timescaledb_catalog.dimension_slice sl ON sl.id = cc.dimension_slice_id
+  WHERE ch.hypertable_id = htid AND NOT ch.dropped AND sl.dimension_id = dimid;
+
+  FOR i IN 1 .. max_moves LOOP
+    CREATE TEMP TABLE IF NOT EXISTS _rebalance_chunk_size ON COMMIT DROP AS
+    SELECT * FROM @extschema@.chunks_detailed_size(htoid);
+
+    SELECT n.node_name, COALESCE(sum(s.total_bytes), 0) INTO src_node, src_bytes
+    FROM _timescaledb_catalog.hypertable_data_node n
+      LEFT JOIN _rebalance_chunk_size s ON s.node_name = n.node_name
+    WHERE n.hypertable_id = htid
+    GROUP BY n.node_name
+    ORDER BY 2 DESC, 1
+    LIMIT 1;
+
+    -- data nodes that are blocked for new chunks do not get moved chunks either
+    SELECT n.node_name, COALESCE(sum(s.total_bytes), 0) INTO dst_node, dst_bytes
+    FROM _timescaledb_catalog.hypertable_data_node n
+      LEFT JOIN _rebalance_chunk_size s ON s.node_name = n.node_name
+    WHERE n.hypertable_id = htid AND NOT n.block_chunks
+    GROUP BY n.node_name
+    ORDER BY 2, 1
+    LIMIT 1;
+
+    SELECT COALESCE(sum(s.total_bytes), 0)::FLOAT8 / count(DISTINCT n.node_name) INTO avg_bytes
+    FROM _timescaledb_catalog.hypertable_data_node n
+      LEFT JOIN _rebalance_chunk_size s ON s.node_name = n.node_name
+    WHERE n.hypertable_id = htid;
+
+    IF dst_node IS NULL OR src_node = dst_node OR src_bytes - dst_bytes <= max_skew * avg_bytes THEN
+      EXIT;
+    END IF;
+
+    -- only move chunks that make the two data nodes closer in size, so that
+    -- the next runs do not move them back
+    SELECT format('%I.%I', ch.schema_name, ch.table_name)::REGCLASS AS oid, s.total_bytes
+    INTO chunk_rec
+    FROM _timescaledb_catalog.chunk ch
+      INNER JOIN _rebalance_chunk_size s
+        ON s.chunk_schema = ch.schema_name AND s.chunk_name = ch.table_name AND s.node_name = src_node
+      INNER JOIN _timescaledb_catalog.chunk_constraint cc ON cc.chunk_id = ch.id
+      INNER JOIN _timescaledb_catalog.dimension_slice sl
+        ON sl.id = cc.dimension_slice_id AND sl.dimension_id = dimid
+    WHERE ch.hypertable_id = htid
+      AND NOT ch.dropped
+      AND sl.range_start < latest_start
+      AND s.total_bytes < src_bytes - dst_bytes
+      AND (max_bytes IS NULL OR moved_bytes + s.total_bytes <= max_bytes)
+      AND NOT EXISTS (
+        SELECT FROM _timescaledb_catalog.chunk_data_node cdn
+        WHERE cdn.chunk_id = ch.id AND cdn.node_name = dst_node)
+      AND NOT EXISTS (
+        SELECT FROM _timescaledb_catalog.chunk_copy_operation op
+        WHERE op.chunk_id = ch.id)
+    ORDER BY sl.range_start DESC, s.total_bytes DESC
+    LIMIT 1;
+
+    IF NOT FOUND THEN
+      EXIT;
+    END IF;
+
+    -- move_chunk cannot run in the transaction that read the chunk sizes
+    -- from the data nodes
+    COMMIT;
+    SET LOCAL search_path TO pg_catalog, pg_temp;
+
+    IF verbose_log THEN
+      RAISE LOG 'job % moving chunk "%" (% bytes) from data node "%" to data node "%"',
+        job_id, chunk_rec.oid::text, chunk_rec.total_bytes, src_node, dst_node;
+    END IF;
+
+    CALL timescaledb_experimental.move_chunk(chunk_rec.oid, src_node, dst_node);
+    COMMIT;
+    SET LOCAL search_path TO pg_catalog, pg_temp;
+
+    moved_bytes := moved_bytes + chunk_rec.total_bytes;
+  END LOOP;
+END;
+$$ LANGUAGE PLPGSQL;
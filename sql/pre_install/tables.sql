@@ -321,6 +321,20 @@ CREATE TABLE _timescaledb_internal.bgw_job_stat (
   CONSTRAINT bgw_job_stat_job_id_fkey FOREIGN KEY (job_id) REFERENCES _timescaledb_config.bgw_job (id) ON DELETE CASCADE
 );
 
+-- Histograms of the resource usage of the runs of each job. Element i of
+-- each array counts the runs with a value in [2^(i-1), 2^i), except for the
+-- first element, which counts the runs with a value of zero.
+CREATE TABLE _timescaledb_internal.bgw_job_stat_histogram (
+  job_id integer NOT NULL,
+  duration_ms bigint[] NOT NULL,
+  bytes_read bigint[] NOT NULL,
+  bytes_written bigint[] NOT NULL,
+  wal_bytes bigint[] NOT NULL,
+  -- table constraints
+  CONSTRAINT bgw_job_stat_histogram_pkey PRIMARY KEY (job_id),
+  CONSTRAINT bgw_job_stat_histogram_job_id_fkey FOREIGN KEY (job_id) REFERENCES _timescaledb_config.bgw_job (id) ON DELETE CASCADE
+);
+
 --The job_stat table is not dumped by pg_dump on purpose because
 --the statistics probably aren't very meaningful across instances.
 -- Now we define a special stats table for each job/chunk pair. This will be used by the scheduler
@@ -423,6 +437,41 @@ CREATE TABLE _timescaledb_catalog.continuous_aggs_watermark (
 
 SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.continuous_aggs_watermark', '');
 
+-- The tables that hold the latest row of each series of a hypertable, see
+-- add_last_point_cache(). The cache is only used for queries while it is
+-- valid, and it is invalidated by anything but inserts.
+CREATE TABLE _timescaledb_catalog.hypertable_last_point_cache (
+  hypertable_id integer NOT NULL,
+  cache_schema_name name NOT NULL,
+  cache_table_name name NOT NULL,
+  valid boolean NOT NULL,
+  series_key name[] NOT NULL,
+  -- table constraints
+  CONSTRAINT hypertable_last_point_cache_pkey PRIMARY KEY (hypertable_id),
+  CONSTRAINT hypertable_last_point_cache_hypertable_id_fkey FOREIGN KEY (hypertable_id) REFERENCES _timescaledb_catalog.hypertable (id) ON DELETE CASCADE
+);
+
+SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.hypertable_last_point_cache', '');
+
+-- The columns of the hypertables that have their ranges tracked per chunk for
+-- chunk exclusion, see enable_chunk_skipping(). The row of the hypertable
+-- itself has chunk_id 0, and the row of a chunk has the inclusive range of
+-- the column in the internal time representation. The ranges are computed
+-- when the chunks are compressed, and are only used while they are valid.
+CREATE TABLE _timescaledb_catalog.chunk_column_stats (
+  hypertable_id integer NOT NULL,
+  chunk_id integer NOT NULL,
+  column_name name NOT NULL,
+  range_start bigint NOT NULL,
+  range_end bigint NOT NULL,
+  valid boolean NOT NULL,
+  -- table constraints
+  CONSTRAINT chunk_column_stats_pkey PRIMARY KEY (hypertable_id, chunk_id, column_name),
+  CONSTRAINT chunk_column_stats_hypertable_id_fkey FOREIGN KEY (hypertable_id) REFERENCES _timescaledb_catalog.hypertable (id) ON DELETE CASCADE
+);
+
+SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.chunk_column_stats', '');
+
 
 
 -- this does not have an FK on the materialization table since INSERTs to this
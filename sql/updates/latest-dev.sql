@@ -129,3 +129,52 @@ ALTER FUNCTION _timescaledb_internal.get_chunk_colstats(regclass) SET SCHEMA _ti
 
 UPDATE _timescaledb_catalog.hypertable SET chunk_sizing_func_schema = '_timescaledb_functions' WHERE chunk_sizing_func_schema = '_timescaledb_internal' AND chunk_sizing_func_name = 'calculate_chunk_interval';
 
+
+INSERT INTO _timescaledb_catalog.compression_algorithm( id, version, name, description) VALUES
+( 5, 1, 'COMPRESSION_ALGORITHM_BITPACKING', 'bitpacking');
+
+DROP PROCEDURE IF EXISTS _timescaledb_internal.policy_compression_execute(INTEGER, INTEGER, ANYELEMENT, INTEGER, BOOLEAN, BOOLEAN);
+
+CREATE TABLE _timescaledb_internal.bgw_job_stat_histogram (
+  job_id integer NOT NULL,
+  duration_ms bigint[] NOT NULL,
+  bytes_read bigint[] NOT NULL,
+  bytes_written bigint[] NOT NULL,
+  wal_bytes bigint[] NOT NULL,
+  -- table constraints
+  CONSTRAINT bgw_job_stat_histogram_pkey PRIMARY KEY (job_id),
+  CONSTRAINT bgw_job_stat_histogram_job_id_fkey FOREIGN KEY (job_id) REFERENCES _timescaledb_config.bgw_job (id) ON DELETE CASCADE
+);
+
+GRANT SELECT ON _timescaledb_internal.bgw_job_stat_histogram TO PUBLIC;
+
+CREATE TABLE _timescaledb_catalog.hypertable_last_point_cache (
+  hypertable_id integer NOT NULL,
+  cache_schema_name name NOT NULL,
+  cache_table_name name NOT NULL,
+  valid boolean NOT NULL,
+  series_key name[] NOT NULL,
+  -- table constraints
+  CONSTRAINT hypertable_last_point_cache_pkey PRIMARY KEY (hypertable_id),
+  CONSTRAINT hypertable_last_point_cache_hypertable_id_fkey FOREIGN KEY (hypertable_id) REFERENCES _timescaledb_catalog.hypertable (id) ON DELETE CASCADE
+);
+
+SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.hypertable_last_point_cache', '');
+
+GRANT SELECT ON _timescaledb_catalog.hypertable_last_point_cache TO PUBLIC;
+
+CREATE TABLE _timescaledb_catalog.chunk_column_stats (
+  hypertable_id integer NOT NULL,
+  chunk_id integer NOT NULL,
+  column_name name NOT NULL,
+  range_start bigint NOT NULL,
+  range_end bigint NOT NULL,
+  valid boolean NOT NULL,
+  -- table constraints
+  CONSTRAINT chunk_column_stats_pkey PRIMARY KEY (hypertable_id, chunk_id, column_name),
+  CONSTRAINT chunk_column_stats_hypertable_id_fkey FOREIGN KEY (hypertable_id) REFERENCES _timescaledb_catalog.hypertable (id) ON DELETE CASCADE
+);
+
+SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.chunk_column_stats', '');
+
+GRANT SELECT ON _timescaledb_catalog.chunk_column_stats TO PUBLIC;
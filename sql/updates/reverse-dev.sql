@@ -90,3 +90,111 @@ ALTER FUNCTION _timescaledb_functions.attach_osm_table_chunk(regclass, regclass)
 
 UPDATE _timescaledb_catalog.hypertable SET chunk_sizing_func_schema = '_timescaledb_internal' WHERE chunk_sizing_func_schema = '_timescaledb_functions' AND chunk_sizing_func_name = 'calculate_chunk_interval';
 
+
+-- The previous version cannot decompress the batches that were compressed
+-- with bitpacking. The algorithm is chosen per batch, so look at the first
+-- byte of the compressed data, which is the compression algorithm.
+DO $$
+DECLARE
+  chunk regclass;
+  col name;
+  found bool;
+BEGIN
+  CREATE CAST (_timescaledb_internal.compressed_data AS bytea) WITHOUT FUNCTION;
+  FOR chunk IN
+    SELECT format('%I.%I', comp.schema_name, comp.table_name)::regclass
+    FROM _timescaledb_catalog.chunk ch
+    JOIN _timescaledb_catalog.chunk comp ON comp.id = ch.compressed_chunk_id
+    WHERE NOT comp.dropped
+  LOOP
+    FOR col IN
+      SELECT attname FROM pg_attribute
+      WHERE attrelid = chunk AND attnum > 0 AND NOT attisdropped
+        AND atttypid = '_timescaledb_internal.compressed_data'::regtype
+    LOOP
+      EXECUTE format('SELECT EXISTS (SELECT FROM %s WHERE get_byte(%I::bytea, 0) = 5)', chunk, col) INTO found;
+      IF found THEN
+        RAISE EXCEPTION 'cannot downgrade as the compressed chunk % contains data compressed with bitpacking', chunk
+          USING DETAIL = 'The previous version cannot decompress the data compressed with bitpacking.',
+                HINT = 'Decompress the chunks with decompress_chunk before downgrading, and compress them again after the downgrade.';
+      END IF;
+    END LOOP;
+  END LOOP;
+  DROP CAST (_timescaledb_internal.compressed_data AS bytea);
+END
+$$;
+DELETE FROM _timescaledb_catalog.compression_algorithm WHERE id = 5;
+
+DROP FUNCTION IF EXISTS _timescaledb_functions.bloom1_contains(bytea, anyelement);
+
+DROP FUNCTION IF EXISTS _timescaledb_functions.planner_stats();
+DROP FUNCTION IF EXISTS _timescaledb_functions.planner_stats_reset();
+
+DROP FUNCTION IF EXISTS _timescaledb_functions.wait_stats();
+DROP FUNCTION IF EXISTS _timescaledb_functions.wait_stats_reset();
+
+DROP VIEW IF EXISTS timescaledb_information.hypertable_stats;
+DROP FUNCTION IF EXISTS _timescaledb_functions.hypertable_stats();
+DROP FUNCTION IF EXISTS _timescaledb_functions.hypertable_stats_reset();
+
+DROP PROCEDURE IF EXISTS _timescaledb_internal.policy_compression_execute(INTEGER, INTEGER, ANYELEMENT, INTEGER, BOOLEAN, BOOLEAN, INTEGER);
+DROP FUNCTION IF EXISTS _timescaledb_functions.policy_compression_parallel(INTEGER, REGCLASS[], INTEGER, BOOLEAN, BOOLEAN);
+
+UPDATE _timescaledb_catalog.hypertable SET chunk_sizing_func_schema = '_timescaledb_internal', chunk_sizing_func_name = 'calculate_chunk_interval' WHERE chunk_sizing_func_name = 'calculate_chunk_interval_by_ingest_rate';
+DROP FUNCTION IF EXISTS _timescaledb_functions.calculate_chunk_interval_by_ingest_rate(INTEGER, BIGINT, BIGINT);
+
+DROP VIEW IF EXISTS timescaledb_information.job_stats_histograms;
+DROP TABLE IF EXISTS _timescaledb_internal.bgw_job_stat_histogram;
+
+DROP FUNCTION IF EXISTS @extschema@.compression_advisor(REGCLASS, TEXT[], TEXT[], INTEGER);
+DROP FUNCTION IF EXISTS @extschema@.export_chunk_arrow_ipc(REGCLASS);
+
+DROP FUNCTION IF EXISTS @extschema@.merge_chunks(REGCLASS, REGCLASS);
+DELETE FROM _timescaledb_internal.bgw_job_stat WHERE job_id IN (
+  SELECT id FROM _timescaledb_config.bgw_job WHERE proc_schema = '_timescaledb_functions' AND proc_name = 'policy_merge_chunks'
+);
+DELETE FROM _timescaledb_config.bgw_job WHERE proc_schema = '_timescaledb_functions' AND proc_name = 'policy_merge_chunks';
+DROP FUNCTION IF EXISTS @extschema@.add_merge_chunks_policy(REGCLASS, ANYELEMENT, ANYELEMENT, BOOL, INTERVAL);
+DROP FUNCTION IF EXISTS @extschema@.remove_merge_chunks_policy(REGCLASS, BOOL);
+DROP PROCEDURE IF EXISTS _timescaledb_functions.policy_merge_chunks(INTEGER, JSONB);
+DROP PROCEDURE IF EXISTS _timescaledb_functions.policy_merge_chunks_execute(INTEGER, INTEGER, ANYELEMENT, BIGINT, BOOLEAN);
+
+DROP FUNCTION IF EXISTS _timescaledb_functions.hypertable_osm_range_update(REGCLASS, ANYELEMENT, ANYELEMENT);
+
+DROP FUNCTION IF EXISTS @extschema@.set_partition_mapping(REGCLASS, INTEGER[]);
+
+DROP FUNCTION IF EXISTS @extschema@.add_last_point_cache(REGCLASS, NAME[], BOOLEAN);
+DROP FUNCTION IF EXISTS @extschema@.remove_last_point_cache(REGCLASS, BOOLEAN);
+DROP FUNCTION IF EXISTS @extschema@.refresh_last_point_cache(REGCLASS);
+DO $$
+DECLARE
+  cache record;
+BEGIN
+  FOR cache IN SELECT cache_schema_name, cache_table_name FROM _timescaledb_catalog.hypertable_last_point_cache
+  LOOP
+    EXECUTE format('DROP TABLE IF EXISTS %I.%I', cache.cache_schema_name, cache.cache_table_name);
+  END LOOP;
+END
+$$;
+DROP TABLE IF EXISTS _timescaledb_catalog.hypertable_last_point_cache;
+
+DROP FUNCTION IF EXISTS @extschema@.enable_chunk_skipping(REGCLASS, NAME, BOOLEAN);
+DROP FUNCTION IF EXISTS @extschema@.disable_chunk_skipping(REGCLASS, NAME, BOOLEAN);
+DROP TABLE IF EXISTS _timescaledb_catalog.chunk_column_stats;
+
+DELETE FROM _timescaledb_internal.bgw_job_stat WHERE job_id IN (
+  SELECT id FROM _timescaledb_config.bgw_job WHERE proc_schema = '_timescaledb_functions' AND proc_name = 'policy_rebalance_data_nodes'
+);
+DELETE FROM _timescaledb_config.bgw_job WHERE proc_schema = '_timescaledb_functions' AND proc_name = 'policy_rebalance_data_nodes';
+DROP FUNCTION IF EXISTS @extschema@.add_rebalance_policy(REGCLASS, INTEGER, FLOAT8, BIGINT, BOOL, INTERVAL);
+DROP FUNCTION IF EXISTS @extschema@.remove_rebalance_policy(REGCLASS, BOOL);
+DROP PROCEDURE IF EXISTS _timescaledb_functions.policy_rebalance_data_nodes(INTEGER, JSONB);
+
+DELETE FROM _timescaledb_internal.bgw_job_stat WHERE job_id IN (
+  SELECT id FROM _timescaledb_config.bgw_job WHERE proc_schema = '_timescaledb_internal' AND proc_name = 'policy_maintenance'
+);
+DELETE FROM _timescaledb_config.bgw_job WHERE proc_schema = '_timescaledb_internal' AND proc_name = 'policy_maintenance';
+DROP FUNCTION IF EXISTS @extschema@.add_maintenance_policy(REGCLASS, FLOAT8, INTEGER, BOOL, INTERVAL, TIMESTAMPTZ, TEXT);
+DROP FUNCTION IF EXISTS @extschema@.remove_maintenance_policy(REGCLASS, BOOL);
+DROP PROCEDURE IF EXISTS _timescaledb_internal.policy_maintenance(INTEGER, JSONB);
+DROP FUNCTION IF EXISTS _timescaledb_internal.policy_maintenance_check(JSONB);
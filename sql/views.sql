@@ -44,6 +44,29 @@ FROM _timescaledb_catalog.hypertable ht
 WHERE ht.compression_state != 2 --> no internal compression tables
   AND ca.mat_hypertable_id IS NULL;
 
+-- Cumulative runtime statistics of the hypertables since the server start or
+-- the last reset: the inserted rows by the insert path, the created and the
+-- excluded chunks, the decompressed batches and the cache hit ratios
+CREATE OR REPLACE VIEW timescaledb_information.hypertable_stats AS
+SELECT ht.schema_name AS hypertable_schema,
+  ht.table_name AS hypertable_name,
+  s.rows_inserted,
+  s.rows_copied,
+  s.rows_compressed_chunks,
+  s.chunks_created,
+  s.chunks_excluded_plan,
+  s.chunks_excluded_startup,
+  s.chunks_excluded_runtime,
+  s.batches_decompressed,
+  s.bytes_decompressed,
+  s.hypertable_cache_hits::float8 / nullif(s.hypertable_cache_hits + s.hypertable_cache_misses, 0)
+    AS hypertable_cache_hit_ratio,
+  s.chunk_cache_hits::float8 / nullif(s.chunk_cache_hits + s.chunk_cache_misses, 0)
+    AS chunk_cache_hit_ratio
+FROM _timescaledb_functions.hypertable_stats() s
+  INNER JOIN _timescaledb_catalog.hypertable ht ON ht.id = s.hypertable_id
+WHERE ht.compression_state != 2; --> no internal compression tables
+
 CREATE OR REPLACE VIEW timescaledb_information.job_stats AS
 SELECT ht.schema_name AS hypertable_schema,
   ht.table_name AS hypertable_name,
@@ -83,6 +106,31 @@ FROM _timescaledb_config.bgw_job j
   ORDER BY ht.schema_name,
     ht.table_name;
 
+-- Histograms of the resource usage of the job runs, with one row for each
+-- non-empty bucket of each metric
+CREATE OR REPLACE VIEW timescaledb_information.job_stats_histograms AS
+SELECT j.id AS job_id,
+  j.application_name,
+  m.metric,
+  CASE WHEN b.bucket = 1 THEN
+    0
+  ELSE
+    1::bigint << (b.bucket::int - 2)
+  END AS lower_bound,
+  1::bigint << (b.bucket::int - 1) AS upper_bound,
+  b.runs
+FROM _timescaledb_config.bgw_job j
+  INNER JOIN _timescaledb_internal.bgw_job_stat_histogram h ON j.id = h.job_id
+  CROSS JOIN LATERAL (VALUES ('duration_ms', h.duration_ms),
+    ('bytes_read', h.bytes_read),
+    ('bytes_written', h.bytes_written),
+    ('wal_bytes', h.wal_bytes)) AS m (metric, buckets)
+  CROSS JOIN LATERAL unnest(m.buckets) WITH ORDINALITY AS b (runs, bucket)
+WHERE b.runs > 0
+ORDER BY j.id,
+  m.metric,
+  b.bucket;
+
 -- view for background worker jobs
 CREATE OR REPLACE VIEW timescaledb_information.jobs AS
 SELECT j.id AS job_id,
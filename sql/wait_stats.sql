@@ -0,0 +1,17 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- The cumulative number and time, in milliseconds, of the internal waits of
+-- TimescaleDB in all sessions since the server start or the last reset
+CREATE OR REPLACE FUNCTION _timescaledb_functions.wait_stats()
+RETURNS TABLE (
+    wait_event  text,
+    waits       bigint,
+    total_time  double precision,
+    max_time    double precision)
+AS '@MODULE_PATHNAME@', 'ts_wait_stats' LANGUAGE C VOLATILE STRICT;
+
+CREATE OR REPLACE FUNCTION _timescaledb_functions.wait_stats_reset()
+RETURNS VOID
+AS '@MODULE_PATHNAME@', 'ts_wait_stats_reset' LANGUAGE C VOLATILE STRICT;
@@ -30,6 +30,12 @@ static void bit_array_init(BitArray *array);
 
 /* Append num_bits to the array */
 static void bit_array_append(BitArray *array, uint8 num_bits, uint64 bits);
+/* Append num_bits stored LSB-first in 64-bit words, e.g. an Arrow validity bitmap */
+static void bit_array_append_words(BitArray *array, const uint64 *words, uint64 num_bits);
+
+/* return num_bits starting at the absolute bit position start_bit */
+pg_attribute_always_inline static uint64 bit_array_get_bits(const BitArray *array,
+															uint64 start_bit, uint8 num_bits);
 
 static void bit_array_iterator_init(BitArrayIterator *iter, const BitArray *array);
 /* return next num_bits from the iterator; must have been written as num_bits */
@@ -48,6 +54,9 @@ static char *bytes_store_bit_array_and_advance(char *dest, size_t expected_size,
 static size_t bit_array_output(const BitArray *array, uint64 *data, size_t max_n_bytes,
 							   uint64 *num_bits_out);
 static void bit_array_wrap(BitArray *dst, uint64 *data, uint64 num_bits);
+/* Copy the first num_bits to a bitmap in Arrow validity layout, zeroing the tail */
+static void bit_array_to_validity_bitmap(const BitArray *array, uint64 *restrict dst,
+										 uint64 num_bits);
 
 /* Accessors / Info */
 static uint64 bit_array_num_bits(const BitArray *array);
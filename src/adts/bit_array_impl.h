@@ -225,6 +225,77 @@ bit_array_append(BitArray *array, uint8 num_bits, uint64 bits)
 	bit_array_append_bucket(array, num_bits_for_new_bucket, bits_for_new_bucket);
 }
 
+/*
+ * Append whole words at a time. The bits are in the same LSB-first order as
+ * the buckets, so when the last bucket is full this is a copy of the words.
+ */
+static inline void
+bit_array_append_words(BitArray *array, const uint64 *words, uint64 num_bits)
+{
+	const uint64 num_full_words = num_bits / BITS_PER_BUCKET;
+	const uint8 num_tail_bits = num_bits % BITS_PER_BUCKET;
+
+	if (array->buckets.num_elements == 0 || array->bits_used_in_last_bucket == BITS_PER_BUCKET)
+	{
+		if (num_full_words > 0)
+		{
+			uint64_vec_append_array(&array->buckets, (uint64 *) words, num_full_words);
+			array->bits_used_in_last_bucket = BITS_PER_BUCKET;
+		}
+	}
+	else
+	{
+		for (uint64 i = 0; i < num_full_words; i++)
+			bit_array_append(array, BITS_PER_BUCKET, words[i]);
+	}
+
+	bit_array_append(array, num_tail_bits, num_tail_bits > 0 ? words[num_full_words] : 0);
+}
+
+/*
+ * Read up to 64 bits at an arbitrary position without going through an
+ * iterator. This is meant for the bulk decompression loops that track the bit
+ * position themselves.
+ */
+pg_attribute_always_inline static uint64
+bit_array_get_bits(const BitArray *array, uint64 start_bit, uint8 num_bits)
+{
+	CheckCompressedData(num_bits <= BITS_PER_BUCKET);
+	if (num_bits == 0)
+		return 0;
+
+	CheckCompressedData(start_bit + num_bits <=
+						(uint64) array->buckets.num_elements * BITS_PER_BUCKET);
+
+	const uint64 *restrict data = array->buckets.data;
+	const uint64 bucket = start_bit / BITS_PER_BUCKET;
+	const uint8 offset = start_bit % BITS_PER_BUCKET;
+
+	uint64 value = data[bucket] >> offset;
+	if (offset + num_bits > BITS_PER_BUCKET)
+	{
+		/* The next bucket has the high-order bits */
+		value |= data[bucket + 1] << (BITS_PER_BUCKET - offset);
+	}
+
+	return value & bit_array_low_bits_mask(num_bits);
+}
+
+static inline void
+bit_array_to_validity_bitmap(const BitArray *array, uint64 *restrict dst, uint64 num_bits)
+{
+	const uint64 num_words = (num_bits + BITS_PER_BUCKET - 1) / BITS_PER_BUCKET;
+
+	Assert(num_bits <= bit_array_num_bits(array));
+	if (num_words == 0)
+		return;
+
+	memcpy(dst, array->buckets.data, num_words * sizeof(uint64));
+
+	if (num_bits % BITS_PER_BUCKET)
+		dst[num_words - 1] &= bit_array_low_bits_mask(num_bits % BITS_PER_BUCKET);
+}
+
 static inline void
 bit_array_iterator_init(BitArrayIterator *iter, const BitArray *array)
 {
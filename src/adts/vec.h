@@ -23,6 +23,11 @@
  *	  - VEC_DEFINE - if defined function definitions are generated
  *	  - VEC_SCOPE - in which scope (e.g. extern, static inline) do function
  *		    declarations reside
+ *	  - VEC_INLINE_CAPACITY - optional, if defined the vector stores up to this
+ *		    many elements inline in the vector struct, and only allocates
+ *		    memory when it grows beyond that. This is useful for the small
+ *		    collections on hot paths. Such a vector points into itself, so
+ *		    it must not be copied or moved by value once initialized.
  */
 
 #define VEC_MAKE_PREFIX(a) CppConcat(a, _)
@@ -66,6 +71,11 @@ typedef struct VEC_TYPE
 
 	/* memory context to use for allocations */
 	MemoryContext ctx;
+
+#ifdef VEC_INLINE_CAPACITY
+	/* the storage used until the vector grows beyond the inline capacity */
+	VEC_ELEMENT_TYPE inline_data[VEC_INLINE_CAPACITY];
+#endif
 } VEC_TYPE;
 
 /* externally visible function prototypes */
@@ -120,6 +130,15 @@ VEC_RESERVE(VEC_TYPE *vec, uint32 additional)
 	vec->max_elements = num_elements;
 
 	num_bytes = vec->max_elements * sizeof(VEC_ELEMENT_TYPE);
+#ifdef VEC_INLINE_CAPACITY
+	if (vec->data == vec->inline_data)
+	{
+		/* spill the inline elements to the heap */
+		vec->data = MemoryContextAlloc(vec->ctx, num_bytes);
+		memcpy(vec->data, vec->inline_data, sizeof(VEC_ELEMENT_TYPE) * vec->num_elements);
+		return;
+	}
+#endif
 	if (vec->data == NULL)
 		vec->data = MemoryContextAlloc(vec->ctx, num_bytes);
 	else
@@ -136,6 +155,10 @@ VEC_INIT(VEC_TYPE *vec, MemoryContext ctx, uint32 nelements)
 	*vec = (VEC_TYPE){
 		.ctx = ctx,
 	};
+#ifdef VEC_INLINE_CAPACITY
+	vec->data = vec->inline_data;
+	vec->max_elements = VEC_INLINE_CAPACITY;
+#endif
 	if (nelements > 0)
 		VEC_RESERVE(vec, nelements);
 }
@@ -156,12 +179,18 @@ VEC_CREATE(MemoryContext ctx, uint32 nelements)
 VEC_SCOPE void
 VEC_FREE_DATA(VEC_TYPE *vec)
 {
+#ifdef VEC_INLINE_CAPACITY
+	if (vec->data != vec->inline_data)
+		pfree(vec->data);
+	VEC_INIT(vec, vec->ctx, 0);
+#else
 	if (vec->data != NULL)
 		pfree(vec->data);
 	/* zero out all the vec data except the memory context so it can be reused */
 	*vec = (VEC_TYPE){
 		.ctx = vec->ctx,
 	};
+#endif
 }
 
 /* free an allocated vector, and its data */
@@ -265,6 +294,7 @@ VEC_DELETE(VEC_TYPE *vec, uint32 index)
 #undef VEC_SCOPE
 #undef VEC_DECLARE
 #undef VEC_DEFINE
+#undef VEC_INLINE_CAPACITY
 
 /* undefine locally declared macros */
 #undef VEC_MAKE_PREFIX
@@ -12,6 +12,7 @@
 #include <lib/stringinfo.h>
 #include <nodes/value.h>
 #include <utils/datum.h>
+#include <utils/fmgrprotos.h>
 #include <utils/lsyscache.h>
 #include <utils/syscache.h>
 
@@ -266,7 +267,9 @@ typeinfocache_polydatumcopy(TypeInfoCache *tic, PolyDatum input, PolyDatum *outp
 
 	if (!input.is_null)
 	{
-		output->datum = datumCopy(input.datum, tic->typebyval, tic->typelen);
+		/* datumCopy is a no-op for by-value types, skip the function call */
+		output->datum =
+			tic->typebyval ? input.datum : datumCopy(input.datum, tic->typebyval, tic->typelen);
 		output->is_null = false;
 	}
 	else
@@ -276,14 +279,38 @@ typeinfocache_polydatumcopy(TypeInfoCache *tic, PolyDatum input, PolyDatum *outp
 	}
 }
 
+/*
+ * The comparison operators of the common types of the comparison element are
+ * done inline instead of through fmgr, since the comparison runs for every row.
+ */
+typedef enum CmpProcKind
+{
+	CMPPROC_FMGR = 0,
+	CMPPROC_INT64_LT,
+	CMPPROC_INT64_GT,
+	CMPPROC_INT32_LT,
+	CMPPROC_INT32_GT,
+} CmpProcKind;
+
+typedef struct CmpProc
+{
+	Oid type_oid;
+	CmpProcKind kind;
+	FmgrInfo proc;
+} CmpProc;
+
 inline static void
-cmpproc_init(FunctionCallInfo fcinfo, FmgrInfo *cmp_proc, Oid type_oid, char *opname)
+cmpproc_init(FunctionCallInfo fcinfo, CmpProc *cmp_proc, Oid type_oid, char *opname)
 {
 	Oid cmp_op, cmp_regproc;
 
 	if (!OidIsValid(type_oid))
 		elog(ERROR, "could not determine the type of the comparison_element");
 
+	/* the operator lookup is expensive, so only do it when the type changes */
+	if (cmp_proc->type_oid == type_oid)
+		return;
+
 	cmp_op = OpernameGetOprid(list_make1(makeString(opname)), type_oid, type_oid);
 	if (!OidIsValid(cmp_op))
 		elog(ERROR, "could not find a %s operator for type %d", opname, type_oid);
@@ -293,20 +320,49 @@ cmpproc_init(FunctionCallInfo fcinfo, FmgrInfo *cmp_proc, Oid type_oid, char *op
 			 "could not find the procedure for the %s operator for type %d",
 			 opname,
 			 type_oid);
-	fmgr_info_cxt(cmp_regproc, cmp_proc, fcinfo->flinfo->fn_mcxt);
+	fmgr_info_cxt(cmp_regproc, &cmp_proc->proc, fcinfo->flinfo->fn_mcxt);
+
+	/* timestamp and timestamptz share the comparison functions */
+	if (cmp_proc->proc.fn_addr == timestamp_lt || cmp_proc->proc.fn_addr == int8lt)
+		cmp_proc->kind = CMPPROC_INT64_LT;
+	else if (cmp_proc->proc.fn_addr == timestamp_gt || cmp_proc->proc.fn_addr == int8gt)
+		cmp_proc->kind = CMPPROC_INT64_GT;
+	else if (cmp_proc->proc.fn_addr == date_lt || cmp_proc->proc.fn_addr == int4lt)
+		cmp_proc->kind = CMPPROC_INT32_LT;
+	else if (cmp_proc->proc.fn_addr == date_gt || cmp_proc->proc.fn_addr == int4gt)
+		cmp_proc->kind = CMPPROC_INT32_GT;
+	else
+		cmp_proc->kind = CMPPROC_FMGR;
+
+	cmp_proc->type_oid = type_oid;
 }
 
 inline static bool
-cmpproc_cmp(FmgrInfo *cmp_proc, FunctionCallInfo fcinfo, PolyDatum left, PolyDatum right)
+cmpproc_cmp(CmpProc *cmp_proc, FunctionCallInfo fcinfo, PolyDatum left, PolyDatum right)
 {
-	return DatumGetBool(FunctionCall2Coll(cmp_proc, fcinfo->fncollation, left.datum, right.datum));
+	switch (cmp_proc->kind)
+	{
+		case CMPPROC_INT64_LT:
+			return DatumGetInt64(left.datum) < DatumGetInt64(right.datum);
+		case CMPPROC_INT64_GT:
+			return DatumGetInt64(left.datum) > DatumGetInt64(right.datum);
+		case CMPPROC_INT32_LT:
+			return DatumGetInt32(left.datum) < DatumGetInt32(right.datum);
+		case CMPPROC_INT32_GT:
+			return DatumGetInt32(left.datum) > DatumGetInt32(right.datum);
+		case CMPPROC_FMGR:
+			break;
+	}
+
+	return DatumGetBool(
+		FunctionCall2Coll(&cmp_proc->proc, fcinfo->fncollation, left.datum, right.datum));
 }
 
 typedef struct TransCache
 {
 	TypeInfoCache value_type_cache;
 	TypeInfoCache cmp_type_cache;
-	FmgrInfo cmp_proc;
+	CmpProc cmp_proc;
 } TransCache;
 
 static TransCache *
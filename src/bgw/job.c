@@ -45,10 +45,12 @@
 #include "bgw_policy/policy.h"
 #include "scan_iterator.h"
 #include "bgw/scheduler.h"
+#include "chunk_index.h"
 
 #include <cross_module_fn.h>
 #include "jsonb_utils.h"
 #include "debug_assert.h"
+#include "wait_stats.h"
 
 static scheduler_test_hook_type scheduler_test_hook = NULL;
 static char *job_entrypoint_function_name = "ts_bgw_job_entrypoint";
@@ -378,6 +380,7 @@ ts_bgw_job_get_scheduled(size_t alloc_size, MemoryContext mctx)
 		 * width starting part of the BgwJob struct.
 		 */
 		memcpy(job, GETSTRUCT(tuple), offsetof(FormData_bgw_job, fixed_schedule));
+		job->xmin = HeapTupleHeaderGetXmin(tuple->t_data);
 
 		if (should_free)
 			heap_freetuple(tuple);
@@ -587,10 +590,20 @@ init_scan_by_job_id(ScanIterator *iterator, int32 job_id)
 bool
 ts_lock_job_id(int32 job_id, LOCKMODE mode, bool session_lock, LOCKTAG *tag, bool block)
 {
+	instr_time start;
+	LockAcquireResult result;
+
 	/* Use a special pseudo-random field 4 value to avoid conflicting with user-advisory-locks */
 	TS_SET_LOCKTAG_ADVISORY(*tag, MyDatabaseId, job_id, 0);
 
-	return LockAcquire(tag, mode, session_lock, !block) != LOCKACQUIRE_NOT_AVAIL;
+	if (!block)
+		return LockAcquire(tag, mode, session_lock, true) != LOCKACQUIRE_NOT_AVAIL;
+
+	ts_wait_stats_start(&start);
+	result = LockAcquire(tag, mode, session_lock, false);
+	ts_wait_stats_end(TS_WAIT_JOB_LOCK, &start);
+
+	return result != LOCKACQUIRE_NOT_AVAIL;
 }
 
 static BgwJob *
@@ -1168,43 +1181,31 @@ ts_job_errors_insert_tuple(const FormData_job_error *job_err)
 	return true;
 }
 
-extern Datum
-ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
+/*
+ * Run a job in a background worker that is connected to the database as the
+ * owner of the job.
+ *
+ * The worker can run more jobs after this one, so the session lock on the job
+ * is released when the job has finished.
+ */
+void
+ts_bgw_job_run(int32 job_id)
 {
-	Oid db_oid = DatumGetObjectId(MyBgworkerEntry->bgw_main_arg);
-	BgwParams params;
 	BgwJob *job;
 	JobResult res = JOB_FAILURE;
 	bool got_lock;
 	instr_time start;
 	instr_time duration;
-
-	memcpy(&params, MyBgworkerEntry->bgw_extra, sizeof(BgwParams));
-	Ensure(params.user_oid != 0 && params.job_id != 0,
-		   "job id or user oid was zero - job_id: %d, user_oid: %d",
-		   params.job_id,
-		   params.user_oid);
-
-	BackgroundWorkerBlockSignals();
-	/* Setup any signal handlers here */
-
-	/*
-	 * do not use the default `bgworker_die` sigterm handler because it does
-	 * not respect critical sections
-	 */
-	pqsignal(SIGTERM, die);
-	BackgroundWorkerUnblockSignals();
-
-	BackgroundWorkerInitializeConnectionByOid(db_oid, params.user_oid, 0);
-
-	ts_license_enable_module_loading();
+	LOCKTAG tag;
+	BgwJobUsage usage;
 
 	INSTR_TIME_SET_CURRENT(start);
+	ts_bgw_job_usage_start(&usage);
 
 	StartTransactionCommand();
 	/* Grab a session lock on the job row to prevent concurrent deletes. Lock is released
-	 * when the job process exits */
-	job = ts_bgw_job_find_with_lock(params.job_id,
+	 * when the job has finished or the job process exits */
+	job = ts_bgw_job_find_with_lock(job_id,
 									TopMemoryContext,
 									RowShareLock,
 									SESSION_LOCK,
@@ -1214,7 +1215,7 @@ ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
 	CommitTransactionCommand();
 
 	if (job == NULL)
-		elog(ERROR, "job %d not found when running the background worker", params.job_id);
+		elog(ERROR, "job %d not found when running the background worker", job_id);
 
 	pgstat_report_appname(NameStr(job->fd.application_name));
 	MemoryContext oldcontext = CurrentMemoryContext;
@@ -1260,7 +1261,7 @@ ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
 		 * removed the session lock. Don't block and only record if the lock was actually
 		 * obtained.
 		 */
-		job = ts_bgw_job_find_with_lock(params.job_id,
+		job = ts_bgw_job_find_with_lock(job_id,
 										TopMemoryContext,
 										RowShareLock,
 										TXN_LOCK,
@@ -1269,6 +1270,7 @@ ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
 		if (job != NULL)
 		{
 			ts_bgw_job_stat_mark_end(job, JOB_FAILURE);
+			ts_bgw_job_stat_histogram_record(job_id, &usage);
 			ts_bgw_job_check_max_retries(job);
 			namestrcpy(&proc_name, NameStr(job->fd.proc_name));
 			namestrcpy(&proc_schema, NameStr(job->fd.proc_schema));
@@ -1279,7 +1281,7 @@ ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
 		 * the rethrow will log the error; but also log which job threw the
 		 * error
 		 */
-		elog(LOG, "job %d threw an error", params.job_id);
+		elog(LOG, "job %d threw an error", job_id);
 
 		ErrorData *edata;
 		FormData_job_error jerr = { 0 };
@@ -1287,7 +1289,7 @@ ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
 		MemoryContextSwitchTo(oldcontext);
 		edata = CopyErrorData();
 
-		BgwJobStat *job_stat = ts_bgw_job_stat_find(params.job_id);
+		BgwJobStat *job_stat = ts_bgw_job_stat_find(job_id);
 		if (job_stat != NULL)
 		{
 			start_time = job_stat->fd.last_start;
@@ -1296,7 +1298,7 @@ ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
 		/* We include the procname in the error data and expose it in the view
 		 to avoid adding an extra field in the table */
 		jerr.error_data = ts_errdata_to_jsonb(edata, &proc_schema, &proc_name);
-		jerr.job_id = params.job_id;
+		jerr.job_id = job_id;
 		jerr.start_time = start_time;
 		jerr.finish_time = finish_time;
 		jerr.pid = MyProcPid;
@@ -1318,6 +1320,7 @@ ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
 	 * is launched
 	 */
 	ts_bgw_job_stat_mark_end(job, res);
+	ts_bgw_job_stat_histogram_record(job_id, &usage);
 
 	CommitTransactionCommand();
 
@@ -1326,7 +1329,7 @@ ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
 
 	elog(LOG,
 		 "job %d (%s) exiting with %s: execution time %.2f ms",
-		 params.job_id,
+		 job_id,
 		 NameStr(job->fd.application_name),
 		 (res == JOB_SUCCESS ? "success" : "failure"),
 		 INSTR_TIME_GET_MILLISEC(duration));
@@ -1337,6 +1340,106 @@ ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
 		job = NULL;
 	}
 
+	TS_SET_LOCKTAG_ADVISORY(tag, MyDatabaseId, job_id, 0);
+	LockRelease(&tag, RowShareLock, true);
+}
+
+extern Datum
+ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
+{
+	Oid db_oid = DatumGetObjectId(MyBgworkerEntry->bgw_main_arg);
+	BgwParams params;
+
+	memcpy(&params, MyBgworkerEntry->bgw_extra, sizeof(BgwParams));
+	Ensure(params.user_oid != 0 && params.job_id != 0,
+		   "job id or user oid was zero - job_id: %d, user_oid: %d",
+		   params.job_id,
+		   params.user_oid);
+
+	BackgroundWorkerBlockSignals();
+	/* Setup any signal handlers here */
+
+	/*
+	 * do not use the default `bgworker_die` sigterm handler because it does
+	 * not respect critical sections
+	 */
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	BackgroundWorkerInitializeConnectionByOid(db_oid, params.user_oid, 0);
+
+	ts_license_enable_module_loading();
+
+	ts_bgw_job_run(params.job_id);
+
+	PG_RETURN_VOID();
+}
+
+TS_FUNCTION_INFO_V1(ts_bgw_compression_worker_main);
+
+/*
+ * Entrypoint of the workers that a compression policy starts to compress its
+ * chunks in parallel. The chunks are compressed by the TSL module, which can
+ * only be loaded once the worker is connected to the database.
+ */
+extern Datum
+ts_bgw_compression_worker_main(PG_FUNCTION_ARGS)
+{
+	Oid db_oid = DatumGetObjectId(MyBgworkerEntry->bgw_main_arg);
+	BgwParams params;
+
+	memcpy(&params, MyBgworkerEntry->bgw_extra, sizeof(BgwParams));
+	Ensure(params.user_oid != 0, "user oid was zero - job_id: %d", params.job_id);
+
+	BackgroundWorkerBlockSignals();
+
+	/*
+	 * do not use the default `bgworker_die` sigterm handler because it does
+	 * not respect critical sections
+	 */
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	BackgroundWorkerInitializeConnectionByOid(db_oid, params.user_oid, 0);
+
+	ts_license_enable_module_loading();
+
+	zero_guc("max_parallel_workers_per_gather");
+	zero_guc("max_parallel_workers");
+	zero_guc("max_parallel_maintenance_workers");
+
+	ts_cm_functions->policy_compression_worker_run(params.segment_handle);
+
+	PG_RETURN_VOID();
+}
+
+TS_FUNCTION_INFO_V1(ts_bgw_chunk_index_worker_main);
+
+/*
+ * Entrypoint of the workers that CREATE INDEX ... WITH
+ * (timescaledb.parallel_chunks) starts to build the chunk indexes. Unlike the
+ * compression workers, they keep the parallel maintenance workers, so that
+ * the index build of a chunk can be parallel as well.
+ */
+extern Datum
+ts_bgw_chunk_index_worker_main(PG_FUNCTION_ARGS)
+{
+	Oid db_oid = DatumGetObjectId(MyBgworkerEntry->bgw_main_arg);
+	BgwParams params;
+
+	memcpy(&params, MyBgworkerEntry->bgw_extra, sizeof(BgwParams));
+	Ensure(params.user_oid != 0, "user oid was zero for chunk index worker");
+
+	BackgroundWorkerBlockSignals();
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	BackgroundWorkerInitializeConnectionByOid(db_oid, params.user_oid, 0);
+
+	ts_license_enable_module_loading();
+
+	ts_chunk_index_worker_run(params.segment_handle);
+
 	PG_RETURN_VOID();
 }
 
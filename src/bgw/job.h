@@ -19,6 +19,8 @@
 typedef struct BgwJob
 {
 	FormData_bgw_job fd;
+	/* Xmin of the catalog tuple, which the scheduler uses to find changed jobs */
+	TransactionId xmin;
 } BgwJob;
 
 typedef bool job_main_func(void);
@@ -58,6 +60,9 @@ extern bool ts_bgw_job_execute(BgwJob *job);
 extern TSDLLEXPORT void ts_bgw_job_run_config_check(Oid check, int32 job_id, Jsonb *config);
 
 extern TSDLLEXPORT Datum ts_bgw_job_entrypoint(PG_FUNCTION_ARGS);
+extern void ts_bgw_job_run(int32 job_id);
+extern TSDLLEXPORT Datum ts_bgw_compression_worker_main(PG_FUNCTION_ARGS);
+extern TSDLLEXPORT Datum ts_bgw_chunk_index_worker_main(PG_FUNCTION_ARGS);
 extern void ts_bgw_job_set_scheduler_test_hook(scheduler_test_hook_type hook);
 extern void ts_bgw_job_set_job_entrypoint_function_name(char *func_name);
 extern TSDLLEXPORT bool ts_bgw_job_run_and_set_next_start(BgwJob *job, job_main_func func,
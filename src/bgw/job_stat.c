@@ -5,12 +5,16 @@
  */
 #include <postgres.h>
 #include <access/xact.h>
+#include <catalog/pg_type.h>
+#include <port/pg_bitutils.h>
+#include <utils/array.h>
 #include <utils/fmgrprotos.h>
 
 #include <stdlib.h>
 #include <math.h>
 
 #include "job_stat.h"
+#include "scan_iterator.h"
 #include "scanner.h"
 #include "timer.h"
 #include "utils.h"
@@ -106,14 +110,183 @@ bgw_job_stat_tuple_delete(TupleInfo *ti, void *const data)
 	return SCAN_CONTINUE;
 }
 
+static void
+bgw_job_stat_histogram_init_scan(ScanIterator *iterator, int32 bgw_job_id)
+{
+	iterator->ctx.index = catalog_get_index(ts_catalog_get(),
+											BGW_JOB_STAT_HISTOGRAM,
+											BGW_JOB_STAT_HISTOGRAM_PKEY_IDX);
+	ts_scan_iterator_scan_key_init(iterator,
+								   Anum_bgw_job_stat_histogram_pkey_idx_job_id,
+								   BTEqualStrategyNumber,
+								   F_INT4EQ,
+								   Int32GetDatum(bgw_job_id));
+}
+
 void
 ts_bgw_job_stat_delete(int32 bgw_job_id)
 {
+	ScanIterator iterator =
+		ts_scan_iterator_create(BGW_JOB_STAT_HISTOGRAM, RowExclusiveLock, CurrentMemoryContext);
+
 	bgw_job_stat_scan_job_id(bgw_job_id,
 							 bgw_job_stat_tuple_delete,
 							 NULL,
 							 NULL,
 							 ShareRowExclusiveLock);
+
+	bgw_job_stat_histogram_init_scan(&iterator, bgw_job_id);
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+
+		ts_catalog_delete_tid(ti->scanrel, ts_scanner_get_tuple_tid(ti));
+	}
+	ts_scan_iterator_close(&iterator);
+}
+
+/*
+ * The histograms have power-of-two buckets: bucket i counts the values in
+ * [2^(i-1), 2^i) and bucket 0 counts the zeros. The last bucket also counts
+ * all larger values.
+ */
+#define JOB_STAT_HISTOGRAM_BUCKETS 63
+
+static int
+histogram_bucket(int64 value)
+{
+	if (value <= 0)
+		return 0;
+
+	return Min(pg_leftmost_one_pos64((uint64) value) + 1, JOB_STAT_HISTOGRAM_BUCKETS - 1);
+}
+
+static Datum
+histogram_add(Datum histogram, bool isnull, int64 value)
+{
+	Datum buckets[JOB_STAT_HISTOGRAM_BUCKETS];
+	int bucket = histogram_bucket(value);
+	int nelems = 0;
+	Datum *elems = NULL;
+
+	if (!isnull)
+		deconstruct_array(DatumGetArrayTypeP(histogram),
+						  INT8OID,
+						  sizeof(int64),
+						  FLOAT8PASSBYVAL,
+						  TYPALIGN_DOUBLE,
+						  &elems,
+						  NULL,
+						  &nelems);
+
+	for (int i = 0; i < JOB_STAT_HISTOGRAM_BUCKETS; i++)
+		buckets[i] = (i < nelems) ? elems[i] : Int64GetDatum(0);
+
+	buckets[bucket] = Int64GetDatum(DatumGetInt64(buckets[bucket]) + 1);
+
+	return PointerGetDatum(construct_array(buckets,
+										   JOB_STAT_HISTOGRAM_BUCKETS,
+										   INT8OID,
+										   sizeof(int64),
+										   FLOAT8PASSBYVAL,
+										   TYPALIGN_DOUBLE));
+}
+
+/*
+ * Remember the counters at the start of a job run.
+ */
+void
+ts_bgw_job_usage_start(BgwJobUsage *usage)
+{
+	INSTR_TIME_SET_CURRENT(usage->start);
+	usage->bufusage = pgBufferUsage;
+	usage->walusage = pgWalUsage;
+}
+
+/*
+ * Add the resource usage of a job run that started at the given counters to
+ * the histograms of the job. Needs to be called in a transaction.
+ */
+void
+ts_bgw_job_stat_histogram_record(int32 bgw_job_id, const BgwJobUsage *usage)
+{
+	ScanIterator iterator =
+		ts_scan_iterator_create(BGW_JOB_STAT_HISTOGRAM, RowExclusiveLock, CurrentMemoryContext);
+	BufferUsage bufusage = { 0 };
+	WalUsage walusage = { 0 };
+	instr_time duration;
+	int64 metrics[_Anum_bgw_job_stat_histogram_max] = { 0 };
+	Datum values[Natts_bgw_job_stat_histogram] = { 0 };
+	bool nulls[Natts_bgw_job_stat_histogram] = { false };
+	bool found = false;
+
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, usage->start);
+	BufferUsageAccumDiff(&bufusage, &pgBufferUsage, &usage->bufusage);
+	WalUsageAccumDiff(&walusage, &pgWalUsage, &usage->walusage);
+
+	metrics[Anum_bgw_job_stat_histogram_duration_ms] =
+		(int64) INSTR_TIME_GET_MILLISEC(duration);
+	metrics[Anum_bgw_job_stat_histogram_bytes_read] =
+		(bufusage.shared_blks_read + bufusage.local_blks_read + bufusage.temp_blks_read) *
+		BLCKSZ;
+	metrics[Anum_bgw_job_stat_histogram_bytes_written] =
+		(bufusage.shared_blks_dirtied + bufusage.local_blks_dirtied + bufusage.temp_blks_written) *
+		BLCKSZ;
+	metrics[Anum_bgw_job_stat_histogram_wal_bytes] = (int64) walusage.wal_bytes;
+
+	bgw_job_stat_histogram_init_scan(&iterator, bgw_job_id);
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		TupleDesc tupdesc = ts_scanner_get_tupledesc(ti);
+		bool should_free;
+		HeapTuple tuple = ts_scanner_fetch_heap_tuple(ti, false, &should_free);
+		HeapTuple new_tuple;
+
+		heap_deform_tuple(tuple, tupdesc, values, nulls);
+
+		for (AttrNumber attno = Anum_bgw_job_stat_histogram_duration_ms;
+			 attno <= Natts_bgw_job_stat_histogram;
+			 attno++)
+		{
+			int i = AttrNumberGetAttrOffset(attno);
+
+			values[i] = histogram_add(values[i], nulls[i], metrics[attno]);
+			nulls[i] = false;
+		}
+
+		new_tuple = heap_form_tuple(tupdesc, values, nulls);
+		ts_catalog_update_tid(ti->scanrel, ts_scanner_get_tuple_tid(ti), new_tuple);
+		heap_freetuple(new_tuple);
+
+		if (should_free)
+			heap_freetuple(tuple);
+
+		found = true;
+	}
+	ts_scan_iterator_close(&iterator);
+
+	if (!found)
+	{
+		Catalog *catalog = ts_catalog_get();
+		CatalogSecurityContext sec_ctx;
+		Relation rel =
+			table_open(catalog_get_table_id(catalog, BGW_JOB_STAT_HISTOGRAM), RowExclusiveLock);
+
+		values[AttrNumberGetAttrOffset(Anum_bgw_job_stat_histogram_job_id)] =
+			Int32GetDatum(bgw_job_id);
+
+		for (AttrNumber attno = Anum_bgw_job_stat_histogram_duration_ms;
+			 attno <= Natts_bgw_job_stat_histogram;
+			 attno++)
+			values[AttrNumberGetAttrOffset(attno)] = histogram_add(0, true, metrics[attno]);
+
+		ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+		ts_catalog_insert_values(rel, RelationGetDescr(rel), values, nulls);
+		ts_catalog_restore_user(&sec_ctx);
+		table_close(rel, RowExclusiveLock);
+	}
 }
 
 /* Mark the start of a job. This should be done in a separate transaction by the scheduler
@@ -6,6 +6,10 @@
 #ifndef BGW_JOB_STAT_H
 #define BGW_JOB_STAT_H
 
+#include <postgres.h>
+#include <executor/instrument.h>
+#include <portability/instr_time.h>
+
 #include "ts_catalog/catalog.h"
 #include "job.h"
 
@@ -17,6 +21,17 @@ typedef struct BgwJobStat
 	FormData_bgw_job_stat fd;
 } BgwJobStat;
 
+/*
+ * Counters at the start of a job run, from which the resource usage of the
+ * run is computed when it ends.
+ */
+typedef struct BgwJobUsage
+{
+	instr_time start;
+	BufferUsage bufusage;
+	WalUsage walusage;
+} BgwJobUsage;
+
 /* Positive result numbers reserved for success */
 typedef enum JobResult
 {
@@ -30,6 +45,8 @@ extern void ts_bgw_job_stat_delete(int job_id);
 extern TSDLLEXPORT void ts_bgw_job_stat_mark_start(int32 bgw_job_id);
 extern void ts_bgw_job_stat_mark_end(BgwJob *job, JobResult result);
 extern bool ts_bgw_job_stat_end_was_marked(BgwJobStat *jobstat);
+extern void ts_bgw_job_usage_start(BgwJobUsage *usage);
+extern void ts_bgw_job_stat_histogram_record(int32 bgw_job_id, const BgwJobUsage *usage);
 
 extern TSDLLEXPORT void ts_bgw_job_stat_set_next_start(int32 job_id, TimestampTz next_start);
 extern TSDLLEXPORT bool ts_bgw_job_stat_update_next_start(int32 job_id, TimestampTz next_start,
@@ -8,8 +8,10 @@
 
 #include <postgres.h>
 
-extern bool ts_bgw_worker_reserve(void);
-extern void ts_bgw_worker_release(void);
+#include "export.h"
+
+extern TSDLLEXPORT bool ts_bgw_worker_reserve(void);
+extern TSDLLEXPORT void ts_bgw_worker_release(void);
 extern int ts_bgw_num_unreserved(void);
 extern int ts_bgw_loader_api_version(void);
 extern void ts_bgw_check_loader_api_version(void);
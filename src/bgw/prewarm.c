@@ -0,0 +1,305 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+/*
+ * Prewarm the most recent chunks when the scheduler of a database starts.
+ *
+ * After a restart or a failover, the first queries on the newest chunks read
+ * them and their indexes from disk. When timescaledb.prewarm_recent_chunks is
+ * set, the scheduler starts a worker that reads the newest chunks of each
+ * hypertable and continuous aggregate into the shared buffers, up to
+ * timescaledb.prewarm_memory_limit. The chunks are taken from the latest
+ * slices of the primary dimension. The newest chunk of every hypertable is
+ * read first, then the second newest ones and so on, so that the budget is
+ * spread over the hypertables.
+ *
+ * The indexes of a chunk are read before the chunk itself since every query
+ * on the chunk reads them, and each relation is read from its end, which
+ * holds the newest rows. A compressed chunk is read through its compressed
+ * chunk, including the TOAST table that holds the compressed data.
+ */
+#include <postgres.h>
+#include <access/relation.h>
+#include <access/xact.h>
+#include <catalog/pg_class.h>
+#include <miscadmin.h>
+#include <pgstat.h>
+#include <postmaster/bgworker.h>
+#include <storage/bufmgr.h>
+#include <tcop/tcopprot.h>
+#include <utils/memutils.h>
+#include <utils/rel.h>
+#include <utils/snapmgr.h>
+
+#include "prewarm.h"
+#include "chunk.h"
+#include "debug_assert.h"
+#include "dimension.h"
+#include "dimension_slice.h"
+#include "extension.h"
+#include "guc.h"
+#include "hypercube.h"
+#include "hypertable.h"
+#include "ts_catalog/continuous_agg.h"
+#include "worker.h"
+
+TS_FUNCTION_INFO_V1(ts_bgw_prewarm_worker_main);
+
+static int
+prewarm_chunk_cmp(const ListCell *a, const ListCell *b)
+{
+	const PrewarmChunk *left = lfirst(a);
+	const PrewarmChunk *right = lfirst(b);
+
+	if (left->rank != right->rank)
+		return left->rank < right->rank ? -1 : 1;
+
+	if (left->hypertable_index != right->hypertable_index)
+		return left->hypertable_index < right->hypertable_index ? -1 : 1;
+
+	return 0;
+}
+
+/*
+ * Get the chunks of the hypertable in its num_chunks latest slices of the
+ * primary dimension.
+ */
+static List *
+get_recent_chunks(List *chunks, const Hypertable *ht, int hypertable_index, int num_chunks,
+				  MemoryContext mcxt)
+{
+	const Dimension *dim = hyperspace_get_open_dimension(ht->space, 0);
+	int64 *starts;
+	int num_slices = 0;
+	ListCell *lc;
+
+	if (dim == NULL || hypertable_is_distributed(ht))
+		return chunks;
+
+	starts = palloc(sizeof(int64) * num_chunks);
+
+	for (int n = 1; n <= num_chunks; n++)
+	{
+		DimensionSlice *slice = ts_dimension_slice_nth_latest_slice(dim->fd.id, n);
+
+		if (slice == NULL)
+			break;
+
+		starts[num_slices++] = slice->fd.range_start;
+	}
+
+	foreach (lc, ts_chunk_get_chunk_ids_by_hypertable_id(ht->fd.id))
+	{
+		Chunk *chunk = ts_chunk_get_by_id(lfirst_int(lc), false);
+		const DimensionSlice *slice;
+		PrewarmChunk *entry;
+		MemoryContext oldcontext;
+		int rank = 0;
+
+		if (chunk == NULL || chunk->fd.dropped || IS_OSM_CHUNK(chunk) ||
+			chunk->relkind != RELKIND_RELATION)
+			continue;
+
+		slice = ts_hypercube_get_slice_by_dimension_id(chunk->cube, dim->fd.id);
+		if (slice == NULL)
+			continue;
+
+		/* The slices are ordered from the newest */
+		while (rank < num_slices && slice->fd.range_start < starts[rank])
+			rank++;
+
+		if (rank == num_slices)
+			continue;
+
+		oldcontext = MemoryContextSwitchTo(mcxt);
+		entry = palloc(sizeof(PrewarmChunk));
+		entry->rank = rank;
+		entry->hypertable_index = hypertable_index;
+		entry->relid = chunk->table_id;
+		entry->compressed_relid = ts_chunk_is_compressed(chunk) ?
+									  ts_chunk_get_relid(chunk->fd.compressed_chunk_id, true) :
+									  InvalidOid;
+		chunks = lappend(chunks, entry);
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	pfree(starts);
+
+	return chunks;
+}
+
+/*
+ * Read the main fork of a relation into the shared buffers, from its end,
+ * until the budget is used. Returns the number of blocks read.
+ */
+static int64
+prewarm_fork(Relation rel, int64 budget)
+{
+	BlockNumber block = RelationGetNumberOfBlocksInFork(rel, MAIN_FORKNUM);
+	int64 blocks = 0;
+
+	while (block > 0 && blocks < budget)
+	{
+		Buffer buf;
+
+		CHECK_FOR_INTERRUPTS();
+
+		buf = ReadBufferExtended(rel, MAIN_FORKNUM, --block, RBM_NORMAL, NULL);
+		ReleaseBuffer(buf);
+		blocks++;
+	}
+
+	return blocks;
+}
+
+/*
+ * Read a table, its indexes and its TOAST table into the shared buffers,
+ * until the budget is used. Returns the number of blocks read.
+ */
+static int64
+prewarm_table(Oid relid, int64 budget)
+{
+	Relation rel = try_relation_open(relid, AccessShareLock);
+	int64 blocks = 0;
+	ListCell *lc;
+
+	/* The chunk might have been dropped in the meantime */
+	if (rel == NULL)
+		return 0;
+
+	foreach (lc, RelationGetIndexList(rel))
+	{
+		Relation index_rel = try_relation_open(lfirst_oid(lc), AccessShareLock);
+
+		if (index_rel == NULL)
+			continue;
+
+		blocks += prewarm_fork(index_rel, budget - blocks);
+		relation_close(index_rel, AccessShareLock);
+	}
+
+	blocks += prewarm_fork(rel, budget - blocks);
+
+	if (OidIsValid(rel->rd_rel->reltoastrelid))
+		blocks += prewarm_table(rel->rd_rel->reltoastrelid, budget - blocks);
+
+	relation_close(rel, AccessShareLock);
+
+	return blocks;
+}
+
+/*
+ * Get the chunks to prewarm, in the order they are read: the num_chunks latest
+ * chunks of each hypertable and continuous aggregate, the newest chunk of every
+ * hypertable first. Has to run in a transaction.
+ */
+List *
+ts_bgw_prewarm_get_recent_chunks(int num_chunks, MemoryContext mcxt)
+{
+	List *chunks = NIL;
+	List *hypertables;
+	ListCell *lc;
+
+	if (!ts_extension_is_loaded())
+		return NIL;
+
+	hypertables = ts_hypertable_get_all();
+
+	/* The hypertables of the continuous aggregates are added to the end of the list */
+	for (int i = 0; i < list_length(hypertables); i++)
+	{
+		Hypertable *ht = list_nth(hypertables, i);
+
+		foreach (lc, ts_continuous_aggs_find_by_raw_table_id(ht->fd.id))
+		{
+			ContinuousAgg *cagg = lfirst(lc);
+			Hypertable *mat_ht = ts_hypertable_get_by_id(cagg->data.mat_hypertable_id);
+
+			if (mat_ht != NULL)
+				hypertables = lappend(hypertables, mat_ht);
+		}
+
+		chunks = get_recent_chunks(chunks, ht, i, num_chunks, mcxt);
+	}
+
+	list_sort(chunks, prewarm_chunk_cmp);
+
+	return chunks;
+}
+
+/*
+ * Read a chunk, and its compressed chunk when it has one, into the shared
+ * buffers until the budget is used. Returns the number of blocks read.
+ */
+int64
+ts_bgw_prewarm_chunk(const PrewarmChunk *chunk, int64 budget)
+{
+	int64 blocks = prewarm_table(chunk->relid, budget);
+
+	if (OidIsValid(chunk->compressed_relid))
+		blocks += prewarm_table(chunk->compressed_relid, budget - blocks);
+
+	return blocks;
+}
+
+static void
+prewarm_recent_chunks(void)
+{
+	MemoryContext mcxt =
+		AllocSetContextCreate(TopMemoryContext, "PrewarmChunks", ALLOCSET_DEFAULT_SIZES);
+	int64 budget = ts_guc_prewarm_memory_limit >= 0 ? ts_guc_prewarm_memory_limit : NBuffers / 4;
+	int64 blocks = 0;
+	int num_chunks = 0;
+	List *chunks;
+	ListCell *lc;
+
+	StartTransactionCommand();
+	PushActiveSnapshot(GetTransactionSnapshot());
+	chunks = ts_bgw_prewarm_get_recent_chunks(ts_guc_prewarm_recent_chunks, mcxt);
+	PopActiveSnapshot();
+	CommitTransactionCommand();
+
+	foreach (lc, chunks)
+	{
+		if (blocks >= budget)
+			break;
+
+		StartTransactionCommand();
+		blocks += ts_bgw_prewarm_chunk(lfirst(lc), budget - blocks);
+		CommitTransactionCommand();
+
+		num_chunks++;
+	}
+
+	elog(LOG,
+		 "prewarmed %d of %d recent chunks (" INT64_FORMAT " blocks)",
+		 num_chunks,
+		 list_length(chunks),
+		 blocks);
+
+	MemoryContextDelete(mcxt);
+}
+
+extern Datum
+ts_bgw_prewarm_worker_main(PG_FUNCTION_ARGS)
+{
+	Oid db_oid = DatumGetObjectId(MyBgworkerEntry->bgw_main_arg);
+	BgwParams params;
+
+	memcpy(&params, MyBgworkerEntry->bgw_extra, sizeof(BgwParams));
+	Ensure(params.user_oid != 0, "user oid was zero for prewarm worker");
+
+	BackgroundWorkerBlockSignals();
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	BackgroundWorkerInitializeConnectionByOid(db_oid, params.user_oid, 0);
+
+	pgstat_report_appname(PREWARM_WORKER_NAME);
+
+	prewarm_recent_chunks();
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,34 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef BGW_PREWARM_H
+#define BGW_PREWARM_H
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <nodes/pg_list.h>
+
+#include "export.h"
+
+#define PREWARM_WORKER_NAME "TimescaleDB Prewarm Worker"
+#define PREWARM_WORKER_MAIN "ts_bgw_prewarm_worker_main"
+
+typedef struct PrewarmChunk
+{
+	/* The newest chunks of a hypertable have rank 0, the next newest rank 1 */
+	int rank;
+	/* The position of the hypertable, to keep the order within a rank */
+	int hypertable_index;
+	Oid relid;
+	Oid compressed_relid;
+} PrewarmChunk;
+
+extern TSDLLEXPORT List *ts_bgw_prewarm_get_recent_chunks(int num_chunks, MemoryContext mcxt);
+extern TSDLLEXPORT int64 ts_bgw_prewarm_chunk(const PrewarmChunk *chunk, int64 budget);
+
+/* Entrypoint of the worker that the scheduler starts to prewarm the recent chunks */
+extern TSDLLEXPORT Datum ts_bgw_prewarm_worker_main(PG_FUNCTION_ARGS);
+
+#endif /* BGW_PREWARM_H */
@@ -12,6 +12,7 @@
  */
 #include <postgres.h>
 
+#include <lib/binaryheap.h>
 #include <miscadmin.h>
 #include <postmaster/bgworker.h>
 #include <storage/ipc.h>
@@ -36,10 +37,12 @@
 #include "job.h"
 #include "job_stat.h"
 #include "launcher_interface.h"
+#include "prewarm.h"
 #include "scheduler.h"
 #include "timer.h"
 #include "version.h"
 #include "worker.h"
+#include "worker_pool.h"
 
 #define START_RETRY_MS (1 * INT64CONST(1000)) /* 1 seconds */
 
@@ -63,6 +66,9 @@ static List *scheduled_jobs = NIL;
 static MemoryContext scheduler_mctx;
 static MemoryContext scratch_mctx;
 
+/* The worker that prewarms the recent chunks when the scheduler starts */
+static BackgroundWorkerHandle *prewarm_worker = NULL;
+
 /* See the README for a state transition diagram */
 typedef enum JobState
 {
@@ -90,15 +96,36 @@ typedef enum JobState
 	JOB_STATE_TERMINATING
 } JobState;
 
+/*
+ * Classes of jobs, in the order in which the due jobs are started when
+ * timescaledb.enable_job_prioritization is on. Continuous aggregate refreshes
+ * keep the dashboards up to date and go first, retention only drops chunks,
+ * and reorder and compression rewrite whole chunks and go last.
+ */
+typedef enum JobClass
+{
+	JOB_CLASS_REFRESH,
+	JOB_CLASS_RETENTION,
+	JOB_CLASS_OTHER,
+	JOB_CLASS_REORDER,
+	JOB_CLASS_COMPRESSION,
+	_JOB_CLASS_MAX,
+} JobClass;
+
 typedef struct ScheduledBgwJob
 {
 	BgwJob job;
+	JobClass job_class;
+	/* Average runtime of the job in microseconds, or 0 if it has not run yet */
+	int64 estimated_runtime;
 	TimestampTz next_start;
 	TimestampTz timeout_at;
 	JobState state;
 	BackgroundWorkerHandle *handle;
-
 	bool reserved_worker;
+	/* The job runs on the worker pool slot pool_slot */
+	bool pooled_worker;
+	int pool_slot;
 
 	/*
 	 * We say "may" here since under normal circumstances the job itself will
@@ -112,6 +139,159 @@ static void on_failure_to_start_job(ScheduledBgwJob *sjob);
 
 static volatile sig_atomic_t got_SIGHUP = false;
 
+/*
+ * Queues of the scheduled jobs ordered by next_start and of the started jobs
+ * ordered by timeout, so that the scheduler loop does not have to sort or scan
+ * all the jobs to find the jobs to start and the next time to wake up.
+ *
+ * The queues are min-heaps that are updated on the state transitions of the
+ * jobs. Instead of removing or updating an entry when the job changes, a new
+ * entry is added and the stale entry is skipped when it reaches the top of
+ * the queue, i.e., an entry is only valid if the job is still in the state and
+ * has the key of the entry. The queues are rebuilt when the jobs list is
+ * updated, since the entries point to the jobs in the list.
+ */
+typedef struct JobQueueEntry
+{
+	ScheduledBgwJob *sjob;
+	int32 job_id;
+	TimestampTz key;
+} JobQueueEntry;
+
+#define JOB_QUEUE_INIT_SIZE 64
+
+static MemoryContext job_queue_mctx = NULL;
+static binaryheap *start_queue = NULL;
+static binaryheap *timeout_queue = NULL;
+
+static int
+job_queue_entry_cmp(Datum left, Datum right, void *arg)
+{
+	const JobQueueEntry *left_entry = (const JobQueueEntry *) DatumGetPointer(left);
+	const JobQueueEntry *right_entry = (const JobQueueEntry *) DatumGetPointer(right);
+
+	/* The binary heap is a max-heap, so invert the order to get the earliest key first */
+	if (left_entry->key < right_entry->key)
+		return 1;
+	if (left_entry->key > right_entry->key)
+		return -1;
+
+	/* Start the jobs with the same next_start in the order of their ID */
+	if (left_entry->job_id < right_entry->job_id)
+		return 1;
+	if (left_entry->job_id > right_entry->job_id)
+		return -1;
+
+	return 0;
+}
+
+static binaryheap *
+job_queue_allocate(int capacity)
+{
+	MemoryContext oldcontext;
+	binaryheap *queue;
+
+	if (job_queue_mctx == NULL)
+		job_queue_mctx =
+			AllocSetContextCreate(TopMemoryContext, "BgwSchedulerJobQueue", ALLOCSET_DEFAULT_SIZES);
+
+	oldcontext = MemoryContextSwitchTo(job_queue_mctx);
+	queue = binaryheap_allocate(capacity, job_queue_entry_cmp, NULL);
+	MemoryContextSwitchTo(oldcontext);
+
+	return queue;
+}
+
+static void
+job_queue_add_entry(binaryheap **queue, JobQueueEntry *entry)
+{
+	/* The binary heap has a fixed capacity, so move the entries to a larger one */
+	if ((*queue)->bh_size >= (*queue)->bh_space)
+	{
+		binaryheap *larger_queue = job_queue_allocate((*queue)->bh_space * 2);
+
+		for (int i = 0; i < (*queue)->bh_size; i++)
+			binaryheap_add_unordered(larger_queue, (*queue)->bh_nodes[i]);
+
+		binaryheap_build(larger_queue);
+		binaryheap_free(*queue);
+		*queue = larger_queue;
+	}
+
+	binaryheap_add(*queue, PointerGetDatum(entry));
+}
+
+static void
+job_queue_add(binaryheap **queue, ScheduledBgwJob *sjob, TimestampTz key)
+{
+	JobQueueEntry *entry;
+
+	if (*queue == NULL)
+		*queue = job_queue_allocate(JOB_QUEUE_INIT_SIZE);
+
+	entry = MemoryContextAlloc(job_queue_mctx, sizeof(*entry));
+	entry->sjob = sjob;
+	entry->job_id = sjob->job.fd.id;
+	entry->key = key;
+	job_queue_add_entry(queue, entry);
+}
+
+static bool
+start_queue_entry_is_valid(const JobQueueEntry *entry)
+{
+	return entry->sjob->state == JOB_STATE_SCHEDULED && entry->sjob->next_start == entry->key;
+}
+
+static bool
+timeout_queue_entry_is_valid(const JobQueueEntry *entry)
+{
+	return entry->sjob->state == JOB_STATE_STARTED && entry->sjob->timeout_at == entry->key;
+}
+
+/*
+ * Get the first valid entry of a queue, removing the stale entries before it,
+ * or NULL if the queue has no valid entries.
+ */
+static JobQueueEntry *
+job_queue_first(binaryheap *queue, bool (*is_valid)(const JobQueueEntry *))
+{
+	while (queue != NULL && !binaryheap_empty(queue))
+	{
+		JobQueueEntry *entry = (JobQueueEntry *) DatumGetPointer(binaryheap_first(queue));
+
+		if (is_valid(entry))
+			return entry;
+
+		binaryheap_remove_first(queue);
+		pfree(entry);
+	}
+
+	return NULL;
+}
+
+/* Rebuild the queues from the jobs list */
+static void
+job_queues_rebuild(List *jobs)
+{
+	ListCell *lc;
+
+	if (job_queue_mctx != NULL)
+		MemoryContextReset(job_queue_mctx);
+
+	start_queue = NULL;
+	timeout_queue = NULL;
+
+	foreach (lc, jobs)
+	{
+		ScheduledBgwJob *sjob = lfirst(lc);
+
+		if (sjob->state == JOB_STATE_SCHEDULED)
+			job_queue_add(&start_queue, sjob, sjob->next_start);
+		else if (sjob->state == JOB_STATE_STARTED && sjob->timeout_at != DT_NOEND)
+			job_queue_add(&timeout_queue, sjob, sjob->timeout_at);
+	}
+}
+
 BackgroundWorkerHandle *
 ts_bgw_start_worker(const char *name, const BgwParams *bgw_params)
 {
@@ -179,7 +359,14 @@ worker_state_cleanup(ScheduledBgwJob *sjob)
 	 * This function needs to be safe wrt failures occurring at any point in
 	 * the job starting process.
 	 */
-	if (sjob->handle != NULL)
+	if (sjob->pooled_worker)
+	{
+		/* The pool owns the handle and keeps the worker for the next job */
+		ts_bgw_worker_pool_release_slot(sjob->pool_slot);
+		sjob->pooled_worker = false;
+		sjob->handle = NULL;
+	}
+	else if (sjob->handle != NULL)
 	{
 #ifdef USE_ASSERT_CHECKING
 		/* Sanity check: worker has stopped (if it was started) */
@@ -238,6 +425,44 @@ worker_state_cleanup(ScheduledBgwJob *sjob)
 	}
 }
 
+static JobClass
+get_job_class(const BgwJob *job)
+{
+	if (namestrcmp((Name) &job->fd.proc_schema, INTERNAL_SCHEMA_NAME) != 0)
+		return JOB_CLASS_OTHER;
+
+	if (namestrcmp((Name) &job->fd.proc_name, "policy_refresh_continuous_aggregate") == 0)
+		return JOB_CLASS_REFRESH;
+	if (namestrcmp((Name) &job->fd.proc_name, "policy_retention") == 0)
+		return JOB_CLASS_RETENTION;
+	if (namestrcmp((Name) &job->fd.proc_name, "policy_reorder") == 0)
+		return JOB_CLASS_REORDER;
+	if (namestrcmp((Name) &job->fd.proc_name, "policy_compression") == 0 ||
+		namestrcmp((Name) &job->fd.proc_name, "policy_recompression") == 0)
+		return JOB_CLASS_COMPRESSION;
+
+	return JOB_CLASS_OTHER;
+}
+
+/*
+ * Estimate the runtime of the next run of a job from the average duration of
+ * its previous runs.
+ */
+static int64
+get_estimated_runtime(const BgwJobStat *job_stat)
+{
+	const Interval *duration;
+
+	if (job_stat == NULL || job_stat->fd.total_runs <= 0)
+		return 0;
+
+	duration = &job_stat->fd.total_duration;
+
+	return (duration->time + duration->day * USECS_PER_DAY +
+			duration->month * DAYS_PER_MONTH * USECS_PER_DAY) /
+		   job_stat->fd.total_runs;
+}
+
 /* Set the state of the job.
  * This function is responsible for setting all of the variables in ScheduledBgwJob
  * except for the job itself.
@@ -264,9 +489,13 @@ scheduled_bgw_job_transition_state_to(ScheduledBgwJob *sjob, JobState new_state)
 
 			job_stat = ts_bgw_job_stat_find(sjob->job.fd.id);
 
+			sjob->job_class = get_job_class(&sjob->job);
+			sjob->estimated_runtime = get_estimated_runtime(job_stat);
+
 			Assert(!sjob->reserved_worker);
 			sjob->next_start =
 				ts_bgw_job_stat_next_start(job_stat, &sjob->job, sjob->consecutive_failed_launches);
+			job_queue_add(&start_queue, sjob, sjob->next_start);
 			break;
 		case JOB_STATE_STARTED:
 			Assert(prev_state == JOB_STATE_SCHEDULED);
@@ -320,7 +549,16 @@ scheduled_bgw_job_transition_state_to(ScheduledBgwJob *sjob, JobState new_state)
 				 sjob->job.fd.id,
 				 NameStr(sjob->job.fd.application_name));
 
-			sjob->handle = ts_bgw_job_start(&sjob->job, sjob->job.fd.owner);
+			/*
+			 * Run the job on a worker of the pool if there is one that can
+			 * take it, which is only possible after the start was marked.
+			 */
+			sjob->handle =
+				ts_bgw_worker_pool_start_job(&sjob->job, sjob->job.fd.owner, &sjob->pool_slot);
+			sjob->pooled_worker = sjob->handle != NULL;
+
+			if (sjob->handle == NULL)
+				sjob->handle = ts_bgw_job_start(&sjob->job, sjob->job.fd.owner);
 			if (sjob->handle == NULL)
 			{
 				elog(WARNING,
@@ -331,6 +569,9 @@ scheduled_bgw_job_transition_state_to(ScheduledBgwJob *sjob, JobState new_state)
 				return;
 			}
 			Assert(sjob->reserved_worker);
+
+			if (sjob->timeout_at != DT_NOEND)
+				job_queue_add(&timeout_queue, sjob, sjob->timeout_at);
 			break;
 		case JOB_STATE_TERMINATING:
 			Assert(prev_state == JOB_STATE_STARTED);
@@ -466,6 +707,8 @@ ts_update_scheduled_jobs_list(List *cur_jobs_list, MemoryContext mctx)
 		}
 		if (cur_sjob->job.fd.id == new_sjob->job.fd.id)
 		{
+			bool job_changed = cur_sjob->job.xmin != new_sjob->job.xmin;
+
 			/*
 			 * Then this job already exists. Copy over any state and advance
 			 * both pointers.
@@ -473,8 +716,13 @@ ts_update_scheduled_jobs_list(List *cur_jobs_list, MemoryContext mctx)
 			cur_sjob->job = new_sjob->job;
 			*new_sjob = *cur_sjob;
 
-			/* reload the scheduling information from the job_stats */
-			if (cur_sjob->state == JOB_STATE_SCHEDULED)
+			/*
+			 * Reload the scheduling information from the job_stats if the job
+			 * was altered. A job whose catalog tuple has not changed since the
+			 * last update keeps its state, so that a change of one job does
+			 * not cause a job_stats lookup for every scheduled job.
+			 */
+			if (cur_sjob->state == JOB_STATE_SCHEDULED && job_changed)
 				scheduled_bgw_job_transition_state_to(new_sjob, JOB_STATE_SCHEDULED);
 
 			cur_ptr = lnext(cur_jobs_list, cur_ptr);
@@ -511,8 +759,9 @@ ts_update_scheduled_jobs_list(List *cur_jobs_list, MemoryContext mctx)
 			scheduled_bgw_job_transition_state_to(lfirst(ptr), JOB_STATE_SCHEDULED);
 	}
 
-	/* Free the old list */
+	/* Free the old list, which the entries of the queues can point to */
 	list_free_deep(cur_jobs_list);
+	job_queues_rebuild(new_jobs);
 	return new_jobs;
 }
 
@@ -550,55 +799,126 @@ cmp_next_start(const ListCell *left_cell, const ListCell *right_cell)
 	if (left_sjob->next_start > right_sjob->next_start)
 		return 1;
 
+	if (left_sjob->job.fd.id != right_sjob->job.fd.id)
+		return left_sjob->job.fd.id < right_sjob->job.fd.id ? -1 : 1;
+
 	return 0;
 }
 
+/*
+ * Order the jobs by job class and then by estimated runtime, so that the
+ * cheap jobs of a class go first, and then by next_start. Only the order of
+ * the jobs that are due matters, since the others are not started.
+ */
+static int
+cmp_priority(const ListCell *left_cell, const ListCell *right_cell)
+{
+	ScheduledBgwJob *left_sjob = lfirst(left_cell);
+	ScheduledBgwJob *right_sjob = lfirst(right_cell);
+
+	if (left_sjob->job_class != right_sjob->job_class)
+		return left_sjob->job_class < right_sjob->job_class ? -1 : 1;
+
+	if (left_sjob->estimated_runtime != right_sjob->estimated_runtime)
+		return left_sjob->estimated_runtime < right_sjob->estimated_runtime ? -1 : 1;
+
+	return cmp_next_start(left_cell, right_cell);
+}
+
 static void
 start_scheduled_jobs(register_background_worker_callback_type bgw_register)
 {
-	List *ordered_scheduled_jobs;
+	List *due_jobs = NIL;
 	ListCell *lc;
+	int running_jobs[_JOB_CLASS_MAX] = { 0 };
+	TimestampTz now = ts_timer_get_current_timestamp();
+	JobQueueEntry *entry;
 	Assert(CurrentMemoryContext == scratch_mctx);
 
-	/* Order jobs by increasing next_start */
-	/* list_sort does in-place sort - so make a copy and sort that */
-	ordered_scheduled_jobs = list_copy(scheduled_jobs);
-	list_sort(ordered_scheduled_jobs, cmp_next_start);
+	/* Take the jobs that are due from the queue, in the order of next_start */
+	while ((entry = job_queue_first(start_queue, start_queue_entry_is_valid)) != NULL &&
+		   entry->key <= now)
+	{
+		binaryheap_remove_first(start_queue);
+		due_jobs = lappend(due_jobs, entry->sjob);
+		pfree(entry);
+	}
+
+	if (due_jobs == NIL)
+		return;
+
+	if (ts_guc_enable_job_prioritization)
+		list_sort(due_jobs, cmp_priority);
+
+	if (ts_guc_max_concurrent_jobs_per_class > 0)
+	{
+		foreach (lc, scheduled_jobs)
+		{
+			ScheduledBgwJob *sjob = lfirst(lc);
+
+			if (sjob->state == JOB_STATE_STARTED || sjob->state == JOB_STATE_TERMINATING)
+				running_jobs[sjob->job_class]++;
+		}
+	}
 
-	foreach (lc, ordered_scheduled_jobs)
+	foreach (lc, due_jobs)
 	{
 		ScheduledBgwJob *sjob = lfirst(lc);
 
-		if (sjob->state == JOB_STATE_SCHEDULED &&
-			sjob->next_start <= ts_timer_get_current_timestamp())
-			scheduled_ts_bgw_job_start(sjob, bgw_register);
+		if (sjob->state != JOB_STATE_SCHEDULED)
+			continue;
+
+		/*
+		 * Leave the job scheduled if its class already runs the maximum
+		 * number of jobs. It is started once a job of the class has finished.
+		 */
+		if (ts_guc_max_concurrent_jobs_per_class > 0 &&
+			running_jobs[sjob->job_class] >= ts_guc_max_concurrent_jobs_per_class)
+		{
+			job_queue_add(&start_queue, sjob, sjob->next_start);
+			continue;
+		}
+
+		scheduled_ts_bgw_job_start(sjob, bgw_register);
+
+		if (sjob->state == JOB_STATE_STARTED)
+			running_jobs[sjob->job_class]++;
 	}
 
-	list_free(ordered_scheduled_jobs);
+	list_free(due_jobs);
 }
 
 /* Returns the earliest time the scheduler should start a job that is waiting to be started */
 static TimestampTz
 earliest_wakeup_to_start_next_job()
 {
-	ListCell *lc;
 	TimestampTz earliest = DT_NOEND;
 	TimestampTz now = ts_timer_get_current_timestamp();
+	List *past_entries = NIL;
+	JobQueueEntry *entry;
+	ListCell *lc;
 
-	foreach (lc, scheduled_jobs)
+	/*
+	 * If the start is less than now, this means we tried and failed to start
+	 * the job already, so use the retry period. Those jobs are at the top of
+	 * the queue, so set them aside to find the first job that starts later.
+	 */
+	while ((entry = job_queue_first(start_queue, start_queue_entry_is_valid)) != NULL &&
+		   entry->key < now)
 	{
-		ScheduledBgwJob *sjob = lfirst(lc);
-
-		if (sjob->state == JOB_STATE_SCHEDULED)
-		{
-			TimestampTz start = sjob->next_start;
-			/* if the start is less than now, this means we tried and failed to start it already, so
-			 * use the retry period */
-			if (start < now)
-				start = TimestampTzPlusMilliseconds(now, START_RETRY_MS);
-			earliest = least_timestamp(earliest, start);
-		}
+		binaryheap_remove_first(start_queue);
+		past_entries = lappend(past_entries, entry);
+		earliest = TimestampTzPlusMilliseconds(now, START_RETRY_MS);
 	}
+
+	if (entry != NULL)
+		earliest = least_timestamp(earliest, entry->key);
+
+	foreach (lc, past_entries)
+		job_queue_add_entry(&start_queue, lfirst(lc));
+
+	list_free(past_entries);
+
 	return earliest;
 }
 
@@ -606,17 +926,10 @@ earliest_wakeup_to_start_next_job()
 static TimestampTz
 earliest_job_timeout()
 {
-	ListCell *lc;
-	TimestampTz earliest = DT_NOEND;
+	JobQueueEntry *entry = job_queue_first(timeout_queue, timeout_queue_entry_is_valid);
 
-	foreach (lc, scheduled_jobs)
-	{
-		ScheduledBgwJob *sjob = lfirst(lc);
-
-		if (sjob->state == JOB_STATE_STARTED)
-			earliest = least_timestamp(earliest, sjob->timeout_at);
-	}
-	return earliest;
+	/* Jobs without a timeout are not in the queue */
+	return entry != NULL ? entry->key : DT_NOEND;
 }
 
 /* Special exit function only used in shmem_exit_callback.
@@ -648,6 +961,45 @@ terminate_all_jobs_and_release_workers()
 			sjob->reserved_worker = false;
 		}
 	}
+
+	ts_bgw_worker_pool_terminate_all();
+
+	if (prewarm_worker != NULL)
+	{
+		TerminateBackgroundWorker(prewarm_worker);
+		ts_bgw_worker_release();
+		prewarm_worker = NULL;
+	}
+}
+
+static void
+start_prewarm_worker(void)
+{
+	BgwParams params = {
+		.user_oid = GetUserId(),
+	};
+
+	if (ts_guc_prewarm_recent_chunks <= 0 || !ts_bgw_worker_reserve())
+		return;
+
+	strlcpy(params.bgw_main, PREWARM_WORKER_MAIN, sizeof(params.bgw_main));
+	prewarm_worker = ts_bgw_start_worker(PREWARM_WORKER_NAME, &params);
+
+	if (prewarm_worker == NULL)
+		ts_bgw_worker_release();
+}
+
+static void
+check_for_stopped_prewarm_worker(void)
+{
+	pid_t pid;
+
+	if (prewarm_worker == NULL || GetBackgroundWorkerPid(prewarm_worker, &pid) != BGWH_STOPPED)
+		return;
+
+	ts_bgw_worker_release();
+	pfree(prewarm_worker);
+	prewarm_worker = NULL;
 }
 
 static void
@@ -659,7 +1011,13 @@ wait_for_all_jobs_to_shutdown()
 	{
 		ScheduledBgwJob *sjob = lfirst(lc);
 
-		if (sjob->state == JOB_STATE_STARTED || sjob->state == JOB_STATE_TERMINATING)
+		if (sjob->state != JOB_STATE_STARTED && sjob->state != JOB_STATE_TERMINATING)
+			continue;
+
+		/* A pooled worker does not stop when its job has finished */
+		if (sjob->pooled_worker)
+			ts_bgw_worker_pool_wait_for_job(sjob->pool_slot);
+		else
 			WaitForBackgroundWorkerShutdown(sjob->handle);
 	}
 }
@@ -681,6 +1039,11 @@ check_for_stopped_and_timed_out_jobs()
 
 		status = GetBackgroundWorkerPid(sjob->handle, &pid);
 
+		/* A pooled worker that has finished its job is handled like a stopped worker */
+		if (status == BGWH_STARTED && sjob->pooled_worker &&
+			ts_bgw_worker_pool_job_finished(sjob->pool_slot))
+			status = BGWH_STOPPED;
+
 		switch (status)
 		{
 			case BGWH_POSTMASTER_DIED:
@@ -794,6 +1157,7 @@ ts_bgw_scheduler_process(int32 run_for_interval_ms,
 		}
 
 		check_for_stopped_and_timed_out_jobs();
+		check_for_stopped_prewarm_worker();
 
 		MemoryContextReset(scratch_mctx);
 	}
@@ -879,6 +1243,8 @@ ts_bgw_scheduler_main(PG_FUNCTION_ARGS)
 
 	ts_bgw_scheduler_setup_mctx();
 
+	start_prewarm_worker();
+
 	ts_bgw_scheduler_process(-1, NULL);
 
 	Assert(scheduled_jobs == NIL);
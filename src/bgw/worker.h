@@ -10,6 +10,7 @@
 #include <postgres.h>
 
 #include <postmaster/bgworker.h>
+#include <storage/dsm.h>
 
 /**
  * Parameters to background workers.
@@ -26,6 +27,9 @@
  *
  * @see ts_bgw_db_scheduler_test_main
  * @see ts_bgw_job_entrypoint
+ * @see ts_bgw_worker_pool_main
+ * @see ts_bgw_compression_worker_main
+ * @see ts_bgw_chunk_index_worker_main
  */
 typedef struct BgwParams
 {
@@ -39,6 +43,13 @@ typedef struct BgwParams
 	/** Time to live. Only used in tests. */
 	int32 ttl;
 
+	/** Dynamic shared memory segment of the pooled workers, the compression
+	 * workers and the chunk index workers. */
+	dsm_handle segment_handle;
+
+	/** Slot of the worker in the worker pool. Only used by pooled workers. */
+	int32 pool_slot;
+
 	/** Name of function to call when starting the background worker. */
 	char bgw_main[BGW_MAXLEN];
 } BgwParams;
@@ -0,0 +1,492 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+/*
+ * A pool of background workers that run the jobs of a scheduler.
+ *
+ * Starting a background worker for every job run means starting a process,
+ * connecting to the database and loading the catalog caches, which for small
+ * and frequent jobs can take longer than the job itself. When the pool is
+ * enabled, a worker stays around after its job has finished and waits, for up
+ * to timescaledb.job_worker_pool_idle_timeout, for the scheduler to hand it
+ * the next job. A worker is connected to the database as the owner of its
+ * first job, so it only runs jobs of that owner.
+ *
+ * The scheduler and the workers share an array of slots, one per worker, in a
+ * dynamic shared memory segment. The state of a slot moves as follows:
+ *
+ *   FREE -> RUNNING: the scheduler starts a worker with a job
+ *   IDLE -> RUNNING: the scheduler hands a job to an idle worker
+ *   RUNNING -> DONE: the worker has finished the job
+ *   DONE -> IDLE: the scheduler has handled the end of the job
+ *   IDLE -> EXITING: the worker timed out waiting for a job
+ *
+ * and back to FREE when the scheduler notices that the worker has stopped.
+ * The scheduler treats a job on a pooled worker like any other job, except
+ * that the job has ended when its slot is DONE rather than when its worker
+ * stops. A job that fails or times out still takes its worker with it.
+ */
+#include <postgres.h>
+#include <miscadmin.h>
+#include <pgstat.h>
+#include <postmaster/bgworker.h>
+#include <postmaster/interrupt.h>
+#include <storage/dsm.h>
+#include <storage/latch.h>
+#include <storage/proc.h>
+#include <storage/shmem.h>
+#include <storage/spin.h>
+#include <tcop/tcopprot.h>
+#include <utils/guc.h>
+#include <utils/memutils.h>
+
+#include "worker_pool.h"
+#include "debug_assert.h"
+#include "guc.h"
+#include "license_guc.h"
+#include "scheduler.h"
+#include "worker.h"
+
+#define POOL_WORKER_NAME "TimescaleDB Job Pool Worker"
+
+TS_FUNCTION_INFO_V1(ts_bgw_worker_pool_main);
+
+typedef enum PoolSlotState
+{
+	POOL_SLOT_FREE,
+	POOL_SLOT_IDLE,
+	POOL_SLOT_RUNNING,
+	POOL_SLOT_DONE,
+	POOL_SLOT_EXITING,
+} PoolSlotState;
+
+typedef struct PoolSlot
+{
+	slock_t mutex;
+	PoolSlotState state;
+	/* Job that the worker runs or has run last */
+	int32 job_id;
+	/* User that the worker is connected as */
+	Oid user_oid;
+	/* Process of the worker, set when the worker has started */
+	PGPROC *proc;
+} PoolSlot;
+
+typedef struct BgwWorkerPool
+{
+	/* The scheduler, which the workers wake up when they finish a job */
+	PGPROC *scheduler;
+	int num_slots;
+	PoolSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} BgwWorkerPool;
+
+/* The state of the workers that only the scheduler knows about */
+typedef struct PoolWorker
+{
+	BackgroundWorkerHandle *handle;
+	/* The worker runs a job of the scheduler, or has not been released */
+	bool in_use;
+} PoolWorker;
+
+static char *pool_worker_main_function_name = "ts_bgw_worker_pool_main";
+static dsm_segment *pool_segment = NULL;
+static BgwWorkerPool *pool = NULL;
+static PoolWorker *pool_workers = NULL;
+
+static bool
+worker_pool_create(void)
+{
+	int num_slots = ts_guc_job_worker_pool_size;
+	Size size = add_size(offsetof(BgwWorkerPool, slots), mul_size(num_slots, sizeof(PoolSlot)));
+
+	pool_segment = dsm_create(size, DSM_CREATE_NULL_IF_MAXSEGMENTS);
+
+	if (pool_segment == NULL)
+	{
+		elog(LOG, "could not create the shared memory of the job worker pool");
+		return false;
+	}
+
+	/* Keep the segment mapped until the scheduler exits */
+	dsm_pin_mapping(pool_segment);
+
+	pool = dsm_segment_address(pool_segment);
+	pool->scheduler = MyProc;
+	pool->num_slots = num_slots;
+
+	for (int i = 0; i < num_slots; i++)
+	{
+		PoolSlot *slot = &pool->slots[i];
+
+		SpinLockInit(&slot->mutex);
+		slot->state = POOL_SLOT_FREE;
+		slot->job_id = 0;
+		slot->user_oid = InvalidOid;
+		slot->proc = NULL;
+	}
+
+	pool_workers = MemoryContextAllocZero(TopMemoryContext, sizeof(PoolWorker) * num_slots);
+
+	return true;
+}
+
+static bool
+pool_worker_has_stopped(const PoolWorker *worker)
+{
+	pid_t pid;
+	BgwHandleStatus status = GetBackgroundWorkerPid(worker->handle, &pid);
+
+	return status == BGWH_STOPPED || status == BGWH_POSTMASTER_DIED;
+}
+
+static void
+pool_worker_free(int slotno)
+{
+	PoolSlot *slot = &pool->slots[slotno];
+	PoolWorker *worker = &pool_workers[slotno];
+
+	pfree(worker->handle);
+	worker->handle = NULL;
+
+	SpinLockAcquire(&slot->mutex);
+	slot->state = POOL_SLOT_FREE;
+	slot->job_id = 0;
+	slot->user_oid = InvalidOid;
+	slot->proc = NULL;
+	SpinLockRelease(&slot->mutex);
+}
+
+static BackgroundWorkerHandle *
+pool_worker_start(int slotno, BgwJob *job, Oid user_oid)
+{
+	PoolSlot *slot = &pool->slots[slotno];
+	PoolWorker *worker = &pool_workers[slotno];
+	BgwParams bgw_params = {
+		.job_id = job->fd.id,
+		.user_oid = user_oid,
+		.segment_handle = dsm_segment_handle(pool_segment),
+		.pool_slot = slotno,
+	};
+
+	strlcpy(bgw_params.bgw_main, pool_worker_main_function_name, sizeof(bgw_params.bgw_main));
+
+	SpinLockAcquire(&slot->mutex);
+	slot->state = POOL_SLOT_RUNNING;
+	slot->job_id = job->fd.id;
+	slot->user_oid = user_oid;
+	slot->proc = NULL;
+	SpinLockRelease(&slot->mutex);
+
+	worker->handle = ts_bgw_start_worker(POOL_WORKER_NAME, &bgw_params);
+
+	if (worker->handle == NULL)
+	{
+		SpinLockAcquire(&slot->mutex);
+		slot->state = POOL_SLOT_FREE;
+		SpinLockRelease(&slot->mutex);
+		return NULL;
+	}
+
+	worker->in_use = true;
+
+	return worker->handle;
+}
+
+/*
+ * Run a job on a worker of the pool, either an idle worker of the owner of the
+ * job or a new worker. Returns the handle of the worker and sets the slot of
+ * the worker, or returns NULL if the pool is disabled or has no room for the
+ * job, in which case the caller should start a worker for the job itself.
+ *
+ * The job has to be marked as started before it is handed to the worker.
+ */
+BackgroundWorkerHandle *
+ts_bgw_worker_pool_start_job(BgwJob *job, Oid user_oid, int *slotno)
+{
+	int num_slots;
+	int free_slot = -1;
+
+	*slotno = -1;
+
+	if (pool == NULL && (ts_guc_job_worker_pool_size <= 0 || !worker_pool_create()))
+		return NULL;
+
+	/* The pool cannot grow after it was created, but it can shrink */
+	num_slots = Min(pool->num_slots, ts_guc_job_worker_pool_size);
+
+	for (int i = 0; i < pool->num_slots; i++)
+	{
+		PoolSlot *slot = &pool->slots[i];
+		PoolWorker *worker = &pool_workers[i];
+		PGPROC *proc = NULL;
+
+		if (worker->in_use)
+			continue;
+
+		/* Clean up after the workers that have exited since the last time */
+		if (worker->handle != NULL && pool_worker_has_stopped(worker))
+			pool_worker_free(i);
+
+		if (i >= num_slots)
+			continue;
+
+		if (worker->handle == NULL)
+		{
+			if (free_slot < 0)
+				free_slot = i;
+			continue;
+		}
+
+		SpinLockAcquire(&slot->mutex);
+		if (slot->state == POOL_SLOT_IDLE && slot->user_oid == user_oid)
+		{
+			slot->state = POOL_SLOT_RUNNING;
+			slot->job_id = job->fd.id;
+			proc = slot->proc;
+		}
+		SpinLockRelease(&slot->mutex);
+
+		if (proc != NULL)
+		{
+			SetLatch(&proc->procLatch);
+			worker->in_use = true;
+			*slotno = i;
+			return worker->handle;
+		}
+	}
+
+	if (free_slot < 0)
+		return NULL;
+
+	if (pool_worker_start(free_slot, job, user_oid) == NULL)
+		return NULL;
+
+	*slotno = free_slot;
+	return pool_workers[free_slot].handle;
+}
+
+/* Check if the worker of the slot has finished its job */
+bool
+ts_bgw_worker_pool_job_finished(int slotno)
+{
+	PoolSlot *slot = &pool->slots[slotno];
+	bool finished;
+
+	Assert(pool_workers[slotno].in_use);
+
+	SpinLockAcquire(&slot->mutex);
+	finished = slot->state == POOL_SLOT_DONE;
+	SpinLockRelease(&slot->mutex);
+
+	return finished;
+}
+
+/* Wait until the worker of the slot has finished its job or has stopped */
+void
+ts_bgw_worker_pool_wait_for_job(int slotno)
+{
+	PoolWorker *worker = &pool_workers[slotno];
+
+	while (!ts_bgw_worker_pool_job_finished(slotno) && !pool_worker_has_stopped(worker))
+	{
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 1000L,
+						 PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+		CHECK_FOR_INTERRUPTS();
+	}
+}
+
+/*
+ * Wait until the worker of the handle has finished its job, if the worker is
+ * in the pool, or else until the worker has stopped.
+ */
+void
+ts_bgw_worker_pool_wait_for_worker(BackgroundWorkerHandle *handle)
+{
+	if (pool != NULL)
+	{
+		for (int i = 0; i < pool->num_slots; i++)
+		{
+			if (pool_workers[i].handle == handle)
+			{
+				if (pool_workers[i].in_use)
+					ts_bgw_worker_pool_wait_for_job(i);
+				return;
+			}
+		}
+	}
+
+	WaitForBackgroundWorkerShutdown(handle);
+}
+
+/*
+ * Release the worker of the slot after the end of its job was handled, so
+ * that it can run the next job. A worker that has not finished its job, e.g.,
+ * because the job is being deleted, is terminated.
+ */
+void
+ts_bgw_worker_pool_release_slot(int slotno)
+{
+	PoolSlot *slot = &pool->slots[slotno];
+	PoolWorker *worker = &pool_workers[slotno];
+	bool idle = false;
+
+	Assert(worker->in_use);
+	worker->in_use = false;
+
+	if (pool_worker_has_stopped(worker))
+	{
+		pool_worker_free(slotno);
+		return;
+	}
+
+	SpinLockAcquire(&slot->mutex);
+	if (slot->state == POOL_SLOT_DONE)
+	{
+		slot->state = POOL_SLOT_IDLE;
+		idle = true;
+	}
+	SpinLockRelease(&slot->mutex);
+
+	if (!idle)
+		TerminateBackgroundWorker(worker->handle);
+}
+
+/*
+ * Terminate all the workers of the pool when the scheduler exits. The workers
+ * that run a job are also terminated with the job.
+ */
+void
+ts_bgw_worker_pool_terminate_all(void)
+{
+	if (pool == NULL)
+		return;
+
+	for (int i = 0; i < pool->num_slots; i++)
+	{
+		if (pool_workers[i].handle != NULL)
+			TerminateBackgroundWorker(pool_workers[i].handle);
+	}
+}
+
+void
+ts_bgw_worker_pool_set_main_function_name(char *func_name)
+{
+	pool_worker_main_function_name = func_name;
+}
+
+/*
+ * Wait for the scheduler to hand the worker a new job. Returns the job id, or
+ * 0 if the worker timed out and should exit.
+ */
+static int32
+pool_worker_wait_for_job(PoolSlot *slot)
+{
+	bool timed_out = false;
+
+	pgstat_report_appname(POOL_WORKER_NAME);
+	pgstat_report_activity(STATE_IDLE, NULL);
+
+	for (;;)
+	{
+		int32 job_id = 0;
+		bool exiting = false;
+		int rc;
+
+		SpinLockAcquire(&slot->mutex);
+		if (slot->state == POOL_SLOT_RUNNING)
+			job_id = slot->job_id;
+		else if (timed_out && slot->state == POOL_SLOT_IDLE)
+		{
+			slot->state = POOL_SLOT_EXITING;
+			exiting = true;
+		}
+		SpinLockRelease(&slot->mutex);
+
+		if (job_id != 0 || exiting)
+			return job_id;
+
+		rc = WaitLatch(MyLatch,
+					   WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+					   ts_guc_job_worker_pool_idle_timeout,
+					   PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+		CHECK_FOR_INTERRUPTS();
+
+		if (ConfigReloadPending)
+		{
+			ConfigReloadPending = false;
+			ProcessConfigFile(PGC_SIGHUP);
+		}
+
+		timed_out = (rc & WL_TIMEOUT) != 0;
+	}
+}
+
+extern Datum
+ts_bgw_worker_pool_main(PG_FUNCTION_ARGS)
+{
+	Oid db_oid = DatumGetObjectId(MyBgworkerEntry->bgw_main_arg);
+	BgwParams params;
+	dsm_segment *segment;
+	BgwWorkerPool *shared_pool;
+	PoolSlot *slot;
+	int32 job_id;
+
+	memcpy(&params, MyBgworkerEntry->bgw_extra, sizeof(BgwParams));
+	Ensure(params.user_oid != 0 && params.job_id != 0,
+		   "job id or user oid was zero - job_id: %d, user_oid: %d",
+		   params.job_id,
+		   params.user_oid);
+
+	BackgroundWorkerBlockSignals();
+
+	/*
+	 * do not use the default `bgworker_die` sigterm handler because it does
+	 * not respect critical sections
+	 */
+	pqsignal(SIGTERM, die);
+	pqsignal(SIGHUP, SignalHandlerForConfigReload);
+	BackgroundWorkerUnblockSignals();
+
+	BackgroundWorkerInitializeConnectionByOid(db_oid, params.user_oid, 0);
+
+	ts_license_enable_module_loading();
+
+	segment = dsm_attach(params.segment_handle);
+	if (segment == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map the shared memory of the job worker pool")));
+	dsm_pin_mapping(segment);
+
+	shared_pool = dsm_segment_address(segment);
+	Ensure(params.pool_slot >= 0 && params.pool_slot < shared_pool->num_slots,
+		   "invalid job worker pool slot %d",
+		   params.pool_slot);
+	slot = &shared_pool->slots[params.pool_slot];
+
+	SpinLockAcquire(&slot->mutex);
+	slot->proc = MyProc;
+	SpinLockRelease(&slot->mutex);
+
+	job_id = params.job_id;
+
+	while (job_id != 0)
+	{
+		ts_bgw_job_run(job_id);
+
+		SpinLockAcquire(&slot->mutex);
+		slot->state = POOL_SLOT_DONE;
+		SpinLockRelease(&slot->mutex);
+		SetLatch(&shared_pool->scheduler->procLatch);
+
+		job_id = pool_worker_wait_for_job(slot);
+	}
+
+	PG_RETURN_VOID();
+}
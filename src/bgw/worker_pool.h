@@ -0,0 +1,31 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef BGW_WORKER_POOL_H
+#define BGW_WORKER_POOL_H
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <postmaster/bgworker.h>
+
+#include "export.h"
+#include "job.h"
+
+/* Used by the scheduler */
+extern BackgroundWorkerHandle *ts_bgw_worker_pool_start_job(BgwJob *job, Oid user_oid,
+															int *slotno);
+extern bool ts_bgw_worker_pool_job_finished(int slotno);
+extern void ts_bgw_worker_pool_wait_for_job(int slotno);
+extern void ts_bgw_worker_pool_release_slot(int slotno);
+extern void ts_bgw_worker_pool_terminate_all(void);
+
+/* Used by the test scheduler */
+extern void ts_bgw_worker_pool_wait_for_worker(BackgroundWorkerHandle *handle);
+extern void ts_bgw_worker_pool_set_main_function_name(char *func_name);
+
+/* Entrypoint of the pooled workers */
+extern TSDLLEXPORT Datum ts_bgw_worker_pool_main(PG_FUNCTION_ARGS);
+
+#endif /* BGW_WORKER_POOL_H */
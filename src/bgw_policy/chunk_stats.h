@@ -16,7 +16,8 @@ typedef struct BgwPolicyChunkStats
 } BgwPolicyChunkStats;
 
 extern TSDLLEXPORT void ts_bgw_policy_chunk_stats_insert(BgwPolicyChunkStats *chunk_stats);
-extern BgwPolicyChunkStats *ts_bgw_policy_chunk_stats_find(int32 job_id, int32 chunk_id);
+extern TSDLLEXPORT BgwPolicyChunkStats *ts_bgw_policy_chunk_stats_find(int32 job_id,
+																		int32 chunk_id);
 extern void ts_bgw_policy_chunk_stats_delete_row_only_by_job_id(int32 job_id);
 extern void ts_bgw_policy_chunk_stats_delete_by_chunk_id(int32 chunk_id);
 extern TSDLLEXPORT void ts_bgw_policy_chunk_stats_record_job_run(int32 job_id, int32 chunk_id,
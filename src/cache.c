@@ -10,17 +10,25 @@
 #include "cache.h"
 #include "compat/compat.h"
 
-/* List of pinned caches. A cache occurs once in this list for every pin
- * taken */
-static List *pinned_caches = NIL;
-static MemoryContext pinned_caches_mctx = NULL;
-
 typedef struct CachePin
 {
 	Cache *cache;
 	SubTransactionId subtxnid;
 } CachePin;
 
+/*
+ * Array of pinned caches. A cache occurs once in this array for every pin
+ * taken, in the order the pins were taken. Pins are typically released in
+ * the reverse order, so the array is used as a stack, which makes pinning and
+ * releasing cheap without allocating anything per pin.
+ */
+#define PINNED_CACHES_INITIAL_SIZE 16
+
+static CachePin *pinned_caches = NULL;
+static int num_pinned_caches = 0;
+static int max_pinned_caches = 0;
+static MemoryContext pinned_caches_mctx = NULL;
+
 static void
 cache_reset_pinned_caches(void)
 {
@@ -28,9 +36,12 @@ cache_reset_pinned_caches(void)
 		MemoryContextDelete(pinned_caches_mctx);
 
 	pinned_caches_mctx =
-		AllocSetContextCreate(CacheMemoryContext, "Cache pins", ALLOCSET_DEFAULT_SIZES);
+		AllocSetContextCreate(CacheMemoryContext, "Cache pins", ALLOCSET_SMALL_SIZES);
 
-	pinned_caches = NIL;
+	pinned_caches =
+		MemoryContextAlloc(pinned_caches_mctx, sizeof(CachePin) * PINNED_CACHES_INITIAL_SIZE);
+	num_pinned_caches = 0;
+	max_pinned_caches = PINNED_CACHES_INITIAL_SIZE;
 }
 
 void
@@ -97,14 +108,21 @@ ts_cache_invalidate(Cache *cache)
 Cache *
 ts_cache_pin(Cache *cache)
 {
-	MemoryContext old = MemoryContextSwitchTo(pinned_caches_mctx);
-	CachePin *cp = palloc(sizeof(CachePin));
-
-	cp->cache = cache;
-	cp->subtxnid = GetCurrentSubTransactionId();
 	if (cache->handle_txn_callbacks)
-		pinned_caches = lappend(pinned_caches, cp);
-	MemoryContextSwitchTo(old);
+	{
+		CachePin *cp;
+
+		if (num_pinned_caches == max_pinned_caches)
+		{
+			max_pinned_caches *= 2;
+			pinned_caches = repalloc(pinned_caches, sizeof(CachePin) * max_pinned_caches);
+		}
+
+		cp = &pinned_caches[num_pinned_caches++];
+		cp->cache = cache;
+		cp->subtxnid = GetCurrentSubTransactionId();
+	}
+
 	cache->refcount++;
 	return cache;
 }
@@ -112,16 +130,19 @@ ts_cache_pin(Cache *cache)
 static void
 remove_pin(Cache *cache, SubTransactionId subtxnid)
 {
-	ListCell *lc;
-
-	foreach (lc, pinned_caches)
+	/* Search from the top, since the latest pin is usually released first */
+	for (int i = num_pinned_caches - 1; i >= 0; i--)
 	{
-		CachePin *cp = lfirst(lc);
+		const CachePin *cp = &pinned_caches[i];
 
 		if (cp->cache == cache && cp->subtxnid == subtxnid)
 		{
-			pinned_caches = list_delete_cell(pinned_caches, lc);
-			pfree(cp);
+			/* Keep the order of the remaining pins */
+			num_pinned_caches--;
+			if (i < num_pinned_caches)
+				memmove(&pinned_caches[i],
+						&pinned_caches[i + 1],
+						sizeof(CachePin) * (num_pinned_caches - i));
 			return;
 		}
 	}
@@ -228,18 +249,16 @@ ts_cache_remove(Cache *cache, void *key)
 static void
 release_all_pinned_caches()
 {
-	ListCell *lc;
-
 	/*
-	 * release once for every occurrence of a cache in the pinned caches list.
+	 * release once for every occurrence of a cache in the pinned caches array.
 	 * On abort, release irrespective of cache->release_on_commit.
 	 */
-	foreach (lc, pinned_caches)
+	for (int i = 0; i < num_pinned_caches; i++)
 	{
-		CachePin *cp = lfirst(lc);
+		Cache *cache = pinned_caches[i].cache;
 
-		cp->cache->refcount--;
-		cache_destroy(cp->cache);
+		cache->refcount--;
+		cache_destroy(cache);
 	}
 
 	cache_reset_pinned_caches();
@@ -248,28 +267,22 @@ release_all_pinned_caches()
 static void
 release_subtxn_pinned_caches(SubTransactionId subtxnid, bool abort)
 {
-	ListCell *lc;
-
-	/* Need a copy because cache_release will modify pinned_caches */
-	List *pinned_caches_copy = list_copy(pinned_caches);
-
-	/* Only release caches created in subtxn */
-	foreach (lc, pinned_caches_copy)
+	/*
+	 * Only release caches created in subtxn. Releasing removes a matching pin
+	 * at this position or above, so iterate from the top to not skip any.
+	 */
+	for (int i = num_pinned_caches - 1; i >= 0; i--)
 	{
-		CachePin *cp = lfirst(lc);
-
-		if (cp->subtxnid == subtxnid)
+		if (pinned_caches[i].subtxnid == subtxnid)
 		{
 			/*
 			 * This assert makes sure that that we don't have a cache leak
 			 * when running with debugging
 			 */
 			Assert(abort);
-			cache_release_subtxn(cp->cache, subtxnid);
+			cache_release_subtxn(pinned_caches[i].cache, subtxnid);
 		}
 	}
-
-	list_free(pinned_caches_copy);
 }
 
 /*
@@ -295,34 +308,28 @@ cache_xact_end(XactEvent event, void *arg)
 		default:
 		{
 			/*
-			 * Make a copy of the list of pinned caches since
-			 * ts_cache_release() can manipulate the original list.
-			 */
-			List *pinned_caches_copy = list_copy(pinned_caches);
-			ListCell *lc;
-
-			/*
+			 * Iterate from the top since ts_cache_release() removes a
+			 * matching pin at this position or above.
+			 *
 			 * Only caches left should be marked as non-released
 			 */
-			foreach (lc, pinned_caches_copy)
+			for (int i = num_pinned_caches - 1; i >= 0; i--)
 			{
-				CachePin *cp = lfirst(lc);
+				Cache *cache = pinned_caches[i].cache;
 
 				/*
 				 * This assert makes sure that that we don't have a cache
 				 * leak when running with debugging
 				 */
-				Assert(!cp->cache->release_on_commit);
+				Assert(!cache->release_on_commit);
 
 				/*
 				 * This may still happen in optimized environments where
 				 * Assert is turned off. In that case, release.
 				 */
-				if (cp->cache->release_on_commit)
-					ts_cache_release(cp->cache);
+				if (cache->release_on_commit)
+					ts_cache_release(cache);
 			}
-
-			list_free(pinned_caches_copy);
 		}
 		break;
 	}
@@ -371,7 +378,9 @@ _cache_fini(void)
 	release_all_pinned_caches();
 	MemoryContextDelete(pinned_caches_mctx);
 	pinned_caches_mctx = NULL;
-	pinned_caches = NIL;
+	pinned_caches = NULL;
+	num_pinned_caches = 0;
+	max_pinned_caches = 0;
 	UnregisterXactCallback(cache_xact_end, NULL);
 	UnregisterSubXactCallback(cache_subxact_abort, NULL);
 }
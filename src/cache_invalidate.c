@@ -17,6 +17,9 @@
 #include "compat/compat.h"
 #include "extension.h"
 #include "hypertable_cache.h"
+#include "chunk_slice_cache.h"
+#include "dimension_slice.h"
+#include "relation_constraint_cache.h"
 
 #include "bgw/scheduler.h"
 #include "cross_module_fn.h"
@@ -58,6 +61,9 @@ cache_invalidate_relcache_all(void)
 {
 	ts_hypertable_cache_invalidate_callback();
 	ts_bgw_job_cache_invalidate_callback();
+	ts_chunk_slice_cache_invalidate();
+	ts_dimension_slice_cache_invalidate();
+	ts_relation_constraint_cache_invalidate(InvalidOid);
 }
 
 static Oid hypertable_proxy_table_oid = InvalidOid;
@@ -94,11 +100,19 @@ cache_invalidate_relcache_callback(Datum arg, Oid relid)
 	else if (relid == hypertable_proxy_table_oid)
 	{
 		ts_hypertable_cache_invalidate_callback();
+		ts_chunk_slice_cache_invalidate();
+		ts_dimension_slice_cache_invalidate();
 	}
 	else if (relid == bgw_proxy_table_oid)
 	{
 		ts_bgw_job_cache_invalidate_callback();
 	}
+	else
+	{
+		ts_hypertable_cache_invalidate_relid(relid);
+		/* The constraints of a chunk changed, see relation_constraint_cache.c */
+		ts_relation_constraint_cache_invalidate(relid);
+	}
 }
 
 /* Registration for given cache ids happens in non-TSL code when the extension
@@ -10,6 +10,7 @@
 #include <access/reloptions.h>
 #include <access/tupdesc.h>
 #include <access/xact.h>
+#include <catalog/dependency.h>
 #include <catalog/indexing.h>
 #include <catalog/namespace.h>
 #include <catalog/pg_class.h>
@@ -33,6 +34,7 @@
 #include <utils/builtins.h>
 #include <utils/datum.h>
 #include <utils/hsearch.h>
+#include <utils/inval.h>
 #include <utils/lsyscache.h>
 #include <utils/palloc.h>
 #include <utils/syscache.h>
@@ -54,28 +56,34 @@
 #include "errors.h"
 #include "export.h"
 #include "extension.h"
+#include "guc.h"
 #include "hypercube.h"
 #include "hypertable.h"
 #include "hypertable_cache.h"
+#include "last_point_cache.h"
 #include "osm_callbacks.h"
 #include "partitioning.h"
 #include "process_utility.h"
+#include "relation_size_cache.h"
 #include "scan_iterator.h"
 #include "scanner.h"
 #include "time_utils.h"
 #include "trigger.h"
 #include "ts_catalog/catalog.h"
+#include "ts_catalog/chunk_column_stats.h"
 #include "ts_catalog/chunk_data_node.h"
 #include "ts_catalog/compression_chunk_size.h"
 #include "ts_catalog/continuous_agg.h"
 #include "ts_catalog/continuous_aggs_watermark.h"
 #include "ts_catalog/hypertable_data_node.h"
 #include "utils.h"
+#include "wait_stats.h"
 
 TS_FUNCTION_INFO_V1(ts_chunk_show_chunks);
 TS_FUNCTION_INFO_V1(ts_chunk_drop_chunks);
 TS_FUNCTION_INFO_V1(ts_chunk_drop_single_chunk);
 TS_FUNCTION_INFO_V1(ts_chunk_attach_osm_table_chunk);
+TS_FUNCTION_INFO_V1(ts_chunk_osm_range_update);
 TS_FUNCTION_INFO_V1(ts_chunks_in);
 TS_FUNCTION_INFO_V1(ts_chunk_id_from_relid);
 TS_FUNCTION_INFO_V1(ts_chunk_show);
@@ -241,12 +249,29 @@ ts_chunk_insert_lock(const Chunk *chunk, LOCKMODE lock)
 {
 	Catalog *catalog = ts_catalog_get();
 	Relation rel;
+	instr_time start;
 
+	ts_wait_stats_start(&start);
 	rel = table_open(catalog_get_table_id(catalog, CHUNK), lock);
+	ts_wait_stats_end(TS_WAIT_CHUNK_CATALOG_LOCK, &start);
 	chunk_insert_relation(rel, chunk);
 	table_close(rel, lock);
 }
 
+/*
+ * Lock the hypertable to serialize the chunk creation, keeping the wait
+ * stats of it, since this is where concurrent inserts of new data queue up.
+ */
+static void
+chunk_creation_lock(const Hypertable *ht)
+{
+	instr_time start;
+
+	ts_wait_stats_start(&start);
+	LockRelationOid(ht->main_table_relid, ShareUpdateExclusiveLock);
+	ts_wait_stats_end(TS_WAIT_CHUNK_CREATE_LOCK, &start);
+}
+
 typedef struct CollisionInfo
 {
 	Hypercube *cube;
@@ -1138,7 +1163,7 @@ ts_chunk_create_only_table(Hypertable *ht, Hypercube *cube, const char *schema_n
 	 * ShareUpdateExclusiveLock, which is the weakest lock possible that
 	 * conflicts with itself. The lock needs to be held until transaction end.
 	 */
-	LockRelationOid(ht->main_table_relid, ShareUpdateExclusiveLock);
+	chunk_creation_lock(ht);
 
 	ts_hypercube_find_existing_slices(cube, &tuplock);
 
@@ -1365,7 +1390,7 @@ ts_chunk_find_or_create_without_cuts(const Hypertable *ht, Hypercube *hc, const
 	if (NULL == stub)
 	{
 		/* Serialize chunk creation around the root hypertable */
-		LockRelationOid(ht->main_table_relid, ShareUpdateExclusiveLock);
+		chunk_creation_lock(ht);
 
 		/* Check again after lock */
 		stub = chunk_collides(ht, hc);
@@ -1460,7 +1485,7 @@ ts_chunk_create_for_point(const Hypertable *ht, const Point *p, bool *found, con
 	 * ShareUpdateExclusiveLock, which is the weakest lock possible that
 	 * conflicts with itself. The lock needs to be held until transaction end.
 	 */
-	LockRelationOid(ht->main_table_relid, ShareUpdateExclusiveLock);
+	chunk_creation_lock(ht);
 
 	DEBUG_WAITPOINT("chunk_create_for_point");
 
@@ -1516,6 +1541,62 @@ ts_chunk_create_for_point(const Hypertable *ht, const Point *p, bool *found, con
 	return chunk;
 }
 
+/*
+ * Create the next chunk in time ahead of the inserts, when the point is past
+ * the given percentage of its chunk's interval. Otherwise, all the sessions
+ * inserting into the new time range at the same time would queue on the
+ * chunk creation lock of the first one until its transaction ends.
+ *
+ * We don't wait for the lock if some other session is creating a chunk, it
+ * will either create the next chunk or we will try again later.
+ */
+void
+ts_chunk_precreate_next_for_point(const Hypertable *ht, const Chunk *chunk, const Point *p,
+								  int threshold)
+{
+	const Dimension *dim = hyperspace_get_open_dimension(ht->space, 0);
+	const DimensionSlice *slice;
+	int dim_index;
+	Point *next;
+
+	if (dim == NULL || hypertable_is_distributed(ht) || hypertable_is_distributed_member(ht))
+		return;
+
+	slice = ts_hypercube_get_slice_by_dimension_id(chunk->cube, dim->fd.id);
+
+	if (slice == NULL || slice->fd.range_start == DIMENSION_SLICE_MINVALUE ||
+		slice->fd.range_end == DIMENSION_SLICE_MAXVALUE)
+		return;
+
+	dim_index = dim - ht->space->dimensions;
+
+	if ((double) p->coordinates[dim_index] - (double) slice->fd.range_start <
+		((double) slice->fd.range_end - (double) slice->fd.range_start) * threshold / 100.0)
+		return;
+
+	next = palloc(POINT_SIZE(p->cardinality));
+	memcpy(next, p, POINT_SIZE(p->cardinality));
+	next->coordinates[dim_index] = slice->fd.range_end;
+
+	if (chunk_point_find_chunk_id(ht, next) != 0)
+		return;
+
+	if (!ConditionalLockRelationOid(ht->main_table_relid, ShareUpdateExclusiveLock))
+		return;
+
+	if (chunk_point_find_chunk_id(ht, next) != 0)
+	{
+		UnlockRelationOid(ht->main_table_relid, ShareUpdateExclusiveLock);
+		return;
+	}
+
+	chunk_create_from_point_after_lock(ht,
+									   next,
+									   NameStr(ht->fd.associated_schema_name),
+									   NULL,
+									   NameStr(ht->fd.associated_table_prefix));
+}
+
 /*
  * Find the chunks that belong to the subspace identified by the given dimension
  * vectors. We might be restricting only some dimensions, so this subspace is
@@ -1530,8 +1611,11 @@ ts_chunk_id_find_in_subspace(Hypertable *ht, List *dimension_vecs)
 	ChunkScanCtx ctx;
 	chunk_scan_ctx_init(&ctx, ht, /* point = */ NULL);
 
-	ScanIterator iterator = ts_chunk_constraint_scan_iterator_create(CurrentMemoryContext);
-
+	/*
+	 * Look up the constraints referencing the slices of all the dimensions in
+	 * one scan.
+	 */
+	int num_slice_ids = 0;
 	ListCell *lc;
 	foreach (lc, dimension_vecs)
 	{
@@ -1542,52 +1626,59 @@ ts_chunk_id_find_in_subspace(Hypertable *ht, List *dimension_vecs)
 		 * handled earlier by gather_restriction_dimension_vectors().
 		 */
 		Assert(vec->num_slices > 0);
+		num_slice_ids += vec->num_slices;
+	}
+
+	int32 *slice_ids = palloc(sizeof(int32) * Max(num_slice_ids, 1));
+	num_slice_ids = 0;
+	foreach (lc, dimension_vecs)
+	{
+		const DimensionVec *vec = lfirst(lc);
+
 		for (int i = 0; i < vec->num_slices; i++)
-		{
-			const DimensionSlice *slice = vec->slices[i];
+			slice_ids[num_slice_ids++] = vec->slices[i]->fd.id;
+	}
 
-			ts_chunk_constraint_scan_iterator_set_slice_id(&iterator, slice->fd.id);
-			ts_scan_iterator_start_or_restart_scan(&iterator);
+	ScanIterator iterator = ts_chunk_constraint_scan_iterator_create(CurrentMemoryContext);
+	ts_chunk_constraint_scan_iterator_set_slice_ids(&iterator, slice_ids, num_slice_ids);
 
-			while (ts_scan_iterator_next(&iterator) != NULL)
-			{
-				TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
-				bool PG_USED_FOR_ASSERTS_ONLY isnull = true;
-				Datum datum = slot_getattr(ti->slot, Anum_chunk_constraint_chunk_id, &isnull);
-				Assert(!isnull);
-				int32 current_chunk_id = DatumGetInt32(datum);
-				Assert(current_chunk_id != 0);
-
-				bool found = false;
-				ChunkScanEntry *entry =
-					hash_search(ctx.htab, &current_chunk_id, HASH_ENTER, &found);
-				if (!found)
-				{
-					entry->stub = NULL;
-					entry->num_dimension_constraints = 0;
-				}
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		bool PG_USED_FOR_ASSERTS_ONLY isnull = true;
+		Datum datum = slot_getattr(ti->slot, Anum_chunk_constraint_chunk_id, &isnull);
+		Assert(!isnull);
+		int32 current_chunk_id = DatumGetInt32(datum);
+		Assert(current_chunk_id != 0);
+
+		bool found = false;
+		ChunkScanEntry *entry = hash_search(ctx.htab, &current_chunk_id, HASH_ENTER, &found);
+		if (!found)
+		{
+			entry->stub = NULL;
+			entry->num_dimension_constraints = 0;
+		}
 
-				/*
-				 * We have only the dimension constraints here, because we're searching
-				 * by dimension slice id.
-				 */
-				Assert(!slot_attisnull(ts_scan_iterator_slot(&iterator),
-									   Anum_chunk_constraint_dimension_slice_id));
-				entry->num_dimension_constraints++;
+		/*
+		 * We have only the dimension constraints here, because we're searching
+		 * by dimension slice id.
+		 */
+		Assert(!slot_attisnull(ts_scan_iterator_slot(&iterator),
+							   Anum_chunk_constraint_dimension_slice_id));
+		entry->num_dimension_constraints++;
 
-				/*
-				 * A chunk is complete when we've found slices for all required dimensions,
-				 * i.e., a complete subspace.
-				 */
-				if (entry->num_dimension_constraints == list_length(dimension_vecs))
-				{
-					chunk_ids = lappend_int(chunk_ids, entry->chunk_id);
-				}
-			}
+		/*
+		 * A chunk is complete when we've found slices for all required dimensions,
+		 * i.e., a complete subspace.
+		 */
+		if (entry->num_dimension_constraints == list_length(dimension_vecs))
+		{
+			chunk_ids = lappend_int(chunk_ids, entry->chunk_id);
 		}
 	}
 
 	ts_scan_iterator_close(&iterator);
+	pfree(slice_ids);
 
 	chunk_scan_ctx_destroy(&ctx);
 
@@ -2062,16 +2153,23 @@ chunk_point_find_chunk_id(const Hypertable *ht, const Point *p)
 									 &all_slices);
 	}
 
-	/* Find constraints matching dimension slices. */
-	ScanIterator iterator = ts_chunk_constraint_scan_iterator_create(CurrentMemoryContext);
+	/* Find constraints matching dimension slices, in one scan for all of them. */
+	int32 *slice_ids = palloc(sizeof(int32) * Max(list_length(all_slices), 1));
+	int num_slice_ids = 0;
 
 	ListCell *lc;
 	foreach (lc, all_slices)
 	{
 		DimensionSlice *slice = (DimensionSlice *) lfirst(lc);
+		slice_ids[num_slice_ids++] = slice->fd.id;
+	}
+
+	if (num_slice_ids > 0)
+	{
+		ScanIterator iterator = ts_chunk_constraint_scan_iterator_create(CurrentMemoryContext);
 
-		ts_chunk_constraint_scan_iterator_set_slice_id(&iterator, slice->fd.id);
-		ts_scan_iterator_start_or_restart_scan(&iterator);
+		ts_chunk_constraint_scan_iterator_set_slice_ids(&iterator, slice_ids, num_slice_ids);
+		ts_scan_iterator_start_scan(&iterator);
 
 		while (ts_scan_iterator_next(&iterator) != NULL)
 		{
@@ -2110,13 +2208,10 @@ chunk_point_find_chunk_id(const Hypertable *ht, const Point *p)
 			}
 		}
 
-		if (matching_chunk_id != 0)
-		{
-			break;
-		}
+		ts_scan_iterator_close(&iterator);
 	}
 
-	ts_scan_iterator_close(&iterator);
+	pfree(slice_ids);
 
 	chunk_scan_ctx_destroy(&ctx);
 
@@ -2837,6 +2932,15 @@ ts_chunk_get_hypertable_id_and_status_by_relid(Oid relid, int32 *hypertable_id,
 	return false;
 }
 
+/*
+ * Returns false if there is no chunk with such reloid.
+ */
+bool
+ts_chunk_get_formdata_by_relid(Oid relid, FormData_chunk *form)
+{
+	return chunk_simple_scan_by_reloid(relid, form, /* missing_ok = */ true);
+}
+
 FormData_chunk
 ts_chunk_get_formdata(int32 chunk_id)
 {
@@ -2933,9 +3037,13 @@ typedef enum ChunkDeleteResult
  * those tuples (the CHUNK_ALREADY_MARKED_DROPPED case), but ideally we
  * shouldn't scan the updated tuples at all since it means double the number
  * of tuples to process.
+ *
+ * The compressed chunk of the chunk is dropped too, unless the caller drops
+ * it itself, as the batch drop does (drop_compressed_chunk = false).
  */
 static ChunkDeleteResult
-chunk_tuple_delete(TupleInfo *ti, DropBehavior behavior, bool preserve_chunk_catalog_row)
+chunk_tuple_delete(TupleInfo *ti, DropBehavior behavior, bool preserve_chunk_catalog_row,
+				   bool drop_compressed_chunk)
 {
 	FormData_chunk form;
 	CatalogSecurityContext sec_ctx;
@@ -3013,12 +3121,13 @@ chunk_tuple_delete(TupleInfo *ti, DropBehavior behavior, bool preserve_chunk_cat
 
 	ts_chunk_index_delete_by_chunk_id(form.id, true);
 	ts_compression_chunk_size_delete(form.id);
+	ts_chunk_column_stats_delete_by_chunk_id(form.hypertable_id, form.id);
 	ts_chunk_data_node_delete_by_chunk_id(form.id);
 
 	/* Delete any row in bgw_policy_chunk-stats corresponding to this chunk */
 	ts_bgw_policy_chunk_stats_delete_by_chunk_id(form.id);
 
-	if (form.compressed_chunk_id != INVALID_CHUNK_ID)
+	if (form.compressed_chunk_id != INVALID_CHUNK_ID && drop_compressed_chunk)
 	{
 		Chunk *compressed_chunk = ts_chunk_get_by_id(form.compressed_chunk_id, false);
 
@@ -3078,7 +3187,8 @@ init_scan_by_qualified_table_name(ScanIterator *iterator, const char *schema_nam
 }
 
 static int
-chunk_delete(ScanIterator *iterator, DropBehavior behavior, bool preserve_chunk_catalog_row)
+chunk_delete(ScanIterator *iterator, DropBehavior behavior, bool preserve_chunk_catalog_row,
+			 bool drop_compressed_chunks)
 {
 	int count = 0;
 
@@ -3088,7 +3198,8 @@ chunk_delete(ScanIterator *iterator, DropBehavior behavior, bool preserve_chunk_
 
 		res = chunk_tuple_delete(ts_scan_iterator_tuple_info(iterator),
 								 behavior,
-								 preserve_chunk_catalog_row);
+								 preserve_chunk_catalog_row,
+								 drop_compressed_chunks);
 
 		switch (res)
 		{
@@ -3113,7 +3224,7 @@ ts_chunk_delete_by_name_internal(const char *schema, const char *table, DropBeha
 	int count;
 
 	init_scan_by_qualified_table_name(&iterator, schema, table);
-	count = chunk_delete(&iterator, behavior, preserve_chunk_catalog_row);
+	count = chunk_delete(&iterator, behavior, preserve_chunk_catalog_row, true);
 
 	/* (schema,table) names and (hypertable_id) are unique so should only have
 	 * dropped one chunk or none (if not found) */
@@ -3151,6 +3262,62 @@ init_scan_by_hypertable_id(ScanIterator *iterator, int32 hypertable_id)
 								   Int32GetDatum(hypertable_id));
 }
 
+typedef struct ChunkIdFilter
+{
+	const int32 *chunk_ids;
+	int num_chunk_ids;
+} ChunkIdFilter;
+
+static int
+chunk_id_cmp(const void *p1, const void *p2)
+{
+	int32 id1 = *((const int32 *) p1);
+	int32 id2 = *((const int32 *) p2);
+
+	return (id1 > id2) - (id1 < id2);
+}
+
+static ScanFilterResult
+chunk_filter_by_ids(const TupleInfo *ti, void *data)
+{
+	const ChunkIdFilter *filter = data;
+	bool isnull;
+	int32 chunk_id = DatumGetInt32(slot_getattr(ti->slot, Anum_chunk_id, &isnull));
+
+	Assert(!isnull);
+
+	if (bsearch(&chunk_id,
+				filter->chunk_ids,
+				filter->num_chunk_ids,
+				sizeof(int32),
+				chunk_id_cmp) != NULL)
+		return SCAN_INCLUDE;
+
+	return SCAN_EXCLUDE;
+}
+
+/*
+ * Delete the catalog rows of a set of chunks of a hypertable with a single
+ * scan of the chunk catalog instead of one scan per chunk. The chunk ids need
+ * to be sorted. The compressed chunks of the chunks are left to the caller.
+ */
+static int
+chunk_delete_by_ids(int32 hypertable_id, const int32 *chunk_ids, int num_chunk_ids,
+					DropBehavior behavior, bool preserve_chunk_catalog_row)
+{
+	ScanIterator iterator = ts_scan_iterator_create(CHUNK, RowExclusiveLock, CurrentMemoryContext);
+	ChunkIdFilter filter = {
+		.chunk_ids = chunk_ids,
+		.num_chunk_ids = num_chunk_ids,
+	};
+
+	init_scan_by_hypertable_id(&iterator, hypertable_id);
+	iterator.ctx.filter = chunk_filter_by_ids;
+	iterator.ctx.data = &filter;
+
+	return chunk_delete(&iterator, behavior, preserve_chunk_catalog_row, false);
+}
+
 int
 ts_chunk_delete_by_hypertable_id(int32 hypertable_id)
 {
@@ -3158,7 +3325,7 @@ ts_chunk_delete_by_hypertable_id(int32 hypertable_id)
 
 	init_scan_by_hypertable_id(&iterator, hypertable_id);
 
-	return chunk_delete(&iterator, DROP_RESTRICT, false);
+	return chunk_delete(&iterator, DROP_RESTRICT, false, true);
 }
 
 bool
@@ -3529,6 +3696,8 @@ bool
 ts_chunk_set_unordered(Chunk *chunk)
 {
 	Assert(ts_chunk_is_compressed(chunk));
+	/* The new batches of the chunk can be outside of its tracked ranges */
+	ts_chunk_column_stats_set_invalid(chunk);
 	return ts_chunk_add_status(chunk, CHUNK_STATUS_COMPRESSED_UNORDERED);
 }
 
@@ -3536,6 +3705,8 @@ bool
 ts_chunk_set_partial(Chunk *chunk)
 {
 	Assert(ts_chunk_is_compressed(chunk));
+	/* The new data of the chunk can be outside of its tracked ranges */
+	ts_chunk_column_stats_set_invalid(chunk);
 	return ts_chunk_add_status(chunk, CHUNK_STATUS_COMPRESSED_PARTIAL);
 }
 
@@ -3675,6 +3846,11 @@ bool
 ts_chunk_set_compressed_chunk(Chunk *chunk, int32 compressed_chunk_id)
 {
 	ScanKeyData scankey[1];
+
+	/* Compression moves the data to the compressed chunk */
+	ts_relation_size_cache_invalidate(chunk->table_id);
+	ts_relation_size_cache_invalidate(ts_chunk_get_relid(compressed_chunk_id, true));
+
 	ScanKeyInit(&scankey[0],
 				Anum_chunk_idx_id,
 				BTEqualStrategyNumber,
@@ -3698,6 +3874,16 @@ ts_chunk_clear_compressed_chunk(Chunk *chunk)
 {
 	int32 compressed_chunk_id = INVALID_CHUNK_ID;
 	ScanKeyData scankey[1];
+
+	/* Decompression moves the data back to the chunk */
+	ts_relation_size_cache_invalidate(chunk->table_id);
+
+	/*
+	 * The inserts into an uncompressed chunk are not tracked, so its ranges
+	 * are only valid until it is compressed again.
+	 */
+	ts_chunk_column_stats_set_invalid(chunk);
+
 	ScanKeyInit(&scankey[0],
 				Anum_chunk_idx_id,
 				BTEqualStrategyNumber,
@@ -3837,6 +4023,7 @@ ts_chunk_drop_internal(const Chunk *chunk, DropBehavior behavior, int32 log_leve
 
 	/* Remove the chunk from the chunk table */
 	ts_chunk_delete_by_relid(chunk->table_id, behavior, preserve_catalog_row);
+	ts_relation_size_cache_remove(chunk->table_id);
 
 	/* Drop the table */
 	performDeletion(&objaddr, behavior, 0);
@@ -3854,6 +4041,119 @@ ts_chunk_drop_preserve_catalog_row(const Chunk *chunk, DropBehavior behavior, in
 	ts_chunk_drop_internal(chunk, behavior, log_level, true);
 }
 
+/*
+ * Drop a set of chunks of a hypertable in one go.
+ *
+ * The chunk tables and their compressed chunk tables are locked in the order
+ * of their relids before anything is dropped, so that concurrent batch drops
+ * take the locks in the same order. The catalog rows of all the chunks are
+ * then deleted with a single scan of the chunk catalog, and those of the
+ * compressed chunks with a single scan too. All the tables are dropped with a
+ * single dependency walk, like a DROP TABLE with multiple tables does,
+ * instead of one walk per compressed chunk and one per chunk.
+ */
+static void
+chunk_drop_batch(Chunk **chunks, int num_chunks, DropBehavior behavior, int32 log_level,
+				 bool preserve_catalog_row)
+{
+	ObjectAddresses *objects;
+	int32 *chunk_ids;
+	int32 *compressed_chunk_ids;
+	int32 compressed_hypertable_id = INVALID_HYPERTABLE_ID;
+	int num_compressed_chunks = 0;
+	int num_relids = 0;
+	Oid *relids;
+
+	if (num_chunks == 0)
+		return;
+
+	relids = palloc(sizeof(Oid) * num_chunks * 2);
+	chunk_ids = palloc(sizeof(int32) * num_chunks);
+	compressed_chunk_ids = palloc(sizeof(int32) * num_chunks);
+	objects = new_object_addresses();
+
+	for (int i = 0; i < num_chunks; i++)
+	{
+		relids[num_relids++] = chunks[i]->table_id;
+		chunk_ids[i] = chunks[i]->fd.id;
+
+		if (chunks[i]->fd.compressed_chunk_id != INVALID_CHUNK_ID)
+		{
+			FormData_chunk form = { 0 };
+			Oid compressed_relid = InvalidOid;
+
+			/* The compressed chunk may have been deleted by a CASCADE */
+			if (chunk_simple_scan_by_id(chunks[i]->fd.compressed_chunk_id, &form, true))
+				compressed_relid = ts_get_relation_relid(NameStr(form.schema_name),
+														 NameStr(form.table_name),
+														 true);
+
+			if (OidIsValid(compressed_relid))
+			{
+				ObjectAddress objaddr = {
+					.classId = RelationRelationId,
+					.objectId = compressed_relid,
+				};
+
+				Assert(compressed_hypertable_id == INVALID_HYPERTABLE_ID ||
+					   compressed_hypertable_id == form.hypertable_id);
+				compressed_hypertable_id = form.hypertable_id;
+				compressed_chunk_ids[num_compressed_chunks++] = form.id;
+				relids[num_relids++] = compressed_relid;
+				add_exact_object_address(&objaddr, objects);
+			}
+		}
+	}
+
+	qsort(relids, num_relids, sizeof(Oid), oid_cmp);
+	qsort(chunk_ids, num_chunks, sizeof(int32), chunk_id_cmp);
+	qsort(compressed_chunk_ids, num_compressed_chunks, sizeof(int32), chunk_id_cmp);
+
+	for (int i = 0; i < num_relids; i++)
+	{
+		LockRelationOid(relids[i], AccessExclusiveLock);
+		ts_relation_size_cache_remove(relids[i]);
+	}
+
+	for (int i = 0; i < num_chunks; i++)
+	{
+		ObjectAddress objaddr = {
+			.classId = RelationRelationId,
+			.objectId = chunks[i]->table_id,
+		};
+
+		if (log_level >= 0)
+			elog(log_level,
+				 "dropping chunk %s.%s",
+				 chunks[i]->fd.schema_name.data,
+				 chunks[i]->fd.table_name.data);
+
+		add_exact_object_address(&objaddr, objects);
+	}
+
+	/* Remove the chunks and their compressed chunks from the chunk table */
+	chunk_delete_by_ids(chunks[0]->fd.hypertable_id,
+						chunk_ids,
+						num_chunks,
+						behavior,
+						preserve_catalog_row);
+
+	if (num_compressed_chunks > 0)
+		chunk_delete_by_ids(compressed_hypertable_id,
+							compressed_chunk_ids,
+							num_compressed_chunks,
+							behavior,
+							false);
+
+	/* Drop the tables */
+	performMultipleDeletions(objects, behavior, 0);
+
+	free_object_addresses(objects);
+	pfree(compressed_chunk_ids);
+	pfree(chunk_ids);
+	pfree(relids);
+}
+
 static void
 lock_referenced_tables(Oid table_relid)
 {
@@ -3993,6 +4293,12 @@ ts_chunk_do_drop_chunks(Hypertable *ht, int64 older_than, int64 newer_than, int3
 
 	List *data_nodes = NIL;
 	List *dropped_chunk_names = NIL;
+	Chunk **batch = NULL;
+	int num_batch = 0;
+
+	if (ts_guc_enable_batched_chunk_drop)
+		batch = palloc(sizeof(Chunk *) * num_chunks);
+
 	for (uint64 i = 0; i < num_chunks; i++)
 	{
 		char *chunk_name;
@@ -4012,7 +4318,9 @@ ts_chunk_do_drop_chunks(Hypertable *ht, int64 older_than, int64 newer_than, int3
 		chunk_name = psprintf("%s.%s", schema_name, table_name);
 		dropped_chunk_names = lappend(dropped_chunk_names, chunk_name);
 
-		if (has_continuous_aggs)
+		if (batch != NULL)
+			batch[num_batch++] = chunks + i;
+		else if (has_continuous_aggs)
 			ts_chunk_drop_preserve_catalog_row(chunks + i, DROP_RESTRICT, log_level);
 		else
 			ts_chunk_drop(chunks + i, DROP_RESTRICT, log_level);
@@ -4026,6 +4334,12 @@ ts_chunk_do_drop_chunks(Hypertable *ht, int64 older_than, int64 newer_than, int3
 		}
 	}
 
+	if (batch != NULL)
+	{
+		chunk_drop_batch(batch, num_batch, DROP_RESTRICT, log_level, has_continuous_aggs);
+		pfree(batch);
+	}
+
 	/* When dropping chunks for a given CAgg then force set the watermark */
 	if (is_materialization_hypertable)
 	{
@@ -4037,6 +4351,9 @@ ts_chunk_do_drop_chunks(Hypertable *ht, int64 older_than, int64 newer_than, int3
 	if (affected_data_nodes)
 		*affected_data_nodes = data_nodes;
 
+	if (dropped_chunk_names != NIL)
+		ts_last_point_cache_invalidate(hypertable_id);
+
 	DEBUG_WAITPOINT("drop_chunks_end");
 
 	return dropped_chunk_names;
@@ -4510,6 +4827,17 @@ ts_chunk_scan_iterator_set_chunk_id(ScanIterator *it, int32 chunk_id)
 								   Int32GetDatum(chunk_id));
 }
 
+/*
+ * Scan for all the given chunk ids in one index scan.
+ */
+void
+ts_chunk_scan_iterator_set_chunk_ids(ScanIterator *it, const int32 *chunk_ids, int num_chunk_ids)
+{
+	it->ctx.index = catalog_get_index(ts_catalog_get(), CHUNK, CHUNK_ID_INDEX);
+	ts_scan_iterator_scan_key_reset(it);
+	ts_scan_iterator_scan_key_init_ids(it, Anum_chunk_idx_id, chunk_ids, num_chunk_ids);
+}
+
 #include "hypercube.h"
 static Hypercube *
 fill_hypercube_for_foreign_table_chunk(Hyperspace *hs)
@@ -4605,9 +4933,14 @@ add_foreign_table_as_chunk(Oid relid, Hypertable *parent_ht)
 	chunk_add_inheritance(chunk, parent_ht);
 }
 
+/*
+ * Extend the slice of a chunk on a dimension to also cover the adjacent slice
+ * of another chunk, updating the dimension constraint of the chunk. The other
+ * chunk is left as it is, so its data can still be moved into the chunk.
+ */
 void
-ts_chunk_merge_on_dimension(const Hypertable *ht, Chunk *chunk, const Chunk *merge_chunk,
-							int32 dimension_id)
+ts_chunk_extend_on_dimension(const Hypertable *ht, Chunk *chunk, const Chunk *merge_chunk,
+							 int32 dimension_id)
 {
 	const DimensionSlice *slice, *merge_slice;
 	int num_ccs = 0;
@@ -4755,7 +5088,13 @@ ts_chunk_merge_on_dimension(const Hypertable *ht, Chunk *chunk, const Chunk *mer
 	ts_chunk_constraints_create(ht, chunk);
 	ts_process_utility_set_expect_chunk_modification(false);
 	chunk->constraints = oldccs;
+}
 
+void
+ts_chunk_merge_on_dimension(const Hypertable *ht, Chunk *chunk, const Chunk *merge_chunk,
+							int32 dimension_id)
+{
+	ts_chunk_extend_on_dimension(ht, chunk, merge_chunk, dimension_id);
 	ts_chunk_drop(merge_chunk, DROP_RESTRICT, 1);
 }
 
@@ -4786,6 +5125,131 @@ ts_chunk_attach_osm_table_chunk(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(ret);
 }
 
+/*
+ * Internal API used by OSM extension to record the time range of the data in
+ * the OSM chunk. The range replaces the placeholder dimension slice that the
+ * chunk got when it was attached, so that the planner can exclude the OSM
+ * chunk like any other chunk instead of always scanning it, which means a
+ * call to the object storage for every query on the hypertable. Passing NULL
+ * for the range resets the placeholder, and the OSM chunk is then always
+ * included in the scans again.
+ *
+ * The range must not overlap the range of any other chunk, since inserts
+ * into it would be routed to the OSM chunk.
+ */
+Datum
+ts_chunk_osm_range_update(PG_FUNCTION_ARGS)
+{
+	Oid hypertable_relid = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+	Cache *hcache;
+	Hypertable *ht =
+		ts_hypertable_cache_get_cache_and_entry(hypertable_relid, CACHE_FLAG_NONE, &hcache);
+	const Dimension *time_dim = hyperspace_get_open_dimension(ht->space, 0);
+	Oid time_type = ts_dimension_get_partition_type(time_dim);
+	int32 osm_chunk_id;
+	Chunk *osm_chunk;
+	DimensionSlice *slice = NULL;
+	DimensionSlice *new_slice;
+	int64 range_start, range_end;
+
+	ts_hypertable_permissions_check(hypertable_relid, GetUserId());
+
+	osm_chunk_id = ts_chunk_get_osm_chunk_id(ht->fd.id);
+	if (osm_chunk_id == INVALID_CHUNK_ID)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("hypertable \"%s\" has no tiered chunk", get_rel_name(hypertable_relid))));
+
+	osm_chunk = ts_chunk_get_by_id(osm_chunk_id, true);
+	for (int i = 0; i < osm_chunk->cube->num_slices; i++)
+	{
+		if (osm_chunk->cube->slices[i]->fd.dimension_id == time_dim->fd.id)
+			slice = osm_chunk->cube->slices[i];
+	}
+
+	if (slice == NULL)
+		elog(ERROR, "missing dimension slice for tiered chunk %d", osm_chunk_id);
+
+	if (PG_ARGISNULL(1) && PG_ARGISNULL(2))
+	{
+		Hypercube *cube = fill_hypercube_for_foreign_table_chunk(ht->space);
+
+		range_start = cube->slices[0]->fd.range_start;
+		range_end = cube->slices[0]->fd.range_end;
+	}
+	else
+	{
+		Oid start_type = get_fn_expr_argtype(fcinfo->flinfo, 1);
+		Oid end_type = get_fn_expr_argtype(fcinfo->flinfo, 2);
+
+		if (PG_ARGISNULL(1) || PG_ARGISNULL(2))
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("range_start and range_end must both be NULL or both be set")));
+
+		if (start_type != time_type || end_type != time_type)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("invalid type for the range of the tiered chunk"),
+					 errdetail("The range has to be of type %s, the type of the time dimension.",
+							   format_type_be(time_type))));
+
+		range_start = ts_time_value_to_internal(PG_GETARG_DATUM(1), time_type);
+		range_end = ts_time_value_to_internal(PG_GETARG_DATUM(2), time_type);
+
+		if (range_start >= range_end)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("range_start must be less than range_end")));
+
+		DimensionVec *collisions =
+			ts_dimension_slice_collision_scan_limit(time_dim->fd.id, range_start, range_end, 0);
+
+		for (int i = 0; i < collisions->num_slices; i++)
+		{
+			const DimensionSlice *collision = collisions->slices[i];
+
+			if (collision->fd.id == slice->fd.id)
+				continue;
+
+			if (ts_chunk_constraint_scan_by_dimension_slice_id(collision->fd.id,
+															   NULL,
+															   CurrentMemoryContext) > 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("range of the tiered chunk overlaps with existing chunks")));
+		}
+	}
+
+	if (slice->fd.range_start == range_start && slice->fd.range_end == range_end)
+	{
+		ts_cache_release(hcache);
+		PG_RETURN_BOOL(false);
+	}
+
+	new_slice = ts_dimension_slice_create(time_dim->fd.id, range_start, range_end);
+
+	ScanTupLock tuplock = {
+		.lockmode = LockTupleKeyShare,
+		.waitpolicy = LockWaitBlock,
+	};
+	if (!ts_dimension_slice_scan_for_existing(new_slice, &tuplock))
+		ts_dimension_slice_insert(new_slice);
+
+	ts_chunk_constraint_update_slice_id(osm_chunk->fd.id, slice->fd.id, new_slice->fd.id);
+
+	if (ts_chunk_constraint_scan_by_dimension_slice_id(slice->fd.id, NULL, CurrentMemoryContext) ==
+		0)
+		ts_dimension_slice_delete_by_id(slice->fd.id, false);
+
+	/* Plans that skipped or scanned the OSM chunk have to be made again */
+	CacheInvalidateRelcacheByRelid(ht->main_table_relid);
+
+	ts_cache_release(hcache);
+
+	PG_RETURN_BOOL(true);
+}
+
 static ScanTupleResult
 chunk_tuple_osm_chunk_found(TupleInfo *ti, void *arg)
 {
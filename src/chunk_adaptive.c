@@ -599,6 +599,151 @@ ts_calculate_chunk_interval(PG_FUNCTION_ARGS)
 	PG_RETURN_INT64(chunk_interval);
 }
 
+/* The chunks of the window must hold at least this fraction of the target
+ * size in total to estimate the ingest rate from them */
+#define INGEST_RATE_MIN_SIZE_FRACTION 0.01
+
+/* Bounds on how much the interval can grow or shrink with each new chunk */
+#define INGEST_RATE_MAX_GROWTH 2.0
+#define INGEST_RATE_MAX_SHRINK 0.5
+
+TS_FUNCTION_INFO_V1(ts_calculate_chunk_interval_by_ingest_rate);
+
+/*
+ * Calculate a new interval for a chunk in a given dimension from the ingest
+ * rate of the preceding chunks.
+ *
+ * This is an alternative to ts_calculate_chunk_interval() that does not scan
+ * the chunks for the min and max values of the dimension. The ingest rate is
+ * the number of bytes (including indexes and TOAST) written per unit of the
+ * dimension, i.e., the total size of the chunks in the window divided by the
+ * total width of their slices. The interval that would have filled a chunk to
+ * the target size at that rate is:
+ *
+ *   target_size / ingest_rate
+ *
+ * The target size is capped to the memory cache size, so that the chunk that
+ * is being written to, including its indexes, stays in shared_buffers.
+ *
+ * To converge on the target without oscillating, the interval only moves
+ * halfway (geometrically) towards the estimate with each new chunk and is
+ * bounded by INGEST_RATE_MAX_GROWTH and INGEST_RATE_MAX_SHRINK. Compressed
+ * and OSM chunks are skipped since their size does not reflect the rate at
+ * which data was ingested.
+ */
+Datum
+ts_calculate_chunk_interval_by_ingest_rate(PG_FUNCTION_ARGS)
+{
+	int32 dimension_id = PG_GETARG_INT32(0);
+	int64 dimension_coord = PG_GETARG_INT64(1);
+	int64 chunk_target_size_bytes = PG_GETARG_INT64(2);
+	int64 memory_target_size_bytes = ts_chunk_calculate_initial_chunk_target_size();
+	int64 current_interval;
+	int64 chunk_interval;
+	int32 hypertable_id;
+	Hypertable *ht;
+	const Dimension *dim;
+	List *chunks;
+	ListCell *lc;
+	double total_size = 0;
+	double total_interval = 0;
+	double ingest_rate;
+	double factor;
+
+	if (PG_NARGS() != CHUNK_SIZING_FUNC_NARGS)
+		elog(ERROR, "invalid number of arguments");
+
+	if (chunk_target_size_bytes < 0)
+		elog(ERROR, "chunk_target_size must be positive");
+
+	if (chunk_target_size_bytes == 0 || chunk_target_size_bytes > memory_target_size_bytes)
+		chunk_target_size_bytes = memory_target_size_bytes;
+
+	hypertable_id = ts_dimension_get_hypertable_id(dimension_id);
+
+	if (hypertable_id <= 0)
+		elog(ERROR, "could not find a matching hypertable for dimension %u", dimension_id);
+
+	ht = ts_hypertable_get_by_id(hypertable_id);
+
+	Assert(ht != NULL);
+
+	if (pg_class_aclcheck(ht->main_table_relid, GetUserId(), ACL_SELECT) != ACLCHECK_OK)
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("permission denied for table %s", ht->fd.table_name.data)));
+
+	if (hypertable_is_distributed(ht))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("adaptive chunking not supported on distributed hypertables")));
+
+	dim = ts_hyperspace_get_dimension_by_id(ht->space, dimension_id);
+
+	Assert(dim != NULL);
+
+	current_interval = dim->fd.interval_length;
+
+	chunks = ts_chunk_get_window(dimension_id,
+								 dimension_coord,
+								 DEFAULT_CHUNK_WINDOW,
+								 CurrentMemoryContext);
+
+	foreach (lc, chunks)
+	{
+		Chunk *chunk = lfirst(lc);
+		const DimensionSlice *slice =
+			ts_hypercube_get_slice_by_dimension_id(chunk->cube, dimension_id);
+
+		Assert(NULL != slice);
+
+		if (chunk->fd.osm_chunk || ts_chunk_is_compressed(chunk))
+			continue;
+
+		total_size += DatumGetInt64(
+			DirectFunctionCall1(pg_total_relation_size, ObjectIdGetDatum(chunk->table_id)));
+		total_interval += (double) slice->fd.range_end - slice->fd.range_start;
+	}
+
+	if (total_interval <= 0 ||
+		total_size < chunk_target_size_bytes * INGEST_RATE_MIN_SIZE_FRACTION)
+	{
+		elog(DEBUG1,
+			 "[adaptive] not enough data to estimate the ingest rate, "
+			 "use previous size of " UINT64_FORMAT,
+			 current_interval);
+		PG_RETURN_INT64(current_interval);
+	}
+
+	ingest_rate = total_size / total_interval;
+	factor = sqrt((chunk_target_size_bytes / ingest_rate) / current_interval);
+	factor = Max(INGEST_RATE_MAX_SHRINK, Min(INGEST_RATE_MAX_GROWTH, factor));
+
+	elog(DEBUG1,
+		 "[adaptive] ingest_rate=%lf bytes per unit chunk_target_size_bytes=" UINT64_FORMAT
+		 " factor=%lf",
+		 ingest_rate,
+		 chunk_target_size_bytes,
+		 factor);
+
+	/*
+	 * Keep the old interval if it is close enough to the estimate, to avoid
+	 * fluctuating around the target size.
+	 */
+	if (fabs(1.0 - factor) <= INTERVAL_MIN_CHANGE_THRESH / 2)
+		PG_RETURN_INT64(current_interval);
+
+	chunk_interval = Max(1, (int64) (current_interval * factor));
+
+	elog(LOG,
+		 "[adaptive] calculated chunk interval=" UINT64_FORMAT
+		 " for hypertable %d from ingest rate, making change",
+		 chunk_interval,
+		 hypertable_id);
+
+	PG_RETURN_INT64(chunk_interval);
+}
+
 /*
  * Validate that the provided function in the catalog can be used for
  * determining a new chunk size, i.e., has form (int,bigint,bigint) -> bigint.
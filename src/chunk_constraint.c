@@ -556,6 +556,42 @@ ts_chunk_constraint_scan_iterator_set_chunk_id(ScanIterator *it, int32 chunk_id)
 								   Int32GetDatum(chunk_id));
 }
 
+/*
+ * Scan for the constraints referencing any of the given dimension slices in
+ * one index scan.
+ */
+void
+ts_chunk_constraint_scan_iterator_set_slice_ids(ScanIterator *it, const int32 *slice_ids,
+												int num_slice_ids)
+{
+	it->ctx.index = catalog_get_index(ts_catalog_get(),
+									  CHUNK_CONSTRAINT,
+									  CHUNK_CONSTRAINT_DIMENSION_SLICE_ID_IDX);
+	ts_scan_iterator_scan_key_reset(it);
+	ts_scan_iterator_scan_key_init_ids(it,
+									   Anum_chunk_constraint_dimension_slice_id_idx_dimension_slice_id,
+									   slice_ids,
+									   num_slice_ids);
+}
+
+/*
+ * Scan for the constraints of all the given chunks in one index scan. The
+ * constraints are returned ordered by chunk id and constraint name.
+ */
+void
+ts_chunk_constraint_scan_iterator_set_chunk_ids(ScanIterator *it, const int32 *chunk_ids,
+												int num_chunk_ids)
+{
+	it->ctx.index = catalog_get_index(ts_catalog_get(),
+									  CHUNK_CONSTRAINT,
+									  CHUNK_CONSTRAINT_CHUNK_ID_CONSTRAINT_NAME_IDX);
+	ts_scan_iterator_scan_key_reset(it);
+	ts_scan_iterator_scan_key_init_ids(it,
+									   Anum_chunk_constraint_chunk_id_constraint_name_idx_chunk_id,
+									   chunk_ids,
+									   num_chunk_ids);
+}
+
 static void
 init_scan_by_chunk_id_constraint_name(ScanIterator *iterator, int32 chunk_id,
 									  const char *constraint_name)
@@ -21,13 +21,23 @@
 #include <miscadmin.h>
 #include <nodes/parsenodes.h>
 #include <optimizer/optimizer.h>
+#include <port/atomics.h>
+#include <postmaster/bgworker.h>
+#include <storage/bufmgr.h>
+#include <storage/dsm.h>
+#include <storage/ipc.h>
 #include <utils/builtins.h>
 #include <utils/fmgroids.h>
 #include <utils/lsyscache.h>
+#include <utils/memutils.h>
 #include <utils/rel.h>
+#include <utils/snapmgr.h>
 #include <utils/syscache.h>
 
+#include "bgw/launcher_interface.h"
+#include "bgw/worker.h"
 #include "chunk_index.h"
+#include "extension.h"
 #include "hypertable.h"
 #include "hypertable_cache.h"
 #include "ts_catalog/catalog.h"
@@ -246,6 +256,13 @@ ts_chunk_index_create_post_adjustment(int32 hypertable_id, Relation template_ind
 	List *colnames = create_index_colnames(template_indexrel);
 	Oid tablespace;
 	bits16 flags = 0;
+	/*
+	 * The heap of a compressed chunk is empty when its indexes are created, as
+	 * is the heap of a new chunk. Building the index of an empty heap is
+	 * cheap, but index_create() would still plan a parallel build for it, so
+	 * we skip the build there and do it serially below.
+	 */
+	bool empty_heap = RelationGetNumberOfBlocks(chunkrel) == 0;
 
 	tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(RelationGetRelid(template_indexrel)));
 
@@ -276,6 +293,8 @@ ts_chunk_index_create_post_adjustment(int32 hypertable_id, Relation template_ind
 		flags |= INDEX_CREATE_ADD_CONSTRAINT;
 	if (template_indexrel->rd_index->indisprimary)
 		flags |= INDEX_CREATE_IS_PRIMARY;
+	if (empty_heap)
+		flags |= INDEX_CREATE_SKIP_BUILD;
 
 	chunk_indexrelid = index_create(chunkrel,
 									indexname,
@@ -298,6 +317,14 @@ ts_chunk_index_create_post_adjustment(int32 hypertable_id, Relation template_ind
 									false, /* is internal */
 									NULL); /* constraintId */
 
+	if (empty_heap)
+	{
+		Relation chunk_indexrel = index_open(chunk_indexrelid, NoLock);
+
+		index_build(chunkrel, chunk_indexrel, indexinfo, false, /* parallel = */ false);
+		index_close(chunk_indexrel, NoLock);
+	}
+
 	ReleaseSysCache(tuple);
 
 	return chunk_indexrelid;
@@ -471,6 +498,264 @@ ts_chunk_index_create_all(int32 hypertable_id, Oid hypertable_relid, int32 chunk
 	table_close(htrel, AccessShareLock);
 }
 
+#define CHUNK_INDEX_WORKER_NAME "TimescaleDB Chunk Index Worker"
+#define CHUNK_INDEX_WORKER_MAIN "ts_bgw_chunk_index_worker_main"
+
+/*
+ * The chunks that CREATE INDEX builds the index on with background workers,
+ * in a dynamic shared memory segment. The workers take the next chunk from
+ * the queue until all the chunks are taken.
+ */
+typedef struct ChunkIndexWorkerQueue
+{
+	pg_atomic_uint32 next_chunk;
+	int32 hypertable_id;
+	Oid hypertable_relid;
+	Oid hypertable_indexrelid;
+	int n_ht_atts;
+	int num_chunks;
+	Oid chunks[FLEXIBLE_ARRAY_MEMBER];
+} ChunkIndexWorkerQueue;
+
+typedef struct ChunkIndexWorkers
+{
+	BackgroundWorkerHandle **handles;
+	int num_workers;
+} ChunkIndexWorkers;
+
+static BackgroundWorkerHandle *
+chunk_index_worker_start(dsm_segment *segment)
+{
+	BackgroundWorker worker = {
+		.bgw_flags = BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION,
+		.bgw_start_time = BgWorkerStart_RecoveryFinished,
+		.bgw_restart_time = BGW_NEVER_RESTART,
+		.bgw_notify_pid = MyProcPid,
+		.bgw_main_arg = ObjectIdGetDatum(MyDatabaseId),
+	};
+	BgwParams bgw_params = {
+		.user_oid = GetUserId(),
+		.segment_handle = dsm_segment_handle(segment),
+	};
+	BackgroundWorkerHandle *handle;
+
+	strlcpy(bgw_params.bgw_main, CHUNK_INDEX_WORKER_MAIN, sizeof(bgw_params.bgw_main));
+	strlcpy(worker.bgw_name, CHUNK_INDEX_WORKER_NAME, BGW_MAXLEN);
+	strlcpy(worker.bgw_library_name, ts_extension_get_so_name(), BGW_MAXLEN);
+	strlcpy(worker.bgw_function_name, CHUNK_INDEX_WORKER_MAIN, BGW_MAXLEN);
+	memcpy(worker.bgw_extra, &bgw_params, sizeof(bgw_params));
+
+	if (!RegisterDynamicBackgroundWorker(&worker, &handle))
+		return NULL;
+
+	return handle;
+}
+
+/* Terminate the workers if CREATE INDEX fails or is canceled while they run */
+static void
+chunk_index_workers_terminate(int code, Datum arg)
+{
+	ChunkIndexWorkers *workers = (ChunkIndexWorkers *) DatumGetPointer(arg);
+
+	for (int i = 0; i < workers->num_workers; i++)
+	{
+		TerminateBackgroundWorker(workers->handles[i]);
+		ts_bgw_worker_release();
+	}
+
+	workers->num_workers = 0;
+}
+
+/*
+ * Build the index of a hypertable on the given chunks with up to max_workers
+ * background workers, each chunk in its own transaction. The workers are
+ * counted against timescaledb.max_background_workers like the jobs, and each
+ * of them can use a parallel index build for its chunk.
+ *
+ * This is called outside of a transaction, with the hypertable index locked
+ * for the session. The chunks that the workers could not index, because they
+ * failed or did not start, are left for the caller to index itself, which also
+ * reports the errors. Returns the number of workers that were started.
+ */
+int
+ts_chunk_index_create_parallel(int32 hypertable_id, Oid hypertable_relid,
+							   Oid hypertable_indexrelid, int n_ht_atts, List *chunk_relids,
+							   int max_workers)
+{
+	const int num_chunks = list_length(chunk_relids);
+	ChunkIndexWorkerQueue *queue;
+	ChunkIndexWorkers workers;
+	dsm_segment *segment;
+	int num_started;
+	ListCell *lc;
+	int i = 0;
+
+	Assert(!IsTransactionState());
+
+	max_workers = Min(max_workers, num_chunks);
+	if (max_workers < 1)
+		return 0;
+
+	segment = dsm_create(add_size(offsetof(ChunkIndexWorkerQueue, chunks),
+								  mul_size(num_chunks, sizeof(Oid))),
+						 0);
+	queue = dsm_segment_address(segment);
+	pg_atomic_init_u32(&queue->next_chunk, 0);
+	queue->hypertable_id = hypertable_id;
+	queue->hypertable_relid = hypertable_relid;
+	queue->hypertable_indexrelid = hypertable_indexrelid;
+	queue->n_ht_atts = n_ht_atts;
+	queue->num_chunks = num_chunks;
+
+	foreach (lc, chunk_relids)
+		queue->chunks[i++] = lfirst_oid(lc);
+
+	workers.num_workers = 0;
+	workers.handles = palloc(sizeof(BackgroundWorkerHandle *) * max_workers);
+
+	PG_ENSURE_ERROR_CLEANUP(chunk_index_workers_terminate, PointerGetDatum(&workers));
+	{
+		while (workers.num_workers < max_workers && ts_bgw_worker_reserve())
+		{
+			BackgroundWorkerHandle *handle = chunk_index_worker_start(segment);
+
+			if (handle == NULL)
+			{
+				ts_bgw_worker_release();
+				break;
+			}
+
+			workers.handles[workers.num_workers++] = handle;
+		}
+
+		if (workers.num_workers < max_workers)
+			elog(DEBUG1,
+				 "started %d of %d workers to create the chunk indexes",
+				 workers.num_workers,
+				 max_workers);
+
+		for (i = 0; i < workers.num_workers; i++)
+		{
+			if (WaitForBackgroundWorkerShutdown(workers.handles[i]) == BGWH_POSTMASTER_DIED)
+				ereport(FATAL,
+						(errcode(ERRCODE_ADMIN_SHUTDOWN),
+						 errmsg("postmaster exited while chunk index workers were running")));
+		}
+	}
+	PG_END_ENSURE_ERROR_CLEANUP(chunk_index_workers_terminate, PointerGetDatum(&workers));
+
+	num_started = workers.num_workers;
+	for (i = 0; i < workers.num_workers; i++)
+		ts_bgw_worker_release();
+
+	pfree(workers.handles);
+	dsm_detach(segment);
+
+	return num_started;
+}
+
+/*
+ * Build the index on one chunk of the queue in its own transaction. A chunk
+ * that fails is only logged, and its index is built afterwards by the backend
+ * that runs CREATE INDEX.
+ */
+static void
+chunk_index_worker_process_chunk(const ChunkIndexWorkerQueue *queue, Oid chunk_relid)
+{
+	MemoryContext oldcontext = CurrentMemoryContext;
+
+	StartTransactionCommand();
+	PushActiveSnapshot(GetTransactionSnapshot());
+
+	PG_TRY();
+	{
+		CatalogSecurityContext sec_ctx;
+		Relation chunk_rel;
+		Chunk *chunk;
+
+		ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+
+		/* The chunk might have been dropped in the meantime */
+		chunk_rel = try_relation_open(chunk_relid, ShareLock);
+		chunk = chunk_rel != NULL ? ts_chunk_get_by_relid(chunk_relid, false) : NULL;
+
+		/* The foreign OSM chunk is left to the caller, which skips it */
+		if (chunk != NULL && !IS_OSM_CHUNK(chunk))
+		{
+			Relation hypertable_index_rel =
+				index_open(queue->hypertable_indexrelid, AccessShareLock);
+			IndexInfo *indexinfo = BuildIndexInfo(hypertable_index_rel);
+
+			if (chunk_index_columns_changed(queue->n_ht_atts, RelationGetDescr(chunk_rel)))
+				ts_adjust_indexinfo_attnos(indexinfo, queue->hypertable_relid, chunk_rel);
+
+			ts_chunk_index_create_from_adjusted_index_info(queue->hypertable_id,
+														   hypertable_index_rel,
+														   chunk->fd.id,
+														   chunk_rel,
+														   indexinfo);
+
+			index_close(hypertable_index_rel, NoLock);
+		}
+
+		if (chunk_rel != NULL)
+			table_close(chunk_rel, NoLock);
+
+		ts_catalog_restore_user(&sec_ctx);
+
+		PopActiveSnapshot();
+		CommitTransactionCommand();
+	}
+	PG_CATCH();
+	{
+		ErrorData *edata;
+
+		MemoryContextSwitchTo(oldcontext);
+		edata = CopyErrorData();
+		FlushErrorState();
+		AbortCurrentTransaction();
+
+		ereport(LOG,
+				(errcode(edata->sqlerrcode),
+				 errmsg("could not create index on chunk %u in background worker", chunk_relid),
+				 errdetail("Message: (%s).", edata->message)));
+
+		FreeErrorData(edata);
+	}
+	PG_END_TRY();
+
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/* Main loop of the workers started by ts_chunk_index_create_parallel() */
+void
+ts_chunk_index_worker_run(dsm_handle segment_handle)
+{
+	dsm_segment *segment = dsm_attach(segment_handle);
+	ChunkIndexWorkerQueue *queue;
+
+	if (segment == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map the shared memory of the chunk index workers")));
+
+	queue = dsm_segment_address(segment);
+
+	for (;;)
+	{
+		uint32 next_chunk = pg_atomic_fetch_add_u32(&queue->next_chunk, 1);
+
+		if (next_chunk >= (uint32) queue->num_chunks)
+			break;
+
+		chunk_index_worker_process_chunk(queue, queue->chunks[next_chunk]);
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	dsm_detach(segment);
+}
+
 static int
 chunk_index_scan(int indexid, ScanKeyData scankey[], int nkeys, tuple_found_func tuple_found,
 				 tuple_filter_func tuple_filter, void *data, LOCKMODE lockmode)
@@ -10,6 +10,7 @@
 #include <nodes/execnodes.h>
 #include <nodes/parsenodes.h>
 #include <fmgr.h>
+#include <storage/dsm.h>
 #include <utils/relcache.h>
 
 #include "compat/compat.h"
@@ -37,6 +38,10 @@ extern void ts_chunk_index_create_from_adjusted_index_info(int32 hypertable_id,
 extern TSDLLEXPORT void ts_chunk_index_create_all(int32 hypertable_id, Oid hypertable_relid,
 												  int32 chunk_id, Oid chunkrelid, Oid index_tblspc);
 extern TSDLLEXPORT void ts_chunk_index_move_all(Oid chunk_relid, Oid index_tblspc);
+extern int ts_chunk_index_create_parallel(int32 hypertable_id, Oid hypertable_relid,
+										  Oid hypertable_indexrelid, int n_ht_atts,
+										  List *chunk_relids, int max_workers);
+extern void ts_chunk_index_worker_run(dsm_handle segment_handle);
 extern int ts_chunk_index_delete(int32 chunk_id, const char *indexname, bool drop_index);
 extern int ts_chunk_index_delete_by_chunk_id(int32 chunk_id, bool drop_index);
 extern void ts_chunk_index_delete_by_name(const char *schema, const char *index_name,
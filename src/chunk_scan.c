@@ -18,9 +18,61 @@
 #include "chunk_scan.h"
 #include "chunk.h"
 #include "chunk_constraint.h"
+#include "dimension_slice.h"
 #include "ts_catalog/chunk_data_node.h"
 #include "utils.h"
 
+/*
+ * Sorted arrays of unique ids are used to match the tuples of the batched
+ * catalog scans to the chunks and slices they belong to.
+ */
+static int
+id_cmp(const void *left, const void *right)
+{
+	int32 l = *((const int32 *) left);
+	int32 r = *((const int32 *) right);
+
+	if (l < r)
+		return -1;
+
+	return (l > r) ? 1 : 0;
+}
+
+/*
+ * Sort an array of ids and remove the duplicates. Returns the number of
+ * unique ids.
+ */
+static int
+ids_sort_unique(int32 *ids, int num_ids)
+{
+	int num_unique = 0;
+
+	if (num_ids == 0)
+		return 0;
+
+	qsort(ids, num_ids, sizeof(int32), id_cmp);
+
+	for (int i = 1; i < num_ids; i++)
+	{
+		if (ids[i] != ids[num_unique])
+			ids[++num_unique] = ids[i];
+	}
+
+	return num_unique + 1;
+}
+
+/*
+ * Find the position of an id in a sorted array of unique ids, or -1 if it is
+ * not in the array.
+ */
+static int
+ids_find(const int32 *ids, int num_ids, int32 id)
+{
+	const int32 *found = bsearch(&id, ids, num_ids, sizeof(int32), id_cmp);
+
+	return (found == NULL) ? -1 : (int) (found - ids);
+}
+
 /*
  * Scan for chunks matching a query.
  *
@@ -37,6 +89,11 @@
  * For performance, try not to interleave scans of different metadata tables
  * in order to maintain data locality while scanning. Also, keep scanned
  * tables and indexes open until all the metadata is scanned for all chunks.
+ *
+ * Each metadata table is read with a single index scan that looks up the ids
+ * of all chunks (or slices) at once using an array scan key, instead of doing
+ * a separate index probe per chunk. The tuples are then matched to the chunks
+ * by binary search over the sorted ids.
  */
 Chunk **
 ts_chunk_scan_by_chunk_ids(const Hyperspace *hs, const List *chunk_ids, unsigned int *num_chunks)
@@ -52,39 +109,45 @@ ts_chunk_scan_by_chunk_ids(const Hyperspace *hs, const List *chunk_ids, unsigned
 	int unlocked_chunk_count = 0;
 	ListCell *lc;
 	int remote_chunk_count = 0;
+	int32 *ids;
+	int num_ids = 0;
+	Chunk **chunks_by_id;
 
 	Assert(OidIsValid(hs->main_table_relid));
 	orig_mcxt = MemoryContextSwitchTo(work_mcxt);
 
+	ids = palloc(sizeof(int32) * list_length(chunk_ids));
+	foreach (lc, chunk_ids)
+		ids[num_ids++] = lfirst_int(lc);
+	num_ids = ids_sort_unique(ids, num_ids);
+	chunks_by_id = palloc0(sizeof(Chunk *) * num_ids);
+
 	/*
 	 * For each matching chunk, fill in the metadata from the "chunk" table.
 	 * Make sure to filter out "dropped" chunks.
 	 */
-	ScanIterator chunk_it = ts_chunk_scan_iterator_create(orig_mcxt);
-	unlocked_chunks = MemoryContextAlloc(work_mcxt, sizeof(Chunk *) * list_length(chunk_ids));
-	foreach (lc, chunk_ids)
+	if (num_ids > 0)
 	{
-		int chunk_id = lfirst_int(lc);
-		TupleInfo *ti;
-
-		Assert(CurrentMemoryContext == work_mcxt);
+		ScanIterator chunk_it = ts_chunk_scan_iterator_create(orig_mcxt);
 
-		ts_chunk_scan_iterator_set_chunk_id(&chunk_it, chunk_id);
-		ts_scan_iterator_start_or_restart_scan(&chunk_it);
-		ti = ts_scan_iterator_next(&chunk_it);
+		ts_chunk_scan_iterator_set_chunk_ids(&chunk_it, ids, num_ids);
 
-		if (ti)
+		ts_scanner_foreach(&chunk_it)
 		{
+			TupleInfo *ti = ts_scan_iterator_tuple_info(&chunk_it);
 			bool isnull;
 			Datum datum = slot_getattr(ti->slot, Anum_chunk_dropped, &isnull);
 			bool is_dropped = isnull ? false : DatumGetBool(datum);
 
+			Assert(CurrentMemoryContext == work_mcxt);
+
 			MemoryContextSwitchTo(per_tuple_mcxt);
 			MemoryContextReset(per_tuple_mcxt);
 
 			if (!is_dropped)
 			{
 				Chunk *chunk = MemoryContextAllocZero(orig_mcxt, sizeof(Chunk));
+				int pos;
 
 				MemoryContext old_mcxt = MemoryContextSwitchTo(ti->mctx);
 				ts_chunk_formdata_fill(&chunk->fd, ti);
@@ -94,17 +157,31 @@ ts_chunk_scan_by_chunk_ids(const Hyperspace *hs, const List *chunk_ids, unsigned
 				chunk->cube = NULL;
 				chunk->hypertable_relid = hs->main_table_relid;
 
-				unlocked_chunks[unlocked_chunk_count] = chunk;
-				unlocked_chunk_count++;
+				pos = ids_find(ids, num_ids, chunk->fd.id);
+				Assert(pos >= 0);
+				/* Only one chunk should match */
+				Assert(chunks_by_id[pos] == NULL);
+				chunks_by_id[pos] = chunk;
 			}
 
 			MemoryContextSwitchTo(work_mcxt);
-			/* Only one chunk should match */
-			Assert(ts_scan_iterator_next(&chunk_it) == NULL);
 		}
+
+		ts_scan_iterator_close(&chunk_it);
 	}
 
-	ts_scan_iterator_close(&chunk_it);
+	/* Keep the chunks in the order they were requested */
+	unlocked_chunks = MemoryContextAlloc(work_mcxt, sizeof(Chunk *) * list_length(chunk_ids));
+	foreach (lc, chunk_ids)
+	{
+		int pos = ids_find(ids, num_ids, lfirst_int(lc));
+
+		if (chunks_by_id[pos] != NULL)
+		{
+			unlocked_chunks[unlocked_chunk_count++] = chunks_by_id[pos];
+			chunks_by_id[pos] = NULL;
+		}
+	}
 
 	Assert(unlocked_chunk_count == 0 || unlocked_chunks != NULL);
 	Assert(unlocked_chunk_count <= list_length(chunk_ids));
@@ -163,33 +240,120 @@ ts_chunk_scan_by_chunk_ids(const Hyperspace *hs, const List *chunk_ids, unsigned
 	}
 
 	/*
-	 * Fetch the chunk constraints.
+	 * Map the ids of the locked chunks to the chunks, for matching the tuples
+	 * of the remaining scans. The ids are already unique.
 	 */
-	ScanIterator constr_it = ts_chunk_constraint_scan_iterator_create(orig_mcxt);
+	num_ids = locked_chunk_count;
+	for (int i = 0; i < locked_chunk_count; i++)
+		ids[i] = locked_chunks[i]->fd.id;
+	num_ids = ids_sort_unique(ids, num_ids);
+	Assert(num_ids == locked_chunk_count);
 
+	for (int i = 0; i < locked_chunk_count; i++)
+		chunks_by_id[ids_find(ids, num_ids, locked_chunks[i]->fd.id)] = locked_chunks[i];
+
+	/*
+	 * Fetch the chunk constraints. The index is on (chunk_id,
+	 * constraint_name), so the constraints of each chunk are added in the same
+	 * order as when scanning for a single chunk.
+	 */
+	int num_slice_ids = 0;
 	for (int i = 0; i < locked_chunk_count; i++)
 	{
 		Chunk *chunk = locked_chunks[i];
 		chunk->constraints = ts_chunk_constraints_alloc(/* size_hint = */ 0, orig_mcxt);
+	}
+
+	if (locked_chunk_count > 0)
+	{
+		ScanIterator constr_it = ts_chunk_constraint_scan_iterator_create(orig_mcxt);
 
-		ts_chunk_constraint_scan_iterator_set_chunk_id(&constr_it, chunk->fd.id);
-		ts_scan_iterator_start_or_restart_scan(&constr_it);
+		ts_chunk_constraint_scan_iterator_set_chunk_ids(&constr_it, ids, num_ids);
 
-		while (ts_scan_iterator_next(&constr_it) != NULL)
+		ts_scanner_foreach(&constr_it)
 		{
 			TupleInfo *constr_ti = ts_scan_iterator_tuple_info(&constr_it);
+			bool isnull;
+			Datum datum = slot_getattr(constr_ti->slot, Anum_chunk_constraint_chunk_id, &isnull);
+			int pos;
+
+			Assert(!isnull);
+			pos = ids_find(ids, num_ids, DatumGetInt32(datum));
+			Assert(pos >= 0);
+
 			MemoryContextSwitchTo(per_tuple_mcxt);
-			ts_chunk_constraints_add_from_tuple(chunk->constraints, constr_ti);
+			ts_chunk_constraints_add_from_tuple(chunks_by_id[pos]->constraints, constr_ti);
 			MemoryContextSwitchTo(work_mcxt);
 		}
+		ts_scan_iterator_close(&constr_it);
 	}
-	ts_scan_iterator_close(&constr_it);
+
+	for (int i = 0; i < locked_chunk_count; i++)
+		num_slice_ids += locked_chunks[i]->constraints->num_dimension_constraints;
 
 	/*
 	 * Build hypercubes for the chunks by finding and combining the dimension
-	 * slices that match the chunk constraints.
+	 * slices that match the chunk constraints. Chunks typically share slices,
+	 * so each slice is only read once.
 	 */
-	ScanIterator slice_iterator = ts_dimension_slice_scan_iterator_create(NULL, orig_mcxt);
+	int32 *slice_ids = palloc(sizeof(int32) * num_slice_ids);
+	DimensionSlice **slices_by_id;
+
+	num_slice_ids = 0;
+	for (int chunk_index = 0; chunk_index < locked_chunk_count; chunk_index++)
+	{
+		ChunkConstraints *constraints = locked_chunks[chunk_index]->constraints;
+
+		for (int constraint_index = 0; constraint_index < constraints->num_constraints;
+			 constraint_index++)
+		{
+			ChunkConstraint *constraint = &constraints->constraints[constraint_index];
+
+			if (is_dimension_constraint(constraint))
+				slice_ids[num_slice_ids++] = constraint->fd.dimension_slice_id;
+		}
+	}
+	num_slice_ids = ids_sort_unique(slice_ids, num_slice_ids);
+	slices_by_id = palloc0(sizeof(DimensionSlice *) * num_slice_ids);
+
+	/*
+	 * Don't have to lock the slices because the chunks are locked, so we can
+	 * take them from the slice cache, and only read the missing ones.
+	 */
+	const uint64 slice_cache_generation = ts_dimension_slice_cache_generation();
+	int32 *missing_slice_ids = palloc(sizeof(int32) * num_slice_ids);
+	int num_missing_slice_ids = 0;
+
+	for (int i = 0; i < num_slice_ids; i++)
+	{
+		slices_by_id[i] = ts_dimension_slice_cache_lookup(slice_ids[i]);
+
+		if (slices_by_id[i] == NULL)
+			missing_slice_ids[num_missing_slice_ids++] = slice_ids[i];
+	}
+
+	if (num_missing_slice_ids > 0)
+	{
+		ScanIterator slice_iterator = ts_dimension_slice_scan_iterator_create(NULL, work_mcxt);
+
+		ts_dimension_slice_scan_iterator_set_slice_ids(&slice_iterator,
+													   missing_slice_ids,
+													   num_missing_slice_ids,
+													   /* tuplock = */ NULL);
+
+		ts_scanner_foreach(&slice_iterator)
+		{
+			DimensionSlice *slice =
+				ts_dimension_slice_from_tuple(ts_scan_iterator_tuple_info(&slice_iterator));
+			int pos = ids_find(slice_ids, num_slice_ids, slice->fd.id);
+
+			Assert(pos >= 0);
+			slices_by_id[pos] = slice;
+			ts_dimension_slice_cache_add(slice, slice_cache_generation);
+		}
+		ts_scan_iterator_close(&slice_iterator);
+	}
+
 	for (int chunk_index = 0; chunk_index < locked_chunk_count; chunk_index++)
 	{
 		Chunk *chunk = locked_chunks[chunk_index];
@@ -206,15 +370,9 @@ ts_chunk_scan_by_chunk_ids(const Hyperspace *hs, const List *chunk_ids, unsigned
 				continue;
 			}
 
-			/*
-			 * Find the slice by id. Don't have to lock it because the chunk is
-			 * locked.
-			 */
 			const int slice_id = constraint->fd.dimension_slice_id;
-			DimensionSlice *slice_ptr =
-				ts_dimension_slice_scan_iterator_get_by_id(&slice_iterator,
-														   slice_id,
-														   /* tuplock = */ NULL);
+			const int pos = ids_find(slice_ids, num_slice_ids, slice_id);
+			DimensionSlice *slice_ptr = slices_by_id[pos];
 			if (slice_ptr == NULL)
 			{
 				elog(ERROR, "dimension slice %d is not found", slice_id);
@@ -231,59 +389,61 @@ ts_chunk_scan_by_chunk_ids(const Hyperspace *hs, const List *chunk_ids, unsigned
 		ts_hypercube_slice_sort(cube);
 		chunk->cube = cube;
 	}
-	ts_scan_iterator_close(&slice_iterator);
 
 	Assert(CurrentMemoryContext == work_mcxt);
 
 	/*
 	 * Fill in data nodes for remote chunks.
 	 *
-	 * Avoid the loop if there are no remote chunks. (Typically, either all
+	 * Avoid the scan if there are no remote chunks. (Typically, either all
 	 * chunks are remote chunks or none are.)
 	 */
 	if (remote_chunk_count > 0)
 	{
 		ScanIterator data_node_it = ts_chunk_data_nodes_scan_iterator_create(orig_mcxt);
+		int32 *remote_ids = palloc(sizeof(int32) * remote_chunk_count);
+		int num_remote_ids = 0;
 
 		for (int i = 0; i < locked_chunk_count; i++)
 		{
-			Chunk *chunk = locked_chunks[i];
+			if (locked_chunks[i]->relkind == RELKIND_FOREIGN_TABLE)
+				remote_ids[num_remote_ids++] = locked_chunks[i]->fd.id;
+		}
+		num_remote_ids = ids_sort_unique(remote_ids, num_remote_ids);
 
-			if (chunk->relkind == RELKIND_FOREIGN_TABLE)
-			{
-				/* Must start or restart the scan on the longer-lived context */
-				ts_chunk_data_nodes_scan_iterator_set_chunk_id(&data_node_it, chunk->fd.id);
-				ts_scan_iterator_start_or_restart_scan(&data_node_it);
-
-				while (ts_scan_iterator_next(&data_node_it) != NULL)
-				{
-					bool should_free;
-					TupleInfo *ti = ts_scan_iterator_tuple_info(&data_node_it);
-					ChunkDataNode *chunk_data_node;
-					Form_chunk_data_node form;
-					MemoryContext old_mcxt;
-					HeapTuple tuple;
-
-					MemoryContextSwitchTo(per_tuple_mcxt);
-					MemoryContextReset(per_tuple_mcxt);
-
-					tuple = ts_scanner_fetch_heap_tuple(ti, false, &should_free);
-					form = (Form_chunk_data_node) GETSTRUCT(tuple);
-					old_mcxt = MemoryContextSwitchTo(ti->mctx);
-					chunk_data_node = palloc(sizeof(ChunkDataNode));
-					memcpy(&chunk_data_node->fd, form, sizeof(FormData_chunk_data_node));
-					chunk_data_node->foreign_server_oid =
-						get_foreign_server_oid(NameStr(form->node_name),
-											   /* missing_ok = */ false);
-					chunk->data_nodes = lappend(chunk->data_nodes, chunk_data_node);
-					MemoryContextSwitchTo(old_mcxt);
-
-					if (should_free)
-						heap_freetuple(tuple);
-
-					MemoryContextSwitchTo(work_mcxt);
-				}
-			}
+		ts_chunk_data_nodes_scan_iterator_set_chunk_ids(&data_node_it, remote_ids, num_remote_ids);
+
+		ts_scanner_foreach(&data_node_it)
+		{
+			bool should_free;
+			TupleInfo *ti = ts_scan_iterator_tuple_info(&data_node_it);
+			ChunkDataNode *chunk_data_node;
+			Form_chunk_data_node form;
+			MemoryContext old_mcxt;
+			HeapTuple tuple;
+			Chunk *chunk;
+
+			MemoryContextSwitchTo(per_tuple_mcxt);
+			MemoryContextReset(per_tuple_mcxt);
+
+			tuple = ts_scanner_fetch_heap_tuple(ti, false, &should_free);
+			form = (Form_chunk_data_node) GETSTRUCT(tuple);
+			chunk = chunks_by_id[ids_find(ids, num_ids, form->chunk_id)];
+			Assert(chunk->relkind == RELKIND_FOREIGN_TABLE);
+
+			old_mcxt = MemoryContextSwitchTo(ti->mctx);
+			chunk_data_node = palloc(sizeof(ChunkDataNode));
+			memcpy(&chunk_data_node->fd, form, sizeof(FormData_chunk_data_node));
+			chunk_data_node->foreign_server_oid =
+				get_foreign_server_oid(NameStr(form->node_name),
+									   /* missing_ok = */ false);
+			chunk->data_nodes = lappend(chunk->data_nodes, chunk_data_node);
+			MemoryContextSwitchTo(old_mcxt);
+
+			if (should_free)
+				heap_freetuple(tuple);
+
+			MemoryContextSwitchTo(work_mcxt);
 		}
 
 		ts_scan_iterator_close(&data_node_it);
@@ -0,0 +1,432 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <access/stratnum.h>
+#include <utils/hsearch.h>
+#include <utils/memutils.h>
+
+#include "chunk_slice_cache.h"
+
+#include "chunk_constraint.h"
+#include "dimension.h"
+#include "dimension_slice.h"
+#include "dimension_vector.h"
+#include "guc.h"
+#include "scan_iterator.h"
+
+/*
+ * A backend-local cache of the dimension slices of the chunks of each
+ * hypertable. The planner uses it to find the chunks that match the query
+ * restrictions without scanning the dimension_slice and chunk_constraint
+ * catalogs for every query, which gets expensive with many chunks.
+ *
+ * The cache has to be invalidated whenever the chunks of a hypertable or
+ * their slices change. Any change to the chunk and chunk_constraint catalogs,
+ * and the updates and deletes of dimension slices, invalidate the hypertable
+ * cache proxy (see ts_catalog_invalidate_cache()), and we invalidate the
+ * entire cache along with the hypertable cache, see cache_invalidate.c. Those
+ * are rare compared to queries.
+ *
+ * The invalidation only bumps a counter, and the memory is reset on the next
+ * lookup. So the slices returned by ts_chunk_slice_cache_get() stay valid
+ * until the next call, even if there are invalidations in between.
+ */
+typedef struct ChunkSliceCacheEntry
+{
+	int32 hypertable_id;
+	ChunkSlices *slices;
+} ChunkSliceCacheEntry;
+
+typedef struct ChunkSlicesBuildEntry
+{
+	int32 chunk_id;
+	int index;
+} ChunkSlicesBuildEntry;
+
+/* A slice read while building the cache, with the dimension it belongs to */
+typedef struct ChunkSlicesBuildSlice
+{
+	int32 slice_id;
+	int dimension_index;
+	const DimensionSlice *slice;
+} ChunkSlicesBuildSlice;
+
+typedef struct ChunkSlicesSortContext
+{
+	const ChunkSlices *slices;
+	int dimension_index;
+} ChunkSlicesSortContext;
+
+static MemoryContext cache_mcxt = NULL;
+static HTAB *cache_htab = NULL;
+static uint64 cache_generation = 0;
+static uint64 invalidation_count = 0;
+
+void
+ts_chunk_slice_cache_invalidate(void)
+{
+	invalidation_count++;
+}
+
+static void
+chunk_slice_cache_reset(void)
+{
+	HASHCTL ctl = {
+		.keysize = sizeof(int32),
+		.entrysize = sizeof(ChunkSliceCacheEntry),
+	};
+
+	if (cache_mcxt == NULL)
+		cache_mcxt =
+			AllocSetContextCreate(CacheMemoryContext, "chunk slice cache", ALLOCSET_DEFAULT_SIZES);
+	else
+		MemoryContextReset(cache_mcxt);
+
+	ctl.hcxt = cache_mcxt;
+	cache_htab = hash_create("chunk slice cache", 16, &ctl, HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	cache_generation = invalidation_count;
+}
+
+static void
+chunk_slices_add(ChunkSlices *slices, HTAB *chunk_index, int *capacity, int32 chunk_id,
+				 int dimension_index, const DimensionSlice *slice)
+{
+	bool found;
+	ChunkSlicesBuildEntry *entry = hash_search(chunk_index, &chunk_id, HASH_ENTER, &found);
+	const int nd = slices->num_dimensions;
+
+	if (!found)
+	{
+		if (slices->num_chunks == *capacity)
+		{
+			*capacity *= 2;
+			slices->chunk_ids = repalloc(slices->chunk_ids, sizeof(int32) * *capacity);
+			slices->range_start = repalloc(slices->range_start, sizeof(int64) * *capacity * nd);
+			slices->range_end = repalloc(slices->range_end, sizeof(int64) * *capacity * nd);
+			slices->has_slice = repalloc(slices->has_slice, sizeof(bool) * *capacity * nd);
+		}
+
+		entry->index = slices->num_chunks++;
+		slices->chunk_ids[entry->index] = chunk_id;
+		memset(&slices->has_slice[entry->index * nd], 0, sizeof(bool) * nd);
+	}
+
+	const int pos = entry->index * nd + dimension_index;
+	slices->range_start[pos] = slice->fd.range_start;
+	slices->range_end[pos] = slice->fd.range_end;
+	slices->has_slice[pos] = true;
+}
+
+static int
+chunk_slice_start_cmp(const void *a, const void *b, void *arg)
+{
+	const ChunkSlicesSortContext *ctx = (const ChunkSlicesSortContext *) arg;
+	const ChunkSlices *slices = ctx->slices;
+	const int64 start_a =
+		slices->range_start[*(const int *) a * slices->num_dimensions + ctx->dimension_index];
+	const int64 start_b =
+		slices->range_start[*(const int *) b * slices->num_dimensions + ctx->dimension_index];
+
+	return (start_a > start_b) - (start_a < start_b);
+}
+
+/*
+ * Build the per-dimension index of the chunks sorted by the slice start.
+ */
+static void
+chunk_slices_sort(ChunkSlices *slices)
+{
+	const int nd = slices->num_dimensions;
+	const int n = slices->num_chunks;
+	const int size = Max(nd * n, 1);
+
+	slices->num_sorted = palloc0(sizeof(int) * Max(nd, 1));
+	slices->sorted_chunks = palloc(sizeof(int) * size);
+	slices->sorted_start = palloc(sizeof(int64) * size);
+	slices->max_end = palloc(sizeof(int64) * size);
+
+	for (int d = 0; d < nd; d++)
+	{
+		int *sorted = &slices->sorted_chunks[d * n];
+		int64 *sorted_start = &slices->sorted_start[d * n];
+		int64 *max_end = &slices->max_end[d * n];
+		ChunkSlicesSortContext ctx = { .slices = slices, .dimension_index = d };
+		int num_sorted = 0;
+
+		for (int c = 0; c < n; c++)
+		{
+			if (slices->has_slice[c * nd + d])
+				sorted[num_sorted++] = c;
+		}
+
+		qsort_arg(sorted, num_sorted, sizeof(int), chunk_slice_start_cmp, &ctx);
+
+		for (int k = 0; k < num_sorted; k++)
+		{
+			const int pos = sorted[k] * nd + d;
+
+			sorted_start[k] = slices->range_start[pos];
+			max_end[k] = slices->range_end[pos];
+			if (k > 0)
+				max_end[k] = Max(max_end[k], max_end[k - 1]);
+		}
+
+		slices->num_sorted[d] = num_sorted;
+	}
+}
+
+/*
+ * Find the first position in the sorted values that is greater than the given
+ * value, or greater or equal if inclusive is set.
+ */
+static int
+int64_bsearch(const int64 *values, int n, int64 value, bool inclusive)
+{
+	int low = 0;
+	int high = n;
+
+	while (low < high)
+	{
+		const int mid = low + (high - low) / 2;
+
+		if (values[mid] < value || (!inclusive && values[mid] == value))
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/*
+ * Find the range [first, last) of positions in the sorted chunks of the given
+ * dimension that can match the conditions of
+ * ts_dimension_slice_scan_iterator_set_range(). All the matching chunks are in
+ * this range, but they still have to be checked with
+ * ts_dimension_slice_range_matches(), because the slices can overlap.
+ */
+void
+ts_chunk_slices_search(const ChunkSlices *slices, int dimension_index,
+					   StrategyNumber start_strategy, int64 start_value,
+					   StrategyNumber end_strategy, int64 end_value, int *first, int *last)
+{
+	const int n = slices->num_sorted[dimension_index];
+	const int64 *sorted_start = &slices->sorted_start[dimension_index * slices->num_chunks];
+	const int64 *max_end = &slices->max_end[dimension_index * slices->num_chunks];
+
+	*first = 0;
+	*last = n;
+
+	switch (start_strategy)
+	{
+		case BTLessStrategyNumber:
+			*last = int64_bsearch(sorted_start, n, start_value, true);
+			break;
+		case BTLessEqualStrategyNumber:
+			*last = int64_bsearch(sorted_start, n, start_value, false);
+			break;
+		case BTEqualStrategyNumber:
+			*first = int64_bsearch(sorted_start, n, start_value, true);
+			*last = int64_bsearch(sorted_start, n, start_value, false);
+			break;
+		case BTGreaterEqualStrategyNumber:
+			*first = int64_bsearch(sorted_start, n, start_value, true);
+			break;
+		case BTGreaterStrategyNumber:
+			*first = int64_bsearch(sorted_start, n, start_value, false);
+			break;
+		default:
+			break;
+	}
+
+	/*
+	 * The running maximum of range_end bounds the ends of all the slices up to
+	 * that position, so it lets us skip the leading slices that end before a
+	 * lower bound. It doesn't help with an upper bound on range_end.
+	 */
+	if (end_strategy == BTGreaterStrategyNumber || end_strategy == BTGreaterEqualStrategyNumber)
+	{
+		const int end_first = int64_bsearch(max_end,
+											n,
+											ts_dimension_slice_range_end_search_value(end_value),
+											end_strategy == BTGreaterEqualStrategyNumber);
+
+		*first = Max(*first, end_first);
+	}
+
+	if (*last < *first)
+		*last = *first;
+}
+
+static int
+build_slice_cmp(const void *left, const void *right)
+{
+	const ChunkSlicesBuildSlice *l = left;
+	const ChunkSlicesBuildSlice *r = right;
+
+	if (l->slice_id < r->slice_id)
+		return -1;
+
+	return (l->slice_id > r->slice_id) ? 1 : 0;
+}
+
+/*
+ * Read the slices of all the chunks of the hypertable, in the same way as
+ * ts_chunk_id_find_in_subspace() does for the matching slices. The chunk
+ * constraints of all the slices are read in a single index scan.
+ */
+static ChunkSlices *
+chunk_slices_build(const Hyperspace *hs)
+{
+	const int nd = hs->num_dimensions;
+	int capacity = 64;
+	ChunkSlices *slices = palloc0(sizeof(ChunkSlices));
+	MemoryContext work_mcxt =
+		AllocSetContextCreate(CurrentMemoryContext, "chunk slices build", ALLOCSET_DEFAULT_SIZES);
+	HASHCTL ctl = {
+		.keysize = sizeof(int32),
+		.entrysize = sizeof(ChunkSlicesBuildEntry),
+		.hcxt = work_mcxt,
+	};
+	HTAB *chunk_index =
+		hash_create("chunk slices build", capacity, &ctl, HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	slices->hypertable_id = hs->hypertable_id;
+	slices->num_dimensions = nd;
+	slices->dimension_ids = palloc(sizeof(int32) * Max(nd, 1));
+	slices->chunk_ids = palloc(sizeof(int32) * capacity);
+	slices->range_start = palloc(sizeof(int64) * capacity * Max(nd, 1));
+	slices->range_end = palloc(sizeof(int64) * capacity * Max(nd, 1));
+	slices->has_slice = palloc(sizeof(bool) * capacity * Max(nd, 1));
+
+	MemoryContext old_mcxt = MemoryContextSwitchTo(work_mcxt);
+	DimensionVec **vecs = palloc(sizeof(DimensionVec *) * Max(nd, 1));
+	int num_build_slices = 0;
+
+	for (int d = 0; d < nd; d++)
+	{
+		const Dimension *dim = &hs->dimensions[d];
+
+		vecs[d] = ts_dimension_slice_scan_range_limit(dim->fd.id,
+													  InvalidStrategy,
+													  0,
+													  InvalidStrategy,
+													  0,
+													  0,
+													  NULL);
+		slices->dimension_ids[d] = dim->fd.id;
+		num_build_slices += vecs[d]->num_slices;
+	}
+
+	ChunkSlicesBuildSlice *build_slices =
+		palloc(sizeof(ChunkSlicesBuildSlice) * Max(num_build_slices, 1));
+	int32 *slice_ids = palloc(sizeof(int32) * Max(num_build_slices, 1));
+
+	num_build_slices = 0;
+	for (int d = 0; d < nd; d++)
+	{
+		for (int i = 0; i < vecs[d]->num_slices; i++)
+		{
+			ChunkSlicesBuildSlice *build_slice = &build_slices[num_build_slices++];
+
+			build_slice->slice_id = vecs[d]->slices[i]->fd.id;
+			build_slice->dimension_index = d;
+			build_slice->slice = vecs[d]->slices[i];
+		}
+	}
+	qsort(build_slices, num_build_slices, sizeof(ChunkSlicesBuildSlice), build_slice_cmp);
+
+	for (int i = 0; i < num_build_slices; i++)
+		slice_ids[i] = build_slices[i].slice_id;
+
+	if (num_build_slices > 0)
+	{
+		ScanIterator iterator = ts_chunk_constraint_scan_iterator_create(work_mcxt);
+
+		ts_chunk_constraint_scan_iterator_set_slice_ids(&iterator, slice_ids, num_build_slices);
+
+		ts_scanner_foreach(&iterator)
+		{
+			TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+			bool PG_USED_FOR_ASSERTS_ONLY isnull = true;
+			ChunkSlicesBuildSlice key;
+			Datum datum = slot_getattr(ti->slot, Anum_chunk_constraint_chunk_id, &isnull);
+			Assert(!isnull);
+
+			key.slice_id = DatumGetInt32(
+				slot_getattr(ti->slot, Anum_chunk_constraint_dimension_slice_id, &isnull));
+			Assert(!isnull);
+
+			const ChunkSlicesBuildSlice *build_slice = bsearch(&key,
+															   build_slices,
+															   num_build_slices,
+															   sizeof(ChunkSlicesBuildSlice),
+															   build_slice_cmp);
+			Assert(build_slice != NULL);
+
+			MemoryContextSwitchTo(old_mcxt);
+			chunk_slices_add(slices,
+							 chunk_index,
+							 &capacity,
+							 DatumGetInt32(datum),
+							 build_slice->dimension_index,
+							 build_slice->slice);
+			MemoryContextSwitchTo(work_mcxt);
+		}
+
+		ts_scan_iterator_close(&iterator);
+	}
+
+	MemoryContextSwitchTo(old_mcxt);
+	MemoryContextDelete(work_mcxt);
+
+	chunk_slices_sort(slices);
+
+	return slices;
+}
+
+/*
+ * Get the slices of all the chunks of the hypertable, or NULL if the cache is
+ * disabled. The result is only valid until the next call.
+ */
+const ChunkSlices *
+ts_chunk_slice_cache_get(const Hypertable *ht)
+{
+	bool found;
+
+	if (!ts_guc_enable_chunk_slice_cache)
+		return NULL;
+
+	if (cache_htab == NULL || cache_generation != invalidation_count)
+		chunk_slice_cache_reset();
+
+	ChunkSliceCacheEntry *entry = hash_search(cache_htab, &ht->fd.id, HASH_FIND, &found);
+	if (found)
+		return entry->slices;
+
+	/*
+	 * Build the entry in its own context, so that we can move it into the
+	 * cache afterwards. If there was an invalidation while we were scanning
+	 * the catalogs, the result might be stale already, so we only use it for
+	 * this lookup, and it is freed with the current memory context.
+	 */
+	const uint64 generation = invalidation_count;
+	MemoryContext entry_mcxt =
+		AllocSetContextCreate(CurrentMemoryContext, "chunk slice cache entry", ALLOCSET_SMALL_SIZES);
+	MemoryContext old_mcxt = MemoryContextSwitchTo(entry_mcxt);
+	ChunkSlices *slices = chunk_slices_build(ht->space);
+	MemoryContextSwitchTo(old_mcxt);
+
+	if (generation == invalidation_count && cache_generation == invalidation_count)
+	{
+		MemoryContextSetParent(entry_mcxt, cache_mcxt);
+		entry = hash_search(cache_htab, &ht->fd.id, HASH_ENTER, &found);
+		Assert(!found);
+		entry->slices = slices;
+	}
+
+	return slices;
+}
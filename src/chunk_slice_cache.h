@@ -0,0 +1,51 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_CHUNK_SLICE_CACHE_H
+#define TIMESCALEDB_CHUNK_SLICE_CACHE_H
+
+#include <postgres.h>
+#include <access/stratnum.h>
+
+#include "hypertable.h"
+
+/*
+ * The dimension slices of all the chunks of a hypertable. The slice of the
+ * i-th chunk in the d-th dimension is at index i * num_dimensions + d of the
+ * range arrays, if has_slice is set there.
+ */
+typedef struct ChunkSlices
+{
+	int32 hypertable_id;
+	int num_dimensions;
+	int32 *dimension_ids;
+	int num_chunks;
+	int32 *chunk_ids;
+	int64 *range_start;
+	int64 *range_end;
+	bool *has_slice;
+
+	/*
+	 * For each dimension d, the indexes of the num_sorted[d] chunks that have
+	 * a slice in it, sorted by range_start, at index d * num_chunks + k of
+	 * sorted_chunks. The sorted_start and max_end arrays have the range_start
+	 * and the running maximum of range_end at the same positions, so that we
+	 * can find the candidate chunks for a range restriction with a binary
+	 * search.
+	 */
+	int *num_sorted;
+	int *sorted_chunks;
+	int64 *sorted_start;
+	int64 *max_end;
+} ChunkSlices;
+
+extern const ChunkSlices *ts_chunk_slice_cache_get(const Hypertable *ht);
+extern void ts_chunk_slices_search(const ChunkSlices *slices, int dimension_index,
+								   StrategyNumber start_strategy, int64 start_value,
+								   StrategyNumber end_strategy, int64 end_value, int *first,
+								   int *last);
+extern void ts_chunk_slice_cache_invalidate(void);
+
+#endif /* TIMESCALEDB_CHUNK_SLICE_CACHE_H */
@@ -863,4 +863,39 @@ object_ownercheck(Oid classid, Oid objectid, Oid roleid)
 }
 #endif
 
+/*
+ * PG16 changes DecodeTimezoneAbbrev() to return the token type through an
+ * output argument, and to report errors through a DateTimeErrorExtra struct.
+ * The compat variant returns the token type, UNKNOWN_FIELD if the token is not
+ * an abbreviation.
+ */
+#if PG16_LT
+#define DecodeTimezoneAbbrevCompat(lowtoken, offset, tz)                                          \
+	DecodeTimezoneAbbrev(0, lowtoken, offset, tz)
+#else
+#include <utils/datetime.h>
+
+static inline int
+DecodeTimezoneAbbrevCompat(const char *lowtoken, int *offset, pg_tz **tz)
+{
+	DateTimeErrorExtra extra;
+	int type;
+
+	if (DecodeTimezoneAbbrev(0, lowtoken, &type, offset, tz, &extra) != 0)
+		return UNKNOWN_FIELD;
+
+	return type;
+}
+#endif
+
+/*
+ * PG15 changes the random state of the reservoir sampling to a pg_prng_state,
+ * which sampler_random_fract() takes by reference.
+ */
+#if PG15_LT
+#define sampler_random_fract_compat(rs) sampler_random_fract((rs)->randstate)
+#else
+#define sampler_random_fract_compat(rs) sampler_random_fract(&(rs)->randstate)
+#endif
+
 #endif /* TIMESCALEDB_COMPAT_H */
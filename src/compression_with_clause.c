@@ -39,6 +39,18 @@ static const WithClauseDefinition compress_hypertable_with_clause_def[] = {
 			 .arg_name = "compress_chunk_time_interval",
 			 .type_id = INTERVALOID,
 		},
+		[CompressToastCompression] = {
+			 .arg_name = "compress_toast_compression",
+			 .type_id = TEXTOID,
+		},
+		[CompressBloomFilter] = {
+			 .arg_name = "compress_bloomfilter",
+			 .type_id = TEXTOID,
+		},
+		[CompressMinMax] = {
+			 .arg_name = "compress_minmax",
+			 .type_id = TEXTOID,
+		},
 };
 
 WithClauseResult *
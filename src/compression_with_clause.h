@@ -19,6 +19,9 @@ typedef enum CompressHypertableOption
 	CompressSegmentBy,
 	CompressOrderBy,
 	CompressChunkTimeInterval,
+	CompressToastCompression,
+	CompressBloomFilter,
+	CompressMinMax,
 	CompressOptionMax
 } CompressHypertableOption;
 
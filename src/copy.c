@@ -30,6 +30,7 @@
 
 #include <access/heapam.h>
 #include <access/hio.h>
+#include <access/htup_details.h>
 #include <access/sysattr.h>
 #include <access/xact.h>
 #include <catalog/pg_trigger_d.h>
@@ -69,21 +70,27 @@
 #endif
 
 /*
- * No more than this many tuples per TSCopyMultiInsertBuffer
- *
- * Caution: Don't make this too big, as we could end up with this many
- * TSCopyMultiInsertBuffer items stored in TSCopyMultiInsertInfo's
- * multiInsertBuffers list.  Increasing this can cause quadratic growth in
- * memory requirements during copies into partitioned tables with a large
- * number of partitions.
+ * No more than this many tuples over all TSCopyMultiInsertBuffers when we
+ * don't know the size of the tuples (PG < 14, binary COPY, or no COPY state).
  */
 #define MAX_BUFFERED_TUPLES 1000
 
 /*
- * Flush buffers if there are >= this many bytes, as counted by the input
- * size, of tuples stored.
+ * When we know the size of the input lines, the number of tuples per buffer
+ * adapts to the observed row width, so that the buffers of the chunks share a
+ * fixed memory budget. Narrow rows can buffer more tuples than the default,
+ * but no more than this many over all buffers.
+ */
+#define MAX_ADAPTIVE_BUFFERED_TUPLES 10000
+
+/*
+ * Flush buffers if the estimated memory of the stored tuples (their input size
+ * plus the per-tuple overhead of the slots) reaches this budget.
  */
-#define MAX_BUFFERED_BYTES 65535
+#define MAX_BUFFERED_MEMORY (1024 * 1024)
+
+/* The initial number of slots of a TSCopyMultiInsertBuffer. It grows on demand. */
+#define INITIAL_BUFFER_SLOTS 64
 
 /* Trim the list of buffers back down to this number after flushing */
 #define MAX_PARTITION_BUFFERS 32
@@ -97,12 +104,21 @@ typedef struct TSCopyMultiInsertBuffer
 	 * not needed and is wasting a lot of CPU in ResourceOwner.
 	 */
 	TupleDesc tupdesc;
-	TupleTableSlot *slots[MAX_BUFFERED_TUPLES]; /* Array to store tuples */
-	Point *point;								/* The point in space of this buffer */
-	BulkInsertState bistate;					/* BulkInsertState for this buffer */
-	int nused;									/* number of 'slots' containing tuples */
-	uint64 linenos[MAX_BUFFERED_TUPLES];		/* Line # of tuple in copy
-												 * stream */
+	TupleTableSlot **slots;	 /* Array to store tuples */
+	uint64 *linenos;		 /* Line # of tuple in copy stream */
+	int nslots;				 /* allocated size of 'slots' and 'linenos' */
+	Point *point;			 /* The point in space of this buffer */
+	BulkInsertState bistate; /* BulkInsertState for this buffer */
+	int nused;				 /* number of 'slots' containing tuples */
+
+	/*
+	 * The estimated memory overhead of a buffered tuple besides its data, and
+	 * the input size and number of all the tuples stored in this buffer so
+	 * far, which give the observed row width of the chunk.
+	 */
+	int tuple_overhead;
+	uint64 total_bytes;
+	uint64 total_tuples;
 } TSCopyMultiInsertBuffer;
 
 /*
@@ -122,7 +138,7 @@ typedef struct TSCopyMultiInsertInfo
 	HTAB *multiInsertBuffers; /* Maps the chunk ids to the buffers (chunkid ->
 								 TSCopyMultiInsertBuffer) */
 	int bufferedTuples;		  /* number of tuples buffered over all buffers */
-	int bufferedBytes;		  /* number of bytes from all buffered tuples */
+	int bufferedBytes;		  /* estimated memory of all buffered tuples */
 	CopyChunkState *ccstate;  /* Copy chunk state for this TSCopyMultiInsertInfo */
 	EState *estate;			  /* Executor state used for COPY */
 	CommandId mycid;		  /* Command Id used for COPY */
@@ -193,9 +209,13 @@ TSCopyMultiInsertBufferInit(ChunkInsertState *cis, Point *point)
 	TSCopyMultiInsertBuffer *buffer;
 
 	buffer = (TSCopyMultiInsertBuffer *) palloc(sizeof(TSCopyMultiInsertBuffer));
-	memset(buffer->slots, 0, sizeof(TupleTableSlot *) * MAX_BUFFERED_TUPLES);
+	buffer->nslots = INITIAL_BUFFER_SLOTS;
+	buffer->slots = palloc0(sizeof(TupleTableSlot *) * buffer->nslots);
+	buffer->linenos = palloc(sizeof(uint64) * buffer->nslots);
 	buffer->bistate = GetBulkInsertState();
 	buffer->nused = 0;
+	buffer->total_bytes = 0;
+	buffer->total_tuples = 0;
 
 	buffer->point = palloc(POINT_SIZE(point->num_coords));
 	memcpy(buffer->point, point, POINT_SIZE(point->num_coords));
@@ -211,6 +231,10 @@ TSCopyMultiInsertBufferInit(ChunkInsertState *cis, Point *point)
 	buffer->tupdesc = CreateTupleDescCopyConstr(cis->rel->rd_att);
 	Assert(buffer->tupdesc->tdrefcount == -1);
 
+	/* The materialized heap tuple and the values and nulls arrays of the slot */
+	buffer->tuple_overhead = HEAPTUPLESIZE + SizeofHeapTupleHeader +
+							 buffer->tupdesc->natts * (sizeof(Datum) + sizeof(bool));
+
 	return buffer;
 }
 
@@ -274,14 +298,41 @@ TSCopyMultiInsertInfoInit(TSCopyMultiInsertInfo *miinfo, ResultRelInfo *rri,
 	miinfo->ht = ht;
 }
 
+/*
+ * The number of tuples the buffer can hold before we flush. The open buffers
+ * share the memory budget evenly, so the capacity depends on the observed row
+ * width of the chunk and on the number of chunks we are copying into.
+ */
+static inline int
+TSCopyMultiInsertBufferCapacity(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuffer *buffer)
+{
+	uint64 row_width;
+	long nbuffers;
+	uint64 capacity;
+
+	if (buffer->total_bytes == 0)
+		return MAX_BUFFERED_TUPLES;
+
+	row_width = buffer->total_bytes / buffer->total_tuples + buffer->tuple_overhead;
+	nbuffers = Max(hash_get_num_entries(miinfo->multiInsertBuffers), 1);
+	capacity = MAX_BUFFERED_MEMORY / nbuffers / row_width;
+
+	return (int) Min(Max(capacity, 1), MAX_ADAPTIVE_BUFFERED_TUPLES);
+}
+
 /*
  * Returns true if the buffers are full.
  */
 static inline bool
-TSCopyMultiInsertInfoIsFull(TSCopyMultiInsertInfo *miinfo)
+TSCopyMultiInsertInfoIsFull(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuffer *buffer)
 {
-	if (miinfo->bufferedTuples >= MAX_BUFFERED_TUPLES ||
-		miinfo->bufferedBytes >= MAX_BUFFERED_BYTES)
+	/* Without the tuple sizes, we can only limit the number of tuples */
+	if (miinfo->bufferedBytes == 0)
+		return miinfo->bufferedTuples >= MAX_BUFFERED_TUPLES;
+
+	if (miinfo->bufferedTuples >= MAX_ADAPTIVE_BUFFERED_TUPLES ||
+		miinfo->bufferedBytes >= MAX_BUFFERED_MEMORY ||
+		buffer->nused >= TSCopyMultiInsertBufferCapacity(miinfo, buffer))
 		return true;
 
 	return false;
@@ -330,6 +381,28 @@ TSCopyMultiInsertBufferFlush(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuf
 
 	ResultRelInfo *resultRelInfo = cis->result_relation_info;
 
+	if (cis->compress_on_insert)
+	{
+		if (ts_cm_functions->compress_tuples_for_insert(cis, slots, nused))
+		{
+			MemoryContextSwitchTo(oldcontext);
+
+			ts_chunk_insert_state_capture_tuples(cis,
+												 miinfo->ccstate->dispatch->transition_capture,
+												 slots,
+												 nused);
+
+			for (i = 0; i < nused; i++)
+				ExecClearTuple(slots[i]);
+			buffer->nused = 0;
+
+			return cis->chunk_id;
+		}
+
+		/* No compressed chunk could be created, use the uncompressed chunk */
+		cis->compress_on_insert = false;
+	}
+
 	/*
 	 * Add context information to the copy state, which is used to display
 	 * error messages with additional details. Providing this information is
@@ -365,6 +438,11 @@ TSCopyMultiInsertBufferFlush(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuf
 					   buffer->bistate);
 	MemoryContextSwitchTo(oldcontext);
 
+#if PG14_LT
+	if (miinfo->ccstate->dispatch->transition_capture != NULL)
+		miinfo->ccstate->dispatch->transition_capture->tcs_map = cis->chunk_to_hyper_map;
+#endif
+
 	for (i = 0; i < nused; i++)
 	{
 #if PG14_GE
@@ -392,23 +470,24 @@ TSCopyMultiInsertBufferFlush(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuf
 								 resultRelInfo,
 								 slots[i],
 								 recheckIndexes,
-								 NULL /* transition capture */);
+								 miinfo->ccstate->dispatch->transition_capture);
 			list_free(recheckIndexes);
 		}
 
 		/*
 		 * There's no indexes, but see if we need to run AFTER ROW INSERT
-		 * triggers anyway.
+		 * triggers or fill the transition tables anyway.
 		 */
-		else if (resultRelInfo->ri_TrigDesc != NULL &&
-				 (resultRelInfo->ri_TrigDesc->trig_insert_after_row ||
-				  resultRelInfo->ri_TrigDesc->trig_insert_new_table))
+		else if ((resultRelInfo->ri_TrigDesc != NULL &&
+				  (resultRelInfo->ri_TrigDesc->trig_insert_after_row ||
+				   resultRelInfo->ri_TrigDesc->trig_insert_new_table)) ||
+				 miinfo->ccstate->dispatch->transition_capture != NULL)
 		{
 			ExecARInsertTriggers(estate,
 								 resultRelInfo,
 								 slots[i],
 								 NIL,
-								 NULL /* transition capture */);
+								 miinfo->ccstate->dispatch->transition_capture);
 		}
 
 		ExecClearTuple(slots[i]);
@@ -453,9 +532,11 @@ TSCopyMultiInsertBufferCleanup(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertB
 	FreeBulkInsertState(buffer->bistate);
 
 	/* Since we only create slots on demand, just drop the non-null ones. */
-	for (i = 0; i < MAX_BUFFERED_TUPLES && buffer->slots[i] != NULL; i++)
+	for (i = 0; i < buffer->nslots && buffer->slots[i] != NULL; i++)
 		ExecDropSingleTupleTableSlot(buffer->slots[i]);
 
+	pfree(buffer->slots);
+	pfree(buffer->linenos);
 	pfree(buffer->point);
 	FreeTupleDesc(buffer->tupdesc);
 	pfree(buffer);
@@ -575,7 +656,19 @@ TSCopyMultiInsertInfoNextFreeSlot(TSCopyMultiInsertInfo *miinfo,
 	int nused = buffer->nused;
 
 	Assert(buffer != NULL);
-	Assert(nused < MAX_BUFFERED_TUPLES);
+	Assert(nused < MAX_ADAPTIVE_BUFFERED_TUPLES);
+
+	if (nused == buffer->nslots)
+	{
+		int nslots = Min(buffer->nslots * 2, MAX_ADAPTIVE_BUFFERED_TUPLES);
+
+		buffer->slots = repalloc(buffer->slots, sizeof(TupleTableSlot *) * nslots);
+		memset(buffer->slots + buffer->nslots,
+			   0,
+			   sizeof(TupleTableSlot *) * (nslots - buffer->nslots));
+		buffer->linenos = repalloc(buffer->linenos, sizeof(uint64) * nslots);
+		buffer->nslots = nslots;
+	}
 
 	if (buffer->slots[nused] == NULL)
 	{
@@ -622,10 +715,12 @@ TSCopyMultiInsertInfoStore(TSCopyMultiInsertInfo *miinfo, ResultRelInfo *rri,
 	 * tuples and not based on the size.
 	 */
 #if PG14_GE
-	if (cstate != NULL)
+	if (cstate != NULL && cstate->line_buf.len > 0)
 	{
 		int tuplen = cstate->line_buf.len;
-		miinfo->bufferedBytes += tuplen;
+		miinfo->bufferedBytes += tuplen + buffer->tuple_overhead;
+		buffer->total_bytes += tuplen;
+		buffer->total_tuples++;
 	}
 #endif
 }
@@ -838,6 +933,14 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 	/* Prepare to catch AFTER triggers. */
 	AfterTriggerBeginQuery();
 
+	/*
+	 * The statement triggers of the hypertable with transition tables get the
+	 * rows copied into all chunks.
+	 */
+	dispatch->transition_capture = MakeTransitionCaptureState(resultRelInfo->ri_TrigDesc,
+															  RelationGetRelid(ccstate->rel),
+															  CMD_INSERT);
+
 	if (ccstate->where_clause)
 		qualexpr = ExecInitQual(castNode(List, ccstate->where_clause), NULL);
 
@@ -941,6 +1044,15 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 
 		Assert(cis != NULL);
 
+		dispatch->num_rows++;
+		if (cis->chunk_compressed)
+			dispatch->num_rows_compressed++;
+
+		ts_chunk_insert_state_track_invalidation(cis, point);
+
+		if (dispatch->last_point_tracker != NULL)
+			ts_last_point_cache_tracker_add(dispatch->last_point_tracker, myslot);
+
 		/* Triggers and stuff need to be invoked in query context. */
 		MemoryContextSwitchTo(oldcontext);
 
@@ -1076,11 +1188,15 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 																 NIL,
 																 false);
 				/* AFTER ROW INSERT Triggers */
+#if PG14_LT
+				if (dispatch->transition_capture != NULL)
+					dispatch->transition_capture->tcs_map = cis->chunk_to_hyper_map;
+#endif
 				ExecARInsertTriggers(estate,
 									 resultRelInfo,
 									 myslot,
 									 recheckIndexes,
-									 NULL /* transition capture */);
+									 dispatch->transition_capture);
 			}
 			else
 			{
@@ -1101,7 +1217,7 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 				 * If enough inserts have queued up, then flush all
 				 * buffers out to their tables.
 				 */
-				if (TSCopyMultiInsertInfoIsFull(&multiInsertInfo))
+				if (TSCopyMultiInsertInfoIsFull(&multiInsertInfo, buffer))
 				{
 					ereport(DEBUG2,
 							(errmsg("flush called with %d bytes and %d buffered tuples",
@@ -1145,7 +1261,7 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 	MemoryContextSwitchTo(oldcontext);
 
 	/* Execute AFTER STATEMENT insertion triggers */
-	ExecASInsertTriggers(estate, resultRelInfo, NULL);
+	ExecASInsertTriggers(estate, resultRelInfo, dispatch->transition_capture);
 
 	/* Handle queued AFTER triggers */
 	AfterTriggerEndQuery(estate);
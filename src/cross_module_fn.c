@@ -29,6 +29,11 @@ CROSSMODULE_WRAPPER(policy_compression_add);
 CROSSMODULE_WRAPPER(policy_compression_remove);
 CROSSMODULE_WRAPPER(policy_recompression_proc);
 CROSSMODULE_WRAPPER(policy_compression_check);
+CROSSMODULE_WRAPPER(policy_compression_parallel);
+CROSSMODULE_WRAPPER(policy_maintenance_add);
+CROSSMODULE_WRAPPER(policy_maintenance_proc);
+CROSSMODULE_WRAPPER(policy_maintenance_check);
+CROSSMODULE_WRAPPER(policy_maintenance_remove);
 CROSSMODULE_WRAPPER(policy_refresh_cagg_add);
 CROSSMODULE_WRAPPER(policy_refresh_cagg_proc);
 CROSSMODULE_WRAPPER(policy_refresh_cagg_check);
@@ -81,9 +86,12 @@ CROSSMODULE_WRAPPER(dictionary_compressor_append);
 CROSSMODULE_WRAPPER(dictionary_compressor_finish);
 CROSSMODULE_WRAPPER(array_compressor_append);
 CROSSMODULE_WRAPPER(array_compressor_finish);
+CROSSMODULE_WRAPPER(bloom1_contains);
 CROSSMODULE_WRAPPER(create_compressed_chunk);
 CROSSMODULE_WRAPPER(compress_chunk);
 CROSSMODULE_WRAPPER(decompress_chunk);
+CROSSMODULE_WRAPPER(compression_advisor);
+CROSSMODULE_WRAPPER(export_chunk_arrow_ipc);
 
 /* continuous aggregate */
 CROSSMODULE_WRAPPER(continuous_agg_invalidation_trigger);
@@ -106,6 +114,7 @@ CROSSMODULE_WRAPPER(data_node_alter);
 CROSSMODULE_WRAPPER(chunk_drop_replica);
 CROSSMODULE_WRAPPER(chunk_freeze_chunk);
 CROSSMODULE_WRAPPER(chunk_unfreeze_chunk);
+CROSSMODULE_WRAPPER(chunk_merge_chunks);
 CROSSMODULE_WRAPPER(chunks_drop_stale);
 
 CROSSMODULE_WRAPPER(chunk_set_default_data_node);
@@ -193,6 +202,12 @@ job_execute_default_fn(BgwJob *job)
 	pg_unreachable();
 }
 
+static void
+policy_compression_worker_run_default(dsm_handle segment_handle)
+{
+	error_no_default_fn_community();
+}
+
 static bool
 process_compress_table_default(AlterTableCmd *cmd, Hypertable *ht,
 							   WithClauseResult *with_clause_options)
@@ -336,6 +351,14 @@ continuous_agg_call_invalidation_trigger_default(int32 hypertable_id, Relation c
 	pg_unreachable();
 }
 
+static void
+continuous_agg_invalidate_range_default(int32 hypertable_id, int32 entry_id, int64 start,
+										int64 end)
+{
+	error_no_default_fn_community();
+	pg_unreachable();
+}
+
 static Datum
 empty_fn(PG_FUNCTION_ARGS)
 {
@@ -421,11 +444,14 @@ TSDLLEXPORT CrossModuleFunctions ts_cm_functions_default = {
 	.set_rel_pathlist_dml = NULL,
 	.set_rel_pathlist_query = NULL,
 	.set_rel_pathlist = NULL,
+	.tsl_postprocess_plan = NULL,
 	.ddl_command_start = NULL,
 	.ddl_command_end = NULL,
 	.sql_drop = NULL,
 	.process_altertable_cmd = NULL,
 	.process_rename_cmd = NULL,
+	.process_create_index = NULL,
+	.analyze_compressed_chunk = NULL,
 
 	/* gapfill */
 	.gapfill_marker = error_no_default_fn_pg_community,
@@ -442,6 +468,12 @@ TSDLLEXPORT CrossModuleFunctions ts_cm_functions_default = {
 	.policy_compression_remove = error_no_default_fn_pg_community,
 	.policy_recompression_proc = error_no_default_fn_pg_community,
 	.policy_compression_check = error_no_default_fn_pg_community,
+	.policy_compression_parallel = error_no_default_fn_pg_community,
+	.policy_compression_worker_run = policy_compression_worker_run_default,
+	.policy_maintenance_add = error_no_default_fn_pg_community,
+	.policy_maintenance_proc = error_no_default_fn_pg_community,
+	.policy_maintenance_check = error_no_default_fn_pg_community,
+	.policy_maintenance_remove = error_no_default_fn_pg_community,
 	.policy_refresh_cagg_add = error_no_default_fn_pg_community,
 	.policy_refresh_cagg_proc = error_no_default_fn_pg_community,
 	.policy_refresh_cagg_check = error_no_default_fn_pg_community,
@@ -481,6 +513,7 @@ TSDLLEXPORT CrossModuleFunctions ts_cm_functions_default = {
 	.process_cagg_viewstmt = process_cagg_viewstmt_default,
 	.continuous_agg_invalidation_trigger = error_no_default_fn_pg_community,
 	.continuous_agg_call_invalidation_trigger = continuous_agg_call_invalidation_trigger_default,
+	.continuous_agg_invalidate_range = continuous_agg_invalidate_range_default,
 	.continuous_agg_refresh = error_no_default_fn_pg_community,
 	.continuous_agg_invalidate_raw_ht = continuous_agg_invalidate_raw_ht_all_default,
 	.continuous_agg_invalidate_mat_ht = continuous_agg_invalidate_mat_ht_all_default,
@@ -503,6 +536,8 @@ TSDLLEXPORT CrossModuleFunctions ts_cm_functions_default = {
 	.create_compressed_chunk = error_no_default_fn_pg_community,
 	.compress_chunk = error_no_default_fn_pg_community,
 	.decompress_chunk = error_no_default_fn_pg_community,
+	.compression_advisor = error_no_default_fn_pg_community,
+	.export_chunk_arrow_ipc = error_no_default_fn_pg_community,
 	.compressed_data_decompress_forward = error_no_default_fn_pg_community,
 	.compressed_data_decompress_reverse = error_no_default_fn_pg_community,
 	.deltadelta_compressor_append = error_no_default_fn_pg_community,
@@ -513,6 +548,7 @@ TSDLLEXPORT CrossModuleFunctions ts_cm_functions_default = {
 	.dictionary_compressor_finish = error_no_default_fn_pg_community,
 	.array_compressor_append = error_no_default_fn_pg_community,
 	.array_compressor_finish = error_no_default_fn_pg_community,
+	.bloom1_contains = error_no_default_fn_pg_community,
 
 	.data_node_add = error_no_default_fn_pg_community,
 	.data_node_delete = error_no_default_fn_pg_community,
@@ -531,6 +567,7 @@ TSDLLEXPORT CrossModuleFunctions ts_cm_functions_default = {
 	.chunk_drop_replica = error_no_default_fn_pg_community,
 	.chunk_freeze_chunk = error_no_default_fn_pg_community,
 	.chunk_unfreeze_chunk = error_no_default_fn_pg_community,
+	.chunk_merge_chunks = error_no_default_fn_pg_community,
 	.chunks_drop_stale = error_no_default_fn_pg_community,
 	.hypertable_make_distributed = hypertable_make_distributed_default_fn,
 	.get_and_validate_data_node_list = get_and_validate_data_node_list_default_fn,
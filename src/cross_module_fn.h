@@ -10,6 +10,7 @@
 #include <fmgr.h>
 #include <commands/event_trigger.h>
 #include <optimizer/planner.h>
+#include <storage/dsm.h>
 #include <utils/timestamp.h>
 #include <utils/jsonb.h>
 #include <utils/array.h>
@@ -44,6 +45,12 @@ typedef struct CrossModuleFunctions
 	PGFunction policy_compression_remove;
 	PGFunction policy_recompression_proc;
 	PGFunction policy_compression_check;
+	PGFunction policy_compression_parallel;
+	void (*policy_compression_worker_run)(dsm_handle segment_handle);
+	PGFunction policy_maintenance_add;
+	PGFunction policy_maintenance_proc;
+	PGFunction policy_maintenance_check;
+	PGFunction policy_maintenance_remove;
 	PGFunction policy_refresh_cagg_add;
 	PGFunction policy_refresh_cagg_proc;
 	PGFunction policy_refresh_cagg_check;
@@ -77,6 +84,7 @@ typedef struct CrossModuleFunctions
 	void (*set_rel_pathlist_query)(PlannerInfo *, RelOptInfo *, Index, RangeTblEntry *,
 								   Hypertable *);
 	void (*set_rel_pathlist)(PlannerInfo *root, RelOptInfo *rel, Index rti, RangeTblEntry *rte);
+	void (*tsl_postprocess_plan)(PlannedStmt *stmt);
 
 	/* gapfill */
 	PGFunction gapfill_marker;
@@ -110,6 +118,8 @@ typedef struct CrossModuleFunctions
 													 HeapTuple chunk_newtuple, bool update,
 													 bool is_distributed_hypertable_trigger,
 													 int32 parent_hypertable_id);
+	void (*continuous_agg_invalidate_range)(int32 hypertable_id, int32 entry_id, int64 start,
+											int64 end);
 	PGFunction continuous_agg_refresh;
 	void (*continuous_agg_invalidate_raw_ht)(const Hypertable *raw_ht, int64 start, int64 end);
 	void (*continuous_agg_invalidate_mat_ht)(const Hypertable *raw_ht, const Hypertable *mat_ht,
@@ -134,12 +144,19 @@ typedef struct CrossModuleFunctions
 								   WithClauseResult *with_clause_options);
 	void (*process_altertable_cmd)(Hypertable *ht, const AlterTableCmd *cmd);
 	void (*process_rename_cmd)(Oid relid, Cache *hcache, const RenameStmt *stmt);
+	void (*process_create_index)(Hypertable *ht, const IndexStmt *stmt, Oid hypertable_indexrelid);
+	void (*analyze_compressed_chunk)(Oid chunk_relid);
 	PGFunction create_compressed_chunk;
 	PGFunction compress_chunk;
 	PGFunction decompress_chunk;
+	PGFunction compression_advisor;
+	PGFunction export_chunk_arrow_ipc;
 	void (*decompress_batches_for_insert)(ChunkInsertState *state, Chunk *chunk,
 										  TupleTableSlot *slot);
+	bool (*compress_tuples_for_insert)(ChunkInsertState *state, TupleTableSlot **slots,
+									   int nslots);
 	bool (*decompress_target_segments)(ModifyTableState *ps);
+	PGFunction bloom1_contains;
 	/* The compression functions below are not installed in SQL as part of create extension;
 	 *  They are installed and tested during testing scripts. They are exposed in cross-module
 	 *  functions because they may be very useful for debugging customer problems if the sql
@@ -204,6 +221,7 @@ typedef struct CrossModuleFunctions
 	PGFunction chunk_drop_replica;
 	PGFunction chunk_freeze_chunk;
 	PGFunction chunk_unfreeze_chunk;
+	PGFunction chunk_merge_chunks;
 	PGFunction chunks_drop_stale;
 	PGFunction health_check;
 	PGFunction recompress_chunk_segmentwise;
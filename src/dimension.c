@@ -7,6 +7,7 @@
 #include <catalog/pg_type.h>
 #include <catalog/namespace.h>
 #include <access/relscan.h>
+#include <access/xact.h>
 #include <commands/tablecmds.h>
 #include <utils/lsyscache.h>
 #include <utils/syscache.h>
@@ -1180,6 +1181,15 @@ ts_dimension_update(const Hypertable *ht, const NameData *dimname, DimensionType
 	if (NULL != num_slices)
 	{
 		Assert(IS_CLOSED_DIMENSION(dim));
+
+		/* A new number of partitions also resets the mapping of hash
+		 * partitions to dimension partitions */
+		if (dim->fd.num_slices != *num_slices)
+		{
+			ts_dimension_partition_info_delete(dim->fd.id);
+			CommandCounterIncrement();
+		}
+
 		dim->fd.num_slices = *num_slices;
 		ts_hypertable_update_dimension_partitions(ht);
 	}
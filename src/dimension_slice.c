@@ -10,7 +10,9 @@
 #include <utils/rel.h>
 #include <catalog/indexing.h>
 #include <funcapi.h>
+#include <utils/hsearch.h>
 #include <utils/lsyscache.h>
+#include <utils/memutils.h>
 #include <catalog/pg_opfamily.h>
 #include <catalog/pg_type.h>
 
@@ -21,6 +23,7 @@
 #include "dimension.h"
 #include "dimension_slice.h"
 #include "dimension_vector.h"
+#include "guc.h"
 #include "hypertable.h"
 #include "scanner.h"
 
@@ -31,6 +34,31 @@
 #define REMAP_LAST_COORDINATE(coord)                                                               \
 	(((coord) == DIMENSION_SLICE_MAXVALUE) ? DIMENSION_SLICE_MAXVALUE - 1 : (coord))
 
+/*
+ * range_end is stored as exclusive, so add 1 to the value being searched.
+ * Also avoid overflow.
+ */
+int64
+ts_dimension_slice_range_end_search_value(int64 end_value)
+{
+	if (end_value != PG_INT64_MAX)
+	{
+		end_value++;
+
+		/*
+		 * If getting as input INT64_MAX-1, need to remap the incremented
+		 * value back to INT64_MAX-1
+		 */
+		return REMAP_LAST_COORDINATE(end_value);
+	}
+
+	/*
+	 * The point with INT64_MAX gets mapped to INT64_MAX-1 so incrementing
+	 * that gets you to INT_64MAX
+	 */
+	return PG_INT64_MAX;
+}
+
 static inline DimensionSlice *
 dimension_slice_alloc(void)
 {
@@ -48,6 +76,116 @@ dimension_slice_from_form_data(const Form_dimension_slice fd)
 	return slice;
 }
 
+/*
+ * A backend-local cache of the dimension slices by id, so that building the
+ * hypercubes of known chunks doesn't have to read the dimension_slice catalog
+ * every time.
+ *
+ * Updating or deleting a slice invalidates the hypertable cache proxy (see
+ * ts_catalog_invalidate_cache()), and new slices get new ids, so we flush the
+ * cache on the invalidations of the proxy in the same way as the chunk slice
+ * cache. Only lookups that don't lock the slice tuple can use the cache.
+ */
+typedef struct DimensionSliceCacheEntry
+{
+	int32 slice_id;
+	FormData_dimension_slice fd;
+} DimensionSliceCacheEntry;
+
+static MemoryContext slice_cache_mcxt = NULL;
+static HTAB *slice_cache_htab = NULL;
+static uint64 slice_cache_generation = 0;
+static uint64 slice_cache_invalidation_count = 0;
+
+void
+ts_dimension_slice_cache_invalidate(void)
+{
+	slice_cache_invalidation_count++;
+}
+
+/*
+ * Get the current generation of the cache, to be passed to
+ * ts_dimension_slice_cache_add() for the slices read after this call.
+ */
+uint64
+ts_dimension_slice_cache_generation(void)
+{
+	return slice_cache_invalidation_count;
+}
+
+static HTAB *
+dimension_slice_cache_get_htab(void)
+{
+	if (!ts_guc_enable_chunk_slice_cache)
+		return NULL;
+
+	if (slice_cache_htab == NULL || slice_cache_generation != slice_cache_invalidation_count)
+	{
+		HASHCTL ctl = {
+			.keysize = sizeof(int32),
+			.entrysize = sizeof(DimensionSliceCacheEntry),
+		};
+
+		if (slice_cache_mcxt == NULL)
+			slice_cache_mcxt = AllocSetContextCreate(CacheMemoryContext,
+													 "dimension slice cache",
+													 ALLOCSET_DEFAULT_SIZES);
+		else
+			MemoryContextReset(slice_cache_mcxt);
+
+		ctl.hcxt = slice_cache_mcxt;
+		slice_cache_htab = hash_create("dimension slice cache",
+									   64,
+									   &ctl,
+									   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+		slice_cache_generation = slice_cache_invalidation_count;
+	}
+
+	return slice_cache_htab;
+}
+
+/*
+ * Look up a slice by id in the cache. Returns a new slice allocated on the
+ * current memory context, or NULL if the slice isn't cached.
+ */
+DimensionSlice *
+ts_dimension_slice_cache_lookup(int32 slice_id)
+{
+	HTAB *htab = dimension_slice_cache_get_htab();
+	DimensionSliceCacheEntry *entry;
+	DimensionSlice *slice;
+
+	if (htab == NULL)
+		return NULL;
+
+	entry = hash_search(htab, &slice_id, HASH_FIND, NULL);
+
+	if (entry == NULL)
+		return NULL;
+
+	slice = dimension_slice_alloc();
+	slice->fd = entry->fd;
+	return slice;
+}
+
+/*
+ * Add a slice read from the catalog to the cache. If there was an
+ * invalidation since the given generation, the slice might be stale already,
+ * so it isn't added.
+ */
+void
+ts_dimension_slice_cache_add(const DimensionSlice *slice, uint64 generation)
+{
+	HTAB *htab = dimension_slice_cache_get_htab();
+	DimensionSliceCacheEntry *entry;
+
+	if (htab == NULL || generation != slice_cache_generation)
+		return;
+
+	entry = hash_search(htab, &slice->fd.id, HASH_ENTER, NULL);
+	entry->fd = slice->fd;
+}
+
 static inline DimensionSlice *
 dimension_slice_from_slot(TupleTableSlot *slot)
 {
@@ -392,40 +530,59 @@ ts_dimension_slice_scan_iterator_set_range(ScanIterator *it, int32 dimension_id,
 
 		Assert(OidIsValid(proc));
 
-		/*
-		 * range_end is stored as exclusive, so add 1 to the value being
-		 * searched. Also avoid overflow
-		 */
-		if (end_value != PG_INT64_MAX)
-		{
-			end_value++;
-
-			/*
-			 * If getting as input INT64_MAX-1, need to remap the incremented
-			 * value back to INT64_MAX-1
-			 */
-			end_value = REMAP_LAST_COORDINATE(end_value);
-		}
-		else
-		{
-			/*
-			 * The point with INT64_MAX gets mapped to INT64_MAX-1 so
-			 * incrementing that gets you to INT_64MAX
-			 */
-			end_value = PG_INT64_MAX;
-		}
-
 		ts_scan_iterator_scan_key_init(
 			it,
 			Anum_dimension_slice_dimension_id_range_start_range_end_idx_range_end,
 			end_strategy,
 			proc,
-			Int64GetDatum(end_value));
+			Int64GetDatum(ts_dimension_slice_range_end_search_value(end_value)));
 	}
 
 	return it->ctx.nkeys;
 }
 
+static bool
+int64_matches_strategy(int64 value, StrategyNumber strategy, int64 arg)
+{
+	switch (strategy)
+	{
+		case BTLessStrategyNumber:
+			return value < arg;
+		case BTLessEqualStrategyNumber:
+			return value <= arg;
+		case BTEqualStrategyNumber:
+			return value == arg;
+		case BTGreaterEqualStrategyNumber:
+			return value >= arg;
+		case BTGreaterStrategyNumber:
+			return value > arg;
+		default:
+			elog(ERROR, "invalid strategy number %d", strategy);
+			pg_unreachable();
+	}
+}
+
+/*
+ * Check whether a slice with the given range matches the conditions of
+ * ts_dimension_slice_scan_iterator_set_range(), without scanning the catalog.
+ */
+bool
+ts_dimension_slice_range_matches(int64 range_start, int64 range_end, StrategyNumber start_strategy,
+								 int64 start_value, StrategyNumber end_strategy, int64 end_value)
+{
+	if (start_strategy != InvalidStrategy &&
+		!int64_matches_strategy(range_start, start_strategy, start_value))
+		return false;
+
+	if (end_strategy != InvalidStrategy &&
+		!int64_matches_strategy(range_end,
+								end_strategy,
+								ts_dimension_slice_range_end_search_value(end_value)))
+		return false;
+
+	return true;
+}
+
 /*
  * Look for all dimension slices where (lower_bound, upper_bound) of the dimension_slice contains
  * the given (start_value, end_value) range
@@ -805,18 +962,53 @@ ts_dimension_slice_scan_iterator_set_slice_id(ScanIterator *it, int32 slice_id,
 	it->ctx.tuplock = tuplock;
 }
 
+/*
+ * Scan for all the given slice ids in one index scan.
+ */
+void
+ts_dimension_slice_scan_iterator_set_slice_ids(ScanIterator *it, const int32 *slice_ids,
+											   int num_slice_ids, const ScanTupLock *tuplock)
+{
+	it->ctx.index = catalog_get_index(ts_catalog_get(), DIMENSION_SLICE, DIMENSION_SLICE_ID_IDX);
+	ts_scan_iterator_scan_key_reset(it);
+	ts_scan_iterator_scan_key_init_ids(it,
+									   Anum_dimension_slice_id_idx_id,
+									   slice_ids,
+									   num_slice_ids);
+	it->ctx.tuplock = tuplock;
+}
+
 DimensionSlice *
 ts_dimension_slice_scan_iterator_get_by_id(ScanIterator *it, int32 slice_id,
 										   const ScanTupLock *tuplock)
 {
 	TupleInfo *ti;
+	DimensionSlice *slice;
+	const uint64 generation = ts_dimension_slice_cache_generation();
+
+	/* Locking the slice requires reading the tuple */
+	if (tuplock == NULL)
+	{
+		MemoryContext old = MemoryContextSwitchTo(ts_scan_iterator_get_result_memory_context(it));
+		slice = ts_dimension_slice_cache_lookup(slice_id);
+		MemoryContextSwitchTo(old);
+
+		if (slice != NULL)
+			return slice;
+	}
 
 	ts_dimension_slice_scan_iterator_set_slice_id(it, slice_id, tuplock);
 	ts_scan_iterator_start_or_restart_scan(it);
 	ti = ts_scan_iterator_next(it);
 	Assert(ti);
 	Assert(ts_scan_iterator_next(it) == NULL); /* This is a heavy call, consider removing it */
-	return ti ? ts_dimension_slice_from_tuple(ti) : NULL;
+
+	if (ti == NULL)
+		return NULL;
+
+	slice = ts_dimension_slice_from_tuple(ti);
+	ts_dimension_slice_cache_add(slice, generation);
+	return slice;
 }
 
 DimensionSlice *
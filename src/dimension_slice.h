@@ -93,6 +93,13 @@ extern ScanIterator ts_dimension_slice_scan_iterator_create(const ScanTupLock *t
 															MemoryContext result_mcxt);
 extern void ts_dimension_slice_scan_iterator_set_slice_id(ScanIterator *it, int32 slice_id,
 														  const ScanTupLock *tuplock);
+extern void ts_dimension_slice_scan_iterator_set_slice_ids(ScanIterator *it, const int32 *slice_ids,
+														   int num_slice_ids,
+														   const ScanTupLock *tuplock);
+extern DimensionSlice *ts_dimension_slice_cache_lookup(int32 slice_id);
+extern void ts_dimension_slice_cache_add(const DimensionSlice *slice, uint64 generation);
+extern uint64 ts_dimension_slice_cache_generation(void);
+extern void ts_dimension_slice_cache_invalidate(void);
 extern DimensionSlice *ts_dimension_slice_scan_iterator_get_by_id(ScanIterator *it, int32 slice_id,
 																  const ScanTupLock *tuplock);
 
@@ -100,6 +107,10 @@ extern int ts_dimension_slice_scan_iterator_set_range(ScanIterator *it, int32 di
 													  StrategyNumber start_strategy,
 													  int64 start_value,
 													  StrategyNumber end_strategy, int64 end_value);
+extern int64 ts_dimension_slice_range_end_search_value(int64 end_value);
+extern bool ts_dimension_slice_range_matches(int64 range_start, int64 range_end,
+											 StrategyNumber start_strategy, int64 start_value,
+											 StrategyNumber end_strategy, int64 end_value);
 
 #define dimension_slice_insert(slice) ts_dimension_slice_insert_multi(&(slice), 1)
 
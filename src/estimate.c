@@ -6,13 +6,20 @@
 #include <postgres.h>
 #include <optimizer/optimizer.h>
 #include <parser/parse_oper.h>
+#include <parser/parsetree.h>
 #include <catalog/pg_type.h>
 #include <utils/selfuncs.h>
 
 #include "compat/compat.h"
+#include "chunk.h"
+#include "dimension.h"
+#include "dimension_slice.h"
 #include "func_cache.h"
 #include "estimate.h"
+#include "hypercube.h"
+#include "hypertable.h"
 #include "import/planner.h"
+#include "planner/planner.h"
 #include "utils.h"
 
 /*
@@ -23,31 +30,31 @@
 static double estimate_max_spread_expr(PlannerInfo *root, Expr *expr);
 static double group_estimate_opexpr(PlannerInfo *root, OpExpr *opexpr, double path_rows);
 
-/* Estimate the max spread on a time var in terms of the internal time representation.
- * Note that this will happen on the hypertable var in most cases. Therefore this is
- * a huge overestimate in many cases where there is a WHERE clause on time.
+/*
+ * Get the range of the values of a time expression from the statistics, in
+ * the internal time representation.
  */
-static double
-estimate_max_spread_var(PlannerInfo *root, Var *var)
+static bool
+get_internal_time_range(PlannerInfo *root, Node *expr, Oid type, int64 *min, int64 *max)
 {
 	VariableStatData vardata;
 	Oid ltop;
 	Datum max_datum, min_datum;
-	volatile int64 max, min;
+	volatile int64 max_internal, min_internal;
 	volatile bool valid;
 
-	examine_variable(root, (Node *) var, 0, &vardata);
-	get_sort_group_operators(var->vartype, true, false, false, &ltop, NULL, NULL, NULL);
+	examine_variable(root, expr, 0, &vardata);
+	get_sort_group_operators(type, true, false, false, &ltop, NULL, NULL, NULL);
 	valid = ts_get_variable_range(root, &vardata, ltop, &min_datum, &max_datum);
 	ReleaseVariableStats(vardata);
 
 	if (!valid)
-		return INVALID_ESTIMATE;
+		return false;
 
 	PG_TRY();
 	{
-		max = ts_time_value_to_internal(max_datum, var->vartype);
-		min = ts_time_value_to_internal(min_datum, var->vartype);
+		max_internal = ts_time_value_to_internal(max_datum, type);
+		min_internal = ts_time_value_to_internal(min_datum, type);
 	}
 	PG_CATCH();
 	{
@@ -56,6 +63,177 @@ estimate_max_spread_var(PlannerInfo *root, Var *var)
 	}
 	PG_END_TRY();
 
+	if (!valid)
+		return false;
+
+	*min = min_internal;
+	*max = max_internal;
+	return true;
+}
+
+typedef struct TimeInterval
+{
+	int64 start;
+	int64 end;
+} TimeInterval;
+
+static int
+time_interval_cmp(const void *left, const void *right)
+{
+	const TimeInterval *l = left;
+	const TimeInterval *r = right;
+
+	if (l->start == r->start)
+		return 0;
+	return l->start < r->start ? -1 : 1;
+}
+
+/*
+ * Estimate the spread of a time var of a hypertable from the chunks that are
+ * left after chunk exclusion. The spread is the part of the range of the var
+ * that is covered by the chunks, so that it accounts for both the excluded
+ * chunks and the gaps between chunks. In each chunk the var is within the
+ * range from the statistics of the chunk, or else from the statistics of the
+ * hypertable, and within the slice of the chunk if the var is a dimension.
+ */
+static double
+estimate_max_spread_var_chunks(PlannerInfo *root, Var *var, bool ht_valid, int64 ht_min,
+							   int64 ht_max)
+{
+	RangeTblEntry *rte;
+	Hypertable *ht;
+	const Dimension *dim = NULL;
+	TimeInterval *intervals;
+	int num_intervals = 0;
+	int num_children = 0;
+	double spread = 0;
+	ListCell *lc;
+
+	if (var->varlevelsup != 0 || var->varattno <= 0 ||
+		(int) var->varno >= root->simple_rel_array_size ||
+		root->simple_rel_array[var->varno] == NULL)
+		return INVALID_ESTIMATE;
+
+	/* The expanded hypertables have the chunks as children */
+	rte = planner_rt_fetch(var->varno, root);
+	if (rte->rtekind != RTE_RELATION)
+		return INVALID_ESTIMATE;
+
+	ht = ts_planner_get_hypertable(rte->relid, CACHE_FLAG_CHECK);
+	if (ht == NULL || hypertable_is_distributed(ht))
+		return INVALID_ESTIMATE;
+
+	for (int i = 0; i < ht->space->num_dimensions; i++)
+	{
+		if (ht->space->dimensions[i].column_attno == var->varattno)
+			dim = &ht->space->dimensions[i];
+	}
+
+	foreach (lc, root->append_rel_list)
+	{
+		if (lfirst_node(AppendRelInfo, lc)->parent_relid == var->varno)
+			num_children++;
+	}
+
+	if (num_children == 0)
+		return INVALID_ESTIMATE;
+
+	intervals = palloc(sizeof(TimeInterval) * num_children);
+
+	foreach (lc, root->append_rel_list)
+	{
+		AppendRelInfo *appinfo = lfirst_node(AppendRelInfo, lc);
+		RelOptInfo *child_rel;
+		TimescaleDBPrivate *priv;
+		Node *child_var;
+		int64 start, end;
+
+		if (appinfo->parent_relid != var->varno)
+			continue;
+
+		child_rel = root->simple_rel_array[appinfo->child_relid];
+
+		/* The child is excluded */
+		if (child_rel == NULL || IS_DUMMY_REL(child_rel))
+			continue;
+
+		priv = child_rel->fdw_private;
+		if (priv == NULL || priv->cached_chunk_struct == NULL ||
+			var->varattno > list_length(appinfo->translated_vars))
+			return INVALID_ESTIMATE;
+
+		child_var = list_nth(appinfo->translated_vars, AttrNumberGetAttrOffset(var->varattno));
+		if (child_var == NULL || !IsA(child_var, Var))
+			return INVALID_ESTIMATE;
+
+		if (!get_internal_time_range(root, child_var, var->vartype, &start, &end))
+		{
+			start = ht_valid ? ht_min : DIMENSION_SLICE_MINVALUE;
+			end = ht_valid ? ht_max : DIMENSION_SLICE_MAXVALUE;
+		}
+
+		if (dim != NULL)
+		{
+			const DimensionSlice *slice =
+				ts_hypercube_get_slice_by_dimension_id(priv->cached_chunk_struct->cube,
+													   dim->fd.id);
+
+			if (slice != NULL)
+			{
+				start = Max(start, slice->fd.range_start);
+				end = Min(end, slice->fd.range_end);
+			}
+		}
+
+		/* The range of the var in the chunk is unbounded */
+		if (start == DIMENSION_SLICE_MINVALUE || end == DIMENSION_SLICE_MAXVALUE)
+			return INVALID_ESTIMATE;
+
+		if (start < end)
+		{
+			intervals[num_intervals].start = start;
+			intervals[num_intervals].end = end;
+			num_intervals++;
+		}
+	}
+
+	/* Sum up the union of the intervals, since the slices of space partitions overlap */
+	qsort(intervals, num_intervals, sizeof(TimeInterval), time_interval_cmp);
+
+	for (int i = 0; i < num_intervals;)
+	{
+		int64 start = intervals[i].start;
+		int64 end = intervals[i].end;
+
+		for (i++; i < num_intervals && intervals[i].start <= end; i++)
+			end = Max(end, intervals[i].end);
+
+		spread += (double) end - (double) start;
+	}
+
+	pfree(intervals);
+
+	return spread;
+}
+
+/* Estimate the max spread on a time var in terms of the internal time representation.
+ * Note that this will happen on the hypertable var in most cases, where the spread
+ * is estimated from the chunks that are left after chunk exclusion.
+ */
+static double
+estimate_max_spread_var(PlannerInfo *root, Var *var)
+{
+	int64 max = 0;
+	int64 min = 0;
+	bool valid;
+	double spread;
+
+	valid = get_internal_time_range(root, (Node *) var, var->vartype, &min, &max);
+
+	spread = estimate_max_spread_var_chunks(root, var, valid, min, max);
+	if (IS_VALID_ESTIMATE(spread))
+		return spread;
+
 	if (!valid)
 		return INVALID_ESTIMATE;
 
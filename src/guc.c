@@ -56,6 +56,13 @@ static const struct config_enum_entry hypertable_distributed_types[] = {
 	{ NULL, 0, false }
 };
 
+static const struct config_enum_entry data_node_chunk_assignments[] = {
+	{ "attached", DNCA_Attached, false },
+	{ "balanced", DNCA_Balanced, false },
+	{ "fewest_nodes", DNCA_FewestNodes, false },
+	{ NULL, 0, false }
+};
+
 static const struct config_enum_entry dist_copy_transfer_formats[] = {
 	{ "auto", DCTF_Auto, false },
 	{ "binary", DCTF_Binary, false },
@@ -68,6 +75,11 @@ bool ts_guc_restoring = false;
 bool ts_guc_enable_constraint_aware_append = true;
 bool ts_guc_enable_ordered_append = true;
 bool ts_guc_enable_chunk_append = true;
+bool ts_guc_enable_chunk_slice_cache = true;
+bool ts_guc_enable_chunkwise_aggregation = true;
+TSDLLEXPORT bool ts_guc_enable_hashed_gapfill = true;
+bool ts_guc_enable_planner_stats = false;
+bool ts_guc_enable_hypertable_stats = true;
 bool ts_guc_enable_parallel_chunk_append = true;
 bool ts_guc_enable_runtime_exclusion = true;
 bool ts_guc_enable_constraint_exclusion = true;
@@ -76,18 +88,48 @@ bool ts_guc_enable_cagg_reorder_groupby = true;
 bool ts_guc_enable_now_constify = true;
 bool ts_guc_enable_osm_reads = true;
 TSDLLEXPORT bool ts_guc_enable_dml_decompression = true;
+bool ts_guc_enable_multi_insert = true;
+bool ts_guc_enable_multi_insert_on_conflict = false;
+bool ts_guc_enable_direct_compress_insert = false;
+bool ts_guc_enable_direct_compress_empty_chunks = false;
 TSDLLEXPORT bool ts_guc_enable_transparent_decompression = true;
 TSDLLEXPORT bool ts_guc_enable_decompression_logrep_markers = false;
 TSDLLEXPORT bool ts_guc_enable_decompression_sorted_merge = true;
+TSDLLEXPORT int ts_guc_decompression_sorted_merge_memory = 256 * 1024;
+TSDLLEXPORT int ts_guc_decompressed_batch_cache_size = 0;
 bool ts_guc_enable_per_data_node_queries = true;
 bool ts_guc_enable_parameterized_data_node_scan = true;
 bool ts_guc_enable_async_append = true;
+TSDLLEXPORT bool ts_guc_enable_pipelined_fetching = false;
+TSDLLEXPORT bool ts_guc_enable_async_append_ready_first = false;
+TSDLLEXPORT bool ts_guc_enable_remote_cost_calibration = false;
+TSDLLEXPORT bool ts_guc_enable_remote_plan_cache = false;
 TSDLLEXPORT bool ts_guc_enable_compression_indexscan = true;
 TSDLLEXPORT bool ts_guc_enable_bulk_decompression = true;
+TSDLLEXPORT bool ts_guc_enable_compression_algorithm_selection = true;
+TSDLLEXPORT int ts_guc_compression_batch_rows = 1000;
+TSDLLEXPORT bool ts_guc_enable_compression_freeze = true;
+TSDLLEXPORT int ts_guc_cagg_max_invalidation_ranges = 1;
+TSDLLEXPORT bool ts_guc_enable_cagg_diff_materialization = false;
+TSDLLEXPORT bool ts_guc_enable_cagg_refresh_compression = false;
+TSDLLEXPORT bool ts_guc_enable_vectorized_aggregation = true;
+TSDLLEXPORT bool ts_guc_enable_runtime_filter = false;
+bool ts_guc_enable_last_point_cache = true;
+bool ts_guc_enable_cagg_rewrite = false;
+bool ts_guc_enable_chunk_skipping = true;
 TSDLLEXPORT bool ts_guc_enable_skip_scan = true;
+TSDLLEXPORT bool ts_guc_enable_online_reorder = false;
 /* default value of ts_guc_max_open_chunks_per_insert and ts_guc_max_cached_chunks_per_hypertable
  * will be set as their respective boot-value when the GUC mechanism starts up */
 int ts_guc_max_open_chunks_per_insert;
+int ts_guc_chunk_precreation_threshold = 0;
+bool ts_guc_enable_job_prioritization = false;
+int ts_guc_max_concurrent_jobs_per_class = 0;
+int ts_guc_job_worker_pool_size = 0;
+int ts_guc_job_worker_pool_idle_timeout = 60000;
+int ts_guc_prewarm_recent_chunks = 0;
+int ts_guc_prewarm_memory_limit = -1;
+bool ts_guc_enable_batched_chunk_drop = false;
 int ts_guc_max_cached_chunks_per_hypertable;
 #ifdef USE_TELEMETRY
 TelemetryLevel ts_guc_telemetry_level = TELEMETRY_DEFAULT;
@@ -98,18 +140,28 @@ TSDLLEXPORT char *ts_guc_license = TS_LICENSE_DEFAULT;
 char *ts_last_tune_time = NULL;
 char *ts_last_tune_version = NULL;
 TSDLLEXPORT bool ts_guc_enable_2pc = true;
+TSDLLEXPORT bool ts_guc_enable_single_data_node_1pc = false;
 TSDLLEXPORT int ts_guc_max_insert_batch_size = 1000;
+TSDLLEXPORT bool ts_guc_enable_remote_direct_modify = false;
+int ts_guc_relation_size_cache_ttl = 300000;
+TSDLLEXPORT int ts_guc_data_node_connection_idle_timeout = 0;
+TSDLLEXPORT int ts_guc_data_node_health_check_interval = 0;
+TSDLLEXPORT int ts_guc_chunk_copy_streams = 0;
 TSDLLEXPORT bool ts_guc_enable_connection_binary_data = true;
 TSDLLEXPORT DistCopyTransferFormat ts_guc_dist_copy_transfer_format = DCTF_Auto;
 TSDLLEXPORT bool ts_guc_enable_client_ddl_on_data_nodes = false;
 TSDLLEXPORT char *ts_guc_ssl_dir = NULL;
 TSDLLEXPORT char *ts_guc_passfile = NULL;
 TSDLLEXPORT bool ts_guc_enable_remote_explain = false;
+TSDLLEXPORT bool ts_guc_enable_remote_explain_timing = false;
+TSDLLEXPORT bool ts_guc_enable_node_timing = false;
 TSDLLEXPORT DataFetcherType ts_guc_remote_data_fetcher = AutoFetcherType;
+TSDLLEXPORT DataNodeChunkAssignmentType ts_guc_data_node_chunk_assignment = DNCA_Attached;
 TSDLLEXPORT HypertableDistType ts_guc_hypertable_distributed_default = HYPERTABLE_DIST_AUTO;
 TSDLLEXPORT int ts_guc_hypertable_replication_factor_default = 1;
 
 bool ts_guc_debug_require_batch_sorted_merge = false;
+bool ts_guc_debug_require_vector_qual = false;
 
 #ifdef TS_DEBUG
 bool ts_shutdown_bgw = false;
@@ -294,6 +346,68 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable("timescaledb.enable_chunk_slice_cache",
+							 "Enable caching the chunk dimension slices",
+							 "Cache the dimension slices of the chunks to speed up the chunk "
+							 "exclusion and building the chunks in the planner",
+							 &ts_guc_enable_chunk_slice_cache,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_chunkwise_aggregation",
+							 "Enable chunk-wise aggregation",
+							 "Aggregate each chunk partially and combine the partial results "
+							 "when grouping by a chunk dimension",
+							 &ts_guc_enable_chunkwise_aggregation,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_hashed_gapfill",
+							 "Enable hashed gapfill",
+							 "Fill the gaps of each group from a hash table of the groups, "
+							 "instead of sorting the input of the gapfill node by the group "
+							 "columns and time",
+							 &ts_guc_enable_hashed_gapfill,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_planner_stats",
+							 "Enable collecting planner statistics",
+							 "Collect the time spent in the phases of planning hypertable queries, "
+							 "see _timescaledb_functions.planner_stats()",
+							 &ts_guc_enable_planner_stats,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_hypertable_stats",
+							 "Enable collecting hypertable statistics",
+							 "Collect the counts of the inserted rows, the excluded chunks and the "
+							 "decompressed batches per hypertable, see "
+							 "timescaledb_information.hypertable_stats",
+							 &ts_guc_enable_hypertable_stats,
+							 true,
+							 PGC_SUSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable("timescaledb.enable_parallel_chunk_append",
 							 "Enable parallel chunk append node",
 							 "Enable using parallel aware chunk append node",
@@ -349,6 +463,57 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable("timescaledb.enable_multi_insert",
+							 "Enable multi-insert for INSERT",
+							 "Buffer the tuples of INSERT statements and insert them into "
+							 "the chunks in batches",
+							 &ts_guc_enable_multi_insert,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_multi_insert_on_conflict",
+							 "Enable multi-insert for INSERT ... ON CONFLICT DO NOTHING",
+							 "Buffer the tuples of INSERT ... ON CONFLICT DO NOTHING statements, "
+							 "check them against the arbiter index in batches and insert the "
+							 "remaining ones into the chunks in batches. A concurrent transaction "
+							 "that inserts the same keys can then cause a unique violation",
+							 &ts_guc_enable_multi_insert_on_conflict,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_direct_compress_insert",
+							 "Enable direct insertion into compressed chunks",
+							 "Compress the tuples inserted into compressed chunks into new "
+							 "batches instead of writing them to the uncompressed chunk",
+							 &ts_guc_enable_direct_compress_insert,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_direct_compress_empty_chunks",
+							 "Enable direct insertion into empty chunks as compressed batches",
+							 "Compress the tuples inserted into empty chunks of hypertables with "
+							 "compression enabled into batches of a new compressed chunk, "
+							 "without writing them to the uncompressed chunk",
+							 &ts_guc_enable_direct_compress_empty_chunks,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable("timescaledb.enable_transparent_decompression",
 							 "Enable transparent decompression",
 							 "Enable transparent decompression when querying hypertable",
@@ -396,6 +561,37 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomIntVariable("timescaledb.decompression_sorted_merge_memory",
+							"Sets the max memory for the compressed batches heap merge",
+							"When the batches that are open at the same time use more memory, "
+							"the heap merge falls back to sorting the rest of the chunk. "
+							"Zero disables the limit",
+							&ts_guc_decompression_sorted_merge_memory,
+							256 * 1024,
+							0,
+							MAX_KILOBYTES,
+							PGC_USERSET,
+							GUC_UNIT_KB,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("timescaledb.decompressed_batch_cache_size",
+							"Sets the size of the cache of decompressed batches",
+							"The backend keeps the results of bulk decompression of the "
+							"recently read compressed batches in memory, so that the repeated "
+							"queries over the same data don't have to decompress them again. "
+							"Zero disables the cache",
+							&ts_guc_decompressed_batch_cache_size,
+							0,
+							0,
+							MAX_KILOBYTES,
+							PGC_USERSET,
+							GUC_UNIT_KB,
+							NULL,
+							NULL,
+							NULL);
+
 	DefineCustomBoolVariable("timescaledb.enable_cagg_reorder_groupby",
 							 "Enable group by reordering",
 							 "Enable group by clause reordering for continuous aggregates",
@@ -429,6 +625,19 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable("timescaledb.enable_single_data_node_1pc",
+							 "Enable one-phase commit for transactions on a single data node",
+							 "Commit a distributed transaction with one-phase commit if it "
+							 "involves a single data node and did not write on the access node, "
+							 "which saves a round trip and the persistent commit record",
+							 &ts_guc_enable_single_data_node_1pc,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable("timescaledb.enable_per_data_node_queries",
 							 "Enable the per data node query optimization for hypertables",
 							 "Enable the optimization that combines different chunks belonging to "
@@ -482,6 +691,87 @@ _guc_init(void)
 							NULL,
 							NULL);
 
+	DefineCustomBoolVariable("timescaledb.enable_remote_direct_modify",
+							 "Push down UPDATE and DELETE of whole chunks to data nodes",
+							 "Send a single UPDATE or DELETE statement per chunk to the data "
+							 "nodes, instead of fetching the rows to the access node and "
+							 "modifying them one at a time, when the new values and the WHERE "
+							 "clause can be evaluated on the data nodes and there is no "
+							 "RETURNING clause",
+							 &ts_guc_enable_remote_direct_modify,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomIntVariable("timescaledb.data_node_connection_idle_timeout",
+							"Idle time after which a cached data node connection is closed",
+							"Close the cached connections to data nodes that have not been used "
+							"for this long at the end of a transaction, so that a session does "
+							"not keep connections, and their memory on the data nodes, for "
+							"data nodes and users it no longer uses. Setting this to 0 keeps "
+							"the connections until the session ends",
+							&ts_guc_data_node_connection_idle_timeout,
+							0,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_UNIT_MS,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("timescaledb.relation_size_cache_ttl",
+							"Time for which the cached relation sizes are used",
+							"Use the sizes of the hypertables, chunks and their indexes and "
+							"TOAST tables measured within this time by the size functions, "
+							"unless the relations have been changed by inserts or compression "
+							"since. Setting this to 0 disables the cache",
+							&ts_guc_relation_size_cache_ttl,
+							300000,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_UNIT_MS,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("timescaledb.data_node_health_check_interval",
+							"Interval between health checks of data nodes",
+							"Check the data nodes of a distributed hypertable when planning a "
+							"query on it, at most once per interval, and read the chunks of "
+							"data nodes that do not accept connections from their replicas. "
+							"Setting this to 0 disables the health checks",
+							&ts_guc_data_node_health_check_interval,
+							0,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_UNIT_MS,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("timescaledb.chunk_copy_streams",
+							"Number of parallel COPY streams used to copy or move a chunk",
+							"Copy the data of a chunk between data nodes with this number of "
+							"parallel binary COPY streams per table through the access node, "
+							"instead of with logical replication. The data is copied from a "
+							"snapshot, so writes to the chunk during the copy are not copied. "
+							"Setting this to 0 uses logical replication",
+							&ts_guc_chunk_copy_streams,
+							0,
+							0,
+							64,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
 	DefineCustomBoolVariable("timescaledb.enable_connection_binary_data",
 							 "Enable binary format for connection",
 							 "Enable binary format for data exchanged between nodes in the cluster",
@@ -499,10 +789,16 @@ _guc_init(void)
 	 * which greatly reduces the CPU usage. Ideally we would implement the same
 	 * optimization for binary, but the Postgres COPY code doesn't provide
 	 * enough APIs for that.
+	 *
+	 * With 'binary', text and CSV input is parsed into datums on the access
+	 * node and sent in binary format, which moves the parsing work from the
+	 * data nodes to the access node.
 	 */
 	DefineCustomEnumVariable("timescaledb.dist_copy_transfer_format",
 							 "Data format used by distributed COPY to send data to data nodes",
-							 "auto, binary or text",
+							 "auto, binary or text. With auto, input is sent in its own format. "
+							 "With binary, text input is converted to binary on the access node, "
+							 "so that data nodes do not have to parse it",
 							 (int *) &ts_guc_dist_copy_transfer_format,
 							 DCTF_Auto,
 							 dist_copy_transfer_formats,
@@ -535,6 +831,57 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable("timescaledb.enable_async_append_ready_first",
+							 "Read from the first data node that has data ready",
+							 "Let an unordered async append return tuples from whichever data "
+							 "node has data ready instead of reading the data nodes in order",
+							 &ts_guc_enable_async_append_ready_first,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_remote_cost_calibration",
+							 "Calibrate the cost of data node scans",
+							 "Track the startup and per-row times of the scans on each data "
+							 "node and use them to estimate the startup cost of later scans on "
+							 "the data node",
+							 &ts_guc_enable_remote_cost_calibration,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_remote_plan_cache",
+							 "Cache the plans of data node queries",
+							 "Keep the statements of the prepared statement fetcher prepared "
+							 "on the data node connection, so that repeated queries are not "
+							 "parsed and planned again on the data nodes",
+							 &ts_guc_enable_remote_plan_cache,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_pipelined_fetching",
+							 "Enable pipelined fetching of data from data nodes",
+							 "Request the next batch of a cursor while the current batch is "
+							 "consumed, and adapt the fetch size to the row width and the time "
+							 "spent waiting for data nodes",
+							 &ts_guc_enable_pipelined_fetching,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable("timescaledb.enable_remote_explain",
 							 "Show explain from remote nodes when using VERBOSE flag",
 							 "Enable getting and showing EXPLAIN output from remote nodes",
@@ -546,6 +893,31 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable("timescaledb.enable_remote_explain_timing",
+							 "Show where the time of data node scans went with EXPLAIN ANALYZE",
+							 "Show the connection, fetch and conversion times, batches and "
+							 "bytes of each data node scan, and the time an async append waited "
+							 "for the slowest data node, in EXPLAIN ANALYZE output",
+							 &ts_guc_enable_remote_explain_timing,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_node_timing",
+							 "Show the time of the internal phases of custom nodes",
+							 "Show where the time of the DecompressChunk, ChunkAppend, GapFill "
+							 "and SkipScan nodes went in EXPLAIN (ANALYZE, VERBOSE) output",
+							 &ts_guc_enable_node_timing,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable("timescaledb.enable_compression_indexscan",
 							 "Enable compression to take indexscan path",
 							 "Enable indexscan during compression, if matching index is found",
@@ -569,6 +941,168 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable("timescaledb.enable_compression_algorithm_selection",
+							 "Enable the selection of compression algorithm by the data",
+							 "Try alternative compression algorithms on the first batches of "
+							 "each column, and use the one that produces the smallest output",
+							 &ts_guc_enable_compression_algorithm_selection,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	/* The maximum must not exceed GLOBAL_MAX_ROWS_PER_COMPRESSION. */
+	DefineCustomIntVariable("timescaledb.compression_batch_rows",
+							"The max number of rows in a compressed batch",
+							"The compression splits the chunk into batches of up to this "
+							"number of rows. Larger batches reduce the per-batch overhead "
+							"of the queries that scan a lot of compressed data",
+							&ts_guc_compression_batch_rows,
+							1000,
+							1,
+							16384,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_compression_freeze",
+							 "Enable freezing the tuples of new compressed chunks",
+							 "Insert the compressed tuples frozen and all-visible when the "
+							 "compressed chunk was created in the same transaction, so that "
+							 "vacuum does not have to write its pages again",
+							 &ts_guc_enable_compression_freeze,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	/* The maximum must not exceed CA_CACHE_INVAL_MAX_RANGES. */
+	DefineCustomIntVariable("timescaledb.cagg_max_invalidation_ranges",
+							"The max number of invalidated ranges per hypertable and transaction",
+							"Modifications of a hypertable with continuous aggregates are "
+							"tracked as up to this number of disjoint time ranges per "
+							"transaction, aligned to the buckets of the continuous aggregates. "
+							"The default of 1 invalidates everything between the lowest and "
+							"the greatest modified time value",
+							&ts_guc_cagg_max_invalidation_ranges,
+							1,
+							1,
+							64,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_cagg_diff_materialization",
+							 "Enable writing only the changed buckets on refresh",
+							 "Refreshing a continuous aggregate compares the new aggregate "
+							 "rows with the materialized rows and only deletes and inserts the "
+							 "rows that differ, instead of rewriting all the rows of the "
+							 "refreshed range",
+							 &ts_guc_enable_cagg_diff_materialization,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_cagg_refresh_compression",
+							 "Enable compressing the refreshed chunks on refresh",
+							 "Refreshing a continuous aggregate with a compression policy "
+							 "compresses the refreshed chunks of the materialization hypertable "
+							 "that are older than the compress_after of the policy, instead of "
+							 "leaving them to the next run of the compression policy",
+							 &ts_guc_enable_cagg_refresh_compression,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_online_reorder",
+							 "Enable reordering chunks without blocking writes",
+							 "Copy a chunk that is reordered, or moved, under a lock that "
+							 "allows concurrent writes, and only block other sessions while "
+							 "the reordered data is swapped in. The reorder fails if the "
+							 "chunk was modified during the copy",
+							 &ts_guc_enable_online_reorder,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_vectorized_aggregation",
+							 "Enable vectorized aggregation",
+							 "Enable vectorized aggregation for compressed data",
+							 &ts_guc_enable_vectorized_aggregation,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_runtime_filter",
+							 "Enable runtime filters from hash joins",
+							 "Enable skipping the compressed batches that can't match the inner "
+							 "side of a hash join, using a filter built from its hash keys",
+							 &ts_guc_enable_runtime_filter,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_last_point_cache",
+							 "Enable reading from the last point caches",
+							 "Enable answering the queries for the latest row of each series "
+							 "from the last point cache of the hypertable",
+							 &ts_guc_enable_last_point_cache,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_cagg_rewrite",
+							 "Enable reading from the continuous aggregates",
+							 "Enable answering the aggregate queries on a hypertable from a "
+							 "matching real-time continuous aggregate. The results reflect the "
+							 "materialized data, which can lag behind the hypertable until the "
+							 "continuous aggregate is refreshed",
+							 &ts_guc_enable_cagg_rewrite,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_chunk_skipping",
+							 "Enable chunk skipping on the tracked column ranges",
+							 "Enable excluding the chunks whose tracked range of a column, see "
+							 "enable_chunk_skipping(), contradicts the query restrictions",
+							 &ts_guc_enable_chunk_skipping,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomEnumVariable("timescaledb.remote_data_fetcher",
 							 "Set remote data fetcher type",
 							 "Pick data fetcher type based on type of queries you plan to run "
@@ -582,6 +1116,20 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomEnumVariable("timescaledb.data_node_chunk_assignment",
+							 "Set how replicated chunks are assigned to data nodes for reads",
+							 "Read each chunk from the data node it is attached to (attached), "
+							 "spread the chunks over their replicas (balanced), or read the "
+							 "chunks from as few data nodes as possible (fewest_nodes)",
+							 (int *) &ts_guc_data_node_chunk_assignment,
+							 DNCA_Attached,
+							 data_node_chunk_assignments,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomStringVariable("timescaledb.ssl_dir",
 							   "TimescaleDB user certificate directory",
 							   "Determines a path which is used to search user certificates and "
@@ -619,6 +1167,127 @@ _guc_init(void)
 							assign_max_open_chunks_per_insert_hook,
 							NULL);
 
+	DefineCustomIntVariable("timescaledb.chunk_precreation_threshold",
+							"Percentage of the chunk interval to create the next chunk at",
+							"Create the next chunk in time once the inserts are past this "
+							"percentage of the time interval of the current chunk. Zero disables "
+							"creating the chunks ahead of time",
+							&ts_guc_chunk_precreation_threshold,
+							0,
+							0,
+							99,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_job_prioritization",
+							 "Enable prioritizing the due background jobs",
+							 "Start the background jobs that are due in the order of their job "
+							 "class, continuous aggregate refreshes first and compression last, "
+							 "and then of their average runtime, instead of the order in which "
+							 "they became due",
+							 &ts_guc_enable_job_prioritization,
+							 false,
+							 PGC_SIGHUP,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomIntVariable("timescaledb.max_concurrent_jobs_per_class",
+							"Maximum concurrently running background jobs per job class",
+							"Maximum number of background jobs of the same class, e.g., "
+							"compression policies, that a scheduler runs at the same time, so "
+							"that they cannot take all the background workers. Zero means no "
+							"limit",
+							&ts_guc_max_concurrent_jobs_per_class,
+							0,
+							0,
+							1000,
+							PGC_SIGHUP,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("timescaledb.job_worker_pool_size",
+							"Number of pooled background job workers per database",
+							"Number of background workers that a scheduler keeps running after "
+							"their job has finished, to run the next jobs of the same owner "
+							"without starting a new process. Idle pooled workers are not counted "
+							"against timescaledb.max_background_workers, so max_worker_processes "
+							"needs room for them. The number of workers is fixed when the "
+							"scheduler first uses the pool. Zero disables the pool",
+							&ts_guc_job_worker_pool_size,
+							0,
+							0,
+							1000,
+							PGC_SIGHUP,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("timescaledb.job_worker_pool_idle_timeout",
+							"Idle time after which a pooled job worker exits",
+							"Time that a pooled background job worker waits for a new job "
+							"before it exits",
+							&ts_guc_job_worker_pool_idle_timeout,
+							60000,
+							1,
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_UNIT_MS,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("timescaledb.prewarm_recent_chunks",
+							"Number of recent chunks to prewarm per hypertable",
+							"Number of the latest chunks of each hypertable and continuous "
+							"aggregate that a worker reads into the shared buffers, together with "
+							"their indexes, when the scheduler of a database starts. Zero "
+							"disables prewarming",
+							&ts_guc_prewarm_recent_chunks,
+							0,
+							0,
+							1000,
+							PGC_SIGHUP,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("timescaledb.prewarm_memory_limit",
+							"Maximum amount of data to prewarm per database",
+							"Maximum amount of data that the prewarm worker of a database reads "
+							"into the shared buffers. -1 uses a quarter of shared_buffers",
+							&ts_guc_prewarm_memory_limit,
+							-1,
+							-1,
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_UNIT_BLOCKS,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_batched_chunk_drop",
+							 "Enable dropping chunks in batches",
+							 "Drop all the chunks of a drop_chunks call or a retention policy "
+							 "together, locking them in a consistent order up front and "
+							 "deleting their catalog rows with a single scan, instead of "
+							 "dropping them one at a time",
+							 &ts_guc_enable_batched_chunk_drop,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomIntVariable("timescaledb.max_cached_chunks_per_hypertable",
 							"Maximum cached chunks",
 							"Maximum number of chunks stored in the cache",
@@ -724,6 +1393,17 @@ _guc_init(void)
 							 /* check_hook= */ NULL,
 							 /* assign_hook= */ NULL,
 							 /* show_hook= */ NULL);
+
+	DefineCustomBoolVariable(/* name= */ "timescaledb.debug_require_vector_qual",
+							 /* short_desc= */ "require that all DecompressChunk quals are vectorized",
+							 /* long_desc= */ "this is for debugging purposes",
+							 /* valueAddr= */ &ts_guc_debug_require_vector_qual,
+							 /* bootValue= */ false,
+							 /* context= */ PGC_USERSET,
+							 /* flags= */ 0,
+							 /* check_hook= */ NULL,
+							 /* assign_hook= */ NULL,
+							 /* show_hook= */ NULL);
 #endif
 
 	DefineCustomEnumVariable("timescaledb.hypertable_distributed_default",
@@ -19,6 +19,11 @@ extern bool ts_guc_enable_optimizations;
 extern bool ts_guc_enable_constraint_aware_append;
 extern bool ts_guc_enable_ordered_append;
 extern bool ts_guc_enable_chunk_append;
+extern bool ts_guc_enable_chunk_slice_cache;
+extern bool ts_guc_enable_chunkwise_aggregation;
+extern TSDLLEXPORT bool ts_guc_enable_hashed_gapfill;
+extern bool ts_guc_enable_planner_stats;
+extern bool ts_guc_enable_hypertable_stats;
 extern bool ts_guc_enable_parallel_chunk_append;
 extern bool ts_guc_enable_qual_propagation;
 extern bool ts_guc_enable_runtime_exclusion;
@@ -27,15 +32,34 @@ extern bool ts_guc_enable_cagg_reorder_groupby;
 extern bool ts_guc_enable_now_constify;
 extern bool ts_guc_enable_osm_reads;
 extern TSDLLEXPORT bool ts_guc_enable_dml_decompression;
+extern bool ts_guc_enable_multi_insert;
+extern bool ts_guc_enable_multi_insert_on_conflict;
+extern bool ts_guc_enable_direct_compress_insert;
+extern bool ts_guc_enable_direct_compress_empty_chunks;
 extern TSDLLEXPORT bool ts_guc_enable_transparent_decompression;
 extern TSDLLEXPORT bool ts_guc_enable_decompression_logrep_markers;
 extern TSDLLEXPORT bool ts_guc_enable_decompression_sorted_merge;
+extern TSDLLEXPORT int ts_guc_decompression_sorted_merge_memory;
+extern TSDLLEXPORT int ts_guc_decompressed_batch_cache_size;
 extern TSDLLEXPORT bool ts_guc_enable_per_data_node_queries;
 extern TSDLLEXPORT bool ts_guc_enable_parameterized_data_node_scan;
 extern TSDLLEXPORT bool ts_guc_enable_async_append;
+extern TSDLLEXPORT bool ts_guc_enable_pipelined_fetching;
+extern TSDLLEXPORT bool ts_guc_enable_async_append_ready_first;
+extern TSDLLEXPORT bool ts_guc_enable_remote_cost_calibration;
+extern TSDLLEXPORT bool ts_guc_enable_remote_plan_cache;
 extern TSDLLEXPORT bool ts_guc_enable_skip_scan;
+extern TSDLLEXPORT bool ts_guc_enable_online_reorder;
 extern bool ts_guc_restoring;
 extern int ts_guc_max_open_chunks_per_insert;
+extern int ts_guc_chunk_precreation_threshold;
+extern bool ts_guc_enable_job_prioritization;
+extern int ts_guc_max_concurrent_jobs_per_class;
+extern int ts_guc_job_worker_pool_size;
+extern int ts_guc_job_worker_pool_idle_timeout;
+extern int ts_guc_prewarm_recent_chunks;
+extern int ts_guc_prewarm_memory_limit;
+extern bool ts_guc_enable_batched_chunk_drop;
 extern int ts_guc_max_cached_chunks_per_hypertable;
 
 #ifdef USE_TELEMETRY
@@ -54,14 +78,33 @@ extern TSDLLEXPORT char *ts_guc_license;
 extern char *ts_last_tune_time;
 extern char *ts_last_tune_version;
 extern TSDLLEXPORT bool ts_guc_enable_2pc;
+extern TSDLLEXPORT bool ts_guc_enable_single_data_node_1pc;
 extern TSDLLEXPORT int ts_guc_max_insert_batch_size;
+extern TSDLLEXPORT bool ts_guc_enable_remote_direct_modify;
+extern TSDLLEXPORT int ts_guc_data_node_connection_idle_timeout;
+extern int ts_guc_relation_size_cache_ttl;
+extern TSDLLEXPORT int ts_guc_data_node_health_check_interval;
+extern TSDLLEXPORT int ts_guc_chunk_copy_streams;
 extern TSDLLEXPORT bool ts_guc_enable_connection_binary_data;
 extern TSDLLEXPORT bool ts_guc_enable_client_ddl_on_data_nodes;
 extern TSDLLEXPORT char *ts_guc_ssl_dir;
 extern TSDLLEXPORT char *ts_guc_passfile;
 extern TSDLLEXPORT bool ts_guc_enable_remote_explain;
+extern TSDLLEXPORT bool ts_guc_enable_remote_explain_timing;
+extern TSDLLEXPORT bool ts_guc_enable_node_timing;
 extern TSDLLEXPORT bool ts_guc_enable_compression_indexscan;
 extern TSDLLEXPORT bool ts_guc_enable_bulk_decompression;
+extern TSDLLEXPORT bool ts_guc_enable_compression_algorithm_selection;
+extern TSDLLEXPORT int ts_guc_compression_batch_rows;
+extern TSDLLEXPORT bool ts_guc_enable_compression_freeze;
+extern TSDLLEXPORT int ts_guc_cagg_max_invalidation_ranges;
+extern TSDLLEXPORT bool ts_guc_enable_cagg_diff_materialization;
+extern TSDLLEXPORT bool ts_guc_enable_cagg_refresh_compression;
+extern TSDLLEXPORT bool ts_guc_enable_vectorized_aggregation;
+extern TSDLLEXPORT bool ts_guc_enable_runtime_filter;
+extern bool ts_guc_enable_last_point_cache;
+extern bool ts_guc_enable_cagg_rewrite;
+extern bool ts_guc_enable_chunk_skipping;
 
 typedef enum DataFetcherType
 {
@@ -92,6 +135,15 @@ typedef enum DistCopyTransferFormat
 
 extern TSDLLEXPORT DistCopyTransferFormat ts_guc_dist_copy_transfer_format;
 
+typedef enum DataNodeChunkAssignmentType
+{
+	DNCA_Attached,
+	DNCA_Balanced,
+	DNCA_FewestNodes
+} DataNodeChunkAssignmentType;
+
+extern TSDLLEXPORT DataNodeChunkAssignmentType ts_guc_data_node_chunk_assignment;
+
 /* Hook for plugins to allow additional SSL options */
 typedef void (*set_ssl_options_hook_type)(const char *user_name);
 extern TSDLLEXPORT set_ssl_options_hook_type ts_set_ssl_options_hook;
@@ -104,6 +156,7 @@ extern char *ts_current_timestamp_mock;
 #endif
 
 extern TSDLLEXPORT bool ts_guc_debug_require_batch_sorted_merge;
+extern TSDLLEXPORT bool ts_guc_debug_require_vector_qual;
 
 void _guc_init(void);
 void _guc_fini(void);
@@ -13,6 +13,7 @@
 #include <libpq/pqformat.h>
 
 #include "compat/compat.h"
+#include "histogram.h"
 #include "utils.h"
 #include "debug_assert.h"
 
@@ -44,17 +45,49 @@ typedef struct Histogram
 	Datum buckets[FLEXIBLE_ARRAY_MEMBER];
 } Histogram;
 
+/*
+ * Check the arguments of histogram() the same way width_bucket() does, so that
+ * we can compute the buckets with ts_hist_bucket().
+ */
+TSDLLEXPORT void
+ts_hist_check_args(float8 min, float8 max, int32 nbuckets)
+{
+	if (min > max)
+	{
+		/* cannot generate a histogram with incompatible bounds */
+		elog(ERROR, "lower bound cannot exceed upper bound");
+	}
+
+	if (nbuckets <= 0 || nbuckets > PG_INT32_MAX - 2)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+				 errmsg("count must be greater than zero")));
+
+	if (isnan(min) || isnan(max))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+				 errmsg("operand, lower bound, and upper bound cannot be NaN")));
+
+	if (isinf(min) || isinf(max))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+				 errmsg("lower and upper bounds must be finite")));
+
+	if (min == max)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+				 errmsg("lower bound cannot equal upper bound")));
+}
+
 /* histogram(state, val, min, max, nbuckets) */
 Datum
 ts_hist_sfunc(PG_FUNCTION_ARGS)
 {
 	MemoryContext aggcontext;
 	Histogram *state = (Histogram *) (PG_ARGISNULL(0) ? NULL : PG_GETARG_POINTER(0));
-	Datum val_datum = PG_GETARG_DATUM(1);
-	Datum min_datum = PG_GETARG_DATUM(2);
-	Datum max_datum = PG_GETARG_DATUM(3);
-	double min = DatumGetFloat8(min_datum);
-	double max = DatumGetFloat8(max_datum);
+	double val = PG_GETARG_FLOAT8(1);
+	double min = PG_GETARG_FLOAT8(2);
+	double max = PG_GETARG_FLOAT8(3);
 	int nbuckets;
 
 	if (!AggCheckCallContext(fcinfo, &aggcontext))
@@ -63,11 +96,12 @@ ts_hist_sfunc(PG_FUNCTION_ARGS)
 		elog(ERROR, "ts_hist_sfunc called in non-aggregate context");
 	}
 
-	if (min > max)
-	{
-		/* cannot generate a histogram with incompatible bounds */
-		elog(ERROR, "lower bound cannot exceed upper bound");
-	}
+	ts_hist_check_args(min, max, PG_GETARG_INT32(4));
+
+	if (isnan(val))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+				 errmsg("operand, lower bound, and upper bound cannot be NaN")));
 
 	if (state == NULL)
 	{
@@ -85,11 +119,7 @@ ts_hist_sfunc(PG_FUNCTION_ARGS)
 	if (nbuckets != PG_GETARG_INT32(4))
 		elog(ERROR, "number of buckets must not change between calls");
 
-	int32 bucket = DatumGetInt32(DirectFunctionCall4(width_bucket_float8,
-													 val_datum,
-													 min_datum,
-													 max_datum,
-													 Int32GetDatum(nbuckets)));
+	int32 bucket = ts_hist_bucket(val, min, max, nbuckets);
 
 	/* Increment the proper histogram bucket */
 	if (bucket < 0 || bucket >= state->nbuckets)
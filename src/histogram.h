@@ -0,0 +1,45 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_HISTOGRAM_H
+#define TIMESCALEDB_HISTOGRAM_H
+
+#include <postgres.h>
+#include <math.h>
+
+#include "export.h"
+
+extern TSDLLEXPORT void ts_hist_check_args(float8 min, float8 max, int32 nbuckets);
+
+/*
+ * The histogram bucket of a value, the same as width_bucket(val, min, max,
+ * nbuckets). The arguments have to be checked with ts_hist_check_args(), and
+ * the value must not be NaN. This is a separate inline function so that the
+ * vectorized aggregation can compute the buckets for a whole batch in a loop.
+ */
+static pg_attribute_always_inline int32
+ts_hist_bucket(float8 val, float8 min, float8 max, int32 nbuckets)
+{
+	if (val < min)
+		return 0;
+
+	if (val >= max)
+		return nbuckets + 1;
+
+	/* The quotient is in [0, 1], so this can't overflow */
+	int32 bucket;
+	if (!isinf(max - min))
+		bucket = (int32) (nbuckets * ((val - min) / (max - min)));
+	else
+		bucket = (int32) (nbuckets * ((val / 2 - min / 2) / (max / 2 - min / 2)));
+
+	/* The quotient could round to 1.0 */
+	if (bucket >= nbuckets)
+		bucket = nbuckets - 1;
+
+	return bucket + 1;
+}
+
+#endif /* TIMESCALEDB_HISTOGRAM_H */
@@ -78,6 +78,23 @@ ts_hypercube_copy(const Hypercube *hc)
 	return copy;
 }
 
+/*
+ * Check whether the point lies within the hypercube. The slices are in the
+ * dimension order, the same as the point coordinates.
+ */
+bool
+ts_hypercube_contains_point(const Hypercube *hc, const Point *p)
+{
+	if (hc->num_slices != p->cardinality)
+		return false;
+
+	for (int i = 0; i < hc->num_slices; i++)
+		if (ts_dimension_slice_cmp_coordinate(hc->slices[i], p->coordinates[i]) != 0)
+			return false;
+
+	return true;
+}
+
 bool
 ts_hypercube_equal(const Hypercube *hc1, const Hypercube *hc2)
 {
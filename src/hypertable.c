@@ -48,6 +48,7 @@
 #include "ts_catalog/hypertable_compression.h"
 #include "subspace_store.h"
 #include "hypertable_cache.h"
+#include "hypertable_stats.h"
 #include "trigger.h"
 #include "scanner.h"
 #include "ts_catalog/catalog.h"
@@ -60,7 +61,9 @@
 #include "copy.h"
 #include "utils.h"
 #include "bgw_policy/policy.h"
+#include "ts_catalog/chunk_column_stats.h"
 #include "ts_catalog/continuous_agg.h"
+#include "last_point_cache.h"
 #include "license_guc.h"
 #include "cross_module_fn.h"
 #include "scan_iterator.h"
@@ -255,6 +258,8 @@ ts_hypertable_from_tupleinfo(const TupleInfo *ti)
 		ts_subspace_store_init(h->space, ti->mctx, ts_guc_max_cached_chunks_per_hypertable);
 	h->chunk_sizing_func = get_chunk_sizing_func_oid(&h->fd);
 	h->data_nodes = ts_hypertable_data_node_scan(h->fd.id, ti->mctx);
+	h->range_space =
+		ts_chunk_column_stats_range_space_scan(h->fd.id, h->main_table_relid, ti->mctx);
 
 	return h;
 }
@@ -672,6 +677,10 @@ hypertable_tuple_delete(TupleInfo *ti, void *data)
 	/* remove any associated compression definitions */
 	ts_hypertable_compression_delete_by_hypertable_id(hypertable_id);
 
+	ts_hypertable_stats_drop(hypertable_id);
+	ts_last_point_cache_delete_by_hypertable_id(hypertable_id);
+	ts_chunk_column_stats_delete_by_hypertable_id(hypertable_id);
+
 	if (!compressed_hypertable_id_isnull)
 	{
 		Hypertable *compressed_hypertable = ts_hypertable_get_by_id(compressed_hypertable_id);
@@ -1126,7 +1135,8 @@ hypertable_chunk_store_add(const Hypertable *h, const Chunk *input_chunk)
 	ts_subspace_store_add(h->chunk_cache,
 						  cached_chunk->cube,
 						  cached_chunk,
-						  hypertable_chunk_store_free);
+						  hypertable_chunk_store_free,
+						  1);
 	MemoryContextSwitchTo(old_mcxt);
 
 	return cached_chunk;
@@ -1146,6 +1156,9 @@ ts_hypertable_create_chunk_for_point(const Hypertable *h, const Point *point, bo
 											 NameStr(h->fd.associated_schema_name),
 											 NameStr(h->fd.associated_table_prefix));
 
+	if (!*found)
+		ts_hypertable_stats_add(h->fd.id, HYPERTABLE_STATS_CHUNKS_CREATED, 1);
+
 	/* Also add the chunk to the hypertable's chunk store */
 	Chunk *cached_chunk = hypertable_chunk_store_add(h, chunk);
 	return cached_chunk;
@@ -2257,13 +2270,13 @@ ts_hypertable_create_from_info(Oid table_relid, int32 hypertable_id, uint32 flag
 		hypertable_create_schema(NameStr(*associated_schema_name));
 
 	/*
-	 * Hypertables do not support transition tables in triggers, so if the
+	 * Hypertables do not support transition tables in row triggers, so if the
 	 * table already has such triggers we bail out
 	 */
-	if (ts_relation_has_transition_table_trigger(table_relid))
+	if (ts_relation_has_row_transition_table_trigger(table_relid))
 		ereport(ERROR,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-				 errmsg("hypertables do not support transition tables in triggers")));
+				 errmsg("hypertables do not support transition tables in row triggers")));
 
 	if (NULL == chunk_sizing_info)
 		chunk_sizing_info = ts_chunk_sizing_info_get_default_disabled(table_relid);
@@ -3026,10 +3039,10 @@ ts_hypertable_update_dimension_partitions(const Hypertable *ht)
 		if (hypertable_is_distributed(ht))
 			data_node_names = ts_hypertable_get_available_data_node_names(ht, false);
 
-		ts_dimension_partition_info_recreate(space_dim->fd.id,
-											 space_dim->fd.num_slices,
-											 data_node_names,
-											 ht->fd.replication_factor);
+		ts_dimension_partition_info_update(space_dim->fd.id,
+										   space_dim->fd.num_slices,
+										   data_node_names,
+										   ht->fd.replication_factor);
 		return true;
 	}
 
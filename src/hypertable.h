@@ -59,6 +59,11 @@ typedef struct Hypertable
 	 * use all available data nodes.
 	 */
 	List *data_nodes;
+	/*
+	 * The columns that have their ranges tracked per chunk, or NULL if there
+	 * are none, see chunk_column_stats.c.
+	 */
+	struct ChunkRangeSpace *range_space;
 } Hypertable;
 
 /* create_hypertable record attribute numbers */
@@ -11,6 +11,7 @@
 
 #include "errors.h"
 #include "hypertable_cache.h"
+#include "hypertable_stats.h"
 #include "hypertable.h"
 #include "ts_catalog/catalog.h"
 #include "cache.h"
@@ -35,10 +36,15 @@ hypertable_cache_get_key(CacheQuery *query)
 	return &((HypertableCacheQuery *) query)->relid;
 }
 
+/*
+ * Each hypertable is built on its own memory context, so that the entry can
+ * be invalidated separately from the other entries of the cache.
+ */
 typedef struct
 {
 	Oid relid;
 	Hypertable *hypertable;
+	MemoryContext mctx;
 } HypertableCacheEntry;
 
 static bool
@@ -82,6 +88,17 @@ hypertable_cache_create()
 
 static Cache *hypertable_cache_current = NULL;
 
+/*
+ * The memory contexts of the entries that were invalidated while the cache was
+ * pinned. The pinned users might still reference them, so they are freed when
+ * the cache is pinned the next time without any other pins. They're children
+ * of the cache memory context, so they go away with the cache in any case.
+ */
+static List *hypertable_cache_removed_mctxs = NIL;
+
+/* Set while building entries, when the hash table entry is not complete */
+static int hypertable_cache_creating_entries = 0;
+
 static ScanTupleResult
 hypertable_tuple_found(TupleInfo *ti, void *data)
 {
@@ -98,25 +115,43 @@ hypertable_cache_create_entry(Cache *cache, CacheQuery *query)
 	HypertableCacheEntry *cache_entry = query->result;
 	int number_found;
 
+	/*
+	 * Invalidations can be processed while looking up the relation and
+	 * scanning the catalogs, and the hash table entry must not be removed from
+	 * under us then.
+	 */
+	hypertable_cache_creating_entries++;
+
 	if (NULL == hq->schema)
 		hq->schema = get_namespace_name(get_rel_namespace(hq->relid));
 
 	if (NULL == hq->table)
 		hq->table = get_rel_name(hq->relid);
 
+	cache_entry->hypertable = NULL;
+	cache_entry->mctx = AllocSetContextCreate(ts_cache_memory_ctx(cache),
+											  "Hypertable cache entry",
+											  ALLOCSET_SMALL_SIZES);
+
 	number_found = ts_hypertable_scan_with_memory_context(hq->schema,
 														  hq->table,
 														  hypertable_tuple_found,
 														  query->result,
 														  AccessShareLock,
 														  false,
-														  ts_cache_memory_ctx(cache));
+														  cache_entry->mctx);
+
+	/* A full invalidation while scanning resets the counter */
+	if (hypertable_cache_creating_entries > 0)
+		hypertable_cache_creating_entries--;
 
 	switch (number_found)
 	{
 		case 0:
 			/* Negative cache entry: table is not a hypertable */
 			cache_entry->hypertable = NULL;
+			MemoryContextDelete(cache_entry->mctx);
+			cache_entry->mctx = NULL;
 			break;
 		case 1:
 			Assert(strncmp(cache_entry->hypertable->fd.schema_name.data, hq->schema, NAMEDATALEN) ==
@@ -153,6 +188,54 @@ ts_hypertable_cache_invalidate_callback(void)
 {
 	ts_cache_invalidate(hypertable_cache_current);
 	hypertable_cache_current = hypertable_cache_create();
+
+	/* The removed entries belonged to the old cache */
+	hypertable_cache_removed_mctxs = NIL;
+	hypertable_cache_creating_entries = 0;
+}
+
+/*
+ * Invalidate the cache entry of a single table, after a relcache invalidation
+ * of it. Changes of the catalog that only affect one hypertable are signaled
+ * this way, so that the other hypertables stay cached.
+ *
+ * If the cache is pinned, the users might still reference the hypertable, so
+ * we only remove the entry from the hash table and keep its memory until the
+ * cache isn't pinned anymore.
+ */
+void
+ts_hypertable_cache_invalidate_relid(Oid relid)
+{
+	Cache *cache = hypertable_cache_current;
+	HypertableCacheEntry *entry;
+
+	if (cache == NULL)
+		return;
+
+	if (hypertable_cache_creating_entries > 0)
+	{
+		ts_hypertable_cache_invalidate_callback();
+		return;
+	}
+
+	entry = hash_search(cache->htab, &relid, HASH_FIND, NULL);
+
+	if (entry == NULL)
+		return;
+
+	if (entry->mctx != NULL)
+	{
+		if (cache->refcount > 1)
+		{
+			MemoryContext old = MemoryContextSwitchTo(ts_cache_memory_ctx(cache));
+			hypertable_cache_removed_mctxs = lappend(hypertable_cache_removed_mctxs, entry->mctx);
+			MemoryContextSwitchTo(old);
+		}
+		else
+			MemoryContextDelete(entry->mctx);
+	}
+
+	ts_cache_remove(cache, &relid);
 }
 
 /* Get hypertable cache entry. If the entry is not in the cache, add it. */
@@ -208,14 +291,36 @@ ts_hypertable_cache_get_entry_with_table(Cache *cache, const Oid relid, const ch
 		.schema = schema,
 		.table = table,
 	};
+	const uint64 hits = cache->stats.hits;
 	HypertableCacheEntry *entry = ts_cache_fetch(cache, &query.q);
 	Assert((flags & CACHE_FLAG_MISSING_OK) ? true : (entry != NULL && entry->hypertable != NULL));
+
+	if (entry != NULL && entry->hypertable != NULL)
+	{
+		HypertableStatsCounter counter = cache->stats.hits != hits ?
+											 HYPERTABLE_STATS_HYPERTABLE_CACHE_HITS :
+											 HYPERTABLE_STATS_HYPERTABLE_CACHE_MISSES;
+		ts_hypertable_stats_add(entry->hypertable->fd.id, counter, 1);
+	}
+
 	return entry == NULL ? NULL : entry->hypertable;
 }
 
 extern TSDLLEXPORT Cache *
 ts_hypertable_cache_pin()
 {
+	/* Free the removed entries if nobody can reference them anymore */
+	if (hypertable_cache_removed_mctxs != NIL && hypertable_cache_current->refcount == 1)
+	{
+		ListCell *lc;
+
+		foreach (lc, hypertable_cache_removed_mctxs)
+			MemoryContextDelete(lfirst(lc));
+
+		list_free(hypertable_cache_removed_mctxs);
+		hypertable_cache_removed_mctxs = NIL;
+	}
+
 	return ts_cache_pin(hypertable_cache_current);
 }
 
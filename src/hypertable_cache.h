@@ -54,6 +54,7 @@ extern TSDLLEXPORT Hypertable *ts_hypertable_cache_get_entry_by_id(Cache *cache,
 																   const int32 hypertable_id);
 
 extern void ts_hypertable_cache_invalidate_callback(void);
+extern void ts_hypertable_cache_invalidate_relid(Oid relid);
 
 extern TSDLLEXPORT Cache *ts_hypertable_cache_pin(void);
 
@@ -17,13 +17,16 @@
 
 #include "chunk.h"
 #include "chunk_scan.h"
+#include "chunk_slice_cache.h"
 #include "dimension.h"
 #include "dimension_slice.h"
 #include "dimension_vector.h"
 #include "guc.h"
 #include "hypercube.h"
+#include "hypertable_stats.h"
 #include "partitioning.h"
 #include "scan_iterator.h"
+#include "ts_catalog/chunk_column_stats.h"
 #include "utils.h"
 
 #include <inttypes.h>
@@ -267,11 +270,53 @@ typedef struct HypertableRestrictInfo
 {
 	int num_base_restrictions; /* number of base restrictions
 								* successfully added */
+	/*
+	 * The restrictions on the columns with tracked chunk ranges, which work
+	 * like the restrictions on open dimensions, see chunk_column_stats.c
+	 */
+	int num_columns;
+	DimensionRestrictInfo **column_restriction;
 	int num_dimensions;
 	DimensionRestrictInfo *dimension_restriction[FLEXIBLE_ARRAY_MEMBER]; /* array of dimension
 																		  * restrictions */
 } HypertableRestrictInfo;
 
+/*
+ * Create the restrictions on the tracked columns of the hypertable, using an
+ * open dimension without partitioning for each column.
+ */
+static void
+hypertable_restrict_info_create_columns(HypertableRestrictInfo *hri, const Hypertable *ht)
+{
+	const ChunkRangeSpace *range_space = ht->range_space;
+
+	if (!ts_guc_enable_chunk_skipping || range_space == NULL)
+		return;
+
+	hri->column_restriction = palloc(sizeof(DimensionRestrictInfo *) * range_space->num_columns);
+
+	for (int i = 0; i < range_space->num_columns; i++)
+	{
+		const ChunkRangeColumn *column = &range_space->columns[i];
+		Dimension *dim;
+
+		/* The column can have become a dimension after it was tracked */
+		if (ts_is_partitioning_column(ht, column->attno))
+			continue;
+
+		dim = palloc0(sizeof(Dimension));
+		dim->type = DIMENSION_TYPE_OPEN;
+		dim->column_attno = column->attno;
+		dim->main_table_relid = ht->main_table_relid;
+		dim->fd.hypertable_id = ht->fd.id;
+		dim->fd.column_type = column->type;
+		namestrcpy(&dim->fd.column_name, NameStr(column->column_name));
+
+		hri->column_restriction[hri->num_columns++] =
+			&dimension_restrict_info_open_create(dim)->base;
+	}
+}
+
 HypertableRestrictInfo *
 ts_hypertable_restrict_info_create(RelOptInfo *rel, Hypertable *ht)
 {
@@ -289,6 +334,8 @@ ts_hypertable_restrict_info_create(RelOptInfo *rel, Hypertable *ht)
 		res->dimension_restriction[i] = dri;
 	}
 
+	hypertable_restrict_info_create_columns(res, ht);
+
 	return res;
 }
 
@@ -302,6 +349,12 @@ hypertable_restrict_info_get(HypertableRestrictInfo *hri, AttrNumber attno)
 		if (hri->dimension_restriction[i]->dimension->column_attno == attno)
 			return hri->dimension_restriction[i];
 	}
+
+	for (i = 0; i < hri->num_columns; i++)
+	{
+		if (hri->column_restriction[i]->dimension->column_attno == attno)
+			return hri->column_restriction[i];
+	}
 	return NULL;
 }
 
@@ -636,6 +689,331 @@ gather_restriction_dimension_vectors(const HypertableRestrictInfo *hri)
 	return dimension_vecs;
 }
 
+/*
+ * Get the single range condition of a restriction in the terms of
+ * ts_dimension_slice_scan_iterator_set_range(). Returns false for the closed
+ * dimensions restricted to several partitions.
+ */
+static bool
+dimension_restrict_info_get_range(const DimensionRestrictInfo *dri, StrategyNumber *start_strategy,
+								  int64 *start_value, StrategyNumber *end_strategy,
+								  int64 *end_value)
+{
+	switch (dri->dimension->type)
+	{
+		case DIMENSION_TYPE_OPEN:
+		{
+			const DimensionRestrictInfoOpen *open = (const DimensionRestrictInfoOpen *) dri;
+
+			*start_strategy = open->upper_strategy;
+			*start_value = open->upper_bound;
+			*end_strategy = open->lower_strategy;
+			*end_value = open->lower_bound;
+			return true;
+		}
+		case DIMENSION_TYPE_CLOSED:
+		{
+			const DimensionRestrictInfoClosed *closed = (const DimensionRestrictInfoClosed *) dri;
+
+			if (list_length(closed->partitions) != 1)
+				return false;
+
+			*start_strategy = BTLessEqualStrategyNumber;
+			*start_value = linitial_int(closed->partitions);
+			*end_strategy = BTGreaterEqualStrategyNumber;
+			*end_value = linitial_int(closed->partitions);
+			return true;
+		}
+		default:
+			elog(ERROR, "unknown dimension type");
+			return false;
+	}
+}
+
+static bool
+cached_slice_matches(const DimensionRestrictInfo *dri, int64 range_start, int64 range_end)
+{
+	StrategyNumber start_strategy;
+	StrategyNumber end_strategy;
+	int64 start_value;
+	int64 end_value;
+
+	if (dimension_restrict_info_get_range(dri,
+										  &start_strategy,
+										  &start_value,
+										  &end_strategy,
+										  &end_value))
+		return ts_dimension_slice_range_matches(range_start,
+												range_end,
+												start_strategy,
+												start_value,
+												end_strategy,
+												end_value);
+
+	const DimensionRestrictInfoClosed *closed = (const DimensionRestrictInfoClosed *) dri;
+	ListCell *cell;
+
+	foreach (cell, closed->partitions)
+	{
+		int32 partition = lfirst_int(cell);
+
+		if (ts_dimension_slice_range_matches(range_start,
+											 range_end,
+											 BTLessEqualStrategyNumber,
+											 partition,
+											 BTGreaterEqualStrategyNumber,
+											 partition))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Whether the OSM chunk still has the placeholder dimension slice it got when
+ * it was attached, i.e. OSM hasn't set the range of its data.
+ */
+static bool
+osm_chunk_range_is_unknown(const Hypertable *ht, int32 osm_chunk_id)
+{
+	const Dimension *time_dim = hyperspace_get_open_dimension(ht->space, 0);
+	Chunk *chunk = ts_chunk_get_by_id(osm_chunk_id, false);
+
+	if (chunk == NULL)
+		return true;
+
+	for (int i = 0; i < chunk->cube->num_slices; i++)
+	{
+		const DimensionSlice *slice = chunk->cube->slices[i];
+
+		if (slice->fd.dimension_id == time_dim->fd.id)
+			return slice->fd.range_end == DIMENSION_SLICE_MAXVALUE;
+	}
+
+	return true;
+}
+
+/*
+ * Find the chunks matching the restrictions using the cached dimension slices
+ * of the hypertable, which gives the same result as gather_restriction_
+ * dimension_vectors() followed by ts_chunk_id_find_in_subspace() without
+ * scanning the catalogs. Returns false if the cache can't be used.
+ */
+static bool
+chunk_ids_find_in_slice_cache(const HypertableRestrictInfo *hri, const Hypertable *ht,
+							  List **chunk_ids)
+{
+	const ChunkSlices *slices = ts_chunk_slice_cache_get(ht);
+
+	if (slices == NULL)
+		return false;
+
+	/* Map the restricted dimensions to the dimensions of the cached slices. */
+	int *dimension_index = palloc(sizeof(int) * hri->num_dimensions);
+	for (int i = 0; i < hri->num_dimensions; i++)
+	{
+		const DimensionRestrictInfo *dri = hri->dimension_restriction[i];
+
+		dimension_index[i] = -1;
+		for (int d = 0; d < slices->num_dimensions; d++)
+		{
+			if (slices->dimension_ids[d] == dri->dimension->fd.id)
+			{
+				dimension_index[i] = d;
+				break;
+			}
+		}
+
+		if (dimension_index[i] < 0)
+		{
+			pfree(dimension_index);
+			return false;
+		}
+	}
+
+	/*
+	 * Narrow down the candidate chunks with a binary search in the dimension
+	 * with the most selective range restriction. The rest of the restrictions
+	 * are checked for each candidate.
+	 */
+	int search_dimension = -1;
+	int first = 0;
+	int last = slices->num_chunks;
+	for (int i = 0; i < hri->num_dimensions; i++)
+	{
+		StrategyNumber start_strategy;
+		StrategyNumber end_strategy;
+		int64 start_value;
+		int64 end_value;
+		int dim_first;
+		int dim_last;
+
+		if (!dimension_restrict_info_get_range(hri->dimension_restriction[i],
+											   &start_strategy,
+											   &start_value,
+											   &end_strategy,
+											   &end_value))
+			continue;
+
+		ts_chunk_slices_search(slices,
+							   dimension_index[i],
+							   start_strategy,
+							   start_value,
+							   end_strategy,
+							   end_value,
+							   &dim_first,
+							   &dim_last);
+
+		if (dim_last - dim_first < last - first)
+		{
+			search_dimension = dimension_index[i];
+			first = dim_first;
+			last = dim_last;
+		}
+	}
+
+	*chunk_ids = NIL;
+	for (int k = first; k < last; k++)
+	{
+		const int c = search_dimension < 0 ?
+						  k :
+						  slices->sorted_chunks[search_dimension * slices->num_chunks + k];
+		bool matches = true;
+
+		for (int i = 0; i < hri->num_dimensions && matches; i++)
+		{
+			const int pos = c * slices->num_dimensions + dimension_index[i];
+
+			matches = slices->has_slice[pos] &&
+					  cached_slice_matches(hri->dimension_restriction[i],
+										   slices->range_start[pos],
+										   slices->range_end[pos]);
+		}
+
+		if (matches)
+			*chunk_ids = lappend_int(*chunk_ids, slices->chunk_ids[c]);
+	}
+
+	/* We know the total number of chunks only here, so count the exclusion */
+	ts_hypertable_stats_add(ht->fd.id,
+							HYPERTABLE_STATS_CHUNKS_EXCLUDED_PLAN,
+							slices->num_chunks - list_length(*chunk_ids));
+
+	pfree(dimension_index);
+	return true;
+}
+
+/*
+ * Check if the range of a tracked column in a chunk contradicts the
+ * restriction on the column. Unlike the dimension slices, the range includes
+ * its end.
+ */
+static bool
+column_range_is_excluded(const DimensionRestrictInfoOpen *open, int64 range_start,
+						 int64 range_end)
+{
+	switch (open->upper_strategy)
+	{
+		case BTLessStrategyNumber:
+			if (range_start >= open->upper_bound)
+				return true;
+			break;
+		case BTLessEqualStrategyNumber:
+			if (range_start > open->upper_bound)
+				return true;
+			break;
+		default:
+			break;
+	}
+
+	switch (open->lower_strategy)
+	{
+		case BTGreaterStrategyNumber:
+			if (range_end <= open->lower_bound)
+				return true;
+			break;
+		case BTGreaterEqualStrategyNumber:
+			if (range_end < open->lower_bound)
+				return true;
+			break;
+		default:
+			break;
+	}
+
+	return false;
+}
+
+/*
+ * Remove the chunks whose valid ranges of the tracked columns contradict the
+ * restrictions on these columns. The chunk ids have to be sorted. The chunks
+ * without a valid range always match.
+ */
+static List *
+chunk_ids_exclude_by_column_ranges(HypertableRestrictInfo *hri, const Hypertable *ht,
+								   List *chunk_ids)
+{
+	const int old_columns = hri->num_columns;
+	List *excluded = NIL;
+	List *result = NIL;
+	ListCell *lc;
+	int next = 0;
+
+	/* Same as for the dimensions, the trivial restrictions match every chunk */
+	hri->num_columns = 0;
+	for (int i = 0; i < old_columns; i++)
+	{
+		DimensionRestrictInfo *dri = hri->column_restriction[i];
+
+		if (!dimension_restrict_info_is_trivial(dri))
+			hri->column_restriction[hri->num_columns++] = dri;
+	}
+
+	if (hri->num_columns == 0 || chunk_ids == NIL)
+		return chunk_ids;
+
+	/* The ranges are ordered by the chunk id */
+	foreach (lc, ts_chunk_column_stats_get_ranges(ht))
+	{
+		const ChunkColumnRange *range = lfirst(lc);
+		AttrNumber attno = ht->range_space->columns[range->column].attno;
+
+		for (int i = 0; i < hri->num_columns; i++)
+		{
+			const DimensionRestrictInfoOpen *open =
+				(const DimensionRestrictInfoOpen *) hri->column_restriction[i];
+
+			if (open->base.dimension->column_attno == attno &&
+				column_range_is_excluded(open, range->range_start, range->range_end))
+			{
+				excluded = lappend_int(excluded, range->chunk_id);
+				break;
+			}
+		}
+	}
+
+	if (excluded == NIL)
+		return chunk_ids;
+
+	foreach (lc, chunk_ids)
+	{
+		int32 chunk_id = lfirst_int(lc);
+
+		while (next < list_length(excluded) && list_nth_int(excluded, next) < chunk_id)
+			next++;
+
+		if (next < list_length(excluded) && list_nth_int(excluded, next) == chunk_id)
+			continue;
+
+		result = lappend_int(result, chunk_id);
+	}
+
+	ts_hypertable_stats_add(ht->fd.id,
+							HYPERTABLE_STATS_CHUNKS_EXCLUDED_PLAN,
+							list_length(chunk_ids) - list_length(result));
+
+	return result;
+}
+
 Chunk **
 ts_hypertable_restrict_info_get_chunks(HypertableRestrictInfo *hri, Hypertable *ht,
 									   unsigned int *num_chunks)
@@ -678,7 +1056,7 @@ ts_hypertable_restrict_info_get_chunks(HypertableRestrictInfo *hri, Hypertable *
 			chunk_ids = list_delete_int(chunk_ids, osm_chunk_id);
 		}
 	}
-	else
+	else if (!chunk_ids_find_in_slice_cache(hri, ht, &chunk_ids))
 	{
 		/*
 		 * Have some restrictions, enumerate the matching dimension slices.
@@ -697,14 +1075,20 @@ ts_hypertable_restrict_info_get_chunks(HypertableRestrictInfo *hri, Hypertable *
 			/* Find the chunks matching these dimension slices. */
 			chunk_ids = ts_chunk_id_find_in_subspace(ht, dimension_vectors);
 		}
+	}
+
+	if (hri->num_dimensions > 0)
+	{
 
 		/*
-		 * Always include the OSM chunk if we have one and OSM reads are
-		 * enabled. It has some virtual dimension slices (at the moment,
-		 * (+inf, +inf) slice for time, but it used to be different and might
-		 * change again.) So sometimes it will match and sometimes it won't,
-		 * so we have to check if it's already there not to add a duplicate.
-		 * Similarly if OSM reads are disabled then we exclude the OSM chunk.
+		 * Include the OSM chunk if we have one and OSM reads are enabled,
+		 * unless OSM has told us the range of its data. Until then, it has a
+		 * virtual dimension slice that ends at +inf for time. So sometimes it
+		 * will match and sometimes it won't, so we have to check if it's
+		 * already there not to add a duplicate. With a known range, the slice
+		 * matches the restrictions like the slice of any other chunk, and the
+		 * OSM chunk is excluded without asking the object storage. Similarly
+		 * if OSM reads are disabled then we exclude the OSM chunk.
 		 */
 		int32 osm_chunk_id = ts_chunk_get_osm_chunk_id(ht->fd.id);
 
@@ -714,9 +1098,10 @@ ts_hypertable_restrict_info_get_chunks(HypertableRestrictInfo *hri, Hypertable *
 			{
 				chunk_ids = list_delete_int(chunk_ids, osm_chunk_id);
 			}
-			else
+			else if (!list_member_int(chunk_ids, osm_chunk_id) &&
+					 osm_chunk_range_is_unknown(ht, osm_chunk_id))
 			{
-				chunk_ids = list_append_unique_int(chunk_ids, osm_chunk_id);
+				chunk_ids = lappend_int(chunk_ids, osm_chunk_id);
 			}
 		}
 	}
@@ -729,6 +1114,8 @@ ts_hypertable_restrict_info_get_chunks(HypertableRestrictInfo *hri, Hypertable *
 	 */
 	list_sort(chunk_ids, list_int_cmp_compat);
 
+	chunk_ids = chunk_ids_exclude_by_column_ranges(hri, ht, chunk_ids);
+
 	return ts_chunk_scan_by_chunk_ids(ht->space, chunk_ids, num_chunks);
 }
 
@@ -753,10 +1140,21 @@ chunk_cmp(const void *c1, const void *c2)
 	return chunk_cmp_impl(*((const Chunk **) c1), *((const Chunk **) c2));
 }
 
+/*
+ * Compare two chunks along the end of the first dimension, then its start and
+ * the chunk ID, in descending order.
+ */
 static int
 chunk_cmp_reverse(const void *c1, const void *c2)
 {
-	return chunk_cmp_impl(*((const Chunk **) c2), *((const Chunk **) c1));
+	const Chunk *chunk1 = *((const Chunk **) c1);
+	const Chunk *chunk2 = *((const Chunk **) c2);
+	int cmp = DIMENSION_SLICE_RANGE_END_CMP(chunk2->cube->slices[0], chunk1->cube->slices[0]);
+
+	if (cmp == 0)
+		cmp = chunk_cmp_impl(chunk2, chunk1);
+
+	return cmp;
 }
 
 /*
@@ -769,6 +1167,11 @@ chunk_cmp_reverse(const void *c1, const void *c2)
  * in the same list. In the list [[1,2,3],[4,5,6]] chunks 1, 2 and 3 are space partitions of
  * the same time slice and 4, 5 and 6 are space partitions of the next time slice.
  *
+ * The time slices of different space partitions can overlap without being
+ * equal, e.g., after the chunk time interval was changed, so the chunks are
+ * grouped by overlapping time ranges rather than by equal slices. This way
+ * the lists can be appended in order, each list is merged, and only the
+ * chunks of the current time range have to be scanned at once.
  */
 Chunk **
 ts_hypertable_restrict_info_get_chunks_ordered(HypertableRestrictInfo *hri, Hypertable *ht,
@@ -777,6 +1180,8 @@ ts_hypertable_restrict_info_get_chunks_ordered(HypertableRestrictInfo *hri, Hype
 {
 	List *slot_chunk_oids = NIL;
 	DimensionSlice *slice = NULL;
+	int64 slot_start = 0;
+	int64 slot_end = 0;
 	unsigned int i;
 
 	if (chunks == NULL)
@@ -799,8 +1204,17 @@ ts_hypertable_restrict_info_get_chunks_ordered(HypertableRestrictInfo *hri, Hype
 	{
 		Chunk *chunk = chunks[i];
 
-		if (NULL != slice && ts_dimension_slice_cmp(slice, chunk->cube->slices[0]) != 0 &&
-			slot_chunk_oids != NIL)
+		DimensionSlice *chunk_slice = chunk->cube->slices[0];
+
+		/*
+		 * Start a new time slot when the chunk does not overlap the chunks of
+		 * the current slot. The chunks are sorted by start in forward order
+		 * and by end in reverse order, so no later chunk can overlap an
+		 * earlier slot either.
+		 */
+		if (NULL != slice && slot_chunk_oids != NIL &&
+			(reverse ? chunk_slice->fd.range_end <= slot_start :
+					   chunk_slice->fd.range_start >= slot_end))
 		{
 			*nested_oids = lappend(*nested_oids, slot_chunk_oids);
 			slot_chunk_oids = NIL;
@@ -809,7 +1223,18 @@ ts_hypertable_restrict_info_get_chunks_ordered(HypertableRestrictInfo *hri, Hype
 		if (NULL != nested_oids)
 			slot_chunk_oids = lappend_oid(slot_chunk_oids, chunk->table_id);
 
-		slice = chunk->cube->slices[0];
+		if (list_length(slot_chunk_oids) <= 1)
+		{
+			slot_start = chunk_slice->fd.range_start;
+			slot_end = chunk_slice->fd.range_end;
+		}
+		else
+		{
+			slot_start = Min(slot_start, chunk_slice->fd.range_start);
+			slot_end = Max(slot_end, chunk_slice->fd.range_end);
+		}
+
+		slice = chunk_slice;
 	}
 
 	if (slot_chunk_oids != NIL)
@@ -0,0 +1,376 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <access/xact.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <miscadmin.h>
+#include <utils/builtins.h>
+#include <utils/hsearch.h>
+#include <utils/memutils.h>
+
+#include "hypertable_stats.h"
+
+#include "export.h"
+#include "guc.h"
+#include "loader/hypertable_stats.h"
+
+/*
+ * Cumulative runtime statistics per hypertable, shared by all backends and
+ * shown by the timescaledb_information.hypertable_stats view.
+ *
+ * Most of the counters are updated on hot paths, like for every inserted row,
+ * so the executor nodes add them up in their own state and report the totals
+ * when they end. The reported counts are kept in a backend-local hash table
+ * and are added to the shared memory at the end of the transaction, so that
+ * the shared lock is taken at most once per transaction. The counts of the
+ * current transaction are not visible before it ends.
+ *
+ * The shared memory is allocated by the loader. With an older loader it is
+ * missing, and nothing is collected.
+ */
+typedef struct PendingStatsEntry
+{
+	int32 hypertable_id;
+	int64 counters[_HYPERTABLE_STATS_MAX];
+} PendingStatsEntry;
+
+StaticAssertDecl(_HYPERTABLE_STATS_MAX <= TS_HYPERTABLE_STATS_MAX_COUNTERS,
+				 "too many counters for the shared hypertable stats");
+
+static HTAB *pending_stats = NULL;
+static PendingStatsEntry *last_pending_entry = NULL;
+static bool have_pending_stats = false;
+
+static HypertableStatsRendezvous *
+hypertable_stats_get(void)
+{
+	static HypertableStatsRendezvous **rendezvous = NULL;
+
+	if (rendezvous == NULL)
+		rendezvous =
+			(HypertableStatsRendezvous **) find_rendezvous_variable(RENDEZVOUS_HYPERTABLE_STATS);
+
+	return *rendezvous;
+}
+
+static PendingStatsEntry *
+pending_stats_get_entry(int32 hypertable_id)
+{
+	bool found;
+
+	if (last_pending_entry != NULL && last_pending_entry->hypertable_id == hypertable_id)
+		return last_pending_entry;
+
+	if (pending_stats == NULL)
+	{
+		HASHCTL ctl = {
+			.keysize = sizeof(int32),
+			.entrysize = sizeof(PendingStatsEntry),
+			.hcxt = TopMemoryContext,
+		};
+
+		pending_stats = hash_create("pending hypertable stats",
+									16,
+									&ctl,
+									HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+
+	last_pending_entry = hash_search(pending_stats, &hypertable_id, HASH_ENTER, &found);
+	if (!found)
+		memset(last_pending_entry->counters, 0, sizeof(last_pending_entry->counters));
+
+	return last_pending_entry;
+}
+
+void
+ts_hypertable_stats_add(int32 hypertable_id, HypertableStatsCounter counter, int64 value)
+{
+	Assert(counter >= 0 && counter < _HYPERTABLE_STATS_MAX);
+
+	if (!ts_guc_enable_hypertable_stats || value == 0 || hypertable_id <= 0)
+		return;
+
+	pending_stats_get_entry(hypertable_id)->counters[counter] += value;
+	have_pending_stats = true;
+}
+
+static bool
+pending_entry_is_zero(const PendingStatsEntry *pending)
+{
+	for (int i = 0; i < _HYPERTABLE_STATS_MAX; i++)
+	{
+		if (pending->counters[i] != 0)
+			return false;
+	}
+
+	return true;
+}
+
+static void
+pending_entry_add_to(PendingStatsEntry *pending, HypertableStatsEntry *entry)
+{
+	for (int i = 0; i < _HYPERTABLE_STATS_MAX; i++)
+	{
+		if (pending->counters[i] != 0)
+			pg_atomic_fetch_add_u64(&entry->counters[i], pending->counters[i]);
+	}
+
+	memset(pending->counters, 0, sizeof(pending->counters));
+}
+
+/*
+ * Add the pending counts to the shared memory. The counters of the existing
+ * entries are updated atomically under the shared lock, and only adding the
+ * entries for the new hypertables needs the exclusive lock.
+ */
+static void
+pending_stats_flush(void)
+{
+	HypertableStatsRendezvous *stats = hypertable_stats_get();
+	HASH_SEQ_STATUS status;
+	PendingStatsEntry *pending;
+	bool have_new_entries = false;
+
+	if (!have_pending_stats)
+		return;
+
+	have_pending_stats = false;
+
+	if (stats == NULL || !OidIsValid(MyDatabaseId))
+	{
+		hash_seq_init(&status, pending_stats);
+		while ((pending = hash_seq_search(&status)) != NULL)
+			memset(pending->counters, 0, sizeof(pending->counters));
+		return;
+	}
+
+	LWLockAcquire(stats->lock, LW_SHARED);
+	hash_seq_init(&status, pending_stats);
+	while ((pending = hash_seq_search(&status)) != NULL)
+	{
+		HypertableStatsKey key = {
+			.dbid = MyDatabaseId,
+			.hypertable_id = pending->hypertable_id,
+		};
+		HypertableStatsEntry *entry;
+
+		if (pending_entry_is_zero(pending))
+			continue;
+
+		entry = hash_search(stats->entries, &key, HASH_FIND, NULL);
+		if (entry != NULL)
+			pending_entry_add_to(pending, entry);
+		else
+			have_new_entries = true;
+	}
+	LWLockRelease(stats->lock);
+
+	if (!have_new_entries)
+		return;
+
+	LWLockAcquire(stats->lock, LW_EXCLUSIVE);
+	hash_seq_init(&status, pending_stats);
+	while ((pending = hash_seq_search(&status)) != NULL)
+	{
+		HypertableStatsKey key = {
+			.dbid = MyDatabaseId,
+			.hypertable_id = pending->hypertable_id,
+		};
+		HypertableStatsEntry *entry;
+		bool found;
+
+		if (pending_entry_is_zero(pending))
+			continue;
+
+		/* The stats of the hypertables that don't fit in the table are lost */
+		entry = hash_search(stats->entries, &key, HASH_ENTER_NULL, &found);
+		if (entry == NULL)
+		{
+			memset(pending->counters, 0, sizeof(pending->counters));
+			continue;
+		}
+
+		if (!found)
+		{
+			for (int i = 0; i < TS_HYPERTABLE_STATS_MAX_COUNTERS; i++)
+				pg_atomic_init_u64(&entry->counters[i], 0);
+		}
+
+		pending_entry_add_to(pending, entry);
+	}
+	LWLockRelease(stats->lock);
+}
+
+/*
+ * Remove the stats of a dropped hypertable, so that a new hypertable with the
+ * same id doesn't inherit them.
+ */
+void
+ts_hypertable_stats_drop(int32 hypertable_id)
+{
+	HypertableStatsRendezvous *stats = hypertable_stats_get();
+	HypertableStatsKey key = {
+		.dbid = MyDatabaseId,
+		.hypertable_id = hypertable_id,
+	};
+
+	if (pending_stats != NULL)
+	{
+		hash_search(pending_stats, &hypertable_id, HASH_REMOVE, NULL);
+		last_pending_entry = NULL;
+	}
+
+	if (stats == NULL)
+		return;
+
+	LWLockAcquire(stats->lock, LW_EXCLUSIVE);
+	hash_search(stats->entries, &key, HASH_REMOVE, NULL);
+	LWLockRelease(stats->lock);
+}
+
+static void
+hypertable_stats_xact_end(XactEvent event, void *arg)
+{
+	switch (event)
+	{
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_ABORT:
+		case XACT_EVENT_PREPARE:
+			pending_stats_flush();
+			break;
+		default:
+			break;
+	}
+}
+
+TS_FUNCTION_INFO_V1(ts_hypertable_stats);
+TS_FUNCTION_INFO_V1(ts_hypertable_stats_reset);
+
+typedef struct HypertableStatsRow
+{
+	int32 hypertable_id;
+	uint64 counters[_HYPERTABLE_STATS_MAX];
+} HypertableStatsRow;
+
+Datum
+ts_hypertable_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		HypertableStatsRendezvous *stats = hypertable_stats_get();
+		MemoryContext oldcontext;
+		TupleDesc tupdesc;
+		uint64 nrows = 0;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("function returning record called in context "
+							"that cannot accept type record")));
+
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		/* Copy the entries of this database, to not hold the lock between calls */
+		if (stats != NULL)
+		{
+			HASH_SEQ_STATUS status;
+			HypertableStatsEntry *entry;
+			HypertableStatsRow *rows;
+
+			LWLockAcquire(stats->lock, LW_SHARED);
+			rows = palloc(sizeof(HypertableStatsRow) *
+						  Max(hash_get_num_entries(stats->entries), 1));
+			hash_seq_init(&status, stats->entries);
+			while ((entry = hash_seq_search(&status)) != NULL)
+			{
+				if (entry->key.dbid != MyDatabaseId)
+					continue;
+
+				rows[nrows].hypertable_id = entry->key.hypertable_id;
+				for (int i = 0; i < _HYPERTABLE_STATS_MAX; i++)
+					rows[nrows].counters[i] = pg_atomic_read_u64(&entry->counters[i]);
+				nrows++;
+			}
+			LWLockRelease(stats->lock);
+
+			funcctx->user_fctx = rows;
+		}
+
+		funcctx->max_calls = nrows;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	if (funcctx->call_cntr < funcctx->max_calls)
+	{
+		const HypertableStatsRow *row =
+			&((HypertableStatsRow *) funcctx->user_fctx)[funcctx->call_cntr];
+		Datum values[1 + _HYPERTABLE_STATS_MAX];
+		bool nulls[1 + _HYPERTABLE_STATS_MAX] = { false };
+		HeapTuple tuple;
+
+		values[0] = Int32GetDatum(row->hypertable_id);
+		for (int i = 0; i < _HYPERTABLE_STATS_MAX; i++)
+			values[1 + i] = Int64GetDatum((int64) row->counters[i]);
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+/*
+ * Remove the stats of all the hypertables in the current database.
+ */
+Datum
+ts_hypertable_stats_reset(PG_FUNCTION_ARGS)
+{
+	HypertableStatsRendezvous *stats = hypertable_stats_get();
+	HASH_SEQ_STATUS status;
+	HypertableStatsEntry *entry;
+
+	if (!superuser())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("must be superuser to reset the hypertable statistics")));
+
+	if (stats == NULL)
+		PG_RETURN_VOID();
+
+	LWLockAcquire(stats->lock, LW_EXCLUSIVE);
+	hash_seq_init(&status, stats->entries);
+	while ((entry = hash_seq_search(&status)) != NULL)
+	{
+		if (entry->key.dbid == MyDatabaseId)
+			hash_search(stats->entries, &entry->key, HASH_REMOVE, NULL);
+	}
+	LWLockRelease(stats->lock);
+
+	PG_RETURN_VOID();
+}
+
+void
+_hypertable_stats_init(void)
+{
+	RegisterXactCallback(hypertable_stats_xact_end, NULL);
+}
+
+void
+_hypertable_stats_fini(void)
+{
+	UnregisterXactCallback(hypertable_stats_xact_end, NULL);
+}
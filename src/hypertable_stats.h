@@ -0,0 +1,40 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_HYPERTABLE_STATS_H
+#define TIMESCALEDB_HYPERTABLE_STATS_H
+
+#include <postgres.h>
+
+#include "export.h"
+
+/*
+ * The counters that we keep per hypertable. The values index the shared
+ * slots allocated by the loader, so existing values must not be renumbered.
+ * Keep the columns of _timescaledb_functions.hypertable_stats() in sync.
+ */
+typedef enum HypertableStatsCounter
+{
+	HYPERTABLE_STATS_ROWS_INSERTED = 0,		  /* rows inserted with INSERT */
+	HYPERTABLE_STATS_ROWS_COPIED,			  /* rows inserted with COPY */
+	HYPERTABLE_STATS_ROWS_COMPRESSED_CHUNKS,  /* rows inserted into compressed chunks */
+	HYPERTABLE_STATS_CHUNKS_CREATED,		  /* chunks created by inserts */
+	HYPERTABLE_STATS_CHUNKS_EXCLUDED_PLAN,	  /* chunks excluded by the planner */
+	HYPERTABLE_STATS_CHUNKS_EXCLUDED_STARTUP, /* chunks excluded by ChunkAppend at startup */
+	HYPERTABLE_STATS_CHUNKS_EXCLUDED_RUNTIME, /* chunks excluded by ChunkAppend at runtime */
+	HYPERTABLE_STATS_BATCHES_DECOMPRESSED,	  /* compressed batches read by DecompressChunk */
+	HYPERTABLE_STATS_BYTES_DECOMPRESSED,	  /* compressed bytes detoasted by DecompressChunk */
+	HYPERTABLE_STATS_HYPERTABLE_CACHE_HITS,
+	HYPERTABLE_STATS_HYPERTABLE_CACHE_MISSES,
+	HYPERTABLE_STATS_CHUNK_CACHE_HITS,	 /* chunk insert states reused by inserts */
+	HYPERTABLE_STATS_CHUNK_CACHE_MISSES, /* chunk insert states opened by inserts */
+	_HYPERTABLE_STATS_MAX,
+} HypertableStatsCounter;
+
+extern TSDLLEXPORT void ts_hypertable_stats_add(int32 hypertable_id,
+												HypertableStatsCounter counter, int64 value);
+extern void ts_hypertable_stats_drop(int32 hypertable_id);
+
+#endif /* TIMESCALEDB_HYPERTABLE_STATS_H */
@@ -326,8 +326,8 @@ ht_ExecDeleteEpilogue(ModifyTableContext * context, ResultRelInfo * resultRelInf
 
 #if PG15_GE
 
-TupleTableSlot *ExecInsert(ModifyTableContext * context, ResultRelInfo * resultRelInfo,
-			   TupleTableSlot * slot, bool canSetTag);
+TupleTableSlot *ExecInsert(ModifyTableContext * context, ChunkDispatchState * cds,
+			   ResultRelInfo * resultRelInfo, TupleTableSlot * slot, bool canSetTag);
 
 static TupleTableSlot * mergeGetUpdateNewTuple(ResultRelInfo * relinfo, TupleTableSlot * planSlot,
 		    TupleTableSlot * oldSlot, MergeActionState * relaction);
@@ -790,6 +790,7 @@ ht_ExecMergeNotMatched(ModifyTableContext * context, ResultRelInfo * resultRelIn
 												MakeSingleTupleTableSlot(chunktupdesc,
 																		&TTSOpsVirtual));
 				(void) ExecInsert(context,
+									cds,
 									cds->rri,
 									(chunk_slot ? chunk_slot : newslot),
 									canSetTag);
@@ -797,7 +798,7 @@ ht_ExecMergeNotMatched(ModifyTableContext * context, ResultRelInfo * resultRelIn
 					ExecDropSingleTupleTableSlot(chunk_slot);
 			}
 			else
-				(void) ExecInsert(context, cds->rri, newslot, canSetTag);
+				(void) ExecInsert(context, cds, cds->rri, newslot, canSetTag);
 			mtstate->mt_merge_inserted = 1;
 			break;
 		case CMD_NOTHING:
@@ -36,6 +36,9 @@ extern void _cache_invalidate_fini(void);
 extern void _cache_init(void);
 extern void _cache_fini(void);
 
+extern void _hypertable_stats_init(void);
+extern void _hypertable_stats_fini(void);
+
 extern void _planner_init(void);
 extern void _planner_fini(void);
 
@@ -84,6 +87,7 @@ cleanup_on_pg_proc_exit(int code, Datum arg)
 	_event_trigger_fini();
 	_planner_fini();
 	_cache_invalidate_fini();
+	_hypertable_stats_fini();
 	_hypertable_cache_fini();
 	_cache_fini();
 }
@@ -101,6 +105,7 @@ _PG_init(void)
 
 	_cache_init();
 	_hypertable_cache_init();
+	_hypertable_stats_init();
 	_cache_invalidate_init();
 	_planner_init();
 	_constraint_aware_append_init();
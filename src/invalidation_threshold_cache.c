@@ -0,0 +1,125 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <fmgr.h>
+#include <miscadmin.h>
+
+#include "invalidation_threshold_cache.h"
+
+#include "loader/invalidation_threshold_cache.h"
+
+/*
+ * The invalidation thresholds of the hypertables, shared by all backends, so
+ * that the inserts don't read the threshold from the catalog in every
+ * transaction that invalidates a continuous aggregate.
+ *
+ * A refresh moves the cached threshold forward when it moves the threshold in
+ * the catalog, before its transaction commits. The cached threshold is thus
+ * never behind the committed one, so the inserts never skip an invalidation
+ * that the catalog would have them write. If the refresh aborts, the cached
+ * threshold is ahead of the catalog, and the inserts only write some
+ * invalidations that are not needed.
+ *
+ * Only the refreshes add entries, so the thresholds that are not cached, like
+ * after a restart, are read from the catalog until the next refresh. The
+ * shared memory is allocated by the loader. With an older loader it is
+ * missing, and the thresholds are always read from the catalog.
+ */
+static InvalidationThresholdCacheRendezvous *
+invalidation_threshold_cache_get(void)
+{
+	static InvalidationThresholdCacheRendezvous **rendezvous = NULL;
+
+	if (rendezvous == NULL)
+		rendezvous = (InvalidationThresholdCacheRendezvous **) find_rendezvous_variable(
+			RENDEZVOUS_INVALIDATION_THRESHOLD_CACHE);
+
+	return *rendezvous;
+}
+
+/*
+ * Get the cached invalidation threshold of a hypertable. Returns false if it
+ * is not cached.
+ */
+bool
+ts_invalidation_threshold_cache_get(int32 hypertable_id, int64 *threshold)
+{
+	InvalidationThresholdCacheRendezvous *cache = invalidation_threshold_cache_get();
+	InvalidationThresholdCacheKey key = { .dbid = MyDatabaseId, .hypertable_id = hypertable_id };
+	InvalidationThresholdCacheEntry *entry;
+
+	if (cache == NULL)
+		return false;
+
+	LWLockAcquire(cache->lock, LW_SHARED);
+	entry = hash_search(cache->entries, &key, HASH_FIND, NULL);
+	if (entry != NULL)
+		*threshold = (int64) pg_atomic_read_u64(&entry->threshold);
+	LWLockRelease(cache->lock);
+
+	return entry != NULL;
+}
+
+/*
+ * Move the cached invalidation threshold of a hypertable forward. It is never
+ * moved back, so concurrent refreshes can advance it in any order.
+ */
+void
+ts_invalidation_threshold_cache_advance(int32 hypertable_id, int64 threshold)
+{
+	InvalidationThresholdCacheRendezvous *cache = invalidation_threshold_cache_get();
+	InvalidationThresholdCacheKey key = { .dbid = MyDatabaseId, .hypertable_id = hypertable_id };
+	InvalidationThresholdCacheEntry *entry;
+	bool found;
+
+	if (cache == NULL)
+		return;
+
+	LWLockAcquire(cache->lock, LW_SHARED);
+	entry = hash_search(cache->entries, &key, HASH_FIND, NULL);
+	if (entry == NULL)
+	{
+		LWLockRelease(cache->lock);
+		LWLockAcquire(cache->lock, LW_EXCLUSIVE);
+		entry = hash_search(cache->entries, &key, HASH_ENTER_NULL, &found);
+
+		/* The thresholds that don't fit are read from the catalog */
+		if (entry != NULL && !found)
+		{
+			pg_atomic_init_u64(&entry->threshold, (uint64) threshold);
+			entry = NULL;
+		}
+	}
+
+	if (entry != NULL)
+	{
+		uint64 current = pg_atomic_read_u64(&entry->threshold);
+
+		/* A failed exchange updates the current value, so just try again */
+		while ((int64) current < threshold &&
+			   !pg_atomic_compare_exchange_u64(&entry->threshold, &current, (uint64) threshold))
+			;
+	}
+	LWLockRelease(cache->lock);
+}
+
+/*
+ * Remove the cached invalidation threshold of a hypertable, when its
+ * threshold is removed from the catalog.
+ */
+void
+ts_invalidation_threshold_cache_remove(int32 hypertable_id)
+{
+	InvalidationThresholdCacheRendezvous *cache = invalidation_threshold_cache_get();
+	InvalidationThresholdCacheKey key = { .dbid = MyDatabaseId, .hypertable_id = hypertable_id };
+
+	if (cache == NULL)
+		return;
+
+	LWLockAcquire(cache->lock, LW_EXCLUSIVE);
+	hash_search(cache->entries, &key, HASH_REMOVE, NULL);
+	LWLockRelease(cache->lock);
+}
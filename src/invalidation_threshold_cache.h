@@ -0,0 +1,18 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_INVALIDATION_THRESHOLD_CACHE_H
+#define TIMESCALEDB_INVALIDATION_THRESHOLD_CACHE_H
+
+#include <postgres.h>
+
+#include "export.h"
+
+extern TSDLLEXPORT bool ts_invalidation_threshold_cache_get(int32 hypertable_id, int64 *threshold);
+extern TSDLLEXPORT void ts_invalidation_threshold_cache_advance(int32 hypertable_id,
+																int64 threshold);
+extern void ts_invalidation_threshold_cache_remove(int32 hypertable_id);
+
+#endif /* TIMESCALEDB_INVALIDATION_THRESHOLD_CACHE_H */
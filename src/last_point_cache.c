@@ -0,0 +1,1326 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+/*
+ * The last point cache of a hypertable is a plain table that holds the latest
+ * row of each series, as defined by a series key over the columns of the
+ * hypertable. It is maintained by INSERT and COPY into the hypertable, and the
+ * planner reads it instead of the hypertable for the queries of the form
+ *
+ *   SELECT DISTINCT ON (<series key>) ... FROM <hypertable>
+ *   ORDER BY <series key>, <time> DESC
+ *
+ * Any other modification of the data, i.e. UPDATE, DELETE, MERGE, INSERT ...
+ * ON CONFLICT, drop_chunks and TRUNCATE, marks the cache invalid, and it is not
+ * used until it is refreshed with refresh_last_point_cache(). Modifications
+ * of the chunks that bypass the hypertable are not tracked.
+ */
+#include <postgres.h>
+#include <access/attmap.h>
+#include <access/genam.h>
+#include <access/htup_details.h>
+#include <access/stratnum.h>
+#include <access/table.h>
+#include <access/xact.h>
+#include <catalog/dependency.h>
+#include <catalog/indexing.h>
+#include <catalog/namespace.h>
+#include <catalog/pg_class.h>
+#include <catalog/pg_type.h>
+#include <catalog/toasting.h>
+#include <commands/tablecmds.h>
+#include <executor/executor.h>
+#include <executor/spi.h>
+#include <lib/stringinfo.h>
+#include <miscadmin.h>
+#include <nodes/makefuncs.h>
+#include <optimizer/optimizer.h>
+#include <optimizer/tlist.h>
+#include <parser/parsetree.h>
+#include <rewrite/rewriteManip.h>
+#include <storage/lmgr.h>
+#include <utils/array.h>
+#include <utils/builtins.h>
+#include <utils/fmgroids.h>
+#include <utils/inval.h>
+#include <utils/lsyscache.h>
+#include <utils/rel.h>
+#include <utils/snapmgr.h>
+#include <utils/typcache.h>
+
+#include "compat/compat.h"
+#include "dimension.h"
+#include "export.h"
+#include "extension_constants.h"
+#include "hypertable_cache.h"
+#include "last_point_cache.h"
+#include "scan_iterator.h"
+#include "scanner.h"
+#include "ts_catalog/catalog.h"
+#include "utils.h"
+
+typedef struct LastPointCacheInfo
+{
+	int32 hypertable_id;
+	NameData cache_schema_name;
+	NameData cache_table_name;
+	bool valid;
+	int num_keys;
+	char **series_key;
+} LastPointCacheInfo;
+
+/* The latest row of a series seen by the statement. */
+typedef struct LastPoint
+{
+	int64 time;
+	MinimalTuple tuple;
+} LastPoint;
+
+struct LastPointCacheTracker
+{
+	int32 hypertable_id;
+	Oid hypertable_relid;
+	/* The row type of the hypertable, which is also the type of the tracked rows */
+	TupleDesc tupdesc;
+	AttrNumber time_attno;
+	Oid time_type;
+	int num_keys;
+	AttrNumber *key_attnos;
+	Oid *key_eq_operators;
+	Oid *key_collations;
+	TupleHashTable points;
+	int64 num_points;
+	MemoryContext table_mcxt;
+	MemoryContext temp_mcxt;
+};
+
+static void
+last_point_cache_init_scan(ScanIterator *iterator, int32 hypertable_id)
+{
+	iterator->ctx.index = catalog_get_index(ts_catalog_get(),
+											HYPERTABLE_LAST_POINT_CACHE,
+											HYPERTABLE_LAST_POINT_CACHE_PKEY);
+	ts_scan_iterator_scan_key_init(iterator,
+								   Anum_hypertable_last_point_cache_pkey_hypertable_id,
+								   BTEqualStrategyNumber,
+								   F_INT4EQ,
+								   Int32GetDatum(hypertable_id));
+}
+
+static void
+last_point_cache_info_from_tuple(TupleInfo *ti, LastPointCacheInfo *info)
+{
+	bool should_free;
+	HeapTuple tuple = ts_scanner_fetch_heap_tuple(ti, false, &should_free);
+	Datum values[Natts_hypertable_last_point_cache];
+	bool nulls[Natts_hypertable_last_point_cache];
+	Datum *keys;
+	int num_keys;
+
+	heap_deform_tuple(tuple, ts_scanner_get_tupledesc(ti), values, nulls);
+
+	info->hypertable_id = DatumGetInt32(
+		values[AttrNumberGetAttrOffset(Anum_hypertable_last_point_cache_hypertable_id)]);
+	namestrcpy(&info->cache_schema_name,
+			   NameStr(*DatumGetName(values[AttrNumberGetAttrOffset(
+				   Anum_hypertable_last_point_cache_cache_schema_name)])));
+	namestrcpy(&info->cache_table_name,
+			   NameStr(*DatumGetName(values[AttrNumberGetAttrOffset(
+				   Anum_hypertable_last_point_cache_cache_table_name)])));
+	info->valid =
+		DatumGetBool(values[AttrNumberGetAttrOffset(Anum_hypertable_last_point_cache_valid)]);
+
+	deconstruct_array(DatumGetArrayTypeP(values[AttrNumberGetAttrOffset(
+						  Anum_hypertable_last_point_cache_series_key)]),
+					  NAMEOID,
+					  NAMEDATALEN,
+					  false,
+					  TYPALIGN_CHAR,
+					  &keys,
+					  NULL,
+					  &num_keys);
+
+	info->num_keys = num_keys;
+	info->series_key = palloc(sizeof(char *) * num_keys);
+	for (int i = 0; i < num_keys; i++)
+		info->series_key[i] = pstrdup(NameStr(*DatumGetName(keys[i])));
+
+	if (should_free)
+		heap_freetuple(tuple);
+}
+
+static bool
+last_point_cache_info_get(int32 hypertable_id, LastPointCacheInfo *info)
+{
+	ScanIterator iterator =
+		ts_scan_iterator_create(HYPERTABLE_LAST_POINT_CACHE, AccessShareLock, CurrentMemoryContext);
+	bool found = false;
+
+	last_point_cache_init_scan(&iterator, hypertable_id);
+	ts_scanner_foreach(&iterator)
+	{
+		last_point_cache_info_from_tuple(ts_scan_iterator_tuple_info(&iterator), info);
+		found = true;
+	}
+	ts_scan_iterator_close(&iterator);
+
+	return found;
+}
+
+/*
+ * Get the cache table, or InvalidOid if it was dropped.
+ */
+static Oid
+last_point_cache_get_relid(const LastPointCacheInfo *info)
+{
+	Oid nspid = get_namespace_oid(NameStr(info->cache_schema_name), true);
+
+	if (!OidIsValid(nspid))
+		return InvalidOid;
+
+	return get_relname_relid(NameStr(info->cache_table_name), nspid);
+}
+
+static ScanFilterResult
+last_point_cache_filter_valid(const TupleInfo *ti, void *data)
+{
+	bool valid = *(bool *) data;
+	bool isnull;
+	Datum current = slot_getattr(ti->slot, Anum_hypertable_last_point_cache_valid, &isnull);
+
+	Assert(!isnull);
+	return DatumGetBool(current) == valid ? SCAN_EXCLUDE : SCAN_INCLUDE;
+}
+
+/*
+ * Mark the last point cache of a hypertable valid or invalid, and invalidate
+ * the plans that depend on that.
+ */
+static void
+last_point_cache_set_valid(int32 hypertable_id, bool valid)
+{
+	ScanTupLock tuplock = {
+		.lockmode = LockTupleExclusive,
+		.waitpolicy = LockWaitBlock,
+		/* in read committed mode, we follow all updates to this tuple */
+		.lockflags = IsolationUsesXactSnapshot() ? 0 : TUPLE_LOCK_FLAG_FIND_LAST_VERSION,
+	};
+	ScanIterator iterator = ts_scan_iterator_create(HYPERTABLE_LAST_POINT_CACHE,
+													RowExclusiveLock,
+													CurrentMemoryContext);
+
+	last_point_cache_init_scan(&iterator, hypertable_id);
+	/* Don't lock the tuple if there is nothing to change, which is the common case. */
+	iterator.ctx.filter = last_point_cache_filter_valid;
+	iterator.ctx.data = &valid;
+	iterator.ctx.tuplock = &tuplock;
+
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		TupleDesc tupdesc = ts_scanner_get_tupledesc(ti);
+		Datum values[Natts_hypertable_last_point_cache];
+		bool nulls[Natts_hypertable_last_point_cache];
+		CatalogSecurityContext sec_ctx;
+		LastPointCacheInfo info;
+		HeapTuple tuple;
+		HeapTuple new_tuple;
+		bool should_free;
+		Oid cache_relid;
+
+		/*
+		 * The cache was changed or removed by a concurrent transaction, which
+		 * also invalidated it.
+		 */
+		if (ti->lockresult != TM_Ok && ti->lockresult != TM_SelfModified)
+			continue;
+
+		/* Recheck after following the updates */
+		if (last_point_cache_filter_valid(ti, &valid) == SCAN_EXCLUDE)
+			continue;
+
+		last_point_cache_info_from_tuple(ti, &info);
+
+		tuple = ts_scanner_fetch_heap_tuple(ti, false, &should_free);
+		heap_deform_tuple(tuple, tupdesc, values, nulls);
+		values[AttrNumberGetAttrOffset(Anum_hypertable_last_point_cache_valid)] =
+			BoolGetDatum(valid);
+		new_tuple = heap_form_tuple(tupdesc, values, nulls);
+
+		ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+		ts_catalog_update_tid(ti->scanrel, ts_scanner_get_tuple_tid(ti), new_tuple);
+		ts_catalog_restore_user(&sec_ctx);
+
+		heap_freetuple(new_tuple);
+		if (should_free)
+			heap_freetuple(tuple);
+
+		/*
+		 * The queries that read the cache have to be planned again when it
+		 * becomes invalid, and the queries on the hypertable when it becomes
+		 * valid.
+		 */
+		cache_relid = last_point_cache_get_relid(&info);
+		if (OidIsValid(cache_relid))
+			CacheInvalidateRelcacheByRelid(cache_relid);
+		CacheInvalidateRelcacheByRelid(ts_hypertable_id_to_relid(hypertable_id, false));
+	}
+	ts_scan_iterator_close(&iterator);
+}
+
+/*
+ * Stop using the last point cache of the hypertable, if it has one, until it
+ * is refreshed. Called for the modifications of the hypertable other than
+ * inserts.
+ */
+void
+ts_last_point_cache_invalidate(int32 hypertable_id)
+{
+	last_point_cache_set_valid(hypertable_id, false);
+}
+
+void
+ts_last_point_cache_delete_by_hypertable_id(int32 hypertable_id)
+{
+	ScanIterator iterator = ts_scan_iterator_create(HYPERTABLE_LAST_POINT_CACHE,
+													RowExclusiveLock,
+													CurrentMemoryContext);
+	CatalogSecurityContext sec_ctx;
+
+	last_point_cache_init_scan(&iterator, hypertable_id);
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+
+		ts_catalog_delete_tid(ti->scanrel, ts_scanner_get_tuple_tid(ti));
+	}
+	ts_catalog_restore_user(&sec_ctx);
+	ts_scan_iterator_close(&iterator);
+}
+
+/*
+ * Find the column of the same name, type and collation as the given one.
+ * Returns InvalidAttrNumber if there is no such column.
+ */
+static AttrNumber
+find_matching_attribute(TupleDesc desc, Form_pg_attribute attr)
+{
+	for (int i = 0; i < desc->natts; i++)
+	{
+		Form_pg_attribute candidate = TupleDescAttr(desc, i);
+
+		if (candidate->attisdropped ||
+			namestrcmp(&candidate->attname, NameStr(attr->attname)) != 0)
+			continue;
+
+		if (candidate->atttypid != attr->atttypid || candidate->atttypmod != attr->atttypmod ||
+			candidate->attcollation != attr->attcollation)
+			return InvalidAttrNumber;
+
+		return AttrOffsetGetAttrNumber(i);
+	}
+
+	return InvalidAttrNumber;
+}
+
+/*
+ * Map the columns of the "to" relation to the matching columns of the "from"
+ * relation. Returns NULL if some column of the "to" relation has no match,
+ * which happens when the hypertable was altered after the cache was created.
+ */
+static AttrMap *
+build_attrmap_by_name_strict(TupleDesc from, TupleDesc to)
+{
+	AttrMap *map = make_attrmap(to->natts);
+
+	for (int i = 0; i < to->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(to, i);
+
+		if (attr->attisdropped)
+			continue;
+
+		map->attnums[i] = find_matching_attribute(from, attr);
+
+		if (map->attnums[i] == InvalidAttrNumber)
+		{
+			free_attrmap(map);
+			return NULL;
+		}
+	}
+
+	return map;
+}
+
+LastPointCacheTracker *
+ts_last_point_cache_tracker_create(const Hypertable *ht, MemoryContext mcxt)
+{
+	LastPointCacheTracker *tracker;
+	LastPointCacheInfo info;
+	const Dimension *dim;
+	Oid *eq_funcs;
+	FmgrInfo *hash_funcs;
+	Relation rel;
+	MemoryContext old;
+
+	if (!last_point_cache_info_get(ht->fd.id, &info) || !info.valid)
+		return NULL;
+
+	rel = table_open(ht->main_table_relid, NoLock);
+
+	/*
+	 * The BEFORE and INSTEAD OF row triggers can change or skip the rows after
+	 * we have seen them, so we cannot keep the cache up to date.
+	 */
+	if (rel->trigdesc != NULL &&
+		(rel->trigdesc->trig_insert_before_row || rel->trigdesc->trig_insert_instead_row))
+	{
+		table_close(rel, NoLock);
+		ts_last_point_cache_invalidate(ht->fd.id);
+		return NULL;
+	}
+
+	old = MemoryContextSwitchTo(mcxt);
+
+	dim = hyperspace_get_open_dimension(ht->space, 0);
+	tracker = palloc0(sizeof(LastPointCacheTracker));
+	tracker->hypertable_id = ht->fd.id;
+	tracker->hypertable_relid = ht->main_table_relid;
+	tracker->tupdesc = CreateTupleDescCopy(RelationGetDescr(rel));
+	tracker->time_attno = dim->column_attno;
+	tracker->time_type = dim->fd.column_type;
+	tracker->num_keys = info.num_keys;
+	tracker->key_attnos = palloc(sizeof(AttrNumber) * info.num_keys);
+	tracker->key_eq_operators = palloc(sizeof(Oid) * info.num_keys);
+	tracker->key_collations = palloc(sizeof(Oid) * info.num_keys);
+
+	for (int i = 0; i < info.num_keys; i++)
+	{
+		AttrNumber attno = get_attnum(ht->main_table_relid, info.series_key[i]);
+		Form_pg_attribute attr;
+
+		/* A column of the series key was dropped, so the cache is useless. */
+		if (attno == InvalidAttrNumber)
+		{
+			MemoryContextSwitchTo(old);
+			table_close(rel, NoLock);
+			ts_last_point_cache_invalidate(ht->fd.id);
+			return NULL;
+		}
+
+		attr = TupleDescAttr(tracker->tupdesc, AttrNumberGetAttrOffset(attno));
+		tracker->key_attnos[i] = attno;
+		tracker->key_eq_operators[i] = lookup_type_cache(attr->atttypid, TYPECACHE_EQ_OPR)->eq_opr;
+		tracker->key_collations[i] = attr->attcollation;
+	}
+
+	table_close(rel, NoLock);
+
+	execTuplesHashPrepare(info.num_keys, tracker->key_eq_operators, &eq_funcs, &hash_funcs);
+
+	tracker->table_mcxt =
+		AllocSetContextCreate(mcxt, "last point cache tracker", ALLOCSET_DEFAULT_SIZES);
+	tracker->temp_mcxt =
+		AllocSetContextCreate(mcxt, "last point cache tracker temp", ALLOCSET_SMALL_SIZES);
+	tracker->points = BuildTupleHashTableExt(NULL,
+											 tracker->tupdesc,
+											 info.num_keys,
+											 tracker->key_attnos,
+											 eq_funcs,
+											 hash_funcs,
+											 tracker->key_collations,
+											 /* nbuckets = */ 1024,
+											 /* additionalsize = */ 0,
+											 mcxt,
+											 tracker->table_mcxt,
+											 tracker->temp_mcxt,
+											 false);
+	MemoryContextSwitchTo(old);
+
+	return tracker;
+}
+
+/*
+ * Remember the row if it is the latest of its series so far. The slot has the
+ * row type of the hypertable.
+ */
+void
+ts_last_point_cache_tracker_add(LastPointCacheTracker *tracker, TupleTableSlot *slot)
+{
+	TupleHashEntry entry;
+	LastPoint *point;
+	MemoryContext old;
+	Datum time;
+	int64 time_value;
+	bool isnull;
+	bool isnew;
+
+	time = slot_getattr(slot, tracker->time_attno, &isnull);
+	if (isnull)
+		return;
+
+	/* The rows with NULL keys are not part of any series */
+	for (int i = 0; i < tracker->num_keys; i++)
+	{
+		slot_getattr(slot, tracker->key_attnos[i], &isnull);
+		if (isnull)
+			return;
+	}
+
+	time_value = ts_time_value_to_internal(time, tracker->time_type);
+
+	old = MemoryContextSwitchTo(tracker->table_mcxt);
+	entry = LookupTupleHashEntry(tracker->points, slot, &isnew, NULL);
+
+	if (isnew)
+	{
+		point = palloc(sizeof(LastPoint));
+		point->tuple = NULL;
+		entry->additional = point;
+		tracker->num_points++;
+	}
+	else
+		point = entry->additional;
+
+	if (point->tuple == NULL || time_value > point->time)
+	{
+		if (point->tuple != NULL)
+			pfree(point->tuple);
+
+		point->tuple = ExecCopySlotMinimalTuple(slot);
+		point->time = time_value;
+	}
+
+	MemoryContextSwitchTo(old);
+	MemoryContextReset(tracker->temp_mcxt);
+}
+
+/*
+ * Find the unique index on the series key of the cache table.
+ */
+static Oid
+last_point_cache_get_index(Relation cache_rel, int num_keys)
+{
+	List *indexes = RelationGetIndexList(cache_rel);
+	ListCell *lc;
+
+	foreach (lc, indexes)
+	{
+		Relation index = index_open(lfirst_oid(lc), AccessShareLock);
+		bool match = index->rd_index->indisunique &&
+					 index->rd_index->indnkeyatts == num_keys && index->rd_indexprs == NIL;
+
+		index_close(index, AccessShareLock);
+
+		if (match)
+			return lfirst_oid(lc);
+	}
+
+	return InvalidOid;
+}
+
+/*
+ * Write the latest rows of the series seen by the statement to the cache
+ * table, where they are newer than the rows already there.
+ */
+void
+ts_last_point_cache_tracker_flush(LastPointCacheTracker *tracker)
+{
+	LastPointCacheInfo info;
+	Relation cache_rel;
+	TupleDesc cache_desc;
+	CatalogIndexState indstate;
+	TupleTableSlot *point_slot;
+	TupleHashIterator iter;
+	TupleHashEntry entry;
+	ScanKeyData *scankeys;
+	AttrNumber *cache_key_attnos;
+	AttrNumber cache_time_attno;
+	AttrMap *map;
+	Snapshot snapshot;
+	Datum *values;
+	bool *nulls;
+	Oid cache_relid;
+	Oid index_relid;
+
+	if (tracker->num_points == 0)
+		return;
+
+	if (!last_point_cache_info_get(tracker->hypertable_id, &info) || !info.valid)
+		return;
+
+	cache_relid = last_point_cache_get_relid(&info);
+	if (!OidIsValid(cache_relid))
+		return;
+
+	/*
+	 * The lock serializes the writers of the cache, so that each of them sees
+	 * the rows that the others have written. It is held until the end of the
+	 * transaction.
+	 */
+	cache_rel = table_open(cache_relid, ShareRowExclusiveLock);
+	cache_desc = RelationGetDescr(cache_rel);
+
+	/* The cache might have been invalidated while we waited for the lock. */
+	if (!last_point_cache_info_get(tracker->hypertable_id, &info) || !info.valid)
+	{
+		table_close(cache_rel, NoLock);
+		return;
+	}
+
+	map = build_attrmap_by_name_strict(tracker->tupdesc, cache_desc);
+	index_relid = last_point_cache_get_index(cache_rel, tracker->num_keys);
+	cache_time_attno =
+		find_matching_attribute(cache_desc,
+								TupleDescAttr(tracker->tupdesc,
+											  AttrNumberGetAttrOffset(tracker->time_attno)));
+	cache_key_attnos = palloc(sizeof(AttrNumber) * tracker->num_keys);
+	for (int i = 0; i < tracker->num_keys; i++)
+	{
+		Form_pg_attribute attr =
+			TupleDescAttr(tracker->tupdesc, AttrNumberGetAttrOffset(tracker->key_attnos[i]));
+
+		cache_key_attnos[i] = find_matching_attribute(cache_desc, attr);
+		if (cache_key_attnos[i] == InvalidAttrNumber)
+			cache_time_attno = InvalidAttrNumber;
+	}
+
+	/* The hypertable no longer matches the cache table. */
+	if (map == NULL || !OidIsValid(index_relid) || cache_time_attno == InvalidAttrNumber)
+	{
+		table_close(cache_rel, NoLock);
+		ts_last_point_cache_invalidate(tracker->hypertable_id);
+		return;
+	}
+
+	snapshot = RegisterSnapshot(GetLatestSnapshot());
+	indstate = CatalogOpenIndexes(cache_rel);
+	point_slot = MakeSingleTupleTableSlot(tracker->tupdesc, &TTSOpsMinimalTuple);
+	scankeys = palloc(sizeof(ScanKeyData) * tracker->num_keys);
+	values = palloc(sizeof(Datum) * cache_desc->natts);
+	nulls = palloc(sizeof(bool) * cache_desc->natts);
+
+	InitTupleHashIterator(tracker->points, &iter);
+	while ((entry = ScanTupleHashTable(tracker->points, &iter)) != NULL)
+	{
+		LastPoint *point = entry->additional;
+		HeapTuple new_tuple;
+		HeapTuple existing;
+		SysScanDesc scan;
+
+		ExecStoreMinimalTuple(point->tuple, point_slot, false);
+		slot_getallattrs(point_slot);
+
+		for (int i = 0; i < cache_desc->natts; i++)
+		{
+			AttrNumber attno = map->attnums[i];
+
+			nulls[i] = attno == InvalidAttrNumber ||
+					   point_slot->tts_isnull[AttrNumberGetAttrOffset(attno)];
+			values[i] =
+				nulls[i] ? (Datum) 0 : point_slot->tts_values[AttrNumberGetAttrOffset(attno)];
+		}
+
+		for (int i = 0; i < tracker->num_keys; i++)
+			ScanKeyEntryInitialize(&scankeys[i],
+								   0,
+								   cache_key_attnos[i],
+								   BTEqualStrategyNumber,
+								   InvalidOid,
+								   tracker->key_collations[i],
+								   get_opcode(tracker->key_eq_operators[i]),
+								   point_slot->tts_values[AttrNumberGetAttrOffset(
+									   tracker->key_attnos[i])]);
+
+		new_tuple = heap_form_tuple(cache_desc, values, nulls);
+		scan = systable_beginscan(cache_rel,
+								  index_relid,
+								  true,
+								  snapshot,
+								  tracker->num_keys,
+								  scankeys);
+		existing = systable_getnext(scan);
+
+		if (!HeapTupleIsValid(existing))
+			CatalogTupleInsertWithInfo(cache_rel, new_tuple, indstate);
+		else
+		{
+			bool isnull;
+			Datum time = heap_getattr(existing, cache_time_attno, cache_desc, &isnull);
+
+			if (isnull || point->time > ts_time_value_to_internal(time, tracker->time_type))
+				CatalogTupleUpdateWithInfo(cache_rel, &existing->t_self, new_tuple, indstate);
+		}
+
+		systable_endscan(scan);
+		heap_freetuple(new_tuple);
+		ExecClearTuple(point_slot);
+	}
+
+	ExecDropSingleTupleTableSlot(point_slot);
+	CatalogCloseIndexes(indstate);
+	UnregisterSnapshot(snapshot);
+	free_attrmap(map);
+	table_close(cache_rel, NoLock);
+
+	/* Make the changes visible to the later statements of the command */
+	CommandCounterIncrement();
+}
+
+/*
+ * Run a command on the cache table as the owner of the hypertable.
+ */
+static void
+last_point_cache_execute(Oid owner, const char *command)
+{
+	Oid saved_uid;
+	int sec_ctx;
+	int res;
+
+	GetUserIdAndSecContext(&saved_uid, &sec_ctx);
+	if (owner != saved_uid)
+		SetUserIdAndSecContext(owner, sec_ctx | SECURITY_LOCAL_USERID_CHANGE);
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "could not connect to SPI");
+
+	res = SPI_execute(command, false /* read_only */, 0 /*count*/);
+	if (res < 0)
+		elog(ERROR, "could not execute \"%s\": %s", command, SPI_result_code_string(res));
+
+	if ((res = SPI_finish()) != SPI_OK_FINISH)
+		elog(ERROR, "SPI_finish failed: %s", SPI_result_code_string(res));
+
+	if (owner != saved_uid)
+		SetUserIdAndSecContext(saved_uid, sec_ctx);
+}
+
+/*
+ * Fill the cache table with the latest row of each series of the hypertable.
+ * The cache must not be valid, so that the query reads the hypertable.
+ */
+static void
+last_point_cache_populate(const Hypertable *ht, const LastPointCacheInfo *info,
+						  Oid cache_relid, bool truncate)
+{
+	const Dimension *dim = hyperspace_get_open_dimension(ht->space, 0);
+	Relation ht_rel = table_open(ht->main_table_relid, NoLock);
+	Relation cache_rel = table_open(cache_relid, AccessShareLock);
+	TupleDesc cache_desc = RelationGetDescr(cache_rel);
+	AttrMap *map = build_attrmap_by_name_strict(RelationGetDescr(ht_rel), cache_desc);
+	const char *cache_name = quote_qualified_identifier(NameStr(info->cache_schema_name),
+														NameStr(info->cache_table_name));
+	StringInfoData columns;
+	StringInfoData keys;
+	StringInfoData command;
+	Oid owner = ht_rel->rd_rel->relowner;
+
+	Assert(!info->valid);
+
+	if (map == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("the last point cache of hypertable \"%s\" does not match its columns",
+						get_rel_name(ht->main_table_relid)),
+				 errhint("Remove the last point cache and add it again.")));
+
+	initStringInfo(&columns);
+	for (int i = 0; i < cache_desc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(cache_desc, i);
+
+		if (attr->attisdropped)
+			continue;
+
+		appendStringInfo(&columns,
+						 "%s%s",
+						 columns.len > 0 ? ", " : "",
+						 quote_identifier(NameStr(attr->attname)));
+	}
+
+	initStringInfo(&keys);
+	for (int i = 0; i < info->num_keys; i++)
+		appendStringInfo(&keys, "%s%s", i > 0 ? ", " : "", quote_identifier(info->series_key[i]));
+
+	free_attrmap(map);
+	table_close(cache_rel, NoLock);
+	table_close(ht_rel, NoLock);
+
+	if (truncate)
+	{
+		initStringInfo(&command);
+		appendStringInfo(&command, "TRUNCATE %s", cache_name);
+		last_point_cache_execute(owner, command.data);
+	}
+
+	initStringInfo(&command);
+	appendStringInfo(&command,
+					 "INSERT INTO %s (%s) SELECT DISTINCT ON (%s) %s FROM %s ORDER BY %s, %s DESC",
+					 cache_name,
+					 columns.data,
+					 keys.data,
+					 columns.data,
+					 quote_qualified_identifier(NameStr(ht->fd.schema_name),
+												NameStr(ht->fd.table_name)),
+					 keys.data,
+					 quote_identifier(NameStr(dim->fd.column_name)));
+	last_point_cache_execute(owner, command.data);
+}
+
+/*
+ * Create the cache table with the columns of the hypertable. It is owned by
+ * the owner of the hypertable and is dropped together with the hypertable.
+ */
+static Oid
+last_point_cache_create_table(const Hypertable *ht, Relation ht_rel, const char *table_name,
+							  const LastPointCacheInfo *info)
+{
+	TupleDesc desc = RelationGetDescr(ht_rel);
+	CreateStmt stmt = {
+		.type = T_CreateStmt,
+		.relation = makeRangeVar(INTERNAL_SCHEMA_NAME, (char *) table_name, 0),
+		.oncommit = ONCOMMIT_NOOP,
+	};
+	CatalogSecurityContext sec_ctx;
+	ObjectAddress cache_addr;
+	ObjectAddress ht_addr;
+	StringInfoData command;
+
+	for (int i = 0; i < desc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(desc, i);
+		ColumnDef *def;
+
+		if (attr->attisdropped)
+			continue;
+
+		def = makeColumnDef(NameStr(attr->attname),
+							attr->atttypid,
+							attr->atttypmod,
+							attr->attcollation);
+		def->is_not_null = attr->attnotnull;
+		stmt.tableElts = lappend(stmt.tableElts, def);
+	}
+
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+	cache_addr = DefineRelation(&stmt, RELKIND_RELATION, ht_rel->rd_rel->relowner, NULL, NULL);
+	CommandCounterIncrement();
+	NewRelationCreateToastTable(cache_addr.objectId, (Datum) 0);
+	ts_catalog_restore_user(&sec_ctx);
+
+	ObjectAddressSet(ht_addr, RelationRelationId, ht->main_table_relid);
+	recordDependencyOn(&cache_addr, &ht_addr, DEPENDENCY_AUTO);
+	CommandCounterIncrement();
+
+	initStringInfo(&command);
+	appendStringInfo(&command,
+					 "CREATE UNIQUE INDEX ON %s (",
+					 quote_qualified_identifier(INTERNAL_SCHEMA_NAME, table_name));
+	for (int i = 0; i < info->num_keys; i++)
+		appendStringInfo(&command,
+						 "%s%s",
+						 i > 0 ? ", " : "",
+						 quote_identifier(info->series_key[i]));
+	appendStringInfoChar(&command, ')');
+	last_point_cache_execute(ht_rel->rd_rel->relowner, command.data);
+
+	return cache_addr.objectId;
+}
+
+static void
+last_point_cache_validate_key(const Hypertable *ht, Relation ht_rel, const char *column,
+							  Bitmapset **key_attnos)
+{
+	AttrNumber attno = get_attnum(ht->main_table_relid, column);
+	const Dimension *dim = hyperspace_get_open_dimension(ht->space, 0);
+	Form_pg_attribute attr;
+	TypeCacheEntry *tce;
+
+	if (attno == InvalidAttrNumber)
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_COLUMN),
+				 errmsg("column \"%s\" does not exist", column)));
+
+	if (attno == dim->column_attno)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("series key cannot contain the time column \"%s\"", column)));
+
+	if (bms_is_member(attno, *key_attnos))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("column \"%s\" appears more than once in the series key", column)));
+
+	attr = TupleDescAttr(RelationGetDescr(ht_rel), AttrNumberGetAttrOffset(attno));
+
+	if (!attr->attnotnull)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("series key column \"%s\" must be NOT NULL", column)));
+
+	tce = lookup_type_cache(attr->atttypid, TYPECACHE_EQ_OPR | TYPECACHE_BTREE_OPFAMILY);
+
+	if (!OidIsValid(tce->btree_opf) || !OidIsValid(tce->eq_opr) ||
+		!op_hashjoinable(tce->eq_opr, attr->atttypid))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("series key column \"%s\" has an unsupported type", column),
+				 errdetail("The type must have default B-tree and hash operator classes.")));
+
+	*key_attnos = bms_add_member(*key_attnos, attno);
+}
+
+TS_FUNCTION_INFO_V1(ts_last_point_cache_add);
+
+/*
+ * Add a last point cache to a hypertable.
+ *
+ * hypertable - The hypertable
+ * series_key - The columns that identify a series
+ * if_not_exists - Don't fail if the hypertable already has a cache
+ */
+Datum
+ts_last_point_cache_add(PG_FUNCTION_ARGS)
+{
+	Oid hypertable_relid = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+	ArrayType *key_arr = PG_ARGISNULL(1) ? NULL : PG_GETARG_ARRAYTYPE_P(1);
+	bool if_not_exists = PG_ARGISNULL(2) ? false : PG_GETARG_BOOL(2);
+	Datum values[Natts_hypertable_last_point_cache] = { 0 };
+	bool nulls[Natts_hypertable_last_point_cache] = { false };
+	Bitmapset *key_attnos = NULL;
+	CatalogSecurityContext sec_ctx;
+	LastPointCacheInfo info = { 0 };
+	const Dimension *dim;
+	Hypertable *ht;
+	Relation ht_rel;
+	Relation catalog_rel;
+	Cache *hcache;
+	Datum *keys;
+	bool *key_nulls;
+	Oid cache_relid;
+
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (!OidIsValid(hypertable_relid))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("hypertable cannot be NULL")));
+
+	if (key_arr == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("series key cannot be NULL")));
+
+	ts_hypertable_permissions_check(hypertable_relid, GetUserId());
+
+	/* Block the writes to the hypertable while the cache is filled. */
+	LockRelationOid(hypertable_relid, ShareRowExclusiveLock);
+
+	ht = ts_hypertable_cache_get_cache_and_entry(hypertable_relid, CACHE_FLAG_NONE, &hcache);
+
+	if (hypertable_is_distributed(ht) || TS_HYPERTABLE_IS_INTERNAL_COMPRESSION_TABLE(ht))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("last point cache is not supported on hypertable \"%s\"",
+						get_rel_name(hypertable_relid))));
+
+	if (last_point_cache_info_get(ht->fd.id, &info))
+	{
+		if (!if_not_exists)
+			ereport(ERROR,
+					(errcode(ERRCODE_DUPLICATE_OBJECT),
+					 errmsg("hypertable \"%s\" already has a last point cache",
+							get_rel_name(hypertable_relid))));
+
+		ereport(NOTICE,
+				(errmsg("hypertable \"%s\" already has a last point cache, skipping",
+						get_rel_name(hypertable_relid))));
+		ts_cache_release(hcache);
+		PG_RETURN_VOID();
+	}
+
+	dim = hyperspace_get_open_dimension(ht->space, 0);
+	if (dim->partitioning != NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("last point cache is not supported with a time partitioning function")));
+
+	deconstruct_array(key_arr,
+					  NAMEOID,
+					  NAMEDATALEN,
+					  false,
+					  TYPALIGN_CHAR,
+					  &keys,
+					  &key_nulls,
+					  &info.num_keys);
+
+	if (info.num_keys == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("series key cannot be empty")));
+
+	ht_rel = table_open(hypertable_relid, NoLock);
+	info.series_key = palloc(sizeof(char *) * info.num_keys);
+
+	for (int i = 0; i < info.num_keys; i++)
+	{
+		if (key_nulls[i])
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("series key cannot contain NULL")));
+
+		info.series_key[i] = NameStr(*DatumGetName(keys[i]));
+		last_point_cache_validate_key(ht, ht_rel, info.series_key[i], &key_attnos);
+	}
+
+	info.hypertable_id = ht->fd.id;
+	namestrcpy(&info.cache_schema_name, INTERNAL_SCHEMA_NAME);
+	snprintf(NameStr(info.cache_table_name),
+			 NAMEDATALEN,
+			 "%s_last_point",
+			 NameStr(ht->fd.associated_table_prefix));
+	info.valid = false;
+
+	cache_relid =
+		last_point_cache_create_table(ht, ht_rel, NameStr(info.cache_table_name), &info);
+	table_close(ht_rel, NoLock);
+
+	last_point_cache_populate(ht, &info, cache_relid, false);
+
+	values[AttrNumberGetAttrOffset(Anum_hypertable_last_point_cache_hypertable_id)] =
+		Int32GetDatum(info.hypertable_id);
+	values[AttrNumberGetAttrOffset(Anum_hypertable_last_point_cache_cache_schema_name)] =
+		NameGetDatum(&info.cache_schema_name);
+	values[AttrNumberGetAttrOffset(Anum_hypertable_last_point_cache_cache_table_name)] =
+		NameGetDatum(&info.cache_table_name);
+	values[AttrNumberGetAttrOffset(Anum_hypertable_last_point_cache_valid)] = BoolGetDatum(true);
+	values[AttrNumberGetAttrOffset(Anum_hypertable_last_point_cache_series_key)] =
+		PointerGetDatum(key_arr);
+
+	catalog_rel = table_open(catalog_get_table_id(ts_catalog_get(), HYPERTABLE_LAST_POINT_CACHE),
+							 RowExclusiveLock);
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+	ts_catalog_insert_values(catalog_rel, RelationGetDescr(catalog_rel), values, nulls);
+	ts_catalog_restore_user(&sec_ctx);
+	table_close(catalog_rel, RowExclusiveLock);
+
+	/* Plan the queries on the hypertable again, so that they can use the cache. */
+	CacheInvalidateRelcacheByRelid(hypertable_relid);
+	ts_cache_release(hcache);
+
+	PG_RETURN_VOID();
+}
+
+TS_FUNCTION_INFO_V1(ts_last_point_cache_remove);
+
+/*
+ * Remove the last point cache of a hypertable.
+ *
+ * hypertable - The hypertable
+ * if_exists - Don't fail if the hypertable has no cache
+ */
+Datum
+ts_last_point_cache_remove(PG_FUNCTION_ARGS)
+{
+	Oid hypertable_relid = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+	bool if_exists = PG_ARGISNULL(1) ? false : PG_GETARG_BOOL(1);
+	LastPointCacheInfo info;
+	Hypertable *ht;
+	Cache *hcache;
+	Oid cache_relid;
+
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (!OidIsValid(hypertable_relid))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("hypertable cannot be NULL")));
+
+	ts_hypertable_permissions_check(hypertable_relid, GetUserId());
+	LockRelationOid(hypertable_relid, ShareRowExclusiveLock);
+	ht = ts_hypertable_cache_get_cache_and_entry(hypertable_relid, CACHE_FLAG_NONE, &hcache);
+
+	if (!last_point_cache_info_get(ht->fd.id, &info))
+	{
+		if (!if_exists)
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_OBJECT),
+					 errmsg("hypertable \"%s\" has no last point cache",
+							get_rel_name(hypertable_relid))));
+
+		ereport(NOTICE,
+				(errmsg("hypertable \"%s\" has no last point cache, skipping",
+						get_rel_name(hypertable_relid))));
+		ts_cache_release(hcache);
+		PG_RETURN_VOID();
+	}
+
+	ts_last_point_cache_delete_by_hypertable_id(ht->fd.id);
+
+	cache_relid = last_point_cache_get_relid(&info);
+	if (OidIsValid(cache_relid))
+	{
+		ObjectAddress cache_addr;
+
+		ObjectAddressSet(cache_addr, RelationRelationId, cache_relid);
+		performDeletion(&cache_addr, DROP_RESTRICT, 0);
+	}
+
+	ts_cache_release(hcache);
+
+	PG_RETURN_VOID();
+}
+
+TS_FUNCTION_INFO_V1(ts_last_point_cache_refresh);
+
+/*
+ * Fill the last point cache of a hypertable again from its data, and make it
+ * valid.
+ *
+ * hypertable - The hypertable
+ */
+Datum
+ts_last_point_cache_refresh(PG_FUNCTION_ARGS)
+{
+	Oid hypertable_relid = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+	LastPointCacheInfo info;
+	Hypertable *ht;
+	Cache *hcache;
+	Oid cache_relid;
+
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (!OidIsValid(hypertable_relid))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("hypertable cannot be NULL")));
+
+	ts_hypertable_permissions_check(hypertable_relid, GetUserId());
+
+	/* Block the writes to the hypertable while the cache is filled. */
+	LockRelationOid(hypertable_relid, ShareRowExclusiveLock);
+	ht = ts_hypertable_cache_get_cache_and_entry(hypertable_relid, CACHE_FLAG_NONE, &hcache);
+
+	if (!last_point_cache_info_get(ht->fd.id, &info))
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_OBJECT),
+				 errmsg("hypertable \"%s\" has no last point cache",
+						get_rel_name(hypertable_relid))));
+
+	cache_relid = last_point_cache_get_relid(&info);
+	if (!OidIsValid(cache_relid))
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_TABLE),
+				 errmsg("the last point cache table of hypertable \"%s\" does not exist",
+						get_rel_name(hypertable_relid)),
+				 errhint("Remove the last point cache and add it again.")));
+
+	last_point_cache_set_valid(ht->fd.id, false);
+	info.valid = false;
+	last_point_cache_populate(ht, &info, cache_relid, true);
+	last_point_cache_set_valid(ht->fd.id, true);
+
+	ts_cache_release(hcache);
+
+	PG_RETURN_VOID();
+}
+
+static AttrNumber
+sort_group_clause_attno(SortGroupClause *sgc, List *tlist, Index rti)
+{
+	TargetEntry *tle = get_sortgroupclause_tle(sgc, tlist);
+	Var *var;
+
+	if (!IsA(tle->expr, Var))
+		return InvalidAttrNumber;
+
+	var = castNode(Var, tle->expr);
+	if (var->varno != (int) rti || var->varlevelsup != 0)
+		return InvalidAttrNumber;
+
+	return var->varattno;
+}
+
+/*
+ * Check that the query is a DISTINCT ON the series key of the cache, and that
+ * it is ordered by the series key and then by time descending, so that it
+ * returns the latest row of each series.
+ */
+static bool
+last_point_cache_query_matches(Query *query, Index rti, const Hypertable *ht,
+							   const LastPointCacheInfo *info)
+{
+	const Dimension *dim = hyperspace_get_open_dimension(ht->space, 0);
+	Bitmapset *key_attnos = NULL;
+	Bitmapset *distinct_attnos = NULL;
+	ListCell *lc;
+	int i = 0;
+
+	if (list_length(query->distinctClause) != info->num_keys ||
+		list_length(query->sortClause) != info->num_keys + 1)
+		return false;
+
+	for (int k = 0; k < info->num_keys; k++)
+	{
+		AttrNumber attno = get_attnum(ht->main_table_relid, info->series_key[k]);
+
+		if (attno == InvalidAttrNumber)
+			return false;
+
+		key_attnos = bms_add_member(key_attnos, attno);
+	}
+
+	foreach (lc, query->distinctClause)
+	{
+		AttrNumber attno = sort_group_clause_attno(lfirst_node(SortGroupClause, lc),
+												   query->targetList,
+												   rti);
+
+		if (attno <= 0 || !bms_is_member(attno, key_attnos))
+			return false;
+
+		distinct_attnos = bms_add_member(distinct_attnos, attno);
+	}
+
+	if (!bms_equal(distinct_attnos, key_attnos))
+		return false;
+
+	foreach (lc, query->sortClause)
+	{
+		SortGroupClause *sgc = lfirst_node(SortGroupClause, lc);
+		AttrNumber attno = sort_group_clause_attno(sgc, query->targetList, rti);
+
+		if (i < info->num_keys)
+		{
+			if (attno <= 0 || !bms_is_member(attno, key_attnos))
+				return false;
+		}
+		else
+		{
+			Oid opfamily;
+			Oid opcintype;
+			int16 strategy;
+
+			if (attno != dim->column_attno ||
+				!get_ordering_op_properties(sgc->sortop, &opfamily, &opcintype, &strategy) ||
+				strategy != BTGreaterStrategyNumber)
+				return false;
+		}
+
+		i++;
+	}
+
+	return true;
+}
+
+/*
+ * Read the latest row of each series from the last point cache, instead of
+ * the hypertable, if the query asks for exactly that. The query itself stays
+ * the same, since the DISTINCT ON over the cache table gives the same result.
+ *
+ * The hypertable stays in the range table, outside of the join tree, like the
+ * views do. This checks the permissions on the hypertable at execution and
+ * makes the plan depend on it. The cache table itself needs no permissions.
+ */
+bool
+ts_last_point_cache_rewrite_query(Query *query, Cache *hcache)
+{
+	LastPointCacheInfo info;
+	RangeTblEntry *rte;
+	RangeTblEntry *ht_rte;
+	RangeTblRef *rtr;
+	Relation cache_rel;
+	Relation ht_rel;
+	TupleDesc ht_desc;
+	TupleDesc cache_desc;
+	Hypertable *ht;
+	AttrMap *map;
+	List *tlist;
+	List *colnames = NIL;
+	bool found_whole_row;
+	Oid cache_relid;
+
+	if (query->commandType != CMD_SELECT || query->utilityStmt != NULL ||
+		!query->hasDistinctOn || query->hasAggs || query->hasWindowFuncs ||
+		query->hasTargetSRFs || query->hasSubLinks || query->hasRecursive ||
+		query->hasModifyingCTE || query->hasForUpdate || query->rowMarks != NIL ||
+		query->cteList != NIL || query->groupClause != NIL || query->groupingSets != NIL ||
+		query->havingQual != NULL || query->setOperations != NULL ||
+		list_length(query->rtable) != 1 || query->jointree == NULL ||
+		query->jointree->quals != NULL || list_length(query->jointree->fromlist) != 1)
+		return false;
+
+	rtr = linitial(query->jointree->fromlist);
+	if (!IsA(rtr, RangeTblRef))
+		return false;
+
+	rte = rt_fetch(rtr->rtindex, query->rtable);
+	if (rte->rtekind != RTE_RELATION || !rte->inh || rte->tablesample != NULL ||
+		rte->securityQuals != NIL || (rte->alias != NULL && rte->alias->colnames != NIL))
+		return false;
+
+	ht = ts_hypertable_cache_get_entry(hcache, rte->relid, CACHE_FLAG_MISSING_OK);
+	if (ht == NULL || !last_point_cache_info_get(ht->fd.id, &info) || !info.valid)
+		return false;
+
+	/* The volatile functions would be evaluated for fewer rows. */
+	if (contain_volatile_functions((Node *) query->targetList) ||
+		!last_point_cache_query_matches(query, rtr->rtindex, ht, &info))
+		return false;
+
+	cache_relid = last_point_cache_get_relid(&info);
+	if (!OidIsValid(cache_relid))
+		return false;
+
+	cache_rel = table_open(cache_relid, AccessShareLock);
+	ht_rel = table_open(rte->relid, NoLock);
+	ht_desc = RelationGetDescr(ht_rel);
+	cache_desc = RelationGetDescr(cache_rel);
+
+	/* All the columns of the hypertable have to be in the cache. */
+	map = build_attrmap_by_name_strict(cache_desc, ht_desc);
+	tlist = map == NULL ? NIL :
+						  (List *) map_variable_attnos((Node *) query->targetList,
+													   rtr->rtindex,
+													   0,
+													   map,
+													   InvalidOid,
+													   &found_whole_row);
+
+	if (map == NULL || found_whole_row)
+	{
+		table_close(ht_rel, NoLock);
+		table_close(cache_rel, NoLock);
+		return false;
+	}
+
+	for (int i = 0; i < cache_desc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(cache_desc, i);
+		const char *colname = attr->attisdropped ? "" : NameStr(attr->attname);
+
+		colnames = lappend(colnames, makeString(pstrdup(colname)));
+	}
+
+	table_close(ht_rel, NoLock);
+	/* Keep the lock on the cache table until the end of the transaction */
+	table_close(cache_rel, NoLock);
+
+	ht_rte = copyObject(rte);
+	ht_rte->inh = false;
+	ht_rte->inFromCl = false;
+	query->rtable = lappend(query->rtable, ht_rte);
+
+	query->targetList = tlist;
+	rte->relid = cache_relid;
+	rte->relkind = RELKIND_RELATION;
+	rte->inh = false;
+	rte->eref = makeAlias(rte->eref->aliasname, colnames);
+#if PG16_LT
+	rte->requiredPerms = 0;
+	rte->selectedCols = NULL;
+#else
+	rte->perminfoindex = 0;
+#endif
+
+	return true;
+}
@@ -0,0 +1,33 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_LAST_POINT_CACHE_H
+#define TIMESCALEDB_LAST_POINT_CACHE_H
+
+#include <postgres.h>
+#include <executor/tuptable.h>
+#include <nodes/parsenodes.h>
+
+#include "cache.h"
+#include "hypertable.h"
+
+/*
+ * Collects the latest inserted row of each series during an INSERT or COPY
+ * into a hypertable that has a last point cache. The rows are written to the
+ * cache table when the statement finishes.
+ */
+typedef struct LastPointCacheTracker LastPointCacheTracker;
+
+extern LastPointCacheTracker *ts_last_point_cache_tracker_create(const Hypertable *ht,
+																 MemoryContext mcxt);
+extern void ts_last_point_cache_tracker_add(LastPointCacheTracker *tracker,
+											TupleTableSlot *slot);
+extern void ts_last_point_cache_tracker_flush(LastPointCacheTracker *tracker);
+
+extern void ts_last_point_cache_invalidate(int32 hypertable_id);
+extern void ts_last_point_cache_delete_by_hypertable_id(int32 hypertable_id);
+extern bool ts_last_point_cache_rewrite_query(Query *query, Cache *hcache);
+
+#endif /* TIMESCALEDB_LAST_POINT_CACHE_H */
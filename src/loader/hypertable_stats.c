@@ -0,0 +1,60 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <fmgr.h>
+#include <storage/shmem.h>
+
+#include "loader/hypertable_stats.h"
+
+/*
+ * The number of hypertables, in all databases, that we can keep the stats
+ * of. The stats of the hypertables beyond that are not collected.
+ */
+#define HYPERTABLE_STATS_HASH_SIZE 2048
+
+static HypertableStatsRendezvous rendezvous;
+
+void
+ts_hypertable_stats_shmem_startup(void)
+{
+	HypertableStatsRendezvous **rendezvous_ptr;
+	HASHCTL hash_info;
+	HTAB *entries;
+	LWLock **lock;
+	bool found;
+
+	hash_info.keysize = sizeof(HypertableStatsKey);
+	hash_info.entrysize = sizeof(HypertableStatsEntry);
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+	/* GetNamedLWLockTranche must only be run once, see function_telemetry.c */
+	lock = ShmemInitStruct("hypertable_stats_detect_first_run", sizeof(LWLock *), &found);
+	if (!found)
+		*lock = &(GetNamedLWLockTranche(HYPERTABLE_STATS_LWLOCK_TRANCHE_NAME))->lock;
+
+	entries = ShmemInitHash("timescaledb hypertable stats hash",
+							HYPERTABLE_STATS_HASH_SIZE,
+							HYPERTABLE_STATS_HASH_SIZE,
+							&hash_info,
+							HASH_ELEM | HASH_BLOBS);
+	LWLockRelease(AddinShmemInitLock);
+
+	rendezvous.lock = *lock;
+	rendezvous.entries = entries;
+
+	rendezvous_ptr =
+		(HypertableStatsRendezvous **) find_rendezvous_variable(RENDEZVOUS_HYPERTABLE_STATS);
+	*rendezvous_ptr = &rendezvous;
+}
+
+void
+ts_hypertable_stats_shmem_alloc(void)
+{
+	Size size = hash_estimate_size(HYPERTABLE_STATS_HASH_SIZE, sizeof(HypertableStatsEntry));
+	RequestAddinShmemSpace(add_size(size, sizeof(LWLock *)));
+	RequestNamedLWLockTranche(HYPERTABLE_STATS_LWLOCK_TRANCHE_NAME, 1);
+}
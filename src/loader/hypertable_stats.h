@@ -0,0 +1,49 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_LOADER_HYPERTABLE_STATS_H
+#define TIMESCALEDB_LOADER_HYPERTABLE_STATS_H
+
+#include <postgres.h>
+#include <port/atomics.h>
+#include <storage/lwlock.h>
+#include <utils/hsearch.h>
+
+#define RENDEZVOUS_HYPERTABLE_STATS "ts_hypertable_stats"
+#define HYPERTABLE_STATS_LWLOCK_TRANCHE_NAME "ts_hypertable_stats_lwlock_tranche"
+
+/*
+ * The shared memory is allocated by the loader, so its layout has to stay the
+ * same across versions. The versioned library owns the mapping of the
+ * counters to the slots.
+ */
+#define TS_HYPERTABLE_STATS_MAX_COUNTERS 32
+
+typedef struct HypertableStatsKey
+{
+	Oid dbid;
+	int32 hypertable_id;
+} HypertableStatsKey;
+
+typedef struct HypertableStatsEntry
+{
+	HypertableStatsKey key;
+	pg_atomic_uint64 counters[TS_HYPERTABLE_STATS_MAX_COUNTERS];
+} HypertableStatsEntry;
+
+/*
+ * The lock is taken in shared mode to update the counters of the existing
+ * entries, and in exclusive mode to add or remove entries.
+ */
+typedef struct HypertableStatsRendezvous
+{
+	LWLock *lock;
+	HTAB *entries;
+} HypertableStatsRendezvous;
+
+extern void ts_hypertable_stats_shmem_startup(void);
+extern void ts_hypertable_stats_shmem_alloc(void);
+
+#endif /* TIMESCALEDB_LOADER_HYPERTABLE_STATS_H */
@@ -0,0 +1,64 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <fmgr.h>
+#include <storage/shmem.h>
+
+#include "loader/invalidation_threshold_cache.h"
+
+/*
+ * The number of hypertables, in all databases, that we can cache the
+ * invalidation thresholds of. The thresholds of the hypertables beyond that
+ * are read from the catalog.
+ */
+#define INVALIDATION_THRESHOLD_CACHE_HASH_SIZE 8192
+
+static InvalidationThresholdCacheRendezvous rendezvous;
+
+void
+ts_invalidation_threshold_cache_shmem_startup(void)
+{
+	InvalidationThresholdCacheRendezvous **rendezvous_ptr;
+	HASHCTL hash_info;
+	HTAB *entries;
+	LWLock **lock;
+	bool found;
+
+	hash_info.keysize = sizeof(InvalidationThresholdCacheKey);
+	hash_info.entrysize = sizeof(InvalidationThresholdCacheEntry);
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+	/* GetNamedLWLockTranche must only be run once, see function_telemetry.c */
+	lock = ShmemInitStruct("invalidation_threshold_cache_detect_first_run",
+						   sizeof(LWLock *),
+						   &found);
+	if (!found)
+		*lock = &(GetNamedLWLockTranche(INVALIDATION_THRESHOLD_CACHE_LWLOCK_TRANCHE_NAME))->lock;
+
+	entries = ShmemInitHash("timescaledb invalidation threshold cache hash",
+							INVALIDATION_THRESHOLD_CACHE_HASH_SIZE,
+							INVALIDATION_THRESHOLD_CACHE_HASH_SIZE,
+							&hash_info,
+							HASH_ELEM | HASH_BLOBS);
+	LWLockRelease(AddinShmemInitLock);
+
+	rendezvous.lock = *lock;
+	rendezvous.entries = entries;
+
+	rendezvous_ptr = (InvalidationThresholdCacheRendezvous **) find_rendezvous_variable(
+		RENDEZVOUS_INVALIDATION_THRESHOLD_CACHE);
+	*rendezvous_ptr = &rendezvous;
+}
+
+void
+ts_invalidation_threshold_cache_shmem_alloc(void)
+{
+	Size size = hash_estimate_size(INVALIDATION_THRESHOLD_CACHE_HASH_SIZE,
+								   sizeof(InvalidationThresholdCacheEntry));
+	RequestAddinShmemSpace(add_size(size, sizeof(LWLock *)));
+	RequestNamedLWLockTranche(INVALIDATION_THRESHOLD_CACHE_LWLOCK_TRANCHE_NAME, 1);
+}
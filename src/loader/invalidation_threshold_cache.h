@@ -0,0 +1,48 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_LOADER_INVALIDATION_THRESHOLD_CACHE_H
+#define TIMESCALEDB_LOADER_INVALIDATION_THRESHOLD_CACHE_H
+
+#include <postgres.h>
+#include <port/atomics.h>
+#include <storage/lwlock.h>
+#include <utils/hsearch.h>
+
+#define RENDEZVOUS_INVALIDATION_THRESHOLD_CACHE "ts_invalidation_threshold_cache"
+#define INVALIDATION_THRESHOLD_CACHE_LWLOCK_TRANCHE_NAME                                           \
+	"ts_invalidation_threshold_cache_lwlock_tranche"
+
+/*
+ * The shared memory is allocated by the loader, so its layout has to stay the
+ * same across versions.
+ */
+typedef struct InvalidationThresholdCacheKey
+{
+	Oid dbid;
+	int32 hypertable_id;
+} InvalidationThresholdCacheKey;
+
+typedef struct InvalidationThresholdCacheEntry
+{
+	InvalidationThresholdCacheKey key;
+	/* The threshold in the internal time representation, only moves forward */
+	pg_atomic_uint64 threshold;
+} InvalidationThresholdCacheEntry;
+
+/*
+ * The lock is taken in shared mode to read the entries and to move their
+ * thresholds, and in exclusive mode to add or remove entries.
+ */
+typedef struct InvalidationThresholdCacheRendezvous
+{
+	LWLock *lock;
+	HTAB *entries;
+} InvalidationThresholdCacheRendezvous;
+
+extern void ts_invalidation_threshold_cache_shmem_startup(void);
+extern void ts_invalidation_threshold_cache_shmem_alloc(void);
+
+#endif /* TIMESCALEDB_LOADER_INVALIDATION_THRESHOLD_CACHE_H */
@@ -31,12 +31,17 @@
 
 #include "loader/loader.h"
 #include "loader/function_telemetry.h"
+#include "loader/hypertable_stats.h"
+#include "loader/invalidation_threshold_cache.h"
+#include "loader/relation_size_cache.h"
 #include "loader/bgw_counter.h"
 #include "loader/bgw_interface.h"
 #include "loader/bgw_launcher.h"
 #include "loader/bgw_message_queue.h"
 #include "loader/lwlocks.h"
 #include "loader/seclabel.h"
+#include "loader/version_cache.h"
+#include "loader/wait_stats.h"
 
 /*
  * Loading process:
@@ -45,7 +50,8 @@
  *      post_parse_analyze_hook (a postgres-defined hook which is called after
  *      every statement is parsed) to our function post_analyze_hook
  *   2. When a command is run with timescale not loaded, post_analyze_hook:
- *        a. Gets the extension version.
+ *        a. Gets the extension version, from the shared version cache if
+ *           another backend already looked it up in this database.
  *        b. Loads the versioned extension.
  *        c. Grabs the post_parse_analyze_hook from the versioned extension
  *           (src/init.c:post_analyze_hook) and stores it in
@@ -111,6 +117,14 @@ static shmem_request_hook_type prev_shmem_request_hook;
 #endif
 static ProcessUtility_hook_type prev_ProcessUtility_hook;
 
+/*
+ * The database whose cached extension versions have to be invalidated again
+ * at the end of the transaction, InvalidOid if there is none. If statements
+ * for several databases ran, all the cached versions are invalidated.
+ */
+static Oid version_cache_pending_dbid = InvalidOid;
+static bool version_cache_pending = false;
+
 typedef struct TsExtension
 {
 	/*
@@ -586,6 +600,44 @@ check_uuid(const char *label)
 	PG_END_TRY();
 }
 
+/*
+ * Invalidate the cached extension versions of the database both now and at
+ * the end of the transaction, when the catalog change becomes visible to the
+ * other backends.
+ */
+static void
+version_cache_invalidate_for_xact(Oid dbid)
+{
+	ts_version_cache_invalidate(dbid);
+
+	if (version_cache_pending && version_cache_pending_dbid != dbid)
+		version_cache_pending_dbid = InvalidOid;
+	else
+		version_cache_pending_dbid = dbid;
+	version_cache_pending = true;
+}
+
+static void
+version_cache_xact_callback(XactEvent event, void *arg)
+{
+	switch (event)
+	{
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_PARALLEL_ABORT:
+			if (version_cache_pending)
+			{
+				ts_version_cache_invalidate(version_cache_pending_dbid);
+				version_cache_pending_dbid = InvalidOid;
+				version_cache_pending = false;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
 static void
 loader_process_utility_hook(PlannedStmt *pstmt, const char *query_string,
 #if PG14_GE
@@ -610,9 +662,20 @@ loader_process_utility_hook(PlannedStmt *pstmt, const char *query_string,
 			Oid dboid = get_database_oid(stmt->dbname, stmt->missing_ok);
 
 			if (OidIsValid(dboid))
+			{
 				is_distributed_database = ts_seclabel_get_dist_uuid(dboid, &dist_uuid);
+				version_cache_invalidate_for_xact(dboid);
+			}
 			break;
 		}
+		case T_CreateExtensionStmt:
+		case T_AlterExtensionStmt:
+			version_cache_invalidate_for_xact(MyDatabaseId);
+			break;
+		case T_DropStmt:
+			if (castNode(DropStmt, pstmt->utilityStmt)->removeType == OBJECT_EXTENSION)
+				version_cache_invalidate_for_xact(MyDatabaseId);
+			break;
 		case T_SecLabelStmt:
 		{
 			SecLabelStmt *stmt = castNode(SecLabelStmt, pstmt->utilityStmt);
@@ -667,6 +730,11 @@ timescaledb_shmem_startup_hook(void)
 	ts_bgw_message_queue_shmem_startup();
 	ts_lwlocks_shmem_startup();
 	ts_function_telemetry_shmem_startup();
+	ts_version_cache_shmem_startup();
+	ts_wait_stats_shmem_startup();
+	ts_hypertable_stats_shmem_startup();
+	ts_relation_size_cache_shmem_startup();
+	ts_invalidation_threshold_cache_shmem_startup();
 }
 
 /*
@@ -686,6 +754,11 @@ timescaledb_shmem_request_hook(void)
 	ts_bgw_message_queue_alloc();
 	ts_lwlocks_shmem_alloc();
 	ts_function_telemetry_shmem_alloc();
+	ts_version_cache_shmem_alloc();
+	ts_wait_stats_shmem_alloc();
+	ts_hypertable_stats_shmem_alloc();
+	ts_relation_size_cache_shmem_alloc();
+	ts_invalidation_threshold_cache_shmem_alloc();
 }
 
 static void
@@ -767,12 +840,41 @@ _PG_init(void)
 	/* register utility hook to handle a distributed database drop */
 	prev_ProcessUtility_hook = ProcessUtility_hook;
 	ProcessUtility_hook = loader_process_utility_hook;
+
+	RegisterXactCallback(version_cache_xact_callback, NULL);
+}
+
+/*
+ * Get the installed version of the extension. The shared version cache is
+ * only used for an installed extension, because during CREATE or ALTER
+ * EXTENSION the version is changing, and not in a transaction that itself
+ * changed the version, because the other backends can't see that yet.
+ */
+static char *
+loader_extension_version(TsExtension const *const ext, bool use_cache)
+{
+	char cached_version[MAX_VERSION_LEN];
+	uint64 generation;
+	char *version;
+
+	use_cache = use_cache && !version_cache_pending;
+
+	if (use_cache &&
+		ts_version_cache_lookup(MyDatabaseId, ext->name, cached_version, &generation))
+		return pstrdup(cached_version);
+
+	version = extension_version(ext->name);
+
+	if (use_cache)
+		ts_version_cache_store(MyDatabaseId, ext->name, version, generation);
+
+	return version;
 }
 
 inline static void
-do_load(TsExtension *const ext)
+do_load(TsExtension *const ext, bool installed)
 {
-	char *version = extension_version(ext->name);
+	char *version = loader_extension_version(ext, installed);
 	char soname[MAX_SO_NAME_LEN];
 	post_parse_analyze_hook_type old_hook;
 
@@ -862,8 +964,10 @@ extension_check(TsExtension *const ext)
 			 * calls. Otherwise, the CREATE FUNCTION calls will load the .so
 			 * without capturing the post_parse_analyze_hook.
 			 */
+			do_load(ext, false);
+			return;
 		case EXTENSION_STATE_CREATED:
-			do_load(ext);
+			do_load(ext, true);
 			return;
 		case EXTENSION_STATE_UNKNOWN:
 		case EXTENSION_STATE_NOT_INSTALLED:
@@ -0,0 +1,60 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <fmgr.h>
+#include <storage/shmem.h>
+
+#include "loader/relation_size_cache.h"
+
+/*
+ * The number of relations, in all databases, that we can cache the sizes of.
+ * The sizes of the relations beyond that are measured on every call.
+ */
+#define RELATION_SIZE_CACHE_HASH_SIZE 65536
+
+static RelationSizeCacheRendezvous rendezvous;
+
+void
+ts_relation_size_cache_shmem_startup(void)
+{
+	RelationSizeCacheRendezvous **rendezvous_ptr;
+	HASHCTL hash_info;
+	HTAB *entries;
+	LWLock **lock;
+	bool found;
+
+	hash_info.keysize = sizeof(RelationSizeCacheKey);
+	hash_info.entrysize = sizeof(RelationSizeCacheEntry);
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+	/* GetNamedLWLockTranche must only be run once, see function_telemetry.c */
+	lock = ShmemInitStruct("relation_size_cache_detect_first_run", sizeof(LWLock *), &found);
+	if (!found)
+		*lock = &(GetNamedLWLockTranche(RELATION_SIZE_CACHE_LWLOCK_TRANCHE_NAME))->lock;
+
+	entries = ShmemInitHash("timescaledb relation size cache hash",
+							RELATION_SIZE_CACHE_HASH_SIZE,
+							RELATION_SIZE_CACHE_HASH_SIZE,
+							&hash_info,
+							HASH_ELEM | HASH_BLOBS);
+	LWLockRelease(AddinShmemInitLock);
+
+	rendezvous.lock = *lock;
+	rendezvous.entries = entries;
+
+	rendezvous_ptr =
+		(RelationSizeCacheRendezvous **) find_rendezvous_variable(RENDEZVOUS_RELATION_SIZE_CACHE);
+	*rendezvous_ptr = &rendezvous;
+}
+
+void
+ts_relation_size_cache_shmem_alloc(void)
+{
+	Size size = hash_estimate_size(RELATION_SIZE_CACHE_HASH_SIZE, sizeof(RelationSizeCacheEntry));
+	RequestAddinShmemSpace(add_size(size, sizeof(LWLock *)));
+	RequestNamedLWLockTranche(RELATION_SIZE_CACHE_LWLOCK_TRANCHE_NAME, 1);
+}
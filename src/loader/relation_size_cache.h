@@ -0,0 +1,53 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_LOADER_RELATION_SIZE_CACHE_H
+#define TIMESCALEDB_LOADER_RELATION_SIZE_CACHE_H
+
+#include <postgres.h>
+#include <port/atomics.h>
+#include <storage/lwlock.h>
+#include <utils/hsearch.h>
+#include <utils/timestamp.h>
+
+#define RENDEZVOUS_RELATION_SIZE_CACHE "ts_relation_size_cache"
+#define RELATION_SIZE_CACHE_LWLOCK_TRANCHE_NAME "ts_relation_size_cache_lwlock_tranche"
+
+/*
+ * The shared memory is allocated by the loader, so its layout has to stay the
+ * same across versions.
+ */
+typedef struct RelationSizeCacheKey
+{
+	Oid dbid;
+	Oid relid;
+} RelationSizeCacheKey;
+
+typedef struct RelationSizeCacheEntry
+{
+	RelationSizeCacheKey key;
+	/* When the sizes were measured */
+	TimestampTz measured;
+	/* Set when the relation has changed since the sizes were measured */
+	pg_atomic_uint32 stale;
+	int64 heap_size;
+	int64 index_size;
+	int64 toast_size;
+} RelationSizeCacheEntry;
+
+/*
+ * The lock is taken in shared mode to read the entries and to mark them
+ * stale, and in exclusive mode to add, update or remove entries.
+ */
+typedef struct RelationSizeCacheRendezvous
+{
+	LWLock *lock;
+	HTAB *entries;
+} RelationSizeCacheRendezvous;
+
+extern void ts_relation_size_cache_shmem_startup(void);
+extern void ts_relation_size_cache_shmem_alloc(void);
+
+#endif /* TIMESCALEDB_LOADER_RELATION_SIZE_CACHE_H */
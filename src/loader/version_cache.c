@@ -0,0 +1,191 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+/*
+ * A cluster-wide cache of the installed extension versions per database.
+ *
+ * Every new backend has to find out which versioned library to load, which
+ * means a scan of pg_extension. With many short-lived connections this adds
+ * up, so the loader remembers the version it found in shared memory and the
+ * backends that connect to the same database later take it from there.
+ *
+ * The entries are invalidated by the loader's utility hook on the statements
+ * that can change the installed version. Since the catalog change only
+ * becomes visible at commit, the invalidation is repeated at the end of the
+ * transaction. A backend that read the catalog before that could store a
+ * stale version afterwards, so every invalidation bumps a generation counter,
+ * and a version is only stored if the generation hasn't changed since the
+ * lookup that missed.
+ */
+
+#include <postgres.h>
+#include <miscadmin.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+#include <utils/builtins.h>
+#include <utils/hsearch.h>
+
+#include "extension_constants.h"
+#include "loader/version_cache.h"
+
+#define VERSION_CACHE_SHMEM_NAME "ts_version_cache_shmem"
+#define VERSION_CACHE_HASH_NAME "timescaledb extension version cache"
+
+/*
+ * The number of cached versions. There is one entry per database and
+ * extension, so this covers a few hundred databases. When the cache is full
+ * the versions are simply not cached.
+ */
+#define VERSION_CACHE_SIZE 512
+
+typedef struct VersionCacheKey
+{
+	Oid dbid;
+	NameData extname;
+} VersionCacheKey;
+
+typedef struct VersionCacheEntry
+{
+	VersionCacheKey key;
+	char version[MAX_VERSION_LEN];
+} VersionCacheEntry;
+
+typedef struct VersionCacheState
+{
+	LWLock *lock;
+	/* protected by the lock */
+	uint64 generation;
+} VersionCacheState;
+
+static VersionCacheState *version_cache_state = NULL;
+static HTAB *version_cache = NULL;
+
+void
+ts_version_cache_shmem_startup(void)
+{
+	HASHCTL hash_info = {
+		.keysize = sizeof(VersionCacheKey),
+		.entrysize = sizeof(VersionCacheEntry),
+	};
+	bool found;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	version_cache_state =
+		ShmemInitStruct(VERSION_CACHE_SHMEM_NAME, sizeof(VersionCacheState), &found);
+	if (!found)
+	{
+		memset(version_cache_state, 0, sizeof(VersionCacheState));
+		version_cache_state->lock =
+			&(GetNamedLWLockTranche(VERSION_CACHE_LWLOCK_TRANCHE_NAME))->lock;
+	}
+	version_cache = ShmemInitHash(VERSION_CACHE_HASH_NAME,
+								  VERSION_CACHE_SIZE,
+								  VERSION_CACHE_SIZE,
+								  &hash_info,
+								  HASH_ELEM | HASH_BLOBS);
+	LWLockRelease(AddinShmemInitLock);
+}
+
+void
+ts_version_cache_shmem_alloc(void)
+{
+	Size size = hash_estimate_size(VERSION_CACHE_SIZE, sizeof(VersionCacheEntry));
+
+	RequestAddinShmemSpace(add_size(size, sizeof(VersionCacheState)));
+	RequestNamedLWLockTranche(VERSION_CACHE_LWLOCK_TRANCHE_NAME, 1);
+}
+
+static void
+version_cache_key_init(VersionCacheKey *key, Oid dbid, const char *extname)
+{
+	memset(key, 0, sizeof(VersionCacheKey));
+	key->dbid = dbid;
+	namestrcpy(&key->extname, extname);
+}
+
+/*
+ * Look up the cached version of the extension in the database. On a miss,
+ * the current generation is returned so that the caller can store the
+ * version it reads from the catalog.
+ *
+ * The cache only exists when the loader is preloaded, otherwise this always
+ * misses.
+ */
+bool
+ts_version_cache_lookup(Oid dbid, const char *extname, char *version, uint64 *generation)
+{
+	VersionCacheKey key;
+	VersionCacheEntry *entry;
+
+	*generation = 0;
+
+	if (version_cache == NULL)
+		return false;
+
+	version_cache_key_init(&key, dbid, extname);
+
+	LWLockAcquire(version_cache_state->lock, LW_SHARED);
+	entry = hash_search(version_cache, &key, HASH_FIND, NULL);
+	if (entry != NULL)
+		strlcpy(version, entry->version, MAX_VERSION_LEN);
+	*generation = version_cache_state->generation;
+	LWLockRelease(version_cache_state->lock);
+
+	return entry != NULL;
+}
+
+void
+ts_version_cache_store(Oid dbid, const char *extname, const char *version, uint64 generation)
+{
+	VersionCacheKey key;
+	VersionCacheEntry *entry;
+	bool found;
+
+	if (version_cache == NULL || strlen(version) >= MAX_VERSION_LEN)
+		return;
+
+	version_cache_key_init(&key, dbid, extname);
+
+	LWLockAcquire(version_cache_state->lock, LW_EXCLUSIVE);
+
+	/* Something was invalidated after the caller read the catalog */
+	if (version_cache_state->generation != generation)
+	{
+		LWLockRelease(version_cache_state->lock);
+		return;
+	}
+
+	entry = hash_search(version_cache, &key, HASH_ENTER_NULL, &found);
+	if (entry != NULL)
+		strlcpy(entry->version, version, MAX_VERSION_LEN);
+	LWLockRelease(version_cache_state->lock);
+}
+
+/*
+ * Remove the cached versions for the database, or for all databases if dbid
+ * is invalid.
+ */
+void
+ts_version_cache_invalidate(Oid dbid)
+{
+	HASH_SEQ_STATUS status;
+	VersionCacheEntry *entry;
+
+	if (version_cache == NULL)
+		return;
+
+	LWLockAcquire(version_cache_state->lock, LW_EXCLUSIVE);
+	version_cache_state->generation++;
+
+	/* Removing the current element is allowed during a sequential scan */
+	hash_seq_init(&status, version_cache);
+	while ((entry = hash_seq_search(&status)) != NULL)
+	{
+		if (!OidIsValid(dbid) || entry->key.dbid == dbid)
+			hash_search(version_cache, &entry->key, HASH_REMOVE, NULL);
+	}
+	LWLockRelease(version_cache_state->lock);
+}
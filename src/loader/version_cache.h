@@ -0,0 +1,23 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+#ifndef TIMESCALEDB_LOADER_VERSION_CACHE_H
+#define TIMESCALEDB_LOADER_VERSION_CACHE_H
+
+#include <postgres.h>
+
+#define VERSION_CACHE_LWLOCK_TRANCHE_NAME "ts_version_cache_lwlock_tranche"
+
+extern void ts_version_cache_shmem_alloc(void);
+extern void ts_version_cache_shmem_startup(void);
+
+extern bool ts_version_cache_lookup(Oid dbid, const char *extname, char *version,
+									uint64 *generation);
+extern void ts_version_cache_store(Oid dbid, const char *extname, const char *version,
+								   uint64 generation);
+extern void ts_version_cache_invalidate(Oid dbid);
+
+#endif /* TIMESCALEDB_LOADER_VERSION_CACHE_H */
@@ -0,0 +1,41 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <fmgr.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+
+#include "loader/wait_stats.h"
+
+void
+ts_wait_stats_shmem_startup(void)
+{
+	TsWaitStats **rendezvous;
+	TsWaitStats *stats;
+	bool found;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	stats = ShmemInitStruct("timescaledb wait stats", sizeof(TsWaitStats), &found);
+	if (!found)
+	{
+		for (int i = 0; i < TS_WAIT_STATS_MAX_EVENTS; i++)
+		{
+			pg_atomic_init_u64(&stats->events[i].count, 0);
+			pg_atomic_init_u64(&stats->events[i].total_us, 0);
+			pg_atomic_init_u64(&stats->events[i].max_us, 0);
+		}
+	}
+	LWLockRelease(AddinShmemInitLock);
+
+	rendezvous = (TsWaitStats **) find_rendezvous_variable(RENDEZVOUS_WAIT_STATS);
+	*rendezvous = stats;
+}
+
+void
+ts_wait_stats_shmem_alloc(void)
+{
+	RequestAddinShmemSpace(sizeof(TsWaitStats));
+}
@@ -0,0 +1,37 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_LOADER_WAIT_STATS_H
+#define TIMESCALEDB_LOADER_WAIT_STATS_H
+
+#include <postgres.h>
+#include <port/atomics.h>
+
+#define RENDEZVOUS_WAIT_STATS "ts_wait_stats"
+
+/*
+ * The shared memory is allocated by the loader, so that it outlives the
+ * versioned extension libraries, and its layout has to stay the same across
+ * versions. New events can be added as long as they fit in the fixed number
+ * of slots; the versioned library owns the mapping of events to slots.
+ */
+#define TS_WAIT_STATS_MAX_EVENTS 32
+
+typedef struct TsWaitStatsEntry
+{
+	pg_atomic_uint64 count;
+	pg_atomic_uint64 total_us;
+	pg_atomic_uint64 max_us;
+} TsWaitStatsEntry;
+
+typedef struct TsWaitStats
+{
+	TsWaitStatsEntry events[TS_WAIT_STATS_MAX_EVENTS];
+} TsWaitStats;
+
+extern void ts_wait_stats_shmem_startup(void);
+extern void ts_wait_stats_shmem_alloc(void);
+
+#endif /* TIMESCALEDB_LOADER_WAIT_STATS_H */
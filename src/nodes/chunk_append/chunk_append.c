@@ -14,8 +14,10 @@
 
 #include "planner/planner.h"
 #include "nodes/chunk_append/chunk_append.h"
+#include "dimension.h"
 #include "func_cache.h"
 #include "guc.h"
+#include "ts_catalog/chunk_column_stats.h"
 
 static Var *find_equality_join_var(Var *sort_var, Index ht_relid, Oid eq_opr,
 								   List *join_conditions);
@@ -38,6 +40,68 @@ has_joins(FromExpr *jointree)
 	return list_length(jointree->fromlist) != 1 || !IsA(linitial(jointree->fromlist), RangeTblRef);
 }
 
+/*
+ * Check if the clause is an equality between the time column and an external
+ * parameter, like in the generic plan of a prepared point query.
+ */
+static bool
+is_param_equality_on_time(RestrictInfo *rinfo, Hypertable *ht, Index relid)
+{
+	const Dimension *dim = hyperspace_get_open_dimension(ht->space, 0);
+	OpExpr *op;
+	Node *left;
+	Node *right;
+	Var *var;
+	Param *param;
+
+	if (dim == NULL || !IsA(rinfo->clause, OpExpr))
+		return false;
+
+	op = castNode(OpExpr, rinfo->clause);
+	if (list_length(op->args) != 2)
+		return false;
+
+	left = strip_implicit_coercions(linitial(op->args));
+	right = strip_implicit_coercions(lsecond(op->args));
+
+	if (IsA(left, Var) && IsA(right, Param))
+	{
+		var = castNode(Var, left);
+		param = castNode(Param, right);
+	}
+	else if (IsA(left, Param) && IsA(right, Var))
+	{
+		var = castNode(Var, right);
+		param = castNode(Param, left);
+	}
+	else
+		return false;
+
+	return param->paramkind == PARAM_EXTERN && (Index) var->varno == relid &&
+		   var->varattno == dim->column_attno &&
+		   ts_is_equality_operator(op->opno, exprType(left), exprType(right));
+}
+
+/*
+ * The number of chunks in a single time slice, if all the space partitions
+ * have one.
+ */
+static int
+chunks_per_time_slice(Hypertable *ht)
+{
+	int chunks = 1;
+
+	for (int i = 0; i < ht->space->num_dimensions; i++)
+	{
+		const Dimension *dim = &ht->space->dimensions[i];
+
+		if (dim->type == DIMENSION_TYPE_CLOSED)
+			chunks *= Max(dim->fd.num_slices, 1);
+	}
+
+	return chunks;
+}
+
 /*
  * Create the appropriate subpath for the outer MergeAppend
  * node depending on the number of paths in the current group:
@@ -77,6 +141,8 @@ ts_chunk_append_path_create(PlannerInfo *root, RelOptInfo *rel, Hypertable *ht,
 	double rows = 0.0;
 	Cost total_cost = 0.0;
 	List *children = NIL;
+	bool param_equality_on_time = false;
+	int costed_children = 0;
 
 	path = (ChunkAppendPath *) newNode(sizeof(ChunkAppendPath), T_CustomPath);
 
@@ -140,6 +206,9 @@ ts_chunk_append_path_create(PlannerInfo *root, RelOptInfo *rel, Hypertable *ht,
 		if (contain_mutable_functions((Node *) rinfo->clause))
 			path->startup_exclusion = true;
 
+		if (is_param_equality_on_time(rinfo, ht, rel->relid))
+			param_equality_on_time = true;
+
 		if (ts_guc_enable_runtime_exclusion && ts_contain_param((Node *) rinfo->clause))
 		{
 			ListCell *lc_var;
@@ -159,7 +228,7 @@ ts_chunk_append_path_create(PlannerInfo *root, RelOptInfo *rel, Hypertable *ht,
 			 * the range of the chunk. It is more widely applicable than the parent
 			 * exclusion but is also more expensive to evaluate since you have to perform
 			 * the check on every chunk. Child exclusion can only apply if one of the quals
-			 * involves a partitioning column.
+			 * involves a partitioning column or a column with tracked chunk ranges.
 			 *
 			 */
 			path->runtime_exclusion_parent = true;
@@ -173,7 +242,9 @@ ts_chunk_append_path_create(PlannerInfo *root, RelOptInfo *rel, Hypertable *ht,
 				 * answer for those as well
 				 */
 				if ((Index) var->varno == rel->relid && var->varattno > 0 &&
-					ts_is_partitioning_column(ht, var->varattno))
+					(ts_is_partitioning_column(ht, var->varattno) ||
+					 (ts_guc_enable_chunk_skipping &&
+					  ts_chunk_column_stats_get_column(ht, var->varattno) >= 0)))
 				{
 					path->runtime_exclusion_children = true;
 					break;
@@ -403,6 +474,27 @@ ts_chunk_append_path_create(PlannerInfo *root, RelOptInfo *rel, Hypertable *ht,
 		{
 			total_cost += child->total_cost;
 			rows += child->rows;
+			costed_children++;
+		}
+	}
+
+	/*
+	 * In a generic plan, an equality on the time column with a parameter
+	 * leaves only the chunks of a single time slice after the runtime
+	 * exclusion. Only count those, otherwise the plan cache would always
+	 * prefer the custom plans, which only have these chunks, and replan
+	 * the query for every execution. With ordered append on a space
+	 * partitioned hypertable, each child already covers a time slice.
+	 */
+	if (param_equality_on_time && path->runtime_exclusion_children)
+	{
+		int expected_children =
+			(ordered && ht->space->num_dimensions > 1) ? 1 : chunks_per_time_slice(ht);
+
+		if (expected_children < costed_children)
+		{
+			total_cost = total_cost * expected_children / costed_children;
+			rows = clamp_row_est(rows * expected_children / costed_children);
 		}
 	}
 
@@ -4,6 +4,7 @@
  * LICENSE-APACHE for a copy of the license.
  */
 #include <postgres.h>
+#include <access/stratnum.h>
 #include <fmgr.h>
 #include <miscadmin.h>
 #include <catalog/pg_collation.h>
@@ -27,11 +28,30 @@
 #include <math.h>
 
 #include "nodes/chunk_append/chunk_append.h"
+#include "hypertable_stats.h"
 #include "loader/lwlocks.h"
+#include "nodes/node_timing.h"
+#include "planner/planner_stats.h"
+#include "relation_constraint_cache.h"
+#include "utils.h"
 
 #define INVALID_SUBPLAN_INDEX (-1)
 #define NO_MATCHING_SUBPLANS (-2)
 
+typedef enum ChunkAppendTimingPhase
+{
+	CHUNK_APPEND_TIMING_STARTUP_EXCLUSION = 0,
+	CHUNK_APPEND_TIMING_RUNTIME_EXCLUSION,
+	CHUNK_APPEND_TIMING_SUBPLAN_INIT,
+	_CHUNK_APPEND_TIMING_PHASES,
+} ChunkAppendTimingPhase;
+
+static const char *const chunk_append_timing_names[_CHUNK_APPEND_TIMING_PHASES] = {
+	[CHUNK_APPEND_TIMING_STARTUP_EXCLUSION] = "Startup Exclusion Time",
+	[CHUNK_APPEND_TIMING_RUNTIME_EXCLUSION] = "Runtime Exclusion Time",
+	[CHUNK_APPEND_TIMING_SUBPLAN_INIT] = "Subplan Initialization Time",
+};
+
 typedef enum SubplanState
 {
 	SUBPLAN_STATE_INCLUDED = 1 << 0, /* Used and not removed by startup exclusion */
@@ -49,6 +69,8 @@ typedef enum SubplanState
  *
  * The second index is the position of a subplan in filtered_subplans. This index is used to get/set
  * the flag SUBPLAN_STATE_FINISHED.
+ *
+ * next_plan is a position in the parallel_order of the subplans, see initialize_parallel_order().
  */
 typedef struct ParallelChunkAppendState
 {
@@ -70,12 +92,20 @@ typedef struct ChunkAppendState
 	int current;
 
 	Oid ht_reloid;
+	int32 hypertable_id;
 	bool startup_exclusion;
 	bool runtime_exclusion_parent;
 	bool runtime_exclusion_children;
 	bool runtime_initialized;
 	uint32 limit;
 
+	/*
+	 * Whether the subplans are initialized only when we start executing them.
+	 * This way, an ordered append under a LIMIT only opens the chunks it
+	 * actually reads, which are usually the first one or two.
+	 */
+	bool lazy_init;
+
 #ifdef USE_ASSERT_CHECKING
 	bool init_done;
 #endif
@@ -102,6 +132,32 @@ typedef struct ChunkAppendState
 	Bitmapset *valid_subplans;
 	Bitmapset *params;
 
+	/*
+	 * Runtime exclusion of the children on the time ranges of the chunks. We
+	 * compare the values of the comparisons of the time column with the
+	 * parameters with the ranges, which are sorted by their start, instead of
+	 * proving the chunk constraints for every chunk on every rescan. If there
+	 * are other clauses with parameters, the chunks in the matching ranges
+	 * still have their constraints checked. The startup exclusion uses the
+	 * comparisons that don't depend on PARAM_EXEC parameters, like the ones
+	 * with now() or the parameters of a prepared statement, to skip the
+	 * chunks outside the ranges before proving the constraints of the rest.
+	 */
+	List *range_strategies;
+	List *range_exprstates;
+	List *range_startup;
+	Oid range_type;
+	bool range_exclusion_complete;
+	/* list of time ranges indexed like initial_subplans */
+	List *initial_ranges;
+	/* list of time ranges after startup exclusion */
+	List *filtered_ranges;
+	/* subplan index, range start, range end and running maximum of range end */
+	int *range_subplans;
+	int64 *range_start;
+	int64 *range_end;
+	int64 *range_max_end;
+
 	/* sort options if this append is ordered, only used for EXPLAIN */
 	List *sort_options;
 
@@ -109,10 +165,13 @@ typedef struct ChunkAppendState
 	int runtime_number_loops;
 	int runtime_number_exclusions_parent;
 	int runtime_number_exclusions_children;
+	TsNodeTiming timing;
 
 	LWLock *lock;
 	ParallelContext *pcxt;
 	ParallelChunkAppendState *pstate;
+	/* the order in which the parallel workers pick the filtered subplans */
+	int *parallel_order;
 	EState *estate;
 	int eflags;
 	void (*choose_next_subplan)(struct ChunkAppendState *);
@@ -148,6 +207,8 @@ static void choose_next_subplan_for_worker(ChunkAppendState *state);
 static List *constify_restrictinfos(PlannerInfo *root, List *restrictinfos);
 static bool can_exclude_chunk(List *constraints, List *baserestrictinfo);
 static void do_startup_exclusion(ChunkAppendState *state);
+static bool get_range_exclusion_bounds(ChunkAppendState *state, bool startup, int64 *lower,
+									   int64 *upper);
 static Node *constify_param_mutator(Node *node, void *context);
 static List *constify_restrictinfo_params(PlannerInfo *root, EState *state, List *restrictinfos);
 
@@ -159,6 +220,7 @@ static void show_sortorder_options(StringInfo buf, Node *sortexpr, Oid sortOpera
 								   bool nullsFirst);
 
 static void perform_plan_init(ChunkAppendState *state, EState *estate, int eflags);
+static PlanState *get_subplan_state(ChunkAppendState *state, int subplan);
 
 Node *
 ts_chunk_append_state_create(CustomScan *cscan)
@@ -180,6 +242,17 @@ ts_chunk_append_state_create(CustomScan *cscan)
 	state->runtime_exclusion_children = (bool) lthird_int(settings);
 	state->limit = lfourth_int(settings);
 	state->first_partial_plan = lfirst_int(list_nth_cell(settings, 4));
+	state->range_exclusion_complete = (bool) lfirst_int(list_nth_cell(settings, 5));
+	state->hypertable_id = lfirst_int(list_nth_cell(settings, 6));
+
+	List *range_exclusion = lfirst(list_nth_cell(cscan->custom_private, 5));
+	if (range_exclusion != NIL)
+	{
+		state->range_strategies = linitial(range_exclusion);
+		state->initial_ranges = lthird(range_exclusion);
+		state->range_startup = lfourth(range_exclusion);
+	}
+	state->filtered_ranges = state->initial_ranges;
 
 	state->filtered_subplans = state->initial_subplans;
 	state->filtered_ri_clauses = state->initial_ri_clauses;
@@ -201,11 +274,16 @@ do_startup_exclusion(ChunkAppendState *state)
 	List *filtered_children = NIL;
 	List *filtered_ri_clauses = NIL;
 	List *filtered_constraints = NIL;
+	List *filtered_ranges = NIL;
 	ListCell *lc_plan;
 	ListCell *lc_clauses;
 	ListCell *lc_constraints;
 	int i = -1;
 	int filtered_first_partial_plan = state->first_partial_plan;
+	bool use_ranges = false;
+	bool ranges_empty = false;
+	int64 lower = PG_INT64_MIN;
+	int64 upper = PG_INT64_MAX;
 
 	/*
 	 * create skeleton plannerinfo for estimate_expression_value
@@ -226,6 +304,18 @@ do_startup_exclusion(ChunkAppendState *state)
 	Assert(list_length(state->initial_subplans) == list_length(state->initial_ri_clauses));
 	Assert(list_length(state->initial_subplans) == list_length(state->initial_constraints));
 
+	/*
+	 * Evaluate the comparisons of the time column once, so that we don't have
+	 * to constify the clauses and prove the constraints of the chunks outside
+	 * the resulting range.
+	 */
+	if (state->range_exprstates != NIL && list_member_int(state->range_startup, true))
+	{
+		Assert(list_length(state->initial_ranges) == list_length(state->initial_subplans));
+		use_ranges = true;
+		ranges_empty = !get_range_exclusion_bounds(state, true, &lower, &upper);
+	}
+
 	forthree (lc_plan,
 			  state->initial_subplans,
 			  lc_constraints,
@@ -246,6 +336,21 @@ do_startup_exclusion(ChunkAppendState *state)
 		 */
 		if (scan != NULL && scan->scanrelid)
 		{
+			if (use_ranges)
+			{
+				List *range = list_nth(state->initial_ranges, i);
+
+				if (ranges_empty ||
+					DatumGetInt64(linitial_node(Const, range)->constvalue) > upper ||
+					DatumGetInt64(lsecond_node(Const, range)->constvalue) <= lower)
+				{
+					if (i < state->first_partial_plan)
+						filtered_first_partial_plan--;
+
+					continue;
+				}
+			}
+
 			foreach (lc, ri_clauses)
 			{
 				RestrictInfo *ri = makeNode(RestrictInfo);
@@ -282,11 +387,14 @@ do_startup_exclusion(ChunkAppendState *state)
 		filtered_children = lappend(filtered_children, lfirst(lc_plan));
 		filtered_ri_clauses = lappend(filtered_ri_clauses, ri_clauses);
 		filtered_constraints = lappend(filtered_constraints, lfirst(lc_constraints));
+		if (state->initial_ranges != NIL)
+			filtered_ranges = lappend(filtered_ranges, list_nth(state->initial_ranges, i));
 	}
 
 	state->filtered_subplans = filtered_children;
 	state->filtered_ri_clauses = filtered_ri_clauses;
 	state->filtered_constraints = filtered_constraints;
+	state->filtered_ranges = filtered_ranges;
 	state->filtered_first_partial_plan = filtered_first_partial_plan;
 
 	Assert(list_length(state->filtered_subplans) ==
@@ -325,8 +433,30 @@ chunk_append_begin(CustomScanState *node, EState *estate, int eflags)
 	node->ss.ps.resultopsfixed = false;
 	ExecAssignScanProjectionInfoWithVarno(&node->ss, INDEX_VAR);
 
+	ts_node_timing_init(&state->timing,
+						estate,
+						chunk_append_timing_names,
+						_CHUNK_APPEND_TIMING_PHASES);
+
 	initialize_constraints(state, lthird(cscan->custom_private));
 
+	List *range_exclusion = lfirst(list_nth_cell(cscan->custom_private, 5));
+	if (range_exclusion != NIL)
+	{
+		ListCell *lc;
+
+		foreach (lc, lsecond(range_exclusion))
+		{
+			Expr *expr = lfirst(lc);
+
+			/* The expressions didn't go through setrefs, so fix the operators. */
+			fix_opfuncids((Node *) expr);
+			state->range_type = exprType((Node *) expr);
+			state->range_exprstates =
+				lappend(state->range_exprstates, ExecInitExpr(expr, &node->ss.ps));
+		}
+	}
+
 	/* In parallel mode with a parallel_aware plan, the parallel leader performs the startup
 	 * exclusion and stores the result in shared memory (the flag SUBPLAN_STATE_INCLUDED of
 	 * pstate->subplan_state is set for all included plans).
@@ -361,18 +491,84 @@ chunk_append_begin(CustomScanState *node, EState *estate, int eflags)
 	}
 
 	if (state->startup_exclusion)
+	{
+		instr_time start;
+		instr_time timing_start;
+
+		ts_planner_stats_start(&start);
+		ts_node_timing_start(&state->timing, &timing_start);
 		do_startup_exclusion(state);
+		ts_node_timing_stop(&state->timing, CHUNK_APPEND_TIMING_STARTUP_EXCLUSION, &timing_start);
+		ts_planner_stats_add(PLANNER_STATS_STARTUP_EXCLUSION,
+							 &start,
+							 list_length(state->initial_subplans));
+	}
 
 	perform_plan_init(state, estate, eflags);
 }
 
+typedef struct SubplanCost
+{
+	int subplan;
+	Cost cost;
+} SubplanCost;
+
+static int
+subplan_cost_cmp(const void *a, const void *b)
+{
+	const SubplanCost *cost_a = (const SubplanCost *) a;
+	const SubplanCost *cost_b = (const SubplanCost *) b;
+
+	/* Most expensive first, and keep the plan order for equal costs. */
+	if (cost_a->cost != cost_b->cost)
+		return cost_a->cost > cost_b->cost ? -1 : 1;
+
+	return cost_a->subplan - cost_b->subplan;
+}
+
+/*
+ * Order the subplans for the parallel workers by decreasing cost, so that the
+ * most expensive ones are started first instead of becoming the tail of the
+ * parallel scan. The non-partial plans stay ahead of the partial ones, so
+ * that each of them gets its own worker, and the remaining workers then share
+ * the partial plans. The leader and the workers have the same subplans, so
+ * they compute the same order.
+ */
+static void
+initialize_parallel_order(ChunkAppendState *state)
+{
+	const int num_subplans = state->num_subplans;
+	const int first_partial = Min(Max(state->filtered_first_partial_plan, 0), num_subplans);
+	SubplanCost *costs = palloc(sizeof(SubplanCost) * num_subplans);
+	ListCell *lc;
+	int i = 0;
+
+	foreach (lc, state->filtered_subplans)
+	{
+		costs[i].subplan = i;
+		costs[i].cost = ((Plan *) lfirst(lc))->total_cost;
+		i++;
+	}
+
+	qsort(costs, first_partial, sizeof(SubplanCost), subplan_cost_cmp);
+	qsort(costs + first_partial,
+		  num_subplans - first_partial,
+		  sizeof(SubplanCost),
+		  subplan_cost_cmp);
+
+	state->parallel_order = palloc(sizeof(int) * num_subplans);
+	for (i = 0; i < num_subplans; i++)
+		state->parallel_order[i] = costs[i].subplan;
+
+	pfree(costs);
+}
+
 /*
  * Perform an initialization of the filtered_subplans.
  */
 static void
 perform_plan_init(ChunkAppendState *state, EState *estate, int eflags)
 {
-	ListCell *lc;
 	int i;
 
 #ifdef USE_ASSERT_CHECKING
@@ -389,34 +585,75 @@ perform_plan_init(ChunkAppendState *state, EState *estate, int eflags)
 	}
 
 	state->subplanstates = palloc0(state->num_subplans * sizeof(PlanState *));
+	state->estate = estate;
+	state->eflags = eflags;
 
-	i = 0;
-	foreach (lc, state->filtered_subplans)
+	/*
+	 * EXPLAIN needs the states of all the subplans, and the parallel workers
+	 * can pick any of them, so we only defer the initialization for the
+	 * plain serial execution.
+	 */
+	state->lazy_init = !(eflags & EXEC_FLAG_EXPLAIN_ONLY) && estate->es_instrument == 0 &&
+					   !state->csstate.ss.ps.plan->parallel_aware;
+
+	if (!state->lazy_init)
+	{
+		for (i = 0; i < state->num_subplans; i++)
+			get_subplan_state(state, i);
+	}
+
+	if (state->csstate.ss.ps.plan->parallel_aware)
+		initialize_parallel_order(state);
+
+	if (state->runtime_exclusion_parent || state->runtime_exclusion_children)
+	{
+		Plan *first_plan = linitial(state->filtered_subplans);
+
+		state->params = first_plan->allParam;
+		/*
+		 * make sure all params are initialized for runtime exclusion
+		 */
+		state->csstate.ss.ps.chgParam = bms_copy(first_plan->allParam);
+	}
+}
+
+/*
+ * Get the state of the given subplan, initializing it on first use.
+ */
+static PlanState *
+get_subplan_state(ChunkAppendState *state, int subplan)
+{
+	if (state->subplanstates[subplan] == NULL)
 	{
+		/*
+		 * We can be called in a short-lived context when we are under a
+		 * subplan, so make sure the state lives as long as the query.
+		 */
+		MemoryContext old = MemoryContextSwitchTo(state->estate->es_query_cxt);
+		instr_time start;
+
+		ts_node_timing_start(&state->timing, &start);
+		PlanState *ps =
+			ExecInitNode(list_nth(state->filtered_subplans, subplan), state->estate, state->eflags);
+		ts_node_timing_stop(&state->timing, CHUNK_APPEND_TIMING_SUBPLAN_INIT, &start);
+
 		/*
 		 * we use an array for the states but put it in custom_ps as well
 		 * so explain and planstate_tree_walker can find it
 		 */
-		state->subplanstates[i] = ExecInitNode(lfirst(lc), estate, eflags);
-		state->csstate.custom_ps = lappend(state->csstate.custom_ps, state->subplanstates[i]);
+		state->subplanstates[subplan] = ps;
+		state->csstate.custom_ps = lappend(state->csstate.custom_ps, ps);
 
 		/*
 		 * pass down limit to child nodes
 		 */
 		if (state->limit)
-			ExecSetTupleBound(state->limit, state->subplanstates[i]);
+			ExecSetTupleBound(state->limit, ps);
 
-		i++;
+		MemoryContextSwitchTo(old);
 	}
 
-	if (state->runtime_exclusion_parent || state->runtime_exclusion_children)
-	{
-		state->params = state->subplanstates[0]->plan->allParam;
-		/*
-		 * make sure all params are initialized for runtime exclusion
-		 */
-		state->csstate.ss.ps.chgParam = bms_copy(state->subplanstates[0]->plan->allParam);
-	}
+	return state->subplanstates[subplan];
 }
 
 static bool
@@ -443,6 +680,209 @@ can_exclude_constraints_using_clauses(ChunkAppendState *state, List *constraints
 	return can_exclude;
 }
 
+static int
+range_start_cmp(const void *a, const void *b, void *arg)
+{
+	const int64 *range_start = (const int64 *) arg;
+	const int64 start_a = range_start[*(const int *) a];
+	const int64 start_b = range_start[*(const int *) b];
+
+	return (start_a > start_b) - (start_a < start_b);
+}
+
+/*
+ * Sort the time ranges of the subplans by their start for the binary search.
+ */
+static void
+initialize_runtime_ranges(ChunkAppendState *state)
+{
+	MemoryContext old = MemoryContextSwitchTo(state->csstate.ss.ps.state->es_query_cxt);
+	const int n = state->num_subplans;
+	int64 *start = palloc(sizeof(int64) * n);
+	int64 *end = palloc(sizeof(int64) * n);
+	ListCell *lc;
+	int i = 0;
+
+	Assert(list_length(state->filtered_ranges) == n);
+
+	state->range_subplans = palloc(sizeof(int) * n);
+	state->range_start = palloc(sizeof(int64) * n);
+	state->range_end = palloc(sizeof(int64) * n);
+	state->range_max_end = palloc(sizeof(int64) * n);
+
+	foreach (lc, state->filtered_ranges)
+	{
+		List *range = lfirst(lc);
+
+		start[i] = DatumGetInt64(linitial_node(Const, range)->constvalue);
+		end[i] = DatumGetInt64(lsecond_node(Const, range)->constvalue);
+		state->range_subplans[i] = i;
+		i++;
+	}
+
+	qsort_arg(state->range_subplans, n, sizeof(int), range_start_cmp, start);
+
+	for (i = 0; i < n; i++)
+	{
+		state->range_start[i] = start[state->range_subplans[i]];
+		state->range_end[i] = end[state->range_subplans[i]];
+		state->range_max_end[i] = state->range_end[i];
+		if (i > 0)
+			state->range_max_end[i] = Max(state->range_max_end[i], state->range_max_end[i - 1]);
+	}
+
+	pfree(start);
+	pfree(end);
+	MemoryContextSwitchTo(old);
+}
+
+/*
+ * Find the first position in the sorted values that is greater than the given
+ * value.
+ */
+static int
+int64_upper_bound(const int64 *values, int n, int64 value)
+{
+	int low = 0;
+	int high = n;
+
+	while (low < high)
+	{
+		const int mid = low + (high - low) / 2;
+
+		if (values[mid] <= value)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/*
+ * Evaluate the comparisons of the time column for the exclusion on the time
+ * ranges of the chunks. The values restrict the time to the inclusive range
+ * [lower, upper]. For the startup exclusion, we only use the comparisons that
+ * don't depend on PARAM_EXEC parameters. Returns false if no rows can match.
+ */
+static bool
+get_range_exclusion_bounds(ChunkAppendState *state, bool startup, int64 *lower, int64 *upper)
+{
+	ExprContext *econtext = state->csstate.ss.ps.ps_ExprContext;
+	ListCell *lc_strategy;
+	ListCell *lc_expr;
+	ListCell *lc_startup;
+
+	*lower = PG_INT64_MIN;
+	*upper = PG_INT64_MAX;
+
+	forthree (lc_strategy,
+			  state->range_strategies,
+			  lc_expr,
+			  state->range_exprstates,
+			  lc_startup,
+			  state->range_startup)
+	{
+		bool isnull;
+		Datum datum;
+		int64 value;
+
+		if (startup && !lfirst_int(lc_startup))
+			continue;
+
+		datum = ExecEvalExprSwitchContext(lfirst(lc_expr), econtext, &isnull);
+
+		/* A comparison with NULL doesn't match any rows. */
+		if (isnull)
+			return false;
+
+		value = ts_time_value_to_internal_or_infinite(datum, state->range_type, NULL);
+
+		switch (lfirst_int(lc_strategy))
+		{
+			case BTLessStrategyNumber:
+				if (value == PG_INT64_MIN)
+					return false;
+				*upper = Min(*upper, value - 1);
+				break;
+			case BTLessEqualStrategyNumber:
+				*upper = Min(*upper, value);
+				break;
+			case BTEqualStrategyNumber:
+				*lower = Max(*lower, value);
+				*upper = Min(*upper, value);
+				break;
+			case BTGreaterEqualStrategyNumber:
+				*lower = Max(*lower, value);
+				break;
+			case BTGreaterStrategyNumber:
+				if (value == PG_INT64_MAX)
+					return false;
+				*lower = Max(*lower, value + 1);
+				break;
+			default:
+				Assert(false);
+				break;
+		}
+	}
+
+	if (*lower > *upper)
+		return false;
+
+	/*
+	 * The last slice ends at the maximum value, which means it also contains
+	 * the maximum value, see REMAP_LAST_COORDINATE.
+	 */
+	if (*lower == PG_INT64_MAX)
+		*lower = PG_INT64_MAX - 1;
+
+	return true;
+}
+
+/*
+ * Build the bitmap of valid subplans from the time ranges of the chunks. The
+ * parameter values restrict the time to the inclusive range [lower, upper],
+ * and the chunk ranges are [start, end).
+ */
+static void
+initialize_runtime_range_exclusion(ChunkAppendState *state, PlannerInfo *root)
+{
+	int64 lower;
+	int64 upper;
+
+	if (state->range_subplans == NULL)
+		initialize_runtime_ranges(state);
+
+	if (get_range_exclusion_bounds(state, false, &lower, &upper))
+	{
+		const int n = state->num_subplans;
+		const int first = int64_upper_bound(state->range_max_end, n, lower);
+		const int last = int64_upper_bound(state->range_start, n, upper);
+
+		for (int k = first; k < last; k++)
+		{
+			const int subplan = state->range_subplans[k];
+
+			if (state->range_end[k] <= lower)
+				continue;
+
+			if (!state->range_exclusion_complete &&
+				can_exclude_constraints_using_clauses(state,
+													  list_nth(state->filtered_constraints,
+															   subplan),
+													  list_nth(state->filtered_ri_clauses, subplan),
+													  root,
+													  &state->csstate.ss.ps))
+				continue;
+
+			state->valid_subplans = bms_add_member(state->valid_subplans, subplan);
+		}
+	}
+
+	state->runtime_number_exclusions_children +=
+		state->num_subplans - bms_num_members(state->valid_subplans);
+}
+
 /*
  * build bitmap of valid subplans for runtime exclusion
  */
@@ -495,6 +935,12 @@ initialize_runtime_exclusion(ChunkAppendState *state)
 		return;
 	}
 
+	if (state->range_exprstates != NIL)
+	{
+		initialize_runtime_range_exclusion(state, &root);
+		return;
+	}
+
 	Assert(state->num_subplans == list_length(state->filtered_ri_clauses));
 
 	lc_clauses = list_head(state->filtered_ri_clauses);
@@ -505,8 +951,7 @@ initialize_runtime_exclusion(ChunkAppendState *state)
 	 */
 	for (i = 0; i < state->num_subplans; i++)
 	{
-		PlanState *ps = state->subplanstates[i];
-		Scan *scan = ts_chunk_append_get_scan_plan(ps->plan);
+		Scan *scan = ts_chunk_append_get_scan_plan(list_nth(state->filtered_subplans, i));
 
 		if (scan == NULL || scan->scanrelid == 0)
 		{
@@ -518,7 +963,7 @@ initialize_runtime_exclusion(ChunkAppendState *state)
 																	 lfirst(lc_constraints),
 																	 lfirst(lc_clauses),
 																	 &root,
-																	 ps);
+																	 &state->csstate.ss.ps);
 
 			if (!can_exclude)
 				state->valid_subplans = bms_add_member(state->valid_subplans, i);
@@ -531,6 +976,16 @@ initialize_runtime_exclusion(ChunkAppendState *state)
 	}
 }
 
+static void
+timed_runtime_exclusion(ChunkAppendState *state)
+{
+	instr_time start;
+
+	ts_node_timing_start(&state->timing, &start);
+	initialize_runtime_exclusion(state);
+	ts_node_timing_stop(&state->timing, CHUNK_APPEND_TIMING_RUNTIME_EXCLUSION, &start);
+}
+
 /*
  * Fetch the next scan tuple.
  *
@@ -561,7 +1016,7 @@ chunk_append_exec(CustomScanState *node)
 			return ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
 
 		Assert(state->current >= 0 && state->current < state->num_subplans);
-		subnode = state->subplanstates[state->current];
+		subnode = get_subplan_state(state, state->current);
 
 		/*
 		 * get a tuple from the subplan
@@ -598,7 +1053,7 @@ get_next_subplan(ChunkAppendState *state, int last_plan)
 	if (state->runtime_exclusion_parent || state->runtime_exclusion_children)
 	{
 		if (!state->runtime_initialized)
-			initialize_runtime_exclusion(state);
+			timed_runtime_exclusion(state);
 
 		/*
 		 * bms_next_member will return -2 (NO_MATCHING_SUBPLANS) if there are
@@ -623,13 +1078,42 @@ choose_next_subplan_non_parallel(ChunkAppendState *state)
 	state->current = get_next_subplan(state, state->current);
 }
 
+/*
+ * Get the next position in the parallel order of the subplans that is not
+ * excluded at runtime.
+ */
+static int
+get_next_parallel_position(ChunkAppendState *state, int last_position)
+{
+	const bool runtime_exclusion =
+		state->runtime_exclusion_parent || state->runtime_exclusion_children;
+
+	if (last_position == NO_MATCHING_SUBPLANS)
+		return NO_MATCHING_SUBPLANS;
+
+	if (runtime_exclusion && !state->runtime_initialized)
+		timed_runtime_exclusion(state);
+
+	for (int position = last_position + 1; position < state->num_subplans; position++)
+	{
+		if (!runtime_exclusion ||
+			bms_is_member(state->parallel_order[position], state->valid_subplans))
+			return position;
+	}
+
+	return NO_MATCHING_SUBPLANS;
+}
+
 static void
 choose_next_subplan_for_worker(ChunkAppendState *state)
 {
 	ParallelChunkAppendState *pstate = state->pstate;
+	int next_position;
 	int next_plan;
 	int start;
 
+	Assert(state->parallel_order != NULL);
+
 	LWLockAcquire(state->lock, LW_EXCLUSIVE);
 
 	/* mark just completed subplan as finished */
@@ -638,11 +1122,11 @@ choose_next_subplan_for_worker(ChunkAppendState *state)
 			ts_set_flags_32(pstate->subplan_state[state->current], SUBPLAN_STATE_FINISHED);
 
 	if (pstate->next_plan == INVALID_SUBPLAN_INDEX)
-		next_plan = get_next_subplan(state, INVALID_SUBPLAN_INDEX);
+		next_position = get_next_parallel_position(state, INVALID_SUBPLAN_INDEX);
 	else
-		next_plan = pstate->next_plan;
+		next_position = pstate->next_plan;
 
-	if (next_plan == NO_MATCHING_SUBPLANS)
+	if (next_position == NO_MATCHING_SUBPLANS)
 	{
 		/* all subplans are finished */
 		pstate->next_plan = NO_MATCHING_SUBPLANS;
@@ -651,29 +1135,30 @@ choose_next_subplan_for_worker(ChunkAppendState *state)
 		return;
 	}
 
-	start = next_plan;
+	start = next_position;
 
 	/* skip finished subplans */
-	while (ts_flags_are_set_32(pstate->subplan_state[next_plan], SUBPLAN_STATE_FINISHED))
+	while (ts_flags_are_set_32(pstate->subplan_state[state->parallel_order[next_position]],
+							   SUBPLAN_STATE_FINISHED))
 	{
-		next_plan = get_next_subplan(state, next_plan);
+		next_position = get_next_parallel_position(state, next_position);
 
 		/* wrap around if we reach end of subplan list */
-		if (next_plan < 0)
-			next_plan = get_next_subplan(state, INVALID_SUBPLAN_INDEX);
+		if (next_position < 0)
+			next_position = get_next_parallel_position(state, INVALID_SUBPLAN_INDEX);
 
-		if (next_plan == start || next_plan < 0)
+		if (next_position == start || next_position < 0)
 		{
 			/*
 			 * back at start of search so all subplans are finished
 			 *
-			 * next_plan should not be < 0 because this means there
+			 * next_position should not be < 0 because this means there
 			 * are no valid subplans and then the function would
 			 * have returned at the check before the while loop but
 			 * static analysis marked this so might as well include
 			 * that in the check
 			 */
-			Assert(next_plan >= 0);
+			Assert(next_position >= 0);
 			pstate->next_plan = NO_MATCHING_SUBPLANS;
 			state->current = NO_MATCHING_SUBPLANS;
 			LWLockRelease(state->lock);
@@ -681,6 +1166,7 @@ choose_next_subplan_for_worker(ChunkAppendState *state)
 		}
 	}
 
+	next_plan = state->parallel_order[next_position];
 	Assert(next_plan >= 0 && next_plan < state->num_subplans);
 	state->current = next_plan;
 
@@ -693,7 +1179,7 @@ choose_next_subplan_for_worker(ChunkAppendState *state)
 			ts_set_flags_32(pstate->subplan_state[next_plan], SUBPLAN_STATE_FINISHED);
 
 	/* advance next_plan for next worker */
-	pstate->next_plan = get_next_subplan(state, state->current);
+	pstate->next_plan = get_next_parallel_position(state, next_position);
 	/*
 	 * if we reach the end of the list of subplans we set next_plan
 	 * to INVALID_SUBPLAN_INDEX to allow rechecking unfinished subplans
@@ -721,6 +1207,16 @@ chunk_append_end(CustomScanState *node)
 	{
 		ExecEndNode(state->subplanstates[i]);
 	}
+
+	/* The parallel workers do the same startup exclusion as the leader */
+	if (state->startup_exclusion && !IsParallelWorker())
+		ts_hypertable_stats_add(state->hypertable_id,
+								HYPERTABLE_STATS_CHUNKS_EXCLUDED_STARTUP,
+								list_length(state->initial_subplans) -
+									list_length(state->filtered_subplans));
+	ts_hypertable_stats_add(state->hypertable_id,
+							HYPERTABLE_STATS_CHUNKS_EXCLUDED_RUNTIME,
+							state->runtime_number_exclusions_children);
 }
 
 /*
@@ -734,6 +1230,10 @@ chunk_append_rescan(CustomScanState *node)
 
 	for (i = 0; i < state->num_subplans; i++)
 	{
+		/* The subplans we haven't initialized yet don't need a rescan. */
+		if (state->subplanstates[i] == NULL)
+			continue;
+
 		if (node->ss.ps.chgParam != NULL)
 			UpdateChangedParamSet(state->subplanstates[i], node->ss.ps.chgParam);
 
@@ -866,6 +1366,7 @@ chunk_append_initialize_worker(CustomScanState *node, shm_toc *toc, void *coordi
 	List *filtered_subplans = NIL;
 	List *filtered_ri_clauses = NIL;
 	List *filtered_constraints = NIL;
+	List *filtered_ranges = NIL;
 
 	for (int plan = 0; plan < list_length(state->initial_subplans); plan++)
 	{
@@ -877,12 +1378,16 @@ chunk_append_initialize_worker(CustomScanState *node, shm_toc *toc, void *coordi
 				lappend(filtered_ri_clauses, list_nth(state->filtered_ri_clauses, plan));
 			filtered_constraints =
 				lappend(filtered_constraints, list_nth(state->filtered_constraints, plan));
+			if (state->filtered_ranges != NIL)
+				filtered_ranges =
+					lappend(filtered_ranges, list_nth(state->filtered_ranges, plan));
 		}
 	}
 
 	state->filtered_subplans = filtered_subplans;
 	state->filtered_ri_clauses = filtered_ri_clauses;
 	state->filtered_constraints = filtered_constraints;
+	state->filtered_ranges = filtered_ranges;
 
 	Assert(list_length(state->filtered_subplans) == list_length(state->filtered_ri_clauses));
 	Assert(list_length(state->filtered_ri_clauses) == list_length(state->filtered_constraints));
@@ -998,92 +1503,25 @@ constify_param_mutator(Node *node, void *context)
 }
 
 /*
- * stripped down version of postgres get_relation_constraints
+ * stripped down version of postgres get_relation_constraints, the constraint
+ * expressions are cached across executions, see relation_constraint_cache.c
  */
 static List *
-ca_get_relation_constraints(Oid relationObjectId, Index varno, bool include_notnull)
+ca_get_relation_constraints(Oid relationObjectId, Index varno)
 {
-	List *result = NIL;
+	List *result;
 	Relation relation;
-	TupleConstr *constr;
 
 	/*
 	 * We assume the relation has already been safely locked.
 	 */
 	relation = table_open(relationObjectId, AccessShareLock);
 
-	constr = relation->rd_att->constr;
-	if (constr != NULL)
-	{
-		int num_check = constr->num_check;
-		int i;
-
-		for (i = 0; i < num_check; i++)
-		{
-			Node *cexpr;
-
-			/*
-			 * If this constraint hasn't been fully validated yet, we must
-			 * ignore it here.
-			 */
-			if (!constr->check[i].ccvalid)
-				continue;
-
-			cexpr = stringToNode(constr->check[i].ccbin);
+	result = ts_relation_constraint_cache_get(relation);
 
-			/*
-			 * Run each expression through const-simplification and
-			 * canonicalization.  This is not just an optimization, but is
-			 * necessary, because we will be comparing it to
-			 * similarly-processed qual clauses, and may fail to detect valid
-			 * matches without this.  This must match the processing done to
-			 * qual clauses in preprocess_expression()!  (We can skip the
-			 * stuff involving subqueries, however, since we don't allow any
-			 * in check constraints.)
-			 */
-			cexpr = eval_const_expressions(NULL, cexpr);
-			cexpr = (Node *) canonicalize_qual((Expr *) cexpr, true);
-
-			/* Fix Vars to have the desired varno */
-			if (varno != 1)
-				ChangeVarNodes(cexpr, 1, varno, 0);
-
-			/*
-			 * Finally, convert to implicit-AND format (that is, a List) and
-			 * append the resulting item(s) to our output list.
-			 */
-			result = list_concat(result, make_ands_implicit((Expr *) cexpr));
-		}
-
-		/* Add NOT NULL constraints in expression form, if requested */
-		if (include_notnull && constr->has_not_null)
-		{
-			int natts = relation->rd_att->natts;
-
-			for (i = 1; i <= natts; i++)
-			{
-				Form_pg_attribute att = TupleDescAttr(relation->rd_att, i - 1);
-
-				if (att->attnotnull && !att->attisdropped)
-				{
-					NullTest *ntest = makeNode(NullTest);
-
-					ntest->arg = (Expr *)
-						makeVar(varno, i, att->atttypid, att->atttypmod, att->attcollation, 0);
-					ntest->nulltesttype = IS_NOT_NULL;
-
-					/*
-					 * argisrow=false is correct even for a composite column,
-					 * because attnotnull does not represent a SQL-spec IS NOT
-					 * NULL test in such a case, just IS DISTINCT FROM NULL.
-					 */
-					ntest->argisrow = false;
-					ntest->location = -1;
-					result = lappend(result, ntest);
-				}
-			}
-		}
-	}
+	/* Fix Vars to have the desired varno */
+	if (varno != 1)
+		ChangeVarNodes((Node *) result, 1, varno, 0);
 
 	table_close(relation, NoLock);
 
@@ -1173,7 +1611,7 @@ initialize_constraints(ChunkAppendState *state, List *initial_rt_indexes)
 		{
 			Index rt_index = scan->scanrelid;
 			RangeTblEntry *rte = rt_fetch(rt_index, estate->es_range_table);
-			relation_constraints = ca_get_relation_constraints(rte->relid, rt_index, true);
+			relation_constraints = ca_get_relation_constraints(rte->relid, rt_index);
 
 			/*
 			 * Adjust the RangeTableEntry indexes in the restrictinfo
@@ -1215,7 +1653,8 @@ chunk_append_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 	if (state->startup_exclusion)
 		ExplainPropertyInteger("Chunks excluded during startup",
 							   NULL,
-							   list_length(state->initial_subplans) - list_length(node->custom_ps),
+							   list_length(state->initial_subplans) -
+								   list_length(state->filtered_subplans),
 							   es);
 
 	if (state->runtime_exclusion_parent && state->runtime_number_loops > 0)
@@ -1229,6 +1668,8 @@ chunk_append_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 		int avg_excluded = state->runtime_number_exclusions_children / state->runtime_number_loops;
 		ExplainPropertyInteger("Chunks excluded during runtime", NULL, avg_excluded, es);
 	}
+
+	ts_node_timing_explain(&state->timing, es);
 }
 
 /*
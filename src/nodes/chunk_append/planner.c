@@ -5,6 +5,8 @@
  */
 
 #include <postgres.h>
+#include <access/stratnum.h>
+#include <catalog/pg_class.h>
 #include <catalog/pg_namespace.h>
 #include <nodes/extensible.h>
 #include <nodes/makefuncs.h>
@@ -19,12 +21,17 @@
 #include <optimizer/subselect.h>
 #include <optimizer/tlist.h>
 #include <parser/parsetree.h>
+#include <utils/lsyscache.h>
+#include <utils/typcache.h>
 
 #include "nodes/chunk_append/chunk_append.h"
 #include "nodes/chunk_append/transform.h"
 #include "nodes/hypertable_modify.h"
 #include "import/planner.h"
+#include "dimension.h"
 #include "guc.h"
+#include "hypercube.h"
+#include "planner/planner.h"
 
 static Sort *make_sort(Plan *lefttree, int numCols, AttrNumber *sortColIdx, Oid *sortOperators,
 					   Oid *collations, bool *nullsFirst);
@@ -96,6 +103,181 @@ adjust_childscan(PlannerInfo *root, Plan *plan, Path *path, List *pathkeys, List
 	return plan;
 }
 
+static bool
+contain_exec_param_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Param))
+		return castNode(Param, node)->paramkind == PARAM_EXEC;
+
+	return expression_tree_walker(node, contain_exec_param_walker, context);
+}
+
+/*
+ * Check if the clause compares the time column with an expression that only
+ * depends on parameters and stable functions, and get the strategy of the
+ * comparison with the time column on the left.
+ */
+static bool
+get_time_param_comparison(Expr *clause, Index relid, AttrNumber time_attno, Oid time_type,
+						  Oid opfamily, StrategyNumber *strategy, Expr **expr)
+{
+	OpExpr *op;
+	Expr *left;
+	Expr *right;
+	Expr *other;
+	bool var_on_left;
+	StrategyNumber op_strategy;
+
+	if (!IsA(clause, OpExpr))
+		return false;
+
+	op = castNode(OpExpr, clause);
+	if (list_length(op->args) != 2)
+		return false;
+
+	left = linitial(op->args);
+	right = lsecond(op->args);
+
+	if (IsA(left, Var) && (Index) castNode(Var, left)->varno == relid &&
+		castNode(Var, left)->varattno == time_attno && castNode(Var, left)->varlevelsup == 0)
+	{
+		other = right;
+		var_on_left = true;
+	}
+	else if (IsA(right, Var) && (Index) castNode(Var, right)->varno == relid &&
+			 castNode(Var, right)->varattno == time_attno && castNode(Var, right)->varlevelsup == 0)
+	{
+		other = left;
+		var_on_left = false;
+	}
+	else
+		return false;
+
+	if (exprType((Node *) other) != time_type || contain_var_clause((Node *) other) ||
+		contain_volatile_functions((Node *) other) || contain_subplans((Node *) other))
+		return false;
+
+	op_strategy = get_op_opfamily_strategy(op->opno, opfamily);
+	if (op_strategy == InvalidStrategy)
+		return false;
+
+	*strategy = var_on_left ? op_strategy : BTCommuteStrategyNumber(op_strategy);
+	*expr = other;
+	return true;
+}
+
+/*
+ * Get the information for the exclusion of the children on the time ranges of
+ * the chunks: the strategies of the comparisons of the time column with the
+ * parameters or stable expressions like now(), the compared expressions, the
+ * range of each child in the time dimension, and whether each expression can
+ * be evaluated at executor startup, that is, has no PARAM_EXEC parameters.
+ * Returns NIL if some child is not a plain chunk scan or there are no such
+ * comparisons. The complete flag tells whether these are all the clauses with
+ * parameters, so that the executor doesn't have to check the chunk
+ * constraints on rescan.
+ */
+static List *
+get_runtime_range_exclusion(PlannerInfo *root, RelOptInfo *rel, List *clauses, List *custom_plans,
+							bool *complete)
+{
+	RangeTblEntry *rte = planner_rt_fetch(rel->relid, root);
+	Hypertable *ht = ts_planner_get_hypertable(rte->relid, CACHE_FLAG_CHECK);
+	const Dimension *dim;
+	TypeCacheEntry *tce;
+	List *strategies = NIL;
+	List *exprs = NIL;
+	List *ranges = NIL;
+	List *startup = NIL;
+	ListCell *lc;
+
+	*complete = true;
+
+	if (ht == NULL)
+		return NIL;
+
+	dim = hyperspace_get_open_dimension(ht->space, 0);
+
+	/* The clauses are on the column, not on the partitioning function. */
+	if (dim == NULL || dim->partitioning != NULL)
+		return NIL;
+
+	tce = lookup_type_cache(dim->fd.column_type, TYPECACHE_BTREE_OPFAMILY);
+	if (!OidIsValid(tce->btree_opf))
+		return NIL;
+
+	foreach (lc, clauses)
+	{
+		Expr *clause = castNode(RestrictInfo, lfirst(lc))->clause;
+		const bool has_param = ts_contain_param((Node *) clause);
+		StrategyNumber strategy;
+		Expr *expr;
+
+		if (!has_param && !contain_mutable_functions((Node *) clause))
+			continue;
+
+		if (get_time_param_comparison(clause,
+									  rel->relid,
+									  dim->column_attno,
+									  dim->fd.column_type,
+									  tce->btree_opf,
+									  &strategy,
+									  &expr))
+		{
+			strategies = lappend_int(strategies, strategy);
+			exprs = lappend(exprs, expr);
+			startup = lappend_int(startup, !contain_exec_param_walker((Node *) expr, NULL));
+		}
+		else if (has_param)
+			*complete = false;
+	}
+
+	if (strategies == NIL)
+		return NIL;
+
+	foreach (lc, custom_plans)
+	{
+		Scan *scan = ts_chunk_append_get_scan_plan(lfirst(lc));
+		RelOptInfo *chunk_rel;
+		TimescaleDBPrivate *priv;
+		const DimensionSlice *slice;
+
+		if (scan == NULL || scan->scanrelid == 0 ||
+			planner_rt_fetch(scan->scanrelid, root)->relkind != RELKIND_RELATION)
+			return NIL;
+
+		chunk_rel = root->simple_rel_array[scan->scanrelid];
+		priv = chunk_rel != NULL ? chunk_rel->fdw_private : NULL;
+		if (priv == NULL || priv->cached_chunk_struct == NULL)
+			return NIL;
+
+		slice = ts_hypercube_get_slice_by_dimension_id(priv->cached_chunk_struct->cube, dim->fd.id);
+		if (slice == NULL)
+			return NIL;
+
+		ranges = lappend(ranges,
+						 list_make2(makeConst(INT8OID,
+											  -1,
+											  InvalidOid,
+											  sizeof(int64),
+											  Int64GetDatum(slice->fd.range_start),
+											  false,
+											  FLOAT8PASSBYVAL),
+									makeConst(INT8OID,
+											  -1,
+											  InvalidOid,
+											  sizeof(int64),
+											  Int64GetDatum(slice->fd.range_end),
+											  false,
+											  FLOAT8PASSBYVAL)));
+	}
+
+	return list_make4(strategies, exprs, ranges, startup);
+}
+
 Plan *
 ts_chunk_append_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *path, List *tlist,
 							List *clauses, List *custom_plans)
@@ -106,10 +288,15 @@ ts_chunk_append_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *path
 	List *chunk_rt_indexes = NIL;
 	List *sort_options = NIL;
 	List *custom_private = NIL;
+	List *settings;
+	List *range_exclusion = NIL;
+	bool range_exclusion_complete = false;
 	uint32 limit = 0;
 
 	ChunkAppendPath *capath = (ChunkAppendPath *) path;
 	CustomScan *cscan = makeNode(CustomScan);
+	Hypertable *ht =
+		ts_planner_get_hypertable(planner_rt_fetch(rel->relid, root)->relid, CACHE_FLAG_CHECK);
 
 	cscan->flags = path->flags;
 	cscan->methods = &chunk_append_plan_methods;
@@ -322,18 +509,36 @@ ts_chunk_append_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *path
 		}
 	}
 
+	/*
+	 * For the startup and runtime exclusion of the children, also pass down
+	 * the time ranges of the chunks, so that the executor can exclude them
+	 * without proving the chunk constraints for each of them.
+	 */
+	if (capath->startup_exclusion || capath->runtime_exclusion_children)
+		range_exclusion = get_runtime_range_exclusion(root,
+													  rel,
+													  clauses,
+													  cscan->custom_plans,
+													  &range_exclusion_complete);
+
 	if (capath->pushdown_limit && capath->limit_tuples > 0)
 		limit = capath->limit_tuples;
 
-	custom_private = list_make1(list_make5_int(capath->startup_exclusion,
-											   capath->runtime_exclusion_parent,
-											   capath->runtime_exclusion_children,
-											   limit,
-											   capath->first_partial_path));
+	settings = list_make5_int(capath->startup_exclusion,
+							  capath->runtime_exclusion_parent,
+							  capath->runtime_exclusion_children,
+							  limit,
+							  capath->first_partial_path);
+	settings = lappend_int(settings, range_exclusion_complete);
+	/* The hypertable id is only used for the hypertable stats */
+	settings = lappend_int(settings, ht != NULL ? ht->fd.id : 0);
+
+	custom_private = list_make1(settings);
 	custom_private = lappend(custom_private, chunk_ri_clauses);
 	custom_private = lappend(custom_private, chunk_rt_indexes);
 	custom_private = lappend(custom_private, sort_options);
 	custom_private = lappend(custom_private, parent_clauses);
+	custom_private = lappend(custom_private, range_exclusion);
 
 	cscan->custom_private = custom_private;
 
@@ -9,6 +9,7 @@
 #include <nodes/extensible.h>
 #include <nodes/makefuncs.h>
 #include <nodes/nodeFuncs.h>
+#include <optimizer/optimizer.h>
 #include <parser/parsetree.h>
 #include <utils/rel.h>
 #include <utils/syscache.h>
@@ -21,6 +22,8 @@
 #include "subspace_store.h"
 #include "dimension.h"
 #include "guc.h"
+#include "hypercube.h"
+#include "hypertable_stats.h"
 #include "nodes/hypertable_modify.h"
 #include "ts_catalog/chunk_data_node.h"
 
@@ -39,6 +42,12 @@ ts_chunk_dispatch_create(Hypertable *ht, EState *estate, int eflags)
 		ts_subspace_store_init(ht->space, estate->es_query_cxt, ts_guc_max_open_chunks_per_insert);
 	cd->prev_cis = NULL;
 	cd->prev_cis_oid = InvalidOid;
+	cd->num_recent_cis = 0;
+	cd->check_exprs = NULL;
+	cis_vec_init(&cd->buffered_chunk_states, estate->es_query_cxt, 0);
+	cd->last_point_tracker = (eflags & EXEC_FLAG_EXPLAIN_ONLY) ?
+								 NULL :
+								 ts_last_point_cache_tracker_create(ht, estate->es_query_cxt);
 
 	return cd;
 }
@@ -46,7 +55,28 @@ ts_chunk_dispatch_create(Hypertable *ht, EState *estate, int eflags)
 void
 ts_chunk_dispatch_destroy(ChunkDispatch *chunk_dispatch)
 {
+	const int32 hypertable_id = chunk_dispatch->hypertable->fd.id;
+
+	ts_hypertable_stats_add(hypertable_id,
+							chunk_dispatch->dispatch_state != NULL ?
+								HYPERTABLE_STATS_ROWS_INSERTED :
+								HYPERTABLE_STATS_ROWS_COPIED,
+							chunk_dispatch->num_rows);
+	ts_hypertable_stats_add(hypertable_id,
+							HYPERTABLE_STATS_ROWS_COMPRESSED_CHUNKS,
+							chunk_dispatch->num_rows_compressed);
+	ts_hypertable_stats_add(hypertable_id,
+							HYPERTABLE_STATS_CHUNK_CACHE_HITS,
+							chunk_dispatch->num_cis_hits);
+	ts_hypertable_stats_add(hypertable_id,
+							HYPERTABLE_STATS_CHUNK_CACHE_MISSES,
+							chunk_dispatch->num_cis_misses);
+
+	if (chunk_dispatch->last_point_tracker != NULL)
+		ts_last_point_cache_tracker_flush(chunk_dispatch->last_point_tracker);
+
 	ts_subspace_store_free(chunk_dispatch->cache);
+	cis_vec_free_data(&chunk_dispatch->buffered_chunk_states);
 }
 
 static void
@@ -55,6 +85,43 @@ destroy_chunk_insert_state(void *cis)
 	ts_chunk_insert_state_destroy((ChunkInsertState *) cis);
 }
 
+/*
+ * Find the point among the most recently used chunks, and move the chunk to
+ * the front. This is a fast path for the usual case of ingest that hits the
+ * same few chunks for many consecutive tuples.
+ */
+static ChunkInsertState *
+chunk_dispatch_get_recent(ChunkDispatch *dispatch, const Point *point)
+{
+	for (int i = 0; i < dispatch->num_recent_cis; i++)
+	{
+		ChunkInsertState *cis = dispatch->recent_cis[i];
+
+		if (!ts_hypercube_contains_point(cis->cube, point))
+			continue;
+
+		if (i > 0)
+		{
+			memmove(&dispatch->recent_cis[1], &dispatch->recent_cis[0], sizeof(cis) * i);
+			dispatch->recent_cis[0] = cis;
+		}
+
+		return cis;
+	}
+
+	return NULL;
+}
+
+static void
+chunk_dispatch_remember_recent(ChunkDispatch *dispatch, ChunkInsertState *cis)
+{
+	int num_recent = Min(dispatch->num_recent_cis + 1, CHUNK_DISPATCH_NUM_RECENT_CHUNKS);
+
+	memmove(&dispatch->recent_cis[1], &dispatch->recent_cis[0], sizeof(cis) * (num_recent - 1));
+	dispatch->recent_cis[0] = cis;
+	dispatch->num_recent_cis = num_recent;
+}
+
 /*
  * Get the chunk insert state for the chunk that matches the given point in the
  * partitioned hyperspace.
@@ -77,7 +144,15 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 	if (dispatch->hypertable->fd.compression_state == HypertableInternalCompressionTable)
 		elog(ERROR, "direct insert into internal compressed hypertable is not supported");
 
-	cis = ts_subspace_store_get(dispatch->cache, point);
+	cis = chunk_dispatch_get_recent(dispatch, point);
+
+	if (cis == NULL)
+	{
+		cis = ts_subspace_store_get(dispatch->cache, point);
+
+		if (cis != NULL)
+			chunk_dispatch_remember_recent(dispatch, cis);
+	}
 
 	/*
 	 * The chunk search functions may leak memory, so switch to a temporary
@@ -85,6 +160,11 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 	 */
 	MemoryContext old_context = MemoryContextSwitchTo(GetPerTupleMemoryContext(dispatch->estate));
 
+	if (cis != NULL)
+		dispatch->num_cis_hits++;
+	else
+		dispatch->num_cis_misses++;
+
 	if (!cis)
 	{
 		/*
@@ -132,6 +212,12 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 			list_free(chunk_data_nodes);
 		}
 
+		/*
+		 * Adding the new chunk insert state can close the least recently used
+		 * chunks, so we have to flush the tuples buffered for them.
+		 */
+		ts_chunk_dispatch_flush(dispatch);
+
 		cis = ts_chunk_insert_state_create(chunk, dispatch);
 
 		/*
@@ -145,7 +231,27 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 		chunk = ts_chunk_get_by_relid(chunk->table_id, true);
 		ts_set_compression_status(cis, chunk);
 
-		ts_subspace_store_add(dispatch->cache, chunk->cube, cis, destroy_chunk_insert_state);
+		/*
+		 * The hits on the recent chunks don't go through the store, so mark
+		 * them as used to keep them from being evicted. Reopening the chunk
+		 * is more expensive the more indexes we have to open, so prefer keeping
+		 * these chunks open.
+		 */
+		for (int i = dispatch->num_recent_cis - 1; i >= 0; i--)
+			ts_subspace_store_touch(dispatch->cache, dispatch->recent_cis[i]->cube);
+		dispatch->num_recent_cis = 0;
+		ts_subspace_store_add(dispatch->cache,
+							  chunk->cube,
+							  cis,
+							  destroy_chunk_insert_state,
+							  1 + cis->result_relation_info->ri_NumIndices);
+		chunk_dispatch_remember_recent(dispatch, cis);
+
+		if (ts_guc_chunk_precreation_threshold > 0)
+			ts_chunk_precreate_next_for_point(dispatch->hypertable,
+											  chunk,
+											  point,
+											  ts_guc_chunk_precreation_threshold);
 	}
 	else if (cis->rel->rd_id == dispatch->prev_cis_oid && cis == dispatch->prev_cis)
 	{
@@ -200,6 +306,61 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 	return cis;
 }
 
+/*
+ * Check whether we can buffer the tuples for multi-insert into the given chunk
+ * result relation. Besides the statement-level conditions, the chunk must have
+ * no row triggers that would observe the table or the individual rows, and no
+ * WITH CHECK options.
+ */
+bool
+ts_chunk_dispatch_can_buffer_tuple(const ChunkDispatchState *state, const ResultRelInfo *rri)
+{
+	if (state == NULL || !state->allow_multi_insert)
+		return false;
+
+	if (rri->ri_FdwRoutine != NULL || rri->ri_WithCheckOptions != NIL)
+		return false;
+
+	if (rri->ri_TrigDesc != NULL &&
+		(rri->ri_TrigDesc->trig_insert_before_row || rri->ri_TrigDesc->trig_insert_after_row ||
+		 rri->ri_TrigDesc->trig_insert_instead_row || rri->ri_TrigDesc->trig_insert_new_table))
+		return false;
+
+	return true;
+}
+
+/*
+ * Buffer the tuple for a multi-insert into the given chunk, and flush all the
+ * buffers once they hold enough tuples.
+ */
+void
+ts_chunk_dispatch_buffer_tuple(ChunkDispatch *dispatch, ChunkInsertState *cis,
+							   TupleTableSlot *slot)
+{
+	if (cis->n_buffered_slots == 0)
+		cis_vec_append(&dispatch->buffered_chunk_states, cis);
+
+	ts_chunk_insert_state_buffer_tuple(cis, slot);
+	dispatch->n_buffered_tuples++;
+
+	if (dispatch->n_buffered_tuples >= CHUNK_DISPATCH_MAX_BUFFERED_TUPLES)
+		ts_chunk_dispatch_flush(dispatch);
+}
+
+/*
+ * Insert all the buffered tuples into their chunks.
+ */
+void
+ts_chunk_dispatch_flush(ChunkDispatch *dispatch)
+{
+	for (uint32 i = 0; i < dispatch->buffered_chunk_states.num_elements; i++)
+		ts_chunk_insert_state_flush_buffer(*cis_vec_at(&dispatch->buffered_chunk_states, i),
+										   dispatch->transition_capture);
+
+	cis_vec_clear(&dispatch->buffered_chunk_states);
+	dispatch->n_buffered_tuples = 0;
+}
+
 static CustomScanMethods chunk_dispatch_plan_methods = {
 	.CustomName = "ChunkDispatch",
 	.CreateCustomScanState = chunk_dispatch_state_create,
@@ -237,7 +398,9 @@ chunk_dispatch_plan_create(PlannerInfo *root, RelOptInfo *relopt, CustomPath *be
 		cscan->scan.plan.plan_width += subplan->plan_width;
 	}
 
-	cscan->custom_private = list_make1_oid(cdpath->hypertable_relid);
+	cscan->custom_private =
+		list_make2(list_make1_oid(cdpath->hypertable_relid),
+				   list_make1_int(cdpath->allow_multi_insert));
 	cscan->methods = &chunk_dispatch_plan_methods;
 	cscan->custom_plans = custom_plans;
 	cscan->scan.scanrelid = 0; /* Indicate this is not a real relation we are
@@ -284,6 +447,20 @@ ts_chunk_dispatch_path_create(PlannerInfo *root, ModifyTablePath *mtpath, Index
 	path->hypertable_rti = hypertable_rti;
 	path->hypertable_relid = rte->relid;
 
+	/*
+	 * The buffered tuples are not visible to the statement until they are
+	 * flushed, so we can only buffer them when nothing can observe them in
+	 * between, or the individual insert results. The volatile functions, that
+	 * also include the column defaults at this point, could query the
+	 * hypertable. The tuples of ON CONFLICT DO NOTHING are checked against the
+	 * arbiter index when they are flushed.
+	 */
+	path->allow_multi_insert =
+		ts_guc_enable_multi_insert && mtpath->operation == CMD_INSERT &&
+		(mtpath->onconflict == NULL || (ts_guc_enable_multi_insert_on_conflict &&
+										mtpath->onconflict->action == ONCONFLICT_NOTHING)) &&
+		mtpath->returningLists == NIL && !contain_volatile_functions((Node *) root->parse);
+
 	return &path->cpath.path;
 }
 
@@ -425,6 +602,15 @@ chunk_dispatch_exec(CustomScanState *node)
 												   on_chunk_insert_state_changed,
 												   state);
 
+	dispatch->num_rows++;
+	if (cis->chunk_compressed)
+		dispatch->num_rows_compressed++;
+
+	ts_chunk_insert_state_track_invalidation(cis, point);
+
+	if (dispatch->last_point_tracker != NULL)
+		ts_last_point_cache_tracker_add(dispatch->last_point_tracker, slot);
+
 	/*
 	 * Set the result relation in the executor state to the target chunk.
 	 * This makes sure that the tuple gets inserted into the correct
@@ -434,6 +620,10 @@ chunk_dispatch_exec(CustomScanState *node)
 	 */
 #if PG14_LT
 	estate->es_result_relation_info = cis->result_relation_info;
+
+	/* The transition tables get the tuples in the rowtype of the hypertable */
+	if (dispatch->transition_capture != NULL)
+		dispatch->transition_capture->tcs_map = cis->chunk_to_hyper_map;
 #endif
 
 	MemoryContextSwitchTo(old);
@@ -481,10 +671,11 @@ static Node *
 chunk_dispatch_state_create(CustomScan *cscan)
 {
 	ChunkDispatchState *state;
-	Oid hypertable_relid = linitial_oid(cscan->custom_private);
+	Oid hypertable_relid = linitial_oid(linitial(cscan->custom_private));
 
 	state = (ChunkDispatchState *) newNode(sizeof(ChunkDispatchState), T_CustomScanState);
 	state->hypertable_relid = hypertable_relid;
+	state->allow_multi_insert = linitial_int(lsecond(cscan->custom_private));
 	Assert(list_length(cscan->custom_plans) == 1);
 	state->subplan = linitial(cscan->custom_plans);
 	state->cscan_state.methods = &chunk_dispatch_state_methods;
@@ -525,4 +716,20 @@ ts_chunk_dispatch_state_set_parent(ChunkDispatchState *state, ModifyTableState *
 #endif
 	state->mtstate = mtstate;
 	state->arbiter_indexes = mt_plan->arbiterIndexes;
+	state->dispatch->transition_capture = mtstate->mt_transition_capture;
+
+	/*
+	 * The rows of INSERT ... ON CONFLICT and MERGE are not necessarily
+	 * inserted, so we cannot maintain the last point cache for them.
+	 */
+	if (state->dispatch->last_point_tracker != NULL &&
+		(mt_plan->onConflictAction != ONCONFLICT_NONE
+#if PG15_GE
+		 || mtstate->operation == CMD_MERGE
+#endif
+		 ))
+	{
+		ts_last_point_cache_invalidate(state->dispatch->hypertable->fd.id);
+		state->dispatch->last_point_tracker = NULL;
+	}
 }
@@ -14,11 +14,38 @@
 #include <executor/tuptable.h>
 
 #include "hypertable_cache.h"
+#include "last_point_cache.h"
 #include "cache.h"
 #include "export.h"
 #include "subspace_store.h"
 #include "chunk_insert_state.h"
 
+/*
+ * The maximum number of INSERT tuples that we buffer for the multi-insert into
+ * the chunks, over all chunks. The same as for COPY.
+ */
+#define CHUNK_DISPATCH_MAX_BUFFERED_TUPLES 1000
+
+/*
+ * The number of the most recently used chunk insert states that we check
+ * before looking the point up in the subspace store. Time-ordered ingest hits
+ * the same chunk for long runs of tuples, or a few chunks when there are space
+ * partitions.
+ */
+#define CHUNK_DISPATCH_NUM_RECENT_CHUNKS 4
+
+/*
+ * A vector of chunk insert states. A statement usually buffers tuples for a
+ * few chunks at a time, so keep that many inline.
+ */
+#define VEC_PREFIX cis
+#define VEC_ELEMENT_TYPE ChunkInsertState *
+#define VEC_INLINE_CAPACITY 8
+#define VEC_DECLARE 1
+#define VEC_DEFINE 1
+#define VEC_SCOPE static inline
+#include <adts/vec.h>
+
 /*
  * ChunkDispatch keeps cached state needed to dispatch tuples to chunks. It is
  * separate from any plan and executor nodes, since it is used both for INSERT
@@ -40,6 +67,42 @@ typedef struct ChunkDispatch
 	ResultRelInfo *hypertable_result_rel_info;
 	ChunkInsertState *prev_cis;
 	Oid prev_cis_oid;
+
+	/*
+	 * The most recently used chunk insert states, the latest first. They are
+	 * owned by the subspace store, so we reset them when we add a new chunk
+	 * to the store, which can close the least recently used chunks.
+	 */
+	ChunkInsertState *recent_cis[CHUNK_DISPATCH_NUM_RECENT_CHUNKS];
+	int num_recent_cis;
+
+	/*
+	 * The planned CHECK constraints of the chunks opened by this statement, so
+	 * that reopening a closed chunk is cheaper.
+	 */
+	HTAB *check_exprs;
+
+	/* The chunk insert states that have buffered tuples, and their total. */
+	cis_vec buffered_chunk_states;
+	int n_buffered_tuples;
+
+	/*
+	 * The counts for the hypertable stats, reported when the dispatch is
+	 * destroyed. The rows are counted by the callers that dispatch them.
+	 */
+	int64 num_rows;
+	int64 num_rows_compressed;
+	int64 num_cis_hits;
+	int64 num_cis_misses;
+
+	/* Collects the latest rows for the last point cache, if there is one */
+	LastPointCacheTracker *last_point_tracker;
+
+	/*
+	 * The transition tables of the statement triggers of the hypertable, that
+	 * collect the rows inserted into all chunks, or NULL.
+	 */
+	TransitionCaptureState *transition_capture;
 } ChunkDispatch;
 
 typedef struct ChunkDispatchPath
@@ -48,6 +111,12 @@ typedef struct ChunkDispatchPath
 	ModifyTablePath *mtpath;
 	Index hypertable_rti;
 	Oid hypertable_relid;
+
+	/*
+	 * Whether the statement allows buffering the tuples for multi-insert, as
+	 * far as we can tell at the planning time.
+	 */
+	bool allow_multi_insert;
 } ChunkDispatchPath;
 
 typedef struct Cache Cache;
@@ -74,6 +143,14 @@ typedef struct ChunkDispatchState
 	ResultRelInfo *rri;
 	/* flag to represent dropped attributes */
 	bool is_dropped_attr_exists;
+	/*
+	 * Whether we can buffer the tuples for multi-insert into the chunks that
+	 * have no row triggers. This requires a plain INSERT without RETURNING or
+	 * ON CONFLICT other than DO NOTHING, and no volatile functions that could
+	 * observe the rows inserted so far. The buffered tuples are added to the
+	 * transition tables when they are flushed.
+	 */
+	bool allow_multi_insert;
 } ChunkDispatchState;
 
 extern TSDLLEXPORT bool ts_is_chunk_dispatch_state(PlanState *state);
@@ -89,6 +166,12 @@ extern ChunkInsertState *
 ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *p, TupleTableSlot *slot,
 										 const on_chunk_changed_func on_chunk_changed, void *data);
 
+extern bool ts_chunk_dispatch_can_buffer_tuple(const ChunkDispatchState *state,
+											   const ResultRelInfo *rri);
+extern void ts_chunk_dispatch_buffer_tuple(ChunkDispatch *dispatch, ChunkInsertState *cis,
+										   TupleTableSlot *slot);
+extern void ts_chunk_dispatch_flush(ChunkDispatch *dispatch);
+
 extern TSDLLEXPORT Path *ts_chunk_dispatch_path_create(PlannerInfo *root, ModifyTablePath *mtpath,
 													   Index hypertable_rti, int subpath_index);
 
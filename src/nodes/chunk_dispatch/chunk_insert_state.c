@@ -5,8 +5,14 @@
  */
 #include <postgres.h>
 #include <access/attnum.h>
+#include <access/stratnum.h>
 #include <access/xact.h>
+#include <catalog/pg_am.h>
+#include <catalog/pg_index.h>
+#include <catalog/pg_trigger.h>
 #include <catalog/pg_type.h>
+#include <commands/trigger.h>
+#include <executor/executor.h>
 #include <executor/tuptable.h>
 #include <foreign/fdwapi.h>
 #include <miscadmin.h>
@@ -17,34 +23,42 @@
 #include <optimizer/optimizer.h>
 #include <parser/parsetree.h>
 #include <rewrite/rewriteManip.h>
+#include <storage/bufmgr.h>
 #include <utils/builtins.h>
 #include <utils/guc.h>
+#include <utils/hsearch.h>
 #include <utils/lsyscache.h>
 #include <utils/memutils.h>
 #include <utils/rel.h>
 #include <utils/rls.h>
+#include <utils/sortsupport.h>
 
 #include "compat/compat.h"
 #include "errors.h"
 #include "chunk_dispatch.h"
 #include "chunk_insert_state.h"
+#include "ts_catalog/chunk_column_stats.h"
 #include "ts_catalog/chunk_data_node.h"
 #include "ts_catalog/continuous_agg.h"
+#include "chunk_constraint.h"
 #include "chunk_index.h"
+#include "guc.h"
+#include "hypercube.h"
 #include "indexing.h"
+#include "nodes/hypertable_modify.h"
+#include "relation_size_cache.h"
 #include <utils/inval.h>
 
-/* Just like ExecPrepareExpr except that it doesn't switch to the query memory context */
-static inline ExprState *
-prepare_constr_expr(Expr *node)
+/*
+ * The planned CHECK constraint expressions of a chunk, kept for the duration
+ * of the statement, so that reopening a chunk that was closed due to
+ * timescaledb.max_open_chunks_per_insert doesn't parse and plan them again.
+ */
+typedef struct ChunkCheckExprsEntry
 {
-	ExprState *result;
-
-	node = expression_planner(node);
-	result = ExecInitExpr(node, NULL);
-
-	return result;
-}
+	int32 chunk_id;
+	Expr **exprs;
+} ChunkCheckExprsEntry;
 
 static inline ModifyTableState *
 get_modifytable_state(const ChunkDispatch *dispatch)
@@ -99,6 +113,75 @@ chunk_dispatch_get_cmd_type(const ChunkDispatch *dispatch)
 											  dispatch->dispatch_state->mtstate->operation;
 }
 
+static bool
+is_chunk_dimension_constraint(const Chunk *chunk, const char *constraint_name)
+{
+	if (chunk->constraints == NULL)
+		return false;
+
+	for (int i = 0; i < chunk->constraints->num_constraints; i++)
+	{
+		const ChunkConstraint *cc = chunk_constraints_get(chunk->constraints, i);
+
+		if (is_dimension_constraint(cc) &&
+			namestrcmp((Name) &cc->fd.constraint_name, constraint_name) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Get the planned CHECK constraint expressions of the chunk, in the order of
+ * the relation's constraints. The skipped ones are NULL.
+ */
+static Expr **
+get_chunk_check_exprs(ChunkDispatch *dispatch, Relation rel, const Chunk *chunk,
+					  bool skip_dimension_constraints)
+{
+	MemoryContext query_mcxt = dispatch->estate->es_query_cxt;
+	ChunkCheckExprsEntry *entry;
+	bool found;
+
+	if (dispatch->check_exprs == NULL)
+	{
+		HASHCTL hctl = {
+			.keysize = sizeof(int32),
+			.entrysize = sizeof(ChunkCheckExprsEntry),
+			.hcxt = query_mcxt,
+		};
+
+		dispatch->check_exprs = hash_create("chunk check constraint expressions",
+											32,
+											&hctl,
+											HASH_ELEM | HASH_CONTEXT | HASH_BLOBS);
+	}
+
+	entry = hash_search(dispatch->check_exprs, &chunk->fd.id, HASH_ENTER, &found);
+
+	if (!found)
+	{
+		int ncheck = rel->rd_att->constr->num_check;
+		ConstrCheck *check = rel->rd_att->constr->check;
+		MemoryContext old_mcxt = MemoryContextSwitchTo(query_mcxt);
+
+		entry->exprs = palloc(ncheck * sizeof(Expr *));
+
+		for (int i = 0; i < ncheck; i++)
+		{
+			if (skip_dimension_constraints &&
+				is_chunk_dimension_constraint(chunk, check[i].ccname))
+				entry->exprs[i] = NULL;
+			else
+				entry->exprs[i] = expression_planner(stringToNode(check[i].ccbin));
+		}
+
+		MemoryContextSwitchTo(old_mcxt);
+	}
+
+	return entry->exprs;
+}
+
 /*
  * Create the constraint exprs inside the current memory context. If this
  * is not done here, then ExecRelCheck will do it for you but put it into
@@ -106,24 +189,31 @@ chunk_dispatch_get_cmd_type(const ChunkDispatch *dispatch)
  *
  * See the comment in `ts_chunk_insert_state_destroy` for more information
  * on the implications of this.
+ *
+ * The tuples are routed to the chunk by their point in the hypertable's
+ * dimensional space, so they always satisfy the CHECK constraints for the
+ * chunk's dimension slices. We don't build these constraints, which makes
+ * ExecConstraints skip them. The only exception is ON CONFLICT DO UPDATE,
+ * where the updated tuple can change its partitioning columns.
  */
 static inline void
-create_chunk_rri_constraint_expr(ResultRelInfo *rri, Relation rel)
+create_chunk_rri_constraint_expr(ChunkDispatch *dispatch, ResultRelInfo *rri, Relation rel,
+								 const Chunk *chunk, bool skip_dimension_constraints)
 {
 	int ncheck, i;
-	ConstrCheck *check;
+	Expr **check_exprs;
 
 	Assert(rel->rd_att->constr != NULL && rri->ri_ConstraintExprs == NULL);
 
 	ncheck = rel->rd_att->constr->num_check;
-	check = rel->rd_att->constr->check;
+	check_exprs = get_chunk_check_exprs(dispatch, rel, chunk, skip_dimension_constraints);
 	rri->ri_ConstraintExprs = (ExprState **) palloc(ncheck * sizeof(ExprState *));
 
 	for (i = 0; i < ncheck; i++)
 	{
-		Expr *checkconstr = stringToNode(check[i].ccbin);
-
-		rri->ri_ConstraintExprs[i] = prepare_constr_expr(checkconstr);
+		/* Just like ExecPrepareExpr except that it doesn't switch to the query memory context */
+		rri->ri_ConstraintExprs[i] =
+			check_exprs[i] == NULL ? NULL : ExecInitExpr(check_exprs[i], NULL);
 	}
 }
 
@@ -136,7 +226,7 @@ create_chunk_rri_constraint_expr(ResultRelInfo *rri, Relation rel)
  * The Hypertable ResultRelInfo is used as a template for the chunk's new ResultRelInfo.
  */
 static inline ResultRelInfo *
-create_chunk_result_relation_info(ChunkDispatch *dispatch, Relation rel)
+create_chunk_result_relation_info(ChunkDispatch *dispatch, Relation rel, const Chunk *chunk)
 {
 	ResultRelInfo *rri;
 	ResultRelInfo *rri_orig = dispatch->hypertable_result_rel_info;
@@ -159,7 +249,12 @@ create_chunk_result_relation_info(ChunkDispatch *dispatch, Relation rel)
 	if (RelationGetForm(rel)->relkind == RELKIND_FOREIGN_TABLE)
 		rri->ri_FdwRoutine = GetFdwRoutineForRelation(rel, true);
 
-	create_chunk_rri_constraint_expr(rri, rel);
+	create_chunk_rri_constraint_expr(dispatch,
+									 rri,
+									 rel,
+									 chunk,
+									 chunk_dispatch_get_on_conflict_action(dispatch) !=
+										 ONCONFLICT_UPDATE);
 
 	return rri;
 }
@@ -522,6 +617,48 @@ set_arbiter_indexes(ChunkInsertState *state, ChunkDispatch *dispatch)
 	state->result_relation_info->ri_onConflictArbiterIndexes = state->arbiter_indexes;
 }
 
+#if PG14_GE
+/*
+ * Find the arbiter index of an INSERT ... ON CONFLICT DO NOTHING that the
+ * buffered tuples can be checked against in batches, see
+ * check_buffered_arbiter_conflicts(). There must be a single arbiter, and it
+ * must be an immediate unique B-tree index on plain columns, so that the
+ * tuples can be sorted and compared like the index does. Returns the position
+ * of the index in the result relation, or -1.
+ */
+static int
+get_batch_arbiter_index(ChunkInsertState *state, ChunkDispatch *dispatch)
+{
+	ResultRelInfo *rri = state->result_relation_info;
+	int result = -1;
+
+	if (chunk_dispatch_get_on_conflict_action(dispatch) != ONCONFLICT_NOTHING ||
+		dispatch->dispatch_state == NULL)
+		return -1;
+
+	for (int i = 0; i < rri->ri_NumIndices; i++)
+	{
+		Relation index = rri->ri_IndexRelationDescs[i];
+		IndexInfo *ii = rri->ri_IndexRelationInfo[i];
+
+		/* Without an inference specification, all unique indexes are arbiters */
+		if (state->arbiter_indexes != NIL ?
+				!list_member_oid(state->arbiter_indexes, RelationGetRelid(index)) :
+				!ii->ii_Unique && ii->ii_ExclusionOps == NULL)
+			continue;
+
+		if (result >= 0 || !ii->ii_Unique || ii->ii_ExclusionOps != NULL ||
+			!ii->ii_ReadyForInserts || ii->ii_Expressions != NIL || ii->ii_Predicate != NIL ||
+			index->rd_rel->relam != BTREE_AM_OID || !index->rd_index->indimmediate)
+			return -1;
+
+		result = i;
+	}
+
+	return result;
+}
+#endif
+
 /* Change the projections to work with chunks instead of hypertables */
 static void
 adjust_projections(ChunkInsertState *cis, ChunkDispatch *dispatch, Oid rowtype)
@@ -562,6 +699,109 @@ adjust_projections(ChunkInsertState *cis, ChunkDispatch *dispatch, Oid rowtype)
 	}
 }
 
+/*
+ * Take over the continuous aggregate invalidation trigger of the chunk.
+ *
+ * The invalidation trigger is an AFTER ROW trigger, so each inserted tuple
+ * pays for a trigger call, for queuing the trigger event, and for extracting
+ * the time value from the tuple again. It also prevents buffering the tuples
+ * for multi-inserts. For plain inserts the trigger only needs the lowest and
+ * greatest time value of the tuples, which we already compute when routing
+ * the tuples to the chunk, so we remove the trigger from the chunk's result
+ * relation and record the range once when the chunk insert state is
+ * destroyed.
+ *
+ * ON CONFLICT keeps the trigger, since DO NOTHING skips tuples only after
+ * they were routed and DO UPDATE also updates tuples, and so does MERGE. We
+ * also keep it if a BEFORE ROW trigger could change the inserted tuple, or if
+ * the trigger would not fire in this session.
+ */
+static void
+take_over_cagg_invalidation_trigger(ChunkInsertState *state, ChunkDispatch *dispatch,
+									OnConflictAction onconflict_action)
+{
+	ResultRelInfo *rri = state->result_relation_info;
+	TriggerDesc *tg = rri->ri_TrigDesc;
+	const Hyperspace *space = dispatch->hypertable->space;
+	const Dimension *open_dim = hyperspace_get_open_dimension(space, 0);
+	int cagg_trigger = -1;
+
+	if (tg == NULL || !tg->trig_insert_after_row || tg->trig_insert_before_row ||
+		onconflict_action != ONCONFLICT_NONE ||
+		chunk_dispatch_get_cmd_type(dispatch) != CMD_INSERT || open_dim == NULL ||
+		SessionReplicationRole == SESSION_REPLICATION_ROLE_REPLICA)
+		return;
+
+	for (int i = 0; i < tg->numtriggers; i++)
+	{
+		Trigger *trigger = &tg->triggers[i];
+
+		if (strcmp(trigger->tgname, CAGGINVAL_TRIGGER_NAME) == 0 && trigger->tgnargs >= 1 &&
+			trigger->tgqual == NULL &&
+			(trigger->tgenabled == TRIGGER_FIRES_ON_ORIGIN ||
+			 trigger->tgenabled == TRIGGER_FIRES_ALWAYS))
+		{
+			cagg_trigger = i;
+			break;
+		}
+	}
+
+	if (cagg_trigger < 0)
+		return;
+
+	state->cagg_inval_tracked = true;
+	state->cagg_inval_hypertable_id = atoi(tg->triggers[cagg_trigger].tgargs[0]);
+	state->cagg_inval_entry_id = tg->triggers[cagg_trigger].tgnargs > 1 ?
+									 atoi(tg->triggers[cagg_trigger].tgargs[1]) :
+									 state->cagg_inval_hypertable_id;
+	state->cagg_inval_dimension = open_dim - space->dimensions;
+
+	/* The result relation has its own copy of the trigger descriptor */
+	tg->numtriggers--;
+	memmove(&tg->triggers[cagg_trigger],
+			&tg->triggers[cagg_trigger + 1],
+			sizeof(Trigger) * (tg->numtriggers - cagg_trigger));
+
+	tg->trig_insert_after_row = false;
+	for (int i = 0; i < tg->numtriggers; i++)
+	{
+		if (TRIGGER_TYPE_MATCHES(tg->triggers[i].tgtype,
+								 TRIGGER_TYPE_ROW,
+								 TRIGGER_TYPE_AFTER,
+								 TRIGGER_TYPE_INSERT))
+			tg->trig_insert_after_row = true;
+	}
+
+	if (tg->numtriggers == 0)
+		rri->ri_TrigDesc = NULL;
+}
+
+/*
+ * Track the time value of a tuple routed to the chunk for the continuous
+ * aggregate invalidation, if we took over the invalidation trigger.
+ */
+void
+ts_chunk_insert_state_track_invalidation(ChunkInsertState *state, const Point *point)
+{
+	int64 value;
+
+	if (!state->cagg_inval_tracked)
+		return;
+
+	value = point->coordinates[state->cagg_inval_dimension];
+
+	if (!state->cagg_inval_value_is_set)
+	{
+		state->cagg_inval_lowest_value = value;
+		state->cagg_inval_greatest_value = value;
+		state->cagg_inval_value_is_set = true;
+	}
+	else if (value < state->cagg_inval_lowest_value)
+		state->cagg_inval_lowest_value = value;
+	else if (value > state->cagg_inval_greatest_value)
+		state->cagg_inval_greatest_value = value;
+}
+
 /*
  * Create new insert chunk state.
  *
@@ -591,7 +831,7 @@ ts_chunk_insert_state_create(const Chunk *chunk, ChunkDispatch *dispatch)
 	rel = table_open(chunk->table_id, RowExclusiveLock);
 
 	MemoryContext old_mcxt = MemoryContextSwitchTo(cis_context);
-	relinfo = create_chunk_result_relation_info(dispatch, rel);
+	relinfo = create_chunk_result_relation_info(dispatch, rel, chunk);
 	CheckValidResultRel(relinfo, chunk_dispatch_get_cmd_type(dispatch));
 
 	state = palloc0(sizeof(ChunkInsertState));
@@ -604,6 +844,31 @@ ts_chunk_insert_state_create(const Chunk *chunk, ChunkDispatch *dispatch)
 	if (relinfo->ri_RelationDesc->rd_rel->relhasindex && relinfo->ri_IndexRelationDescs == NULL)
 		ExecOpenIndices(relinfo, onconflict_action != ONCONFLICT_NONE);
 
+	if (chunk->relkind == RELKIND_RELATION)
+		take_over_cagg_invalidation_trigger(state, dispatch, onconflict_action);
+
+	/*
+	 * The tuples can only go directly into the compressed chunk when nothing
+	 * needs to see them in the uncompressed chunk: no row triggers, check
+	 * options or conflict handling, and no unique indexes to check them
+	 * against. An empty chunk that is not compressed yet gets its compressed
+	 * chunk when the first tuples are compressed.
+	 */
+	bool compress_into_compressed_chunk =
+		ts_guc_enable_direct_compress_insert && state->chunk_compressed;
+	bool compress_into_new_chunk = ts_guc_enable_direct_compress_empty_chunks &&
+								   !state->chunk_compressed && chunk->relkind == RELKIND_RELATION &&
+								   TS_HYPERTABLE_HAS_COMPRESSION_ENABLED(dispatch->hypertable) &&
+								   RelationGetNumberOfBlocks(rel) == 0;
+	state->compress_on_insert = (compress_into_compressed_chunk || compress_into_new_chunk) &&
+								chunk->relkind == RELKIND_RELATION &&
+								ts_cm_functions->compress_tuples_for_insert != NULL &&
+								chunk_dispatch_get_cmd_type(dispatch) == CMD_INSERT &&
+								onconflict_action == ONCONFLICT_NONE &&
+								relinfo->ri_TrigDesc == NULL &&
+								relinfo->ri_WithCheckOptions == NIL &&
+								!ts_indexing_relation_has_primary_or_unique_index(rel);
+
 	if (relinfo->ri_TrigDesc != NULL)
 	{
 		TriggerDesc *tg = relinfo->ri_TrigDesc;
@@ -633,8 +898,32 @@ ts_chunk_insert_state_create(const Chunk *chunk, ChunkDispatch *dispatch)
 		state->hyper_to_chunk_map =
 			convert_tuples_by_name(RelationGetDescr(parent_rel), RelationGetDescr(rel));
 
+	/*
+	 * The transition tables of the statement triggers of the hypertable get
+	 * the tuples of the chunk in the rowtype of the hypertable.
+	 */
+	if (chunk->relkind != RELKIND_FOREIGN_TABLE && state->hyper_to_chunk_map != NULL)
+	{
+		TupleConversionMap *chunk_map =
+			convert_tuples_by_name(RelationGetDescr(rel), RelationGetDescr(parent_rel));
+#if PG14_LT
+		state->chunk_to_hyper_map = chunk_map;
+#else
+		relinfo->ri_ChildToRootMap = chunk_map;
+		relinfo->ri_ChildToRootMapValid = true;
+#endif
+	}
+
 	adjust_projections(state, dispatch, RelationGetForm(rel)->reltype);
 
+#if PG14_GE
+	state->batch_arbiter_index = get_batch_arbiter_index(state, dispatch);
+	if (state->batch_arbiter_index >= 0)
+		state->mtstate = dispatch->dispatch_state->mtstate;
+#else
+	state->batch_arbiter_index = -1;
+#endif
+
 	/* Need a tuple table slot to store tuples going into this chunk. We don't
 	 * want this slot tied to the executor's tuple table, since that would tie
 	 * the slot's lifetime to the entire length of the execution and we want
@@ -647,6 +936,7 @@ ts_chunk_insert_state_create(const Chunk *chunk, ChunkDispatch *dispatch)
 	table_close(parent_rel, AccessShareLock);
 
 	state->chunk_id = chunk->fd.id;
+	state->cube = ts_hypercube_copy(chunk->cube);
 
 	if (chunk->relkind == RELKIND_FOREIGN_TABLE)
 	{
@@ -704,6 +994,330 @@ ts_chunk_insert_state_create(const Chunk *chunk, ChunkDispatch *dispatch)
 	return state;
 }
 
+/*
+ * Buffer a copy of the tuple for a multi-insert into the chunk.
+ *
+ * The caller must have checked the constraints of the tuple, and must flush
+ * the buffer before it holds CHUNK_DISPATCH_MAX_BUFFERED_TUPLES tuples.
+ */
+void
+ts_chunk_insert_state_buffer_tuple(ChunkInsertState *state, TupleTableSlot *slot)
+{
+	MemoryContext old_mcxt = MemoryContextSwitchTo(state->mctx);
+
+	if (state->buffered_slots == NULL)
+	{
+		state->buffered_slots =
+			palloc0(sizeof(TupleTableSlot *) * CHUNK_DISPATCH_MAX_BUFFERED_TUPLES);
+		state->bistate = GetBulkInsertState();
+
+		/*
+		 * Make a non-refcounted copy of the tupdesc, so that creating a lot of
+		 * slots doesn't spend CPU in ResourceOwner, like we do for COPY.
+		 */
+		state->buffered_slot_tupdesc = CreateTupleDescCopyConstr(RelationGetDescr(state->rel));
+		Assert(state->buffered_slot_tupdesc->tdrefcount == -1);
+	}
+
+	Assert(state->n_buffered_slots < CHUNK_DISPATCH_MAX_BUFFERED_TUPLES);
+	TupleTableSlot **buffered_slot = &state->buffered_slots[state->n_buffered_slots];
+	if (*buffered_slot == NULL)
+	{
+		*buffered_slot = MakeSingleTupleTableSlot(state->buffered_slot_tupdesc,
+												  table_slot_callbacks(state->rel));
+	}
+
+	ExecCopySlot(*buffered_slot, slot);
+	state->n_buffered_slots++;
+
+	MemoryContextSwitchTo(old_mcxt);
+}
+
+#if PG14_GE
+typedef struct ArbiterKeys
+{
+	TupleTableSlot **slots;
+	int nkeys;
+	AttrNumber *attnos;
+	SortSupport ssup;
+} ArbiterKeys;
+
+/*
+ * Compare two tuples on the columns of the arbiter index. Equal NULLs compare
+ * as equal, and are reported since they don't conflict in the index unless it
+ * has NULLS NOT DISTINCT.
+ */
+static int
+compare_arbiter_keys(TupleTableSlot *slot1, TupleTableSlot *slot2, const ArbiterKeys *keys,
+					 bool *equal_nulls)
+{
+	for (int i = 0; i < keys->nkeys; i++)
+	{
+		bool isnull1, isnull2;
+		Datum value1 = slot_getattr(slot1, keys->attnos[i], &isnull1);
+		Datum value2 = slot_getattr(slot2, keys->attnos[i], &isnull2);
+		int cmp = ApplySortComparator(value1, isnull1, value2, isnull2, &keys->ssup[i]);
+
+		if (cmp != 0)
+			return cmp;
+
+		if (isnull1)
+			*equal_nulls = true;
+	}
+
+	return 0;
+}
+
+/* Sort the positions of the buffered tuples in the order of the index, then by position */
+static int
+compare_buffered_positions(const void *a, const void *b, void *arg)
+{
+	const ArbiterKeys *keys = arg;
+	int pos1 = *(const int *) a;
+	int pos2 = *(const int *) b;
+	bool equal_nulls = false;
+	int cmp = compare_arbiter_keys(keys->slots[pos1], keys->slots[pos2], keys, &equal_nulls);
+
+	if (cmp != 0)
+		return cmp;
+
+	return (pos1 > pos2) - (pos1 < pos2);
+}
+
+/*
+ * Check the buffered tuples of an INSERT ... ON CONFLICT DO NOTHING against
+ * the arbiter index of the chunk, and move the tuples that are not inserted
+ * after the ones that are. Returns the number of tuples to insert.
+ *
+ * The tuples are probed in the order of the index, so that consecutive probes
+ * mostly visit the same index pages. A tuple with the same key as an earlier
+ * tuple of the buffer is skipped without a probe, since it would conflict
+ * with that tuple once it is inserted, or with the same existing tuple.
+ *
+ * Nothing holds off concurrent inserts of the same keys between the checks
+ * and the inserts, like the speculative insertion of a single tuple does, so
+ * such inserts make the index insert fail with a unique violation instead.
+ */
+static int
+check_buffered_arbiter_conflicts(ChunkInsertState *state)
+{
+	ResultRelInfo *rri = state->result_relation_info;
+	EState *estate = state->estate;
+	Relation index = rri->ri_IndexRelationDescs[state->batch_arbiter_index];
+	IndexInfo *ii = rri->ri_IndexRelationInfo[state->batch_arbiter_index];
+	int n_slots = state->n_buffered_slots;
+	int *order = palloc(sizeof(int) * n_slots);
+	bool *skip = palloc0(sizeof(bool) * n_slots);
+	TupleTableSlot **slots = palloc(sizeof(TupleTableSlot *) * n_slots);
+	bool nulls_not_distinct = false;
+	ArbiterKeys keys;
+	int n_insert = 0;
+	int n_skipped = 0;
+
+#if PG15_GE
+	nulls_not_distinct = ii->ii_NullsNotDistinct;
+#endif
+
+	keys.slots = state->buffered_slots;
+	keys.nkeys = ii->ii_NumIndexKeyAttrs;
+	keys.attnos = ii->ii_IndexAttrNumbers;
+	keys.ssup = palloc0(sizeof(SortSupportData) * keys.nkeys);
+
+	for (int i = 0; i < keys.nkeys; i++)
+	{
+		SortSupport ssup = &keys.ssup[i];
+		int16 option = index->rd_indoption[i];
+
+		ssup->ssup_cxt = CurrentMemoryContext;
+		ssup->ssup_collation = index->rd_indcollation[i];
+		ssup->ssup_nulls_first = (option & INDOPTION_NULLS_FIRST) != 0;
+		ssup->ssup_attno = keys.attnos[i];
+		PrepareSortSupportFromIndexRel(index,
+									   (option & INDOPTION_DESC) ? BTGreaterStrategyNumber :
+																   BTLessStrategyNumber,
+									   ssup);
+	}
+
+	for (int i = 0; i < n_slots; i++)
+		order[i] = i;
+
+	qsort_arg(order, n_slots, sizeof(int), compare_buffered_positions, &keys);
+
+	for (int i = 0; i < n_slots; i++)
+	{
+		TupleTableSlot *slot = state->buffered_slots[order[i]];
+		ItemPointerData conflict_tid;
+
+		if (i > 0)
+		{
+			bool equal_nulls = false;
+
+			if (compare_arbiter_keys(state->buffered_slots[order[i - 1]],
+									 slot,
+									 &keys,
+									 &equal_nulls) == 0 &&
+				(!equal_nulls || nulls_not_distinct))
+			{
+				skip[order[i]] = true;
+				continue;
+			}
+		}
+
+		if (!ExecCheckIndexConstraints(rri, slot, estate, &conflict_tid, state->arbiter_indexes))
+		{
+			ts_hypertable_modify_check_conflict_visible(estate, rri, &conflict_tid);
+			skip[order[i]] = true;
+		}
+	}
+
+	/* Keep the inserted tuples in their original order */
+	memcpy(slots, state->buffered_slots, sizeof(TupleTableSlot *) * n_slots);
+
+	for (int i = 0; i < n_slots; i++)
+	{
+		if (!skip[i])
+			state->buffered_slots[n_insert++] = slots[i];
+	}
+
+	for (int i = 0; i < n_slots; i++)
+	{
+		if (skip[i])
+			state->buffered_slots[n_insert + n_skipped++] = slots[i];
+	}
+
+	return n_insert;
+}
+#endif
+
+/*
+ * Add the tuples inserted into the chunk to the transition tables of the
+ * statement triggers of the hypertable, if there are any.
+ */
+void
+ts_chunk_insert_state_capture_tuples(ChunkInsertState *state,
+									 TransitionCaptureState *transition_capture,
+									 TupleTableSlot **slots, int nslots)
+{
+	if (transition_capture == NULL || !transition_capture->tcs_insert_new_table)
+		return;
+
+#if PG14_LT
+	transition_capture->tcs_map = state->chunk_to_hyper_map;
+#endif
+	transition_capture->tcs_original_insert_tuple = NULL;
+
+	for (int i = 0; i < nslots; i++)
+		ExecARInsertTriggers(state->estate,
+							 state->result_relation_info,
+							 slots[i],
+							 NIL,
+							 transition_capture);
+}
+
+/*
+ * Insert the buffered tuples into the chunk, and update its indexes.
+ *
+ * We only buffer the tuples when the chunk has no row triggers, so there are
+ * no AFTER ROW triggers to run here. The inserted tuples are only added to
+ * the transition tables of the hypertable.
+ */
+void
+ts_chunk_insert_state_flush_buffer(ChunkInsertState *state,
+								   TransitionCaptureState *transition_capture)
+{
+	ResultRelInfo *rri = state->result_relation_info;
+	EState *estate = state->estate;
+	int n_insert = state->n_buffered_slots;
+
+	if (state->n_buffered_slots == 0)
+		return;
+
+	if (state->compress_on_insert)
+	{
+		MemoryContext old_mcxt = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+		bool compressed = ts_cm_functions->compress_tuples_for_insert(state,
+																	   state->buffered_slots,
+																	   state->n_buffered_slots);
+		MemoryContextSwitchTo(old_mcxt);
+
+		if (compressed)
+		{
+			ts_chunk_insert_state_capture_tuples(state,
+												 transition_capture,
+												 state->buffered_slots,
+												 state->n_buffered_slots);
+
+			for (int i = 0; i < state->n_buffered_slots; i++)
+				ExecClearTuple(state->buffered_slots[i]);
+			state->n_buffered_slots = 0;
+			return;
+		}
+
+		/* No compressed chunk could be created, use the uncompressed chunk */
+		state->compress_on_insert = false;
+	}
+
+#if PG14_LT
+	ResultRelInfo *saved_result_relation_info = estate->es_result_relation_info;
+	estate->es_result_relation_info = rri;
+#endif
+
+	/* table_multi_insert() may leak memory, so use a short-lived context. */
+	MemoryContext old_mcxt = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+
+#if PG14_GE
+	if (state->batch_arbiter_index >= 0)
+	{
+		n_insert = check_buffered_arbiter_conflicts(state);
+
+		InstrCountTuples2(&state->mtstate->ps, state->n_buffered_slots - n_insert);
+		if (state->mtstate->canSetTag)
+			estate->es_processed += n_insert;
+	}
+#endif
+
+	if (n_insert > 0)
+		table_multi_insert(rri->ri_RelationDesc,
+						   state->buffered_slots,
+						   n_insert,
+						   estate->es_output_cid,
+						   0,
+						   state->bistate);
+	MemoryContextSwitchTo(old_mcxt);
+
+	ts_chunk_insert_state_capture_tuples(state,
+										 transition_capture,
+										 state->buffered_slots,
+										 n_insert);
+
+	for (int i = 0; i < state->n_buffered_slots; i++)
+	{
+		if (i < n_insert && rri->ri_NumIndices > 0)
+		{
+			List *recheckIndexes = ExecInsertIndexTuplesCompat(rri,
+															   state->buffered_slots[i],
+															   estate,
+															   false,
+															   false,
+															   NULL,
+															   NIL,
+															   false);
+			list_free(recheckIndexes);
+		}
+
+		ExecClearTuple(state->buffered_slots[i]);
+	}
+
+	state->n_buffered_slots = 0;
+
+	/* Don't keep the last heap page pinned while we insert into other chunks. */
+	ReleaseBulkInsertStatePin(state->bistate);
+
+#if PG14_LT
+	estate->es_result_relation_info = saved_result_relation_info;
+#endif
+}
+
 void
 ts_set_compression_status(ChunkInsertState *state, const Chunk *chunk)
 {
@@ -717,7 +1331,13 @@ ts_chunk_insert_state_destroy(ChunkInsertState *state)
 {
 	ResultRelInfo *rri = state->result_relation_info;
 
-	if (state->chunk_compressed && !state->chunk_partial)
+	/*
+	 * The chunk only becomes partial when some tuples went into the
+	 * uncompressed chunk, which is always the case without direct compressed
+	 * inserts.
+	 */
+	if (state->chunk_compressed && !state->chunk_partial &&
+		(!state->compress_on_insert || RelationGetNumberOfBlocks(state->rel) > 0))
 	{
 		Oid chunk_relid = RelationGetRelid(state->result_relation_info->ri_RelationDesc);
 		Chunk *chunk = ts_chunk_get_by_relid(chunk_relid, true);
@@ -725,13 +1345,50 @@ ts_chunk_insert_state_destroy(ChunkInsertState *state)
 		/* changed chunk status, so invalidate any plans involving this chunk */
 		CacheInvalidateRelcacheByRelid(chunk_relid);
 	}
+	else if (state->chunk_compressed && state->compress_on_insert)
+	{
+		/*
+		 * The tuples went directly into the compressed chunk, so they can be
+		 * outside of its tracked ranges even if the batches stay ordered.
+		 */
+		Oid chunk_relid = RelationGetRelid(state->result_relation_info->ri_RelationDesc);
+		ts_chunk_column_stats_set_invalid(ts_chunk_get_by_relid(chunk_relid, true));
+	}
 
 	if (rri->ri_FdwRoutine && !rri->ri_usesFdwDirectModify && rri->ri_FdwRoutine->EndForeignModify)
 		rri->ri_FdwRoutine->EndForeignModify(state->estate, rri);
 
+	if (state->cagg_inval_value_is_set)
+		ts_cm_functions->continuous_agg_invalidate_range(state->cagg_inval_hypertable_id,
+														 state->cagg_inval_entry_id,
+														 state->cagg_inval_lowest_value,
+														 state->cagg_inval_greatest_value);
+
 	destroy_on_conflict_state(state);
+
+	/* The buffered tuples must be flushed before the chunk is closed. */
+	Assert(state->n_buffered_slots == 0);
+	if (state->buffered_slots != NULL)
+	{
+		for (int i = 0; i < CHUNK_DISPATCH_MAX_BUFFERED_TUPLES && state->buffered_slots[i] != NULL;
+			 i++)
+			ExecDropSingleTupleTableSlot(state->buffered_slots[i]);
+		FreeBulkInsertState(state->bistate);
+	}
+
 	ExecCloseIndices(state->result_relation_info);
 
+	/* The inserts have grown the chunk, or its compressed chunk */
+	ts_relation_size_cache_invalidate(RelationGetRelid(state->rel));
+	if (state->compress_on_insert)
+	{
+		Chunk *chunk = ts_chunk_get_by_relid(RelationGetRelid(state->rel), false);
+
+		if (chunk != NULL && chunk->fd.compressed_chunk_id != INVALID_CHUNK_ID)
+			ts_relation_size_cache_invalidate(
+				ts_chunk_get_relid(chunk->fd.compressed_chunk_id, true));
+	}
+
 	table_close(state->rel, NoLock);
 	if (state->slot)
 		ExecDropSingleTupleTableSlot(state->slot);
@@ -8,8 +8,11 @@
 
 #include <postgres.h>
 #include <funcapi.h>
+#include <access/heapam.h>
 #include <access/tupconvert.h>
+#include <commands/trigger.h>
 
+#include "compat/compat.h"
 #include "chunk.h"
 #include "cache.h"
 #include "cross_module_fn.h"
@@ -44,21 +47,87 @@ typedef struct ChunkInsertState
 	TupleTableSlot *slot;
 	/* Map for converting tuple from hypertable (root table) format to chunk format */
 	TupleConversionMap *hyper_to_chunk_map;
+#if PG14_LT
+	/*
+	 * Map for converting the tuples of the chunk back to the hypertable
+	 * format, for the transition tables. PG >= 14 keeps it in the
+	 * ri_ChildToRootMap of the result relation.
+	 */
+	TupleConversionMap *chunk_to_hyper_map;
+#endif
 	MemoryContext mctx;
 	EState *estate;
 	List *chunk_data_nodes; /* List of data nodes for the chunk (ChunkDataNode objects) */
 	int32 chunk_id;
 	Oid user_id;
+	/* A copy of the chunk's hypercube, to check the points routed to the chunk */
+	Hypercube *cube;
 
 	/* for tracking compressed chunks */
 	bool chunk_compressed;
 	bool chunk_partial;
+	/*
+	 * Whether the buffered tuples are compressed into new batches of the
+	 * compressed chunk instead of being inserted into the uncompressed chunk,
+	 * see timescaledb.enable_direct_compress_insert and
+	 * timescaledb.enable_direct_compress_empty_chunks.
+	 */
+	bool compress_on_insert;
+	/*
+	 * Whether the batches compressed into the compressed chunk that was
+	 * created for this insert are still in the order of the sort keys of the
+	 * compression, and the last tuple compressed so far, to check the next
+	 * buffer against it. The chunk doesn't become unordered as long as this
+	 * holds.
+	 */
+	bool compress_ordered;
+	HeapTuple compress_last_tuple;
+
+	/*
+	 * The tuples of an INSERT that are buffered for a multi-insert into the
+	 * chunk, see ts_chunk_dispatch_buffer_tuple(). The slots are created on
+	 * demand and reused after each flush.
+	 */
+	TupleTableSlot **buffered_slots;
+	int n_buffered_slots;
+	TupleDesc buffered_slot_tupdesc;
+	BulkInsertState bistate;
+
+	/*
+	 * The position of the arbiter index of an INSERT ... ON CONFLICT DO
+	 * NOTHING in the indexes of the result relation, when the buffered tuples
+	 * are checked against it at flush time, or -1. The INSERT then counts the
+	 * inserted and the conflicting tuples at flush time.
+	 */
+	int batch_arbiter_index;
+	ModifyTableState *mtstate;
+
+	/*
+	 * The continuous aggregate invalidation of the inserted tuples, which is
+	 * tracked here for the whole statement instead of with the per-row
+	 * invalidation trigger of the chunk, see
+	 * take_over_cagg_invalidation_trigger().
+	 */
+	bool cagg_inval_tracked;
+	int32 cagg_inval_hypertable_id;
+	int32 cagg_inval_entry_id;
+	int cagg_inval_dimension;
+	bool cagg_inval_value_is_set;
+	int64 cagg_inval_lowest_value;
+	int64 cagg_inval_greatest_value;
 } ChunkInsertState;
 
 typedef struct ChunkDispatch ChunkDispatch;
 
 extern ChunkInsertState *ts_chunk_insert_state_create(const Chunk *chunk, ChunkDispatch *dispatch);
 extern void ts_chunk_insert_state_destroy(ChunkInsertState *state);
+extern void ts_chunk_insert_state_track_invalidation(ChunkInsertState *state, const Point *point);
+extern void ts_chunk_insert_state_buffer_tuple(ChunkInsertState *state, TupleTableSlot *slot);
+extern void ts_chunk_insert_state_flush_buffer(ChunkInsertState *state,
+											   TransitionCaptureState *transition_capture);
+extern void ts_chunk_insert_state_capture_tuples(ChunkInsertState *state,
+												 TransitionCaptureState *transition_capture,
+												 TupleTableSlot **slots, int nslots);
 
 OnConflictAction chunk_dispatch_get_on_conflict_action(const ChunkDispatch *dispatch);
 void ts_set_compression_status(ChunkInsertState *state, const Chunk *chunk);
@@ -27,6 +27,7 @@
 #include "guc.h"
 #include "hypertable_cache.h"
 #include "hypertable_modify.h"
+#include "last_point_cache.h"
 #include "nodes/chunk_append/chunk_append.h"
 #include "ts_catalog/hypertable_data_node.h"
 
@@ -131,6 +132,16 @@ hypertable_modify_begin(CustomScanState *node, EState *estate, int eflags)
 	node->custom_ps = list_make1(ps);
 	mtstate = castNode(ModifyTableState, ps);
 
+	/* The last point cache is only maintained by inserts. */
+	if (!(eflags & EXEC_FLAG_EXPLAIN_ONLY) &&
+		(mt->operation == CMD_DELETE || mt->operation == CMD_UPDATE
+#if PG15_GE
+		 || mt->operation == CMD_MERGE
+#endif
+		 ))
+		ts_last_point_cache_invalidate(
+			ts_hypertable_relid_to_id(exec_rt_fetch(mt->nominalRelation, estate)->relid));
+
 	/*
 	 * If this is not the primary ModifyTable node, postgres added it to the
 	 * beginning of es_auxmodifytables, to be executed by ExecPostprocessPlan.
@@ -983,7 +994,7 @@ ExecModifyTable(CustomScanState *cs_node, PlanState *pstate)
 				if (unlikely(!resultRelInfo->ri_projectNewInfoValid))
 					ExecInitInsertProjection(node, resultRelInfo);
 				slot = ExecGetInsertNewTuple(resultRelInfo, context.planSlot);
-				slot = ExecInsert(&context, cds->rri, slot, node->canSetTag);
+				slot = ExecInsert(&context, cds, cds->rri, slot, node->canSetTag);
 				break;
 			case CMD_UPDATE:
 				/* Initialize projection info if first time for this table */
@@ -1054,6 +1065,9 @@ ExecModifyTable(CustomScanState *cs_node, PlanState *pstate)
 	/*
 	 * Insert remaining tuples for batch insert.
 	 */
+	if (cds != NULL)
+		ts_chunk_dispatch_flush(cds->dispatch);
+
 	relinfos = estate->es_opened_result_relations;
 
 	if (ht_state->comp_chunks_processed)
@@ -1485,10 +1499,13 @@ ExecGetUpdateNewTuple(ResultRelInfo *relinfo, TupleTableSlot *planSlot, TupleTab
  * ----------------------------------------------------------------
  *
  * copied and modified version of ExecInsert from executor/nodeModifyTable.c
+ *
+ * When the ChunkDispatchState allows it, the tuple is buffered for a
+ * multi-insert into the chunk instead of being inserted right away.
  */
 TupleTableSlot *
-ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo, TupleTableSlot *slot,
-		   bool canSetTag)
+ExecInsert(ModifyTableContext *context, ChunkDispatchState *cds, ResultRelInfo *resultRelInfo,
+		   TupleTableSlot *slot, bool canSetTag)
 {
 	ModifyTableState *mtstate = context->mtstate;
 	EState *estate = context->estate;
@@ -1696,7 +1713,21 @@ ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo, TupleTable
 			 (resultRelInfo->ri_TrigDesc && resultRelInfo->ri_TrigDesc->trig_insert_before_row)))
 			ExecPartitionCheck(resultRelInfo, slot, estate, true);
 
-		if (onconflict != ONCONFLICT_NONE && resultRelInfo->ri_NumIndices > 0)
+		if (onconflict == ONCONFLICT_NOTHING && resultRelInfo->ri_NumIndices > 0 &&
+			ts_chunk_dispatch_can_buffer_tuple(cds, resultRelInfo) &&
+			cds->dispatch->prev_cis->batch_arbiter_index >= 0)
+		{
+			/*
+			 * Buffer the tuple for a multi-insert into the chunk. It is
+			 * checked against the arbiter index together with the other
+			 * buffered tuples when the buffer is flushed, and counted then if
+			 * it is inserted.
+			 */
+			Assert(cds->dispatch->prev_cis->result_relation_info == resultRelInfo);
+			ts_chunk_dispatch_buffer_tuple(cds->dispatch, cds->dispatch->prev_cis, slot);
+			return NULL;
+		}
+		else if (onconflict != ONCONFLICT_NONE && resultRelInfo->ri_NumIndices > 0)
 		{
 			/* Perform a speculative insertion. */
 			uint32 specToken;
@@ -1824,6 +1855,16 @@ ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo, TupleTable
 
 			/* Since there was no insertion conflict, we're done */
 		}
+		else if (ts_chunk_dispatch_can_buffer_tuple(cds, resultRelInfo))
+		{
+			/*
+			 * Buffer the tuple for a multi-insert into the chunk. The index
+			 * entries are inserted when the buffer is flushed, and there are
+			 * no AFTER ROW triggers to run.
+			 */
+			Assert(cds->dispatch->prev_cis->result_relation_info == resultRelInfo);
+			ts_chunk_dispatch_buffer_tuple(cds->dispatch, cds->dispatch->prev_cis, slot);
+		}
 		else
 		{
 			/* insert the tuple normally */
@@ -2498,6 +2539,18 @@ ExecCheckTIDVisible(EState *estate, ResultRelInfo *relinfo, ItemPointer tid,
 	ExecClearTuple(tempSlot);
 }
 
+/*
+ * Verify that the conflicting tuple of a tuple that INSERT ... ON CONFLICT DO
+ * NOTHING skips is visible, for the tuples that are checked against the
+ * arbiter index when they are flushed from the multi-insert buffer.
+ */
+void
+ts_hypertable_modify_check_conflict_visible(EState *estate, ResultRelInfo *relinfo,
+											ItemPointer tid)
+{
+	ExecCheckTIDVisible(estate, relinfo, tid, ExecGetReturningSlot(estate, relinfo));
+}
+
 /* ----------------------------------------------------------------
  *		ExecDelete
  *
@@ -38,8 +38,11 @@ extern Path *ts_hypertable_modify_path_create(PlannerInfo *root, ModifyTablePath
 extern List *ts_replace_rowid_vars(PlannerInfo *root, List *tlist, int varno);
 
 #if PG14_GE
-extern TupleTableSlot *ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo,
-								  TupleTableSlot *slot, bool canSetTag);
+extern TupleTableSlot *ExecInsert(ModifyTableContext *context, ChunkDispatchState *cds,
+								  ResultRelInfo *resultRelInfo, TupleTableSlot *slot,
+								  bool canSetTag);
+extern void ts_hypertable_modify_check_conflict_visible(EState *estate, ResultRelInfo *relinfo,
+														ItemPointer tid);
 #endif
 
 #endif /* TIMESCALEDB_HYPERTABLE_MODIFY_H */
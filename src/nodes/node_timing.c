@@ -0,0 +1,42 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <executor/instrument.h>
+
+#include "guc.h"
+#include "nodes/node_timing.h"
+
+/*
+ * Set up the timing when the node is initialized. The instrumentation of the
+ * node is allocated only after its initialization, so we look at the
+ * instrumentation options of the query instead.
+ */
+void
+ts_node_timing_init(TsNodeTiming *timing, EState *estate, const char *const *phase_names,
+					int num_phases)
+{
+	Assert(num_phases <= TS_NODE_TIMING_MAX_PHASES);
+
+	*timing = (TsNodeTiming){
+		.enabled = ts_guc_enable_node_timing && (estate->es_instrument & INSTRUMENT_TIMER) != 0,
+		.num_phases = num_phases,
+		.phase_names = phase_names,
+	};
+}
+
+void
+ts_node_timing_explain(const TsNodeTiming *timing, ExplainState *es)
+{
+	if (!timing->enabled || !es->analyze || !es->verbose || !es->timing)
+		return;
+
+	for (int i = 0; i < timing->num_phases; i++)
+		ExplainPropertyFloat(timing->phase_names[i],
+							 "ms",
+							 INSTR_TIME_GET_MILLISEC(timing->phase_time[i]),
+							 3,
+							 es);
+}
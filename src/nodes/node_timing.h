@@ -0,0 +1,57 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_NODES_NODE_TIMING_H
+#define TIMESCALEDB_NODES_NODE_TIMING_H
+
+#include <postgres.h>
+#include <commands/explain.h>
+#include <nodes/execnodes.h>
+#include <portability/instr_time.h>
+
+#include "export.h"
+
+#define TS_NODE_TIMING_MAX_PHASES 4
+
+/*
+ * The time spent in the internal phases of one of our custom nodes, for
+ * EXPLAIN (ANALYZE, VERBOSE). The timing is only enabled with the
+ * timescaledb.enable_node_timing setting and TIMING on, so that the clock is
+ * not read in the hot loops otherwise. The phases are named by the node, and
+ * the time of the child nodes is not included in them.
+ */
+typedef struct TsNodeTiming
+{
+	bool enabled;
+	int num_phases;
+	const char *const *phase_names;
+	instr_time phase_time[TS_NODE_TIMING_MAX_PHASES];
+} TsNodeTiming;
+
+extern TSDLLEXPORT void ts_node_timing_init(TsNodeTiming *timing, EState *estate,
+											const char *const *phase_names, int num_phases);
+extern TSDLLEXPORT void ts_node_timing_explain(const TsNodeTiming *timing, ExplainState *es);
+
+static inline void
+ts_node_timing_start(const TsNodeTiming *timing, instr_time *start)
+{
+	if (unlikely(timing->enabled))
+		INSTR_TIME_SET_CURRENT(*start);
+}
+
+static inline void
+ts_node_timing_stop(TsNodeTiming *timing, int phase, const instr_time *start)
+{
+	if (unlikely(timing->enabled))
+	{
+		instr_time end;
+
+		Assert(phase < timing->num_phases);
+		INSTR_TIME_SET_CURRENT(end);
+		INSTR_TIME_ACCUM_DIFF(timing->phase_time[phase], end, *start);
+	}
+}
+
+#endif /* TIMESCALEDB_NODES_NODE_TIMING_H */
@@ -8,6 +8,7 @@
 #include <access/htup_details.h>
 #include <catalog/namespace.h>
 #include <catalog/pg_type.h>
+#include <common/hashfn.h>
 #include <miscadmin.h>
 #include <nodes/makefuncs.h>
 #include <nodes/pg_list.h>
@@ -17,6 +18,7 @@
 #include <utils/cash.h>
 #include <utils/catcache.h>
 #include <utils/date.h>
+#include <utils/fmgroids.h>
 #include <utils/inet.h>
 #include <utils/jsonb.h>
 #include <utils/lsyscache.h>
@@ -208,6 +210,14 @@ ts_partitioning_info_create(const char *schema, const char *partfunc, const char
 
 		if (!OidIsValid(tce->hash_proc) && ts_partitioning_func_is_closed_default(schema, partfunc))
 			elog(ERROR, "could not find hash function for type %s", format_type_be(columntype));
+
+		if (ts_partitioning_func_is_closed_default(schema, partfunc) &&
+			(tce->hash_proc == F_HASHINT2 || tce->hash_proc == F_HASHINT4 ||
+			 tce->hash_proc == F_HASHINT8 || tce->hash_proc == F_HASHTEXT))
+		{
+			pinfo->partfunc.hash_proc = tce->hash_proc;
+			pinfo->partfunc.hash_collation = tce->typcollation;
+		}
 	}
 
 	partitioning_func_set_func_fmgr(&pinfo->partfunc, columntype, dimtype);
@@ -233,6 +243,48 @@ ts_partitioning_info_create(const char *schema, const char *partfunc, const char
 	return pinfo;
 }
 
+/*
+ * Compute the same hash as get_partition_hash() for the integer and text
+ * types, without the fmgr calls of the partitioning and the hash functions.
+ */
+static inline Datum
+partitioning_func_hash_direct(const PartitioningFunc *pf, Oid collation, Datum value)
+{
+	uint32 hash;
+
+	switch (pf->hash_proc)
+	{
+		case F_HASHINT2:
+			hash = hash_bytes_uint32((int32) DatumGetInt16(value));
+			break;
+		case F_HASHINT4:
+			hash = hash_bytes_uint32(DatumGetInt32(value));
+			break;
+		case F_HASHINT8:
+		{
+			/* The same as hashint8(), which is compatible with hashint4() */
+			int64 val = DatumGetInt64(value);
+			uint32 lohalf = (uint32) val;
+			uint32 hihalf = (uint32) (val >> 32);
+
+			lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+			hash = hash_bytes_uint32(lohalf);
+			break;
+		}
+		case F_HASHTEXT:
+			if (!OidIsValid(collation))
+				collation = pf->hash_collation;
+			hash = DatumGetUInt32(DirectFunctionCall1Coll(hashtext, collation, value));
+			break;
+		default:
+			pg_unreachable();
+			hash = 0;
+	}
+
+	/* Only positive numbers */
+	return Int32GetDatum((int32) (hash & 0x7fffffff));
+}
+
 /*
  * Apply a dimension's partitioning function to a value.
  *
@@ -245,6 +297,9 @@ ts_partitioning_func_apply(PartitioningInfo *pinfo, Oid collation, Datum value)
 	LOCAL_FCINFO(fcinfo, 1);
 	Datum result;
 
+	if (OidIsValid(pinfo->partfunc.hash_proc))
+		return partitioning_func_hash_direct(&pinfo->partfunc, collation, value);
+
 	InitFunctionCallInfoData(*fcinfo, &pinfo->partfunc.func_fmgr, 1, collation, NULL, NULL);
 
 	FC_SET_ARG(fcinfo, 0, value);
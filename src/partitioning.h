@@ -34,6 +34,14 @@ typedef struct PartitioningFunc
 	 * partitioning column's text representation.
 	 */
 	FmgrInfo func_fmgr;
+
+	/*
+	 * When the default partitioning function hashes an integer or text column,
+	 * the hash function of the column type, which we call directly instead of
+	 * going through fmgr for every value. InvalidOid otherwise.
+	 */
+	Oid hash_proc;
+	Oid hash_collation;
 } PartitioningFunc;
 
 typedef struct PartitioningInfo
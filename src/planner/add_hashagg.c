@@ -39,8 +39,8 @@
  * */
 
 #define GAPFILL_PATH_NAME "GapFill"
-static bool
-is_gapfill_path(Path *path)
+bool
+ts_is_gapfill_path(Path *path)
 {
 	if (IsA(path, CustomPath))
 	{
@@ -163,7 +163,7 @@ ts_plan_add_hashagg(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *output
 		return;
 
 	/* Don't add HashAgg path if this is a gapfill query */
-	if (is_gapfill_path(linitial(output_rel->pathlist)))
+	if (ts_is_gapfill_path(linitial(output_rel->pathlist)))
 		return;
 
 	MemSet(&agg_costs, 0, sizeof(AggClauseCosts));
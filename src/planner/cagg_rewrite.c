@@ -0,0 +1,360 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+/*
+ * Answer an aggregate query on a hypertable from a continuous aggregate.
+ *
+ * The query is rewritten when it groups the hypertable by exactly the same
+ * expressions as the definition of a real-time continuous aggregate, and all
+ * its aggregates are outputs of the continuous aggregate. Each row of the
+ * continuous aggregate is then one group of the query, so the hypertable is
+ * replaced by the view of the continuous aggregate, and the aggregates and
+ * the grouping expressions by its columns. The real-time view adds the
+ * aggregated tail of the hypertable above the watermark.
+ *
+ * Coarser groupings are not rewritten, since the finalized aggregates cannot
+ * be aggregated again in general.
+ */
+#include <postgres.h>
+#include <access/table.h>
+#include <catalog/pg_class.h>
+#include <nodes/makefuncs.h>
+#include <nodes/nodeFuncs.h>
+#include <optimizer/optimizer.h>
+#include <optimizer/tlist.h>
+#include <parser/parse_relation.h>
+#include <parser/parsetree.h>
+#include <rewrite/rewriteHandler.h>
+#include <rewrite/rewriteManip.h>
+#include <utils/acl.h>
+#include <utils/rel.h>
+
+#include "compat/compat.h"
+#include "hypertable.h"
+#include "hypertable_cache.h"
+#include "planner.h"
+#include "ts_catalog/continuous_agg.h"
+
+typedef struct CaggRewriteContext
+{
+	/* The range table index of the hypertable in the query */
+	Index rti;
+	/* The output expressions of the continuous aggregate and their columns */
+	List *exprs;
+	List *attnos;
+	bool failed;
+} CaggRewriteContext;
+
+/*
+ * Replace the expressions computed by the continuous aggregate with its
+ * columns. Anything else that depends on the rows of the hypertable cannot be
+ * computed from the continuous aggregate.
+ */
+static Node *
+cagg_rewrite_mutator(Node *node, CaggRewriteContext *context)
+{
+	ListCell *lc_expr;
+	ListCell *lc_attno;
+
+	if (node == NULL)
+		return NULL;
+
+	forboth (lc_expr, context->exprs, lc_attno, context->attnos)
+	{
+		Node *expr = lfirst(lc_expr);
+
+		if (equal(node, expr))
+			return (Node *) makeVar(context->rti,
+									lfirst_int(lc_attno),
+									exprType(expr),
+									exprTypmod(expr),
+									exprCollation(expr),
+									0);
+	}
+
+	if ((IsA(node, Var) && castNode(Var, node)->varlevelsup == 0) ||
+		(IsA(node, Aggref) && castNode(Aggref, node)->agglevelsup == 0) ||
+		(IsA(node, GroupingFunc) && castNode(GroupingFunc, node)->agglevelsup == 0))
+	{
+		context->failed = true;
+		return node;
+	}
+
+	return expression_tree_mutator(node, cagg_rewrite_mutator, context);
+}
+
+static List *
+get_group_exprs(Query *query)
+{
+	List *exprs = NIL;
+	ListCell *lc;
+
+	foreach (lc, query->groupClause)
+		exprs = lappend(exprs,
+						get_sortgroupclause_expr(lfirst_node(SortGroupClause, lc),
+												 query->targetList));
+
+	return exprs;
+}
+
+/* Check that each expression of the first list is in the second one */
+static bool
+exprs_contained_in(List *exprs, List *other)
+{
+	ListCell *lc;
+
+	foreach (lc, exprs)
+	{
+		if (!list_member(other, lfirst(lc)))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Check that the continuous aggregate computes the groups of the query, and
+ * collect its output expressions, with the Vars of the hypertable changed to
+ * the range table index of the query.
+ */
+static bool
+cagg_matches_query(ContinuousAgg *cagg, Query *query, RangeTblEntry *rte, Index rti,
+				   CaggRewriteContext *context)
+{
+	Query *cagg_query;
+	RangeTblRef *cagg_rtr;
+	RangeTblEntry *cagg_rte;
+	List *cagg_group_exprs;
+	List *group_exprs;
+	ListCell *lc;
+
+	/* The old format continuous aggregates have no view of the original query */
+	if (!ContinuousAggIsFinalized(cagg) || cagg->data.materialized_only)
+		return false;
+
+	cagg_query = ts_continuous_agg_get_query(cagg);
+
+	if (cagg_query->jointree->quals != NULL || cagg_query->havingQual != NULL ||
+		cagg_query->groupingSets != NIL || cagg_query->hasWindowFuncs ||
+		cagg_query->hasSubLinks || cagg_query->hasTargetSRFs || cagg_query->cteList != NIL ||
+		cagg_query->distinctClause != NIL || list_length(cagg_query->jointree->fromlist) != 1)
+		return false;
+
+	cagg_rtr = linitial(cagg_query->jointree->fromlist);
+	if (!IsA(cagg_rtr, RangeTblRef))
+		return false;
+
+	cagg_rte = rt_fetch(cagg_rtr->rtindex, cagg_query->rtable);
+	if (cagg_rte->rtekind != RTE_RELATION || cagg_rte->relid != rte->relid)
+		return false;
+
+	if (cagg_rtr->rtindex != (int) rti)
+		ChangeVarNodes((Node *) cagg_query, cagg_rtr->rtindex, rti, 0);
+
+	cagg_group_exprs = get_group_exprs(cagg_query);
+	group_exprs = get_group_exprs(query);
+
+	if (!exprs_contained_in(group_exprs, cagg_group_exprs) ||
+		!exprs_contained_in(cagg_group_exprs, group_exprs))
+		return false;
+
+	context->rti = rti;
+	context->exprs = NIL;
+	context->attnos = NIL;
+	context->failed = false;
+
+	foreach (lc, cagg_query->targetList)
+	{
+		TargetEntry *tle = lfirst_node(TargetEntry, lc);
+
+		if (tle->resjunk)
+			continue;
+
+		context->exprs = lappend(context->exprs, tle->expr);
+		context->attnos = lappend_int(context->attnos, tle->resno);
+	}
+
+	return true;
+}
+
+/*
+ * Replace the hypertable in the range table with the view of the continuous
+ * aggregate, expanded like the rewriter expands views.
+ *
+ * The hypertable stays in the range table, outside of the join tree, so that
+ * the permissions on it are still checked and the plan depends on it.
+ */
+static void
+cagg_replace_rte(Query *query, RangeTblEntry *rte, ContinuousAgg *cagg)
+{
+	RangeTblEntry *ht_rte;
+	Relation view_rel;
+	Query *view_query;
+	List *colnames = NIL;
+	Oid check_as_user;
+#if PG16_GE
+	RTEPermissionInfo *perminfo;
+#endif
+
+	view_rel = table_open(cagg->relid, AccessShareLock);
+	view_query = copyObject(get_view_query(view_rel));
+
+	for (int i = 0; i < RelationGetDescr(view_rel)->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(RelationGetDescr(view_rel), i);
+
+		colnames = lappend(colnames, makeString(pstrdup(NameStr(attr->attname))));
+	}
+
+	/* Keep the lock on the view until the end of the transaction */
+	table_close(view_rel, NoLock);
+	AcquireRewriteLocks(view_query, true, false);
+
+	ht_rte = copyObject(rte);
+	ht_rte->inh = false;
+	ht_rte->inFromCl = false;
+	query->rtable = lappend(query->rtable, ht_rte);
+
+#if PG16_LT
+	check_as_user = rte->checkAsUser;
+#else
+	check_as_user = getRTEPermissionInfo(query->rteperminfos, rte)->checkAsUser;
+#endif
+
+	rte->rtekind = RTE_SUBQUERY;
+	rte->subquery = view_query;
+	rte->security_barrier = false;
+	rte->inh = false;
+	rte->tablesample = NULL;
+	rte->eref = makeAlias(rte->eref->aliasname, colnames);
+
+#if PG16_LT
+	/*
+	 * The permissions on the view are checked on its OLD placeholder entry,
+	 * like for the views expanded by the rewriter.
+	 */
+	RangeTblEntry *old_rte = rt_fetch(PRS2_OLD_VARNO, view_query->rtable);
+
+	Assert(old_rte->relid == cagg->relid);
+	old_rte->requiredPerms = ACL_SELECT;
+	old_rte->checkAsUser = check_as_user;
+
+	rte->relid = InvalidOid;
+	rte->relkind = 0;
+	rte->rellockmode = 0;
+	rte->requiredPerms = 0;
+	rte->checkAsUser = InvalidOid;
+	rte->selectedCols = NULL;
+	rte->insertedCols = NULL;
+	rte->updatedCols = NULL;
+	rte->extraUpdatedCols = NULL;
+#else
+	/* The subquery entry of the view keeps the view for the permission checks */
+	rte->relid = cagg->relid;
+	rte->relkind = RELKIND_VIEW;
+	rte->rellockmode = AccessShareLock;
+	rte->perminfoindex = 0;
+	perminfo = addRTEPermissionInfo(&query->rteperminfos, rte);
+	perminfo->requiredPerms = ACL_SELECT;
+	perminfo->checkAsUser = check_as_user;
+#endif
+}
+
+static bool
+relation_has_row_security(Oid relid)
+{
+	Relation rel = table_open(relid, AccessShareLock);
+	bool result = rel->rd_rel->relrowsecurity;
+
+	table_close(rel, NoLock);
+	return result;
+}
+
+/*
+ * Rewrite an aggregate query on a hypertable to read a matching real-time
+ * continuous aggregate instead. Returns true if the query was rewritten.
+ */
+bool
+ts_cagg_rewrite_query(Query *query, Cache *hcache)
+{
+	CaggRewriteContext context;
+	RangeTblRef *rtr;
+	RangeTblEntry *rte;
+	Hypertable *ht;
+	ContinuousAgg *match = NULL;
+	List *tlist = NIL;
+	Node *having = NULL;
+	ListCell *lc;
+	Oid mat_relid;
+
+	if (query->commandType != CMD_SELECT || query->utilityStmt != NULL ||
+		query->groupClause == NIL || query->groupingSets != NIL || query->hasWindowFuncs ||
+		query->hasSubLinks || query->hasRecursive || query->hasModifyingCTE ||
+		query->hasForUpdate || query->rowMarks != NIL || query->setOperations != NULL ||
+		list_length(query->rtable) != 1 || query->jointree == NULL ||
+		query->jointree->quals != NULL || list_length(query->jointree->fromlist) != 1)
+		return false;
+
+	rtr = linitial(query->jointree->fromlist);
+	if (!IsA(rtr, RangeTblRef))
+		return false;
+
+	rte = rt_fetch(rtr->rtindex, query->rtable);
+	if (rte->rtekind != RTE_RELATION || !rte->inh || rte->tablesample != NULL ||
+		rte->securityQuals != NIL || (rte->alias != NULL && rte->alias->colnames != NIL))
+		return false;
+
+	ht = ts_hypertable_cache_get_entry(hcache, rte->relid, CACHE_FLAG_MISSING_OK);
+	if (ht == NULL || hypertable_is_distributed(ht))
+		return false;
+
+	foreach (lc, ts_continuous_aggs_find_by_raw_table_id(ht->fd.id))
+	{
+		ContinuousAgg *cagg = lfirst(lc);
+
+		if (!cagg_matches_query(cagg, query, rte, rtr->rtindex, &context))
+			continue;
+
+		tlist = (List *) cagg_rewrite_mutator((Node *) copyObject(query->targetList), &context);
+		having = cagg_rewrite_mutator(copyObject(query->havingQual), &context);
+
+		if (!context.failed)
+		{
+			match = cagg;
+			break;
+		}
+	}
+
+	if (match == NULL)
+		return false;
+
+	/*
+	 * The rewritten query would fail rather than fall back to the hypertable
+	 * when the user cannot read the continuous aggregate. The expanded view
+	 * would also not apply the row security policies of the materialized
+	 * hypertable, which the rewriter has already skipped.
+	 */
+	if (pg_class_aclcheck(match->relid, GetUserId(), ACL_SELECT) != ACLCHECK_OK)
+		return false;
+
+	mat_relid = ts_hypertable_id_to_relid(match->data.mat_hypertable_id, true);
+	if (!OidIsValid(mat_relid) || relation_has_row_security(mat_relid))
+		return false;
+
+	cagg_replace_rte(query, rte, match);
+
+	/* Each row of the continuous aggregate is one group of the query */
+	query->targetList = tlist;
+	query->groupClause = NIL;
+#if PG14_GE
+	query->groupDistinct = false;
+#endif
+	query->hasAggs = false;
+	query->havingQual = NULL;
+	query->jointree->quals = having;
+
+	return true;
+}
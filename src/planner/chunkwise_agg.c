@@ -0,0 +1,330 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <catalog/pg_type.h>
+#include <nodes/nodeFuncs.h>
+#include <optimizer/appendinfo.h>
+#include <optimizer/optimizer.h>
+#include <optimizer/pathnode.h>
+#include <optimizer/tlist.h>
+#include <utils/selfuncs.h>
+
+#include "compat/compat-msvc-enter.h"
+#include <optimizer/cost.h>
+#include "compat/compat-msvc-exit.h"
+
+#include "compat/compat.h"
+#include "dimension.h"
+#include "estimate.h"
+#include "func_cache.h"
+#include "guc.h"
+#include "hypertable.h"
+#include "import/planner.h"
+#include "planner.h"
+#include "utils.h"
+
+/*
+ * Chunk-wise aggregation
+ *
+ * A grouped aggregate over a hypertable normally aggregates the Append of all
+ * the chunks with one hash table that holds the groups of all the chunks. When
+ * the query groups by the space partitioning column or by a time bucket that
+ * is aligned to the chunk boundaries, most groups come from a single chunk, so
+ * we can instead aggregate each chunk partially with its own, much smaller
+ * hash table, and combine the partial results with a final aggregate:
+ *
+ *   Finalize HashAggregate
+ *     ->  Append
+ *           ->  Partial HashAggregate
+ *                 ->  Scan on chunk 1
+ *           ->  Partial HashAggregate
+ *                 ->  Scan on chunk 2
+ *
+ * This is the hypertable counterpart of the partitionwise aggregation that
+ * PostgreSQL does for declaratively partitioned tables. The path competes on
+ * cost with the other grouping paths.
+ */
+
+/*
+ * Check if a group by expression is the space partitioning column of the
+ * hypertable, the time column, or a time bucket of the time column whose
+ * width divides the chunk interval, so that the groups rarely span chunks.
+ */
+static bool
+is_chunk_dimension_group_expr(const Hypertable *ht, Index relid, Node *expr)
+{
+	for (int i = 0; i < ht->space->num_dimensions; i++)
+	{
+		const Dimension *dim = &ht->space->dimensions[i];
+
+		if (IsA(expr, Var))
+		{
+			Var *var = castNode(Var, expr);
+
+			if ((Index) var->varno == relid && var->varattno == dim->column_attno &&
+				dim->partitioning == NULL)
+				return true;
+		}
+		else if (IsA(expr, FuncExpr) && IS_OPEN_DIMENSION(dim) && dim->partitioning == NULL)
+		{
+			FuncExpr *func = castNode(FuncExpr, expr);
+			FuncInfo *finfo = ts_func_cache_get_bucketing_func(func->funcid);
+			Const *width;
+			Var *var;
+			int64 width_internal;
+
+			if (finfo == NULL || list_length(func->args) != 2 ||
+				!IsA(linitial(func->args), Const) || !IsA(lsecond(func->args), Var))
+				continue;
+
+			width = linitial_node(Const, func->args);
+			var = lsecond_node(Var, func->args);
+
+			if ((Index) var->varno != relid || var->varattno != dim->column_attno ||
+				width->constisnull)
+				continue;
+
+			if (width->consttype == INTERVALOID)
+			{
+				if (DatumGetIntervalP(width->constvalue)->month != 0)
+					continue;
+			}
+			else if (width->consttype != INT2OID && width->consttype != INT4OID &&
+					 width->consttype != INT8OID)
+				continue;
+
+			width_internal = ts_interval_value_to_internal(width->constvalue, width->consttype);
+
+			if (width_internal > 0 && width_internal <= dim->fd.interval_length &&
+				dim->fd.interval_length % width_internal == 0)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+static bool
+groups_by_chunk_dimension(PlannerInfo *root, const Hypertable *ht, RelOptInfo *rel)
+{
+	ListCell *lc;
+
+	foreach (lc, root->parse->groupClause)
+	{
+		SortGroupClause *sgc = lfirst_node(SortGroupClause, lc);
+		Node *expr = get_sortgroupclause_expr(sgc, root->processed_tlist);
+
+		if (is_chunk_dimension_group_expr(ht, rel->relid, expr))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Translate a target of the hypertable to a chunk, keeping the sort group
+ * references so that the aggregate of the chunk can find its grouping
+ * columns.
+ */
+static PathTarget *
+translate_target_to_chunk(PlannerInfo *root, PathTarget *target, RelOptInfo *chunk_rel)
+{
+	AppendRelInfo *appinfo = ts_get_appendrelinfo(root, chunk_rel->relid, false);
+	PathTarget *chunk_target = copy_pathtarget(target);
+
+	chunk_target->exprs =
+		castNode(List, adjust_appendrel_attrs(root, (Node *) chunk_target->exprs, 1, &appinfo));
+
+	return chunk_target;
+}
+
+/*
+ * Add the partial aggregation of one chunk. Returns NULL if the hash table of
+ * the chunk does not fit in work_mem.
+ */
+static Path *
+create_chunk_partial_agg_path(PlannerInfo *root, Path *chunk_path, PathTarget *scanjoin_target,
+							  PathTarget *partial_grouping_target,
+							  AggClauseCosts *agg_partial_costs)
+{
+	Query *parse = root->parse;
+	RelOptInfo *chunk_rel = chunk_path->parent;
+	PathTarget *chunk_scanjoin_target;
+	PathTarget *chunk_partial_target;
+	List *group_exprs;
+	double num_groups;
+	Path *path;
+
+	if (chunk_rel == NULL || !IS_SIMPLE_REL(chunk_rel) || chunk_path->param_info != NULL)
+		return NULL;
+
+	chunk_scanjoin_target = translate_target_to_chunk(root, scanjoin_target, chunk_rel);
+	chunk_partial_target = translate_target_to_chunk(root, partial_grouping_target, chunk_rel);
+
+	group_exprs = get_sortgrouplist_exprs(parse->groupClause,
+										  make_tlist_from_pathtarget(chunk_scanjoin_target));
+	num_groups = estimate_num_groups_compat(root, group_exprs, chunk_path->rows, NULL, NULL);
+
+	if (estimate_hashagg_tablesize_compat(root, chunk_path, agg_partial_costs, num_groups) >=
+		work_mem * UINT64CONST(1024))
+		return NULL;
+
+	path = (Path *) create_projection_path(root, chunk_rel, chunk_path, chunk_scanjoin_target);
+
+	return (Path *) create_agg_path(root,
+									chunk_rel,
+									path,
+									chunk_partial_target,
+									AGG_HASHED,
+									AGGSPLIT_INITIAL_SERIAL,
+									parse->groupClause,
+									NIL,
+									agg_partial_costs,
+									num_groups);
+}
+
+/*
+ * Add a grouping path that aggregates each chunk partially and combines the
+ * partial results with a final aggregate, if the query groups by a chunk
+ * dimension. This code is similar to the partitionwise aggregation in
+ * create_ordinary_grouping_paths.
+ */
+void
+ts_plan_add_chunkwise_agg(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *output_rel,
+						  const Hypertable *ht)
+{
+	Query *parse = root->parse;
+	Path *cheapest_path = input_rel->cheapest_total_path;
+	PathTarget *target = root->upper_targets[UPPERREL_GROUP_AGG];
+	PathTarget *scanjoin_target;
+	PathTarget *partial_grouping_target;
+	RelOptInfo *partially_grouped_rel;
+	AggClauseCosts agg_partial_costs;
+	AggClauseCosts agg_final_costs;
+	AppendPath *append;
+	List *partial_paths = NIL;
+	List *group_exprs;
+	double num_groups;
+	Path *path;
+	ListCell *lc;
+
+	if (!ts_guc_enable_chunkwise_aggregation || ht == NULL || hypertable_is_distributed(ht))
+		return;
+
+	if (parse->groupingSets || !parse->hasAggs || parse->groupClause == NIL)
+		return;
+
+	/* Don't add the path if this is a gapfill query */
+	if (output_rel->pathlist != NIL && ts_is_gapfill_path(linitial(output_rel->pathlist)))
+		return;
+
+	if (input_rel->reloptkind != RELOPT_BASEREL || cheapest_path == NULL ||
+		cheapest_path->param_info != NULL)
+		return;
+
+#if PG14_LT
+	MemSet(&agg_partial_costs, 0, sizeof(AggClauseCosts));
+	get_agg_clause_costs_compat(root,
+								(Node *) root->processed_tlist,
+								AGGSPLIT_SIMPLE,
+								&agg_partial_costs);
+	get_agg_clause_costs_compat(root, parse->havingQual, AGGSPLIT_SIMPLE, &agg_partial_costs);
+
+	if (agg_partial_costs.hasNonPartial || agg_partial_costs.hasNonSerial ||
+		agg_partial_costs.numOrderedAggs > 0)
+		return;
+#else
+	if (root->hasNonPartialAggs || root->hasNonSerialAggs || root->numOrderedAggs > 0)
+		return;
+#endif
+
+	if (!grouping_is_hashable(parse->groupClause) ||
+		!groups_by_chunk_dimension(root, ht, input_rel))
+		return;
+
+	/*
+	 * The scan target of the hypertable, with the group by expressions, is
+	 * either applied in place to the Append or with a projection on top of it.
+	 */
+	scanjoin_target = cheapest_path->pathtarget;
+	path = cheapest_path;
+	if (IsA(path, ProjectionPath))
+		path = castNode(ProjectionPath, path)->subpath;
+
+	if (!IsA(path, AppendPath))
+		return;
+
+	append = castNode(AppendPath, path);
+
+	if (append->path.parallel_aware || append->first_partial_path < list_length(append->subpaths) ||
+		list_length(append->subpaths) < 2)
+		return;
+
+	partial_grouping_target = ts_make_partial_grouping_target(root, target);
+
+	MemSet(&agg_partial_costs, 0, sizeof(AggClauseCosts));
+	MemSet(&agg_final_costs, 0, sizeof(AggClauseCosts));
+	get_agg_clause_costs_compat(root,
+								(Node *) partial_grouping_target->exprs,
+								AGGSPLIT_INITIAL_SERIAL,
+								&agg_partial_costs);
+	get_agg_clause_costs_compat(root,
+								(Node *) target->exprs,
+								AGGSPLIT_FINAL_DESERIAL,
+								&agg_final_costs);
+	get_agg_clause_costs_compat(root,
+								parse->havingQual,
+								AGGSPLIT_FINAL_DESERIAL,
+								&agg_final_costs);
+
+	foreach (lc, append->subpaths)
+	{
+		Path *chunk_agg_path = create_chunk_partial_agg_path(root,
+															 lfirst(lc),
+															 scanjoin_target,
+															 partial_grouping_target,
+															 &agg_partial_costs);
+
+		if (chunk_agg_path == NULL)
+			return;
+
+		partial_paths = lappend(partial_paths, chunk_agg_path);
+	}
+
+	partially_grouped_rel = fetch_upper_rel(root, UPPERREL_PARTIAL_GROUP_AGG, input_rel->relids);
+	partially_grouped_rel->reltarget = partial_grouping_target;
+
+	path = (Path *) create_append_path_compat(root,
+											  partially_grouped_rel,
+											  partial_paths,
+											  NIL,
+											  NIL,
+											  NULL,
+											  0,
+											  false,
+											  NIL,
+											  -1);
+
+	num_groups = ts_estimate_group(root, cheapest_path->rows);
+	if (!IS_VALID_ESTIMATE(num_groups))
+	{
+		group_exprs = get_sortgrouplist_exprs(parse->groupClause, root->processed_tlist);
+		num_groups =
+			estimate_num_groups_compat(root, group_exprs, cheapest_path->rows, NULL, NULL);
+	}
+
+	add_path(output_rel,
+			 (Path *) create_agg_path(root,
+									  output_rel,
+									  path,
+									  target,
+									  AGG_HASHED,
+									  AGGSPLIT_FINAL_DESERIAL,
+									  parse->groupClause,
+									  (List *) parse->havingQual,
+									  &agg_final_costs,
+									  num_groups));
+}
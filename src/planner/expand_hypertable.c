@@ -57,6 +57,7 @@
 #include "partitioning.h"
 #include "partialize.h"
 #include "planner.h"
+#include "planner_stats.h"
 #include "time_utils.h"
 
 typedef struct CollectQualCtx
@@ -1328,6 +1329,7 @@ ts_plan_expand_hypertable_chunks(Hypertable *ht, PlannerInfo *root, RelOptInfo *
 		.join_level = 0,
 	};
 	Index first_chunk_index = 0;
+	instr_time start;
 
 	/* double check our permissions are valid */
 	Assert(rti != (Index) parse->resultRelation);
@@ -1337,6 +1339,7 @@ ts_plan_expand_hypertable_chunks(Hypertable *ht, PlannerInfo *root, RelOptInfo *
 	if (oldrc && RowMarkRequiresRowShareLock(oldrc->markType))
 		elog(ERROR, "unexpected permissions requested");
 
+	ts_planner_stats_start(&start);
 	init_chunk_exclusion_func();
 
 	/* Walk the tree and find restrictions or chunk exclusion functions */
@@ -1349,11 +1352,15 @@ ts_plan_expand_hypertable_chunks(Hypertable *ht, PlannerInfo *root, RelOptInfo *
 	if (ctx.propagate_conditions != NIL)
 		propagate_join_quals(root, rel, &ctx);
 
+	ts_planner_stats_add(PLANNER_STATS_RESTRICTIONS, &start, list_length(ctx.restrictions));
+
 	Chunk **chunks = NULL;
 	unsigned int num_chunks = 0;
+	ts_planner_stats_start(&start);
 	chunks = get_chunks(&ctx, root, rel, ht, &num_chunks);
 	/* Can have zero chunks. */
 	Assert(num_chunks == 0 || chunks != NULL);
+	ts_planner_stats_add(PLANNER_STATS_CHUNK_SCAN, &start, num_chunks);
 
 	for (unsigned int i = 0; i < num_chunks; i++)
 	{
@@ -1370,6 +1377,7 @@ ts_plan_expand_hypertable_chunks(Hypertable *ht, PlannerInfo *root, RelOptInfo *
 	if (list_length(inh_oids) + list_length(ht->data_nodes) == 0)
 		return;
 
+	ts_planner_stats_start(&start);
 	oldrelation = table_open(parent_oid, NoLock);
 
 	/*
@@ -1510,6 +1518,8 @@ ts_plan_expand_hypertable_chunks(Hypertable *ht, PlannerInfo *root, RelOptInfo *
 		ts_get_private_reloptinfo(child_rel)->cached_chunk_struct = chunks[i];
 		Assert(chunks[i]->table_id == root->simple_rte_array[child_rtindex]->relid);
 	}
+
+	ts_planner_stats_add(PLANNER_STATS_CHUNK_RELS, &start, list_length(inh_oids));
 }
 
 void
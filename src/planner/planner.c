@@ -52,6 +52,7 @@
 #include "guc.h"
 #include "hypertable_cache.h"
 #include "import/allpaths.h"
+#include "last_point_cache.h"
 #include "license_guc.h"
 #include "nodes/chunk_append/chunk_append.h"
 #include "nodes/chunk_dispatch/chunk_dispatch.h"
@@ -59,6 +60,7 @@
 #include "nodes/hypertable_modify.h"
 #include "partitioning.h"
 #include "planner/planner.h"
+#include "planner/planner_stats.h"
 #include "utils.h"
 
 #include "compat/compat.h"
@@ -316,6 +318,10 @@ typedef struct
  * 3. Reordering of GROUP BY clauses for continuous aggregates.
  *
  * 4. Constifying now() expressions for primary time dimension.
+ *
+ * 5. Reading the latest rows of the series from the last point cache.
+ *
+ * 6. Reading the groups of aggregate queries from continuous aggregates.
  */
 static bool
 preprocess_query(Node *node, PreprocessQueryContext *context)
@@ -357,6 +363,14 @@ preprocess_query(Node *node, PreprocessQueryContext *context)
 		Index rti = 1;
 		bool ret;
 
+		/* Read the latest row of each series from the last point cache */
+		if (ts_guc_enable_optimizations && ts_guc_enable_last_point_cache && query->hasDistinctOn)
+			ts_last_point_cache_rewrite_query(query, hcache);
+
+		/* Read the groups from a matching continuous aggregate */
+		if (ts_guc_enable_optimizations && ts_guc_enable_cagg_rewrite && query->groupClause != NIL)
+			ts_cagg_rewrite_query(query, hcache);
+
 		foreach (lc, query->rtable)
 		{
 			RangeTblEntry *rte = lfirst_node(RangeTblEntry, lc);
@@ -588,6 +602,9 @@ timescaledb_planner(Query *parse, const char *query_string, int cursor_opts,
 					ts_hypertable_modify_fixup_tlist(subplan);
 			}
 
+			if (ts_cm_functions->tsl_postprocess_plan != NULL)
+				ts_cm_functions->tsl_postprocess_plan(stmt);
+
 			if (IsA(stmt->planTree, Agg))
 			{
 				Agg *agg = castNode(Agg, stmt->planTree);
@@ -1195,6 +1212,7 @@ timescaledb_set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, Index rti, Rang
 {
 	TsRelType reltype;
 	Hypertable *ht;
+	instr_time start;
 
 	/* Quick exit if this is a relation we're not interested in */
 	if (!valid_hook_call() || !OidIsValid(rte->relid) || IS_DUMMY_REL(rel))
@@ -1204,6 +1222,7 @@ timescaledb_set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, Index rti, Rang
 		return;
 	}
 
+	ts_planner_stats_start(&start);
 	reltype = classify_relation(root, rel, &ht);
 
 	/* Check for unexpanded hypertable */
@@ -1261,6 +1280,10 @@ timescaledb_set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, Index rti, Rang
 			apply_optimizations(root, reltype, rel, rte, ht);
 			break;
 	}
+
+	if (reltype == TS_REL_HYPERTABLE || reltype == TS_REL_CHUNK_CHILD ||
+		reltype == TS_REL_CHUNK_STANDALONE)
+		ts_planner_stats_add(PLANNER_STATS_CHUNK_PATHS, &start, reltype != TS_REL_HYPERTABLE);
 }
 
 /* This hook is meant to editorialize about the information the planner gets
@@ -1544,8 +1567,13 @@ timescaledb_create_upper_paths_hook(PlannerInfo *root, UpperRelationKind stage,
 	if (stage == UPPERREL_GROUP_AGG && output_rel != NULL)
 	{
 		if (!partials_found)
+		{
 			ts_plan_add_hashagg(root, input_rel, output_rel);
 
+			if (reltype == TS_REL_HYPERTABLE)
+				ts_plan_add_chunkwise_agg(root, input_rel, output_rel, ht);
+		}
+
 		if (parse->hasAggs)
 			ts_preprocess_first_last_aggregates(root, root->processed_tlist);
 	}
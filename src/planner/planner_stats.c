@@ -0,0 +1,129 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <utils/builtins.h>
+
+#include "planner_stats.h"
+
+#include "export.h"
+#include "guc.h"
+
+/*
+ * Backend-local counters and timings of the phases of planning hypertable
+ * queries, to tell where the planning time goes, e.g., when tuning the chunk
+ * interval for planning latency. Collecting them is enabled with the
+ * timescaledb.enable_planner_stats setting, and they are shown by
+ * _timescaledb_functions.planner_stats().
+ */
+typedef struct PlannerStatsCounter
+{
+	int64 calls;
+	int64 items;
+	instr_time time;
+} PlannerStatsCounter;
+
+static const char *planner_stats_phase_names[_PLANNER_STATS_PHASE_MAX] = {
+	[PLANNER_STATS_RESTRICTIONS] = "restrictions",
+	[PLANNER_STATS_CHUNK_SCAN] = "chunk_scan",
+	[PLANNER_STATS_CHUNK_RELS] = "chunk_rels",
+	[PLANNER_STATS_CHUNK_PATHS] = "chunk_paths",
+	[PLANNER_STATS_STARTUP_EXCLUSION] = "startup_exclusion",
+};
+
+static PlannerStatsCounter planner_stats[_PLANNER_STATS_PHASE_MAX];
+
+/*
+ * Start timing a phase. The start time stays zero when the stats are
+ * disabled, so that ts_planner_stats_add() ignores it.
+ */
+void
+ts_planner_stats_start(instr_time *start)
+{
+	if (ts_guc_enable_planner_stats)
+		INSTR_TIME_SET_CURRENT(*start);
+	else
+		INSTR_TIME_SET_ZERO(*start);
+}
+
+/*
+ * Add the time since start to a phase, together with the number of items,
+ * e.g. chunks, handled by it.
+ */
+void
+ts_planner_stats_add(PlannerStatsPhase phase, const instr_time *start, int64 items)
+{
+	instr_time duration;
+
+	Assert(phase >= 0 && phase < _PLANNER_STATS_PHASE_MAX);
+
+	if (!ts_guc_enable_planner_stats || INSTR_TIME_IS_ZERO(*start))
+		return;
+
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, *start);
+	INSTR_TIME_ADD(planner_stats[phase].time, duration);
+	planner_stats[phase].calls++;
+	planner_stats[phase].items += items;
+}
+
+TS_FUNCTION_INFO_V1(ts_planner_stats);
+TS_FUNCTION_INFO_V1(ts_planner_stats_reset);
+
+Datum
+ts_planner_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("function returning record called in context "
+							"that cannot accept type record")));
+
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+		funcctx->max_calls = _PLANNER_STATS_PHASE_MAX;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	if (funcctx->call_cntr < funcctx->max_calls)
+	{
+		const PlannerStatsCounter *counter = &planner_stats[funcctx->call_cntr];
+		Datum values[4];
+		bool nulls[4] = { false };
+		HeapTuple tuple;
+
+		values[0] = CStringGetTextDatum(planner_stats_phase_names[funcctx->call_cntr]);
+		values[1] = Int64GetDatum(counter->calls);
+		values[2] = Int64GetDatum(counter->items);
+		values[3] = Float8GetDatum(INSTR_TIME_GET_MILLISEC(counter->time));
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+Datum
+ts_planner_stats_reset(PG_FUNCTION_ARGS)
+{
+	memset(planner_stats, 0, sizeof(planner_stats));
+
+	PG_RETURN_VOID();
+}
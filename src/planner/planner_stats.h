@@ -0,0 +1,29 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_PLANNER_STATS_H
+#define TIMESCALEDB_PLANNER_STATS_H
+
+#include <postgres.h>
+#include <portability/instr_time.h>
+
+/*
+ * The phases of planning a hypertable query that we keep timings for. Keep
+ * the names in planner_stats.c in sync.
+ */
+typedef enum PlannerStatsPhase
+{
+	PLANNER_STATS_RESTRICTIONS = 0, /* collecting the restrictions of the query */
+	PLANNER_STATS_CHUNK_SCAN,		/* finding the matching chunks in the catalog */
+	PLANNER_STATS_CHUNK_RELS,		/* setting up the chunk relations */
+	PLANNER_STATS_CHUNK_PATHS,		/* creating our paths for chunks and hypertables */
+	PLANNER_STATS_STARTUP_EXCLUSION, /* ChunkAppend startup exclusion */
+	_PLANNER_STATS_PHASE_MAX,
+} PlannerStatsPhase;
+
+extern void ts_planner_stats_start(instr_time *start);
+extern void ts_planner_stats_add(PlannerStatsPhase phase, const instr_time *start, int64 items);
+
+#endif /* TIMESCALEDB_PLANNER_STATS_H */
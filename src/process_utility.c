@@ -51,6 +51,7 @@
 #include "ts_catalog/catalog.h"
 #include "chunk.h"
 #include "chunk_index.h"
+#include "ts_catalog/chunk_column_stats.h"
 #include "ts_catalog/chunk_data_node.h"
 #include "compat/compat.h"
 #include "copy.h"
@@ -60,6 +61,7 @@
 #include "hypercube.h"
 #include "hypertable.h"
 #include "hypertable_cache.h"
+#include "last_point_cache.h"
 #include "ts_catalog/hypertable_data_node.h"
 #include "dimension_vector.h"
 #include "indexing.h"
@@ -714,16 +716,15 @@ foreach_chunk(Hypertable *ht, process_chunk_t process_chunk, void *arg)
 	return n;
 }
 
-static int
-foreach_chunk_multitransaction(Oid relid, MemoryContext mctx, mt_process_chunk_t process_chunk,
-							   void *arg)
+/*
+ * Get the chunks of a hypertable in a separate transaction, in the given
+ * long-lived memory context. Returns false if the table is not a hypertable.
+ */
+static bool
+get_chunks_multitransaction(Oid relid, MemoryContext mctx, int32 *hypertable_id, List **chunks)
 {
 	Cache *hcache;
 	Hypertable *ht;
-	int32 hypertable_id;
-	List *chunks;
-	ListCell *lc;
-	int num_chunks = -1;
 
 	StartTransactionCommand();
 	MemoryContextSwitchTo(mctx);
@@ -734,15 +735,30 @@ foreach_chunk_multitransaction(Oid relid, MemoryContext mctx, mt_process_chunk_t
 	{
 		ts_cache_release(hcache);
 		CommitTransactionCommand();
-		return -1;
+		return false;
 	}
 
-	hypertable_id = ht->fd.id;
-	chunks = find_inheritance_children(ht->main_table_relid, NoLock);
+	*hypertable_id = ht->fd.id;
+	*chunks = find_inheritance_children(ht->main_table_relid, NoLock);
 
 	ts_cache_release(hcache);
 	CommitTransactionCommand();
 
+	return true;
+}
+
+static int
+foreach_chunk_multitransaction(Oid relid, MemoryContext mctx, mt_process_chunk_t process_chunk,
+							   void *arg)
+{
+	int32 hypertable_id;
+	List *chunks;
+	ListCell *lc;
+	int num_chunks = -1;
+
+	if (!get_chunks_multitransaction(relid, mctx, &hypertable_id, &chunks))
+		return -1;
+
 	num_chunks = list_length(chunks);
 	foreach (lc, chunks)
 	{
@@ -758,6 +774,8 @@ typedef struct VacuumCtx
 {
 	VacuumRelation *ht_vacuum_rel;
 	List *chunk_rels;
+	/* Chunks with compressed data, to compute their statistics after ANALYZE */
+	List *compressed_chunk_relids;
 } VacuumCtx;
 
 /* Adds a chunk to the list of tables to be vacuumed */
@@ -785,6 +803,10 @@ add_chunk_to_vacuum(Hypertable *ht, Oid chunk_relid, void *arg)
 		{
 			chunk_vacuum_rel = makeVacuumRelation(NULL, comp_chunk->table_id, NIL);
 			ctx->chunk_rels = lappend(ctx->chunk_rels, chunk_vacuum_rel);
+
+			if (ctx->ht_vacuum_rel->va_cols == NIL)
+				ctx->compressed_chunk_relids =
+					lappend_oid(ctx->compressed_chunk_relids, chunk_relid);
 		}
 	}
 }
@@ -851,6 +873,26 @@ ts_get_all_vacuum_rels(bool is_vacuumcmd)
 	return vacrels;
 }
 
+/* Whether a VACUUM or ANALYZE statement computes statistics */
+static bool
+vacuum_stmt_analyzes(const VacuumStmt *stmt)
+{
+	ListCell *lc;
+
+	if (!stmt->is_vacuumcmd)
+		return true;
+
+	foreach (lc, stmt->options)
+	{
+		DefElem *opt = lfirst_node(DefElem, lc);
+
+		if (strcmp(opt->defname, "analyze") == 0)
+			return defGetBoolean(opt);
+	}
+
+	return false;
+}
+
 /* Vacuums/Analyzes a hypertable and all of it's chunks */
 static DDLResult
 process_vacuum(ProcessUtilityArgs *args)
@@ -860,6 +902,7 @@ process_vacuum(ProcessUtilityArgs *args)
 	VacuumCtx ctx = {
 		.ht_vacuum_rel = NULL,
 		.chunk_rels = NIL,
+		.compressed_chunk_relids = NIL,
 	};
 	ListCell *lc;
 	Hypertable *ht;
@@ -920,6 +963,16 @@ process_vacuum(ProcessUtilityArgs *args)
 
 		/* ACL permission checks inside vacuum_rel and analyze_rel called by this ExecVacuum */
 		ExecVacuum(args->parse_state, stmt, is_toplevel);
+
+		/*
+		 * ANALYZE only sampled the uncompressed chunk tables, so compute the
+		 * statistics of the compressed chunks from their compressed data too.
+		 */
+		if (ts_cm_functions->analyze_compressed_chunk != NULL && vacuum_stmt_analyzes(stmt))
+		{
+			foreach (lc, ctx.compressed_chunk_relids)
+				ts_cm_functions->analyze_compressed_chunk(lfirst_oid(lc));
+		}
 	}
 	/*
 	Restore original list. stmt->rels which has references to
@@ -956,6 +1009,7 @@ handle_truncate_hypertable(ProcessUtilityArgs *args, TruncateStmt *stmt, Hyperta
 
 	/* Delete the metadata */
 	ts_chunk_delete_by_hypertable_id(ht->fd.id);
+	ts_last_point_cache_invalidate(ht->fd.id);
 
 	/* Drop the chunk tables */
 	foreach_chunk(ht, process_truncate_chunk, stmt);
@@ -2010,6 +2064,7 @@ process_rename_column(ProcessUtilityArgs *args, Cache *hcache, Oid relid, Rename
 
 		if (dim)
 			ts_dimension_set_name(dim, stmt->newname);
+		ts_chunk_column_stats_delete_by_column(ht, stmt->subname);
 		if (ts_cm_functions->process_rename_cmd)
 			ts_cm_functions->process_rename_cmd(relid, hcache, stmt);
 	}
@@ -2305,6 +2360,8 @@ process_altertable_drop_column(Hypertable *ht, AlterTableCmd *cmd)
 					 errdetail("Cannot drop column that is a hypertable partitioning (space or "
 							   "time) dimension.")));
 	}
+
+	ts_chunk_column_stats_delete_by_column(ht, cmd->name);
 }
 
 /* process all regular-table alter commands to make sure they aren't adding
@@ -2435,6 +2492,18 @@ typedef struct HypertableIndexOptions
 	bool multitransaction;
 	int n_ht_atts;
 
+	/*
+	 * The max number of background workers that create the chunk indexes in
+	 * the multi-transaction case. Zero creates them in this backend.
+	 */
+	int32 parallel_chunks;
+
+	/*
+	 * Skip the chunks that already have the index, because the background
+	 * workers have created it.
+	 */
+	bool skip_indexed_chunks;
+
 	/* Concurrency testing options. */
 #ifdef DEBUG
 	/*
@@ -2567,6 +2636,20 @@ process_index_chunk_multitransaction(int32 hypertable_id, Oid chunk_relid, void
 	chunk_rel = table_open(chunk_relid, ShareLock);
 	chunk = ts_chunk_get_by_relid(chunk_relid, true);
 
+	if (info->extended_options.skip_indexed_chunks && !IS_OSM_CHUNK(chunk))
+	{
+		ChunkIndexMapping cim;
+
+		if (ts_chunk_index_get_by_hypertable_indexrelid(chunk, info->obj.objectId, &cim))
+		{
+			table_close(chunk_rel, NoLock);
+			ts_catalog_restore_user(&sec_ctx);
+			PopActiveSnapshot();
+			CommitTransactionCommand();
+			return;
+		}
+	}
+
 	/*
 	 * Validation happens when creating the hypertable's index, which goes
 	 * through the usual DefineIndex mechanism.
@@ -2602,6 +2685,7 @@ process_index_chunk_multitransaction(int32 hypertable_id, Oid chunk_relid, void
 typedef enum HypertableIndexFlags
 {
 	HypertableIndexFlagMultiTransaction = 0,
+	HypertableIndexFlagParallelChunks,
 #ifdef DEBUG
 	HypertableIndexFlagBarrierTable,
 	HypertableIndexFlagMaxChunks,
@@ -2610,12 +2694,48 @@ typedef enum HypertableIndexFlags
 
 static const WithClauseDefinition index_with_clauses[] = {
 	[HypertableIndexFlagMultiTransaction] = {.arg_name = "transaction_per_chunk", .type_id = BOOLOID,},
+	[HypertableIndexFlagParallelChunks] = {.arg_name = "parallel_chunks", .type_id = INT4OID, .default_val = (Datum)0},
 #ifdef DEBUG
 	[HypertableIndexFlagBarrierTable] = {.arg_name = "barrier_table", .type_id = REGCLASSOID,},
 	[HypertableIndexFlagMaxChunks] = {.arg_name = "max_chunks", .type_id = INT4OID, .default_val = (Datum)-1},
 #endif
 };
 
+/*
+ * Start the background workers that create the chunk indexes, if requested.
+ * The chunks that they didn't index are then indexed by this backend, as
+ * usual.
+ */
+static void
+multitransaction_create_index_parallel(CreateIndexInfo *info)
+{
+	int32 hypertable_id;
+	List *chunks;
+
+	if (info->extended_options.parallel_chunks <= 0)
+		return;
+
+#ifdef DEBUG
+	/* The concurrency testing options need the chunks to be indexed here */
+	if (info->extended_options.max_chunks >= 0 ||
+		OidIsValid(info->extended_options.barrier_table))
+		return;
+#endif
+
+	if (!get_chunks_multitransaction(info->main_table_relid, info->mctx, &hypertable_id, &chunks))
+		return;
+
+	if (ts_chunk_index_create_parallel(hypertable_id,
+									   info->main_table_relid,
+									   info->obj.objectId,
+									   info->extended_options.n_ht_atts,
+									   chunks,
+									   info->extended_options.parallel_chunks) > 0)
+		info->extended_options.skip_indexed_chunks = true;
+
+	list_free(chunks);
+}
+
 static bool
 multitransaction_create_index_mark_valid(CreateIndexInfo info)
 {
@@ -2734,6 +2854,8 @@ process_index_start(ProcessUtilityArgs *args)
 
 	info.extended_options.multitransaction =
 		DatumGetBool(parsed_with_clauses[HypertableIndexFlagMultiTransaction].parsed);
+	info.extended_options.parallel_chunks =
+		DatumGetInt32(parsed_with_clauses[HypertableIndexFlagParallelChunks].parsed);
 #ifdef DEBUG
 	info.extended_options.max_chunks =
 		DatumGetInt32(parsed_with_clauses[HypertableIndexFlagMaxChunks].parsed);
@@ -2755,6 +2877,19 @@ process_index_start(ProcessUtilityArgs *args)
 				 errmsg(
 					 "cannot use timescaledb.transaction_per_chunk with UNIQUE or PRIMARY KEY")));
 
+	if (info.extended_options.parallel_chunks < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("timescaledb.parallel_chunks must not be negative")));
+
+	if (info.extended_options.parallel_chunks > 0 && !info.extended_options.multitransaction)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot use timescaledb.parallel_chunks without "
+						"timescaledb.transaction_per_chunk"),
+				 errhint("Create the chunk indexes in separate transactions with "
+						 "WITH (timescaledb.transaction_per_chunk).")));
+
 	if (info.extended_options.multitransaction && hypertable_is_distributed(ht))
 		ereport(ERROR,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
@@ -2805,6 +2940,9 @@ process_index_start(ProcessUtilityArgs *args)
 		return DDL_DONE;
 	}
 
+	if (ts_cm_functions->process_create_index)
+		ts_cm_functions->process_create_index(ht, stmt, root_table_index.objectId);
+
 	/* CREATE INDEX on the chunks, unless this is a distributed hypertable */
 	if (hypertable_is_distributed(ht))
 	{
@@ -2876,6 +3014,8 @@ process_index_start(ProcessUtilityArgs *args)
 	PopActiveSnapshot();
 	CommitTransactionCommand();
 
+	multitransaction_create_index_parallel(&info);
+
 	foreach_chunk_multitransaction(info.main_table_relid,
 								   info.mctx,
 								   process_index_chunk_multitransaction,
@@ -3994,12 +4134,17 @@ process_create_trigger_start(ProcessUtilityArgs *args)
 		return DDL_CONTINUE;
 	}
 
-	if (stmt->transitionRels)
+	/*
+	 * The row triggers are replicated on the chunks, where the transition
+	 * tables would only see the rows of one chunk. The statement triggers
+	 * stay on the hypertable, which collects the rows of all chunks.
+	 */
+	if (stmt->transitionRels && stmt->row)
 	{
 		ts_cache_release(hcache);
 		ereport(ERROR,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-				 errmsg("trigger with transition tables not supported on hypertables")));
+				 errmsg("ROW triggers with transition tables are not supported on hypertables")));
 	}
 
 	add_hypertable_to_process_args(args, ht);
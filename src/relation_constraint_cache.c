@@ -0,0 +1,203 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <nodes/makefuncs.h>
+#include <optimizer/optimizer.h>
+#include <utils/hsearch.h>
+#include <utils/memutils.h>
+#include <utils/rel.h>
+
+#include "relation_constraint_cache.h"
+#include "ts_catalog/chunk_column_stats.h"
+
+/*
+ * A backend-local cache of the CHECK and NOT NULL constraints of relations in
+ * the expression form used for constraint exclusion, keyed by the relation
+ * oid. The valid ranges of the tracked columns of a chunk, see
+ * chunk_column_stats.c, are included as constraints of the chunk.
+ *
+ * The relcache only keeps the CHECK constraints as node strings, so getting
+ * them means parsing and simplifying every expression again. Runtime chunk
+ * exclusion needs the constraints of every chunk on every execution, so we
+ * keep the processed expressions here instead. An entry is dropped on the
+ * relcache invalidation of its relation, see cache_invalidate.c.
+ */
+typedef struct RelationConstraintCacheEntry
+{
+	Oid relid;
+	MemoryContext mcxt;
+	List *constraints;
+} RelationConstraintCacheEntry;
+
+static MemoryContext cache_mcxt = NULL;
+static HTAB *cache_htab = NULL;
+static uint64 invalidation_count = 0;
+
+void
+ts_relation_constraint_cache_invalidate(Oid relid)
+{
+	invalidation_count++;
+
+	if (cache_htab == NULL)
+		return;
+
+	if (!OidIsValid(relid))
+	{
+		hash_destroy(cache_htab);
+		cache_htab = NULL;
+		MemoryContextReset(cache_mcxt);
+		return;
+	}
+
+	RelationConstraintCacheEntry *entry = hash_search(cache_htab, &relid, HASH_FIND, NULL);
+
+	if (entry != NULL)
+	{
+		MemoryContextDelete(entry->mcxt);
+		hash_search(cache_htab, &relid, HASH_REMOVE, NULL);
+	}
+}
+
+static void
+relation_constraint_cache_create(void)
+{
+	HASHCTL ctl = {
+		.keysize = sizeof(Oid),
+		.entrysize = sizeof(RelationConstraintCacheEntry),
+	};
+
+	if (cache_mcxt == NULL)
+		cache_mcxt = AllocSetContextCreate(CacheMemoryContext,
+										   "relation constraint cache",
+										   ALLOCSET_DEFAULT_SIZES);
+
+	ctl.hcxt = cache_mcxt;
+	cache_htab =
+		hash_create("relation constraint cache", 64, &ctl, HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+}
+
+/*
+ * Get the validated CHECK constraints and the NOT NULL constraints of the
+ * relation, with Vars of varno 1, in the same form as postgres
+ * get_relation_constraints.
+ */
+static List *
+relation_constraints_build(Relation relation)
+{
+	List *result = ts_chunk_column_stats_get_constraints(relation);
+	TupleConstr *constr = relation->rd_att->constr;
+
+	if (constr == NULL)
+		return result;
+
+	for (int i = 0; i < constr->num_check; i++)
+	{
+		Node *cexpr;
+
+		/*
+		 * If this constraint hasn't been fully validated yet, we must
+		 * ignore it here.
+		 */
+		if (!constr->check[i].ccvalid)
+			continue;
+
+		cexpr = stringToNode(constr->check[i].ccbin);
+
+		/*
+		 * Run each expression through const-simplification and
+		 * canonicalization.  This is not just an optimization, but is
+		 * necessary, because we will be comparing it to
+		 * similarly-processed qual clauses, and may fail to detect valid
+		 * matches without this.  This must match the processing done to
+		 * qual clauses in preprocess_expression()!  (We can skip the
+		 * stuff involving subqueries, however, since we don't allow any
+		 * in check constraints.)
+		 */
+		cexpr = eval_const_expressions(NULL, cexpr);
+		cexpr = (Node *) canonicalize_qual((Expr *) cexpr, true);
+
+		/*
+		 * Finally, convert to implicit-AND format (that is, a List) and
+		 * append the resulting item(s) to our output list.
+		 */
+		result = list_concat(result, make_ands_implicit((Expr *) cexpr));
+	}
+
+	/* Add NOT NULL constraints in expression form */
+	if (constr->has_not_null)
+	{
+		int natts = relation->rd_att->natts;
+
+		for (int i = 1; i <= natts; i++)
+		{
+			Form_pg_attribute att = TupleDescAttr(relation->rd_att, i - 1);
+
+			if (att->attnotnull && !att->attisdropped)
+			{
+				NullTest *ntest = makeNode(NullTest);
+
+				ntest->arg =
+					(Expr *) makeVar(1, i, att->atttypid, att->atttypmod, att->attcollation, 0);
+				ntest->nulltesttype = IS_NOT_NULL;
+
+				/*
+				 * argisrow=false is correct even for a composite column,
+				 * because attnotnull does not represent a SQL-spec IS NOT
+				 * NULL test in such a case, just IS DISTINCT FROM NULL.
+				 */
+				ntest->argisrow = false;
+				ntest->location = -1;
+				result = lappend(result, ntest);
+			}
+		}
+	}
+
+	return result;
+}
+
+/*
+ * Get a copy of the cached constraints of an opened relation, in the current
+ * memory context. The Vars of the constraints have varno 1.
+ */
+List *
+ts_relation_constraint_cache_get(Relation relation)
+{
+	Oid relid = RelationGetRelid(relation);
+	RelationConstraintCacheEntry *entry;
+	bool found;
+
+	if (cache_htab == NULL)
+		relation_constraint_cache_create();
+
+	entry = hash_search(cache_htab, &relid, HASH_FIND, &found);
+	if (found)
+		return copyObject(entry->constraints);
+
+	/*
+	 * Build the entry in its own context. If there was an invalidation while
+	 * we were building it, the result might be stale already, so we don't
+	 * cache it and it is freed with the current memory context.
+	 */
+	const uint64 count = invalidation_count;
+	MemoryContext entry_mcxt = AllocSetContextCreate(CurrentMemoryContext,
+													 "relation constraint cache entry",
+													 ALLOCSET_SMALL_SIZES);
+	MemoryContext old_mcxt = MemoryContextSwitchTo(entry_mcxt);
+	List *constraints = relation_constraints_build(relation);
+	MemoryContextSwitchTo(old_mcxt);
+
+	if (count == invalidation_count && cache_htab != NULL)
+	{
+		MemoryContextSetParent(entry_mcxt, cache_mcxt);
+		entry = hash_search(cache_htab, &relid, HASH_ENTER, &found);
+		Assert(!found);
+		entry->mcxt = entry_mcxt;
+		entry->constraints = constraints;
+		return copyObject(constraints);
+	}
+
+	return constraints;
+}
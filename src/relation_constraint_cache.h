@@ -0,0 +1,16 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_RELATION_CONSTRAINT_CACHE_H
+#define TIMESCALEDB_RELATION_CONSTRAINT_CACHE_H
+
+#include <postgres.h>
+#include <nodes/pg_list.h>
+#include <utils/relcache.h>
+
+extern List *ts_relation_constraint_cache_get(Relation relation);
+extern void ts_relation_constraint_cache_invalidate(Oid relid);
+
+#endif /* TIMESCALEDB_RELATION_CONSTRAINT_CACHE_H */
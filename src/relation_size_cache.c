@@ -0,0 +1,172 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <fmgr.h>
+#include <miscadmin.h>
+#include <utils/syscache.h>
+#include <utils/timestamp.h>
+
+#include "relation_size_cache.h"
+
+#include "guc.h"
+#include "loader/relation_size_cache.h"
+
+/*
+ * The sizes of the relations, shared by all backends, so that the size
+ * functions don't stat the files of every chunk, index and TOAST table each
+ * time they are called.
+ *
+ * The inserts mark the sizes of the chunks stale when they close them, and
+ * compression and decompression mark the sizes of both the chunk and its
+ * compressed chunk. The stale sizes are measured again when they are read.
+ * Any other change of the size, like by a vacuum, shows after at most
+ * timescaledb.relation_size_cache_ttl.
+ *
+ * The shared memory is allocated by the loader. With an older loader it is
+ * missing, and the sizes are measured on every call.
+ */
+static RelationSizeCacheRendezvous *
+relation_size_cache_get(void)
+{
+	static RelationSizeCacheRendezvous **rendezvous = NULL;
+
+	if (rendezvous == NULL)
+		rendezvous = (RelationSizeCacheRendezvous **) find_rendezvous_variable(
+			RENDEZVOUS_RELATION_SIZE_CACHE);
+
+	return *rendezvous;
+}
+
+/*
+ * Remove the entries that have expired, to make room for new ones. The
+ * entries of the dropped relations are only removed this way.
+ */
+static void
+relation_size_cache_remove_expired(RelationSizeCacheRendezvous *cache, TimestampTz now)
+{
+	HASH_SEQ_STATUS status;
+	RelationSizeCacheEntry *entry;
+
+	Assert(LWLockHeldByMeInMode(cache->lock, LW_EXCLUSIVE));
+
+	hash_seq_init(&status, cache->entries);
+	while ((entry = hash_seq_search(&status)) != NULL)
+	{
+		if (TimestampDifferenceExceeds(entry->measured, now, ts_guc_relation_size_cache_ttl))
+			hash_search(cache->entries, &entry->key, HASH_REMOVE, NULL);
+	}
+}
+
+/*
+ * Get the sizes of a relation, from the cache if they are fresh enough.
+ */
+RelationSize
+ts_relation_size_cached(Oid relid)
+{
+	RelationSizeCacheRendezvous *cache = relation_size_cache_get();
+	RelationSizeCacheKey key = { .dbid = MyDatabaseId, .relid = relid };
+	RelationSizeCacheEntry *entry;
+	RelationSize relsize = { 0 };
+	TimestampTz now;
+	bool found = false;
+
+	if (cache == NULL || ts_guc_relation_size_cache_ttl <= 0)
+		return ts_relation_size_impl(relid);
+
+	now = GetCurrentTimestamp();
+
+	LWLockAcquire(cache->lock, LW_SHARED);
+	entry = hash_search(cache->entries, &key, HASH_FIND, NULL);
+	if (entry != NULL && pg_atomic_read_u32(&entry->stale) == 0 &&
+		!TimestampDifferenceExceeds(entry->measured, now, ts_guc_relation_size_cache_ttl))
+	{
+		relsize.heap_size = entry->heap_size;
+		relsize.index_size = entry->index_size;
+		relsize.toast_size = entry->toast_size;
+		found = true;
+	}
+	LWLockRelease(cache->lock);
+
+	if (found)
+	{
+		relsize.total_size = relsize.heap_size + relsize.index_size + relsize.toast_size;
+		return relsize;
+	}
+
+	/* Measure the sizes without holding the lock, since it stats the files */
+	relsize = ts_relation_size_impl(relid);
+
+	/* Don't cache the zero sizes of a relation that does not exist */
+	if (!SearchSysCacheExists1(RELOID, ObjectIdGetDatum(relid)))
+		return relsize;
+
+	LWLockAcquire(cache->lock, LW_EXCLUSIVE);
+	entry = hash_search(cache->entries, &key, HASH_ENTER_NULL, &found);
+	if (entry == NULL)
+	{
+		relation_size_cache_remove_expired(cache, now);
+		entry = hash_search(cache->entries, &key, HASH_ENTER_NULL, &found);
+	}
+
+	if (entry != NULL)
+	{
+		entry->measured = now;
+		entry->heap_size = relsize.heap_size;
+		entry->index_size = relsize.index_size;
+		entry->toast_size = relsize.toast_size;
+
+		/*
+		 * The sizes were measured after the relation was marked stale, if it
+		 * was, but they might be stale again already if it was marked while
+		 * we measured. That is only fixed by the expiry.
+		 */
+		if (found)
+			pg_atomic_write_u32(&entry->stale, 0);
+		else
+			pg_atomic_init_u32(&entry->stale, 0);
+	}
+	LWLockRelease(cache->lock);
+
+	return relsize;
+}
+
+/*
+ * Mark the cached sizes of a relation stale, after it has changed. This only
+ * takes the shared lock, so that it is cheap enough for every insert.
+ */
+void
+ts_relation_size_cache_invalidate(Oid relid)
+{
+	RelationSizeCacheRendezvous *cache = relation_size_cache_get();
+	RelationSizeCacheKey key = { .dbid = MyDatabaseId, .relid = relid };
+	RelationSizeCacheEntry *entry;
+
+	if (cache == NULL)
+		return;
+
+	LWLockAcquire(cache->lock, LW_SHARED);
+	entry = hash_search(cache->entries, &key, HASH_FIND, NULL);
+	if (entry != NULL)
+		pg_atomic_write_u32(&entry->stale, 1);
+	LWLockRelease(cache->lock);
+}
+
+/*
+ * Remove the cached sizes of a relation that is dropped.
+ */
+void
+ts_relation_size_cache_remove(Oid relid)
+{
+	RelationSizeCacheRendezvous *cache = relation_size_cache_get();
+	RelationSizeCacheKey key = { .dbid = MyDatabaseId, .relid = relid };
+
+	if (cache == NULL)
+		return;
+
+	LWLockAcquire(cache->lock, LW_EXCLUSIVE);
+	hash_search(cache->entries, &key, HASH_REMOVE, NULL);
+	LWLockRelease(cache->lock);
+}
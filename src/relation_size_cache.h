@@ -0,0 +1,18 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_RELATION_SIZE_CACHE_H
+#define TIMESCALEDB_RELATION_SIZE_CACHE_H
+
+#include <postgres.h>
+
+#include "export.h"
+#include "utils.h"
+
+extern TSDLLEXPORT RelationSize ts_relation_size_cached(Oid relid);
+extern TSDLLEXPORT void ts_relation_size_cache_invalidate(Oid relid);
+extern void ts_relation_size_cache_remove(Oid relid);
+
+#endif /* TIMESCALEDB_RELATION_SIZE_CACHE_H */
@@ -4,6 +4,8 @@
  * LICENSE-APACHE for a copy of the license.
  */
 #include <postgres.h>
+#include <catalog/pg_collation.h>
+#include <catalog/pg_type.h>
 
 #include "scan_iterator.h"
 
@@ -53,6 +55,66 @@ ts_scan_iterator_scan_key_init(ScanIterator *iterator, AttrNumber attributeNumbe
 	MemoryContextSwitchTo(oldmcxt);
 }
 
+/*
+ * Initialize a scan key that matches any of the elements of the array, that
+ * is "attr = ANY(array)". This is only supported for index scans, where the
+ * btree index handles the array itself, so a batch of keys can be looked up
+ * in a single scan. The array has to live for the duration of the scan.
+ * Rescans can still change the array, like for any other key.
+ */
+TSDLLEXPORT void
+ts_scan_iterator_scan_key_init_array(ScanIterator *iterator, AttrNumber attributeNumber,
+									 StrategyNumber strategy, RegProcedure procedure,
+									 ArrayType *array)
+{
+	MemoryContext oldmcxt;
+
+	Assert(iterator->ctx.scankey == NULL || iterator->ctx.scankey == iterator->scankey);
+	Assert(iterator->ctx.index != InvalidOid);
+	iterator->ctx.scankey = iterator->scankey;
+
+	if (iterator->ctx.nkeys >= EMBEDDED_SCAN_KEY_SIZE)
+		elog(ERROR, "cannot scan more than %d keys", EMBEDDED_SCAN_KEY_SIZE);
+
+	oldmcxt = MemoryContextSwitchTo(iterator->ctx.internal.scan_mcxt);
+	ScanKeyEntryInitialize(&iterator->scankey[iterator->ctx.nkeys++],
+						   SK_SEARCHARRAY,
+						   attributeNumber,
+						   strategy,
+						   InvalidOid,
+						   C_COLLATION_OID,
+						   procedure,
+						   PointerGetDatum(array));
+	MemoryContextSwitchTo(oldmcxt);
+}
+
+/*
+ * Initialize a scan key that matches any of the given int4 ids, so that the
+ * rows for a batch of ids can be read in index order with a single scan
+ * instead of one scan (or rescan) per id.
+ */
+TSDLLEXPORT void
+ts_scan_iterator_scan_key_init_ids(ScanIterator *iterator, AttrNumber attributeNumber,
+								   const int32 *ids, int num_ids)
+{
+	MemoryContext oldmcxt = MemoryContextSwitchTo(iterator->ctx.internal.scan_mcxt);
+	Datum *elems = palloc(sizeof(Datum) * Max(num_ids, 1));
+	ArrayType *array;
+
+	for (int i = 0; i < num_ids; i++)
+		elems[i] = Int32GetDatum(ids[i]);
+
+	array = construct_array(elems, num_ids, INT4OID, sizeof(int32), true, TYPALIGN_INT);
+	pfree(elems);
+	MemoryContextSwitchTo(oldmcxt);
+
+	ts_scan_iterator_scan_key_init_array(iterator,
+										 attributeNumber,
+										 BTEqualStrategyNumber,
+										 F_INT4EQ,
+										 array);
+}
+
 TSDLLEXPORT void
 ts_scan_iterator_rescan(ScanIterator *iterator)
 {
@@ -7,6 +7,7 @@
 #define TIMESCALEDB_SCAN_ITERATOR_H
 
 #include <postgres.h>
+#include <utils/array.h>
 #include <utils/palloc.h>
 
 #include "scanner.h"
@@ -106,6 +107,13 @@ void TSDLLEXPORT ts_scan_iterator_close(ScanIterator *iterator);
 void TSDLLEXPORT ts_scan_iterator_scan_key_init(ScanIterator *iterator, AttrNumber attributeNumber,
 												StrategyNumber strategy, RegProcedure procedure,
 												Datum argument);
+void TSDLLEXPORT ts_scan_iterator_scan_key_init_array(ScanIterator *iterator,
+													  AttrNumber attributeNumber,
+													  StrategyNumber strategy,
+													  RegProcedure procedure, ArrayType *array);
+void TSDLLEXPORT ts_scan_iterator_scan_key_init_ids(ScanIterator *iterator,
+													AttrNumber attributeNumber, const int32 *ids,
+													int num_ids);
 
 /*
  * Reset the scan to use a new scan key.
@@ -47,6 +47,13 @@ table_scanner_open(ScannerCtx *ctx)
 static ScanDesc
 table_scanner_beginscan(ScannerCtx *ctx)
 {
+	/* Only index scans can handle array keys */
+	for (int i = 0; i < ctx->nkeys; i++)
+	{
+		if (ctx->scankey[i].sk_flags & SK_SEARCHARRAY)
+			elog(ERROR, "array scan keys are only supported for index scans");
+	}
+
 	ctx->internal.scan.table_scan =
 		table_beginscan(ctx->tablerel, ctx->snapshot, ctx->nkeys, ctx->scankey);
 
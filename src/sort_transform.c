@@ -4,13 +4,17 @@
  * LICENSE-APACHE for a copy of the license.
  */
 #include <postgres.h>
+#include <access/nbtree.h>
+#include <catalog/pg_am.h>
 #include <catalog/pg_type.h>
+#include <commands/defrem.h>
 #include <nodes/makefuncs.h>
 #include <nodes/nodeFuncs.h>
 #include <nodes/plannodes.h>
 #include <optimizer/paths.h>
 #include <optimizer/planner.h>
 #include <parser/parsetree.h>
+#include <utils/builtins.h>
 #include <utils/fmgroids.h>
 #include <utils/guc.h>
 #include <utils/lsyscache.h>
@@ -31,64 +35,132 @@
 
 extern void ts_sort_transform_optimization(PlannerInfo *root, RelOptInfo *rel);
 
-static Expr *
-transform_timestamp_cast(FuncExpr *func)
-{
-	/*
-	 * transform cast from timestamptz to timestamp
-	 *
-	 * timestamp(var) => var
-	 *
-	 * proof: timestamp(time1) >= timestamp(time2) iff time1 > time2
-	 *
-	 */
+static Expr *sort_transform_expr(Expr *orig_expr, bool *reversed);
 
-	Expr *first;
+/*
+ * Check that the field of date_part() or extract() is the epoch. The other
+ * fields like 'year' are monotonic in UTC only, and the rest are periodic.
+ */
+static bool
+date_part_is_epoch(FuncExpr *func)
+{
+	Const *field = linitial(func->args);
 
-	if (list_length(func->args) != 1)
-		return (Expr *) func;
+	return !field->constisnull &&
+		   pg_strcasecmp(TextDatumGetCString(field->constvalue), "epoch") == 0;
+}
 
-	first = ts_sort_transform_expr(linitial(func->args));
-	if (!IsA(first, Var))
-		return (Expr *) func;
+/*
+ * A built-in function that is monotonic in one of its arguments when the
+ * other arguments are constants, so that an ordering on this argument is also
+ * a valid ordering of the function result.
+ */
+typedef struct MonotonicFunc
+{
+	Oid funcid;
+	/* The argument the function is monotonic in. */
+	int arg;
+	/* The function is non-increasing rather than non-decreasing. */
+	bool decreasing;
+	/* Optional check of the constant arguments. */
+	bool (*check_args)(FuncExpr *func);
+} MonotonicFunc;
+
+static const MonotonicFunc monotonic_funcs[] = {
+#if PG14_LT
+	/* Casts to timestamp and timestamptz. */
+	{ .funcid = F_DATE_TIMESTAMP },
+	{ .funcid = F_TIMESTAMPTZ_TIMESTAMP },
+	{ .funcid = F_DATE_TIMESTAMPTZ },
+	{ .funcid = F_TIMESTAMP_TIMESTAMPTZ },
+	{ .funcid = F_FLOAT8_TIMESTAMPTZ },
+	/* Casts to date. */
+	{ .funcid = F_TIMESTAMP_DATE },
+	{ .funcid = F_TIMESTAMPTZ_DATE },
+	/* Widening integer and float casts. */
+	{ .funcid = F_I2TOI4 },
+	{ .funcid = F_INT28 },
+	{ .funcid = F_INT48 },
+	{ .funcid = F_I4TOD },
+	{ .funcid = F_I8TOD },
+	/* Epoch extraction. */
+	{ .funcid = F_TIMESTAMP_PART, .arg = 1, .check_args = date_part_is_epoch },
+	{ .funcid = F_TIMESTAMPTZ_PART, .arg = 1, .check_args = date_part_is_epoch },
+#else
+	{ .funcid = F_TIMESTAMP_DATE },
+	{ .funcid = F_TIMESTAMP_TIMESTAMPTZ },
+	{ .funcid = F_TIMESTAMPTZ_DATE },
+	{ .funcid = F_TIMESTAMPTZ_TIMESTAMP },
+	{ .funcid = F_TO_TIMESTAMP_FLOAT8 },
+	{ .funcid = F_DATE_TIMESTAMP },
+	{ .funcid = F_DATE_TIMESTAMPTZ },
+	{ .funcid = F_INT4_INT2 },
+	{ .funcid = F_INT8_INT2 },
+	{ .funcid = F_INT8_INT4 },
+	{ .funcid = F_FLOAT8_INT4 },
+	{ .funcid = F_FLOAT8_INT8 },
+	{ .funcid = F_DATE_PART_TEXT_TIMESTAMP, .arg = 1, .check_args = date_part_is_epoch },
+	{ .funcid = F_DATE_PART_TEXT_TIMESTAMPTZ, .arg = 1, .check_args = date_part_is_epoch },
+	{ .funcid = F_EXTRACT_TEXT_TIMESTAMP, .arg = 1, .check_args = date_part_is_epoch },
+	{ .funcid = F_EXTRACT_TEXT_TIMESTAMPTZ, .arg = 1, .check_args = date_part_is_epoch },
+#endif
+};
 
-	return (Expr *) copyObject(first);
+static const MonotonicFunc *
+get_monotonic_func(Oid funcid)
+{
+	for (size_t i = 0; i < lengthof(monotonic_funcs); i++)
+	{
+		if (monotonic_funcs[i].funcid == funcid)
+			return &monotonic_funcs[i];
+	}
+	return NULL;
 }
 
 static Expr *
-transform_timestamptz_cast(FuncExpr *func)
+transform_monotonic_func(FuncExpr *func, const MonotonicFunc *mf, bool *reversed)
 {
 	/*
-	 * Transform cast from date to timestamptz, or timestamp to timestamptz,
-	 * or abstime to timestamptz Handles only single-argument versions of the
-	 * cast to avoid explicit timezone specifiers
-	 *
+	 * transform a function that is monotonic in one argument
 	 *
-	 * timestamptz(var) => var
-	 *
-	 * proof: timestamptz(time1) >= timestamptz(time2) iff time1 > time2
+	 * func(const, var, const) => var
 	 *
+	 * proof: func(c, time1, c) >= func(c, time2, c) iff time1 > time2, or
+	 * the reverse for the decreasing functions
 	 */
+	ListCell *lc;
+	Expr *arg;
+	bool arg_reversed = false;
 
-	Expr *first;
+	if (list_length(func->args) <= mf->arg)
+		return (Expr *) func;
+
+	foreach (lc, func->args)
+	{
+		if (foreach_current_index(lc) != mf->arg && !IsA(lfirst(lc), Const))
+			return (Expr *) func;
+	}
 
-	if (list_length(func->args) != 1)
+	if (mf->check_args != NULL && !mf->check_args(func))
 		return (Expr *) func;
 
-	first = ts_sort_transform_expr(linitial(func->args));
-	if (!IsA(first, Var))
+	arg = sort_transform_expr(list_nth(func->args, mf->arg), &arg_reversed);
+	if (!IsA(arg, Var))
 		return (Expr *) func;
 
-	return (Expr *) copyObject(first);
+	*reversed = arg_reversed != mf->decreasing;
+	return (Expr *) copyObject(arg);
 }
 
 static inline Expr *
-transform_time_op_const_interval(OpExpr *op)
+transform_time_op_const_interval(OpExpr *op, bool *reversed)
 {
 	/*
 	 * optimize timestamp(tz) +/- const interval
 	 *
 	 * Sort of ts + 1 minute fulfilled by sort of ts
+	 *
+	 * and const timestamp(tz) - timestamp(tz), which reverses the sort
 	 */
 	if (list_length(op->args) == 2 && IsA(lsecond(op->args), Const))
 	{
@@ -103,29 +175,76 @@ transform_time_op_const_interval(OpExpr *op)
 
 			if (strncmp(name, "-", NAMEDATALEN) == 0 || strncmp(name, "+", NAMEDATALEN) == 0)
 			{
-				Expr *first = ts_sort_transform_expr((Expr *) linitial(op->args));
+				Expr *first = sort_transform_expr((Expr *) linitial(op->args), reversed);
 
 				if (IsA(first, Var))
 					return copyObject(first);
 			}
 		}
 	}
+	else if (list_length(op->args) == 2 && IsA(linitial(op->args), Const) &&
+			 exprType((Node *) linitial(op->args)) == exprType((Node *) lsecond(op->args)))
+	{
+		char *name = get_opname(op->opno);
+
+		if (strncmp(name, "-", NAMEDATALEN) == 0)
+		{
+			Expr *second = sort_transform_expr((Expr *) lsecond(op->args), reversed);
+
+			if (IsA(second, Var))
+			{
+				*reversed = !*reversed;
+				return copyObject(second);
+			}
+		}
+	}
 	return (Expr *) op;
 }
 
+static int64
+int_const_get_value(Const *c)
+{
+	switch (c->consttype)
+	{
+		case INT2OID:
+			return DatumGetInt16(c->constvalue);
+		case INT4OID:
+			return DatumGetInt32(c->constvalue);
+		default:
+			Assert(c->consttype == INT8OID);
+			return DatumGetInt64(c->constvalue);
+	}
+}
+
 static inline Expr *
-transform_int_op_const(OpExpr *op)
+transform_int_op_const(OpExpr *op, bool *reversed)
 {
 	/*
 	 * Optimize int op const (or const op int), whenever possible. e.g. sort
 	 * of  some_int + const fulfilled by sort of some_int same for the
 	 * following operator: + - / *
 	 *
-	 * Note that / is not commutative and const / var does NOT work (namely it
-	 * reverses sort order, which we don't handle yet)
+	 * Note that / is not commutative and const / var does NOT work, and that
+	 * const - var, multiplication and division by a negative const, and the
+	 * unary minus reverse the sort order.
 	 */
-	if (list_length(op->args) == 2 &&
-		(IsA(lsecond(op->args), Const) || IsA(linitial(op->args), Const)))
+	if (list_length(op->args) == 1)
+	{
+		char *name = get_opname(op->opno);
+
+		if (strncmp(name, "-", NAMEDATALEN) == 0)
+		{
+			Expr *arg = sort_transform_expr((Expr *) linitial(op->args), reversed);
+
+			if (IsA(arg, Var))
+			{
+				*reversed = !*reversed;
+				return copyObject(arg);
+			}
+		}
+	}
+	else if (list_length(op->args) == 2 &&
+			 (IsA(lsecond(op->args), Const) || IsA(linitial(op->args), Const)))
 	{
 		Oid left = exprType((Node *) linitial(op->args));
 		Oid right = exprType((Node *) lsecond(op->args));
@@ -134,70 +253,61 @@ transform_int_op_const(OpExpr *op)
 			(left == INT2OID && right == INT2OID))
 		{
 			char *name = get_opname(op->opno);
+			const bool const_first = IsA(linitial(op->args), Const);
+			Const *c = const_first ? linitial(op->args) : lsecond(op->args);
+			Expr *nonconst = const_first ? lsecond(op->args) : linitial(op->args);
+			bool reverse_op;
+
+			if (name[1] != '\0' || c->constisnull)
+				return (Expr *) op;
 
-			if (name[1] == '\0')
+			switch (name[0])
 			{
-				switch (name[0])
-				{
-					case '-':
-					case '+':
-					case '*':
-						/* commutative cases */
-						if (IsA(linitial(op->args), Const))
-						{
-							Expr *nonconst = ts_sort_transform_expr((Expr *) lsecond(op->args));
-
-							if (IsA(nonconst, Var))
-								return copyObject(nonconst);
-						}
-						else
-						{
-							Expr *nonconst = ts_sort_transform_expr((Expr *) linitial(op->args));
-
-							if (IsA(nonconst, Var))
-								return copyObject(nonconst);
-						}
-						break;
-					case '/':
-						/* only if second arg is const */
-						if (IsA(lsecond(op->args), Const))
-						{
-							Expr *nonconst = ts_sort_transform_expr((Expr *) linitial(op->args));
-
-							if (IsA(nonconst, Var))
-								return copyObject(nonconst);
-						}
-						break;
-				}
+				case '+':
+					reverse_op = false;
+					break;
+				case '-':
+					reverse_op = const_first;
+					break;
+				case '*':
+					reverse_op = int_const_get_value(c) < 0;
+					break;
+				case '/':
+					/* only if second arg is const */
+					if (const_first)
+						return (Expr *) op;
+					reverse_op = int_const_get_value(c) < 0;
+					break;
+				default:
+					return (Expr *) op;
+			}
+
+			nonconst = sort_transform_expr(nonconst, reversed);
+			if (IsA(nonconst, Var))
+			{
+				*reversed = *reversed != reverse_op;
+				return copyObject(nonconst);
 			}
 		}
 	}
 	return (Expr *) op;
 }
 
-/* sort_transforms_expr returns a simplified sort expression in a form
- * more common for indexes. Must return same data type & collation too.
- *
- * Sort transforms have the following correctness condition:
- *	Any ordering provided by the returned expression is a valid
- *	ordering under the original expression. The reverse need not
- *	be true to apply the transformation to the last member of pathkeys
- *	but it would need to be true to apply the transformation to
- *	arbitrary members of pathkeys.
- *
- * Namely if orig_expr(X) > orig_expr(Y) then
- *			 new_expr(X) > new_expr(Y).
- *
- * Note that if orig_expr(X) = orig_expr(Y) then
- *			 the ordering under new_expr is unconstrained.
- * */
-Expr *
-ts_sort_transform_expr(Expr *orig_expr)
+/*
+ * sort_transform_expr returns a simplified sort expression in a form more
+ * common for indexes, and sets reversed if the order of the simplified
+ * expression is the reverse of the original one.
+ */
+static Expr *
+sort_transform_expr(Expr *orig_expr, bool *reversed)
 {
+	*reversed = false;
+
 	if (IsA(orig_expr, FuncExpr))
 	{
 		FuncExpr *func = (FuncExpr *) orig_expr;
 		FuncInfo *finfo = ts_func_cache_get_bucketing_func(func->funcid);
+		const MonotonicFunc *mf;
 
 		if (NULL != finfo)
 		{
@@ -207,24 +317,9 @@ ts_sort_transform_expr(Expr *orig_expr)
 			return finfo->sort_transform(func);
 		}
 
-		/* Functions of one argument that convert something to timestamp(tz). */
-#if PG14_LT
-		if (func->funcid == F_DATE_TIMESTAMP || func->funcid == F_TIMESTAMPTZ_TIMESTAMP)
-#else
-		if (func->funcid == F_TIMESTAMP_DATE || func->funcid == F_TIMESTAMP_TIMESTAMPTZ)
-#endif
-		{
-			return transform_timestamp_cast(func);
-		}
-
-#if PG14_LT
-		if (func->funcid == F_DATE_TIMESTAMPTZ || func->funcid == F_TIMESTAMP_TIMESTAMPTZ)
-#else
-		if (func->funcid == F_TIMESTAMPTZ_DATE || func->funcid == F_TIMESTAMPTZ_TIMESTAMP)
-#endif
-		{
-			return transform_timestamptz_cast(func);
-		}
+		mf = get_monotonic_func(func->funcid);
+		if (NULL != mf)
+			return transform_monotonic_func(func, mf, reversed);
 	}
 	if (IsA(orig_expr, OpExpr))
 	{
@@ -233,22 +328,92 @@ ts_sort_transform_expr(Expr *orig_expr)
 
 		if (type_first == TIMESTAMPOID || type_first == TIMESTAMPTZOID || type_first == DATEOID)
 		{
-			return transform_time_op_const_interval(op);
+			return transform_time_op_const_interval(op, reversed);
 		}
 		if (type_first == INT2OID || type_first == INT4OID || type_first == INT8OID)
 		{
-			return transform_int_op_const(op);
+			return transform_int_op_const(op, reversed);
 		}
 	}
 	return orig_expr;
 }
 
+/* sort_transforms_expr returns a simplified sort expression in a form
+ * more common for indexes. Must return same data type & collation too.
+ *
+ * Sort transforms have the following correctness condition:
+ *	Any ordering provided by the returned expression is a valid
+ *	ordering under the original expression. The reverse need not
+ *	be true to apply the transformation to the last member of pathkeys
+ *	but it would need to be true to apply the transformation to
+ *	arbitrary members of pathkeys.
+ *
+ * Namely if orig_expr(X) > orig_expr(Y) then
+ *			 new_expr(X) > new_expr(Y).
+ *
+ * Note that if orig_expr(X) = orig_expr(Y) then
+ *			 the ordering under new_expr is unconstrained.
+ *
+ * The transformations that reverse the order are not applied here.
+ * */
+Expr *
+ts_sort_transform_expr(Expr *orig_expr)
+{
+	bool reversed;
+	Expr *transformed = sort_transform_expr(orig_expr, &reversed);
+
+	return reversed ? orig_expr : transformed;
+}
+
+/*
+ * Check that the reversed transformed expression is a NOT NULL column, so
+ * that we don't have to care where the nulls go in the reversed order.
+ */
+static bool
+can_reverse_sort(PlannerInfo *root, Expr *transformed)
+{
+	Var *var = castNode(Var, transformed);
+	RangeTblEntry *rte;
+
+	if (var->varattno <= 0 || var->varlevelsup != 0 || IS_SPECIAL_VARNO(var->varno) ||
+		(int) var->varno >= root->simple_rel_array_size)
+		return false;
+
+	rte = planner_rt_fetch(var->varno, root);
+	return rte->rtekind == RTE_RELATION && get_attnotnull(rte->relid, var->varattno);
+}
+
+/*
+ * Get the btree opfamily for sorting on the transformed expression. This is
+ * the opfamily of the original sort if it supports the type of the transformed
+ * expression, like it does for the casts between the datetime types, and the
+ * default btree opfamily of the type otherwise, e.g. for the epoch extraction.
+ */
+static Oid
+get_transformed_opfamily(Oid orig_opfamily, Oid type_oid)
+{
+	Oid opclass;
+
+	if (OidIsValid(get_opfamily_member(orig_opfamily, type_oid, type_oid, BTLessStrategyNumber)))
+		return orig_opfamily;
+
+	opclass = GetDefaultOpClass(type_oid, BTREE_AM_OID);
+	if (!OidIsValid(opclass))
+		return InvalidOid;
+
+	return get_opclass_family(opclass);
+}
+
 /*	sort_transform_ec creates a new EquivalenceClass with transformed
  *	expressions if any of the members of the original EC can be transformed for the sort.
+ *	All members of the new EC are transformed in the same direction, which is
+ *	returned in reversed, and are sorted with the same opfamily, which is
+ *	returned in opfamily.
  */
 
 static EquivalenceClass *
-sort_transform_ec(PlannerInfo *root, EquivalenceClass *orig)
+sort_transform_ec(PlannerInfo *root, EquivalenceClass *orig, Oid orig_opfamily, Oid *opfamily,
+				  bool *reversed)
 {
 	ListCell *lc_member;
 	EquivalenceClass *newec = NULL;
@@ -258,13 +423,25 @@ sort_transform_ec(PlannerInfo *root, EquivalenceClass *orig)
 	foreach (lc_member, orig->ec_members)
 	{
 		EquivalenceMember *ec_mem = (EquivalenceMember *) lfirst(lc_member);
-		Expr *transformed_expr = ts_sort_transform_expr(ec_mem->em_expr);
+		bool member_reversed;
+		Expr *transformed_expr = sort_transform_expr(ec_mem->em_expr, &member_reversed);
+		Oid type_oid;
+		Oid member_opfamily;
+
+		if (transformed_expr == ec_mem->em_expr ||
+			(member_reversed && !can_reverse_sort(root, transformed_expr)))
+			continue;
 
-		if (transformed_expr != ec_mem->em_expr)
+		type_oid = exprType((Node *) transformed_expr);
+		member_opfamily = get_transformed_opfamily(orig_opfamily, type_oid);
+
+		if (OidIsValid(member_opfamily) &&
+			(newec == NULL || (member_reversed == *reversed && member_opfamily == *opfamily)))
 		{
 			EquivalenceMember *em;
-			Oid type_oid = exprType((Node *) transformed_expr);
-			List *opfamilies = list_copy(orig->ec_opfamilies);
+			List *opfamilies = member_opfamily == orig_opfamily ?
+								   list_copy(orig->ec_opfamilies) :
+								   list_make1_oid(member_opfamily);
 
 			/*
 			 * if the transform already exists for even one member, assume
@@ -282,6 +459,8 @@ sort_transform_ec(PlannerInfo *root, EquivalenceClass *orig)
 
 			if (exist != NULL)
 			{
+				*reversed = member_reversed;
+				*opfamily = member_opfamily;
 				return exist;
 			}
 
@@ -296,6 +475,9 @@ sort_transform_ec(PlannerInfo *root, EquivalenceClass *orig)
 
 			if (newec == NULL)
 			{
+				*reversed = member_reversed;
+				*opfamily = member_opfamily;
+
 				/* lazy create the ec. */
 				newec = makeNode(EquivalenceClass);
 				newec->ec_opfamilies = opfamilies;
@@ -387,6 +569,8 @@ ts_sort_transform_optimization(PlannerInfo *root, RelOptInfo *rel)
 	PathKey *last_pk;
 	PathKey *new_pk;
 	EquivalenceClass *transformed;
+	bool reversed = false;
+	Oid opfamily = InvalidOid;
 
 	/*
 	 * nothing to do for empty pathkeys
@@ -400,16 +584,23 @@ ts_sort_transform_optimization(PlannerInfo *root, RelOptInfo *rel)
 	 * Using it for other ORDER BY clauses will result in wrong ordering.
 	 */
 	last_pk = llast(root->query_pathkeys);
-	transformed = sort_transform_ec(root, last_pk->pk_eclass);
+	transformed =
+		sort_transform_ec(root, last_pk->pk_eclass, last_pk->pk_opfamily, &opfamily, &reversed);
 
 	if (transformed == NULL)
 		return;
 
+	/*
+	 * The reversed transform is only done for NOT NULL columns, so we can
+	 * also put the nulls at the other end to match the backward index scans.
+	 */
 	new_pk = make_canonical_pathkey(root,
 									transformed,
-									last_pk->pk_opfamily,
-									last_pk->pk_strategy,
-									last_pk->pk_nulls_first);
+									opfamily,
+									reversed ? BTCommuteStrategyNumber(last_pk->pk_strategy) :
+											   last_pk->pk_strategy,
+									reversed ? !last_pk->pk_nulls_first :
+											   last_pk->pk_nulls_first);
 
 	/*
 	 * create complete transformed pathkeys
@@ -8,22 +8,50 @@
 
 #include "dimension.h"
 #include "dimension_slice.h"
-#include "dimension_vector.h"
 #include "hypercube.h"
 #include "subspace_store.h"
 
 /*
  * In terms of datastructures, the subspace store is actually a tree. At the
- * root of a tree is a DimensionVec representing the different DimensionSlices
- * for the first dimension. Each of the DimensionSlices of the
- * first dimension point to a DimensionVec of the second dimension. This recurses
- * for the N dimensions. The leaf DimensionSlice points to the data being stored.
+ * root of a tree is an internal node holding the ranges of the different
+ * DimensionSlices for the first dimension. Each of the ranges of the first
+ * dimension points to an internal node for the second dimension. This recurses
+ * for the N dimensions. The entries of the leaf nodes point to the data being
+ * stored.
  *
- * */
+ * Each node keeps the ranges in flat arrays sorted by the range start, so that
+ * a lookup is a binary search over contiguous memory instead of chasing the
+ * pointers to separately allocated slices.
+ *
+ * When the store is full, we evict a single stored object, the one with the
+ * highest eviction score. By default, this is the object that was not used for
+ * the longest time relative to the cost of recreating it.
+ */
+
+#define SUBSPACE_STORE_NODE_DEFAULT_SIZE 10
+
+typedef struct SubspaceStoreEntry
+{
+	/* The internal node of the next dimension, or the stored object */
+	void *storage;
+	void (*storage_free)(void *);
+
+	/*
+	 * For the stored objects, the last time the object was used and the cost
+	 * of recreating it, which the store uses to choose the object to evict.
+	 */
+	uint64 last_used;
+	uint32 cost;
+} SubspaceStoreEntry;
 
 typedef struct SubspaceStoreInternalNode
 {
-	DimensionVec *vector;
+	int32 num_entries;
+	int32 capacity;
+	/* The ranges [range_start, range_end) of the entries, sorted by start */
+	int64 *range_start;
+	int64 *range_end;
+	SubspaceStoreEntry *entries;
 	uint16 descendants;
 	bool last_internal_node;
 } SubspaceStoreInternalNode;
@@ -32,8 +60,11 @@ typedef struct SubspaceStore
 {
 	MemoryContext mcxt;
 	uint16 num_dimensions;
-	/* limit growth of store by  limiting number of slices in first dimension,	0 for no limit */
+	/* limit growth of store by limiting the number of stored objects, 0 for no limit */
 	uint16 max_items;
+	/* logical clock advanced on every access, to track the usage of the objects */
+	uint64 clock;
+	SubspaceStoreEvictionScore eviction_score;
 	SubspaceStoreInternalNode *origin; /* origin of the tree */
 } SubspaceStore;
 
@@ -42,31 +73,125 @@ subspace_store_internal_node_create(bool last_internal_node)
 {
 	SubspaceStoreInternalNode *node = palloc(sizeof(SubspaceStoreInternalNode));
 
-	node->vector = ts_dimension_vec_create(DIMENSION_VEC_DEFAULT_SIZE);
+	node->num_entries = 0;
+	node->capacity = SUBSPACE_STORE_NODE_DEFAULT_SIZE;
+	node->range_start = palloc(sizeof(int64) * node->capacity);
+	node->range_end = palloc(sizeof(int64) * node->capacity);
+	node->entries = palloc(sizeof(SubspaceStoreEntry) * node->capacity);
 	node->descendants = 0;
 	node->last_internal_node = last_internal_node;
 	return node;
 }
 
 static inline void
-subspace_store_internal_node_free(void *node)
+subspace_store_entry_free(SubspaceStoreEntry *entry)
 {
-	ts_dimension_vec_free(((SubspaceStoreInternalNode *) node)->vector);
+	if (entry->storage_free != NULL)
+		entry->storage_free(entry->storage);
+}
+
+static void
+subspace_store_internal_node_free(void *ptr)
+{
+	SubspaceStoreInternalNode *node = ptr;
+
+	for (int i = 0; i < node->num_entries; i++)
+		subspace_store_entry_free(&node->entries[i]);
+
+	pfree(node->range_start);
+	pfree(node->range_end);
+	pfree(node->entries);
 	pfree(node);
 }
 
-static size_t
-subspace_store_internal_node_descendants(SubspaceStoreInternalNode *node, int index)
+/*
+ * Find the entry whose range contains the coordinate, or return -1. The search
+ * for the last range that starts at or before the coordinate has no branches
+ * that depend on the data, apart from the loop itself.
+ */
+static inline int
+subspace_store_internal_node_find(const SubspaceStoreInternalNode *node, int64 coordinate)
 {
-	const DimensionSlice *slice = ts_dimension_vec_get(node->vector, index);
+	const int64 *range_start = node->range_start;
+	int low = 0;
+	int n = node->num_entries;
 
-	if (slice == NULL)
-		return 0;
+	if (n == 0)
+		return -1;
 
-	if (node->last_internal_node)
-		return 1;
+	/* The last slice also contains the maximum value. */
+	if (coordinate == DIMENSION_SLICE_MAXVALUE)
+		coordinate = DIMENSION_SLICE_MAXVALUE - 1;
 
-	return ((SubspaceStoreInternalNode *) slice->storage)->descendants;
+	while (n > 1)
+	{
+		const int half = n / 2;
+
+		low = range_start[low + half] <= coordinate ? low + half : low;
+		n -= half;
+	}
+
+	if (range_start[low] > coordinate || coordinate >= node->range_end[low])
+		return -1;
+
+	return low;
+}
+
+/*
+ * Add an empty entry for the range of the slice, keeping the ranges sorted,
+ * and return its index.
+ */
+static int
+subspace_store_internal_node_insert(SubspaceStoreInternalNode *node, const DimensionSlice *slice)
+{
+	int pos = 0;
+
+	if (node->num_entries == node->capacity)
+	{
+		node->capacity *= 2;
+		node->range_start = repalloc(node->range_start, sizeof(int64) * node->capacity);
+		node->range_end = repalloc(node->range_end, sizeof(int64) * node->capacity);
+		node->entries = repalloc(node->entries, sizeof(SubspaceStoreEntry) * node->capacity);
+	}
+
+	while (pos < node->num_entries && node->range_start[pos] < slice->fd.range_start)
+		pos++;
+
+	memmove(&node->range_start[pos + 1],
+			&node->range_start[pos],
+			sizeof(int64) * (node->num_entries - pos));
+	memmove(&node->range_end[pos + 1],
+			&node->range_end[pos],
+			sizeof(int64) * (node->num_entries - pos));
+	memmove(&node->entries[pos + 1],
+			&node->entries[pos],
+			sizeof(SubspaceStoreEntry) * (node->num_entries - pos));
+
+	node->range_start[pos] = slice->fd.range_start;
+	node->range_end[pos] = slice->fd.range_end;
+	memset(&node->entries[pos], 0, sizeof(SubspaceStoreEntry));
+	node->num_entries++;
+
+	return pos;
+}
+
+static void
+subspace_store_internal_node_remove(SubspaceStoreInternalNode *node, int index)
+{
+	Assert(index >= 0 && index < node->num_entries);
+
+	subspace_store_entry_free(&node->entries[index]);
+
+	memmove(&node->range_start[index],
+			&node->range_start[index + 1],
+			sizeof(int64) * (node->num_entries - index - 1));
+	memmove(&node->range_end[index],
+			&node->range_end[index + 1],
+			sizeof(int64) * (node->num_entries - index - 1));
+	memmove(&node->entries[index],
+			&node->entries[index + 1],
+			sizeof(SubspaceStoreEntry) * (node->num_entries - index - 1));
+	node->num_entries--;
 }
 
 SubspaceStore *
@@ -85,28 +210,140 @@ ts_subspace_store_init(const Hyperspace *space, MemoryContext mcxt, int16 max_it
 	sst->num_dimensions = space->num_dimensions;
 	/* max_items = 0 is treated as unlimited */
 	sst->max_items = max_items;
+	sst->clock = 0;
+	sst->eviction_score = subspace_store_default_eviction_score;
 	sst->mcxt = mcxt;
 	MemoryContextSwitchTo(old);
 	return sst;
 }
 
+/*
+ * The default eviction score: the objects that were not used for the longest
+ * time relative to the cost of recreating them are evicted first, so that the
+ * objects that are expensive to recreate stay longer in the store.
+ */
+static double
+subspace_store_default_eviction_score(uint64 age, uint32 cost)
+{
+	return (double) age / Max(cost, 1);
+}
+
+void
+ts_subspace_store_set_eviction_score(SubspaceStore *subspace_store,
+									 SubspaceStoreEvictionScore eviction_score)
+{
+	subspace_store->eviction_score = eviction_score;
+}
+
+/*
+ * Find the stored object with the highest eviction score in the subtree of the
+ * node, and record the indexes of the entries leading to it in best_path.
+ */
+static void
+subspace_store_find_victim(const SubspaceStore *subspace_store,
+						   const SubspaceStoreInternalNode *node, int depth, int *path,
+						   int *best_path, double *best_score)
+{
+	for (int i = 0; i < node->num_entries; i++)
+	{
+		const SubspaceStoreEntry *entry = &node->entries[i];
+
+		path[depth] = i;
+
+		if (!node->last_internal_node)
+		{
+			subspace_store_find_victim(subspace_store,
+									   entry->storage,
+									   depth + 1,
+									   path,
+									   best_path,
+									   best_score);
+		}
+		else
+		{
+			double score = subspace_store->eviction_score(subspace_store->clock -
+															  entry->last_used + 1,
+														  entry->cost);
+
+			if (best_path[0] < 0 || score > *best_score)
+			{
+				memcpy(best_path, path, sizeof(int) * (depth + 1));
+				*best_score = score;
+			}
+		}
+	}
+}
+
+/*
+ * Remove the stored object at the path below the node, together with the
+ * internal nodes that become empty.
+ */
+static void
+subspace_store_remove_path(SubspaceStoreInternalNode *node, const int *path)
+{
+	const int index = path[0];
+
+	node->descendants--;
+
+	if (!node->last_internal_node)
+	{
+		SubspaceStoreInternalNode *child = node->entries[index].storage;
+
+		subspace_store_remove_path(child, path + 1);
+
+		if (child->num_entries > 0)
+			return;
+	}
+
+	subspace_store_internal_node_remove(node, index);
+}
+
+/*
+ * Evict the stored object with the highest eviction score, so that we don't
+ * throw away the other objects in the same time range.
+ */
+static void
+subspace_store_evict(SubspaceStore *subspace_store)
+{
+	int *path = palloc(sizeof(int) * subspace_store->num_dimensions);
+	int *best_path = palloc(sizeof(int) * subspace_store->num_dimensions);
+	double best_score = 0;
+
+	best_path[0] = -1;
+	subspace_store_find_victim(subspace_store,
+							   subspace_store->origin,
+							   0,
+							   path,
+							   best_path,
+							   &best_score);
+
+	if (best_path[0] >= 0)
+		subspace_store_remove_path(subspace_store->origin, best_path);
+
+	pfree(path);
+	pfree(best_path);
+}
+
 void
 ts_subspace_store_add(SubspaceStore *subspace_store, const Hypercube *hypercube, void *object,
-					  void (*object_free)(void *))
+					  void (*object_free)(void *), uint32 cost)
 {
 	SubspaceStoreInternalNode *node = subspace_store->origin;
-	DimensionSlice *last = NULL;
+	SubspaceStoreEntry *last = NULL;
 	MemoryContext old = MemoryContextSwitchTo(subspace_store->mcxt);
 	int i;
 
 	Assert(hypercube->num_slices == subspace_store->num_dimensions);
 
+	/* Do we have enough space to store the object? */
+	if (subspace_store->max_items > 0 &&
+		subspace_store->origin->descendants >= subspace_store->max_items)
+		subspace_store_evict(subspace_store);
+
 	for (i = 0; i < hypercube->num_slices; i++)
 	{
 		const DimensionSlice *target = hypercube->slices[i];
-		DimensionSlice *match;
-
-		Assert(target->storage == NULL);
+		int match;
 
 		if (node == NULL)
 		{
@@ -131,77 +368,77 @@ ts_subspace_store_add(SubspaceStore *subspace_store, const Hypercube *hypercube,
 		 */
 		node->descendants += 1;
 
-		Assert(0 == node->vector->num_slices ||
-			   node->vector->slices[0]->fd.dimension_id == target->fd.dimension_id);
+		Assert(subspace_store->max_items == 0 ||
+			   node->descendants <= (size_t) subspace_store->max_items);
 
-		/* Do we have enough space to store the object? */
-		if (subspace_store->max_items > 0 && node->descendants > subspace_store->max_items)
-		{
-			/*
-			 * Always delete the slice corresponding to the earliest time
-			 * range. In the normal case that inserts are performed in
-			 * time-order this is the one least likely to be reused. (Note
-			 * that we made sure that the first dimension is a time dimension
-			 * when creating the subspace_store). If out-of-order inserts are
-			 * become significant we may wish to change this to something more
-			 * sophisticated like LRU.
-			 */
-			size_t items_removed = subspace_store_internal_node_descendants(node, i);
+		match = subspace_store_internal_node_find(node, target->fd.range_start);
 
-			/*
-			 * descendants at the root is inclusive of the descendants at the
-			 * children, so if we have an overflow it must be in the time dim
-			 */
-			Assert(i == 0);
+		/* Do we have a slot in this node for the new object? */
+		if (match < 0)
+			match = subspace_store_internal_node_insert(node, target);
 
-			Assert(subspace_store->max_items + 1 == node->descendants);
+		last = &node->entries[match];
+		/* internal entries point to the next SubspaceStoreInternalNode */
+		node = last->storage;
+	}
 
-			ts_dimension_vec_remove_slice(&node->vector, i);
+	Assert(last != NULL && last->storage == NULL);
+	last->storage = object; /* at the end we store the object */
+	last->storage_free = object_free;
+	last->last_used = ++subspace_store->clock;
+	last->cost = cost;
+	MemoryContextSwitchTo(old);
+}
 
-			/*
-			 * Note we would have to do this to ancestors if this was not the
-			 * root.
-			 */
-			node->descendants -= items_removed;
-		}
+/*
+ * Find the entry of the object stored for the subspace of the hypercube.
+ */
+static SubspaceStoreEntry *
+subspace_store_find_entry(const SubspaceStore *subspace_store, const int64 *coordinates)
+{
+	const SubspaceStoreInternalNode *node = subspace_store->origin;
+	SubspaceStoreEntry *match = NULL;
 
-		match = ts_dimension_vec_find_slice(node->vector, target->fd.range_start);
+	for (int i = 0; i < subspace_store->num_dimensions; i++)
+	{
+		const int index = subspace_store_internal_node_find(node, coordinates[i]);
 
-		/* Do we have a slot in this vector for the new object? */
-		if (match == NULL)
-		{
-			DimensionSlice *copy;
+		if (index < 0)
+			return NULL;
 
-			/*
-			 * create a new copy of the range this slice covers, to store the
-			 * object in
-			 */
-			copy = ts_dimension_slice_copy(target);
+		match = &node->entries[index];
+		node = match->storage;
+	}
 
-			ts_dimension_vec_add_slice_sort(&node->vector, copy);
-			match = copy;
-		}
+	return match;
+}
 
-		Assert(subspace_store->max_items == 0 ||
-			   node->descendants <= (size_t) subspace_store->max_items);
+void
+ts_subspace_store_touch(SubspaceStore *subspace_store, const Hypercube *hypercube)
+{
+	int64 *coordinates;
+	SubspaceStoreEntry *entry;
 
-		last = match;
-		/* internal slices point to the next SubspaceStoreInternalNode */
-		node = last->storage;
-	}
+	Assert(hypercube->num_slices == subspace_store->num_dimensions);
 
-	Assert(last != NULL && last->storage == NULL);
-	last->storage = object; /* at the end we store the object */
-	last->storage_free = object_free;
-	MemoryContextSwitchTo(old);
+	if (subspace_store->num_dimensions == 0)
+		return;
+
+	coordinates = palloc(sizeof(int64) * hypercube->num_slices);
+	for (int i = 0; i < hypercube->num_slices; i++)
+		coordinates[i] = hypercube->slices[i]->fd.range_start;
+
+	entry = subspace_store_find_entry(subspace_store, coordinates);
+	if (entry != NULL)
+		entry->last_used = ++subspace_store->clock;
+
+	pfree(coordinates);
 }
 
 void *
-ts_subspace_store_get(const SubspaceStore *subspace_store, const Point *target)
+ts_subspace_store_get(SubspaceStore *subspace_store, const Point *target)
 {
-	int i;
-	DimensionVec *vec = subspace_store->origin->vector;
-	DimensionSlice *match = NULL;
+	SubspaceStoreEntry *match;
 
 	Assert(target->cardinality == subspace_store->num_dimensions);
 
@@ -211,16 +448,11 @@ ts_subspace_store_get(const SubspaceStore *subspace_store, const Point *target)
 	if (subspace_store->num_dimensions == 0)
 		return NULL;
 
-	for (i = 0; i < target->cardinality; i++)
-	{
-		match = ts_dimension_vec_find_slice(vec, target->coordinates[i]);
-
-		if (NULL == match)
-			return NULL;
+	match = subspace_store_find_entry(subspace_store, target->coordinates);
+	if (match == NULL)
+		return NULL;
 
-		vec = ((SubspaceStoreInternalNode *) match->storage)->vector;
-	}
-	Assert(match != NULL);
+	match->last_used = ++subspace_store->clock;
 	return match->storage;
 }
 
@@ -22,14 +22,30 @@ typedef struct SubspaceStore SubspaceStore;
 extern SubspaceStore *ts_subspace_store_init(const Hyperspace *space, MemoryContext mcxt,
 											 int16 max_items);
 
-/* Store an object associate with the subspace represented by a hypercube */
+/*
+ * The eviction policy of a full store: the score of a stored object, given the
+ * number of store accesses since it was last used and the cost of recreating
+ * it. The object with the highest score is evicted.
+ */
+typedef double (*SubspaceStoreEvictionScore)(uint64 age, uint32 cost);
+
+extern void ts_subspace_store_set_eviction_score(SubspaceStore *subspace_store,
+												 SubspaceStoreEvictionScore eviction_score);
+
+/*
+ * Store an object associate with the subspace represented by a hypercube. The
+ * cost of recreating the object makes it less likely to be evicted.
+ */
 extern void ts_subspace_store_add(SubspaceStore *subspace_store, const Hypercube *hypercube,
-								  void *object, void (*object_free)(void *));
+								  void *object, void (*object_free)(void *), uint32 cost);
 
 /* Get the object stored for the subspace that a point is in.
  * Return the object stored or NULL if this subspace is not in the store.
  */
-extern void *ts_subspace_store_get(const SubspaceStore *subspace_store, const Point *target);
+extern void *ts_subspace_store_get(SubspaceStore *subspace_store, const Point *target);
+
+/* Mark the object stored for the subspace of a hypercube as recently used. */
+extern void ts_subspace_store_touch(SubspaceStore *subspace_store, const Hypercube *hypercube);
 extern void ts_subspace_store_free(SubspaceStore *subspace_store);
 extern MemoryContext ts_subspace_store_mcxt(const SubspaceStore *subspace_store);
 
@@ -17,9 +17,13 @@
 #include <commands/extension.h>
 #include <nodes/nodeFuncs.h>
 #include <port/atomics.h>
+#include <access/xact.h>
+#include <storage/ipc.h>
 #include <storage/lwlock.h>
 #include <utils/hsearch.h>
 #include <utils/fmgroids.h>
+#include <utils/memutils.h>
+#include <utils/timestamp.h>
 
 #include <utils/regproc.h>
 
@@ -120,6 +124,8 @@ allowed_extension_functions(const char **visible_extensions, int num_visible_ext
 	return allowed_fns;
 }
 
+static void flush_function_counts(bool wait);
+
 static fn_telemetry_entry_vec *
 read_shared_map()
 {
@@ -199,6 +205,9 @@ ts_function_telemetry_read(const char **visible_extensions, int num_visible_exte
 		function_counts_lock = (*rendezvous)->lock;
 	}
 
+	/* Include the counts of this backend */
+	flush_function_counts(true);
+
 	all_entries = read_shared_map();
 	entries_to_send =
 		fn_telemetry_entry_vec_create(CurrentMemoryContext, all_entries->num_elements);
@@ -265,6 +274,20 @@ ts_function_telemetry_reset_counts()
  * Telemetry gathering code *
  ****************************/
 
+/*
+ * How often a backend adds its local function counts to the shared hashmap.
+ * Taking the lock of the shared hashmap for every query causes contention on
+ * workloads with many short queries, so the counts are accumulated locally
+ * in between. The counts that are not flushed yet are not visible to the
+ * telemetry worker, which is fine for telemetry.
+ */
+#define FN_TELEMETRY_FLUSH_INTERVAL_MS 1000
+
+static HTAB *local_function_counts = NULL;
+static bool have_local_counts = false;
+static TimestampTz last_flush_time = 0;
+static bool exit_callback_registered = false;
+
 static bool
 function_telemetry_increment(Oid func_id, HTAB **local_counts)
 {
@@ -277,10 +300,10 @@ function_telemetry_increment(Oid func_id, HTAB **local_counts)
 		HASHCTL hash_info = {
 			.keysize = sizeof(Oid),
 			.entrysize = sizeof(FnTelemetryEntry),
-			.hcxt = CurrentMemoryContext,
+			.hcxt = TopMemoryContext,
 		};
 		*local_counts = hash_create("fn telemetry local function hash",
-									10,
+									64,
 									&hash_info,
 									HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
 	}
@@ -290,6 +313,7 @@ function_telemetry_increment(Oid func_id, HTAB **local_counts)
 		entry->count = 0;
 
 	entry->count += 1;
+	have_local_counts = true;
 
 	return true;
 }
@@ -321,17 +345,28 @@ function_gather_walker(Node *node, void *context)
 	return expression_tree_walker(node, function_gather_walker, context);
 }
 
-static HTAB *
+static void
 record_function_counts(Query *query)
 {
-	HTAB *query_function_counts = NULL;
-	query_tree_walker(query, function_gather_walker, &query_function_counts, 0);
-	return query_function_counts;
+	query_tree_walker(query, function_gather_walker, &local_function_counts, 0);
+}
+
+static bool
+function_counts_lock_acquire(LWLockMode mode, bool wait)
+{
+	if (wait)
+	{
+		LWLockAcquire(function_counts_lock, mode);
+		return true;
+	}
+
+	return LWLockConditionalAcquire(function_counts_lock, mode);
 }
 
 /*
- * Store a map of (function_oid, count) into shared memory so it can be seen by
- * the telemetry worker. This insertion works in two phases:
+ * Add the local map of (function_oid, count) to shared memory so it can be
+ * seen by the telemetry worker, and reset the local counts. This insertion
+ * works in two phases:
  *   1. Under a SHARED lock, we increment the counts of all those functions that
  *      are already present in the map, using atomic fetch-add to prevent races.
  *   2. Under an EXCLUSIVE lock, we insert entries for all those functions that
@@ -340,75 +375,110 @@ record_function_counts(Query *query)
  * query uses will already be in the shared map, so this strategy should
  * minimize contention between queries.
  *
- * @param query_function_counts A hashtable of FnTelemetryEntry storing
- *                              function usage counts
+ * If wait is false, the counts are dropped instead of waiting for the lock.
  */
 static void
-store_function_counts_in_shared_mem(HTAB *query_function_counts)
+flush_function_counts(bool wait)
 {
 	HASH_SEQ_STATUS hash_seq;
 	FnTelemetryEntry *local_entry = NULL;
-	fn_telemetry_entry_vec missing_entries;
-	fn_telemetry_entry_vec_init(&missing_entries, CurrentMemoryContext, 0);
+	bool have_missing_entries = false;
+
+	if (!have_local_counts || function_counts == NULL)
+		return;
+
+	have_local_counts = false;
 
 	/*
 	 * Increment the counts of any functions already in the table under a
 	 * shared lock; the atomicity of increments will handle concurrency.
 	 */
-	LWLockAcquire(function_counts_lock, LW_SHARED);
-	hash_seq_init(&hash_seq, query_function_counts);
-
-	while ((local_entry = hash_seq_search(&hash_seq)))
+	if (function_counts_lock_acquire(LW_SHARED, wait))
 	{
-		FnTelemetryHashEntry *shared_entry =
-			hash_search(function_counts, &local_entry->fn, HASH_FIND, NULL);
+		hash_seq_init(&hash_seq, local_function_counts);
 
-		if (shared_entry)
-			pg_atomic_fetch_add_u64(&shared_entry->count, local_entry->count);
-		else
-			fn_telemetry_entry_vec_append(&missing_entries, *local_entry);
-	}
+		while ((local_entry = hash_seq_search(&hash_seq)))
+		{
+			FnTelemetryHashEntry *shared_entry;
 
-	LWLockRelease(function_counts_lock);
+			if (local_entry->count == 0)
+				continue;
+
+			shared_entry = hash_search(function_counts, &local_entry->fn, HASH_FIND, NULL);
+
+			if (shared_entry)
+			{
+				pg_atomic_fetch_add_u64(&shared_entry->count, local_entry->count);
+				local_entry->count = 0;
+			}
+			else
+				have_missing_entries = true;
+		}
+
+		LWLockRelease(function_counts_lock);
+	}
 
 	/*
 	 * If any functions did not have an entries create them under an
 	 * exclusive lock
 	 */
-	if (missing_entries.num_elements > 0)
+	if (have_missing_entries && function_counts_lock_acquire(LW_EXCLUSIVE, wait))
 	{
-		LWLockAcquire(function_counts_lock, LW_EXCLUSIVE);
-		for (uint32 i = 0; i < missing_entries.num_elements; i++)
+		hash_seq_init(&hash_seq, local_function_counts);
+
+		while ((local_entry = hash_seq_search(&hash_seq)))
 		{
 			bool found = false;
-			FnTelemetryEntry *missing_entry = fn_telemetry_entry_vec_at(&missing_entries, i);
-			FnTelemetryHashEntry *shared_entry =
-				hash_search(function_counts, &missing_entry->fn, HASH_ENTER_NULL, &found);
+			FnTelemetryHashEntry *shared_entry;
+
+			if (local_entry->count == 0)
+				continue;
+
+			shared_entry = hash_search(function_counts, &local_entry->fn, HASH_ENTER_NULL, &found);
 
 			if (!shared_entry)
+			{
+				hash_seq_term(&hash_seq);
 				break;
+			}
 
 			if (found)
-				pg_atomic_fetch_add_u64(&shared_entry->count, missing_entry->count);
+				pg_atomic_fetch_add_u64(&shared_entry->count, local_entry->count);
 			else
-				pg_atomic_init_u64(&shared_entry->count, missing_entry->count);
+				pg_atomic_init_u64(&shared_entry->count, local_entry->count);
+			local_entry->count = 0;
 		}
 		LWLockRelease(function_counts_lock);
 	}
+
+	/* The counts that didn't fit in the shared hashmap are dropped */
+	hash_seq_init(&hash_seq, local_function_counts);
+	while ((local_entry = hash_seq_search(&hash_seq)))
+		local_entry->count = 0;
+}
+
+/*
+ * Flush the remaining counts when the backend exits. This can run with the
+ * lock still held after an error, so don't wait for the lock.
+ */
+static void
+function_telemetry_exit_callback(int code, Datum arg)
+{
+	flush_function_counts(false);
 }
 
 /*
  * Gather function usage telemetry for a query.
  *
  * This function walks a query looking for function Oids, counts their
- * occurrence, and stores the (function_id, count) set into the shared-memory
- * function telemetry hashtable for later processing by the telemetry background
- * worker.
+ * occurrence, and periodically adds the (function_id, count) set to the
+ * shared-memory function telemetry hashtable for later processing by the
+ * telemetry background worker.
  */
 void
 ts_telemetry_function_info_gather(Query *query)
 {
-	HTAB *query_function_counts;
+	TimestampTz now;
 
 	if (skip_telemetry || !ts_function_telemetry_on())
 		return;
@@ -429,8 +499,19 @@ ts_telemetry_function_info_gather(Query *query)
 		function_counts_lock = (*rendezvous)->lock;
 	}
 
-	query_function_counts = record_function_counts(query);
+	if (!exit_callback_registered)
+	{
+		before_shmem_exit(function_telemetry_exit_callback, (Datum) 0);
+		exit_callback_registered = true;
+	}
+
+	record_function_counts(query);
 
-	if (query_function_counts)
-		store_function_counts_in_shared_mem(query_function_counts);
+	/* The statement start avoids reading the clock for every query */
+	now = GetCurrentStatementStartTimestamp();
+	if (TimestampDifferenceExceeds(last_flush_time, now, FN_TELEMETRY_FLUSH_INTERVAL_MS))
+	{
+		flush_function_counts(true);
+		last_flush_time = now;
+	}
 }
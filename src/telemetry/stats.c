@@ -13,9 +13,11 @@
 #include <catalog/namespace.h>
 #include <catalog/pg_namespace.h>
 #include <utils/builtins.h>
+#include <utils/hsearch.h>
 #include <utils/syscache.h>
 #include <utils/snapmgr.h>
 #include <storage/lmgr.h>
+#include <miscadmin.h>
 #include <fmgr.h>
 
 #include "stats.h"
@@ -25,12 +27,45 @@
 #include "extension.h"
 #include "hypertable_cache.h"
 #include "debug_point.h"
+#include "scan_iterator.h"
 #include "utils.h"
 
+/*
+ * The catalog information of a chunk that the stats need. We read it for all
+ * the chunks up front with a few catalog scans, instead of looking up every
+ * relation in pg_class as a potential chunk, which needs several index scans
+ * per relation and dominates the cost on databases with many relations.
+ */
+typedef struct ChunkStatsInfo
+{
+	int32 chunk_id; /* hash key */
+	int32 hypertable_id;
+	int32 status;
+	int num_data_nodes;
+	bool has_compression_size;
+	FormData_compression_chunk_size compression_size;
+} ChunkStatsInfo;
+
+typedef struct RelidStatsEntry
+{
+	Oid relid; /* hash key */
+	int32 id;
+} RelidStatsEntry;
+
+typedef struct HypertableIdStatsEntry
+{
+	int32 id; /* hash key */
+	Oid relid;
+} HypertableIdStatsEntry;
+
 typedef struct StatsContext
 {
 	TelemetryStats *stats;
 	Snapshot snapshot;
+	HTAB *hypertables_by_relid;
+	HTAB *hypertables_by_id;
+	HTAB *chunks_by_relid;
+	HTAB *chunks;
 } StatsContext;
 
 /*
@@ -77,14 +112,22 @@ classify_hypertable(const Hypertable *ht)
 }
 
 static StatsRelType
-classify_chunk(Cache *htcache, const Hypertable **ht, const Chunk *chunk)
+classify_chunk(const StatsContext *statsctx, Cache *htcache, const Hypertable **ht,
+			   const ChunkStatsInfo *chunk)
 {
 	StatsRelType parent_reltype;
+	const HypertableIdStatsEntry *parent;
 
 	Assert(NULL != chunk);
 	/* Classify the chunk's parent */
-	*ht = ts_hypertable_cache_get_entry(htcache, chunk->hypertable_relid, CACHE_FLAG_MISSING_OK);
-	Assert(NULL != *ht);
+	parent = hash_search(statsctx->hypertables_by_id, &chunk->hypertable_id, HASH_FIND, NULL);
+	*ht = parent == NULL ?
+			  NULL :
+			  ts_hypertable_cache_get_entry(htcache, parent->relid, CACHE_FLAG_MISSING_OK);
+
+	if (NULL == *ht)
+		return RELTYPE_OTHER;
+
 	parent_reltype = classify_hypertable(*ht);
 
 	/* Classify the chunk's parent */
@@ -106,26 +149,43 @@ classify_chunk(Cache *htcache, const Hypertable **ht, const Chunk *chunk)
 	}
 }
 
+static const ChunkStatsInfo *
+find_chunk(const StatsContext *statsctx, Oid relid)
+{
+	const RelidStatsEntry *entry = hash_search(statsctx->chunks_by_relid, &relid, HASH_FIND, NULL);
+
+	if (NULL == entry)
+		return NULL;
+
+	return hash_search(statsctx->chunks, &entry->id, HASH_FIND, NULL);
+}
+
 static StatsRelType
-classify_table(const Form_pg_class class, Cache *htcache, const Hypertable **ht,
-			   const Chunk **chunk)
+classify_table(const Form_pg_class class, const StatsContext *statsctx, Cache *htcache,
+			   const Hypertable **ht, const ChunkStatsInfo **chunk)
 {
 	Assert(class->relkind == RELKIND_RELATION);
 
 	if (class->relispartition)
 		return RELTYPE_PARTITION;
 
-	/* Check if it is a hypertable */
-	*ht = ts_hypertable_cache_get_entry(htcache, class->oid, CACHE_FLAG_MISSING_OK);
+	/*
+	 * Check if it is a hypertable. Only look up the known hypertables in the
+	 * cache, so that we don't add an entry for every other table to it.
+	 */
+	if (hash_search(statsctx->hypertables_by_relid, &class->oid, HASH_FIND, NULL) != NULL)
+	{
+		*ht = ts_hypertable_cache_get_entry(htcache, class->oid, CACHE_FLAG_MISSING_OK);
 
-	if (*ht)
-		return classify_hypertable(*ht);
+		if (*ht)
+			return classify_hypertable(*ht);
+	}
 
 	/* Check if it is a chunk */
-	*chunk = ts_chunk_get_by_relid(class->oid, false);
+	*chunk = find_chunk(statsctx, class->oid);
 
 	if (NULL != *chunk)
-		return classify_chunk(htcache, ht, *chunk);
+		return classify_chunk(statsctx, htcache, ht, *chunk);
 
 	return RELTYPE_TABLE;
 }
@@ -147,12 +207,13 @@ classify_partitioned_table(const Form_pg_class class)
 }
 
 static StatsRelType
-classify_foreign_table(Cache *htcache, Oid relid, const Hypertable **ht, const Chunk **chunk)
+classify_foreign_table(const StatsContext *statsctx, Cache *htcache, Oid relid,
+					   const Hypertable **ht, const ChunkStatsInfo **chunk)
 {
-	*chunk = ts_chunk_get_by_relid(relid, false);
+	*chunk = find_chunk(statsctx, relid);
 
 	if (*chunk)
-		return classify_chunk(htcache, ht, *chunk);
+		return classify_chunk(statsctx, htcache, ht, *chunk);
 
 	/*
 	 * Currently don't care about non-chunk foreign tables, so classify as
@@ -178,8 +239,8 @@ classify_view(const Form_pg_class class, Cache *htcache, const ContinuousAgg **c
 }
 
 static StatsRelType
-classify_relation(const Form_pg_class class, Cache *htcache, const Hypertable **ht,
-				  const Chunk **chunk, const ContinuousAgg **cagg)
+classify_relation(const Form_pg_class class, const StatsContext *statsctx, Cache *htcache,
+				  const Hypertable **ht, const ChunkStatsInfo **chunk, const ContinuousAgg **cagg)
 {
 	*chunk = NULL;
 	*ht = NULL;
@@ -188,11 +249,11 @@ classify_relation(const Form_pg_class class, Cache *htcache, const Hypertable **
 	switch (class->relkind)
 	{
 		case RELKIND_RELATION:
-			return classify_table(class, htcache, ht, chunk);
+			return classify_table(class, statsctx, htcache, ht, chunk);
 		case RELKIND_PARTITIONED_TABLE:
 			return classify_partitioned_table(class);
 		case RELKIND_FOREIGN_TABLE:
-			return classify_foreign_table(htcache, class->oid, ht, chunk);
+			return classify_foreign_table(statsctx, htcache, class->oid, ht, chunk);
 		case RELKIND_MATVIEW:
 			return RELTYPE_MATVIEW;
 		case RELKIND_VIEW:
@@ -307,17 +368,17 @@ process_partition(HyperStats *stats, Form_pg_class class, bool ischunk)
  * Add a chunk's stats to the parent table.
  */
 static void
-add_chunk_stats(HyperStats *stats, Form_pg_class class, const Chunk *chunk,
-				const Form_compression_chunk_size fd_compr)
+add_chunk_stats(HyperStats *stats, Form_pg_class class, const ChunkStatsInfo *chunk,
+				const FormData_compression_chunk_size *fd_compr)
 {
 	process_partition(stats, class, true);
 
-	if (ts_chunk_is_compressed(chunk))
+	if (ts_flags_are_set_32(chunk->status, CHUNK_STATUS_COMPRESSED))
 		stats->compressed_chunk_count++;
 
 	/* Add replica chunks, if any. Only count the extra replicas */
-	if (list_length(chunk->data_nodes) > 1)
-		stats->replica_chunk_count += (list_length(chunk->data_nodes) - 1);
+	if (chunk->num_data_nodes > 1)
+		stats->replica_chunk_count += (chunk->num_data_nodes - 1);
 
 	/*
 	 * A chunk on a distributed hypertable can be marked as compressed but
@@ -343,50 +404,6 @@ add_chunk_stats(HyperStats *stats, Form_pg_class class, const Chunk *chunk,
 	}
 }
 
-static bool
-get_chunk_compression_stats(StatsContext *statsctx, const Chunk *chunk,
-							Form_compression_chunk_size compr_stats)
-{
-	TupleInfo *ti;
-	ScanIterator it;
-	bool found = false;
-
-	if (!ts_chunk_is_compressed(chunk))
-		return false;
-
-	it = ts_scan_iterator_create(COMPRESSION_CHUNK_SIZE, AccessShareLock, CurrentMemoryContext);
-	ts_scan_iterator_set_index(&it, COMPRESSION_CHUNK_SIZE, COMPRESSION_CHUNK_SIZE_PKEY);
-	it.ctx.snapshot = statsctx->snapshot;
-
-	ts_scan_iterator_scan_key_reset(&it);
-	ts_scan_iterator_scan_key_init(&it,
-								   Anum_compression_chunk_size_pkey_chunk_id,
-								   BTEqualStrategyNumber,
-								   F_INT4EQ,
-								   Int32GetDatum(chunk->fd.id));
-	ts_scan_iterator_start_or_restart_scan(&it);
-	ti = ts_scan_iterator_next(&it);
-
-	if (ti)
-	{
-		Form_compression_chunk_size fd;
-		bool should_free;
-		HeapTuple tuple = ts_scan_iterator_fetch_heap_tuple(&it, false, &should_free);
-
-		fd = (Form_compression_chunk_size) GETSTRUCT(tuple);
-		memcpy(compr_stats, fd, sizeof(*fd));
-
-		if (should_free)
-			heap_freetuple(tuple);
-
-		found = true;
-	}
-
-	ts_scan_iterator_close(&it);
-
-	return found;
-}
-
 /*
  * Process a relation identified as being a chunk.
  *
@@ -409,11 +426,10 @@ get_chunk_compression_stats(StatsContext *statsctx, const Chunk *chunk,
  */
 static void
 process_chunk(StatsContext *statsctx, StatsRelType chunk_reltype, Form_pg_class class,
-			  const Chunk *chunk)
+			  const ChunkStatsInfo *chunk)
 {
 	TelemetryStats *stats = statsctx->stats;
-	FormData_compression_chunk_size comp_stats_data;
-	Form_compression_chunk_size compr_stats = NULL;
+	const FormData_compression_chunk_size *compr_stats = NULL;
 
 	Assert(chunk);
 
@@ -424,8 +440,9 @@ process_chunk(StatsContext *statsctx, StatsRelType chunk_reltype, Form_pg_class
 	if (chunk_reltype == RELTYPE_COMPRESSION_CHUNK)
 		return;
 
-	if (get_chunk_compression_stats(statsctx, chunk, &comp_stats_data))
-		compr_stats = &comp_stats_data;
+	if (ts_flags_are_set_32(chunk->status, CHUNK_STATUS_COMPRESSED) &&
+		chunk->has_compression_size)
+		compr_stats = &chunk->compression_size;
 
 	switch (chunk_reltype)
 	{
@@ -483,9 +500,150 @@ should_ignore_relation(const Catalog *catalog, Form_pg_class class)
 			is_ts_schema(catalog, class->relnamespace) || ts_is_catalog_table(class->oid));
 }
 
+static HTAB *
+create_stats_hash(const char *name, Size keysize, Size entrysize, MemoryContext mcxt)
+{
+	HASHCTL ctl = {
+		.keysize = keysize,
+		.entrysize = entrysize,
+		.hcxt = mcxt,
+	};
+
+	return hash_create(name, 128, &ctl, HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+}
+
+static void
+load_hypertables(StatsContext *statsctx)
+{
+	ScanIterator it = ts_scan_iterator_create(HYPERTABLE, AccessShareLock, CurrentMemoryContext);
+	it.ctx.snapshot = statsctx->snapshot;
+
+	ts_scanner_foreach(&it)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&it);
+		bool isnull;
+		int32 id = DatumGetInt32(slot_getattr(ti->slot, Anum_hypertable_id, &isnull));
+		Name schema_name =
+			DatumGetName(slot_getattr(ti->slot, Anum_hypertable_schema_name, &isnull));
+		Name table_name = DatumGetName(slot_getattr(ti->slot, Anum_hypertable_table_name, &isnull));
+		Oid relid = ts_get_relation_relid(NameStr(*schema_name), NameStr(*table_name), true);
+		RelidStatsEntry *by_relid;
+		HypertableIdStatsEntry *by_id;
+
+		if (!OidIsValid(relid))
+			continue;
+
+		by_relid = hash_search(statsctx->hypertables_by_relid, &relid, HASH_ENTER, NULL);
+		by_relid->id = id;
+		by_id = hash_search(statsctx->hypertables_by_id, &id, HASH_ENTER, NULL);
+		by_id->relid = relid;
+	}
+
+	ts_scan_iterator_close(&it);
+}
+
+static void
+load_chunks(StatsContext *statsctx)
+{
+	ScanIterator it = ts_scan_iterator_create(CHUNK, AccessShareLock, CurrentMemoryContext);
+	it.ctx.snapshot = statsctx->snapshot;
+
+	ts_scanner_foreach(&it)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&it);
+		bool isnull;
+		int32 id = DatumGetInt32(slot_getattr(ti->slot, Anum_chunk_id, &isnull));
+		Name schema_name = DatumGetName(slot_getattr(ti->slot, Anum_chunk_schema_name, &isnull));
+		Name table_name = DatumGetName(slot_getattr(ti->slot, Anum_chunk_table_name, &isnull));
+		bool dropped = DatumGetBool(slot_getattr(ti->slot, Anum_chunk_dropped, &isnull));
+		ChunkStatsInfo *chunk;
+		RelidStatsEntry *by_relid;
+		Oid relid;
+
+		if (dropped)
+			continue;
+
+		relid = ts_get_relation_relid(NameStr(*schema_name), NameStr(*table_name), true);
+		if (!OidIsValid(relid))
+			continue;
+
+		chunk = hash_search(statsctx->chunks, &id, HASH_ENTER, NULL);
+		chunk->hypertable_id =
+			DatumGetInt32(slot_getattr(ti->slot, Anum_chunk_hypertable_id, &isnull));
+		chunk->status = DatumGetInt32(slot_getattr(ti->slot, Anum_chunk_status, &isnull));
+		chunk->num_data_nodes = 0;
+		chunk->has_compression_size = false;
+
+		by_relid = hash_search(statsctx->chunks_by_relid, &relid, HASH_ENTER, NULL);
+		by_relid->id = id;
+	}
+
+	ts_scan_iterator_close(&it);
+
+	it = ts_scan_iterator_create(CHUNK_DATA_NODE, AccessShareLock, CurrentMemoryContext);
+	it.ctx.snapshot = statsctx->snapshot;
+
+	ts_scanner_foreach(&it)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&it);
+		bool isnull;
+		int32 id = DatumGetInt32(slot_getattr(ti->slot, Anum_chunk_data_node_chunk_id, &isnull));
+		ChunkStatsInfo *chunk = hash_search(statsctx->chunks, &id, HASH_FIND, NULL);
+
+		if (chunk != NULL)
+			chunk->num_data_nodes++;
+	}
+
+	ts_scan_iterator_close(&it);
+
+	it = ts_scan_iterator_create(COMPRESSION_CHUNK_SIZE, AccessShareLock, CurrentMemoryContext);
+	it.ctx.snapshot = statsctx->snapshot;
+
+	ts_scanner_foreach(&it)
+	{
+		bool should_free;
+		HeapTuple tuple = ts_scan_iterator_fetch_heap_tuple(&it, false, &should_free);
+		Form_compression_chunk_size fd = (Form_compression_chunk_size) GETSTRUCT(tuple);
+		ChunkStatsInfo *chunk = hash_search(statsctx->chunks, &fd->chunk_id, HASH_FIND, NULL);
+
+		if (chunk != NULL)
+		{
+			memcpy(&chunk->compression_size, fd, sizeof(*fd));
+			chunk->has_compression_size = true;
+		}
+
+		if (should_free)
+			heap_freetuple(tuple);
+	}
+
+	ts_scan_iterator_close(&it);
+}
+
+/*
+ * Whether we collect any stats for a relation type. The relations of the
+ * other types are skipped without locking them.
+ */
+static bool
+reltype_has_stats(StatsRelType reltype)
+{
+	switch (reltype)
+	{
+		case RELTYPE_COMPRESSION_HYPERTABLE:
+		case RELTYPE_MATERIALIZED_HYPERTABLE:
+		case RELTYPE_COMPRESSION_CHUNK:
+		case RELTYPE_OTHER:
+			return false;
+		default:
+			return true;
+	}
+}
+
 /*
  * Scan the entire pg_class catalog table for all relations. For each
  * relation, classify it and gather stats based on the classification.
+ *
+ * The TimescaleDB catalog is read up front into hash tables, so that the
+ * classification of a relation doesn't need any catalog scans.
  */
 void
 ts_telemetry_stats_gather(TelemetryStats *stats)
@@ -494,13 +652,37 @@ ts_telemetry_stats_gather(TelemetryStats *stats)
 	Relation rel;
 	SysScanDesc scan;
 	Cache *htcache = ts_hypertable_cache_pin();
-	MemoryContext oldmcxt, relmcxt;
+	MemoryContext oldmcxt, relmcxt, catalogmcxt;
 	StatsContext statsctx = {
 		.stats = stats,
 		.snapshot = GetActiveSnapshot(),
 	};
 
 	MemSet(stats, 0, sizeof(*stats));
+
+	catalogmcxt =
+		AllocSetContextCreate(CurrentMemoryContext, "CatalogStats", ALLOCSET_DEFAULT_SIZES);
+	statsctx.hypertables_by_relid = create_stats_hash("telemetry hypertables by relid",
+													  sizeof(Oid),
+													  sizeof(RelidStatsEntry),
+													  catalogmcxt);
+	statsctx.hypertables_by_id = create_stats_hash("telemetry hypertables by id",
+												   sizeof(int32),
+												   sizeof(HypertableIdStatsEntry),
+												   catalogmcxt);
+	statsctx.chunks_by_relid = create_stats_hash("telemetry chunks by relid",
+												 sizeof(Oid),
+												 sizeof(RelidStatsEntry),
+												 catalogmcxt);
+	statsctx.chunks = create_stats_hash("telemetry chunks",
+										sizeof(int32),
+										sizeof(ChunkStatsInfo),
+										catalogmcxt);
+	oldmcxt = MemoryContextSwitchTo(catalogmcxt);
+	load_hypertables(&statsctx);
+	load_chunks(&statsctx);
+	MemoryContextSwitchTo(oldmcxt);
+
 	rel = table_open(RelationRelationId, AccessShareLock);
 	scan = systable_beginscan(rel, ClassOidIndexId, false, NULL, 0, NULL);
 	relmcxt = AllocSetContextCreate(CurrentMemoryContext, "RelationStats", ALLOCSET_DEFAULT_SIZES);
@@ -510,10 +692,12 @@ ts_telemetry_stats_gather(TelemetryStats *stats)
 		HeapTuple tup;
 		Form_pg_class class;
 		StatsRelType reltype;
-		const Chunk *chunk = NULL;
+		const ChunkStatsInfo *chunk = NULL;
 		const Hypertable *ht = NULL;
 		const ContinuousAgg *cagg = NULL;
 
+		CHECK_FOR_INTERRUPTS();
+
 		tup = systable_getnext(scan);
 
 		if (!HeapTupleIsValid(tup))
@@ -524,6 +708,23 @@ ts_telemetry_stats_gather(TelemetryStats *stats)
 		if (should_ignore_relation(catalog, class))
 			continue;
 
+		/*
+		 * Use temporary per-relation memory context to not accumulate cruft
+		 * during processing of pg_class.
+		 */
+		oldmcxt = MemoryContextSwitchTo(relmcxt);
+		MemoryContextReset(relmcxt);
+
+		reltype = classify_relation(class, &statsctx, htcache, &ht, &chunk, &cagg);
+
+		DEBUG_WAITPOINT("telemetry_classify_relation");
+
+		if (!reltype_has_stats(reltype))
+		{
+			MemoryContextSwitchTo(oldmcxt);
+			continue;
+		}
+
 		/* Lock the relation to ensure it does not disappear while we process
 		 * it */
 		LockRelationOid(class->oid, AccessShareLock);
@@ -534,20 +735,10 @@ ts_telemetry_stats_gather(TelemetryStats *stats)
 		if (!SearchSysCacheExists1(RELOID, ObjectIdGetDatum(class->oid)))
 		{
 			UnlockRelationOid(class->oid, AccessShareLock);
+			MemoryContextSwitchTo(oldmcxt);
 			continue;
 		}
 
-		/*
-		 * Use temporary per-relation memory context to not accumulate cruft
-		 * during processing of pg_class.
-		 */
-		oldmcxt = MemoryContextSwitchTo(relmcxt);
-		MemoryContextReset(relmcxt);
-
-		reltype = classify_relation(class, htcache, &ht, &chunk, &cagg);
-
-		DEBUG_WAITPOINT("telemetry_classify_relation");
-
 		switch (reltype)
 		{
 			case RELTYPE_HYPERTABLE:
@@ -575,7 +766,6 @@ ts_telemetry_stats_gather(TelemetryStats *stats)
 			case RELTYPE_CHUNK:
 			case RELTYPE_DISTRIBUTED_CHUNK:
 			case RELTYPE_DISTRIBUTED_CHUNK_MEMBER:
-			case RELTYPE_COMPRESSION_CHUNK:
 			case RELTYPE_MATERIALIZED_CHUNK:
 				Assert(NULL != chunk);
 				process_chunk(&statsctx, reltype, class, chunk);
@@ -598,6 +788,7 @@ ts_telemetry_stats_gather(TelemetryStats *stats)
 				/* No stats collected for types below */
 			case RELTYPE_COMPRESSION_HYPERTABLE:
 			case RELTYPE_MATERIALIZED_HYPERTABLE:
+			case RELTYPE_COMPRESSION_CHUNK:
 			case RELTYPE_OTHER:
 				break;
 		}
@@ -610,4 +801,5 @@ ts_telemetry_stats_gather(TelemetryStats *stats)
 	table_close(rel, AccessShareLock);
 	ts_cache_release(htcache);
 	MemoryContextDelete(relmcxt);
+	MemoryContextDelete(catalogmcxt);
 }
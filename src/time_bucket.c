@@ -6,12 +6,15 @@
 #include <postgres.h>
 #include <catalog/pg_type.h>
 #include <fmgr.h>
+#include <parser/scansup.h>
+#include <pgtime.h>
 #include <utils/builtins.h>
 #include <utils/date.h>
 #include <utils/datetime.h>
 #include <utils/fmgrprotos.h>
 #include <utils/timestamp.h>
 
+#include "compat/compat.h"
 #include "utils.h"
 #include "time_bucket.h"
 
@@ -321,6 +324,225 @@ ts_timestamptz_offset_bucket(PG_FUNCTION_ARGS)
 	PG_RETURN_DATUM(timestamp);
 }
 
+/*
+ * Cache of the UTC offset of a time zone for the timezone-aware variants of
+ * time_bucket(), kept in fn_extra. Converting to the local time and back with
+ * timestamptz_zone() and timestamp_zone() looks up the zone by name and does
+ * the calendar math for every row. Instead, we remember the range of UTC times
+ * around the last converted value where the zone has a constant UTC offset, so
+ * that converting the other times in this range is a single addition.
+ */
+typedef struct TimezoneOffsetCache
+{
+	/* The zone name the cache is for. */
+	char tzname[TZ_STRLEN_MAX + 1];
+	bool have_tzname;
+
+	/*
+	 * Whether we can use the cached offset for this zone. The dynamic-offset
+	 * abbreviations have their own rules, so we always use the slow path for
+	 * them.
+	 */
+	bool cacheable;
+
+	/* The zone, NULL for the fixed-offset abbreviations. */
+	pg_tz *tz;
+
+	/* The UTC offset of the zone in the range [range_start, range_end). */
+	TimestampTz range_start;
+	TimestampTz range_end;
+	int64 gmtoff;
+
+	/* The last origin converted to the local time. */
+	bool have_origin;
+	TimestampTz origin;
+	Timestamp local_origin;
+} TimezoneOffsetCache;
+
+/* How far back we look for the previous offset transition of a zone. */
+#define TZ_CACHE_LOOKBACK_SECS ((pg_time_t) 366 * SECS_PER_DAY)
+
+/*
+ * The UTC offsets differ by at most 26 hours, so a local time that is farther
+ * than this from the ends of the range with the cached offset maps to a unique
+ * UTC time inside the range.
+ */
+#define TZ_CACHE_MARGIN_USECS (2 * USECS_PER_DAY)
+
+#define UNIX_EPOCH_DIFF_SECS ((pg_time_t) (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * SECS_PER_DAY)
+
+/*
+ * Get the offset cache for the given zone name, or NULL if we have to use the
+ * slow path. There is no cache when the function is called through
+ * DirectFunctionCall.
+ */
+static TimezoneOffsetCache *
+tz_offset_cache_get(FunctionCallInfo fcinfo, Datum tzname_datum)
+{
+	text *tzname = DatumGetTextPP(tzname_datum);
+	const int len = VARSIZE_ANY_EXHDR(tzname);
+	TimezoneOffsetCache *cache;
+	char *lowzone;
+	int type, val;
+	pg_tz *tzp;
+
+	if (fcinfo->flinfo == NULL || len > TZ_STRLEN_MAX)
+		return NULL;
+
+	cache = (TimezoneOffsetCache *) fcinfo->flinfo->fn_extra;
+	if (cache == NULL)
+	{
+		cache = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt, sizeof(TimezoneOffsetCache));
+		fcinfo->flinfo->fn_extra = cache;
+	}
+	else if (cache->have_tzname && strlen(cache->tzname) == (size_t) len &&
+			 memcmp(cache->tzname, VARDATA_ANY(tzname), len) == 0)
+	{
+		return cache->cacheable ? cache : NULL;
+	}
+
+	memset(cache, 0, sizeof(TimezoneOffsetCache));
+	memcpy(cache->tzname, VARDATA_ANY(tzname), len);
+	cache->tzname[len] = '\0';
+	cache->have_tzname = true;
+
+	/* Resolve the zone name the same way as timestamptz_zone() does. */
+	lowzone = downcase_truncate_identifier(cache->tzname, len, false);
+	type = DecodeTimezoneAbbrevCompat(lowzone, &val, &tzp);
+	if (type == TZ || type == DTZ)
+	{
+		cache->cacheable = true;
+		cache->range_start = PG_INT64_MIN;
+		cache->range_end = PG_INT64_MAX;
+		cache->gmtoff = (int64) val * USECS_PER_SEC;
+	}
+	else if (type != DYNTZ)
+	{
+		/* An unknown zone is reported by the slow path. */
+		cache->tz = pg_tzset(cache->tzname);
+		cache->cacheable = cache->tz != NULL;
+	}
+	pfree(lowzone);
+
+	return cache->cacheable ? cache : NULL;
+}
+
+/*
+ * Make sure the cached offset applies to the given UTC time. Returns false if
+ * we couldn't determine the offset.
+ */
+static bool
+tz_offset_cache_lookup(TimezoneOffsetCache *cache, TimestampTz utc)
+{
+	pg_time_t t, probe, boundary;
+	long int before_gmtoff, after_gmtoff;
+	int before_isdst, after_isdst;
+	int res;
+
+	if (TIMESTAMP_NOT_FINITE(utc))
+		return false;
+
+	if (utc >= cache->range_start && utc < cache->range_end)
+		return true;
+
+	if (cache->tz == NULL)
+		return false;
+
+	t = utc / USECS_PER_SEC - (utc % USECS_PER_SEC < 0) + UNIX_EPOCH_DIFF_SECS;
+
+	/* Walk the transitions from a year before to find the range containing t. */
+	probe = t - TZ_CACHE_LOOKBACK_SECS;
+	for (;;)
+	{
+		res = pg_next_dst_boundary(&probe,
+								   &before_gmtoff,
+								   &before_isdst,
+								   &boundary,
+								   &after_gmtoff,
+								   &after_isdst,
+								   cache->tz);
+		if (res < 0)
+			return false;
+
+		if (res == 0 || boundary > t)
+			break;
+
+		probe = boundary;
+	}
+
+	cache->range_start = (probe - UNIX_EPOCH_DIFF_SECS) * USECS_PER_SEC;
+	cache->range_end = res == 0 ? PG_INT64_MAX : (boundary - UNIX_EPOCH_DIFF_SECS) * USECS_PER_SEC;
+	cache->gmtoff = (int64) before_gmtoff * USECS_PER_SEC;
+
+	return true;
+}
+
+/*
+ * Convert the given time to the local time in the zone, same as
+ * timestamptz_zone().
+ */
+static Timestamp
+tz_to_local(TimezoneOffsetCache *cache, Datum tzname, TimestampTz utc)
+{
+	if (cache != NULL && tz_offset_cache_lookup(cache, utc))
+	{
+		Timestamp local = utc + cache->gmtoff;
+		if (IS_VALID_TIMESTAMP(local))
+			return local;
+	}
+
+	return DatumGetTimestamp(
+		DirectFunctionCall2(timestamptz_zone, tzname, TimestampTzGetDatum(utc)));
+}
+
+/*
+ * Convert the given local time in the zone back to UTC, same as
+ * timestamp_zone(). We only use the cached offset when the local time is
+ * unambiguous in the cached range, otherwise the slow path deals with the
+ * nonexistent and repeated local times around the transitions.
+ */
+static TimestampTz
+tz_from_local(TimezoneOffsetCache *cache, Datum tzname, Timestamp local)
+{
+	if (cache != NULL && !TIMESTAMP_NOT_FINITE(local))
+	{
+		const int64 margin = cache->tz == NULL ? 0 : TZ_CACHE_MARGIN_USECS;
+		TimestampTz utc = local - cache->gmtoff;
+
+		if (IS_VALID_TIMESTAMP(utc) && utc >= cache->range_start + margin &&
+			utc < cache->range_end - margin)
+			return utc;
+	}
+
+	return DatumGetTimestampTz(
+		DirectFunctionCall2(timestamp_zone, tzname, TimestampGetDatum(local)));
+}
+
+/*
+ * Convert the origin to the local time in the zone. The origin is usually a
+ * constant, so we remember the last one.
+ */
+static Timestamp
+tz_origin_to_local(TimezoneOffsetCache *cache, Datum tzname, TimestampTz origin)
+{
+	Timestamp local;
+
+	if (cache != NULL && cache->have_origin && cache->origin == origin)
+		return cache->local_origin;
+
+	local = DatumGetTimestamp(
+		DirectFunctionCall2(timestamptz_zone, tzname, TimestampTzGetDatum(origin)));
+
+	if (cache != NULL)
+	{
+		cache->have_origin = true;
+		cache->origin = origin;
+		cache->local_origin = local;
+	}
+
+	return local;
+}
+
 TS_FUNCTION_INFO_V1(ts_timestamptz_timezone_bucket);
 
 /*
@@ -349,8 +571,10 @@ ts_timestamptz_timezone_bucket(PG_FUNCTION_ARGS)
 	if (PG_ARGISNULL(0) || PG_ARGISNULL(1) || PG_ARGISNULL(2))
 		PG_RETURN_NULL();
 
+	TimezoneOffsetCache *cache = tz_offset_cache_get(fcinfo, tzname);
+
 	/* Convert to local timestamp according to timezone */
-	timestamp = DirectFunctionCall2(timestamptz_zone, tzname, timestamp);
+	timestamp = TimestampGetDatum(tz_to_local(cache, tzname, DatumGetTimestampTz(timestamp)));
 	if (have_offset)
 	{
 		/* Apply offset. */
@@ -359,7 +583,8 @@ ts_timestamptz_timezone_bucket(PG_FUNCTION_ARGS)
 
 	if (have_origin)
 	{
-		Datum origin = DirectFunctionCall2(timestamptz_zone, tzname, PG_GETARG_DATUM(3));
+		Datum origin =
+			TimestampGetDatum(tz_origin_to_local(cache, tzname, PG_GETARG_TIMESTAMPTZ(3)));
 		timestamp = DirectFunctionCall3(ts_timestamp_bucket, period, timestamp, origin);
 	}
 	else
@@ -374,9 +599,7 @@ ts_timestamptz_timezone_bucket(PG_FUNCTION_ARGS)
 	}
 
 	/* Convert back to timezone */
-	timestamp = DirectFunctionCall2(timestamp_zone, tzname, timestamp);
-
-	PG_RETURN_DATUM(timestamp);
+	PG_RETURN_TIMESTAMPTZ(tz_from_local(cache, tzname, DatumGetTimestamp(timestamp)));
 }
 
 static inline void
@@ -686,12 +909,13 @@ ts_time_bucket_ng_timezone(PG_FUNCTION_ARGS)
 	Datum interval = PG_GETARG_DATUM(0);
 	Datum timestamptz = PG_GETARG_DATUM(1);
 	Datum tzname = PG_GETARG_DATUM(2);
+	TimezoneOffsetCache *cache = tz_offset_cache_get(fcinfo, tzname);
 
 	/*
 	 * Convert 'timestamptz' to TIMESTAMP at given 'tzname'.
 	 * The code is equal to 'timestamptz AT TIME ZONE tzname'.
 	 */
-	timestamp = DirectFunctionCall2(timestamptz_zone, tzname, timestamptz);
+	timestamp = TimestampGetDatum(tz_to_local(cache, tzname, DatumGetTimestampTz(timestamptz)));
 
 	/* Then treat resulting timestamp as a regular one */
 	result =
@@ -699,7 +923,7 @@ ts_time_bucket_ng_timezone(PG_FUNCTION_ARGS)
 	if (TIMESTAMP_NOT_FINITE(result))
 		PG_RETURN_TIMESTAMP(result);
 
-	PG_RETURN_DATUM(DirectFunctionCall2(timestamp_zone, tzname, TimestampGetDatum(result)));
+	PG_RETURN_TIMESTAMPTZ(tz_from_local(cache, tzname, result));
 }
 
 TS_FUNCTION_INFO_V1(ts_time_bucket_ng_timezone_origin);
@@ -712,15 +936,16 @@ ts_time_bucket_ng_timezone_origin(PG_FUNCTION_ARGS)
 	Datum timestamptz = PG_GETARG_DATUM(1);
 	Datum origintz = PG_GETARG_DATUM(2);
 	Datum tzname = PG_GETARG_DATUM(3);
+	TimezoneOffsetCache *cache = tz_offset_cache_get(fcinfo, tzname);
 
 	/*
 	 * Convert 'origin' to TIMESTAMP at given 'tzname'.
 	 * The code is equal to 'origin AT TIME ZONE tzname'.
 	 */
-	origin = DirectFunctionCall2(timestamptz_zone, tzname, origintz);
+	origin = TimestampGetDatum(tz_origin_to_local(cache, tzname, DatumGetTimestampTz(origintz)));
 
 	/* Same for 'timestamptz' */
-	timestamp = DirectFunctionCall2(timestamptz_zone, tzname, timestamptz);
+	timestamp = TimestampGetDatum(tz_to_local(cache, tzname, DatumGetTimestampTz(timestamptz)));
 
 	/* Then treat resulting 'timestamp' and 'origin' as a regular ones */
 	result = DatumGetTimestamp(
@@ -728,5 +953,5 @@ ts_time_bucket_ng_timezone_origin(PG_FUNCTION_ARGS)
 	if (TIMESTAMP_NOT_FINITE(result))
 		PG_RETURN_TIMESTAMP(result);
 
-	PG_RETURN_DATUM(DirectFunctionCall2(timestamp_zone, tzname, TimestampGetDatum(result)));
+	PG_RETURN_TIMESTAMPTZ(tz_from_local(cache, tzname, result));
 }
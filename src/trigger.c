@@ -108,11 +108,16 @@ create_trigger_handler(const Trigger *trigger, void *arg)
 {
 	const Chunk *chunk = arg;
 
-	if (TRIGGER_USES_TRANSITION_TABLE(trigger->tgnewtable) ||
-		TRIGGER_USES_TRANSITION_TABLE(trigger->tgoldtable))
+	/*
+	 * The statement triggers with transition tables stay on the hypertable,
+	 * which collects the rows of all chunks for them.
+	 */
+	if (TRIGGER_FOR_ROW(trigger->tgtype) &&
+		(TRIGGER_USES_TRANSITION_TABLE(trigger->tgnewtable) ||
+		 TRIGGER_USES_TRANSITION_TABLE(trigger->tgoldtable)))
 		ereport(ERROR,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-				 errmsg("hypertables do not support transition tables in triggers")));
+				 errmsg("hypertables do not support transition tables in row triggers")));
 
 	if (trigger_is_chunk_trigger(trigger))
 		ts_trigger_create_on_chunk(trigger->tgoid,
@@ -160,12 +165,13 @@ ts_trigger_create_all_on_chunk(const Chunk *chunk)
 }
 
 static bool
-check_for_transition_table(const Trigger *trigger, void *arg)
+check_for_row_transition_table(const Trigger *trigger, void *arg)
 {
 	bool *found = arg;
 
-	if (TRIGGER_USES_TRANSITION_TABLE(trigger->tgnewtable) ||
-		TRIGGER_USES_TRANSITION_TABLE(trigger->tgoldtable))
+	if (TRIGGER_FOR_ROW(trigger->tgtype) &&
+		(TRIGGER_USES_TRANSITION_TABLE(trigger->tgnewtable) ||
+		 TRIGGER_USES_TRANSITION_TABLE(trigger->tgoldtable)))
 	{
 		*found = true;
 		return false;
@@ -174,12 +180,17 @@ check_for_transition_table(const Trigger *trigger, void *arg)
 	return true;
 }
 
+/*
+ * Check for row triggers with transition tables, which would have to be
+ * replicated on the chunks. The statement triggers with transition tables
+ * are supported on hypertables.
+ */
 bool
-ts_relation_has_transition_table_trigger(Oid relid)
+ts_relation_has_row_transition_table_trigger(Oid relid)
 {
 	bool found = false;
 
-	for_each_trigger(relid, check_for_transition_table, &found);
+	for_each_trigger(relid, check_for_row_transition_table, &found);
 
 	return found;
 }
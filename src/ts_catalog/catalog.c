@@ -22,6 +22,7 @@
 #include "ts_catalog/catalog.h"
 #include "extension.h"
 #include "cache_invalidate.h"
+#include "hypertable.h"
 #include "utils.h"
 
 static const TableInfoDef catalog_table_names[_MAX_CATALOG_TABLES + 1] = {
@@ -129,6 +130,18 @@ static const TableInfoDef catalog_table_names[_MAX_CATALOG_TABLES + 1] = {
 		.schema_name = CATALOG_SCHEMA_NAME,
 		.table_name = TELEMETRY_EVENT_TABLE_NAME,
 	},
+	[BGW_JOB_STAT_HISTOGRAM] = {
+		.schema_name = INTERNAL_SCHEMA_NAME,
+		.table_name = BGW_JOB_STAT_HISTOGRAM_TABLE_NAME,
+	},
+	[HYPERTABLE_LAST_POINT_CACHE] = {
+		.schema_name = CATALOG_SCHEMA_NAME,
+		.table_name = HYPERTABLE_LAST_POINT_CACHE_TABLE_NAME,
+	},
+	[CHUNK_COLUMN_STATS] = {
+		.schema_name = CATALOG_SCHEMA_NAME,
+		.table_name = CHUNK_COLUMN_STATS_TABLE_NAME,
+	},
 	[_MAX_CATALOG_TABLES] = {
 		.schema_name = "invalid schema",
 		.table_name = "invalid table",
@@ -222,6 +235,12 @@ static const TableIndexDef catalog_table_index_definitions[_MAX_CATALOG_TABLES]
 			[BGW_JOB_STAT_PKEY_IDX] = "bgw_job_stat_pkey",
 		},
 	},
+	[BGW_JOB_STAT_HISTOGRAM] = {
+		.length = _MAX_BGW_JOB_STAT_HISTOGRAM_INDEX,
+		.names = (char *[]) {
+			[BGW_JOB_STAT_HISTOGRAM_PKEY_IDX] = "bgw_job_stat_histogram_pkey",
+		},
+	},
 	[METADATA] = {
 		.length = _MAX_METADATA_INDEX,
 		.names = (char *[]) {
@@ -267,6 +286,18 @@ static const TableIndexDef catalog_table_index_definitions[_MAX_CATALOG_TABLES]
 			[CONTINUOUS_AGGS_WATERMARK_PKEY] = "continuous_aggs_watermark_pkey",
 		},
 	},
+	[HYPERTABLE_LAST_POINT_CACHE] = {
+		.length = _MAX_HYPERTABLE_LAST_POINT_CACHE_INDEX,
+		.names = (char *[]) {
+			[HYPERTABLE_LAST_POINT_CACHE_PKEY] = "hypertable_last_point_cache_pkey",
+		},
+	},
+	[CHUNK_COLUMN_STATS] = {
+		.length = _MAX_CHUNK_COLUMN_STATS_INDEX,
+		.names = (char *[]) {
+			[CHUNK_COLUMN_STATS_PKEY] = "chunk_column_stats_pkey",
+		},
+	},
 	[HYPERTABLE_COMPRESSION] = {
 		.length =  _MAX_HYPERTABLE_COMPRESSION_INDEX,
 		.names = (char *[]) {
@@ -690,11 +721,78 @@ ts_catalog_insert_values(Relation rel, TupleDesc tupdesc, Datum *values, bool *n
 	heap_freetuple(tuple);
 }
 
+/*
+ * Get the main table of the hypertable that an updated catalog tuple belongs
+ * to, for the catalog tables where an update only affects the cache entry of
+ * that hypertable. Returns InvalidOid if the update can't be attributed to a
+ * single hypertable.
+ */
+static Oid
+catalog_tuple_get_hypertable_relid(Relation rel, HeapTuple tuple)
+{
+	TupleDesc desc = RelationGetDescr(rel);
+	AttrNumber hypertable_id_attno;
+	bool isnull;
+	Datum datum;
+
+	switch (catalog_get_table(ts_catalog_get(), RelationGetRelid(rel)))
+	{
+		case HYPERTABLE:
+		{
+			/*
+			 * Use the names in the new tuple, since a rename also updates
+			 * them. If the relation doesn't have the new name yet, we fall
+			 * back to invalidating all hypertables.
+			 */
+			bool schema_isnull;
+			Datum schema_name =
+				heap_getattr(tuple, Anum_hypertable_schema_name, desc, &schema_isnull);
+			Datum table_name = heap_getattr(tuple, Anum_hypertable_table_name, desc, &isnull);
+
+			if (schema_isnull || isnull)
+				return InvalidOid;
+
+			return ts_get_relation_relid(NameStr(*DatumGetName(schema_name)),
+										 NameStr(*DatumGetName(table_name)),
+										 true);
+		}
+		case DIMENSION:
+			hypertable_id_attno = Anum_dimension_hypertable_id;
+			break;
+		case CHUNK:
+			hypertable_id_attno = Anum_chunk_hypertable_id;
+			break;
+		default:
+			return InvalidOid;
+	}
+
+	datum = heap_getattr(tuple, hypertable_id_attno, desc, &isnull);
+
+	if (isnull)
+		return InvalidOid;
+
+	return ts_hypertable_id_to_relid(DatumGetInt32(datum), true);
+}
+
 void
 ts_catalog_update_tid_only(Relation rel, ItemPointer tid, HeapTuple tuple)
 {
+	Oid hypertable_relid;
+
 	CatalogTupleUpdate(rel, tid, tuple);
-	ts_catalog_invalidate_cache(RelationGetRelid(rel), CMD_UPDATE);
+
+	/*
+	 * Updates of a hypertable, its dimensions or chunks only need to
+	 * invalidate the cache entry of that hypertable, which we signal with a
+	 * relcache invalidation of its main table. This keeps the cached entries
+	 * of the other hypertables, see ts_hypertable_cache_invalidate_relid().
+	 */
+	hypertable_relid = catalog_tuple_get_hypertable_relid(rel, tuple);
+
+	if (OidIsValid(hypertable_relid))
+		CacheInvalidateRelcacheByRelid(hypertable_relid);
+	else
+		ts_catalog_invalidate_cache(RelationGetRelid(rel), CMD_UPDATE);
 }
 
 void
@@ -758,6 +856,13 @@ ts_catalog_invalidate_cache(Oid catalog_relid, CmdType operation)
 	{
 		case CHUNK:
 		case CHUNK_CONSTRAINT:
+			/*
+			 * New chunks and their constraints change the chunk slices of the
+			 * hypertable, see chunk_slice_cache.c
+			 */
+			relid = ts_catalog_get_cache_proxy_id(catalog, CACHE_TYPE_HYPERTABLE);
+			CacheInvalidateRelcacheByRelid(relid);
+			break;
 		case CHUNK_DATA_NODE:
 		case DIMENSION_SLICE:
 			if (operation == CMD_UPDATE || operation == CMD_DELETE)
@@ -59,6 +59,9 @@ typedef enum CatalogTable
 	JOB_ERRORS,
 	CONTINUOUS_AGGS_WATERMARK,
 	TELEMETRY_EVENT,
+	BGW_JOB_STAT_HISTOGRAM,
+	HYPERTABLE_LAST_POINT_CACHE,
+	CHUNK_COLUMN_STATS,
 	/* Don't forget updating catalog.c when adding new tables! */
 	_MAX_CATALOG_TABLES,
 } CatalogTable;
@@ -846,6 +849,38 @@ enum Anum_bgw_job_stat_pkey_idx
 
 #define Natts_bjw_job_stat_pkey_idx (_Anum_bgw_job_stat_pkey_idx_max - 1)
 
+/**********************************************
+ *
+ * bgw_job_stat_histogram table definitions
+ *
+ **********************************************/
+
+#define BGW_JOB_STAT_HISTOGRAM_TABLE_NAME "bgw_job_stat_histogram"
+
+enum Anum_bgw_job_stat_histogram
+{
+	Anum_bgw_job_stat_histogram_job_id = 1,
+	Anum_bgw_job_stat_histogram_duration_ms,
+	Anum_bgw_job_stat_histogram_bytes_read,
+	Anum_bgw_job_stat_histogram_bytes_written,
+	Anum_bgw_job_stat_histogram_wal_bytes,
+	_Anum_bgw_job_stat_histogram_max,
+};
+
+#define Natts_bgw_job_stat_histogram (_Anum_bgw_job_stat_histogram_max - 1)
+
+enum
+{
+	BGW_JOB_STAT_HISTOGRAM_PKEY_IDX = 0,
+	_MAX_BGW_JOB_STAT_HISTOGRAM_INDEX,
+};
+
+enum Anum_bgw_job_stat_histogram_pkey_idx
+{
+	Anum_bgw_job_stat_histogram_pkey_idx_job_id = 1,
+	_Anum_bgw_job_stat_histogram_pkey_idx_max,
+};
+
 /******************************
  *
  * metadata table definitions
@@ -1223,6 +1258,77 @@ typedef enum Anum_continuous_aggs_watermark_pkey
 
 #define Natts_continuous_aggs_watermark_pkey (_Anum_continuous_aggs_watermark_pkey_max - 1)
 
+/****** HYPERTABLE_LAST_POINT_CACHE_TABLE definitions*/
+#define HYPERTABLE_LAST_POINT_CACHE_TABLE_NAME "hypertable_last_point_cache"
+typedef enum Anum_hypertable_last_point_cache
+{
+	Anum_hypertable_last_point_cache_hypertable_id = 1,
+	Anum_hypertable_last_point_cache_cache_schema_name,
+	Anum_hypertable_last_point_cache_cache_table_name,
+	Anum_hypertable_last_point_cache_valid,
+	Anum_hypertable_last_point_cache_series_key,
+	_Anum_hypertable_last_point_cache_max,
+} Anum_hypertable_last_point_cache;
+
+#define Natts_hypertable_last_point_cache (_Anum_hypertable_last_point_cache_max - 1)
+
+enum
+{
+	HYPERTABLE_LAST_POINT_CACHE_PKEY = 0,
+	_MAX_HYPERTABLE_LAST_POINT_CACHE_INDEX,
+};
+
+typedef enum Anum_hypertable_last_point_cache_pkey
+{
+	Anum_hypertable_last_point_cache_pkey_hypertable_id = 1,
+	_Anum_hypertable_last_point_cache_pkey_max,
+} Anum_hypertable_last_point_cache_pkey;
+
+#define Natts_hypertable_last_point_cache_pkey (_Anum_hypertable_last_point_cache_pkey_max - 1)
+
+/****** CHUNK_COLUMN_STATS_TABLE definitions*/
+#define CHUNK_COLUMN_STATS_TABLE_NAME "chunk_column_stats"
+typedef enum Anum_chunk_column_stats
+{
+	Anum_chunk_column_stats_hypertable_id = 1,
+	Anum_chunk_column_stats_chunk_id,
+	Anum_chunk_column_stats_column_name,
+	Anum_chunk_column_stats_range_start,
+	Anum_chunk_column_stats_range_end,
+	Anum_chunk_column_stats_valid,
+	_Anum_chunk_column_stats_max,
+} Anum_chunk_column_stats;
+
+#define Natts_chunk_column_stats (_Anum_chunk_column_stats_max - 1)
+
+typedef struct FormData_chunk_column_stats
+{
+	int32 hypertable_id;
+	int32 chunk_id;
+	NameData column_name;
+	int64 range_start;
+	int64 range_end;
+	bool valid;
+} FormData_chunk_column_stats;
+
+typedef FormData_chunk_column_stats *Form_chunk_column_stats;
+
+enum
+{
+	CHUNK_COLUMN_STATS_PKEY = 0,
+	_MAX_CHUNK_COLUMN_STATS_INDEX,
+};
+
+typedef enum Anum_chunk_column_stats_pkey
+{
+	Anum_chunk_column_stats_pkey_hypertable_id = 1,
+	Anum_chunk_column_stats_pkey_chunk_id,
+	Anum_chunk_column_stats_pkey_column_name,
+	_Anum_chunk_column_stats_pkey_max,
+} Anum_chunk_column_stats_pkey;
+
+#define Natts_chunk_column_stats_pkey (_Anum_chunk_column_stats_pkey_max - 1)
+
 #define HYPERTABLE_COMPRESSION_TABLE_NAME "hypertable_compression"
 typedef enum Anum_hypertable_compression
 {
@@ -0,0 +1,819 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+/*
+ * Chunk skipping on the columns that are not dimensions.
+ *
+ * The range of a tracked column is stored per chunk in the chunk_column_stats
+ * catalog table. The planner excludes the chunks whose range contradicts the
+ * restrictions of the query on the column, the same way the dimension slices
+ * exclude chunks, and ChunkAppend uses the ranges as constraints of the chunks
+ * for the startup and runtime exclusion.
+ *
+ * The ranges are only computed for the chunks that are compressed, since the
+ * data of the other chunks is still changing. Any change that can widen the
+ * range of a chunk, e.g. an insert into a compressed chunk or its
+ * decompression, marks the range invalid, and it is not used until the chunk
+ * is compressed again.
+ */
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <access/stratnum.h>
+#include <access/xact.h>
+#include <catalog/pg_class.h>
+#include <catalog/pg_type.h>
+#include <executor/spi.h>
+#include <lib/stringinfo.h>
+#include <miscadmin.h>
+#include <nodes/makefuncs.h>
+#include <nodes/nodeFuncs.h>
+#include <storage/lmgr.h>
+#include <utils/builtins.h>
+#include <utils/fmgroids.h>
+#include <utils/inval.h>
+#include <utils/lsyscache.h>
+#include <utils/rel.h>
+#include <utils/typcache.h>
+
+#include "chunk.h"
+#include "debug_assert.h"
+#include "hypertable_cache.h"
+#include "scan_iterator.h"
+#include "scanner.h"
+#include "time_utils.h"
+#include "ts_catalog/catalog.h"
+#include "ts_catalog/chunk_column_stats.h"
+#include "utils.h"
+
+/* The chunk id of the row that marks a column of the hypertable as tracked */
+#define CHUNK_COLUMN_STATS_HYPERTABLE_ROW 0
+/* Scan the rows of all the chunks, see chunk_column_stats_init_scan() */
+#define CHUNK_COLUMN_STATS_ANY_CHUNK -1
+
+#define IS_VALID_RANGE_COLUMN_TYPE(type) (IS_INTEGER_TYPE(type) || IS_TIMESTAMP_TYPE(type))
+
+static void
+chunk_column_stats_init_scan(ScanIterator *iterator, int32 hypertable_id, int32 chunk_id,
+							 const char *column_name)
+{
+	iterator->ctx.index =
+		catalog_get_index(ts_catalog_get(), CHUNK_COLUMN_STATS, CHUNK_COLUMN_STATS_PKEY);
+	ts_scan_iterator_scan_key_init(iterator,
+								   Anum_chunk_column_stats_pkey_hypertable_id,
+								   BTEqualStrategyNumber,
+								   F_INT4EQ,
+								   Int32GetDatum(hypertable_id));
+
+	if (chunk_id != CHUNK_COLUMN_STATS_ANY_CHUNK)
+		ts_scan_iterator_scan_key_init(iterator,
+									   Anum_chunk_column_stats_pkey_chunk_id,
+									   BTEqualStrategyNumber,
+									   F_INT4EQ,
+									   Int32GetDatum(chunk_id));
+
+	if (column_name != NULL)
+		ts_scan_iterator_scan_key_init(iterator,
+									   Anum_chunk_column_stats_pkey_column_name,
+									   BTEqualStrategyNumber,
+									   F_NAMEEQ,
+									   CStringGetDatum(column_name));
+}
+
+static void
+chunk_column_stats_formdata_fill(FormData_chunk_column_stats *fd, const TupleInfo *ti)
+{
+	bool should_free;
+	HeapTuple tuple = ts_scanner_fetch_heap_tuple(ti, false, &should_free);
+	Datum values[Natts_chunk_column_stats];
+	bool nulls[Natts_chunk_column_stats];
+
+	heap_deform_tuple(tuple, ts_scanner_get_tupledesc(ti), values, nulls);
+
+	fd->hypertable_id =
+		DatumGetInt32(values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_hypertable_id)]);
+	fd->chunk_id =
+		DatumGetInt32(values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_chunk_id)]);
+	namestrcpy(&fd->column_name,
+			   NameStr(*DatumGetName(
+				   values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_column_name)])));
+	fd->range_start =
+		DatumGetInt64(values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_range_start)]);
+	fd->range_end =
+		DatumGetInt64(values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_range_end)]);
+	fd->valid = DatumGetBool(values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_valid)]);
+
+	if (should_free)
+		heap_freetuple(tuple);
+}
+
+static void
+chunk_column_stats_insert(int32 hypertable_id, int32 chunk_id, const char *column_name,
+						  int64 range_start, int64 range_end)
+{
+	Datum values[Natts_chunk_column_stats] = { 0 };
+	bool nulls[Natts_chunk_column_stats] = { false };
+	CatalogSecurityContext sec_ctx;
+	NameData name;
+	Relation rel;
+
+	namestrcpy(&name, column_name);
+	values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_hypertable_id)] =
+		Int32GetDatum(hypertable_id);
+	values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_chunk_id)] = Int32GetDatum(chunk_id);
+	values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_column_name)] = NameGetDatum(&name);
+	values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_range_start)] =
+		Int64GetDatum(range_start);
+	values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_range_end)] = Int64GetDatum(range_end);
+	values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_valid)] = BoolGetDatum(true);
+
+	rel = table_open(catalog_get_table_id(ts_catalog_get(), CHUNK_COLUMN_STATS), RowExclusiveLock);
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+	ts_catalog_insert_values(rel, RelationGetDescr(rel), values, nulls);
+	ts_catalog_restore_user(&sec_ctx);
+	table_close(rel, RowExclusiveLock);
+}
+
+/*
+ * Delete the rows matching the keys, see chunk_column_stats_init_scan().
+ * Returns the ids of the chunks of the deleted rows.
+ */
+static List *
+chunk_column_stats_delete(int32 hypertable_id, int32 chunk_id, const char *column_name)
+{
+	ScanIterator iterator =
+		ts_scan_iterator_create(CHUNK_COLUMN_STATS, RowExclusiveLock, CurrentMemoryContext);
+	CatalogSecurityContext sec_ctx;
+	List *chunk_ids = NIL;
+
+	chunk_column_stats_init_scan(&iterator, hypertable_id, chunk_id, column_name);
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		bool isnull;
+		Datum id = slot_getattr(ti->slot, Anum_chunk_column_stats_chunk_id, &isnull);
+
+		Assert(!isnull);
+		chunk_ids = lappend_int(chunk_ids, DatumGetInt32(id));
+		ts_catalog_delete_tid(ti->scanrel, ts_scanner_get_tuple_tid(ti));
+	}
+	ts_catalog_restore_user(&sec_ctx);
+	ts_scan_iterator_close(&iterator);
+
+	return chunk_ids;
+}
+
+void
+ts_chunk_column_stats_delete_by_chunk_id(int32 hypertable_id, int32 chunk_id)
+{
+	chunk_column_stats_delete(hypertable_id, chunk_id, NULL);
+}
+
+void
+ts_chunk_column_stats_delete_by_hypertable_id(int32 hypertable_id)
+{
+	chunk_column_stats_delete(hypertable_id, CHUNK_COLUMN_STATS_ANY_CHUNK, NULL);
+}
+
+/*
+ * Stop tracking a column of a hypertable, and remove its ranges in all the
+ * chunks.
+ */
+static void
+chunk_column_stats_delete_column(int32 hypertable_id, Oid hypertable_relid,
+								 const char *column_name)
+{
+	List *chunk_ids =
+		chunk_column_stats_delete(hypertable_id, CHUNK_COLUMN_STATS_ANY_CHUNK, column_name);
+	ListCell *lc;
+
+	if (chunk_ids == NIL)
+		return;
+
+	foreach (lc, chunk_ids)
+	{
+		Oid chunk_relid;
+
+		if (lfirst_int(lc) == CHUNK_COLUMN_STATS_HYPERTABLE_ROW)
+			continue;
+
+		/* The constraints of the chunk changed, see relation_constraint_cache.c */
+		chunk_relid = ts_chunk_get_relid(lfirst_int(lc), true);
+		if (OidIsValid(chunk_relid))
+			CacheInvalidateRelcacheByRelid(chunk_relid);
+	}
+
+	CacheInvalidateRelcacheByRelid(hypertable_relid);
+}
+
+/*
+ * Remove the ranges of a column that is dropped or renamed. The ranges are
+ * stored by column name, so they would otherwise apply to another column
+ * that gets the same name later.
+ */
+void
+ts_chunk_column_stats_delete_by_column(const Hypertable *ht, const char *column_name)
+{
+	chunk_column_stats_delete_column(ht->fd.id, ht->main_table_relid, column_name);
+}
+
+/*
+ * Get the tracked columns of a hypertable. Returns NULL if the hypertable
+ * has none, which is the common case.
+ *
+ * The columns are stored by name, so a tracked column that was dropped or
+ * renamed, or had its type changed to an unsupported type, is not tracked
+ * any longer.
+ */
+ChunkRangeSpace *
+ts_chunk_column_stats_range_space_scan(int32 hypertable_id, Oid hypertable_relid,
+									   MemoryContext mcxt)
+{
+	ScanIterator iterator =
+		ts_scan_iterator_create(CHUNK_COLUMN_STATS, AccessShareLock, CurrentMemoryContext);
+	ChunkRangeSpace *range_space = NULL;
+	List *columns = NIL;
+	ListCell *lc;
+
+	if (!OidIsValid(hypertable_relid))
+		return NULL;
+
+	chunk_column_stats_init_scan(&iterator,
+								 hypertable_id,
+								 CHUNK_COLUMN_STATS_HYPERTABLE_ROW,
+								 NULL);
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		bool isnull;
+		Datum name = slot_getattr(ti->slot, Anum_chunk_column_stats_column_name, &isnull);
+
+		Assert(!isnull);
+		columns = lappend(columns, pstrdup(NameStr(*DatumGetName(name))));
+	}
+	ts_scan_iterator_close(&iterator);
+
+	if (columns == NIL)
+		return NULL;
+
+	range_space = MemoryContextAllocZero(mcxt,
+										 sizeof(ChunkRangeSpace) +
+											 sizeof(ChunkRangeColumn) * list_length(columns));
+	range_space->hypertable_id = hypertable_id;
+
+	foreach (lc, columns)
+	{
+		const char *column_name = lfirst(lc);
+		ChunkRangeColumn *column = &range_space->columns[range_space->num_columns];
+		AttrNumber attno = get_attnum(hypertable_relid, column_name);
+
+		if (attno == InvalidAttrNumber)
+			continue;
+
+		column->type = get_atttype(hypertable_relid, attno);
+		if (!IS_VALID_RANGE_COLUMN_TYPE(column->type))
+			continue;
+
+		namestrcpy(&column->column_name, column_name);
+		column->attno = attno;
+		range_space->num_columns++;
+	}
+
+	if (range_space->num_columns == 0)
+	{
+		pfree(range_space);
+		return NULL;
+	}
+
+	return range_space;
+}
+
+/*
+ * Get the index of the tracked column in the range space of the hypertable,
+ * or -1 if the column is not tracked.
+ */
+int
+ts_chunk_column_stats_get_column(const Hypertable *ht, AttrNumber attno)
+{
+	if (ht->range_space == NULL)
+		return -1;
+
+	for (int i = 0; i < ht->range_space->num_columns; i++)
+	{
+		if (ht->range_space->columns[i].attno == attno)
+			return i;
+	}
+
+	return -1;
+}
+
+static int
+range_space_find_column(const ChunkRangeSpace *range_space, const char *column_name)
+{
+	for (int i = 0; i < range_space->num_columns; i++)
+	{
+		if (namestrcmp((Name) &range_space->columns[i].column_name, column_name) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+/*
+ * Get the valid ranges of the tracked columns in the chunks of the
+ * hypertable, ordered by the chunk id.
+ */
+List *
+ts_chunk_column_stats_get_ranges(const Hypertable *ht)
+{
+	ScanIterator iterator;
+	List *ranges = NIL;
+
+	if (ht->range_space == NULL)
+		return NIL;
+
+	iterator = ts_scan_iterator_create(CHUNK_COLUMN_STATS, AccessShareLock, CurrentMemoryContext);
+	chunk_column_stats_init_scan(&iterator, ht->fd.id, CHUNK_COLUMN_STATS_ANY_CHUNK, NULL);
+	ts_scanner_foreach(&iterator)
+	{
+		FormData_chunk_column_stats fd;
+		ChunkColumnRange *range;
+		int column;
+
+		chunk_column_stats_formdata_fill(&fd, ts_scan_iterator_tuple_info(&iterator));
+
+		if (fd.chunk_id == CHUNK_COLUMN_STATS_HYPERTABLE_ROW || !fd.valid)
+			continue;
+
+		column = range_space_find_column(ht->range_space, NameStr(fd.column_name));
+		if (column < 0)
+			continue;
+
+		range = palloc(sizeof(ChunkColumnRange));
+		range->chunk_id = fd.chunk_id;
+		range->column = column;
+		range->range_start = fd.range_start;
+		range->range_end = fd.range_end;
+		ranges = lappend(ranges, range);
+	}
+	ts_scan_iterator_close(&iterator);
+
+	return ranges;
+}
+
+static Expr *
+make_range_clause(Var *var, TypeCacheEntry *tce, StrategyNumber strategy, int64 value)
+{
+	Oid opno = get_opfamily_member(tce->btree_opf, tce->type_id, tce->type_id, strategy);
+	Const *bound;
+	OpExpr *clause;
+
+	if (!OidIsValid(opno))
+		return NULL;
+
+	bound = makeConst(tce->type_id,
+					  -1,
+					  InvalidOid,
+					  tce->typlen,
+					  ts_internal_to_time_value(value, tce->type_id),
+					  false,
+					  tce->typbyval);
+	clause = (OpExpr *) make_opclause(opno,
+									  BOOLOID,
+									  false,
+									  (Expr *) copyObject(var),
+									  (Expr *) bound,
+									  InvalidOid,
+									  InvalidOid);
+	set_opfuncid(clause);
+
+	return (Expr *) clause;
+}
+
+/*
+ * Get the valid ranges of the tracked columns of a chunk as constraints in
+ * the form used for constraint exclusion, with Vars of varno 1.
+ */
+List *
+ts_chunk_column_stats_get_constraints(Relation chunk_rel)
+{
+	Oid relid = RelationGetRelid(chunk_rel);
+	FormData_chunk form;
+	ScanIterator iterator;
+	List *constraints = NIL;
+
+	if (!ts_chunk_get_formdata_by_relid(relid, &form))
+		return NIL;
+
+	iterator = ts_scan_iterator_create(CHUNK_COLUMN_STATS, AccessShareLock, CurrentMemoryContext);
+	chunk_column_stats_init_scan(&iterator, form.hypertable_id, form.id, NULL);
+	ts_scanner_foreach(&iterator)
+	{
+		FormData_chunk_column_stats fd;
+		Form_pg_attribute attr;
+		TypeCacheEntry *tce;
+		AttrNumber attno;
+		Expr *clause;
+		Var *var;
+
+		chunk_column_stats_formdata_fill(&fd, ts_scan_iterator_tuple_info(&iterator));
+
+		if (!fd.valid)
+			continue;
+
+		attno = get_attnum(relid, NameStr(fd.column_name));
+		if (attno == InvalidAttrNumber)
+			continue;
+
+		attr = TupleDescAttr(RelationGetDescr(chunk_rel), AttrNumberGetAttrOffset(attno));
+		if (!IS_VALID_RANGE_COLUMN_TYPE(attr->atttypid))
+			continue;
+
+		tce = lookup_type_cache(attr->atttypid, TYPECACHE_BTREE_OPFAMILY);
+		var = makeVar(1, attno, attr->atttypid, attr->atttypmod, attr->attcollation, 0);
+
+		clause = make_range_clause(var, tce, BTGreaterEqualStrategyNumber, fd.range_start);
+		if (clause != NULL)
+			constraints = lappend(constraints, clause);
+
+		clause = make_range_clause(var, tce, BTLessEqualStrategyNumber, fd.range_end);
+		if (clause != NULL)
+			constraints = lappend(constraints, clause);
+	}
+	ts_scan_iterator_close(&iterator);
+
+	return constraints;
+}
+
+/*
+ * Compute the ranges of the given columns in the chunk, and store them as
+ * the valid ranges of the chunk. The columns that only have NULL values,
+ * e.g. because the chunk is empty, get no range.
+ */
+static void
+chunk_column_stats_calculate(const ChunkRangeSpace *range_space, const Chunk *chunk)
+{
+	StringInfoData command;
+	int64 *range_start = palloc(sizeof(int64) * range_space->num_columns);
+	int64 *range_end = palloc(sizeof(int64) * range_space->num_columns);
+	bool *has_range = palloc(sizeof(bool) * range_space->num_columns);
+	int res;
+
+	/*
+	 * Fully schema-qualify everything, since this might run as part of a
+	 * parallel operation where we cannot lock down the search_path.
+	 */
+	initStringInfo(&command);
+	appendStringInfoString(&command, "SELECT ");
+	for (int i = 0; i < range_space->num_columns; i++)
+	{
+		const char *column = quote_identifier(NameStr(range_space->columns[i].column_name));
+
+		appendStringInfo(&command,
+						 "%spg_catalog.min(%s), pg_catalog.max(%s)",
+						 i > 0 ? ", " : "",
+						 column,
+						 column);
+	}
+	appendStringInfo(&command,
+					 " FROM %s.%s",
+					 quote_identifier(NameStr(chunk->fd.schema_name)),
+					 quote_identifier(NameStr(chunk->fd.table_name)));
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "could not connect to SPI");
+
+	res = SPI_execute(command.data, true /* read_only */, 0 /*count*/);
+	if (res != SPI_OK_SELECT || SPI_processed != 1)
+		elog(ERROR, "could not execute \"%s\": %s", command.data, SPI_result_code_string(res));
+
+	for (int i = 0; i < range_space->num_columns; i++)
+	{
+		Oid type = range_space->columns[i].type;
+		bool min_isnull;
+		bool max_isnull;
+		Datum min =
+			SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 2 * i + 1, &min_isnull);
+		Datum max =
+			SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 2 * i + 2, &max_isnull);
+
+		Ensure(SPI_gettypeid(SPI_tuptable->tupdesc, 2 * i + 1) == type,
+			   "type of the range (%d) and the column (%d) do not match",
+			   SPI_gettypeid(SPI_tuptable->tupdesc, 2 * i + 1),
+			   type);
+
+		has_range[i] = !min_isnull && !max_isnull;
+		if (has_range[i])
+		{
+			range_start[i] = ts_time_value_to_internal_or_infinite(min, type, NULL);
+			range_end[i] = ts_time_value_to_internal_or_infinite(max, type, NULL);
+		}
+	}
+
+	if ((res = SPI_finish()) != SPI_OK_FINISH)
+		elog(ERROR, "SPI_finish failed: %s", SPI_result_code_string(res));
+
+	for (int i = 0; i < range_space->num_columns; i++)
+	{
+		const char *column = NameStr(range_space->columns[i].column_name);
+
+		chunk_column_stats_delete(chunk->fd.hypertable_id, chunk->fd.id, column);
+
+		if (has_range[i])
+			chunk_column_stats_insert(chunk->fd.hypertable_id,
+									  chunk->fd.id,
+									  column,
+									  range_start[i],
+									  range_end[i]);
+	}
+
+	/* The constraints of the chunk changed, see relation_constraint_cache.c */
+	CacheInvalidateRelcacheByRelid(chunk->table_id);
+}
+
+/*
+ * Compute the ranges of the tracked columns in a chunk. The caller has to
+ * make sure that the chunk cannot be modified until the end of the
+ * transaction.
+ */
+void
+ts_chunk_column_stats_calculate(const Hypertable *ht, const Chunk *chunk)
+{
+	if (ht->range_space == NULL)
+		return;
+
+	chunk_column_stats_calculate(ht->range_space, chunk);
+}
+
+static ScanFilterResult
+chunk_column_stats_filter_valid(const TupleInfo *ti, void *data)
+{
+	bool isnull;
+	Datum valid = slot_getattr(ti->slot, Anum_chunk_column_stats_valid, &isnull);
+
+	Assert(!isnull);
+	return DatumGetBool(valid) ? SCAN_INCLUDE : SCAN_EXCLUDE;
+}
+
+/*
+ * Stop using the ranges of a chunk, since they might not contain all its data
+ * any longer.
+ */
+void
+ts_chunk_column_stats_set_invalid(const Chunk *chunk)
+{
+	ScanTupLock tuplock = {
+		.lockmode = LockTupleExclusive,
+		.waitpolicy = LockWaitBlock,
+		/* in read committed mode, we follow all updates to this tuple */
+		.lockflags = IsolationUsesXactSnapshot() ? 0 : TUPLE_LOCK_FLAG_FIND_LAST_VERSION,
+	};
+	ScanIterator iterator =
+		ts_scan_iterator_create(CHUNK_COLUMN_STATS, RowExclusiveLock, CurrentMemoryContext);
+	bool changed = false;
+
+	chunk_column_stats_init_scan(&iterator, chunk->fd.hypertable_id, chunk->fd.id, NULL);
+	/* Don't lock the tuple if there is nothing to change, which is the common case. */
+	iterator.ctx.filter = chunk_column_stats_filter_valid;
+	iterator.ctx.tuplock = &tuplock;
+
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		TupleDesc tupdesc = ts_scanner_get_tupledesc(ti);
+		Datum values[Natts_chunk_column_stats];
+		bool nulls[Natts_chunk_column_stats];
+		CatalogSecurityContext sec_ctx;
+		HeapTuple tuple;
+		HeapTuple new_tuple;
+		bool should_free;
+
+		/* The row was changed or removed by a concurrent transaction */
+		if (ti->lockresult != TM_Ok && ti->lockresult != TM_SelfModified)
+			continue;
+
+		/* Recheck after following the updates */
+		if (chunk_column_stats_filter_valid(ti, NULL) == SCAN_EXCLUDE)
+			continue;
+
+		tuple = ts_scanner_fetch_heap_tuple(ti, false, &should_free);
+		heap_deform_tuple(tuple, tupdesc, values, nulls);
+		values[AttrNumberGetAttrOffset(Anum_chunk_column_stats_valid)] = BoolGetDatum(false);
+		new_tuple = heap_form_tuple(tupdesc, values, nulls);
+
+		ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+		ts_catalog_update_tid(ti->scanrel, ts_scanner_get_tuple_tid(ti), new_tuple);
+		ts_catalog_restore_user(&sec_ctx);
+
+		heap_freetuple(new_tuple);
+		if (should_free)
+			heap_freetuple(tuple);
+		changed = true;
+	}
+	ts_scan_iterator_close(&iterator);
+
+	/*
+	 * The plans that excluded the chunk don't refer to it, so the plans on
+	 * the hypertable have to be invalidated as well.
+	 */
+	if (changed)
+	{
+		CacheInvalidateRelcacheByRelid(chunk->table_id);
+		CacheInvalidateRelcacheByRelid(
+			ts_hypertable_id_to_relid(chunk->fd.hypertable_id, false));
+	}
+}
+
+static bool
+chunk_column_stats_is_enabled(int32 hypertable_id, const char *column_name)
+{
+	ScanIterator iterator =
+		ts_scan_iterator_create(CHUNK_COLUMN_STATS, AccessShareLock, CurrentMemoryContext);
+	bool found = false;
+
+	chunk_column_stats_init_scan(&iterator,
+								 hypertable_id,
+								 CHUNK_COLUMN_STATS_HYPERTABLE_ROW,
+								 column_name);
+	ts_scanner_foreach(&iterator)
+	{
+		found = true;
+	}
+	ts_scan_iterator_close(&iterator);
+
+	return found;
+}
+
+static Hypertable *
+chunk_column_stats_get_hypertable(Oid hypertable_relid, Cache **hcache)
+{
+	Hypertable *ht;
+
+	if (!OidIsValid(hypertable_relid))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("hypertable cannot be NULL")));
+
+	ts_hypertable_permissions_check(hypertable_relid, GetUserId());
+
+	/* Block the writes to the hypertable while the ranges are computed. */
+	LockRelationOid(hypertable_relid, ShareRowExclusiveLock);
+
+	ht = ts_hypertable_cache_get_cache_and_entry(hypertable_relid, CACHE_FLAG_NONE, hcache);
+
+	if (hypertable_is_distributed(ht) || TS_HYPERTABLE_IS_INTERNAL_COMPRESSION_TABLE(ht))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("chunk skipping is not supported on hypertable \"%s\"",
+						get_rel_name(hypertable_relid))));
+
+	return ht;
+}
+
+TS_FUNCTION_INFO_V1(ts_chunk_column_stats_enable);
+
+/*
+ * Track the range of a column in each chunk of a hypertable for chunk
+ * exclusion. The ranges of the chunks that are already compressed are
+ * computed right away.
+ *
+ * hypertable - The hypertable
+ * column_name - The column to track
+ * if_not_exists - Don't fail if the column is already tracked
+ */
+Datum
+ts_chunk_column_stats_enable(PG_FUNCTION_ARGS)
+{
+	Oid hypertable_relid = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+	Name column_name = PG_ARGISNULL(1) ? NULL : PG_GETARG_NAME(1);
+	bool if_not_exists = PG_ARGISNULL(2) ? false : PG_GETARG_BOOL(2);
+	ChunkRangeSpace *range_space;
+	ListCell *lc;
+	Hypertable *ht;
+	Cache *hcache;
+	AttrNumber attno;
+	Oid type;
+
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (column_name == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("column name cannot be NULL")));
+
+	ht = chunk_column_stats_get_hypertable(hypertable_relid, &hcache);
+
+	attno = get_attnum(hypertable_relid, NameStr(*column_name));
+	if (attno == InvalidAttrNumber)
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_COLUMN),
+				 errmsg("column \"%s\" does not exist", NameStr(*column_name))));
+
+	if (ts_is_partitioning_column(ht, attno))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("column \"%s\" is a dimension of the hypertable", NameStr(*column_name)),
+				 errdetail("The chunks are already excluded on the dimensions.")));
+
+	type = get_atttype(hypertable_relid, attno);
+	if (!IS_VALID_RANGE_COLUMN_TYPE(type))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("data type \"%s\" is not supported for chunk skipping",
+						format_type_be(type)),
+				 errhint("Use an integer or a time column.")));
+
+	if (chunk_column_stats_is_enabled(ht->fd.id, NameStr(*column_name)))
+	{
+		if (!if_not_exists)
+			ereport(ERROR,
+					(errcode(ERRCODE_DUPLICATE_OBJECT),
+					 errmsg("chunk skipping is already enabled for column \"%s\"",
+							NameStr(*column_name))));
+
+		ereport(NOTICE,
+				(errmsg("chunk skipping is already enabled for column \"%s\", skipping",
+						NameStr(*column_name))));
+		ts_cache_release(hcache);
+		PG_RETURN_VOID();
+	}
+
+	chunk_column_stats_insert(ht->fd.id,
+							  CHUNK_COLUMN_STATS_HYPERTABLE_ROW,
+							  NameStr(*column_name),
+							  PG_INT64_MIN,
+							  PG_INT64_MAX);
+
+	range_space = palloc0(sizeof(ChunkRangeSpace) + sizeof(ChunkRangeColumn));
+	range_space->hypertable_id = ht->fd.id;
+	range_space->num_columns = 1;
+	namestrcpy(&range_space->columns[0].column_name, NameStr(*column_name));
+	range_space->columns[0].attno = attno;
+	range_space->columns[0].type = type;
+
+	foreach (lc, ts_chunk_get_chunk_ids_by_hypertable_id(ht->fd.id))
+	{
+		Chunk *chunk = ts_chunk_get_by_id(lfirst_int(lc), false);
+
+		if (chunk == NULL || chunk->fd.dropped || chunk->relkind == RELKIND_FOREIGN_TABLE ||
+			!ts_chunk_is_compressed(chunk) || ts_chunk_is_partial(chunk))
+			continue;
+
+		LockRelationOid(chunk->table_id, ShareLock);
+		chunk_column_stats_calculate(range_space, chunk);
+	}
+
+	/* Plan the queries on the hypertable again, so that they can skip chunks. */
+	CacheInvalidateRelcacheByRelid(hypertable_relid);
+	ts_cache_release(hcache);
+
+	PG_RETURN_VOID();
+}
+
+TS_FUNCTION_INFO_V1(ts_chunk_column_stats_disable);
+
+/*
+ * Stop tracking the range of a column of a hypertable.
+ *
+ * hypertable - The hypertable
+ * column_name - The tracked column
+ * if_exists - Don't fail if the column is not tracked
+ */
+Datum
+ts_chunk_column_stats_disable(PG_FUNCTION_ARGS)
+{
+	Oid hypertable_relid = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+	Name column_name = PG_ARGISNULL(1) ? NULL : PG_GETARG_NAME(1);
+	bool if_exists = PG_ARGISNULL(2) ? false : PG_GETARG_BOOL(2);
+	Hypertable *ht;
+	Cache *hcache;
+
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (column_name == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("column name cannot be NULL")));
+
+	ht = chunk_column_stats_get_hypertable(hypertable_relid, &hcache);
+
+	if (!chunk_column_stats_is_enabled(ht->fd.id, NameStr(*column_name)))
+	{
+		if (!if_exists)
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_OBJECT),
+					 errmsg("chunk skipping is not enabled for column \"%s\"",
+							NameStr(*column_name))));
+
+		ereport(NOTICE,
+				(errmsg("chunk skipping is not enabled for column \"%s\", skipping",
+						NameStr(*column_name))));
+		ts_cache_release(hcache);
+		PG_RETURN_VOID();
+	}
+
+	chunk_column_stats_delete_column(ht->fd.id, hypertable_relid, NameStr(*column_name));
+	ts_cache_release(hcache);
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,57 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_CHUNK_COLUMN_STATS_H
+#define TIMESCALEDB_CHUNK_COLUMN_STATS_H
+
+#include <postgres.h>
+#include <nodes/pg_list.h>
+#include <utils/relcache.h>
+
+#include "export.h"
+#include "hypertable.h"
+
+/* A column of a hypertable that has its range tracked per chunk */
+typedef struct ChunkRangeColumn
+{
+	NameData column_name;
+	AttrNumber attno;
+	Oid type;
+} ChunkRangeColumn;
+
+/* The tracked columns of a hypertable, cached with the hypertable */
+typedef struct ChunkRangeSpace
+{
+	int32 hypertable_id;
+	int num_columns;
+	ChunkRangeColumn columns[FLEXIBLE_ARRAY_MEMBER];
+} ChunkRangeSpace;
+
+/*
+ * The valid range of a tracked column in a chunk, in the internal time
+ * representation. The range includes both ends.
+ */
+typedef struct ChunkColumnRange
+{
+	int32 chunk_id;
+	/* The index of the column in the range space of the hypertable */
+	int column;
+	int64 range_start;
+	int64 range_end;
+} ChunkColumnRange;
+
+extern ChunkRangeSpace *ts_chunk_column_stats_range_space_scan(int32 hypertable_id,
+															   Oid hypertable_relid,
+															   MemoryContext mcxt);
+extern int ts_chunk_column_stats_get_column(const Hypertable *ht, AttrNumber attno);
+extern List *ts_chunk_column_stats_get_ranges(const Hypertable *ht);
+extern List *ts_chunk_column_stats_get_constraints(Relation chunk_rel);
+extern TSDLLEXPORT void ts_chunk_column_stats_calculate(const Hypertable *ht, const Chunk *chunk);
+extern TSDLLEXPORT void ts_chunk_column_stats_set_invalid(const Chunk *chunk);
+extern void ts_chunk_column_stats_delete_by_chunk_id(int32 hypertable_id, int32 chunk_id);
+extern void ts_chunk_column_stats_delete_by_hypertable_id(int32 hypertable_id);
+extern void ts_chunk_column_stats_delete_by_column(const Hypertable *ht, const char *column_name);
+
+#endif /* TIMESCALEDB_CHUNK_COLUMN_STATS_H */
@@ -430,6 +430,23 @@ ts_chunk_data_nodes_scan_iterator_set_chunk_id(ScanIterator *it, int32 chunk_id)
 								   Int32GetDatum(chunk_id));
 }
 
+/*
+ * Scan for the data nodes of all the given chunks in one index scan.
+ */
+void
+ts_chunk_data_nodes_scan_iterator_set_chunk_ids(ScanIterator *it, const int32 *chunk_ids,
+												int num_chunk_ids)
+{
+	it->ctx.index = catalog_get_index(ts_catalog_get(),
+									  CHUNK_DATA_NODE,
+									  CHUNK_DATA_NODE_CHUNK_ID_NODE_NAME_IDX);
+	ts_scan_iterator_scan_key_reset(it);
+	ts_scan_iterator_scan_key_init_ids(it,
+									   Anum_chunk_data_node_chunk_id_node_name_idx_chunk_id,
+									   chunk_ids,
+									   num_chunk_ids);
+}
+
 void
 ts_chunk_data_nodes_scan_iterator_set_node_name(ScanIterator *it, const char *node_name)
 {
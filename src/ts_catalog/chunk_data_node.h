@@ -38,6 +38,9 @@ ts_chunk_data_node_scan_by_node_name_and_hypertable_id(const char *node_name, in
 extern TSDLLEXPORT ScanIterator ts_chunk_data_nodes_scan_iterator_create(MemoryContext result_mcxt);
 extern TSDLLEXPORT void ts_chunk_data_nodes_scan_iterator_set_chunk_id(ScanIterator *it,
 																	   int32 chunk_id);
+extern TSDLLEXPORT void ts_chunk_data_nodes_scan_iterator_set_chunk_ids(ScanIterator *it,
+																		const int32 *chunk_ids,
+																		int num_chunk_ids);
 extern TSDLLEXPORT void ts_chunk_data_nodes_scan_iterator_set_node_name(ScanIterator *it,
 																		const char *node_name);
 #endif /* TIMESCALEDB_CHUNK_DATA_NODE_H */
@@ -33,6 +33,7 @@
 #include "hypercube.h"
 #include "hypertable.h"
 #include "hypertable_cache.h"
+#include "invalidation_threshold_cache.h"
 #include "scan_iterator.h"
 #include "time_bucket.h"
 #include "time_utils.h"
@@ -81,6 +82,18 @@ static const WithClauseDefinition continuous_aggregate_with_clause_def[] = {
 			 .arg_name = "compress_chunk_time_interval",
 			 .type_id = INTERVALOID,
 		},
+		[ContinuousViewOptionCompressToastCompression] = {
+			 .arg_name = "compress_toast_compression",
+			 .type_id = TEXTOID,
+		},
+		[ContinuousViewOptionCompressBloomFilter] = {
+			 .arg_name = "compress_bloomfilter",
+			 .type_id = TEXTOID,
+		},
+		[ContinuousViewOptionCompressMinMax] = {
+			 .arg_name = "compress_minmax",
+			 .type_id = TEXTOID,
+		},
 };
 
 WithClauseResult *
@@ -113,6 +126,15 @@ ts_continuous_agg_get_compression_defelems(const WithClauseResult *with_clauses)
 			case CompressChunkTimeInterval:
 				option_index = ContinuousViewOptionCompressChunkTimeInterval;
 				break;
+			case CompressToastCompression:
+				option_index = ContinuousViewOptionCompressToastCompression;
+				break;
+			case CompressBloomFilter:
+				option_index = ContinuousViewOptionCompressBloomFilter;
+				break;
+			case CompressMinMax:
+				option_index = ContinuousViewOptionCompressMinMax;
+				break;
 			default:
 				elog(ERROR, "Unhandled compression option");
 				break;
@@ -248,6 +270,8 @@ invalidation_threshold_delete(int32 raw_hypertable_id)
 		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
 		ts_catalog_delete_tid(ti->scanrel, ts_scanner_get_tuple_tid(ti));
 	}
+
+	ts_invalidation_threshold_cache_remove(raw_hypertable_id);
 }
 
 static void
@@ -51,6 +51,9 @@ typedef enum ContinuousAggViewOption
 	ContinuousViewOptionCompressSegmentBy,
 	ContinuousViewOptionCompressOrderBy,
 	ContinuousViewOptionCompressChunkTimeInterval,
+	ContinuousViewOptionCompressToastCompression,
+	ContinuousViewOptionCompressBloomFilter,
+	ContinuousViewOptionCompressMinMax,
 	ContinuousViewOptionMax
 } ContinuousAggViewOption;
 
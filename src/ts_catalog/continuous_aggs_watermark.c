@@ -13,6 +13,8 @@
 #include <fmgr.h>
 #include <miscadmin.h>
 #include <utils/acl.h>
+#include <utils/hsearch.h>
+#include <utils/memutils.h>
 #include <utils/snapmgr.h>
 
 #include "ts_catalog/continuous_agg.h"
@@ -21,33 +23,33 @@
 
 typedef struct ContinuousAggregateWatermark
 {
-	int32 mat_hypertable_id;
-	MemoryContext mctx;
-	MemoryContextCallback cb;
+	int32 mat_hypertable_id; /* Hash key */
 	CommandId cid;
 	int64 value;
 } ContinuousAggregateWatermark;
 
 /*
- * Cache the watermark in the current transaction for better performance
- * (by avoiding repeated max bucket calculations). The watermark will be
- * reset at the end of the transaction, when the watermark function's input
- * argument (materialized hypertable ID) changes, or when a new command is
- * executed.
+ * Cache the watermarks in the current transaction for better performance
+ * (by avoiding repeated max bucket calculations). The cache is a hashtable of
+ * watermarks keyed on materialized hypertable ID, since a query can reference
+ * several continuous aggregates, e.g., a real-time continuous aggregate on top
+ * of another real-time continuous aggregate, or a join of continuous
+ * aggregates. The executor constifies the calls to the watermark function
+ * during startup chunk exclusion, once per chunk, so with a single cached
+ * watermark the calls for the different continuous aggregates would keep
+ * evicting each other.
  *
- * One could potentially create a hashtable of watermarks keyed on materialized
- * hypertable ID, but this is left as a future optimization since it doesn't
- * seem to be common case that multiple continuous aggregates exist in the same
- * query. Besides, the planner can constify calls to the watermark function
- * during planning since the function is STABLE. Therefore, this is only a
- * fallback if the planner needs to constify it many times (e.g., if used as
- * an index condition on many chunks).
+ * A cached watermark is valid until a new command is executed, and the cache
+ * is reset at the end of the transaction.
  */
-static ContinuousAggregateWatermark *cagg_watermark_cache = NULL;
+#define CAGG_WATERMARK_CACHE_INIT_SIZE 8
+
+static HTAB *cagg_watermark_cache = NULL;
+static MemoryContextCallback cagg_watermark_cache_cb;
 
 /*
- * Callback handler to reset the watermark after the transaction ends. This is
- * triggered by the deletion of the associated memory context.
+ * Callback handler to reset the watermarks after the transaction ends. This
+ * is triggered by the deletion of the memory context of the hashtable.
  */
 static void
 cagg_watermark_reset(void *arg)
@@ -55,15 +57,24 @@ cagg_watermark_reset(void *arg)
 	cagg_watermark_cache = NULL;
 }
 
-/*
- * ContinuousAggregateWatermark is valid for the duration of one command execution on the same
- * materialized hypertable.
- */
-static bool
-cagg_watermark_is_valid(const ContinuousAggregateWatermark *cagg_watermark, int32 mat_hypertable_id)
+static HTAB *
+cagg_watermark_cache_create(void)
 {
-	return cagg_watermark != NULL && cagg_watermark->mat_hypertable_id == mat_hypertable_id &&
-		   cagg_watermark->cid == GetCurrentCommandId(false);
+	HASHCTL ctl = {
+		.keysize = sizeof(int32),
+		.entrysize = sizeof(ContinuousAggregateWatermark),
+		.hcxt = AllocSetContextCreate(TopTransactionContext,
+									  "ContinuousAggregateWatermark cache",
+									  ALLOCSET_SMALL_SIZES),
+	};
+
+	cagg_watermark_cache_cb.func = cagg_watermark_reset;
+	MemoryContextRegisterResetCallback(ctl.hcxt, &cagg_watermark_cache_cb);
+
+	return hash_create("ContinuousAggregateWatermark cache",
+					   CAGG_WATERMARK_CACHE_INIT_SIZE,
+					   &ctl,
+					   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
 }
 
 static void
@@ -126,24 +137,11 @@ cagg_watermark_get(Hypertable *mat_ht)
 	return DatumGetInt64(watermark);
 }
 
-static ContinuousAggregateWatermark *
-cagg_watermark_create(const ContinuousAgg *cagg, MemoryContext top_mctx)
+static int64
+cagg_watermark_fetch(const ContinuousAgg *cagg)
 {
-	Hypertable *ht;
-	ContinuousAggregateWatermark *watermark;
-	MemoryContext mctx = AllocSetContextCreate(top_mctx,
-											   "ContinuousAggregateWatermark function",
-											   ALLOCSET_DEFAULT_SIZES);
-
-	watermark = MemoryContextAllocZero(mctx, sizeof(ContinuousAggregateWatermark));
-	watermark->mctx = mctx;
-	watermark->mat_hypertable_id = cagg->data.mat_hypertable_id;
-	watermark->cid = GetCurrentCommandId(false);
-	watermark->cb.func = cagg_watermark_reset;
-	MemoryContextRegisterResetCallback(mctx, &watermark->cb);
-
 	/* Hypertable associated to the Continuous Aggregate */
-	ht = ts_hypertable_get_by_id(cagg->data.mat_hypertable_id);
+	Hypertable *ht = ts_hypertable_get_by_id(cagg->data.mat_hypertable_id);
 
 	if (NULL == ht)
 		ereport(ERROR,
@@ -152,9 +150,7 @@ cagg_watermark_create(const ContinuousAgg *cagg, MemoryContext top_mctx)
 						cagg->data.mat_hypertable_id)));
 
 	/* Get the stored watermark */
-	watermark->value = cagg_watermark_get(ht);
-
-	return watermark;
+	return cagg_watermark_get(ht);
 }
 
 TS_FUNCTION_INFO_V1(ts_continuous_agg_watermark);
@@ -178,15 +174,17 @@ Datum
 ts_continuous_agg_watermark(PG_FUNCTION_ARGS)
 {
 	const int32 mat_hypertable_id = PG_GETARG_INT32(0);
+	ContinuousAggregateWatermark *watermark;
 	ContinuousAgg *cagg;
 	AclResult aclresult;
+	int64 value;
 
 	if (NULL != cagg_watermark_cache)
 	{
-		if (cagg_watermark_is_valid(cagg_watermark_cache, mat_hypertable_id))
-			PG_RETURN_INT64(cagg_watermark_cache->value);
+		watermark = hash_search(cagg_watermark_cache, &mat_hypertable_id, HASH_FIND, NULL);
 
-		MemoryContextDelete(cagg_watermark_cache->mctx);
+		if (NULL != watermark && watermark->cid == GetCurrentCommandId(false))
+			PG_RETURN_INT64(watermark->value);
 	}
 
 	cagg = ts_continuous_agg_find_by_mat_hypertable_id(mat_hypertable_id);
@@ -202,9 +200,16 @@ ts_continuous_agg_watermark(PG_FUNCTION_ARGS)
 	 */
 	aclresult = pg_class_aclcheck(cagg->relid, GetUserId(), ACL_SELECT);
 	aclcheck_error(aclresult, OBJECT_MATVIEW, get_rel_name(cagg->relid));
-	cagg_watermark_cache = cagg_watermark_create(cagg, TopTransactionContext);
+	value = cagg_watermark_fetch(cagg);
+
+	if (NULL == cagg_watermark_cache)
+		cagg_watermark_cache = cagg_watermark_cache_create();
+
+	watermark = hash_search(cagg_watermark_cache, &mat_hypertable_id, HASH_ENTER, NULL);
+	watermark->cid = GetCurrentCommandId(false);
+	watermark->value = value;
 
-	PG_RETURN_INT64(cagg_watermark_cache->value);
+	PG_RETURN_INT64(value);
 }
 
 static int64
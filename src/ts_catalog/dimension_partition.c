@@ -7,13 +7,16 @@
 #include <access/heapam.h>
 #include <access/xact.h>
 #include <catalog/catalog.h>
+#include <catalog/pg_type.h>
 #include <commands/tablecmds.h>
 #include <nodes/parsenodes.h>
 #include <utils/array.h>
 #include <utils/palloc.h>
 #include <utils/rel.h>
 #include <utils/builtins.h>
+#include <utils/lsyscache.h>
 #include <utils/snapmgr.h>
+#include <miscadmin.h>
 
 #include "ts_catalog/catalog.h"
 #include "dimension.h"
@@ -22,6 +25,8 @@
 #include "hypertable_cache.h"
 #include "scanner.h"
 #include "config.h"
+#include "errors.h"
+#include "utils.h"
 
 #include "compat/compat.h"
 
@@ -317,6 +322,57 @@ ts_dimension_partition_info_delete(int dimension_id)
 	dimension_partition_info_delete(dimension_id, SCANNER_F_NOFLAGS, RowExclusiveLock);
 }
 
+/*
+ * Get the start of a hash partition when the closed dimension is divided
+ * into num_partitions equally sized partitions.
+ *
+ * Hash values for space partitions are in range 0 to INT32_MAX, so the first
+ * partition covers 0 to partition size, although the start is written as
+ * -INF.
+ */
+static int64
+dimpart_hash_partition_start(unsigned int num_partitions, unsigned int index)
+{
+	if (index == 0)
+		return DIMENSION_SLICE_MINVALUE;
+
+	return (DIMENSION_SLICE_CLOSED_MAX / ((int64) num_partitions)) * index;
+}
+
+/*
+ * Get the hash partitions at which the given dimension partitions start.
+ *
+ * Returns the number of dimension partitions, or -1 if the dimension
+ * partitions don't start at hash partition boundaries when the dimension is
+ * divided into num_partitions, in which case the mapping cannot be kept.
+ */
+static int
+dimpart_get_hash_partition_starts(const DimensionPartitionInfo *dpi, unsigned int num_partitions,
+								  unsigned int *partition_starts)
+{
+	int64 partition_size = DIMENSION_SLICE_CLOSED_MAX / ((int64) num_partitions);
+	unsigned int i;
+
+	if (dpi->num_partitions > num_partitions ||
+		dpi->partitions[0]->range_start != DIMENSION_SLICE_MINVALUE)
+		return -1;
+
+	partition_starts[0] = 0;
+
+	for (i = 1; i < dpi->num_partitions; i++)
+	{
+		int64 range_start = dpi->partitions[i]->range_start;
+
+		if (range_start <= 0 || range_start % partition_size != 0 ||
+			range_start / partition_size >= num_partitions)
+			return -1;
+
+		partition_starts[i] = range_start / partition_size;
+	}
+
+	return dpi->num_partitions;
+}
+
 /*
  * Recreate dimension partitions based on changes to one or more of these
  * variables:
@@ -324,13 +380,43 @@ ts_dimension_partition_info_delete(int dimension_id)
  * - number of partitions
  * - list of data nodes
  * - replication factor
+ *
+ * Every hash partition gets its own dimension partition, and thus its own
+ * chunks. Use ts_dimension_partition_info_remap() to map several hash
+ * partitions to the same chunks.
  */
 DimensionPartitionInfo *
 ts_dimension_partition_info_recreate(int32 dimension_id, unsigned int num_partitions,
 									 List *data_nodes, int replication_factor)
 {
-	int64 partition_size = DIMENSION_SLICE_CLOSED_MAX / ((int64) num_partitions);
-	int64 range_start = DIMENSION_SLICE_MINVALUE;
+	return ts_dimension_partition_info_remap(dimension_id,
+											 num_partitions,
+											 NULL,
+											 num_partitions,
+											 data_nodes,
+											 replication_factor);
+}
+
+/*
+ * Recreate dimension partitions so that each dimension partition covers a
+ * contiguous range of hash partitions.
+ *
+ * The partition_starts array holds, in ascending order, the index of the hash
+ * partition at which each dimension partition starts, and the first one has
+ * to be 0. A NULL array gives each hash partition its own dimension
+ * partition.
+ *
+ * Chunks are created for dimension partitions, so the dimension can have a
+ * large number of hash partitions without creating as many chunks per time
+ * slice. The mapping only applies to new chunks and can be changed at any
+ * time, e.g., to split partitions that receive a lot of data.
+ */
+DimensionPartitionInfo *
+ts_dimension_partition_info_remap(int32 dimension_id, unsigned int num_partitions,
+								  const unsigned int *partition_starts,
+								  unsigned int num_dimension_partitions, List *data_nodes,
+								  int replication_factor)
+{
 	Catalog *catalog = ts_catalog_get();
 	Oid relid = catalog_get_table_id(catalog, DIMENSION_PARTITION);
 	DimensionPartitionInfo *dpi;
@@ -339,6 +425,9 @@ ts_dimension_partition_info_recreate(int32 dimension_id, unsigned int num_partit
 	unsigned int i;
 
 	Assert(num_partitions > 0);
+	Assert(num_dimension_partitions > 0 && num_dimension_partitions <= num_partitions);
+	Assert(partition_starts != NULL || num_dimension_partitions == num_partitions);
+	Assert(partition_starts == NULL || partition_starts[0] == 0);
 	Assert(data_nodes == NIL || replication_factor > 0);
 
 	/* Delete all partitions for the dimension */
@@ -347,13 +436,21 @@ ts_dimension_partition_info_recreate(int32 dimension_id, unsigned int num_partit
 	/* Lock already held */
 	rel = table_open(relid, NoLock);
 
-	partitions = palloc0(sizeof(DimensionPartition *) * num_partitions);
+	partitions = palloc0(sizeof(DimensionPartition *) * num_dimension_partitions);
 
-	for (i = 0; i < num_partitions; i++)
+	for (i = 0; i < num_dimension_partitions; i++)
 	{
-		int64 range_end =
-			(i == (num_partitions - 1)) ? DIMENSION_SLICE_CLOSED_MAX : range_start + partition_size;
+		unsigned int start_index = partition_starts ? partition_starts[i] : i;
+		unsigned int end_index = partition_starts && i < (num_dimension_partitions - 1) ?
+									 partition_starts[i + 1] :
+									 i + 1;
+		int64 range_start = dimpart_hash_partition_start(num_partitions, start_index);
+		int64 range_end = (i == (num_dimension_partitions - 1)) ?
+							  DIMENSION_SLICE_CLOSED_MAX :
+							  dimpart_hash_partition_start(num_partitions, end_index);
 		DimensionPartition *dp;
+
+		Assert(range_start < range_end);
 		CatalogSecurityContext sec_ctx;
 		HeapTuple tuple;
 
@@ -372,31 +469,54 @@ ts_dimension_partition_info_recreate(int32 dimension_id, unsigned int num_partit
 		heap_freetuple(tuple);
 
 		partitions[i] = dp;
-
-		/* Hash values for space partitions are in range 0 to INT32_MAX, so
-		 * the first partition covers 0 to partition size (although the start
-		 * is written as -INF) */
-		if (range_start == DIMENSION_SLICE_MINVALUE)
-			range_start = 0;
-
-		range_start += partition_size;
 	}
 
 	table_close(rel, RowExclusiveLock);
 
 	/* Sort the partitions so that we can later use binary search */
-	qsort(partitions, num_partitions, sizeof(DimensionPartition *), dimpart_cmp);
+	qsort(partitions, num_dimension_partitions, sizeof(DimensionPartition *), dimpart_cmp);
 
 	/* Make changes visible */
 	CommandCounterIncrement();
 
 	dpi = palloc(sizeof(DimensionPartitionInfo));
 	dpi->partitions = partitions;
-	dpi->num_partitions = num_partitions;
+	dpi->num_partitions = num_dimension_partitions;
 
 	return dpi;
 }
 
+/*
+ * Recreate dimension partitions, e.g., for a new list of data nodes, while
+ * keeping the current mapping of hash partitions to dimension partitions if
+ * it is still valid for the number of partitions.
+ */
+DimensionPartitionInfo *
+ts_dimension_partition_info_update(int32 dimension_id, unsigned int num_partitions,
+								   List *data_nodes, int replication_factor)
+{
+	DimensionPartitionInfo *current = ts_dimension_partition_info_get(dimension_id);
+	unsigned int *partition_starts = palloc(sizeof(unsigned int) * num_partitions);
+	int num_dimension_partitions = -1;
+
+	if (current != NULL)
+		num_dimension_partitions =
+			dimpart_get_hash_partition_starts(current, num_partitions, partition_starts);
+
+	if (num_dimension_partitions <= 0)
+		return ts_dimension_partition_info_recreate(dimension_id,
+													num_partitions,
+													data_nodes,
+													replication_factor);
+
+	return ts_dimension_partition_info_remap(dimension_id,
+											 num_partitions,
+											 partition_starts,
+											 num_dimension_partitions,
+											 data_nodes,
+											 replication_factor);
+}
+
 /*
  * Manually update the dimension partition state for a hypertable.
  *
@@ -416,3 +536,104 @@ ts_dimension_partition_update(PG_FUNCTION_ARGS)
 	ts_cache_release(hcache);
 	PG_RETURN_VOID();
 }
+
+TS_FUNCTION_INFO_V1(ts_dimension_partition_set_mapping);
+
+/*
+ * Map the hash partitions of the space dimension of a hypertable to
+ * dimension partitions, which decide the space range of new chunks.
+ *
+ * hypertable - The hypertable
+ * partition_starts - The (zero-based) hash partitions at which each
+ *     dimension partition starts, in ascending order. NULL gives each hash
+ *     partition its own dimension partition.
+ */
+Datum
+ts_dimension_partition_set_mapping(PG_FUNCTION_ARGS)
+{
+	Oid hypertable_relid = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+	ArrayType *starts_arr = PG_ARGISNULL(1) ? NULL : PG_GETARG_ARRAYTYPE_P(1);
+	unsigned int *partition_starts = NULL;
+	unsigned int num_partitions;
+	unsigned int num_dimension_partitions;
+	List *data_node_names = NIL;
+	const Dimension *space_dim;
+	const Hypertable *ht;
+	Cache *hcache;
+
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (!OidIsValid(hypertable_relid))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("hypertable cannot be NULL")));
+
+	ht = ts_hypertable_cache_get_cache_and_entry(hypertable_relid, CACHE_FLAG_NONE, &hcache);
+	ts_hypertable_permissions_check(hypertable_relid, GetUserId());
+	space_dim = hyperspace_get_closed_dimension(ht->space, 0);
+
+	if (NULL == space_dim)
+		ereport(ERROR,
+				(errcode(ERRCODE_TS_DIMENSION_NOT_EXIST),
+				 errmsg("hypertable \"%s\" has no space dimension",
+						get_rel_name(hypertable_relid))));
+
+	num_partitions = space_dim->fd.num_slices;
+	num_dimension_partitions = num_partitions;
+
+	if (NULL != starts_arr)
+	{
+		Datum *elems;
+		bool *nulls;
+		int nelems;
+		int i;
+
+		deconstruct_array(starts_arr, INT4OID, 4, true, TYPALIGN_INT, &elems, &nulls, &nelems);
+
+		if (nelems == 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("partition starts cannot be empty")));
+
+		partition_starts = palloc(sizeof(unsigned int) * nelems);
+
+		for (i = 0; i < nelems; i++)
+		{
+			int32 start = nulls[i] ? -1 : DatumGetInt32(elems[i]);
+
+			if (nulls[i] || start < 0 || (unsigned int) start >= num_partitions)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("invalid partition start"),
+						 errdetail("Partition starts must be between 0 and %u.",
+								   num_partitions - 1)));
+
+			if (i == 0 && start != 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("the first partition must start at 0")));
+
+			if (i > 0 && (unsigned int) start <= partition_starts[i - 1])
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("partition starts must be in ascending order")));
+
+			partition_starts[i] = start;
+		}
+
+		num_dimension_partitions = nelems;
+	}
+
+	if (hypertable_is_distributed(ht))
+		data_node_names = ts_hypertable_get_available_data_node_names(ht, false);
+
+	ts_dimension_partition_info_remap(space_dim->fd.id,
+									  num_partitions,
+									  partition_starts,
+									  num_dimension_partitions,
+									  data_node_names,
+									  ht->fd.replication_factor);
+	ts_hypertable_func_call_on_data_nodes(ht, fcinfo);
+	ts_cache_release(hcache);
+
+	PG_RETURN_VOID();
+}
@@ -30,6 +30,15 @@ extern const DimensionPartition *ts_dimension_partition_find(const DimensionPart
 extern TSDLLEXPORT DimensionPartitionInfo *
 ts_dimension_partition_info_recreate(int32 dimension_id, unsigned int num_partitions,
 									 List *data_nodes, int replication_factor);
+extern DimensionPartitionInfo *
+ts_dimension_partition_info_remap(int32 dimension_id, unsigned int num_partitions,
+								  const unsigned int *partition_starts,
+								  unsigned int num_dimension_partitions, List *data_nodes,
+								  int replication_factor);
+extern DimensionPartitionInfo *ts_dimension_partition_info_update(int32 dimension_id,
+																  unsigned int num_partitions,
+																  List *data_nodes,
+																  int replication_factor);
 extern void ts_dimension_partition_info_delete(int dimension_id);
 
 #endif /* TIMESCALEDB_DIMENSION_PARTITION_H */
@@ -17,6 +17,7 @@
 #include <catalog/pg_operator.h>
 #include <catalog/pg_type.h>
 #include <commands/event_trigger.h>
+#include <common/relpath.h>
 #include <commands/tablecmds.h>
 #include <fmgr.h>
 #include <funcapi.h>
@@ -39,6 +40,7 @@
 #include "guc.h"
 #include "hypertable_cache.h"
 #include "utils.h"
+#include "relation_size_cache.h"
 #include "time_utils.h"
 
 TS_FUNCTION_INFO_V1(ts_pg_timestamp_to_unix_microseconds);
@@ -960,7 +962,7 @@ ts_relation_size(PG_FUNCTION_ARGS)
 	if (!OidIsValid(relid))
 		PG_RETURN_NULL();
 
-	relsize = ts_relation_size_impl(relid);
+	relsize = ts_relation_size_cached(relid);
 
 	tupdesc = BlessTupleDesc(tupdesc);
 
@@ -987,8 +989,17 @@ ts_relation_size_impl(Oid relid)
 	if (!rel)
 		return relsize;
 
-	/* Get to total relation size to be our calculation base */
-	relsize.total_size = DatumGetInt64(DirectFunctionCall1(pg_total_relation_size, reloid));
+	/*
+	 * Add up the sizes of the heap forks, the indexes and the TOAST table
+	 * separately instead of subtracting them from the total size, so that we
+	 * don't stat the files of the indexes and the TOAST table twice. This
+	 * matters for the telemetry, which gets the sizes of all relations.
+	 */
+	for (ForkNumber fork = MAIN_FORKNUM; fork <= MAX_FORKNUM; fork++)
+		relsize.heap_size +=
+			DatumGetInt64(DirectFunctionCall2(pg_relation_size,
+											  reloid,
+											  CStringGetTextDatum(forkNames[fork])));
 
 	/* Get the indexes size of the relation (don't consider TOAST indexes) */
 	relsize.index_size = DatumGetInt64(DirectFunctionCall1(pg_indexes_size, reloid));
@@ -1003,8 +1014,7 @@ ts_relation_size_impl(Oid relid)
 
 	relation_close(rel, AccessShareLock);
 
-	/* Calculate the HEAP size based on the total size and indexes plus toast */
-	relsize.heap_size = relsize.total_size - (relsize.index_size + relsize.toast_size);
+	relsize.total_size = relsize.heap_size + relsize.index_size + relsize.toast_size;
 
 	return relsize;
 }
@@ -0,0 +1,160 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <miscadmin.h>
+#include <utils/builtins.h>
+
+#include "wait_stats.h"
+
+#include "export.h"
+#include "loader/wait_stats.h"
+
+/*
+ * Cumulative counts and timings of the internal waits of TimescaleDB, shared
+ * by all backends, so that stalls e.g. during ingest spikes can be attributed
+ * to specific operations. In pg_stat_activity these waits only show up as
+ * generic Lock or Extension waits, because PostgreSQL before version 17 has
+ * no way to register custom wait event names. The counters are shown by
+ * _timescaledb_functions.wait_stats().
+ *
+ * The shared memory is allocated by the loader. With an older loader it is
+ * missing, and nothing is collected.
+ */
+static const char *wait_event_names[_TS_WAIT_EVENT_MAX] = {
+	[TS_WAIT_CHUNK_CREATE_LOCK] = "chunk_create_lock",
+	[TS_WAIT_CHUNK_CATALOG_LOCK] = "chunk_catalog_lock",
+	[TS_WAIT_JOB_LOCK] = "job_lock",
+	[TS_WAIT_REMOTE_RESPONSE] = "remote_response",
+};
+
+StaticAssertDecl(_TS_WAIT_EVENT_MAX <= TS_WAIT_STATS_MAX_EVENTS,
+				 "too many wait events for the shared wait stats");
+
+static TsWaitStats *
+wait_stats_get(void)
+{
+	static TsWaitStats **rendezvous = NULL;
+
+	if (rendezvous == NULL)
+		rendezvous = (TsWaitStats **) find_rendezvous_variable(RENDEZVOUS_WAIT_STATS);
+
+	return *rendezvous;
+}
+
+void
+ts_wait_stats_start(instr_time *start)
+{
+	INSTR_TIME_SET_CURRENT(*start);
+}
+
+/*
+ * Add a wait that began at start and ended now.
+ */
+void
+ts_wait_stats_end(TsWaitEvent event, const instr_time *start)
+{
+	TsWaitStats *stats = wait_stats_get();
+	TsWaitStatsEntry *entry;
+	instr_time duration;
+	uint64 us;
+	uint64 max;
+
+	Assert(event >= 0 && event < _TS_WAIT_EVENT_MAX);
+
+	if (stats == NULL)
+		return;
+
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, *start);
+	us = INSTR_TIME_GET_MICROSEC(duration);
+
+	entry = &stats->events[event];
+	pg_atomic_fetch_add_u64(&entry->count, 1);
+	pg_atomic_fetch_add_u64(&entry->total_us, us);
+
+	max = pg_atomic_read_u64(&entry->max_us);
+	while (us > max)
+	{
+		/* On failure, max is updated to the current value */
+		if (pg_atomic_compare_exchange_u64(&entry->max_us, &max, us))
+			break;
+	}
+}
+
+TS_FUNCTION_INFO_V1(ts_wait_stats);
+TS_FUNCTION_INFO_V1(ts_wait_stats_reset);
+
+Datum
+ts_wait_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	TsWaitStats *stats = wait_stats_get();
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("function returning record called in context "
+							"that cannot accept type record")));
+
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+		funcctx->max_calls = stats == NULL ? 0 : _TS_WAIT_EVENT_MAX;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	if (funcctx->call_cntr < funcctx->max_calls)
+	{
+		TsWaitStatsEntry *entry = &stats->events[funcctx->call_cntr];
+		Datum values[4];
+		bool nulls[4] = { false };
+		HeapTuple tuple;
+
+		values[0] = CStringGetTextDatum(wait_event_names[funcctx->call_cntr]);
+		values[1] = Int64GetDatum((int64) pg_atomic_read_u64(&entry->count));
+		values[2] = Float8GetDatum(pg_atomic_read_u64(&entry->total_us) / 1000.0);
+		values[3] = Float8GetDatum(pg_atomic_read_u64(&entry->max_us) / 1000.0);
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+Datum
+ts_wait_stats_reset(PG_FUNCTION_ARGS)
+{
+	TsWaitStats *stats = wait_stats_get();
+
+	if (!superuser())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("must be superuser to reset the wait statistics")));
+
+	if (stats == NULL)
+		PG_RETURN_VOID();
+
+	for (int i = 0; i < TS_WAIT_STATS_MAX_EVENTS; i++)
+	{
+		pg_atomic_write_u64(&stats->events[i].count, 0);
+		pg_atomic_write_u64(&stats->events[i].total_us, 0);
+		pg_atomic_write_u64(&stats->events[i].max_us, 0);
+	}
+
+	PG_RETURN_VOID();
+}
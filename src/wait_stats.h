@@ -0,0 +1,31 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_WAIT_STATS_H
+#define TIMESCALEDB_WAIT_STATS_H
+
+#include <postgres.h>
+#include <portability/instr_time.h>
+
+#include "export.h"
+
+/*
+ * The internal waits that we keep cumulative counts and timings of. The
+ * values index the shared slots allocated by the loader, so existing values
+ * must not be renumbered. Keep the names in wait_stats.c in sync.
+ */
+typedef enum TsWaitEvent
+{
+	TS_WAIT_CHUNK_CREATE_LOCK = 0, /* serializing chunk creation on the hypertable */
+	TS_WAIT_CHUNK_CATALOG_LOCK,	   /* locking the chunk catalog table for insert */
+	TS_WAIT_JOB_LOCK,			   /* the advisory lock of a background job */
+	TS_WAIT_REMOTE_RESPONSE,	   /* waiting for the response of a data node */
+	_TS_WAIT_EVENT_MAX,
+} TsWaitEvent;
+
+extern TSDLLEXPORT void ts_wait_stats_start(instr_time *start);
+extern TSDLLEXPORT void ts_wait_stats_end(TsWaitEvent event, const instr_time *start);
+
+#endif /* TIMESCALEDB_WAIT_STATS_H */
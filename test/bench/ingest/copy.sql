@@ -0,0 +1,7 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- pgbench script: one COPY of :batch rows per transaction, from the
+-- server-side file that run.sh generates.
+COPY bench_metrics FROM :copy_file WITH (FORMAT csv);
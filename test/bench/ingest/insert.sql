@@ -0,0 +1,8 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- pgbench script: one single-row INSERT per transaction.
+\set t random(0, :span - 1)
+\set d random(1, :devices)
+INSERT INTO bench_metrics VALUES ('2023-01-01'::timestamptz + :t * interval '1 second', :d, random(), random());
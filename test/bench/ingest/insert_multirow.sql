@@ -0,0 +1,11 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- pgbench script: one INSERT of :batch rows per transaction. The rows are
+-- spread over the whole time span and all devices, so that a statement
+-- touches many chunks, like a multi-row INSERT from a collector does.
+\set t random(0, :span - 1)
+INSERT INTO bench_metrics
+SELECT '2023-01-01'::timestamptz + ((:t + g * 3607) % :span) * interval '1 second', g % :devices + 1, random(), random()
+FROM generate_series(1, :batch) g;
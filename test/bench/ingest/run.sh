@@ -0,0 +1,89 @@
+#!/usr/bin/env bash
+#
+# Ingest benchmark for the INSERT and COPY paths of hypertables. For every
+# scenario, recreates the hypertable with setup.sql and runs each workload
+# with pgbench, then reports the rows per second and the latency percentiles
+# of the statements.
+#
+# Usage: run.sh [scenario...]
+#
+# Connects with the usual libpq environment variables. The database must have
+# the timescaledb extension, and the user must be allowed to read server-side
+# files for the COPY workload. Settings through the environment:
+#
+#   DURATION  seconds to run each workload (default 30)
+#   CLIENTS   number of concurrent pgbench clients (default 4)
+#   BATCH     rows per multi-row INSERT and per COPY (default 1000)
+#   DEVICES   number of distinct devices (default 10)
+#   WORKLOADS workloads to run (default "insert insert_multirow copy")
+
+set -eu
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+DURATION=${DURATION:-30}
+CLIENTS=${CLIENTS:-4}
+BATCH=${BATCH:-1000}
+DEVICES=${DEVICES:-10}
+WORKLOADS=${WORKLOADS:-"insert insert_multirow copy"}
+
+# name chunks space_partitions indexes compression cagg precreate
+SCENARIOS="
+baseline 10 0 0 off off on
+chunk_creation 1000 0 0 off off off
+many_chunks 1000 0 0 off off on
+space_partitions 10 4 0 off off on
+indexes 10 0 3 off off on
+compressed_late_data 10 0 0 on off on
+cagg 10 0 0 off on on
+"
+
+PSQL="psql -X -q -v ON_ERROR_STOP=1"
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# The COPY input is generated by the server, so that the file is readable by
+# it. It is rewritten for every scenario, because it depends on the time span,
+# and left in the data directory at the end.
+COPY_FILE=$(${PSQL} -A -t -c "SELECT current_setting('data_directory') || '/bench_ingest_copy.csv'")
+
+printf "%-22s %-16s %12s %12s %12s %12s\n" scenario workload rows/s "p50 ms" "p99 ms" "max ms"
+
+echo "$SCENARIOS" | while read -r name chunks space indexes compression cagg precreate; do
+  [ -z "$name" ] && continue
+  if [ $# -gt 0 ] && [[ ! " $* " =~ " $name " ]]; then
+    continue
+  fi
+
+  span=$((chunks * 86400))
+
+  ${PSQL} -f "$DIR/setup.sql" -v chunks="$chunks" -v space_partitions="$space" \
+    -v devices="$DEVICES" -v indexes="$indexes" -v compression="$compression" \
+    -v cagg="$cagg" -v precreate="$precreate" > /dev/null
+
+  ${PSQL} -c "COPY (SELECT '2023-01-01'::timestamptz + ((g * 3607) % $span) * interval '1 second', \
+    g % $DEVICES + 1, random(), random() FROM generate_series(1, $BATCH) g) TO '$COPY_FILE' \
+    WITH (FORMAT csv)"
+
+  for workload in $WORKLOADS; do
+    rows_per_xact=$BATCH
+    [ "$workload" = insert ] && rows_per_xact=1
+
+    rm -f "$WORK_DIR"/pgbench_log.*
+    (cd "$WORK_DIR" && pgbench -n -f "$DIR/$workload.sql" -c "$CLIENTS" -j "$CLIENTS" \
+      -T "$DURATION" -l -D span="$span" -D devices="$DEVICES" -D batch="$BATCH" \
+      -D copy_file="'$COPY_FILE'" > /dev/null)
+
+    # The third field of the per-transaction log is the latency in
+    # microseconds.
+    cat "$WORK_DIR"/pgbench_log.* | awk '{ print $3 }' | sort -n | awk \
+      -v name="$name" -v workload="$workload" -v rows="$rows_per_xact" -v duration="$DURATION" '
+      { latency[NR] = $1 }
+      END {
+        if (NR == 0) { print "no transactions for " name " " workload > "/dev/stderr"; exit 1 }
+        p50 = latency[int((NR - 1) * 0.50) + 1]
+        p99 = latency[int((NR - 1) * 0.99) + 1]
+        printf "%-22s %-16s %12.0f %12.3f %12.3f %12.3f\n", name, workload,
+          NR * rows / duration, p50 / 1000, p99 / 1000, latency[NR] / 1000
+      }'
+  done
+done
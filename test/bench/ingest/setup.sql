@@ -0,0 +1,57 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- Creates the hypertable for one ingest benchmark scenario. Expects the psql
+-- variables set by run.sh:
+--
+--   chunks            number of one-day chunks the inserted data spans
+--   space_partitions  number of space partitions on device, 0 for none
+--   devices           number of distinct devices
+--   indexes           number of additional indexes, 0 to 3
+--   compression       on to compress the chunks, so that the ingest is late
+--                     data going into compressed chunks
+--   cagg              on to create a continuous aggregate, which adds the
+--                     invalidation trigger to the ingest path
+--   precreate         on to create all the chunks before the run, off to
+--                     measure the chunk creation as part of the ingest
+
+\set ON_ERROR_STOP 1
+SET client_min_messages TO warning;
+
+DROP MATERIALIZED VIEW IF EXISTS bench_metrics_hourly;
+DROP TABLE IF EXISTS bench_metrics;
+
+CREATE TABLE bench_metrics(time timestamptz NOT NULL, device int, value float8, value2 float8);
+SELECT create_hypertable('bench_metrics', 'time', chunk_time_interval => interval '1 day');
+
+SELECT add_dimension('bench_metrics', 'device', number_partitions => :space_partitions)
+WHERE :space_partitions > 0;
+
+SELECT format('CREATE INDEX ON bench_metrics(%s, time)', col)
+FROM unnest(array['device', 'value', 'value2']) WITH ORDINALITY AS cols(col, n)
+WHERE n <= :indexes \gexec
+
+-- Create all the chunks up front, so that the measurement shows the
+-- dispatching into existing chunks. Compressed chunks have to exist before
+-- the run anyway.
+\if :precreate
+INSERT INTO bench_metrics
+SELECT '2023-01-01'::timestamptz + h * interval '1 hour', d, random(), random()
+FROM generate_series(0, :chunks * 24 - 1) h, generate_series(1, :devices) d;
+\endif
+
+\if :compression
+ALTER TABLE bench_metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+SELECT count(compress_chunk(c)) FROM show_chunks('bench_metrics') c;
+\endif
+
+\if :cagg
+CREATE MATERIALIZED VIEW bench_metrics_hourly WITH (timescaledb.continuous) AS
+SELECT time_bucket('1 hour', time) AS bucket, device, avg(value)
+FROM bench_metrics
+GROUP BY 1, 2
+WITH NO DATA;
+\endif
+
+VACUUM ANALYZE bench_metrics;
@@ -0,0 +1,10 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- Hourly aggregates for all devices. On the compressed table, the columns
+-- should be bulk decompressed.
+\set name downsampling
+\set query 'SELECT time_bucket(''1 hour'', time) AS bucket, device_id, avg(value), max(value2) FROM %1$I GROUP BY 1, 2'
+\set expect_compressed 'strict $.** ? (@."Custom Plan Provider" == "DecompressChunk" && @."Bulk Decompression" == true)'
+\set expect_uncompressed 'strict $.** ? (@."Node Type" == "Aggregate")'
@@ -0,0 +1,11 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- A filter on a column that is neither segmentby nor orderby, so it can't be
+-- checked on the compressed batch metadata and has to be evaluated on the
+-- decompressed values.
+\set name filter_non_segmentby
+\set query 'SELECT count(*) FROM %1$I WHERE value2 > 0.99'
+\set expect_compressed 'strict $.** ? (@."Custom Plan Provider" == "DecompressChunk" && @."Bulk Decompression" == true)'
+\set expect_uncompressed 'strict $.** ? (@."Node Type" == "Seq Scan")'
@@ -0,0 +1,9 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- Gapfilled hourly averages for a few devices over two days.
+\set name gapfill
+\set query 'SELECT time_bucket_gapfill(''1 hour'', time) AS bucket, device_id, locf(avg(value)) FROM %1$I WHERE time >= ''2023-01-01'' AND time < ''2023-01-03'' AND device_id < 5 GROUP BY 1, 2'
+\set expect_compressed 'strict $.** ? (@."Custom Plan Provider" == "GapFill")'
+\set expect_uncompressed 'strict $.** ? (@."Custom Plan Provider" == "GapFill")'
@@ -0,0 +1,9 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- The most recent value of every device.
+\set name last_point
+\set query 'SELECT DISTINCT ON (device_id) device_id, time, value FROM %1$I ORDER BY device_id, time DESC'
+\set expect_compressed 'strict $.** ? (@."Custom Plan Provider" == "DecompressChunk")'
+\set expect_uncompressed 'strict $.** ? (@."Node Type" == "Index Scan" || @."Node Type" == "Index Only Scan")'
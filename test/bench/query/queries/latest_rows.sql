@@ -0,0 +1,10 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- The most recent rows over all devices. On the compressed table, this should
+-- use the sorted merge of the compressed batches.
+\set name latest_rows
+\set query 'SELECT * FROM %1$I ORDER BY time DESC LIMIT 100'
+\set expect_compressed 'strict $.** ? (@."Custom Plan Provider" == "DecompressChunk" && @."Sorted merge append" == true)'
+\set expect_uncompressed 'strict $.** ? (@."Node Type" == "Limit")'
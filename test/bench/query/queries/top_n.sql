@@ -0,0 +1,10 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- The largest values over the whole table, sorted by a column that is not in
+-- the compression order.
+\set name top_n
+\set query 'SELECT device_id, time, value2 FROM %1$I ORDER BY value2 DESC LIMIT 10'
+\set expect_compressed 'strict $.** ? (@."Custom Plan Provider" == "DecompressChunk")'
+\set expect_uncompressed 'strict $.** ? (@."Node Type" == "Limit")'
@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+#
+# Query benchmark over compressed and uncompressed hypertables. Generates the
+# data with setup.sql, then runs every query in queries/ on both tables and
+# reports the median execution time, the DecompressChunk counters and the
+# plan. Exits with an error if a plan doesn't have the expected shape.
+#
+# Usage: run.sh [query...]
+#
+# Connects with the usual libpq environment variables, the database must have
+# the timescaledb extension. Settings through the environment:
+#
+#   DAYS     days of generated data (default 7)
+#   DEVICES  number of devices (default 50)
+#   RUNS     executions of each query, the median is reported (default 5)
+#   SETUP    set to 0 to reuse the data from a previous run (default 1)
+#
+# To compare settings, pass them in PGOPTIONS, e.g.
+# PGOPTIONS='-c timescaledb.enable_decompression_sorted_merge=off' run.sh
+
+set -eu
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+DAYS=${DAYS:-7}
+DEVICES=${DEVICES:-50}
+RUNS=${RUNS:-5}
+SETUP=${SETUP:-1}
+
+PSQL="psql -X -q -v ON_ERROR_STOP=1"
+
+if [ "$SETUP" = 1 ]; then
+  ${PSQL} -f "$DIR/setup.sql" -v days="$DAYS" -v devices="$DEVICES" > /dev/null
+fi
+
+failed=0
+first=1
+for file in "$DIR"/queries/*.sql; do
+  name=$(basename "$file" .sql)
+  if [ $# -gt 0 ] && [[ ! " $* " =~ " $name " ]]; then
+    continue
+  fi
+
+  output=$(${PSQL} -A -F ' | ' -P footer=off -v runs="$RUNS" -f "$file" -f "$DIR/run.sql")
+
+  # Print the header only once
+  if [ "$first" = 1 ]; then
+    echo "$output"
+    first=0
+  else
+    echo "$output" | tail -n +2
+  fi
+
+  if echo "$output" | grep -q '| FAIL$'; then
+    failed=1
+  fi
+done
+
+if [ "$failed" = 1 ]; then
+  echo "some plans don't have the expected shape" >&2
+  exit 1
+fi
@@ -0,0 +1,38 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- Runs one benchmark query, which is defined by the query file included
+-- before this one. The query file sets these psql variables:
+--
+--   query                the query, with %1$I in place of the table name
+--   expect_compressed    jsonpath that must match the plan on the compressed
+--                        table
+--   expect_uncompressed  jsonpath that must match the plan on the
+--                        uncompressed table
+--
+-- Outputs one row per table with the median execution time, the
+-- DecompressChunk counters, the plan nodes, and whether the plan matches.
+
+\set ON_ERROR_STOP 1
+
+SELECT :'name' AS query, t.table_name,
+    round(r.execution_ms::numeric, 3) AS execution_ms,
+    (SELECT sum(n::int) FROM jsonb_path_query(r.plan, 'strict $.**."Batches Read"') n)
+        AS batches_read,
+    (SELECT sum(n::int)
+     FROM jsonb_path_query(r.plan, 'strict $.**."Batches Filtered by Vectorized Quals"') n)
+        AS batches_filtered,
+    (SELECT sum(n::int) FROM jsonb_path_query(r.plan, 'strict $.**."Columns Bulk Decompressed"') n)
+        AS columns_bulk,
+    (SELECT sum(n::int)
+     FROM jsonb_path_query(r.plan, 'strict $.**."Columns Decompressed Row-by-Row"') n)
+        AS columns_row_by_row,
+    (SELECT string_agg(DISTINCT coalesce(node->>'Custom Plan Provider', node->>'Node Type'), ',')
+     FROM jsonb_path_query(r.plan, 'strict $.** ? (exists (@."Node Type"))') node)
+        AS plan_nodes,
+    CASE WHEN jsonb_path_exists(r.plan, t.expect::jsonpath) THEN 'ok' ELSE 'FAIL' END
+        AS plan_check
+FROM (VALUES ('bench_compressed', :'expect_compressed'),
+    ('bench_uncompressed', :'expect_uncompressed')) t(table_name, expect),
+    LATERAL bench_explain(format(:'query', t.table_name), :runs) r;
@@ -0,0 +1,57 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- Creates the data for the query benchmark: the same generated metrics in a
+-- compressed and in an uncompressed hypertable. Expects the psql variables
+-- set by run.sh:
+--
+--   days     number of days of data, one chunk per day
+--   devices  number of devices, one row every 30 seconds per device
+
+\set ON_ERROR_STOP 1
+SET client_min_messages TO warning;
+
+DROP TABLE IF EXISTS bench_compressed;
+DROP TABLE IF EXISTS bench_uncompressed;
+
+CREATE TABLE bench_uncompressed(time timestamptz NOT NULL, device_id int, value float8,
+    value2 float8);
+SELECT create_hypertable('bench_uncompressed', 'time', chunk_time_interval => interval '1 day');
+CREATE INDEX ON bench_uncompressed(device_id, time DESC);
+
+INSERT INTO bench_uncompressed
+SELECT '2023-01-01'::timestamptz + s * interval '30 seconds', d,
+    d + sin(s / 100.0), random()
+FROM generate_series(0, :days * 2880 - 1) s, generate_series(1, :devices) d;
+
+CREATE TABLE bench_compressed(LIKE bench_uncompressed);
+SELECT create_hypertable('bench_compressed', 'time', chunk_time_interval => interval '1 day');
+CREATE INDEX ON bench_compressed(device_id, time DESC);
+INSERT INTO bench_compressed SELECT * FROM bench_uncompressed;
+
+ALTER TABLE bench_compressed SET (timescaledb.compress,
+    timescaledb.compress_segmentby = 'device_id', timescaledb.compress_orderby = 'time DESC');
+SELECT count(compress_chunk(c)) FROM show_chunks('bench_compressed') c;
+
+VACUUM ANALYZE bench_uncompressed;
+VACUUM ANALYZE bench_compressed;
+
+-- Runs the query the given number of times, and returns the median execution
+-- time and the plan of the last run with its instrumentation.
+CREATE OR REPLACE FUNCTION bench_explain(query text, runs int, OUT execution_ms float8,
+    OUT plan jsonb)
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    times float8[] := '{}';
+    result jsonb;
+BEGIN
+    FOR i IN 1..runs LOOP
+        EXECUTE 'EXPLAIN (ANALYZE, BUFFERS, SUMMARY, FORMAT JSON) ' || query INTO result;
+        times := times || (result->0->>'Execution Time')::float8;
+    END LOOP;
+    SELECT percentile_cont(0.5) WITHIN GROUP (ORDER BY t) INTO execution_ms FROM unnest(times) t;
+    plan := result->0->'Plan';
+END
+$$;
@@ -49,3 +49,21 @@ SELECT first(longvalue, quantity) FROM partial_aggregation;
 SELECT last(longvalue, quantity) FROM partial_aggregation;
 SET enable_partitionwise_aggregate = OFF;
 
+-- Test the comparison of the common comparison element types, with
+-- negative values and several groups
+CREATE TABLE bookend_types AS
+SELECT i % 3 AS g, i AS v, c4, c4::bigint * 10000000000 AS c8,
+  '2000-01-01'::timestamp + c4 * interval '1 day' AS ts,
+  '2000-01-01 UTC'::timestamptz + c4 * interval '1 day' AS tstz,
+  '2000-01-01'::date + c4 AS d, c4::numeric AS n
+FROM generate_series(1, 1000) i, LATERAL (SELECT (i * 7919) % 1000 - 500 AS c4) c;
+SELECT g, first(v, c4) AS first_v, last(v, c4) AS last_v,
+  first(v, c8) = first(v, c4) AND first(v, ts) = first(v, c4) AND first(v, tstz) = first(v, c4)
+    AND first(v, d) = first(v, c4) AND first(v, n) = first(v, c4) AS same_first,
+  last(v, c8) = last(v, c4) AND last(v, ts) = last(v, c4) AND last(v, tstz) = last(v, c4)
+    AND last(v, d) = last(v, c4) AND last(v, n) = last(v, c4) AS same_last,
+  first(v, c4) = (array_agg(v ORDER BY c4))[1] AND last(v, c4) = (array_agg(v ORDER BY c4 DESC))[1] AS ordered
+FROM bookend_types
+GROUP BY g
+ORDER BY g;
+DROP TABLE bookend_types;
@@ -505,3 +505,29 @@ SELECT ch AS chunk_name FROM show_chunks('replid') ch ORDER BY chunk_name LIMIT
 ALTER TABLE :chunk_name REPLICA IDENTITY FULL;
 SELECT relname, relreplident FROM show_chunks('replid') ch INNER JOIN pg_class c ON (ch = c.oid) ORDER BY relname;
 
+-- Catalog updates of one hypertable invalidate the cache entry of that
+-- hypertable only, and the updated metadata is used for new chunks
+CREATE TABLE inval_a(time int NOT NULL, value int);
+CREATE TABLE inval_b(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('inval_a', 'time', chunk_time_interval => 10);
+SELECT table_name FROM create_hypertable('inval_b', 'time', chunk_time_interval => 10);
+INSERT INTO inval_a VALUES (0, 1);
+INSERT INTO inval_b VALUES (0, 1);
+SELECT set_chunk_time_interval('inval_a', 100);
+INSERT INTO inval_a VALUES (1000, 1);
+INSERT INTO inval_b VALUES (1000, 1);
+-- renaming updates the hypertable catalog
+ALTER TABLE inval_b RENAME TO inval_c;
+INSERT INTO inval_c VALUES (2000, 1);
+BEGIN;
+SELECT set_chunk_time_interval('inval_c', 1000);
+INSERT INTO inval_c VALUES (5000, 1);
+INSERT INTO inval_a VALUES (5000, 1);
+COMMIT;
+SELECT hypertable_name, range_start_integer, range_end_integer
+FROM timescaledb_information.chunks
+WHERE hypertable_name LIKE 'inval_%'
+ORDER BY 1, 2;
+SELECT count(*) FROM inval_a;
+SELECT count(*) FROM inval_c;
+DROP TABLE inval_a, inval_c;
@@ -0,0 +1,37 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE TABLE ingest(time int NOT NULL, value int, payload text);
+SELECT table_name FROM create_hypertable('ingest', 'time', chunk_time_interval => 1000);
+SELECT id AS dimension_id FROM _timescaledb_catalog.dimension WHERE column_name = 'time' \gset
+
+\set ON_ERROR_STOP 0
+SELECT _timescaledb_functions.calculate_chunk_interval_by_ingest_rate(:dimension_id, 0, -1);
+\set ON_ERROR_STOP 1
+
+-- Without any preceding chunk, the interval stays the same
+SELECT _timescaledb_functions.calculate_chunk_interval_by_ingest_rate(:dimension_id, 0, 10485760);
+
+-- Five chunks of about 200kB each, i.e., an ingest rate of about 200 bytes
+-- per unit of time
+INSERT INTO ingest SELECT t, t, repeat('x', 100) FROM generate_series(0, 4999) t;
+SELECT _timescaledb_functions.calculate_chunk_interval_by_ingest_rate(:dimension_id, 0, 10485760);
+
+-- A large target size grows the interval, but by at most a factor of two,
+-- and a small target size shrinks it, by at most a factor of two
+SELECT _timescaledb_functions.calculate_chunk_interval_by_ingest_rate(:dimension_id, 5000, 10485760);
+SELECT _timescaledb_functions.calculate_chunk_interval_by_ingest_rate(:dimension_id, 5000, 10240);
+
+-- A target size the preceding chunks do not fill by 1% does not give an
+-- estimate
+SELECT _timescaledb_functions.calculate_chunk_interval_by_ingest_rate(:dimension_id, 5000, 1099511627776);
+
+-- New chunks use the estimated interval
+SELECT * FROM set_adaptive_chunking('ingest', '10MB', '_timescaledb_functions.calculate_chunk_interval_by_ingest_rate');
+INSERT INTO ingest VALUES (10000, 10000, repeat('x', 100));
+SELECT range_start, range_end FROM _timescaledb_catalog.dimension_slice
+WHERE dimension_id = :dimension_id ORDER BY range_start DESC LIMIT 1;
+SELECT interval_length FROM _timescaledb_catalog.dimension WHERE id = :dimension_id;
@@ -0,0 +1,54 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- The number of chunks ChunkAppend excluded at executor startup
+CREATE FUNCTION startup_excluded(stmt text) RETURNS int LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (costs off) ' || stmt LOOP
+        IF line ~ 'Chunks excluded during startup' THEN
+            RETURN substring(line FROM '(\d+)$')::int;
+        END IF;
+    END LOOP;
+    RETURN NULL;
+END
+$$;
+
+CREATE TABLE cached(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('cached', 'time', chunk_time_interval => 10);
+INSERT INTO cached SELECT t, t * 10 FROM generate_series(0, 29) t;
+\set CHUNK1 _timescaledb_internal._hyper_1_1_chunk
+
+-- The startup exclusion uses the constraints of the chunks, which are cached
+-- across executions
+SELECT startup_excluded('SELECT count(*) FROM cached WHERE time < 15 + length(version()) * 0');
+SELECT startup_excluded('SELECT count(*) FROM cached WHERE time < 15 + length(version()) * 0');
+SELECT count(*) FROM cached WHERE time < 15 + length(version()) * 0;
+SELECT startup_excluded('SELECT count(*) FROM cached WHERE value > 150 + length(version()) * 0');
+
+-- Adding a constraint to a chunk invalidates its cached constraints
+ALTER TABLE :CHUNK1 ADD CONSTRAINT chunk1_value CHECK (value < 100);
+SELECT startup_excluded('SELECT count(*) FROM cached WHERE value > 150 + length(version()) * 0');
+SELECT startup_excluded('SELECT count(*) FROM cached WHERE value > 150 + length(version()) * 0');
+SELECT count(*) FROM cached WHERE value > 150 + length(version()) * 0;
+
+-- So does replacing and dropping it
+ALTER TABLE :CHUNK1 DROP CONSTRAINT chunk1_value;
+ALTER TABLE :CHUNK1 ADD CONSTRAINT chunk1_value CHECK (value < 200);
+SELECT startup_excluded('SELECT count(*) FROM cached WHERE value > 150 + length(version()) * 0');
+ALTER TABLE :CHUNK1 DROP CONSTRAINT chunk1_value;
+SELECT startup_excluded('SELECT count(*) FROM cached WHERE value > 150 + length(version()) * 0');
+INSERT INTO :CHUNK1 VALUES (5, 500);
+SELECT count(*) FROM cached WHERE value > 150 + length(version()) * 0;
+
+-- The constraints of a new chunk are used too
+INSERT INTO cached VALUES (35, 350);
+SELECT startup_excluded('SELECT count(*) FROM cached WHERE time < 15 + length(version()) * 0');
+SELECT count(*) FROM cached WHERE time < 15 + length(version()) * 0;
+
+DROP TABLE cached;
+DROP FUNCTION startup_excluded(text);
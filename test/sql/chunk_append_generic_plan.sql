@@ -0,0 +1,121 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- Whether the plan of the statement uses the parameter, i.e. it is the generic
+-- plan, and the number of chunks ChunkAppend excluded at runtime
+CREATE FUNCTION generic_plan(stmt text, OUT is_generic bool, OUT excluded int) LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+BEGIN
+    is_generic := false;
+    FOR line IN EXECUTE 'EXPLAIN (analyze, costs off, timing off, summary off) ' || stmt LOOP
+        IF line ~ '\$1' THEN
+            is_generic := true;
+        END IF;
+        IF line ~ 'Chunks excluded during runtime' THEN
+            excluded := substring(line FROM '(\d+)$')::int;
+        END IF;
+    END LOOP;
+END
+$$;
+
+CREATE TABLE point(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('point', 'time', chunk_time_interval => 10);
+INSERT INTO point SELECT t, d, t * 10 + d FROM generate_series(0, 39) t, generate_series(1, 3) d;
+ANALYZE point;
+
+-- The generic plan of a point query is costed with the chunks that remain after
+-- the runtime exclusion, so the plan cache switches to it after the first
+-- custom plans instead of replanning every execution
+PREPARE point_query(int) AS SELECT count(*), min(value) FROM point WHERE time = $1;
+EXECUTE point_query(5);
+EXECUTE point_query(15);
+EXECUTE point_query(25);
+EXECUTE point_query(35);
+EXECUTE point_query(7);
+EXECUTE point_query(17);
+EXECUTE point_query(27);
+SELECT * FROM generic_plan('EXECUTE point_query(33)');
+EXECUTE point_query(33);
+EXECUTE point_query(40);
+DEALLOCATE point_query;
+
+-- The same with the parameter on the left side
+PREPARE point_query(int) AS SELECT count(*), min(value) FROM point WHERE $1 = time;
+EXECUTE point_query(5);
+EXECUTE point_query(15);
+EXECUTE point_query(25);
+EXECUTE point_query(35);
+EXECUTE point_query(7);
+EXECUTE point_query(17);
+EXECUTE point_query(27);
+SELECT * FROM generic_plan('EXECUTE point_query(3)');
+DEALLOCATE point_query;
+
+DROP TABLE point;
+DROP FUNCTION generic_plan(text);
+
+-- The startup exclusion of a generic plan skips the chunks outside the time
+-- range of the comparisons with now() and the statement parameters
+CREATE FUNCTION startup_excluded(stmt text) RETURNS int LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (analyze, costs off, timing off, summary off) ' || stmt LOOP
+        IF line ~ 'Chunks excluded during startup' THEN
+            RETURN substring(line FROM '(\d+)$')::int;
+        END IF;
+    END LOOP;
+    RETURN 0;
+END
+$$;
+CREATE TABLE startup(time timestamptz NOT NULL, value int);
+SELECT table_name FROM create_hypertable('startup', 'time', chunk_time_interval => interval '1 day');
+INSERT INTO startup SELECT '2000-01-01 12:00+00'::timestamptz + d * interval '1 day', d FROM generate_series(0, 4) d;
+INSERT INTO startup VALUES ('2200-01-01 12:00+00', 100);
+SET plan_cache_mode TO force_generic_plan;
+PREPARE recent(interval) AS SELECT value FROM startup WHERE time > now() - $1;
+SELECT startup_excluded('EXECUTE recent(''1 day'')');
+EXECUTE recent('1 day');
+PREPARE window_query(timestamptz) AS SELECT value FROM startup WHERE time >= $1 AND time < $1 + interval '2 day';
+SELECT startup_excluded('EXECUTE window_query(''2000-01-02 00:00+00'')');
+EXECUTE window_query('2000-01-02 00:00+00');
+DEALLOCATE recent;
+DEALLOCATE window_query;
+RESET plan_cache_mode;
+DROP TABLE startup;
+DROP FUNCTION startup_excluded(text);
+
+-- The times of the internal phases of ChunkAppend are shown with
+-- enable_node_timing for EXPLAIN (ANALYZE, VERBOSE) with TIMING
+CREATE FUNCTION timing_properties(options text, stmt text) RETURNS SETOF text LANGUAGE plpgsql AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE format('EXPLAIN (%s, FORMAT JSON) %s', options, stmt) INTO plan;
+  RETURN QUERY
+  WITH RECURSIVE nodes(node) AS (
+    SELECT plan -> 0 -> 'Plan'
+    UNION ALL
+    SELECT child FROM nodes, jsonb_array_elements(node -> 'Plans') child
+  )
+  SELECT key FROM nodes, jsonb_object_keys(node) key
+  WHERE node ->> 'Custom Plan Provider' = 'ChunkAppend' AND key LIKE '% Time'
+    AND key NOT IN ('Actual Startup Time', 'Actual Total Time')
+  ORDER BY key;
+END
+$$;
+CREATE TABLE node_timing(time timestamptz NOT NULL, value int);
+SELECT table_name FROM create_hypertable('node_timing', 'time', chunk_time_interval => interval '1 day');
+INSERT INTO node_timing SELECT '2000-01-01 12:00+00'::timestamptz + d * interval '1 day', d FROM generate_series(0, 2) d;
+SELECT timing_properties('ANALYZE, VERBOSE', 'SELECT value FROM node_timing WHERE time < now()');
+SET timescaledb.enable_node_timing TO on;
+SELECT timing_properties('ANALYZE, VERBOSE', 'SELECT value FROM node_timing WHERE time < now()');
+SELECT timing_properties('ANALYZE, VERBOSE, TIMING OFF', 'SELECT value FROM node_timing WHERE time < now()');
+SELECT timing_properties('ANALYZE', 'SELECT value FROM node_timing WHERE time < now()');
+RESET timescaledb.enable_node_timing;
+DROP TABLE node_timing;
+DROP FUNCTION timing_properties(text, text);
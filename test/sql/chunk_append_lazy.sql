@@ -0,0 +1,50 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE FUNCTION has_chunk_append(stmt text) RETURNS bool LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (costs off) ' || stmt LOOP
+        IF line ~ 'ChunkAppend' THEN
+            RETURN true;
+        END IF;
+    END LOOP;
+    RETURN false;
+END
+$$;
+
+CREATE TABLE ordered(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('ordered', 'time', chunk_time_interval => 24);
+INSERT INTO ordered SELECT t, t % 3, t * 0.5 FROM generate_series(0, 95) t;
+ANALYZE ordered;
+
+-- ChunkAppend initializes the chunk subplans when it starts reading them, so
+-- an ordered append under a LIMIT only initializes the chunks it reads
+SELECT has_chunk_append('SELECT * FROM ordered ORDER BY time DESC LIMIT 3');
+SELECT * FROM ordered ORDER BY time DESC LIMIT 3;
+SELECT * FROM ordered ORDER BY time LIMIT 3 OFFSET 23;
+
+-- A rescan with runtime exclusion only initializes the chunks that are read
+SELECT x, (SELECT time FROM ordered WHERE time < x ORDER BY time DESC LIMIT 1)
+FROM (VALUES (12), (36), (60), (84), (200), (-5)) v(x);
+-- A rescan after some chunks were initialized in the previous loop
+SELECT x, o.time FROM (VALUES (1), (2), (0)) v(x)
+CROSS JOIN LATERAL (SELECT time FROM ordered ORDER BY time DESC LIMIT 2 OFFSET v.x * 24) o;
+
+-- A cursor initializes the next chunks as it fetches from them
+BEGIN;
+DECLARE c CURSOR FOR SELECT time FROM ordered ORDER BY time LIMIT 30;
+FETCH 2 FROM c;
+FETCH 25 FROM c;
+FETCH 5 FROM c;
+COMMIT;
+
+-- A LIMIT that reads several chunks
+SELECT count(*), sum(time) FROM (SELECT time FROM ordered ORDER BY time DESC LIMIT 50) o;
+
+DROP TABLE ordered;
+DROP FUNCTION has_chunk_append(text);
@@ -0,0 +1,52 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE FUNCTION has_parallel_chunk_append(stmt text) RETURNS bool LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (costs off) ' || stmt LOOP
+        IF line ~ 'Parallel Custom Scan \(ChunkAppend\)' THEN
+            RETURN true;
+        END IF;
+    END LOOP;
+    RETURN false;
+END
+$$;
+
+-- The chunks have very different sizes and the largest one is the last in the
+-- plan order
+CREATE TABLE skewed(i int NOT NULL, j float);
+SELECT table_name FROM create_hypertable('skewed', 'i', chunk_time_interval => 100000);
+INSERT INTO skewed SELECT x, x * 0.5 FROM generate_series(0, 999) x;
+INSERT INTO skewed SELECT x, x * 0.5 FROM generate_series(100000, 109999) x;
+INSERT INTO skewed SELECT x, x * 0.5 FROM generate_series(200000, 299999) x;
+ANALYZE skewed;
+
+SET max_parallel_workers_per_gather TO 2;
+SET parallel_setup_cost TO 0;
+SET parallel_tuple_cost TO 0;
+SET min_parallel_table_scan_size TO 0;
+
+-- The parallel workers pick the most expensive chunk first, and every chunk is
+-- still scanned exactly once
+SELECT has_parallel_chunk_append('SELECT count(*), sum(i), count(DISTINCT tableoid) AS chunks FROM skewed WHERE i > 1 AND length(version()) > 0');
+SELECT count(*), sum(i), count(DISTINCT tableoid) AS chunks FROM skewed WHERE i > 1 AND length(version()) > 0;
+
+-- The same with the workers only
+SET parallel_leader_participation TO off;
+SELECT count(*), sum(i), count(DISTINCT tableoid) AS chunks FROM skewed WHERE i > 1 AND length(version()) > 0;
+RESET parallel_leader_participation;
+
+-- The chunks excluded at runtime are skipped in the cost order
+SELECT count(*), sum(i) FROM skewed WHERE i > (SELECT 100500) AND length(version()) > 0;
+
+RESET max_parallel_workers_per_gather;
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET min_parallel_table_scan_size;
+DROP TABLE skewed;
+DROP FUNCTION has_parallel_chunk_append(text);
@@ -0,0 +1,58 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- The number of chunks ChunkAppend excluded at runtime, averaged over the loops
+CREATE FUNCTION runtime_excluded(stmt text) RETURNS int LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (analyze, costs off, timing off, summary off) ' || stmt LOOP
+        IF line ~ 'Chunks excluded during runtime' THEN
+            RETURN substring(line FROM '(\d+)$')::int;
+        END IF;
+    END LOOP;
+    RETURN NULL;
+END
+$$;
+
+CREATE TABLE ranges(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('ranges', 'time', chunk_time_interval => 10);
+INSERT INTO ranges SELECT t, t % 7 FROM generate_series(0, 49) t;
+ANALYZE ranges;
+
+-- The chunks are excluded on a rescan by comparing the parameter values with
+-- the time ranges of the chunks
+SELECT x,
+    (SELECT count(*) FROM ranges WHERE time >= x AND time < x + 15) AS window,
+    (SELECT count(*) FROM ranges WHERE time = x) AS point,
+    (SELECT count(*) FROM ranges WHERE x < time) AS after,
+    (SELECT count(*) FROM ranges WHERE x >= time) AS upto
+FROM (VALUES (-100), (-5), (0), (9), (10), (20), (45), (60), (NULL::int)) v(x);
+
+-- The other clauses with parameters are still checked against the chunk constraints
+SELECT x, (SELECT count(*) FROM ranges WHERE time >= x AND value < 3 + x - x) AS count
+FROM (VALUES (-100), (-5), (0), (9), (10), (20), (45), (60), (NULL::int)) v(x);
+
+SELECT runtime_excluded('SELECT x, (SELECT count(*) FROM ranges WHERE time >= x AND time < x + 15)
+FROM (VALUES (20)) v(x)');
+SELECT runtime_excluded('SELECT x, (SELECT count(*) FROM ranges WHERE time = x)
+FROM (VALUES (45)) v(x)');
+SELECT runtime_excluded('SELECT x, (SELECT count(*) FROM ranges WHERE time < x)
+FROM (VALUES (NULL::int)) v(x)');
+
+-- The same with a timestamp time column
+CREATE TABLE ranges_tz(time timestamptz NOT NULL, value int);
+SELECT table_name FROM create_hypertable('ranges_tz', 'time', chunk_time_interval => interval '1 day');
+INSERT INTO ranges_tz SELECT '2023-01-01 UTC'::timestamptz + t * interval '1 hour', t FROM generate_series(0, 119) t;
+ANALYZE ranges_tz;
+SELECT d, (SELECT count(*) FROM ranges_tz
+    WHERE time >= '2023-01-01 UTC'::timestamptz + d * interval '1 day' - interval '6 hours'
+    AND time < '2023-01-01 UTC'::timestamptz + d * interval '1 day' + interval '6 hours') AS count
+FROM generate_series(0, 6) d;
+
+DROP TABLE ranges;
+DROP TABLE ranges_tz;
+DROP FUNCTION runtime_excluded(text);
@@ -0,0 +1,54 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE TABLE metrics(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 10);
+
+-- Every chunk has to get exactly the rows of its time range, and every time
+-- range has to go to a single chunk
+CREATE VIEW misrouted AS
+SELECT count(*) AS rows, count(DISTINCT tableoid) AS chunks, count(DISTINCT time / 10) AS ranges,
+       (SELECT count(*) FROM (SELECT FROM metrics GROUP BY tableoid HAVING count(DISTINCT time / 10) > 1) s) AS mixed_chunks
+FROM metrics;
+
+-- The rows cycle through more chunks than the list of the recently used chunks
+-- holds, then through fewer of them
+INSERT INTO metrics SELECT i % 6 * 10 + i / 6 % 10, i FROM generate_series(0, 599) i;
+INSERT INTO metrics SELECT 60 + i % 3 * 10 + i / 3 % 10, i FROM generate_series(0, 299) i;
+SELECT * FROM misrouted;
+
+-- Closing the chunk insert states when there are too many open chunks resets
+-- the list
+TRUNCATE metrics;
+SET timescaledb.max_open_chunks_per_insert TO 2;
+INSERT INTO metrics SELECT i % 6 * 10 + i / 6 % 10, i FROM generate_series(0, 599) i;
+COPY metrics FROM STDIN;
+60	0
+70	1
+80	2
+90	3
+100	4
+61	5
+71	6
+81	7
+91	8
+101	9
+62	10
+72	11
+82	12
+92	13
+102	14
+63	15
+73	16
+83	17
+93	18
+103	19
+\.
+SELECT * FROM misrouted;
+RESET timescaledb.max_open_chunks_per_insert;
+
+DROP VIEW misrouted;
+DROP TABLE metrics;
@@ -0,0 +1,42 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE TABLE metrics(time int NOT NULL, payload text);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 1000000);
+
+-- The AFTER ROW trigger events are queued when the buffers are flushed, one
+-- buffer after another. The rows of the COPY alternate between two chunks, so
+-- every flush gives one run of events for each chunk.
+CREATE TABLE insert_log(id serial, chunk oid);
+CREATE FUNCTION log_insert() RETURNS trigger LANGUAGE plpgsql AS $$
+BEGIN
+    INSERT INTO insert_log(chunk) VALUES (TG_RELID);
+    RETURN NULL;
+END
+$$;
+CREATE TRIGGER log_insert AFTER INSERT ON metrics FOR EACH ROW EXECUTE FUNCTION log_insert();
+CREATE VIEW insert_runs AS
+SELECT count(*) FILTER (WHERE chunk IS DISTINCT FROM prev) AS runs
+FROM (SELECT chunk, lag(chunk) OVER (ORDER BY id) AS prev FROM insert_log) s;
+
+-- The narrow rows are buffered up to the limit of 10000 tuples, instead of
+-- flushing every 1000 tuples
+COPY metrics FROM PROGRAM 'awk ''BEGIN { OFS = ","; for (i = 0; i < 20000; i++) print i % 2 * 1000000 + i, "x" }''' WITH (FORMAT csv);
+SELECT count(*), count(DISTINCT tableoid), sum(length(payload)) FROM metrics;
+SELECT runs BETWEEN 2 AND 6 AS few_flushes FROM insert_runs;
+
+-- The wide rows are flushed when they fill the memory budget of 1 MB, instead of
+-- flushing every 64 kB of input
+TRUNCATE metrics;
+TRUNCATE insert_log;
+COPY metrics FROM PROGRAM 'awk ''BEGIN { OFS = ","; for (j = 0; j < 200; j++) s = s "xxxxxxxxxx"; for (i = 0; i < 2000; i++) print i % 2 * 1000000 + i, s }''' WITH (FORMAT csv);
+SELECT count(*), count(DISTINCT tableoid), sum(length(payload)) FROM metrics;
+SELECT runs BETWEEN 4 AND 12 AS few_flushes FROM insert_runs;
+
+DROP TABLE metrics;
+DROP VIEW insert_runs;
+DROP TABLE insert_log;
+DROP FUNCTION log_insert();
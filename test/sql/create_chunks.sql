@@ -121,3 +121,20 @@ SELECT set_chunk_time_interval('chunk_test', NULL::BIGINT);
 SELECT set_chunk_time_interval('chunk_test2', NULL::BIGINT);
 SELECT set_chunk_time_interval('chunk_test2', NULL::INTERVAL);
 \set ON_ERROR_STOP 1
+
+-- The shared wait statistics count the lock waits when creating chunks
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT _timescaledb_functions.wait_stats_reset();
+CREATE TABLE wait_test(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('wait_test', 'time', chunk_time_interval => 10);
+INSERT INTO wait_test SELECT t, t FROM generate_series(0, 29) t;
+SELECT wait_event, waits >= 3 AS counted, total_time >= max_time AS consistent
+FROM _timescaledb_functions.wait_stats()
+WHERE wait_event LIKE 'chunk_%'
+ORDER BY wait_event;
+SELECT wait_event FROM _timescaledb_functions.wait_stats() ORDER BY wait_event;
+DROP TABLE wait_test;
+\c :TEST_DBNAME :ROLE_DEFAULT_PERM_USER
+\set ON_ERROR_STOP 0
+SELECT _timescaledb_functions.wait_stats_reset();
+\set ON_ERROR_STOP 1
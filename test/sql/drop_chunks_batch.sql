@@ -0,0 +1,47 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE TABLE expiring(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('expiring', 'time', chunk_time_interval => 10);
+INSERT INTO expiring SELECT t, t FROM generate_series(0, 59) t;
+
+-- The chunks of the hypertable together with their catalog rows
+CREATE VIEW expiring_chunks AS
+SELECT c.table_name,
+  (SELECT count(*) FROM _timescaledb_catalog.chunk_constraint cc WHERE cc.chunk_id = c.id) AS constraints
+FROM _timescaledb_catalog.chunk c
+JOIN _timescaledb_catalog.hypertable h ON h.id = c.hypertable_id
+WHERE h.table_name = 'expiring'
+ORDER BY c.id;
+
+SET timescaledb.enable_batched_chunk_drop TO on;
+SELECT drop_chunks('expiring', older_than => 30);
+SELECT * FROM expiring_chunks;
+SELECT count(*) FROM pg_class WHERE relname IN ('_hyper_1_1_chunk', '_hyper_1_2_chunk', '_hyper_1_3_chunk');
+SELECT show_chunks('expiring');
+SELECT count(*) FROM _timescaledb_catalog.dimension_slice ds
+JOIN _timescaledb_catalog.dimension d ON d.id = ds.dimension_id
+JOIN _timescaledb_catalog.hypertable h ON h.id = d.hypertable_id
+WHERE h.table_name = 'expiring';
+SELECT min(time), max(time), count(*) FROM expiring;
+
+-- With RESTRICT, an object that depends on one of the chunks stops the
+-- whole batch and nothing is dropped
+CREATE VIEW chunk_view AS SELECT * FROM _timescaledb_internal._hyper_1_5_chunk;
+\set ON_ERROR_STOP 0
+SELECT drop_chunks('expiring', older_than => 60);
+\set ON_ERROR_STOP 1
+SELECT * FROM expiring_chunks;
+SELECT count(*) FROM expiring;
+
+DROP VIEW chunk_view;
+SELECT drop_chunks('expiring', older_than => 50);
+SELECT * FROM expiring_chunks;
+SELECT min(time), max(time), count(*) FROM expiring;
+
+-- Without any expired chunk, there is nothing to drop
+SELECT drop_chunks('expiring', older_than => 50);
+RESET timescaledb.enable_batched_chunk_drop;
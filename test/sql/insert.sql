@@ -208,3 +208,39 @@ ALTER TABLE i3037 ADD COLUMN value float DEFAULT 0;
 INSERT INTO i3037 VALUES ('2000-01-01');
 INSERT INTO i3037 VALUES ('2000-01-01') ON CONFLICT(time) DO UPDATE SET value = EXCLUDED.value;
 
+-- More cache pins than the initial size of the pin array are held at the
+-- same time, and pins taken in aborted subtransactions are released
+CREATE TABLE cache_pins(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('cache_pins', 'time', chunk_time_interval => 10);
+DO $$
+BEGIN
+  EXECUTE (SELECT 'WITH ' || string_agg(format('i%s AS (INSERT INTO cache_pins VALUES (%s, %s))', i, i, i), ', ') || ' SELECT 1'
+           FROM generate_series(1, 40) i);
+END
+$$;
+SELECT count(*), sum(value), count(DISTINCT tableoid) AS chunks FROM cache_pins;
+DO $$
+BEGIN
+  FOR i IN 41..60 LOOP
+    BEGIN
+      INSERT INTO cache_pins VALUES (i, i);
+      IF i % 2 = 0 THEN
+        RAISE EXCEPTION 'rollback %', i;
+      END IF;
+    EXCEPTION WHEN raise_exception THEN
+      NULL;
+    END;
+  END LOOP;
+END
+$$;
+BEGIN;
+INSERT INTO cache_pins VALUES (61, 61);
+SAVEPOINT s1;
+INSERT INTO cache_pins VALUES (62, 62);
+SAVEPOINT s2;
+INSERT INTO cache_pins VALUES (71, 71);
+ROLLBACK TO SAVEPOINT s1;
+INSERT INTO cache_pins VALUES (63, 63);
+COMMIT;
+SELECT count(*), sum(value), count(DISTINCT tableoid) AS chunks FROM cache_pins;
+DROP TABLE cache_pins;
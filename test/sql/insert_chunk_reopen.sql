@@ -0,0 +1,67 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE TABLE backfill(time int NOT NULL, device int NOT NULL, value float CHECK (value >= 0));
+SELECT table_name FROM create_hypertable('backfill', 'time', chunk_time_interval => 10);
+CREATE UNIQUE INDEX ON backfill(time, device);
+
+-- Inserting out of order into more chunks than can be kept open closes and
+-- reopens the chunks, which reuses the CHECK constraints planned when the
+-- chunk was first opened
+SET timescaledb.max_open_chunks_per_insert TO 2;
+INSERT INTO backfill SELECT (i % 5) * 10 + i / 5 % 10, i / 50, i FROM generate_series(0, 499) i;
+SELECT time / 10 AS bucket, count(*), count(DISTINCT tableoid) AS chunks, sum(value)
+FROM backfill GROUP BY 1 ORDER BY 1;
+
+-- The constraints are still checked in the reopened chunks
+INSERT INTO backfill SELECT (i % 5) * 10 + i / 5 % 10, 100 + i, 3 - i FROM generate_series(0, 9) i;
+INSERT INTO backfill SELECT (i % 5) * 10 + i / 5 % 10, 100 + i, 5 - i FROM generate_series(0, 9) i;
+SELECT count(*) FROM backfill WHERE device >= 100;
+
+-- The dimension constraints are checked when the conflicting row is updated,
+-- also in the reopened chunks
+INSERT INTO backfill SELECT (i % 5) * 10 + i / 5 % 10, i / 50, 1 FROM generate_series(0, 499) i
+ON CONFLICT (time, device) DO UPDATE SET value = excluded.value;
+SELECT count(*), sum(value), count(DISTINCT tableoid) AS chunks FROM backfill;
+INSERT INTO backfill SELECT (i % 5) * 10 + i / 5 % 10, i / 50, 1 FROM generate_series(0, 9) i
+ON CONFLICT (time, device) DO UPDATE SET time = backfill.time + CASE WHEN excluded.time = 1 THEN 10 ELSE 0 END;
+
+RESET timescaledb.max_open_chunks_per_insert;
+DROP TABLE backfill;
+
+-- The chunks of a space partitioned hypertable are found in the subspace store
+-- by searching the ranges of the time and the space slices, also with gaps
+-- between the time ranges and at the ends of the time dimension
+CREATE TABLE store(time int NOT NULL, device int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('store', 'time', 'device', 4, chunk_time_interval => 10);
+INSERT INTO store SELECT t, d, d FROM unnest(ARRAY[-35, 0, 57, 93, 2147483000, -2147483000, 12]) t, generate_series(1, 20) d;
+INSERT INTO store SELECT t, d, d FROM unnest(ARRAY[-34, 1, 58, 94, 2147483001, -2147482999, 13]) t, generate_series(1, 20) d;
+SET timescaledb.max_open_chunks_per_insert TO 2;
+INSERT INTO store SELECT t, d, d FROM unnest(ARRAY[-33, 2, 59, 95, 2147483002, -2147482998, 14]) t, generate_series(1, 20) d;
+RESET timescaledb.max_open_chunks_per_insert;
+SELECT sum(rows) AS rows, bool_and(buckets = 1) AS one_bucket_per_chunk,
+  count(*) = (SELECT count(*) FROM show_chunks('store')) AS all_chunks_used
+FROM (SELECT tableoid, count(*) AS rows, count(DISTINCT floor(time / 10.0)) AS buckets
+  FROM store GROUP BY tableoid) c;
+SELECT count(*) AS buckets FROM (SELECT DISTINCT floor(time / 10.0) FROM store) b;
+DROP TABLE store;
+
+-- When the store is full, single chunk insert states are evicted, so the
+-- chunk that every other row goes to stays open while the rows in between
+-- sweep over the other chunks
+CREATE TABLE evict(time int NOT NULL, device int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('evict', 'time', 'device', 2, chunk_time_interval => 10);
+CREATE UNIQUE INDEX ON evict(time, device);
+SET timescaledb.max_open_chunks_per_insert TO 2;
+INSERT INTO evict SELECT CASE WHEN i % 2 = 0 THEN i / 2 % 10 ELSE 10 + i * 7 % 50 END, i % 8, i
+FROM generate_series(0, 999) i ON CONFLICT DO NOTHING;
+SELECT count(*), count(DISTINCT tableoid) = (SELECT count(*) FROM show_chunks('evict')) AS all_chunks_used FROM evict;
+-- the conflicts are found in the evicted and reopened chunks
+INSERT INTO evict SELECT CASE WHEN i % 2 = 0 THEN i / 2 % 10 ELSE 10 + i * 7 % 50 END, i % 8, i
+FROM generate_series(0, 999) i ON CONFLICT DO NOTHING;
+SELECT count(*) FROM evict;
+RESET timescaledb.max_open_chunks_per_insert;
+DROP TABLE evict;
@@ -0,0 +1,36 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE TABLE metrics(time int NOT NULL, device int, value float CHECK (value >= 0), UNIQUE (time, device));
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 10);
+
+-- The tuples are routed to the chunk whose dimension slices contain them, so
+-- the dimension constraints of the chunks are not checked, but they still hold
+INSERT INTO metrics SELECT t, 1, t FROM generate_series(1, 25) t;
+COPY metrics FROM STDIN;
+5	2	0.5
+15	2	1.5
+35	2	3.5
+\.
+SELECT tableoid::regclass AS chunk, min(time), max(time), count(*) FROM metrics GROUP BY 1 ORDER BY 1;
+
+-- The other CHECK constraints are checked
+INSERT INTO metrics VALUES (3, 3, -1);
+COPY metrics FROM STDIN;
+13	3	-1
+\.
+
+-- The inserts into the chunk itself check its dimension constraints
+INSERT INTO _timescaledb_internal._hyper_1_1_chunk VALUES (12, 3, 1);
+
+-- ON CONFLICT DO UPDATE can move the tuple out of the chunk, so it checks them
+INSERT INTO metrics VALUES (3, 1, 0) ON CONFLICT (time, device) DO UPDATE SET time = metrics.time + 10;
+INSERT INTO metrics VALUES (3, 1, 0) ON CONFLICT (time, device) DO UPDATE SET value = 42;
+INSERT INTO metrics VALUES (3, 1, 0) ON CONFLICT (time, device) DO NOTHING;
+SELECT * FROM metrics WHERE time = 3;
+SELECT tableoid::regclass AS chunk, min(time), max(time), count(*) FROM metrics GROUP BY 1 ORDER BY 1;
+
+DROP TABLE metrics;
@@ -30,3 +30,39 @@ FROM many_partitions_test
 GROUP BY period, device;
 
 SELECT * FROM many_partitions_test_1m ORDER BY time, device LIMIT 10;
+
+-- The tuples of a plain INSERT are buffered and inserted into the chunks in
+-- batches, check that they are all inserted and indexed.
+CREATE TABLE multi_insert(time timestamptz NOT NULL, device int, value float8);
+SELECT create_hypertable('multi_insert', 'time', chunk_time_interval => interval '1 day');
+CREATE UNIQUE INDEX ON multi_insert(time, device);
+INSERT INTO multi_insert
+SELECT '2023-01-01 00:00+00'::timestamptz + interval '1 minute' * x, x % 5, x
+FROM generate_series(1, 5000) x;
+SELECT count(*), count(DISTINCT tableoid), sum(value) FROM multi_insert;
+SET enable_seqscan TO off;
+SET enable_bitmapscan TO off;
+SELECT count(*) FROM multi_insert WHERE time < '2023-01-01 01:00+00';
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+
+-- The same without buffering.
+SET timescaledb.enable_multi_insert TO off;
+INSERT INTO multi_insert
+SELECT '2023-01-10 00:00+00'::timestamptz + interval '1 minute' * x, x % 5, x
+FROM generate_series(1, 100) x;
+RESET timescaledb.enable_multi_insert;
+SELECT count(*), count(DISTINCT tableoid), sum(value) FROM multi_insert;
+
+-- Create the next chunk ahead of time once the inserts are past the threshold
+-- of the current chunk's interval.
+CREATE TABLE precreate(time int NOT NULL, value int);
+SELECT create_hypertable('precreate', 'time', chunk_time_interval => 10);
+SET timescaledb.chunk_precreation_threshold TO 50;
+INSERT INTO precreate VALUES (2, 1);
+SELECT count(*) FROM show_chunks('precreate');
+INSERT INTO precreate VALUES (7, 1);
+INSERT INTO precreate VALUES (8, 1);
+RESET timescaledb.chunk_precreation_threshold;
+SELECT range_start_integer, range_end_integer FROM timescaledb_information.chunks
+WHERE hypertable_name = 'precreate' ORDER BY 1;
@@ -0,0 +1,152 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- Check if the query reads the last point cache instead of the chunks
+CREATE FUNCTION uses_cache(query text) RETURNS boolean LANGUAGE plpgsql AS
+$$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (costs off) ' || query LOOP
+        IF line ~ '_last_point' THEN
+            RETURN true;
+        END IF;
+    END LOOP;
+    RETURN false;
+END
+$$;
+
+CREATE TABLE metrics(time int NOT NULL, device int NOT NULL, value float);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 10);
+INSERT INTO metrics SELECT x, x % 3, x FROM generate_series(0, 47) x;
+
+\set ON_ERROR_STOP 0
+SELECT add_last_point_cache('metrics', '{}');
+SELECT add_last_point_cache('metrics', '{nope}');
+SELECT add_last_point_cache('metrics', '{time}');
+SELECT add_last_point_cache('metrics', '{value}');
+SELECT add_last_point_cache('metrics', '{device,device}');
+SELECT remove_last_point_cache('metrics');
+SELECT refresh_last_point_cache('metrics');
+\set ON_ERROR_STOP 1
+
+SELECT add_last_point_cache('metrics', '{device}');
+\set ON_ERROR_STOP 0
+SELECT add_last_point_cache('metrics', '{device}');
+\set ON_ERROR_STOP 1
+SELECT add_last_point_cache('metrics', '{device}', if_not_exists => true);
+SELECT * FROM _timescaledb_catalog.hypertable_last_point_cache;
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+
+-- the query for the latest row of each series reads the cache
+SELECT uses_cache('SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC');
+SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC;
+SELECT uses_cache('SELECT DISTINCT ON (device) device, value FROM metrics m ORDER BY device, m.time DESC');
+-- but not the other queries
+SELECT uses_cache('SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time');
+SELECT uses_cache('SELECT DISTINCT ON (device) * FROM metrics WHERE value > 10 ORDER BY device, time DESC');
+SELECT uses_cache('SELECT DISTINCT ON (value) * FROM metrics ORDER BY value, time DESC');
+SELECT uses_cache('SELECT DISTINCT ON (device) device, random() FROM metrics ORDER BY device, time DESC');
+SELECT uses_cache('SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC, value');
+SET timescaledb.enable_last_point_cache TO off;
+SELECT uses_cache('SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC');
+RESET timescaledb.enable_last_point_cache;
+
+-- inserts keep the cache up to date, and older rows don't replace newer ones
+INSERT INTO metrics VALUES (50, 0, 100), (49, 1, 99), (48, 3, 98), (10, 2, -1);
+COPY metrics FROM STDIN;
+51	2	101
+11	3	-1
+\.
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC;
+SET timescaledb.enable_last_point_cache TO off;
+SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC;
+RESET timescaledb.enable_last_point_cache;
+
+-- UPDATE, DELETE, drop_chunks and TRUNCATE invalidate the cache until it is
+-- refreshed
+UPDATE metrics SET value = 0 WHERE time = 50;
+SELECT valid FROM _timescaledb_catalog.hypertable_last_point_cache;
+SELECT uses_cache('SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC');
+SELECT refresh_last_point_cache('metrics');
+SELECT valid FROM _timescaledb_catalog.hypertable_last_point_cache;
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+
+DELETE FROM metrics WHERE time = 51;
+SELECT valid FROM _timescaledb_catalog.hypertable_last_point_cache;
+SELECT uses_cache('SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC');
+SELECT refresh_last_point_cache('metrics');
+SELECT valid FROM _timescaledb_catalog.hypertable_last_point_cache;
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+
+SELECT count(*) FROM drop_chunks('metrics', older_than => 10);
+SELECT valid FROM _timescaledb_catalog.hypertable_last_point_cache;
+SELECT refresh_last_point_cache('metrics');
+SELECT valid FROM _timescaledb_catalog.hypertable_last_point_cache;
+
+-- a BEFORE ROW trigger could change the inserted rows
+CREATE FUNCTION double_value() RETURNS trigger LANGUAGE plpgsql AS
+$$
+BEGIN
+    NEW.value := NEW.value * 2;
+    RETURN NEW;
+END
+$$;
+CREATE TRIGGER double_value BEFORE INSERT ON metrics FOR EACH ROW EXECUTE FUNCTION double_value();
+INSERT INTO metrics VALUES (60, 0, 1);
+SELECT valid FROM _timescaledb_catalog.hypertable_last_point_cache;
+DROP TRIGGER double_value ON metrics;
+SELECT refresh_last_point_cache('metrics');
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+
+-- a cached plan is planned again when the cache becomes invalid or valid
+SET plan_cache_mode TO force_generic_plan;
+PREPARE latest AS SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC;
+SELECT uses_cache('EXECUTE latest');
+EXECUTE latest;
+DELETE FROM metrics WHERE time = 60;
+SELECT uses_cache('EXECUTE latest');
+EXECUTE latest;
+SELECT refresh_last_point_cache('metrics');
+SELECT uses_cache('EXECUTE latest');
+EXECUTE latest;
+DEALLOCATE latest;
+RESET plan_cache_mode;
+
+-- reading the cache needs the permissions on the hypertable, but not on the
+-- cache table
+GRANT SELECT ON metrics TO :ROLE_DEFAULT_PERM_USER;
+SET ROLE :ROLE_DEFAULT_PERM_USER;
+SELECT uses_cache('SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC');
+SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC;
+\set ON_ERROR_STOP 0
+SELECT * FROM _timescaledb_internal._hyper_1_last_point;
+SELECT refresh_last_point_cache('metrics');
+SELECT remove_last_point_cache('metrics');
+RESET ROLE;
+SET ROLE :ROLE_DEFAULT_PERM_USER_2;
+SELECT DISTINCT ON (device) * FROM metrics ORDER BY device, time DESC;
+\set ON_ERROR_STOP 1
+RESET ROLE;
+
+TRUNCATE metrics;
+SELECT valid FROM _timescaledb_catalog.hypertable_last_point_cache;
+SELECT refresh_last_point_cache('metrics');
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+INSERT INTO metrics VALUES (5, 1, 5);
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+
+SELECT remove_last_point_cache('metrics');
+SELECT remove_last_point_cache('metrics', if_exists => true);
+SELECT count(*) FROM _timescaledb_catalog.hypertable_last_point_cache;
+SELECT to_regclass('_timescaledb_internal._hyper_1_last_point');
+
+-- the cache is dropped together with the hypertable
+SELECT add_last_point_cache('metrics', '{device}');
+DROP TABLE metrics;
+SELECT count(*) FROM _timescaledb_catalog.hypertable_last_point_cache;
+SELECT to_regclass('_timescaledb_internal._hyper_1_last_point');
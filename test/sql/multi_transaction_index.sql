@@ -147,3 +147,24 @@ SET enable_bitmapscan TO true;
 \set ON_ERROR_STOP 0
 CREATE INDEX ON partial_index_test (time) WITH (timescaledb.transaction_per_chunk, timescaledb.max_chunks='1');
 \set ON_ERROR_STOP 1
+
+-- The chunk indexes can be built by background workers
+\c :TEST_DBNAME :ROLE_DEFAULT_PERM_USER
+CREATE TABLE parallel_index_test(time int NOT NULL, device int);
+SELECT table_name FROM create_hypertable('parallel_index_test', 'time', chunk_time_interval => 10);
+INSERT INTO parallel_index_test SELECT t, t % 3 FROM generate_series(0, 59) t;
+CREATE INDEX parallel_index_test_device_idx ON parallel_index_test (device, time)
+WITH (timescaledb.transaction_per_chunk, timescaledb.parallel_chunks = 2);
+-- every chunk has a valid index, and the hypertable index is valid
+SELECT count(*) AS chunks_without_index
+FROM show_chunks('parallel_index_test') c
+WHERE NOT EXISTS (
+    SELECT FROM pg_index i JOIN pg_class ic ON ic.oid = i.indexrelid
+    WHERE i.indrelid = c AND ic.relname LIKE '%parallel_index_test_device_idx' AND i.indisvalid);
+SELECT count(*) FROM _timescaledb_catalog.chunk_index WHERE hypertable_index_name = 'parallel_index_test_device_idx';
+SELECT indisvalid FROM pg_index WHERE indexrelid = 'parallel_index_test_device_idx'::regclass;
+\set ON_ERROR_STOP 0
+CREATE INDEX ON parallel_index_test (time) WITH (timescaledb.parallel_chunks = 2);
+CREATE INDEX ON parallel_index_test (time) WITH (timescaledb.transaction_per_chunk, timescaledb.parallel_chunks = -1);
+\set ON_ERROR_STOP 1
+DROP TABLE parallel_index_test;
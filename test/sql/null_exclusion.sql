@@ -29,3 +29,24 @@ explain (analyze, costs off, summary off, timing off)
 select * from metrics
 where ts >= (select max(ts) from metrics where id = -1)
     and id = 1;
+
+-- the chunk exclusion uses the cached chunk slices, and sees the chunks
+-- created and dropped after the cache was filled
+select count(*) from metrics where ts > '2022-01-01';
+insert into metrics values ('2024-04-04 04:04:04', 4, 4.);
+select count(*) from metrics where ts > '2022-01-01';
+select count(drop_chunks('metrics', older_than => '2023-01-01'::timestamp));
+select count(*) from metrics where ts > '2022-01-01';
+set timescaledb.enable_chunk_slice_cache to off;
+select count(*) from metrics where ts > '2022-01-01';
+reset timescaledb.enable_chunk_slice_cache;
+select count(*) from metrics where ts >= '2023-03-03 03:03:03' and ts < '2024-01-01';
+select count(*) from metrics where ts = '2024-04-04 04:04:04';
+
+-- the planner statistics count the chunks found and set up for the query
+set timescaledb.enable_planner_stats to on;
+select _timescaledb_functions.planner_stats_reset();
+select count(*) from metrics where ts > '2022-01-01';
+select phase, calls, items from _timescaledb_functions.planner_stats()
+where phase in ('chunk_scan', 'chunk_rels');
+reset timescaledb.enable_planner_stats;
@@ -307,3 +307,59 @@ INSERT INTO part_time_func_null_ret VALUES (1530214157.134, 23.4, 'dev1'),
 CREATE FUNCTION _timescaledb_internal.update_dimension_partition(hypertable REGCLASS) RETURNS VOID AS :MODULE_PATHNAME, 'ts_dimension_partition_update' LANGUAGE C VOLATILE;
 SELECT _timescaledb_internal.update_dimension_partition('part_custom_dim');
 DROP FUNCTION _timescaledb_internal.update_dimension_partition;
+
+-- The chunks are found in the catalog with one scan over the constraints of
+-- all the matching slices, also when the caches are cold after reconnecting
+CREATE TABLE part_lookup(time int NOT NULL, device int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('part_lookup', 'time', 'device', 3, chunk_time_interval => 10);
+INSERT INTO part_lookup SELECT t, d, 1 FROM generate_series(0, 49) t, generate_series(1, 6) d;
+SELECT count(*) AS chunks FROM show_chunks('part_lookup') \gset
+\c :TEST_DBNAME :ROLE_SUPERUSER
+-- the point lookups of the insert find the existing chunks
+INSERT INTO part_lookup SELECT t, d, 2 FROM generate_series(0, 49) t, generate_series(1, 6) d;
+SELECT count(*) = :chunks AS no_new_chunks FROM show_chunks('part_lookup');
+\c :TEST_DBNAME :ROLE_SUPERUSER
+-- the restrictions on both dimensions
+SELECT count(*), sum(value) FROM part_lookup WHERE time >= 15 AND time < 35 AND device IN (2, 5);
+SELECT count(DISTINCT tableoid) AS chunks FROM part_lookup WHERE time >= 15 AND time < 35 AND device = 2;
+DROP TABLE part_lookup;
+
+-- The dimension slices cached by id are not used after the chunks and their
+-- slices are dropped and the chunks are created again with new slices
+CREATE TABLE part_slices(time int NOT NULL, device int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('part_slices', 'time', 'device', 2, chunk_time_interval => 10);
+INSERT INTO part_slices SELECT t, d, 1 FROM generate_series(0, 29) t, generate_series(1, 4) d;
+SELECT count(*), sum(value), count(DISTINCT tableoid) AS chunks FROM part_slices WHERE time < 20 AND device = 1;
+SELECT count(*) >= 2 AS dropped FROM drop_chunks('part_slices', older_than => 20);
+INSERT INTO part_slices SELECT t, d, 2 FROM generate_series(0, 19) t, generate_series(1, 4) d;
+SELECT count(*), sum(value), count(DISTINCT tableoid) AS chunks FROM part_slices WHERE time < 20 AND device = 1;
+SET timescaledb.enable_chunk_slice_cache TO off;
+SELECT count(*), sum(value), count(DISTINCT tableoid) AS chunks FROM part_slices WHERE time < 20 AND device = 1;
+RESET timescaledb.enable_chunk_slice_cache;
+DROP TABLE part_slices;
+
+-- Several space partitions can be mapped to the same chunks
+CREATE TABLE part_mapping(time int NOT NULL, device int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('part_mapping', 'time', 'device', 8, chunk_time_interval => 10);
+SELECT id AS part_mapping_id FROM _timescaledb_catalog.hypertable WHERE table_name = 'part_mapping' \gset
+SELECT set_partition_mapping('part_mapping', '{0,4}');
+SELECT dp.range_start FROM _timescaledb_catalog.dimension_partition dp
+JOIN _timescaledb_catalog.dimension d ON d.id = dp.dimension_id
+WHERE d.hypertable_id = :part_mapping_id ORDER BY 1;
+INSERT INTO part_mapping SELECT t, d, 1 FROM generate_series(0, 9) t, generate_series(1, 100) d;
+SELECT count(*) FROM show_chunks('part_mapping');
+SELECT ds.range_start, ds.range_end FROM _timescaledb_catalog.dimension_slice ds
+JOIN _timescaledb_catalog.dimension d ON d.id = ds.dimension_id
+WHERE d.hypertable_id = :part_mapping_id AND d.column_name = 'device' ORDER BY 1;
+-- NULL gives each partition its own chunks again
+SELECT set_partition_mapping('part_mapping');
+INSERT INTO part_mapping SELECT t, d, 1 FROM generate_series(10, 19) t, generate_series(1, 100) d;
+SELECT count(*) FROM show_chunks('part_mapping', newer_than => 9);
+SELECT count(*), sum(value) FROM part_mapping WHERE time < 10;
+\set ON_ERROR_STOP 0
+SELECT set_partition_mapping('part_mapping', '{1,4}');
+SELECT set_partition_mapping('part_mapping', '{0,4,2}');
+SELECT set_partition_mapping('part_mapping', '{0,8}');
+SELECT set_partition_mapping('part_mapping', '{}');
+\set ON_ERROR_STOP 1
+DROP TABLE part_mapping;
@@ -0,0 +1,69 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- The number of rows whose space partition hash, computed by the SQL function,
+-- is not within the slice of their chunk
+CREATE FUNCTION misplaced_rows(tbl regclass) RETURNS bigint LANGUAGE plpgsql AS $$
+DECLARE
+    n bigint;
+BEGIN
+    EXECUTE format($q$
+        SELECT count(*) FROM %s t
+        JOIN _timescaledb_catalog.chunk c ON format('%%I.%%I', c.schema_name, c.table_name)::regclass = t.tableoid
+        JOIN _timescaledb_catalog.chunk_constraint cc ON cc.chunk_id = c.id
+        JOIN _timescaledb_catalog.dimension_slice ds ON ds.id = cc.dimension_slice_id
+        JOIN _timescaledb_catalog.dimension d ON d.id = ds.dimension_id
+        WHERE d.column_name = 'device'
+        AND NOT (_timescaledb_internal.get_partition_hash(t.device) >= ds.range_start
+                 AND _timescaledb_internal.get_partition_hash(t.device) < ds.range_end)
+    $q$, tbl) INTO n;
+    RETURN n;
+END
+$$;
+
+-- The default partitioning function hashes the integer and text columns
+-- directly, and has to give the same partitions as the SQL function
+CREATE TABLE part_int2(time int NOT NULL, device int2);
+SELECT table_name FROM create_hypertable('part_int2', 'time', 'device', 4, chunk_time_interval => 1000);
+INSERT INTO part_int2 SELECT i + 500, i FROM generate_series(-500, 500) i;
+CREATE TABLE part_int4(time int NOT NULL, device int4);
+SELECT table_name FROM create_hypertable('part_int4', 'time', 'device', 4, chunk_time_interval => 1000);
+INSERT INTO part_int4 SELECT i + 500, i * 1000003 FROM generate_series(-500, 500) i;
+CREATE TABLE part_int8(time int NOT NULL, device int8);
+SELECT table_name FROM create_hypertable('part_int8', 'time', 'device', 4, chunk_time_interval => 1000);
+INSERT INTO part_int8 SELECT i + 500, i * 10000000007 FROM generate_series(-500, 500) i;
+CREATE TABLE part_text(time int NOT NULL, device text);
+SELECT table_name FROM create_hypertable('part_text', 'time', 'device', 4, chunk_time_interval => 1000);
+INSERT INTO part_text SELECT i + 500, 'device ' || i FROM generate_series(-500, 500) i;
+COPY part_int4 FROM STDIN;
+100	-39595
+101	-31676
+102	-23757
+103	-15838
+104	-7919
+105	0
+106	7919
+107	15838
+108	23757
+109	31676
+110	39595
+\.
+
+SELECT tbl, misplaced_rows(tbl), (SELECT count(*) FROM show_chunks(tbl)) AS chunks
+FROM unnest('{part_int2, part_int4, part_int8, part_text}'::regclass[]) tbl;
+
+-- The chunk exclusion by the space dimension uses the same hash
+SELECT count(*) FROM part_int2 WHERE device = (-7)::int2 OR device = 7::int2;
+SELECT count(*) FROM part_int4 WHERE device = -7 * 1000003 OR device = 7 * 1000003;
+SELECT count(*) FROM part_int8 WHERE device = -7 * 10000000007 OR device = 7 * 10000000007;
+SELECT count(*) FROM part_text WHERE device = 'device -7' OR device = 'device 7';
+SELECT count(*) FROM part_int4 WHERE device = -5 * 7919;
+
+DROP TABLE part_int2;
+DROP TABLE part_int4;
+DROP TABLE part_int8;
+DROP TABLE part_text;
+DROP FUNCTION misplaced_rows(regclass);
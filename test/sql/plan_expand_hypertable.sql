@@ -105,4 +105,35 @@ $function$;
 :PREFIX SELECT * FROM f_t1_2(10);
 :PREFIX SELECT * FROM f_t1_2(10) sc, f_t2(sc.a, 10);
 
+-- The chunks matching the restrictions are built with one catalog scan per
+-- catalog table, and the slices are shared by several chunks
+CREATE TABLE batched(time int NOT NULL, device int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('batched', 'time', 'device', 3, chunk_time_interval => 10);
+INSERT INTO batched SELECT t, d, t * 100 + d FROM generate_series(0, 199) t, generate_series(1, 12) d;
+SELECT count(*), sum(value),
+  count(DISTINCT tableoid) = (SELECT count(*) FROM show_chunks('batched', older_than => 150, newer_than => 50)) AS all_chunks
+FROM batched WHERE time >= 50 AND time < 150;
+SELECT count(*), sum(value), count(DISTINCT tableoid) AS chunks FROM batched WHERE device = 3 AND time < 30;
+DROP TABLE batched;
+
+-- The groups of time_bucket() are estimated from the range of the chunks
+-- that are left after chunk exclusion
+CREATE FUNCTION group_estimate(stmt text) RETURNS float LANGUAGE plpgsql AS $$
+DECLARE
+    plan json;
+BEGIN
+    EXECUTE 'EXPLAIN (FORMAT JSON) ' || stmt INTO plan;
+    RETURN plan->0->'Plan'->>'Plan Rows';
+END
+$$;
+CREATE TABLE bucket_groups(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('bucket_groups', 'time', chunk_time_interval => 100, create_default_indexes => false);
+INSERT INTO bucket_groups SELECT t, d, t FROM generate_series(0, 999) t, generate_series(1, 5) d;
+ANALYZE bucket_groups;
+SELECT group_estimate('SELECT time_bucket(10, time), count(*) FROM bucket_groups WHERE time >= 900 GROUP BY 1') AS groups;
+-- the gaps between the chunks are not counted
+SELECT group_estimate('SELECT time_bucket(10, time), count(*) FROM bucket_groups WHERE time < 100 OR time >= 900 GROUP BY 1') AS groups;
+DROP TABLE bucket_groups;
+DROP FUNCTION group_estimate(text);
+
 \qecho '--TEST END--'
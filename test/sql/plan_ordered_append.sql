@@ -40,3 +40,26 @@ SET timescaledb.ordered_append = 'off';
 \o
 
 :DIFF_CMD
+
+-- chunks of different space partitions whose time slices overlap without
+-- being equal, because the chunk time interval changed, have to be merged
+CREATE TABLE space_overlap(time timestamptz NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('space_overlap', 'time', 'device', 2, chunk_time_interval => interval '1 day') \gset
+INSERT INTO space_overlap SELECT t, 1, 1 FROM generate_series('2000-01-01'::timestamptz, '2000-01-03', '1 hour') t;
+SELECT set_chunk_time_interval('space_overlap', interval '3 days') IS NULL AS ignored \gset
+INSERT INTO space_overlap SELECT t, d, 2 FROM generate_series('2000-01-01'::timestamptz, '2000-01-08', '1 hour') t, generate_series(1, 4) d;
+ANALYZE space_overlap;
+
+\o :TEST_RESULTS_OPTIMIZED
+SET timescaledb.enable_ordered_append TO on;
+SELECT time, device, value FROM space_overlap ORDER BY time, device, value;
+SELECT time, device, value FROM space_overlap ORDER BY time DESC, device, value LIMIT 100;
+\o
+\o :TEST_RESULTS_UNOPTIMIZED
+SET timescaledb.enable_ordered_append TO off;
+SELECT time, device, value FROM space_overlap ORDER BY time, device, value;
+SELECT time, device, value FROM space_overlap ORDER BY time DESC, device, value LIMIT 100;
+\o
+RESET timescaledb.enable_ordered_append;
+
+:DIFF_CMD
@@ -288,3 +288,21 @@ BEGIN
 END;
 $$;
 RESET client_min_messages;
+
+-- The relation sizes are cached until an insert writes to the chunk or the
+-- TTL passes
+CREATE TABLE size_cache(time int NOT NULL, value text);
+SELECT table_name FROM create_hypertable('size_cache', 'time', chunk_time_interval => 1000);
+INSERT INTO size_cache VALUES (1, 'a');
+SELECT table_bytes AS size_before FROM hypertable_detailed_size('size_cache') \gset
+INSERT INTO size_cache SELECT t, repeat('x', 100) FROM generate_series(2, 999) t;
+SELECT table_bytes > :size_before AS grown FROM hypertable_detailed_size('size_cache');
+-- the sizes of a rewrite are only seen when the cached sizes expire
+SELECT table_bytes AS size_cached FROM hypertable_detailed_size('size_cache') \gset
+DELETE FROM size_cache;
+VACUUM FULL size_cache;
+SELECT table_bytes = :size_cached AS cached FROM hypertable_detailed_size('size_cache');
+SET timescaledb.relation_size_cache_ttl = 0;
+SELECT table_bytes < :size_cached AS shrunk FROM hypertable_detailed_size('size_cache');
+RESET timescaledb.relation_size_cache_ttl;
+DROP TABLE size_cache;
@@ -34,3 +34,12 @@ SELECT time_bucket(10,time),device_id,value FROM order_test ORDER BY 2,1;
 -- should use index scan
 :PREFIX SELECT time_bucket(10,time),device_id,value FROM order_test ORDER BY 2,1;
 
+-- test sort optimization with an order-reversing expression on a NOT NULL column
+SELECT -time,device_id,value FROM order_test ORDER BY 1;
+-- should use index scan
+:PREFIX SELECT -time,device_id,value FROM order_test ORDER BY 1;
+
+-- test sort optimization with a widening cast
+SELECT time::float8,device_id,value FROM order_test ORDER BY 1;
+-- should use index scan
+:PREFIX SELECT time::float8,device_id,value FROM order_test ORDER BY 1;
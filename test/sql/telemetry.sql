@@ -238,6 +238,25 @@ SELECT get_telemetry_report()->'functions_used';
 -- check the report again to see if resetting works
 SELECT get_telemetry_report()->'functions_used';
 
+-- the counts of a backend that are not added to the shared counts yet are
+-- added when the backend exits
+CREATE FUNCTION wait_for_backend_exit(backend_pid int) RETURNS void AS $$
+BEGIN
+  FOR i IN 1..300 LOOP
+    EXIT WHEN NOT EXISTS (SELECT FROM pg_stat_activity WHERE pid = backend_pid);
+    PERFORM pg_sleep(0.1);
+  END LOOP;
+END
+$$ LANGUAGE plpgsql;
+SELECT pg_backend_pid() AS old_pid \gset
+SELECT gcd(12, 18);
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT wait_for_backend_exit(:old_pid);
+SET timescaledb.telemetry_level=basic;
+SELECT (get_telemetry_report()->'functions_used'->>'pg_catalog.gcd(integer,integer)')::int AS gcd_calls;
+RESET timescaledb.telemetry_level;
+DROP FUNCTION wait_for_backend_exit(int);
+
 \c :TEST_DBNAME :ROLE_SUPERUSER
 TRUNCATE _timescaledb_catalog.metadata;
 
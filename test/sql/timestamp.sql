@@ -694,6 +694,20 @@ SELECT
 
 FROM generate_series('1999-12-01'::timestamptz,'2000-09-01'::timestamptz, '9 day'::interval) ts;
 
+-- the cached UTC offsets give the same buckets as converting every value,
+-- across the DST transitions and when the zone changes from row to row
+SELECT count(*) AS rows,
+  count(*) FILTER (WHERE time_bucket('1 hour', ts, tz) IS DISTINCT FROM timezone(tz, time_bucket('1 hour', timezone(tz, ts)))) AS wrong_hour,
+  count(*) FILTER (WHERE time_bucket('1 day', ts, tz) IS DISTINCT FROM timezone(tz, time_bucket('1 day', timezone(tz, ts)))) AS wrong_day,
+  count(*) FILTER (WHERE timescaledb_experimental.time_bucket_ng('1 day', ts, timezone => tz) IS DISTINCT FROM timezone(tz, time_bucket('1 day', timezone(tz, ts)))) AS wrong_ng
+FROM unnest(ARRAY['Europe/Berlin', 'America/New_York', 'Australia/Lord_Howe', 'EST', 'UTC']) tz,
+  generate_series('2020-01-01 00:00+00'::timestamptz + length(tz) * interval '0', '2022-01-01 00:00+00', '37 min') ts;
+SELECT count(*) AS rows,
+  count(*) FILTER (WHERE time_bucket('1 hour', ts, tz) IS DISTINCT FROM timezone(tz, time_bucket('1 hour', timezone(tz, ts)))) AS wrong_hour,
+  count(*) FILTER (WHERE time_bucket('1 day', ts, tz) IS DISTINCT FROM timezone(tz, time_bucket('1 day', timezone(tz, ts)))) AS wrong_day
+FROM generate_series('2020-01-01 00:00+00'::timestamptz, '2022-01-01 00:00+00', '1 hour') ts,
+  LATERAL (SELECT (ARRAY['Europe/Berlin', 'America/New_York', 'Australia/Lord_Howe', 'EST', 'UTC'])[1 + (extract(epoch FROM ts)::bigint / 3600) % 5] AS tz) z;
+
 RESET datestyle;
 
 ------------------------------------------------------------
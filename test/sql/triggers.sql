@@ -304,24 +304,52 @@ DROP TABLE location;
 
 -- test triggers with transition tables
 -- test creating hypertable from table with triggers with transition tables
-CREATE TABLE transition_test(time timestamptz NOT NULL);
-CREATE TRIGGER t1 AFTER INSERT ON transition_test REFERENCING NEW TABLE AS new_trans FOR EACH STATEMENT EXECUTE FUNCTION test_trigger();
+CREATE TABLE transition_test(time timestamptz NOT NULL, value int);
+CREATE TRIGGER t1 AFTER INSERT ON transition_test REFERENCING NEW TABLE AS new_trans FOR EACH ROW EXECUTE FUNCTION test_trigger();
 
 \set ON_ERROR_STOP 0
 SELECT create_hypertable('transition_test','time');
 \set ON_ERROR_STOP 1
 DROP TRIGGER t1 ON transition_test;
+CREATE TRIGGER t1 AFTER INSERT ON transition_test REFERENCING NEW TABLE AS new_trans FOR EACH STATEMENT EXECUTE FUNCTION test_trigger();
 SELECT create_hypertable('transition_test','time');
+DROP TRIGGER t1 ON transition_test;
 
 -- test creating trigger with transition tables on existing hypertable
-\set ON_ERROR_STOP 0
-CREATE TRIGGER t2 AFTER INSERT ON transition_test REFERENCING NEW TABLE AS new_trans FOR EACH STATEMENT EXECUTE FUNCTION test_trigger();
-CREATE TRIGGER t3 AFTER UPDATE ON transition_test REFERENCING NEW TABLE AS new_trans OLD TABLE AS old_trans FOR EACH STATEMENT EXECUTE FUNCTION test_trigger();
-CREATE TRIGGER t4 AFTER DELETE ON transition_test REFERENCING OLD TABLE AS old_trans FOR EACH STATEMENT EXECUTE FUNCTION test_trigger();
+CREATE OR REPLACE FUNCTION test_transition_trigger()
+    RETURNS TRIGGER LANGUAGE PLPGSQL AS
+$BODY$
+DECLARE
+    cnt_new INTEGER := 0;
+    cnt_old INTEGER := 0;
+BEGIN
+    IF TG_OP IN ('INSERT', 'UPDATE') THEN
+        SELECT count(*) INTO cnt_new FROM new_trans;
+    END IF;
+    IF TG_OP IN ('UPDATE', 'DELETE') THEN
+        SELECT count(*) INTO cnt_old FROM old_trans;
+    END IF;
+    RAISE WARNING 'FIRING trigger op: % new: % old: % trigger_name %',
+        tg_op, cnt_new, cnt_old, tg_name;
+    RETURN NULL;
+END
+$BODY$;
 
-CREATE TRIGGER t2 AFTER INSERT ON transition_test REFERENCING NEW TABLE AS new_trans FOR EACH ROW EXECUTE FUNCTION test_trigger();
-CREATE TRIGGER t3 AFTER UPDATE ON transition_test REFERENCING NEW TABLE AS new_trans OLD TABLE AS old_trans FOR EACH ROW EXECUTE FUNCTION test_trigger();
-CREATE TRIGGER t4 AFTER DELETE ON transition_test REFERENCING OLD TABLE AS old_trans FOR EACH ROW EXECUTE FUNCTION test_trigger();
-\set ON_ERROR_STOP 1
+CREATE TRIGGER t2 AFTER INSERT ON transition_test REFERENCING NEW TABLE AS new_trans FOR EACH STATEMENT EXECUTE FUNCTION test_transition_trigger();
+CREATE TRIGGER t3 AFTER UPDATE ON transition_test REFERENCING NEW TABLE AS new_trans OLD TABLE AS old_trans FOR EACH STATEMENT EXECUTE FUNCTION test_transition_trigger();
+CREATE TRIGGER t4 AFTER DELETE ON transition_test REFERENCING OLD TABLE AS old_trans FOR EACH STATEMENT EXECUTE FUNCTION test_transition_trigger();
 
+-- the transition tables have the rows of all chunks
+INSERT INTO transition_test SELECT t, 0 FROM generate_series('2000-01-01'::timestamptz, '2000-03-01', '1 day') t;
+COPY transition_test FROM STDIN;
+2001-01-01 00:00:00+00	0
+2001-06-01 00:00:00+00	0
+\.
+UPDATE transition_test SET value = 1 WHERE time < '2000-02-01';
+DELETE FROM transition_test WHERE time >= '2000-02-01';
 
+\set ON_ERROR_STOP 0
+CREATE TRIGGER t5 AFTER INSERT ON transition_test REFERENCING NEW TABLE AS new_trans FOR EACH ROW EXECUTE FUNCTION test_trigger();
+CREATE TRIGGER t6 AFTER UPDATE ON transition_test REFERENCING NEW TABLE AS new_trans OLD TABLE AS old_trans FOR EACH ROW EXECUTE FUNCTION test_trigger();
+CREATE TRIGGER t7 AFTER DELETE ON transition_test REFERENCING OLD TABLE AS old_trans FOR EACH ROW EXECUTE FUNCTION test_trigger();
+\set ON_ERROR_STOP 1
@@ -0,0 +1,7 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- The inserts keep the last point cache up to date, where there is one
+INSERT INTO last_point VALUES (50, 0, 100), (10, 1, -1);
+SELECT DISTINCT ON (device) * FROM last_point ORDER BY device, time DESC;
@@ -11,3 +11,4 @@
 \ir post.policies.sql
 \ir post.sequences.sql
 \ir post.functions.sql
+\ir post.last_point_cache.sql
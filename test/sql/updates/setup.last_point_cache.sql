@@ -0,0 +1,18 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- The last point cache only exists in the later versions, which means
+-- that the clean rerun has a cache while the updated instance has not.
+-- The post script checks that they still answer the same.
+SELECT count(*) > 0 AS has_last_point_cache
+  FROM pg_proc
+ WHERE proname = 'add_last_point_cache' \gset
+
+CREATE TABLE last_point(time int NOT NULL, device int NOT NULL, value float);
+SELECT create_hypertable('last_point', 'time', chunk_time_interval => 10);
+INSERT INTO last_point SELECT x, x % 3, x FROM generate_series(0, 47) x;
+
+\if :has_last_point_cache
+SELECT add_last_point_cache('last_point', '{device}');
+\endif
@@ -3,3 +3,4 @@
 -- LICENSE-APACHE for a copy of the license.
 
 \ir setup.v7.sql
+\ir setup.last_point_cache.sql
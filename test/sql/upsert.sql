@@ -308,3 +308,35 @@ $sql$ LANGUAGE PLPGSQL;
 SELECT counter,test_upsert2('2000-01-01',1.0) FROM generate_series(1,10) AS g(counter);
 
 SELECT * FROM prepared_test;
+
+-- Test ON CONFLICT DO NOTHING with the multi-insert into the chunks
+CREATE TABLE upsert_batch(time int NOT NULL, device int NOT NULL, value float, UNIQUE (time, device));
+SELECT table_name FROM create_hypertable('upsert_batch', 'time', chunk_time_interval => 10);
+INSERT INTO upsert_batch SELECT t, 1, -1 FROM generate_series(0, 19) t;
+SET timescaledb.enable_multi_insert_on_conflict TO on;
+-- the tuples with the keys of existing rows or of earlier tuples are skipped
+DO $$
+DECLARE
+  n int;
+BEGIN
+  INSERT INTO upsert_batch SELECT t, d, t FROM generate_series(10, 29) t, generate_series(1, 2) d, generate_series(1, 2)
+  ON CONFLICT DO NOTHING;
+  GET DIAGNOSTICS n = ROW_COUNT;
+  RAISE NOTICE 'inserted % rows', n;
+END
+$$;
+SELECT device, count(*), sum(value) FROM upsert_batch GROUP BY device ORDER BY device;
+-- all the tuples conflict now
+DO $$
+DECLARE
+  n int;
+BEGIN
+  INSERT INTO upsert_batch SELECT t, d, t FROM generate_series(10, 29) t, generate_series(1, 2) d, generate_series(1, 2)
+  ON CONFLICT (time, device) DO NOTHING;
+  GET DIAGNOSTICS n = ROW_COUNT;
+  RAISE NOTICE 'inserted % rows', n;
+END
+$$;
+SELECT count(*) FROM upsert_batch;
+RESET timescaledb.enable_multi_insert_on_conflict;
+DROP TABLE upsert_batch;
@@ -19,6 +19,14 @@ TS_FUNCTION_INFO_V1(ts_test_adts);
 #define VEC_SCOPE static inline
 #include <adts/vec.h>
 
+#define VEC_PREFIX inline_int32
+#define VEC_ELEMENT_TYPE int32
+#define VEC_INLINE_CAPACITY 4
+#define VEC_DECLARE 1
+#define VEC_DEFINE 1
+#define VEC_SCOPE static inline
+#include <adts/vec.h>
+
 /* We have to stub this for the unit tests. */
 #ifndef CheckCompressedData
 #define CheckCompressedData(X) Assert(X)
@@ -99,6 +107,51 @@ uint64_vec_test(void)
 	TestAssertPtrEq(vec.data, NULL);
 }
 
+static void
+inline_vec_test(void)
+{
+	inline_int32_vec vec;
+	int i;
+
+	inline_int32_vec_init(&vec, CurrentMemoryContext, 0);
+	TestAssertInt64Eq(vec.num_elements, 0);
+	TestAssertInt64Eq(vec.max_elements, 4);
+	TestAssertPtrEq(vec.data, vec.inline_data);
+
+	/* the elements are kept inline up to the inline capacity */
+	for (i = 0; i < 4; i++)
+		inline_int32_vec_append(&vec, i);
+	TestAssertInt64Eq(vec.num_elements, 4);
+	TestAssertInt64Eq(vec.max_elements, 4);
+	TestAssertPtrEq(vec.data, vec.inline_data);
+
+	/* growing beyond it moves the elements to the heap */
+	for (; i < 100; i++)
+		inline_int32_vec_append(&vec, i);
+	TestAssertInt64Eq(vec.num_elements, 100);
+	if (vec.data == vec.inline_data)
+		TestFailure("vec data should not be inline");
+	for (i = 0; i < 100; i++)
+		TestAssertInt64Eq(*inline_int32_vec_at(&vec, i), i);
+
+	/* freeing the data makes the vector use the inline storage again */
+	inline_int32_vec_free_data(&vec);
+	TestAssertInt64Eq(vec.num_elements, 0);
+	TestAssertInt64Eq(vec.max_elements, 4);
+	TestAssertPtrEq(vec.data, vec.inline_data);
+
+	inline_int32_vec_append(&vec, 42);
+	TestAssertInt64Eq(*inline_int32_vec_last(&vec), 42);
+	TestAssertPtrEq(vec.data, vec.inline_data);
+
+	/* reserving more than the inline capacity upfront allocates */
+	inline_int32_vec_init(&vec, CurrentMemoryContext, 10);
+	TestAssertInt64Eq(vec.max_elements, 10);
+	if (vec.data == vec.inline_data)
+		TestFailure("vec data should not be inline");
+	inline_int32_vec_free_data(&vec);
+}
+
 static void
 bit_array_test(void)
 {
@@ -139,11 +192,66 @@ bit_array_test(void)
 		TestAssertInt64Eq(bit_array_iter_next_rev(&iter, i), i);
 }
 
+static void
+bit_array_words_test(void)
+{
+	const uint64 words[3] = { UINT64CONST(0x9069060909009090),
+							  UINT64CONST(0xFEDCBA9876543210),
+							  UINT64CONST(0xFFFFFFFFFFFFFFFF) };
+	BitArray bits;
+	BitArrayIterator iter;
+	uint64 bitmap[3];
+
+	/* appending to an empty array copies the full words */
+	bit_array_init(&bits);
+	bit_array_append_words(&bits, words, 130);
+	TestAssertInt64Eq(bit_array_num_bits(&bits), 130);
+
+	bit_array_iterator_init(&iter, &bits);
+	TestAssertInt64Eq(bit_array_iter_next(&iter, 64), words[0]);
+	TestAssertInt64Eq(bit_array_iter_next(&iter, 64), words[1]);
+	TestAssertInt64Eq(bit_array_iter_next(&iter, 2), 3);
+
+	TestAssertInt64Eq(bit_array_get_bits(&bits, 0, 64), words[0]);
+	TestAssertInt64Eq(bit_array_get_bits(&bits, 4, 8), 0x09);
+	/* a read that spans two buckets */
+	TestAssertInt64Eq(bit_array_get_bits(&bits, 60, 12), 0x109);
+	TestAssertInt64Eq(bit_array_get_bits(&bits, 128, 2), 3);
+	TestAssertInt64Eq(bit_array_get_bits(&bits, 128, 0), 0);
+
+	/* the tail of the last word is zeroed */
+	bit_array_to_validity_bitmap(&bits, bitmap, 130);
+	TestAssertInt64Eq(bitmap[0], words[0]);
+	TestAssertInt64Eq(bitmap[1], words[1]);
+	TestAssertInt64Eq(bitmap[2], 3);
+
+	bit_array_to_validity_bitmap(&bits, bitmap, 68);
+	TestAssertInt64Eq(bitmap[0], words[0]);
+	TestAssertInt64Eq(bitmap[1], 0);
+
+	/* appending after a partially used bucket shifts the words */
+	bit_array_init(&bits);
+	bit_array_append(&bits, 3, 5);
+	bit_array_append_words(&bits, words, 100);
+	TestAssertInt64Eq(bit_array_num_bits(&bits), 103);
+
+	bit_array_iterator_init(&iter, &bits);
+	TestAssertInt64Eq(bit_array_iter_next(&iter, 3), 5);
+	TestAssertInt64Eq(bit_array_iter_next(&iter, 64), words[0]);
+	TestAssertInt64Eq(bit_array_iter_next(&iter, 36), words[1] & UINT64CONST(0xFFFFFFFFF));
+
+	TestAssertInt64Eq(bit_array_get_bits(&bits, 0, 3), 5);
+	TestAssertInt64Eq(bit_array_get_bits(&bits, 3, 64), words[0]);
+	TestAssertInt64Eq(bit_array_get_bits(&bits, 67, 36), words[1] & UINT64CONST(0xFFFFFFFFF));
+}
+
 Datum
 ts_test_adts(PG_FUNCTION_ARGS)
 {
 	i32_vec_test();
 	uint64_vec_test();
+	inline_vec_test();
 	bit_array_test();
+	bit_array_words_test();
 	PG_RETURN_VOID();
 }
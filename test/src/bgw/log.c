@@ -134,6 +134,10 @@ emit_log_hook_callback(ErrorData *edata)
 void
 ts_register_emit_log_hook()
 {
+	/* A pooled job worker registers the hook again for every job it runs */
+	if (emit_log_hook == emit_log_hook_callback)
+		return;
+
 	prev_emit_log_hook = emit_log_hook;
 	emit_log_hook = emit_log_hook_callback;
 }
@@ -28,6 +28,7 @@
 #include "bgw/scheduler.h"
 #include "bgw/job.h"
 #include "bgw/job_stat.h"
+#include "bgw/worker_pool.h"
 #include "timer_mock.h"
 #include "params.h"
 #include "test_utils.h"
@@ -39,6 +40,7 @@ TS_FUNCTION_INFO_V1(ts_bgw_db_scheduler_test_run);
 TS_FUNCTION_INFO_V1(ts_bgw_db_scheduler_test_wait_for_scheduler_finish);
 TS_FUNCTION_INFO_V1(ts_bgw_db_scheduler_test_main);
 TS_FUNCTION_INFO_V1(ts_bgw_job_execute_test);
+TS_FUNCTION_INFO_V1(ts_bgw_worker_pool_test_main);
 /* function for testing the correctness of the next_scheduled_slot calculation */
 TS_FUNCTION_INFO_V1(ts_test_next_scheduled_execution_slot);
 
@@ -183,6 +185,7 @@ ts_bgw_db_scheduler_test_main(PG_FUNCTION_ARGS)
 	ts_timer_set(&ts_mock_timer);
 
 	ts_bgw_job_set_job_entrypoint_function_name("ts_bgw_job_execute_test");
+	ts_bgw_worker_pool_set_main_function_name("ts_bgw_worker_pool_test_main");
 
 	pgstat_report_appname("DB Scheduler Test");
 
@@ -428,3 +431,13 @@ ts_bgw_job_execute_test(PG_FUNCTION_ARGS)
 
 	return ts_bgw_job_entrypoint(fcinfo);
 }
+
+/* Like ts_bgw_job_execute_test, but for the workers of the job worker pool */
+Datum
+ts_bgw_worker_pool_test_main(PG_FUNCTION_ARGS)
+{
+	ts_timer_set(&ts_mock_timer);
+	ts_bgw_job_set_scheduler_test_hook(test_job_dispatcher);
+
+	return ts_bgw_worker_pool_main(fcinfo);
+}
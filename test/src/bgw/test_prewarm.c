@@ -0,0 +1,95 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/memutils.h>
+
+#include "compat/compat.h"
+#include "export.h"
+#include "bgw/prewarm.h"
+
+TS_FUNCTION_INFO_V1(ts_test_prewarm_recent_chunks);
+
+typedef struct PrewarmResult
+{
+	PrewarmChunk *chunk;
+	int64 blocks;
+} PrewarmResult;
+
+/*
+ * Prewarm the recent chunks like the prewarm worker does, but in the current
+ * transaction, and return the chunks in the order they were read together with
+ * the number of blocks read for each of them.
+ */
+Datum
+ts_test_prewarm_recent_chunks(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	List *results;
+	PrewarmResult *result;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc tupdesc;
+		int64 budget = PG_GETARG_INT64(1);
+		int64 blocks = 0;
+		ListCell *lc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		{
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("function returning record called in context "
+							"that cannot accept type record")));
+		}
+
+		results = NIL;
+		foreach (lc,
+				 ts_bgw_prewarm_get_recent_chunks(PG_GETARG_INT32(0),
+												  funcctx->multi_call_memory_ctx))
+		{
+			if (blocks >= budget)
+				break;
+
+			result = palloc(sizeof(PrewarmResult));
+			result->chunk = lfirst(lc);
+			result->blocks = ts_bgw_prewarm_chunk(result->chunk, budget - blocks);
+			blocks += result->blocks;
+			results = lappend(results, result);
+		}
+
+		funcctx->user_fctx = results;
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	results = funcctx->user_fctx;
+
+	if (funcctx->call_cntr < (uint64) list_length(results))
+	{
+		Datum values[3];
+		bool nulls[3] = { false };
+		HeapTuple tuple;
+
+		result = list_nth(results, funcctx->call_cntr);
+		values[0] = ObjectIdGetDatum(result->chunk->relid);
+		values[1] = ObjectIdGetDatum(result->chunk->compressed_relid);
+		nulls[1] = !OidIsValid(result->chunk->compressed_relid);
+		values[2] = Int64GetDatum(result->blocks);
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
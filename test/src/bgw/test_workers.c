@@ -0,0 +1,48 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <fmgr.h>
+
+#include "compat/compat.h"
+#include "export.h"
+#include "bgw/launcher_interface.h"
+
+TS_FUNCTION_INFO_V1(ts_test_bgw_worker_reserve);
+TS_FUNCTION_INFO_V1(ts_test_bgw_worker_release);
+TS_FUNCTION_INFO_V1(ts_test_bgw_num_unreserved);
+
+/*
+ * Reserve up to the given number of background workers, e.g., to leave no
+ * workers for a job, and return the number of workers that were reserved.
+ */
+Datum
+ts_test_bgw_worker_reserve(PG_FUNCTION_ARGS)
+{
+	int32 num_workers = PG_GETARG_INT32(0);
+	int32 reserved = 0;
+
+	while (reserved < num_workers && ts_bgw_worker_reserve())
+		reserved++;
+
+	PG_RETURN_INT32(reserved);
+}
+
+Datum
+ts_test_bgw_worker_release(PG_FUNCTION_ARGS)
+{
+	int32 num_workers = PG_GETARG_INT32(0);
+
+	for (int32 i = 0; i < num_workers; i++)
+		ts_bgw_worker_release();
+
+	PG_RETURN_VOID();
+}
+
+Datum
+ts_test_bgw_num_unreserved(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_INT32(ts_bgw_num_unreserved());
+}
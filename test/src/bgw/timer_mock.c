@@ -20,6 +20,7 @@
 #include "ts_catalog/catalog.h"
 #include "params.h"
 #include "bgw/launcher_interface.h"
+#include "bgw/worker_pool.h"
 
 static BackgroundWorkerHandle *bgw_handle = NULL;
 
@@ -53,7 +54,8 @@ mock_wait(TimestampTz until)
 		case WAIT_ON_JOB:
 			if (bgw_handle != NULL)
 			{
-				WaitForBackgroundWorkerShutdown(bgw_handle);
+				/* A pooled worker does not stop when its job has finished */
+				ts_bgw_worker_pool_wait_for_worker(bgw_handle);
 				bgw_handle = NULL;
 			}
 			TS_FALLTHROUGH;
@@ -6,11 +6,22 @@
 
 #include <postgres.h>
 #include <access/xact.h>
+#include <catalog/pg_class.h>
+#include <catalog/pg_type.h>
 #include <miscadmin.h>
+#include <port/atomics.h>
+#include <postmaster/bgworker.h>
+#include <storage/dsm.h>
+#include <storage/ipc.h>
+#include <utils/array.h>
 #include <utils/builtins.h>
+#include <utils/memutils.h>
+#include <utils/snapmgr.h>
 
 #include "compression_api.h"
+#include "chunk.h"
 #include "errors.h"
+#include "extension.h"
 #include "hypertable.h"
 #include "hypertable_cache.h"
 #include "policy_utils.h"
@@ -22,7 +33,10 @@
 #include "bgw_policy/continuous_aggregate_api.h"
 #include "bgw_policy/policies_v2.h"
 #include "bgw/job_stat.h"
+#include "bgw/launcher_interface.h"
 #include "bgw/timer.h"
+#include "bgw/worker.h"
+#include "compression/api.h"
 
 /* Default max runtime is unlimited for compress chunks */
 #define DEFAULT_MAX_RUNTIME                                                                        \
@@ -123,6 +137,15 @@ policy_recompression_get_recompress_after_interval(const Jsonb *config)
 	return interval;
 }
 
+int64
+policy_recompression_get_maxbytes_per_job(const Jsonb *config)
+{
+	bool found;
+	int64 maxbytes =
+		ts_jsonb_get_int64_field(config, POL_RECOMPRESSION_CONF_KEY_MAXBYTES_TO_RECOMPRESS, &found);
+	return (found && maxbytes > 0) ? maxbytes : 0;
+}
+
 Datum
 policy_recompression_proc(PG_FUNCTION_ARGS)
 {
@@ -137,6 +160,283 @@ policy_recompression_proc(PG_FUNCTION_ARGS)
 	PG_RETURN_VOID();
 }
 
+#define COMPRESSION_WORKER_NAME "TimescaleDB Compression Worker"
+#define COMPRESSION_WORKER_MAIN "ts_bgw_compression_worker_main"
+
+/*
+ * The chunks that a compression policy compresses in parallel, in a dynamic
+ * shared memory segment. The workers take the next chunk from the queue until
+ * all the chunks are taken.
+ */
+typedef struct CompressionWorkerQueue
+{
+	pg_atomic_uint32 next_chunk;
+	int32 job_id;
+	bool verbose_log;
+	bool recompress;
+	int num_chunks;
+	Oid chunks[FLEXIBLE_ARRAY_MEMBER];
+} CompressionWorkerQueue;
+
+typedef struct CompressionWorkers
+{
+	BackgroundWorkerHandle **handles;
+	int num_workers;
+} CompressionWorkers;
+
+static BackgroundWorkerHandle *
+compression_worker_start(int32 job_id, dsm_segment *segment)
+{
+	BackgroundWorker worker = {
+		.bgw_flags = BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION,
+		.bgw_start_time = BgWorkerStart_RecoveryFinished,
+		.bgw_restart_time = BGW_NEVER_RESTART,
+		.bgw_notify_pid = MyProcPid,
+		.bgw_main_arg = ObjectIdGetDatum(MyDatabaseId),
+	};
+	BgwParams bgw_params = {
+		.job_id = job_id,
+		.user_oid = GetUserId(),
+		.segment_handle = dsm_segment_handle(segment),
+	};
+	BackgroundWorkerHandle *handle;
+
+	strlcpy(bgw_params.bgw_main, COMPRESSION_WORKER_MAIN, sizeof(bgw_params.bgw_main));
+	strlcpy(worker.bgw_name, COMPRESSION_WORKER_NAME, BGW_MAXLEN);
+	strlcpy(worker.bgw_library_name, ts_extension_get_so_name(), BGW_MAXLEN);
+	strlcpy(worker.bgw_function_name, COMPRESSION_WORKER_MAIN, BGW_MAXLEN);
+	memcpy(worker.bgw_extra, &bgw_params, sizeof(bgw_params));
+
+	if (!RegisterDynamicBackgroundWorker(&worker, &handle))
+		return NULL;
+
+	return handle;
+}
+
+/* Terminate the workers if the policy fails or is terminated while they run */
+static void
+compression_workers_terminate(int code, Datum arg)
+{
+	CompressionWorkers *workers = (CompressionWorkers *) DatumGetPointer(arg);
+
+	for (int i = 0; i < workers->num_workers; i++)
+	{
+		TerminateBackgroundWorker(workers->handles[i]);
+		ts_bgw_worker_release();
+	}
+
+	workers->num_workers = 0;
+}
+
+/*
+ * Compress the chunks of a compression policy with up to the given number of
+ * background workers, which are counted against
+ * timescaledb.max_background_workers like the jobs. The chunks that are
+ * compressed but unordered or partial are recompressed if recompress is set.
+ *
+ * Returns false, without compressing any chunk, if no worker could be
+ * started, so that the caller can compress the chunks itself.
+ */
+Datum
+policy_compression_parallel(PG_FUNCTION_ARGS)
+{
+	int32 job_id = PG_GETARG_INT32(0);
+	ArrayType *chunks = PG_ARGISNULL(1) ? NULL : PG_GETARG_ARRAYTYPE_P(1);
+	int32 max_workers = PG_ARGISNULL(2) ? 0 : PG_GETARG_INT32(2);
+	bool verbose_log = PG_ARGISNULL(3) ? false : PG_GETARG_BOOL(3);
+	bool recompress = PG_ARGISNULL(4) ? true : PG_GETARG_BOOL(4);
+	CompressionWorkerQueue *queue;
+	CompressionWorkers workers;
+	dsm_segment *segment;
+	Datum *chunk_datums;
+	bool *chunk_nulls;
+	int num_chunks;
+	Chunk *chunk;
+	Size size;
+	bool started;
+
+	ts_feature_flag_check(FEATURE_POLICY);
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (chunks == NULL || max_workers < 1)
+		PG_RETURN_BOOL(false);
+
+	deconstruct_array(chunks,
+					  REGCLASSOID,
+					  sizeof(Oid),
+					  true,
+					  TYPALIGN_INT,
+					  &chunk_datums,
+					  &chunk_nulls,
+					  &num_chunks);
+
+	if (num_chunks == 0)
+		PG_RETURN_BOOL(true);
+
+	/* The chunks of distributed hypertables are compressed by the data nodes */
+	chunk = ts_chunk_get_by_relid(DatumGetObjectId(chunk_datums[0]), false);
+	if (chunk == NULL || chunk->relkind == RELKIND_FOREIGN_TABLE)
+		PG_RETURN_BOOL(false);
+
+	max_workers = Min(max_workers, num_chunks);
+
+	size = add_size(offsetof(CompressionWorkerQueue, chunks), mul_size(num_chunks, sizeof(Oid)));
+	segment = dsm_create(size, 0);
+	queue = dsm_segment_address(segment);
+	pg_atomic_init_u32(&queue->next_chunk, 0);
+	queue->job_id = job_id;
+	queue->verbose_log = verbose_log;
+	queue->recompress = recompress;
+	queue->num_chunks = num_chunks;
+
+	for (int i = 0; i < num_chunks; i++)
+		queue->chunks[i] = chunk_nulls[i] ? InvalidOid : DatumGetObjectId(chunk_datums[i]);
+
+	workers.num_workers = 0;
+	workers.handles = palloc(sizeof(BackgroundWorkerHandle *) * max_workers);
+
+	PG_ENSURE_ERROR_CLEANUP(compression_workers_terminate, PointerGetDatum(&workers));
+	{
+		while (workers.num_workers < max_workers && ts_bgw_worker_reserve())
+		{
+			BackgroundWorkerHandle *handle = compression_worker_start(job_id, segment);
+
+			if (handle == NULL)
+			{
+				ts_bgw_worker_release();
+				break;
+			}
+
+			workers.handles[workers.num_workers++] = handle;
+		}
+
+		if (workers.num_workers < max_workers)
+			elog(LOG,
+				 "job %d started %d of %d compression workers",
+				 job_id,
+				 workers.num_workers,
+				 max_workers);
+
+		for (int i = 0; i < workers.num_workers; i++)
+		{
+			if (WaitForBackgroundWorkerShutdown(workers.handles[i]) == BGWH_POSTMASTER_DIED)
+				ereport(FATAL,
+						(errcode(ERRCODE_ADMIN_SHUTDOWN),
+						 errmsg("postmaster exited while compression workers were running")));
+		}
+	}
+	PG_END_ENSURE_ERROR_CLEANUP(compression_workers_terminate, PointerGetDatum(&workers));
+
+	started = workers.num_workers > 0;
+
+	for (int i = 0; i < workers.num_workers; i++)
+		ts_bgw_worker_release();
+
+	dsm_detach(segment);
+
+	PG_RETURN_BOOL(started);
+}
+
+/*
+ * Compress or recompress one chunk of the queue in its own transaction. A
+ * chunk that fails to compress is reported and skipped, like the compression
+ * policy does.
+ */
+static void
+compression_worker_process_chunk(const CompressionWorkerQueue *queue, Oid chunk_relid)
+{
+	MemoryContext oldcontext = CurrentMemoryContext;
+	Chunk *chunk;
+	char *chunk_name;
+
+	StartTransactionCommand();
+	PushActiveSnapshot(GetTransactionSnapshot());
+
+	/* The chunk might have been dropped in the meantime */
+	chunk = ts_chunk_get_by_relid(chunk_relid, false);
+	if (chunk == NULL)
+	{
+		PopActiveSnapshot();
+		CommitTransactionCommand();
+		return;
+	}
+
+	chunk_name = MemoryContextStrdup(oldcontext,
+									 quote_qualified_identifier(NameStr(chunk->fd.schema_name),
+																NameStr(chunk->fd.table_name)));
+
+	PG_TRY();
+	{
+		if (!ts_chunk_is_compressed(chunk))
+			tsl_compress_chunk_wrapper(chunk, true);
+		else if (queue->recompress &&
+				 (ts_chunk_is_unordered(chunk) || ts_chunk_is_partial(chunk)))
+			tsl_recompress_chunk_wrapper(chunk);
+
+		PopActiveSnapshot();
+		CommitTransactionCommand();
+	}
+	PG_CATCH();
+	{
+		ErrorData *edata;
+
+		MemoryContextSwitchTo(oldcontext);
+		edata = CopyErrorData();
+		FlushErrorState();
+		AbortCurrentTransaction();
+
+		ereport(WARNING,
+				(errcode(edata->sqlerrcode),
+				 errmsg("compressing chunk \"%s\" failed when compression policy is executed",
+						chunk_name),
+				 errdetail("Message: (%s), Detail: (%s).",
+						   edata->message,
+						   edata->detail ? edata->detail : "")));
+
+		FreeErrorData(edata);
+		pfree(chunk_name);
+		return;
+	}
+	PG_END_TRY();
+
+	MemoryContextSwitchTo(oldcontext);
+
+	if (queue->verbose_log)
+		elog(LOG, "job %d completed processing chunk %s", queue->job_id, chunk_name);
+
+	pfree(chunk_name);
+}
+
+/* Main loop of the workers started by policy_compression_parallel */
+void
+policy_compression_worker_run(dsm_handle segment_handle)
+{
+	dsm_segment *segment = dsm_attach(segment_handle);
+	CompressionWorkerQueue *queue;
+
+	if (segment == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map the shared memory of the compression workers")));
+
+	queue = dsm_segment_address(segment);
+
+	for (;;)
+	{
+		uint32 next_chunk = pg_atomic_fetch_add_u32(&queue->next_chunk, 1);
+
+		if (next_chunk >= (uint32) queue->num_chunks)
+			break;
+
+		if (OidIsValid(queue->chunks[next_chunk]))
+			compression_worker_process_chunk(queue, queue->chunks[next_chunk]);
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	dsm_detach(segment);
+}
+
 static void
 validate_compress_after_type(Oid partitioning_type, Oid compress_after_type)
 {
@@ -8,6 +8,7 @@
 #define TIMESCALEDB_TSL_BGW_POLICY_COMPRESSION_API_H
 
 #include <postgres.h>
+#include <storage/dsm.h>
 #include <utils/jsonb.h>
 #include <utils/timestamp.h>
 
@@ -17,6 +18,8 @@ extern Datum policy_compression_remove(PG_FUNCTION_ARGS);
 
 extern Datum policy_recompression_proc(PG_FUNCTION_ARGS);
 extern Datum policy_compression_check(PG_FUNCTION_ARGS);
+extern Datum policy_compression_parallel(PG_FUNCTION_ARGS);
+extern void policy_compression_worker_run(dsm_handle segment_handle);
 
 int32 policy_compression_get_hypertable_id(const Jsonb *config);
 int64 policy_compression_get_compress_after_int(const Jsonb *config);
@@ -24,6 +27,7 @@ Interval *policy_compression_get_compress_after_interval(const Jsonb *config);
 int32 policy_compression_get_maxchunks_per_job(const Jsonb *config);
 int64 policy_recompression_get_recompress_after_int(const Jsonb *config);
 Interval *policy_recompression_get_recompress_after_interval(const Jsonb *config);
+int64 policy_recompression_get_maxbytes_per_job(const Jsonb *config);
 
 Datum policy_compression_add_internal(Oid user_rel_oid, Datum compress_after_datum,
 									  Oid compress_after_type, Interval *default_schedule_interval,
@@ -7,7 +7,9 @@
 #include <postgres.h>
 #include <access/xact.h>
 #include <catalog/namespace.h>
+#include <catalog/pg_class.h>
 #include <catalog/pg_type.h>
+#include <commands/vacuum.h>
 #include <funcapi.h>
 #include <hypertable_cache.h>
 #include <nodes/makefuncs.h>
@@ -30,6 +32,7 @@
 #include "bgw_policy/chunk_stats.h"
 #include "bgw_policy/compression_api.h"
 #include "bgw_policy/continuous_aggregate_api.h"
+#include "bgw_policy/maintenance_api.h"
 #include "bgw_policy/policy_utils.h"
 #include "bgw_policy/reorder_api.h"
 #include "bgw_policy/retention_api.h"
@@ -51,6 +54,7 @@
 #include "dimension.h"
 #include "dimension_slice.h"
 #include "dimension_vector.h"
+#include "hypercube.h"
 #include "errors.h"
 #include "job.h"
 #include "reorder.h"
@@ -476,10 +480,107 @@ policy_recompression_read_and_validate_config(Jsonb *config, PolicyCompressionDa
 	}
 }
 
+/* Recompress a chunk segmentwise if its uncompressed data is less than this
+ * fraction of the chunk */
+#define RECOMPRESS_SEGMENTWISE_FRACTION 0.1
+
+typedef struct RecompressCandidate
+{
+	int32 chunk_id;
+	int64 uncompressed_bytes;
+	int64 compressed_bytes;
+} RecompressCandidate;
+
+static int
+recompress_candidate_cmp(const ListCell *a, const ListCell *b)
+{
+	const RecompressCandidate *c1 = lfirst(a);
+	const RecompressCandidate *c2 = lfirst(b);
+
+	if (c1->uncompressed_bytes != c2->uncompressed_bytes)
+		return (c1->uncompressed_bytes > c2->uncompressed_bytes) ? -1 : 1;
+
+	return (c1->chunk_id > c2->chunk_id) - (c1->chunk_id < c2->chunk_id);
+}
+
+/*
+ * Get the chunks to recompress ordered by the amount of uncompressed data in
+ * them, so that the chunks where recompression helps queries the most are
+ * recompressed first.
+ */
+static List *
+get_recompress_candidates(List *chunkid_lst)
+{
+	List *candidates = NIL;
+	ListCell *lc;
+
+	foreach (lc, chunkid_lst)
+	{
+		Chunk *chunk = ts_chunk_get_by_id(lfirst_int(lc), false);
+		RecompressCandidate *candidate;
+		Oid compressed_relid;
+
+		if (!chunk || !ts_chunk_is_compressed(chunk) ||
+			!(ts_chunk_is_unordered(chunk) || ts_chunk_is_partial(chunk)))
+			continue;
+
+		compressed_relid = ts_chunk_get_relid(chunk->fd.compressed_chunk_id, true);
+
+		candidate = palloc(sizeof(RecompressCandidate));
+		candidate->chunk_id = chunk->fd.id;
+		candidate->uncompressed_bytes = DatumGetInt64(
+			DirectFunctionCall1(pg_total_relation_size, ObjectIdGetDatum(chunk->table_id)));
+		candidate->compressed_bytes =
+			OidIsValid(compressed_relid) ?
+				DatumGetInt64(DirectFunctionCall1(pg_total_relation_size,
+												  ObjectIdGetDatum(compressed_relid))) :
+				0;
+		candidates = lappend(candidates, candidate);
+	}
+
+	list_sort(candidates, recompress_candidate_cmp);
+
+	return candidates;
+}
+
+/*
+ * Recompress a chunk, either segmentwise if only a small part of it is
+ * uncompressed, or by decompressing and compressing it again. Returns the
+ * number of bytes that were processed.
+ */
+static int64
+recompress_candidate(const RecompressCandidate *candidate)
+{
+	Chunk *chunk = ts_chunk_get_by_id(candidate->chunk_id, false);
+	int64 total_bytes = candidate->uncompressed_bytes + candidate->compressed_bytes;
+
+	if (!chunk || !ts_chunk_is_compressed(chunk) ||
+		!(ts_chunk_is_unordered(chunk) || ts_chunk_is_partial(chunk)))
+		return 0;
+
+	if (candidate->uncompressed_bytes < total_bytes * RECOMPRESS_SEGMENTWISE_FRACTION)
+	{
+		DirectFunctionCall2(tsl_recompress_chunk_segmentwise,
+							ObjectIdGetDatum(chunk->table_id),
+							BoolGetDatum(true));
+		total_bytes = candidate->uncompressed_bytes;
+	}
+	else
+		tsl_recompress_chunk_wrapper(chunk);
+
+	elog(LOG,
+		 "completed recompressing chunk \"%s.%s\"",
+		 NameStr(chunk->fd.schema_name),
+		 NameStr(chunk->fd.table_name));
+
+	return total_bytes;
+}
+
 bool
 policy_recompression_execute(int32 job_id, Jsonb *config)
 {
 	List *chunkid_lst;
+	List *candidates = NIL;
 	ListCell *lc;
 	const Dimension *dim;
 	PolicyCompressionData policy_data;
@@ -507,6 +608,8 @@ policy_recompression_execute(int32 job_id, Jsonb *config)
 	}
 	saved_cxt = MemoryContextSwitchTo(multitxn_cxt);
 	chunkid_lst = get_chunk_to_recompress(dim, config);
+	if (!distributed)
+		candidates = get_recompress_candidates(chunkid_lst);
 	MemoryContextSwitchTo(saved_cxt);
 
 	if (!chunkid_lst)
@@ -523,27 +626,268 @@ policy_recompression_execute(int32 job_id, Jsonb *config)
 	ts_cache_release(policy_data.hcache);
 	if (ActiveSnapshotSet())
 		PopActiveSnapshot();
-	/* process each chunk in a new transaction */
-	foreach (lc, chunkid_lst)
+	/*
+	 * Process each chunk in a new transaction, the chunks with the most
+	 * uncompressed data first, until the bytes to process are exhausted. The
+	 * chunk sizes of a distributed hypertable are on the data nodes, so
+	 * those chunks are processed in order.
+	 */
+	if (distributed)
+	{
+		foreach (lc, chunkid_lst)
+		{
+			CommitTransactionCommand();
+			StartTransactionCommand();
+			int32 chunkid = lfirst_int(lc);
+			Chunk *chunk = ts_chunk_get_by_id(chunkid, true);
+			if (!chunk || !ts_chunk_is_unordered(chunk))
+				continue;
+			policy_invoke_recompress_chunk(chunk);
+
+			elog(LOG,
+				 "completed recompressing chunk \"%s.%s\"",
+				 NameStr(chunk->fd.schema_name),
+				 NameStr(chunk->fd.table_name));
+		}
+	}
+	else
+	{
+		int64 maxbytes = policy_recompression_get_maxbytes_per_job(config);
+		int64 processed_bytes = 0;
+
+		foreach (lc, candidates)
+		{
+			const RecompressCandidate *candidate = lfirst(lc);
+
+			if (maxbytes > 0 && processed_bytes > 0 &&
+				processed_bytes + candidate->uncompressed_bytes > maxbytes)
+				break;
+
+			CommitTransactionCommand();
+			StartTransactionCommand();
+			processed_bytes += recompress_candidate(candidate);
+		}
+	}
+
+	elog(DEBUG1, "job %d completed recompressing chunk", job_id);
+	return true;
+}
+
+void
+policy_maintenance_read_and_validate_config(Jsonb *config, PolicyMaintenanceData *policy)
+{
+	int32 htid = policy_maintenance_get_hypertable_id(config);
+	float8 analyze_scale_factor = policy_maintenance_get_analyze_scale_factor(config);
+	int32 max_vacuums_per_run = policy_maintenance_get_max_vacuums_per_run(config);
+	Hypertable *ht = ts_hypertable_get_by_id(htid);
+
+	if (!ht)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("configuration hypertable id %d not found", htid)));
+
+	if (!(analyze_scale_factor >= 0))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid value for analyze_scale_factor")));
+
+	if (max_vacuums_per_run < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid value for max_vacuums_per_run")));
+
+	if (policy)
 	{
+		policy->hypertable = ht;
+		policy->analyze_scale_factor = analyze_scale_factor;
+		policy->max_vacuums_per_run = max_vacuums_per_run;
+	}
+}
+
+/*
+ * A chunk that the maintenance policy analyzes or vacuums. The chunks that are
+ * compressed are vacuumed through their compressed chunk.
+ */
+typedef struct MaintenanceTask
+{
+	int32 chunk_id;
+	bool vacuum;
+} MaintenanceTask;
+
+/*
+ * Check if enough rows of the chunk changed since it was last analyzed. The
+ * inserts, updates and deletes on the chunk are counted by the cumulative
+ * statistics, so the insert path does not need to track them.
+ */
+static bool
+chunk_needs_analyze(Oid relid, float8 scale_factor)
+{
+	int64 changes =
+		DatumGetInt64(DirectFunctionCall1(pg_stat_get_mod_since_analyze, ObjectIdGetDatum(relid)));
+	HeapTuple tuple;
+	float4 reltuples;
+
+	if (changes <= 0)
+		return false;
+
+	tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(relid));
+	if (!HeapTupleIsValid(tuple))
+		return false;
+
+	reltuples = ((Form_pg_class) GETSTRUCT(tuple))->reltuples;
+	ReleaseSysCache(tuple);
+
+	/* Relations that were never analyzed have no or negative row estimates */
+	return reltuples <= 0 || changes > scale_factor * reltuples;
+}
+
+static void
+maintenance_vacuum_chunk(Oid relid, bool vacuum)
+{
+	VacuumRelation vr = {
+		.type = T_VacuumRelation,
+		.relation = NULL,
+		.oid = relid,
+		.va_cols = NIL,
+	};
+	VacuumStmt vs = {
+		.type = T_VacuumStmt,
+		.rels = list_make1(&vr),
+		.is_vacuumcmd = vacuum,
+		.options = vacuum ? list_make2(makeDefElem("freeze", NULL, -1),
+									   makeDefElem("analyze", NULL, -1)) :
+							NIL,
+	};
+
+	ExecVacuum(NULL, &vs, true);
+}
+
+/*
+ * Analyze the active chunks of the hypertable, the ones in the latest slice of
+ * the primary dimension, when their statistics are stale, and freeze at most
+ * max_vacuums_per_run of the closed chunks, the oldest first. A closed chunk
+ * is frozen once, and once more after it is compressed. The chunk stats of
+ * the job record the chunks that were frozen.
+ */
+bool
+policy_maintenance_execute(int32 job_id, Jsonb *config)
+{
+	PolicyMaintenanceData policy;
+	const Dimension *dim;
+	DimensionSlice *latest;
+	List *chunk_ids;
+	List *analyze_tasks = NIL;
+	List *vacuum_tasks = NIL;
+	List *tasks;
+	ListCell *lc;
+	bool used_portalcxt = false;
+	MemoryContext saved_cxt, multitxn_cxt;
+
+	policy_maintenance_read_and_validate_config(config, &policy);
+
+	/* the tasks have to survive the transactions of the vacuums */
+	if (PortalContext)
+	{
+		multitxn_cxt = PortalContext;
+		used_portalcxt = true;
+	}
+	else
+		multitxn_cxt =
+			AllocSetContextCreate(TopMemoryContext, "MaintenanceJobCxt", ALLOCSET_DEFAULT_SIZES);
+
+	dim = hyperspace_get_open_dimension(policy.hypertable->space, 0);
+	latest = ts_dimension_slice_nth_latest_slice(dim->fd.id, 1);
+	chunk_ids = ts_chunk_get_chunk_ids_by_hypertable_id(policy.hypertable->fd.id);
+	list_sort(chunk_ids, list_int_cmp);
+
+	foreach (lc, chunk_ids)
+	{
+		Chunk *chunk = ts_chunk_get_by_id(lfirst_int(lc), false);
+		const DimensionSlice *slice;
+		MaintenanceTask *task;
+		int32 vacuum_chunk_id;
+
+		if (chunk == NULL || chunk->fd.dropped || IS_OSM_CHUNK(chunk))
+			continue;
+
+		slice = ts_hypercube_get_slice_by_dimension_id(chunk->cube, dim->fd.id);
+
+		if (latest != NULL && slice != NULL && slice->fd.range_start >= latest->fd.range_start)
+		{
+			if (!chunk_needs_analyze(chunk->table_id, policy.analyze_scale_factor))
+				continue;
+
+			saved_cxt = MemoryContextSwitchTo(multitxn_cxt);
+			task = palloc(sizeof(MaintenanceTask));
+			task->chunk_id = chunk->fd.id;
+			task->vacuum = false;
+			analyze_tasks = lappend(analyze_tasks, task);
+			MemoryContextSwitchTo(saved_cxt);
+			continue;
+		}
+
+		if (list_length(vacuum_tasks) >= policy.max_vacuums_per_run)
+			continue;
+
+		vacuum_chunk_id = ts_chunk_is_compressed(chunk) ? chunk->fd.compressed_chunk_id :
+														  chunk->fd.id;
+		if (ts_bgw_policy_chunk_stats_find(job_id, vacuum_chunk_id) != NULL)
+			continue;
+
+		saved_cxt = MemoryContextSwitchTo(multitxn_cxt);
+		task = palloc(sizeof(MaintenanceTask));
+		task->chunk_id = vacuum_chunk_id;
+		task->vacuum = true;
+		vacuum_tasks = lappend(vacuum_tasks, task);
+		MemoryContextSwitchTo(saved_cxt);
+	}
+
+	/* The active chunks go first since the plans depend on their statistics */
+	saved_cxt = MemoryContextSwitchTo(multitxn_cxt);
+	tasks = list_concat(analyze_tasks, vacuum_tasks);
+	MemoryContextSwitchTo(saved_cxt);
+
+	if (ActiveSnapshotSet())
+		PopActiveSnapshot();
+
+	foreach (lc, tasks)
+	{
+		MaintenanceTask *task = lfirst(lc);
+		Oid relid;
+
 		CommitTransactionCommand();
 		StartTransactionCommand();
-		int32 chunkid = lfirst_int(lc);
-		Chunk *chunk = ts_chunk_get_by_id(chunkid, true);
-		if (!chunk || !ts_chunk_is_unordered(chunk))
+
+		/* The chunk might have been dropped in the meantime */
+		relid = ts_chunk_get_relid(task->chunk_id, true);
+		if (!OidIsValid(relid))
 			continue;
-		if (distributed)
-			policy_invoke_recompress_chunk(chunk);
+
+		if (task->vacuum)
+		{
+			/* VACUUM commits the transaction and starts a new one when it is done */
+			maintenance_vacuum_chunk(relid, true);
+			ts_bgw_policy_chunk_stats_record_job_run(job_id,
+													 task->chunk_id,
+													 ts_timer_get_current_timestamp());
+		}
 		else
-			tsl_recompress_chunk_wrapper(chunk);
+		{
+			PushActiveSnapshot(GetTransactionSnapshot());
+			maintenance_vacuum_chunk(relid, false);
+			PopActiveSnapshot();
+		}
 
 		elog(LOG,
-			 "completed recompressing chunk \"%s.%s\"",
-			 NameStr(chunk->fd.schema_name),
-			 NameStr(chunk->fd.table_name));
+			 "completed %s chunk \"%s.%s\"",
+			 task->vacuum ? "freezing" : "analyzing",
+			 get_namespace_name(get_rel_namespace(relid)),
+			 get_rel_name(relid));
 	}
 
-	elog(DEBUG1, "job %d completed recompressing chunk", job_id);
+	if (!used_portalcxt)
+		MemoryContextDelete(multitxn_cxt);
+
 	return true;
 }
 
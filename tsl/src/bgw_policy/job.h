@@ -44,6 +44,13 @@ typedef struct PolicyCompressionData
 	Cache *hcache;
 } PolicyCompressionData;
 
+typedef struct PolicyMaintenanceData
+{
+	Hypertable *hypertable;
+	float8 analyze_scale_factor;
+	int32 max_vacuums_per_run;
+} PolicyMaintenanceData;
+
 /* Reorder function type. Necessary for testing */
 typedef void (*reorder_func)(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id,
 							 Oid destination_tablespace, Oid index_tablespace);
@@ -53,6 +60,7 @@ extern bool policy_reorder_execute(int32 job_id, Jsonb *config);
 extern bool policy_retention_execute(int32 job_id, Jsonb *config);
 extern bool policy_refresh_cagg_execute(int32 job_id, Jsonb *config);
 extern bool policy_recompression_execute(int32 job_id, Jsonb *config);
+extern bool policy_maintenance_execute(int32 job_id, Jsonb *config);
 extern void policy_reorder_read_and_validate_config(Jsonb *config, PolicyReorderData *policy_data);
 extern void policy_retention_read_and_validate_config(Jsonb *config,
 													  PolicyRetentionData *policy_data);
@@ -62,6 +70,8 @@ extern void policy_compression_read_and_validate_config(Jsonb *config,
 														PolicyCompressionData *policy_data);
 extern void policy_recompression_read_and_validate_config(Jsonb *config,
 														  PolicyCompressionData *policy_data);
+extern void policy_maintenance_read_and_validate_config(Jsonb *config,
+														PolicyMaintenanceData *policy_data);
 extern bool job_execute(BgwJob *job);
 
 #endif /* TIMESCALEDB_TSL_BGW_POLICY_JOB_H */
@@ -0,0 +1,288 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#include <postgres.h>
+#include <utils/builtins.h>
+#include <utils/lsyscache.h>
+#include <utils/timestamp.h>
+#include <miscadmin.h>
+
+#include <compat/compat.h>
+#include <hypertable_cache.h>
+#include <jsonb_utils.h>
+
+#include "bgw/job.h"
+#include "bgw/job_stat.h"
+#include "bgw/timer.h"
+#include "bgw_policy/job.h"
+#include "bgw_policy/maintenance_api.h"
+#include "errors.h"
+#include "hypertable.h"
+#include "utils.h"
+
+/* Default max runtime for a maintenance job is unlimited */
+#define DEFAULT_MAX_RUNTIME                                                                        \
+	DatumGetIntervalP(DirectFunctionCall3(interval_in, CStringGetDatum("0"), InvalidOid, -1))
+#define DEFAULT_MAX_RETRIES (-1)
+#define DEFAULT_RETRY_PERIOD                                                                       \
+	DatumGetIntervalP(DirectFunctionCall3(interval_in, CStringGetDatum("5 min"), InvalidOid, -1))
+
+/*
+ * The active chunks are analyzed when more than this fraction of their rows
+ * changed since the last analyze. It is lower than the default of
+ * autovacuum_analyze_scale_factor since the statistics of the active chunks
+ * are the ones that the queries relative to now() depend on.
+ */
+#define DEFAULT_ANALYZE_SCALE_FACTOR 0.02
+#define DEFAULT_MAX_VACUUMS_PER_RUN 1
+
+#define CONFIG_KEY_HYPERTABLE_ID "hypertable_id"
+#define CONFIG_KEY_ANALYZE_SCALE_FACTOR "analyze_scale_factor"
+#define CONFIG_KEY_MAX_VACUUMS_PER_RUN "max_vacuums_per_run"
+
+#define POLICY_MAINTENANCE_PROC_NAME "policy_maintenance"
+#define POLICY_MAINTENANCE_CHECK_NAME "policy_maintenance_check"
+
+int32
+policy_maintenance_get_hypertable_id(const Jsonb *config)
+{
+	bool found;
+	int32 hypertable_id = ts_jsonb_get_int32_field(config, CONFIG_KEY_HYPERTABLE_ID, &found);
+
+	if (!found)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("could not find hypertable_id in config for job")));
+
+	return hypertable_id;
+}
+
+float8
+policy_maintenance_get_analyze_scale_factor(const Jsonb *config)
+{
+	char *value = ts_jsonb_get_str_field(config, CONFIG_KEY_ANALYZE_SCALE_FACTOR);
+
+	if (value == NULL)
+		return DEFAULT_ANALYZE_SCALE_FACTOR;
+
+	return DatumGetFloat8(DirectFunctionCall1(float8in, CStringGetDatum(value)));
+}
+
+int32
+policy_maintenance_get_max_vacuums_per_run(const Jsonb *config)
+{
+	bool found;
+	int32 max_vacuums = ts_jsonb_get_int32_field(config, CONFIG_KEY_MAX_VACUUMS_PER_RUN, &found);
+
+	return found ? max_vacuums : DEFAULT_MAX_VACUUMS_PER_RUN;
+}
+
+Datum
+policy_maintenance_check(PG_FUNCTION_ARGS)
+{
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (PG_ARGISNULL(0))
+	{
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), errmsg("config must not be NULL")));
+	}
+
+	policy_maintenance_read_and_validate_config(PG_GETARG_JSONB_P(0), NULL);
+
+	PG_RETURN_VOID();
+}
+
+Datum
+policy_maintenance_proc(PG_FUNCTION_ARGS)
+{
+	if (PG_NARGS() != 2 || PG_ARGISNULL(0) || PG_ARGISNULL(1))
+		PG_RETURN_VOID();
+
+	ts_feature_flag_check(FEATURE_POLICY);
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	policy_maintenance_execute(PG_GETARG_INT32(0), PG_GETARG_JSONB_P(1));
+
+	PG_RETURN_VOID();
+}
+
+Datum
+policy_maintenance_add(PG_FUNCTION_ARGS)
+{
+	/* behave like a strict function */
+	if (PG_ARGISNULL(0) || PG_ARGISNULL(1) || PG_ARGISNULL(2) || PG_ARGISNULL(3) ||
+		PG_ARGISNULL(4))
+		PG_RETURN_NULL();
+
+	NameData application_name;
+	NameData proc_name, proc_schema, check_name, check_schema;
+	int32 job_id;
+	Oid ht_oid = PG_GETARG_OID(0);
+	float8 analyze_scale_factor = PG_GETARG_FLOAT8(1);
+	int32 max_vacuums_per_run = PG_GETARG_INT32(2);
+	bool if_not_exists = PG_GETARG_BOOL(3);
+	Interval *schedule_interval = PG_GETARG_INTERVAL_P(4);
+	TimestampTz initial_start = PG_ARGISNULL(5) ? DT_NOBEGIN : PG_GETARG_TIMESTAMPTZ(5);
+	bool fixed_schedule = !PG_ARGISNULL(5);
+	text *timezone = PG_ARGISNULL(6) ? NULL : PG_GETARG_TEXT_PP(6);
+	char *valid_timezone = NULL;
+	Cache *hcache;
+	Hypertable *ht;
+	int32 hypertable_id;
+	Oid owner_id;
+	List *jobs;
+
+	ts_feature_flag_check(FEATURE_POLICY);
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	/* also rejects NaN */
+	if (!(analyze_scale_factor >= 0))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid value for analyze_scale_factor"),
+				 errhint("Use a non-negative fraction of the rows of a chunk.")));
+
+	if (max_vacuums_per_run < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid value for max_vacuums_per_run"),
+				 errhint("Use a non-negative number of chunks.")));
+
+	if (timezone != NULL)
+		valid_timezone = ts_bgw_job_validate_timezone(PG_GETARG_DATUM(6));
+
+	ht = ts_hypertable_cache_get_cache_and_entry(ht_oid, CACHE_FLAG_NONE, &hcache);
+	Assert(ht != NULL);
+	hypertable_id = ht->fd.id;
+
+	owner_id = ts_hypertable_permissions_check(ht_oid, GetUserId());
+
+	if (TS_HYPERTABLE_IS_INTERNAL_COMPRESSION_TABLE(ht))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot add maintenance policy to compressed hypertable \"%s\"",
+						get_rel_name(ht_oid)),
+				 errhint("Please add the policy to the corresponding uncompressed hypertable "
+						 "instead.")));
+
+	if (hypertable_is_distributed(ht))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("maintenance policies not supported on a distributed hypertables")));
+
+	ts_bgw_job_validate_job_owner(owner_id);
+
+	jobs = ts_bgw_job_find_by_proc_and_hypertable_id(POLICY_MAINTENANCE_PROC_NAME,
+													 INTERNAL_SCHEMA_NAME,
+													 hypertable_id);
+	ts_cache_release(hcache);
+
+	if (jobs != NIL)
+	{
+		Assert(list_length(jobs) == 1);
+
+		if (!if_not_exists)
+			ereport(ERROR,
+					(errcode(ERRCODE_DUPLICATE_OBJECT),
+					 errmsg("maintenance policy already exists for hypertable \"%s\"",
+							get_rel_name(ht_oid))));
+
+		ereport(NOTICE,
+				(errmsg("maintenance policy already exists on hypertable \"%s\", skipping",
+						get_rel_name(ht_oid))));
+		PG_RETURN_INT32(-1);
+	}
+
+	/* if users pass in -infinity for initial_start, then use the current_timestamp instead */
+	if (fixed_schedule)
+	{
+		ts_bgw_job_validate_schedule_interval(schedule_interval);
+		if (TIMESTAMP_NOT_FINITE(initial_start))
+			initial_start = ts_timer_get_current_timestamp();
+	}
+
+	namestrcpy(&application_name, "Maintenance Policy");
+	namestrcpy(&proc_name, POLICY_MAINTENANCE_PROC_NAME);
+	namestrcpy(&proc_schema, INTERNAL_SCHEMA_NAME);
+	namestrcpy(&check_name, POLICY_MAINTENANCE_CHECK_NAME);
+	namestrcpy(&check_schema, INTERNAL_SCHEMA_NAME);
+
+	JsonbParseState *parse_state = NULL;
+
+	pushJsonbValue(&parse_state, WJB_BEGIN_OBJECT, NULL);
+	ts_jsonb_add_int32(parse_state, CONFIG_KEY_HYPERTABLE_ID, hypertable_id);
+	ts_jsonb_add_numeric(parse_state,
+						 CONFIG_KEY_ANALYZE_SCALE_FACTOR,
+						 DatumGetNumeric(
+							 DirectFunctionCall1(float8_numeric,
+												 Float8GetDatum(analyze_scale_factor))));
+	ts_jsonb_add_int32(parse_state, CONFIG_KEY_MAX_VACUUMS_PER_RUN, max_vacuums_per_run);
+	JsonbValue *result = pushJsonbValue(&parse_state, WJB_END_OBJECT, NULL);
+	Jsonb *config = JsonbValueToJsonb(result);
+
+	job_id = ts_bgw_job_insert_relation(&application_name,
+										schedule_interval,
+										DEFAULT_MAX_RUNTIME,
+										DEFAULT_MAX_RETRIES,
+										DEFAULT_RETRY_PERIOD,
+										&proc_schema,
+										&proc_name,
+										&check_schema,
+										&check_name,
+										owner_id,
+										true,
+										fixed_schedule,
+										hypertable_id,
+										config,
+										initial_start,
+										valid_timezone);
+
+	if (!TIMESTAMP_NOT_FINITE(initial_start))
+		ts_bgw_job_stat_upsert_next_start(job_id, initial_start);
+
+	PG_RETURN_INT32(job_id);
+}
+
+Datum
+policy_maintenance_remove(PG_FUNCTION_ARGS)
+{
+	Oid hypertable_oid = PG_GETARG_OID(0);
+	bool if_exists = PG_GETARG_BOOL(1);
+	Hypertable *ht;
+	Cache *hcache;
+
+	ts_feature_flag_check(FEATURE_POLICY);
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	ht = ts_hypertable_cache_get_cache_and_entry(hypertable_oid, CACHE_FLAG_NONE, &hcache);
+
+	List *jobs = ts_bgw_job_find_by_proc_and_hypertable_id(POLICY_MAINTENANCE_PROC_NAME,
+														   INTERNAL_SCHEMA_NAME,
+														   ht->fd.id);
+	ts_cache_release(hcache);
+
+	if (jobs == NIL)
+	{
+		if (!if_exists)
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_OBJECT),
+					 errmsg("maintenance policy not found for hypertable \"%s\"",
+							get_rel_name(hypertable_oid))));
+
+		ereport(NOTICE,
+				(errmsg("maintenance policy not found for hypertable \"%s\", skipping",
+						get_rel_name(hypertable_oid))));
+		PG_RETURN_BOOL(false);
+	}
+	Assert(list_length(jobs) == 1);
+	BgwJob *job = linitial(jobs);
+
+	ts_hypertable_permissions_check(hypertable_oid, GetUserId());
+
+	ts_bgw_job_delete_by_id(job->fd.id);
+
+	PG_RETURN_BOOL(true);
+}
@@ -0,0 +1,23 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#ifndef TIMESCALEDB_TSL_BGW_POLICY_MAINTENANCE_API_H
+#define TIMESCALEDB_TSL_BGW_POLICY_MAINTENANCE_API_H
+
+#include <postgres.h>
+#include <utils/jsonb.h>
+
+/* User-facing API functions */
+extern Datum policy_maintenance_add(PG_FUNCTION_ARGS);
+extern Datum policy_maintenance_remove(PG_FUNCTION_ARGS);
+extern Datum policy_maintenance_proc(PG_FUNCTION_ARGS);
+extern Datum policy_maintenance_check(PG_FUNCTION_ARGS);
+
+extern int32 policy_maintenance_get_hypertable_id(const Jsonb *config);
+extern float8 policy_maintenance_get_analyze_scale_factor(const Jsonb *config);
+extern int32 policy_maintenance_get_max_vacuums_per_run(const Jsonb *config);
+
+#endif /* TIMESCALEDB_TSL_BGW_POLICY_MAINTENANCE_API_H */
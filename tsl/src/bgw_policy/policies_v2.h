@@ -26,6 +26,7 @@
 
 #define POLICY_RECOMPRESSION_PROC_NAME "policy_recompression"
 #define POL_RECOMPRESSION_CONF_KEY_RECOMPRESS_AFTER "recompress_after"
+#define POL_RECOMPRESSION_CONF_KEY_MAXBYTES_TO_RECOMPRESS "maxbytes_to_recompress"
 
 #define POLICY_RETENTION_PROC_NAME "policy_retention"
 #define POLICY_RETENTION_CHECK_NAME "policy_retention_check"
@@ -5,7 +5,10 @@
  */
 
 #include <postgres.h>
+#include <access/heapam.h>
 #include <access/htup_details.h>
+#include <access/tableam.h>
+#include <access/tupconvert.h>
 #include <access/xact.h>
 #include <catalog/pg_foreign_server.h>
 #include <catalog/pg_foreign_table.h>
@@ -19,6 +22,7 @@
 #include <utils/builtins.h>
 #include <utils/syscache.h>
 #include <utils/inval.h>
+#include <utils/lsyscache.h>
 #include <utils/tuplestore.h>
 #include <utils/palloc.h>
 #include <utils/memutils.h>
@@ -42,11 +46,14 @@
 
 #include "chunk.h"
 #include "chunk_api.h"
+#include "compression/api.h"
+#include "compression/create.h"
 #include "data_node.h"
 #include "deparse.h"
 #include "debug_point.h"
 #include "dist_util.h"
 #include "remote/dist_commands.h"
+#include "ts_catalog/chunk_column_stats.h"
 #include "ts_catalog/chunk_data_node.h"
 #include "utils.h"
 
@@ -563,6 +570,252 @@ chunk_unfreeze_chunk(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(ret);
 }
 
+/*
+ * Copy all the rows of a chunk table into another chunk table of the same
+ * hypertable, inserting them into the indexes of the target table as well.
+ * The tables can have different physical layouts, e.g., due to dropped
+ * columns. If a sequence number column is given, the copied rows are moved
+ * after the existing ones by adding an offset to it.
+ *
+ * Triggers are not fired since the rows are only moved between chunks.
+ */
+static int64
+chunk_merge_copy_rows(Relation src_rel, Relation dst_rel, AttrNumber seqnum_attno,
+					  int32 seqnum_offset)
+{
+	TupleDesc src_desc = RelationGetDescr(src_rel);
+	TupleDesc dst_desc = RelationGetDescr(dst_rel);
+	TupleConversionMap *map = convert_tuples_by_name(src_desc, dst_desc);
+	TupleTableSlot *src_slot = table_slot_create(src_rel, NULL);
+	TupleTableSlot *dst_slot = MakeSingleTupleTableSlot(dst_desc, &TTSOpsVirtual);
+	EState *estate = CreateExecutorState();
+	ResultRelInfo *rri = makeNode(ResultRelInfo);
+	BulkInsertState bistate = GetBulkInsertState();
+	CommandId mycid = GetCurrentCommandId(true);
+	Snapshot snapshot = RegisterSnapshot(GetLatestSnapshot());
+	TableScanDesc scan = table_beginscan(src_rel, snapshot, 0, NULL);
+	int64 nrows = 0;
+
+	InitResultRelInfo(rri, dst_rel, 1, NULL, 0);
+	ExecOpenIndices(rri, false);
+#if PG14_LT
+	estate->es_result_relation_info = rri;
+#endif
+
+	while (table_scan_getnextslot(scan, ForwardScanDirection, src_slot))
+	{
+		slot_getallattrs(src_slot);
+
+		if (map != NULL)
+			execute_attr_map_slot(map->attrMap, src_slot, dst_slot);
+		else
+		{
+			ExecClearTuple(dst_slot);
+			memcpy(dst_slot->tts_values, src_slot->tts_values, sizeof(Datum) * dst_desc->natts);
+			memcpy(dst_slot->tts_isnull, src_slot->tts_isnull, sizeof(bool) * dst_desc->natts);
+			ExecStoreVirtualTuple(dst_slot);
+		}
+
+		if (seqnum_attno != InvalidAttrNumber)
+		{
+			int offset = AttrNumberGetAttrOffset(seqnum_attno);
+			int64 seqnum = (int64) DatumGetInt32(dst_slot->tts_values[offset]) + seqnum_offset;
+
+			if (seqnum > PG_INT32_MAX)
+				ereport(ERROR,
+						(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+						 errmsg("too many batches in the merged compressed chunk \"%s\"",
+								RelationGetRelationName(dst_rel))));
+
+			dst_slot->tts_values[offset] = Int32GetDatum((int32) seqnum);
+		}
+
+		table_tuple_insert(dst_rel, dst_slot, mycid, 0, bistate);
+
+		if (rri->ri_NumIndices > 0)
+			ExecInsertIndexTuplesCompat(rri, dst_slot, estate, false, false, NULL, NIL, false);
+
+		ResetPerTupleExprContext(estate);
+		nrows++;
+	}
+
+	table_endscan(scan);
+	UnregisterSnapshot(snapshot);
+	ExecCloseIndices(rri);
+	FreeExecutorState(estate);
+	FreeBulkInsertState(bistate);
+	ExecDropSingleTupleTableSlot(dst_slot);
+	ExecDropSingleTupleTableSlot(src_slot);
+
+	return nrows;
+}
+
+/*
+ * The highest sequence number of the batches of a compressed chunk table.
+ */
+static int32
+chunk_merge_max_sequence_num(Relation rel, AttrNumber seqnum_attno)
+{
+	TupleTableSlot *slot = table_slot_create(rel, NULL);
+	Snapshot snapshot = RegisterSnapshot(GetLatestSnapshot());
+	TableScanDesc scan = table_beginscan(rel, snapshot, 0, NULL);
+	int32 max_seqnum = 0;
+
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		bool isnull;
+		Datum seqnum = slot_getattr(slot, seqnum_attno, &isnull);
+
+		if (!isnull && DatumGetInt32(seqnum) > max_seqnum)
+			max_seqnum = DatumGetInt32(seqnum);
+	}
+
+	table_endscan(scan);
+	UnregisterSnapshot(snapshot);
+	ExecDropSingleTupleTableSlot(slot);
+
+	return max_seqnum;
+}
+
+/*
+ * Merge two adjacent chunks of a hypertable into one.
+ *
+ * The chunks have to be adjacent on the primary dimension and cover the same
+ * slices on all the other dimensions. The later chunk is merged into the
+ * earlier one: the slice of the earlier chunk is extended to cover both chunks,
+ * the rows of the later chunk are moved into it, and the later chunk is
+ * dropped. Compressed chunks can only be merged with compressed chunks, in
+ * which case the compressed batches are moved behind the batches of the
+ * earlier chunk.
+ *
+ * Returns the merged chunk.
+ */
+Datum
+chunk_merge_chunks(PG_FUNCTION_ARGS)
+{
+	Oid chunk_relid = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+	Oid merge_chunk_relid = PG_ARGISNULL(1) ? InvalidOid : PG_GETARG_OID(1);
+	const DimensionSlice *slice, *merge_slice;
+	const Dimension *time_dim;
+	Chunk *chunk, *merge_chunk;
+	Hypertable *ht;
+	Cache *hcache;
+	Relation rel, merge_rel;
+	int64 nrows;
+
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (!OidIsValid(chunk_relid) || !OidIsValid(merge_chunk_relid))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("invalid chunk to merge")));
+
+	if (chunk_relid == merge_chunk_relid)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("cannot merge chunk \"%s\" with itself", get_rel_name(chunk_relid))));
+
+	chunk = ts_chunk_get_by_relid(chunk_relid, true);
+	merge_chunk = ts_chunk_get_by_relid(merge_chunk_relid, true);
+
+	if (chunk->hypertable_relid != merge_chunk->hypertable_relid)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("cannot merge chunks from different hypertables"),
+				 errhint("chunk 1: \"%s\", chunk 2: \"%s\"",
+						 get_rel_name(chunk_relid),
+						 get_rel_name(merge_chunk_relid))));
+
+	if (chunk->relkind == RELKIND_FOREIGN_TABLE || merge_chunk->relkind == RELKIND_FOREIGN_TABLE)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("operation not supported on distributed chunk or foreign table")));
+
+	ht = ts_hypertable_cache_get_cache_and_entry(chunk->hypertable_relid, CACHE_FLAG_NONE, &hcache);
+	ts_hypertable_permissions_check(ht->main_table_relid, GetUserId());
+
+	/* Merge the later chunk into the earlier one */
+	time_dim = hyperspace_get_open_dimension(ht->space, 0);
+	slice = ts_hypercube_get_slice_by_dimension_id(chunk->cube, time_dim->fd.id);
+	merge_slice = ts_hypercube_get_slice_by_dimension_id(merge_chunk->cube, time_dim->fd.id);
+
+	if (slice != NULL && merge_slice != NULL &&
+		merge_slice->fd.range_end == slice->fd.range_start)
+	{
+		Chunk *tmp = chunk;
+
+		chunk = merge_chunk;
+		merge_chunk = tmp;
+	}
+
+	LockRelationOid(ht->main_table_relid, AccessShareLock);
+	LockRelationOid(chunk->table_id, AccessExclusiveLock);
+	LockRelationOid(merge_chunk->table_id, AccessExclusiveLock);
+
+	/*
+	 * The status of the chunks can have changed while we waited for the
+	 * locks, e.g. by a concurrent compression, so read them again.
+	 */
+	chunk = ts_chunk_get_by_relid(chunk->table_id, true);
+	merge_chunk = ts_chunk_get_by_relid(merge_chunk->table_id, true);
+
+	/* The merged chunk is modified and the other one is dropped */
+	ts_chunk_validate_chunk_status_for_operation(chunk, CHUNK_UPDATE, true);
+	ts_chunk_validate_chunk_status_for_operation(merge_chunk, CHUNK_DROP, true);
+
+	if (ts_chunk_is_compressed(chunk) != ts_chunk_is_compressed(merge_chunk))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot merge a compressed chunk with an uncompressed chunk"),
+				 errhint("Compress or decompress the chunks before merging them.")));
+
+	/* This also checks that the chunks are adjacent */
+	ts_chunk_extend_on_dimension(ht, chunk, merge_chunk, time_dim->fd.id);
+
+	/* The rows of the other chunk can be outside of the tracked ranges */
+	ts_chunk_column_stats_set_invalid(chunk);
+
+	if (ts_chunk_is_compressed(chunk))
+	{
+		Chunk *compressed_chunk = ts_chunk_get_by_id(chunk->fd.compressed_chunk_id, true);
+		Chunk *merge_compressed_chunk =
+			ts_chunk_get_by_id(merge_chunk->fd.compressed_chunk_id, true);
+		AttrNumber seqnum_attno;
+
+		LockRelationOid(compressed_chunk->table_id, AccessExclusiveLock);
+		LockRelationOid(merge_compressed_chunk->table_id, AccessExclusiveLock);
+
+		rel = table_open(compressed_chunk->table_id, NoLock);
+		merge_rel = table_open(merge_compressed_chunk->table_id, NoLock);
+		seqnum_attno = get_attnum(compressed_chunk->table_id,
+								  COMPRESSION_COLUMN_METADATA_SEQUENCE_NUM_NAME);
+
+		chunk_merge_copy_rows(merge_rel,
+							  rel,
+							  seqnum_attno,
+							  chunk_merge_max_sequence_num(rel, seqnum_attno));
+
+		table_close(merge_rel, NoLock);
+		table_close(rel, NoLock);
+
+		tsl_compression_chunk_merged(ht, chunk, merge_chunk);
+	}
+
+	rel = table_open(chunk->table_id, NoLock);
+	merge_rel = table_open(merge_chunk->table_id, NoLock);
+	nrows = chunk_merge_copy_rows(merge_rel, rel, InvalidAttrNumber, 0);
+	table_close(merge_rel, NoLock);
+	table_close(rel, NoLock);
+
+	/* Uncompressed rows of a compressed chunk make it partially compressed */
+	if (nrows > 0 && ts_chunk_is_compressed(chunk))
+		ts_chunk_set_partial(chunk);
+
+	ts_chunk_drop(merge_chunk, DROP_RESTRICT, DEBUG1);
+	ts_cache_release(hcache);
+
+	PG_RETURN_OID(chunk->table_id);
+}
+
 static List *
 chunk_id_list_create(ArrayType *array)
 {
@@ -27,7 +27,10 @@
 #include <miscadmin.h>
 #include <fmgr.h>
 #include <executor/spi.h>
+#include <libpq-fe.h>
+#include <pgstat.h>
 #include <replication/slot.h>
+#include <storage/latch.h>
 
 #ifdef USE_ASSERT_CHECKING
 #include <funcapi.h>
@@ -45,6 +48,8 @@
 #include "chunk_copy.h"
 #include "data_node.h"
 #include "debug_point.h"
+#include "guc.h"
+#include "remote/connection.h"
 #include "remote/dist_commands.h"
 #include "dist_util.h"
 
@@ -56,6 +61,7 @@
 #define CCS_CREATE_SUBSCRIPTION "create_subscription"
 #define CCS_SYNC_START "sync_start"
 #define CCS_SYNC "sync"
+#define CCS_COPY_DATA "copy_data"
 #define CCS_DROP_PUBLICATION "drop_publication"
 #define CCS_DROP_SUBSCRIPTION "drop_subscription"
 #define CCS_ATTACH_CHUNK "attach_chunk"
@@ -68,11 +74,21 @@ typedef struct ChunkCopy ChunkCopy;
 
 typedef void (*chunk_copy_stage_func)(ChunkCopy *);
 
+/* How the data of the chunk is transferred between the data nodes */
+typedef enum ChunkCopyMethod
+{
+	CHUNK_COPY_METHOD_ANY = 0,
+	CHUNK_COPY_METHOD_REPLICATION,
+	CHUNK_COPY_METHOD_COPY_STREAMS,
+} ChunkCopyMethod;
+
 struct ChunkCopyStage
 {
 	const char *name;
 	chunk_copy_stage_func function;
 	chunk_copy_stage_func function_cleanup;
+	/* the stage only does something with this copy method */
+	ChunkCopyMethod method;
 };
 
 /* To track a chunk move or copy activity */
@@ -88,10 +104,21 @@ struct ChunkCopy
 	/* from/to foreign servers */
 	ForeignServer *src_server;
 	ForeignServer *dst_server;
+	/* data transfer method and number of parallel COPY streams per table */
+	ChunkCopyMethod method;
+	int num_streams;
 	/* temporary memory context */
 	MemoryContext mcxt;
 };
 
+/* A COPY stream between the source and destination data nodes */
+typedef struct ChunkCopyStream
+{
+	TSConnection *src_conn;
+	TSConnection *dst_conn;
+	bool done;
+} ChunkCopyStream;
+
 static HeapTuple
 chunk_copy_operation_make_tuple(const FormData_chunk_copy_operation *fd, TupleDesc desc)
 {
@@ -353,6 +380,9 @@ chunk_copy_setup(ChunkCopy *cc, Oid chunk_relid, const char *src_node, const cha
 	namestrcpy(&cc->fd.dest_node_name, dst_node);
 	memset(cc->fd.compressed_chunk_name.data, 0, NAMEDATALEN);
 	cc->fd.delete_on_src_node = delete_on_src_node;
+	cc->num_streams = ts_guc_chunk_copy_streams;
+	cc->method =
+		cc->num_streams > 0 ? CHUNK_COPY_METHOD_COPY_STREAMS : CHUNK_COPY_METHOD_REPLICATION;
 
 	ts_cache_release(hcache);
 	MemoryContextSwitchTo(old);
@@ -884,6 +914,295 @@ chunk_copy_stage_sync(ChunkCopy *cc)
 	}
 }
 
+/*
+ * Open a session with a transaction on a data node for a COPY stream. The
+ * source sessions read from the same snapshot, so that the streams together
+ * copy a consistent state of the chunk.
+ */
+static TSConnection *
+chunk_copy_stream_open(const ForeignServer *server, const char *snapshot)
+{
+	TSConnection *conn =
+		remote_connection_open_session_by_id(remote_connection_id(server->serverid, GetUserId()));
+
+	if (snapshot == NULL)
+		remote_connection_cmd_ok(conn, "BEGIN");
+	else
+	{
+		remote_connection_cmd_ok(conn, "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+		remote_connection_cmd_ok(conn,
+								 psprintf("SET TRANSACTION SNAPSHOT %s",
+										  quote_literal_cstr(snapshot)));
+	}
+
+	return conn;
+}
+
+/*
+ * Get the number of pages of a table on the source data node. TID range scans
+ * were added in PG14, so on earlier versions the table is not split and a
+ * single stream copies it.
+ */
+static int64
+chunk_copy_get_num_pages(TSConnection *conn, const char *table_name)
+{
+	int64 num_pages = 0;
+
+#if PG14_GE
+	PGresult *res = remote_connection_queryf_ok(conn,
+												"SELECT pg_catalog.pg_relation_size(%s) / "
+												"pg_catalog.current_setting('block_size')::int",
+												quote_literal_cstr(table_name));
+	num_pages = pg_strtoint64(PQgetvalue(res, 0, 0));
+	PQclear(res);
+#endif
+
+	return num_pages;
+}
+
+/*
+ * Start the COPY streams for a table. The table is split into page ranges
+ * that are copied by the streams in parallel.
+ */
+static List *
+chunk_copy_streams_start(ChunkCopy *cc, List *streams, const char *table_name, int64 num_pages,
+						 TSConnection *snapshot_conn, const char *snapshot)
+{
+	int num_streams = cc->num_streams;
+	int64 pages_per_stream;
+	int i;
+
+	if (num_pages < num_streams)
+		num_streams = 1;
+
+	pages_per_stream = num_pages / num_streams;
+
+	for (i = 0; i < num_streams; i++)
+	{
+		ChunkCopyStream *stream = palloc0(sizeof(ChunkCopyStream));
+		StringInfoData query;
+		TSConnectionError err;
+
+		initStringInfo(&query);
+		appendStringInfo(&query, "COPY (SELECT * FROM %s", table_name);
+
+		/* The last stream also copies the pages added after the size was read */
+		if (num_streams > 1)
+		{
+			appendStringInfo(&query,
+							 " WHERE ctid >= '(" INT64_FORMAT ",0)'::tid",
+							 i * pages_per_stream);
+			if (i < num_streams - 1)
+				appendStringInfo(&query,
+								 " AND ctid < '(" INT64_FORMAT ",0)'::tid",
+								 (i + 1) * pages_per_stream);
+		}
+
+		appendStringInfoString(&query, ") TO STDOUT WITH (FORMAT binary)");
+
+		stream->src_conn =
+			(i == 0 && streams == NIL) ? snapshot_conn :
+										 chunk_copy_stream_open(cc->src_server, snapshot);
+		stream->dst_conn = chunk_copy_stream_open(cc->dst_server, NULL);
+
+		if (1 != PQsendQuery(remote_connection_get_pg_conn(stream->src_conn), query.data))
+			remote_connection_elog(stream->src_conn, ERROR);
+
+		/* The binary header and trailer are relayed from the source */
+		if (!remote_connection_begin_copy(stream->dst_conn,
+										  psprintf("COPY %s FROM STDIN WITH (FORMAT binary)",
+												   table_name),
+										  false,
+										  &err))
+			remote_connection_error_elog(&err, ERROR);
+
+		streams = lappend(streams, stream);
+	}
+
+	return streams;
+}
+
+static void
+chunk_copy_stream_put_data(ChunkCopyStream *stream, const char *buf, int len)
+{
+	PGconn *pg_conn = remote_connection_get_pg_conn(stream->dst_conn);
+	TSConnectionError err;
+	int ret;
+
+	/* The destination connection is non-blocking during COPY */
+	while ((ret = remote_connection_put_copy_data(stream->dst_conn, buf, len, &err)) == 0)
+	{
+		(void) WaitLatchOrSocket(MyLatch,
+								 WL_SOCKET_WRITEABLE | WL_EXIT_ON_PM_DEATH,
+								 PQsocket(pg_conn),
+								 0,
+								 PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+		CHECK_FOR_INTERRUPTS();
+
+		if (PQflush(pg_conn) == -1)
+			remote_connection_elog(stream->dst_conn, ERROR);
+	}
+
+	if (ret == -1)
+		remote_connection_error_elog(&err, ERROR);
+}
+
+static void
+chunk_copy_stream_finish(ChunkCopyStream *stream)
+{
+	PGconn *src_pg_conn = remote_connection_get_pg_conn(stream->src_conn);
+	TSConnectionError err;
+	PGresult *res;
+
+	while ((res = PQgetResult(src_pg_conn)) != NULL)
+		remote_result_cmd_ok(res);
+
+	if (!remote_connection_end_copy(stream->dst_conn, &err))
+		remote_connection_error_elog(&err, ERROR);
+
+	stream->done = true;
+}
+
+/*
+ * Relay the data of all streams from the source to the destination data
+ * node, reading from whichever source has data.
+ */
+static void
+chunk_copy_streams_relay(List *streams)
+{
+	int num_active = list_length(streams);
+	ListCell *lc;
+
+	while (num_active > 0)
+	{
+		bool progress = false;
+
+		foreach (lc, streams)
+		{
+			ChunkCopyStream *stream = lfirst(lc);
+			char *buf;
+			int len;
+
+			if (stream->done)
+				continue;
+
+			len = PQgetCopyData(remote_connection_get_pg_conn(stream->src_conn), &buf, true);
+
+			if (len > 0)
+			{
+				chunk_copy_stream_put_data(stream, buf, len);
+				PQfreemem(buf);
+				progress = true;
+			}
+			else if (len == -1)
+			{
+				chunk_copy_stream_finish(stream);
+				num_active--;
+				progress = true;
+			}
+			else if (len == -2)
+				remote_connection_elog(stream->src_conn, ERROR);
+		}
+
+		if (!progress)
+		{
+			WaitEventSet *we_set = CreateWaitEventSet(CurrentMemoryContext, num_active + 1);
+			WaitEvent event;
+
+			AddWaitEventToSet(we_set, WL_LATCH_SET, PGINVALID_SOCKET, MyLatch, NULL);
+
+			foreach (lc, streams)
+			{
+				ChunkCopyStream *stream = lfirst(lc);
+
+				if (!stream->done)
+					AddWaitEventToSet(we_set,
+									  WL_SOCKET_READABLE,
+									  PQsocket(remote_connection_get_pg_conn(stream->src_conn)),
+									  NULL,
+									  NULL);
+			}
+
+			(void) WaitEventSetWait(we_set, -1L, &event, 1, PG_WAIT_EXTENSION);
+			FreeWaitEventSet(we_set);
+			ResetLatch(MyLatch);
+			CHECK_FOR_INTERRUPTS();
+
+			foreach (lc, streams)
+			{
+				ChunkCopyStream *stream = lfirst(lc);
+
+				if (!stream->done &&
+					PQconsumeInput(remote_connection_get_pg_conn(stream->src_conn)) == 0)
+					remote_connection_elog(stream->src_conn, ERROR);
+			}
+		}
+	}
+}
+
+/*
+ * Copy the chunk, and its compressed chunk, with parallel binary COPY streams
+ * through the access node. The destination transactions are committed once
+ * all the streams are done.
+ */
+static void
+chunk_copy_stage_copy_data(ChunkCopy *cc)
+{
+	TSConnection *snapshot_conn;
+	PGresult *res;
+	char *snapshot;
+	const char *chunk_name;
+	const char *compressed_chunk_name = NULL;
+	int64 num_pages;
+	int64 num_compressed_pages = 0;
+	List *streams = NIL;
+	ListCell *lc;
+
+	chunk_name = quote_qualified_identifier(NameStr(cc->chunk->fd.schema_name),
+											NameStr(cc->chunk->fd.table_name));
+	if (ts_chunk_is_compressed(cc->chunk))
+		compressed_chunk_name =
+			quote_qualified_identifier(INTERNAL_SCHEMA_NAME, NameStr(cc->fd.compressed_chunk_name));
+
+	snapshot_conn = remote_connection_open_session_by_id(
+		remote_connection_id(cc->src_server->serverid, GetUserId()));
+	remote_connection_cmd_ok(snapshot_conn, "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+	res = remote_connection_query_ok(snapshot_conn, "SELECT pg_catalog.pg_export_snapshot()");
+	snapshot = pstrdup(PQgetvalue(res, 0, 0));
+	PQclear(res);
+
+	/* Get the sizes before the first stream makes the connection busy */
+	num_pages = chunk_copy_get_num_pages(snapshot_conn, chunk_name);
+	if (compressed_chunk_name != NULL)
+		num_compressed_pages = chunk_copy_get_num_pages(snapshot_conn, compressed_chunk_name);
+
+	streams = chunk_copy_streams_start(cc, streams, chunk_name, num_pages, snapshot_conn, snapshot);
+
+	if (compressed_chunk_name != NULL)
+		streams = chunk_copy_streams_start(cc,
+										   streams,
+										   compressed_chunk_name,
+										   num_compressed_pages,
+										   snapshot_conn,
+										   snapshot);
+
+	chunk_copy_streams_relay(streams);
+
+	foreach (lc, streams)
+	{
+		ChunkCopyStream *stream = lfirst(lc);
+
+		remote_connection_cmd_ok(stream->dst_conn, "COMMIT");
+		remote_connection_close(stream->dst_conn);
+
+		if (stream->src_conn != snapshot_conn)
+			remote_connection_close(stream->src_conn);
+	}
+
+	remote_connection_close(snapshot_conn);
+}
+
 static void
 chunk_copy_stage_drop_subscription(ChunkCopy *cc)
 {
@@ -1047,27 +1366,46 @@ static const ChunkCopyStage chunk_copy_stages[] = {
 	 */
 	{ CCS_CREATE_PUBLICATION,
 	  chunk_copy_stage_create_publication,
-	  chunk_copy_stage_create_publication_cleanup },
+	  chunk_copy_stage_create_publication_cleanup,
+	  CHUNK_COPY_METHOD_REPLICATION },
 	{ CCS_CREATE_REPLICATION_SLOT,
 	  chunk_copy_stage_create_replication_slot,
-	  chunk_copy_stage_create_replication_slot_cleanup },
+	  chunk_copy_stage_create_replication_slot_cleanup,
+	  CHUNK_COPY_METHOD_REPLICATION },
 	{ CCS_CREATE_SUBSCRIPTION,
 	  chunk_copy_stage_create_subscription,
-	  chunk_copy_stage_create_subscription_cleanup },
+	  chunk_copy_stage_create_subscription_cleanup,
+	  CHUNK_COPY_METHOD_REPLICATION },
 
 	/*
 	 * Begin data transfer and wait for completion.
 	 * The corresponding cleanup function should just disable the subscription so
 	 * that earlier steps above can drop the subcription/publication cleanly.
 	 */
-	{ CCS_SYNC_START, chunk_copy_stage_sync_start, chunk_copy_stage_sync_start_cleanup },
-	{ CCS_SYNC, chunk_copy_stage_sync, NULL },
+	{ CCS_SYNC_START,
+	  chunk_copy_stage_sync_start,
+	  chunk_copy_stage_sync_start_cleanup,
+	  CHUNK_COPY_METHOD_REPLICATION },
+	{ CCS_SYNC, chunk_copy_stage_sync, NULL, CHUNK_COPY_METHOD_REPLICATION },
+
+	/*
+	 * Alternatively, copy the data with parallel COPY streams. The
+	 * destination transactions only commit when all streams are done, so the
+	 * cleanup of the empty chunks above is enough.
+	 */
+	{ CCS_COPY_DATA, chunk_copy_stage_copy_data, NULL, CHUNK_COPY_METHOD_COPY_STREAMS },
 
 	/*
 	 * Cleanup. Nothing else required via the cleanup functions.
 	 */
-	{ CCS_DROP_SUBSCRIPTION, chunk_copy_stage_drop_subscription, NULL },
-	{ CCS_DROP_PUBLICATION, chunk_copy_stage_drop_publication, NULL },
+	{ CCS_DROP_SUBSCRIPTION,
+	  chunk_copy_stage_drop_subscription,
+	  NULL,
+	  CHUNK_COPY_METHOD_REPLICATION },
+	{ CCS_DROP_PUBLICATION,
+	  chunk_copy_stage_drop_publication,
+	  NULL,
+	  CHUNK_COPY_METHOD_REPLICATION },
 
 	/*
 	 * Attach chunk to the hypertable on the dst_node.
@@ -1140,7 +1478,9 @@ chunk_copy_execute(ChunkCopy *cc)
 
 		cc->stage = stage;
 
-		if (cc->stage->function)
+		/* Stages of the other copy method are only marked as completed */
+		if (cc->stage->function &&
+			(stage->method == CHUNK_COPY_METHOD_ANY || stage->method == cc->method))
 			cc->stage->function(cc);
 
 		/* Mark current stage as completed and update the catalog */
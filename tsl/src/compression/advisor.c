@@ -0,0 +1,827 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * The compression advisor estimates the compression ratio and the bulk
+ * decompression cost of a chunk for several candidate segmentby and orderby
+ * settings, without compressing the chunk.
+ *
+ * The chunk is read once. For each candidate, a sample of the rows is sorted
+ * in the order that compress_chunk() would use, and the sample is split into
+ * batches the same way. Every column of every batch is then compressed with
+ * each algorithm that supports its type, and the compressed batch is
+ * decompressed again to measure the decompression time.
+ *
+ * The batches have to look like the real ones for the estimate to be useful,
+ * so the sample consists of whole segments: a row is sampled when the hash of
+ * its segmentby values is below a threshold. Without segmentby, the whole
+ * chunk is one segment, and the sample is the first rows in the orderby.
+ */
+
+#include <postgres.h>
+
+#include <access/htup_details.h>
+#include <access/table.h>
+#include <access/tableam.h>
+#include <catalog/pg_class.h>
+#include <catalog/pg_type.h>
+#include <common/hashfn.h>
+#include <executor/tuptable.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <miscadmin.h>
+#include <portability/instr_time.h>
+#include <utils/array.h>
+#include <utils/builtins.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/snapmgr.h>
+#include <utils/tuplesort.h>
+#include <utils/typcache.h>
+
+#include "annotations.h"
+#include "compat/compat.h"
+#include "compression/advisor.h"
+#include "compression/compression.h"
+#include "compression/create.h"
+#include "compression_with_clause.h"
+#include "chunk.h"
+#include "guc.h"
+#include "hypertable.h"
+#include "hypertable_cache.h"
+#include "ts_catalog/hypertable_compression.h"
+
+static const char *advisor_algorithm_names[_END_COMPRESSION_ALGORITHMS] = {
+	[COMPRESSION_ALGORITHM_ARRAY] = "array",
+	[COMPRESSION_ALGORITHM_DICTIONARY] = "dictionary",
+	[COMPRESSION_ALGORITHM_GORILLA] = "gorilla",
+	[COMPRESSION_ALGORITHM_DELTADELTA] = "deltadelta",
+	[COMPRESSION_ALGORITHM_BITPACKING] = "bitpacking",
+};
+
+typedef struct AdvisorColumn
+{
+	AttrNumber attno;
+	Oid type;
+	int16 typlen;
+	bool is_segmentby;
+	/* The value of a segmentby column in the current batch */
+	SegmentInfo *segment_info;
+
+	int n_algorithms;
+	CompressionAlgorithms algorithms[_END_COMPRESSION_ALGORITHMS];
+	Compressor *compressors[_END_COMPRESSION_ALGORITHMS];
+	int64 compressed_bytes[_END_COMPRESSION_ALGORITHMS];
+	double decompress_seconds[_END_COMPRESSION_ALGORITHMS];
+	int64 decompressed_values[_END_COMPRESSION_ALGORITHMS];
+
+	/* The size of the non-null values in their in-memory representation */
+	int64 uncompressed_bytes;
+	/* A segmentby column stores its value once per batch */
+	int64 segmentby_bytes;
+} AdvisorColumn;
+
+typedef struct AdvisorCandidate
+{
+	const char *segmentby;
+	const char *orderby;
+
+	/* The sort keys, the segmentby columns first */
+	int n_keys;
+	int n_segmentby;
+	AttrNumber *sort_keys;
+	Oid *sort_operators;
+	Oid *sort_collations;
+	bool *nulls_first;
+
+	Tuplesortstate *sort;
+	int64 sampled_rows;
+	int64 batches;
+} AdvisorCandidate;
+
+static bool
+advisor_algorithm_supports_type(CompressionAlgorithms algorithm, Oid type)
+{
+	switch (algorithm)
+	{
+		case COMPRESSION_ALGORITHM_ARRAY:
+			return true;
+		case COMPRESSION_ALGORITHM_DICTIONARY:
+		{
+			TypeCacheEntry *tentry =
+				lookup_type_cache(type, TYPECACHE_EQ_OPR_FINFO | TYPECACHE_HASH_PROC_FINFO);
+			return tentry->hash_proc_finfo.fn_addr != NULL && tentry->eq_opr_finfo.fn_addr != NULL;
+		}
+		case COMPRESSION_ALGORITHM_GORILLA:
+			return type == FLOAT4OID || type == FLOAT8OID || type == INT2OID || type == INT4OID ||
+				   type == INT8OID;
+		case COMPRESSION_ALGORITHM_DELTADELTA:
+			if (type == BOOLOID)
+				return true;
+			/* Bitpacking supports the same types as deltadelta except bool. */
+			TS_FALLTHROUGH;
+		case COMPRESSION_ALGORITHM_BITPACKING:
+			return type == INT2OID || type == INT4OID || type == INT8OID || type == DATEOID ||
+				   type == TIMESTAMPOID || type == TIMESTAMPTZOID;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Parse a candidate setting with the same parser as the compress_segmentby
+ * and compress_orderby options.
+ */
+static List *
+advisor_parse_setting(CompressHypertableOption option, const char *setting, Hypertable *ht)
+{
+	WithClauseResult parsed_options[CompressOptionMax] = { 0 };
+
+	for (int i = 0; i < CompressOptionMax; i++)
+		parsed_options[i].is_default = true;
+
+	parsed_options[option] = (WithClauseResult){
+		.is_default = false,
+		.parsed = CStringGetTextDatum(setting),
+	};
+
+	if (option == CompressSegmentBy)
+		return ts_compress_hypertable_parse_segment_by(parsed_options, ht);
+
+	return ts_compress_hypertable_parse_order_by(parsed_options, ht);
+}
+
+static bool
+advisor_colname_in_list(List *cols, const char *colname)
+{
+	ListCell *lc;
+
+	foreach (lc, cols)
+	{
+		CompressedParsedCol *col = lfirst(lc);
+		if (namestrcmp(&col->colname, colname) == 0)
+			return true;
+	}
+	return false;
+}
+
+static void
+advisor_candidate_init(AdvisorCandidate *candidate, Relation chunk_rel, Hypertable *ht,
+					   const char *segmentby, const char *orderby, int sample_rows)
+{
+	List *segmentby_cols = advisor_parse_setting(CompressSegmentBy, segmentby, ht);
+	List *orderby_cols = advisor_parse_setting(CompressOrderBy, orderby, ht);
+	const Dimension *time_dim = hyperspace_get_open_dimension(ht->space, 0);
+	const char *time_col_name = get_attname(ht->main_table_relid, time_dim->column_attno, false);
+	ListCell *lc;
+	int n = 0;
+
+	foreach (lc, orderby_cols)
+	{
+		CompressedParsedCol *col = lfirst(lc);
+		if (advisor_colname_in_list(segmentby_cols, NameStr(col->colname)))
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("cannot use column \"%s\" for both ordering and segmenting",
+							NameStr(col->colname))));
+	}
+
+	/* compress_chunk() orders by time DESC if it is not in the settings */
+	if (!advisor_colname_in_list(segmentby_cols, time_col_name) &&
+		!advisor_colname_in_list(orderby_cols, time_col_name))
+	{
+		CompressedParsedCol *col = palloc(sizeof(*col));
+		*col = (CompressedParsedCol){
+			.index = list_length(orderby_cols),
+			.asc = false,
+			.nullsfirst = true,
+		};
+		namestrcpy(&col->colname, time_col_name);
+		orderby_cols = lappend(orderby_cols, col);
+	}
+
+	*candidate = (AdvisorCandidate){
+		.segmentby = segmentby,
+		.orderby = orderby,
+		.n_segmentby = list_length(segmentby_cols),
+		.n_keys = list_length(segmentby_cols) + list_length(orderby_cols),
+	};
+	candidate->sort_keys = palloc(sizeof(AttrNumber) * candidate->n_keys);
+	candidate->sort_operators = palloc(sizeof(Oid) * candidate->n_keys);
+	candidate->sort_collations = palloc(sizeof(Oid) * candidate->n_keys);
+	candidate->nulls_first = palloc(sizeof(bool) * candidate->n_keys);
+
+	foreach (lc, list_concat(segmentby_cols, orderby_cols))
+	{
+		CompressedParsedCol *col = lfirst(lc);
+		FormData_hypertable_compression column = {
+			.attname = col->colname,
+			.segmentby_column_index = n < candidate->n_segmentby ? n + 1 : 0,
+			.orderby_column_index = n < candidate->n_segmentby ? 0 : n + 1,
+			.orderby_asc = col->asc,
+			.orderby_nullsfirst = col->nullsfirst,
+		};
+
+		if (get_attnum(RelationGetRelid(chunk_rel), NameStr(col->colname)) == InvalidAttrNumber)
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_COLUMN),
+					 errmsg("column \"%s\" does not exist", NameStr(col->colname)),
+					 errhint("The candidate settings must refer to columns of the hypertable.")));
+
+		compress_chunk_populate_sort_info_for_column(RelationGetRelid(chunk_rel),
+													 &column,
+													 &candidate->sort_keys[n],
+													 &candidate->sort_operators[n],
+													 &candidate->sort_collations[n],
+													 &candidate->nulls_first[n]);
+		n++;
+	}
+
+	candidate->sort = tuplesort_begin_heap(RelationGetDescr(chunk_rel),
+										   candidate->n_keys,
+										   candidate->sort_keys,
+										   candidate->sort_operators,
+										   candidate->sort_collations,
+										   candidate->nulls_first,
+										   work_mem,
+										   NULL,
+										   false /*=randomAccess*/);
+	tuplesort_set_bound(candidate->sort, sample_rows);
+}
+
+/*
+ * Hash the segmentby values of a row by their binary representation. Equal
+ * values with different representations only make the sample less exact.
+ */
+static uint32
+advisor_segment_hash(const AdvisorCandidate *candidate, TupleTableSlot *slot)
+{
+	TupleDesc tupdesc = slot->tts_tupleDescriptor;
+	uint32 hash = 0;
+
+	for (int i = 0; i < candidate->n_segmentby; i++)
+	{
+		const AttrNumber attno = candidate->sort_keys[i];
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, AttrNumberGetAttrOffset(attno));
+		bool isnull;
+		Datum value = slot_getattr(slot, attno, &isnull);
+		uint32 value_hash = 0;
+
+		if (!isnull)
+		{
+			if (attr->attbyval)
+				value_hash = hash_bytes((const unsigned char *) &value, sizeof(Datum));
+			else if (attr->attlen == -1)
+			{
+				struct varlena *detoasted = PG_DETOAST_DATUM_PACKED(value);
+				value_hash = hash_bytes((const unsigned char *) VARDATA_ANY(detoasted),
+										VARSIZE_ANY_EXHDR(detoasted));
+			}
+			else if (attr->attlen == -2)
+				value_hash = hash_bytes((const unsigned char *) DatumGetCString(value),
+										strlen(DatumGetCString(value)));
+			else
+				value_hash =
+					hash_bytes((const unsigned char *) DatumGetPointer(value), attr->attlen);
+		}
+
+		hash = hash_combine(hash, value_hash);
+	}
+
+	return hash;
+}
+
+/*
+ * Read the chunk once and feed the sampled rows of each candidate to its
+ * bounded sort.
+ */
+static void
+advisor_sample_chunk(Relation chunk_rel, AdvisorCandidate *candidates, int n_candidates,
+					 int sample_rows)
+{
+	MemoryContext per_tuple_context = AllocSetContextCreate(CurrentMemoryContext,
+															"compression advisor sample",
+															ALLOCSET_DEFAULT_SIZES);
+	TupleTableSlot *slot = table_slot_create(chunk_rel, NULL);
+	TableScanDesc scan = table_beginscan(chunk_rel, GetActiveSnapshot(), 0, NULL);
+	const double reltuples = chunk_rel->rd_rel->reltuples;
+	uint32 threshold = PG_UINT32_MAX;
+
+	/*
+	 * Sample twice the requested number of rows, so that an outdated
+	 * reltuples or a skewed distribution of the segment sizes still give
+	 * enough rows. The bound of the sort limits the sample.
+	 */
+	if (reltuples > 2.0 * sample_rows)
+		threshold = (uint32) (PG_UINT32_MAX * (2.0 * sample_rows / reltuples));
+
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		MemoryContext old_context = MemoryContextSwitchTo(per_tuple_context);
+
+		CHECK_FOR_INTERRUPTS();
+
+		for (int i = 0; i < n_candidates; i++)
+		{
+			AdvisorCandidate *candidate = &candidates[i];
+
+			if (candidate->n_segmentby > 0 && advisor_segment_hash(candidate, slot) > threshold)
+				continue;
+
+			tuplesort_puttupleslot(candidate->sort, slot);
+		}
+
+		MemoryContextSwitchTo(old_context);
+		MemoryContextReset(per_tuple_context);
+	}
+
+	table_endscan(scan);
+	ExecDropSingleTupleTableSlot(slot);
+	MemoryContextDelete(per_tuple_context);
+
+	for (int i = 0; i < n_candidates; i++)
+		tuplesort_performsort(candidates[i].sort);
+}
+
+static void
+advisor_columns_init(AdvisorColumn *columns, TupleDesc tupdesc, const AdvisorCandidate *candidate)
+{
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		AdvisorColumn *column = &columns[i];
+
+		*column = (AdvisorColumn){
+			.attno = attr->attnum,
+			.type = attr->atttypid,
+			.typlen = attr->attlen,
+		};
+
+		if (attr->attisdropped)
+			continue;
+
+		for (int key = 0; key < candidate->n_segmentby; key++)
+		{
+			if (candidate->sort_keys[key] == attr->attnum)
+				column->is_segmentby = true;
+		}
+
+		if (column->is_segmentby)
+		{
+			column->segment_info = segment_info_new(attr);
+			continue;
+		}
+
+		for (CompressionAlgorithms algorithm = 1; algorithm < _END_COMPRESSION_ALGORITHMS;
+			 algorithm++)
+		{
+			if (advisor_algorithm_supports_type(algorithm, attr->atttypid))
+				column->algorithms[column->n_algorithms++] = algorithm;
+		}
+	}
+}
+
+/*
+ * Compress the current batch of a column with each of its algorithms, and
+ * measure the time it takes to decompress the result in bulk, or row by row
+ * for the algorithms and types without bulk decompression.
+ */
+static void
+advisor_column_finish_batch(AdvisorColumn *column, MemoryContext batch_context)
+{
+	if (column->is_segmentby)
+	{
+		if (!column->segment_info->is_null)
+			column->segmentby_bytes +=
+				column->typlen > 0 ?
+					column->typlen :
+					(int64) VARSIZE_ANY(DatumGetPointer(column->segment_info->val));
+		return;
+	}
+
+	for (int i = 0; i < column->n_algorithms; i++)
+	{
+		const CompressionAlgorithms algorithm = column->algorithms[i];
+		Compressor *compressor = column->compressors[i];
+		void *compressed;
+		DecompressAllFunction decompress_all;
+		instr_time start;
+		instr_time duration;
+		int64 values = 0;
+
+		if (compressor == NULL)
+			continue;
+
+		column->compressors[i] = NULL;
+		compressed = compressor->finish(compressor);
+
+		/* All the values of the batch were null */
+		if (compressed == NULL)
+			continue;
+
+		column->compressed_bytes[i] += VARSIZE(compressed);
+
+		decompress_all = tsl_get_decompress_all_function(algorithm, column->type);
+		INSTR_TIME_SET_CURRENT(start);
+		if (decompress_all != NULL)
+		{
+			DecompressionArena arena = { .mctx = batch_context };
+			ArrowArray *arrow = decompress_all(PointerGetDatum(compressed), column->type, &arena);
+			values = arrow->length;
+		}
+		else
+		{
+			DecompressionIterator *iter =
+				tsl_get_decompression_iterator_init(algorithm,
+													/* reverse = */ false)(PointerGetDatum(
+																			   compressed),
+																		   column->type);
+			for (DecompressResult r = iter->try_next(iter); !r.is_done; r = iter->try_next(iter))
+				values++;
+		}
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, start);
+
+		column->decompress_seconds[i] += INSTR_TIME_GET_DOUBLE(duration);
+		column->decompressed_values[i] += values;
+	}
+}
+
+static void
+advisor_column_append(AdvisorColumn *column, Datum value, bool isnull)
+{
+	if (!isnull)
+		column->uncompressed_bytes +=
+			column->typlen > 0 ? column->typlen : (int64) VARSIZE_ANY(DatumGetPointer(value));
+
+	for (int i = 0; i < column->n_algorithms; i++)
+	{
+		if (column->compressors[i] == NULL)
+			column->compressors[i] =
+				compressor_for_algorithm_and_type(column->algorithms[i], column->type);
+
+		if (isnull)
+			column->compressors[i]->append_null(column->compressors[i]);
+		else
+			column->compressors[i]->append_val(column->compressors[i], value);
+	}
+}
+
+/*
+ * Split the sorted sample into batches like the row compressor does, on a
+ * change of the segmentby values or when the batch is full, and compress
+ * them.
+ */
+static void
+advisor_evaluate_candidate(AdvisorCandidate *candidate, TupleDesc tupdesc, AdvisorColumn *columns)
+{
+	MemoryContext batch_context = AllocSetContextCreate(CurrentMemoryContext,
+														"compression advisor batch",
+														ALLOCSET_DEFAULT_SIZES);
+	MemoryContext old_context = CurrentMemoryContext;
+	TupleTableSlot *slot = MakeSingleTupleTableSlot(tupdesc, &TTSOpsMinimalTuple);
+	int rows_in_batch = 0;
+
+	while (tuplesort_gettupleslot(candidate->sort,
+								  true /*=forward*/,
+								  false /*=copy*/,
+								  slot,
+								  NULL /*=abbrev*/))
+	{
+		bool new_batch = rows_in_batch >= ts_guc_compression_batch_rows;
+
+		CHECK_FOR_INTERRUPTS();
+		slot_getallattrs(slot);
+
+		for (int i = 0; i < tupdesc->natts && !new_batch && rows_in_batch > 0; i++)
+		{
+			if (columns[i].is_segmentby &&
+				!segment_info_datum_is_in_group(columns[i].segment_info,
+												slot->tts_values[i],
+												slot->tts_isnull[i]))
+				new_batch = true;
+		}
+
+		MemoryContextSwitchTo(batch_context);
+
+		if (new_batch)
+		{
+			for (int i = 0; i < tupdesc->natts; i++)
+				advisor_column_finish_batch(&columns[i], batch_context);
+			candidate->batches++;
+			rows_in_batch = 0;
+			MemoryContextReset(batch_context);
+		}
+
+		for (int i = 0; i < tupdesc->natts; i++)
+		{
+			if (TupleDescAttr(tupdesc, i)->attisdropped)
+				continue;
+
+			if (columns[i].is_segmentby)
+			{
+				if (rows_in_batch == 0)
+					segment_info_update(columns[i].segment_info,
+										slot->tts_values[i],
+										slot->tts_isnull[i]);
+				if (!slot->tts_isnull[i])
+					columns[i].uncompressed_bytes +=
+						columns[i].typlen > 0 ?
+							columns[i].typlen :
+							(int64) VARSIZE_ANY(DatumGetPointer(slot->tts_values[i]));
+			}
+			else
+				advisor_column_append(&columns[i], slot->tts_values[i], slot->tts_isnull[i]);
+		}
+
+		MemoryContextSwitchTo(old_context);
+		rows_in_batch++;
+		candidate->sampled_rows++;
+	}
+
+	if (rows_in_batch > 0)
+	{
+		MemoryContextSwitchTo(batch_context);
+		for (int i = 0; i < tupdesc->natts; i++)
+			advisor_column_finish_batch(&columns[i], batch_context);
+		MemoryContextSwitchTo(old_context);
+		candidate->batches++;
+	}
+
+	ExecDropSingleTupleTableSlot(slot);
+	tuplesort_end(candidate->sort);
+	candidate->sort = NULL;
+	MemoryContextDelete(batch_context);
+}
+
+/*
+ * The current settings of the hypertable in the format of the
+ * compress_segmentby and compress_orderby options, or empty strings if
+ * compression is not configured.
+ */
+static void
+advisor_current_settings(Hypertable *ht, char **segmentby, char **orderby)
+{
+	List *settings = ts_hypertable_compression_get(ht->fd.id);
+	StringInfoData segmentby_buf;
+	StringInfoData orderby_buf;
+	int n_segmentby = 0;
+	int n_orderby = 0;
+	ListCell *lc;
+
+	initStringInfo(&segmentby_buf);
+	initStringInfo(&orderby_buf);
+
+	/* The segmentby and orderby columns in their configured order */
+	for (int index = 1; index <= list_length(settings); index++)
+	{
+		foreach (lc, settings)
+		{
+			FormData_hypertable_compression *fd = lfirst(lc);
+
+			if (fd->segmentby_column_index == index)
+				appendStringInfo(&segmentby_buf,
+								 "%s%s",
+								 n_segmentby++ > 0 ? ", " : "",
+								 quote_identifier(NameStr(fd->attname)));
+
+			if (fd->orderby_column_index == index)
+				appendStringInfo(&orderby_buf,
+								 "%s%s %s NULLS %s",
+								 n_orderby++ > 0 ? ", " : "",
+								 quote_identifier(NameStr(fd->attname)),
+								 fd->orderby_asc ? "ASC" : "DESC",
+								 fd->orderby_nullsfirst ? "FIRST" : "LAST");
+		}
+	}
+
+	*segmentby = segmentby_buf.data;
+	*orderby = orderby_buf.data;
+}
+
+static List *
+advisor_text_array_to_list(ArrayType *array)
+{
+	Datum *elements;
+	bool *nulls;
+	int n;
+	List *result = NIL;
+
+	deconstruct_array(array, TEXTOID, -1, false, TYPALIGN_INT, &elements, &nulls, &n);
+
+	for (int i = 0; i < n; i++)
+		result = lappend(result, nulls[i] ? "" : TextDatumGetCString(elements[i]));
+
+	return result;
+}
+
+/*
+ * Estimate the compression of a chunk for the combinations of the candidate
+ * segmentby and orderby settings. Returns a row for each column of each
+ * combination and each algorithm that supports the type of the column, with
+ * the sizes of the sampled rows before and after compression, and the bulk
+ * decompression time per value.
+ *
+ * The candidates default to the current settings of the hypertable.
+ */
+Datum
+tsl_compression_advisor(PG_FUNCTION_ARGS)
+{
+	/* Output columns of this function. */
+	enum
+	{
+		out_segmentby = 0,
+		out_orderby,
+		out_column_name,
+		out_algorithm,
+		out_is_default,
+		out_sampled_rows,
+		out_batches,
+		out_uncompressed_bytes,
+		out_compressed_bytes,
+		out_compression_ratio,
+		out_decompress_ns_per_value,
+		_out_columns
+	};
+
+	FuncCallContext *funcctx;
+	List *results;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		Oid chunk_relid = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+		const int sample_rows = PG_ARGISNULL(3) ? 0 : PG_GETARG_INT32(3);
+		MemoryContext call_memory_context;
+		TupleDesc result_desc;
+		Cache *hcache;
+		Hypertable *ht;
+		Chunk *chunk;
+		Relation chunk_rel;
+		TupleDesc tupdesc;
+		char *current_segmentby;
+		char *current_orderby;
+		List *segmentby_candidates;
+		List *orderby_candidates;
+		AdvisorCandidate *candidates;
+		AdvisorColumn *columns;
+		int n_candidates;
+		int n = 0;
+		ListCell *lc_segmentby;
+		ListCell *lc_orderby;
+
+		ts_feature_flag_check(FEATURE_HYPERTABLE_COMPRESSION);
+
+		if (sample_rows <= 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("the number of sampled rows must be positive")));
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		call_memory_context = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &result_desc) != TYPEFUNC_COMPOSITE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("function returning record called in context "
+							"that cannot accept type record")));
+		result_desc = BlessTupleDesc(result_desc);
+
+		/* The estimation itself doesn't need to survive across calls */
+		MemoryContextSwitchTo(call_memory_context);
+
+		chunk = ts_chunk_get_by_relid(chunk_relid, true);
+		if (chunk->relkind == RELKIND_FOREIGN_TABLE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("compression advisor is not supported for chunks of distributed "
+							"hypertables")));
+
+		ht = ts_hypertable_cache_get_cache_and_entry(chunk->hypertable_relid,
+													 CACHE_FLAG_NONE,
+													 &hcache);
+		ts_hypertable_permissions_check(ht->main_table_relid, GetUserId());
+
+		advisor_current_settings(ht, &current_segmentby, &current_orderby);
+		segmentby_candidates = PG_ARGISNULL(1) ?
+								   list_make1(current_segmentby) :
+								   advisor_text_array_to_list(PG_GETARG_ARRAYTYPE_P(1));
+		orderby_candidates = PG_ARGISNULL(2) ?
+								 list_make1(current_orderby) :
+								 advisor_text_array_to_list(PG_GETARG_ARRAYTYPE_P(2));
+		n_candidates = list_length(segmentby_candidates) * list_length(orderby_candidates);
+
+		if (n_candidates == 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("no candidate settings given")));
+
+		chunk_rel = table_open(chunk->table_id, AccessShareLock);
+		tupdesc = RelationGetDescr(chunk_rel);
+
+		candidates = palloc(sizeof(AdvisorCandidate) * n_candidates);
+		foreach (lc_segmentby, segmentby_candidates)
+		{
+			foreach (lc_orderby, orderby_candidates)
+			{
+				advisor_candidate_init(&candidates[n++],
+									   chunk_rel,
+									   ht,
+									   lfirst(lc_segmentby),
+									   lfirst(lc_orderby),
+									   sample_rows);
+			}
+		}
+
+		advisor_sample_chunk(chunk_rel, candidates, n_candidates, sample_rows);
+
+		results = NIL;
+		columns = palloc(sizeof(AdvisorColumn) * tupdesc->natts);
+		for (int c = 0; c < n_candidates; c++)
+		{
+			AdvisorCandidate *candidate = &candidates[c];
+
+			advisor_columns_init(columns, tupdesc, candidate);
+			advisor_evaluate_candidate(candidate, tupdesc, columns);
+
+			if (candidate->sampled_rows == 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+						 errmsg("chunk \"%s\" has no uncompressed rows to sample",
+								get_rel_name(chunk->table_id)),
+						 errhint("Decompress the chunk to estimate its compression.")));
+
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+			for (int i = 0; i < tupdesc->natts; i++)
+			{
+				const AdvisorColumn *column = &columns[i];
+				Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+				CompressionAlgorithms default_algorithm;
+				Datum values[_out_columns] = { 0 };
+				bool nulls[_out_columns] = { 0 };
+
+				if (attr->attisdropped)
+					continue;
+
+				default_algorithm = get_default_algorithm_id(column->type);
+
+				values[out_segmentby] = CStringGetTextDatum(candidate->segmentby);
+				values[out_orderby] = CStringGetTextDatum(candidate->orderby);
+				values[out_column_name] = NameGetDatum(&attr->attname);
+				values[out_sampled_rows] = Int64GetDatum(candidate->sampled_rows);
+				values[out_batches] = Int64GetDatum(candidate->batches);
+				values[out_uncompressed_bytes] = Int64GetDatum(column->uncompressed_bytes);
+
+				if (column->is_segmentby)
+				{
+					values[out_algorithm] = CStringGetTextDatum("segmentby");
+					values[out_is_default] = BoolGetDatum(true);
+					values[out_compressed_bytes] = Int64GetDatum(column->segmentby_bytes);
+					values[out_compression_ratio] = Float8GetDatum(
+						column->segmentby_bytes > 0 ?
+							(double) column->uncompressed_bytes / column->segmentby_bytes :
+							0);
+					nulls[out_decompress_ns_per_value] = true;
+					results = lappend(results, heap_form_tuple(result_desc, values, nulls));
+					continue;
+				}
+
+				for (int a = 0; a < column->n_algorithms; a++)
+				{
+					values[out_algorithm] =
+						CStringGetTextDatum(advisor_algorithm_names[column->algorithms[a]]);
+					values[out_is_default] =
+						BoolGetDatum(column->algorithms[a] == default_algorithm);
+					values[out_compressed_bytes] = Int64GetDatum(column->compressed_bytes[a]);
+					values[out_compression_ratio] = Float8GetDatum(
+						column->compressed_bytes[a] > 0 ?
+							(double) column->uncompressed_bytes / column->compressed_bytes[a] :
+							0);
+					values[out_decompress_ns_per_value] = Float8GetDatum(
+						column->decompressed_values[a] > 0 ?
+							column->decompress_seconds[a] * 1e9 / column->decompressed_values[a] :
+							0);
+					results = lappend(results, heap_form_tuple(result_desc, values, nulls));
+				}
+			}
+			MemoryContextSwitchTo(call_memory_context);
+		}
+
+		table_close(chunk_rel, AccessShareLock);
+		ts_cache_release(hcache);
+
+		funcctx->user_fctx = results;
+		funcctx->max_calls = list_length(results);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	results = funcctx->user_fctx;
+
+	if (funcctx->call_cntr < funcctx->max_calls)
+		SRF_RETURN_NEXT(funcctx,
+						HeapTupleGetDatum((HeapTuple) list_nth(results, funcctx->call_cntr)));
+
+	SRF_RETURN_DONE(funcctx);
+}
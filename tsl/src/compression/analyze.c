@@ -0,0 +1,466 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Column statistics of compressed chunks.
+ *
+ * ANALYZE only samples the uncompressed chunk table, which holds the rows
+ * inserted after the chunk was compressed and usually nothing else, so the
+ * column statistics of a compressed chunk would describe a small and skewed
+ * part of its data. Here we sample the uncompressed chunk table together with
+ * the decompressed rows of a sample of the compressed batches, compute the
+ * statistics with the typanalyze functions of the columns like ANALYZE does,
+ * and store them for the uncompressed chunk table, where the planner looks
+ * for them.
+ *
+ * Decompressing every batch would be as expensive as decompressing the chunk,
+ * so we sample batches first and then rows of the sampled batches. To keep the
+ * rows of the uncompressed chunk table in the same proportion as in the chunk,
+ * each of them is sampled with the fraction of the compressed rows that are in
+ * the sampled batches.
+ */
+#include <postgres.h>
+
+#include <access/heapam.h>
+#include <access/htup_details.h>
+#include <access/table.h>
+#include <access/tableam.h>
+#include <catalog/indexing.h>
+#include <catalog/pg_statistic.h>
+#include <catalog/pg_type.h>
+#include <commands/vacuum.h>
+#include <executor/tuptable.h>
+#include <fmgr.h>
+#include <miscadmin.h>
+#include <utils/array.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/rel.h>
+#include <utils/sampling.h>
+#include <utils/snapmgr.h>
+#include <utils/syscache.h>
+
+#include "compat/compat.h"
+#include "chunk.h"
+#include "compression/analyze.h"
+#include "compression/compression.h"
+#include "compression/create.h"
+#include "ts_catalog/catalog.h"
+
+/*
+ * The number of decompressed rows we aim to sample from each sampled batch,
+ * on average. A batch holds up to 1000 rows.
+ */
+#define ANALYZE_ROWS_PER_SAMPLED_BATCH 10
+
+/*
+ * Reservoir sample of heap tuples, Vitter's algorithm Z like in
+ * acquire_sample_rows().
+ */
+typedef struct TupleReservoir
+{
+	HeapTuple *tuples;
+	int target;
+	int num;
+	double seen;
+	double skip;
+	ReservoirStateData rstate;
+} TupleReservoir;
+
+typedef struct DecompressedRowSample
+{
+	TupleReservoir *reservoir;
+	TupleDesc tupdesc;
+	MemoryContext mcxt;
+} DecompressedRowSample;
+
+static void
+tuple_reservoir_init(TupleReservoir *reservoir, int target)
+{
+	reservoir->tuples = palloc(sizeof(HeapTuple) * target);
+	reservoir->target = target;
+	reservoir->num = 0;
+	reservoir->seen = 0;
+	reservoir->skip = -1;
+	reservoir_init_selection_state(&reservoir->rstate, target);
+}
+
+/*
+ * Advance the reservoir by one tuple. Returns the position that the tuple goes
+ * to, or -1 if it is not sampled. The tuple that was at the position is freed.
+ */
+static int
+tuple_reservoir_next(TupleReservoir *reservoir)
+{
+	int pos = -1;
+
+	if (reservoir->num < reservoir->target)
+		pos = reservoir->num++;
+	else
+	{
+		if (reservoir->skip < 0)
+			reservoir->skip =
+				reservoir_get_next_S(&reservoir->rstate, reservoir->seen, reservoir->target);
+
+		if (reservoir->skip <= 0)
+		{
+			pos = (int) (reservoir->target * sampler_random_fract_compat(&reservoir->rstate));
+			Assert(pos >= 0 && pos < reservoir->target);
+			heap_freetuple(reservoir->tuples[pos]);
+		}
+
+		reservoir->skip -= 1;
+	}
+
+	reservoir->seen += 1;
+	return pos;
+}
+
+static void
+decompressed_row_sample(void *arg, Datum *values, bool *nulls)
+{
+	DecompressedRowSample *sample = arg;
+	int pos = tuple_reservoir_next(sample->reservoir);
+
+	if (pos >= 0)
+	{
+		MemoryContext oldcxt = MemoryContextSwitchTo(sample->mcxt);
+		sample->reservoir->tuples[pos] = heap_form_tuple(sample->tupdesc, values, nulls);
+		MemoryContextSwitchTo(oldcxt);
+	}
+}
+
+/*
+ * Set up the statistics computation of a column, like examine_attribute()
+ * does for ANALYZE. Returns NULL if the column doesn't get statistics.
+ */
+static VacAttrStats *
+analyze_examine_column(Relation rel, int attnum, MemoryContext anl_context)
+{
+	Form_pg_attribute attr = TupleDescAttr(RelationGetDescr(rel), attnum - 1);
+	VacAttrStats *stats;
+	HeapTuple typtuple;
+	bool ok;
+
+	if (attr->attisdropped || attr->attstattarget == 0)
+		return NULL;
+
+	stats = palloc0(sizeof(VacAttrStats));
+	stats->attr = palloc(ATTRIBUTE_FIXED_PART_SIZE);
+	memcpy(stats->attr, attr, ATTRIBUTE_FIXED_PART_SIZE);
+	stats->attrtypid = attr->atttypid;
+	stats->attrtypmod = attr->atttypmod;
+	stats->attrcollid = attr->attcollation;
+
+	typtuple = SearchSysCacheCopy1(TYPEOID, ObjectIdGetDatum(stats->attrtypid));
+	if (!HeapTupleIsValid(typtuple))
+		elog(ERROR, "cache lookup failed for type %u", stats->attrtypid);
+	stats->attrtype = (Form_pg_type) GETSTRUCT(typtuple);
+	stats->anl_context = anl_context;
+	stats->tupattnum = attnum;
+
+	for (int i = 0; i < STATISTIC_NUM_SLOTS; i++)
+	{
+		stats->statypid[i] = stats->attrtypid;
+		stats->statyplen[i] = stats->attrtype->typlen;
+		stats->statypbyval[i] = stats->attrtype->typbyval;
+		stats->statypalign[i] = stats->attrtype->typalign;
+	}
+
+	if (OidIsValid(stats->attrtype->typanalyze))
+		ok = DatumGetBool(OidFunctionCall1(stats->attrtype->typanalyze, PointerGetDatum(stats)));
+	else
+		ok = std_typanalyze(stats);
+
+	if (!ok || stats->compute_stats == NULL || stats->minrows <= 0)
+	{
+		heap_freetuple(typtuple);
+		pfree(stats->attr);
+		pfree(stats);
+		return NULL;
+	}
+
+	return stats;
+}
+
+static Datum
+analyze_fetch_func(VacAttrStatsP stats, int rownum, bool *isNull)
+{
+	return heap_getattr(stats->rows[rownum], stats->tupattnum, stats->tupDesc, isNull);
+}
+
+/*
+ * Write the computed statistics of a column to pg_statistic, like
+ * update_attstats() does for ANALYZE.
+ */
+static void
+analyze_update_column_stats(Oid relid, VacAttrStats *stats)
+{
+	Relation sd = table_open(StatisticRelationId, RowExclusiveLock);
+	Datum values[Natts_pg_statistic] = { 0 };
+	bool nulls[Natts_pg_statistic] = { false };
+	bool replaces[Natts_pg_statistic];
+	HeapTuple oldtup;
+	int i = 0;
+
+	memset(replaces, true, sizeof(replaces));
+
+	values[Anum_pg_statistic_starelid - 1] = ObjectIdGetDatum(relid);
+	values[Anum_pg_statistic_staattnum - 1] = Int16GetDatum(stats->tupattnum);
+	values[Anum_pg_statistic_stainherit - 1] = BoolGetDatum(false);
+	values[Anum_pg_statistic_stanullfrac - 1] = Float4GetDatum(stats->stanullfrac);
+	values[Anum_pg_statistic_stawidth - 1] = Int32GetDatum(stats->stawidth);
+	values[Anum_pg_statistic_stadistinct - 1] = Float4GetDatum(stats->stadistinct);
+
+	for (int k = 0; k < STATISTIC_NUM_SLOTS; k++)
+	{
+		values[Anum_pg_statistic_stakind1 - 1 + k] = Int16GetDatum(stats->stakind[k]);
+		values[Anum_pg_statistic_staop1 - 1 + k] = ObjectIdGetDatum(stats->staop[k]);
+		values[Anum_pg_statistic_stacoll1 - 1 + k] = ObjectIdGetDatum(stats->stacoll[k]);
+	}
+
+	i = Anum_pg_statistic_stanumbers1 - 1;
+	for (int k = 0; k < STATISTIC_NUM_SLOTS; k++, i++)
+	{
+		int nnum = stats->numnumbers[k];
+
+		if (nnum > 0)
+		{
+			Datum *numdatums = palloc(nnum * sizeof(Datum));
+
+			for (int n = 0; n < nnum; n++)
+				numdatums[n] = Float4GetDatum(stats->stanumbers[k][n]);
+			values[i] =
+				PointerGetDatum(construct_array(numdatums, nnum, FLOAT4OID, sizeof(float4), true,
+												TYPALIGN_INT));
+		}
+		else
+			nulls[i] = true;
+	}
+
+	i = Anum_pg_statistic_stavalues1 - 1;
+	for (int k = 0; k < STATISTIC_NUM_SLOTS; k++, i++)
+	{
+		if (stats->numvalues[k] > 0)
+			values[i] = PointerGetDatum(construct_array(stats->stavalues[k],
+														stats->numvalues[k],
+														stats->statypid[k],
+														stats->statyplen[k],
+														stats->statypbyval[k],
+														stats->statypalign[k]));
+		else
+			nulls[i] = true;
+	}
+
+	oldtup = SearchSysCache3(STATRELATTINH,
+							 ObjectIdGetDatum(relid),
+							 Int16GetDatum(stats->tupattnum),
+							 BoolGetDatum(false));
+
+	if (HeapTupleIsValid(oldtup))
+	{
+		HeapTuple stup = heap_modify_tuple(oldtup, RelationGetDescr(sd), values, nulls, replaces);
+
+		ReleaseSysCache(oldtup);
+		CatalogTupleUpdate(sd, &stup->t_self, stup);
+		heap_freetuple(stup);
+	}
+	else
+	{
+		HeapTuple stup = heap_form_tuple(RelationGetDescr(sd), values, nulls);
+
+		CatalogTupleInsert(sd, stup);
+		heap_freetuple(stup);
+	}
+
+	table_close(sd, RowExclusiveLock);
+}
+
+/*
+ * Compute the column statistics of a compressed chunk from the rows of the
+ * uncompressed chunk table and a sample of the compressed data. Called after
+ * ANALYZE has processed the chunk, to overwrite the statistics it computed
+ * from the uncompressed chunk table alone.
+ */
+void
+tsl_analyze_compressed_chunk(Oid chunk_relid)
+{
+	Chunk *chunk = ts_chunk_get_by_relid(chunk_relid, false);
+	Chunk *compressed_chunk;
+	Relation chunk_rel;
+	Relation compressed_rel;
+	TupleDesc chunk_desc;
+	TupleDesc compressed_desc;
+	MemoryContext anl_context;
+	MemoryContext oldcxt;
+	VacAttrStats **vacattrstats;
+	int attr_cnt = 0;
+	int targrows = 0;
+	AttrNumber count_attno;
+	TupleReservoir batches;
+	TupleReservoir rows;
+	TupleTableSlot *slot;
+	TableScanDesc scan;
+	double total_compressed_rows = 0;
+	double sampled_compressed_rows = 0;
+	double heap_rows = 0;
+	double heap_fraction;
+	double totalrows;
+
+	if (chunk == NULL || chunk->fd.compressed_chunk_id == INVALID_CHUNK_ID)
+		return;
+
+	/* ANALYZE has already warned about the chunks the user can't analyze */
+	if (!object_ownercheck(RelationRelationId, chunk_relid, GetUserId()))
+		return;
+
+	compressed_chunk = ts_chunk_get_by_id(chunk->fd.compressed_chunk_id, false);
+	if (compressed_chunk == NULL)
+		return;
+
+	chunk_rel = table_open(chunk_relid, ShareUpdateExclusiveLock);
+	compressed_rel = table_open(compressed_chunk->table_id, AccessShareLock);
+	chunk_desc = RelationGetDescr(chunk_rel);
+	compressed_desc = RelationGetDescr(compressed_rel);
+
+	count_attno = get_attnum(compressed_chunk->table_id, COMPRESSION_COLUMN_METADATA_COUNT_NAME);
+	Assert(count_attno != InvalidAttrNumber);
+
+	anl_context = AllocSetContextCreate(CurrentMemoryContext,
+										"compressed chunk analyze",
+										ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(anl_context);
+	PushActiveSnapshot(GetTransactionSnapshot());
+
+	vacattrstats = palloc(sizeof(VacAttrStats *) * chunk_desc->natts);
+	for (int attnum = 1; attnum <= chunk_desc->natts; attnum++)
+	{
+		VacAttrStats *stats = analyze_examine_column(chunk_rel, attnum, anl_context);
+
+		if (stats == NULL)
+			continue;
+
+		vacattrstats[attr_cnt++] = stats;
+		targrows = Max(targrows, stats->minrows);
+	}
+
+	if (attr_cnt == 0)
+		goto done;
+
+	/* Sample the compressed batches and count the compressed rows */
+	tuple_reservoir_init(&batches, Max(targrows / ANALYZE_ROWS_PER_SAMPLED_BATCH, 1));
+	slot = table_slot_create(compressed_rel, NULL);
+	scan = table_beginscan(compressed_rel, GetActiveSnapshot(), 0, NULL);
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		bool isnull;
+		Datum count = slot_getattr(slot, count_attno, &isnull);
+		int pos;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (!isnull)
+			total_compressed_rows += DatumGetInt32(count);
+
+		pos = tuple_reservoir_next(&batches);
+		if (pos >= 0)
+			batches.tuples[pos] = ExecCopySlotHeapTuple(slot);
+	}
+	table_endscan(scan);
+	ExecDropSingleTupleTableSlot(slot);
+
+	/* The statistics ANALYZE computed are right if nothing is compressed */
+	if (total_compressed_rows == 0)
+		goto done;
+
+	for (int i = 0; i < batches.num; i++)
+	{
+		bool isnull;
+		Datum count = heap_getattr(batches.tuples[i], count_attno, compressed_desc, &isnull);
+
+		if (!isnull)
+			sampled_compressed_rows += DatumGetInt32(count);
+	}
+	heap_fraction = sampled_compressed_rows / total_compressed_rows;
+
+	/* Sample the rows of the uncompressed chunk table */
+	tuple_reservoir_init(&rows, targrows);
+	slot = table_slot_create(chunk_rel, NULL);
+	scan = table_beginscan(chunk_rel, GetActiveSnapshot(), 0, NULL);
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		int pos;
+
+		CHECK_FOR_INTERRUPTS();
+
+		heap_rows += 1;
+		if (heap_fraction < 1.0 && sampler_random_fract_compat(&rows.rstate) >= heap_fraction)
+			continue;
+
+		pos = tuple_reservoir_next(&rows);
+		if (pos >= 0)
+			rows.tuples[pos] = ExecCopySlotHeapTuple(slot);
+	}
+	table_endscan(scan);
+	ExecDropSingleTupleTableSlot(slot);
+
+	/* Sample the decompressed rows of the sampled batches */
+	{
+		RowDecompressor decompressor = build_decompressor(compressed_rel, chunk_rel);
+		DecompressedRowSample sample = {
+			.reservoir = &rows,
+			.tupdesc = chunk_desc,
+			.mcxt = anl_context,
+		};
+
+		for (int i = 0; i < batches.num; i++)
+		{
+			CHECK_FOR_INTERRUPTS();
+
+			heap_deform_tuple(batches.tuples[i],
+							  compressed_desc,
+							  decompressor.compressed_datums,
+							  decompressor.compressed_is_nulls);
+			row_decompressor_decompress_row_to_callback(&decompressor,
+														decompressed_row_sample,
+														&sample);
+		}
+
+		FreeBulkInsertState(decompressor.bistate);
+		MemoryContextDelete(decompressor.per_compressed_row_ctx);
+		ts_catalog_close_indexes(decompressor.indexstate);
+	}
+
+	if (rows.num == 0)
+		goto done;
+
+	totalrows = heap_rows + total_compressed_rows;
+
+	for (int i = 0; i < attr_cnt; i++)
+	{
+		VacAttrStats *stats = vacattrstats[i];
+
+		stats->rows = rows.tuples;
+		stats->tupDesc = chunk_desc;
+		stats->compute_stats(stats, analyze_fetch_func, rows.num, totalrows);
+
+		if (stats->stats_valid)
+			analyze_update_column_stats(chunk_relid, stats);
+	}
+
+	elog(DEBUG1,
+		 "computed statistics of compressed chunk \"%s\" from %d of %.0f rows",
+		 get_rel_name(chunk_relid),
+		 rows.num,
+		 totalrows);
+
+done:
+	PopActiveSnapshot();
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextDelete(anl_context);
+	table_close(compressed_rel, AccessShareLock);
+	table_close(chunk_rel, NoLock);
+}
@@ -0,0 +1,13 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_TSL_COMPRESSION_ANALYZE_H
+#define TIMESCALEDB_TSL_COMPRESSION_ANALYZE_H
+
+#include <postgres.h>
+
+extern void tsl_analyze_compressed_chunk(Oid chunk_relid);
+
+#endif /* TIMESCALEDB_TSL_COMPRESSION_ANALYZE_H */
@@ -8,6 +8,7 @@
  *  compress and decompress chunks
  */
 #include <postgres.h>
+#include <access/tableam.h>
 #include <access/xact.h>
 #include <catalog/dependency.h>
 #include <commands/tablecmds.h>
@@ -17,14 +18,20 @@
 #include <nodes/pg_list.h>
 #include <nodes/parsenodes.h>
 #include <parser/parse_func.h>
+#include <storage/bufmgr.h>
 #include <storage/lmgr.h>
 #include <trigger.h>
 #include <utils/builtins.h>
+#include <utils/datum.h>
 #include <utils/elog.h>
 #include <utils/fmgrprotos.h>
 #include <libpq-fe.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
 #include <utils/snapmgr.h>
 #include <utils/inval.h>
+#include <utils/tuplestore.h>
+#include <utils/typcache.h>
 
 #include <remote/dist_commands.h>
 #include "compat/compat.h"
@@ -39,6 +46,7 @@
 #include "ts_catalog/continuous_agg.h"
 #include "ts_catalog/hypertable_compression.h"
 #include "ts_catalog/compression_chunk_size.h"
+#include "ts_catalog/chunk_column_stats.h"
 #include "create.h"
 #include "api.h"
 #include "compression.h"
@@ -480,12 +488,18 @@ compress_chunk_impl(Oid hypertable_relid, Oid chunk_relid)
 		/* create compressed chunk and a new table */
 		compress_ht_chunk = create_compress_chunk(cxt.compress_ht, cxt.srcht_chunk, InvalidOid);
 		new_compressed_chunk = true;
+
+		/* The data can't change any more, so the ranges of the chunk stay valid */
+		ts_chunk_column_stats_calculate(cxt.srcht, cxt.srcht_chunk);
 	}
 	else
 	{
 		/* use an existing compressed chunk to compress into */
 		compress_ht_chunk = ts_chunk_get_by_id(mergable_chunk->fd.compressed_chunk_id, true);
 		result_chunk_id = mergable_chunk->table_id;
+
+		/* The merged data can be outside of the ranges of the chunk */
+		ts_chunk_column_stats_set_invalid(mergable_chunk);
 	}
 	/* convert list to array of pointers for compress_chunk */
 	colinfo_array = palloc(sizeof(ColumnCompressionInfo *) * htcols_listlen);
@@ -555,6 +569,114 @@ compress_chunk_impl(Oid hypertable_relid, Oid chunk_relid)
 	return result_chunk_id;
 }
 
+/*
+ * Read the uncompressed sizes and the row counts of a compressed chunk from
+ * the compression_chunk_size catalog table.
+ */
+static bool
+compression_chunk_size_catalog_get(int32 chunk_id, RelationSize *size,
+								   int64 *rowcnt_pre_compression, int64 *rowcnt_post_compression)
+{
+	ScanIterator iterator =
+		ts_scan_iterator_create(COMPRESSION_CHUNK_SIZE, AccessShareLock, CurrentMemoryContext);
+	bool found = false;
+
+	iterator.ctx.index =
+		catalog_get_index(ts_catalog_get(), COMPRESSION_CHUNK_SIZE, COMPRESSION_CHUNK_SIZE_PKEY);
+	ts_scan_iterator_scan_key_init(&iterator,
+								   Anum_compression_chunk_size_pkey_chunk_id,
+								   BTEqualStrategyNumber,
+								   F_INT4EQ,
+								   Int32GetDatum(chunk_id));
+	ts_scanner_foreach(&iterator)
+	{
+		Datum values[Natts_compression_chunk_size];
+		bool nulls[Natts_compression_chunk_size];
+		bool should_free;
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		HeapTuple tuple = ts_scanner_fetch_heap_tuple(ti, false, &should_free);
+
+		heap_deform_tuple(tuple, ts_scanner_get_tupledesc(ti), values, nulls);
+
+		size->heap_size = DatumGetInt64(
+			values[AttrNumberGetAttrOffset(Anum_compression_chunk_size_uncompressed_heap_size)]);
+		size->toast_size = DatumGetInt64(
+			values[AttrNumberGetAttrOffset(Anum_compression_chunk_size_uncompressed_toast_size)]);
+		size->index_size = DatumGetInt64(
+			values[AttrNumberGetAttrOffset(Anum_compression_chunk_size_uncompressed_index_size)]);
+		*rowcnt_pre_compression = nulls[AttrNumberGetAttrOffset(
+									  Anum_compression_chunk_size_numrows_pre_compression)] ?
+									  0 :
+									  DatumGetInt64(values[AttrNumberGetAttrOffset(
+										  Anum_compression_chunk_size_numrows_pre_compression)]);
+		*rowcnt_post_compression = nulls[AttrNumberGetAttrOffset(
+									   Anum_compression_chunk_size_numrows_post_compression)] ?
+									   0 :
+									   DatumGetInt64(values[AttrNumberGetAttrOffset(
+										   Anum_compression_chunk_size_numrows_post_compression)]);
+
+		if (should_free)
+			heap_freetuple(tuple);
+
+		found = true;
+		break;
+	}
+
+	ts_scan_iterator_end(&iterator);
+	ts_scan_iterator_close(&iterator);
+	return found;
+}
+
+/*
+ * Update the compression metadata of a chunk after merge_chunks() has moved the
+ * compressed data of an adjacent chunk into its compressed chunk.
+ *
+ * The uncompressed sizes and the row counts of the merged chunk are added to
+ * the ones of the chunk. The chunk becomes unordered unless the merged batches,
+ * which got higher sequence numbers, also come later in the compression order.
+ */
+void
+tsl_compression_chunk_merged(const Hypertable *ht, Chunk *chunk, Chunk *merge_chunk)
+{
+	Chunk *compressed_chunk = ts_chunk_get_by_id(chunk->fd.compressed_chunk_id, true);
+	RelationSize merge_size = { 0 };
+	RelationSize compressed_size;
+	int64 rowcnt_pre_compression = 0;
+	int64 rowcnt_post_compression = 0;
+	List *htcols_list = ts_hypertable_compression_get(ht->fd.id);
+	int htcols_listlen = list_length(htcols_list);
+	const ColumnCompressionInfo **colinfo_array;
+	const Dimension *time_dim = hyperspace_get_open_dimension(ht->space, 0);
+	ListCell *lc;
+	int i = 0;
+
+	Assert(time_dim != NULL);
+
+	compression_chunk_size_catalog_get(merge_chunk->fd.id,
+									   &merge_size,
+									   &rowcnt_pre_compression,
+									   &rowcnt_post_compression);
+	compressed_size = ts_relation_size_impl(compressed_chunk->table_id);
+	compression_chunk_size_catalog_update_merged(chunk->fd.id,
+												 &merge_size,
+												 compressed_chunk->fd.id,
+												 &compressed_size,
+												 rowcnt_pre_compression,
+												 rowcnt_post_compression);
+
+	colinfo_array = palloc(sizeof(ColumnCompressionInfo *) * htcols_listlen);
+	foreach (lc, htcols_list)
+		colinfo_array[i++] = lfirst(lc);
+
+	if (ts_chunk_is_unordered(merge_chunk) ||
+		check_is_chunk_order_violated_by_merge(time_dim,
+											   chunk,
+											   merge_chunk,
+											   colinfo_array,
+											   htcols_listlen))
+		ts_chunk_set_unordered(chunk);
+}
+
 static bool
 decompress_chunk_impl(Oid uncompressed_hypertable_relid, Oid uncompressed_chunk_relid,
 					  bool if_compressed)
@@ -818,6 +940,74 @@ tsl_create_compressed_chunk(PG_FUNCTION_ARGS)
 	PG_RETURN_OID(chunk_relid);
 }
 
+/*
+ * Create an empty compressed chunk for an empty chunk that the inserted
+ * tuples are compressed into directly, see compress_tuples_for_insert().
+ * Returns false when this is not possible right now, and the tuples have to
+ * go to the uncompressed chunk.
+ *
+ * The other transactions must not insert into the uncompressed chunk, since
+ * they don't know that it is compressed and would not mark it as partial. So
+ * we take a lock that conflicts with their inserts, but we don't wait for it,
+ * because the concurrent inserts might wait for our lock in turn.
+ */
+bool
+tsl_create_compressed_chunk_for_insert(Chunk *chunk, Relation rel)
+{
+	RelationSize empty_size = { 0 };
+	Chunk *compress_ht_chunk;
+	Hypertable *ht;
+	Hypertable *compress_ht;
+	Cache *hcache;
+
+	if (!ConditionalLockRelationOid(chunk->table_id, ShareRowExclusiveLock))
+		return false;
+
+	/* Another transaction might have compressed or written the chunk meanwhile */
+	chunk = ts_chunk_get_by_relid(chunk->table_id, true);
+	if (chunk->fd.compressed_chunk_id != INVALID_CHUNK_ID ||
+		chunk->fd.status != CHUNK_STATUS_DEFAULT || RelationGetNumberOfBlocks(rel) > 0)
+		return false;
+
+	hcache = ts_hypertable_cache_pin();
+	ht = ts_hypertable_cache_get_entry(hcache, chunk->hypertable_relid, CACHE_FLAG_NONE);
+	compress_ht = TS_HYPERTABLE_HAS_COMPRESSION_TABLE(ht) ?
+					  ts_hypertable_get_by_id(ht->fd.compressed_hypertable_id) :
+					  NULL;
+	if (compress_ht == NULL)
+	{
+		ts_cache_release(hcache);
+		return false;
+	}
+
+	/* The same locks as compress_chunk_impl() takes */
+	LockRelationOid(compress_ht->main_table_relid, AccessShareLock);
+	LockRelationOid(catalog_get_table_id(ts_catalog_get(), HYPERTABLE_COMPRESSION),
+					AccessShareLock);
+	LockRelationOid(catalog_get_table_id(ts_catalog_get(), CHUNK), RowExclusiveLock);
+
+	compress_ht_chunk = create_compress_chunk(compress_ht, chunk, InvalidOid);
+	ts_chunk_constraints_create(compress_ht, compress_ht_chunk);
+	ts_trigger_create_all_on_chunk(compress_ht_chunk);
+	ts_chunk_drop_fks(chunk);
+
+	/* Like tsl_create_compressed_chunk(), start with empty stats */
+	compression_chunk_size_catalog_insert(chunk->fd.id,
+										  &empty_size,
+										  compress_ht_chunk->fd.id,
+										  &empty_size,
+										  0,
+										  0);
+
+	ts_chunk_set_compressed_chunk(chunk, compress_ht_chunk->fd.id);
+	ts_cache_release(hcache);
+
+	/* changed chunk status, so invalidate any plans involving this chunk */
+	CacheInvalidateRelcacheByRelid(chunk->table_id);
+
+	return true;
+}
+
 Datum
 tsl_compress_chunk(PG_FUNCTION_ARGS)
 {
@@ -898,7 +1088,7 @@ bool
 tsl_recompress_chunk_wrapper(Chunk *uncompressed_chunk)
 {
 	Oid uncompressed_chunk_relid = uncompressed_chunk->table_id;
-	if (ts_chunk_is_unordered(uncompressed_chunk))
+	if (ts_chunk_is_unordered(uncompressed_chunk) || ts_chunk_is_partial(uncompressed_chunk))
 	{
 		if (!decompress_chunk_impl(uncompressed_chunk->hypertable_relid,
 								   uncompressed_chunk_relid,
@@ -911,14 +1101,94 @@ tsl_recompress_chunk_wrapper(Chunk *uncompressed_chunk)
 	return true;
 }
 
-/* This is a wrapper around row_compressor_append_sorted_rows. */
+/*
+ * The first orderby column of the chunk. The segmentwise recompression uses
+ * its min/max metadata to find the compressed batches that overlap the new
+ * rows of a segment.
+ */
+typedef struct RecompressOrderby
+{
+	/* InvalidAttrNumber if we have to recompress the entire segment */
+	AttrNumber attno;
+	/* the min/max metadata columns in the compressed chunk */
+	AttrNumber min_attno;
+	AttrNumber max_attno;
+	bool asc;
+	int16 typlen;
+	bool typbyval;
+	Oid collation;
+	FmgrInfo cmp_fn;
+} RecompressOrderby;
+
+/* The new rows of the current segment fetched from the uncompressed chunk. */
+typedef struct RecompressNewRows
+{
+	int64 count;
+	/* the range of the first orderby column, if we use it */
+	Datum min;
+	Datum max;
+} RecompressNewRows;
+
+/* A compressed batch of the current segment. */
+typedef struct RecompressBatch
+{
+	ItemPointerData tid;
+	int32 sequence_num;
+	int32 count;
+	bool minmax_is_null;
+	Datum min;
+	Datum max;
+} RecompressBatch;
+
+typedef struct SegmentRecompression
+{
+	Relation compressed_chunk_rel;
+	Relation uncompressed_chunk_rel;
+	RowDecompressor *decompressor;
+	RowCompressor *row_compressor;
+	Snapshot snapshot;
+	/* used to fetch the compressed batches that we rewrite */
+	TupleTableSlot *batch_slot;
+
+	int n_keys;
+	AttrNumber *sort_keys;
+	Oid *sort_operators;
+	Oid *sort_collations;
+	bool *nulls_first;
+
+	RecompressOrderby orderby;
+	AttrNumber count_attno;
+	AttrNumber sequence_num_attno;
+
+	/* the batches of the current segment, allocated in the segment context */
+	MemoryContext segment_ctx;
+	RecompressBatch *batches;
+	int n_batches;
+	int max_batches;
+
+	/* the batches that we didn't have to rewrite, for the compression statistics */
+	int64 untouched_rows;
+	int64 untouched_batches;
+} SegmentRecompression;
+
+/*
+ * This is a wrapper around row_compressor_append_sorted_rows. The compressed
+ * rows get the sequence numbers starting from first_sequence_num with the
+ * given step, so that they fit between the batches of the segment that we
+ * don't rewrite.
+ */
 static void
 recompress_segment(Tuplesortstate *tuplesortstate, Relation compressed_chunk_rel,
-				   RowCompressor *row_compressor)
+				   RowCompressor *row_compressor, int32 first_sequence_num,
+				   int32 sequence_num_step)
 {
+	row_compressor->first_sequence_num = first_sequence_num;
+	row_compressor->sequence_num_step = sequence_num_step;
 	row_compressor_append_sorted_rows(row_compressor,
 									  tuplesortstate,
 									  RelationGetDescr(compressed_chunk_rel));
+	row_compressor->first_sequence_num = SEQUENCE_NUM_GAP;
+	row_compressor->sequence_num_step = SEQUENCE_NUM_GAP;
 }
 
 static bool
@@ -1084,6 +1354,89 @@ tsl_get_compressed_chunk_index_for_recompression(PG_FUNCTION_ARGS)
 		PG_RETURN_NULL();
 }
 
+static int
+recompress_orderby_compare(const RecompressOrderby *orderby, Datum a, Datum b)
+{
+	return DatumGetInt32(FunctionCall2Coll(&orderby->cmp_fn, orderby->collation, a, b));
+}
+
+static void
+recompress_orderby_init(RecompressOrderby *orderby, const ColumnCompressionInfo **colinfo_array,
+						int n_columns, Relation uncompressed_chunk_rel,
+						Relation compressed_chunk_rel)
+{
+	*orderby = (RecompressOrderby){ .attno = InvalidAttrNumber };
+
+	for (int i = 0; i < n_columns; i++)
+	{
+		const ColumnCompressionInfo *fd = colinfo_array[i];
+		if (fd->orderby_column_index != 1)
+			continue;
+
+		AttrNumber attno =
+			get_attnum(RelationGetRelid(uncompressed_chunk_rel), NameStr(fd->attname));
+		Ensure(attno != InvalidAttrNumber, "orderby column \"%s\" not found", NameStr(fd->attname));
+		Form_pg_attribute attr =
+			TupleDescAttr(RelationGetDescr(uncompressed_chunk_rel), AttrNumberGetAttrOffset(attno));
+
+		/*
+		 * The min/max metadata doesn't tell where the NULLs are in the batch,
+		 * so we can only find the overlapping batches for a NOT NULL column.
+		 */
+		if (!attr->attnotnull)
+			return;
+
+		TypeCacheEntry *tce = lookup_type_cache(attr->atttypid, TYPECACHE_CMP_PROC_FINFO);
+		if (!OidIsValid(tce->cmp_proc_finfo.fn_oid))
+			return;
+
+		Oid compressed_relid = RelationGetRelid(compressed_chunk_rel);
+		AttrNumber min_attno =
+			get_attnum(compressed_relid, compression_column_segment_min_name(fd));
+		AttrNumber max_attno =
+			get_attnum(compressed_relid, compression_column_segment_max_name(fd));
+		if (min_attno == InvalidAttrNumber || max_attno == InvalidAttrNumber)
+			return;
+
+		orderby->attno = attno;
+		orderby->min_attno = min_attno;
+		orderby->max_attno = max_attno;
+		orderby->asc = fd->orderby_asc;
+		orderby->typlen = attr->attlen;
+		orderby->typbyval = attr->attbyval;
+		orderby->collation = attr->attcollation;
+		fmgr_info_copy(&orderby->cmp_fn, &tce->cmp_proc_finfo, CurrentMemoryContext);
+		return;
+	}
+}
+
+static void
+recompress_new_rows_update(RecompressNewRows *new_rows, const RecompressOrderby *orderby,
+						   TupleTableSlot *slot, MemoryContext mctx)
+{
+	new_rows->count++;
+
+	if (orderby->attno == InvalidAttrNumber)
+		return;
+
+	bool is_null;
+	Datum val = slot_getattr(slot, orderby->attno, &is_null);
+	Assert(!is_null);
+
+	const bool first_row = new_rows->count == 1;
+	const bool new_min = first_row || recompress_orderby_compare(orderby, val, new_rows->min) < 0;
+	const bool new_max = first_row || recompress_orderby_compare(orderby, val, new_rows->max) > 0;
+	if (!new_min && !new_max)
+		return;
+
+	MemoryContext old_ctx = MemoryContextSwitchTo(mctx);
+	if (new_min)
+		new_rows->min = datumCopy(val, orderby->typbyval, orderby->typlen);
+	if (new_max)
+		new_rows->max = datumCopy(val, orderby->typbyval, orderby->typlen);
+	MemoryContextSwitchTo(old_ctx);
+}
+
 /*
  * This function fetches the remaining uncompressed chunk rows into
  * the tuplesort for recompression.
@@ -1120,12 +1473,17 @@ fetch_unmatched_uncompressed_chunk_into_tuplesort(Tuplesortstate *segment_tuples
 	table_endscan(heapScan);
 }
 
+/*
+ * Move the uncompressed chunk rows that belong to the current segment into the
+ * tuplestore, and compute the range of their first orderby column.
+ */
 static void
-fetch_matching_uncompressed_chunk_into_tuplesort(Tuplesortstate *segment_tuplesortstate,
-												 int nsegmentby_cols,
-												 Relation uncompressed_chunk_rel,
-												 CompressedSegmentInfo **current_segment)
+fetch_matching_uncompressed_chunk_rows(SegmentRecompression *rc, Tuplestorestate *new_rows_store,
+									   int nsegmentby_cols,
+									   CompressedSegmentInfo **current_segment,
+									   RecompressNewRows *new_rows)
 {
+	Relation uncompressed_chunk_rel = rc->uncompressed_chunk_rel;
 	TableScanDesc heapScan;
 	HeapTuple uncompressed_tuple;
 	TupleDesc uncompressed_rel_tupdesc = RelationGetDescr(uncompressed_chunk_rel);
@@ -1192,7 +1550,8 @@ fetch_matching_uncompressed_chunk_into_tuplesort(Tuplesortstate *segment_tupleso
 		{
 			ExecStoreHeapTuple(uncompressed_tuple, heap_tuple_slot, false);
 			slot_getallattrs(heap_tuple_slot);
-			tuplesort_puttupleslot(segment_tuplesortstate, heap_tuple_slot);
+			recompress_new_rows_update(new_rows, &rc->orderby, heap_tuple_slot, rc->segment_ctx);
+			tuplestore_puttupleslot(new_rows_store, heap_tuple_slot);
 			/* simple_heap_delete since we don't expect concurrent updates, have exclusive lock on
 			 * the relation */
 			simple_heap_delete(uncompressed_chunk_rel, &uncompressed_tuple->t_self);
@@ -1208,6 +1567,264 @@ fetch_matching_uncompressed_chunk_into_tuplesort(Tuplesortstate *segment_tupleso
 		pfree(scankey);
 }
 
+static Tuplesortstate *
+segment_recompression_begin_sort(SegmentRecompression *rc)
+{
+	return tuplesort_begin_heap(RelationGetDescr(rc->uncompressed_chunk_rel),
+								rc->n_keys,
+								rc->sort_keys,
+								rc->sort_operators,
+								rc->sort_collations,
+								rc->nulls_first,
+								maintenance_work_mem,
+								NULL,
+								false);
+}
+
+/* Remember the compressed batch of the current segment we got from the index scan. */
+static void
+segment_recompression_add_batch(SegmentRecompression *rc, TupleTableSlot *slot)
+{
+	MemoryContext old_ctx = MemoryContextSwitchTo(rc->segment_ctx);
+	bool is_null;
+
+	if (rc->n_batches == rc->max_batches)
+	{
+		rc->max_batches = rc->max_batches == 0 ? 16 : rc->max_batches * 2;
+		if (rc->batches == NULL)
+			rc->batches = palloc(sizeof(*rc->batches) * rc->max_batches);
+		else
+			rc->batches = repalloc(rc->batches, sizeof(*rc->batches) * rc->max_batches);
+	}
+
+	RecompressBatch *batch = &rc->batches[rc->n_batches++];
+	batch->tid = slot->tts_tid;
+	batch->count = DatumGetInt32(slot_getattr(slot, rc->count_attno, &is_null));
+	Assert(!is_null);
+	batch->sequence_num = DatumGetInt32(slot_getattr(slot, rc->sequence_num_attno, &is_null));
+	Assert(!is_null);
+
+	batch->minmax_is_null = true;
+	if (rc->orderby.attno != InvalidAttrNumber)
+	{
+		bool min_is_null, max_is_null;
+		Datum min = slot_getattr(slot, rc->orderby.min_attno, &min_is_null);
+		Datum max = slot_getattr(slot, rc->orderby.max_attno, &max_is_null);
+		batch->minmax_is_null = min_is_null || max_is_null;
+		if (!batch->minmax_is_null)
+		{
+			batch->min = datumCopy(min, rc->orderby.typbyval, rc->orderby.typlen);
+			batch->max = datumCopy(max, rc->orderby.typbyval, rc->orderby.typlen);
+		}
+	}
+
+	MemoryContextSwitchTo(old_ctx);
+}
+
+/*
+ * Find the batches of the current segment that we have to rewrite to merge
+ * the new rows into them, as the range [*first_batch, *end_batch). The batches
+ * are ordered by the sequence number, which follows the orderby, so the new
+ * compressed rows must get the sequence numbers between the batches that
+ * precede and follow this range.
+ *
+ * The batches overlapping the range of the first orderby column of the new
+ * rows must be rewritten. If there are none, we merge the new rows into an
+ * adjacent batch if it is not full, to avoid creating small batches for every
+ * few late rows. If we can't tell which batches are affected, or the sequence
+ * numbers don't leave enough room for the new compressed rows, we fall back to
+ * rewriting the entire segment.
+ */
+static void
+segment_recompression_find_batches(SegmentRecompression *rc, const RecompressNewRows *new_rows,
+								   int *first_batch, int *end_batch, int32 *first_sequence_num,
+								   int32 *sequence_num_step)
+{
+	const RecompressOrderby *orderby = &rc->orderby;
+	const int n_batches = rc->n_batches;
+	const uint32 max_rows = rc->row_compressor->max_rows_per_compression;
+
+	*first_batch = 0;
+	*end_batch = n_batches;
+	*first_sequence_num = SEQUENCE_NUM_GAP;
+	*sequence_num_step = SEQUENCE_NUM_GAP;
+
+	if (orderby->attno == InvalidAttrNumber)
+		return;
+
+	int n_before = 0;
+	int n_after = 0;
+	for (int i = 0; i < n_batches; i++)
+	{
+		const RecompressBatch *batch = &rc->batches[i];
+		if (batch->minmax_is_null)
+			return;
+
+		bool before, after;
+		if (orderby->asc)
+		{
+			before = recompress_orderby_compare(orderby, batch->max, new_rows->min) < 0;
+			after = recompress_orderby_compare(orderby, batch->min, new_rows->max) > 0;
+		}
+		else
+		{
+			before = recompress_orderby_compare(orderby, batch->min, new_rows->max) > 0;
+			after = recompress_orderby_compare(orderby, batch->max, new_rows->min) < 0;
+		}
+
+		if (before)
+		{
+			/* The preceding batches must come first, otherwise the batches overlap. */
+			if (i != n_before)
+				return;
+			n_before++;
+		}
+		else if (after)
+			n_after++;
+		else if (n_after > 0)
+			return;
+	}
+
+	int first = n_before;
+	int end = n_batches - n_after;
+	if (first == end)
+	{
+		if (first > 0 && (uint32) rc->batches[first - 1].count < max_rows)
+			first--;
+		else if (end < n_batches && (uint32) rc->batches[end].count < max_rows)
+			end++;
+	}
+
+	int64 total_rows = new_rows->count;
+	for (int i = first; i < end; i++)
+		total_rows += rc->batches[i].count;
+	const int64 n_compressed_rows = (total_rows + max_rows - 1) / max_rows;
+
+	const int64 lower = first > 0 ? rc->batches[first - 1].sequence_num : 0;
+	int64 step = SEQUENCE_NUM_GAP;
+	if (end < n_batches)
+	{
+		const int64 upper = rc->batches[end].sequence_num;
+		step = Min(step, (upper - lower) / (n_compressed_rows + 1));
+		if (step < 1)
+			return;
+	}
+	else if (lower + step * n_compressed_rows > PG_INT32_MAX)
+		return;
+
+	*first_batch = first;
+	*end_batch = end;
+	*first_sequence_num = (int32) (lower + step);
+	*sequence_num_step = (int32) step;
+}
+
+/* Decompress the compressed batch into the tuplesort and delete it. */
+static void
+segment_recompression_decompress_batch(SegmentRecompression *rc, const RecompressBatch *batch,
+									   Tuplesortstate *sortstate)
+{
+	RowDecompressor *decompressor = rc->decompressor;
+	ItemPointerData tid = batch->tid;
+	bool should_free;
+
+	if (!table_tuple_fetch_row_version(rc->compressed_chunk_rel,
+									   &tid,
+									   rc->snapshot,
+									   rc->batch_slot))
+		elog(ERROR, "could not find the compressed batch to recompress");
+
+	HeapTuple compressed_tuple = ExecFetchSlotHeapTuple(rc->batch_slot, false, &should_free);
+
+	heap_deform_tuple(compressed_tuple,
+					  RelationGetDescr(rc->compressed_chunk_rel),
+					  decompressor->compressed_datums,
+					  decompressor->compressed_is_nulls);
+
+	row_decompressor_decompress_row(decompressor, sortstate);
+
+	simple_table_tuple_delete(rc->compressed_chunk_rel, &tid, rc->snapshot);
+
+	if (should_free)
+		heap_freetuple(compressed_tuple);
+	ExecClearTuple(rc->batch_slot);
+}
+
+/*
+ * Merge the new rows of the current segment from the uncompressed chunk into
+ * its compressed batches. Only the batches they affect are rewritten, and the
+ * segments without new rows are left as they are.
+ */
+static void
+segment_recompression_process(SegmentRecompression *rc, int nsegmentby_cols,
+							  CompressedSegmentInfo **current_segment)
+{
+	RecompressNewRows new_rows = { 0 };
+	Tuplestorestate *new_rows_store = tuplestore_begin_heap(false, false, maintenance_work_mem);
+
+	fetch_matching_uncompressed_chunk_rows(rc,
+										   new_rows_store,
+										   nsegmentby_cols,
+										   current_segment,
+										   &new_rows);
+
+	int first_batch = rc->n_batches;
+	int end_batch = rc->n_batches;
+	int32 first_sequence_num = SEQUENCE_NUM_GAP;
+	int32 sequence_num_step = SEQUENCE_NUM_GAP;
+	if (new_rows.count > 0)
+		segment_recompression_find_batches(rc,
+										   &new_rows,
+										   &first_batch,
+										   &end_batch,
+										   &first_sequence_num,
+										   &sequence_num_step);
+
+	for (int i = 0; i < rc->n_batches; i++)
+	{
+		if (i >= first_batch && i < end_batch)
+			continue;
+		rc->untouched_rows += rc->batches[i].count;
+		rc->untouched_batches++;
+	}
+
+	if (new_rows.count > 0)
+	{
+		Tuplesortstate *sortstate = segment_recompression_begin_sort(rc);
+
+		for (int i = first_batch; i < end_batch; i++)
+			segment_recompression_decompress_batch(rc, &rc->batches[i], sortstate);
+
+		/*
+		 * Add the new rows after the rows of the existing batches, the same
+		 * way the recompression of the entire segment does.
+		 */
+		TupleTableSlot *new_row_slot =
+			MakeSingleTupleTableSlot(RelationGetDescr(rc->uncompressed_chunk_rel),
+									 &TTSOpsMinimalTuple);
+		while (tuplestore_gettupleslot(new_rows_store, true, false, new_row_slot))
+			tuplesort_puttupleslot(sortstate, new_row_slot);
+		ExecDropSingleTupleTableSlot(new_row_slot);
+
+		tuplesort_performsort(sortstate);
+		recompress_segment(sortstate,
+						   rc->uncompressed_chunk_rel,
+						   rc->row_compressor,
+						   first_sequence_num,
+						   sequence_num_step);
+		tuplesort_end(sortstate);
+
+		/* make changes visible */
+		CommandCounterIncrement();
+	}
+
+	tuplestore_end(new_rows_store);
+
+	MemoryContextReset(rc->segment_ctx);
+	rc->batches = NULL;
+	rc->n_batches = 0;
+	rc->max_batches = 0;
+}
+
 /*
  * Recompress an existing chunk by decompressing the batches
  * that are affected by the addition of newer data. The existing
@@ -1317,8 +1934,6 @@ tsl_recompress_chunk_segmentwise(PG_FUNCTION_ARGS)
 	/****** compression statistics ******/
 	RelationSize after_size;
 
-	Tuplesortstate *segment_tuplesortstate;
-
 	/*************** tuplesort state *************************/
 	TupleDesc compressed_rel_tupdesc = RelationGetDescr(compressed_chunk_rel);
 	TupleDesc uncompressed_rel_tupdesc = RelationGetDescr(uncompressed_chunk_rel);
@@ -1336,16 +1951,6 @@ tsl_recompress_chunk_segmentwise(PG_FUNCTION_ARGS)
 													 &sort_collations[n],
 													 &nulls_first[n]);
 
-	segment_tuplesortstate = tuplesort_begin_heap(uncompressed_rel_tupdesc,
-												  n_keys,
-												  sort_keys,
-												  sort_operators,
-												  sort_collations,
-												  nulls_first,
-												  maintenance_work_mem,
-												  NULL,
-												  false);
-
 	/******************** row decompressor **************/
 
 	RowDecompressor decompressor = build_decompressor(compressed_chunk_rel, uncompressed_chunk_rel);
@@ -1374,11 +1979,8 @@ tsl_recompress_chunk_segmentwise(PG_FUNCTION_ARGS)
 		segmentby_column_offsets_compressed[seg_idx++] = col;
 	}
 
-	HeapTuple compressed_tuple;
-
 	IndexScanDesc index_scan;
 	SegmentInfo *segment_info = NULL;
-	bool changed_segment = false;
 	/************ current segment **************/
 	CompressedSegmentInfo **current_segment =
 		palloc(sizeof(CompressedSegmentInfo *) * nsegmentby_cols);
@@ -1392,6 +1994,36 @@ tsl_recompress_chunk_segmentwise(PG_FUNCTION_ARGS)
 	/************** snapshot ****************************/
 	Snapshot snapshot = RegisterSnapshot(GetTransactionSnapshot());
 
+	/************** segment recompression ***************/
+	SegmentRecompression rc = {
+		.compressed_chunk_rel = compressed_chunk_rel,
+		.uncompressed_chunk_rel = uncompressed_chunk_rel,
+		.decompressor = &decompressor,
+		.row_compressor = &row_compressor,
+		.snapshot = snapshot,
+		.batch_slot = table_slot_create(compressed_chunk_rel, NULL),
+		.n_keys = n_keys,
+		.sort_keys = sort_keys,
+		.sort_operators = sort_operators,
+		.sort_collations = sort_collations,
+		.nulls_first = nulls_first,
+		.count_attno =
+			get_attnum(compressed_chunk->table_id, COMPRESSION_COLUMN_METADATA_COUNT_NAME),
+		.sequence_num_attno =
+			get_attnum(compressed_chunk->table_id, COMPRESSION_COLUMN_METADATA_SEQUENCE_NUM_NAME),
+		.segment_ctx = AllocSetContextCreate(CurrentMemoryContext,
+											 "segmentwise recompression",
+											 ALLOCSET_DEFAULT_SIZES),
+	};
+	Ensure(rc.count_attno != InvalidAttrNumber && rc.sequence_num_attno != InvalidAttrNumber,
+		   "missing metadata columns in compressed chunk \"%s\"",
+		   get_rel_name(compressed_chunk->table_id));
+	recompress_orderby_init(&rc.orderby,
+							colinfo_array,
+							htcols_listlen,
+							uncompressed_chunk_rel,
+							compressed_chunk_rel);
+
 	/* Index scan */
 	Relation index_rel = index_open(row_compressor.index_oid, AccessExclusiveLock);
 
@@ -1427,112 +2059,38 @@ tsl_recompress_chunk_segmentwise(PG_FUNCTION_ARGS)
 			}
 		}
 		/* we have a segment already, so compare those */
-		changed_segment = decompress_segment_changed_group(current_segment,
-														   slot,
-														   decompressor.per_compressed_cols,
-														   segmentby_column_offsets_compressed,
-														   nsegmentby_cols);
-		if (!changed_segment)
+		else if (decompress_segment_changed_group(current_segment,
+												  slot,
+												  decompressor.per_compressed_cols,
+												  segmentby_column_offsets_compressed,
+												  nsegmentby_cols))
 		{
-			i = 0;
-			bool should_free;
-
-			compressed_tuple = ExecFetchSlotHeapTuple(slot, false, &should_free);
-
-			heap_deform_tuple(compressed_tuple,
-							  compressed_rel_tupdesc,
-							  decompressor.compressed_datums,
-							  decompressor.compressed_is_nulls);
-
-			row_decompressor_decompress_row(&decompressor, segment_tuplesortstate);
-
-			simple_table_tuple_delete(compressed_chunk_rel, &(slot->tts_tid), snapshot);
-
-			if (should_free)
-				heap_freetuple(compressed_tuple);
-		}
-		else if (changed_segment)
-		{
-			fetch_matching_uncompressed_chunk_into_tuplesort(segment_tuplesortstate,
-															 nsegmentby_cols,
-															 uncompressed_chunk_rel,
-															 current_segment);
-
-			tuplesort_performsort(segment_tuplesortstate);
-
-			recompress_segment(segment_tuplesortstate, uncompressed_chunk_rel, &row_compressor);
-
-			/* now any pointers returned will be garbage */
-			tuplesort_end(segment_tuplesortstate);
+			/* We have all the batches of the previous segment, so recompress it. */
+			segment_recompression_process(&rc, nsegmentby_cols, current_segment);
 
 			decompress_segment_update_current_segment(current_segment,
 													  slot, /*slot from compressed chunk*/
 													  decompressor.per_compressed_cols,
 													  segmentby_column_offsets_compressed,
 													  nsegmentby_cols);
-			/* reinit tuplesort and add the first tuple of the new segment to it */
-			segment_tuplesortstate = tuplesort_begin_heap(uncompressed_rel_tupdesc,
-														  n_keys,
-														  sort_keys,
-														  sort_operators,
-														  sort_collations,
-														  nulls_first,
-														  maintenance_work_mem,
-														  NULL,
-														  false);
-
-			bool should_free;
-			compressed_tuple = ExecFetchSlotHeapTuple(slot, false, &should_free);
-
-			heap_deform_tuple(compressed_tuple,
-							  compressed_rel_tupdesc,
-							  decompressor.compressed_datums,
-							  decompressor.compressed_is_nulls);
-
-			row_decompressor_decompress_row(&decompressor, segment_tuplesortstate);
-
-			simple_table_tuple_delete(compressed_chunk_rel, &(slot->tts_tid), snapshot);
-			/* because this is the first tuple of the new segment */
-			changed_segment = false;
-			/* make changes visible */
-			CommandCounterIncrement();
-
-			if (should_free)
-				heap_freetuple(compressed_tuple);
 		}
+
+		segment_recompression_add_batch(&rc, slot);
 	}
 
 	ExecClearTuple(slot);
 
-	/* never changed segment, but still need to perform the tuplesort and add everything to the
-	 * compressed chunk
+	/* Recompress the last segment.
 	 * the current segment could not be initialized in the case where two recompress operations
 	 * execute concurrently: one blocks on the Exclusive lock but has already read the chunk
 	 * status and determined that there is data in the uncompressed chunk */
-	if (!changed_segment && current_segment_init)
-	{
-		fetch_matching_uncompressed_chunk_into_tuplesort(segment_tuplesortstate,
-														 nsegmentby_cols,
-														 uncompressed_chunk_rel,
-														 current_segment);
-		tuplesort_performsort(segment_tuplesortstate);
-		recompress_segment(segment_tuplesortstate, uncompressed_chunk_rel, &row_compressor);
-		tuplesort_end(segment_tuplesortstate);
+	if (current_segment_init)
+		segment_recompression_process(&rc, nsegmentby_cols, current_segment);
 
-		CommandCounterIncrement();
-	}
 	/* done with the compressed chunk segments that had new entries in the uncompressed
 	 but there could be rows inserted into the uncompressed that don't already have a corresponding
 	 compressed segment, we need to compress those as well */
-	segment_tuplesortstate = tuplesort_begin_heap(uncompressed_rel_tupdesc,
-												  n_keys,
-												  sort_keys,
-												  sort_operators,
-												  sort_collations,
-												  nulls_first,
-												  maintenance_work_mem,
-												  NULL,
-												  false);
+	Tuplesortstate *segment_tuplesortstate = segment_recompression_begin_sort(&rc);
 
 	bool unmatched_rows_exist = false;
 	fetch_unmatched_uncompressed_chunk_into_tuplesort(segment_tuplesortstate,
@@ -1545,11 +2103,11 @@ tsl_recompress_chunk_segmentwise(PG_FUNCTION_ARGS)
 		row_compressor_append_sorted_rows(&row_compressor,
 										  segment_tuplesortstate,
 										  RelationGetDescr(uncompressed_chunk_rel));
-		tuplesort_end(segment_tuplesortstate);
 
 		/* make changes visible */
 		CommandCounterIncrement();
 	}
+	tuplesort_end(segment_tuplesortstate);
 
 	after_size = ts_relation_size_impl(compressed_chunk->table_id);
 	/* the compression size statistics we are able to update and accurately report are:
@@ -1558,12 +2116,16 @@ tsl_recompress_chunk_segmentwise(PG_FUNCTION_ARGS)
 	compression_chunk_size_catalog_update_recompressed(uncompressed_chunk->fd.id,
 													   compressed_chunk->fd.id,
 													   &after_size,
-													   row_compressor.rowcnt_pre_compression,
-													   row_compressor.num_compressed_rows);
+													   row_compressor.rowcnt_pre_compression +
+														   rc.untouched_rows,
+													   row_compressor.num_compressed_rows +
+														   rc.untouched_batches);
 
 	row_compressor_finish(&row_compressor);
 	FreeBulkInsertState(decompressor.bistate);
 	ExecDropSingleTupleTableSlot(slot);
+	ExecDropSingleTupleTableSlot(rc.batch_slot);
+	MemoryContextDelete(rc.segment_ctx);
 	index_endscan(index_scan);
 	UnregisterSnapshot(snapshot);
 	index_close(index_rel, AccessExclusiveLock);
@@ -15,6 +15,8 @@ extern Datum tsl_decompress_chunk(PG_FUNCTION_ARGS);
 extern Datum tsl_recompress_chunk(PG_FUNCTION_ARGS);
 extern Oid tsl_compress_chunk_wrapper(Chunk *chunk, bool if_not_compressed);
 extern bool tsl_recompress_chunk_wrapper(Chunk *chunk);
+extern bool tsl_create_compressed_chunk_for_insert(Chunk *chunk, Relation rel);
+extern void tsl_compression_chunk_merged(const Hypertable *ht, Chunk *chunk, Chunk *merge_chunk);
 extern Datum tsl_recompress_chunk_segmentwise(PG_FUNCTION_ARGS);
 
 extern Datum tsl_get_compressed_chunk_index_for_recompression(
@@ -15,8 +15,10 @@
 #include <funcapi.h>
 
 #include "compression/array.h"
+#include "compression/arrow_c_data_interface.h"
 #include "compression/compression.h"
 #include "compression/simple8b_rle.h"
+#include "compression/simple8b_rle_bitmap.h"
 #include "datum_serialize.h"
 
 /* A "compressed" array
@@ -417,6 +419,194 @@ array_decompression_iterator_try_next_forward(DecompressionIterator *general_ite
 	};
 }
 
+/*********************
+ *** Decompress All ***
+ *********************/
+
+#define ELEMENT_TYPE uint32
+#include "simple8b_rle_decompress_all.h"
+#undef ELEMENT_TYPE
+
+/*
+ * Whether the bulk decompression of arrays supports the given type. We
+ * support the pass-by-value types that fit into a Datum, and the varlena types.
+ */
+bool
+array_decompress_all_supports_type(Oid element_type)
+{
+	int16 typlen;
+	bool typbyval;
+	get_typlenbyval(element_type, &typlen, &typbyval);
+	return typlen == -1 || (typbyval && typlen > 0 && typlen <= (int16) sizeof(Datum));
+}
+
+/*
+ * Decompress the entire array into an Arrow array. The fixed-width values are
+ * stored in a values buffer, same as for the other algorithms. The varlena
+ * values are stored as an Arrow binary array: int32 offsets buffer and the
+ * value bodies buffer, without the varlena headers.
+ */
+ArrowArray *
+array_decompress_all_serialized_no_header(StringInfo si, Oid element_type, bool has_nulls,
+										  DecompressionArena *dest)
+{
+	ArrayCompressedData data = array_compressed_data_from_bytes(si, element_type, has_nulls);
+
+	int16 typlen;
+	bool typbyval;
+	char typalign;
+	get_typlenbyvalalign(element_type, &typlen, &typbyval, &typalign);
+	Assert(array_decompress_all_supports_type(element_type));
+
+	uint16 n_notnull;
+	const uint32 *restrict sizes = simple8brle_decompress_all_uint32(data.sizes, &n_notnull);
+	CheckCompressedData(n_notnull <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+
+	Simple8bRleBitmap nulls = { 0 };
+	if (has_nulls)
+	{
+		nulls = simple8brle_bitmap_decompress(data.nulls);
+	}
+
+	const uint16 n_total = has_nulls ? nulls.num_elements : n_notnull;
+	CheckCompressedData(n_total >= n_notnull);
+	CheckCompressedData(n_total <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+	if (has_nulls)
+	{
+		CheckCompressedData(n_notnull + simple8brle_bitmap_num_ones(&nulls) == n_total);
+	}
+
+	const int validity_bitmap_bytes = sizeof(uint64) * ((n_total + 64 - 1) / 64);
+	uint64 *restrict validity_bitmap = decompression_arena_alloc(dest, validity_bitmap_bytes);
+
+	/* All data valid by default, we will fill in the nulls later. */
+	memset(validity_bitmap, 0xFF, validity_bitmap_bytes);
+
+	/* The tail bits are not valid. */
+	if (n_total % 64)
+	{
+		const uint64 tail_mask = -1ULL >> (64 - n_total % 64);
+		validity_bitmap[n_total / 64] &= tail_mask;
+	}
+
+	/*
+	 * The sizes of the elements include the alignment padding before them, so
+	 * we can find the end of each element without looking at the data. We use
+	 * this to check that the data is consistent.
+	 */
+	const char *restrict current = data.data;
+	const char *restrict data_end = data.data + data.data_len;
+
+	ArrowArray *result;
+	if (typlen == -1)
+	{
+		int32 *restrict offsets = decompression_arena_alloc(dest, sizeof(int32) * (n_total + 1));
+		char *restrict bodies = decompression_arena_alloc(dest, data.data_len + 1);
+
+		DatumDeserializer *deserializer = create_datum_deserializer(element_type);
+
+		int current_notnull_element = 0;
+		offsets[0] = 0;
+		for (int i = 0; i < n_total; i++)
+		{
+			if (has_nulls && simple8brle_bitmap_get_at(&nulls, i))
+			{
+				arrow_set_row_validity(validity_bitmap, i, false);
+				offsets[i + 1] = offsets[i];
+				continue;
+			}
+
+			Assert(current_notnull_element < n_notnull);
+			const uint32 element_bytes = sizes[current_notnull_element];
+			CheckCompressedData(element_bytes > 0);
+			CheckCompressedData(element_bytes <= (Size) (data_end - current));
+
+			const char *element_end = current + element_bytes;
+			const char *ptr = current;
+			const void *value = DatumGetPointer(bytes_to_datum_and_advance(deserializer, &ptr));
+			CheckCompressedData(ptr == element_end);
+
+			const int body_bytes = VARSIZE_ANY_EXHDR(value);
+			memcpy(&bodies[offsets[i]], VARDATA_ANY(value), body_bytes);
+			offsets[i + 1] = offsets[i] + body_bytes;
+
+			current = element_end;
+			current_notnull_element++;
+		}
+		Assert(current_notnull_element == n_notnull);
+
+		result = decompression_arena_alloc_zero(dest, sizeof(ArrowArray) + sizeof(void *) * 3);
+		const void **buffers = (const void **) &result[1];
+		buffers[0] = validity_bitmap;
+		buffers[1] = offsets;
+		buffers[2] = bodies;
+		result->n_buffers = 3;
+		result->buffers = buffers;
+	}
+	else
+	{
+		/*
+		 * We need additional padding at the end of buffer, because the code that
+		 * converts the elements to postres Datum always reads in 8 bytes.
+		 */
+		const int buffer_bytes = n_total * typlen + 8;
+		char *restrict values = decompression_arena_alloc_zero(dest, buffer_bytes);
+
+		int current_notnull_element = 0;
+		for (int i = 0; i < n_total; i++)
+		{
+			if (has_nulls && simple8brle_bitmap_get_at(&nulls, i))
+			{
+				arrow_set_row_validity(validity_bitmap, i, false);
+				continue;
+			}
+
+			Assert(current_notnull_element < n_notnull);
+			const uint32 element_bytes = sizes[current_notnull_element];
+			CheckCompressedData(element_bytes >= (uint32) typlen);
+			CheckCompressedData(element_bytes <= (Size) (data_end - current));
+
+			const char *element_end = current + element_bytes;
+			const char *ptr = (const char *) att_align_nominal(current, typalign);
+			CheckCompressedData(ptr + typlen == element_end);
+
+			store_att_byval(&values[i * typlen], fetch_att(ptr, typbyval, typlen), typlen);
+
+			current = element_end;
+			current_notnull_element++;
+		}
+		Assert(current_notnull_element == n_notnull);
+
+		result = decompression_arena_alloc_zero(dest, sizeof(ArrowArray) + sizeof(void *) * 2);
+		const void **buffers = (const void **) &result[1];
+		buffers[0] = validity_bitmap;
+		buffers[1] = values;
+		result->n_buffers = 2;
+		result->buffers = buffers;
+	}
+
+	result->length = n_total;
+	result->null_count = n_total - n_notnull;
+	return result;
+}
+
+ArrowArray *
+array_decompress_all(Datum compressed_array, Oid element_type, DecompressionArena *dest)
+{
+	void *compressed_data = PG_DETOAST_DATUM(compressed_array);
+	StringInfoData si = { .data = compressed_data, .len = VARSIZE(compressed_data) };
+	ArrayCompressed *header = consumeCompressedData(&si, sizeof(ArrayCompressed));
+
+	Assert(header->compression_algorithm == COMPRESSION_ALGORITHM_ARRAY);
+	CheckCompressedData(header->element_type == element_type);
+	CheckCompressedData(header->has_nulls == 0 || header->has_nulls == 1);
+
+	return array_decompress_all_serialized_no_header(&si,
+													 element_type,
+													 header->has_nulls == 1,
+													 dest);
+}
+
 /**************************
  *** Decompress Reverse ***
  **************************/
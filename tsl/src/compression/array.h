@@ -55,6 +55,13 @@ extern DecompressionIterator *array_decompression_iterator_alloc_forward(StringI
 																		 Oid element_type,
 																		 bool has_nulls);
 
+extern bool array_decompress_all_supports_type(Oid element_type);
+extern ArrowArray *array_decompress_all(Datum compressed_array, Oid element_type,
+										DecompressionArena *dest);
+extern ArrowArray *array_decompress_all_serialized_no_header(StringInfo si, Oid element_type,
+															 bool has_nulls,
+															 DecompressionArena *dest);
+
 extern ArrayCompressorSerializationInfo *array_compressed_data_recv(StringInfo buffer,
 																	Oid element_type);
 extern void array_compressed_data_send(StringInfo buffer, const char *serialized_data,
@@ -70,6 +77,7 @@ extern Datum tsl_array_compressor_finish(PG_FUNCTION_ARGS);
 	{                                                                                              \
 		.iterator_init_forward = tsl_array_decompression_iterator_from_datum_forward,              \
 		.iterator_init_reverse = tsl_array_decompression_iterator_from_datum_reverse,              \
+		.decompress_all = array_decompress_all,                                                    \
 		.compressed_data_send = array_compressed_send,                                             \
 		.compressed_data_recv = array_compressed_recv,                                             \
 		.compressor_for_type = array_compressor_for_type,                                          \
@@ -0,0 +1,1146 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Export the compressed data of a chunk in the Arrow IPC streaming format.
+ *
+ * The stream consists of the schema message, one record batch message for
+ * each compressed batch, and the end-of-stream marker. Each of them is
+ * returned as a separate bytea row, so the client gets the stream by
+ * concatenating the rows in order.
+ *
+ * The record batches are built directly from the bulk decompressed columns,
+ * which already have the Arrow memory layout for most types, so the rows are
+ * never materialized as tuples or formatted as text. Only the values that are
+ * represented differently in Arrow are converted: the booleans are packed into
+ * bitmaps, the dates and timestamps are shifted to the Unix epoch, and the
+ * dictionary-encoded strings are expanded.
+ *
+ * The IPC messages are flatbuffers. The few tables that we need are simple
+ * enough to write them directly instead of depending on a flatbuffers library.
+ */
+
+#include <postgres.h>
+
+#include <access/heapam.h>
+#include <access/htup_details.h>
+#include <access/table.h>
+#include <access/tableam.h>
+#include <catalog/pg_class.h>
+#include <catalog/pg_type.h>
+#include <datatype/timestamp.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <mb/pg_wchar.h>
+#include <miscadmin.h>
+#include <port/pg_bitutils.h>
+#include <utils/acl.h>
+#include <utils/builtins.h>
+#include <utils/date.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/rls.h>
+#include <utils/snapmgr.h>
+
+#include "annotations.h"
+#include "chunk.h"
+#include "compression/arrow_c_data_interface.h"
+#include "compression/arrow_ipc.h"
+#include "compression/compression.h"
+#include "compression/create.h"
+#include "custom_type_cache.h"
+#include "guc.h"
+
+/*
+ * The enum values of the Arrow flatbuffers schema, from Schema.fbs and
+ * Message.fbs.
+ */
+#define ARROW_METADATA_V5 4
+
+#define ARROW_HEADER_SCHEMA 1
+#define ARROW_HEADER_RECORD_BATCH 3
+
+#define ARROW_TYPE_INT 2
+#define ARROW_TYPE_FLOATING_POINT 3
+#define ARROW_TYPE_BINARY 4
+#define ARROW_TYPE_UTF8 5
+#define ARROW_TYPE_BOOL 6
+#define ARROW_TYPE_DATE 8
+#define ARROW_TYPE_TIME 9
+#define ARROW_TYPE_TIMESTAMP 10
+
+#define ARROW_PRECISION_SINGLE 1
+#define ARROW_PRECISION_DOUBLE 2
+#define ARROW_DATE_UNIT_DAY 0
+#define ARROW_TIME_UNIT_MICROSECOND 2
+
+/* The IPC messages start with this marker, and the stream ends with it. */
+#define ARROW_IPC_CONTINUATION 0xFFFFFFFF
+
+/* The offset between the PostgreSQL epoch (2000-01-01) and the Unix epoch */
+#define ARROW_EPOCH_DAYS (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE)
+#define ARROW_EPOCH_USECS ((int64) ARROW_EPOCH_DAYS * USECS_PER_DAY)
+
+/*
+ * A table, string or vector of a flatbuffer. The children are written after
+ * their parents, so that all the offsets point forward as the format requires.
+ */
+typedef enum FbNodeKind
+{
+	FB_TABLE,
+	FB_STRING,
+	FB_TABLE_VECTOR,
+	FB_STRUCT_VECTOR,
+} FbNodeKind;
+
+#define FB_MAX_FIELDS 6
+
+typedef struct FbNode FbNode;
+
+typedef struct FbField
+{
+	/* The size of a scalar field, or zero for an absent or offset field */
+	uint8 size;
+	uint64 value;
+	/* The child of an offset field */
+	const FbNode *child;
+} FbField;
+
+struct FbNode
+{
+	FbNodeKind kind;
+
+	/* FB_TABLE */
+	FbField fields[FB_MAX_FIELDS];
+	int num_fields;
+
+	/* FB_STRING */
+	const char *str;
+
+	/* FB_TABLE_VECTOR */
+	List *elements;
+
+	/* FB_STRUCT_VECTOR, with the structs aligned to 8 bytes */
+	const void *data;
+	int count;
+	int struct_bytes;
+};
+
+static FbNode *
+fb_node(FbNodeKind kind)
+{
+	FbNode *node = palloc0(sizeof(FbNode));
+
+	node->kind = kind;
+	return node;
+}
+
+static FbNode *
+fb_string(const char *str)
+{
+	FbNode *node = fb_node(FB_STRING);
+
+	node->str = str;
+	return node;
+}
+
+static FbNode *
+fb_table_vector(List *elements)
+{
+	FbNode *node = fb_node(FB_TABLE_VECTOR);
+
+	node->elements = elements;
+	return node;
+}
+
+static FbNode *
+fb_struct_vector(const void *data, int count, int struct_bytes)
+{
+	FbNode *node = fb_node(FB_STRUCT_VECTOR);
+
+	node->data = data;
+	node->count = count;
+	node->struct_bytes = struct_bytes;
+	return node;
+}
+
+static void
+fb_set_scalar(FbNode *table, int field, int size, uint64 value)
+{
+	Assert(table->kind == FB_TABLE && field < FB_MAX_FIELDS);
+	table->fields[field] = (FbField){ .size = size, .value = value };
+	table->num_fields = Max(table->num_fields, field + 1);
+}
+
+static void
+fb_set_child(FbNode *table, int field, const FbNode *child)
+{
+	Assert(table->kind == FB_TABLE && field < FB_MAX_FIELDS);
+	table->fields[field] = (FbField){ .child = child };
+	table->num_fields = Max(table->num_fields, field + 1);
+}
+
+static void
+fb_append_zeros(StringInfo buf, int bytes)
+{
+	enlargeStringInfo(buf, bytes);
+	memset(buf->data + buf->len, 0, bytes);
+	buf->len += bytes;
+	buf->data[buf->len] = '\0';
+}
+
+/* Pad the buffer so that (buf->len + extra) is a multiple of the alignment */
+static void
+fb_align(StringInfo buf, int alignment, int extra)
+{
+	const int misalignment = (buf->len + extra) % alignment;
+
+	if (misalignment != 0)
+		fb_append_zeros(buf, alignment - misalignment);
+}
+
+static void
+fb_put_scalar(StringInfo buf, int pos, int size, uint64 value)
+{
+	switch (size)
+	{
+		case 1:
+		{
+			uint8 v = value;
+			memcpy(buf->data + pos, &v, sizeof(v));
+			break;
+		}
+		case 2:
+		{
+			uint16 v = value;
+			memcpy(buf->data + pos, &v, sizeof(v));
+			break;
+		}
+		case 4:
+		{
+			uint32 v = value;
+			memcpy(buf->data + pos, &v, sizeof(v));
+			break;
+		}
+		case 8:
+			memcpy(buf->data + pos, &value, sizeof(value));
+			break;
+		default:
+			pg_unreachable();
+	}
+}
+
+static int fb_write(StringInfo buf, const FbNode *node);
+
+/* Write the child and point the offset at the given position to it */
+static void
+fb_write_child(StringInfo buf, int offset_pos, const FbNode *child)
+{
+	const int child_pos = fb_write(buf, child);
+
+	Assert(child_pos > offset_pos);
+	fb_put_scalar(buf, offset_pos, sizeof(uint32), child_pos - offset_pos);
+}
+
+/*
+ * Write the node at the end of the buffer and return its position, which is
+ * the position that the offsets to it point to.
+ */
+static int
+fb_write(StringInfo buf, const FbNode *node)
+{
+	int pos;
+
+	switch (node->kind)
+	{
+		case FB_TABLE:
+		{
+			uint16 vtable[2 + FB_MAX_FIELDS] = { 0 };
+			const int vtable_bytes = sizeof(uint16) * (2 + node->num_fields);
+			int table_bytes = sizeof(int32);
+
+			/* Lay out the fields in the order of decreasing size to align them */
+			for (int size = 8; size >= 1; size /= 2)
+			{
+				for (int i = 0; i < node->num_fields; i++)
+				{
+					const FbField *field = &node->fields[i];
+					const int field_size = field->child != NULL ? sizeof(uint32) : field->size;
+
+					if (field_size != size)
+						continue;
+
+					table_bytes = TYPEALIGN(size, table_bytes);
+					vtable[2 + i] = table_bytes;
+					table_bytes += size;
+				}
+			}
+			vtable[0] = vtable_bytes;
+			vtable[1] = table_bytes;
+
+			/* The vtable precedes the table, which is aligned to 8 bytes */
+			fb_align(buf, 8, vtable_bytes);
+			appendBinaryStringInfo(buf, (char *) vtable, vtable_bytes);
+			pos = buf->len;
+			fb_append_zeros(buf, table_bytes);
+			fb_put_scalar(buf, pos, sizeof(int32), vtable_bytes);
+
+			for (int i = 0; i < node->num_fields; i++)
+			{
+				const FbField *field = &node->fields[i];
+
+				if (field->size > 0)
+					fb_put_scalar(buf, pos + vtable[2 + i], field->size, field->value);
+			}
+
+			for (int i = 0; i < node->num_fields; i++)
+			{
+				const FbField *field = &node->fields[i];
+
+				if (field->child != NULL)
+					fb_write_child(buf, pos + vtable[2 + i], field->child);
+			}
+			break;
+		}
+		case FB_STRING:
+		{
+			const uint32 len = strlen(node->str);
+
+			fb_align(buf, sizeof(uint32), 0);
+			pos = buf->len;
+			appendBinaryStringInfo(buf, (char *) &len, sizeof(len));
+			/* The terminating zero is a part of the format */
+			appendBinaryStringInfo(buf, node->str, len + 1);
+			break;
+		}
+		case FB_TABLE_VECTOR:
+		{
+			const uint32 count = list_length(node->elements);
+			ListCell *lc;
+			int i = 0;
+
+			fb_align(buf, sizeof(uint32), 0);
+			pos = buf->len;
+			appendBinaryStringInfo(buf, (char *) &count, sizeof(count));
+			fb_append_zeros(buf, sizeof(uint32) * count);
+
+			foreach (lc, node->elements)
+			{
+				fb_write_child(buf, pos + sizeof(uint32) * (1 + i), lfirst(lc));
+				i++;
+			}
+			break;
+		}
+		case FB_STRUCT_VECTOR:
+		{
+			const uint32 count = node->count;
+
+			fb_align(buf, 8, sizeof(uint32));
+			pos = buf->len;
+			appendBinaryStringInfo(buf, (char *) &count, sizeof(count));
+			if (count > 0)
+				appendBinaryStringInfo(buf, node->data, node->struct_bytes * count);
+			break;
+		}
+		default:
+			pg_unreachable();
+	}
+
+	return pos;
+}
+
+/*
+ * Build an IPC message with the given header and body. The metadata is padded
+ * so that the body is aligned to 8 bytes, like the body buffers are.
+ */
+static bytea *
+arrow_ipc_message(uint8 header_type, const FbNode *header, const StringInfo body)
+{
+	FbNode *message = fb_node(FB_TABLE);
+	StringInfoData metadata;
+	const int body_bytes = body != NULL ? body->len : 0;
+	const uint32 continuation = ARROW_IPC_CONTINUATION;
+	bytea *result;
+	char *ptr;
+
+	fb_set_scalar(message, 0, sizeof(int16), ARROW_METADATA_V5);
+	fb_set_scalar(message, 1, sizeof(uint8), header_type);
+	fb_set_child(message, 2, header);
+	fb_set_scalar(message, 3, sizeof(int64), body_bytes);
+
+	initStringInfo(&metadata);
+	fb_append_zeros(&metadata, sizeof(uint32));
+	fb_write_child(&metadata, 0, message);
+	fb_align(&metadata, 8, 0);
+
+	result = palloc(VARHDRSZ + sizeof(uint32) + sizeof(int32) + metadata.len + body_bytes);
+	SET_VARSIZE(result, VARHDRSZ + sizeof(uint32) + sizeof(int32) + metadata.len + body_bytes);
+	ptr = VARDATA(result);
+	memcpy(ptr, &continuation, sizeof(uint32));
+	ptr += sizeof(uint32);
+	memcpy(ptr, &metadata.len, sizeof(int32));
+	ptr += sizeof(int32);
+	memcpy(ptr, metadata.data, metadata.len);
+	ptr += metadata.len;
+	if (body_bytes > 0)
+		memcpy(ptr, body->data, body_bytes);
+
+	pfree(metadata.data);
+	return result;
+}
+
+static bytea *
+arrow_ipc_end_of_stream(void)
+{
+	const uint32 eos[2] = { ARROW_IPC_CONTINUATION, 0 };
+	bytea *result = palloc(VARHDRSZ + sizeof(eos));
+
+	SET_VARSIZE(result, VARHDRSZ + sizeof(eos));
+	memcpy(VARDATA(result), eos, sizeof(eos));
+	return result;
+}
+
+/* The FieldNode and Buffer structs of a record batch message */
+typedef struct ArrowIpcFieldNode
+{
+	int64 length;
+	int64 null_count;
+} ArrowIpcFieldNode;
+
+typedef struct ArrowIpcBuffer
+{
+	int64 offset;
+	int64 length;
+} ArrowIpcBuffer;
+
+typedef enum ArrowExportType
+{
+	ARROW_EXPORT_BOOL,
+	ARROW_EXPORT_INT16,
+	ARROW_EXPORT_INT32,
+	ARROW_EXPORT_INT64,
+	ARROW_EXPORT_FLOAT32,
+	ARROW_EXPORT_FLOAT64,
+	ARROW_EXPORT_DATE,
+	ARROW_EXPORT_TIME,
+	ARROW_EXPORT_TIMESTAMP,
+	ARROW_EXPORT_TIMESTAMPTZ,
+	ARROW_EXPORT_UTF8,
+	ARROW_EXPORT_BINARY,
+} ArrowExportType;
+
+typedef struct ArrowExportColumn
+{
+	char *name;
+	bool nullable;
+	Oid typid;
+	int16 value_bytes;
+	ArrowExportType type;
+
+	/* The attribute of the column in the chunk */
+	AttrNumber attnum;
+
+	/* The offset of the column in the compressed chunk, -1 if there is none */
+	int compressed_offset;
+	bool is_segmentby;
+} ArrowExportColumn;
+
+typedef enum ArrowExportPhase
+{
+	ARROW_EXPORT_PHASE_SCHEMA,
+	ARROW_EXPORT_PHASE_BATCHES,
+	ARROW_EXPORT_PHASE_END_OF_STREAM,
+	ARROW_EXPORT_PHASE_DONE,
+} ArrowExportPhase;
+
+typedef struct ArrowExportState
+{
+	ArrowExportPhase phase;
+
+	Relation chunk_rel;
+	Relation compressed_rel;
+	TableScanDesc scan;
+	ExprContext *econtext;
+
+	ArrowExportColumn *columns;
+	int num_columns;
+	int count_offset;
+
+	Datum *compressed_datums;
+	bool *compressed_nulls;
+
+	MemoryContext batch_context;
+} ArrowExportState;
+
+static ArrowExportType
+arrow_export_type(Oid typid, const char *column_name)
+{
+	switch (getBaseType(typid))
+	{
+		case BOOLOID:
+			return ARROW_EXPORT_BOOL;
+		case INT2OID:
+			return ARROW_EXPORT_INT16;
+		case INT4OID:
+			return ARROW_EXPORT_INT32;
+		case INT8OID:
+			return ARROW_EXPORT_INT64;
+		case FLOAT4OID:
+			return ARROW_EXPORT_FLOAT32;
+		case FLOAT8OID:
+			return ARROW_EXPORT_FLOAT64;
+		case DATEOID:
+			return ARROW_EXPORT_DATE;
+		case TIMEOID:
+			return ARROW_EXPORT_TIME;
+		case TIMESTAMPOID:
+			return ARROW_EXPORT_TIMESTAMP;
+		case TIMESTAMPTZOID:
+			return ARROW_EXPORT_TIMESTAMPTZ;
+		case TEXTOID:
+		case VARCHAROID:
+		case BPCHAROID:
+			/* The strings are only valid Arrow strings in a UTF-8 database */
+			return GetDatabaseEncoding() == PG_UTF8 ? ARROW_EXPORT_UTF8 : ARROW_EXPORT_BINARY;
+		case BYTEAOID:
+			return ARROW_EXPORT_BINARY;
+		default:
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("type %s of column \"%s\" is not supported by the Arrow export",
+							format_type_be(typid),
+							column_name)));
+			pg_unreachable();
+	}
+}
+
+static FbNode *
+arrow_export_field(const ArrowExportColumn *column)
+{
+	FbNode *field = fb_node(FB_TABLE);
+	FbNode *type = fb_node(FB_TABLE);
+	uint8 type_type;
+
+	switch (column->type)
+	{
+		case ARROW_EXPORT_BOOL:
+			type_type = ARROW_TYPE_BOOL;
+			break;
+		case ARROW_EXPORT_INT16:
+		case ARROW_EXPORT_INT32:
+		case ARROW_EXPORT_INT64:
+			type_type = ARROW_TYPE_INT;
+			fb_set_scalar(type, 0, sizeof(int32), column->value_bytes * 8);
+			fb_set_scalar(type, 1, sizeof(bool), true);
+			break;
+		case ARROW_EXPORT_FLOAT32:
+		case ARROW_EXPORT_FLOAT64:
+			type_type = ARROW_TYPE_FLOATING_POINT;
+			fb_set_scalar(type,
+						  0,
+						  sizeof(int16),
+						  column->type == ARROW_EXPORT_FLOAT32 ? ARROW_PRECISION_SINGLE :
+																 ARROW_PRECISION_DOUBLE);
+			break;
+		case ARROW_EXPORT_DATE:
+			type_type = ARROW_TYPE_DATE;
+			fb_set_scalar(type, 0, sizeof(int16), ARROW_DATE_UNIT_DAY);
+			break;
+		case ARROW_EXPORT_TIME:
+			type_type = ARROW_TYPE_TIME;
+			fb_set_scalar(type, 0, sizeof(int16), ARROW_TIME_UNIT_MICROSECOND);
+			fb_set_scalar(type, 1, sizeof(int32), 64);
+			break;
+		case ARROW_EXPORT_TIMESTAMP:
+		case ARROW_EXPORT_TIMESTAMPTZ:
+			type_type = ARROW_TYPE_TIMESTAMP;
+			fb_set_scalar(type, 0, sizeof(int16), ARROW_TIME_UNIT_MICROSECOND);
+			if (column->type == ARROW_EXPORT_TIMESTAMPTZ)
+				fb_set_child(type, 1, fb_string("UTC"));
+			break;
+		case ARROW_EXPORT_UTF8:
+			type_type = ARROW_TYPE_UTF8;
+			break;
+		case ARROW_EXPORT_BINARY:
+			type_type = ARROW_TYPE_BINARY;
+			break;
+		default:
+			pg_unreachable();
+	}
+
+	fb_set_child(field, 0, fb_string(column->name));
+	fb_set_scalar(field, 1, sizeof(bool), column->nullable);
+	fb_set_scalar(field, 2, sizeof(uint8), type_type);
+	fb_set_child(field, 3, type);
+	/* The readers expect the children even for the primitive types */
+	fb_set_child(field, 5, fb_table_vector(NIL));
+
+	return field;
+}
+
+static bytea *
+arrow_export_schema(ArrowExportState *state)
+{
+	FbNode *schema = fb_node(FB_TABLE);
+	List *fields = NIL;
+
+	for (int i = 0; i < state->num_columns; i++)
+		fields = lappend(fields, arrow_export_field(&state->columns[i]));
+
+	/* Little-endian */
+	fb_set_scalar(schema, 0, sizeof(int16), 0);
+	fb_set_child(schema, 1, fb_table_vector(fields));
+
+	return arrow_ipc_message(ARROW_HEADER_SCHEMA, schema, NULL);
+}
+
+/*
+ * Build an Arrow array with the same layout as the bulk decompression
+ * produces, from the datums of a batch. This is used for the segmentby
+ * columns, the columns that have the same default value for the entire batch,
+ * and the compression algorithms that don't support bulk decompression.
+ */
+static ArrowArray *
+arrow_export_array_from_datums(const ArrowExportColumn *column, const Datum *values,
+							   const bool *nulls, int n)
+{
+	ArrowArray *arrow = palloc0(sizeof(ArrowArray) + sizeof(void *) * 3);
+	const void **buffers = (const void **) &arrow[1];
+	uint64 *validity = palloc0(sizeof(uint64) * ((n + 63) / 64));
+
+	for (int i = 0; i < n; i++)
+	{
+		if (nulls[i])
+			arrow->null_count++;
+		else
+			arrow_set_row_validity(validity, i, true);
+	}
+
+	buffers[0] = validity;
+	arrow->buffers = buffers;
+	arrow->length = n;
+
+	if (column->value_bytes == -1)
+	{
+		int32 *offsets = palloc(sizeof(int32) * (n + 1));
+		StringInfoData bodies;
+
+		initStringInfo(&bodies);
+		offsets[0] = 0;
+		for (int i = 0; i < n; i++)
+		{
+			if (!nulls[i])
+			{
+				const struct varlena *value = PG_DETOAST_DATUM_PACKED(values[i]);
+
+				appendBinaryStringInfo(&bodies, VARDATA_ANY(value), VARSIZE_ANY_EXHDR(value));
+			}
+			offsets[i + 1] = bodies.len;
+		}
+
+		buffers[1] = offsets;
+		buffers[2] = bodies.data;
+		arrow->n_buffers = 3;
+		return arrow;
+	}
+
+	char *fixed = palloc0(column->value_bytes * n);
+
+	for (int i = 0; i < n; i++)
+	{
+		if (nulls[i])
+			continue;
+
+		switch (column->value_bytes)
+		{
+			case 8:
+			{
+				int64 v = DatumGetInt64(values[i]);
+				memcpy(&fixed[8 * i], &v, sizeof(v));
+				break;
+			}
+			case 4:
+			{
+				int32 v = DatumGetInt32(values[i]);
+				memcpy(&fixed[4 * i], &v, sizeof(v));
+				break;
+			}
+			case 2:
+			{
+				int16 v = DatumGetInt16(values[i]);
+				memcpy(&fixed[2 * i], &v, sizeof(v));
+				break;
+			}
+			case 1:
+				fixed[i] = DatumGetChar(values[i]);
+				break;
+			default:
+				pg_unreachable();
+		}
+	}
+
+	buffers[1] = fixed;
+	arrow->n_buffers = 2;
+	return arrow;
+}
+
+/* Get the values of a column of the current compressed batch */
+static ArrowArray *
+arrow_export_column_values(ArrowExportState *state, const ArrowExportColumn *column, int n)
+{
+	Datum *values;
+	bool *nulls;
+	Datum value;
+	bool isnull;
+
+	if (column->compressed_offset >= 0 && !column->is_segmentby &&
+		!state->compressed_nulls[column->compressed_offset])
+	{
+		CompressedDataHeader *header = (CompressedDataHeader *) PG_DETOAST_DATUM(
+			state->compressed_datums[column->compressed_offset]);
+		DecompressAllFunction decompress_all;
+		DecompressionIterator *iterator;
+		int row = 0;
+
+		if (header->compression_algorithm >= _END_COMPRESSION_ALGORITHMS)
+			elog(ERROR, "invalid compression algorithm %d", header->compression_algorithm);
+
+		decompress_all =
+			tsl_get_decompress_all_function(header->compression_algorithm, column->typid);
+		if (decompress_all != NULL)
+		{
+			DecompressionArena arena = { .mctx = CurrentMemoryContext };
+
+			return decompress_all(PointerGetDatum(header), column->typid, &arena);
+		}
+
+		values = palloc(sizeof(Datum) * n);
+		nulls = palloc(sizeof(bool) * n);
+		iterator = tsl_get_decompression_iterator_init(header->compression_algorithm,
+													   false)(PointerGetDatum(header),
+															  column->typid);
+		for (DecompressResult r = iterator->try_next(iterator); !r.is_done;
+			 r = iterator->try_next(iterator))
+		{
+			if (row >= n)
+				elog(ERROR, "compressed column out of sync with batch counter");
+
+			values[row] = r.val;
+			nulls[row] = r.is_null;
+			row++;
+		}
+
+		return arrow_export_array_from_datums(column, values, nulls, row);
+	}
+
+	/* The column has the same value for the entire batch */
+	if (column->compressed_offset >= 0)
+	{
+		value = state->compressed_datums[column->compressed_offset];
+		isnull = state->compressed_nulls[column->compressed_offset];
+	}
+	else
+		value = getmissingattr(RelationGetDescr(state->chunk_rel), column->attnum, &isnull);
+
+	values = palloc(sizeof(Datum) * n);
+	nulls = palloc(sizeof(bool) * n);
+	for (int i = 0; i < n; i++)
+	{
+		values[i] = value;
+		nulls[i] = isnull;
+	}
+
+	return arrow_export_array_from_datums(column, values, nulls, n);
+}
+
+typedef struct ArrowExportBatch
+{
+	StringInfoData body;
+	ArrowIpcFieldNode *nodes;
+	int num_nodes;
+	ArrowIpcBuffer *buffers;
+	int num_buffers;
+} ArrowExportBatch;
+
+static void
+arrow_export_add_buffer(ArrowExportBatch *batch, const void *data, Size bytes)
+{
+	ArrowIpcBuffer *buffer = &batch->buffers[batch->num_buffers++];
+
+	buffer->offset = batch->body.len;
+	buffer->length = bytes;
+	if (bytes > 0)
+		appendBinaryStringInfo(&batch->body, data, bytes);
+	fb_align(&batch->body, 8, 0);
+}
+
+/*
+ * Add the buffers of a column to the record batch. The fixed-width values are
+ * copied as they are, unless their Arrow representation is different.
+ */
+static void
+arrow_export_add_column(ArrowExportBatch *batch, const ArrowExportColumn *column,
+						const ArrowArray *arrow)
+{
+	const int n = arrow->length;
+	const int validity_bytes = (n + 7) / 8;
+	const uint64 *validity = arrow->buffers[0];
+	const void *values = arrow->buffers[1];
+	Size values_bytes = (Size) column->value_bytes * n;
+	int64 null_count = 0;
+
+	if (validity != NULL)
+		null_count = n - pg_popcount((const char *) validity, validity_bytes);
+
+	batch->nodes[batch->num_nodes++] = (ArrowIpcFieldNode){ .length = n, .null_count = null_count };
+
+	/* The validity bitmap can be omitted when there are no nulls */
+	arrow_export_add_buffer(batch, validity, null_count > 0 ? validity_bytes : 0);
+
+	switch (column->type)
+	{
+		case ARROW_EXPORT_BOOL:
+		{
+			const uint8 *bytes = values;
+			uint8 *bits = palloc0(validity_bytes);
+
+			for (int i = 0; i < n; i++)
+				bits[i / 8] |= (bytes[i] != 0) << (i % 8);
+
+			values = bits;
+			values_bytes = validity_bytes;
+			break;
+		}
+		case ARROW_EXPORT_DATE:
+		{
+			const DateADT *dates = values;
+			int32 *shifted = palloc(sizeof(int32) * n);
+
+			for (int i = 0; i < n; i++)
+				shifted[i] = DATE_NOT_FINITE(dates[i]) ? dates[i] : dates[i] + ARROW_EPOCH_DAYS;
+
+			values = shifted;
+			break;
+		}
+		case ARROW_EXPORT_TIMESTAMP:
+		case ARROW_EXPORT_TIMESTAMPTZ:
+		{
+			const Timestamp *timestamps = values;
+			int64 *shifted = palloc(sizeof(int64) * n);
+
+			for (int i = 0; i < n; i++)
+				shifted[i] = TIMESTAMP_NOT_FINITE(timestamps[i]) ?
+								 timestamps[i] :
+								 timestamps[i] + ARROW_EPOCH_USECS;
+
+			values = shifted;
+			break;
+		}
+		case ARROW_EXPORT_UTF8:
+		case ARROW_EXPORT_BINARY:
+		{
+			const int32 *offsets;
+			const char *bodies;
+
+			if (arrow->dictionary != NULL)
+			{
+				/* Expand the dictionary, which is different in every batch */
+				const int16 *indices = values;
+				const int32 *item_offsets = arrow->dictionary->buffers[1];
+				const char *item_bodies = arrow->dictionary->buffers[2];
+				int32 *expanded_offsets = palloc(sizeof(int32) * (n + 1));
+				StringInfoData expanded_bodies;
+
+				initStringInfo(&expanded_bodies);
+				expanded_offsets[0] = 0;
+				for (int i = 0; i < n; i++)
+				{
+					if (validity == NULL || arrow_row_is_valid(validity, i))
+					{
+						const int16 index = indices[i];
+
+						appendBinaryStringInfo(&expanded_bodies,
+											   &item_bodies[item_offsets[index]],
+											   item_offsets[index + 1] - item_offsets[index]);
+					}
+					expanded_offsets[i + 1] = expanded_bodies.len;
+				}
+
+				offsets = expanded_offsets;
+				bodies = expanded_bodies.data;
+			}
+			else
+			{
+				offsets = values;
+				bodies = arrow->buffers[2];
+			}
+
+			arrow_export_add_buffer(batch, offsets, sizeof(int32) * (n + 1));
+			arrow_export_add_buffer(batch, bodies, offsets[n]);
+			return;
+		}
+		default:
+			break;
+	}
+
+	arrow_export_add_buffer(batch, values, values_bytes);
+}
+
+/* Build the record batch message for the current compressed batch */
+static bytea *
+arrow_export_record_batch(ArrowExportState *state)
+{
+	FbNode *record_batch = fb_node(FB_TABLE);
+	ArrowExportBatch batch = { 0 };
+	MemoryContext oldcontext;
+	bytea *result;
+	int n;
+
+	if (state->compressed_nulls[state->count_offset])
+		elog(ERROR, "NULL count in compressed batch");
+
+	n = DatumGetInt32(state->compressed_datums[state->count_offset]);
+	if (n < 0 || n > GLOBAL_MAX_ROWS_PER_COMPRESSION)
+		elog(ERROR, "invalid number of rows %d in compressed batch", n);
+
+	oldcontext = MemoryContextSwitchTo(state->batch_context);
+
+	initStringInfo(&batch.body);
+	batch.nodes = palloc(sizeof(ArrowIpcFieldNode) * state->num_columns);
+	batch.buffers = palloc(sizeof(ArrowIpcBuffer) * 3 * state->num_columns);
+
+	for (int i = 0; i < state->num_columns; i++)
+	{
+		const ArrowExportColumn *column = &state->columns[i];
+		const ArrowArray *arrow = arrow_export_column_values(state, column, n);
+
+		if (arrow->length != n)
+			elog(ERROR, "compressed column out of sync with batch counter");
+
+		arrow_export_add_column(&batch, column, arrow);
+	}
+
+	fb_set_scalar(record_batch, 0, sizeof(int64), n);
+	fb_set_child(record_batch,
+				 1,
+				 fb_struct_vector(batch.nodes, batch.num_nodes, sizeof(ArrowIpcFieldNode)));
+	fb_set_child(record_batch,
+				 2,
+				 fb_struct_vector(batch.buffers, batch.num_buffers, sizeof(ArrowIpcBuffer)));
+
+	/* The message is returned in the memory context of the caller */
+	MemoryContextSwitchTo(oldcontext);
+	result = arrow_ipc_message(ARROW_HEADER_RECORD_BATCH, record_batch, &batch.body);
+	MemoryContextReset(state->batch_context);
+
+	return result;
+}
+
+static void
+arrow_export_end(ArrowExportState *state)
+{
+	if (state->scan == NULL)
+		return;
+
+	table_endscan(state->scan);
+	table_close(state->compressed_rel, NoLock);
+	table_close(state->chunk_rel, NoLock);
+	state->scan = NULL;
+}
+
+/* Release the scan when the query doesn't read the function to the end */
+static void
+arrow_export_shutdown(Datum arg)
+{
+	arrow_export_end((ArrowExportState *) DatumGetPointer(arg));
+}
+
+static ArrowExportState *
+arrow_export_begin(Oid chunk_relid, ExprContext *econtext)
+{
+	ArrowExportState *state = palloc0(sizeof(ArrowExportState));
+	Chunk *chunk = ts_chunk_get_by_relid(chunk_relid, true);
+	Oid compressed_typid = ts_custom_type_cache_get(CUSTOM_TYPE_COMPRESSED_DATA)->type_oid;
+	Oid compressed_relid;
+	TupleDesc chunk_desc;
+	TupleDesc compressed_desc;
+	AclResult aclresult;
+	AttrNumber count_attnum;
+
+	if (chunk->relkind == RELKIND_FOREIGN_TABLE)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("Arrow export is not supported for chunks of distributed hypertables")));
+
+	aclresult = pg_class_aclcheck(chunk->table_id, GetUserId(), ACL_SELECT);
+	if (aclresult != ACLCHECK_OK)
+		aclcheck_error(aclresult, OBJECT_TABLE, get_rel_name(chunk->table_id));
+
+	/* The export reads the compressed data directly, bypassing the policies */
+	if (check_enable_rls(chunk->table_id, InvalidOid, false) == RLS_ENABLED ||
+		check_enable_rls(chunk->hypertable_relid, InvalidOid, false) == RLS_ENABLED)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("Arrow export is not supported for tables with row-level security")));
+
+	if (!ts_chunk_is_compressed(chunk))
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("chunk \"%s\" is not compressed", get_rel_name(chunk->table_id))));
+
+	if (ts_chunk_is_partial(chunk))
+		ereport(WARNING,
+				(errmsg("chunk \"%s\" is partially compressed", get_rel_name(chunk->table_id)),
+				 errdetail("The rows that are not compressed yet are not exported.")));
+
+	compressed_relid = ts_chunk_get_relid(chunk->fd.compressed_chunk_id, false);
+
+	state->chunk_rel = table_open(chunk->table_id, AccessShareLock);
+	state->compressed_rel = table_open(compressed_relid, AccessShareLock);
+	chunk_desc = RelationGetDescr(state->chunk_rel);
+	compressed_desc = RelationGetDescr(state->compressed_rel);
+
+	count_attnum = get_attnum(compressed_relid, COMPRESSION_COLUMN_METADATA_COUNT_NAME);
+	if (!AttributeNumberIsValid(count_attnum))
+		elog(ERROR,
+			 "missing count metadata in compressed chunk \"%s\"",
+			 get_rel_name(compressed_relid));
+	state->count_offset = AttrNumberGetAttrOffset(count_attnum);
+
+	state->columns = palloc0(sizeof(ArrowExportColumn) * chunk_desc->natts);
+	for (int i = 0; i < chunk_desc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(chunk_desc, i);
+		ArrowExportColumn *column = &state->columns[state->num_columns];
+		AttrNumber compressed_attnum;
+
+		if (attr->attisdropped)
+			continue;
+
+		column->name = pstrdup(NameStr(attr->attname));
+		column->nullable = !attr->attnotnull;
+		column->typid = attr->atttypid;
+		column->value_bytes = attr->attlen;
+		column->type = arrow_export_type(attr->atttypid, column->name);
+		column->attnum = attr->attnum;
+		column->compressed_offset = -1;
+
+		compressed_attnum = get_attnum(compressed_relid, column->name);
+		if (AttributeNumberIsValid(compressed_attnum))
+		{
+			Form_pg_attribute compressed_attr =
+				TupleDescAttr(compressed_desc, AttrNumberGetAttrOffset(compressed_attnum));
+
+			column->compressed_offset = AttrNumberGetAttrOffset(compressed_attnum);
+			column->is_segmentby = compressed_attr->atttypid != compressed_typid;
+			if (column->is_segmentby && compressed_attr->atttypid != attr->atttypid)
+				elog(ERROR,
+					 "compressed table type '%s' does not match decompressed table type '%s' "
+					 "for segment-by column \"%s\"",
+					 format_type_be(compressed_attr->atttypid),
+					 format_type_be(attr->atttypid),
+					 column->name);
+		}
+
+		state->num_columns++;
+	}
+
+	state->compressed_datums = palloc(sizeof(Datum) * compressed_desc->natts);
+	state->compressed_nulls = palloc(sizeof(bool) * compressed_desc->natts);
+	state->batch_context =
+		AllocSetContextCreate(CurrentMemoryContext, "Arrow export batch", ALLOCSET_DEFAULT_SIZES);
+
+	state->scan = table_beginscan(state->compressed_rel, GetActiveSnapshot(), 0, NULL);
+	state->econtext = econtext;
+	RegisterExprContextCallback(econtext, arrow_export_shutdown, PointerGetDatum(state));
+
+	return state;
+}
+
+/* Get the next message of the stream, or NULL at the end */
+static bytea *
+arrow_export_next(ArrowExportState *state)
+{
+	HeapTuple tuple;
+
+	switch (state->phase)
+	{
+		case ARROW_EXPORT_PHASE_SCHEMA:
+			state->phase = ARROW_EXPORT_PHASE_BATCHES;
+			return arrow_export_schema(state);
+		case ARROW_EXPORT_PHASE_BATCHES:
+			tuple = heap_getnext(state->scan, ForwardScanDirection);
+			if (tuple != NULL)
+			{
+				heap_deform_tuple(tuple,
+								  RelationGetDescr(state->compressed_rel),
+								  state->compressed_datums,
+								  state->compressed_nulls);
+				return arrow_export_record_batch(state);
+			}
+			state->phase = ARROW_EXPORT_PHASE_END_OF_STREAM;
+			TS_FALLTHROUGH;
+		case ARROW_EXPORT_PHASE_END_OF_STREAM:
+			state->phase = ARROW_EXPORT_PHASE_DONE;
+			return arrow_export_end_of_stream();
+		case ARROW_EXPORT_PHASE_DONE:
+			return NULL;
+	}
+
+	pg_unreachable();
+}
+
+/*
+ * Return the compressed data of the chunk as a stream of Arrow IPC messages,
+ * one message per row.
+ */
+Datum
+tsl_export_chunk_arrow_ipc(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	ArrowExportState *state;
+	bytea *message;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		Oid chunk_relid = PG_GETARG_OID(0);
+		ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+		MemoryContext oldcontext;
+
+		ts_feature_flag_check(FEATURE_HYPERTABLE_COMPRESSION);
+
+#ifdef WORDS_BIGENDIAN
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("Arrow export is not supported on big-endian platforms")));
+#endif
+
+		if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("set-valued function called in context that cannot accept a set")));
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		funcctx->user_fctx = arrow_export_begin(chunk_relid, rsinfo->econtext);
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	state = funcctx->user_fctx;
+
+	message = arrow_export_next(state);
+	if (message == NULL)
+	{
+		UnregisterExprContextCallback(state->econtext,
+									  arrow_export_shutdown,
+									  PointerGetDatum(state));
+		arrow_export_end(state);
+		SRF_RETURN_DONE(funcctx);
+	}
+
+	SRF_RETURN_NEXT(funcctx, PointerGetDatum(message));
+}
@@ -0,0 +1,14 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_TSL_COMPRESSION_ARROW_IPC_H
+#define TIMESCALEDB_TSL_COMPRESSION_ARROW_IPC_H
+
+#include <postgres.h>
+#include <fmgr.h>
+
+extern Datum tsl_export_chunk_arrow_ipc(PG_FUNCTION_ARGS);
+
+#endif /* TIMESCALEDB_TSL_COMPRESSION_ARROW_IPC_H */
@@ -0,0 +1,472 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * A micro-benchmark for the compression algorithms. It runs the compression,
+ * the row-by-row decompression in both directions and the bulk decompression
+ * of one batch repeatedly, and reports the throughput of each phase. It is
+ * meant to catch performance regressions in the compression kernels, see
+ * scripts/bench_compression.sql for how to run it.
+ *
+ * The data is either generated synthetically, or taken from a compressed
+ * data file in the same format as the fuzzing corpus. In the latter case the
+ * file is decompressed to get the values, and they are compressed again with
+ * the algorithm under test.
+ *
+ * This is built into the debug builds, and into the release builds with
+ * -DTS_COMPRESSION_BENCHMARK=1 to measure the optimized code.
+ */
+
+#include <postgres.h>
+
+#include <access/htup_details.h>
+#include <catalog/pg_type.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <lib/stringinfo.h>
+#include <portability/instr_time.h>
+#include <storage/fd.h>
+#include <utils/builtins.h>
+#include <utils/date.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/timestamp.h>
+
+#include "compression/arrow_c_data_interface.h"
+#include "compression/compression.h"
+#include "export.h"
+
+#if !defined(NDEBUG) || defined(TS_COMPRESSION_BENCHMARK)
+
+/* The size of the benchmarked batch, same as for a compressed chunk. */
+#define BENCH_BATCH_ROWS MAX_ROWS_PER_COMPRESSION
+
+typedef enum BenchPhase
+{
+	BENCH_COMPRESS = 0,
+	BENCH_DECOMPRESS_FORWARD,
+	BENCH_DECOMPRESS_REVERSE,
+	BENCH_DECOMPRESS_ALL,
+	_BENCH_PHASES
+} BenchPhase;
+
+static const char *bench_phase_names[_BENCH_PHASES] = {
+	[BENCH_COMPRESS] = "compress",
+	[BENCH_DECOMPRESS_FORWARD] = "decompress_forward",
+	[BENCH_DECOMPRESS_REVERSE] = "decompress_reverse",
+	[BENCH_DECOMPRESS_ALL] = "decompress_all",
+};
+
+static const char *bench_algorithm_names[_END_COMPRESSION_ALGORITHMS] = {
+	[COMPRESSION_ALGORITHM_ARRAY] = "array",
+	[COMPRESSION_ALGORITHM_DICTIONARY] = "dictionary",
+	[COMPRESSION_ALGORITHM_GORILLA] = "gorilla",
+	[COMPRESSION_ALGORITHM_DELTADELTA] = "deltadelta",
+	[COMPRESSION_ALGORITHM_BITPACKING] = "bitpacking",
+};
+
+typedef struct BenchInput
+{
+	Oid type;
+	int n_rows;
+	Datum values[BENCH_BATCH_ROWS];
+	bool nulls[BENCH_BATCH_ROWS];
+	/* The size of the non-null values in their in-memory representation */
+	int64 uncompressed_bytes;
+} BenchInput;
+
+typedef struct BenchResult
+{
+	/* Timings are for all iterations together */
+	double seconds;
+	int64 values;
+	bool skipped;
+} BenchResult;
+
+static CompressionAlgorithms
+bench_get_algorithm(const char *name)
+{
+	for (int i = 1; i < _END_COMPRESSION_ALGORITHMS; i++)
+	{
+		if (bench_algorithm_names[i] != NULL && pg_strcasecmp(name, bench_algorithm_names[i]) == 0)
+			return i;
+	}
+
+	ereport(ERROR,
+			(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			 errmsg("unknown compression algorithm \"%s\"", name)));
+	pg_unreachable();
+}
+
+static uint64
+bench_hash64(uint64 x)
+{
+	/* The splitmix64 finalizer, for reproducible pseudo-random data */
+	x ^= x >> 30;
+	x *= UINT64CONST(0xbf58476d1ce4e5b9);
+	x ^= x >> 27;
+	x *= UINT64CONST(0x94d049bb133111eb);
+	x ^= x >> 31;
+	return x;
+}
+
+/*
+ * Generate the synthetic value for the row. Returns false for a null.
+ */
+static bool
+bench_synthetic_value(const char *dataset, int row, int64 *value)
+{
+	if (strcmp(dataset, "sequential") == 0)
+		*value = row;
+	else if (strcmp(dataset, "timestamps") == 0)
+	{
+		/* Ten second intervals with some jitter, in microseconds */
+		*value = INT64CONST(700000000000000) + row * INT64CONST(10000000) +
+				 (int64) (bench_hash64(row) % 1000);
+	}
+	else if (strcmp(dataset, "random") == 0)
+		*value = (int64) bench_hash64(row);
+	else if (strcmp(dataset, "repeated") == 0)
+		*value = (int64) (bench_hash64(row / 100) % 1000000);
+	else if (strcmp(dataset, "low_cardinality") == 0)
+		*value = (int64) (bench_hash64(row) % 16);
+	else if (strcmp(dataset, "sparse") == 0)
+	{
+		/* Mostly nulls */
+		*value = row;
+		return bench_hash64(row) % 10 == 0;
+	}
+	else
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("unknown benchmark dataset \"%s\"", dataset),
+				 errhint("Use one of sequential, timestamps, random, repeated, low_cardinality, "
+						 "sparse, or the path of a compressed data file.")));
+
+	return true;
+}
+
+static Datum
+bench_value_to_datum(Oid type, int64 value)
+{
+	switch (type)
+	{
+		case INT2OID:
+			return Int16GetDatum((int16) value);
+		case INT4OID:
+			return Int32GetDatum((int32) value);
+		case DATEOID:
+			return DateADTGetDatum((DateADT) (value % (INT64CONST(100000))));
+		case INT8OID:
+			return Int64GetDatum(value);
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			return TimestampTzGetDatum(value);
+		case FLOAT4OID:
+			return Float4GetDatum((float4) value / 100);
+		case FLOAT8OID:
+			return Float8GetDatum((float8) value / 100);
+		case TEXTOID:
+			return PointerGetDatum(cstring_to_text(psprintf(INT64_FORMAT, value)));
+		default:
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("synthetic benchmark data is not supported for type %s",
+							format_type_be(type))));
+			pg_unreachable();
+	}
+}
+
+static void
+bench_input_synthetic(BenchInput *input, const char *dataset)
+{
+	for (int row = 0; row < BENCH_BATCH_ROWS; row++)
+	{
+		int64 value;
+
+		input->nulls[row] = !bench_synthetic_value(dataset, row, &value);
+		if (!input->nulls[row])
+			input->values[row] = bench_value_to_datum(input->type, value);
+	}
+	input->n_rows = BENCH_BATCH_ROWS;
+}
+
+/*
+ * Read the values from a compressed data file, as produced by the fuzzing.
+ * The file contains the algorithm id followed by the binary send format of
+ * the compressed data.
+ */
+static void
+bench_input_from_file(BenchInput *input, const char *path)
+{
+	FILE *f = AllocateFile(path, PG_BINARY_R);
+
+	if (f == NULL)
+		ereport(ERROR,
+				(errcode_for_file_access(), errmsg("could not open file \"%s\": %m", path)));
+
+	StringInfoData buf;
+	char chunk[8192];
+	size_t n;
+
+	initStringInfo(&buf);
+	while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+		appendBinaryStringInfo(&buf, chunk, n);
+
+	if (ferror(f))
+		ereport(ERROR,
+				(errcode_for_file_access(), errmsg("could not read file \"%s\": %m", path)));
+	FreeFile(f);
+
+	if (buf.len == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("file \"%s\" is empty", path)));
+
+	Datum compressed = DirectFunctionCall1(tsl_compressed_data_recv, PointerGetDatum(&buf));
+	CompressedDataHeader *header = (CompressedDataHeader *) PG_DETOAST_DATUM(compressed);
+	DecompressionIterator *iter =
+		tsl_get_decompression_iterator_init(header->compression_algorithm,
+											/* reverse = */ false)(PointerGetDatum(header),
+																   input->type);
+
+	input->n_rows = 0;
+	for (DecompressResult r = iter->try_next(iter); !r.is_done; r = iter->try_next(iter))
+	{
+		if (input->n_rows >= BENCH_BATCH_ROWS)
+			break;
+
+		input->values[input->n_rows] = r.val;
+		input->nulls[input->n_rows] = r.is_null;
+		input->n_rows++;
+	}
+}
+
+static void
+bench_input_init(BenchInput *input, Oid type, const char *dataset)
+{
+	int16 typlen = get_typlen(type);
+
+	input->type = type;
+
+	if (is_absolute_path(dataset))
+		bench_input_from_file(input, dataset);
+	else
+		bench_input_synthetic(input, dataset);
+
+	input->uncompressed_bytes = 0;
+	for (int i = 0; i < input->n_rows; i++)
+	{
+		if (input->nulls[i])
+			continue;
+
+		input->uncompressed_bytes +=
+			typlen > 0 ? typlen : (int64) VARSIZE_ANY(DatumGetPointer(input->values[i]));
+	}
+}
+
+static void *
+bench_compress(CompressionAlgorithms algo, const BenchInput *input)
+{
+	Compressor *compressor = compressor_for_algorithm_and_type(algo, input->type);
+
+	for (int i = 0; i < input->n_rows; i++)
+	{
+		if (input->nulls[i])
+			compressor->append_null(compressor);
+		else
+			compressor->append_val(compressor, input->values[i]);
+	}
+
+	return compressor->finish(compressor);
+}
+
+static void
+bench_run(CompressionAlgorithms algo, const BenchInput *input, int iterations,
+		  BenchResult results[_BENCH_PHASES], int64 *compressed_bytes)
+{
+	MemoryContext iteration_context = AllocSetContextCreate(CurrentMemoryContext,
+															"compression benchmark",
+															ALLOCSET_DEFAULT_SIZES);
+	MemoryContext old_context = CurrentMemoryContext;
+	DecompressionIterator *(*iterator_init_forward)(Datum, Oid) =
+		tsl_get_decompression_iterator_init(algo, /* reverse = */ false);
+	DecompressionIterator *(*iterator_init_reverse)(Datum, Oid) =
+		tsl_get_decompression_iterator_init(algo, /* reverse = */ true);
+	DecompressAllFunction decompress_all = tsl_get_decompress_all_function(algo, input->type);
+	instr_time start;
+	instr_time duration;
+
+	/* The compressed data that the decompression phases work on */
+	void *compressed = bench_compress(algo, input);
+	if (compressed == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("the benchmark dataset has no non-null values")));
+	*compressed_bytes = VARSIZE(compressed);
+
+	memset(results, 0, sizeof(BenchResult) * _BENCH_PHASES);
+
+	for (BenchPhase phase = 0; phase < _BENCH_PHASES; phase++)
+	{
+		int64 values = 0;
+
+		if (phase == BENCH_DECOMPRESS_ALL && decompress_all == NULL)
+		{
+			results[phase].skipped = true;
+			continue;
+		}
+
+		MemoryContextSwitchTo(iteration_context);
+		INSTR_TIME_SET_CURRENT(start);
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			switch (phase)
+			{
+				case BENCH_COMPRESS:
+					bench_compress(algo, input);
+					values += input->n_rows;
+					break;
+				case BENCH_DECOMPRESS_FORWARD:
+				case BENCH_DECOMPRESS_REVERSE:
+				{
+					DecompressionIterator *iter =
+						(phase == BENCH_DECOMPRESS_FORWARD ?
+							 iterator_init_forward :
+							 iterator_init_reverse)(PointerGetDatum(compressed), input->type);
+					for (DecompressResult r = iter->try_next(iter); !r.is_done;
+						 r = iter->try_next(iter))
+						values++;
+					break;
+				}
+				case BENCH_DECOMPRESS_ALL:
+				{
+					DecompressionArena arena = { .mctx = iteration_context };
+					ArrowArray *arrow =
+						decompress_all(PointerGetDatum(compressed), input->type, &arena);
+					values += arrow->length;
+					break;
+				}
+				case _BENCH_PHASES:
+					pg_unreachable();
+			}
+			MemoryContextReset(iteration_context);
+		}
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, start);
+		MemoryContextSwitchTo(old_context);
+
+		results[phase].seconds = INSTR_TIME_GET_DOUBLE(duration);
+		results[phase].values = values;
+	}
+
+	MemoryContextDelete(iteration_context);
+}
+
+TS_FUNCTION_INFO_V1(ts_bench_compression);
+
+/*
+ * Benchmark one compression algorithm on one dataset. Returns a row for each
+ * phase with the throughput in values and in uncompressed megabytes per
+ * second, and the compression ratio.
+ */
+Datum
+ts_bench_compression(PG_FUNCTION_ARGS)
+{
+	/* Output columns of this function. */
+	enum
+	{
+		out_phase = 0,
+		out_values,
+		out_uncompressed_bytes,
+		out_compressed_bytes,
+		out_ratio,
+		out_ns_per_value,
+		out_mb_per_s,
+		_out_columns
+	};
+
+	/* Cross-call context for this set-returning function. */
+	struct user_context
+	{
+		BenchResult results[_BENCH_PHASES];
+		int64 uncompressed_bytes;
+		int64 compressed_bytes;
+		int iterations;
+		BenchPhase next_phase;
+	};
+
+	FuncCallContext *funcctx;
+	struct user_context *c;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		const CompressionAlgorithms algo = bench_get_algorithm(PG_GETARG_CSTRING(0));
+		const Oid type = PG_GETARG_OID(1);
+		const char *dataset = PG_GETARG_CSTRING(2);
+		const int iterations = PG_GETARG_INT32(3);
+		MemoryContext call_memory_context;
+
+		if (iterations <= 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("the number of iterations must be positive")));
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		call_memory_context = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &funcctx->tuple_desc) != TYPEFUNC_COMPOSITE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("function returning record called in context "
+							"that cannot accept type record")));
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+
+		c = palloc0(sizeof(struct user_context));
+		c->iterations = iterations;
+		funcctx->user_fctx = c;
+
+		/* The benchmark itself doesn't need to survive across calls */
+		MemoryContextSwitchTo(call_memory_context);
+
+		BenchInput *input = palloc0(sizeof(BenchInput));
+		bench_input_init(input, type, dataset);
+		c->uncompressed_bytes = input->uncompressed_bytes;
+		bench_run(algo, input, iterations, c->results, &c->compressed_bytes);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	c = (struct user_context *) funcctx->user_fctx;
+
+	while (c->next_phase < _BENCH_PHASES)
+	{
+		const BenchPhase phase = c->next_phase++;
+		const BenchResult *result = &c->results[phase];
+		Datum values[_out_columns] = { 0 };
+		bool nulls[_out_columns] = { 0 };
+
+		if (result->skipped)
+			continue;
+
+		values[out_phase] = CStringGetTextDatum(bench_phase_names[phase]);
+		values[out_values] = Int64GetDatum(result->values);
+		values[out_uncompressed_bytes] = Int64GetDatum(c->uncompressed_bytes);
+		values[out_compressed_bytes] = Int64GetDatum(c->compressed_bytes);
+		values[out_ratio] = Float8GetDatum((double) c->uncompressed_bytes / c->compressed_bytes);
+		values[out_ns_per_value] =
+			Float8GetDatum(result->values > 0 ? result->seconds * 1e9 / result->values : 0);
+		values[out_mb_per_s] =
+			Float8GetDatum(result->seconds > 0 ? (double) c->uncompressed_bytes * c->iterations /
+													 result->seconds / (1024 * 1024) :
+												 0);
+
+		SRF_RETURN_NEXT(funcctx,
+						HeapTupleGetDatum(heap_form_tuple(funcctx->tuple_desc, values, nulls)));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+#endif
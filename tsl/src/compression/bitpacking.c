@@ -0,0 +1,631 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#include "compression/bitpacking.h"
+
+#include <catalog/pg_type.h>
+#include <libpq/pqformat.h>
+#include <port/pg_bitutils.h>
+#include <utils/builtins.h>
+#include <utils/date.h>
+#include <utils/timestamp.h>
+
+#include "compression/arrow_c_data_interface.h"
+#include "compression/compression.h"
+#include "compression/simple8b_rle.h"
+#include "compression/simple8b_rle_bitmap.h"
+
+typedef struct BitpackingCompressed
+{
+	CompressedDataHeaderFields;
+	uint8 has_nulls; /* 1 if this has a NULLs bitmap after the packed values, 0 otherwise */
+	uint8 bit_width; /* 0 to 64 bits per value */
+	uint8 padding[1];
+	uint32 num_values; /* the number of non-null values */
+	uint32 padding2;
+	uint64 reference; /* the minimal value, subtracted from all values */
+	/* the packed values as uint64 words, followed by the NULLs bitmap if any */
+	uint64 packed[FLEXIBLE_ARRAY_MEMBER];
+} BitpackingCompressed;
+
+static void
+pg_attribute_unused() assertions(void)
+{
+	BitpackingCompressed test_val = { .vl_len_ = { 0 } };
+	/* make sure no padding bytes make it to disk */
+	StaticAssertStmt(sizeof(BitpackingCompressed) ==
+						 sizeof(test_val.vl_len_) + sizeof(test_val.compression_algorithm) +
+							 sizeof(test_val.has_nulls) + sizeof(test_val.bit_width) +
+							 sizeof(test_val.padding) + sizeof(test_val.num_values) +
+							 sizeof(test_val.padding2) + sizeof(test_val.reference),
+					 "BitpackingCompressed wrong size");
+	StaticAssertStmt(sizeof(BitpackingCompressed) == 24, "BitpackingCompressed wrong size");
+}
+
+typedef struct BitpackingDecompressionIterator
+{
+	DecompressionIterator base;
+	const uint64 *packed;
+	uint64 reference;
+	uint8 bit_width;
+	/* the index of the next value to return, counting from 0 or from the end */
+	uint32 next_value;
+	uint32 num_values;
+	Simple8bRleDecompressionIterator nulls;
+	bool has_nulls;
+} BitpackingDecompressionIterator;
+
+typedef struct BitpackingCompressor
+{
+	/*
+	 * The frame of reference and the bit width depend on all values, so we
+	 * have to accumulate them before packing.
+	 */
+	uint64 *values;
+	uint32 num_values;
+	uint32 max_values;
+	Simple8bRleCompressor nulls;
+	bool has_nulls;
+} BitpackingCompressor;
+
+typedef struct ExtendedCompressor
+{
+	Compressor base;
+	BitpackingCompressor *internal;
+} ExtendedCompressor;
+
+static inline uint32
+bitpacking_num_words(uint32 num_values, uint8 bit_width)
+{
+	return ((uint64) num_values * bit_width + 63) / 64;
+}
+
+static inline uint64
+bitpacking_mask(uint8 bit_width)
+{
+	return bit_width == 64 ? PG_UINT64_MAX : (UINT64CONST(1) << bit_width) - 1;
+}
+
+static inline uint64
+bitpacking_unpack(const uint64 *packed, uint8 bit_width, uint32 index)
+{
+	if (bit_width == 0)
+		return 0;
+
+	const uint64 bit = (uint64) index * bit_width;
+	const uint64 word = bit / 64;
+	const uint32 shift = bit % 64;
+	uint64 value = packed[word] >> shift;
+	if (shift + bit_width > 64)
+		value |= packed[word + 1] << (64 - shift);
+
+	return value & bitpacking_mask(bit_width);
+}
+
+static void
+bitpacking_compressor_append_int16(Compressor *compressor, Datum val)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = bitpacking_compressor_alloc();
+
+	bitpacking_compressor_append_value(extended->internal, DatumGetInt16(val));
+}
+
+static void
+bitpacking_compressor_append_int32(Compressor *compressor, Datum val)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = bitpacking_compressor_alloc();
+
+	bitpacking_compressor_append_value(extended->internal, DatumGetInt32(val));
+}
+
+static void
+bitpacking_compressor_append_int64(Compressor *compressor, Datum val)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = bitpacking_compressor_alloc();
+
+	bitpacking_compressor_append_value(extended->internal, DatumGetInt64(val));
+}
+
+static void
+bitpacking_compressor_append_date(Compressor *compressor, Datum val)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = bitpacking_compressor_alloc();
+
+	bitpacking_compressor_append_value(extended->internal, DatumGetDateADT(val));
+}
+
+static void
+bitpacking_compressor_append_timestamp(Compressor *compressor, Datum val)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = bitpacking_compressor_alloc();
+
+	bitpacking_compressor_append_value(extended->internal, DatumGetTimestamp(val));
+}
+
+static void
+bitpacking_compressor_append_timestamptz(Compressor *compressor, Datum val)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = bitpacking_compressor_alloc();
+
+	bitpacking_compressor_append_value(extended->internal, DatumGetTimestampTz(val));
+}
+
+static void
+bitpacking_compressor_append_null_value(Compressor *compressor)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = bitpacking_compressor_alloc();
+
+	bitpacking_compressor_append_null(extended->internal);
+}
+
+static void *
+bitpacking_compressor_finish_and_reset(Compressor *compressor)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		return NULL;
+
+	void *compressed = bitpacking_compressor_finish(extended->internal);
+	pfree(extended->internal->values);
+	pfree(extended->internal);
+	extended->internal = NULL;
+	return compressed;
+}
+
+const Compressor bitpacking_uint16_compressor = {
+	.append_val = bitpacking_compressor_append_int16,
+	.append_null = bitpacking_compressor_append_null_value,
+	.finish = bitpacking_compressor_finish_and_reset,
+};
+
+const Compressor bitpacking_uint32_compressor = {
+	.append_val = bitpacking_compressor_append_int32,
+	.append_null = bitpacking_compressor_append_null_value,
+	.finish = bitpacking_compressor_finish_and_reset,
+};
+
+const Compressor bitpacking_uint64_compressor = {
+	.append_val = bitpacking_compressor_append_int64,
+	.append_null = bitpacking_compressor_append_null_value,
+	.finish = bitpacking_compressor_finish_and_reset,
+};
+
+const Compressor bitpacking_date_compressor = {
+	.append_val = bitpacking_compressor_append_date,
+	.append_null = bitpacking_compressor_append_null_value,
+	.finish = bitpacking_compressor_finish_and_reset,
+};
+
+const Compressor bitpacking_timestamp_compressor = {
+	.append_val = bitpacking_compressor_append_timestamp,
+	.append_null = bitpacking_compressor_append_null_value,
+	.finish = bitpacking_compressor_finish_and_reset,
+};
+
+const Compressor bitpacking_timestamptz_compressor = {
+	.append_val = bitpacking_compressor_append_timestamptz,
+	.append_null = bitpacking_compressor_append_null_value,
+	.finish = bitpacking_compressor_finish_and_reset,
+};
+
+Compressor *
+bitpacking_compressor_for_type(Oid element_type)
+{
+	ExtendedCompressor *compressor = palloc(sizeof(*compressor));
+	switch (element_type)
+	{
+		case INT2OID:
+			*compressor = (ExtendedCompressor){ .base = bitpacking_uint16_compressor };
+			return &compressor->base;
+		case INT4OID:
+			*compressor = (ExtendedCompressor){ .base = bitpacking_uint32_compressor };
+			return &compressor->base;
+		case INT8OID:
+			*compressor = (ExtendedCompressor){ .base = bitpacking_uint64_compressor };
+			return &compressor->base;
+		case DATEOID:
+			*compressor = (ExtendedCompressor){ .base = bitpacking_date_compressor };
+			return &compressor->base;
+		case TIMESTAMPOID:
+			*compressor = (ExtendedCompressor){ .base = bitpacking_timestamp_compressor };
+			return &compressor->base;
+		case TIMESTAMPTZOID:
+			*compressor = (ExtendedCompressor){ .base = bitpacking_timestamptz_compressor };
+			return &compressor->base;
+		default:
+			elog(ERROR,
+				 "invalid type for bitpacking compressor \"%s\"",
+				 format_type_be(element_type));
+	}
+
+	pg_unreachable();
+}
+
+BitpackingCompressor *
+bitpacking_compressor_alloc(void)
+{
+	BitpackingCompressor *compressor = palloc0(sizeof(*compressor));
+	compressor->max_values = 64;
+	compressor->values = palloc(sizeof(*compressor->values) * compressor->max_values);
+	simple8brle_compressor_init(&compressor->nulls);
+	return compressor;
+}
+
+void
+bitpacking_compressor_append_null(BitpackingCompressor *compressor)
+{
+	compressor->has_nulls = true;
+	simple8brle_compressor_append(&compressor->nulls, 1);
+}
+
+void
+bitpacking_compressor_append_value(BitpackingCompressor *compressor, int64 next_val)
+{
+	if (compressor->num_values == compressor->max_values)
+	{
+		if (compressor->max_values >= PG_UINT32_MAX / 2)
+			ereport(ERROR,
+					(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+					 errmsg("too many values for bitpacking compression")));
+
+		compressor->max_values *= 2;
+		compressor->values =
+			repalloc(compressor->values, sizeof(*compressor->values) * compressor->max_values);
+	}
+
+	/*
+	 * We perform all arithmetic using unsigned values, so that the difference
+	 * with the reference value doesn't overflow.
+	 */
+	compressor->values[compressor->num_values++] = (uint64) next_val;
+	simple8brle_compressor_append(&compressor->nulls, 0);
+}
+
+static BitpackingCompressed *
+bitpacking_from_parts(uint64 reference, uint8 bit_width, uint32 num_values, const uint64 *packed,
+					  Simple8bRleSerialized *nulls)
+{
+	const Size packed_size = sizeof(uint64) * bitpacking_num_words(num_values, bit_width);
+	const uint32 nulls_size = nulls != NULL ? simple8brle_serialized_total_size(nulls) : 0;
+	const Size compressed_size = sizeof(BitpackingCompressed) + packed_size + nulls_size;
+
+	if (!AllocSizeIsValid(compressed_size))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("compressed size exceeds the maximum allowed (%d)", (int) MaxAllocSize)));
+
+	char *compressed_data = palloc0(compressed_size);
+	BitpackingCompressed *compressed = (BitpackingCompressed *) compressed_data;
+	SET_VARSIZE(&compressed->vl_len_, compressed_size);
+
+	compressed->compression_algorithm = COMPRESSION_ALGORITHM_BITPACKING;
+	compressed->has_nulls = nulls_size != 0 ? 1 : 0;
+	compressed->bit_width = bit_width;
+	compressed->num_values = num_values;
+	compressed->reference = reference;
+
+	if (packed_size > 0)
+		memcpy(compressed->packed, packed, packed_size);
+
+	if (compressed->has_nulls == 1)
+	{
+		CheckCompressedData(nulls->num_elements > num_values);
+		compressed_data += sizeof(*compressed) + packed_size;
+		bytes_serialize_simple8b_and_advance(compressed_data, nulls_size, nulls);
+	}
+
+	return compressed;
+}
+
+void *
+bitpacking_compressor_finish(BitpackingCompressor *compressor)
+{
+	Simple8bRleSerialized *nulls = simple8brle_compressor_finish(&compressor->nulls);
+
+	if (compressor->num_values == 0)
+		return NULL;
+
+	/* The frame of reference is the minimal value. */
+	int64 min = (int64) compressor->values[0];
+	int64 max = min;
+	for (uint32 i = 1; i < compressor->num_values; i++)
+	{
+		const int64 value = (int64) compressor->values[i];
+		min = Min(min, value);
+		max = Max(max, value);
+	}
+
+	const uint64 reference = (uint64) min;
+	const uint64 range = ((uint64) max) - reference;
+	const uint8 bit_width = range == 0 ? 0 : pg_leftmost_one_pos64(range) + 1;
+
+	const uint32 num_words = bitpacking_num_words(compressor->num_values, bit_width);
+	uint64 *packed = palloc0(sizeof(uint64) * (num_words + 1));
+	for (uint32 i = 0; i < compressor->num_values && bit_width > 0; i++)
+	{
+		const uint64 value = compressor->values[i] - reference;
+		const uint64 bit = (uint64) i * bit_width;
+		const uint64 word = bit / 64;
+		const uint32 shift = bit % 64;
+		packed[word] |= value << shift;
+		if (shift + bit_width > 64)
+			packed[word + 1] |= value >> (64 - shift);
+	}
+
+	BitpackingCompressed *compressed = bitpacking_from_parts(reference,
+															 bit_width,
+															 compressor->num_values,
+															 packed,
+															 compressor->has_nulls ? nulls : NULL);
+	pfree(packed);
+
+	Assert(compressed->compression_algorithm == COMPRESSION_ALGORITHM_BITPACKING);
+	return compressed;
+}
+
+/**********************************************************************************/
+/**********************************************************************************/
+
+static void
+bitpacking_decompression_iterator_init(BitpackingDecompressionIterator *iter, void *compressed,
+									   Oid element_type, bool forward)
+{
+	StringInfoData si = { .data = compressed, .len = VARSIZE(compressed) };
+	BitpackingCompressed *header = consumeCompressedData(&si, sizeof(BitpackingCompressed));
+
+	CheckCompressedData(header->has_nulls == 0 || header->has_nulls == 1);
+	CheckCompressedData(header->bit_width <= 64);
+
+	const uint64 *packed =
+		consumeCompressedData(&si,
+							  sizeof(uint64) *
+								  bitpacking_num_words(header->num_values, header->bit_width));
+
+	*iter = (BitpackingDecompressionIterator){
+		.base = {
+			.compression_algorithm = COMPRESSION_ALGORITHM_BITPACKING,
+			.forward = forward,
+			.element_type = element_type,
+			.try_next = forward ? bitpacking_decompression_iterator_try_next_forward :
+								  bitpacking_decompression_iterator_try_next_reverse,
+		},
+		.packed = packed,
+		.reference = header->reference,
+		.bit_width = header->bit_width,
+		.next_value = 0,
+		.num_values = header->num_values,
+		.has_nulls = header->has_nulls == 1,
+	};
+
+	if (iter->has_nulls)
+	{
+		Simple8bRleSerialized *nulls = bytes_deserialize_simple8b_and_advance(&si);
+		if (forward)
+			simple8brle_decompression_iterator_init_forward(&iter->nulls, nulls);
+		else
+			simple8brle_decompression_iterator_init_reverse(&iter->nulls, nulls);
+	}
+}
+
+static inline DecompressResult
+convert_from_internal(DecompressResultInternal res_internal, Oid element_type)
+{
+	if (res_internal.is_done || res_internal.is_null)
+	{
+		return (DecompressResult){
+			.is_done = res_internal.is_done,
+			.is_null = res_internal.is_null,
+		};
+	}
+
+	switch (element_type)
+	{
+		case INT8OID:
+			return (DecompressResult){
+				.val = Int64GetDatum(res_internal.val),
+			};
+		case INT4OID:
+			return (DecompressResult){
+				.val = Int32GetDatum(res_internal.val),
+			};
+		case INT2OID:
+			return (DecompressResult){
+				.val = Int16GetDatum(res_internal.val),
+			};
+		case DATEOID:
+			return (DecompressResult){
+				.val = DateADTGetDatum(res_internal.val),
+			};
+		case TIMESTAMPTZOID:
+			return (DecompressResult){
+				.val = TimestampTzGetDatum(res_internal.val),
+			};
+		case TIMESTAMPOID:
+			return (DecompressResult){
+				.val = TimestampGetDatum(res_internal.val),
+			};
+		default:
+			elog(ERROR,
+				 "invalid type requested from bitpacking decompression \"%s\"",
+				 format_type_be(element_type));
+	}
+
+	pg_unreachable();
+}
+
+static DecompressResultInternal
+bitpacking_decompression_iterator_try_next_internal(BitpackingDecompressionIterator *iter)
+{
+	/* check for a null value */
+	if (iter->has_nulls)
+	{
+		Simple8bRleDecompressResult result =
+			iter->base.forward ?
+				simple8brle_decompression_iterator_try_next_forward(&iter->nulls) :
+				simple8brle_decompression_iterator_try_next_reverse(&iter->nulls);
+		if (result.is_done)
+			return (DecompressResultInternal){
+				.is_done = true,
+			};
+
+		if (result.val != 0)
+		{
+			CheckCompressedData(result.val == 1);
+			return (DecompressResultInternal){
+				.is_null = true,
+			};
+		}
+	}
+
+	if (iter->next_value >= iter->num_values)
+		return (DecompressResultInternal){
+			.is_done = true,
+		};
+
+	const uint32 index =
+		iter->base.forward ? iter->next_value : iter->num_values - 1 - iter->next_value;
+	iter->next_value++;
+
+	return (DecompressResultInternal){
+		.val = iter->reference + bitpacking_unpack(iter->packed, iter->bit_width, index),
+	};
+}
+
+DecompressResult
+bitpacking_decompression_iterator_try_next_forward(DecompressionIterator *iter)
+{
+	Assert(iter->compression_algorithm == COMPRESSION_ALGORITHM_BITPACKING && iter->forward);
+	return convert_from_internal(bitpacking_decompression_iterator_try_next_internal(
+									 (BitpackingDecompressionIterator *) iter),
+								 iter->element_type);
+}
+
+DecompressResult
+bitpacking_decompression_iterator_try_next_reverse(DecompressionIterator *iter)
+{
+	Assert(iter->compression_algorithm == COMPRESSION_ALGORITHM_BITPACKING && !iter->forward);
+	return convert_from_internal(bitpacking_decompression_iterator_try_next_internal(
+									 (BitpackingDecompressionIterator *) iter),
+								 iter->element_type);
+}
+
+DecompressionIterator *
+bitpacking_decompression_iterator_from_datum_forward(Datum compressed, Oid element_type)
+{
+	BitpackingDecompressionIterator *iterator = palloc(sizeof(*iterator));
+	bitpacking_decompression_iterator_init(iterator,
+										   (void *) PG_DETOAST_DATUM(compressed),
+										   element_type,
+										   /* forward = */ true);
+	return &iterator->base;
+}
+
+DecompressionIterator *
+bitpacking_decompression_iterator_from_datum_reverse(Datum compressed, Oid element_type)
+{
+	BitpackingDecompressionIterator *iterator = palloc(sizeof(*iterator));
+	bitpacking_decompression_iterator_init(iterator,
+										   (void *) PG_DETOAST_DATUM(compressed),
+										   element_type,
+										   /* forward = */ false);
+	return &iterator->base;
+}
+
+/* Functions for bulk decompression. */
+#define ELEMENT_TYPE uint16
+#include "bitpacking_impl.c"
+#undef ELEMENT_TYPE
+
+#define ELEMENT_TYPE uint32
+#include "bitpacking_impl.c"
+#undef ELEMENT_TYPE
+
+#define ELEMENT_TYPE uint64
+#include "bitpacking_impl.c"
+#undef ELEMENT_TYPE
+
+ArrowArray *
+bitpacking_decompress_all(Datum compressed_data, Oid element_type, DecompressionArena *dest)
+{
+	switch (element_type)
+	{
+		case INT8OID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			return bitpacking_decompress_all_uint64(compressed_data, dest);
+		case INT4OID:
+		case DATEOID:
+			return bitpacking_decompress_all_uint32(compressed_data, dest);
+		case INT2OID:
+			return bitpacking_decompress_all_uint16(compressed_data, dest);
+		default:
+			elog(ERROR,
+				 "type '%s' is not supported for bitpacking decompression",
+				 format_type_be(element_type));
+			pg_unreachable();
+	}
+}
+
+/**********************************************************************************/
+/**********************************************************************************/
+
+void
+bitpacking_compressed_send(CompressedDataHeader *header, StringInfo buffer)
+{
+	const BitpackingCompressed *data = (BitpackingCompressed *) header;
+	Assert(header->compression_algorithm == COMPRESSION_ALGORITHM_BITPACKING);
+	pq_sendbyte(buffer, data->has_nulls);
+	pq_sendbyte(buffer, data->bit_width);
+	pq_sendint32(buffer, data->num_values);
+	pq_sendint64(buffer, data->reference);
+
+	const uint32 num_words = bitpacking_num_words(data->num_values, data->bit_width);
+	for (uint32 i = 0; i < num_words; i++)
+		pq_sendint64(buffer, data->packed[i]);
+
+	if (data->has_nulls)
+		simple8brle_serialized_send(buffer, (Simple8bRleSerialized *) &data->packed[num_words]);
+}
+
+Datum
+bitpacking_compressed_recv(StringInfo buffer)
+{
+	Simple8bRleSerialized *nulls = NULL;
+
+	const uint8 has_nulls = pq_getmsgbyte(buffer);
+	CheckCompressedData(has_nulls == 0 || has_nulls == 1);
+
+	const uint8 bit_width = pq_getmsgbyte(buffer);
+	CheckCompressedData(bit_width <= 64);
+
+	const uint32 num_values = pq_getmsgint(buffer, 4);
+	const uint64 reference = pq_getmsgint64(buffer);
+
+	const uint32 num_words = bitpacking_num_words(num_values, bit_width);
+	CheckCompressedData(num_words <= (uint32) (buffer->len - buffer->cursor) / sizeof(uint64));
+	uint64 *packed = palloc(sizeof(uint64) * (num_words + 1));
+	for (uint32 i = 0; i < num_words; i++)
+		packed[i] = pq_getmsgint64(buffer);
+
+	if (has_nulls)
+		nulls = simple8brle_serialized_recv(buffer);
+
+	PG_RETURN_POINTER(bitpacking_from_parts(reference, bit_width, num_values, packed, nulls));
+}
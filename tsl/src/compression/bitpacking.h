@@ -0,0 +1,63 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+/*
+ * Bitpacking is used to encode integers or integer-like objects (e.g.
+ * timestamps) that have a small range of values, e.g. status codes or bounded
+ * sensor readings. It uses the frame-of-reference encoding: we store the
+ * minimal value once, and then subtract it from every value and pack the
+ * differences using the minimal bit width that fits all of them.
+ *
+ * Unlike deltadelta, each value can be unpacked independently of the others,
+ * so the bulk decompression is a simple loop without dependencies between the
+ * iterations.
+ */
+#ifndef TIMESCALEDB_TSL_COMPRESSION_BITPACKING_H
+#define TIMESCALEDB_TSL_COMPRESSION_BITPACKING_H
+
+#include <postgres.h>
+#include <c.h>
+#include <fmgr.h>
+#include <lib/stringinfo.h>
+
+#include "compression/compression.h"
+
+typedef struct BitpackingCompressor BitpackingCompressor;
+typedef struct BitpackingCompressed BitpackingCompressed;
+typedef struct BitpackingDecompressionIterator BitpackingDecompressionIterator;
+
+extern Compressor *bitpacking_compressor_for_type(Oid element_type);
+extern BitpackingCompressor *bitpacking_compressor_alloc(void);
+extern void bitpacking_compressor_append_null(BitpackingCompressor *compressor);
+extern void bitpacking_compressor_append_value(BitpackingCompressor *compressor, int64 next_val);
+extern void *bitpacking_compressor_finish(BitpackingCompressor *compressor);
+
+extern DecompressionIterator *bitpacking_decompression_iterator_from_datum_forward(Datum compressed,
+																				  Oid element_type);
+extern DecompressionIterator *bitpacking_decompression_iterator_from_datum_reverse(Datum compressed,
+																				  Oid element_type);
+extern DecompressResult
+bitpacking_decompression_iterator_try_next_forward(DecompressionIterator *iter);
+extern DecompressResult
+bitpacking_decompression_iterator_try_next_reverse(DecompressionIterator *iter);
+
+extern ArrowArray *bitpacking_decompress_all(Datum compressed_data, Oid element_type,
+											 DecompressionArena *dest);
+
+extern void bitpacking_compressed_send(CompressedDataHeader *header, StringInfo buffer);
+extern Datum bitpacking_compressed_recv(StringInfo buf);
+
+#define BITPACKING_ALGORITHM_DEFINITION                                                            \
+	{                                                                                              \
+		.iterator_init_forward = bitpacking_decompression_iterator_from_datum_forward,             \
+		.iterator_init_reverse = bitpacking_decompression_iterator_from_datum_reverse,             \
+		.decompress_all = bitpacking_decompress_all,                                               \
+		.compressed_data_send = bitpacking_compressed_send,                                        \
+		.compressed_data_recv = bitpacking_compressed_recv,                                        \
+		.compressor_for_type = bitpacking_compressor_for_type,                                     \
+		.compressed_data_storage = TOAST_STORAGE_EXTERNAL,                                         \
+	}
+
+#endif
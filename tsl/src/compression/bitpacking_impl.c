@@ -0,0 +1,153 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Decompress the entire batch of bitpacking-compressed rows into an Arrow array.
+ * Specialized for each supported data type.
+ */
+
+#define FUNCTION_NAME_HELPER(X, Y) X##_##Y
+#define FUNCTION_NAME(X, Y) FUNCTION_NAME_HELPER(X, Y)
+
+static ArrowArray *
+FUNCTION_NAME(bitpacking_decompress_all, ELEMENT_TYPE)(Datum compressed, DecompressionArena *dest)
+{
+	compressed = PointerGetDatum(PG_DETOAST_DATUM(compressed));
+
+	StringInfoData si = { .data = DatumGetPointer(compressed), .len = VARSIZE(compressed) };
+	BitpackingCompressed *header = consumeCompressedData(&si, sizeof(BitpackingCompressed));
+
+	const bool has_nulls = header->has_nulls == 1;
+	const uint8 bit_width = header->bit_width;
+
+	CheckCompressedData(header->has_nulls == 0 || header->has_nulls == 1);
+	CheckCompressedData(bit_width <= 64);
+	CheckCompressedData(header->num_values <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+
+	const uint32 num_words = bitpacking_num_words(header->num_values, bit_width);
+	const uint64 *packed = consumeCompressedData(&si, sizeof(uint64) * num_words);
+
+	Simple8bRleBitmap nulls = { 0 };
+	if (has_nulls)
+	{
+		Simple8bRleSerialized *nulls_compressed = bytes_deserialize_simple8b_and_advance(&si);
+		nulls = simple8brle_bitmap_decompress(nulls_compressed);
+	}
+
+	/*
+	 * Pad the number of elements to multiple of 64 bytes if needed, so that we
+	 * can work in 64-byte blocks.
+	 */
+	const uint16 n_notnull = header->num_values;
+	const uint16 n_total = has_nulls ? nulls.num_elements : n_notnull;
+	const uint16 n_total_padded =
+		((n_total * sizeof(ELEMENT_TYPE) + 63) / 64) * 64 / sizeof(ELEMENT_TYPE);
+	const uint16 n_notnull_padded =
+		((n_notnull * sizeof(ELEMENT_TYPE) + 63) / 64) * 64 / sizeof(ELEMENT_TYPE);
+	Assert(n_total_padded >= n_total);
+	Assert(n_notnull_padded >= n_notnull);
+	CheckCompressedData(n_total >= n_notnull);
+	CheckCompressedData(n_total <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+
+	const int validity_bitmap_bytes = sizeof(uint64) * ((n_total + 64 - 1) / 64);
+	uint64 *restrict validity_bitmap = decompression_arena_alloc(dest, validity_bitmap_bytes);
+
+	/*
+	 * We need additional padding at the end of buffer, because the code that
+	 * converts the elements to postres Datum always reads in 8 bytes.
+	 */
+	const int buffer_bytes = n_total_padded * sizeof(ELEMENT_TYPE) + 8;
+	ELEMENT_TYPE *restrict decompressed_values = decompression_arena_alloc(dest, buffer_bytes);
+
+	/*
+	 * The unpacking loop below always reads the word that follows the one
+	 * with the beginning of the value, and works on the padded number of
+	 * elements, so copy the packed words to a zero-padded buffer. For zero bit
+	 * width, there are no packed words, but we still read the first two.
+	 */
+	const uint32 num_words_padded = bitpacking_num_words(n_notnull_padded, bit_width) + 2;
+	uint64 *restrict words = palloc0(sizeof(uint64) * num_words_padded);
+	memcpy(words, packed, sizeof(uint64) * num_words);
+
+	/*
+	 * Now fill the data w/o nulls. The loop has no branches and no dependencies
+	 * between the iterations, so that the compiler can vectorize it. The second
+	 * word is shifted in two steps, so that we get zero and not an undefined
+	 * shift by 64 when the value starts at the word boundary.
+	 */
+	const uint64 reference = header->reference;
+	const uint64 mask = bitpacking_mask(bit_width);
+	for (uint16 i = 0; i < n_notnull_padded; i++)
+	{
+		const uint32 bit = (uint32) i * bit_width;
+		const uint32 word = bit / 64;
+		const uint32 shift = bit % 64;
+		const uint64 low = words[word] >> shift;
+		const uint64 high = (words[word + 1] << 1) << (63 - shift);
+		decompressed_values[i] = (ELEMENT_TYPE) (reference + ((low | high) & mask));
+	}
+
+	pfree(words);
+
+	/* All data valid by default, we will fill in the nulls later. */
+	memset(validity_bitmap, 0xFF, validity_bitmap_bytes);
+
+	/* Now move the data to account for nulls, and fill the validity bitmap. */
+	if (has_nulls)
+	{
+		/*
+		 * The number of not-null elements we have must be consistent with the
+		 * nulls bitmap.
+		 */
+		CheckCompressedData(n_notnull + simple8brle_bitmap_num_ones(&nulls) == n_total);
+
+		int current_notnull_element = n_notnull - 1;
+		for (int i = n_total - 1; i >= 0; i--)
+		{
+			Assert(i >= current_notnull_element);
+
+			if (simple8brle_bitmap_get_at(&nulls, i))
+			{
+				arrow_set_row_validity(validity_bitmap, i, false);
+			}
+			else
+			{
+				Assert(current_notnull_element >= 0);
+				decompressed_values[i] = decompressed_values[current_notnull_element];
+				current_notnull_element--;
+			}
+		}
+
+		Assert(current_notnull_element == -1);
+	}
+	else
+	{
+		/*
+		 * The validity bitmap size is a multiple of 64 bits. Fill the tail bits
+		 * with zeros, because the corresponding elements are not valid.
+		 */
+		if (n_total % 64)
+		{
+			const uint64 tail_mask = -1ULL >> (64 - n_total % 64);
+			validity_bitmap[n_total / 64] &= tail_mask;
+		}
+	}
+
+	/* Return the result. */
+	ArrowArray *result =
+		decompression_arena_alloc_zero(dest, sizeof(ArrowArray) + sizeof(void *) * 2);
+	const void **buffers = (const void **) &result[1];
+	buffers[0] = validity_bitmap;
+	buffers[1] = decompressed_values;
+	result->n_buffers = 2;
+	result->buffers = buffers;
+	result->length = n_total;
+	result->null_count = n_total - n_notnull;
+	return result;
+}
+
+#undef FUNCTION_NAME
+#undef FUNCTION_NAME_HELPER
@@ -11,6 +11,7 @@
 #include <access/heapam.h>
 #include <access/htup_details.h>
 #include <access/multixact.h>
+#include <access/tableam.h>
 #include <access/valid.h>
 #include <access/xact.h>
 #include <catalog/heap.h>
@@ -20,6 +21,7 @@
 #include <catalog/pg_attribute.h>
 #include <catalog/pg_type.h>
 #include <common/base64.h>
+#include <common/hashfn.h>
 #include <executor/nodeIndexscan.h>
 #include <executor/tuptable.h>
 #include <funcapi.h>
@@ -30,16 +32,19 @@
 #include <nodes/pg_list.h>
 #include <nodes/print.h>
 #include <parser/parsetree.h>
+#include <storage/bufmgr.h>
 #include <storage/lmgr.h>
 #include <storage/predicate.h>
 #include <utils/builtins.h>
 #include <utils/datum.h>
 #include <utils/fmgroids.h>
+#include <utils/inval.h>
 #include <utils/lsyscache.h>
 #include <utils/memutils.h>
 #include <utils/rel.h>
 #include <utils/relcache.h>
 #include <utils/snapmgr.h>
+#include <utils/sortsupport.h>
 #include <utils/syscache.h>
 #include <utils/tuplesort.h>
 #include <utils/typcache.h>
@@ -49,9 +54,11 @@
 
 #include "array.h"
 #include "chunk.h"
+#include "api.h"
 #include "create.h"
 #include "custom_type_cache.h"
 #include "arrow_c_data_interface.h"
+#include "bitpacking.h"
 #include "debug_point.h"
 #include "deltadelta.h"
 #include "dictionary.h"
@@ -59,6 +66,8 @@
 #include "guc.h"
 #include "nodes/chunk_dispatch/chunk_insert_state.h"
 #include "indexing.h"
+#include "parallel_sort.h"
+#include "radix_sort.h"
 #include "segment_meta.h"
 #include "ts_catalog/compression_chunk_size.h"
 #include "ts_catalog/hypertable_compression.h"
@@ -68,6 +77,7 @@ static const CompressionAlgorithmDefinition definitions[_END_COMPRESSION_ALGORIT
 	[COMPRESSION_ALGORITHM_DICTIONARY] = DICTIONARY_ALGORITHM_DEFINITION,
 	[COMPRESSION_ALGORITHM_GORILLA] = GORILLA_ALGORITHM_DEFINITION,
 	[COMPRESSION_ALGORITHM_DELTADELTA] = DELTA_DELTA_ALGORITHM_DEFINITION,
+	[COMPRESSION_ALGORITHM_BITPACKING] = BITPACKING_ALGORITHM_DEFINITION,
 };
 
 #if PG14_GE
@@ -103,7 +113,7 @@ write_logical_replication_msg_decompression_end()
 #endif
 }
 
-static Compressor *
+Compressor *
 compressor_for_algorithm_and_type(CompressionAlgorithms algorithm, Oid type)
 {
 	if (algorithm >= _END_COMPRESSION_ALGORITHMS)
@@ -125,16 +135,56 @@ DecompressionIterator *(*tsl_get_decompression_iterator_init(CompressionAlgorith
 }
 
 DecompressAllFunction
-tsl_get_decompress_all_function(CompressionAlgorithms algorithm)
+tsl_get_decompress_all_function(CompressionAlgorithms algorithm, Oid type)
 {
 	if (algorithm >= _END_COMPRESSION_ALGORITHMS)
 		elog(ERROR, "invalid compression algorithm %d", algorithm);
 
+	/*
+	 * The bulk dictionary decompression uses the bulk array decompression for
+	 * the dictionary items, so it supports the same types.
+	 */
+	if ((algorithm == COMPRESSION_ALGORITHM_ARRAY ||
+		 algorithm == COMPRESSION_ALGORITHM_DICTIONARY) &&
+		!array_decompress_all_supports_type(type))
+		return NULL;
+
 	return definitions[algorithm].decompress_all;
 }
 
+/*
+ * Detoast the compressed datum, fetching only the part of it that is required
+ * to decompress its first num_rows rows, if the compression algorithm supports
+ * this. The result might contain more rows than requested. It can only be
+ * decompressed in the forward direction.
+ */
+Datum
+tsl_detoast_compressed_prefix(Datum compressed, int num_rows)
+{
+	Assert(num_rows > 0);
+
+	if (!VARATT_IS_EXTENDED(DatumGetPointer(compressed)))
+		return compressed;
+
+	/* Fetch just enough to find out the compression algorithm. */
+	CompressedDataHeader *header = (CompressedDataHeader *)
+		PG_DETOAST_DATUM_SLICE(compressed, 0, sizeof(CompressedDataHeader) - VARHDRSZ);
+	const CompressionAlgorithms algorithm = header->compression_algorithm;
+	pfree(header);
+
+	if (algorithm >= _END_COMPRESSION_ALGORITHMS)
+		elog(ERROR, "invalid compression algorithm %d", algorithm);
+
+	if (definitions[algorithm].detoast_prefix == NULL)
+		return PointerGetDatum(PG_DETOAST_DATUM(compressed));
+
+	return definitions[algorithm].detoast_prefix(compressed, num_rows);
+}
+
 static Tuplesortstate *compress_chunk_sort_relation(Relation in_rel, int n_keys,
-													const ColumnCompressionInfo **keys);
+													const ColumnCompressionInfo **keys,
+													ParallelCompressionSort **parallel_sort,
+													CompressionRadixSort **radix_sort);
 static void row_compressor_process_ordered_slot(RowCompressor *row_compressor, TupleTableSlot *slot,
 												CommandId mycid);
 static void row_compressor_update_group(RowCompressor *row_compressor, TupleTableSlot *row);
@@ -143,12 +193,15 @@ static bool row_compressor_new_row_is_in_new_group(RowCompressor *row_compressor
 static void row_compressor_append_row(RowCompressor *row_compressor, TupleTableSlot *row);
 static void row_compressor_flush(RowCompressor *row_compressor, CommandId mycid,
 								 bool changed_groups);
+static void row_compressor_buffer_tuple(RowCompressor *row_compressor, CommandId mycid);
+static void row_compressor_insert_buffered(RowCompressor *row_compressor);
 
 static int create_segment_filter_scankey(RowDecompressor *decompressor,
 										 char *segment_filter_col_name, StrategyNumber strategy,
 										 ScanKeyData *scankeys, int num_scankeys,
 										 Bitmapset **null_columns, Datum value, bool isnull);
 static void run_analyze_on_chunk(Oid chunk_relid);
+static int32 row_compressor_get_sequence_num(RowCompressor *row_compressor);
 
 /********************
  ** compress_chunk **
@@ -219,6 +272,94 @@ truncate_relation(Oid table_oid)
 	table_close(rel, NoLock);
 }
 
+/*
+ * Check whether the given index of the uncompressed chunk returns the rows in
+ * the order required for compression, see compress_chunk(). If it does, sets
+ * the index scan direction to use.
+ */
+static bool
+compress_chunk_index_matches(Relation in_rel, Relation index_rel, int n_keys,
+							 const ColumnCompressionInfo **keys, ScanDirection *direction)
+{
+	TupleDesc in_desc = RelationGetDescr(in_rel);
+	Bitmapset *segmentby_attnos = NULL;
+	int n_segment_keys = 0;
+
+	/* A partial or invalid index might not contain all the rows. */
+	if (index_rel->rd_rel->relam != BTREE_AM_OID || !index_rel->rd_index->indisvalid ||
+		RelationGetIndexPredicate(index_rel) != NIL)
+		return false;
+
+	if (n_keys > IndexRelationGetNumberOfKeyAttributes(index_rel))
+		return false;
+
+	/* The segmentby columns go first in the keys. */
+	while (n_segment_keys < n_keys && COMPRESSIONCOL_IS_SEGMENT_BY(keys[n_segment_keys]))
+	{
+		AttrNumber attno = get_attnum(RelationGetRelid(in_rel),
+									  NameStr(keys[n_segment_keys]->attname));
+		segmentby_attnos = bms_add_member(segmentby_attnos, attno);
+		n_segment_keys++;
+	}
+
+	*direction = NoMovementScanDirection;
+	for (int i = 0; i < n_keys; i++)
+	{
+		AttrNumber index_attno = index_rel->rd_index->indkey.values[i];
+
+		/* Expression index columns have zero attno. */
+		if (index_attno == InvalidAttrNumber)
+			return false;
+
+		if (index_rel->rd_indcollation[i] !=
+			TupleDescAttr(in_desc, AttrNumberGetAttrOffset(index_attno))->attcollation)
+			return false;
+
+		if (i < n_segment_keys)
+		{
+			/*
+			 * The order of the segmentby columns doesn't matter, so we just
+			 * check that we have each of them once.
+			 */
+			if (!bms_is_member(index_attno, segmentby_attnos))
+				return false;
+
+			segmentby_attnos = bms_del_member(segmentby_attnos, index_attno);
+			continue;
+		}
+
+		if (index_attno != get_attnum(RelationGetRelid(in_rel), NameStr(keys[i]->attname)))
+			return false;
+
+		int16 option = index_rel->rd_indoption[i];
+		bool index_orderby_asc = ((option & INDOPTION_DESC) == 0);
+		bool index_null_first = ((option & INDOPTION_NULLS_FIRST) != 0);
+		ScanDirection column_direction;
+
+		if (index_orderby_asc == keys[i]->orderby_asc &&
+			index_null_first == keys[i]->orderby_nullsfirst)
+			column_direction = ForwardScanDirection;
+		else if (index_orderby_asc != keys[i]->orderby_asc &&
+				 index_null_first != keys[i]->orderby_nullsfirst)
+			column_direction = BackwardScanDirection;
+		else
+			return false;
+
+		if (*direction != NoMovementScanDirection && *direction != column_direction)
+			return false;
+
+		*direction = column_direction;
+	}
+
+	Assert(bms_is_empty(segmentby_attnos));
+
+	/* With only the segmentby columns, any direction works. */
+	if (*direction == NoMovementScanDirection)
+		*direction = ForwardScanDirection;
+
+	return true;
+}
+
 CompressionStats
 compress_chunk(Oid in_table, Oid out_table, const ColumnCompressionInfo **column_compression_info,
 			   int num_compression_infos)
@@ -231,8 +372,6 @@ compress_chunk(Oid in_table, Oid out_table, const ColumnCompressionInfo **column
 	TupleTableSlot *slot;
 	IndexScanDesc index_scan;
 	CommandId mycid = GetCurrentCommandId(true);
-	HeapTuple in_table_tp = NULL, index_tp = NULL;
-	Form_pg_attribute in_table_attr_tp, index_attr_tp;
 	const ColumnCompressionInfo **keys;
 	CompressionStats cstat;
 
@@ -257,7 +396,6 @@ compress_chunk(Oid in_table, Oid out_table, const ColumnCompressionInfo **column
 	TupleDesc in_desc = RelationGetDescr(in_rel);
 	TupleDesc out_desc = RelationGetDescr(out_rel);
 	in_rel_index_oids = RelationGetIndexList(in_rel);
-	int i = 0;
 	/* Before calling row compressor relation should be segmented and sorted as per
 	 * compress_segmentby and compress_orderby column/s configured in ColumnCompressionInfo.
 	 * Cost of sorting can be mitigated if we find an existing BTREE index defined for
@@ -267,11 +405,12 @@ compress_chunk(Oid in_table, Oid out_table, const ColumnCompressionInfo **column
 	 * matches the ColumnCompressionInfo so that we can skip sequential scan and
 	 * tuplesort.
 	 *
-	 * Matching Criteria for Each IndexAtt[i] and ColumnCompressionInfo Keys[i]
-	 * ========================================================================
-	 * a) Index attnum must match with ColumnCompressionInfo Key {keys[i]}.
-	 * b) Index attOption(ASC/DESC and NULL_FIRST) can be mapped with ColumnCompressionInfo
-	 * orderby_asc and null_first.
+	 * The index must be a valid non-partial btree index. Its leading columns
+	 * must be the segmentby columns in any order and direction, because we
+	 * only need the rows of each segment to come together. They must be
+	 * followed by the orderby columns in the compression order. The index
+	 * scan direction is determined by the orderby columns, and must be the
+	 * same for all of them:
 	 *
 	 * BTREE Indexes Ordering
 	 * =====================
@@ -286,103 +425,16 @@ compress_chunk(Oid in_table, Oid out_table, const ColumnCompressionInfo **column
 		{
 			Oid index_oid = lfirst_oid(lc);
 			Relation index_rel = index_open(index_oid, AccessShareLock);
-			IndexInfo *index_info = BuildIndexInfo(index_rel);
-			int previous_direction = NoMovementScanDirection;
-			int current_direction = NoMovementScanDirection;
-
-			if (n_keys <= index_info->ii_NumIndexKeyAttrs && index_info->ii_Am == BTREE_AM_OID)
-			{
-				for (i = 0; i < n_keys; i++)
-				{
-					int16 att_num = get_attnum(in_table, NameStr(keys[i]->attname));
-
-					int16 option = index_rel->rd_indoption[i];
-					bool index_orderby_asc = ((option & INDOPTION_DESC) == 0);
-					bool index_null_first = ((option & INDOPTION_NULLS_FIRST) != 0);
-					bool is_orderby_asc =
-						COMPRESSIONCOL_IS_SEGMENT_BY(keys[i]) ? true : keys[i]->orderby_asc;
-					bool is_null_first =
-						COMPRESSIONCOL_IS_SEGMENT_BY(keys[i]) ? false : keys[i]->orderby_nullsfirst;
-
-					if (att_num == 0 || index_info->ii_IndexAttrNumbers[i] != att_num)
-					{
-						break;
-					}
+			ScanDirection direction = NoMovementScanDirection;
 
-					in_table_tp = SearchSysCacheAttNum(in_table, att_num);
-					if (!HeapTupleIsValid(in_table_tp))
-						elog(ERROR,
-							 "table \"%s\" does not have column \"%s\"",
-							 get_rel_name(in_table),
-							 NameStr(keys[i]->attname));
-
-					index_tp = SearchSysCacheAttNum(index_oid, i + 1);
-					if (!HeapTupleIsValid(index_tp))
-						elog(ERROR,
-							 "index \"%s\" does not have column \"%s\"",
-							 get_rel_name(index_oid),
-							 NameStr(keys[i]->attname));
-
-					in_table_attr_tp = (Form_pg_attribute) GETSTRUCT(in_table_tp);
-					index_attr_tp = (Form_pg_attribute) GETSTRUCT(index_tp);
-
-					if (index_orderby_asc == is_orderby_asc && index_null_first == is_null_first &&
-						in_table_attr_tp->attcollation == index_attr_tp->attcollation)
-					{
-						current_direction = ForwardScanDirection;
-					}
-					else if (index_orderby_asc != is_orderby_asc &&
-							 index_null_first != is_null_first &&
-							 in_table_attr_tp->attcollation == index_attr_tp->attcollation)
-					{
-						current_direction = BackwardScanDirection;
-					}
-					else
-					{
-						current_direction = NoMovementScanDirection;
-						break;
-					}
-
-					ReleaseSysCache(in_table_tp);
-					in_table_tp = NULL;
-					ReleaseSysCache(index_tp);
-					index_tp = NULL;
-					if (previous_direction == NoMovementScanDirection)
-					{
-						previous_direction = current_direction;
-					}
-					else if (previous_direction != current_direction)
-					{
-						break;
-					}
-				}
-
-				if (n_keys == i && (previous_direction == current_direction &&
-									current_direction != NoMovementScanDirection))
-				{
-					matched_index_rel = index_rel;
-					indexscan_direction = current_direction;
-					break;
-				}
-				else
-				{
-					if (HeapTupleIsValid(in_table_tp))
-					{
-						ReleaseSysCache(in_table_tp);
-						in_table_tp = NULL;
-					}
-					if (HeapTupleIsValid(index_tp))
-					{
-						ReleaseSysCache(index_tp);
-						index_tp = NULL;
-					}
-					index_close(index_rel, AccessShareLock);
-				}
-			}
-			else
+			if (compress_chunk_index_matches(in_rel, index_rel, n_keys, keys, &direction))
 			{
-				index_close(index_rel, AccessShareLock);
+				matched_index_rel = index_rel;
+				indexscan_direction = direction;
+				break;
 			}
+
+			index_close(index_rel, AccessShareLock);
 		}
 	}
 
@@ -433,9 +485,44 @@ compress_chunk(Oid in_table, Oid out_table, const ColumnCompressionInfo **column
 		if (compression_path != NULL && strcmp(compression_path, "on") == 0)
 			elog(INFO, "compress_chunk_tuplesort_start");
 #endif
-		Tuplesortstate *sorted_rel = compress_chunk_sort_relation(in_rel, n_keys, keys);
-		row_compressor_append_sorted_rows(&row_compressor, sorted_rel, in_desc);
-		tuplesort_end(sorted_rel);
+		ParallelCompressionSort *parallel_sort = NULL;
+		CompressionRadixSort *radix_sort = NULL;
+		Tuplesortstate *sorted_rel =
+			compress_chunk_sort_relation(in_rel, n_keys, keys, &parallel_sort, &radix_sort);
+
+		if (radix_sort != NULL)
+		{
+			HeapTuple tuple;
+
+			slot = MakeTupleTableSlot(in_desc, &TTSOpsHeapTuple);
+			while ((tuple = compression_radix_sort_gettuple(radix_sort)) != NULL)
+			{
+				ExecStoreHeapTuple(tuple, slot, false);
+				row_compressor_process_ordered_slot(&row_compressor, slot, mycid);
+			}
+
+			if (row_compressor.rows_compressed_into_current_value > 0)
+				row_compressor_flush(&row_compressor, mycid, true);
+
+			ExecDropSingleTupleTableSlot(slot);
+			compression_radix_sort_end(radix_sort);
+		}
+		else
+		{
+			row_compressor_append_sorted_rows(&row_compressor, sorted_rel, in_desc);
+			tuplesort_end(sorted_rel);
+		}
+
+		if (parallel_sort != NULL)
+		{
+			compression_sort_end_parallel(parallel_sort);
+
+			/*
+			 * We can't analyze the chunk in parallel mode, so we do it only
+			 * after the parallel sort has finished.
+			 */
+			run_analyze_on_chunk(in_rel->rd_id);
+		}
 	}
 
 	row_compressor_finish(&row_compressor);
@@ -496,10 +583,13 @@ compress_chunk_populate_keys(Oid in_table, const ColumnCompressionInfo **columns
 }
 
 static Tuplesortstate *
-compress_chunk_sort_relation(Relation in_rel, int n_keys, const ColumnCompressionInfo **keys)
+compress_chunk_sort_relation(Relation in_rel, int n_keys, const ColumnCompressionInfo **keys,
+							 ParallelCompressionSort **parallel_sort,
+							 CompressionRadixSort **radix_sort)
 {
 	TupleDesc tupDesc = RelationGetDescr(in_rel);
-	Tuplesortstate *tuplesortstate;
+	Tuplesortstate *tuplesortstate = NULL;
+	CompressionRadixSort *radix = NULL;
 	HeapTuple tuple;
 	TableScanDesc heapScan;
 	TupleTableSlot *heap_tuple_slot = MakeTupleTableSlot(tupDesc, &TTSOpsHeapTuple);
@@ -517,15 +607,51 @@ compress_chunk_sort_relation(Relation in_rel, int n_keys, const ColumnCompressio
 													 &sort_collations[n],
 													 &nulls_first[n]);
 
-	tuplesortstate = tuplesort_begin_heap(tupDesc,
-										  n_keys,
-										  sort_keys,
-										  sort_operators,
-										  sort_collations,
-										  nulls_first,
-										  maintenance_work_mem,
-										  NULL,
-										  false /*=randomAccess*/);
+	/*
+	 * Sort large chunks in parallel. The leader still compresses the sorted
+	 * rows one by one, so the sequence numbers are assigned in the same way.
+	 */
+	const int nworkers = compression_sort_plan_workers(in_rel);
+	if (nworkers > 0)
+	{
+		*parallel_sort = compression_sort_begin_parallel(in_rel,
+														 nworkers,
+														 n_keys,
+														 sort_keys,
+														 sort_operators,
+														 sort_collations,
+														 nulls_first,
+														 &tuplesortstate);
+		if (*parallel_sort != NULL)
+		{
+			ExecDropSingleTupleTableSlot(heap_tuple_slot);
+			return tuplesortstate;
+		}
+	}
+
+	/*
+	 * When all the sort keys are integers or timestamps, which is the common
+	 * case, try to sort the chunk in memory with a radix sort. If the chunk
+	 * doesn't fit into maintenance_work_mem, the tuples read so far are moved
+	 * to a tuplesort, which can spill to disk.
+	 */
+	radix = compression_radix_sort_begin(tupDesc,
+										 n_keys,
+										 sort_keys,
+										 sort_operators,
+										 nulls_first,
+										 (Size) maintenance_work_mem * 1024L);
+
+	if (radix == NULL)
+		tuplesortstate = tuplesort_begin_heap(tupDesc,
+											  n_keys,
+											  sort_keys,
+											  sort_operators,
+											  sort_collations,
+											  nulls_first,
+											  maintenance_work_mem,
+											  NULL,
+											  false /*=randomAccess*/);
 
 	heapScan = table_beginscan(in_rel, GetLatestSnapshot(), 0, (ScanKey) NULL);
 	for (tuple = heap_getnext(heapScan, ForwardScanDirection); tuple != NULL;
@@ -533,6 +659,33 @@ compress_chunk_sort_relation(Relation in_rel, int n_keys, const ColumnCompressio
 	{
 		if (HeapTupleIsValid(tuple))
 		{
+			if (radix != NULL)
+			{
+				HeapTuple radix_tuple;
+
+				if (compression_radix_sort_puttuple(radix, tuple))
+					continue;
+
+				tuplesortstate = tuplesort_begin_heap(tupDesc,
+													  n_keys,
+													  sort_keys,
+													  sort_operators,
+													  sort_collations,
+													  nulls_first,
+													  maintenance_work_mem,
+													  NULL,
+													  false /*=randomAccess*/);
+
+				while ((radix_tuple = compression_radix_sort_gettuple(radix)) != NULL)
+				{
+					ExecStoreHeapTuple(radix_tuple, heap_tuple_slot, false);
+					tuplesort_puttupleslot(tuplesortstate, heap_tuple_slot);
+				}
+
+				compression_radix_sort_end(radix);
+				radix = NULL;
+			}
+
 			/*    This may not be the most efficient way to do things.
 			 *     Since we use begin_heap() the tuplestore expects tupleslots,
 			 *      so ISTM that the options are this or maybe putdatum().
@@ -553,6 +706,13 @@ compress_chunk_sort_relation(Relation in_rel, int n_keys, const ColumnCompressio
 
 	ExecDropSingleTupleTableSlot(heap_tuple_slot);
 
+	if (radix != NULL)
+	{
+		compression_radix_sort_performsort(radix);
+		*radix_sort = radix;
+		return NULL;
+	}
+
 	tuplesort_performsort(tuplesortstate);
 
 	return tuplesortstate;
@@ -826,9 +986,330 @@ get_sequence_number_for_current_group(Relation table_rel, Oid index_oid,
 	return result + SEQUENCE_NUM_GAP;
 }
 
+/*
+ * The key of the sequence number cache of the row compressor is the bytes of
+ * the segmentby values. Values that are equal but have different bytes, e.g.,
+ * numeric 1.0 and 1.00, get different entries, which only means that the
+ * sequence number is looked up in the compressed table again.
+ */
+typedef struct SequenceNumKey
+{
+	Size len;
+	char *data;
+} SequenceNumKey;
+
+typedef struct SequenceNumEntry
+{
+	SequenceNumKey key;
+	int32 sequence_num;
+} SequenceNumEntry;
+
+static uint32
+sequence_num_key_hash(const void *key, Size keysize)
+{
+	const SequenceNumKey *k = (const SequenceNumKey *) key;
+
+	return hash_bytes((const unsigned char *) k->data, k->len);
+}
+
+static int
+sequence_num_key_match(const void *key1, const void *key2, Size keysize)
+{
+	const SequenceNumKey *k1 = (const SequenceNumKey *) key1;
+	const SequenceNumKey *k2 = (const SequenceNumKey *) key2;
+
+	if (k1->len != k2->len)
+		return 1;
+
+	return memcmp(k1->data, k2->data, k1->len);
+}
+
+static void
+sequence_num_key_append_segment(StringInfo buf, const SegmentInfo *segment_info)
+{
+	Size len;
+
+	appendStringInfoChar(buf, segment_info->is_null ? 1 : 0);
+
+	if (segment_info->is_null)
+		return;
+
+	if (segment_info->typ_by_val)
+	{
+		appendBinaryStringInfo(buf, (const char *) &segment_info->val, sizeof(Datum));
+	}
+	else if (segment_info->typlen == -1)
+	{
+		struct varlena *value = PG_DETOAST_DATUM_PACKED(segment_info->val);
+
+		len = VARSIZE_ANY_EXHDR(value);
+		appendBinaryStringInfo(buf, (const char *) &len, sizeof(len));
+		appendBinaryStringInfo(buf, VARDATA_ANY(value), len);
+	}
+	else
+	{
+		len = datumGetSize(segment_info->val, false, segment_info->typlen);
+		appendBinaryStringInfo(buf, (const char *) &len, sizeof(len));
+		appendBinaryStringInfo(buf, DatumGetPointer(segment_info->val), len);
+	}
+}
+
+/*
+ * Get the sequence number the current segment continues from. The first time
+ * we see a segment, this is the max sequence number of the segment in the
+ * compressed table, and afterwards it is the next sequence number we would
+ * have written.
+ */
+static int32
+row_compressor_get_sequence_num(RowCompressor *row_compressor)
+{
+	MemoryContext cache_ctx = row_compressor->per_row_ctx->parent;
+	SequenceNumKey key;
+	SequenceNumEntry *entry;
+	StringInfoData buf;
+	bool found;
+
+	if (row_compressor->sequence_nums == NULL)
+	{
+		HASHCTL ctl = {
+			.keysize = sizeof(SequenceNumKey),
+			.entrysize = sizeof(SequenceNumEntry),
+			.hash = sequence_num_key_hash,
+			.match = sequence_num_key_match,
+			.hcxt = cache_ctx,
+		};
+
+		row_compressor->sequence_nums =
+			hash_create("compression sequence numbers",
+						64,
+						&ctl,
+						HASH_ELEM | HASH_FUNCTION | HASH_COMPARE | HASH_CONTEXT);
+
+		/* Nothing has been inserted by us yet, because this is the first
+		 * segment */
+		row_compressor->compressed_table_was_empty =
+			RelationGetNumberOfBlocks(row_compressor->compressed_table) == 0;
+	}
+
+	/* The key is only needed in the cache context if it is a new one */
+	MemoryContext old_ctx = MemoryContextSwitchTo(row_compressor->per_row_ctx);
+	initStringInfo(&buf);
+	for (int col = 0; col < row_compressor->n_input_columns; col++)
+	{
+		if (row_compressor->per_column[col].segment_info != NULL)
+			sequence_num_key_append_segment(&buf, row_compressor->per_column[col].segment_info);
+	}
+	MemoryContextSwitchTo(old_ctx);
+
+	key.len = buf.len;
+	key.data = buf.data;
+	entry = hash_search(row_compressor->sequence_nums, &key, HASH_ENTER, &found);
+
+	if (!found)
+	{
+		entry->key.data = MemoryContextAlloc(cache_ctx, key.len);
+		memcpy(entry->key.data, key.data, key.len);
+
+		if (row_compressor->compressed_table_was_empty)
+			entry->sequence_num = SEQUENCE_NUM_GAP;
+		else
+			entry->sequence_num = get_sequence_number_for_current_group(
+				row_compressor->compressed_table,
+				row_compressor->index_oid,
+				row_compressor->uncompressed_col_to_compressed_col,
+				row_compressor->per_column,
+				row_compressor->n_input_columns,
+				AttrOffsetGetAttrNumber(row_compressor->sequence_num_metadata_column_offset));
+	}
+
+	row_compressor->sequence_num_entry = entry;
+
+	return entry->sequence_num;
+}
+
+/*
+ * The alternative compression algorithms that we try on the first batches of
+ * the columns that use the given algorithm by default, see the comment in
+ * per_column_finish_trial(). Returns the number of the algorithms.
+ */
+static int
+get_trial_algorithms(CompressionAlgorithms algorithm, Oid element_type,
+					 CompressionAlgorithms *trial_algorithms)
+{
+	switch (algorithm)
+	{
+		case COMPRESSION_ALGORITHM_DELTADELTA:
+			trial_algorithms[0] = COMPRESSION_ALGORITHM_DICTIONARY;
+			/* Bitpacking supports the same types as deltadelta except bool. */
+			if (element_type == BOOLOID)
+				return 1;
+			trial_algorithms[1] = COMPRESSION_ALGORITHM_BITPACKING;
+			return 2;
+		case COMPRESSION_ALGORITHM_GORILLA:
+			trial_algorithms[0] = COMPRESSION_ALGORITHM_DICTIONARY;
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+/*
+ * The dictionary compression merges the values that are equal by the equality
+ * operator of the type, so for floats it would lose the negative zeros and the
+ * NaN payloads. The trial compression stops when it sees such values.
+ */
+static bool
+trial_value_is_exact(Oid element_type, Datum val)
+{
+	switch (element_type)
+	{
+		case FLOAT8OID:
+		{
+			const double d = DatumGetFloat8(val);
+			return !isnan(d) && !(d == 0 && signbit(d));
+		}
+		case FLOAT4OID:
+		{
+			const float f = DatumGetFloat4(val);
+			return !isnan(f) && !(f == 0 && signbit(f));
+		}
+		default:
+			return true;
+	}
+}
+
+static void
+per_column_append_trial(PerColumn *column, Datum val, bool is_null)
+{
+	if (!is_null && !trial_value_is_exact(column->trial_element_type, val))
+	{
+		column->n_trial_compressors = 0;
+		return;
+	}
+
+	for (int i = 0; i < column->n_trial_compressors; i++)
+	{
+		Compressor *trial_compressor = column->trial_compressors[i];
+		if (is_null)
+			trial_compressor->append_null(trial_compressor);
+		else
+			trial_compressor->append_val(trial_compressor, val);
+	}
+}
+
+/*
+ * The default algorithm is chosen by the column type, but the data might be
+ * better compressed by another algorithm, e.g. a float column that holds a
+ * small set of distinct values compresses much better with the dictionary
+ * than with gorilla, and an integer column with a small range of values that
+ * don't change monotonically compresses better with bitpacking than with
+ * deltadelta. For the first batches of each column, we compress the data with
+ * all these algorithms and store the smallest result. The decompression takes
+ * the algorithm from the header of each compressed datum, so the batches can
+ * use different algorithms. After the trial batches, we keep using the
+ * algorithm that produced the least data in total.
+ */
+static void *
+per_column_finish_trial(PerColumn *column, void *compressed_data)
+{
+	void *result = compressed_data;
+	Size result_bytes = compressed_data != NULL ? VARSIZE(compressed_data) : 0;
+
+	/* The batch where all values are null doesn't count. */
+	const bool count_batch = compressed_data != NULL;
+	if (count_batch)
+		column->compressor_bytes += result_bytes;
+
+	for (int i = 0; i < column->n_trial_compressors; i++)
+	{
+		Compressor *trial_compressor = column->trial_compressors[i];
+		void *trial_data = trial_compressor->finish(trial_compressor);
+		if (trial_data == NULL)
+			continue;
+
+		if (!count_batch)
+		{
+			pfree(trial_data);
+			continue;
+		}
+
+		const Size trial_bytes = VARSIZE(trial_data);
+		column->trial_compressor_bytes[i] += trial_bytes;
+		if (trial_bytes < result_bytes)
+		{
+			pfree(result);
+			result = trial_data;
+			result_bytes = trial_bytes;
+		}
+		else
+		{
+			pfree(trial_data);
+		}
+	}
+
+	if (!count_batch)
+		return result;
+
+	column->trial_batches_left--;
+	if (column->trial_batches_left <= 0)
+	{
+		int64 best_bytes = column->compressor_bytes;
+		for (int i = 0; i < column->n_trial_compressors; i++)
+		{
+			if (column->trial_compressor_bytes[i] < best_bytes)
+			{
+				best_bytes = column->trial_compressor_bytes[i];
+				column->compressor = column->trial_compressors[i];
+			}
+		}
+		column->n_trial_compressors = 0;
+	}
+
+	return result;
+}
+
 /********************
  ** row_compressor **
  ********************/
+/*
+ * When the compressed table was created, or got a new relfilenode, in the
+ * current transaction, like a new compressed chunk, insert the compressed
+ * tuples frozen, like COPY FREEZE does. No other transaction can see the
+ * table before this one commits. A later vacuum then doesn't have to freeze
+ * the tuples and set the pages all-visible, which writes every page to the
+ * WAL again with its full image, although the compressed chunks are never
+ * updated. The tuples would only become visible to the earlier snapshots of
+ * the current transaction, which see the uncompressed chunk truncated anyway.
+ *
+ * The free space map of a new table is empty, so we don't check it either.
+ */
+static int
+row_compressor_insert_options(Relation compressed_table)
+{
+#if PG16_LT
+	SubTransactionId new_subid = compressed_table->rd_newRelfilenodeSubid;
+#else
+	SubTransactionId new_subid = compressed_table->rd_newRelfilelocatorSubid;
+#endif
+	int options = 0;
+
+	if (compressed_table->rd_createSubid != InvalidSubTransactionId ||
+		new_subid != InvalidSubTransactionId)
+		options |= HEAP_INSERT_SKIP_FSM;
+
+	/*
+	 * The frozen tuples would stay visible if the subtransaction that
+	 * inserted them was rolled back, but not the outer one that created the
+	 * relfilenode.
+	 */
+	if (ts_guc_enable_compression_freeze &&
+		(compressed_table->rd_createSubid == GetCurrentSubTransactionId() ||
+		 new_subid == GetCurrentSubTransactionId()))
+		options |= HEAP_INSERT_FROZEN;
+
+	return options;
+}
+
 /* num_compression_infos is the number of columns we will write to in the compressed table */
 void
 row_compressor_init(RowCompressor *row_compressor, TupleDesc uncompressed_tuple_desc,
@@ -876,11 +1357,18 @@ row_compressor_init(RowCompressor *row_compressor, TupleDesc uncompressed_tuple_
 		.compressed_values = palloc(sizeof(Datum) * num_columns_in_compressed_table),
 		.compressed_is_null = palloc(sizeof(bool) * num_columns_in_compressed_table),
 		.rows_compressed_into_current_value = 0,
+		.max_rows_per_compression = ts_guc_compression_batch_rows,
 		.rowcnt_pre_compression = 0,
 		.num_compressed_rows = 0,
 		.sequence_num = SEQUENCE_NUM_GAP,
+		.first_sequence_num = SEQUENCE_NUM_GAP,
+		.sequence_num_step = SEQUENCE_NUM_GAP,
 		.reset_sequence = reset_sequence,
 		.first_iteration = true,
+		.insert_slots = palloc0(sizeof(TupleTableSlot *) * MAX_BUFFERED_COMPRESSED_TUPLES),
+		.n_buffered_tuples = 0,
+		.buffered_bytes = 0,
+		.insert_options = row_compressor_insert_options(compressed_table),
 	};
 
 	memset(row_compressor->compressed_is_null, 1, sizeof(bool) * num_columns_in_compressed_table);
@@ -909,10 +1397,33 @@ row_compressor_init(RowCompressor *row_compressor, TupleDesc uncompressed_tuple_
 					 "expected column '%s' to be a compressed data type",
 					 compression_info->attname.data);
 
+			/*
+			 * The orderby columns always have the min/max metadata, and the
+			 * other columns have it if it was requested with the
+			 * timescaledb.compress_minmax option.
+			 */
+			char *segment_min_col_name = NULL;
+			char *segment_max_col_name = NULL;
 			if (compression_info->orderby_column_index > 0)
 			{
-				char *segment_min_col_name = compression_column_segment_min_name(compression_info);
-				char *segment_max_col_name = compression_column_segment_max_name(compression_info);
+				segment_min_col_name = compression_column_segment_min_name(compression_info);
+				segment_max_col_name = compression_column_segment_max_name(compression_info);
+			}
+			else
+			{
+				char *sparse_min_col_name =
+					compression_column_segment_sparse_min_name(NameStr(compression_info->attname));
+				if (sparse_min_col_name != NULL &&
+					get_attnum(compressed_table->rd_id, sparse_min_col_name) != InvalidAttrNumber)
+				{
+					segment_min_col_name = sparse_min_col_name;
+					segment_max_col_name = compression_column_segment_sparse_max_name(
+						NameStr(compression_info->attname));
+				}
+			}
+
+			if (segment_min_col_name != NULL)
+			{
 				AttrNumber segment_min_attr_number =
 					get_attnum(compressed_table->rd_id, segment_min_col_name);
 				AttrNumber segment_max_attr_number =
@@ -927,14 +1438,46 @@ row_compressor_init(RowCompressor *row_compressor, TupleDesc uncompressed_tuple_
 					segment_meta_min_max_builder_create(column_attr->atttypid,
 														column_attr->attcollation);
 			}
+			int16 bloom_attr_offset = -1;
+			SegmentMetaBloomBuilder *bloom_builder = NULL;
+			char *bloom_col_name =
+				compression_column_segment_bloom_name(NameStr(compression_info->attname));
+			AttrNumber bloom_attr_number = bloom_col_name == NULL ?
+											   InvalidAttrNumber :
+											   get_attnum(compressed_table->rd_id, bloom_col_name);
+			if (bloom_attr_number != InvalidAttrNumber)
+			{
+				bloom_attr_offset = AttrNumberGetAttrOffset(bloom_attr_number);
+				bloom_builder =
+					segment_meta_bloom_builder_create(column_attr->atttypid,
+													  column_attr->attcollation,
+													  row_compressor->max_rows_per_compression);
+			}
+			CompressionAlgorithms trial_algorithms[MAX_TRIAL_ALGORITHMS];
+			const int n_trial_algorithms =
+				ts_guc_enable_compression_algorithm_selection ?
+					get_trial_algorithms(compression_info->algo_id,
+										 column_attr->atttypid,
+										 trial_algorithms) :
+					0;
 			*column = (PerColumn){
 				.compressor = compressor_for_algorithm_and_type(compression_info->algo_id,
 																column_attr->atttypid),
 				.min_metadata_attr_offset = segment_min_attr_offset,
 				.max_metadata_attr_offset = segment_max_attr_offset,
 				.min_max_metadata_builder = segment_min_max_builder,
+				.bloom_metadata_attr_offset = bloom_attr_offset,
+				.bloom_metadata_builder = bloom_builder,
 				.segmentby_column_index = -1,
+				.n_trial_compressors = n_trial_algorithms,
+				.trial_element_type = column_attr->atttypid,
+				.trial_batches_left = ALGORITHM_TRIAL_BATCHES,
 			};
+			for (int i = 0; i < n_trial_algorithms; i++)
+			{
+				column->trial_compressors[i] =
+					compressor_for_algorithm_and_type(trial_algorithms[i], column_attr->atttypid);
+			}
 		}
 		else
 		{
@@ -947,6 +1490,7 @@ row_compressor_init(RowCompressor *row_compressor, TupleDesc uncompressed_tuple_
 				.segmentby_column_index = compression_info->segmentby_column_index,
 				.min_metadata_attr_offset = -1,
 				.max_metadata_attr_offset = -1,
+				.bloom_metadata_attr_offset = -1,
 			};
 		}
 	}
@@ -984,9 +1528,31 @@ row_compressor_append_sorted_rows(RowCompressor *row_compressor, Tuplesortstate
 	if (row_compressor->rows_compressed_into_current_value > 0)
 		row_compressor_flush(row_compressor, mycid, true);
 
+	/* The callers might e.g. measure the size of the compressed chunk after that. */
+	row_compressor_insert_buffered(row_compressor);
+
 	ExecDropSingleTupleTableSlot(slot);
 }
 
+/*
+ * Compress the given slots, which are already in the order of the sort keys
+ * of the compression, without sorting them again. The slots are cleared.
+ */
+void
+row_compressor_append_ordered_slots(RowCompressor *row_compressor, TupleTableSlot **slots,
+									int nslots)
+{
+	CommandId mycid = GetCurrentCommandId(true);
+
+	for (int i = 0; i < nslots; i++)
+		row_compressor_process_ordered_slot(row_compressor, slots[i], mycid);
+
+	if (row_compressor->rows_compressed_into_current_value > 0)
+		row_compressor_flush(row_compressor, mycid, true);
+
+	row_compressor_insert_buffered(row_compressor);
+}
+
 static void
 row_compressor_process_ordered_slot(RowCompressor *row_compressor, TupleTableSlot *slot,
 									CommandId mycid)
@@ -1001,7 +1567,8 @@ row_compressor_process_ordered_slot(RowCompressor *row_compressor, TupleTableSlo
 	}
 	bool changed_groups = row_compressor_new_row_is_in_new_group(row_compressor, slot);
 	bool compressed_row_is_full =
-		row_compressor->rows_compressed_into_current_value >= MAX_ROWS_PER_COMPRESSION;
+		row_compressor->rows_compressed_into_current_value >=
+		row_compressor->max_rows_per_compression;
 	if (compressed_row_is_full || changed_groups)
 	{
 		if (row_compressor->rows_compressed_into_current_value > 0)
@@ -1048,22 +1615,13 @@ row_compressor_update_group(RowCompressor *row_compressor, TupleTableSlot *row)
 	/*
 	 * The sequence number of the compressed tuple is per segment by grouping
 	 * and should be reset when the grouping changes to prevent overflows with
-	 * many segmentby columns.
-	 *
+	 * many segmentby columns. The segmentwise recompression can start it from
+	 * a different value, see first_sequence_num.
 	 */
 	if (row_compressor->reset_sequence)
-		row_compressor->sequence_num = SEQUENCE_NUM_GAP; /* Start sequence from beginning */
+		row_compressor->sequence_num = row_compressor->first_sequence_num;
 	else
-		row_compressor->sequence_num =
-			get_sequence_number_for_current_group(row_compressor->compressed_table,
-												  row_compressor->index_oid,
-												  row_compressor
-													  ->uncompressed_col_to_compressed_col,
-												  row_compressor->per_column,
-												  row_compressor->n_input_columns,
-												  AttrOffsetGetAttrNumber(
-													  row_compressor
-														  ->sequence_num_metadata_column_offset));
+		row_compressor->sequence_num = row_compressor_get_sequence_num(row_compressor);
 }
 
 static bool
@@ -1108,6 +1666,9 @@ row_compressor_append_row(RowCompressor *row_compressor, TupleTableSlot *row)
 		 * useless overhead here, and we should just access the array directly.
 		 */
 		val = slot_getattr(row, AttrOffsetGetAttrNumber(col), &is_null);
+		if (row_compressor->per_column[col].n_trial_compressors > 0)
+			per_column_append_trial(&row_compressor->per_column[col], val, is_null);
+
 		if (is_null)
 		{
 			compressor->append_null(compressor);
@@ -1122,6 +1683,10 @@ row_compressor_append_row(RowCompressor *row_compressor, TupleTableSlot *row)
 				segment_meta_min_max_builder_update_val(row_compressor->per_column[col]
 															.min_max_metadata_builder,
 														val);
+			if (row_compressor->per_column[col].bloom_metadata_builder != NULL)
+				segment_meta_bloom_builder_update_val(row_compressor->per_column[col]
+														  .bloom_metadata_builder,
+													  val);
 		}
 	}
 
@@ -1132,7 +1697,6 @@ static void
 row_compressor_flush(RowCompressor *row_compressor, CommandId mycid, bool changed_groups)
 {
 	int16 col;
-	HeapTuple compressed_tuple;
 
 	for (col = 0; col < row_compressor->n_input_columns; col++)
 	{
@@ -1153,6 +1717,8 @@ row_compressor_flush(RowCompressor *row_compressor, CommandId mycid, bool change
 			Assert(column->segment_info == NULL);
 
 			compressed_data = compressor->finish(compressor);
+			if (column->n_trial_compressors > 0)
+				compressed_data = per_column_finish_trial(column, compressed_data);
 
 			/* non-segment columns are NULL iff all the values are NULL */
 			row_compressor->compressed_is_null[compressed_col] = compressed_data == NULL;
@@ -1183,6 +1749,20 @@ row_compressor_flush(RowCompressor *row_compressor, CommandId mycid, bool change
 					row_compressor->compressed_is_null[column->max_metadata_attr_offset] = true;
 				}
 			}
+
+			if (column->bloom_metadata_builder != NULL)
+			{
+				Assert(column->bloom_metadata_attr_offset >= 0);
+
+				/* The bloom filter is NULL iff all the values are NULL. */
+				const bool bloom_is_null =
+					segment_meta_bloom_builder_empty(column->bloom_metadata_builder);
+				row_compressor->compressed_is_null[column->bloom_metadata_attr_offset] =
+					bloom_is_null;
+				if (!bloom_is_null)
+					row_compressor->compressed_values[column->bloom_metadata_attr_offset] =
+						segment_meta_bloom_builder_finish(column->bloom_metadata_builder);
+			}
 		}
 		else if (column->segment_info != NULL)
 		{
@@ -1200,26 +1780,14 @@ row_compressor_flush(RowCompressor *row_compressor, CommandId mycid, bool change
 	row_compressor->compressed_is_null[row_compressor->sequence_num_metadata_column_offset] = false;
 
 	/* overflow could happen only if chunk has more than 200B rows */
-	if (row_compressor->sequence_num > PG_INT32_MAX - SEQUENCE_NUM_GAP)
+	if (row_compressor->sequence_num > PG_INT32_MAX - row_compressor->sequence_num_step)
 		elog(ERROR, "sequence id overflow");
 
-	row_compressor->sequence_num += SEQUENCE_NUM_GAP;
+	row_compressor->sequence_num += row_compressor->sequence_num_step;
+	if (row_compressor->sequence_num_entry != NULL)
+		row_compressor->sequence_num_entry->sequence_num = row_compressor->sequence_num;
 
-	compressed_tuple = heap_form_tuple(RelationGetDescr(row_compressor->compressed_table),
-									   row_compressor->compressed_values,
-									   row_compressor->compressed_is_null);
-	Assert(row_compressor->bistate != NULL);
-	heap_insert(row_compressor->compressed_table,
-				compressed_tuple,
-				mycid,
-				0 /*=options*/,
-				row_compressor->bistate);
-	if (row_compressor->resultRelInfo->ri_NumIndices > 0)
-	{
-		ts_catalog_index_insert(row_compressor->resultRelInfo, compressed_tuple);
-	}
-
-	heap_freetuple(compressed_tuple);
+	row_compressor_buffer_tuple(row_compressor, mycid);
 
 	/* free the compressed values now that we're done with them (the old compressor is freed in
 	 * finish()) */
@@ -1258,6 +1826,18 @@ row_compressor_flush(RowCompressor *row_compressor, CommandId mycid, bool change
 			segment_meta_min_max_builder_reset(column->min_max_metadata_builder);
 		}
 
+		if (column->bloom_metadata_builder != NULL)
+		{
+			if (!row_compressor->compressed_is_null[column->bloom_metadata_attr_offset])
+			{
+				pfree(DatumGetPointer(
+					row_compressor->compressed_values[column->bloom_metadata_attr_offset]));
+				row_compressor->compressed_values[column->bloom_metadata_attr_offset] = 0;
+				row_compressor->compressed_is_null[column->bloom_metadata_attr_offset] = true;
+			}
+			segment_meta_bloom_builder_reset(column->bloom_metadata_builder);
+		}
+
 		row_compressor->compressed_values[compressed_col] = 0;
 		row_compressor->compressed_is_null[compressed_col] = true;
 	}
@@ -1268,12 +1848,105 @@ row_compressor_flush(RowCompressor *row_compressor, CommandId mycid, bool change
 	MemoryContextReset(row_compressor->per_row_ctx);
 }
 
+/*
+ * Form the compressed tuple from the current compressed values and add it to
+ * the insert buffer. We insert the buffered tuples with table multi-insert,
+ * which is much cheaper than inserting them one by one when we have many small
+ * segments.
+ */
+static void
+row_compressor_buffer_tuple(RowCompressor *row_compressor, CommandId mycid)
+{
+	if (row_compressor->n_buffered_tuples > 0 && row_compressor->buffered_cid != mycid)
+		row_compressor_insert_buffered(row_compressor);
+
+	TupleTableSlot **slot = &row_compressor->insert_slots[row_compressor->n_buffered_tuples];
+
+	/*
+	 * The tuple must outlive the per-row context that is reset after every
+	 * compressed tuple, so we form it in the memory context of the slot.
+	 */
+	if (*slot == NULL)
+	{
+		MemoryContext old_ctx = MemoryContextSwitchTo(row_compressor->per_row_ctx->parent);
+		*slot = MakeSingleTupleTableSlot(RelationGetDescr(row_compressor->compressed_table),
+										 &TTSOpsHeapTuple);
+		MemoryContextSwitchTo(old_ctx);
+	}
+
+	MemoryContext old_ctx = MemoryContextSwitchTo((*slot)->tts_mcxt);
+	HeapTuple compressed_tuple = heap_form_tuple(RelationGetDescr(row_compressor->compressed_table),
+												 row_compressor->compressed_values,
+												 row_compressor->compressed_is_null);
+	MemoryContextSwitchTo(old_ctx);
+
+	ExecStoreHeapTuple(compressed_tuple, *slot, true);
+	row_compressor->n_buffered_tuples++;
+	row_compressor->buffered_bytes += compressed_tuple->t_len;
+	row_compressor->buffered_cid = mycid;
+
+	if (row_compressor->n_buffered_tuples >= MAX_BUFFERED_COMPRESSED_TUPLES ||
+		row_compressor->buffered_bytes >= MAX_BUFFERED_COMPRESSED_BYTES)
+		row_compressor_insert_buffered(row_compressor);
+}
+
+/*
+ * Insert the buffered compressed tuples into the compressed table and update
+ * its indexes.
+ */
+static void
+row_compressor_insert_buffered(RowCompressor *row_compressor)
+{
+	if (row_compressor->n_buffered_tuples == 0)
+		return;
+
+	Assert(row_compressor->bistate != NULL);
+	heap_multi_insert(row_compressor->compressed_table,
+					  row_compressor->insert_slots,
+					  row_compressor->n_buffered_tuples,
+					  row_compressor->buffered_cid,
+					  row_compressor->insert_options,
+					  row_compressor->bistate);
+
+	for (int i = 0; i < row_compressor->n_buffered_tuples; i++)
+	{
+		TupleTableSlot *slot = row_compressor->insert_slots[i];
+
+		if (row_compressor->resultRelInfo->ri_NumIndices > 0)
+		{
+			/*
+			 * The multi-insert sets the tid only in the slot, but the index
+			 * insertion takes it from the tuple.
+			 */
+			HeapTuple compressed_tuple = ExecFetchSlotHeapTuple(slot, false, NULL);
+			compressed_tuple->t_self = slot->tts_tid;
+			ts_catalog_index_insert(row_compressor->resultRelInfo, compressed_tuple);
+		}
+
+		ExecClearTuple(slot);
+	}
+
+	row_compressor->n_buffered_tuples = 0;
+	row_compressor->buffered_bytes = 0;
+}
+
 void
 row_compressor_finish(RowCompressor *row_compressor)
 {
+	row_compressor_insert_buffered(row_compressor);
+
+	for (int i = 0; i < MAX_BUFFERED_COMPRESSED_TUPLES; i++)
+	{
+		if (row_compressor->insert_slots[i] != NULL)
+			ExecDropSingleTupleTableSlot(row_compressor->insert_slots[i]);
+	}
+
 	if (row_compressor->bistate)
 		FreeBulkInsertState(row_compressor->bistate);
 	ts_catalog_close_indexes(row_compressor->resultRelInfo);
+
+	if (row_compressor->sequence_nums != NULL)
+		hash_destroy(row_compressor->sequence_nums);
 }
 
 /******************
@@ -1387,6 +2060,9 @@ build_decompressor(Relation in_rel, Relation out_rel)
 		.decompressed_datums = palloc(sizeof(Datum) * out_desc->natts),
 		.decompressed_is_nulls = palloc(sizeof(bool) * out_desc->natts),
 
+		.decompressed_slots = NULL,
+		.num_decompressed_slots = 0,
+
 		.per_compressed_row_ctx = AllocSetContextCreate(CurrentMemoryContext,
 														"decompress chunk per-compressed row",
 														ALLOCSET_DEFAULT_SIZES),
@@ -1403,6 +2079,13 @@ build_decompressor(Relation in_rel, Relation out_rel)
 	return decompressor;
 }
 
+/*
+ * Decompress all the compressed rows of in_table into out_table.
+ *
+ * When the uncompressed chunk is empty, which it is unless the chunk is
+ * partial, the indexes are not maintained row by row but rebuilt at the end,
+ * which is a lot cheaper than inserting every row into every index.
+ */
 void
 decompress_chunk(Oid in_table, Oid out_table)
 {
@@ -1422,6 +2105,13 @@ decompress_chunk(Oid in_table, Oid out_table)
 	Relation in_rel = table_open(in_table, ExclusiveLock);
 
 	RowDecompressor decompressor = build_decompressor(in_rel, out_rel);
+	bool rebuild_indexes = RelationGetNumberOfBlocks(out_rel) == 0;
+
+	if (rebuild_indexes)
+	{
+		ts_catalog_close_indexes(decompressor.indexstate);
+		decompressor.indexstate = NULL;
+	}
 
 	HeapTuple compressed_tuple;
 	TableScanDesc heapScan = table_beginscan(in_rel, GetLatestSnapshot(), 0, (ScanKey) NULL);
@@ -1440,12 +2130,26 @@ decompress_chunk(Oid in_table, Oid out_table)
 
 	table_endscan(heapScan);
 
+	table_finish_bulk_insert(out_rel, 0);
 	FreeBulkInsertState(decompressor.bistate);
 	MemoryContextDelete(decompressor.per_compressed_row_ctx);
-	ts_catalog_close_indexes(decompressor.indexstate);
+	if (decompressor.indexstate != NULL)
+		ts_catalog_close_indexes(decompressor.indexstate);
 
 	table_close(out_rel, NoLock);
 	table_close(in_rel, NoLock);
+
+	if (rebuild_indexes)
+	{
+#if PG14_LT
+		int options = 0;
+#else
+		ReindexParams params = { 0 };
+		ReindexParams *options = &params;
+#endif
+		CommandCounterIncrement();
+		reindex_relation(out_table, 0, options);
+	}
 }
 
 PerCompressedColumn *
@@ -1501,12 +2205,88 @@ create_per_compressed_column(TupleDesc in_desc, TupleDesc out_desc, Oid out_reli
 			.is_null = true,
 			.is_compressed = is_compressed,
 			.decompressed_type = decompressed_type,
+			.value_bytes = get_typlen(decompressed_type),
 		};
 	}
 
 	return per_compressed_cols;
 }
 
+/*
+ * Build the varlena datums for the elements of the given Arrow binary array.
+ * For the dictionary-encoded arrays, we do this for the dictionary, which is
+ * small compared to the batch, so this is cheaper than building a datum for
+ * every row. The datums are allocated in the current memory context.
+ */
+const Datum *
+arrow_make_varlena_datums(const ArrowArray *arrow)
+{
+	const int32 *offsets = arrow->buffers[1];
+	const char *bodies = arrow->buffers[2];
+	const int n = arrow->length;
+
+	Size total_bytes = 0;
+	for (int i = 0; i < n; i++)
+	{
+		total_bytes += INTALIGN(VARHDRSZ + offsets[i + 1] - offsets[i]);
+	}
+
+	Datum *datums = palloc(sizeof(Datum) * n);
+	char *varlenas = palloc(total_bytes);
+	for (int i = 0; i < n; i++)
+	{
+		const int body_bytes = offsets[i + 1] - offsets[i];
+		SET_VARSIZE(varlenas, VARHDRSZ + body_bytes);
+		memcpy(VARDATA(varlenas), &bodies[offsets[i]], body_bytes);
+		datums[i] = PointerGetDatum(varlenas);
+		varlenas += INTALIGN(VARHDRSZ + body_bytes);
+	}
+
+	return datums;
+}
+
+/*
+ * Decompress a compressed column of the batch in one go, if its compression
+ * algorithm supports this. The result is allocated in the current memory
+ * context. Returns false if the column has to be decompressed row by row.
+ */
+static bool
+per_compressed_col_decompress_all(PerCompressedColumn *per_col, CompressedDataHeader *header)
+{
+	DecompressAllFunction decompress_all;
+	DecompressionArena arena = { .mctx = CurrentMemoryContext };
+	ArrowArray *arrow;
+
+	if (!ts_guc_enable_bulk_decompression)
+		return false;
+
+	decompress_all =
+		tsl_get_decompress_all_function(header->compression_algorithm, per_col->decompressed_type);
+	if (decompress_all == NULL)
+		return false;
+
+	arrow = decompress_all(PointerGetDatum(header), per_col->decompressed_type, &arena);
+
+	per_col->arrow = arrow;
+	per_col->arrow_row = 0;
+	per_col->arrow_validity = arrow->buffers[0];
+	per_col->arrow_values = arrow->buffers[1];
+	per_col->arrow_varlena_datums = NULL;
+
+	if (per_col->value_bytes == -1)
+	{
+		if (arrow->dictionary != NULL)
+			per_col->arrow_varlena_datums = arrow_make_varlena_datums(arrow->dictionary);
+		else
+		{
+			per_col->arrow_varlena_datums = arrow_make_varlena_datums(arrow);
+			per_col->arrow_values = NULL;
+		}
+	}
+
+	return true;
+}
+
 void
 populate_per_compressed_columns_from_data(PerCompressedColumn *per_compressed_cols, int16 num_cols,
 										  Datum *compressed_datums, bool *compressed_is_nulls)
@@ -1518,6 +2298,7 @@ populate_per_compressed_columns_from_data(PerCompressedColumn *per_compressed_co
 			continue;
 
 		per_col->is_null = compressed_is_nulls[col];
+		per_col->arrow = NULL;
 		if (per_col->is_null)
 		{
 			per_col->is_null = true;
@@ -1530,21 +2311,171 @@ populate_per_compressed_columns_from_data(PerCompressedColumn *per_compressed_co
 		{
 			CompressedDataHeader *header = get_compressed_data_header(compressed_datums[col]);
 
-			per_col->iterator =
-				definitions[header->compression_algorithm]
-					.iterator_init_forward(PointerGetDatum(header), per_col->decompressed_type);
+			per_col->iterator = NULL;
+			if (!per_compressed_col_decompress_all(per_col, header))
+				per_col->iterator =
+					definitions[header->compression_algorithm]
+						.iterator_init_forward(PointerGetDatum(header), per_col->decompressed_type);
+		}
+		else
+			per_col->val = compressed_datums[col];
+	}
+}
+
+/*
+ * Get the n-th slot for the decompressed rows of a compressed row, creating
+ * more slots if needed.
+ */
+static TupleTableSlot *
+row_decompressor_get_slot(RowDecompressor *decompressor, int n)
+{
+	if (n >= decompressor->num_decompressed_slots)
+	{
+		MemoryContext old_ctx =
+			MemoryContextSwitchTo(MemoryContextGetParent(decompressor->per_compressed_row_ctx));
+		int num_slots = Max(n + 1, Max(2 * decompressor->num_decompressed_slots,
+									   MAX_ROWS_PER_COMPRESSION));
+		TupleDesc desc = CreateTupleDescCopy(decompressor->out_desc);
+
+		if (decompressor->decompressed_slots == NULL)
+			decompressor->decompressed_slots = palloc(sizeof(TupleTableSlot *) * num_slots);
+		else
+			decompressor->decompressed_slots = repalloc(decompressor->decompressed_slots,
+														sizeof(TupleTableSlot *) * num_slots);
+
+		for (int i = decompressor->num_decompressed_slots; i < num_slots; i++)
+			decompressor->decompressed_slots[i] = MakeSingleTupleTableSlot(desc, &TTSOpsHeapTuple);
+
+		decompressor->num_decompressed_slots = num_slots;
+		MemoryContextSwitchTo(old_ctx);
+	}
+
+	return decompressor->decompressed_slots[n];
+}
+
+/*
+ * Insert the decompressed rows of a compressed row into the output relation
+ * with a single table_multi_insert(), and into its indexes unless the
+ * decompressor has no index state, because the caller rebuilds the indexes.
+ */
+static void
+row_decompressor_insert_slots(RowDecompressor *decompressor, int num_rows)
+{
+	TupleTableSlot **slots = decompressor->decompressed_slots;
+
+	table_multi_insert(decompressor->out_rel,
+					   slots,
+					   num_rows,
+					   decompressor->mycid,
+					   0 /*=options*/,
+					   decompressor->bistate);
+
+	for (int i = 0; i < num_rows; i++)
+	{
+		if (decompressor->indexstate != NULL)
+		{
+			HeapTuple tuple = ExecFetchSlotHeapTuple(slots[i], false, NULL);
+
+			tuple->t_self = slots[i]->tts_tid;
+			ts_catalog_index_insert(decompressor->indexstate, tuple);
+		}
+
+		ExecClearTuple(slots[i]);
+	}
+}
+
+void
+row_decompressor_decompress_row(RowDecompressor *decompressor, Tuplesortstate *tuplesortstate)
+{
+	/* each compressed row decompresses to at least one row,
+	 * even if all the data is NULL
+	 */
+	bool wrote_data = false;
+	bool is_done = false;
+	int num_rows = 0;
+
+	MemoryContext old_ctx = MemoryContextSwitchTo(decompressor->per_compressed_row_ctx);
+
+	populate_per_compressed_columns_from_data(decompressor->per_compressed_cols,
+											  decompressor->in_desc->natts,
+											  decompressor->compressed_datums,
+											  decompressor->compressed_is_nulls);
+
+	do
+	{
+		/* we're done if all the decompressors return NULL */
+		is_done = true;
+		for (int16 col = 0; col < decompressor->num_compressed_columns; col++)
+		{
+			bool col_is_done = per_compressed_col_get_data(&decompressor->per_compressed_cols[col],
+														   decompressor->decompressed_datums,
+														   decompressor->decompressed_is_nulls,
+														   decompressor->out_desc);
+			is_done &= col_is_done;
+		}
+
+		/* if we're not done we have data to write. even if we're done, each
+		 * compressed should decompress to at least one row, so we should write that
+		 */
+		if (!is_done || !wrote_data)
+		{
+			if (tuplesortstate == NULL)
+			{
+				/*
+				 * The tuple is freed with the per-compressed-row context,
+				 * after the rows are inserted.
+				 */
+				HeapTuple decompressed_tuple = heap_form_tuple(decompressor->out_desc,
+															   decompressor->decompressed_datums,
+															   decompressor->decompressed_is_nulls);
+
+				ExecStoreHeapTuple(decompressed_tuple,
+								   row_decompressor_get_slot(decompressor, num_rows),
+								   false);
+				num_rows++;
+			}
+			else
+			{
+				/* create the virtual tuple slot */
+				TupleTableSlot *slot =
+					MakeSingleTupleTableSlot(decompressor->out_desc, &TTSOpsVirtual);
+
+				ExecClearTuple(slot);
+				for (int i = 0; i < decompressor->out_desc->natts; i++)
+				{
+					slot->tts_isnull[i] = decompressor->decompressed_is_nulls[i];
+					slot->tts_values[i] = decompressor->decompressed_datums[i];
+				}
+
+				ExecStoreVirtualTuple(slot);
+
+				slot_getallattrs(slot);
+
+				tuplesort_puttupleslot(tuplesortstate, slot);
+				ExecDropSingleTupleTableSlot(slot);
+			}
+
+			wrote_data = true;
 		}
-		else
-			per_col->val = compressed_datums[col];
-	}
+	} while (!is_done);
+
+	if (num_rows > 0)
+		row_decompressor_insert_slots(decompressor, num_rows);
+
+	MemoryContextSwitchTo(old_ctx);
+	MemoryContextReset(decompressor->per_compressed_row_ctx);
 }
 
+/*
+ * Decompress the compressed row in the decompressor like
+ * row_decompressor_decompress_row(), but pass the decompressed rows to a
+ * callback instead of writing them out. The values passed to the callback
+ * are only valid until it returns.
+ */
 void
-row_decompressor_decompress_row(RowDecompressor *decompressor, Tuplesortstate *tuplesortstate)
+row_decompressor_decompress_row_to_callback(RowDecompressor *decompressor,
+											RowDecompressorCallback callback, void *arg)
 {
-	/* each compressed row decompresses to at least one row,
-	 * even if all the data is NULL
-	 */
 	bool wrote_data = false;
 	bool is_done = false;
 
@@ -1557,7 +2488,6 @@ row_decompressor_decompress_row(RowDecompressor *decompressor, Tuplesortstate *t
 
 	do
 	{
-		/* we're done if all the decompressors return NULL */
 		is_done = true;
 		for (int16 col = 0; col < decompressor->num_compressed_columns; col++)
 		{
@@ -1568,45 +2498,10 @@ row_decompressor_decompress_row(RowDecompressor *decompressor, Tuplesortstate *t
 			is_done &= col_is_done;
 		}
 
-		/* if we're not done we have data to write. even if we're done, each
-		 * compressed should decompress to at least one row, so we should write that
-		 */
+		/* each compressed row decompresses to at least one row */
 		if (!is_done || !wrote_data)
 		{
-			HeapTuple decompressed_tuple = heap_form_tuple(decompressor->out_desc,
-														   decompressor->decompressed_datums,
-														   decompressor->decompressed_is_nulls);
-			TupleTableSlot *slot = MakeSingleTupleTableSlot(decompressor->out_desc, &TTSOpsVirtual);
-
-			if (tuplesortstate == NULL)
-			{
-				heap_insert(decompressor->out_rel,
-							decompressed_tuple,
-							decompressor->mycid,
-							0 /*=options*/,
-							decompressor->bistate);
-
-				ts_catalog_index_insert(decompressor->indexstate, decompressed_tuple);
-			}
-			else
-			{
-				/* create the virtual tuple slot */
-				ExecClearTuple(slot);
-				for (int i = 0; i < decompressor->out_desc->natts; i++)
-				{
-					slot->tts_isnull[i] = decompressor->decompressed_is_nulls[i];
-					slot->tts_values[i] = decompressor->decompressed_datums[i];
-				}
-
-				ExecStoreVirtualTuple(slot);
-
-				slot_getallattrs(slot);
-
-				tuplesort_puttupleslot(tuplesortstate, slot);
-			}
-
-			ExecDropSingleTupleTableSlot(slot);
-			heap_freetuple(decompressed_tuple);
+			callback(arg, decompressor->decompressed_datums, decompressor->decompressed_is_nulls);
 			wrote_data = true;
 		}
 	} while (!is_done);
@@ -1648,6 +2543,59 @@ per_compressed_col_get_data(PerCompressedColumn *per_compressed_col, Datum *deco
 		return true;
 	}
 
+	/* bulk decompressed data */
+	if (per_compressed_col->arrow != NULL)
+	{
+		const int row = per_compressed_col->arrow_row;
+
+		if (row >= per_compressed_col->arrow->length)
+		{
+			per_compressed_col->arrow = NULL;
+			decompressed_is_nulls[decompressed_column_offset] = true;
+			return true;
+		}
+
+		per_compressed_col->arrow_row++;
+		decompressed_is_nulls[decompressed_column_offset] =
+			!arrow_row_is_valid(per_compressed_col->arrow_validity, row);
+
+		if (per_compressed_col->arrow_varlena_datums != NULL)
+		{
+			const int index = per_compressed_col->arrow_values != NULL ?
+								  ((const int16 *) per_compressed_col->arrow_values)[row] :
+								  row;
+
+			decompressed_datums[decompressed_column_offset] =
+				per_compressed_col->arrow_varlena_datums[index];
+		}
+		else
+		{
+			/*
+			 * Like in the DecompressChunk node, we can always read 8 bytes
+			 * because of the padding of the Arrow buffers, and zero out the
+			 * bytes that don't belong to the value.
+			 */
+			const int value_bytes = per_compressed_col->value_bytes;
+			const char *src = per_compressed_col->arrow_values;
+			uint64 value;
+
+			Assert(value_bytes > 0);
+			memcpy(&value, &src[value_bytes * row], 8);
+			value &= ~0ULL >> (64 - 8 * value_bytes);
+
+#ifdef USE_FLOAT8_BYVAL
+			decompressed_datums[decompressed_column_offset] = Int64GetDatum(value);
+#else
+			if (value_bytes <= 4)
+				decompressed_datums[decompressed_column_offset] = Int32GetDatum((uint32) value);
+			else
+				decompressed_datums[decompressed_column_offset] = Int64GetDatum(value);
+#endif
+		}
+
+		return false;
+	}
+
 	/* other compressed data */
 	if (per_compressed_col->iterator == NULL)
 		elog(ERROR, "tried to decompress more data than was compressed in column");
@@ -1844,14 +2792,111 @@ compression_get_toast_storage(CompressionAlgorithms algorithm)
 	return definitions[algorithm].compressed_data_storage;
 }
 
+/*
+ * A check of the bloom filter metadata of a compressed batch for the value of
+ * a unique key column. The heap scan can't evaluate it as a scankey, so it is
+ * checked for each compressed tuple.
+ */
+typedef struct BatchBloomCheck
+{
+	AttrNumber bloom_attno;
+	uint64 hash;
+} BatchBloomCheck;
+
+/*
+ * Use the optional metadata of a unique key column that is neither segmentby
+ * nor orderby to skip the batches that can't contain the value: the sparse
+ * min/max metadata become range scankeys, and the bloom filter is checked
+ * for each batch.
+ */
+static int
+create_sparse_filter_scankeys(RowDecompressor *decompressor, Form_pg_attribute attr, Datum value,
+							  ScanKeyData *scankeys, int num_scankeys, Bitmapset **null_columns,
+							  List **bloom_checks)
+{
+	const char *attname = NameStr(attr->attname);
+	Oid compressed_relid = RelationGetRelid(decompressor->in_rel);
+	char *min_name = compression_column_segment_sparse_min_name(attname);
+	char *max_name = compression_column_segment_sparse_max_name(attname);
+
+	if (min_name != NULL && max_name != NULL &&
+		get_attnum(compressed_relid, min_name) != InvalidAttrNumber &&
+		get_attnum(compressed_relid, max_name) != InvalidAttrNumber)
+	{
+		num_scankeys = create_segment_filter_scankey(decompressor,
+													 min_name,
+													 BTLessEqualStrategyNumber,
+													 scankeys,
+													 num_scankeys,
+													 null_columns,
+													 value,
+													 false); /* is_null_check */
+		num_scankeys = create_segment_filter_scankey(decompressor,
+													 max_name,
+													 BTGreaterEqualStrategyNumber,
+													 scankeys,
+													 num_scankeys,
+													 null_columns,
+													 value,
+													 false); /* is_null_check */
+	}
+
+	char *bloom_name = compression_column_segment_bloom_name(attname);
+	AttrNumber bloom_attno =
+		bloom_name != NULL ? get_attnum(compressed_relid, bloom_name) : InvalidAttrNumber;
+	if (bloom_attno == InvalidAttrNumber)
+		return num_scankeys;
+
+	/*
+	 * The bloom filter uses the hash function of the type, so it can only
+	 * tell which batches don't contain the values that are equal according
+	 * to the btree equality the uniqueness is checked with, when the hash
+	 * opfamily agrees with it.
+	 */
+	TypeCacheEntry *tce =
+		lookup_type_cache(attr->atttypid, TYPECACHE_EQ_OPR | TYPECACHE_HASH_OPFAMILY);
+	if (!OidIsValid(tce->eq_opr) || !OidIsValid(tce->hash_opf) ||
+		get_op_opfamily_strategy(tce->eq_opr, tce->hash_opf) != HTEqualStrategyNumber)
+		return num_scankeys;
+
+	BatchBloomCheck *check = palloc(sizeof(BatchBloomCheck));
+	check->bloom_attno = bloom_attno;
+	check->hash = segment_meta_bloom_hash(attr->atttypid, attr->attcollation, value);
+	*bloom_checks = lappend(*bloom_checks, check);
+
+	return num_scankeys;
+}
+
+/*
+ * Check the bloom filters of the compressed tuple. A batch without a bloom
+ * filter has only NULL values in the column, so it can't conflict either.
+ */
+static bool
+batch_bloom_checks_pass(List *bloom_checks, HeapTuple compressed_tuple, TupleDesc compressed_desc)
+{
+	ListCell *lc;
+
+	foreach (lc, bloom_checks)
+	{
+		BatchBloomCheck *check = lfirst(lc);
+		bool isnull;
+		Datum bloom = heap_getattr(compressed_tuple, check->bloom_attno, compressed_desc, &isnull);
+
+		if (isnull || !segment_meta_bloom_contains_hash(DatumGetByteaPP(bloom), check->hash))
+			return false;
+	}
+
+	return true;
+}
+
 /*
  * Build scankeys for decompression of specific batches. key_columns references the
  * columns of the uncompressed chunk.
  */
 static ScanKeyData *
 build_scankeys(int32 hypertable_id, Oid hypertable_relid, RowDecompressor decompressor,
-			   Bitmapset *key_columns, Bitmapset **null_columns, TupleTableSlot *slot,
-			   int *num_scankeys)
+			   Bitmapset *key_columns, Bitmapset **null_columns, List **bloom_checks,
+			   TupleTableSlot *slot, int *num_scankeys)
 {
 	int key_index = 0;
 	ScanKeyData *scankeys = NULL;
@@ -1881,9 +2926,9 @@ build_scankeys(int32 hypertable_id, Oid hypertable_relid, RowDecompressor decomp
 			 * In this we can add 2 ScanKeys with range constraints
 			 * utilizing batch metadata.
 			 * 3. Column is neither segmentby nor orderby
-			 * In this case we cannot utilize this column for
-			 * batch filtering as the values are compressed and
-			 * we have no metadata.
+			 * In this case we can only utilize the optional sparse
+			 * min/max and bloom filter metadata of the column, if
+			 * there are any.
 			 */
 			if (COMPRESSIONCOL_IS_SEGMENT_BY(fd))
 			{
@@ -1921,6 +2966,18 @@ build_scankeys(int32 hypertable_id, Oid hypertable_relid, RowDecompressor decomp
 														  value,
 														  false); /* is_null_check */
 			}
+			else if (!COMPRESSIONCOL_IS_SEGMENT_BY(fd) && !isnull)
+			{
+				Form_pg_attribute attr =
+					TupleDescAttr(decompressor.out_desc, AttrNumberGetAttrOffset(attno));
+				key_index = create_sparse_filter_scankeys(&decompressor,
+														  attr,
+														  value,
+														  scankeys,
+														  key_index,
+														  null_columns,
+														  bloom_checks);
+			}
 		}
 	}
 
@@ -2011,6 +3068,7 @@ decompress_batches_for_insert(ChunkInsertState *cis, Chunk *chunk, TupleTableSlo
 	RowDecompressor decompressor = build_decompressor(in_rel, out_rel);
 	Bitmapset *key_columns = RelationGetIndexAttrBitmap(out_rel, INDEX_ATTR_BITMAP_KEY);
 	Bitmapset *null_columns = NULL;
+	List *bloom_checks = NIL;
 
 	int num_scankeys;
 	ScanKeyData *scankeys = build_scankeys(chunk->fd.hypertable_id,
@@ -2018,6 +3076,7 @@ decompress_batches_for_insert(ChunkInsertState *cis, Chunk *chunk, TupleTableSlo
 										   decompressor,
 										   key_columns,
 										   &null_columns,
+										   &bloom_checks,
 										   slot,
 										   &num_scankeys);
 
@@ -2057,6 +3116,13 @@ decompress_batches_for_insert(ChunkInsertState *cis, Chunk *chunk, TupleTableSlo
 		if (!valid)
 			continue;
 
+		/*
+		 * Skip if the batch can't contain the key according to its bloom
+		 * filters.
+		 */
+		if (!batch_bloom_checks_pass(bloom_checks, compressed_tuple, decompressor.in_desc))
+			continue;
+
 		heap_deform_tuple(compressed_tuple,
 						  decompressor.in_desc,
 						  decompressor.compressed_datums,
@@ -2089,6 +3155,193 @@ decompress_batches_for_insert(ChunkInsertState *cis, Chunk *chunk, TupleTableSlo
 	table_close(in_rel, NoLock);
 }
 
+/*
+ * Compare two tuples on the sort keys of the compression.
+ */
+static int
+compare_slots_on_sort_keys(TupleTableSlot *a, TupleTableSlot *b, int n_keys,
+						   const AttrNumber *sort_keys, SortSupport sortsupport)
+{
+	for (int n = 0; n < n_keys; n++)
+	{
+		bool a_isnull, b_isnull;
+		Datum a_value = slot_getattr(a, sort_keys[n], &a_isnull);
+		Datum b_value = slot_getattr(b, sort_keys[n], &b_isnull);
+		int cmp = ApplySortComparator(a_value, a_isnull, b_value, b_isnull, &sortsupport[n]);
+
+		if (cmp != 0)
+			return cmp;
+	}
+
+	return 0;
+}
+
+/*
+ * Compress the tuples buffered for a multi-insert into a compressed chunk
+ * and add them to the compressed chunk as new batches, instead of inserting
+ * them into the uncompressed chunk.
+ *
+ * The existing batches are not decompressed, so the new batches of a segment
+ * can overlap the existing ones in the orderby columns. We mark the chunk as
+ * unordered, so that the planner doesn't rely on the batch order, and the
+ * recompression merges the batches later.
+ *
+ * An empty chunk that is not compressed yet gets a new compressed chunk here.
+ * When the tuples inserted into it arrive in the order of the compression,
+ * as they do for backfills of sorted data, the batches are written in order
+ * and the chunk is not marked unordered, so it doesn't need a recompression.
+ * Already sorted buffers also skip the sort. Returns false if the compressed
+ * chunk cannot be created, and the tuples have to be inserted into the
+ * uncompressed chunk.
+ */
+bool
+compress_tuples_for_insert(ChunkInsertState *cis, TupleTableSlot **slots, int nslots)
+{
+	Relation uncompressed_rel = cis->rel;
+	TupleDesc uncompressed_desc = RelationGetDescr(uncompressed_rel);
+	Chunk *chunk = ts_chunk_get_by_relid(RelationGetRelid(uncompressed_rel), true);
+
+	if (chunk->fd.compressed_chunk_id == INVALID_CHUNK_ID)
+	{
+		if (!tsl_create_compressed_chunk_for_insert(chunk, uncompressed_rel))
+			return false;
+
+		chunk = ts_chunk_get_by_relid(RelationGetRelid(uncompressed_rel), true);
+		cis->chunk_compressed = true;
+		cis->chunk_partial = false;
+		cis->compress_ordered = true;
+	}
+
+	Chunk *compressed_chunk = ts_chunk_get_by_id(chunk->fd.compressed_chunk_id, true);
+
+	List *htcols_list = ts_hypertable_compression_get(chunk->fd.hypertable_id);
+	int htcols_listlen = list_length(htcols_list);
+	const ColumnCompressionInfo **colinfo_array =
+		palloc(sizeof(ColumnCompressionInfo *) * htcols_listlen);
+	ListCell *lc;
+	int i = 0;
+
+	foreach (lc, htcols_list)
+	{
+		FormData_hypertable_compression *fd = (FormData_hypertable_compression *) lfirst(lc);
+		colinfo_array[i++] = fd;
+	}
+
+	const ColumnCompressionInfo **keys;
+	int n_keys;
+	int16 *in_column_offsets = compress_chunk_populate_keys(chunk->table_id,
+															colinfo_array,
+															htcols_listlen,
+															&n_keys,
+															&keys);
+
+	AttrNumber *sort_keys = palloc(sizeof(*sort_keys) * n_keys);
+	Oid *sort_operators = palloc(sizeof(*sort_operators) * n_keys);
+	Oid *sort_collations = palloc(sizeof(*sort_collations) * n_keys);
+	bool *nulls_first = palloc(sizeof(*nulls_first) * n_keys);
+	SortSupport sortsupport = palloc0(sizeof(SortSupportData) * n_keys);
+
+	for (int n = 0; n < n_keys; n++)
+	{
+		compress_chunk_populate_sort_info_for_column(chunk->table_id,
+													 keys[n],
+													 &sort_keys[n],
+													 &sort_operators[n],
+													 &sort_collations[n],
+													 &nulls_first[n]);
+
+		sortsupport[n].ssup_cxt = CurrentMemoryContext;
+		sortsupport[n].ssup_collation = sort_collations[n];
+		sortsupport[n].ssup_nulls_first = nulls_first[n];
+		sortsupport[n].ssup_attno = sort_keys[n];
+		PrepareSortSupportFromOrderingOp(sort_operators[n], &sortsupport[n]);
+	}
+
+	bool presorted = true;
+	for (int n = 1; n < nslots && presorted; n++)
+		presorted =
+			compare_slots_on_sort_keys(slots[n - 1], slots[n], n_keys, sort_keys, sortsupport) <= 0;
+
+	/*
+	 * The batches stay in order when this buffer continues from the last
+	 * tuple of the previous one.
+	 */
+	if (cis->compress_ordered)
+	{
+		cis->compress_ordered = presorted;
+		if (presorted && cis->compress_last_tuple != NULL)
+		{
+			TupleTableSlot *last_slot =
+				MakeSingleTupleTableSlot(uncompressed_desc, &TTSOpsHeapTuple);
+
+			ExecStoreHeapTuple(cis->compress_last_tuple, last_slot, false);
+			cis->compress_ordered =
+				compare_slots_on_sort_keys(last_slot, slots[0], n_keys, sort_keys, sortsupport) <=
+				0;
+			ExecDropSingleTupleTableSlot(last_slot);
+		}
+
+		if (cis->compress_ordered)
+		{
+			MemoryContext old_mcxt = MemoryContextSwitchTo(cis->mctx);
+
+			if (cis->compress_last_tuple != NULL)
+				heap_freetuple(cis->compress_last_tuple);
+			cis->compress_last_tuple = ExecCopySlotHeapTuple(slots[nslots - 1]);
+			MemoryContextSwitchTo(old_mcxt);
+		}
+	}
+
+	Relation compressed_rel = table_open(compressed_chunk->table_id, RowExclusiveLock);
+
+	RowCompressor row_compressor;
+	row_compressor_init(&row_compressor,
+						uncompressed_desc,
+						compressed_rel,
+						htcols_listlen,
+						colinfo_array,
+						in_column_offsets,
+						RelationGetDescr(compressed_rel)->natts,
+						true /*need_bistate*/,
+						false /*reset_sequence*/);
+
+	if (presorted)
+	{
+		row_compressor_append_ordered_slots(&row_compressor, slots, nslots);
+	}
+	else
+	{
+		Tuplesortstate *sorted_rel = tuplesort_begin_heap(uncompressed_desc,
+														  n_keys,
+														  sort_keys,
+														  sort_operators,
+														  sort_collations,
+														  nulls_first,
+														  work_mem,
+														  NULL,
+														  false /*=randomAccess*/);
+
+		for (int n = 0; n < nslots; n++)
+			tuplesort_puttupleslot(sorted_rel, slots[n]);
+
+		tuplesort_performsort(sorted_rel);
+		row_compressor_append_sorted_rows(&row_compressor, sorted_rel, uncompressed_desc);
+		tuplesort_end(sorted_rel);
+	}
+
+	row_compressor_finish(&row_compressor);
+	table_close(compressed_rel, NoLock);
+
+	if (!cis->compress_ordered && !ts_chunk_is_unordered(chunk))
+	{
+		ts_chunk_set_unordered(chunk);
+		/* changed chunk status, so invalidate any plans involving this chunk */
+		CacheInvalidateRelcacheByRelid(chunk->table_id);
+	}
+
+	return true;
+}
+
 #if !defined(NDEBUG) || defined(TS_COMPRESSION_FUZZING)
 
 static int
@@ -2715,6 +3968,98 @@ find_matching_index(Relation comp_chunk_rel, List *index_filters)
 	return NULL;
 }
 
+/*
+ * Add the filters on the min/max metadata columns of a column for a
+ * comparison of the column with a constant.
+ */
+static void
+add_min_max_filters(List **filters, char *min_name, char *max_name, int op_strategy,
+					Const *arg_value)
+{
+	switch (op_strategy)
+	{
+		case BTEqualStrategyNumber:
+		{
+			/* col = value implies min <= value and max >= value */
+			*filters = lappend(*filters,
+							   add_filter_column_strategy(min_name,
+														  BTLessEqualStrategyNumber,
+														  arg_value,
+														  false)); /* is_null_check */
+			*filters = lappend(*filters,
+							   add_filter_column_strategy(max_name,
+														  BTGreaterEqualStrategyNumber,
+														  arg_value,
+														  false)); /* is_null_check */
+		}
+		break;
+		case BTLessStrategyNumber:
+		case BTLessEqualStrategyNumber:
+		{
+			/* col <[=] value implies min <[=] value */
+			*filters = lappend(*filters,
+							   add_filter_column_strategy(min_name,
+														  op_strategy,
+														  arg_value,
+														  false)); /* is_null_check */
+		}
+		break;
+		case BTGreaterStrategyNumber:
+		case BTGreaterEqualStrategyNumber:
+		{
+			/* col >[=] value implies max >[=] value */
+			*filters = lappend(*filters,
+							   add_filter_column_strategy(max_name,
+														  op_strategy,
+														  arg_value,
+														  false)); /* is_null_check */
+		}
+	}
+}
+
+/*
+ * Use the optional sparse min/max and bloom filter metadata of a column that
+ * is neither segmentby nor orderby for a comparison of the column with a
+ * constant.
+ */
+static void
+add_sparse_metadata_filters(Oid compressed_relid, Var *var, OpExpr *opexpr, int op_strategy,
+							Const *arg_value, const char *column_name, List **filters,
+							List **bloom_checks)
+{
+	char *min_name = compression_column_segment_sparse_min_name(column_name);
+	char *max_name = compression_column_segment_sparse_max_name(column_name);
+
+	if (min_name != NULL && max_name != NULL &&
+		get_attnum(compressed_relid, min_name) != InvalidAttrNumber &&
+		get_attnum(compressed_relid, max_name) != InvalidAttrNumber)
+		add_min_max_filters(filters, min_name, max_name, op_strategy, arg_value);
+
+	if (op_strategy != BTEqualStrategyNumber || arg_value->constisnull)
+		return;
+
+	char *bloom_name = compression_column_segment_bloom_name(column_name);
+	AttrNumber bloom_attno =
+		bloom_name != NULL ? get_attnum(compressed_relid, bloom_name) : InvalidAttrNumber;
+	if (bloom_attno == InvalidAttrNumber)
+		return;
+
+	/*
+	 * Like the qual pushdown, we can only use the bloom filter for the
+	 * equality of the hash opfamily with the collation of the column.
+	 */
+	TypeCacheEntry *tce = lookup_type_cache(var->vartype, TYPECACHE_HASH_OPFAMILY);
+	if (!OidIsValid(tce->hash_opf) ||
+		get_op_opfamily_strategy(opexpr->opno, tce->hash_opf) != HTEqualStrategyNumber ||
+		opexpr->inputcollid != var->varcollid || arg_value->consttype != var->vartype)
+		return;
+
+	BatchBloomCheck *check = palloc(sizeof(BatchBloomCheck));
+	check->bloom_attno = bloom_attno;
+	check->hash = segment_meta_bloom_hash(var->vartype, var->varcollid, arg_value->constvalue);
+	*bloom_checks = lappend(*bloom_checks, check);
+}
+
 /*
  * This method will evaluate the predicates, extract
  * left and right operands, check if one of the operands is
@@ -2722,11 +4067,13 @@ find_matching_index(Relation comp_chunk_rel, List *index_filters)
  * column name from hypertable_compression catalog table.
  * If extracted column is a SEGMENT BY column then save column
  * name, value specified in the predicate. This information will
- * be used to build scan keys later.
+ * be used to build scan keys later. For the other columns, we
+ * use their min/max and bloom filter metadata.
  */
 static void
-fill_predicate_context(Chunk *ch, List *predicates, List **filters, List **index_filters,
-					   List **segmentby_predicates, List **is_null)
+fill_predicate_context(Chunk *ch, Oid compressed_relid, List *predicates, List **filters,
+					   List **index_filters, List **segmentby_predicates, List **is_null,
+					   List **bloom_checks)
 {
 	ListCell *lc;
 	foreach (lc, predicates)
@@ -2742,6 +4089,7 @@ fill_predicate_context(Chunk *ch, List *predicates, List **filters, List **index
 			case T_OpExpr:
 			{
 				OpExpr *opexpr = (OpExpr *) node;
+				Oid opno = opexpr->opno;
 				Expr *leftop, *rightop;
 				Const *arg_value;
 
@@ -2762,6 +4110,8 @@ fill_predicate_context(Chunk *ch, List *predicates, List **filters, List **index
 				{
 					var = (Var *) rightop;
 					arg_value = (Const *) leftop;
+					/* the metadata filters need the operator with the column on the left */
+					opno = get_commutator(opno);
 				}
 				else
 					continue;
@@ -2770,7 +4120,8 @@ fill_predicate_context(Chunk *ch, List *predicates, List **filters, List **index
 				FormData_hypertable_compression *fd =
 					ts_hypertable_compression_get_by_pkey(ch->fd.hypertable_id, column_name);
 				TypeCacheEntry *tce = lookup_type_cache(var->vartype, TYPECACHE_BTREE_OPFAMILY);
-				int op_strategy = get_op_opfamily_strategy(opexpr->opno, tce->btree_opf);
+				int op_strategy =
+					OidIsValid(opno) ? get_op_opfamily_strategy(opno, tce->btree_opf) : 0;
 				if (COMPRESSIONCOL_IS_SEGMENT_BY(fd))
 				{
 					switch (op_strategy)
@@ -2795,49 +4146,22 @@ fill_predicate_context(Chunk *ch, List *predicates, List **filters, List **index
 				}
 				else if (COMPRESSIONCOL_IS_ORDER_BY(fd))
 				{
-					switch (op_strategy)
-					{
-						case BTEqualStrategyNumber:
-						{
-							/* orderby col = value implies min <= value and max >= value */
-							*filters = lappend(
-								*filters,
-								add_filter_column_strategy(compression_column_segment_min_name(fd),
-														   BTLessEqualStrategyNumber,
-														   arg_value,
-														   false)); /* is_null_check */
-							*filters = lappend(
-								*filters,
-								add_filter_column_strategy(compression_column_segment_max_name(fd),
-														   BTGreaterEqualStrategyNumber,
-														   arg_value,
-														   false)); /* is_null_check */
-						}
-						break;
-						case BTLessStrategyNumber:
-						case BTLessEqualStrategyNumber:
-						{
-							/* orderby col <[=] value implies min <[=] value */
-							*filters = lappend(
-								*filters,
-								add_filter_column_strategy(compression_column_segment_min_name(fd),
-														   op_strategy,
-														   arg_value,
-														   false)); /* is_null_check */
-						}
-						break;
-						case BTGreaterStrategyNumber:
-						case BTGreaterEqualStrategyNumber:
-						{
-							/* orderby col >[=] value implies max >[=] value */
-							*filters = lappend(
-								*filters,
-								add_filter_column_strategy(compression_column_segment_max_name(fd),
-														   op_strategy,
-														   arg_value,
-														   false)); /* is_null_check */
-						}
-					}
+					add_min_max_filters(filters,
+										compression_column_segment_min_name(fd),
+										compression_column_segment_max_name(fd),
+										op_strategy,
+										arg_value);
+				}
+				else
+				{
+					add_sparse_metadata_filters(compressed_relid,
+												var,
+												opexpr,
+												op_strategy,
+												arg_value,
+												column_name,
+												filters,
+												bloom_checks);
 				}
 			}
 			break;
@@ -2988,7 +4312,8 @@ report_error(TM_Result result)
  */
 static bool
 decompress_batches(RowDecompressor *decompressor, ScanKeyData *scankeys, int num_scankeys,
-				   Bitmapset *null_columns, List *is_nulls, bool *chunk_status_changed)
+				   Bitmapset *null_columns, List *is_nulls, List *bloom_checks,
+				   bool *chunk_status_changed)
 {
 	TM_Result result;
 	HeapTuple compressed_tuple;
@@ -3021,6 +4346,8 @@ decompress_batches(RowDecompressor *decompressor, ScanKeyData *scankeys, int num
 		}
 		if (skip_tuple)
 			continue;
+		if (!batch_bloom_checks_pass(bloom_checks, compressed_tuple, decompressor->in_desc))
+			continue;
 		heap_deform_tuple(compressed_tuple,
 						  decompressor->in_desc,
 						  decompressor->compressed_datums,
@@ -3089,7 +4416,8 @@ build_index_scankeys(Relation in_rel, Relation index_rel, List *predicates, int
 static bool
 decompress_batches_using_index(RowDecompressor *decompressor, Relation index_rel,
 							   ScanKeyData *index_scankeys, int num_index_scankeys,
-							   ScanKeyData *scankeys, int num_scankeys, bool *chunk_status_changed)
+							   ScanKeyData *scankeys, int num_scankeys, List *bloom_checks,
+							   bool *chunk_status_changed)
 {
 	HeapTuple compressed_tuple;
 	Snapshot snapshot;
@@ -3129,9 +4457,16 @@ decompress_batches_using_index(RowDecompressor *decompressor, Relation index_rel
 			if (!valid)
 			{
 				num_orderby_filtered_rows++;
+				heap_freetuple(compressed_tuple);
 				continue;
 			}
 		}
+		if (!batch_bloom_checks_pass(bloom_checks, compressed_tuple, decompressor->in_desc))
+		{
+			num_orderby_filtered_rows++;
+			heap_freetuple(compressed_tuple);
+			continue;
+		}
 		heap_deform_tuple(compressed_tuple,
 						  decompressor->in_desc,
 						  decompressor->compressed_datums,
@@ -3181,6 +4516,7 @@ decompress_batches_for_update_delete(Chunk *chunk, List *predicates, EState *est
 	List *index_filters = NIL;
 	List *segmentby_predicates = NIL;
 	List *is_null = NIL;
+	List *bloom_checks = NIL;
 	ListCell *lc = NULL;
 	Relation chunk_rel;
 	Relation comp_chunk_rel;
@@ -3195,16 +4531,18 @@ decompress_batches_for_update_delete(Chunk *chunk, List *predicates, EState *est
 	ScanKeyData *index_scankeys = NULL;
 	int num_index_scankeys = 0;
 
+	chunk_rel = table_open(chunk->table_id, RowExclusiveLock);
+	comp_chunk = ts_chunk_get_by_id(chunk->fd.compressed_chunk_id, true);
+	comp_chunk_rel = table_open(comp_chunk->table_id, RowExclusiveLock);
+
 	fill_predicate_context(chunk,
+						   comp_chunk->table_id,
 						   predicates,
 						   &filters,
 						   &index_filters,
 						   &segmentby_predicates,
-						   &is_null);
-
-	chunk_rel = table_open(chunk->table_id, RowExclusiveLock);
-	comp_chunk = ts_chunk_get_by_id(chunk->fd.compressed_chunk_id, true);
-	comp_chunk_rel = table_open(comp_chunk->table_id, RowExclusiveLock);
+						   &is_null,
+						   &bloom_checks);
 	decompressor = build_decompressor(comp_chunk_rel, chunk_rel);
 
 	write_logical_replication_msg_decompression_start();
@@ -3233,6 +4571,7 @@ decompress_batches_for_update_delete(Chunk *chunk, List *predicates, EState *est
 									   num_index_scankeys,
 									   scankeys,
 									   num_scankeys,
+									   bloom_checks,
 									   &chunk_status_changed);
 		/* close the selected index */
 		index_close(matching_index_rel, AccessShareLock);
@@ -3244,6 +4583,7 @@ decompress_batches_for_update_delete(Chunk *chunk, List *predicates, EState *est
 						   num_scankeys,
 						   null_columns,
 						   is_null,
+						   bloom_checks,
 						   &chunk_status_changed);
 	}
 	write_logical_replication_msg_decompression_end();
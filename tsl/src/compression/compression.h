@@ -11,6 +11,7 @@
 #include <executor/tuptable.h>
 #include <fmgr.h>
 #include <lib/stringinfo.h>
+#include <utils/hsearch.h>
 #include <utils/relcache.h>
 
 typedef struct BulkInsertStateData *BulkInsertState;
@@ -31,9 +32,19 @@ typedef struct BulkInsertStateData *BulkInsertState;
 	char vl_len_[4];                                                                               \
 	uint8 compression_algorithm
 
+/* The default number of rows in a compressed batch. */
 #define MAX_ROWS_PER_COMPRESSION 1000
 /* gap in sequence id between rows, potential for adding rows in gap later */
 #define SEQUENCE_NUM_GAP 10
+/*
+ * Limits for the compressed tuples buffered before inserting them into the
+ * compressed chunk, the same as for COPY.
+ */
+#define MAX_BUFFERED_COMPRESSED_TUPLES 1000
+#define MAX_BUFFERED_COMPRESSED_BYTES 65535
+/* Number of batches we compress with both the default and the alternative algorithms. */
+#define ALGORITHM_TRIAL_BATCHES 10
+#define MAX_TRIAL_ALGORITHMS 2
 #define COMPRESSIONCOL_IS_SEGMENT_BY(col) ((col)->segmentby_column_index > 0)
 #define COMPRESSIONCOL_IS_ORDER_BY(col) ((col)->orderby_column_index > 0)
 
@@ -113,6 +124,22 @@ typedef struct PerCompressedColumn
 	 */
 	DecompressionIterator *iterator;
 
+	/*
+	 * The bulk decompressed data of a compressed column, used instead of the
+	 * iterator when the compression algorithm supports bulk decompression.
+	 * For varlena types, the datums are built for the dictionary if the array
+	 * is dictionary-encoded, and the values buffer holds the dictionary
+	 * indices of the rows.
+	 */
+	ArrowArray *arrow;
+	const void *arrow_values;
+	const uint64 *arrow_validity;
+	const Datum *arrow_varlena_datums;
+	int arrow_row;
+
+	/* typlen of the decompressed type */
+	int16 value_bytes;
+
 	/* segment info; only used if !is_compressed */
 	Datum val;
 
@@ -149,6 +176,14 @@ typedef struct RowDecompressor
 	Datum *decompressed_datums;
 	bool *decompressed_is_nulls;
 
+	/*
+	 * The rows of a compressed row, inserted into out_rel together with
+	 * table_multi_insert(). The slots use a copy of out_desc, so they don't
+	 * pin the tuple descriptor of the relation and don't have to be dropped.
+	 */
+	TupleTableSlot **decompressed_slots;
+	int num_decompressed_slots;
+
 	MemoryContext per_compressed_row_ctx;
 } RowDecompressor;
 
@@ -164,14 +199,65 @@ typedef enum
 	TOAST_STORAGE_EXTENDED
 } CompressionStorage;
 
+/*
+ * The destination memory for the results of bulk decompression. The results
+ * are carved out of a preallocated buffer that the caller reuses for every
+ * compressed batch, so that we don't have to go through malloc and free for
+ * the large result buffers which the memory contexts allocate as separate
+ * blocks. When the buffer is exhausted, or if there is no buffer, we allocate
+ * in the memory context. Resetting the arena doesn't free the memory context
+ * allocations, the caller has to reset the memory context too.
+ */
+typedef struct DecompressionArena
+{
+	MemoryContext mctx;
+	char *buffer;
+	Size capacity;
+	Size used;
+} DecompressionArena;
+
+static inline void *
+decompression_arena_alloc(DecompressionArena *arena, Size size)
+{
+	size = MAXALIGN(size);
+	if (arena->capacity - arena->used >= size)
+	{
+		void *result = arena->buffer + arena->used;
+		arena->used += size;
+		return result;
+	}
+
+	return MemoryContextAlloc(arena->mctx, size);
+}
+
+static inline void *
+decompression_arena_alloc_zero(DecompressionArena *arena, Size size)
+{
+	void *result = decompression_arena_alloc(arena, size);
+	memset(result, 0, size);
+	return result;
+}
+
+static inline void
+decompression_arena_reset(DecompressionArena *arena)
+{
+	arena->used = 0;
+}
+
 typedef ArrowArray *(*DecompressAllFunction)(Datum compressed, Oid element_type,
-											 MemoryContext dest_mctx);
+											 DecompressionArena *dest);
 
 typedef struct CompressionAlgorithmDefinition
 {
 	DecompressionIterator *(*iterator_init_forward)(Datum, Oid element_type);
 	DecompressionIterator *(*iterator_init_reverse)(Datum, Oid element_type);
 	DecompressAllFunction decompress_all;
+	/*
+	 * Detoast only the part of the compressed data that is required to
+	 * decompress its first rows, and return it as a shorter compressed datum
+	 * that can be decompressed in the forward direction. Optional.
+	 */
+	Datum (*detoast_prefix)(Datum compressed, int num_rows);
 	void (*compressed_data_send)(CompressedDataHeader *, StringInfo);
 	Datum (*compressed_data_recv)(StringInfo);
 
@@ -188,6 +274,7 @@ typedef enum CompressionAlgorithms
 	COMPRESSION_ALGORITHM_DICTIONARY,
 	COMPRESSION_ALGORITHM_GORILLA,
 	COMPRESSION_ALGORITHM_DELTADELTA,
+	COMPRESSION_ALGORITHM_BITPACKING,
 
 	/* When adding an algorithm also add a static assert statement below */
 	/* end of real values */
@@ -213,9 +300,29 @@ typedef struct PerColumn
 	int16 max_metadata_attr_offset;
 	SegmentMetaMinMaxBuilder *min_max_metadata_builder;
 
+	/*
+	 * The bloom filter metadata, only used for the columns that have the
+	 * bloom filter column in the compressed table, {-1, NULL} for others.
+	 */
+	int16 bloom_metadata_attr_offset;
+	SegmentMetaBloomBuilder *bloom_metadata_builder;
+
 	/* segment info; only used if compressor is NULL */
 	SegmentInfo *segment_info;
 	int16 segmentby_column_index;
+
+	/*
+	 * The compressors with the alternative algorithms that we try on the first
+	 * batches of the column. There are none if we don't try any or have already
+	 * chosen the algorithm. The element type of the column is stored for
+	 * checking the values the alternative algorithms can't represent exactly.
+	 */
+	Compressor *trial_compressors[MAX_TRIAL_ALGORITHMS];
+	int64 trial_compressor_bytes[MAX_TRIAL_ALGORITHMS];
+	int16 n_trial_compressors;
+	Oid trial_element_type;
+	int16 trial_batches_left;
+	int64 compressor_bytes;
 } PerColumn;
 
 typedef struct RowCompressor
@@ -250,8 +357,17 @@ typedef struct RowCompressor
 
 	/* the number of uncompressed rows compressed into the current compressed row */
 	uint32 rows_compressed_into_current_value;
+	/* the max number of rows in a compressed row */
+	uint32 max_rows_per_compression;
 	/* a unique monotonically increasing (according to order by) id for each compressed row */
 	int32 sequence_num;
+	/*
+	 * The sequence number the group starts from when we reset it, and the
+	 * increment between the compressed rows. The segmentwise recompression
+	 * changes them to fit the new compressed rows between the existing ones.
+	 */
+	int32 first_sequence_num;
+	int32 sequence_num_step;
 
 	/* cached arrays used to build the HeapTuple */
 	Datum *compressed_values;
@@ -260,8 +376,25 @@ typedef struct RowCompressor
 	int64 num_compressed_rows;
 	/* if recompressing segmentwise, we use this info to reset the sequence number */
 	bool reset_sequence;
+	/*
+	 * The next sequence numbers of the segments compressed so far, so that a
+	 * segment doesn't need a scan of the compressed table each time it comes
+	 * again. The compressed table might also have been empty at the start, and
+	 * then the new segments need no scan either.
+	 */
+	HTAB *sequence_nums;
+	struct SequenceNumEntry *sequence_num_entry;
+	bool compressed_table_was_empty;
 	/* flag for checking if we are working on the first tuple */
 	bool first_iteration;
+
+	/* compressed tuples buffered for the multi-insert into the compressed table */
+	TupleTableSlot **insert_slots;
+	int n_buffered_tuples;
+	Size buffered_bytes;
+	CommandId buffered_cid;
+	/* options of the multi-insert, see row_compressor_insert_options() */
+	int insert_options;
 } RowCompressor;
 
 /* SegmentFilter is used for filtering segments based on qualifiers */
@@ -297,13 +430,14 @@ pg_attribute_unused() assert_num_compression_algorithms_sane(void)
 	StaticAssertStmt(COMPRESSION_ALGORITHM_DICTIONARY == 2, "algorithm index has changed");
 	StaticAssertStmt(COMPRESSION_ALGORITHM_GORILLA == 3, "algorithm index has changed");
 	StaticAssertStmt(COMPRESSION_ALGORITHM_DELTADELTA == 4, "algorithm index has changed");
+	StaticAssertStmt(COMPRESSION_ALGORITHM_BITPACKING == 5, "algorithm index has changed");
 
 	/*
 	 * This should change when adding a new algorithm after adding the new
 	 * algorithm to the assert list above. This statement prevents adding a
 	 * new algorithm without updating the asserts above
 	 */
-	StaticAssertStmt(_END_COMPRESSION_ALGORITHMS == 5,
+	StaticAssertStmt(_END_COMPRESSION_ALGORITHMS == 6,
 					 "number of algorithms have changed, the asserts should be updated");
 }
 
@@ -313,15 +447,23 @@ extern CompressionStats compress_chunk(Oid in_table, Oid out_table,
 									   int num_compression_infos);
 extern void decompress_chunk(Oid in_table, Oid out_table);
 
+extern Compressor *compressor_for_algorithm_and_type(CompressionAlgorithms algorithm, Oid type);
+/* The algorithm of a column when compression is enabled, in create.c */
+extern CompressionAlgorithms get_default_algorithm_id(Oid typeoid);
+
 extern DecompressionIterator *(*tsl_get_decompression_iterator_init(
 	CompressionAlgorithms algorithm, bool reverse))(Datum, Oid element_type);
 
-extern DecompressAllFunction tsl_get_decompress_all_function(CompressionAlgorithms algorithm);
+extern DecompressAllFunction tsl_get_decompress_all_function(CompressionAlgorithms algorithm,
+																   Oid type);
+
+extern Datum tsl_detoast_compressed_prefix(Datum compressed, int num_rows);
 
 typedef struct Chunk Chunk;
 typedef struct ChunkInsertState ChunkInsertState;
 extern void decompress_batches_for_insert(ChunkInsertState *cis, Chunk *chunk,
 										  TupleTableSlot *slot);
+extern bool compress_tuples_for_insert(ChunkInsertState *cis, TupleTableSlot **slots, int nslots);
 #if PG14_GE
 extern bool decompress_target_segments(ModifyTableState *ps);
 #endif
@@ -337,6 +479,10 @@ extern void compress_row_end(CompressSingleRowState *cr);
 extern void compress_row_destroy(CompressSingleRowState *cr);
 extern void row_decompressor_decompress_row(RowDecompressor *row_decompressor,
 											Tuplesortstate *tuplesortstate);
+typedef void (*RowDecompressorCallback)(void *arg, Datum *values, bool *nulls);
+extern void row_decompressor_decompress_row_to_callback(RowDecompressor *decompressor,
+														RowDecompressorCallback callback,
+														void *arg);
 extern int16 *compress_chunk_populate_keys(Oid in_table, const ColumnCompressionInfo **columns,
 										   int n_columns, int *n_keys_out,
 										   const ColumnCompressionInfo ***keys_out);
@@ -353,11 +499,14 @@ extern void row_compressor_init(RowCompressor *row_compressor, TupleDesc uncompr
 								int16 *column_offsets, int16 num_columns_in_compressed_table,
 								bool need_bistate, bool reset_sequence);
 extern void row_compressor_finish(RowCompressor *row_compressor);
+extern const Datum *arrow_make_varlena_datums(const ArrowArray *arrow);
 extern void populate_per_compressed_columns_from_data(PerCompressedColumn *per_compressed_cols,
 													  int16 num_cols, Datum *compressed_datums,
 													  bool *compressed_is_nulls);
 extern void row_compressor_append_sorted_rows(RowCompressor *row_compressor,
 											  Tuplesortstate *sorted_rel, TupleDesc sorted_desc);
+extern void row_compressor_append_ordered_slots(RowCompressor *row_compressor,
+												TupleTableSlot **slots, int nslots);
 extern void segment_info_update(SegmentInfo *segment_info, Datum val, bool is_null);
 
 extern RowDecompressor build_decompressor(Relation in_rel, Relation out_rel);
@@ -392,9 +541,10 @@ consumeCompressedData(StringInfo si, int bytes)
 }
 
 /*
- * Normal compression uses 1k rows, but the regression tests use up to 1015.
- * We use this limit for sanity checks in case the compressed data is corrupt.
+ * Normal compression uses 1k rows, but the batch size can be increased up to
+ * this limit with timescaledb.compression_batch_rows. We use this limit for
+ * sanity checks in case the compressed data is corrupt.
  */
-#define GLOBAL_MAX_ROWS_PER_COMPRESSION 1015
+#define GLOBAL_MAX_ROWS_PER_COMPRESSION 16384
 
 #endif
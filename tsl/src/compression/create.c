@@ -8,6 +8,7 @@
 #include <access/reloptions.h>
 #include <access/tupdesc.h>
 #include <access/xact.h>
+#include <catalog/dependency.h>
 #include <catalog/index.h>
 #include <catalog/indexing.h>
 #include <catalog/indexing.h>
@@ -30,6 +31,7 @@
 #include <utils/rel.h>
 #include <utils/syscache.h>
 #include <utils/typcache.h>
+#include <utils/varlena.h>
 
 #include "ts_catalog/catalog.h"
 #include "create.h"
@@ -39,6 +41,7 @@
 #include "compat/compat.h"
 #include "compression_with_clause.h"
 #include "compression.h"
+#include "segment_meta.h"
 #include "hypertable_cache.h"
 #include "ts_catalog/hypertable_compression.h"
 #include "custom_type_cache.h"
@@ -46,6 +49,10 @@
 #include "utils.h"
 #include "guc.h"
 
+#if PG14_GE
+#include <access/toast_compression.h>
+#endif
+
 /* entrypoint
  * tsl_process_compress_table : is the entry point.
  */
@@ -58,7 +65,7 @@ typedef struct CompressColInfo
 } CompressColInfo;
 
 static void compresscolinfo_init(CompressColInfo *cc, Oid srctbl_relid, List *segmentby_cols,
-								 List *orderby_cols);
+								 List *orderby_cols, List *bloom_cols, List *minmax_cols);
 static void compresscolinfo_init_singlecolumn(CompressColInfo *cc, const char *colname, Oid typid);
 static void compresscolinfo_add_catalog_entries(CompressColInfo *compress_cols, int32 htid);
 
@@ -74,7 +81,7 @@ static void compresscolinfo_add_catalog_entries(CompressColInfo *compress_cols,
 		}                                                                                          \
 	} while (0);
 
-static enum CompressionAlgorithms
+CompressionAlgorithms
 get_default_algorithm_id(Oid typeoid)
 {
 	switch (typeoid)
@@ -149,6 +156,172 @@ compression_column_segment_max_name(const FormData_hypertable_compression *fd)
 	return column_segment_max_name(fd->orderby_column_index);
 }
 
+/*
+ * The name of the optional metadata column for the given column, such as the
+ * bloom filter or the min/max of a column that is not orderby. These columns
+ * have no index in the catalog, so unlike the orderby min/max columns, the
+ * metadata column is named after the column. Returns NULL if the name doesn't
+ * fit, such columns can't have the optional metadata.
+ */
+static char *
+compression_column_named_metadata_name(const char *type, const char *attname)
+{
+	char *buf = palloc(sizeof(char) * NAMEDATALEN);
+	int ret = snprintf(buf, NAMEDATALEN, COMPRESSION_COLUMN_METADATA_PREFIX "%s_%s", type, attname);
+	if (ret < 0 || ret >= NAMEDATALEN)
+	{
+		pfree(buf);
+		return NULL;
+	}
+	return buf;
+}
+
+char *
+compression_column_segment_bloom_name(const char *attname)
+{
+	return compression_column_named_metadata_name(COMPRESSION_COLUMN_METADATA_BLOOM_COLUMN_NAME,
+												  attname);
+}
+
+char *
+compression_column_segment_sparse_min_name(const char *attname)
+{
+	return compression_column_named_metadata_name(COMPRESSION_COLUMN_METADATA_SPARSE_MIN_COLUMN_NAME,
+												  attname);
+}
+
+char *
+compression_column_segment_sparse_max_name(const char *attname)
+{
+	return compression_column_named_metadata_name(COMPRESSION_COLUMN_METADATA_SPARSE_MAX_COLUMN_NAME,
+												  attname);
+}
+
+/* All the optional metadata columns that are named after the column. */
+static char *(*const named_metadata_name_functions[])(const char *attname) = {
+	compression_column_segment_bloom_name,
+	compression_column_segment_sparse_min_name,
+	compression_column_segment_sparse_max_name,
+};
+
+/*
+ * Find the column that is listed in an option of the WITH clause, and check
+ * that it is not a segmentby column, because those are not compressed and
+ * don't need any metadata.
+ */
+static Form_pg_attribute
+compresscolinfo_get_metadata_column(CompressColInfo *cc, Relation uncompressed_rel,
+									const char *colname, const char *option_name)
+{
+	AttrNumber col_attno = get_attnum(uncompressed_rel->rd_id, colname);
+	if (col_attno == InvalidAttrNumber)
+		ereport(ERROR,
+				(errcode(ERRCODE_SYNTAX_ERROR),
+				 errmsg("column \"%s\" does not exist", colname),
+				 errhint("The timescaledb.%s option must reference a valid column.",
+						 option_name)));
+
+	for (int colno = 0; colno < cc->numcols; colno++)
+	{
+		if (namestrcmp(&cc->col_meta[colno].attname, colname) == 0 &&
+			cc->col_meta[colno].segmentby_column_index > 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_SYNTAX_ERROR),
+					 errmsg("cannot use segmentby column \"%s\" in the timescaledb.%s option",
+							colname,
+							option_name),
+					 errhint("The segmentby columns are not compressed and don't need "
+							 "metadata.")));
+	}
+
+	return TupleDescAttr(RelationGetDescr(uncompressed_rel), AttrNumberGetAttrOffset(col_attno));
+}
+
+static ColumnDef *
+make_named_metadata_column_def(char *metadata_col_name, const char *colname, Oid typid)
+{
+	if (metadata_col_name == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_NAME_TOO_LONG),
+				 errmsg("column name \"%s\" is too long for the compression metadata", colname)));
+
+	return makeColumnDef(metadata_col_name, typid, -1 /* typemod */, 0 /*collation*/);
+}
+
+static void
+compresscolinfo_add_bloom_columns(CompressColInfo *cc, Relation uncompressed_rel,
+								  List *bloom_cols)
+{
+	ListCell *lc;
+
+	foreach (lc, bloom_cols)
+	{
+		char *colname = lfirst(lc);
+		Form_pg_attribute attr = compresscolinfo_get_metadata_column(cc,
+																	 uncompressed_rel,
+																	 colname,
+																	 "compress_bloomfilter");
+		if (!segment_meta_bloom_type_supported(attr->atttypid))
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_FUNCTION),
+					 errmsg("invalid bloom filter column type %s", format_type_be(attr->atttypid)),
+					 errdetail("Could not identify an extended hash function for the type.")));
+
+		cc->coldeflist =
+			lappend(cc->coldeflist,
+					make_named_metadata_column_def(compression_column_segment_bloom_name(colname),
+												   colname,
+												   BYTEAOID));
+	}
+}
+
+/*
+ * Add the min/max metadata columns for the columns that are not orderby, so
+ * that the range conditions on them can be checked without decompression.
+ * The orderby columns already have them.
+ */
+static void
+compresscolinfo_add_sparse_minmax_columns(CompressColInfo *cc, Relation uncompressed_rel,
+										  List *minmax_cols)
+{
+	ListCell *lc;
+
+	foreach (lc, minmax_cols)
+	{
+		char *colname = lfirst(lc);
+		Form_pg_attribute attr =
+			compresscolinfo_get_metadata_column(cc, uncompressed_rel, colname, "compress_minmax");
+
+		bool is_orderby = false;
+		for (int colno = 0; colno < cc->numcols; colno++)
+		{
+			if (namestrcmp(&cc->col_meta[colno].attname, colname) == 0 &&
+				cc->col_meta[colno].orderby_column_index > 0)
+				is_orderby = true;
+		}
+		if (is_orderby)
+			continue;
+
+		TypeCacheEntry *type = lookup_type_cache(attr->atttypid, TYPECACHE_LT_OPR);
+		if (!OidIsValid(type->lt_opr))
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_FUNCTION),
+					 errmsg("invalid min/max column type %s", format_type_be(attr->atttypid)),
+					 errdetail("Could not identify a less-than operator for the type.")));
+
+		cc->coldeflist = lappend(cc->coldeflist,
+								 make_named_metadata_column_def(
+									 compression_column_segment_sparse_min_name(colname),
+									 colname,
+									 attr->atttypid));
+		cc->coldeflist = lappend(cc->coldeflist,
+								 make_named_metadata_column_def(
+									 compression_column_segment_sparse_max_name(colname),
+									 colname,
+									 attr->atttypid));
+	}
+}
+
 static void
 compresscolinfo_add_metadata_columns(CompressColInfo *cc, Relation uncompressed_rel)
 {
@@ -217,7 +390,7 @@ compresscolinfo_add_metadata_columns(CompressColInfo *cc, Relation uncompressed_
  */
 static void
 compresscolinfo_init(CompressColInfo *cc, Oid srctbl_relid, List *segmentby_cols,
-					 List *orderby_cols)
+					 List *orderby_cols, List *bloom_cols, List *minmax_cols)
 {
 	Relation rel;
 	TupleDesc tupdesc;
@@ -329,6 +502,8 @@ compresscolinfo_init(CompressColInfo *cc, Oid srctbl_relid, List *segmentby_cols
 	}
 	cc->numcols = colno;
 	compresscolinfo_add_metadata_columns(cc, rel);
+	compresscolinfo_add_bloom_columns(cc, rel, bloom_cols);
+	compresscolinfo_add_sparse_minmax_columns(cc, rel, minmax_cols);
 	pfree(segorder_colindex);
 	table_close(rel, AccessShareLock);
 }
@@ -354,10 +529,12 @@ compresscolinfo_init_singlecolumn(CompressColInfo *cc, const char *colname, Oid
 }
 
 /* modify storage attributes for toast table columns attached to the
- * compression table
+ * compression table. The columns that are compressed by toast use the given
+ * toast compression method, or the default one if it is NULL.
  */
 static void
-modify_compressed_toast_table_storage(CompressColInfo *cc, Oid compress_relid)
+modify_compressed_toast_table_storage(CompressColInfo *cc, Oid compress_relid,
+									  const char *toast_compression)
 {
 	int colno;
 	List *cmds = NIL;
@@ -376,6 +553,19 @@ modify_compressed_toast_table_storage(CompressColInfo *cc, Oid compress_relid)
 				Assert(stor == TOAST_STORAGE_EXTENDED);
 				cmd->def = (Node *) makeString("extended");
 				cmds = lappend(cmds, cmd);
+
+				if (toast_compression != NULL)
+				{
+#if PG14_GE
+					cmd = makeNode(AlterTableCmd);
+					cmd->subtype = AT_SetCompression;
+					cmd->name = pstrdup(NameStr(cc->col_meta[colno].attname));
+					cmd->def = (Node *) makeString(pstrdup(toast_compression));
+					cmds = lappend(cmds, cmd);
+#else
+					pg_unreachable();
+#endif
+				}
 			}
 		}
 	}
@@ -385,6 +575,80 @@ modify_compressed_toast_table_storage(CompressColInfo *cc, Oid compress_relid)
 	}
 }
 
+/*
+ * Get the toast compression method for the compressed columns from the
+ * timescaledb.compress_toast_compression option. NULL means the default one.
+ *
+ * The array and dictionary compressed columns hold the serialized datums that
+ * can be large, e.g. for text or jsonb, and are further compressed by toast.
+ * Using lz4 instead of the default pglz there makes the decompression much
+ * faster.
+ */
+static const char *
+parse_toast_compression(WithClauseResult *with_clause_options)
+{
+	if (with_clause_options[CompressToastCompression].is_default)
+		return NULL;
+
+#if PG14_LT
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("setting toast compression for compressed columns requires PostgreSQL 14 or "
+					"later")));
+#endif
+
+	return TextDatumGetCString(with_clause_options[CompressToastCompression].parsed);
+}
+
+/*
+ * Get the list of the column names from an option of the WITH clause, such as
+ * the columns that should have bloom filters.
+ */
+static List *
+parse_column_list_option(WithClauseResult *with_clause_options, CompressHypertableOption option)
+{
+	List *cols = NIL;
+
+	if (with_clause_options[option].is_default)
+		return NIL;
+
+	char *rawstring = TextDatumGetCString(with_clause_options[option].parsed);
+	if (!SplitIdentifierString(pstrdup(rawstring), ',', &cols))
+		ereport(ERROR,
+				(errcode(ERRCODE_SYNTAX_ERROR),
+				 errmsg("unable to parse column list \"%s\"", rawstring),
+				 errhint("The timescaledb.%s option must be a set of column names separated by "
+						 "commas.",
+						 with_clause_options[option].definition->arg_name)));
+
+	return cols;
+}
+
+/*
+ * Get the toast compression method used by the existing compressed columns of
+ * the compression table, NULL if they use the default one.
+ */
+static const char *
+get_compressed_toast_compression(Oid compress_relid)
+{
+	const char *toast_compression = NULL;
+#if PG14_GE
+	Relation rel = table_open(compress_relid, AccessShareLock);
+	TupleDesc desc = RelationGetDescr(rel);
+	for (int i = 0; i < desc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(desc, i);
+		if (!attr->attisdropped && CompressionMethodIsValid(attr->attcompression))
+		{
+			toast_compression = GetCompressionMethodName(attr->attcompression);
+			break;
+		}
+	}
+	table_close(rel, AccessShareLock);
+#endif
+	return toast_compression;
+}
+
 /* prevent concurrent transactions from inserting into
  * hypertable_compression for the same table, acquire the lock but don't free
  * here
@@ -571,7 +835,8 @@ set_toast_tuple_target_on_compressed(Oid compressed_table_id)
 }
 
 static int32
-create_compression_table(Oid owner, CompressColInfo *compress_cols, Oid tablespace_oid)
+create_compression_table(Oid owner, CompressColInfo *compress_cols, Oid tablespace_oid,
+						 const char *toast_compression)
 {
 	ObjectAddress tbladdress;
 	char relnamebuf[NAMEDATALEN];
@@ -613,7 +878,7 @@ create_compression_table(Oid owner, CompressColInfo *compress_cols, Oid tablespa
 	(void) heap_reloptions(RELKIND_TOASTVALUE, toast_options, true);
 	NewRelationCreateToastTable(compress_relid, toast_options);
 	ts_catalog_restore_user(&sec_ctx);
-	modify_compressed_toast_table_storage(compress_cols, compress_relid);
+	modify_compressed_toast_table_storage(compress_cols, compress_relid, toast_compression);
 	ts_hypertable_create_compressed(compress_relid, compress_hypertable_id);
 
 	set_statistics_on_compressed_table(compress_relid);
@@ -1054,7 +1319,10 @@ disable_compression(Hypertable *ht, WithClauseResult *with_clause_options)
 {
 	bool compression_already_enabled = TS_HYPERTABLE_HAS_COMPRESSION_ENABLED(ht);
 	if (!with_clause_options[CompressOrderBy].is_default ||
-		!with_clause_options[CompressSegmentBy].is_default)
+		!with_clause_options[CompressSegmentBy].is_default ||
+		!with_clause_options[CompressToastCompression].is_default ||
+		!with_clause_options[CompressBloomFilter].is_default ||
+		!with_clause_options[CompressMinMax].is_default)
 		ereport(ERROR,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("invalid compression configuration"),
@@ -1096,7 +1364,11 @@ add_column_to_compression_table(Hypertable *compress_ht, CompressColInfo *compre
 
 	/* alter the table and add column */
 	ts_alter_table_with_event_trigger(compress_relid, NULL, list_make1(addcol_cmd), true);
-	modify_compressed_toast_table_storage(compress_cols, compress_relid);
+
+	/* The new column uses the same toast compression as the existing ones. */
+	modify_compressed_toast_table_storage(compress_cols,
+										  compress_relid,
+										  get_compressed_toast_compression(compress_relid));
 }
 
 /* Drop column from internal compression table */
@@ -1193,11 +1465,19 @@ tsl_process_compress_table(AlterTableCmd *cmd, Hypertable *ht,
 	segmentby_cols = ts_compress_hypertable_parse_segment_by(with_clause_options, ht);
 	orderby_cols = ts_compress_hypertable_parse_order_by(with_clause_options, ht);
 	orderby_cols = add_time_to_order_by_if_not_included(orderby_cols, segmentby_cols, ht);
+	const char *toast_compression = parse_toast_compression(with_clause_options);
+	List *bloom_cols = parse_column_list_option(with_clause_options, CompressBloomFilter);
+	List *minmax_cols = parse_column_list_option(with_clause_options, CompressMinMax);
 
 	if (TS_HYPERTABLE_HAS_COMPRESSION_ENABLED(ht))
 		check_modify_compression_options(ht, with_clause_options, orderby_cols);
 
-	compresscolinfo_init(&compress_cols, ht->main_table_relid, segmentby_cols, orderby_cols);
+	compresscolinfo_init(&compress_cols,
+						 ht->main_table_relid,
+						 segmentby_cols,
+						 orderby_cols,
+						 bloom_cols,
+						 minmax_cols);
 
 	/* Check if we can create a compressed hypertable with existing
 	 * constraints and indexes. */
@@ -1231,7 +1511,8 @@ tsl_process_compress_table(AlterTableCmd *cmd, Hypertable *ht,
 	else
 	{
 		Oid tablespace_oid = get_rel_tablespace(ht->main_table_relid);
-		compress_htid = create_compression_table(ownerid, &compress_cols, tablespace_oid);
+		compress_htid =
+			create_compression_table(ownerid, &compress_cols, tablespace_oid, toast_compression);
 		ts_hypertable_set_compressed(ht, compress_htid);
 	}
 
@@ -1315,11 +1596,117 @@ tsl_process_compress_table_drop_column(Hypertable *ht, char *name)
 	{
 		Hypertable *compress_ht = ts_hypertable_get_by_id(ht->fd.compressed_hypertable_id);
 		drop_column_from_compression_table(compress_ht, name);
+
+		/* Drop the optional metadata of the column as well, if it has any. */
+		for (int i = 0; i < (int) lengthof(named_metadata_name_functions); i++)
+		{
+			char *metadata_col_name = named_metadata_name_functions[i](name);
+			if (metadata_col_name != NULL &&
+				get_attnum(compress_ht->main_table_relid, metadata_col_name) != InvalidAttrNumber)
+				drop_column_from_compression_table(compress_ht, metadata_col_name);
+		}
 	}
 
 	ts_hypertable_compression_delete_by_pkey(ht->fd.id, name);
 }
 
+/*
+ * Add an index on the segmentby columns of a new hypertable index to the
+ * compressed hypertable.
+ *
+ * Compressed chunks only get the default index on the segmentby columns, so a
+ * lookup on a segmentby column that is not a prefix of the segmentby order has
+ * to scan all the compressed batches. When the keys of a plain btree index are
+ * all segmentby columns, we add the matching index (followed by the sequence
+ * number) to the compressed hypertable. The index is not built on the
+ * existing compressed chunks, which would make CREATE INDEX rewrite the indexes
+ * of all the compressed data; instead the chunks get it when they are
+ * compressed the next time, since the compressed chunk indexes are created from
+ * the indexes of the compressed hypertable.
+ *
+ * The index depends on the hypertable index, so dropping the hypertable index
+ * drops it as well.
+ */
+void
+tsl_process_compress_table_create_index(Hypertable *ht, const IndexStmt *stmt,
+										Oid hypertable_indexrelid)
+{
+	List *indexcols = NIL;
+	bool is_segmentby_prefix = true;
+	int16 position = 0;
+	ListCell *lc;
+
+	Assert(TS_HYPERTABLE_HAS_COMPRESSION_TABLE(ht));
+
+	if (stmt->unique || stmt->primary || stmt->isconstraint || stmt->whereClause != NULL ||
+		stmt->indexIncludingParams != NIL || stmt->excludeOpNames != NIL)
+		return;
+
+	if (stmt->accessMethod != NULL && strcmp(stmt->accessMethod, DEFAULT_INDEX_TYPE) != 0)
+		return;
+
+	foreach (lc, stmt->indexParams)
+	{
+		IndexElem *elem = lfirst_node(IndexElem, lc);
+		FormData_hypertable_compression *col;
+
+		/* Only simple column references with the default operator class */
+		if (elem->name == NULL || elem->collation != NIL || elem->opclass != NIL)
+			return;
+
+		col = ts_hypertable_compression_get_by_pkey(ht->fd.id, elem->name);
+		if (col == NULL || col->segmentby_column_index <= 0)
+			return;
+
+		if (col->segmentby_column_index != ++position)
+			is_segmentby_prefix = false;
+
+		indexcols = lappend(indexcols, copyObject(elem));
+	}
+
+	/* The default index on the segmentby columns already covers it */
+	if (indexcols == NIL || is_segmentby_prefix)
+		return;
+
+	Hypertable *compress_ht = ts_hypertable_get_by_id(ht->fd.compressed_hypertable_id);
+	IndexStmt compress_stmt = {
+		.type = T_IndexStmt,
+		.accessMethod = DEFAULT_INDEX_TYPE,
+		.idxname = NULL,
+		.relation = makeRangeVar(NameStr(compress_ht->fd.schema_name),
+								 NameStr(compress_ht->fd.table_name),
+								 0),
+		.tableSpace = get_tablespace_name(get_rel_tablespace(compress_ht->main_table_relid)),
+	};
+	IndexElem *sequence_num_elem = makeNode(IndexElem);
+	ObjectAddress index_addr;
+	ObjectAddress hypertable_index_addr;
+
+	sequence_num_elem->name = COMPRESSION_COLUMN_METADATA_SEQUENCE_NUM_NAME;
+	compress_stmt.indexParams = lappend(indexcols, sequence_num_elem);
+
+	index_addr = DefineIndexCompat(compress_ht->main_table_relid,
+								   &compress_stmt,
+								   InvalidOid, /* IndexRelationId */
+								   InvalidOid, /* parentIndexId */
+								   InvalidOid, /* parentConstraintId */
+								   -1,		   /* total_parts */
+								   false,	   /* is_alter_table */
+								   false,	   /* check_rights */
+								   false,	   /* check_not_in_use */
+								   false,	   /* skip_build */
+								   false);	   /* quiet */
+
+	ObjectAddressSet(hypertable_index_addr, RelationRelationId, hypertable_indexrelid);
+	recordDependencyOn(&index_addr, &hypertable_index_addr, DEPENDENCY_AUTO);
+
+	elog(DEBUG1,
+		 "adding index %s ON %s.%s",
+		 get_rel_name(index_addr.objectId),
+		 NameStr(compress_ht->fd.schema_name),
+		 NameStr(compress_ht->fd.table_name));
+}
+
 /* Rename a column on a hypertable that has compression enabled.
  *
  * This function renames the existing column in the internal compression table.
@@ -1343,6 +1730,27 @@ tsl_process_compress_table_rename_column(Hypertable *ht, const RenameStmt *stmt)
 												   NameStr(compress_ht->fd.table_name),
 												   -1);
 		ExecRenameStmt(compress_col_stmt);
+
+		/* Rename the optional metadata of the column as well, if it has any. */
+		for (int i = 0; i < (int) lengthof(named_metadata_name_functions); i++)
+		{
+			char *metadata_col_name = named_metadata_name_functions[i](stmt->subname);
+			if (metadata_col_name == NULL ||
+				get_attnum(compress_ht->main_table_relid, metadata_col_name) == InvalidAttrNumber)
+				continue;
+
+			char *new_metadata_col_name = named_metadata_name_functions[i](stmt->newname);
+			if (new_metadata_col_name == NULL)
+				ereport(ERROR,
+						(errcode(ERRCODE_NAME_TOO_LONG),
+						 errmsg("column name \"%s\" is too long for the compression metadata",
+								stmt->newname)));
+
+			RenameStmt *metadata_col_stmt = (RenameStmt *) copyObject(compress_col_stmt);
+			metadata_col_stmt->subname = metadata_col_name;
+			metadata_col_stmt->newname = new_metadata_col_name;
+			ExecRenameStmt(metadata_col_stmt);
+		}
 	}
 	// update catalog entries for the renamed column for the hypertable
 	ts_hypertable_compression_rename_column(orig_htid, stmt->subname, stmt->newname);
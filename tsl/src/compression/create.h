@@ -17,11 +17,16 @@
 	COMPRESSION_COLUMN_METADATA_PREFIX "sequence_num"
 #define COMPRESSION_COLUMN_METADATA_MIN_COLUMN_NAME "min"
 #define COMPRESSION_COLUMN_METADATA_MAX_COLUMN_NAME "max"
+#define COMPRESSION_COLUMN_METADATA_BLOOM_COLUMN_NAME "bloom"
+#define COMPRESSION_COLUMN_METADATA_SPARSE_MIN_COLUMN_NAME "sparse_min"
+#define COMPRESSION_COLUMN_METADATA_SPARSE_MAX_COLUMN_NAME "sparse_max"
 
 bool tsl_process_compress_table(AlterTableCmd *cmd, Hypertable *ht,
 								WithClauseResult *with_clause_options);
 void tsl_process_compress_table_add_column(Hypertable *ht, ColumnDef *orig_def);
 void tsl_process_compress_table_drop_column(Hypertable *ht, char *name);
+void tsl_process_compress_table_create_index(Hypertable *ht, const IndexStmt *stmt,
+											 Oid hypertable_indexrelid);
 void tsl_process_compress_table_rename_column(Hypertable *ht, const RenameStmt *stmt);
 Chunk *create_compress_chunk(Hypertable *compress_ht, Chunk *src_chunk, Oid table_id);
 
@@ -30,5 +35,8 @@ char *compression_column_segment_max_name(const FormData_hypertable_compression
 
 char *column_segment_min_name(int16 column_index);
 char *column_segment_max_name(int16 column_index);
+char *compression_column_segment_bloom_name(const char *attname);
+char *compression_column_segment_sparse_min_name(const char *attname);
+char *compression_column_segment_sparse_max_name(const char *attname);
 
 #endif /* TIMESCALEDB_TSL_COMPRESSION_CREATE_H */
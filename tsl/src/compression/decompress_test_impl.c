@@ -42,8 +42,9 @@ FUNCTION_NAME(ALGO, CTYPE)(const uint8 *Data, size_t Size, bool extra_checks)
 		 * For routine fuzzing, we only run bulk decompression to make it faster
 		 * and the coverage space smaller.
 		 */
-		DecompressAllFunction decompress_all = tsl_get_decompress_all_function(algo);
-		decompress_all(compressed_data, PGTYPE, CurrentMemoryContext);
+		DecompressAllFunction decompress_all = tsl_get_decompress_all_function(algo, PGTYPE);
+		DecompressionArena arena = { .mctx = CurrentMemoryContext };
+		decompress_all(compressed_data, PGTYPE, &arena);
 		return 0;
 	}
 
@@ -53,17 +54,18 @@ FUNCTION_NAME(ALGO, CTYPE)(const uint8 *Data, size_t Size, bool extra_checks)
 	 * the row-by-row is old and stable.
 	 */
 	ArrowArray *arrow = NULL;
-	DecompressAllFunction decompress_all = tsl_get_decompress_all_function(algo);
+	DecompressAllFunction decompress_all = tsl_get_decompress_all_function(algo, PGTYPE);
 	if (decompress_all)
 	{
-		arrow = decompress_all(compressed_data, PGTYPE, CurrentMemoryContext);
+		DecompressionArena arena = { .mctx = CurrentMemoryContext };
+		arrow = decompress_all(compressed_data, PGTYPE, &arena);
 	}
 
 	/*
 	 * Test row-by-row decompression.
 	 */
 	DecompressionIterator *iter = definitions[algo].iterator_init_forward(compressed_data, PGTYPE);
-	DecompressResult results[GLOBAL_MAX_ROWS_PER_COMPRESSION];
+	DecompressResult *results = palloc(sizeof(*results) * GLOBAL_MAX_ROWS_PER_COMPRESSION);
 	int n = 0;
 	for (DecompressResult r = iter->try_next(iter); !r.is_done; r = iter->try_next(iter))
 	{
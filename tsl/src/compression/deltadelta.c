@@ -588,19 +588,19 @@ delta_delta_decompression_iterator_try_next_forward(DecompressionIterator *iter)
 #undef ELEMENT_TYPE
 
 ArrowArray *
-delta_delta_decompress_all(Datum compressed_data, Oid element_type, MemoryContext dest_mctx)
+delta_delta_decompress_all(Datum compressed_data, Oid element_type, DecompressionArena *dest)
 {
 	switch (element_type)
 	{
 		case INT8OID:
 		case TIMESTAMPOID:
 		case TIMESTAMPTZOID:
-			return delta_delta_decompress_all_uint64(compressed_data, dest_mctx);
+			return delta_delta_decompress_all_uint64(compressed_data, dest);
 		case INT4OID:
 		case DATEOID:
-			return delta_delta_decompress_all_uint32(compressed_data, dest_mctx);
+			return delta_delta_decompress_all_uint32(compressed_data, dest);
 		case INT2OID:
-			return delta_delta_decompress_all_uint16(compressed_data, dest_mctx);
+			return delta_delta_decompress_all_uint16(compressed_data, dest);
 		default:
 			elog(ERROR,
 				 "type '%s' is not supported for deltadelta decompression",
@@ -682,6 +682,95 @@ delta_delta_decompression_iterator_from_datum_reverse(Datum deltadelta_compresse
 	return &iterator->base;
 }
 
+/*
+ * Detoast only the part of the compressed datum that is required to decompress
+ * its first num_rows rows, and return it as a shorter valid compressed datum.
+ * Every Simple8b block holds at least one value, and the selectors go before
+ * the blocks, so we need at most num_rows blocks. The nulls go after the deltas,
+ * so we have to detoast the entire datum if there are any. The result can only
+ * be decompressed in the forward direction, because the last value and delta
+ * in its header are those of the full datum.
+ */
+Datum
+delta_delta_detoast_prefix(Datum compressed, int num_rows)
+{
+	Assert(num_rows > 0);
+
+	const int header_bytes = sizeof(DeltaDeltaCompressed) + sizeof(Simple8bRleSerialized);
+	DeltaDeltaCompressed *header =
+		(DeltaDeltaCompressed *) PG_DETOAST_DATUM_SLICE(compressed, 0, header_bytes - VARHDRSZ);
+	CheckCompressedData(VARSIZE(header) == (Size) header_bytes);
+
+	const Simple8bRleSerialized *deltas = (Simple8bRleSerialized *) header->delta_deltas;
+	const uint32 total_blocks = deltas->num_blocks;
+	if (header->has_nulls != 0 || total_blocks <= (uint32) num_rows)
+	{
+		pfree(header);
+		return PointerGetDatum(PG_DETOAST_DATUM(compressed));
+	}
+	pfree(header);
+
+	const uint32 total_selector_slots = simple8brle_num_selector_slots_for_num_blocks(total_blocks);
+	const int prefix_bytes = header_bytes + (total_selector_slots + num_rows) * sizeof(uint64);
+	header =
+		(DeltaDeltaCompressed *) PG_DETOAST_DATUM_SLICE(compressed, 0, prefix_bytes - VARHDRSZ);
+	CheckCompressedData(VARSIZE(header) == (Size) prefix_bytes);
+
+	deltas = (Simple8bRleSerialized *) header->delta_deltas;
+	const uint64 *selector_slots = deltas->slots;
+	const uint64 *blocks = deltas->slots + total_selector_slots;
+
+	/* Find out how many blocks we need for the requested rows. */
+	uint32 num_blocks = 0;
+	uint32 num_elements = 0;
+	while (num_elements < (uint32) num_rows && num_blocks < (uint32) num_rows)
+	{
+		const uint8 selector =
+			(selector_slots[num_blocks / SIMPLE8B_SELECTORS_PER_SELECTOR_SLOT] >>
+			 ((num_blocks % SIMPLE8B_SELECTORS_PER_SELECTOR_SLOT) * SIMPLE8B_BITS_PER_SELECTOR)) &
+			0xF;
+		CheckCompressedData(selector != 0);
+
+		if (simple8brle_selector_is_rle(selector))
+		{
+			num_elements += simple8brle_rledata_repeatcount(blocks[num_blocks]);
+		}
+		else
+		{
+			num_elements += SIMPLE8B_NUM_ELEMENTS[selector];
+		}
+
+		num_blocks++;
+	}
+	CheckCompressedData(num_elements >= num_blocks);
+	num_elements = Min(num_elements, deltas->num_elements);
+
+	/* Build the shorter datum from the selectors and blocks we need. */
+	const uint32 num_selector_slots = simple8brle_num_selector_slots_for_num_blocks(num_blocks);
+	const Size result_bytes = header_bytes + (num_selector_slots + num_blocks) * sizeof(uint64);
+	DeltaDeltaCompressed *result = palloc(result_bytes);
+	memcpy(result, header, sizeof(DeltaDeltaCompressed));
+	SET_VARSIZE(result, result_bytes);
+
+	Simple8bRleSerialized *result_deltas = (Simple8bRleSerialized *) result->delta_deltas;
+	result_deltas->num_elements = num_elements;
+	result_deltas->num_blocks = num_blocks;
+	memcpy(result_deltas->slots, selector_slots, num_selector_slots * sizeof(uint64));
+	memcpy(result_deltas->slots + num_selector_slots, blocks, num_blocks * sizeof(uint64));
+
+	/* Zero out the selectors of the blocks we didn't copy. */
+	const uint32 selectors_in_last_slot = num_blocks % SIMPLE8B_SELECTORS_PER_SELECTOR_SLOT;
+	if (selectors_in_last_slot != 0)
+	{
+		result_deltas->slots[num_selector_slots - 1] &=
+			(1ULL << (selectors_in_last_slot * SIMPLE8B_BITS_PER_SELECTOR)) - 1;
+	}
+
+	pfree(header);
+
+	return PointerGetDatum(result);
+}
+
 /**********************************************************************************/
 /**********************************************************************************/
 void
@@ -44,11 +44,13 @@ extern DecompressResult
 delta_delta_decompression_iterator_try_next_forward(DecompressionIterator *iter);
 
 extern ArrowArray *delta_delta_decompress_all(Datum compressed_data, Oid element_type,
-											  MemoryContext dest_mctx);
+											  DecompressionArena *dest);
 
 extern DecompressResult
 delta_delta_decompression_iterator_try_next_reverse(DecompressionIterator *iter);
 
+extern Datum delta_delta_detoast_prefix(Datum compressed, int num_rows);
+
 extern void deltadelta_compressed_send(CompressedDataHeader *header, StringInfo buffer);
 extern Datum deltadelta_compressed_recv(StringInfo buf);
 
@@ -60,6 +62,7 @@ extern Datum tsl_deltadelta_compressor_finish(PG_FUNCTION_ARGS);
 		.iterator_init_forward = delta_delta_decompression_iterator_from_datum_forward,            \
 		.iterator_init_reverse = delta_delta_decompression_iterator_from_datum_reverse,            \
 		.decompress_all = delta_delta_decompress_all,                                              \
+		.detoast_prefix = delta_delta_detoast_prefix,                                              \
 		.compressed_data_send = deltadelta_compressed_send,                                        \
 		.compressed_data_recv = deltadelta_compressed_recv,                                        \
 		.compressor_for_type = delta_delta_compressor_for_type,                                    \
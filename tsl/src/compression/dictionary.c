@@ -19,9 +19,11 @@
 #include <utils/syscache.h>
 #include <utils/typcache.h>
 
+#include "compression/arrow_c_data_interface.h"
 #include "compression/compression.h"
 #include "compression/dictionary.h"
 #include "compression/simple8b_rle.h"
+#include "compression/simple8b_rle_bitmap.h"
 #include "compression/array.h"
 #include "compression/dictionary_hash.h"
 #include "compression/datum_serialize.h"
@@ -75,7 +77,7 @@ struct DictionaryDecompressionIterator
 
 typedef struct DictionaryCompressor
 {
-	dictionary_hash *dictionary_items;
+	DictionaryHash *dictionary_items;
 	uint32 next_index;
 	Oid type;
 	int16 typlen;
@@ -176,7 +178,7 @@ dictionary_compressor_append(DictionaryCompressor *compressor, Datum val)
 
 	Assert(compressor != NULL);
 
-	dict_item = dictionary_insert(compressor->dictionary_items, val, &found);
+	dict_item = dictionary_hash_insert(compressor->dictionary_items, val, &found);
 
 	if (!found)
 	{
@@ -210,7 +212,6 @@ compressor_get_serialization_info(DictionaryCompressor *compressor)
 	Simple8bRleSerialized *dict_indexes =
 		simple8brle_compressor_finish(&compressor->dictionary_indexes);
 	Simple8bRleSerialized *nulls = simple8brle_compressor_finish(&compressor->nulls);
-	dictionary_iterator dictionary_item_iterator;
 
 	ArrayCompressor *array_comp = array_compressor_alloc(compressor->type);
 
@@ -230,16 +231,8 @@ compressor_get_serialization_info(DictionaryCompressor *compressor)
 		sizes.nulls_size = simple8brle_serialized_total_size(nulls);
 	sizes.total_size += sizes.nulls_size;
 
-	dictionary_start_iterate(compressor->dictionary_items, &dictionary_item_iterator);
-	sizes.num_distinct = 0;
-	for (DictionaryHashItem *dict_item =
-			 dictionary_iterate(compressor->dictionary_items, &dictionary_item_iterator);
-		 dict_item != NULL;
-		 dict_item = dictionary_iterate(compressor->dictionary_items, &dictionary_item_iterator))
-	{
-		sizes.value_array[dict_item->index] = dict_item->key;
-		sizes.num_distinct += 1;
-	}
+	sizes.num_distinct =
+		dictionary_hash_get_keys(compressor->dictionary_items, sizes.value_array);
 	for (uint32 i = 0; i < sizes.num_distinct; i++)
 	{
 		array_compressor_append(array_comp, sizes.value_array[i]);
@@ -419,6 +412,188 @@ tsl_dictionary_decompression_iterator_from_datum_reverse(Datum dictionary_compre
 	return &iterator->base;
 }
 
+#define ELEMENT_TYPE int16
+#include "simple8b_rle_decompress_all.h"
+#undef ELEMENT_TYPE
+
+/*
+ * Decompress the entire batch of dictionary-compressed rows into an Arrow
+ * dictionary-encoded array. The indices are stored as int16 in the values
+ * buffer of the array, and the distinct values are stored as an Arrow binary
+ * array (validity, int32 offsets, value bodies w/o the varlena headers) in the
+ * dictionary of the array. Only the varlena types are supported, because this
+ * is where the dictionary compression is used by default.
+ */
+ArrowArray *
+dictionary_decompress_all(Datum compressed, Oid element_type, DecompressionArena *dest)
+{
+	Assert(array_decompress_all_supports_type(element_type));
+	const int16 typlen = get_typlen(element_type);
+
+	/*
+	 * For the fixed-width types, we return the plain array of values, so the
+	 * indices and the dictionary are only temporary.
+	 */
+	DecompressionArena scratch = { .mctx = CurrentMemoryContext };
+	DecompressionArena *indices_dest = typlen > 0 ? &scratch : dest;
+
+	compressed = PointerGetDatum(PG_DETOAST_DATUM(compressed));
+
+	StringInfoData si = { .data = DatumGetPointer(compressed), .len = VARSIZE(compressed) };
+
+	const DictionaryCompressed *header = consumeCompressedData(&si, sizeof(DictionaryCompressed));
+
+	Assert(header->compression_algorithm == COMPRESSION_ALGORITHM_DICTIONARY);
+	CheckCompressedData(header->element_type == element_type);
+	CheckCompressedData(header->has_nulls == 0 || header->has_nulls == 1);
+	const bool has_nulls = header->has_nulls == 1;
+	const uint32 num_distinct = header->num_distinct;
+	CheckCompressedData(num_distinct > 0 && num_distinct <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+
+	Simple8bRleSerialized *indices_serialized = bytes_deserialize_simple8b_and_advance(&si);
+	const uint16 n_notnull = indices_serialized->num_elements;
+	CheckCompressedData(n_notnull <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+
+	Simple8bRleBitmap nulls = { 0 };
+	if (has_nulls)
+	{
+		Simple8bRleSerialized *nulls_serialized = bytes_deserialize_simple8b_and_advance(&si);
+		nulls = simple8brle_bitmap_decompress(nulls_serialized);
+	}
+
+	const uint16 n_total = has_nulls ? nulls.num_elements : n_notnull;
+	CheckCompressedData(n_total >= n_notnull);
+
+	/*
+	 * We need a significant padding of 64 elements, not bytes, here, because we
+	 * work in Simple8B blocks which can contain up to 64 elements.
+	 */
+	const uint16 n_padded = ((n_total + 63) / 64 + 1) * 64;
+	int16 *restrict indices = decompression_arena_alloc(indices_dest, sizeof(int16) * n_padded);
+
+	const uint16 n_decompressed =
+		simple8brle_decompress_all_buf_int16(indices_serialized, indices, n_padded);
+	Assert(n_decompressed == n_notnull);
+
+	/*
+	 * Check the indices against the dictionary size right away, so that the
+	 * consumers don't have to.
+	 */
+	bool indices_valid = true;
+	for (uint16 i = 0; i < n_notnull; i++)
+	{
+		indices_valid &= ((uint32) indices[i]) < num_distinct;
+	}
+	CheckCompressedData(indices_valid);
+
+	const int validity_bitmap_bytes = sizeof(uint64) * ((n_total + 64 - 1) / 64);
+	uint64 *restrict validity_bitmap = decompression_arena_alloc(dest, validity_bitmap_bytes);
+
+	/* All data valid by default, we will fill in the nulls later. */
+	memset(validity_bitmap, 0xFF, validity_bitmap_bytes);
+
+	/* The tail bits are not valid. */
+	if (n_total % 64)
+	{
+		const uint64 tail_mask = -1ULL >> (64 - n_total % 64);
+		validity_bitmap[n_total / 64] &= tail_mask;
+	}
+
+	/* Now move the indices to account for nulls, and fill the validity bitmap. */
+	if (has_nulls)
+	{
+		/*
+		 * The number of not-null elements we have must be consistent with the
+		 * nulls bitmap.
+		 */
+		CheckCompressedData(n_notnull + simple8brle_bitmap_num_ones(&nulls) == n_total);
+
+		int current_notnull_element = n_notnull - 1;
+		for (int i = n_total - 1; i >= 0; i--)
+		{
+			Assert(i >= current_notnull_element);
+
+			if (simple8brle_bitmap_get_at(&nulls, i))
+			{
+				arrow_set_row_validity(validity_bitmap, i, false);
+				indices[i] = 0;
+			}
+			else
+			{
+				Assert(current_notnull_element >= 0);
+				indices[i] = indices[current_notnull_element];
+				current_notnull_element--;
+			}
+		}
+
+		Assert(current_notnull_element == -1);
+	}
+
+	/*
+	 * Now read the dictionary items. They are stored as an embedded array
+	 * without nulls.
+	 */
+	ArrowArray *dictionary =
+		array_decompress_all_serialized_no_header(&si,
+												  header->element_type,
+												  /* has_nulls */ false,
+												  indices_dest);
+	CheckCompressedData(dictionary->length == num_distinct);
+
+	/* Return the result. */
+	ArrowArray *result =
+		decompression_arena_alloc_zero(dest, sizeof(ArrowArray) + sizeof(void *) * 2);
+	const void **buffers = (const void **) &result[1];
+	buffers[0] = validity_bitmap;
+	result->n_buffers = 2;
+	result->buffers = buffers;
+	result->length = n_total;
+	result->null_count = n_total - n_notnull;
+
+	if (typlen > 0)
+	{
+		/*
+		 * The fixed-width columns usually get the dictionary compression when
+		 * it's smaller than their default algorithm. The consumers expect the
+		 * plain array of values for them, so decode the dictionary right away.
+		 * The null rows have the index zero which is valid. We need additional
+		 * padding at the end of buffer, because the code that converts the
+		 * elements to postres Datum always reads in 8 bytes.
+		 */
+		void *values = decompression_arena_alloc(dest, typlen * n_padded + 8);
+		buffers[1] = values;
+		switch (typlen)
+		{
+#define DECODE_DICTIONARY(TYPE)                                                                    \
+	{                                                                                              \
+		const TYPE *restrict items = (const TYPE *) dictionary->buffers[1];                        \
+		TYPE *restrict typed_values = (TYPE *) values;                                             \
+		for (uint16 i = 0; i < n_total; i++)                                                       \
+		{                                                                                          \
+			typed_values[i] = items[indices[i]];                                                   \
+		}                                                                                          \
+		break;                                                                                     \
+	}
+			case 8:
+				DECODE_DICTIONARY(uint64);
+			case 4:
+				DECODE_DICTIONARY(uint32);
+			case 2:
+				DECODE_DICTIONARY(uint16);
+			case 1:
+				DECODE_DICTIONARY(uint8);
+#undef DECODE_DICTIONARY
+			default:
+				CheckCompressedData(false);
+		}
+		return result;
+	}
+
+	buffers[1] = indices;
+	result->dictionary = dictionary;
+	return result;
+}
+
 DecompressResult
 dictionary_decompression_iterator_try_next_forward(DecompressionIterator *iter_base)
 {
@@ -41,6 +41,9 @@ tsl_dictionary_decompression_iterator_from_datum_reverse(Datum dictionary_compre
 extern DecompressResult
 dictionary_decompression_iterator_try_next_reverse(DecompressionIterator *iter);
 
+extern ArrowArray *dictionary_decompress_all(Datum compressed, Oid element_type,
+											 DecompressionArena *dest);
+
 extern void dictionary_compressed_send(CompressedDataHeader *header, StringInfo buffer);
 extern Datum dictionary_compressed_recv(StringInfo buf);
 
@@ -51,6 +54,7 @@ extern Datum tsl_dictionary_compressor_finish(PG_FUNCTION_ARGS);
 	{                                                                                              \
 		.iterator_init_forward = tsl_dictionary_decompression_iterator_from_datum_forward,         \
 		.iterator_init_reverse = tsl_dictionary_decompression_iterator_from_datum_reverse,         \
+		.decompress_all = dictionary_decompress_all,                                               \
 		.compressed_data_send = dictionary_compressed_send,                                        \
 		.compressed_data_recv = dictionary_compressed_recv,                                        \
 		.compressor_for_type = dictionary_compressor_for_type,                                     \
@@ -14,7 +14,11 @@
 #define TIMESCALEDB_TSL_COMPRESSION_DICTIONARY_HASH_H
 
 #include <postgres.h>
+#include <catalog/pg_type.h>
+#include <common/hashfn.h>
+#include <fmgr.h>
 #include <funcapi.h>
+#include <utils/lsyscache.h>
 #include <utils/typcache.h>
 
 #include "compat/compat.h"
@@ -48,6 +52,98 @@ static bool datum_eq(dictionary_hash *tb, Datum a, Datum b);
 #define SH_DECLARE
 #include "lib/simplehash.h"
 
+/*
+ * Hash tables for types where we don't have to go through the type's hash and
+ * equality functions. The generic table above calls them through fmgr for
+ * every value appended, which is a large share of the compression time for
+ * common types.
+ *
+ * The byval table is for by-value types where equal values have equal
+ * datums, e.g., integers and timestamps.
+ */
+static pg_attribute_always_inline uint32
+datum_byval_hash(Datum key)
+{
+	uint64 k = (uint64) key;
+
+	return murmurhash32((uint32) (k ^ (k >> 32)));
+}
+
+#define SH_PREFIX dictionary_byval
+#define SH_ELEMENT_TYPE DictionaryHashItem
+#define SH_KEY_TYPE Datum
+#define SH_KEY key
+#define SH_HASH_KEY(tb, key) datum_byval_hash(key)
+#define SH_EQUAL(tb, a, b) ((a) == (b))
+#define SH_SCOPE static inline
+#define SH_DEFINE
+#define SH_DECLARE
+#include "lib/simplehash.h"
+
+/*
+ * The varlena table is for types where equal values have equal bytes, e.g.,
+ * bytea and text with a deterministic collation. The values might be
+ * compressed or have a short header, so they are compared on their
+ * detoasted bytes.
+ */
+static pg_attribute_always_inline uint32
+datum_varlena_hash(Datum key)
+{
+	struct varlena *value = PG_DETOAST_DATUM_PACKED(key);
+	uint32 hash = hash_bytes((const unsigned char *) VARDATA_ANY(value), VARSIZE_ANY_EXHDR(value));
+
+	if ((Pointer) value != DatumGetPointer(key))
+		pfree(value);
+
+	return hash;
+}
+
+static pg_attribute_always_inline bool
+datum_varlena_eq(Datum a, Datum b)
+{
+	struct varlena *value_a = PG_DETOAST_DATUM_PACKED(a);
+	struct varlena *value_b = PG_DETOAST_DATUM_PACKED(b);
+	Size len = VARSIZE_ANY_EXHDR(value_a);
+	bool result = len == VARSIZE_ANY_EXHDR(value_b) &&
+				  memcmp(VARDATA_ANY(value_a), VARDATA_ANY(value_b), len) == 0;
+
+	if ((Pointer) value_a != DatumGetPointer(a))
+		pfree(value_a);
+	if ((Pointer) value_b != DatumGetPointer(b))
+		pfree(value_b);
+
+	return result;
+}
+
+#define SH_PREFIX dictionary_varlena
+#define SH_ELEMENT_TYPE DictionaryHashItem
+#define SH_KEY_TYPE Datum
+#define SH_KEY key
+#define SH_HASH_KEY(tb, key) datum_varlena_hash(key)
+#define SH_EQUAL(tb, a, b) datum_varlena_eq(a, b)
+#define SH_SCOPE static inline
+#define SH_DEFINE
+#define SH_DECLARE
+#include "lib/simplehash.h"
+
+typedef enum DictionaryHashKind
+{
+	DICTIONARY_HASH_GENERIC,
+	DICTIONARY_HASH_BYVAL,
+	DICTIONARY_HASH_VARLENA,
+} DictionaryHashKind;
+
+typedef struct DictionaryHash
+{
+	DictionaryHashKind kind;
+	union
+	{
+		dictionary_hash *generic;
+		dictionary_byval_hash *byval;
+		dictionary_varlena_hash *varlena;
+	} table;
+} DictionaryHash;
+
 static uint32
 datum_hash(dictionary_hash *tb, Datum key)
 {
@@ -81,10 +177,43 @@ datum_eq(dictionary_hash *tb, Datum a, Datum b)
 	return DatumGetBool(value);
 }
 
-static dictionary_hash *
+static DictionaryHashKind
+dictionary_hash_kind(TypeCacheEntry *tentry)
+{
+	switch (tentry->type_id)
+	{
+		case BOOLOID:
+		case CHAROID:
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+		case OIDOID:
+		case DATEOID:
+		case TIMEOID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			/* INT8 and the timestamps are by-reference without USE_FLOAT8_BYVAL */
+			return tentry->typbyval ? DICTIONARY_HASH_BYVAL : DICTIONARY_HASH_GENERIC;
+		case BYTEAOID:
+			return DICTIONARY_HASH_VARLENA;
+		case TEXTOID:
+		case VARCHAROID:
+			/* Values that are equal in a nondeterministic collation can have
+			 * different bytes */
+			if (OidIsValid(tentry->typcollation) &&
+				get_collation_isdeterministic(tentry->typcollation))
+				return DICTIONARY_HASH_VARLENA;
+			return DICTIONARY_HASH_GENERIC;
+		default:
+			return DICTIONARY_HASH_GENERIC;
+	}
+}
+
+static DictionaryHash *
 dictionary_hash_alloc(TypeCacheEntry *tentry)
 {
-	HashMeta *meta = palloc(sizeof(*meta));
+	DictionaryHash *hash = palloc(sizeof(*hash));
+	HashMeta *meta;
 	Oid collation = InvalidOid;
 	collation = tentry->typcollation;
 
@@ -93,18 +222,90 @@ dictionary_hash_alloc(TypeCacheEntry *tentry)
 			 "invalid type for dictionary compression, type must have both a hash function and "
 			 "equality function");
 
+	hash->kind = dictionary_hash_kind(tentry);
+
+	switch (hash->kind)
+	{
+		case DICTIONARY_HASH_BYVAL:
+			hash->table.byval = dictionary_byval_create(CurrentMemoryContext, 10, NULL);
+			return hash;
+		case DICTIONARY_HASH_VARLENA:
+			hash->table.varlena = dictionary_varlena_create(CurrentMemoryContext, 10, NULL);
+			return hash;
+		case DICTIONARY_HASH_GENERIC:
+			break;
+	}
+
 	/* May be more correct to get collation defined on the column, which may be different than the
 	 * collation defined on the type (what we're currently using). We need to think about
 	 * backwards compatibility, and different collations. Should only affect compression ratios
 	 * anyway.
 	 */
+	meta = palloc(sizeof(*meta));
 	meta->eq_info = HEAP_FCINFO(2);
 	InitFunctionCallInfoData(*meta->eq_info, &tentry->eq_opr_finfo, 2, collation, NULL, NULL);
 
 	meta->hash_info = HEAP_FCINFO(2);
 	InitFunctionCallInfoData(*meta->hash_info, &tentry->hash_proc_finfo, 1, collation, NULL, NULL);
 
-	return dictionary_create(CurrentMemoryContext, 10, meta);
+	hash->table.generic = dictionary_create(CurrentMemoryContext, 10, meta);
+	return hash;
 }
 
+static pg_attribute_always_inline DictionaryHashItem *
+dictionary_hash_insert(DictionaryHash *hash, Datum key, bool *found)
+{
+	switch (hash->kind)
+	{
+		case DICTIONARY_HASH_BYVAL:
+			return dictionary_byval_insert(hash->table.byval, key, found);
+		case DICTIONARY_HASH_VARLENA:
+			return dictionary_varlena_insert(hash->table.varlena, key, found);
+		case DICTIONARY_HASH_GENERIC:
+			break;
+	}
+
+	return dictionary_insert(hash->table.generic, key, found);
+}
+
+#define DICTIONARY_HASH_GET_KEYS(PREFIX, TABLE, KEYS, COUNT)                                       \
+	do                                                                                             \
+	{                                                                                              \
+		PREFIX##_iterator iterator;                                                                \
+		DictionaryHashItem *item;                                                                  \
+		PREFIX##_start_iterate(TABLE, &iterator);                                                  \
+		while ((item = PREFIX##_iterate(TABLE, &iterator)) != NULL)                                \
+		{                                                                                          \
+			(KEYS)[item->index] = item->key;                                                       \
+			(COUNT)++;                                                                             \
+		}                                                                                          \
+	} while (0)
+
+/*
+ * Store the keys of the dictionary ordered by their index in the keys array,
+ * which must have room for all of them. Returns the number of keys.
+ */
+static uint32
+dictionary_hash_get_keys(DictionaryHash *hash, Datum *keys)
+{
+	uint32 count = 0;
+
+	switch (hash->kind)
+	{
+		case DICTIONARY_HASH_BYVAL:
+			DICTIONARY_HASH_GET_KEYS(dictionary_byval, hash->table.byval, keys, count);
+			break;
+		case DICTIONARY_HASH_VARLENA:
+			DICTIONARY_HASH_GET_KEYS(dictionary_varlena, hash->table.varlena, keys, count);
+			break;
+		case DICTIONARY_HASH_GENERIC:
+			DICTIONARY_HASH_GET_KEYS(dictionary, hash->table.generic, keys, count);
+			break;
+	}
+
+	return count;
+}
+
+#undef DICTIONARY_HASH_GET_KEYS
+
 #endif
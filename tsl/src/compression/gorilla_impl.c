@@ -14,7 +14,7 @@
 
 static ArrowArray *
 FUNCTION_NAME(gorilla_decompress_all, ELEMENT_TYPE)(CompressedGorillaData *gorilla_data,
-													MemoryContext dest_mctx)
+													DecompressionArena *dest)
 {
 	const bool has_nulls = gorilla_data->nulls != NULL;
 	const uint16 n_total =
@@ -34,7 +34,7 @@ FUNCTION_NAME(gorilla_decompress_all, ELEMENT_TYPE)(CompressedGorillaData *goril
 	 * converts the elements to postres Datum always reads in 8 bytes.
 	 */
 	const int buffer_bytes = n_total_padded * sizeof(ELEMENT_TYPE) + 8;
-	ELEMENT_TYPE *restrict decompressed_values = MemoryContextAlloc(dest_mctx, buffer_bytes);
+	ELEMENT_TYPE *restrict decompressed_values = decompression_arena_alloc(dest, buffer_bytes);
 
 	const uint16 n_notnull = gorilla_data->tag0s->num_elements;
 	CheckCompressedData(n_total >= n_notnull);
@@ -43,10 +43,6 @@ FUNCTION_NAME(gorilla_decompress_all, ELEMENT_TYPE)(CompressedGorillaData *goril
 	Simple8bRleBitmap tag0s = simple8brle_bitmap_prefixsums(gorilla_data->tag0s);
 	Simple8bRleBitmap tag1s = simple8brle_bitmap_prefixsums(gorilla_data->tag1s);
 
-	BitArray leading_zeros_bitarray = gorilla_data->leading_zeros;
-	BitArrayIterator leading_zeros_iterator;
-	bit_array_iterator_init(&leading_zeros_iterator, &leading_zeros_bitarray);
-
 	uint8 all_leading_zeros[MAX_NUM_LEADING_ZEROS_PADDED_N64];
 	const uint16 leading_zeros_padded =
 		unpack_leading_zeros_array(&gorilla_data->leading_zeros, all_leading_zeros);
@@ -57,10 +53,6 @@ FUNCTION_NAME(gorilla_decompress_all, ELEMENT_TYPE)(CompressedGorillaData *goril
 											 bit_widths,
 											 MAX_NUM_LEADING_ZEROS_PADDED_N64);
 
-	BitArray xors_bitarray = gorilla_data->xors;
-	BitArrayIterator xors_iterator;
-	bit_array_iterator_init(&xors_iterator, &xors_bitarray);
-
 	/*
 	 * Now decompress the non-null data.
 	 *
@@ -85,25 +77,67 @@ FUNCTION_NAME(gorilla_decompress_all, ELEMENT_TYPE)(CompressedGorillaData *goril
 	CheckCompressedData(n_different <= n_notnull);
 
 	/*
-	 * 1d) Unpack.
+	 * 1d) Precompute the shifts for each bit width, and check that the bit
+	 * widths are valid.
+	 *
+	 * Truncate the shift here not to cause UB on the corrupt data.
+	 */
+	uint8 shifts[MAX_NUM_LEADING_ZEROS_PADDED_N64];
+	for (uint16 i = 0; i < num_bit_widths; i++)
+	{
+		CheckCompressedData(bit_widths[i] <= 64);
+		shifts[i] = (64 - (bit_widths[i] + all_leading_zeros[i])) & 63;
+	}
+
+	/*
+	 * 1e) Sanity check: the xors have enough bits for all the different
+	 * elements. After this check, the xors can be read as whole words without
+	 * bounds checks for each element.
+	 */
+	uint32 total_xor_bits = 0;
+	for (uint16 i = 0; i < n_different; i++)
+	{
+		total_xor_bits += bit_widths[simple8brle_bitmap_prefix_sum(&tag1s, i) - 1];
+	}
+	const uint32 num_xor_words = gorilla_data->xors.buckets.num_elements;
+	CheckCompressedData(total_xor_bits <= (uint64) num_xor_words * 64);
+
+	/*
+	 * An empty xors array is valid when all the xors have zero bits. Read a
+	 * zero word then, and clamp the word index so that a zero-bit read at the
+	 * very end doesn't go past the last word.
+	 */
+	static const uint64 zero_word = 0;
+	const uint64 *restrict xor_words =
+		num_xor_words > 0 ? gorilla_data->xors.buckets.data : &zero_word;
+	const uint32 last_xor_word = num_xor_words > 0 ? num_xor_words - 1 : 0;
+
+	/*
+	 * 1f) Unpack, reading each xor with shifts and masks from the words that
+	 * contain it.
 	 *
 	 * Note that the bit widths change often, so there's no sense in
 	 * having a fast path for stretches of tag1 == 0.
 	 */
 	ELEMENT_TYPE prev = 0;
+	uint32 xor_bit_position = 0;
 	for (uint16 i = 0; i < n_different; i++)
 	{
-		const uint8 current_xor_bits = bit_widths[simple8brle_bitmap_prefix_sum(&tag1s, i) - 1];
-		const uint8 current_leading_zeros =
-			all_leading_zeros[simple8brle_bitmap_prefix_sum(&tag1s, i) - 1];
+		const uint16 width_index = simple8brle_bitmap_prefix_sum(&tag1s, i) - 1;
+		const uint8 current_xor_bits = bit_widths[width_index];
+		const uint32 word = Min(xor_bit_position / 64, last_xor_word);
+		const uint8 offset = xor_bit_position % 64;
 
-		/*
-		 * Truncate the shift here not to cause UB on the corrupt data.
-		 */
-		const uint8 shift = (64 - (current_xor_bits + current_leading_zeros)) & 63;
+		uint64 current_xor = xor_words[word] >> offset;
+		if (offset + current_xor_bits > 64)
+		{
+			/* The next word has the high-order bits */
+			current_xor |= xor_words[word + 1] << (64 - offset);
+		}
+		current_xor &= bit_array_low_bits_mask(current_xor_bits);
 
-		const uint64 current_xor = bit_array_iter_next(&xors_iterator, current_xor_bits);
-		prev ^= current_xor << shift;
+		xor_bit_position += current_xor_bits;
+		prev ^= current_xor << shifts[width_index];
 		decompressed_values[i] = prev;
 	}
 
@@ -135,7 +169,7 @@ FUNCTION_NAME(gorilla_decompress_all, ELEMENT_TYPE)(CompressedGorillaData *goril
 	 * and fill the validity bitmap.
 	 */
 	const int validity_bitmap_bytes = sizeof(uint64) * ((n_total + 64 - 1) / 64);
-	uint64 *restrict validity_bitmap = MemoryContextAlloc(dest_mctx, validity_bitmap_bytes);
+	uint64 *restrict validity_bitmap = decompression_arena_alloc(dest, validity_bitmap_bytes);
 
 	/*
 	 * For starters, set the validity bitmap to all ones. We probably have less
@@ -193,7 +227,8 @@ FUNCTION_NAME(gorilla_decompress_all, ELEMENT_TYPE)(CompressedGorillaData *goril
 	}
 
 	/* Return the result. */
-	ArrowArray *result = MemoryContextAllocZero(dest_mctx, sizeof(ArrowArray) + sizeof(void *) * 2);
+	ArrowArray *result =
+		decompression_arena_alloc_zero(dest, sizeof(ArrowArray) + sizeof(void *) * 2);
 	const void **buffers = (const void **) &result[1];
 	buffers[0] = validity_bitmap;
 	buffers[1] = decompressed_values;
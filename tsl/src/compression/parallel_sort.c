@@ -0,0 +1,320 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Parallel sort of the uncompressed chunk for compress_chunk(). It follows the
+ * scheme of the parallel btree index build in Postgres (nbtsort.c): each
+ * participant sorts the part of the chunk it gets from a parallel table scan
+ * into a worker tuplesort, and the leader merges the results of all
+ * participants with a leader tuplesort that works on the shared fileset.
+ */
+#include <postgres.h>
+#include <access/parallel.h>
+#include <access/relscan.h>
+#include <access/tableam.h>
+#include <access/xact.h>
+#include <catalog/pg_class.h>
+#include <executor/tuptable.h>
+#include <miscadmin.h>
+#include <optimizer/paths.h>
+#include <pgstat.h>
+#include <storage/condition_variable.h>
+#include <storage/spin.h>
+#include <utils/rel.h>
+#include <utils/snapmgr.h>
+
+#include "compression/parallel_sort.h"
+#include "extension_constants.h"
+
+#define PARALLEL_KEY_COMPRESSION_SORT_SHARED UINT64CONST(0xC0DE000000000001)
+#define PARALLEL_KEY_COMPRESSION_TUPLESORT UINT64CONST(0xC0DE000000000002)
+
+typedef struct CompressionSortKey
+{
+	AttrNumber attnum;
+	Oid sort_operator;
+	Oid collation;
+	bool nulls_first;
+} CompressionSortKey;
+
+/*
+ * The state shared between the leader and the workers. The parallel table scan
+ * descriptor follows the sort keys, see compression_sort_shared_pscan().
+ */
+typedef struct CompressionSortShared
+{
+	Oid relid;
+
+	/* Work memory of every participant tuplesort, in kilobytes. */
+	int sortmem;
+
+	/* Protected by the mutex. */
+	slock_t mutex;
+	int nparticipantsdone;
+
+	/* The leader waits on it for all the participants to finish sorting. */
+	ConditionVariable workersdonecv;
+
+	int n_keys;
+	CompressionSortKey keys[FLEXIBLE_ARRAY_MEMBER];
+} CompressionSortShared;
+
+struct ParallelCompressionSort
+{
+	ParallelContext *pcxt;
+	Snapshot snapshot;
+};
+
+static Size
+compression_sort_shared_pscan_offset(int n_keys)
+{
+	return BUFFERALIGN(offsetof(CompressionSortShared, keys) + sizeof(CompressionSortKey) * n_keys);
+}
+
+static ParallelTableScanDesc
+compression_sort_shared_pscan(CompressionSortShared *shared)
+{
+	return (ParallelTableScanDesc) ((char *) shared +
+									compression_sort_shared_pscan_offset(shared->n_keys));
+}
+
+static Tuplesortstate *
+compression_sort_begin(Relation rel, CompressionSortShared *shared, int sortmem,
+					   SortCoordinate coordinate)
+{
+	const int n_keys = shared->n_keys;
+	AttrNumber *sort_keys = palloc(sizeof(*sort_keys) * n_keys);
+	Oid *sort_operators = palloc(sizeof(*sort_operators) * n_keys);
+	Oid *sort_collations = palloc(sizeof(*sort_collations) * n_keys);
+	bool *nulls_first = palloc(sizeof(*nulls_first) * n_keys);
+
+	for (int i = 0; i < n_keys; i++)
+	{
+		sort_keys[i] = shared->keys[i].attnum;
+		sort_operators[i] = shared->keys[i].sort_operator;
+		sort_collations[i] = shared->keys[i].collation;
+		nulls_first[i] = shared->keys[i].nulls_first;
+	}
+
+	return tuplesort_begin_heap(RelationGetDescr(rel),
+								n_keys,
+								sort_keys,
+								sort_operators,
+								sort_collations,
+								nulls_first,
+								sortmem,
+								coordinate,
+								false /*=randomAccess*/);
+}
+
+/*
+ * Sort the part of the chunk this participant gets from the parallel scan,
+ * and report to the leader that we are done. Both the workers and the leader
+ * run this.
+ */
+static void
+compression_sort_participate(Relation rel, CompressionSortShared *shared, Sharedsort *sharedsort)
+{
+	SortCoordinate coordinate = palloc0(sizeof(SortCoordinateData));
+	coordinate->isWorker = true;
+	coordinate->nParticipants = -1;
+	coordinate->sharedsort = sharedsort;
+
+	Tuplesortstate *sortstate = compression_sort_begin(rel, shared, shared->sortmem, coordinate);
+
+	TableScanDesc scan = table_beginscan_parallel(rel, compression_sort_shared_pscan(shared));
+	TupleTableSlot *slot = table_slot_create(rel, NULL);
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		tuplesort_puttupleslot(sortstate, slot);
+		CHECK_FOR_INTERRUPTS();
+	}
+	ExecDropSingleTupleTableSlot(slot);
+	table_endscan(scan);
+
+	tuplesort_performsort(sortstate);
+
+	SpinLockAcquire(&shared->mutex);
+	shared->nparticipantsdone++;
+	SpinLockRelease(&shared->mutex);
+	ConditionVariableSignal(&shared->workersdonecv);
+
+	/* The sorted run stays in the shared fileset for the leader to merge. */
+	tuplesort_end(sortstate);
+}
+
+/*
+ * Decide how many parallel workers to use for sorting the chunk. We use the
+ * same scaling by the relation size that Postgres uses for the parallel table
+ * scans, limited by max_parallel_maintenance_workers like the other
+ * maintenance commands.
+ */
+int
+compression_sort_plan_workers(Relation rel)
+{
+	if (!IsUnderPostmaster || max_parallel_maintenance_workers == 0)
+		return 0;
+
+	if (IsInParallelMode() || rel->rd_rel->relpersistence == RELPERSISTENCE_TEMP)
+		return 0;
+
+	const BlockNumber heap_pages = RelationGetNumberOfBlocks(rel);
+	int threshold = Max(min_parallel_table_scan_size, 1);
+	if (heap_pages < (BlockNumber) threshold)
+		return 0;
+
+	int nworkers = 1;
+	while (heap_pages >= (BlockNumber) threshold * 3 && nworkers < max_parallel_maintenance_workers)
+	{
+		nworkers++;
+		threshold *= 3;
+		if (threshold > INT_MAX / 3)
+			break;
+	}
+
+	return nworkers;
+}
+
+/*
+ * Sort the given relation in parallel. Returns NULL if we couldn't set up the
+ * parallel context, and the caller should sort serially then. Otherwise,
+ * returns the sorted leader tuplesort in *sortstate. The caller must call
+ * tuplesort_end() on it before calling compression_sort_end_parallel(). We
+ * stay in parallel mode until then, so the caller can insert tuples, but
+ * cannot e.g. update the catalog.
+ */
+ParallelCompressionSort *
+compression_sort_begin_parallel(Relation rel, int nworkers, int n_keys, AttrNumber *sort_keys,
+								Oid *sort_operators, Oid *sort_collations, bool *nulls_first,
+								Tuplesortstate **sortstate)
+{
+	Assert(nworkers > 0);
+
+	/*
+	 * We cannot take the snapshot or assign the transaction id in parallel
+	 * mode, so do this in advance. The leader inserts the compressed tuples
+	 * while still in parallel mode.
+	 */
+	Snapshot snapshot = RegisterSnapshot(GetLatestSnapshot());
+	(void) GetCurrentTransactionId();
+
+	EnterParallelMode();
+	ParallelContext *pcxt =
+		CreateParallelContext(EXTENSION_TSL_SO, "compression_sort_worker_main", nworkers);
+
+	/* The leader participates in the sort as well. */
+	const int max_participants = nworkers + 1;
+	const Size shared_size = add_size(compression_sort_shared_pscan_offset(n_keys),
+									  table_parallelscan_estimate(rel, snapshot));
+	const Size sharedsort_size = tuplesort_estimate_shared(max_participants);
+	shm_toc_estimate_chunk(&pcxt->estimator, shared_size);
+	shm_toc_estimate_chunk(&pcxt->estimator, sharedsort_size);
+	shm_toc_estimate_keys(&pcxt->estimator, 2);
+
+	InitializeParallelDSM(pcxt);
+
+	/* No DSM segment available, fall back to the serial sort. */
+	if (pcxt->seg == NULL)
+	{
+		UnregisterSnapshot(snapshot);
+		DestroyParallelContext(pcxt);
+		ExitParallelMode();
+		return NULL;
+	}
+
+	CompressionSortShared *shared = shm_toc_allocate(pcxt->toc, shared_size);
+	shared->relid = RelationGetRelid(rel);
+	shared->sortmem = Max(maintenance_work_mem / max_participants, 64);
+	SpinLockInit(&shared->mutex);
+	shared->nparticipantsdone = 0;
+	ConditionVariableInit(&shared->workersdonecv);
+	shared->n_keys = n_keys;
+	for (int i = 0; i < n_keys; i++)
+	{
+		shared->keys[i] = (CompressionSortKey){
+			.attnum = sort_keys[i],
+			.sort_operator = sort_operators[i],
+			.collation = sort_collations[i],
+			.nulls_first = nulls_first[i],
+		};
+	}
+	table_parallelscan_initialize(rel, compression_sort_shared_pscan(shared), snapshot);
+
+	Sharedsort *sharedsort = shm_toc_allocate(pcxt->toc, sharedsort_size);
+	tuplesort_initialize_shared(sharedsort, max_participants, pcxt->seg);
+
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COMPRESSION_SORT_SHARED, shared);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COMPRESSION_TUPLESORT, sharedsort);
+
+	LaunchParallelWorkers(pcxt);
+
+	/*
+	 * Wait for the workers to attach, so that we know the exact number of the
+	 * participants we have to wait for below.
+	 */
+	WaitForParallelWorkersToAttach(pcxt);
+	const int nparticipants = pcxt->nworkers_launched + 1;
+
+	compression_sort_participate(rel, shared, sharedsort);
+
+	for (;;)
+	{
+		SpinLockAcquire(&shared->mutex);
+		const int nparticipantsdone = shared->nparticipantsdone;
+		SpinLockRelease(&shared->mutex);
+
+		if (nparticipantsdone == nparticipants)
+			break;
+
+		ConditionVariableSleep(&shared->workersdonecv, WAIT_EVENT_PARALLEL_CREATE_INDEX_SCAN);
+	}
+	ConditionVariableCancelSleep();
+
+	/* Merge the sorted runs of all the participants. */
+	SortCoordinate coordinate = palloc0(sizeof(SortCoordinateData));
+	coordinate->isWorker = false;
+	coordinate->nParticipants = nparticipants;
+	coordinate->sharedsort = sharedsort;
+	*sortstate = compression_sort_begin(rel, shared, maintenance_work_mem, coordinate);
+	tuplesort_performsort(*sortstate);
+
+	ParallelCompressionSort *sort = palloc0(sizeof(ParallelCompressionSort));
+	sort->pcxt = pcxt;
+	sort->snapshot = snapshot;
+	return sort;
+}
+
+void
+compression_sort_end_parallel(ParallelCompressionSort *sort)
+{
+	WaitForParallelWorkersToFinish(sort->pcxt);
+	UnregisterSnapshot(sort->snapshot);
+	DestroyParallelContext(sort->pcxt);
+	ExitParallelMode();
+	pfree(sort);
+}
+
+/*
+ * The entry point of the parallel workers.
+ */
+void
+compression_sort_worker_main(dsm_segment *seg, shm_toc *toc)
+{
+	CompressionSortShared *shared =
+		shm_toc_lookup(toc, PARALLEL_KEY_COMPRESSION_SORT_SHARED, false);
+	Sharedsort *sharedsort = shm_toc_lookup(toc, PARALLEL_KEY_COMPRESSION_TUPLESORT, false);
+
+	/*
+	 * The leader holds a stronger lock on the chunk, and we are in the same
+	 * lock group, so this doesn't block.
+	 */
+	Relation rel = table_open(shared->relid, AccessShareLock);
+
+	tuplesort_attach_shared(sharedsort, seg);
+	compression_sort_participate(rel, shared, sharedsort);
+
+	table_close(rel, AccessShareLock);
+}
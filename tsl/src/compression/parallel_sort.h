@@ -0,0 +1,39 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_TSL_COMPRESSION_PARALLEL_SORT_H
+#define TIMESCALEDB_TSL_COMPRESSION_PARALLEL_SORT_H
+
+#include <postgres.h>
+#include <storage/dsm.h>
+#include <storage/shm_toc.h>
+#include <utils/relcache.h>
+#include <utils/tuplesort.h>
+
+#include "export.h"
+
+/*
+ * Parallel sort of the uncompressed chunk before compression.
+ *
+ * The parallel workers and the leader scan the chunk with a parallel table
+ * scan and sort their parts of it, and then the leader merges the sorted runs.
+ * The compression itself and the _ts_meta_sequence_num assignment still happen
+ * in the leader in the sorted order, because the parallel workers cannot insert
+ * tuples.
+ */
+typedef struct ParallelCompressionSort ParallelCompressionSort;
+
+extern int compression_sort_plan_workers(Relation rel);
+
+extern ParallelCompressionSort *
+compression_sort_begin_parallel(Relation rel, int nworkers, int n_keys, AttrNumber *sort_keys,
+								Oid *sort_operators, Oid *sort_collations, bool *nulls_first,
+								Tuplesortstate **sortstate);
+
+extern void compression_sort_end_parallel(ParallelCompressionSort *sort);
+
+extern PGDLLEXPORT void compression_sort_worker_main(dsm_segment *seg, shm_toc *toc);
+
+#endif
@@ -0,0 +1,383 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Radix sort of the uncompressed chunk for compress_chunk(), see
+ * radix_sort.h. Each sort key is normalized into an uint64 that sorts in the
+ * requested direction when compared as unsigned, plus a NULL rank when the key
+ * has NULLs. The tuples are then sorted by an LSD radix sort over the bytes of
+ * the normalized keys, from the last sort key to the first one. The passes for
+ * the bytes that are the same in all tuples, e.g., the high bytes of small
+ * ids, are skipped.
+ */
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <access/stratnum.h>
+#include <catalog/pg_am.h>
+#include <catalog/pg_type.h>
+#include <commands/defrem.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+
+#include "compression/radix_sort.h"
+
+/*
+ * The tuples are copied into blocks of this size, which saves the overhead of
+ * a separate allocation for each tuple.
+ */
+#define RADIX_SORT_BLOCK_SIZE (1024 * 1024)
+#define RADIX_SORT_INITIAL_TUPLES 1024
+
+typedef struct RadixSortKey
+{
+	AttrNumber attnum;
+	int16 typlen;
+	bool descending;
+	bool nulls_first;
+	bool has_nulls;
+} RadixSortKey;
+
+struct CompressionRadixSort
+{
+	MemoryContext mcxt;
+	TupleDesc tupdesc;
+	int n_keys;
+	RadixSortKey *keys;
+
+	Size memory_limit;
+	Size memory_used;
+
+	uint32 num_tuples;
+	uint32 max_tuples;
+	HeapTuple *tuples;
+
+	/* The normalized keys and their NULL ranks, n_keys for each tuple */
+	uint64 *key_values;
+	uint8 *null_ranks;
+
+	/* The sorted order as indexes into the arrays above, after the sort */
+	uint32 *order;
+	uint32 next_tuple;
+
+	char *block;
+	Size block_free;
+};
+
+/*
+ * Start a radix sort, or return NULL if the sort keys are not supported.
+ *
+ * All the sort keys have to be integers, dates or timestamps sorted by the
+ * default btree ordering of the type, which is the order of the integers
+ * they are stored as.
+ */
+CompressionRadixSort *
+compression_radix_sort_begin(TupleDesc tupdesc, int n_keys, const AttrNumber *sort_keys,
+							 const Oid *sort_operators, const bool *nulls_first, Size memory_limit)
+{
+	CompressionRadixSort *sort;
+	MemoryContext mcxt;
+	RadixSortKey *keys = palloc(sizeof(RadixSortKey) * n_keys);
+
+	for (int i = 0; i < n_keys; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, AttrNumberGetAttrOffset(sort_keys[i]));
+		Oid opfamily;
+		Oid opcintype;
+		int16 strategy;
+
+		switch (attr->atttypid)
+		{
+			case INT2OID:
+			case INT4OID:
+			case INT8OID:
+			case DATEOID:
+			case TIMESTAMPOID:
+			case TIMESTAMPTZOID:
+				break;
+			default:
+				pfree(keys);
+				return NULL;
+		}
+
+		if (!get_ordering_op_properties(sort_operators[i], &opfamily, &opcintype, &strategy) ||
+			opcintype != attr->atttypid ||
+			opfamily != get_opclass_family(GetDefaultOpClass(attr->atttypid, BTREE_AM_OID)))
+		{
+			pfree(keys);
+			return NULL;
+		}
+
+		keys[i] = (RadixSortKey){
+			.attnum = sort_keys[i],
+			.typlen = attr->attlen,
+			.descending = strategy == BTGreaterStrategyNumber,
+			.nulls_first = nulls_first[i],
+			.has_nulls = false,
+		};
+	}
+
+	mcxt = AllocSetContextCreate(CurrentMemoryContext,
+								 "compression radix sort",
+								 ALLOCSET_DEFAULT_SIZES);
+	sort = MemoryContextAllocZero(mcxt, sizeof(CompressionRadixSort));
+	sort->mcxt = mcxt;
+	sort->tupdesc = tupdesc;
+	sort->n_keys = n_keys;
+	sort->keys = MemoryContextAlloc(mcxt, sizeof(RadixSortKey) * n_keys);
+	memcpy(sort->keys, keys, sizeof(RadixSortKey) * n_keys);
+	sort->memory_limit = memory_limit;
+	pfree(keys);
+
+	return sort;
+}
+
+static uint64
+radix_sort_normalize(const RadixSortKey *key, Datum value)
+{
+	int64 signed_value;
+	uint64 normalized;
+
+	switch (key->typlen)
+	{
+		case 2:
+			signed_value = DatumGetInt16(value);
+			break;
+		case 4:
+			signed_value = DatumGetInt32(value);
+			break;
+		default:
+			Assert(key->typlen == 8);
+			signed_value = DatumGetInt64(value);
+			break;
+	}
+
+	/* Flip the sign bit, so that the order of the unsigned values is the order
+	 * of the signed ones */
+	normalized = ((uint64) signed_value) ^ (UINT64CONST(1) << 63);
+
+	return key->descending ? ~normalized : normalized;
+}
+
+static void
+radix_sort_grow(CompressionRadixSort *sort)
+{
+	const uint32 max_tuples =
+		sort->max_tuples == 0 ? RADIX_SORT_INITIAL_TUPLES :
+								Min((uint64) sort->max_tuples * 2, (uint64) PG_UINT32_MAX);
+	const Size n_keys = sort->n_keys;
+
+	if (sort->tuples == NULL)
+	{
+		sort->tuples = MemoryContextAllocHuge(sort->mcxt, sizeof(HeapTuple) * max_tuples);
+		sort->key_values =
+			MemoryContextAllocHuge(sort->mcxt, sizeof(uint64) * n_keys * max_tuples);
+		sort->null_ranks = MemoryContextAllocHuge(sort->mcxt, sizeof(uint8) * n_keys * max_tuples);
+	}
+	else
+	{
+		sort->tuples = repalloc_huge(sort->tuples, sizeof(HeapTuple) * max_tuples);
+		sort->key_values = repalloc_huge(sort->key_values, sizeof(uint64) * n_keys * max_tuples);
+		sort->null_ranks = repalloc_huge(sort->null_ranks, sizeof(uint8) * n_keys * max_tuples);
+	}
+
+	sort->max_tuples = max_tuples;
+}
+
+/*
+ * Add a copy of the tuple to the sort. Returns false without adding it if the
+ * sort would exceed its memory limit.
+ */
+bool
+compression_radix_sort_puttuple(CompressionRadixSort *sort, HeapTuple tuple)
+{
+	const Size tuple_size = MAXALIGN(HEAPTUPLESIZE + tuple->t_len);
+	const Size entry_size = sizeof(HeapTuple) + 2 * sizeof(uint32) +
+							(sizeof(uint64) + sizeof(uint8)) * sort->n_keys;
+	const Size index = sort->num_tuples;
+	HeapTuple copy;
+
+	Assert(sort->order == NULL);
+
+	if (sort->num_tuples == PG_UINT32_MAX ||
+		sort->memory_used + tuple_size + entry_size > sort->memory_limit)
+		return false;
+
+	if (sort->num_tuples == sort->max_tuples)
+		radix_sort_grow(sort);
+
+	if (tuple_size > sort->block_free)
+	{
+		const Size block_size = Max(RADIX_SORT_BLOCK_SIZE, tuple_size);
+		sort->block = MemoryContextAllocHuge(sort->mcxt, block_size);
+		sort->block_free = block_size;
+	}
+
+	/* Same as heap_copytuple() */
+	copy = (HeapTuple) sort->block;
+	copy->t_len = tuple->t_len;
+	copy->t_self = tuple->t_self;
+	copy->t_tableOid = tuple->t_tableOid;
+	copy->t_data = (HeapTupleHeader) ((char *) copy + HEAPTUPLESIZE);
+	memcpy(copy->t_data, tuple->t_data, tuple->t_len);
+	sort->block += tuple_size;
+	sort->block_free -= tuple_size;
+
+	for (int k = 0; k < sort->n_keys; k++)
+	{
+		RadixSortKey *key = &sort->keys[k];
+		bool isnull;
+		Datum value = heap_getattr(copy, key->attnum, sort->tupdesc, &isnull);
+
+		if (isnull)
+		{
+			sort->key_values[index * sort->n_keys + k] = 0;
+			sort->null_ranks[index * sort->n_keys + k] = key->nulls_first ? 0 : 1;
+			key->has_nulls = true;
+		}
+		else
+		{
+			sort->key_values[index * sort->n_keys + k] = radix_sort_normalize(key, value);
+			sort->null_ranks[index * sort->n_keys + k] = key->nulls_first ? 1 : 0;
+		}
+	}
+
+	sort->tuples[index] = copy;
+	sort->num_tuples++;
+	sort->memory_used += tuple_size + entry_size;
+
+	return true;
+}
+
+static void
+radix_sort_swap(uint32 **order, uint32 **buffer)
+{
+	uint32 *tmp = *order;
+	*order = *buffer;
+	*buffer = tmp;
+}
+
+/*
+ * Stable sort of the tuples in the order array by one sort key, using the
+ * buffer as scratch space.
+ */
+static void
+radix_sort_key(const CompressionRadixSort *sort, int k, uint32 **order, uint32 **buffer)
+{
+	const uint32 n = sort->num_tuples;
+	const Size n_keys = sort->n_keys;
+	const uint64 *restrict values = sort->key_values;
+	uint32 counts[8][256];
+
+	/* Count the digits of all the bytes in one pass over the keys */
+	memset(counts, 0, sizeof(counts));
+	for (uint32 i = 0; i < n; i++)
+	{
+		const uint64 value = values[i * n_keys + k];
+		for (int byte = 0; byte < 8; byte++)
+			counts[byte][(value >> (8 * byte)) & 0xFF]++;
+	}
+
+	for (int byte = 0; byte < 8; byte++)
+	{
+		const uint8 first_digit = (values[k] >> (8 * byte)) & 0xFF;
+		uint32 offsets[256];
+		uint32 offset = 0;
+
+		/* All the tuples have the same digit, so this pass wouldn't change
+		 * the order */
+		if (counts[byte][first_digit] == n)
+			continue;
+
+		for (int digit = 0; digit < 256; digit++)
+		{
+			offsets[digit] = offset;
+			offset += counts[byte][digit];
+		}
+
+		const uint32 *restrict src = *order;
+		uint32 *restrict dst = *buffer;
+		for (uint32 i = 0; i < n; i++)
+		{
+			const uint32 tuple = src[i];
+			const uint8 digit = (values[tuple * n_keys + k] >> (8 * byte)) & 0xFF;
+			dst[offsets[digit]++] = tuple;
+		}
+
+		radix_sort_swap(order, buffer);
+	}
+
+	/* The NULL rank is the most significant part of the key */
+	if (sort->keys[k].has_nulls)
+	{
+		const uint8 *restrict null_ranks = sort->null_ranks;
+		const uint32 *restrict src = *order;
+		uint32 *restrict dst = *buffer;
+		uint32 offsets[2] = { 0, 0 };
+
+		for (uint32 i = 0; i < n; i++)
+			offsets[1] += null_ranks[i * n_keys + k] == 0;
+
+		for (uint32 i = 0; i < n; i++)
+		{
+			const uint32 tuple = src[i];
+			dst[offsets[null_ranks[tuple * n_keys + k]]++] = tuple;
+		}
+
+		radix_sort_swap(order, buffer);
+	}
+}
+
+void
+compression_radix_sort_performsort(CompressionRadixSort *sort)
+{
+	const uint32 n = sort->num_tuples;
+	uint32 *order;
+	uint32 *buffer;
+
+	Assert(sort->order == NULL);
+
+	if (n == 0)
+		return;
+
+	order = MemoryContextAllocHuge(sort->mcxt, sizeof(uint32) * n);
+	buffer = MemoryContextAllocHuge(sort->mcxt, sizeof(uint32) * n);
+
+	for (uint32 i = 0; i < n; i++)
+		order[i] = i;
+
+	/* LSD order, so the first sort key is sorted by last */
+	for (int k = sort->n_keys - 1; k >= 0; k--)
+		radix_sort_key(sort, k, &order, &buffer);
+
+	pfree(buffer);
+	sort->order = order;
+	sort->next_tuple = 0;
+}
+
+/*
+ * Get the next tuple in the sorted order, or NULL at the end. Before
+ * compression_radix_sort_performsort(), the tuples are returned in the order
+ * they were added, so that the caller can move them to a tuplesort.
+ */
+HeapTuple
+compression_radix_sort_gettuple(CompressionRadixSort *sort)
+{
+	uint32 index;
+
+	if (sort->next_tuple >= sort->num_tuples)
+		return NULL;
+
+	index = sort->order != NULL ? sort->order[sort->next_tuple] : sort->next_tuple;
+	sort->next_tuple++;
+
+	return sort->tuples[index];
+}
+
+void
+compression_radix_sort_end(CompressionRadixSort *sort)
+{
+	MemoryContextDelete(sort->mcxt);
+}
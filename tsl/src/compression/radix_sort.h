@@ -0,0 +1,37 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_TSL_COMPRESSION_RADIX_SORT_H
+#define TIMESCALEDB_TSL_COMPRESSION_RADIX_SORT_H
+
+#include <postgres.h>
+#include <access/htup.h>
+#include <access/tupdesc.h>
+
+/*
+ * In-memory radix sort of the uncompressed chunk before compression, for the
+ * common case where all the segmentby and orderby columns are integers,
+ * dates or timestamps.
+ *
+ * The sort keys are normalized into unsigned integers that sort in the
+ * requested order, so the tuples can be sorted with a stable LSD radix sort
+ * instead of comparisons through the SortSupport functions. The sort does not
+ * spill to disk, so compression_radix_sort_puttuple() refuses the tuples that
+ * don't fit into the memory limit, and the caller has to continue with a
+ * tuplesort then.
+ */
+typedef struct CompressionRadixSort CompressionRadixSort;
+
+extern CompressionRadixSort *compression_radix_sort_begin(TupleDesc tupdesc, int n_keys,
+														  const AttrNumber *sort_keys,
+														  const Oid *sort_operators,
+														  const bool *nulls_first,
+														  Size memory_limit);
+extern bool compression_radix_sort_puttuple(CompressionRadixSort *sort, HeapTuple tuple);
+extern void compression_radix_sort_performsort(CompressionRadixSort *sort);
+extern HeapTuple compression_radix_sort_gettuple(CompressionRadixSort *sort);
+extern void compression_radix_sort_end(CompressionRadixSort *sort);
+
+#endif
@@ -10,9 +10,21 @@
 #include <utils/builtins.h>
 #include <utils/datum.h>
 #include <libpq/pqformat.h>
+#include <port/pg_bitutils.h>
 
 #include "segment_meta.h"
 #include "datum_serialize.h"
+#include "compression/compression.h"
+
+/*
+ * The parameters of the bloom filter. With 8 to 16 bits per value and 6 hash
+ * functions, the false positive rate is about 2% or lower. The bit positions
+ * are derived from one 64-bit hash of the value by double hashing.
+ */
+#define BLOOM1_BITS_PER_VALUE 8
+#define BLOOM1_MIN_BITS 64
+#define BLOOM1_HASHES 6
+#define BLOOM1_SEED 0
 
 SegmentMetaMinMaxBuilder *
 segment_meta_min_max_builder_create(Oid type_oid, Oid collation)
@@ -131,3 +143,168 @@ segment_meta_min_max_builder_empty(SegmentMetaMinMaxBuilder *builder)
 {
 	return builder->empty;
 }
+
+bool
+segment_meta_bloom_type_supported(Oid type_oid)
+{
+	TypeCacheEntry *type = lookup_type_cache(type_oid, TYPECACHE_HASH_EXTENDED_PROC);
+	return OidIsValid(type->hash_extended_proc);
+}
+
+SegmentMetaBloomBuilder *
+segment_meta_bloom_builder_create(Oid type_oid, Oid collation, int max_values)
+{
+	SegmentMetaBloomBuilder *builder = palloc(sizeof(*builder));
+	TypeCacheEntry *type = lookup_type_cache(type_oid, TYPECACHE_HASH_EXTENDED_PROC_FINFO);
+
+	if (!OidIsValid(type->hash_extended_proc))
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_FUNCTION),
+				 errmsg("could not identify an extended hash function for type %s",
+						format_type_be(type_oid))));
+
+	*builder = (SegmentMetaBloomBuilder){
+		.collation = collation,
+		.num_hashes = 0,
+		.max_hashes = max_values,
+		.hashes = palloc(sizeof(uint64) * max_values),
+	};
+	fmgr_info_copy(&builder->hash_proc, &type->hash_extended_proc_finfo, CurrentMemoryContext);
+
+	return builder;
+}
+
+static inline uint64
+bloom1_hash(FmgrInfo *hash_proc, Oid collation, Datum val)
+{
+	return DatumGetUInt64(
+		FunctionCall2Coll(hash_proc, collation, val, Int64GetDatum(BLOOM1_SEED)));
+}
+
+/*
+ * The position of the i-th bit for the given hash, the number of bits is a
+ * power of two.
+ */
+static inline uint32
+bloom1_bit(uint64 hash, int i, uint32 num_bits)
+{
+	const uint32 h1 = (uint32) hash;
+	const uint32 h2 = ((uint32) (hash >> 32)) | 1;
+	return (h1 + i * h2) & (num_bits - 1);
+}
+
+void
+segment_meta_bloom_builder_update_val(SegmentMetaBloomBuilder *builder, Datum val)
+{
+	if (builder->num_hashes >= builder->max_hashes)
+		elog(ERROR, "too many values for the bloom filter");
+
+	builder->hashes[builder->num_hashes++] =
+		bloom1_hash(&builder->hash_proc, builder->collation, val);
+}
+
+bool
+segment_meta_bloom_builder_empty(SegmentMetaBloomBuilder *builder)
+{
+	return builder->num_hashes == 0;
+}
+
+Datum
+segment_meta_bloom_builder_finish(SegmentMetaBloomBuilder *builder)
+{
+	if (builder->num_hashes == 0)
+		elog(ERROR, "trying to get bloom filter from an empty builder");
+
+	const uint32 num_bits =
+		Max(BLOOM1_MIN_BITS, pg_nextpower2_32(builder->num_hashes * BLOOM1_BITS_PER_VALUE));
+	const uint32 num_bytes = num_bits / 8;
+	bytea *bloom = palloc0(VARHDRSZ + num_bytes);
+	SET_VARSIZE(bloom, VARHDRSZ + num_bytes);
+
+	uint8 *restrict bits = (uint8 *) VARDATA(bloom);
+	for (int i = 0; i < builder->num_hashes; i++)
+	{
+		for (int j = 0; j < BLOOM1_HASHES; j++)
+		{
+			const uint32 bit = bloom1_bit(builder->hashes[i], j, num_bits);
+			bits[bit / 8] |= 1 << (bit % 8);
+		}
+	}
+
+	return PointerGetDatum(bloom);
+}
+
+void
+segment_meta_bloom_builder_reset(SegmentMetaBloomBuilder *builder)
+{
+	builder->num_hashes = 0;
+}
+
+/*
+ * Check whether the bloom filter might contain the given value. Used as a
+ * filter on the compressed scan for the equality conditions on the columns
+ * that have bloom filters. The collation of the call must be the collation of
+ * the column.
+ */
+Datum
+tsl_bloom1_contains(PG_FUNCTION_ARGS)
+{
+	FmgrInfo *hash_proc = fcinfo->flinfo->fn_extra;
+	if (hash_proc == NULL)
+	{
+		Oid type_oid = get_fn_expr_argtype(fcinfo->flinfo, 1);
+		TypeCacheEntry *type = lookup_type_cache(type_oid, TYPECACHE_HASH_EXTENDED_PROC_FINFO);
+
+		if (!OidIsValid(type->hash_extended_proc))
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_FUNCTION),
+					 errmsg("could not identify an extended hash function for type %s",
+							format_type_be(type_oid))));
+
+		hash_proc = MemoryContextAlloc(fcinfo->flinfo->fn_mcxt, sizeof(FmgrInfo));
+		fmgr_info_copy(hash_proc, &type->hash_extended_proc_finfo, fcinfo->flinfo->fn_mcxt);
+		fcinfo->flinfo->fn_extra = hash_proc;
+	}
+
+	bytea *bloom = PG_GETARG_BYTEA_PP(0);
+	const uint64 hash = bloom1_hash(hash_proc, PG_GET_COLLATION(), PG_GETARG_DATUM(1));
+	PG_RETURN_BOOL(segment_meta_bloom_contains_hash(bloom, hash));
+}
+
+/*
+ * The hash of the value for checking it against the bloom filters of a column
+ * with the given type and collation. This allows checking the same value
+ * against many bloom filters without rehashing it.
+ */
+uint64
+segment_meta_bloom_hash(Oid type_oid, Oid collation, Datum val)
+{
+	TypeCacheEntry *type = lookup_type_cache(type_oid, TYPECACHE_HASH_EXTENDED_PROC_FINFO);
+
+	if (!OidIsValid(type->hash_extended_proc))
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_FUNCTION),
+				 errmsg("could not identify an extended hash function for type %s",
+						format_type_be(type_oid))));
+
+	return bloom1_hash(&type->hash_extended_proc_finfo, collation, val);
+}
+
+bool
+segment_meta_bloom_contains_hash(bytea *bloom, uint64 hash)
+{
+	const uint32 num_bytes = VARSIZE_ANY_EXHDR(bloom);
+	const uint32 num_bits = num_bytes * 8;
+	CheckCompressedData(num_bits >= BLOOM1_MIN_BITS);
+	CheckCompressedData((num_bits & (num_bits - 1)) == 0);
+
+	const uint8 *bits = (const uint8 *) VARDATA_ANY(bloom);
+	for (int j = 0; j < BLOOM1_HASHES; j++)
+	{
+		const uint32 bit = bloom1_bit(hash, j, num_bits);
+		if ((bits[bit / 8] & (1 << (bit % 8))) == 0)
+			return false;
+	}
+
+	return true;
+}
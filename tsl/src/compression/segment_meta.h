@@ -35,4 +35,34 @@ Datum segment_meta_min_max_builder_max(SegmentMetaMinMaxBuilder *builder);
 bool segment_meta_min_max_builder_empty(SegmentMetaMinMaxBuilder *builder);
 
 void segment_meta_min_max_builder_reset(SegmentMetaMinMaxBuilder *builder);
+
+/*
+ * Bloom filter over the values of a column in a compressed batch. It is stored
+ * in the _ts_meta_bloom_<column> metadata column as bytea, and allows skipping
+ * the batches that certainly don't contain the value we look for with the
+ * equality condition, without decompressing them.
+ */
+typedef struct SegmentMetaBloomBuilder
+{
+	FmgrInfo hash_proc;
+	Oid collation;
+
+	/* The hashes of the values added since the last reset. */
+	int num_hashes;
+	int max_hashes;
+	uint64 *hashes;
+} SegmentMetaBloomBuilder;
+
+SegmentMetaBloomBuilder *segment_meta_bloom_builder_create(Oid type, Oid collation,
+														   int max_values);
+void segment_meta_bloom_builder_update_val(SegmentMetaBloomBuilder *builder, Datum val);
+bool segment_meta_bloom_builder_empty(SegmentMetaBloomBuilder *builder);
+Datum segment_meta_bloom_builder_finish(SegmentMetaBloomBuilder *builder);
+void segment_meta_bloom_builder_reset(SegmentMetaBloomBuilder *builder);
+
+bool segment_meta_bloom_type_supported(Oid type);
+uint64 segment_meta_bloom_hash(Oid type, Oid collation, Datum val);
+bool segment_meta_bloom_contains_hash(bytea *bloom, uint64 hash);
+
+extern Datum tsl_bloom1_contains(PG_FUNCTION_ARGS);
 #endif
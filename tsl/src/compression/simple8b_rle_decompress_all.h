@@ -79,6 +79,20 @@ FUNCTION_NAME(simple8brle_decompress_all_buf,
 		const uint8 bits_per_value = SIMPLE8B_BIT_LENGTH[X];                                       \
 		CheckCompressedData(bits_per_value / 8 <= sizeof(ELEMENT_TYPE));                           \
                                                                                                    \
+		/*                                                                                         \
+		 * The consecutive blocks usually have the same selector, because the                      \
+		 * neighbouring values tend to have the same bit width. Unpack the                         \
+		 * entire run of such blocks here, so that we don't go through the                         \
+		 * switch for each block, and the compiler can vectorize the unpacking                     \
+		 * loop with the constant number of values per block.                                      \
+		 */                                                                                        \
+		uint32 end_block_index = block_index + 1;                                                  \
+		while (end_block_index < num_blocks && selector_values[end_block_index] == (X))            \
+		{                                                                                          \
+			end_block_index++;                                                                     \
+		}                                                                                          \
+		const uint32 n_run_blocks = end_block_index - block_index;                                 \
+                                                                                                   \
 		/*                                                                                         \
 		 * The last block might have less values than normal, but we have                          \
 		 * padding at the end so we can unpack them all always for simpler                         \
@@ -86,16 +100,23 @@ FUNCTION_NAME(simple8brle_decompress_all_buf,
 		 * might be incorrect.                                                                     \
 		 */                                                                                        \
 		const uint16 n_block_values = SIMPLE8B_NUM_ELEMENTS[X];                                    \
-		CheckCompressedData(decompressed_index + n_block_values < n_buffer_elements);              \
+		CheckCompressedData(decompressed_index + n_run_blocks * n_block_values <                   \
+							n_buffer_elements);                                                    \
                                                                                                    \
 		const uint64 bitmask = simple8brle_selector_get_bitmask(X);                                \
                                                                                                    \
-		for (uint16 i = 0; i < n_block_values; i++)                                                \
+		for (uint32 run_block = 0; run_block < n_run_blocks; run_block++)                          \
 		{                                                                                          \
-			const ELEMENT_TYPE value = (block_data >> (bits_per_value * i)) & bitmask;             \
-			decompressed_values[decompressed_index + i] = value;                                   \
+			const uint64 run_block_data = blocks[block_index + run_block];                         \
+			ELEMENT_TYPE *restrict block_values =                                                  \
+				&decompressed_values[decompressed_index + run_block * n_block_values];             \
+			for (uint16 i = 0; i < n_block_values; i++)                                            \
+			{                                                                                      \
+				block_values[i] = (run_block_data >> (bits_per_value * i)) & bitmask;              \
+			}                                                                                      \
 		}                                                                                          \
-		decompressed_index += n_block_values;                                                      \
+		decompressed_index += n_run_blocks * n_block_values;                                       \
+		block_index = end_block_index - 1;                                                         \
 		break;                                                                                     \
 	}
 
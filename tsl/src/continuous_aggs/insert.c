@@ -27,8 +27,10 @@
 #include "chunk.h"
 #include "dimension.h"
 #include "hypertable.h"
+#include "guc.h"
 #include "hypertable_cache.h"
 #include "invalidation.h"
+#include "invalidation_threshold_cache.h"
 #include "export.h"
 #include "partitioning.h"
 #include "utils.h"
@@ -56,7 +58,31 @@
  * multiple can have tuples modified during a single transaction. (And if we
  * move to per-chunk cache-invalidation it makes it even easier).
  *
+ * Instead of only the lowest and greatest modified value, each entry can keep
+ * a small sorted set of disjoint modified ranges, so that a transaction that
+ * modifies a few distant time values, e.g., a sparse backfill, does not
+ * invalidate everything in between. The ranges are aligned to the smallest
+ * bucket width of the continuous aggregates on the hypertable, so that
+ * modifications of the same bucket end up in the same range, and the closest
+ * ranges are coalesced once there are more than
+ * timescaledb.cagg_max_invalidation_ranges of them. With the default of one
+ * range, the entry is the lowest and greatest modified value.
+ *
+ * The materialization hypertable of a continuous aggregate that has other
+ * continuous aggregates on top of it always keeps up to
+ * CA_CACHE_INVAL_MAX_RANGES ranges. A refresh of the lower continuous
+ * aggregate only rewrites the buckets of its invalidated ranges, so in a
+ * hierarchy only the buckets of the upper continuous aggregates that cover
+ * those ranges get invalidated instead of everything between them.
  */
+#define CA_CACHE_INVAL_MAX_RANGES 64
+
+typedef struct ModifiedRange
+{
+	int64 start;
+	int64 end;
+} ModifiedRange;
+
 typedef struct ContinuousAggsCacheInvalEntry
 {
 	int32 hypertable_id;
@@ -70,8 +96,11 @@ typedef struct ContinuousAggsCacheInvalEntry
 	Oid previous_chunk_relid;
 	AttrNumber previous_chunk_open_dimension;
 	bool value_is_set;
-	int64 lowest_modified_value;
-	int64 greatest_modified_value;
+	int64 range_alignment; /* Smallest fixed bucket width of the caggs, or 0 */
+	int max_ranges;
+	int num_ranges;
+	/* One more than the limit to insert a range before coalescing */
+	ModifiedRange ranges[CA_CACHE_INVAL_MAX_RANGES + 1];
 } ContinuousAggsCacheInvalEntry;
 
 static int64 get_lowest_invalidated_time_for_hypertable(Oid hypertable_relid);
@@ -147,6 +176,38 @@ tuple_get_time(Dimension *d, HeapTuple tuple, AttrNumber col, TupleDesc tupdesc)
 	return ts_time_value_to_internal(datum, dimtype);
 }
 
+/*
+ * Get the smallest fixed bucket width of the continuous aggregates on the
+ * hypertable, which is used to align the modified ranges. Aligning the
+ * ranges only widens them, so it does not matter that the buckets of the
+ * other continuous aggregates can be wider or have a different origin.
+ */
+static int64
+get_smallest_bucket_width(int32 hypertable_id)
+{
+	List *caggs = ts_continuous_aggs_find_by_raw_table_id(hypertable_id);
+	int64 smallest_width = 0;
+	ListCell *lc;
+
+	foreach (lc, caggs)
+	{
+		ContinuousAgg *cagg = lfirst(lc);
+		int64 width;
+
+		if (ts_continuous_agg_bucket_width_variable(cagg))
+			continue;
+
+		width = ts_continuous_agg_bucket_width(cagg);
+
+		if (width > 1 && (smallest_width == 0 || width < smallest_width))
+			smallest_width = width;
+	}
+
+	list_free(caggs);
+
+	return smallest_width;
+}
+
 static inline void
 cache_inval_entry_init(ContinuousAggsCacheInvalEntry *cache_entry, int32 hypertable_id,
 					   int32 entry_id)
@@ -168,8 +229,13 @@ cache_inval_entry_init(ContinuousAggsCacheInvalEntry *cache_entry, int32 hyperta
 	}
 	cache_entry->previous_chunk_relid = InvalidOid;
 	cache_entry->value_is_set = false;
-	cache_entry->lowest_modified_value = INVAL_POS_INFINITY;
-	cache_entry->greatest_modified_value = INVAL_NEG_INFINITY;
+	cache_entry->max_ranges = ts_guc_cagg_max_invalidation_ranges;
+	if (ts_continuous_agg_hypertable_status(hypertable_id) & HypertableIsMaterialization)
+		cache_entry->max_ranges = CA_CACHE_INVAL_MAX_RANGES;
+	/* A single range is never split, so there is no need to align it */
+	cache_entry->range_alignment =
+		cache_entry->max_ranges > 1 ? get_smallest_bucket_width(hypertable_id) : 0;
+	cache_entry->num_ranges = 0;
 	ts_cache_release(ht_cache);
 }
 
@@ -190,14 +256,100 @@ cache_entry_switch_to_chunk(ContinuousAggsCacheInvalEntry *cache_entry, Oid chun
 		elog(ERROR, "continuous agg trigger function must be called on hypertable chunks only");
 }
 
+/*
+ * Coalesce the two closest neighboring ranges of the entry.
+ */
+static void
+cache_entry_coalesce_closest_ranges(ContinuousAggsCacheInvalEntry *cache_entry)
+{
+	ModifiedRange *ranges = cache_entry->ranges;
+	int closest = 0;
+
+	Assert(cache_entry->num_ranges > 1);
+
+	for (int i = 1; i < cache_entry->num_ranges - 1; i++)
+	{
+		if (int64_saturating_sub(ranges[i + 1].start, ranges[i].end) <
+			int64_saturating_sub(ranges[closest + 1].start, ranges[closest].end))
+			closest = i;
+	}
+
+	ranges[closest].end = ranges[closest + 1].end;
+	cache_entry->num_ranges--;
+	memmove(&ranges[closest + 1],
+			&ranges[closest + 2],
+			sizeof(ModifiedRange) * (cache_entry->num_ranges - closest - 1));
+}
+
+/*
+ * Add a modified range to the entry, merging it with the ranges that it
+ * overlaps or is adjacent to.
+ */
+static void
+cache_entry_add_range(ContinuousAggsCacheInvalEntry *cache_entry, int64 start, int64 end)
+{
+	ModifiedRange *ranges = cache_entry->ranges;
+	int64 width = cache_entry->range_alignment;
+	int first, last;
+
+	if (width > 1)
+	{
+		int64 start_mod = ((start % width) + width) % width;
+		int64 end_mod = ((end % width) + width) % width;
+
+		if (start >= PG_INT64_MIN + width)
+			start -= start_mod;
+		if (end <= PG_INT64_MAX - width)
+			end += width - 1 - end_mod;
+	}
+
+	/* Find the ranges that overlap with, or are adjacent to, the new range */
+	for (first = 0; first < cache_entry->num_ranges; first++)
+	{
+		if (int64_saturating_add(ranges[first].end, 1) >= start)
+			break;
+	}
+
+	for (last = first; last < cache_entry->num_ranges; last++)
+	{
+		if (int64_saturating_sub(ranges[last].start, 1) > end)
+			break;
+	}
+
+	if (last > first)
+	{
+		/* Merge the ranges first to last - 1 into the new range */
+		ranges[first].start = Min(ranges[first].start, start);
+		ranges[first].end = Max(ranges[last - 1].end, end);
+		memmove(&ranges[first + 1],
+				&ranges[last],
+				sizeof(ModifiedRange) * (cache_entry->num_ranges - last));
+		cache_entry->num_ranges -= last - first - 1;
+		return;
+	}
+
+	memmove(&ranges[first + 1],
+			&ranges[first],
+			sizeof(ModifiedRange) * (cache_entry->num_ranges - first));
+	ranges[first].start = start;
+	ranges[first].end = end;
+	cache_entry->num_ranges++;
+
+	if (cache_entry->num_ranges > cache_entry->max_ranges)
+		cache_entry_coalesce_closest_ranges(cache_entry);
+}
+
 static inline void
-update_cache_entry(ContinuousAggsCacheInvalEntry *cache_entry, int64 timeval)
+update_cache_entry_range(ContinuousAggsCacheInvalEntry *cache_entry, int64 start, int64 end)
 {
 	cache_entry->value_is_set = true;
-	if (timeval < cache_entry->lowest_modified_value)
-		cache_entry->lowest_modified_value = timeval;
-	if (timeval > cache_entry->greatest_modified_value)
-		cache_entry->greatest_modified_value = timeval;
+	cache_entry_add_range(cache_entry, start, end);
+}
+
+static inline void
+update_cache_entry(ContinuousAggsCacheInvalEntry *cache_entry, int64 timeval)
+{
+	update_cache_entry_range(cache_entry, timeval, timeval);
 }
 
 /*
@@ -299,10 +451,33 @@ execute_cagg_trigger(int32 hypertable_id, Relation chunk_rel, HeapTuple chunk_tu
 	update_cache_entry(cache_entry, timeval);
 }
 
+/*
+ * Record the range of time values modified in a hypertable without going
+ * through the invalidation trigger. This is used by inserts, which track the
+ * range of the inserted tuples while routing them to the chunks.
+ */
+void
+continuous_agg_invalidate_range(int32 hypertable_id, int32 entry_id, int64 start, int64 end)
+{
+	ContinuousAggsCacheInvalEntry *cache_entry;
+	bool found;
+
+	if (!continuous_aggs_cache_inval_htab)
+		cache_inval_init();
+
+	cache_entry = (ContinuousAggsCacheInvalEntry *)
+		hash_search(continuous_aggs_cache_inval_htab, &hypertable_id, HASH_ENTER, &found);
+
+	if (!found)
+		cache_inval_entry_init(cache_entry, hypertable_id, entry_id);
+
+	update_cache_entry_range(cache_entry, start, end);
+}
+
 static void
 cache_inval_entry_write(ContinuousAggsCacheInvalEntry *entry)
 {
-	int64 liv;
+	int64 liv = INVAL_POS_INFINITY;
 
 	if (!entry->value_is_set)
 		return;
@@ -319,20 +494,16 @@ cache_inval_entry_write(ContinuousAggsCacheInvalEntry *entry)
 	 * threshold. The same applies for distributed member invalidation triggers of hypertables.
 	 * The materializer can handle invalidations that are beyond the threshold gracefully.
 	 */
-	if (IsolationUsesXactSnapshot() || is_distributed_member)
-	{
-		invalidation_hyper_log_add_entry(entry->entry_id,
-										 entry->lowest_modified_value,
-										 entry->greatest_modified_value);
-		return;
-	}
+	bool write_all = IsolationUsesXactSnapshot() || is_distributed_member;
 
-	liv = get_lowest_invalidated_time_for_hypertable(entry->hypertable_relid);
+	if (!write_all)
+		liv = get_lowest_invalidated_time_for_hypertable(entry->hypertable_relid);
 
-	if (entry->lowest_modified_value < liv)
+	/* The ranges are sorted, so we can stop at the first one above the threshold */
+	for (int i = 0; i < entry->num_ranges && (write_all || entry->ranges[i].start < liv); i++)
 		invalidation_hyper_log_add_entry(entry->entry_id,
-										 entry->lowest_modified_value,
-										 entry->greatest_modified_value);
+										 entry->ranges[i].start,
+										 entry->ranges[i].end);
 };
 
 static void
@@ -459,15 +630,23 @@ int64
 get_lowest_invalidated_time_for_hypertable(Oid hypertable_relid)
 {
 	int64 min_val = INVAL_POS_INFINITY;
+	int32 hypertable_id = ts_hypertable_relid_to_id(hypertable_relid);
 	Catalog *catalog = ts_catalog_get();
 	ScanKeyData scankey[1];
 	ScannerCtx scanctx;
 
+	/*
+	 * The cached threshold is never behind the one in the catalog, see
+	 * invalidation_threshold.c
+	 */
+	if (ts_invalidation_threshold_cache_get(hypertable_id, &min_val))
+		return min_val;
+
 	ScanKeyInit(&scankey[0],
 				Anum_continuous_aggs_invalidation_threshold_pkey_hypertable_id,
 				BTEqualStrategyNumber,
 				F_INT4EQ,
-				Int32GetDatum(ts_hypertable_relid_to_id(hypertable_relid)));
+				Int32GetDatum(hypertable_id));
 	scanctx = (ScannerCtx){
 		.table = catalog_get_table_id(catalog, CONTINUOUS_AGGS_INVALIDATION_THRESHOLD),
 		.index = catalog_get_index(catalog,
@@ -781,6 +781,22 @@ invalidation_entry_try_merge(Invalidation *entry, const Invalidation *newentry)
 	return true;
 }
 
+/*
+ * Write the range of a modified (merged) invalidation back to its tuple in
+ * the given invalidation log.
+ */
+static void
+update_invalidation_entry(Relation log_rel, const Invalidation *entry)
+{
+	HeapTuple tuple = create_invalidation_tup(RelationGetDescr(log_rel),
+											  entry->hyper_id,
+											  entry->lowest_modified_value,
+											  entry->greatest_modified_value);
+
+	ts_catalog_update_tid_only(log_rel, &entry->tid, tuple);
+	heap_freetuple(tuple);
+}
+
 static void
 cut_and_insert_new_cagg_invalidation(const CaggInvalidationState *state, const Invalidation *entry,
 									 int32 cagg_hyper_id)
@@ -799,6 +815,65 @@ cut_and_insert_new_cagg_invalidation(const CaggInvalidationState *state, const I
 	ts_catalog_restore_user(&sec_ctx);
 }
 
+/*
+ * Compact the hypertable invalidation log of a hypertable in place.
+ *
+ * Each transaction that modifies a hypertable adds its own entry to the
+ * hypertable invalidation log, so after heavy backfilling the log can have a
+ * lot of overlapping entries, which are then read once for each continuous
+ * aggregate on the hypertable. Merging the overlapping and adjacent entries
+ * first means that the per-cagg scans only read the merged entries.
+ *
+ * This doesn't change the result of moving the invalidations: merged raw
+ * entries expand to the same bucket ranges as the merged expansions of the
+ * original entries.
+ */
+static void
+compact_hypertable_invalidation_log(const CaggInvalidationState *state)
+{
+	CatalogSecurityContext sec_ctx;
+	Invalidation mergedentry;
+	ScanIterator iterator;
+	Relation hyper_log_rel = open_invalidation_log(LOG_HYPER, RowExclusiveLock);
+
+	invalidation_entry_reset(&mergedentry);
+	hypertable_invalidation_scan_init(&iterator, state->raw_hypertable_id, RowExclusiveLock);
+	iterator.ctx.snapshot = state->snapshot;
+
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		Invalidation logentry;
+
+		INVALIDATION_ENTRY_SET(&logentry,
+							   ti,
+							   hypertable_id,
+							   Form_continuous_aggs_hypertable_invalidation_log);
+
+		if (!IS_VALID_INVALIDATION(&mergedentry))
+			mergedentry = logentry;
+		else if (invalidation_entry_try_merge(&mergedentry, &logentry))
+			ts_catalog_delete_tid_only(hyper_log_rel, &logentry.tid);
+		else
+		{
+			if (mergedentry.is_modified)
+				update_invalidation_entry(hyper_log_rel, &mergedentry);
+			mergedentry = logentry;
+		}
+	}
+
+	ts_scan_iterator_close(&iterator);
+
+	/* Handle the last merged invalidation */
+	if (IS_VALID_INVALIDATION(&mergedentry) && mergedentry.is_modified)
+		update_invalidation_entry(hyper_log_rel, &mergedentry);
+
+	ts_catalog_restore_user(&sec_ctx);
+	table_close(hyper_log_rel, NoLock);
+}
+
 /*
  * Process invalidations in the hypertable invalidation log.
  *
@@ -822,6 +897,10 @@ move_invalidations_from_hyper_to_cagg_log(const CaggInvalidationState *state)
 
 	last_cagg_hyper_id = llast_int(all_caggs->mat_hypertable_ids);
 
+	/* Each continuous aggregate scans the log, so it pays off to compact it first */
+	if (list_length(all_caggs->mat_hypertable_ids) > 1)
+		compact_hypertable_invalidation_log(state);
+
 	/* We use a per-tuple memory context in the scan loop since we could be
 	 * processing a lot of invalidations (basically an unbounded
 	 * amount). Initialize it here by resetting it. */
@@ -945,14 +1024,7 @@ cut_cagg_invalidation(const CaggInvalidationState *state, const InternalTimeRang
 			 * (expanded) with another invalidation, then we still need to
 			 * update it. */
 			if (entry->is_modified)
-			{
-				HeapTuple tuple = create_invalidation_tup(RelationGetDescr(state->cagg_log_rel),
-														  entry->hyper_id,
-														  entry->lowest_modified_value,
-														  entry->greatest_modified_value);
-				ts_catalog_update_tid_only(state->cagg_log_rel, &tid, tuple);
-				heap_freetuple(tuple);
-			}
+				update_invalidation_entry(state->cagg_log_rel, entry);
 			break;
 		case INVAL_DELETE:
 			ts_catalog_delete_tid_only(state->cagg_log_rel, &tid);
@@ -15,6 +15,7 @@
 #include <utils/snapmgr.h>
 
 #include "ts_catalog/catalog.h"
+#include <invalidation_threshold_cache.h>
 #include <scanner.h>
 #include <scan_iterator.h>
 #include <compat/compat.h>
@@ -57,6 +58,11 @@
  *                                        |
  *                               invalidation threshold
  *
+ * The threshold is also kept in shared memory, where the inserts read it
+ * without scanning the catalog. The refresh moves the shared threshold
+ * forward while it still holds the lock on the catalog tuple, so that the
+ * inserts see it before the new threshold in the catalog becomes visible.
+ *
  * Transactions that use an isolation level stronger than READ COMMITTED will
  * not be able to "see" changes to the invalidation threshold that may have
  * been made while they were running. Therefore, they always create records
@@ -187,6 +193,9 @@ invalidation_threshold_set_or_get(const ContinuousAgg *cagg,
 		   "invalidation threshold for hypertable %d not found",
 		   cagg->data.raw_hypertable_id);
 
+	ts_invalidation_threshold_cache_advance(cagg->data.raw_hypertable_id,
+											updatectx.computed_invalidation_threshold);
+
 	return updatectx.computed_invalidation_threshold;
 }
 
@@ -11,6 +11,7 @@
 #include <utils/rel.h>
 #include <utils/relcache.h>
 #include <utils/date.h>
+#include <utils/memutils.h>
 #include <utils/snapmgr.h>
 
 #include <scanner.h>
@@ -20,6 +21,7 @@
 #include "ts_catalog/continuous_aggs_watermark.h"
 #include <time_utils.h>
 #include "debug_assert.h"
+#include "guc.h"
 
 #include "materialize.h"
 
@@ -37,19 +39,37 @@ static Datum internal_to_time_value_or_infinite(int64 internal, Oid time_type,
  * materialization support *
  ***************************/
 
+/*
+ * The max number of ranges materialized by one statement, which bounds the
+ * number of parameters of the statements.
+ */
+#define MATERIALIZATION_RANGES_PER_STATEMENT 16
+#define MATERIALIZATION_MAX_ARGS (2 * MATERIALIZATION_RANGES_PER_STATEMENT + 1)
+
 static void spi_update_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
 										SchemaAndName materialization_table,
-										const NameData *time_column_name,
-										TimeRange invalidation_range, const int32 chunk_id);
+										const NameData *time_column_name, const TimeRange *ranges,
+										int num_ranges, const int32 chunk_id);
 static void spi_delete_materializations(SchemaAndName materialization_table,
-										const NameData *time_column_name,
-										TimeRange invalidation_range,
-										const char *const chunk_condition);
+										const NameData *time_column_name, const TimeRange *ranges,
+										int num_ranges, const int32 chunk_id);
 static void spi_insert_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
 										SchemaAndName materialization_table,
-										const NameData *time_column_name,
-										TimeRange materialization_range,
-										const char *const chunk_condition);
+										const NameData *time_column_name, const TimeRange *ranges,
+										int num_ranges, const int32 chunk_id);
+static void spi_merge_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
+									   SchemaAndName materialization_table,
+									   const NameData *time_column_name, const TimeRange *ranges,
+									   int num_ranges, const int32 chunk_id);
+
+static void
+lock_down_search_path(void)
+{
+	int res = SPI_exec("SET LOCAL search_path TO pg_catalog, pg_temp", 0);
+
+	if (res < 0)
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), (errmsg("could not set search_path"))));
+}
 
 void
 continuous_agg_update_materialization(Hypertable *mat_ht, SchemaAndName partial_view,
@@ -60,12 +80,9 @@ continuous_agg_update_materialization(Hypertable *mat_ht, SchemaAndName partial_
 {
 	InternalTimeRange combined_materialization_range = new_materialization_range;
 	bool materialize_invalidations_separately = range_length(invalidation_range) > 0;
-	int res;
+	TimeRange ranges[2];
 
-	/* Lock down search_path */
-	res = SPI_exec("SET LOCAL search_path TO pg_catalog, pg_temp", 0);
-	if (res < 0)
-		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), (errmsg("could not set search_path"))));
+	lock_down_search_path();
 
 	/* pin the start of new_materialization to the end of new_materialization,
 	 * we are not allowed to materialize beyond that point
@@ -100,29 +117,67 @@ continuous_agg_update_materialization(Hypertable *mat_ht, SchemaAndName partial_
 	 */
 	if (range_length(invalidation_range) == 0 || !materialize_invalidations_separately)
 	{
+		ranges[0] = internal_time_range_to_time_range(combined_materialization_range);
 		spi_update_materializations(mat_ht,
 									partial_view,
 									materialization_table,
 									time_column_name,
-									internal_time_range_to_time_range(
-										combined_materialization_range),
+									ranges,
+									1,
 									chunk_id);
 	}
 	else
 	{
+		/* The two groups are disjoint, so they can be materialized together */
+		ranges[0] = internal_time_range_to_time_range(invalidation_range);
+		ranges[1] = internal_time_range_to_time_range(new_materialization_range);
 		spi_update_materializations(mat_ht,
 									partial_view,
 									materialization_table,
 									time_column_name,
-									internal_time_range_to_time_range(invalidation_range),
+									ranges,
+									2,
 									chunk_id);
+	}
+}
 
-		spi_update_materializations(mat_ht,
-									partial_view,
-									materialization_table,
-									time_column_name,
-									internal_time_range_to_time_range(new_materialization_range),
-									chunk_id);
+/*
+ * Materialize a set of disjoint ranges, e.g., the invalidated ranges of a
+ * refresh window.
+ *
+ * Instead of running the statements once per range, which scans the partial
+ * view and the materialization table once per range, the ranges are
+ * materialized by the same statements in batches of up to
+ * MATERIALIZATION_RANGES_PER_STATEMENT. The chunks that don't overlap with
+ * any of the ranges are still excluded at planning time.
+ */
+void
+continuous_agg_update_materialization_ranges(Hypertable *mat_ht, SchemaAndName partial_view,
+											 SchemaAndName materialization_table,
+											 const NameData *time_column_name,
+											 const InternalTimeRange *ranges, int num_ranges,
+											 int32 chunk_id)
+{
+	TimeRange batch[MATERIALIZATION_RANGES_PER_STATEMENT];
+	int batch_size = 0;
+
+	lock_down_search_path();
+
+	for (int i = 0; i < num_ranges; i++)
+	{
+		batch[batch_size++] = internal_time_range_to_time_range(ranges[i]);
+
+		if (batch_size == MATERIALIZATION_RANGES_PER_STATEMENT || i == num_ranges - 1)
+		{
+			spi_update_materializations(mat_ht,
+										partial_view,
+										materialization_table,
+										time_column_name,
+										batch,
+										batch_size,
+										chunk_id);
+			batch_size = 0;
+		}
 	}
 }
 
@@ -214,12 +269,97 @@ internal_time_range_to_time_range(InternalTimeRange internal)
 	return range;
 }
 
-static void
-spi_update_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
-							SchemaAndName materialization_table, const NameData *time_column_name,
-							TimeRange invalidation_range, const int32 chunk_id)
+/*
+ * The prepared plans of the materialization statements.
+ *
+ * A refresh materializes each invalidated range of the continuous aggregate
+ * with the same statements, so we prepare them once and keep the plans of
+ * the last continuous aggregate for the following ranges and refreshes. The
+ * plans are identified by their command text and parameter types, and are
+ * revalidated by the plan cache if the relations change.
+ */
+typedef struct MaterializationPlan
 {
-	StringInfo chunk_condition = makeStringInfo();
+	char *command;
+	int nargs;
+	Oid argtypes[MATERIALIZATION_MAX_ARGS];
+	SPIPlanPtr plan;
+} MaterializationPlan;
+
+static MaterializationPlan delete_plan = { 0 };
+static MaterializationPlan insert_plan = { 0 };
+static MaterializationPlan merge_plan = { 0 };
+
+static SPIPlanPtr
+get_materialization_plan(MaterializationPlan *cached, const char *command, int nargs,
+						 Oid *argtypes)
+{
+	SPIPlanPtr plan;
+
+	Assert(nargs <= (int) lengthof(cached->argtypes));
+
+	if (cached->plan != NULL && cached->nargs == nargs &&
+		memcmp(cached->argtypes, argtypes, sizeof(Oid) * nargs) == 0 &&
+		strcmp(cached->command, command) == 0)
+		return cached->plan;
+
+	if (cached->plan != NULL)
+	{
+		SPI_freeplan(cached->plan);
+		pfree(cached->command);
+		cached->plan = NULL;
+	}
+
+	plan = SPI_prepare(command, nargs, argtypes);
+
+	if (plan == NULL)
+		elog(ERROR,
+			 "could not prepare materialization statement: %s",
+			 SPI_result_code_string(SPI_result));
+
+	if (SPI_keepplan(plan) != 0)
+		elog(ERROR, "could not save materialization statement");
+
+	cached->command = MemoryContextStrdup(TopMemoryContext, command);
+	cached->nargs = nargs;
+	memcpy(cached->argtypes, argtypes, sizeof(Oid) * nargs);
+	cached->plan = plan;
+
+	return plan;
+}
+
+/*
+ * Build the condition on the time column, and on the chunk if given, with
+ * the start and end of each range as a pair of parameters, followed by the
+ * chunk as the last parameter.
+ */
+static int
+materialization_condition(StringInfo command, const char *alias, const NameData *time_column_name,
+						  const TimeRange *ranges, int num_ranges, const int32 chunk_id,
+						  Oid *argtypes, Datum *values)
+{
+	int nargs = 0;
+
+	Assert(num_ranges > 0 && num_ranges <= MATERIALIZATION_RANGES_PER_STATEMENT);
+
+	appendStringInfoChar(command, '(');
+	for (int i = 0; i < num_ranges; i++)
+	{
+		appendStringInfo(command,
+						 "%s%s.%s >= $%d AND %s.%s < $%d",
+						 i > 0 ? " OR " : "",
+						 alias,
+						 quote_identifier(NameStr(*time_column_name)),
+						 nargs + 1,
+						 alias,
+						 quote_identifier(NameStr(*time_column_name)),
+						 nargs + 2);
+		argtypes[nargs] = ranges[i].type;
+		values[nargs++] = ranges[i].start;
+		argtypes[nargs] = ranges[i].type;
+		values[nargs++] = ranges[i].end;
+	}
+	appendStringInfoChar(command, ')');
 
 	/*
 	 * chunk_id is valid if the materializaion update should be done only on the given chunk.
@@ -228,47 +368,75 @@ spi_update_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
 	 * not provided, i.e., invalid.
 	 */
 	if (chunk_id != INVALID_CHUNK_ID)
-		appendStringInfo(chunk_condition, "AND chunk_id = %d", chunk_id);
+	{
+		appendStringInfo(command, " AND %s.chunk_id = $%d", alias, nargs + 1);
+		argtypes[nargs] = INT4OID;
+		values[nargs] = Int32GetDatum(chunk_id);
+		nargs++;
+	}
+
+	return nargs;
+}
+
+static void
+spi_update_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
+							SchemaAndName materialization_table, const NameData *time_column_name,
+							const TimeRange *ranges, int num_ranges, const int32 chunk_id)
+{
+	if (ts_guc_enable_cagg_diff_materialization)
+	{
+		spi_merge_materializations(mat_ht,
+								   partial_view,
+								   materialization_table,
+								   time_column_name,
+								   ranges,
+								   num_ranges,
+								   chunk_id);
+		return;
+	}
 
 	spi_delete_materializations(materialization_table,
 								time_column_name,
-								invalidation_range,
-								chunk_condition->data);
+								ranges,
+								num_ranges,
+								chunk_id);
 	spi_insert_materializations(mat_ht,
 								partial_view,
 								materialization_table,
 								time_column_name,
-								invalidation_range,
-								chunk_condition->data);
+								ranges,
+								num_ranges,
+								chunk_id);
 }
 
 static void
 spi_delete_materializations(SchemaAndName materialization_table, const NameData *time_column_name,
-							TimeRange invalidation_range, const char *const chunk_condition)
+							const TimeRange *ranges, int num_ranges, const int32 chunk_id)
 {
 	int res;
 	StringInfo command = makeStringInfo();
-	Oid out_fn;
-	bool type_is_varlena;
-	char *invalidation_start;
-	char *invalidation_end;
-
-	getTypeOutputInfo(invalidation_range.type, &out_fn, &type_is_varlena);
-	invalidation_start = OidOutputFunctionCall(out_fn, invalidation_range.start);
-	invalidation_end = OidOutputFunctionCall(out_fn, invalidation_range.end);
+	Oid argtypes[MATERIALIZATION_MAX_ARGS];
+	Datum values[MATERIALIZATION_MAX_ARGS];
+	int nargs;
 
 	appendStringInfo(command,
-					 "DELETE FROM %s.%s AS D WHERE "
-					 "D.%s >= %s AND D.%s < %s %s;",
+					 "DELETE FROM %s.%s AS D WHERE ",
 					 quote_identifier(NameStr(*materialization_table.schema)),
-					 quote_identifier(NameStr(*materialization_table.name)),
-					 quote_identifier(NameStr(*time_column_name)),
-					 quote_literal_cstr(invalidation_start),
-					 quote_identifier(NameStr(*time_column_name)),
-					 quote_literal_cstr(invalidation_end),
-					 chunk_condition);
-
-	res = SPI_execute(command->data, false /* read_only */, 0 /*count*/);
+					 quote_identifier(NameStr(*materialization_table.name)));
+	nargs = materialization_condition(command,
+									  "D",
+									  time_column_name,
+									  ranges,
+									  num_ranges,
+									  chunk_id,
+									  argtypes,
+									  values);
+
+	res = SPI_execute_plan(get_materialization_plan(&delete_plan, command->data, nargs, argtypes),
+						   values,
+						   NULL,
+						   false /* read_only */,
+						   0 /*count*/);
 
 	if (res < 0)
 		elog(ERROR,
@@ -283,92 +451,199 @@ spi_delete_materializations(SchemaAndName materialization_table, const NameData
 			 NameStr(*materialization_table.name));
 }
 
+/*
+ * Update the watermark with the max(time_dimension) of the materialized data,
+ * which is the given column of the single result row of the last statement.
+ */
+static void
+update_watermark_from_result(Hypertable *mat_ht, int column)
+{
+	const Dimension *dim = hyperspace_get_open_dimension(mat_ht->space, 0);
+	Oid timetype;
+	Datum maxdat;
+	bool isnull;
+
+	if (NULL == dim)
+		elog(ERROR, "invalid open dimension index 0");
+
+	timetype = ts_dimension_get_partition_type(dim);
+
+	Ensure(SPI_gettypeid(SPI_tuptable->tupdesc, column) == timetype,
+		   "partition types for result (%d) and dimension (%d) do not match",
+		   SPI_gettypeid(SPI_tuptable->tupdesc, column),
+		   timetype);
+	maxdat = SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, column, &isnull);
+
+	if (!isnull)
+		ts_cagg_watermark_update(mat_ht,
+								 ts_time_value_to_internal(maxdat, timetype),
+								 isnull,
+								 false);
+}
+
+/*
+ * Insert the materializations of the range and get the max(time_dimension)
+ * of the inserted rows for the watermark in the same statement, so that the
+ * partial view is only scanned once.
+ */
 static void
 spi_insert_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
 							SchemaAndName materialization_table, const NameData *time_column_name,
-							TimeRange materialization_range, const char *const chunk_condition)
+							const TimeRange *ranges, int num_ranges, const int32 chunk_id)
 {
 	int res;
 	StringInfo command = makeStringInfo();
-	Oid out_fn, timetype;
-	bool type_is_varlena;
-	char *materialization_start;
-	char *materialization_end;
-
-	getTypeOutputInfo(materialization_range.type, &out_fn, &type_is_varlena);
-	materialization_start = OidOutputFunctionCall(out_fn, materialization_range.start);
-	materialization_end = OidOutputFunctionCall(out_fn, materialization_range.end);
+	Oid argtypes[MATERIALIZATION_MAX_ARGS];
+	Datum values[MATERIALIZATION_MAX_ARGS];
+	int nargs;
+	uint64 rows_inserted;
+	bool isnull;
 
 	appendStringInfo(command,
-					 "INSERT INTO %s.%s SELECT * FROM %s.%s AS I "
-					 "WHERE I.%s >= %s AND I.%s < %s %s;",
+					 "WITH inserted AS (INSERT INTO %s.%s SELECT * FROM %s.%s AS I WHERE ",
 					 quote_identifier(NameStr(*materialization_table.schema)),
 					 quote_identifier(NameStr(*materialization_table.name)),
 					 quote_identifier(NameStr(*partial_view.schema)),
-					 quote_identifier(NameStr(*partial_view.name)),
-					 quote_identifier(NameStr(*time_column_name)),
-					 quote_literal_cstr(materialization_start),
+					 quote_identifier(NameStr(*partial_view.name)));
+	nargs = materialization_condition(command,
+									  "I",
+									  time_column_name,
+									  ranges,
+									  num_ranges,
+									  chunk_id,
+									  argtypes,
+									  values);
+	appendStringInfo(command,
+					 " RETURNING %s) SELECT pg_catalog.count(*), pg_catalog.max(%s) FROM inserted",
 					 quote_identifier(NameStr(*time_column_name)),
-					 quote_literal_cstr(materialization_end),
-					 chunk_condition);
+					 quote_identifier(NameStr(*time_column_name)));
 
-	res = SPI_execute(command->data, false /* read_only */, 0 /*count*/);
+	res = SPI_execute_plan(get_materialization_plan(&insert_plan, command->data, nargs, argtypes),
+						   values,
+						   NULL,
+						   false /* read_only */,
+						   0 /*count*/);
 
-	if (res < 0)
+	if (res < 0 || SPI_processed != 1)
 		elog(ERROR,
 			 "could not materialize values into the materialization table \"%s.%s\"",
 			 NameStr(*materialization_table.schema),
 			 NameStr(*materialization_table.name));
-	else
-		elog(LOG,
-			 "inserted " UINT64_FORMAT " row(s) into materialization table \"%s.%s\"",
-			 SPI_processed,
-			 NameStr(*materialization_table.schema),
-			 NameStr(*materialization_table.name));
-
-	/* Get the max(time_dimension) of the materialized data */
-	if (SPI_processed > 0)
-	{
-		int64 watermark;
-		bool isnull;
-		Datum maxdat;
-		const Dimension *dim = hyperspace_get_open_dimension(mat_ht->space, 0);
 
-		if (NULL == dim)
-			elog(ERROR, "invalid open dimension index 0");
+	rows_inserted =
+		DatumGetInt64(SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1, &isnull));
 
-		timetype = ts_dimension_get_partition_type(dim);
+	elog(LOG,
+		 "inserted " UINT64_FORMAT " row(s) into materialization table \"%s.%s\"",
+		 rows_inserted,
+		 NameStr(*materialization_table.schema),
+		 NameStr(*materialization_table.name));
 
-		resetStringInfo(command);
-		appendStringInfo(command,
-						 "SELECT pg_catalog.max(%s) FROM %s.%s AS I "
-						 "WHERE I.%s >= %s AND I.%s < %s %s;",
-						 quote_identifier(NameStr(*time_column_name)),
-						 quote_identifier(NameStr(*partial_view.schema)),
-						 quote_identifier(NameStr(*partial_view.name)),
-						 quote_identifier(NameStr(*time_column_name)),
-						 quote_literal_cstr(materialization_start),
-						 quote_identifier(NameStr(*time_column_name)),
-						 quote_literal_cstr(materialization_end),
-						 chunk_condition);
-
-		res = SPI_execute(command->data, false /* read_only */, 0 /*count*/);
+	update_watermark_from_result(mat_ht, 2);
+}
 
-		if (res < 0)
-			elog(ERROR, "could not get the last bucket of the materialized data");
+/*
+ * Write only the differences between the materialized rows of the range and
+ * the rows of the partial view, in one statement: the materialized rows that
+ * have no identical row in the partial view are deleted, and the rows of the
+ * partial view that have no identical materialized row are inserted. The
+ * rows of unchanged buckets are not touched, which avoids the dead tuples
+ * and the WAL of rewriting them, see
+ * timescaledb.enable_cagg_diff_materialization.
+ *
+ * The rows are compared with the binary image equality operator, which
+ * works for all column types. The equality on the time column lets the
+ * anti-joins hash on it.
+ */
+static void
+spi_merge_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
+						   SchemaAndName materialization_table, const NameData *time_column_name,
+						   const TimeRange *ranges, int num_ranges, const int32 chunk_id)
+{
+	int res;
+	StringInfo command = makeStringInfo();
+	const char *time_column = quote_identifier(NameStr(*time_column_name));
+	const char *mat_table = quote_qualified_identifier(NameStr(*materialization_table.schema),
+													   NameStr(*materialization_table.name));
+	Oid argtypes[MATERIALIZATION_MAX_ARGS];
+	Datum values[MATERIALIZATION_MAX_ARGS];
+	int nargs;
+	bool isnull;
 
-		Ensure(SPI_gettypeid(SPI_tuptable->tupdesc, 1) == timetype,
-			   "partition types for result (%d) and dimension (%d) do not match",
-			   SPI_gettypeid(SPI_tuptable->tupdesc, 1),
-			   ts_dimension_get_partition_type(dim));
-		maxdat = SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1, &isnull);
+	appendStringInfo(command,
+					 "WITH new AS (SELECT * FROM %s AS I WHERE ",
+					 quote_qualified_identifier(NameStr(*partial_view.schema),
+												NameStr(*partial_view.name)));
+	nargs = materialization_condition(command,
+									  "I",
+									  time_column_name,
+									  ranges,
+									  num_ranges,
+									  chunk_id,
+									  argtypes,
+									  values);
+	appendStringInfo(command, "), deleted AS (DELETE FROM %s AS D WHERE ", mat_table);
+	materialization_condition(command,
+							  "D",
+							  time_column_name,
+							  ranges,
+							  num_ranges,
+							  chunk_id,
+							  argtypes,
+							  values);
+	appendStringInfo(command,
+					 " AND NOT EXISTS (SELECT FROM new AS N WHERE N.%s = D.%s AND "
+					 "ROW(N.*) OPERATOR(pg_catalog.*=) ROW(D.*)) RETURNING 1), "
+					 "inserted AS (INSERT INTO %s SELECT * FROM new AS N WHERE NOT EXISTS "
+					 "(SELECT FROM %s AS D WHERE ",
+					 time_column,
+					 time_column,
+					 mat_table,
+					 mat_table);
+	materialization_condition(command,
+							  "D",
+							  time_column_name,
+							  ranges,
+							  num_ranges,
+							  chunk_id,
+							  argtypes,
+							  values);
+	appendStringInfo(command,
+					 " AND N.%s = D.%s AND ROW(N.*) OPERATOR(pg_catalog.*=) ROW(D.*)) RETURNING 1) "
+					 "SELECT (SELECT pg_catalog.count(*) FROM deleted), "
+					 "(SELECT pg_catalog.count(*) FROM inserted), "
+					 "(SELECT pg_catalog.max(%s) FROM new)",
+					 time_column,
+					 time_column,
+					 time_column);
+
+	res = SPI_execute_plan(get_materialization_plan(&merge_plan, command->data, nargs, argtypes),
+						   values,
+						   NULL,
+						   false /* read_only */,
+						   0 /*count*/);
+
+	if (res < 0 || SPI_processed != 1)
+		elog(ERROR,
+			 "could not materialize values into the materialization table \"%s.%s\"",
+			 NameStr(*materialization_table.schema),
+			 NameStr(*materialization_table.name));
 
-		if (!isnull)
-		{
-			watermark = ts_time_value_to_internal(maxdat, timetype);
-			ts_cagg_watermark_update(mat_ht, watermark, isnull, false);
-		}
-	}
+	elog(LOG,
+		 "deleted " UINT64_FORMAT " row(s) from materialization table \"%s.%s\"",
+		 (uint64) DatumGetInt64(
+			 SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1, &isnull)),
+		 NameStr(*materialization_table.schema),
+		 NameStr(*materialization_table.name));
+	elog(LOG,
+		 "inserted " UINT64_FORMAT " row(s) into materialization table \"%s.%s\"",
+		 (uint64) DatumGetInt64(
+			 SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 2, &isnull)),
+		 NameStr(*materialization_table.schema),
+		 NameStr(*materialization_table.name));
+
+	/* The watermark covers all the rows of the range, not only the changed ones */
+	update_watermark_from_result(mat_ht, 3);
 }
 /*
  * Initialize MatTableColumnInfo.
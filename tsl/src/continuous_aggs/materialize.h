@@ -41,4 +41,9 @@ void continuous_agg_update_materialization(Hypertable *mat_ht, SchemaAndName par
 										   const NameData *time_column_name,
 										   InternalTimeRange new_materialization_range,
 										   InternalTimeRange invalidation_range, int32 chunk_id);
+void continuous_agg_update_materialization_ranges(Hypertable *mat_ht, SchemaAndName partial_view,
+												  SchemaAndName materialization_table,
+												  const NameData *time_column_name,
+												  const InternalTimeRange *ranges, int num_ranges,
+												  int32 chunk_id);
 #endif /* TIMESCALEDB_TSL_CONTINUOUS_AGGS_MATERIALIZE_H */
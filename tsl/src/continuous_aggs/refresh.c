@@ -16,9 +16,15 @@
 #include <fmgr.h>
 #include <executor/spi.h>
 
+#include "bgw/job.h"
+#include "bgw_policy/compression_api.h"
+#include "bgw_policy/policies_v2.h"
+#include "bgw_policy/policy_utils.h"
+#include "compression/api.h"
 #include "ts_catalog/catalog.h"
 #include "ts_catalog/continuous_agg.h"
 #include <dimension.h>
+#include <hypercube.h>
 #include <hypertable.h>
 #include <hypertable_cache.h>
 #include <time_bucket.h>
@@ -315,6 +321,144 @@ continuous_agg_refresh_execute(const CaggRefreshState *refresh,
 										  chunk_id);
 }
 
+/*
+ * Execute a refresh of a set of disjoint refresh windows, which are
+ * materialized together.
+ */
+static void
+continuous_agg_refresh_execute_ranges(const CaggRefreshState *refresh,
+									  const InternalTimeRange *bucketed_refresh_windows,
+									  int num_windows, const int32 chunk_id)
+{
+	SchemaAndName cagg_hypertable_name = {
+		.schema = &refresh->cagg_ht->fd.schema_name,
+		.name = &refresh->cagg_ht->fd.table_name,
+	};
+	const Dimension *time_dim = hyperspace_get_open_dimension(refresh->cagg_ht->space, 0);
+
+	Assert(time_dim != NULL);
+
+	continuous_agg_update_materialization_ranges(refresh->cagg_ht,
+												 refresh->partial_view,
+												 cagg_hypertable_name,
+												 &time_dim->fd.column_name,
+												 bucketed_refresh_windows,
+												 num_windows,
+												 chunk_id);
+}
+
+/*
+ * Get the compression horizon of the materialization hypertable, i.e., the
+ * time before which the compression policy compresses the chunks. Returns
+ * false if the continuous aggregate has no compression policy.
+ */
+static bool
+get_compression_horizon(const Hypertable *mat_ht, int64 *horizon)
+{
+	const Dimension *dim = hyperspace_get_open_dimension(mat_ht->space, 0);
+	Oid partitioning_type = ts_dimension_get_partition_type(dim);
+	List *jobs = ts_bgw_job_find_by_proc_and_hypertable_id(POLICY_COMPRESSION_PROC_NAME,
+														   INTERNAL_SCHEMA_NAME,
+														   mat_ht->fd.id);
+	BgwJob *job;
+
+	if (jobs == NIL)
+		return false;
+
+	job = linitial(jobs);
+
+	if (IS_INTEGER_TYPE(partitioning_type))
+	{
+		Oid now_func = ts_get_integer_now_func(dim);
+
+		if (!OidIsValid(now_func))
+			return false;
+
+		*horizon =
+			ts_sub_integer_from_now(policy_compression_get_compress_after_int(job->fd.config),
+									partitioning_type,
+									now_func);
+	}
+	else
+	{
+		Datum boundary =
+			subtract_interval_from_now(policy_compression_get_compress_after_interval(
+										   job->fd.config),
+									   partitioning_type);
+
+		*horizon = ts_time_value_to_internal(boundary, partitioning_type);
+	}
+
+	return true;
+}
+
+/*
+ * Compress the chunks of the materialization hypertable that were refreshed
+ * and are older than the compression horizon.
+ *
+ * A refresh of a window that is already compressed, e.g., a backfill of
+ * historical data, writes uncompressed rows into the compressed chunks. This
+ * recompresses those chunks right away, together with the new chunks of the
+ * window, instead of leaving them to the next run of the compression policy.
+ */
+static void
+continuous_agg_refresh_compress_chunks(const CaggRefreshState *refresh,
+									   const InternalTimeRange *bucketed_refresh_windows,
+									   int num_windows)
+{
+	const Hypertable *mat_ht = refresh->cagg_ht;
+	const Dimension *dim = hyperspace_get_open_dimension(mat_ht->space, 0);
+	int64 horizon;
+	int64 windows_end = PG_INT64_MIN;
+	List *chunk_ids;
+	ListCell *lc;
+
+	if (!ts_guc_enable_cagg_refresh_compression || num_windows == 0 ||
+		!TS_HYPERTABLE_HAS_COMPRESSION_ENABLED(mat_ht))
+		return;
+
+	if (!get_compression_horizon(mat_ht, &horizon))
+		return;
+
+	for (int i = 0; i < num_windows; i++)
+		windows_end = Max(windows_end, bucketed_refresh_windows[i].end);
+
+	chunk_ids = ts_dimension_slice_get_chunkids_to_compress(dim->fd.id,
+															BTLessStrategyNumber,
+															windows_end,
+															BTLessEqualStrategyNumber,
+															horizon,
+															true /* compress */,
+															true /* recompress */,
+															0 /* numchunks */);
+
+	foreach (lc, chunk_ids)
+	{
+		Chunk *chunk = ts_chunk_get_by_id(lfirst_int(lc), true);
+		const DimensionSlice *slice =
+			ts_hypercube_get_slice_by_dimension_id(chunk->cube, dim->fd.id);
+		bool refreshed = false;
+
+		for (int i = 0; i < num_windows && !refreshed; i++)
+			refreshed = slice->fd.range_start < bucketed_refresh_windows[i].end &&
+						slice->fd.range_end > bucketed_refresh_windows[i].start;
+
+		if (!refreshed)
+			continue;
+
+		elog(DEBUG1,
+			 "compressing refreshed chunk \"%s.%s\" of continuous aggregate \"%s\"",
+			 NameStr(chunk->fd.schema_name),
+			 NameStr(chunk->fd.table_name),
+			 NameStr(refresh->cagg.data.user_view_name));
+
+		if (ts_chunk_is_compressed(chunk))
+			tsl_recompress_chunk_wrapper(chunk);
+		else
+			tsl_compress_chunk_wrapper(chunk, true);
+	}
+}
+
 static void
 log_refresh_window(int elevel, const ContinuousAgg *cagg, const InternalTimeRange *refresh_window,
 				   const char *msg)
@@ -388,17 +532,38 @@ typedef void (*scan_refresh_ranges_funct_t)(const InternalTimeRange *bucketed_re
 											const long iteration, /* 0 is first range */
 											void *arg1, void *arg2);
 
+/*
+ * The refresh windows of the invalidations, collected to materialize them
+ * together.
+ */
+typedef struct RefreshWindows
+{
+	InternalTimeRange *windows;
+	int num_windows;
+	int max_windows;
+} RefreshWindows;
+
 static void
 continuous_agg_refresh_execute_wrapper(const InternalTimeRange *bucketed_refresh_window,
 									   const long iteration, void *arg1_refresh,
-									   void *arg2_chunk_id)
+									   void *arg2_windows)
 {
 	const CaggRefreshState *refresh = (const CaggRefreshState *) arg1_refresh;
-	const int32 chunk_id = *(const int32 *) arg2_chunk_id;
+	RefreshWindows *windows = (RefreshWindows *) arg2_windows;
 	(void) iteration;
 
 	log_refresh_window(DEBUG1, &refresh->cagg, bucketed_refresh_window, "invalidation refresh on");
-	continuous_agg_refresh_execute(refresh, bucketed_refresh_window, chunk_id);
+
+	if (windows->num_windows == windows->max_windows)
+	{
+		windows->max_windows = Max(8, windows->max_windows * 2);
+		windows->windows = windows->windows == NULL ?
+							   palloc(sizeof(InternalTimeRange) * windows->max_windows) :
+							   repalloc(windows->windows,
+										sizeof(InternalTimeRange) * windows->max_windows);
+	}
+
+	windows->windows[windows->num_windows++] = *bucketed_refresh_window;
 }
 
 static void
@@ -538,9 +703,11 @@ continuous_agg_refresh_with_window(const ContinuousAgg *cagg,
 						   &merged_refresh_window,
 						   "merged invalidations for refresh on");
 		continuous_agg_refresh_execute(&refresh, &merged_refresh_window, chunk_id);
+		continuous_agg_refresh_compress_chunks(&refresh, &merged_refresh_window, 1);
 	}
 	else
 	{
+		RefreshWindows windows = { 0 };
 		long count pg_attribute_unused();
 		count = continuous_agg_scan_refresh_window_ranges(refresh_window,
 														  invalidations,
@@ -548,8 +715,20 @@ continuous_agg_refresh_with_window(const ContinuousAgg *cagg,
 														  cagg->bucket_function,
 														  continuous_agg_refresh_execute_wrapper,
 														  (void *) &refresh /* arg1 */,
-														  (void *) &chunk_id /* arg2 */);
+														  (void *) &windows /* arg2 */);
 		Assert(count);
+
+		/*
+		 * The invalidated ranges are disjoint, so we materialize them with
+		 * the same statements instead of one range at a time.
+		 */
+		if (windows.num_windows > 0)
+			continuous_agg_refresh_execute_ranges(&refresh,
+												  windows.windows,
+												  windows.num_windows,
+												  chunk_id);
+
+		continuous_agg_refresh_compress_chunks(&refresh, windows.windows, windows.num_windows);
 	}
 	ts_guc_enable_per_data_node_queries = old_per_data_node_queries;
 }
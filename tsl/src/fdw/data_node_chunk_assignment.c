@@ -19,6 +19,8 @@
 #include "ts_catalog/chunk_data_node.h"
 #include "relinfo.h"
 #include "planner.h"
+#include "remote/healthcheck.h"
+#include "utils.h"
 
 /*
  * Find an existing data node chunk assignment or initialize a new one.
@@ -49,6 +51,98 @@ get_slice_for_dimension(Chunk *chunk, int32 dimension_id)
 	return ts_hypercube_get_slice_by_dimension_id(chunk->cube, dimension_id);
 }
 
+/*
+ * NodeChunkCount: a hash table entry to count the chunks of a query that can
+ * be read from a data node.
+ */
+typedef struct NodeChunkCount
+{
+	Oid node_serverid;
+	int num_chunks;
+} NodeChunkCount;
+
+static bool
+is_readable_replica(Oid serverid)
+{
+	return remote_data_node_is_healthy(serverid) &&
+		   ts_data_node_is_available_by_server(GetForeignServer(serverid));
+}
+
+static int
+get_node_chunk_count(DataNodeChunkAssignments *scas, Oid serverid)
+{
+	NodeChunkCount *count;
+
+	if (scas->node_chunk_counts == NULL)
+		return 0;
+
+	count = hash_search(scas->node_chunk_counts, &serverid, HASH_FIND, NULL);
+
+	return count == NULL ? 0 : count->num_chunks;
+}
+
+static double
+get_assigned_rows(DataNodeChunkAssignments *scas, Oid serverid)
+{
+	DataNodeChunkAssignment *sca = hash_search(scas->assignments, &serverid, HASH_FIND, NULL);
+
+	return sca == NULL ? 0 : sca->rows;
+}
+
+/*
+ * Check if a replica is a better choice than the current choice according to
+ * the assignment strategy.
+ */
+static bool
+replica_is_better(DataNodeChunkAssignments *scas, Oid replica, Oid current)
+{
+	switch (scas->strategy)
+	{
+		case SCA_STRATEGY_BALANCED:
+			return get_assigned_rows(scas, replica) < get_assigned_rows(scas, current);
+		case SCA_STRATEGY_FEWEST_DATA_NODES:
+			return get_node_chunk_count(scas, replica) > get_node_chunk_count(scas, current);
+		case SCA_STRATEGY_ATTACHED_DATA_NODE:
+			break;
+	}
+
+	return false;
+}
+
+/*
+ * Pick the data node to read the chunk from. The attached data node is the
+ * default choice and wins ties, but a healthy replica is picked if the
+ * attached data node failed its last health check. The chunk stays on its
+ * attached data node if none of the replicas is healthy, so that the query
+ * reports the connection error.
+ */
+static Oid
+choose_data_node(DataNodeChunkAssignments *scas, RelOptInfo *chunkrel, const Chunk *chunk)
+{
+	Oid best = chunkrel->serverid;
+	bool best_is_healthy = remote_data_node_is_healthy(best);
+	ListCell *lc;
+
+	if (scas->strategy == SCA_STRATEGY_ATTACHED_DATA_NODE && best_is_healthy)
+		return best;
+
+	foreach (lc, chunk->data_nodes)
+	{
+		ChunkDataNode *cdn = (ChunkDataNode *) lfirst(lc);
+
+		if (cdn->foreign_server_oid == best || !is_readable_replica(cdn->foreign_server_oid))
+			continue;
+
+		if (!best_is_healthy || replica_is_better(scas, cdn->foreign_server_oid, best))
+		{
+			best = cdn->foreign_server_oid;
+			best_is_healthy = true;
+		}
+	}
+
+	return best;
+}
+
 /*
  * Assign the given chunk relation to a data node.
  *
@@ -58,10 +152,13 @@ get_slice_for_dimension(Chunk *chunk, int32 dimension_id)
 DataNodeChunkAssignment *
 data_node_chunk_assignment_assign_chunk(DataNodeChunkAssignments *scas, RelOptInfo *chunkrel)
 {
-	DataNodeChunkAssignment *sca = get_or_create_sca(scas, chunkrel->serverid, NULL);
 	TimescaleDBPrivate *chunk_private = ts_get_private_reloptinfo(chunkrel);
+	DataNodeChunkAssignment *sca;
 	MemoryContext old;
 
+	chunkrel->serverid = choose_data_node(scas, chunkrel, chunk_private->cached_chunk_struct);
+	sca = get_or_create_sca(scas, chunkrel->serverid, NULL);
+
 	/* Should never assign the same chunk twice */
 	Assert(!bms_is_member(chunkrel->relid, sca->chunk_relids));
 
@@ -123,6 +220,7 @@ data_node_chunk_assignments_init(DataNodeChunkAssignments *scas,
 	scas->mctx = hctl.hcxt;
 	scas->total_num_chunks = 0;
 	scas->num_nodes_with_chunks = 0;
+	scas->node_chunk_counts = NULL;
 	scas->assignments = hash_create("data node chunk assignments",
 									nrels_hint,
 									&hctl,
@@ -143,6 +241,47 @@ data_node_chunk_assignment_assign_chunks(DataNodeChunkAssignments *scas, RelOptI
 
 	Assert(scas->assignments != NULL && scas->root != NULL);
 
+	/*
+	 * Count the chunks that each data node can serve, so that the chunks are
+	 * assigned to the data nodes that cover most of them.
+	 */
+	if (scas->strategy == SCA_STRATEGY_FEWEST_DATA_NODES)
+	{
+		HASHCTL hctl = {
+			.keysize = sizeof(Oid),
+			.entrysize = sizeof(NodeChunkCount),
+			.hcxt = scas->mctx,
+		};
+
+		scas->node_chunk_counts = hash_create("data node chunk counts",
+											  hash_get_num_entries(scas->assignments) + 16,
+											  &hctl,
+											  HASH_ELEM | HASH_CONTEXT | HASH_BLOBS);
+
+		for (i = 0; i < nrels; i++)
+		{
+			TimescaleDBPrivate *chunk_private = ts_get_private_reloptinfo(chunkrels[i]);
+			ListCell *lc;
+
+			foreach (lc, chunk_private->cached_chunk_struct->data_nodes)
+			{
+				ChunkDataNode *cdn = (ChunkDataNode *) lfirst(lc);
+				NodeChunkCount *count;
+				bool found;
+
+				count = hash_search(scas->node_chunk_counts,
+									&cdn->foreign_server_oid,
+									HASH_ENTER,
+									&found);
+
+				if (!found)
+					count->num_chunks = 0;
+
+				count->num_chunks++;
+			}
+		}
+	}
+
 	for (i = 0; i < nrels; i++)
 	{
 		RelOptInfo *chunkrel = chunkrels[i];
@@ -34,12 +34,18 @@ typedef struct DataNodeChunkAssignment
 } DataNodeChunkAssignment;
 
 /*
- * Only "attached data node" strategy is supported at this time. This strategy
- * picks the data node that is associated with a chunk's foreign table
+ * The "attached data node" strategy picks the data node that is associated
+ * with a chunk's foreign table. The other strategies pick among the replicas
+ * of a chunk: the "balanced" strategy picks the replica with the least rows
+ * assigned so far, to spread the reads over the replicas, and the "fewest
+ * data nodes" strategy picks the replica that holds the most chunks of the
+ * query, to minimize the number of data nodes involved.
  */
 typedef enum DataNodeChunkAssignmentStrategy
 {
 	SCA_STRATEGY_ATTACHED_DATA_NODE,
+	SCA_STRATEGY_BALANCED,
+	SCA_STRATEGY_FEWEST_DATA_NODES,
 } DataNodeChunkAssignmentStrategy;
 
 typedef struct DataNodeChunkAssignments
@@ -49,6 +55,7 @@ typedef struct DataNodeChunkAssignments
 	HTAB *assignments;
 	unsigned long total_num_chunks;
 	unsigned long num_nodes_with_chunks;
+	HTAB *node_chunk_counts; /* chunks available per data node, if needed */
 	MemoryContext mctx;
 } DataNodeChunkAssignments;
 
@@ -157,6 +157,23 @@ fetch_data(AsyncScanState *ass)
 	fetcher->funcs->fetch_data(fetcher);
 }
 
+static bool
+data_ready(AsyncScanState *ass)
+{
+	DataNodeScanState *dnss = (DataNodeScanState *) ass;
+
+	return data_fetcher_data_ready(dnss->fsstate.fetcher);
+}
+
+static pgsocket
+get_socket(AsyncScanState *ass)
+{
+	DataNodeScanState *dnss = (DataNodeScanState *) ass;
+	DataFetcher *fetcher = dnss->fsstate.fetcher;
+
+	return PQsocket(remote_connection_get_pg_conn(fetcher->conn));
+}
+
 Node *
 data_node_scan_state_create(CustomScan *cscan)
 {
@@ -168,6 +185,8 @@ data_node_scan_state_create(CustomScan *cscan)
 	dnss->async_state.init = create_fetcher;
 	dnss->async_state.send_fetch_request = send_fetch_request;
 	dnss->async_state.fetch_data = fetch_data;
+	dnss->async_state.data_ready = data_ready;
+	dnss->async_state.get_socket = get_socket;
 	dnss->fsstate.planned_fetcher_type =
 		intVal(list_nth(cscan->custom_private, DataNodeScanFetcherType));
 	Assert(dnss->fsstate.planned_fetcher_type != AutoFetcherType);
@@ -47,6 +47,7 @@
 #include "planner/planner.h"
 #include "chunk.h"
 #include "debug_assert.h"
+#include "remote/healthcheck.h"
 
 /*
  * DataNodeScan is a custom scan implementation for scanning hypertables on
@@ -1449,6 +1450,7 @@ data_node_scan_add_node_paths(PlannerInfo *root, RelOptInfo *hyper_rel)
 	Bitmapset *data_node_live_rels = NULL;
 #endif
 	int ndata_node_rels;
+	DataNodeChunkAssignmentStrategy strategy = SCA_STRATEGY_ATTACHED_DATA_NODE;
 	DataNodeChunkAssignments scas;
 	int i;
 
@@ -1465,7 +1467,23 @@ data_node_scan_add_node_paths(PlannerInfo *root, RelOptInfo *hyper_rel)
 
 	Assert(ndata_node_rels > 0);
 
-	data_node_chunk_assignments_init(&scas, SCA_STRATEGY_ATTACHED_DATA_NODE, root, ndata_node_rels);
+	switch (ts_guc_data_node_chunk_assignment)
+	{
+		case DNCA_Balanced:
+			strategy = SCA_STRATEGY_BALANCED;
+			break;
+		case DNCA_FewestNodes:
+			strategy = SCA_STRATEGY_FEWEST_DATA_NODES;
+			break;
+		case DNCA_Attached:
+			strategy = SCA_STRATEGY_ATTACHED_DATA_NODE;
+			break;
+	}
+
+	data_node_chunk_assignments_init(&scas, strategy, root, ndata_node_rels);
+
+	/* Check the data nodes so that chunks on dead data nodes are read from replicas */
+	remote_health_check_data_nodes(ts_get_private_reloptinfo(hyper_rel)->serverids);
 
 	/* Assign chunks to data nodes */
 	data_node_chunk_assignment_assign_chunks(&scas, chunk_rels, nchunk_rels);
@@ -350,6 +350,14 @@ contain_mutable_functions_walker(Node *node, void *context)
 {
 	if (node == NULL)
 		return false;
+
+	/* time_bucket_gapfill is deparsed as time_bucket of its bucket arguments */
+	if (IsA(node, FuncExpr) && is_gapfill_function_call(castNode(FuncExpr, node)))
+	{
+		List *args = gapfill_bucket_args(castNode(FuncExpr, node));
+		return contain_mutable_functions_walker((Node *) args, context);
+	}
+
 	/* Check for mutable functions in node itself */
 	if (check_functions_in_node(node, contain_mutable_functions_checker, context))
 		return true;
@@ -420,12 +428,6 @@ ts_is_foreign_expr(PlannerInfo *root, RelOptInfo *baserel, Expr *expr)
 	if (!foreign_expr_walker((Node *) expr, &glob_cxt))
 		return false;
 
-	/*
-	 * It is not supported to execute time_bucket_gapfill on data node.
-	 */
-	if (gapfill_in_expression(expr))
-		return false;
-
 	/*
 	 * An expression which includes any mutable functions can't be sent over
 	 * because its result is not stable.  For example, sending now() remote
@@ -516,6 +518,22 @@ foreign_expr_walker(Node *node, foreign_glob_cxt *glob_cxt)
 		{
 			FuncExpr *fe = castNode(FuncExpr, node);
 
+			/*
+			 * The gap filling of time_bucket_gapfill can only be done on the
+			 * access node, but the buckets of a grouping can be computed on
+			 * the data nodes with time_bucket, so that the aggregates are
+			 * pushed down and the gaps are filled above them.
+			 */
+			if (is_gapfill_function_call(fe))
+			{
+				if (!IS_UPPER_REL(glob_cxt->foreignrel))
+					return false;
+
+				if (!foreign_expr_walker((Node *) gapfill_bucket_args(fe), glob_cxt))
+					return false;
+				break;
+			}
+
 			/*
 			 * If function used by the expression is not shippable, it
 			 * can't be sent to remote because it might have incompatible
@@ -2013,6 +2031,92 @@ deparseDeleteSql(StringInfo buf, RangeTblEntry *rte, Index rtindex, Relation rel
 						 retrieved_attrs);
 }
 
+static void
+init_direct_modify_context(deparse_expr_cxt *context, StringInfo buf, PlannerInfo *root,
+						   RelOptInfo *foreignrel, List **params_list)
+{
+	context->root = root;
+	context->foreignrel = foreignrel;
+	context->scanrel = foreignrel;
+	context->buf = buf;
+	context->params_list = params_list;
+	context->sca = NULL;
+}
+
+/*
+ * deparse remote UPDATE statement that modifies the rows on the data node
+ * directly, without fetching them first
+ *
+ * The new values are the expressions of the given targetlist, with targetAttrs
+ * giving the updated columns. The WHERE clause is built from the remote
+ * conditions of the scan, and any expressions that have to be sent as
+ * parameters are added to *params_list.
+ */
+void
+deparseDirectUpdateSql(StringInfo buf, PlannerInfo *root, Index rtindex, Relation rel,
+					   RelOptInfo *foreignrel, List *targetlist, List *targetAttrs,
+					   List *remote_conds, List **params_list)
+{
+	deparse_expr_cxt context;
+	RangeTblEntry *rte = planner_rt_fetch(rtindex, root);
+	int nestlevel;
+	bool first = true;
+	ListCell *lc, *lc2;
+
+	init_direct_modify_context(&context, buf, root, foreignrel, params_list);
+
+	appendStringInfoString(buf, "UPDATE ");
+	deparseRelation(buf, rel);
+	appendStringInfoString(buf, " SET ");
+
+	/* Make sure any constants in the exprs are printed portably */
+	nestlevel = set_transmission_modes();
+
+	forboth (lc, targetlist, lc2, targetAttrs)
+	{
+		TargetEntry *tle = lfirst_node(TargetEntry, lc);
+		int attnum = lfirst_int(lc2);
+
+		if (!first)
+			appendStringInfoString(buf, ", ");
+		first = false;
+
+		deparseColumnRef(buf, rtindex, attnum, rte, false);
+		appendStringInfoString(buf, " = ");
+		deparseExpr((Expr *) tle->expr, &context);
+	}
+
+	reset_transmission_modes(nestlevel);
+
+	if (remote_conds != NIL)
+	{
+		appendStringInfoString(buf, " WHERE ");
+		appendConditions(remote_conds, &context, true);
+	}
+}
+
+/*
+ * deparse remote DELETE statement that deletes the rows on the data node
+ * directly, without fetching them first
+ */
+void
+deparseDirectDeleteSql(StringInfo buf, PlannerInfo *root, Index rtindex, Relation rel,
+					   RelOptInfo *foreignrel, List *remote_conds, List **params_list)
+{
+	deparse_expr_cxt context;
+
+	init_direct_modify_context(&context, buf, root, foreignrel, params_list);
+
+	appendStringInfoString(buf, "DELETE FROM ");
+	deparseRelation(buf, rel);
+
+	if (remote_conds != NIL)
+	{
+		appendStringInfoString(buf, " WHERE ");
+		appendConditions(remote_conds, &context, true);
+	}
+}
+
 /*
  * Add a RETURNING clause, if needed, to an INSERT/UPDATE/DELETE.
  */
@@ -2683,6 +2787,27 @@ deparseFuncExpr(FuncExpr *node, deparse_expr_cxt *context)
 		return;
 	}
 
+	/*
+	 * Gaps are filled on the access node, so the data node only has to
+	 * compute the buckets.
+	 */
+	if (is_gapfill_function_call(node))
+	{
+		appendStringInfo(buf,
+						 "%s.time_bucket(",
+						 quote_identifier(get_namespace_name(get_func_namespace(node->funcid))));
+		first = true;
+		foreach (arg, gapfill_bucket_args(node))
+		{
+			if (!first)
+				appendStringInfoString(buf, ", ");
+			deparseExpr((Expr *) lfirst(arg), context);
+			first = false;
+		}
+		appendStringInfoChar(buf, ')');
+		return;
+	}
+
 	/* Check if need to print VARIADIC (cf. ruleutils.c) */
 	use_variadic = node->funcvariadic;
 
@@ -39,6 +39,13 @@ extern void deparseUpdateSql(StringInfo buf, RangeTblEntry *rte, Index rtindex,
 extern void deparseDeleteSql(StringInfo buf, RangeTblEntry *rte, Index rtindex, Relation rel,
 							 List *returningList, List **retrieved_attrs);
 
+extern void deparseDirectUpdateSql(StringInfo buf, PlannerInfo *root, Index rtindex, Relation rel,
+								   RelOptInfo *foreignrel, List *targetlist, List *targetAttrs,
+								   List *remote_conds, List **params_list);
+
+extern void deparseDirectDeleteSql(StringInfo buf, PlannerInfo *root, Index rtindex, Relation rel,
+								   RelOptInfo *foreignrel, List *remote_conds, List **params_list);
+
 extern bool ts_is_foreign_expr(PlannerInfo *root, RelOptInfo *baserel, Expr *expr);
 
 extern void classify_conditions(PlannerInfo *root, RelOptInfo *baserel, List *input_conds,
@@ -342,6 +342,38 @@ plan_foreign_modify(PlannerInfo *root, ModifyTable *plan, Index result_relation,
 	return fdw_plan_foreign_modify(root, plan, result_relation, subplan_index);
 }
 
+#if PG14_GE
+static bool
+plan_direct_modify(PlannerInfo *root, ModifyTable *plan, Index result_relation, int subplan_index)
+{
+	return fdw_plan_direct_modify(root, plan, result_relation, subplan_index);
+}
+
+static void
+begin_direct_modify(ForeignScanState *node, int eflags)
+{
+	fdw_begin_direct_modify(node, eflags);
+}
+
+static TupleTableSlot *
+iterate_direct_modify(ForeignScanState *node)
+{
+	return fdw_iterate_direct_modify(node);
+}
+
+static void
+end_direct_modify(ForeignScanState *node)
+{
+	fdw_end_direct_modify(node);
+}
+
+static void
+explain_direct_modify(ForeignScanState *node, struct ExplainState *es)
+{
+	fdw_explain_direct_modify(node, es);
+}
+#endif
+
 /*
  * get_foreign_upper_paths
  *		Add paths for post-join operations like aggregation, grouping etc. if
@@ -410,9 +442,19 @@ static FdwRoutine timescaledb_fdw_routine = {
 	.ExecForeignUpdate = exec_foreign_update,
 	.EndForeignModify = end_foreign_modify,
 	.AddForeignUpdateTargets = add_foreign_update_targets,
+#if PG14_GE
+	/* direct update */
+	.PlanDirectModify = plan_direct_modify,
+	.BeginDirectModify = begin_direct_modify,
+	.IterateDirectModify = iterate_direct_modify,
+	.EndDirectModify = end_direct_modify,
+#endif
 	/* explain/analyze */
 	.ExplainForeignScan = explain_foreign_scan,
 	.ExplainForeignModify = explain_foreign_modify,
+#if PG14_GE
+	.ExplainDirectModify = explain_direct_modify,
+#endif
 	.AnalyzeForeignTable = NULL,
 };
 
@@ -15,6 +15,7 @@
 #include <fmgr.h>
 #include <miscadmin.h>
 #include <guc.h>
+#include <compat/compat.h>
 
 #include <remote/async.h>
 #include <remote/stmt_params.h>
@@ -30,6 +31,7 @@
 #include "modify_exec.h"
 #include "modify_plan.h"
 #include "tsl/src/chunk.h"
+#include "utils.h"
 
 /*
  * This enum describes what's kept in the fdw_private list for a ModifyTable
@@ -699,3 +701,154 @@ fdw_explain_modify(PlanState *ps, ResultRelInfo *rri, List *fdw_private, int sub
 		ExplainPropertyText("Remote SQL", sql, es);
 	}
 }
+
+#if PG14_GE
+/*
+ * This enum describes what's kept in the fdw_private list for a ForeignScan
+ * node that modifies a chunk directly (see fdw_plan_direct_modify()).
+ */
+enum FdwDirectModifyPrivateIndex
+{
+	/* UPDATE/DELETE statement to execute remotely (as a String node) */
+	FdwDirectModifyPrivateUpdateSql,
+	/* The data nodes of the chunk */
+	FdwDirectModifyPrivateDataNodes,
+	/* set-processed flag (as an integer Value node) */
+	FdwDirectModifyPrivateSetProcessed,
+};
+
+/*
+ * Execution state of a direct UPDATE or DELETE of a chunk.
+ */
+typedef struct TsFdwDirectModifyState
+{
+	char *query;		/* text of UPDATE/DELETE command */
+	bool set_processed; /* do we set the command es_processed? */
+	int64 num_tuples;	/* number of modified rows, -1 until executed */
+	List *conns;		/* connections to the data nodes of the chunk */
+} TsFdwDirectModifyState;
+
+void
+fdw_begin_direct_modify(ForeignScanState *node, int eflags)
+{
+	ForeignScan *fsplan = (ForeignScan *) node->ss.ps.plan;
+	EState *estate = node->ss.ps.state;
+	TsFdwDirectModifyState *dmstate;
+	RangeTblEntry *rte;
+	Oid user_id;
+	List *data_nodes;
+	ListCell *lc;
+
+	/* Do nothing in EXPLAIN (no ANALYZE) case. */
+	if (eflags & EXEC_FLAG_EXPLAIN_ONLY)
+		return;
+
+	dmstate = palloc0(sizeof(TsFdwDirectModifyState));
+	dmstate->query = strVal(list_nth(fsplan->fdw_private, FdwDirectModifyPrivateUpdateSql));
+	dmstate->set_processed =
+		intVal(list_nth(fsplan->fdw_private, FdwDirectModifyPrivateSetProcessed));
+	dmstate->num_tuples = -1;
+
+	/*
+	 * Identify which user to do the remote access as.  This should match what
+	 * ExecCheckRTEPerms() does.
+	 */
+	rte = exec_rt_fetch(fsplan->scan.scanrelid, estate);
+	user_id = OidIsValid(rte->checkAsUser) ? rte->checkAsUser : GetUserId();
+
+	data_nodes = (List *) list_nth(fsplan->fdw_private, FdwDirectModifyPrivateDataNodes);
+
+	foreach (lc, data_nodes)
+	{
+		ForeignServer *server = GetForeignServer(lfirst_oid(lc));
+		TSConnectionId id = remote_connection_id(server->serverid, user_id);
+
+		if (!ts_data_node_is_available_by_server(server))
+			ereport(ERROR, (errmsg("data node \"%s\" is not available", server->servername)));
+
+		dmstate->conns = lappend(dmstate->conns,
+								 remote_dist_txn_get_connection(id, REMOTE_TXN_NO_PREP_STMT));
+	}
+
+	node->fdw_state = dmstate;
+}
+
+/*
+ * Send the statement to all the data nodes of the chunk and count the
+ * modified rows. Like for the row-by-row modifications, we only count the
+ * rows of the first replica that answers.
+ */
+static void
+execute_direct_modify(TsFdwDirectModifyState *dmstate)
+{
+	AsyncRequestSet *reqset = async_request_set_create();
+	AsyncResponseResult *rsp;
+	ListCell *lc;
+
+	foreach (lc, dmstate->conns)
+		async_request_set_add_sql(reqset, lfirst(lc), dmstate->query);
+
+	while ((rsp = async_request_set_wait_ok_result(reqset)))
+	{
+		PGresult *res = async_response_result_get_pg_result(rsp);
+
+		if (dmstate->num_tuples == -1)
+			dmstate->num_tuples = pg_strtoint64(PQcmdTuples(res));
+
+		async_response_result_close(rsp);
+	}
+
+	pfree(reqset);
+}
+
+TupleTableSlot *
+fdw_iterate_direct_modify(ForeignScanState *node)
+{
+	TsFdwDirectModifyState *dmstate = (TsFdwDirectModifyState *) node->fdw_state;
+	EState *estate = node->ss.ps.state;
+	Instrumentation *instr = node->ss.ps.instrument;
+
+	/* There is no RETURNING, so the statement produces no tuples */
+	if (dmstate->num_tuples == -1)
+	{
+		execute_direct_modify(dmstate);
+
+		/* Increment the command es_processed count if necessary. */
+		if (dmstate->set_processed)
+			estate->es_processed += dmstate->num_tuples;
+
+		/* Increment the tuple count for EXPLAIN ANALYZE if necessary. */
+		if (instr)
+			instr->tuplecount += dmstate->num_tuples;
+	}
+
+	return ExecClearTuple(node->ss.ss_ScanTupleSlot);
+}
+
+void
+fdw_end_direct_modify(ForeignScanState *node)
+{
+	TsFdwDirectModifyState *dmstate = (TsFdwDirectModifyState *) node->fdw_state;
+
+	/* if dmstate is NULL, we are in EXPLAIN; nothing to do */
+	if (dmstate == NULL)
+		return;
+
+	/* The connections are owned by the distributed transaction */
+	list_free(dmstate->conns);
+	dmstate->conns = NIL;
+}
+
+void
+fdw_explain_direct_modify(ForeignScanState *node, ExplainState *es)
+{
+	ForeignScan *fsplan = (ForeignScan *) node->ss.ps.plan;
+
+	if (es->verbose)
+	{
+		const char *sql = strVal(list_nth(fsplan->fdw_private, FdwDirectModifyPrivateUpdateSql));
+
+		ExplainPropertyText("Remote SQL", sql, es);
+	}
+}
+#endif
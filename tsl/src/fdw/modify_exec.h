@@ -12,6 +12,8 @@
 #include <nodes/plannodes.h>
 #include <nodes/execnodes.h>
 
+#include <compat/compat.h>
+
 typedef struct TsFdwModifyState TsFdwModifyState;
 
 typedef enum ModifyCommand
@@ -33,4 +35,11 @@ extern void fdw_finish_foreign_modify(TsFdwModifyState *fmstate);
 extern void fdw_explain_modify(PlanState *ps, ResultRelInfo *rri, List *fdw_private,
 							   int subplan_index, ExplainState *es);
 
+#if PG14_GE
+extern void fdw_begin_direct_modify(ForeignScanState *node, int eflags);
+extern TupleTableSlot *fdw_iterate_direct_modify(ForeignScanState *node);
+extern void fdw_end_direct_modify(ForeignScanState *node);
+extern void fdw_explain_direct_modify(ForeignScanState *node, ExplainState *es);
+#endif
+
 #endif /* TIMESCALEDB_TSL_FDW_MODIFY_EXEC_H */
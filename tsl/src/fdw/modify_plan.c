@@ -6,12 +6,18 @@
 #include <postgres.h>
 #include <parser/parsetree.h>
 #include <access/sysattr.h>
+#include <optimizer/appendinfo.h>
+#include <optimizer/optimizer.h>
+#include <optimizer/pathnode.h>
 #include <utils/rel.h>
 
 #include <chunk.h>
+#include <compat/compat.h>
+#include <guc.h>
 #include "deparse.h"
 #include "errors.h"
 #include "modify_plan.h"
+#include "relinfo.h"
 #include "ts_catalog/chunk_data_node.h"
 
 static List *
@@ -218,3 +224,185 @@ fdw_plan_foreign_modify(PlannerInfo *root, ModifyTable *plan, Index result_relat
 					  retrieved_attrs,
 					  data_nodes);
 }
+
+#if PG14_GE
+/*
+ * Find the ForeignScan of the result relation in the subplan of a
+ * ModifyTable.
+ *
+ * Like postgres_fdw, we support the cases where the ForeignScan is the
+ * immediate child of the ModifyTable, or the subplan_index'th child of an
+ * Append (possibly below a Result computing the new values) that is. Anything
+ * deeper involves local joins, so the statement cannot be sent as is.
+ */
+static ForeignScan *
+find_modifytable_subplan(ModifyTable *plan, Index rtindex, int subplan_index)
+{
+	Plan *subplan = outerPlan(plan);
+
+	if (IsA(subplan, Result) && outerPlan(subplan) != NULL && IsA(outerPlan(subplan), Append))
+		subplan = outerPlan(subplan);
+
+	if (IsA(subplan, Append))
+	{
+		Append *appendplan = castNode(Append, subplan);
+
+		if (subplan_index < list_length(appendplan->appendplans))
+			subplan = list_nth(appendplan->appendplans, subplan_index);
+	}
+
+	if (IsA(subplan, ForeignScan))
+	{
+		ForeignScan *fscan = castNode(ForeignScan, subplan);
+
+		if (bms_is_member(rtindex, fscan->fs_relids))
+			return fscan;
+	}
+
+	return NULL;
+}
+
+/*
+ * Plan a direct UPDATE or DELETE of a chunk.
+ *
+ * UPDATEs and DELETEs normally fetch the rows of each chunk to the access
+ * node and modify them one at a time with a prepared statement, which costs
+ * a round trip per row. If the new values and the WHERE clause can be
+ * evaluated on the data nodes and there is no RETURNING clause, we instead
+ * turn the ForeignScan of the chunk into a ForeignScan that sends a single
+ * UPDATE or DELETE of the chunk to its data nodes.
+ *
+ * We only do this when all the data nodes of the chunk are available, since
+ * the row-by-row path is the one that marks the replicas on unavailable data
+ * nodes as stale.
+ */
+bool
+fdw_plan_direct_modify(PlannerInfo *root, ModifyTable *plan, Index result_relation,
+					   int subplan_index)
+{
+	CmdType operation = plan->operation;
+	RangeTblEntry *rte = planner_rt_fetch(result_relation, root);
+	RelOptInfo *foreignrel;
+	TsFdwRelInfo *fpinfo;
+	ForeignScan *fscan;
+	Relation rel;
+	StringInfoData sql;
+	List *processed_tlist = NIL;
+	List *target_attrs = NIL;
+	List *params_list = NIL;
+	List *data_nodes;
+	int32 chunk_id;
+	ListCell *lc, *lc2;
+
+	if (!ts_guc_enable_remote_direct_modify)
+		return false;
+
+	if (operation != CMD_UPDATE && operation != CMD_DELETE)
+		return false;
+
+	/* RETURNING would need the modified rows sent back */
+	if (plan->returningLists != NIL)
+		return false;
+
+	fscan = find_modifytable_subplan(plan, result_relation, subplan_index);
+
+	/*
+	 * The scan must be on the chunk alone, with all its conditions evaluated
+	 * on the data node and no parameters from the outer query.
+	 */
+	if (fscan == NULL || fscan->scan.scanrelid != result_relation ||
+		fscan->scan.plan.qual != NIL || fscan->fdw_exprs != NIL)
+		return false;
+
+	foreignrel = find_base_rel(root, result_relation);
+
+	if (foreignrel->fdw_private == NULL)
+		return false;
+
+	fpinfo = fdw_relinfo_get(foreignrel);
+
+	if (fpinfo == NULL || fpinfo->type != TS_FDW_RELINFO_FOREIGN_TABLE)
+		return false;
+
+	/* Standalone foreign tables are left to the row-by-row path */
+	if (ts_chunk_get_hypertable_id_by_reloid(rte->relid) == INVALID_HYPERTABLE_ID)
+		return false;
+
+	chunk_id = ts_chunk_get_id_by_relid(rte->relid);
+	data_nodes = get_chunk_data_nodes(rte->relid);
+
+	if (list_length(data_nodes) !=
+		list_length(ts_chunk_data_node_scan_by_chunk_id(chunk_id, CurrentMemoryContext)))
+		return false;
+
+	if (operation == CMD_UPDATE)
+	{
+		get_translated_update_targetlist(root, result_relation, &processed_tlist, &target_attrs);
+
+		forboth (lc, processed_tlist, lc2, target_attrs)
+		{
+			TargetEntry *tle = lfirst_node(TargetEntry, lc);
+			AttrNumber attno = lfirst_int(lc2);
+
+			/* update's new-value expressions shouldn't be resjunk */
+			Assert(!tle->resjunk);
+
+			if (attno <= InvalidAttrNumber) /* shouldn't happen */
+				elog(ERROR, "system-column update is not supported");
+
+			/*
+			 * Stable functions, like now(), would be evaluated separately on
+			 * each replica, so leave those to the row-by-row path.
+			 */
+			if (!ts_is_foreign_expr(root, foreignrel, (Expr *) tle->expr) ||
+				contain_mutable_functions((Node *) tle->expr))
+				return false;
+		}
+	}
+
+	/*
+	 * Core code already has some lock on each rel being planned, so we can
+	 * use NoLock here.
+	 */
+	rel = table_open(rte->relid, NoLock);
+
+	initStringInfo(&sql);
+
+	if (operation == CMD_UPDATE)
+		deparseDirectUpdateSql(&sql,
+							   root,
+							   result_relation,
+							   rel,
+							   foreignrel,
+							   processed_tlist,
+							   target_attrs,
+							   fpinfo->final_remote_exprs,
+							   &params_list);
+	else
+		deparseDirectDeleteSql(&sql,
+							   root,
+							   result_relation,
+							   rel,
+							   foreignrel,
+							   fpinfo->final_remote_exprs,
+							   &params_list);
+
+	table_close(rel, NoLock);
+
+	/* Expressions from outer queries would have to be sent as parameters */
+	if (params_list != NIL)
+		return false;
+
+	fscan->operation = operation;
+	fscan->resultRelation = result_relation;
+
+	/*
+	 * Items in the list must match enum FdwDirectModifyPrivateIndex in
+	 * modify_exec.c.
+	 */
+	fscan->fdw_private =
+		list_make3(makeString(sql.data), data_nodes, makeInteger(plan->canSetTag));
+
+	return true;
+}
+#endif
@@ -8,8 +8,14 @@
 
 #include <postgres.h>
 
+#include <compat/compat.h>
+
 extern List *fdw_plan_foreign_modify(PlannerInfo *root, ModifyTable *plan, Index result_relation,
 									 int subplan_index);
+#if PG14_GE
+extern bool fdw_plan_direct_modify(PlannerInfo *root, ModifyTable *plan, Index result_relation,
+								   int subplan_index);
+#endif
 extern List *get_chunk_data_nodes(Oid relid);
 
 #endif /* TIMESCALEDB_TSL_FDW_MODIFY_PLAN_H */
@@ -32,6 +32,7 @@
 #include "option.h"
 #include "relinfo.h"
 #include "remote/connection.h"
+#include "remote/data_fetcher.h"
 #include "scan_exec.h"
 #include "planner.h"
 
@@ -94,6 +95,30 @@ apply_fdw_and_server_options(TsFdwRelInfo *fpinfo)
 	}
 }
 
+/*
+ * Estimate the startup cost of a scan on the data node from the observed
+ * times of the previous scans. The startup time of a scan relative to the
+ * time per row gives the startup cost in units of the tuple cost. The
+ * startup cost is only calibrated if it is not set with an option.
+ */
+static void
+calibrate_startup_cost(TsFdwRelInfo *fpinfo)
+{
+	double startup_ms;
+	double row_ms;
+	double startup_cost;
+
+	if (!ts_guc_enable_remote_cost_calibration ||
+		fpinfo->fdw_startup_cost != DEFAULT_FDW_STARTUP_COST ||
+		!data_fetcher_get_node_stats(fpinfo->server->servername, &startup_ms, &row_ms))
+		return;
+
+	startup_cost = fpinfo->fdw_tuple_cost * startup_ms / row_ms;
+	startup_cost = Max(startup_cost, fpinfo->fdw_tuple_cost);
+	startup_cost = Min(startup_cost, DEFAULT_FDW_STARTUP_COST * 10);
+	fpinfo->fdw_startup_cost = startup_cost;
+}
+
 TsFdwRelInfo *
 fdw_relinfo_get(RelOptInfo *rel)
 {
@@ -442,6 +467,7 @@ fdw_relinfo_create(PlannerInfo *root, RelOptInfo *rel, Oid server_oid, Oid local
 	{
 		fpinfo->server = GetForeignServer(server_oid);
 		apply_fdw_and_server_options(fpinfo);
+		calibrate_startup_cost(fpinfo);
 	}
 
 	/*
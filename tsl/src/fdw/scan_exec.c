@@ -153,6 +153,7 @@ create_data_fetcher(ScanState *ss, TsFdwScanState *fsstate)
 	}
 
 	fsstate->fetcher = fetcher;
+	fetcher->stats.enabled = ss->ps.instrument != NULL && ts_guc_enable_remote_explain_timing;
 	MemoryContextSwitchTo(oldcontext);
 
 	fetcher->funcs->set_fetch_size(fetcher, fsstate->fetch_size);
@@ -248,6 +249,7 @@ fdw_scan_init(ScanState *ss, TsFdwScanState *fsstate, Bitmapset *scanrelids, Lis
 	int num_params;
 	Oid server_oid;
 	ForeignServer *server;
+	instr_time start;
 
 	if ((eflags & EXEC_FLAG_EXPLAIN_ONLY) && !ts_guc_enable_remote_explain)
 		return;
@@ -262,7 +264,10 @@ fdw_scan_init(ScanState *ss, TsFdwScanState *fsstate, Bitmapset *scanrelids, Lis
 	 * Get connection to the foreign server.  Connection manager will
 	 * establish new connection if necessary.
 	 */
+	INSTR_TIME_SET_CURRENT(start);
 	fsstate->conn = get_connection(ss, server_oid, scanrelids, fdw_exprs);
+	INSTR_TIME_SET_CURRENT(fsstate->connection_time);
+	INSTR_TIME_SUBTRACT(fsstate->connection_time, start);
 
 	/* Get private info created by planner functions. */
 	fsstate->query = strVal(list_nth(fdw_private, FdwScanPrivateSelectSql));
@@ -496,6 +501,40 @@ explain_fetcher_type(DataFetcherType type)
 	}
 }
 
+/*
+ * Show where the time of the scan went: getting the connection, waiting for
+ * the first batch, and fetching all batches, of which converting the rows is
+ * the part spent on the access node.
+ */
+static void
+explain_fetcher_stats(TsFdwScanState *fsstate, ExplainState *es)
+{
+	const DataFetcherStats *stats = &fsstate->fetcher->stats;
+
+	if (es->timing)
+	{
+		ExplainPropertyFloat("Connection Time",
+							 "ms",
+							 INSTR_TIME_GET_MILLISEC(fsstate->connection_time),
+							 3,
+							 es);
+		ExplainPropertyFloat("First Batch Time",
+							 "ms",
+							 INSTR_TIME_GET_MILLISEC(stats->first_batch_time),
+							 3,
+							 es);
+		ExplainPropertyFloat("Fetch Time", "ms", INSTR_TIME_GET_MILLISEC(stats->fetch_time), 3, es);
+		ExplainPropertyFloat("Conversion Time",
+							 "ms",
+							 INSTR_TIME_GET_MILLISEC(stats->conversion_time),
+							 3,
+							 es);
+	}
+
+	ExplainPropertyInteger("Batches", NULL, stats->batches, es);
+	ExplainPropertyInteger("Bytes Received", "bytes", stats->bytes, es);
+}
+
 void
 fdw_scan_explain(ScanState *ss, List *fdw_private, ExplainState *es, TsFdwScanState *fsstate)
 {
@@ -527,6 +566,9 @@ fdw_scan_explain(ScanState *ss, List *fdw_private, ExplainState *es, TsFdwScanSt
 		if (fsstate && fsstate->fetcher)
 			ExplainPropertyText("Fetcher Type", explain_fetcher_type(fsstate->fetcher->type), es);
 
+		if (es->analyze && fsstate && fsstate->fetcher && fsstate->fetcher->stats.enabled)
+			explain_fetcher_stats(fsstate, es);
+
 		if (chunk_oids != NIL)
 		{
 			StringInfoData chunk_names;
@@ -50,6 +50,7 @@ typedef struct TsFdwScanState
 	 */
 	DataFetcherType planned_fetcher_type;
 	int row_counter;
+	instr_time connection_time; /* time to get the connection, for EXPLAIN ANALYZE */
 } TsFdwScanState;
 
 extern void fdw_scan_init(ScanState *ss, TsFdwScanState *fsstate, Bitmapset *scanrelids,
@@ -12,12 +12,16 @@
 #include "bgw_policy/retention_api.h"
 #include "bgw_policy/job.h"
 #include "bgw_policy/job_api.h"
+#include "bgw_policy/maintenance_api.h"
 #include "bgw_policy/reorder_api.h"
 #include "bgw_policy/policies_v2.h"
 #include "chunk.h"
 #include "chunk_api.h"
+#include "compression/advisor.h"
+#include "compression/analyze.h"
 #include "compression/api.h"
 #include "compression/array.h"
+#include "compression/arrow_ipc.h"
 #include "compression/compression.h"
 #include "compression/create.h"
 #include "compression/deltadelta.h"
@@ -41,7 +45,9 @@
 #include "hypertable.h"
 #include "license_guc.h"
 #include "nodes/decompress_chunk/planner.h"
+#include "nodes/runtime_filter/plan.h"
 #include "nodes/skip_scan/skip_scan.h"
+#include "nodes/vector_agg/plan.h"
 #include "nodes/gapfill/gapfill_functions.h"
 #include "partialize_finalize.h"
 #include "planner.h"
@@ -95,12 +101,19 @@ CrossModuleFunctions tsl_cm_functions = {
 	.create_upper_paths_hook = tsl_create_upper_paths_hook,
 	.set_rel_pathlist_dml = tsl_set_rel_pathlist_dml,
 	.set_rel_pathlist_query = tsl_set_rel_pathlist_query,
+	.tsl_postprocess_plan = tsl_postprocess_plan,
 
 	/* bgw policies */
 	.policy_compression_add = policy_compression_add,
 	.policy_compression_remove = policy_compression_remove,
 	.policy_recompression_proc = policy_recompression_proc,
 	.policy_compression_check = policy_compression_check,
+	.policy_compression_parallel = policy_compression_parallel,
+	.policy_compression_worker_run = policy_compression_worker_run,
+	.policy_maintenance_add = policy_maintenance_add,
+	.policy_maintenance_proc = policy_maintenance_proc,
+	.policy_maintenance_check = policy_maintenance_check,
+	.policy_maintenance_remove = policy_maintenance_remove,
 	.policy_refresh_cagg_add = policy_refresh_cagg_add,
 	.policy_refresh_cagg_proc = policy_refresh_cagg_proc,
 	.policy_refresh_cagg_check = policy_refresh_cagg_check,
@@ -151,6 +164,7 @@ CrossModuleFunctions tsl_cm_functions = {
 	.process_cagg_viewstmt = tsl_process_continuous_agg_viewstmt,
 	.continuous_agg_invalidation_trigger = continuous_agg_trigfn,
 	.continuous_agg_call_invalidation_trigger = execute_cagg_trigger,
+	.continuous_agg_invalidate_range = continuous_agg_invalidate_range,
 	.continuous_agg_refresh = continuous_agg_refresh,
 	.continuous_agg_invalidate_raw_ht = continuous_agg_invalidate_raw_ht,
 	.continuous_agg_invalidate_mat_ht = continuous_agg_invalidate_mat_ht,
@@ -179,12 +193,18 @@ CrossModuleFunctions tsl_cm_functions = {
 	.dictionary_compressor_finish = tsl_dictionary_compressor_finish,
 	.array_compressor_append = tsl_array_compressor_append,
 	.array_compressor_finish = tsl_array_compressor_finish,
+	.bloom1_contains = tsl_bloom1_contains,
 	.process_compress_table = tsl_process_compress_table,
 	.process_altertable_cmd = tsl_process_altertable_cmd,
 	.process_rename_cmd = tsl_process_rename_cmd,
+	.process_create_index = tsl_process_create_index,
+	.analyze_compressed_chunk = tsl_analyze_compressed_chunk,
 	.compress_chunk = tsl_compress_chunk,
 	.decompress_chunk = tsl_decompress_chunk,
+	.compression_advisor = tsl_compression_advisor,
+	.export_chunk_arrow_ipc = tsl_export_chunk_arrow_ipc,
 	.decompress_batches_for_insert = decompress_batches_for_insert,
+	.compress_tuples_for_insert = compress_tuples_for_insert,
 #if PG14_GE
 	.decompress_target_segments = decompress_target_segments,
 #else
@@ -207,6 +227,7 @@ CrossModuleFunctions tsl_cm_functions = {
 	.chunk_drop_replica = chunk_drop_replica,
 	.chunk_freeze_chunk = chunk_freeze_chunk,
 	.chunk_unfreeze_chunk = chunk_unfreeze_chunk,
+	.chunk_merge_chunks = chunk_merge_chunks,
 	.chunks_drop_stale = chunk_drop_stale_chunks,
 	.hypertable_make_distributed = hypertable_make_distributed,
 	.get_and_validate_data_node_list = hypertable_get_and_validate_data_nodes,
@@ -270,6 +291,8 @@ ts_module_init(PG_FUNCTION_ARGS)
 	_continuous_aggs_cache_inval_init();
 	_decompress_chunk_init();
 	_skip_scan_init();
+	_vector_agg_init();
+	_runtime_filter_init();
 	_remote_connection_cache_init();
 	_remote_dist_txn_init();
 	_tsl_process_utility_init();
@@ -14,6 +14,8 @@
 #include <foreign/fdwapi.h>
 #include <access/sysattr.h>
 #include <miscadmin.h>
+#include <pgstat.h>
+#include <storage/latch.h>
 
 #include "async_append.h"
 #include "fdw/scan_plan.h"
@@ -21,6 +23,7 @@
 #include "fdw/data_node_scan_plan.h"
 #include "planner.h"
 #include "cache.h"
+#include "guc.h"
 #include "hypertable.h"
 #include "hypertable_cache.h"
 #include "utils.h"
@@ -102,11 +105,13 @@
  * (throwing away existing and generating new paths), we needed to adjust plan
  * paths at a later stage, thus using upper path hooks to do that.
  *
- * There are ways asynchronous appends can be further improved. For instance,
- * after sending the initial queries to all nodes, the append node should pick
- * the child to read based on which data node returns data first instead of
- * just picking the first child.
- *
+ * When no ordering is required (the child is an Append) and the
+ * timescaledb.enable_async_append_ready_first setting is on, AsyncAppend
+ * executes the DataNodeScans directly instead of through the Append, and
+ * reads from whichever data node has data ready instead of reading the data
+ * nodes in order. This way a slow data node does not block reading the data
+ * that the other data nodes have already returned. Since the Append is
+ * bypassed, EXPLAIN ANALYZE does not show any rows for it in this mode.
  */
 
 /* Plan state node for AsyncAppend plan */
@@ -116,12 +121,18 @@ typedef struct AsyncAppendState
 	PlanState *subplan_state; /* AppendState or MergeAppendState */
 	List *data_node_scans;	  /* DataNodeScan states */
 	bool first_run;
+	bool ready_first;			  /* read from the first data node with data ready */
+	List *pending_scans;		  /* DataNodeScans that are not done yet */
+	AsyncScanState *current_scan; /* DataNodeScan we are reading from */
+	bool track_idle_time;
+	instr_time idle_time; /* time spent waiting for data nodes, for EXPLAIN ANALYZE */
 } AsyncAppendState;
 
 static TupleTableSlot *async_append_exec(CustomScanState *node);
 static void async_append_begin(CustomScanState *node, EState *estate, int eflags);
 static void async_append_end(CustomScanState *node);
 static void async_append_rescan(CustomScanState *node);
+static void async_append_explain(CustomScanState *node, List *ancestors, ExplainState *es);
 
 static CustomExecMethods async_append_state_methods = {
 	.CustomName = "AsyncAppendState",
@@ -129,6 +140,7 @@ static CustomExecMethods async_append_state_methods = {
 	.EndCustomScan = async_append_end,
 	.ExecCustomScan = async_append_exec,
 	.ReScanCustomScan = async_append_rescan,
+	.ExplainCustomScan = async_append_explain,
 };
 
 static Node *
@@ -140,6 +152,9 @@ async_append_state_create(CustomScan *cscan)
 	state->subplan_state = NULL;
 	state->css.methods = &async_append_state_methods;
 	state->first_run = true;
+	state->ready_first = false;
+	state->pending_scans = NIL;
+	state->current_scan = NULL;
 
 	return (Node *) state;
 }
@@ -205,6 +220,34 @@ get_data_node_async_scan_states(AsyncAppendState *state)
 	return dn_plans;
 }
 
+/*
+ * Check if the data node scans can be executed in the order the data arrives
+ * in. This requires an Append without run-time pruning and with DataNodeScans
+ * as direct children, so that bypassing the Append does not change the result.
+ */
+static bool
+can_read_ready_first(AsyncAppendState *state)
+{
+	AppendState *astate;
+	int i;
+
+	if (!ts_guc_enable_async_append_ready_first || !IsA(state->subplan_state, AppendState))
+		return false;
+
+	astate = castNode(AppendState, state->subplan_state);
+
+	if (astate->as_prune_state != NULL || astate->ps.plan->parallel_aware)
+		return false;
+
+	for (i = 0; i < astate->as_nplans; i++)
+	{
+		if (astate->appendplans[i] != list_nth(state->data_node_scans, i))
+			return false;
+	}
+
+	return true;
+}
+
 static void
 async_append_begin(CustomScanState *node, EState *estate, int eflags)
 {
@@ -221,6 +264,10 @@ async_append_begin(CustomScanState *node, EState *estate, int eflags)
 	state->subplan_state = subplan_state;
 	state->css.custom_ps = list_make1(state->subplan_state);
 	state->data_node_scans = get_data_node_async_scan_states(state);
+	state->ready_first = can_read_ready_first(state);
+	/* The node's instrumentation is only allocated after this callback */
+	state->track_idle_time =
+		(estate->es_instrument & INSTRUMENT_TIMER) != 0 && ts_guc_enable_remote_explain_timing;
 }
 
 static void
@@ -253,12 +300,102 @@ fetch_data(AsyncScanState *ass)
 	ass->fetch_data(ass);
 }
 
+/*
+ * Wait until one of the pending data node scans has data ready and return it.
+ * The current scan is preferred to avoid switching between data nodes when
+ * several have data ready.
+ */
+static AsyncScanState *
+wait_for_ready_scan(AsyncAppendState *state)
+{
+	WaitEventSet *we_set;
+	WaitEvent event;
+	List *sockets;
+	ListCell *lc;
+	instr_time start;
+	instr_time end;
+
+	for (;;)
+	{
+		if (state->current_scan != NULL && state->current_scan->data_ready(state->current_scan))
+			return state->current_scan;
+
+		foreach (lc, state->pending_scans)
+		{
+			AsyncScanState *ass = lfirst(lc);
+
+			if (ass != state->current_scan && ass->data_ready(ass))
+				return ass;
+		}
+
+		we_set = CreateWaitEventSet(CurrentMemoryContext, list_length(state->pending_scans) + 1);
+		AddWaitEventToSet(we_set, WL_LATCH_SET, PGINVALID_SOCKET, (Latch *) MyLatch, NULL);
+		sockets = NIL;
+
+		foreach (lc, state->pending_scans)
+		{
+			AsyncScanState *ass = lfirst(lc);
+			pgsocket sock = ass->get_socket(ass);
+
+			/* Scans on the same data node share the connection */
+			if (list_member_int(sockets, sock))
+				continue;
+
+			sockets = lappend_int(sockets, sock);
+			AddWaitEventToSet(we_set, WL_SOCKET_READABLE, sock, NULL, ass);
+		}
+
+		if (state->track_idle_time)
+			INSTR_TIME_SET_CURRENT(start);
+
+		(void) WaitEventSetWait(we_set, -1L, &event, 1, PG_WAIT_EXTENSION);
+		FreeWaitEventSet(we_set);
+
+		if (state->track_idle_time)
+		{
+			INSTR_TIME_SET_CURRENT(end);
+			INSTR_TIME_ACCUM_DIFF(state->idle_time, end, start);
+		}
+		list_free(sockets);
+
+		if (event.events & WL_LATCH_SET)
+			ResetLatch(MyLatch);
+
+		CHECK_FOR_INTERRUPTS();
+	}
+}
+
+/*
+ * Get the next tuple from whichever data node scan has data ready.
+ */
+static TupleTableSlot *
+exec_ready_first(AsyncAppendState *state)
+{
+	TupleTableSlot *slot;
+
+	while (state->pending_scans != NIL)
+	{
+		state->current_scan = wait_for_ready_scan(state);
+		slot = ExecProcNode(&state->current_scan->css.ss.ps);
+
+		if (!TupIsNull(slot))
+			return slot;
+
+		state->pending_scans = list_delete_ptr(state->pending_scans, state->current_scan);
+		state->current_scan = NULL;
+	}
+
+	return NULL;
+}
+
 static TupleTableSlot *
 async_append_exec(CustomScanState *node)
 {
 	TupleTableSlot *slot;
 	AsyncAppendState *state = (AsyncAppendState *) node;
 	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	instr_time start;
+	instr_time end;
 
 	Assert(state->subplan_state != NULL);
 	Assert(state->data_node_scans != NIL);
@@ -270,12 +407,29 @@ async_append_exec(CustomScanState *node)
 		iterate_data_nodes_and_exec(state, send_fetch_request);
 		/* Fetch a new data batch into all sub-nodes. This will clear the
 		 * connection for new requests (important when there are, e.g.,
-		 * subqueries that share the connection). */
+		 * subqueries that share the connection). This waits for the slowest
+		 * data node to return its first batch. */
+		if (state->track_idle_time)
+			INSTR_TIME_SET_CURRENT(start);
+
 		iterate_data_nodes_and_exec(state, fetch_data);
+
+		if (state->track_idle_time)
+		{
+			INSTR_TIME_SET_CURRENT(end);
+			INSTR_TIME_ACCUM_DIFF(state->idle_time, end, start);
+		}
+
+		if (state->ready_first)
+			state->pending_scans = list_copy(state->data_node_scans);
 	}
 
 	ResetExprContext(econtext);
-	slot = ExecProcNode(state->subplan_state);
+
+	if (state->ready_first)
+		slot = exec_ready_first(state);
+	else
+		slot = ExecProcNode(state->subplan_state);
 	econtext->ecxt_scantuple = slot;
 
 	if (!TupIsNull(slot))
@@ -296,6 +450,24 @@ async_append_end(CustomScanState *node)
 	ExecEndNode(state->subplan_state);
 }
 
+/*
+ * Show the time spent waiting for the first batches of all data nodes, and
+ * waiting for any data node to have data ready, which is the time the access
+ * node was idle because of the slowest data nodes.
+ */
+static void
+async_append_explain(CustomScanState *node, List *ancestors, ExplainState *es)
+{
+	AsyncAppendState *state = (AsyncAppendState *) node;
+
+	if (es->analyze && es->timing && state->track_idle_time)
+		ExplainPropertyFloat("Data Node Wait Time",
+							 "ms",
+							 INSTR_TIME_GET_MILLISEC(state->idle_time),
+							 3,
+							 es);
+}
+
 static void
 async_append_rescan(CustomScanState *node)
 {
@@ -305,6 +477,13 @@ async_append_rescan(CustomScanState *node)
 		UpdateChangedParamSet(state->subplan_state, node->ss.ps.chgParam);
 
 	ExecReScan(state->subplan_state);
+
+	if (state->ready_first && !state->first_run)
+	{
+		list_free(state->pending_scans);
+		state->pending_scans = list_copy(state->data_node_scans);
+		state->current_scan = NULL;
+	}
 }
 
 static Plan *
@@ -30,6 +30,10 @@ typedef struct AsyncScanState
 	void (*send_fetch_request)(struct AsyncScanState *state);
 	/* Fetch the actual data */
 	void (*fetch_data)(struct AsyncScanState *state);
+	/* Check if the next tuple can be returned without waiting */
+	bool (*data_ready)(struct AsyncScanState *state);
+	/* Get the socket to wait on for data */
+	pgsocket (*get_socket)(struct AsyncScanState *state);
 } AsyncScanState;
 
 extern void async_append_add_paths(PlannerInfo *root, RelOptInfo *final_rel);
@@ -204,6 +204,13 @@ enum CustomScanPrivateIndex
  * statement, since the number of rows do not match, and therefore a one-time
  * statement is created for the last insert.
  *
+ * When a data node reaches the predefined size, the data nodes that have at
+ * least half a batch are flushed along with it, using one-time statements. It
+ * costs the data node a parse of the statement, but with rows spread evenly
+ * over the data nodes, they all fill up at about the same time, and this
+ * sends all their batches in one round trip instead of one round trip per
+ * data node.
+ *
  * Note that, since we use one DataNodeState per connection, we
  * could technically have multiple DataNodeStates per data node.
  */
@@ -521,33 +528,25 @@ send_batch_to_data_node(DataNodeDispatchState *sds, DataNodeState *ss)
 		response_type = FORMAT_BINARY;
 
 	/* Send tuples */
-	switch (sds->state)
+	if (ss->num_tuples_sent == sds->flush_threshold)
 	{
-		case SD_FLUSH:
-			/* Lazy initialize the prepared statement */
-			if (NULL == ss->pstmt)
-				ss->pstmt =
-					prepare_data_node_insert_stmt(sds,
-												  ss->conn,
-												  stmt_params_total_values(sds->stmt_params));
-
-			Assert(ss->num_tuples_sent == sds->flush_threshold);
-			req = async_request_send_prepared_stmt_with_params(ss->pstmt,
-															   sds->stmt_params,
-															   response_type);
-			break;
-		case SD_LAST_FLUSH:
-			sql_stmt = deparsed_insert_stmt_get_sql(&sds->stmt,
-													stmt_params_converted_tuples(sds->stmt_params));
-			Assert(sql_stmt != NULL);
-			Assert(ss->num_tuples_sent < sds->flush_threshold);
-			req =
-				async_request_send_with_params(ss->conn, sql_stmt, sds->stmt_params, response_type);
-			break;
-		default:
-			elog(ERROR, "unexpected data node dispatch state %s", state_names[sds->state]);
-			Assert(false);
-			break;
+		/* Lazy initialize the prepared statement */
+		if (NULL == ss->pstmt)
+			ss->pstmt = prepare_data_node_insert_stmt(sds,
+													  ss->conn,
+													  stmt_params_total_values(sds->stmt_params));
+
+		req = async_request_send_prepared_stmt_with_params(ss->pstmt,
+														   sds->stmt_params,
+														   response_type);
+	}
+	else
+	{
+		sql_stmt = deparsed_insert_stmt_get_sql(&sds->stmt,
+												stmt_params_converted_tuples(sds->stmt_params));
+		Assert(sql_stmt != NULL);
+		Assert(ss->num_tuples_sent < sds->flush_threshold);
+		req = async_request_send_with_params(ss->conn, sql_stmt, sds->stmt_params, response_type);
 	}
 
 	Assert(NULL != req);
@@ -578,7 +577,8 @@ send_batch_to_data_node(DataNodeDispatchState *sds, DataNodeState *ss)
  *
  * There are two cases when this happens:
  *
- * 1. State is SD_FLUSH and the flush threshold is reached.
+ * 1. State is SD_FLUSH and at least half the flush threshold is reached. The
+ *    state is SD_FLUSH when some data node reached the full threshold.
  * 2. State is SD_LAST_FLUSH and there are tuples to send.
  */
 static bool
@@ -588,14 +588,13 @@ should_flush_data_node(DataNodeDispatchState *sds, DataNodeState *ss)
 
 	Assert(sds->state == SD_FLUSH || sds->state == SD_LAST_FLUSH);
 
-	if (sds->state == SD_FLUSH)
-	{
-		if (num_tuples >= sds->flush_threshold)
-			return true;
+	if (num_tuples == 0)
 		return false;
-	}
 
-	return num_tuples > 0;
+	if (sds->state == SD_FLUSH)
+		return num_tuples >= (sds->flush_threshold + 1) / 2;
+
+	return true;
 }
 
 /*
@@ -6,6 +6,7 @@
 
 #include <postgres.h>
 #include <nodes/bitmapset.h>
+#include <utils/memutils.h>
 
 #include "compression/compression.h"
 #include "nodes/decompress_chunk/batch_array.h"
@@ -43,10 +44,14 @@ batch_array_destroy(DecompressChunkState *chunk_state)
 
 		if (batch_state->decompressed_scan_slot != NULL)
 			ExecDropSingleTupleTableSlot(batch_state->decompressed_scan_slot);
+
+		if (batch_state->arena.buffer != NULL)
+			pfree(batch_state->arena.buffer);
 	}
 
 	pfree(chunk_state->batch_states);
 	chunk_state->batch_states = NULL;
+	chunk_state->batch_memory_bytes = 0;
 }
 
 /*
@@ -99,12 +104,37 @@ batch_array_free_at(DecompressChunkState *chunk_state, int batch_index)
 		ExecClearTuple(batch_state->compressed_slot);
 		ExecClearTuple(batch_state->decompressed_scan_slot);
 		MemoryContextReset(batch_state->per_batch_context);
+		decompression_arena_reset(&batch_state->arena);
+		batch_array_update_memory(chunk_state, batch_state);
 	}
 
 	chunk_state->unused_batch_states =
 		bms_add_member(chunk_state->unused_batch_states, batch_index);
 }
 
+/*
+ * Update the memory accounting of the given batch state after it was filled
+ * or reset. The unused batch states are accounted as well, because they keep
+ * their arena and the first block of their memory context. This is not done
+ * for every row, so the lazily decompressed columns are accounted only when
+ * the batch is filled through compressed_batch_save_first_tuple().
+ */
+void
+batch_array_update_memory(DecompressChunkState *chunk_state, DecompressBatchState *batch_state)
+{
+	if (batch_state->per_batch_context == NULL)
+		return;
+
+	const int64 bytes = MemoryContextMemAllocated(batch_state->per_batch_context, true) +
+						batch_state->arena.capacity;
+
+	chunk_state->batch_memory_bytes += bytes - batch_state->memory_bytes;
+	batch_state->memory_bytes = bytes;
+
+	if (chunk_state->batch_memory_bytes > chunk_state->instrumentation.peak_batch_memory_bytes)
+		chunk_state->instrumentation.peak_batch_memory_bytes = chunk_state->batch_memory_bytes;
+}
+
 /*
  * Get the next free and unused batch state and mark as used
  */
@@ -35,3 +35,6 @@ batch_array_get_at(DecompressChunkState *chunk_state, int batch_index)
 }
 
 extern void batch_array_free_at(DecompressChunkState *chunk_state, int batch_index);
+
+extern void batch_array_update_memory(DecompressChunkState *chunk_state,
+									  DecompressBatchState *batch_state);
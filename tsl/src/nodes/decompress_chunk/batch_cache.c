@@ -0,0 +1,330 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * A backend-local LRU cache of the bulk-decompressed compressed columns. The
+ * repeated queries over the same recent compressed data, e.g. the dashboards
+ * that refresh every few seconds, otherwise decompress the same batches over
+ * and over again. The cache is disabled by default, and its size is set by
+ * the timescaledb.decompressed_batch_cache_size GUC.
+ */
+#include <postgres.h>
+
+#include <access/htup_details.h>
+#include <lib/ilist.h>
+#include <utils/hsearch.h>
+#include <utils/inval.h>
+#include <utils/memutils.h>
+
+#include "guc.h"
+#include "nodes/decompress_chunk/batch_cache.h"
+
+typedef struct DecompressedBatchCacheEntry
+{
+	DecompressedBatchCacheKey key;
+	dlist_node lru_node;
+	/* Allocated as a single chunk in the cache memory context. */
+	ArrowArray *arrow;
+	int value_bytes;
+	Size size;
+} DecompressedBatchCacheEntry;
+
+static HTAB *batch_cache = NULL;
+static MemoryContext batch_cache_context = NULL;
+/* The most recently used entries are at the head. */
+static dlist_head batch_cache_lru = DLIST_STATIC_INIT(batch_cache_lru);
+static Size batch_cache_bytes = 0;
+
+static void
+batch_cache_remove_entry(DecompressedBatchCacheEntry *entry)
+{
+	dlist_delete(&entry->lru_node);
+	batch_cache_bytes -= entry->size;
+	pfree(entry->arrow);
+	hash_search(batch_cache, &entry->key, HASH_REMOVE, NULL);
+}
+
+/*
+ * Evict the least recently used entries until the given number of bytes fits
+ * into the configured cache size.
+ */
+static void
+batch_cache_evict(Size needed_bytes)
+{
+	const Size limit = (Size) ts_guc_decompressed_batch_cache_size * 1024;
+	while (!dlist_is_empty(&batch_cache_lru) && batch_cache_bytes + needed_bytes > limit)
+	{
+		DecompressedBatchCacheEntry *entry =
+			dlist_tail_element(DecompressedBatchCacheEntry, lru_node, &batch_cache_lru);
+		batch_cache_remove_entry(entry);
+	}
+}
+
+static void
+batch_cache_relcache_callback(Datum arg, Oid relid)
+{
+	if (batch_cache == NULL || dlist_is_empty(&batch_cache_lru))
+	{
+		return;
+	}
+
+	dlist_mutable_iter iter;
+	dlist_foreach_modify(iter, &batch_cache_lru)
+	{
+		DecompressedBatchCacheEntry *entry =
+			dlist_container(DecompressedBatchCacheEntry, lru_node, iter.cur);
+		if (relid == InvalidOid || entry->key.relid == relid)
+		{
+			batch_cache_remove_entry(entry);
+		}
+	}
+}
+
+static void
+batch_cache_init(void)
+{
+	if (batch_cache != NULL)
+	{
+		return;
+	}
+
+	batch_cache_context =
+		AllocSetContextCreate(TopMemoryContext, "decompressed batch cache", ALLOCSET_DEFAULT_SIZES);
+
+	HASHCTL ctl = {
+		.keysize = sizeof(DecompressedBatchCacheKey),
+		.entrysize = sizeof(DecompressedBatchCacheEntry),
+		.hcxt = batch_cache_context,
+	};
+	batch_cache = hash_create("decompressed batch cache",
+							  /* nelem = */ 1024,
+							  &ctl,
+							  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	CacheRegisterRelcacheCallback(batch_cache_relcache_callback, PointerGetDatum(NULL));
+}
+
+/*
+ * Fill the cache key for the given column of the compressed tuple. Returns
+ * false when the slot doesn't hold a heap tuple with a valid identity, e.g.
+ * when it comes from a sort, so the results cannot be cached.
+ */
+bool
+decompressed_batch_cache_key_init(DecompressedBatchCacheKey *key, TupleTableSlot *compressed_slot,
+								  AttrNumber attno)
+{
+	if (ts_guc_decompressed_batch_cache_size <= 0)
+	{
+		/* Release the memory if the cache was disabled after use. */
+		if (batch_cache_bytes > 0)
+		{
+			batch_cache_evict(0);
+		}
+		return false;
+	}
+
+	if (!TTS_IS_HEAPTUPLE(compressed_slot) && !TTS_IS_BUFFERTUPLE(compressed_slot))
+	{
+		return false;
+	}
+
+	HeapTuple tuple = ((HeapTupleTableSlot *) compressed_slot)->tuple;
+	if (tuple == NULL || !OidIsValid(compressed_slot->tts_tableOid) ||
+		!ItemPointerIsValid(&tuple->t_self) ||
+		!TransactionIdIsNormal(HeapTupleHeaderGetRawXmin(tuple->t_data)))
+	{
+		return false;
+	}
+
+	/* The key is hashed as a blob, so clear the padding. */
+	memset(key, 0, sizeof(*key));
+	key->relid = compressed_slot->tts_tableOid;
+	ItemPointerCopy(&tuple->t_self, &key->tid);
+	key->xmin = HeapTupleHeaderGetRawXmin(tuple->t_data);
+	key->cid = HeapTupleHeaderGetRawCommandId(tuple->t_data);
+	key->attno = attno;
+	return true;
+}
+
+/*
+ * The number of bytes of the buffer with the given number of fixed-width
+ * elements, with the same padding as the bulk decompression uses, so that
+ * the vectorized code can work on whole 64-byte blocks and read past the end.
+ */
+static Size
+padded_buffer_bytes(int64 length, int element_bytes)
+{
+	return ((length + 63) / 64 + 1) * 64 * element_bytes + 8;
+}
+
+static Size
+validity_bytes(int64 length)
+{
+	return ((length + 63) / 64) * sizeof(uint64);
+}
+
+static Size
+arrow_copy_size(const ArrowArray *arrow, int value_bytes)
+{
+	Size size = MAXALIGN(sizeof(ArrowArray) + sizeof(void *) * arrow->n_buffers);
+
+	if (arrow->buffers[0] != NULL)
+	{
+		size += MAXALIGN(validity_bytes(arrow->length));
+	}
+
+	if (value_bytes > 0)
+	{
+		size += MAXALIGN(padded_buffer_bytes(arrow->length, value_bytes));
+	}
+	else if (arrow->dictionary != NULL)
+	{
+		size += MAXALIGN(padded_buffer_bytes(arrow->length, sizeof(int16)));
+		size += arrow_copy_size(arrow->dictionary, value_bytes);
+	}
+	else
+	{
+		const uint32 *offsets = arrow->buffers[1];
+		size += MAXALIGN(sizeof(uint32) * (arrow->length + 1));
+		size += MAXALIGN(offsets[arrow->length] + 8);
+	}
+
+	return size;
+}
+
+static void *
+copy_buffer(char **dest, const void *src, Size src_bytes, Size dest_bytes)
+{
+	void *result = *dest;
+	memcpy(result, src, src_bytes);
+	memset((char *) result + src_bytes, 0, dest_bytes - src_bytes);
+	*dest += MAXALIGN(dest_bytes);
+	return result;
+}
+
+/*
+ * Deep-copy the decompressed column into the given memory of the size
+ * computed by arrow_copy_size().
+ */
+static ArrowArray *
+arrow_copy(const ArrowArray *src, int value_bytes, char **dest)
+{
+	ArrowArray *result = (ArrowArray *) *dest;
+	const void **buffers = (const void **) &result[1];
+	*dest += MAXALIGN(sizeof(ArrowArray) + sizeof(void *) * src->n_buffers);
+
+	*result = *src;
+	result->buffers = buffers;
+	result->dictionary = NULL;
+	result->release = NULL;
+	result->private_data = NULL;
+
+	buffers[0] = NULL;
+	if (src->buffers[0] != NULL)
+	{
+		const Size bytes = validity_bytes(src->length);
+		buffers[0] = copy_buffer(dest, src->buffers[0], bytes, bytes);
+	}
+
+	if (value_bytes > 0)
+	{
+		buffers[1] = copy_buffer(dest,
+								 src->buffers[1],
+								 src->length * value_bytes,
+								 padded_buffer_bytes(src->length, value_bytes));
+	}
+	else if (src->dictionary != NULL)
+	{
+		buffers[1] = copy_buffer(dest,
+								 src->buffers[1],
+								 src->length * sizeof(int16),
+								 padded_buffer_bytes(src->length, sizeof(int16)));
+		result->dictionary = arrow_copy(src->dictionary, value_bytes, dest);
+	}
+	else
+	{
+		const uint32 *offsets = src->buffers[1];
+		const Size offsets_bytes = sizeof(uint32) * (src->length + 1);
+		buffers[1] = copy_buffer(dest, offsets, offsets_bytes, offsets_bytes);
+		buffers[2] = copy_buffer(dest,
+								 src->buffers[2],
+								 offsets[src->length],
+								 offsets[src->length] + 8);
+	}
+
+	return result;
+}
+
+/*
+ * Look up the decompressed column in the cache, and copy it into the batch
+ * arena if found. Returns NULL on cache miss.
+ */
+ArrowArray *
+decompressed_batch_cache_get(const DecompressedBatchCacheKey *key, int value_bytes,
+							 DecompressionArena *dest)
+{
+	if (batch_cache == NULL)
+	{
+		return NULL;
+	}
+
+	/* The cache size might have been decreased since the last use. */
+	batch_cache_evict(0);
+
+	DecompressedBatchCacheEntry *entry = hash_search(batch_cache, key, HASH_FIND, NULL);
+	if (entry == NULL)
+	{
+		return NULL;
+	}
+
+	Assert(entry->value_bytes == value_bytes);
+	dlist_move_head(&batch_cache_lru, &entry->lru_node);
+
+	char *memory = decompression_arena_alloc(dest, entry->size);
+	return arrow_copy(entry->arrow, value_bytes, &memory);
+}
+
+/*
+ * Store a copy of the decompressed column in the cache, evicting the least
+ * recently used entries as needed.
+ */
+void
+decompressed_batch_cache_put(const DecompressedBatchCacheKey *key, const ArrowArray *arrow,
+							 int value_bytes)
+{
+	const Size limit = (Size) ts_guc_decompressed_batch_cache_size * 1024;
+	const Size size = arrow_copy_size(arrow, value_bytes);
+
+	/*
+	 * Don't let a single batch push out a large part of the cache, this
+	 * would make it useless for the scans that don't fit into it anyway.
+	 */
+	if (size > limit / 4)
+	{
+		return;
+	}
+
+	batch_cache_init();
+
+	DecompressedBatchCacheEntry *entry = hash_search(batch_cache, key, HASH_FIND, NULL);
+	if (entry != NULL)
+	{
+		dlist_move_head(&batch_cache_lru, &entry->lru_node);
+		return;
+	}
+
+	char *memory = MemoryContextAlloc(batch_cache_context, size);
+	ArrowArray *copy = arrow_copy(arrow, value_bytes, &memory);
+
+	batch_cache_evict(size);
+
+	entry = hash_search(batch_cache, key, HASH_ENTER, NULL);
+	entry->arrow = copy;
+	entry->value_bytes = value_bytes;
+	entry->size = size;
+	dlist_push_head(&batch_cache_lru, &entry->lru_node);
+	batch_cache_bytes += size;
+}
@@ -0,0 +1,37 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#pragma once
+
+#include <postgres.h>
+#include <executor/tuptable.h>
+#include <storage/itemptr.h>
+
+#include "compression/arrow_c_data_interface.h"
+#include "compression/compression.h"
+
+/*
+ * The results of bulk decompression for a compressed column of a particular
+ * version of a compressed tuple. The tuple is identified by its relation,
+ * ctid and xmin, so that any update of the compressed tuple produces a
+ * different key. The entries of a relation are also dropped on its relcache
+ * invalidation, which covers TRUNCATE and the rewrites that reuse the ctids.
+ */
+typedef struct DecompressedBatchCacheKey
+{
+	Oid relid;
+	ItemPointerData tid;
+	TransactionId xmin;
+	CommandId cid;
+	AttrNumber attno;
+} DecompressedBatchCacheKey;
+
+extern bool decompressed_batch_cache_key_init(DecompressedBatchCacheKey *key,
+											  TupleTableSlot *compressed_slot, AttrNumber attno);
+extern ArrowArray *decompressed_batch_cache_get(const DecompressedBatchCacheKey *key,
+												int value_bytes, DecompressionArena *dest);
+extern void decompressed_batch_cache_put(const DecompressedBatchCacheKey *key,
+										 const ArrowArray *arrow, int value_bytes);
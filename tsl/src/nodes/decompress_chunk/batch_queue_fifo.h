@@ -49,6 +49,7 @@ batch_queue_fifo_push_batch(DecompressChunkState *chunk_state, TupleTableSlot *c
 	Assert(TupIsNull(batch_array_get_at(chunk_state, 0)->decompressed_scan_slot));
 	compressed_batch_set_compressed_tuple(chunk_state, batch_state, compressed_slot);
 	compressed_batch_advance(chunk_state, batch_state);
+	batch_array_update_memory(chunk_state, batch_state);
 }
 
 inline static void
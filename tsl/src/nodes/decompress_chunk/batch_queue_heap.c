@@ -5,10 +5,14 @@
  */
 
 #include <postgres.h>
+#include <executor/executor.h>
 #include <nodes/bitmapset.h>
 #include <lib/binaryheap.h>
+#include <miscadmin.h>
+#include <utils/tuplesort.h>
 
 #include "compression/compression.h"
+#include "guc.h"
 #include "nodes/decompress_chunk/batch_array.h"
 #include "nodes/decompress_chunk/batch_queue_heap.h"
 #include "nodes/decompress_chunk/exec.h"
@@ -90,9 +94,154 @@ binaryheap_add_unordered_autoresize(binaryheap *heap, Datum d)
 	return heap;
 }
 
+/*
+ * Put the next tuple from the fallback sort into the output slot.
+ */
+static void
+batch_queue_heap_fallback_next(DecompressChunkState *chunk_state)
+{
+	if (tuplesort_gettupleslot(chunk_state->merge_fallback_sort,
+							   /* forward = */ true,
+							   /* copy = */ false,
+							   chunk_state->merge_fallback_sort_slot,
+							   NULL))
+	{
+		/* The scan slot is virtual, copy the tuple so that our parents get that. */
+		ExecCopySlot(chunk_state->merge_fallback_slot, chunk_state->merge_fallback_sort_slot);
+	}
+	else
+	{
+		ExecClearTuple(chunk_state->merge_fallback_slot);
+	}
+}
+
+/*
+ * Fall back to sorting when the open batches use more memory than allowed by
+ * timescaledb.decompression_sorted_merge_memory. The batches arrive in the
+ * order of their first tuple, so with a lot of overlapping batches, e.g. for
+ * many segmentby values, the number of open batches is not bounded. Put the
+ * remaining tuples of the open batches and the rest of the input into a
+ * tuplesort, which can spill to disk, and return the tuples from there.
+ */
+static void
+batch_queue_heap_start_fallback(DecompressChunkState *chunk_state)
+{
+	TupleTableSlot *scan_slot = chunk_state->csstate.ss.ss_ScanTupleSlot;
+	PlanState *child = linitial(chunk_state->csstate.custom_ps);
+	List *sort_ops = lsecond(chunk_state->sortinfo);
+	const int n_keys = chunk_state->n_sortkeys;
+	AttrNumber *sort_keys = palloc(sizeof(AttrNumber) * n_keys);
+	Oid *sort_operators = palloc(sizeof(Oid) * n_keys);
+	Oid *sort_collations = palloc(sizeof(Oid) * n_keys);
+	bool *nulls_first = palloc(sizeof(bool) * n_keys);
+
+	for (int i = 0; i < n_keys; i++)
+	{
+		sort_keys[i] = chunk_state->sortkeys[i].ssup_attno;
+		sort_operators[i] = list_nth_oid(sort_ops, i);
+		sort_collations[i] = chunk_state->sortkeys[i].ssup_collation;
+		nulls_first[i] = chunk_state->sortkeys[i].ssup_nulls_first;
+	}
+
+	elog(DEBUG1,
+		 "batch sorted merge uses " INT64_FORMAT " bytes of memory, falling back to sort",
+		 chunk_state->batch_memory_bytes);
+	chunk_state->instrumentation.sorted_merge_fallbacks++;
+
+	chunk_state->merge_fallback_sort = tuplesort_begin_heap(scan_slot->tts_tupleDescriptor,
+															n_keys,
+															sort_keys,
+															sort_operators,
+															sort_collations,
+															nulls_first,
+															work_mem,
+															NULL,
+															false /*=randomAccess*/);
+
+	/* The tuples of the open batches that we haven't returned yet. */
+	for (int i = 0; i < chunk_state->merge_heap->bh_size; i++)
+	{
+		const int batch_index = DatumGetInt32(chunk_state->merge_heap->bh_nodes[i]);
+		DecompressBatchState *batch_state = batch_array_get_at(chunk_state, batch_index);
+
+		while (!TupIsNull(batch_state->decompressed_scan_slot))
+		{
+			tuplesort_puttupleslot(chunk_state->merge_fallback_sort,
+								   batch_state->decompressed_scan_slot);
+			compressed_batch_advance(chunk_state, batch_state);
+		}
+
+		batch_array_free_at(chunk_state, batch_index);
+	}
+	binaryheap_reset(chunk_state->merge_heap);
+
+	/* The lookahead batch and the rest of the input, one batch at a time. */
+	const int batch_index = batch_array_get_free_slot(chunk_state);
+	DecompressBatchState *batch_state = batch_array_get_at(chunk_state, batch_index);
+	TupleTableSlot *compressed_slot = chunk_state->lookahead_compressed_slot;
+	if (TupIsNull(compressed_slot))
+		compressed_slot = ExecProcNode(child);
+
+	while (!TupIsNull(compressed_slot))
+	{
+		compressed_batch_set_compressed_tuple(chunk_state, batch_state, compressed_slot);
+		compressed_batch_advance(chunk_state, batch_state);
+		while (!TupIsNull(batch_state->decompressed_scan_slot))
+		{
+			tuplesort_puttupleslot(chunk_state->merge_fallback_sort,
+								   batch_state->decompressed_scan_slot);
+			compressed_batch_advance(chunk_state, batch_state);
+		}
+
+		if (compressed_slot == chunk_state->lookahead_compressed_slot)
+			ExecClearTuple(compressed_slot);
+
+		compressed_slot = ExecProcNode(child);
+	}
+	batch_array_free_at(chunk_state, batch_index);
+
+	tuplesort_performsort(chunk_state->merge_fallback_sort);
+
+	if (chunk_state->merge_fallback_slot == NULL)
+	{
+		chunk_state->merge_fallback_sort_slot =
+			MakeSingleTupleTableSlot(scan_slot->tts_tupleDescriptor, &TTSOpsMinimalTuple);
+		chunk_state->merge_fallback_slot =
+			MakeSingleTupleTableSlot(scan_slot->tts_tupleDescriptor, scan_slot->tts_ops);
+	}
+
+	batch_queue_heap_fallback_next(chunk_state);
+
+	pfree(sort_keys);
+	pfree(sort_operators);
+	pfree(sort_collations);
+	pfree(nulls_first);
+}
+
+/*
+ * Stop the fallback sort, for a rescan or at the end of the execution.
+ */
+static void
+batch_queue_heap_end_fallback(DecompressChunkState *chunk_state)
+{
+	if (chunk_state->merge_fallback_sort == NULL)
+		return;
+
+	tuplesort_end(chunk_state->merge_fallback_sort);
+	chunk_state->merge_fallback_sort = NULL;
+	ExecClearTuple(chunk_state->merge_fallback_sort_slot);
+	ExecClearTuple(chunk_state->merge_fallback_slot);
+}
+
 void
 batch_queue_heap_pop(DecompressChunkState *chunk_state)
 {
+	if (chunk_state->merge_fallback_sort != NULL)
+	{
+		batch_queue_heap_fallback_next(chunk_state);
+		return;
+	}
+
 	if (binaryheap_empty(chunk_state->merge_heap))
 	{
 		/* Allow this function to be called on the initial empty heap. */
@@ -117,9 +266,90 @@ batch_queue_heap_pop(DecompressChunkState *chunk_state)
 	}
 }
 
+/*
+ * Decompress the given compressed tuple and put the batch on the heap.
+ */
+static void
+batch_queue_heap_open_batch(DecompressChunkState *chunk_state, TupleTableSlot *compressed_slot)
+{
+	const int new_batch_index = batch_array_get_free_slot(chunk_state);
+	DecompressBatchState *batch_state = batch_array_get_at(chunk_state, new_batch_index);
+
+	compressed_batch_set_compressed_tuple(chunk_state, batch_state, compressed_slot);
+	compressed_batch_save_first_tuple(chunk_state,
+									  batch_state,
+									  chunk_state->last_batch_first_tuple);
+	batch_array_update_memory(chunk_state, batch_state);
+
+	if (TupIsNull(batch_state->decompressed_scan_slot))
+	{
+		/* Might happen if there are no tuples in the batch that pass the quals. */
+		batch_array_free_at(chunk_state, new_batch_index);
+		return;
+	}
+
+	chunk_state->merge_heap =
+		binaryheap_add_unordered_autoresize(chunk_state->merge_heap, new_batch_index);
+}
+
+/*
+ * Check whether the current top tuple sorts strictly before any tuple of the
+ * lookahead compressed batch, using the min or max metadata of the first sort
+ * key of this batch.
+ */
+static bool
+top_tuple_precedes_lookahead(DecompressChunkState *chunk_state, TupleTableSlot *top_tuple)
+{
+	SortSupportData *sortKey = &chunk_state->sortkeys[0];
+
+	bool top_isnull, bound_isnull;
+	Datum top_value = slot_getattr(top_tuple, sortKey->ssup_attno, &top_isnull);
+	Datum bound_value = slot_getattr(chunk_state->lookahead_compressed_slot,
+									 chunk_state->batch_sort_meta_attno,
+									 &bound_isnull);
+
+	return ApplySortComparator(top_value, top_isnull, bound_value, bound_isnull, sortKey) < 0;
+}
+
 bool
 batch_queue_heap_needs_next_batch(DecompressChunkState *chunk_state)
 {
+	if (chunk_state->merge_fallback_sort != NULL)
+	{
+		/* The fallback sort has already read all the input. */
+		return false;
+	}
+
+	if (ts_guc_decompression_sorted_merge_memory > 0 &&
+		chunk_state->batch_memory_bytes > (int64) ts_guc_decompression_sorted_merge_memory * 1024)
+	{
+		batch_queue_heap_start_fallback(chunk_state);
+		return false;
+	}
+
+	if (!TupIsNull(chunk_state->lookahead_compressed_slot))
+	{
+		/*
+		 * The incoming batches arrive in the order of their metadata, so if the
+		 * top tuple sorts before the lookahead batch, it also sorts before all
+		 * the batches after it, and we don't have to decompress anything.
+		 * Otherwise, put the lookahead batch on the heap, and continue with
+		 * the usual check below.
+		 */
+		if (!binaryheap_empty(chunk_state->merge_heap))
+		{
+			const int top_batch_index = DatumGetInt32(binaryheap_first(chunk_state->merge_heap));
+			DecompressBatchState *top_batch = batch_array_get_at(chunk_state, top_batch_index);
+			if (top_tuple_precedes_lookahead(chunk_state, top_batch->decompressed_scan_slot))
+			{
+				return false;
+			}
+		}
+
+		batch_queue_heap_open_batch(chunk_state, chunk_state->lookahead_compressed_slot);
+		ExecClearTuple(chunk_state->lookahead_compressed_slot);
+	}
+
 	if (binaryheap_empty(chunk_state->merge_heap))
 	{
 		return true;
@@ -152,28 +382,39 @@ batch_queue_heap_push_batch(DecompressChunkState *chunk_state, TupleTableSlot *c
 {
 	Assert(!TupIsNull(compressed_slot));
 
-	const int new_batch_index = batch_array_get_free_slot(chunk_state);
-	DecompressBatchState *batch_state = batch_array_get_at(chunk_state, new_batch_index);
+	/*
+	 * When the metadata of the first sort key is a bound for all tuples of the
+	 * batch, don't decompress the batch right away. For LIMIT queries, this
+	 * saves decompressing the last batch we read, which often can't contain
+	 * any of the tuples we return.
+	 */
+	if (chunk_state->batch_sort_meta_attno != InvalidAttrNumber)
+	{
+		Assert(TupIsNull(chunk_state->lookahead_compressed_slot));
 
-	compressed_batch_set_compressed_tuple(chunk_state, batch_state, compressed_slot);
-	compressed_batch_save_first_tuple(chunk_state,
-									  batch_state,
-									  chunk_state->last_batch_first_tuple);
+		if (chunk_state->lookahead_compressed_slot == NULL)
+		{
+			chunk_state->lookahead_compressed_slot =
+				MakeSingleTupleTableSlot(compressed_slot->tts_tupleDescriptor,
+										 compressed_slot->tts_ops);
+		}
 
-	if (TupIsNull(batch_state->decompressed_scan_slot))
-	{
-		/* Might happen if there are no tuples in the batch that pass the quals. */
-		batch_array_free_at(chunk_state, new_batch_index);
+		ExecCopySlot(chunk_state->lookahead_compressed_slot, compressed_slot);
 		return;
 	}
 
-	chunk_state->merge_heap =
-		binaryheap_add_unordered_autoresize(chunk_state->merge_heap, new_batch_index);
+	batch_queue_heap_open_batch(chunk_state, compressed_slot);
 }
 
 TupleTableSlot *
 batch_queue_heap_top_tuple(DecompressChunkState *chunk_state)
 {
+	if (chunk_state->merge_fallback_sort != NULL)
+	{
+		return TupIsNull(chunk_state->merge_fallback_slot) ? NULL :
+															 chunk_state->merge_fallback_slot;
+	}
+
 	if (binaryheap_empty(chunk_state->merge_heap))
 	{
 		return NULL;
@@ -203,7 +444,11 @@ batch_queue_heap_create(DecompressChunkState *chunk_state)
 void
 batch_queue_heap_reset(DecompressChunkState *chunk_state)
 {
+	batch_queue_heap_end_fallback(chunk_state);
 	binaryheap_reset(chunk_state->merge_heap);
+
+	if (chunk_state->lookahead_compressed_slot != NULL)
+		ExecClearTuple(chunk_state->lookahead_compressed_slot);
 }
 
 /*
@@ -218,5 +463,20 @@ batch_queue_heap_free(DecompressChunkState *chunk_state)
 	chunk_state->merge_heap = NULL;
 	ExecDropSingleTupleTableSlot(chunk_state->last_batch_first_tuple);
 
+	batch_queue_heap_end_fallback(chunk_state);
+	if (chunk_state->merge_fallback_slot != NULL)
+	{
+		ExecDropSingleTupleTableSlot(chunk_state->merge_fallback_sort_slot);
+		ExecDropSingleTupleTableSlot(chunk_state->merge_fallback_slot);
+		chunk_state->merge_fallback_sort_slot = NULL;
+		chunk_state->merge_fallback_slot = NULL;
+	}
+
+	if (chunk_state->lookahead_compressed_slot != NULL)
+	{
+		ExecDropSingleTupleTableSlot(chunk_state->lookahead_compressed_slot);
+		chunk_state->lookahead_compressed_slot = NULL;
+	}
+
 	batch_array_destroy(chunk_state);
 }
@@ -6,17 +6,605 @@
 
 #include <postgres.h>
 
+#include <access/detoast.h>
+#include <access/genam.h>
+#include <access/table.h>
+#include <access/toast_internals.h>
+#include <executor/instrument.h>
 #include <nodes/bitmapset.h>
+#include <port/pg_bitutils.h>
+#include <storage/bufmgr.h>
+#include <utils/array.h>
 #include <utils/builtins.h>
 #include <utils/date.h>
+#include <utils/fmgroids.h>
+#include <utils/lsyscache.h>
+#include <utils/spccache.h>
 #include <utils/timestamp.h>
 
 #include "compression/arrow_c_data_interface.h"
 #include "compression/compression.h"
 #include "debug_assert.h"
 #include "guc.h"
+#include "nodes/decompress_chunk/batch_cache.h"
 #include "nodes/decompress_chunk/compressed_batch.h"
 #include "nodes/decompress_chunk/exec.h"
+#include "nodes/decompress_chunk/vector_predicates.h"
+#include "nodes/runtime_filter/exec.h"
+
+/*
+ * The per-item qual results for the dictionary of a compressed column. The
+ * dictionaries are usually small, so this avoids a palloc for every batch.
+ */
+#define VEC_PREFIX bool
+#define VEC_ELEMENT_TYPE bool
+#define VEC_INLINE_CAPACITY 64
+#define VEC_DECLARE 1
+#define VEC_DEFINE 1
+#define VEC_SCOPE static inline
+#include <adts/vec.h>
+
+/*
+ * Prepare the state for evaluating a vectorized qual on single values. This is
+ * done once per qual at executor startup, see
+ * DecompressChunkState.vectorized_qual_states.
+ */
+void
+compressed_batch_init_scalar_qual(ScalarQualState *state, Node *qual)
+{
+	if (IsA(qual, OpExpr))
+	{
+		OpExpr *opexpr = castNode(OpExpr, qual);
+		fmgr_info(opexpr->opfuncid, &state->flinfo);
+		state->collation = opexpr->inputcollid;
+		state->constvalue = lsecond_node(Const, opexpr->args)->constvalue;
+		state->is_array_op = false;
+		return;
+	}
+
+	ScalarArrayOpExpr *saop = castNode(ScalarArrayOpExpr, qual);
+	fmgr_info(saop->opfuncid, &state->flinfo);
+	state->collation = saop->inputcollid;
+	state->is_array_op = true;
+	state->use_or = saop->useOr;
+
+	ArrayType *array = DatumGetArrayTypeP(lsecond_node(Const, saop->args)->constvalue);
+	int16 typlen;
+	bool typbyval;
+	char typalign;
+	get_typlenbyvalalign(ARR_ELEMTYPE(array), &typlen, &typbyval, &typalign);
+	deconstruct_array(array,
+					  ARR_ELEMTYPE(array),
+					  typlen,
+					  typbyval,
+					  typalign,
+					  &state->elements,
+					  &state->element_nulls,
+					  &state->num_elements);
+}
+
+/*
+ * Evaluate the qual on a single not-null value. The functions are strict, so
+ * we don't have to call them for the null array elements. For ANY, a null
+ * element means the result is either true or null, and for ALL, it is either
+ * false or null, and both null and false don't pass the filter.
+ */
+static bool
+scalar_qual_check(ScalarQualState *state, Datum value)
+{
+	if (!state->is_array_op)
+	{
+		return DatumGetBool(
+			FunctionCall2Coll(&state->flinfo, state->collation, value, state->constvalue));
+	}
+
+	for (int i = 0; i < state->num_elements; i++)
+	{
+		if (state->element_nulls[i])
+		{
+			if (!state->use_or)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const bool element_result = DatumGetBool(
+			FunctionCall2Coll(&state->flinfo, state->collation, value, state->elements[i]));
+		if (element_result == state->use_or)
+		{
+			return element_result;
+		}
+	}
+
+	return !state->use_or;
+}
+
+/*
+ * Compute a vectorized qual on a varlena column. For the dictionary-encoded
+ * columns, we evaluate the qual once for each dictionary item, and then use
+ * the dictionary indices to compute the result for the rows. This way, we
+ * don't have to build the datums for the rows at all.
+ */
+static void
+compute_varlena_qual(ScalarQualState *state, const CompressedColumnValues *column_values,
+					 int n_rows, uint64 *restrict result)
+{
+	const ArrowArray *arrow = column_values->arrow;
+	const Datum *datums = column_values->arrow_varlena_datums;
+	Assert(datums != NULL);
+
+	if (arrow->dictionary != NULL)
+	{
+		const int n_items = arrow->dictionary->length;
+		bool_vec item_passes_vec;
+		bool_vec_init(&item_passes_vec, CurrentMemoryContext, n_items);
+		bool *restrict item_passes = bool_vec_append_zeros(&item_passes_vec, n_items);
+		for (int i = 0; i < n_items; i++)
+		{
+			item_passes[i] = scalar_qual_check(state, datums[i]);
+		}
+
+		const int16 *restrict indices = (const int16 *) arrow->buffers[1];
+		for (int outer = 0; outer < n_rows; outer += 64)
+		{
+			uint64 word = 0;
+			const int inner_end = Min(64, n_rows - outer);
+			for (int inner = 0; inner < inner_end; inner++)
+			{
+				word |= ((uint64) item_passes[indices[outer + inner]]) << inner;
+			}
+			result[outer / 64] &= word;
+		}
+
+		bool_vec_free_data(&item_passes_vec);
+		return;
+	}
+
+	const uint64 *restrict validity = (const uint64 *) column_values->arrow_validity;
+	for (int row = 0; row < n_rows; row++)
+	{
+		if (!arrow_row_is_valid(result, row) || !arrow_row_is_valid(validity, row))
+		{
+			continue;
+		}
+
+		if (!scalar_qual_check(state, datums[row]))
+		{
+			arrow_set_row_validity(result, row, false);
+		}
+	}
+}
+
+/*
+ * Compute the vectorized filters. Fills batch_state->vector_qual_result with
+ * a bitmap of the rows that pass all the vectorized quals. The bitmap is in the
+ * order of the Arrow arrays, i.e. it doesn't account for the reverse scan
+ * direction. Returns the number of rows that pass.
+ */
+static int
+compute_vector_quals(DecompressChunkState *chunk_state, DecompressBatchState *batch_state)
+{
+	Assert(chunk_state->vectorized_quals != NIL);
+	Assert(batch_state->total_batch_rows > 0);
+
+	const size_t n_words = (batch_state->total_batch_rows + 63) / 64;
+	uint64 *restrict result = palloc(sizeof(uint64) * n_words);
+	memset(result, 0xFF, sizeof(uint64) * n_words);
+
+	if (batch_state->total_batch_rows % 64 != 0)
+	{
+		/*
+		 * The bitmap size is a multiple of 64 bits. Clear the tail bits, because
+		 * the corresponding rows don't exist.
+		 */
+		const uint64 tail_mask = -1ULL >> (64 - batch_state->total_batch_rows % 64);
+		result[n_words - 1] &= tail_mask;
+	}
+
+	ListCell *lc;
+	foreach (lc, chunk_state->vectorized_quals)
+	{
+		Node *qual = (Node *) lfirst(lc);
+		ScalarQualState *state = &chunk_state->vectorized_qual_states[foreach_current_index(lc)];
+		List *args = IsA(qual, OpExpr) ? castNode(OpExpr, qual)->args :
+										 castNode(ScalarArrayOpExpr, qual)->args;
+		Var *var = linitial_node(Var, args);
+
+		/* Find the compressed column referenced by the Var. */
+		CompressedColumnValues *column_values = NULL;
+		for (int i = 0; i < chunk_state->num_compressed_columns; i++)
+		{
+			if (batch_state->compressed_columns[i].output_attno == var->varattno)
+			{
+				column_values = &batch_state->compressed_columns[i];
+				break;
+			}
+		}
+		Ensure(column_values != NULL, "decompressed column %d not found in batch", var->varattno);
+
+		if (column_values->arrow == NULL)
+		{
+			/*
+			 * The column has the same default value for the entire batch, so
+			 * we only have to evaluate the predicate once.
+			 */
+			Ensure(column_values->iterator == NULL,
+				   "vectorized qual on a column that is not bulk-decompressed");
+
+			const AttrNumber attr = AttrNumberGetAttrOffset(var->varattno);
+			TupleTableSlot *slot = batch_state->decompressed_scan_slot;
+			bool passed = false;
+			if (!slot->tts_isnull[attr])
+			{
+				passed = scalar_qual_check(state, slot->tts_values[attr]);
+			}
+
+			if (!passed)
+			{
+				memset(result, 0, sizeof(uint64) * n_words);
+			}
+
+			continue;
+		}
+
+		if (column_values->value_bytes == -1)
+		{
+			compute_varlena_qual(state, column_values, batch_state->total_batch_rows, result);
+		}
+		else
+		{
+			OpExpr *opexpr = castNode(OpExpr, qual);
+			Const *constnode = lsecond_node(Const, opexpr->args);
+			VectorPredicate *predicate = get_vector_const_predicate(opexpr->opfuncid);
+			Ensure(predicate != NULL,
+				   "vectorized predicate not found for postgres predicate %d",
+				   opexpr->opfuncid);
+
+			predicate(column_values->arrow, constnode->constvalue, result);
+		}
+
+		/* The predicates are strict, so the null rows don't pass. */
+		const uint64 *restrict validity = (const uint64 *) column_values->arrow_validity;
+		if (validity != NULL)
+		{
+			for (size_t i = 0; i < n_words; i++)
+			{
+				result[i] &= validity[i];
+			}
+		}
+	}
+
+	batch_state->vector_qual_result = result;
+
+	/* Count the passing rows a word at a time. */
+	int n_passed = 0;
+	for (size_t i = 0; i < n_words; i++)
+	{
+		n_passed += pg_popcount64(result[i]);
+	}
+
+	return n_passed;
+}
+
+/*
+ * Issue the read-ahead requests for the TOAST pages of the given compressed
+ * value, if it is stored out of line. We only look up the TIDs in the TOAST
+ * index here, without reading the TOAST table itself.
+ */
+static void
+prefetch_toast_pages(Datum value)
+{
+#ifdef USE_PREFETCH
+	struct varlena *attr = (struct varlena *) DatumGetPointer(value);
+	if (!VARATT_IS_EXTERNAL_ONDISK(attr))
+	{
+		return;
+	}
+
+	struct varatt_external toast_pointer;
+	VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+
+	Relation toastrel = table_open(toast_pointer.va_toastrelid, AccessShareLock);
+	if (get_tablespace_io_concurrency(toastrel->rd_rel->reltablespace) > 0)
+	{
+		Relation *toastidxs;
+		int num_indexes;
+		const int valid_index =
+			toast_open_indexes(toastrel, AccessShareLock, &toastidxs, &num_indexes);
+
+		SnapshotData snapshot_toast;
+		init_toast_snapshot(&snapshot_toast);
+
+		ScanKeyData toastkey;
+		ScanKeyInit(&toastkey,
+					(AttrNumber) 1,
+					BTEqualStrategyNumber,
+					F_OIDEQ,
+					ObjectIdGetDatum(toast_pointer.va_valueid));
+
+		IndexScanDesc scan =
+			index_beginscan(toastrel, toastidxs[valid_index], &snapshot_toast, 1, 0);
+		index_rescan(scan, &toastkey, 1, NULL, 0);
+
+		BlockNumber last_block = InvalidBlockNumber;
+		ItemPointer tid;
+		while ((tid = index_getnext_tid(scan, ForwardScanDirection)) != NULL)
+		{
+			/* The consecutive TOAST chunks are usually on the same page. */
+			const BlockNumber block = ItemPointerGetBlockNumber(tid);
+			if (block != last_block)
+			{
+				PrefetchBuffer(toastrel, MAIN_FORKNUM, block);
+				last_block = block;
+			}
+		}
+
+		index_endscan(scan);
+		toast_close_indexes(toastidxs, num_indexes, AccessShareLock);
+	}
+	table_close(toastrel, AccessShareLock);
+#endif
+}
+
+/*
+ * Prefetch the TOAST pages of the given compressed column of the batch. We do
+ * this for all the columns we are going to decompress before detoasting any of
+ * them, so that the reads for all columns proceed in parallel, instead of
+ * stalling on each column in turn.
+ */
+static void
+prefetch_column(DecompressChunkState *chunk_state, DecompressBatchState *batch_state, int i)
+{
+	DecompressChunkColumnDescription *column_description = &chunk_state->template_columns[i];
+	Assert(column_description->type == COMPRESSED_COLUMN);
+
+	/* We don't read the entire compressed data when we need only some rows. */
+	if (chunk_state->batch_row_limit > 0)
+	{
+		return;
+	}
+
+	bool isnull;
+	Datum value = slot_getattr(batch_state->compressed_slot,
+							   column_description->compressed_scan_attno,
+							   &isnull);
+	if (!isnull)
+	{
+		prefetch_toast_pages(value);
+	}
+}
+
+/*
+ * Decompress the given compressed column of the batch, either in bulk or by
+ * initializing the row-by-row decompression iterator.
+ */
+static void
+decompress_column_internal(DecompressChunkState *chunk_state, DecompressBatchState *batch_state,
+						   int i)
+{
+	DecompressChunkColumnDescription *column_description = &chunk_state->template_columns[i];
+	Assert(column_description->type == COMPRESSED_COLUMN);
+	Assert(i < chunk_state->num_compressed_columns);
+
+	CompressedColumnValues *column_values = &batch_state->compressed_columns[i];
+	Assert(column_values->iterator == NULL);
+	Assert(column_values->arrow == NULL);
+
+	bool isnull;
+	Datum value = slot_getattr(batch_state->compressed_slot,
+							   column_description->compressed_scan_attno,
+							   &isnull);
+	if (isnull)
+	{
+		/*
+		 * The column will have a default value for the entire batch,
+		 * set it now.
+		 */
+		column_values->iterator = NULL;
+		AttrNumber attr = AttrNumberGetAttrOffset(column_description->output_attno);
+
+		batch_state->decompressed_scan_slot->tts_values[attr] =
+			getmissingattr(batch_state->decompressed_scan_slot->tts_tupleDescriptor,
+						   attr + 1,
+						   &batch_state->decompressed_scan_slot->tts_isnull[attr]);
+		return;
+	}
+
+	const int value_bytes = get_typlen(column_description->typid);
+
+	/*
+	 * The recently decompressed batches might be cached, which saves us both
+	 * the detoasting and the decompression. We only cache the entire batches.
+	 */
+	DecompressedBatchCacheKey cache_key;
+	const bool use_batch_cache =
+		chunk_state->batch_row_limit == 0 && chunk_state->enable_bulk_decompression &&
+		column_description->bulk_decompression_supported &&
+		decompressed_batch_cache_key_init(&cache_key,
+										  batch_state->compressed_slot,
+										  column_description->compressed_scan_attno);
+	ArrowArray *arrow = NULL;
+	if (use_batch_cache)
+	{
+		arrow = decompressed_batch_cache_get(&cache_key, value_bytes, &batch_state->arena);
+	}
+
+	/*
+	 * If we need only the first rows of the batch, detoast only the part of
+	 * the compressed data that is required for them, when the compression
+	 * algorithm supports this.
+	 */
+	CompressedDataHeader *header = NULL;
+	if (arrow == NULL)
+	{
+		header = chunk_state->batch_row_limit > 0 ?
+					 (CompressedDataHeader *) DatumGetPointer(
+						 tsl_detoast_compressed_prefix(value, chunk_state->batch_row_limit)) :
+					 (CompressedDataHeader *) PG_DETOAST_DATUM(value);
+		if ((Pointer) header != DatumGetPointer(value))
+		{
+			chunk_state->instrumentation.detoasted_bytes += VARSIZE(header);
+		}
+	}
+
+	/* Decompress the entire batch if it is supported. */
+	if (arrow == NULL && chunk_state->enable_bulk_decompression &&
+		column_description->bulk_decompression_supported)
+	{
+		if (chunk_state->bulk_decompression_context == NULL)
+		{
+			chunk_state->bulk_decompression_context =
+				AllocSetContextCreate(MemoryContextGetParent(batch_state->per_batch_context),
+									  "bulk decompression",
+									  /* minContextSize = */ 0,
+									  /* initBlockSize = */ 64 * 1024,
+									  /* maxBlockSize = */ 64 * 1024);
+		}
+
+		/*
+		 * The particular batch might use a different compression algorithm
+		 * than the default one for this column, e.g. the dictionary
+		 * compression falls back to array compression for high-cardinality
+		 * data, so the bulk decompression might be unavailable.
+		 */
+		DecompressAllFunction decompress_all =
+			tsl_get_decompress_all_function(header->compression_algorithm,
+											column_description->typid);
+		if (decompress_all != NULL)
+		{
+			/* Only measure the time when EXPLAIN ANALYZE needs it. */
+			Instrumentation *instrument = chunk_state->csstate.ss.ps.instrument;
+			const bool need_timer = instrument != NULL && instrument->need_timer;
+			instr_time start_time;
+			if (need_timer)
+			{
+				INSTR_TIME_SET_CURRENT(start_time);
+			}
+
+			MemoryContext context_before_decompression =
+				MemoryContextSwitchTo(chunk_state->bulk_decompression_context);
+
+			arrow = decompress_all(PointerGetDatum(header),
+								   column_description->typid,
+								   &batch_state->arena);
+
+			if (need_timer)
+			{
+				instr_time end_time;
+				INSTR_TIME_SET_CURRENT(end_time);
+				INSTR_TIME_ACCUM_DIFF(chunk_state->instrumentation.bulk_decompression_time,
+									  end_time,
+									  start_time);
+			}
+
+			MemoryContextReset(chunk_state->bulk_decompression_context);
+
+			MemoryContextSwitchTo(context_before_decompression);
+
+			if (use_batch_cache && arrow != NULL)
+			{
+				decompressed_batch_cache_put(&cache_key, arrow, value_bytes);
+			}
+		}
+	}
+
+	if (arrow)
+	{
+		chunk_state->instrumentation.columns_bulk_decompressed++;
+
+		/*
+		 * With the row limit, we might have decompressed only a part of the
+		 * batch, but at least the number of rows we need.
+		 */
+		const int batch_rows = chunk_state->batch_row_limit > 0 ?
+								   Min(arrow->length, chunk_state->batch_row_limit) :
+								   arrow->length;
+		if (batch_state->total_batch_rows == 0)
+		{
+			batch_state->total_batch_rows = batch_rows;
+		}
+		else if (batch_state->total_batch_rows != batch_rows)
+		{
+			elog(ERROR, "compressed column out of sync with batch counter");
+		}
+
+		column_values->arrow = arrow;
+		column_values->arrow_values = arrow->buffers[1];
+		column_values->arrow_validity = arrow->buffers[0];
+
+		column_values->value_bytes = value_bytes;
+
+		if (column_values->value_bytes == -1)
+		{
+			if (arrow->dictionary != NULL)
+			{
+				column_values->arrow_varlena_datums = arrow_make_varlena_datums(arrow->dictionary);
+			}
+			else
+			{
+				column_values->arrow_varlena_datums = arrow_make_varlena_datums(arrow);
+				column_values->arrow_values = NULL;
+			}
+		}
+
+		return;
+	}
+
+	/* As a fallback, decompress row-by-row. */
+	chunk_state->instrumentation.columns_iterator_decompressed++;
+	column_values->iterator =
+		tsl_get_decompression_iterator_init(header->compression_algorithm,
+											chunk_state->reverse)(PointerGetDatum(header),
+																  column_description->typid);
+}
+
+static void
+decompress_column(DecompressChunkState *chunk_state, DecompressBatchState *batch_state, int i)
+{
+	instr_time start;
+
+	ts_node_timing_start(&chunk_state->timing, &start);
+	decompress_column_internal(chunk_state, batch_state, i);
+	ts_node_timing_stop(&chunk_state->timing, DECOMPRESS_CHUNK_TIMING_DECOMPRESSION, &start);
+}
+
+/*
+ * Get the number of rows of the batch from the count column, limited by the
+ * batch row limit.
+ */
+static int
+compressed_batch_get_row_count(DecompressChunkState *chunk_state,
+							   DecompressBatchState *batch_state)
+{
+	for (int i = 0; i < chunk_state->num_total_columns; i++)
+	{
+		DecompressChunkColumnDescription *column_description = &chunk_state->template_columns[i];
+		if (column_description->type != COUNT_COLUMN)
+		{
+			continue;
+		}
+
+		bool isnull;
+		Datum value = slot_getattr(batch_state->compressed_slot,
+								   column_description->compressed_scan_attno,
+								   &isnull);
+		Assert(!isnull);
+		const int count_value = DatumGetInt32(value);
+		if (count_value <= 0)
+		{
+			ereport(ERROR,
+					(errmsg("the compressed data is corrupt: got a segment with length %d",
+							count_value)));
+		}
+
+		return chunk_state->batch_row_limit > 0 ? Min(count_value, chunk_state->batch_row_limit) :
+												  count_value;
+	}
+
+	elog(ERROR, "compressed batch has no count column");
+	pg_unreachable();
+}
 
 void
 compressed_batch_set_compressed_tuple(DecompressChunkState *chunk_state,
@@ -30,19 +618,23 @@ compressed_batch_set_compressed_tuple(DecompressChunkState *chunk_state,
 	 */
 	if (batch_state->per_batch_context == NULL)
 	{
+		batch_state->per_batch_context = AllocSetContextCreate(CurrentMemoryContext,
+															   "DecompressChunk per_batch",
+															   ALLOCSET_DEFAULT_SIZES);
+
 		/*
-		 * We use custom size for the batch memory context page, calculated to
-		 * fit the typical result of bulk decompression (if we use it).
-		 * This allows us to save on expensive malloc/free calls, because the
-		 * Postgres memory contexts reallocate all pages except the first one
-		 * after earch reset.
+		 * The results of bulk decompression go to a preallocated arena which
+		 * is reused for every batch. This allows us to save on expensive
+		 * malloc/free calls, because the Postgres memory contexts allocate
+		 * these big chunks as separate blocks, and free them after each reset.
 		 */
-		batch_state->per_batch_context =
-			AllocSetContextCreate(CurrentMemoryContext,
-								  "DecompressChunk per_batch",
-								  0,
-								  chunk_state->batch_memory_context_bytes,
-								  chunk_state->batch_memory_context_bytes);
+		batch_state->arena.mctx = batch_state->per_batch_context;
+		batch_state->arena.capacity = chunk_state->batch_arena_bytes;
+		batch_state->arena.buffer = batch_state->arena.capacity > 0 ?
+										MemoryContextAlloc(CurrentMemoryContext,
+														   batch_state->arena.capacity) :
+										NULL;
+		batch_state->arena.used = 0;
 
 		Assert(batch_state->compressed_slot == NULL);
 
@@ -86,9 +678,40 @@ compressed_batch_set_compressed_tuple(DecompressChunkState *chunk_state,
 
 	batch_state->total_batch_rows = 0;
 	batch_state->next_batch_row = 0;
+	batch_state->vector_qual_result = NULL;
+	batch_state->lazy_columns_pending = false;
+	chunk_state->instrumentation.batches_read++;
 
 	MemoryContext old_context = MemoryContextSwitchTo(batch_state->per_batch_context);
 	MemoryContextReset(batch_state->per_batch_context);
+	decompression_arena_reset(&batch_state->arena);
+
+	if (chunk_state->num_runtime_filter_probes > 0 &&
+		!runtime_filter_batch_may_match(chunk_state->runtime_filter_probes,
+										chunk_state->num_runtime_filter_probes,
+										chunk_state->csstate.ss.ps.state,
+										batch_state->compressed_slot))
+	{
+		/*
+		 * No rows of this batch can match the inner side of the hash join
+		 * above us, so we skip it like the batches where no rows pass the
+		 * vectorized quals, without decompressing anything.
+		 */
+		batch_state->total_batch_rows = compressed_batch_get_row_count(chunk_state, batch_state);
+		batch_state->next_batch_row = batch_state->total_batch_rows;
+		chunk_state->instrumentation.batches_filtered_by_runtime_filters++;
+		MemoryContextSwitchTo(old_context);
+		return;
+	}
+
+	for (int i = 0; i < chunk_state->num_eager_compressed_columns; i++)
+	{
+		if (chunk_state->vectorized_quals == NIL ||
+			chunk_state->template_columns[i].used_in_vectorized_filters)
+		{
+			prefetch_column(chunk_state, batch_state, i);
+		}
+	}
 
 	for (int i = 0; i < chunk_state->num_total_columns; i++)
 	{
@@ -105,87 +728,21 @@ compressed_batch_set_compressed_tuple(DecompressChunkState *chunk_state,
 				column_values->value_bytes = -1;
 				column_values->arrow_values = NULL;
 				column_values->arrow_validity = NULL;
+				column_values->arrow_varlena_datums = NULL;
 				column_values->output_attno = column_description->output_attno;
-				bool isnull;
-				Datum value = slot_getattr(batch_state->compressed_slot,
-										   column_description->compressed_scan_attno,
-										   &isnull);
-				if (isnull)
-				{
-					/*
-					 * The column will have a default value for the entire batch,
-					 * set it now.
-					 */
-					column_values->iterator = NULL;
-					AttrNumber attr = AttrNumberGetAttrOffset(column_description->output_attno);
-
-					batch_state->decompressed_scan_slot->tts_values[attr] =
-						getmissingattr(batch_state->decompressed_scan_slot->tts_tupleDescriptor,
-									   attr + 1,
-									   &batch_state->decompressed_scan_slot->tts_isnull[attr]);
-					break;
-				}
 
-				/* Decompress the entire batch if it is supported. */
-				CompressedDataHeader *header = (CompressedDataHeader *) PG_DETOAST_DATUM(value);
-				ArrowArray *arrow = NULL;
-				if (chunk_state->enable_bulk_decompression &&
-					column_description->bulk_decompression_supported)
+				/*
+				 * If we have vectorized quals, decompress only the columns they
+				 * use for now. The rest of the columns might not be needed if
+				 * no rows pass these quals. The lazily decompressed columns are
+				 * only decompressed when some row passes all the quals.
+				 */
+				if (i < chunk_state->num_eager_compressed_columns &&
+					(chunk_state->vectorized_quals == NIL ||
+					 column_description->used_in_vectorized_filters))
 				{
-					if (chunk_state->bulk_decompression_context == NULL)
-					{
-						chunk_state->bulk_decompression_context =
-							AllocSetContextCreate(MemoryContextGetParent(
-													  batch_state->per_batch_context),
-												  "bulk decompression",
-												  /* minContextSize = */ 0,
-												  /* initBlockSize = */ 64 * 1024,
-												  /* maxBlockSize = */ 64 * 1024);
-					}
-
-					DecompressAllFunction decompress_all =
-						tsl_get_decompress_all_function(header->compression_algorithm);
-					Assert(decompress_all != NULL);
-
-					MemoryContext context_before_decompression =
-						MemoryContextSwitchTo(chunk_state->bulk_decompression_context);
-
-					arrow = decompress_all(PointerGetDatum(header),
-										   column_description->typid,
-										   batch_state->per_batch_context);
-
-					MemoryContextReset(chunk_state->bulk_decompression_context);
-
-					MemoryContextSwitchTo(context_before_decompression);
+					decompress_column(chunk_state, batch_state, i);
 				}
-
-				if (arrow)
-				{
-					if (batch_state->total_batch_rows == 0)
-					{
-						batch_state->total_batch_rows = arrow->length;
-					}
-					else if (batch_state->total_batch_rows != arrow->length)
-					{
-						elog(ERROR, "compressed column out of sync with batch counter");
-					}
-
-					column_values->arrow = arrow;
-					column_values->arrow_values = arrow->buffers[1];
-					column_values->arrow_validity = arrow->buffers[0];
-
-					column_values->value_bytes = get_typlen(column_description->typid);
-
-					break;
-				}
-
-				/* As a fallback, decompress row-by-row. */
-				column_values->iterator =
-					tsl_get_decompression_iterator_init(header->compression_algorithm,
-														chunk_state
-															->reverse)(PointerGetDatum(header),
-																	   column_description->typid);
-
 				break;
 			}
 			case SEGMENTBY_COLUMN:
@@ -218,6 +775,11 @@ compressed_batch_set_compressed_tuple(DecompressChunkState *chunk_state,
 									count_value)));
 				}
 
+				if (chunk_state->batch_row_limit > 0)
+				{
+					count_value = Min(count_value, chunk_state->batch_row_limit);
+				}
+
 				if (batch_state->total_batch_rows == 0)
 				{
 					batch_state->total_batch_rows = count_value;
@@ -238,16 +800,64 @@ compressed_batch_set_compressed_tuple(DecompressChunkState *chunk_state,
 		}
 	}
 
+	if (chunk_state->vectorized_quals != NIL)
+	{
+		instr_time start;
+
+		ts_node_timing_start(&chunk_state->timing, &start);
+		const int n_passed = compute_vector_quals(chunk_state, batch_state);
+		ts_node_timing_stop(&chunk_state->timing, DECOMPRESS_CHUNK_TIMING_VECTOR_QUALS, &start);
+
+		if (n_passed == 0)
+		{
+			/*
+			 * No rows of this batch pass the vectorized quals, so we can skip
+			 * it entirely without decompressing the rest of the columns.
+			 */
+			InstrCountFiltered1(&chunk_state->csstate, batch_state->total_batch_rows);
+			chunk_state->instrumentation.batches_filtered_by_vector_quals++;
+			batch_state->next_batch_row = batch_state->total_batch_rows;
+			MemoryContextSwitchTo(old_context);
+			return;
+		}
+
+		if (n_passed == batch_state->total_batch_rows)
+		{
+			/* All rows pass, so we don't have to check the bitmap per row. */
+			batch_state->vector_qual_result = NULL;
+		}
+
+		/* Now decompress the columns that we have skipped above. */
+		for (int i = 0; i < chunk_state->num_eager_compressed_columns; i++)
+		{
+			if (!chunk_state->template_columns[i].used_in_vectorized_filters)
+			{
+				prefetch_column(chunk_state, batch_state, i);
+			}
+		}
+
+		for (int i = 0; i < chunk_state->num_eager_compressed_columns; i++)
+		{
+			if (!chunk_state->template_columns[i].used_in_vectorized_filters)
+			{
+				decompress_column(chunk_state, batch_state, i);
+			}
+		}
+	}
+
+	batch_state->lazy_columns_pending =
+		chunk_state->num_eager_compressed_columns < chunk_state->num_compressed_columns;
+
 	MemoryContextSwitchTo(old_context);
 }
 
 /*
- * Construct the next tuple in the decompressed scan slot.
- * Doesn't check the quals.
+ * Fill the values of the given range of compressed columns for the current row
+ * in the decompressed scan slot.
  */
-static void
-compressed_batch_make_next_tuple(DecompressChunkState *chunk_state,
-								 DecompressBatchState *batch_state)
+static pg_attribute_always_inline void
+compressed_batch_fill_columns(DecompressChunkState *chunk_state, DecompressBatchState *batch_state,
+							  int first_column, int end_column)
 {
 	TupleTableSlot *decompressed_scan_slot = batch_state->decompressed_scan_slot;
 	Assert(decompressed_scan_slot != NULL);
@@ -260,8 +870,7 @@ compressed_batch_make_next_tuple(DecompressChunkState *chunk_state,
 								 batch_state->total_batch_rows - 1 - output_row :
 								 output_row;
 
-	const int num_compressed_columns = chunk_state->num_compressed_columns;
-	for (int i = 0; i < num_compressed_columns; i++)
+	for (int i = first_column; i < end_column; i++)
 	{
 		CompressedColumnValues column_values = batch_state->compressed_columns[i];
 
@@ -278,6 +887,16 @@ compressed_batch_make_next_tuple(DecompressChunkState *chunk_state,
 			decompressed_scan_slot->tts_isnull[attr] = result.is_null;
 			decompressed_scan_slot->tts_values[attr] = result.val;
 		}
+		else if (column_values.arrow_varlena_datums != NULL)
+		{
+			const int index = column_values.arrow_values != NULL ?
+								  ((const int16 *) column_values.arrow_values)[arrow_row] :
+								  (int) arrow_row;
+			const AttrNumber attr = AttrNumberGetAttrOffset(column_values.output_attno);
+			decompressed_scan_slot->tts_values[attr] = column_values.arrow_varlena_datums[index];
+			decompressed_scan_slot->tts_isnull[attr] =
+				!arrow_row_is_valid(column_values.arrow_validity, arrow_row);
+		}
 		else if (column_values.arrow_values != NULL)
 		{
 			const char *restrict src = column_values.arrow_values;
@@ -292,6 +911,12 @@ compressed_batch_make_next_tuple(DecompressChunkState *chunk_state,
 			uint64 value;
 			memcpy(&value, &src[column_values.value_bytes * arrow_row], 8);
 
+			/*
+			 * Still, zero out the higher bytes, because some conversions like
+			 * DatumGetBool() look at the entire Datum.
+			 */
+			value &= ~0ULL >> (64 - 8 * column_values.value_bytes);
+
 #ifdef USE_FLOAT8_BYVAL
 			Datum datum = Int64GetDatum(value);
 #else
@@ -315,6 +940,26 @@ compressed_batch_make_next_tuple(DecompressChunkState *chunk_state,
 				!arrow_row_is_valid(column_values.arrow_validity, arrow_row);
 		}
 	}
+}
+
+/*
+ * Construct the next tuple in the decompressed scan slot.
+ * Doesn't check the quals.
+ */
+static void
+compressed_batch_make_next_tuple(DecompressChunkState *chunk_state,
+								 DecompressBatchState *batch_state)
+{
+	TupleTableSlot *decompressed_scan_slot = batch_state->decompressed_scan_slot;
+
+	/*
+	 * The lazily decompressed columns are not decompressed yet, so they are
+	 * skipped here.
+	 */
+	const int num_filled_columns = batch_state->lazy_columns_pending ?
+									   chunk_state->num_eager_compressed_columns :
+									   chunk_state->num_compressed_columns;
+	compressed_batch_fill_columns(chunk_state, batch_state, 0, num_filled_columns);
 
 	/*
 	 * It's a virtual tuple slot, so no point in clearing/storing it
@@ -332,6 +977,150 @@ compressed_batch_make_next_tuple(DecompressChunkState *chunk_state,
 	}
 }
 
+/*
+ * Check whether the current row of the batch passes the vectorized quals.
+ */
+static pg_attribute_always_inline bool
+compressed_batch_vector_qual(DecompressChunkState *chunk_state, DecompressBatchState *batch_state)
+{
+	Assert(batch_state->next_batch_row < batch_state->total_batch_rows);
+
+	if (batch_state->vector_qual_result == NULL)
+	{
+		return true;
+	}
+
+	const int output_row = batch_state->next_batch_row;
+	const size_t arrow_row = unlikely(chunk_state->reverse) ?
+								 batch_state->total_batch_rows - 1 - output_row :
+								 output_row;
+
+	return arrow_row_is_valid(batch_state->vector_qual_result, arrow_row);
+}
+
+/*
+ * Skip the current row of the batch without building the tuple. We still have
+ * to advance the columns that we decompress row-by-row, so that they stay in
+ * sync with the batch row counter.
+ */
+static void
+compressed_batch_skip_row(DecompressChunkState *chunk_state, DecompressBatchState *batch_state)
+{
+	const int num_compressed_columns = chunk_state->num_compressed_columns;
+	for (int i = 0; i < num_compressed_columns; i++)
+	{
+		CompressedColumnValues *column_values = &batch_state->compressed_columns[i];
+		if (column_values->iterator != NULL)
+		{
+			DecompressResult result = column_values->iterator->try_next(column_values->iterator);
+			if (result.is_done)
+			{
+				elog(ERROR, "compressed column out of sync with batch counter");
+			}
+		}
+	}
+}
+
+/*
+ * Decompress the lazily decompressed columns of the batch, and fill their
+ * values for the current row.
+ */
+static void
+compressed_batch_decompress_lazy_columns(DecompressChunkState *chunk_state,
+										 DecompressBatchState *batch_state)
+{
+	Assert(batch_state->lazy_columns_pending);
+
+	MemoryContext old_context = MemoryContextSwitchTo(batch_state->per_batch_context);
+	for (int i = chunk_state->num_eager_compressed_columns;
+		 i < chunk_state->num_compressed_columns;
+		 i++)
+	{
+		prefetch_column(chunk_state, batch_state, i);
+	}
+
+	for (int i = chunk_state->num_eager_compressed_columns;
+		 i < chunk_state->num_compressed_columns;
+		 i++)
+	{
+		decompress_column(chunk_state, batch_state, i);
+
+		/*
+		 * The bulk decompression might be unavailable for this particular
+		 * compressed value, and then we use the row-by-row iterator. It has to
+		 * catch up with the rows we have already produced.
+		 */
+		CompressedColumnValues *column_values = &batch_state->compressed_columns[i];
+		if (column_values->iterator != NULL)
+		{
+			for (int row = 0; row < batch_state->next_batch_row; row++)
+			{
+				DecompressResult result = column_values->iterator->try_next(column_values->iterator);
+				if (result.is_done)
+				{
+					elog(ERROR, "compressed column out of sync with batch counter");
+				}
+			}
+		}
+	}
+	MemoryContextSwitchTo(old_context);
+
+	batch_state->lazy_columns_pending = false;
+
+	compressed_batch_fill_columns(chunk_state,
+								  batch_state,
+								  chunk_state->num_eager_compressed_columns,
+								  chunk_state->num_compressed_columns);
+}
+
+/*
+ * Find the next row of the batch starting from the current one, that passes
+ * the vectorized quals. Works a bitmap word at a time, so that we don't have
+ * to look at the rows that don't pass one by one. Returns total_batch_rows if
+ * there are no such rows.
+ */
+static int
+compressed_batch_next_passing_row(DecompressChunkState *chunk_state,
+								  DecompressBatchState *batch_state)
+{
+	const uint64 *restrict bitmap = batch_state->vector_qual_result;
+	const int total_rows = batch_state->total_batch_rows;
+	Assert(bitmap != NULL);
+
+	if (likely(!chunk_state->reverse))
+	{
+		int row = batch_state->next_batch_row;
+		while (row < total_rows)
+		{
+			const uint64 word = bitmap[row / 64] >> (row % 64);
+			if (word != 0)
+			{
+				return row + pg_rightmost_one_pos64(word);
+			}
+			row = (row / 64 + 1) * 64;
+		}
+		return total_rows;
+	}
+
+	/*
+	 * For the reverse scan, the output rows go in the reverse order of the
+	 * bitmap, so we have to look for the previous set bit.
+	 */
+	int arrow_row = total_rows - 1 - batch_state->next_batch_row;
+	while (arrow_row >= 0)
+	{
+		const int shift = 63 - arrow_row % 64;
+		const uint64 word = bitmap[arrow_row / 64] << shift;
+		if (word != 0)
+		{
+			const int passing_arrow_row = arrow_row - (63 - pg_leftmost_one_pos64(word));
+			return total_rows - 1 - passing_arrow_row;
+		}
+		arrow_row = (arrow_row / 64) * 64 - 1;
+	}
+	return total_rows;
+}
+
 static bool
 compressed_batch_postgres_qual(DecompressChunkState *chunk_state, DecompressBatchState *batch_state)
 {
@@ -347,7 +1136,13 @@ compressed_batch_postgres_qual(DecompressChunkState *chunk_state, DecompressBatc
 	ExprContext *econtext = chunk_state->csstate.ss.ps.ps_ExprContext;
 	econtext->ecxt_scantuple = decompressed_scan_slot;
 	ResetExprContext(econtext);
-	return ExecQual(chunk_state->csstate.ss.ps.qual, econtext);
+
+	instr_time start;
+	ts_node_timing_start(&chunk_state->timing, &start);
+	const bool passed = ExecQual(chunk_state->csstate.ss.ps.qual, econtext);
+	ts_node_timing_stop(&chunk_state->timing, DECOMPRESS_CHUNK_TIMING_QUALS, &start);
+
+	return passed;
 }
 
 /*
@@ -368,6 +1163,32 @@ compressed_batch_advance(DecompressChunkState *chunk_state, DecompressBatchState
 	for (; batch_state->next_batch_row < batch_state->total_batch_rows;
 		 batch_state->next_batch_row++)
 	{
+		if (batch_state->vector_qual_result != NULL)
+		{
+			/*
+			 * Jump over the rows that don't pass the vectorized quals, so that
+			 * we don't even have to build the tuples for them.
+			 */
+			const int passing_row = compressed_batch_next_passing_row(chunk_state, batch_state);
+			const int n_skipped = passing_row - batch_state->next_batch_row;
+			if (n_skipped > 0)
+			{
+				for (int i = 0; i < n_skipped; i++)
+				{
+					compressed_batch_skip_row(chunk_state, batch_state);
+				}
+				InstrCountFiltered1(&chunk_state->csstate, n_skipped);
+				batch_state->next_batch_row = passing_row;
+
+				if (passing_row == batch_state->total_batch_rows)
+				{
+					break;
+				}
+			}
+		}
+
+		Assert(compressed_batch_vector_qual(chunk_state, batch_state));
+
 		compressed_batch_make_next_tuple(chunk_state, batch_state);
 
 		if (!compressed_batch_postgres_qual(chunk_state, batch_state))
@@ -381,16 +1202,22 @@ compressed_batch_advance(DecompressChunkState *chunk_state, DecompressBatchState
 		}
 
 		/* The tuple passed the qual. */
+		if (unlikely(batch_state->lazy_columns_pending))
+		{
+			compressed_batch_decompress_lazy_columns(chunk_state, batch_state);
+		}
+
 		batch_state->next_batch_row++;
 		return;
 	}
 
 	/*
 	 * Reached end of batch. Check that the columns that we're decompressing
-	 * row-by-row have also ended.
+	 * row-by-row have also ended. This is not the case when we only need some
+	 * first rows of the batch.
 	 */
 	Assert(batch_state->next_batch_row == batch_state->total_batch_rows);
-	for (int i = 0; i < num_compressed_columns; i++)
+	for (int i = 0; chunk_state->batch_row_limit == 0 && i < num_compressed_columns; i++)
 	{
 		CompressedColumnValues *column_values = &batch_state->compressed_columns[i];
 		if (column_values->iterator)
@@ -422,9 +1249,14 @@ compressed_batch_save_first_tuple(DecompressChunkState *chunk_state,
 	Assert(TupIsNull(batch_state->decompressed_scan_slot));
 
 	compressed_batch_make_next_tuple(chunk_state, batch_state);
+	if (batch_state->lazy_columns_pending)
+	{
+		compressed_batch_decompress_lazy_columns(chunk_state, batch_state);
+	}
 	ExecCopySlot(first_tuple_slot, batch_state->decompressed_scan_slot);
 
-	const bool qual_passed = compressed_batch_postgres_qual(chunk_state, batch_state);
+	const bool qual_passed = compressed_batch_vector_qual(chunk_state, batch_state) &&
+							 compressed_batch_postgres_qual(chunk_state, batch_state);
 	batch_state->next_batch_row++;
 
 	if (!qual_passed)
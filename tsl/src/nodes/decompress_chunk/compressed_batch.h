@@ -11,6 +11,27 @@
 
 typedef struct ArrowArray ArrowArray;
 
+/*
+ * The state for evaluating a vectorized qual on single values, used for the
+ * varlena columns that don't have a specialized vectorized implementation, and
+ * for the columns that have a default value for the entire batch.
+ */
+typedef struct ScalarQualState
+{
+	FmgrInfo flinfo;
+	Oid collation;
+
+	/* The constant for an OpExpr qual. */
+	Datum constvalue;
+
+	/* The array elements for a ScalarArrayOpExpr qual. */
+	bool is_array_op;
+	bool use_or;
+	int num_elements;
+	Datum *elements;
+	bool *element_nulls;
+} ScalarQualState;
+
 typedef struct CompressedColumnValues
 {
 	/* For row-by-row decompression. */
@@ -29,6 +50,14 @@ typedef struct CompressedColumnValues
 	const void *arrow_validity;
 	const void *arrow_values;
 
+	/*
+	 * For the arrow arrays of varlena type, the varlena datums built from the
+	 * array elements. For the dictionary-encoded arrays, they are built from
+	 * the dictionary items, and the arrow values are the int16 indices into
+	 * this array. Otherwise, the arrow values are NULL.
+	 */
+	const Datum *arrow_varlena_datums;
+
 	/*
 	 * The following fields are copied here for better data locality.
 	 */
@@ -51,11 +80,30 @@ typedef struct DecompressBatchState
 	int total_batch_rows;
 	int next_batch_row;
 	MemoryContext per_batch_context;
+
+	/*
+	 * Reusable memory for the results of bulk decompression, see
+	 * DecompressChunkState.batch_arena_bytes. The allocations that don't fit
+	 * go to the per_batch_context.
+	 */
+	DecompressionArena arena;
+
+	/* The memory of this batch state in DecompressChunkState.batch_memory_bytes */
+	int64 memory_bytes;
+
 	uint64 *vector_qual_result;
 
+	/*
+	 * Whether we still have to decompress the lazily decompressed columns of
+	 * this batch, see DecompressChunkState.num_eager_compressed_columns.
+	 */
+	bool lazy_columns_pending;
+
 	CompressedColumnValues compressed_columns[FLEXIBLE_ARRAY_MEMBER];
 } DecompressBatchState;
 
+extern void compressed_batch_init_scalar_qual(ScalarQualState *state, Node *qual);
+
 extern void compressed_batch_set_compressed_tuple(DecompressChunkState *chunk_state,
 												  DecompressBatchState *batch_state,
 												  TupleTableSlot *subslot);
@@ -6,7 +6,9 @@
 
 #include <math.h>
 #include <postgres.h>
+#include <catalog/pg_class.h>
 #include <catalog/pg_operator.h>
+#include <catalog/pg_statistic.h>
 #include <miscadmin.h>
 #include <nodes/bitmapset.h>
 #include <nodes/makefuncs.h>
@@ -19,6 +21,7 @@
 #include <planner/planner.h>
 #include <utils/builtins.h>
 #include <utils/lsyscache.h>
+#include <utils/syscache.h>
 #include <utils/typcache.h>
 
 #include <planner.h>
@@ -66,6 +69,7 @@ typedef enum MergeBatchResult
 } MergeBatchResult;
 
 static RangeTblEntry *decompress_chunk_make_rte(Oid compressed_relid, LOCKMODE lockmode);
+static void cost_decompress_chunk(DecompressChunkPath *dcpath, Path *compressed_path);
 static void create_compressed_scan_paths(PlannerInfo *root, RelOptInfo *compressed_rel,
 										 CompressionInfo *info, SortInfo *sort_info);
 
@@ -270,6 +274,29 @@ copy_decompress_chunk_path(DecompressChunkPath *src)
 	return dst;
 }
 
+bool
+ts_is_decompress_chunk_path(Path *path)
+{
+	return IsA(path, CustomPath) &&
+		   castNode(CustomPath, path)->methods == &decompress_chunk_path_methods;
+}
+
+/*
+ * Make a copy of DecompressChunkPath that decompresses the output of the given
+ * compressed path. Used by other custom nodes, e.g. SkipScan, that replace the
+ * compressed scan with their own path.
+ */
+Path *
+decompress_chunk_path_replace_compressed_path(DecompressChunkPath *path, Path *compressed_path)
+{
+	DecompressChunkPath *new_path = copy_decompress_chunk_path(path);
+
+	new_path->custom_path.custom_paths = list_make1(compressed_path);
+	cost_decompress_chunk(new_path, compressed_path);
+
+	return &new_path->custom_path.path;
+}
+
 static CompressionInfo *
 build_compressioninfo(PlannerInfo *root, Hypertable *ht, RelOptInfo *chunk_rel)
 {
@@ -313,6 +340,80 @@ build_compressioninfo(PlannerInfo *root, Hypertable *ht, RelOptInfo *chunk_rel)
 	return info;
 }
 
+/*
+ * Estimate the average number of rows in a compressed batch from the
+ * statistics of the count metadata column of the compressed chunk. The
+ * batches are mostly full, but with many segments or after recompression they
+ * can be much smaller, and assuming full batches then overestimates the rows
+ * of the DecompressChunk paths by orders of magnitude. Without statistics we
+ * assume full batches.
+ */
+static double
+estimate_rows_per_batch(Oid compressed_relid)
+{
+	AttrNumber count_attno = get_attnum(compressed_relid, COMPRESSION_COLUMN_METADATA_COUNT_NAME);
+	HeapTuple statstuple;
+	AttStatsSlot sslot;
+	double sum = 0;
+	double frac = 0;
+
+	if (count_attno == InvalidAttrNumber)
+		return DECOMPRESS_CHUNK_BATCH_SIZE;
+
+	statstuple = SearchSysCache3(STATRELATTINH,
+								 ObjectIdGetDatum(compressed_relid),
+								 Int16GetDatum(count_attno),
+								 BoolGetDatum(false));
+	if (!HeapTupleIsValid(statstuple))
+		return DECOMPRESS_CHUNK_BATCH_SIZE;
+
+	if (get_attstatsslot(&sslot,
+						 statstuple,
+						 STATISTIC_KIND_MCV,
+						 InvalidOid,
+						 ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS))
+	{
+		for (int i = 0; i < sslot.nvalues; i++)
+		{
+			sum += sslot.numbers[i] * DatumGetInt32(sslot.values[i]);
+			frac += sslot.numbers[i];
+		}
+		free_attstatsslot(&sslot);
+	}
+
+	/*
+	 * The histogram covers the batches that are not in the MCV list, in
+	 * buckets of equal frequency, so we use the average of the bucket middles
+	 * for them.
+	 */
+	if (frac < 1.0 && get_attstatsslot(&sslot,
+									   statstuple,
+									   STATISTIC_KIND_HISTOGRAM,
+									   InvalidOid,
+									   ATTSTATSSLOT_VALUES))
+	{
+		if (sslot.nvalues > 1)
+		{
+			double hist_sum = 0;
+
+			for (int i = 1; i < sslot.nvalues; i++)
+				hist_sum +=
+					(DatumGetInt32(sslot.values[i - 1]) + DatumGetInt32(sslot.values[i])) / 2.0;
+
+			sum += (1.0 - frac) * hist_sum / (sslot.nvalues - 1);
+			frac = 1.0;
+		}
+		free_attstatsslot(&sslot);
+	}
+
+	ReleaseSysCache(statstuple);
+
+	if (frac <= 0 || sum <= 0)
+		return DECOMPRESS_CHUNK_BATCH_SIZE;
+
+	return clamp_row_est(sum / frac);
+}
+
 /*
  * calculate cost for DecompressChunkPath
  *
@@ -320,15 +421,17 @@ build_compressioninfo(PlannerInfo *root, Hypertable *ht, RelOptInfo *chunk_rel)
  * we put cost of 1 tuple of compressed_scan as startup cost
  */
 static void
-cost_decompress_chunk(Path *path, Path *compressed_path)
+cost_decompress_chunk(DecompressChunkPath *dcpath, Path *compressed_path)
 {
+	Path *path = &dcpath->custom_path.path;
+
 	/* startup_cost is cost before fetching first tuple */
 	if (compressed_path->rows > 0)
 		path->startup_cost = compressed_path->total_cost / compressed_path->rows;
 
 	/* total_cost is cost for fetching all tuples */
 	path->total_cost = compressed_path->total_cost + path->rows * DECOMPRESS_CHUNK_CPU_TUPLE_COST;
-	path->rows = compressed_path->rows * DECOMPRESS_CHUNK_BATCH_SIZE;
+	path->rows = compressed_path->rows * dcpath->info->rows_per_batch;
 }
 
 /*
@@ -377,7 +480,7 @@ cost_decompress_sorted_merge_append(PlannerInfo *root, DecompressChunkPath *dcpa
 	dcpath->custom_path.path.total_cost =
 		sort_path.total_cost + pow(sort_path.rows, 2) * DECOMPRESS_CHUNK_HEAP_MERGE_CPU_TUPLE_COST;
 
-	dcpath->custom_path.path.rows = sort_path.rows * DECOMPRESS_CHUNK_BATCH_SIZE;
+	dcpath->custom_path.path.rows = sort_path.rows * dcpath->info->rows_per_batch;
 }
 
 /*
@@ -456,10 +559,43 @@ can_sorted_merge_append(PlannerInfo *root, CompressionInfo *info, Chunk *chunk)
 	int nkeys = list_length(pathkeys);
 
 	/*
-	 * Loop over the pathkeys of the query. These pathkeys need to match the
-	 * configured compress_orderby pathkeys.
+	 * The pathkeys of the query can start with some segmentby columns. Each
+	 * batch has a single value of these columns, so we can sort the batches by
+	 * them as well, and the batches of each segment are merged by their
+	 * orderby columns. This allows us to provide the ordering by a prefix of
+	 * the segmentby columns followed by the orderby columns, which the sort
+	 * pushdown can't do because it needs all the segmentby columns.
 	 */
-	for (int pk_index = 0; pk_index < nkeys; pk_index++)
+	int num_segmentby_keys = 0;
+	for (; num_segmentby_keys < nkeys; num_segmentby_keys++)
+	{
+		pk = list_nth(pathkeys, num_segmentby_keys);
+		expr = find_em_expr_for_rel(pk->pk_eclass, info->chunk_rel);
+
+		if (expr == NULL || !IsA(expr, Var))
+			break;
+
+		var = castNode(Var, expr);
+
+		if (var->varattno <= 0)
+			break;
+
+		column_name = get_attname(info->chunk_rte->relid, var->varattno, false);
+		ci = get_column_compressioninfo(info->hypertable_compression_info, column_name);
+
+		if (ci->segmentby_column_index <= 0)
+			break;
+	}
+
+	/* We need at least one orderby column to merge the batches. */
+	if (num_segmentby_keys == nkeys)
+		return MERGE_NOT_POSSIBLE;
+
+	/*
+	 * Loop over the rest of the pathkeys of the query. These pathkeys need to
+	 * match the configured compress_orderby pathkeys.
+	 */
+	for (int pk_index = num_segmentby_keys; pk_index < nkeys; pk_index++)
 	{
 		pk = list_nth(pathkeys, pk_index);
 		expr = find_em_expr_for_rel(pk->pk_eclass, info->chunk_rel);
@@ -475,7 +611,7 @@ can_sorted_merge_append(PlannerInfo *root, CompressionInfo *info, Chunk *chunk)
 		column_name = get_attname(info->chunk_rte->relid, var->varattno, false);
 		ci = get_column_compressioninfo(info->hypertable_compression_info, column_name);
 
-		if (ci->orderby_column_index != pk_index + 1)
+		if (ci->orderby_column_index != pk_index - num_segmentby_keys + 1)
 			return MERGE_NOT_POSSIBLE;
 
 		/* Check order, if the order of the first column do not match, switch to backward scan */
@@ -494,7 +630,7 @@ can_sorted_merge_append(PlannerInfo *root, CompressionInfo *info, Chunk *chunk)
 				continue;
 			/* Switch scan direction on exact opposite order for first attribute */
 			else if (ci->orderby_asc && ci->orderby_nullsfirst != pk->pk_nulls_first &&
-					 pk_index == 0)
+					 pk_index == num_segmentby_keys)
 				merge_result = SCAN_BACKWARD;
 			else
 				return MERGE_NOT_POSSIBLE;
@@ -511,7 +647,7 @@ can_sorted_merge_append(PlannerInfo *root, CompressionInfo *info, Chunk *chunk)
 				continue;
 			/* Switch scan direction on exact opposite order for first attribute */
 			else if (!ci->orderby_asc && ci->orderby_nullsfirst != pk->pk_nulls_first &&
-					 pk_index == 0)
+					 pk_index == num_segmentby_keys)
 				merge_result = SCAN_BACKWARD;
 			else
 				return MERGE_NOT_POSSIBLE;
@@ -558,7 +694,7 @@ ts_decompress_chunk_generate_paths(PlannerInfo *root, RelOptInfo *chunk_rel, Hyp
 				   info->hypertable_compression_info,
 				   ts_chunk_is_partial(chunk));
 	set_baserel_size_estimates(root, compressed_rel);
-	new_row_estimate = compressed_rel->rows * DECOMPRESS_CHUNK_BATCH_SIZE;
+	new_row_estimate = compressed_rel->rows * info->rows_per_batch;
 
 	if (!info->single_chunk)
 	{
@@ -732,7 +868,7 @@ ts_decompress_chunk_generate_paths(PlannerInfo *root, RelOptInfo *chunk_rel, Hyp
 						  work_mem,
 						  -1);
 
-				cost_decompress_chunk(&dcpath->custom_path.path, &sort_path);
+				cost_decompress_chunk(dcpath, &sort_path);
 			}
 			/*
 			 * if chunk is partially compressed don't add this now but add an append path later
@@ -1540,6 +1676,7 @@ decompress_chunk_add_plannerinfo(PlannerInfo *root, CompressionInfo *info, Chunk
 
 	root->simple_rel_array[compressed_index] = compressed_rel;
 	info->compressed_rel = compressed_rel;
+	info->rows_per_batch = estimate_rows_per_batch(compressed_reloid);
 	ListCell *lc;
 	foreach (lc, info->hypertable_compression_info)
 	{
@@ -1607,11 +1744,47 @@ decompress_chunk_path_create(PlannerInfo *root, CompressionInfo *info, int paral
 	path->custom_path.custom_paths = list_make1(compressed_path);
 	path->reverse = false;
 	path->compressed_pathkeys = NIL;
-	cost_decompress_chunk(&path->custom_path.path, compressed_path);
+	cost_decompress_chunk(path, compressed_path);
 
 	return path;
 }
 
+/*
+ * Estimate the number of pages a scan of the compressed chunk has to read.
+ *
+ * The compressed batches are usually too big to be stored inline, so most of
+ * the data of a compressed chunk lives in its TOAST table and the heap itself
+ * only holds a few pages of pointers. Sizing the parallel scan by the heap
+ * pages alone would leave a single big compressed chunk with one worker, so
+ * we add the TOAST pages recorded in pg_class as well.
+ */
+static BlockNumber
+compressed_scan_pages(RelOptInfo *compressed_rel, CompressionInfo *info)
+{
+	BlockNumber pages = compressed_rel->pages;
+	HeapTuple tuple;
+	Oid toast_relid;
+
+	tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(info->compressed_rte->relid));
+	if (!HeapTupleIsValid(tuple))
+		return pages;
+
+	toast_relid = ((Form_pg_class) GETSTRUCT(tuple))->reltoastrelid;
+	ReleaseSysCache(tuple);
+
+	if (!OidIsValid(toast_relid))
+		return pages;
+
+	tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(toast_relid));
+	if (!HeapTupleIsValid(tuple))
+		return pages;
+
+	pages += ((Form_pg_class) GETSTRUCT(tuple))->relpages;
+	ReleaseSysCache(tuple);
+
+	return pages;
+}
+
 /* NOTE: this needs to be called strictly after all restrictinfos have been added
  *       to the compressed rel
  */
@@ -1641,9 +1814,12 @@ create_compressed_scan_paths(PlannerInfo *root, RelOptInfo *compressed_rel, Comp
 		 * parallel plan for decompression. If no partial path is present for a single chunk,
 		 * PostgreSQL will not use a parallel plan and all chunks are decompressed by a non-parallel
 		 * plan (even if there are a few bigger chunks).
+		 *
+		 * The workers share the block cursor of the parallel sequential scan, so every
+		 * compressed batch is claimed and decompressed by exactly one of them.
 		 */
 		int parallel_workers = compute_parallel_worker(compressed_rel,
-													   compressed_rel->pages,
+													   compressed_scan_pages(compressed_rel, info),
 													   -1,
 													   max_parallel_workers_per_gather);
 
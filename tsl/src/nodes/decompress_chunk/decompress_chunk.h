@@ -39,6 +39,9 @@ typedef struct CompressionInfo
 
 	bool single_chunk; /* query on explicit chunk */
 
+	/* estimated average number of rows in a compressed batch */
+	double rows_per_batch;
+
 } CompressionInfo;
 
 typedef struct ColumnCompressionInfo
@@ -89,6 +92,10 @@ typedef struct DecompressChunkPath
 void ts_decompress_chunk_generate_paths(PlannerInfo *root, RelOptInfo *rel, Hypertable *ht,
 										Chunk *chunk);
 
+bool ts_is_decompress_chunk_path(Path *path);
+Path *decompress_chunk_path_replace_compressed_path(DecompressChunkPath *path,
+													Path *compressed_path);
+
 FormData_hypertable_compression *get_column_compressioninfo(List *hypertable_compression_info,
 															char *column_name);
 
@@ -7,13 +7,16 @@
 #include <postgres.h>
 #include <miscadmin.h>
 #include <access/sysattr.h>
+#include <catalog/pg_proc.h>
 #include <executor/executor.h>
 #include <nodes/bitmapset.h>
 #include <nodes/makefuncs.h>
 #include <nodes/nodeFuncs.h>
+#include <optimizer/optimizer.h>
 #include <parser/parsetree.h>
 #include <rewrite/rewriteManip.h>
 #include <utils/datum.h>
+#include <utils/lsyscache.h>
 #include <utils/memutils.h>
 #include <utils/typcache.h>
 
@@ -22,12 +25,16 @@
 #include "compression/arrow_c_data_interface.h"
 #include "compression/compression.h"
 #include "guc.h"
+#include "hypertable_stats.h"
 #include "nodes/decompress_chunk/batch_array.h"
 #include "nodes/decompress_chunk/batch_queue_fifo.h"
 #include "nodes/decompress_chunk/batch_queue_heap.h"
+#include "nodes/decompress_chunk/compressed_batch.h"
 #include "nodes/decompress_chunk/decompress_chunk.h"
 #include "nodes/decompress_chunk/exec.h"
 #include "nodes/decompress_chunk/planner.h"
+#include "nodes/decompress_chunk/vector_predicates.h"
+#include "nodes/runtime_filter/exec.h"
 #include "ts_catalog/hypertable_compression.h"
 
 static void decompress_chunk_begin(CustomScanState *node, EState *estate, int eflags);
@@ -43,6 +50,13 @@ static CustomExecMethods decompress_chunk_state_methods = {
 	.ExplainCustomScan = decompress_chunk_explain,
 };
 
+static const char *const decompress_chunk_timing_names[_DECOMPRESS_CHUNK_TIMING_PHASES] = {
+	[DECOMPRESS_CHUNK_TIMING_DECOMPRESSION] = "Decompression Time",
+	[DECOMPRESS_CHUNK_TIMING_VECTOR_QUALS] = "Vectorized Qual Time",
+	[DECOMPRESS_CHUNK_TIMING_QUALS] = "Qual Time",
+	[DECOMPRESS_CHUNK_TIMING_PROJECTION] = "Projection Time",
+};
+
 struct BatchQueueFunctions
 {
 	void (*create)(DecompressChunkState *);
@@ -94,8 +108,10 @@ build_batch_sorted_merge_info(DecompressChunkState *chunk_state)
 	List *sort_ops = lsecond(sortinfo);
 	List *sort_collations = lthird(sortinfo);
 	List *sort_nulls = lfourth(sortinfo);
+	List *sort_meta_col_idx = lfifth(sortinfo);
 
 	chunk_state->n_sortkeys = list_length(linitial((sortinfo)));
+	chunk_state->batch_sort_meta_attno = linitial_int(sort_meta_col_idx);
 
 	Assert(list_length(sort_col_idx) == list_length(sort_ops));
 	Assert(list_length(sort_ops) == list_length(sort_collations));
@@ -140,20 +156,24 @@ decompress_chunk_state_create(CustomScan *cscan)
 	chunk_state->csstate.methods = &chunk_state->exec_methods;
 
 	Assert(IsA(cscan->custom_private, List));
-	Assert(list_length(cscan->custom_private) == 5);
+	Assert(list_length(cscan->custom_private) == 6);
 	List *settings = linitial(cscan->custom_private);
 	chunk_state->decompression_map = lsecond(cscan->custom_private);
 	chunk_state->is_segmentby_column = lthird(cscan->custom_private);
 	chunk_state->bulk_decompression_column = lfourth(cscan->custom_private);
 	chunk_state->sortinfo = lfifth(cscan->custom_private);
+	chunk_state->runtime_filter_probes =
+		runtime_filter_probes_create(list_nth(cscan->custom_private, 5),
+									 &chunk_state->num_runtime_filter_probes);
 
 	Assert(IsA(settings, IntList));
-	Assert(list_length(settings) == 5);
+	Assert(list_length(settings) == 6);
 	chunk_state->hypertable_id = linitial_int(settings);
 	chunk_state->chunk_relid = lsecond_int(settings);
 	chunk_state->reverse = lthird_int(settings);
 	chunk_state->batch_sorted_merge = lfourth_int(settings);
 	chunk_state->enable_bulk_decompression = lfifth_int(settings);
+	chunk_state->batch_row_limit = list_nth_int(settings, 5);
 
 	return (Node *) chunk_state;
 }
@@ -216,6 +236,147 @@ constify_tableoid(List *node, Index chunk_index, Oid chunk_relid)
 	return node;
 }
 
+/*
+ * Find the description of the compressed column referenced by the given Var,
+ * or NULL if it is not a compressed column.
+ */
+static DecompressChunkColumnDescription *
+find_compressed_column(DecompressChunkState *chunk_state, Index scanrelid, Var *var)
+{
+	if ((Index) var->varno != scanrelid || var->varattno <= 0)
+	{
+		return NULL;
+	}
+
+	for (int i = 0; i < chunk_state->num_compressed_columns; i++)
+	{
+		Assert(chunk_state->template_columns[i].type == COMPRESSED_COLUMN);
+		if (chunk_state->template_columns[i].output_attno == var->varattno)
+		{
+			return &chunk_state->template_columns[i];
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * For the varlena columns, we evaluate the predicate function on each
+ * dictionary item of the batch (or on each row, if the batch is not
+ * dictionary-encoded), instead of building the tuples. This is possible for
+ * any immutable strict function.
+ */
+static bool
+is_varlena_vectorizable_function(Oid funcid)
+{
+	return func_strict(funcid) && func_volatile(funcid) == PROVOLATILE_IMMUTABLE;
+}
+
+/*
+ * Check whether the given scan qual can be evaluated in a vectorized fashion
+ * over a bulk-decompressed batch, and return the vectorized form of it, or
+ * NULL if it's not possible. We support "Var op Const" and "Const op Var"
+ * comparisons, where Var refers to a compressed column that uses bulk
+ * decompression, and the operator has a vectorized implementation. For the
+ * varlena columns, we also support "Var op ANY/ALL(Const array)", which is
+ * what the IN-lists are transformed to.
+ */
+static Node *
+make_vectorized_qual(DecompressChunkState *chunk_state, Index scanrelid, Node *qual)
+{
+	if (IsA(qual, ScalarArrayOpExpr))
+	{
+		ScalarArrayOpExpr *saop = castNode(ScalarArrayOpExpr, qual);
+		if (list_length(saop->args) != 2 || !IsA(linitial(saop->args), Var) ||
+			!IsA(lsecond(saop->args), Const))
+		{
+			return NULL;
+		}
+
+		Var *var = linitial_node(Var, saop->args);
+		Const *constnode = lsecond_node(Const, saop->args);
+		DecompressChunkColumnDescription *column =
+			find_compressed_column(chunk_state, scanrelid, var);
+		if (column == NULL || !column->bulk_decompression_supported ||
+			column->value_bytes != -1 || constnode->constisnull)
+		{
+			return NULL;
+		}
+
+		/* The operator function oids are filled in by set_plan_references(). */
+		Assert(OidIsValid(saop->opfuncid));
+		if (!is_varlena_vectorizable_function(saop->opfuncid))
+		{
+			return NULL;
+		}
+
+		column->used_in_vectorized_filters = true;
+
+		return (Node *) saop;
+	}
+
+	if (!IsA(qual, OpExpr))
+	{
+		return NULL;
+	}
+
+	OpExpr *opexpr = castNode(OpExpr, qual);
+	if (list_length(opexpr->args) != 2)
+	{
+		return NULL;
+	}
+
+	if (IsA(linitial(opexpr->args), Const) && IsA(lsecond(opexpr->args), Var))
+	{
+		/* Try to commute the operator if the constant is on the left side. */
+		Oid commutator = get_commutator(opexpr->opno);
+		if (!OidIsValid(commutator))
+		{
+			return NULL;
+		}
+
+		opexpr = (OpExpr *) copyObject(opexpr);
+		opexpr->opno = commutator;
+		opexpr->opfuncid = get_opcode(commutator);
+		opexpr->args = list_make2(lsecond(opexpr->args), linitial(opexpr->args));
+	}
+
+	if (!IsA(linitial(opexpr->args), Var) || !IsA(lsecond(opexpr->args), Const))
+	{
+		return NULL;
+	}
+
+	Var *var = linitial_node(Var, opexpr->args);
+	Const *constnode = lsecond_node(Const, opexpr->args);
+
+	if (constnode->constisnull)
+	{
+		return NULL;
+	}
+
+	/*
+	 * The column must be a compressed column that is bulk-decompressed,
+	 * because the vectorized predicates work on the Arrow arrays.
+	 */
+	DecompressChunkColumnDescription *column = find_compressed_column(chunk_state, scanrelid, var);
+	if (column == NULL || !column->bulk_decompression_supported)
+	{
+		return NULL;
+	}
+
+	/* The operator function oids are filled in by set_plan_references(). */
+	Assert(OidIsValid(opexpr->opfuncid));
+	if (column->value_bytes == -1 ? !is_varlena_vectorizable_function(opexpr->opfuncid) :
+									get_vector_const_predicate(opexpr->opfuncid) == NULL)
+	{
+		return NULL;
+	}
+
+	column->used_in_vectorized_filters = true;
+
+	return (Node *) opexpr;
+}
+
 pg_attribute_always_inline static TupleTableSlot *
 decompress_chunk_exec_impl(DecompressChunkState *chunk_state,
 						   const struct BatchQueueFunctions *queue);
@@ -250,6 +411,11 @@ decompress_chunk_begin(CustomScanState *node, EState *estate, int eflags)
 	Plan *compressed_scan = linitial(cscan->custom_plans);
 	Assert(list_length(cscan->custom_plans) == 1);
 
+	ts_node_timing_init(&chunk_state->timing,
+						estate,
+						decompress_chunk_timing_names,
+						_DECOMPRESS_CHUNK_TIMING_PHASES);
+
 	PlanState *ps = &node->ss.ps;
 	if (ps->ps_ProjInfo)
 	{
@@ -400,19 +566,125 @@ decompress_chunk_begin(CustomScanState *node, EState *estate, int eflags)
 	Assert(current_compressed == num_compressed);
 	Assert(current_not_compressed == num_total);
 
+	/*
+	 * Split off the quals that can be evaluated in a vectorized fashion over
+	 * the entire bulk-decompressed batch. We do this in executor and not in
+	 * planner, so that the plan and its EXPLAIN output stay the same.
+	 */
+	List *postgres_quals = cscan->scan.plan.qual;
+	if (chunk_state->enable_bulk_decompression)
+	{
+		List *vectorized_quals = NIL;
+		List *nonvectorized_quals = NIL;
+		ListCell *lc;
+		foreach (lc, cscan->scan.plan.qual)
+		{
+			Node *qual = (Node *) lfirst(lc);
+			Node *vectorized = make_vectorized_qual(chunk_state, cscan->scan.scanrelid, qual);
+			if (vectorized)
+			{
+				vectorized_quals = lappend(vectorized_quals, vectorized);
+			}
+			else
+			{
+				nonvectorized_quals = lappend(nonvectorized_quals, qual);
+			}
+		}
+
+		if (vectorized_quals != NIL)
+		{
+			chunk_state->vectorized_quals = vectorized_quals;
+			chunk_state->vectorized_qual_states =
+				palloc(sizeof(ScalarQualState) * list_length(vectorized_quals));
+			foreach (lc, vectorized_quals)
+			{
+				const int i = foreach_current_index(lc);
+				compressed_batch_init_scalar_qual(&chunk_state->vectorized_qual_states[i],
+												  lfirst(lc));
+			}
+			postgres_quals = nonvectorized_quals;
+			ps->qual = ExecInitQual(postgres_quals, ps);
+		}
+	}
+
+	/*
+	 * Order the compressed columns so that the ones used by the vectorized
+	 * quals go first, then the ones required to evaluate the rest of the quals,
+	 * and then the output-only columns. The latter are decompressed lazily,
+	 * only when some row of the batch passes the quals. We can only do this
+	 * for the bulk-decompressed columns, because the row-by-row decompression
+	 * has to advance in lockstep with the batch.
+	 */
+	chunk_state->num_eager_compressed_columns = num_compressed;
+	Bitmapset *postgres_qual_attnos = NULL;
+	pull_varattnos((Node *) postgres_quals, cscan->scan.scanrelid, &postgres_qual_attnos);
+	if (chunk_state->enable_bulk_decompression &&
+		(chunk_state->vectorized_quals != NIL || postgres_quals != NIL) &&
+		!bms_is_member(0 - FirstLowInvalidHeapAttributeNumber, postgres_qual_attnos))
+	{
+		DecompressChunkColumnDescription *ordered_columns =
+			palloc(sizeof(DecompressChunkColumnDescription) * num_compressed);
+		bool *is_lazy = palloc(sizeof(bool) * num_compressed);
+		int current = 0;
+
+		for (int i = 0; i < num_compressed; i++)
+		{
+			DecompressChunkColumnDescription *column = &chunk_state->template_columns[i];
+			is_lazy[i] = !column->used_in_vectorized_filters &&
+						 column->bulk_decompression_supported &&
+						 !bms_is_member(column->output_attno - FirstLowInvalidHeapAttributeNumber,
+										postgres_qual_attnos);
+
+			if (column->used_in_vectorized_filters)
+			{
+				ordered_columns[current++] = *column;
+			}
+		}
+
+		for (int i = 0; i < num_compressed; i++)
+		{
+			DecompressChunkColumnDescription *column = &chunk_state->template_columns[i];
+			if (!column->used_in_vectorized_filters && !is_lazy[i])
+			{
+				ordered_columns[current++] = *column;
+			}
+		}
+
+		chunk_state->num_eager_compressed_columns = current;
+
+		for (int i = 0; i < num_compressed; i++)
+		{
+			if (is_lazy[i])
+			{
+				ordered_columns[current++] = chunk_state->template_columns[i];
+			}
+		}
+
+		Assert(current == num_compressed);
+		memcpy(chunk_state->template_columns,
+			   ordered_columns,
+			   sizeof(DecompressChunkColumnDescription) * num_compressed);
+		pfree(ordered_columns);
+		pfree(is_lazy);
+	}
+
+	if (ts_guc_debug_require_vector_qual && ps->qual != NULL)
+	{
+		elog(ERROR, "debug: encountered non-vectorized qual");
+	}
+
 	chunk_state->n_batch_state_bytes =
 		sizeof(DecompressBatchState) +
 		sizeof(CompressedColumnValues) * chunk_state->num_compressed_columns;
 
 	/*
-	 * Calculate the desired size of the batch memory context. Especially if we
-	 * use bulk decompression, the results should fit into the first page of the
-	 * context, otherwise it's going to do malloc/free on every
-	 * MemoryContextReset.
-	 *
-	 * Start with the default size.
+	 * Calculate the size of the per-batch arena for the results of bulk
+	 * decompression. It is allocated once for every batch state and reused for
+	 * every compressed batch, so it should fit the typical results, otherwise
+	 * they go to the batch memory context which does malloc/free for such big
+	 * allocations on every MemoryContextReset.
 	 */
-	chunk_state->batch_memory_context_bytes = ALLOCSET_DEFAULT_INITSIZE;
+	chunk_state->batch_arena_bytes = 0;
 	if (chunk_state->enable_bulk_decompression)
 	{
 		for (int i = 0; i < num_total; i++)
@@ -420,32 +692,36 @@ decompress_chunk_begin(CustomScanState *node, EState *estate, int eflags)
 			DecompressChunkColumnDescription *column = &chunk_state->template_columns[i];
 			if (column->bulk_decompression_supported)
 			{
-				/* Values array, with 64 element padding (actually we have less). */
-				chunk_state->batch_memory_context_bytes +=
-					(GLOBAL_MAX_ROWS_PER_COMPRESSION + 64) * column->value_bytes;
+				/*
+				 * Values array, with 64 element padding and 8 bytes of padding
+				 * at the end. For varlena types, we only account for the int16
+				 * dictionary indices and don't try to estimate the size of the
+				 * values. We use the default batch size here. The batches can
+				 * be larger if they were compressed with a larger
+				 * timescaledb.compression_batch_rows, their results go to the
+				 * memory context then.
+				 */
+				const int element_bytes =
+					column->value_bytes > 0 ? column->value_bytes : sizeof(int16);
+				chunk_state->batch_arena_bytes +=
+					MAXALIGN((MAX_ROWS_PER_COMPRESSION + 64) * element_bytes + 8);
 				/* Also nulls bitmap. */
-				chunk_state->batch_memory_context_bytes +=
-					GLOBAL_MAX_ROWS_PER_COMPRESSION / (64 * sizeof(uint64));
+				chunk_state->batch_arena_bytes +=
+					MAXALIGN(sizeof(uint64) * ((MAX_ROWS_PER_COMPRESSION + 63) / 64));
 				/* Arrow data structure. */
-				chunk_state->batch_memory_context_bytes +=
-					sizeof(ArrowArray) + sizeof(void *) * 2 /* buffers */;
-				/* Memory context header overhead for the above parts. */
-				chunk_state->batch_memory_context_bytes += sizeof(void *) * 3;
+				chunk_state->batch_arena_bytes +=
+					MAXALIGN(sizeof(ArrowArray) + sizeof(void *) * 2 /* buffers */);
 			}
 		}
 	}
 
 	/* Round up to even number of 4k pages. */
-	chunk_state->batch_memory_context_bytes =
-		((chunk_state->batch_memory_context_bytes + 4095) / 4096) * 4096;
+	chunk_state->batch_arena_bytes = ((chunk_state->batch_arena_bytes + 4095) / 4096) * 4096;
 
 	/* As a precaution, limit it to 1MB. */
-	chunk_state->batch_memory_context_bytes =
-		Min(chunk_state->batch_memory_context_bytes, 1 * 1024 * 1024);
+	chunk_state->batch_arena_bytes = Min(chunk_state->batch_arena_bytes, 1 * 1024 * 1024);
 
-	elog(DEBUG3,
-		 "Batch memory context has initial capacity of  %d bytes",
-		 chunk_state->batch_memory_context_bytes);
+	elog(DEBUG3, "Batch arena has capacity of %d bytes", chunk_state->batch_arena_bytes);
 
 	/*
 	 * Choose which batch queue we are going to use: heap for batch sorted
@@ -502,13 +778,58 @@ decompress_chunk_exec_impl(DecompressChunkState *chunk_state,
 	if (chunk_state->csstate.ss.ps.ps_ProjInfo)
 	{
 		ExprContext *econtext = chunk_state->csstate.ss.ps.ps_ExprContext;
+		instr_time start;
+
 		econtext->ecxt_scantuple = result_slot;
-		return ExecProject(chunk_state->csstate.ss.ps.ps_ProjInfo);
+		ts_node_timing_start(&chunk_state->timing, &start);
+		result_slot = ExecProject(chunk_state->csstate.ss.ps.ps_ProjInfo);
+		ts_node_timing_stop(&chunk_state->timing, DECOMPRESS_CHUNK_TIMING_PROJECTION, &start);
 	}
 
 	return result_slot;
 }
 
+/*
+ * Batch-at-a-time interface of the DecompressChunk node, for the parent nodes
+ * of our own that can work with the bulk-decompressed columns directly and don't
+ * need the individual decompressed tuples. Returns the next batch that has any
+ * rows passing the vectorized quals, or NULL when the input has ended. The
+ * decompressed columns are in the arrow arrays of the compressed column values,
+ * and the segmentby values are in the decompressed scan slot. The rows that pass
+ * the vectorized quals are marked in the vector_qual_result bitmap, which is
+ * NULL when all rows pass.
+ *
+ * The returned batch stays valid until the next call. Only the FIFO batch queue
+ * is supported, because the batch sorted merge needs the individual tuples.
+ */
+DecompressBatchState *
+decompress_chunk_next_batch(DecompressChunkState *chunk_state)
+{
+	Assert(!chunk_state->batch_sorted_merge);
+
+	DecompressBatchState *batch_state = batch_array_get_at(chunk_state, 0);
+	batch_array_free_at(chunk_state, 0);
+
+	for (;;)
+	{
+		TupleTableSlot *subslot = ExecProcNode(linitial(chunk_state->csstate.custom_ps));
+		if (TupIsNull(subslot))
+		{
+			return NULL;
+		}
+
+		compressed_batch_set_compressed_tuple(chunk_state, batch_state, subslot);
+		if (batch_state->next_batch_row < batch_state->total_batch_rows)
+		{
+			batch_array_update_memory(chunk_state, batch_state);
+			return batch_state;
+		}
+
+		/* No rows of this batch passed the vectorized quals. */
+		batch_array_free_at(chunk_state, 0);
+	}
+}
+
 static void
 decompress_chunk_rescan(CustomScanState *node)
 {
@@ -532,6 +853,13 @@ decompress_chunk_end(CustomScanState *node)
 {
 	DecompressChunkState *chunk_state = (DecompressChunkState *) node;
 
+	ts_hypertable_stats_add(chunk_state->hypertable_id,
+							HYPERTABLE_STATS_BATCHES_DECOMPRESSED,
+							chunk_state->instrumentation.batches_read);
+	ts_hypertable_stats_add(chunk_state->hypertable_id,
+							HYPERTABLE_STATS_BYTES_DECOMPRESSED,
+							chunk_state->instrumentation.detoasted_bytes);
+
 	chunk_state->batch_queue->free(chunk_state);
 
 	ExecEndNode(linitial(node->custom_ps));
@@ -557,4 +885,56 @@ decompress_chunk_explain(CustomScanState *node, List *ancestors, ExplainState *e
 			ExplainPropertyBool("Bulk Decompression", chunk_state->enable_bulk_decompression, es);
 		}
 	}
+
+	/*
+	 * The decompression counters depend on the batch layout and the timing,
+	 * so we show them only with the execution summary, which the tests
+	 * usually disable to get a stable output.
+	 */
+	if (es->analyze && es->summary)
+	{
+		const DecompressChunkInstrumentation *instrumentation = &chunk_state->instrumentation;
+		ExplainPropertyInteger("Batches Read", NULL, instrumentation->batches_read, es);
+		ExplainPropertyInteger("Batches Filtered by Vectorized Quals",
+							   NULL,
+							   instrumentation->batches_filtered_by_vector_quals,
+							   es);
+		if (chunk_state->num_runtime_filter_probes > 0)
+		{
+			ExplainPropertyInteger("Batches Filtered by Runtime Filters",
+								   NULL,
+								   instrumentation->batches_filtered_by_runtime_filters,
+								   es);
+		}
+		ExplainPropertyInteger("Columns Bulk Decompressed",
+							   NULL,
+							   instrumentation->columns_bulk_decompressed,
+							   es);
+		ExplainPropertyInteger("Columns Decompressed Row-by-Row",
+							   NULL,
+							   instrumentation->columns_iterator_decompressed,
+							   es);
+		ExplainPropertyInteger("Detoasted Bytes", NULL, instrumentation->detoasted_bytes, es);
+		ExplainPropertyInteger("Peak Batch Memory",
+							   "kB",
+							   (instrumentation->peak_batch_memory_bytes + 1023) / 1024,
+							   es);
+		if (chunk_state->batch_sorted_merge)
+		{
+			ExplainPropertyInteger("Sorted Merge Fallbacks to Sort",
+								   NULL,
+								   instrumentation->sorted_merge_fallbacks,
+								   es);
+		}
+		if (es->timing)
+		{
+			ExplainPropertyFloat("Bulk Decompression Time",
+								 "ms",
+								 INSTR_TIME_GET_MILLISEC(instrumentation->bulk_decompression_time),
+								 3,
+								 es);
+		}
+	}
+
+	ts_node_timing_explain(&chunk_state->timing, es);
 }
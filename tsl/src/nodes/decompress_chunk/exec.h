@@ -10,6 +10,9 @@
 #include <postgres.h>
 
 #include <nodes/extensible.h>
+#include <portability/instr_time.h>
+
+#include "nodes/node_timing.h"
 
 #define DECOMPRESS_CHUNK_COUNT_ID -9
 #define DECOMPRESS_CHUNK_SEQUENCE_NUM_ID -10
@@ -42,8 +45,57 @@ typedef struct DecompressChunkColumnDescription
 	AttrNumber compressed_scan_attno;
 
 	bool bulk_decompression_supported;
+
+	/*
+	 * Whether this column is referenced by the vectorized quals. Such columns
+	 * are decompressed before the others, so that we can skip decompressing
+	 * the rest of the batch if no rows pass the vectorized quals.
+	 */
+	bool used_in_vectorized_filters;
 } DecompressChunkColumnDescription;
 
+/*
+ * The phases of the DecompressChunk node that timescaledb.enable_node_timing
+ * shows in EXPLAIN.
+ */
+typedef enum DecompressChunkTimingPhase
+{
+	DECOMPRESS_CHUNK_TIMING_DECOMPRESSION = 0,
+	DECOMPRESS_CHUNK_TIMING_VECTOR_QUALS,
+	DECOMPRESS_CHUNK_TIMING_QUALS,
+	DECOMPRESS_CHUNK_TIMING_PROJECTION,
+	_DECOMPRESS_CHUNK_TIMING_PHASES,
+} DecompressChunkTimingPhase;
+
+/*
+ * The execution counters of the DecompressChunk node that we show in EXPLAIN
+ * ANALYZE.
+ */
+typedef struct DecompressChunkInstrumentation
+{
+	/* The compressed batches we have read, and those we skipped entirely. */
+	int64 batches_read;
+	int64 batches_filtered_by_vector_quals;
+	int64 batches_filtered_by_runtime_filters;
+
+	/* The compressed columns of these batches by the decompression method. */
+	int64 columns_bulk_decompressed;
+	int64 columns_iterator_decompressed;
+
+	/* The size of the compressed data that we had to detoast. */
+	int64 detoasted_bytes;
+
+	/* The time spent in the bulk decompression functions. */
+	instr_time bulk_decompression_time;
+
+	/*
+	 * The peak memory of the batch states, and the number of times the batch
+	 * sorted merge exceeded its memory limit and fell back to a sort.
+	 */
+	int64 peak_batch_memory_bytes;
+	int64 sorted_merge_fallbacks;
+} DecompressChunkInstrumentation;
+
 typedef struct DecompressChunkState
 {
 	CustomScanState csstate;
@@ -55,6 +107,15 @@ typedef struct DecompressChunkState
 
 	DecompressChunkColumnDescription *template_columns;
 
+	/*
+	 * The compressed columns are ordered so that the columns used by the
+	 * vectorized quals go first, then the rest of the columns that we
+	 * decompress when we load a batch, and then the output-only
+	 * bulk-decompressed columns. The latter are decompressed lazily when the
+	 * first row of the batch passes the quals.
+	 */
+	int num_eager_compressed_columns;
+
 	bool reverse;
 	int hypertable_id;
 	Oid chunk_relid;
@@ -69,7 +130,7 @@ typedef struct DecompressChunkState
 	void *batch_states;
 	int n_batch_state_bytes;
 	Bitmapset *unused_batch_states; /* The unused batch states */
-	int batch_memory_context_bytes;
+	int batch_arena_bytes;
 
 	const struct BatchQueueFunctions *batch_queue;
 	CustomExecMethods exec_methods;
@@ -81,8 +142,58 @@ typedef struct DecompressChunkState
 	SortSupportData *sortkeys;	   /* Sort keys for binary heap compare function */
 	TupleTableSlot *last_batch_first_tuple;
 
+	/*
+	 * The position of the min or max metadata column of the first sort key in
+	 * the compressed tuples, and the next compressed tuple that we have read
+	 * but not decompressed yet, because its metadata shows that it can't
+	 * contain the next tuple in the sort order.
+	 */
+	AttrNumber batch_sort_meta_attno;
+	TupleTableSlot *lookahead_compressed_slot;
+
+	/*
+	 * The memory used by all the batch states, see batch_array_update_memory().
+	 * When it exceeds timescaledb.decompression_sorted_merge_memory, the batch
+	 * sorted merge puts the rest of its input into this tuplesort, which can
+	 * spill to disk, and returns the tuples from there.
+	 */
+	int64 batch_memory_bytes;
+	struct Tuplesortstate *merge_fallback_sort;
+	TupleTableSlot *merge_fallback_sort_slot;
+	TupleTableSlot *merge_fallback_slot;
+
 	bool enable_bulk_decompression;
 
+	/*
+	 * If positive, we need at most this many first rows of each batch, so we
+	 * can detoast and decompress only a part of the compressed data.
+	 */
+	int batch_row_limit;
+
+	/*
+	 * The quals that are evaluated in a vectorized fashion over the entire
+	 * bulk-decompressed batch, before the individual tuples are built. These
+	 * are OpExprs of the form "Var op Const", or ScalarArrayOpExprs of the form
+	 * "Var op ANY(Const)" for the varlena columns, that are split off from the
+	 * scan quals at executor startup. The remaining quals are evaluated per
+	 * tuple as usual.
+	 */
+	List *vectorized_quals;
+
+	/*
+	 * The prepared function calls and array constants for the vectorized
+	 * quals, in the same order as the list above. We build them once here,
+	 * and not for every batch.
+	 */
+	struct ScalarQualState *vectorized_qual_states;
+
+	/*
+	 * The runtime filters from the hash joins above this node, that we check
+	 * the segmentby values or the min/max metadata of the batches against.
+	 */
+	struct RuntimeFilterProbe *runtime_filter_probes;
+	int num_runtime_filter_probes;
+
 	/*
 	 * Scratch space for bulk decompression which might need a lot of temporary
 	 * data.
@@ -99,8 +210,13 @@ typedef struct DecompressChunkState
 	 */
 	TupleDesc decompressed_slot_scan_tdesc;
 	TupleDesc compressed_slot_tdesc;
+
+	DecompressChunkInstrumentation instrumentation;
+	TsNodeTiming timing;
 } DecompressChunkState;
 
 extern Node *decompress_chunk_state_create(CustomScan *cscan);
 
+extern struct DecompressBatchState *decompress_chunk_next_batch(DecompressChunkState *chunk_state);
+
 #endif /* TIMESCALEDB_DECOMPRESS_CHUNK_EXEC_H */
@@ -19,6 +19,7 @@
 #include <optimizer/tlist.h>
 #include <parser/parsetree.h>
 #include <utils/builtins.h>
+#include <utils/lsyscache.h>
 #include <utils/typcache.h>
 
 #include "compression/compression.h"
@@ -29,6 +30,7 @@
 #include "nodes/decompress_chunk/decompress_chunk.h"
 #include "nodes/decompress_chunk/exec.h"
 #include "nodes/decompress_chunk/planner.h"
+#include "ts_catalog/hypertable_compression.h"
 
 static CustomScanMethods decompress_chunk_plan_methods = {
 	.CustomName = "DecompressChunk",
@@ -210,9 +212,9 @@ build_decompression_map(DecompressChunkPath *path, List *scan_tlist, Bitmapset *
 			 * We always need count column, and sometimes a sequence number
 			 * column. We don't output them, but use them for decompression,
 			 * hence the special negative destination attnos.
-			 * The min/max metadata columns are normally not required for output
-			 * or decompression, they are used only as filter for the compressed
-			 * scan, so we skip them here.
+			 * The min/max and bloom filter metadata columns are normally not
+			 * required for output or decompression, they are used only as
+			 * filter for the compressed scan, so we skip them here.
 			 */
 			Assert(strncmp(column_name,
 						   COMPRESSION_COLUMN_METADATA_PREFIX,
@@ -239,7 +241,10 @@ build_decompression_map(DecompressChunkPath *path, List *scan_tlist, Bitmapset *
 
 		const bool bulk_decompression_possible =
 			destination_attno_in_uncompressed_chunk > 0 && compression_info &&
-			tsl_get_decompress_all_function(compression_info->algo_id) != NULL;
+			tsl_get_decompress_all_function(compression_info->algo_id,
+											get_atttype(path->info->chunk_rte->relid,
+														destination_attno_in_uncompressed_chunk)) !=
+				NULL;
 		path->have_bulk_decompression_columns |= bulk_decompression_possible;
 		path->bulk_decompression_column =
 			lappend_int(path->bulk_decompression_column, bulk_decompression_possible);
@@ -351,6 +356,53 @@ find_attr_pos_in_tlist(List *targetlist, AttrNumber pos)
 	pg_unreachable();
 }
 
+/*
+ * When the query has a LIMIT, and we output the rows of each batch in their
+ * order without filtering them, no batch can contribute more rows than this
+ * limit. Returns this limit, or 0 if we need all the rows of each batch.
+ */
+static int
+get_batch_row_limit(PlannerInfo *root, DecompressChunkPath *dcpath)
+{
+	CompressionInfo *info = dcpath->info;
+	ListCell *lc;
+
+	/*
+	 * The limit_tuples are set only when there is no grouping or aggregation
+	 * above the scan, but we also have to check that the limit doesn't include
+	 * ties, that this relation is the only one in the query, that the rows are
+	 * not locked, and that the rows are not sorted above this scan.
+	 */
+	if (root->limit_tuples <= 0 || root->limit_tuples >= GLOBAL_MAX_ROWS_PER_COMPRESSION ||
+		root->parse->limitOption == LIMIT_OPTION_WITH_TIES ||
+		bms_num_members(root->all_baserels) != 1 || root->parse->rowMarks != NIL ||
+		dcpath->reverse ||
+		!pathkeys_contained_in(root->query_pathkeys, dcpath->custom_path.path.pathkeys))
+		return 0;
+
+	/*
+	 * The quals on the segmentby columns either pass or filter out the entire
+	 * batch, but the other quals can filter out the first rows.
+	 */
+	foreach (lc, info->chunk_rel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = lfirst_node(RestrictInfo, lc);
+		Bitmapset *attnos = NULL;
+
+		pull_varattnos((Node *) rinfo->clause, info->chunk_rel->relid, &attnos);
+
+		int attno = -1;
+		while ((attno = bms_next_member(attnos, attno)) >= 0)
+		{
+			if (!bms_is_member(attno + FirstLowInvalidHeapAttributeNumber,
+							   info->chunk_segmentby_attnos))
+				return 0;
+		}
+	}
+
+	return (int) root->limit_tuples;
+}
+
 Plan *
 decompress_chunk_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *path,
 							 List *decompressed_tlist, List *clauses, List *custom_plans)
@@ -441,6 +493,13 @@ decompress_chunk_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *pat
 	{
 		compressed_scan->plan.targetlist = ((IndexPath *) compressed_path)->indexinfo->indextlist;
 	}
+	else if (compressed_path->pathtype == T_CustomScan)
+	{
+		/*
+		 * The targetlist of a custom scan, e.g. SkipScan, has to match its
+		 * custom_scan_tlist, so we can't replace it.
+		 */
+	}
 	else
 	{
 		List *physical_tlist = build_physical_tlist(root, dcpath->info->compressed_rel);
@@ -569,8 +628,6 @@ decompress_chunk_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *pat
 				   "pathkey");
 		}
 
-		sort_options = list_make4(sort_col_idx, sort_ops, sort_collations, sort_nulls);
-
 		/*
 		 * Build a sort node for the compressed batches. The sort function is
 		 * derived from the sort function of the pathkeys, except that it refers
@@ -582,6 +639,7 @@ decompress_chunk_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *pat
 		Oid *sortOperators = palloc(sizeof(Oid) * numsortkeys);
 		Oid *collations = palloc(sizeof(Oid) * numsortkeys);
 		bool *nullsFirst = palloc(sizeof(bool) * numsortkeys);
+		bool first_key_is_segmentby = false;
 		for (int i = 0; i < numsortkeys; i++)
 		{
 			Oid sortop = list_nth_oid(sort_ops, i);
@@ -597,13 +655,27 @@ decompress_chunk_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *pat
 
 			/*
 			 * This way to determine the matching metadata column works, because
-			 * we have already verified that the pathkeys match the compression
-			 * orderby.
+			 * we have already verified that the pathkeys are a prefix of the
+			 * segmentby columns followed by the compression orderby. The
+			 * segmentby columns have the same name in the compressed chunk.
 			 */
 			Assert(strategy == BTLessStrategyNumber || strategy == BTGreaterStrategyNumber);
-			char *meta_col_name = strategy == BTLessStrategyNumber ?
-									  column_segment_min_name(i + 1) :
-									  column_segment_max_name(i + 1);
+			char *column_name = get_attname(dcpath->info->chunk_rte->relid,
+											(AttrNumber) list_nth_oid(sort_col_idx, i),
+											false);
+			FormData_hypertable_compression *ci =
+				get_column_compressioninfo(dcpath->info->hypertable_compression_info,
+										   column_name);
+			char *meta_col_name;
+			if (ci->segmentby_column_index > 0)
+				meta_col_name = column_name;
+			else if (strategy == BTLessStrategyNumber)
+				meta_col_name = compression_column_segment_min_name(ci);
+			else
+				meta_col_name = compression_column_segment_max_name(ci);
+
+			if (i == 0)
+				first_key_is_segmentby = ci->segmentby_column_index > 0;
 
 			AttrNumber attr_position =
 				get_attnum(dcpath->info->compressed_rte->relid, meta_col_name);
@@ -627,6 +699,24 @@ decompress_chunk_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *pat
 			nullsFirst[i] = list_nth_oid(sort_nulls, i);
 		}
 
+		/*
+		 * The executor also needs the position of the metadata column of the
+		 * first sort key in the compressed tuples, to check whether the next
+		 * batch can contain the next tuple before decompressing it. The
+		 * metadata is computed over the non-null values, so with NULLS FIRST
+		 * it is a bound for all the tuples of the batch only if the column is
+		 * not nullable. A segmentby value is the same for all the tuples.
+		 */
+		const bool meta_is_bound =
+			first_key_is_segmentby || !nullsFirst[0] ||
+			get_attnotnull(dcpath->info->chunk_rte->relid, linitial_oid(sort_col_idx));
+		sort_options = list_make5(sort_col_idx,
+								  sort_ops,
+								  sort_collations,
+								  sort_nulls,
+								  list_make1_int(meta_is_bound ? sortColIdx[0] :
+																 InvalidAttrNumber));
+
 		/* Now build the compressed batches sort node */
 		Sort *sort = ts_make_sort((Plan *) compressed_scan,
 								  numsortkeys,
@@ -667,6 +757,7 @@ decompress_chunk_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *pat
 							  dcpath->reverse,
 							  dcpath->batch_sorted_merge,
 							  enable_bulk_decompression);
+	settings = lappend_int(settings, get_batch_row_limit(root, dcpath));
 
 	decompress_plan->custom_private = list_make5(settings,
 												 dcpath->decompression_map,
@@ -674,5 +765,131 @@ decompress_chunk_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *pat
 												 dcpath->bulk_decompression_column,
 												 sort_options);
 
+	/* The runtime filters are added after planning, see runtime_filter/plan.c. */
+	decompress_plan->custom_private = lappend(decompress_plan->custom_private, NIL);
+
 	return &decompress_plan->scan.plan;
 }
+
+/*
+ * Check that the given expression is a plain column of the uncompressed chunk
+ * that is produced by the DecompressChunk scan, and find out whether that
+ * column is a segmentby one, and what is its attno in the compressed scan
+ * output.
+ */
+bool
+decompress_chunk_is_chunk_column(CustomScan *decompress_chunk, Expr *expr, bool *is_segmentby,
+								 AttrNumber *compressed_scan_attno)
+{
+	if (expr == NULL || !IsA(expr, Var))
+	{
+		return false;
+	}
+
+	Var *var = castNode(Var, expr);
+	if ((Index) var->varno != decompress_chunk->scan.scanrelid || var->varattno <= 0)
+	{
+		return false;
+	}
+
+	List *decompression_map = lsecond(decompress_chunk->custom_private);
+	List *is_segmentby_column = lthird(decompress_chunk->custom_private);
+	for (int compressed_index = 0; compressed_index < list_length(decompression_map);
+		 compressed_index++)
+	{
+		if (list_nth_int(decompression_map, compressed_index) == var->varattno)
+		{
+			*is_segmentby = list_nth_int(is_segmentby_column, compressed_index);
+			*compressed_scan_attno = AttrOffsetGetAttrNumber(compressed_index);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Find the attno of the min or max metadata column of the given orderby column
+ * in the compressed scan output. If the compressed scan doesn't output this
+ * column yet, add it to the scan targetlist. Returns InvalidAttrNumber if there
+ * is no such metadata column.
+ */
+AttrNumber
+decompress_chunk_get_segment_meta_attno(CustomScan *decompress_chunk, List *rtable,
+										AttrNumber chunk_attno, bool is_min)
+{
+	Plan *compressed_plan = linitial(decompress_chunk->custom_plans);
+	if (!IsA(compressed_plan, SeqScan) && !IsA(compressed_plan, IndexScan) &&
+		!IsA(compressed_plan, BitmapHeapScan))
+	{
+		return InvalidAttrNumber;
+	}
+	Scan *compressed_scan = (Scan *) compressed_plan;
+
+	List *settings = linitial(decompress_chunk->custom_private);
+	const int32 hypertable_id = linitial_int(settings);
+	const Oid chunk_relid = lsecond_int(settings);
+	char *attname = get_attname(chunk_relid, chunk_attno, /* missing_ok = */ false);
+	FormData_hypertable_compression *compression_info =
+		ts_hypertable_compression_get_by_pkey(hypertable_id, attname);
+	if (compression_info == NULL || compression_info->segmentby_column_index > 0)
+	{
+		return InvalidAttrNumber;
+	}
+
+	/*
+	 * The orderby columns always have the min/max metadata, and the other
+	 * columns might have it if it was requested with compress_minmax.
+	 */
+	char *meta_col_name;
+	if (compression_info->orderby_column_index > 0)
+	{
+		meta_col_name = is_min ? compression_column_segment_min_name(compression_info) :
+								 compression_column_segment_max_name(compression_info);
+	}
+	else
+	{
+		const char *attname = NameStr(compression_info->attname);
+		meta_col_name = is_min ? compression_column_segment_sparse_min_name(attname) :
+								 compression_column_segment_sparse_max_name(attname);
+	}
+	if (meta_col_name == NULL)
+	{
+		return InvalidAttrNumber;
+	}
+
+	const Oid compressed_relid = rt_fetch(compressed_scan->scanrelid, rtable)->relid;
+	const AttrNumber meta_attno = get_attnum(compressed_relid, meta_col_name);
+	if (meta_attno == InvalidAttrNumber)
+	{
+		return InvalidAttrNumber;
+	}
+
+	ListCell *lc;
+	foreach (lc, compressed_scan->plan.targetlist)
+	{
+		TargetEntry *tlentry = lfirst_node(TargetEntry, lc);
+		if (IsA(tlentry->expr, Var) &&
+			(Index) castNode(Var, tlentry->expr)->varno == compressed_scan->scanrelid &&
+			castNode(Var, tlentry->expr)->varattno == meta_attno)
+		{
+			return tlentry->resno;
+		}
+	}
+
+	/*
+	 * The compressed scan is a plain scan node, so we can just add the
+	 * metadata column to its output. DecompressChunk ignores the columns that
+	 * are not in its decompression map.
+	 */
+	Oid typid;
+	int32 typmod;
+	Oid collid;
+	get_atttypetypmodcoll(compressed_relid, meta_attno, &typid, &typmod, &collid);
+	const AttrNumber resno = list_length(compressed_scan->plan.targetlist) + 1;
+	Var *meta_var = makeVar(compressed_scan->scanrelid, meta_attno, typid, typmod, collid, 0);
+	compressed_scan->plan.targetlist =
+		lappend(compressed_scan->plan.targetlist,
+				makeTargetEntry((Expr *) meta_var, resno, NULL, /* resjunk = */ false));
+	return resno;
+}
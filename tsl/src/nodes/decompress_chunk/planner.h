@@ -14,4 +14,10 @@ extern Plan *decompress_chunk_plan_create(PlannerInfo *root, RelOptInfo *rel, Cu
 
 extern void _decompress_chunk_init(void);
 
+extern bool decompress_chunk_is_chunk_column(CustomScan *decompress_chunk, Expr *expr,
+											 bool *is_segmentby, AttrNumber *compressed_scan_attno);
+extern AttrNumber decompress_chunk_get_segment_meta_attno(CustomScan *decompress_chunk,
+														  List *rtable, AttrNumber chunk_attno,
+														  bool is_min);
+
 #endif /* TIMESCALEDB_DECOMPRESS_CHUNK_PLANNER_H */
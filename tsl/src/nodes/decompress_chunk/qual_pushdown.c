@@ -19,6 +19,8 @@
 #include "compression/create.h"
 #include "custom_type_cache.h"
 #include "compression/segment_meta.h"
+#include "extension_constants.h"
+#include "utils.h"
 
 typedef struct QualPushdownContext
 {
@@ -127,11 +129,19 @@ make_segment_meta_opexpr(QualPushdownContext *context, Oid opno, AttrNumber meta
 									uncompressed_var->varcollid);
 }
 
+/*
+ * The orderby columns always have the min/max metadata, and the other columns
+ * might have it if it was requested with the timescaledb.compress_minmax
+ * option.
+ */
 static AttrNumber
 get_segment_meta_min_attr_number(FormData_hypertable_compression *compression_info,
 								 Oid compressed_relid)
 {
-	char *meta_col_name = compression_column_segment_min_name(compression_info);
+	char *meta_col_name =
+		compression_info->orderby_column_index > 0 ?
+			compression_column_segment_min_name(compression_info) :
+			compression_column_segment_sparse_min_name(NameStr(compression_info->attname));
 
 	if (meta_col_name == NULL)
 		elog(ERROR, "could not find meta column");
@@ -143,7 +153,10 @@ static AttrNumber
 get_segment_meta_max_attr_number(FormData_hypertable_compression *compression_info,
 								 Oid compressed_relid)
 {
-	char *meta_col_name = compression_column_segment_max_name(compression_info);
+	char *meta_col_name =
+		compression_info->orderby_column_index > 0 ?
+			compression_column_segment_max_name(compression_info) :
+			compression_column_segment_sparse_max_name(NameStr(compression_info->attname));
 
 	if (meta_col_name == NULL)
 		elog(ERROR, "could not find meta column");
@@ -178,8 +191,17 @@ get_compression_info_for_column_with_segment_meta(QualPushdownContext *context,
 	v = (Var *) expr;
 
 	compression_info = get_compression_info_from_var(context, v);
-	/* Only order by vars have segment meta */
-	if (compression_info == NULL || compression_info->orderby_column_index <= 0)
+	if (compression_info == NULL || compression_info->segmentby_column_index > 0)
+		return NULL;
+
+	/* The order by vars always have segment meta, the other ones optionally */
+	if (compression_info->orderby_column_index > 0)
+		return compression_info;
+
+	char *sparse_min_col_name =
+		compression_column_segment_sparse_min_name(NameStr(compression_info->attname));
+	if (sparse_min_col_name == NULL ||
+		get_attnum(context->compressed_rte->relid, sparse_min_col_name) == InvalidAttrNumber)
 		return NULL;
 
 	return compression_info;
@@ -330,6 +352,98 @@ pushdown_op_to_segment_meta_min_max(QualPushdownContext *context, List *expr_arg
 	}
 }
 
+/*
+ * Push down the equality condition on a column with bloom filter metadata as
+ * a check of the bloom filter, so that the compressed scan skips the batches
+ * that don't contain the value. The bloom filter has false positives, so the
+ * original condition has to be rechecked.
+ */
+static Expr *
+pushdown_op_to_segment_meta_bloom(QualPushdownContext *context, List *expr_args, Oid op_oid,
+								  Oid op_collation)
+{
+	Expr *leftop, *rightop, *expr;
+	Var *var_with_bloom;
+	FormData_hypertable_compression *compression_info;
+
+	if (list_length(expr_args) != 2)
+		return NULL;
+
+	leftop = linitial(expr_args);
+	rightop = lsecond(expr_args);
+
+	if (IsA(leftop, RelabelType))
+		leftop = ((RelabelType *) leftop)->arg;
+	if (IsA(rightop, RelabelType))
+		rightop = ((RelabelType *) rightop)->arg;
+
+	if (IsA(leftop, Var) &&
+		(compression_info = get_compression_info_from_var(context, (Var *) leftop)) != NULL)
+	{
+		var_with_bloom = (Var *) leftop;
+		expr = rightop;
+	}
+	else if (IsA(rightop, Var) &&
+			 (compression_info = get_compression_info_from_var(context, (Var *) rightop)) != NULL)
+	{
+		var_with_bloom = (Var *) rightop;
+		expr = leftop;
+		op_oid = get_commutator(op_oid);
+	}
+	else
+		return NULL;
+
+	/* The segmentby columns are pushed down as is. */
+	if (compression_info->segmentby_column_index > 0)
+		return NULL;
+
+	char *bloom_col_name =
+		compression_column_segment_bloom_name(NameStr(compression_info->attname));
+	if (bloom_col_name == NULL)
+		return NULL;
+
+	AttrNumber bloom_attno = get_attnum(context->compressed_rte->relid, bloom_col_name);
+	if (bloom_attno == InvalidAttrNumber)
+		return NULL;
+
+	if (!OidIsValid(op_oid) || !op_strict(op_oid))
+		return NULL;
+
+	/* The bloom filter is built with the collation of the column. */
+	if (var_with_bloom->varcollid != op_collation)
+		return NULL;
+
+	/*
+	 * We can only check the values of the column type that are equal
+	 * according to the hash opfamily of the type, because the bloom filter
+	 * uses its hash function.
+	 */
+	TypeCacheEntry *tce = lookup_type_cache(var_with_bloom->vartype, TYPECACHE_HASH_OPFAMILY);
+	if (!OidIsValid(tce->hash_opf) ||
+		get_op_opfamily_strategy(op_oid, tce->hash_opf) != HTEqualStrategyNumber)
+		return NULL;
+
+	expr = get_pushdownsafe_expr(context, expr);
+	if (expr == NULL || exprType((Node *) expr) != var_with_bloom->vartype)
+		return NULL;
+
+	Oid argtypes[] = { BYTEAOID, ANYELEMENTOID };
+	Oid func_oid = ts_get_function_oid("bloom1_contains",
+									   FUNCTIONS_SCHEMA_NAME,
+									   lengthof(argtypes),
+									   argtypes);
+
+	Var *bloom_var =
+		makeVar(context->compressed_rel->relid, bloom_attno, BYTEAOID, -1, InvalidOid, 0);
+
+	return (Expr *) makeFuncExpr(func_oid,
+								 BOOLOID,
+								 list_make2(bloom_var, copyObject(expr)),
+								 /* funccollid = */ InvalidOid,
+								 /* inputcollid = */ var_with_bloom->varcollid,
+								 COERCE_EXPLICIT_CALL);
+}
+
 static Node *
 modify_expression(Node *node, QualPushdownContext *context)
 {
@@ -353,6 +467,16 @@ modify_expression(Node *node, QualPushdownContext *context)
 					/* pd is on the compressed table so do not mutate further */
 					return (Node *) pd;
 				}
+
+				pd = pushdown_op_to_segment_meta_bloom(context,
+													   opexpr->args,
+													   opexpr->opno,
+													   opexpr->inputcollid);
+				if (pd != NULL)
+				{
+					context->needs_recheck = true;
+					return (Node *) pd;
+				}
 			}
 			/* opexpr will still be checked for segment by columns */
 			break;
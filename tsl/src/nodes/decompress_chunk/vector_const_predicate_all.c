@@ -0,0 +1,60 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Instantiate all the supported vector-const comparison predicates, for all
+ * supported pairs of types. The float comparisons are done in float8, which
+ * represents all float4 values exactly, so the result is the same as for the
+ * float4 functions.
+ */
+
+#define PREDICATE_NAME EQ
+#define COMPARE_INTEGER(X, Y) ((X) == (Y))
+#define COMPARE_FLOAT(X, Y) float8_eq((float8) (X), (float8) (Y))
+#include "vector_const_predicate_types.c"
+#undef PREDICATE_NAME
+#undef COMPARE_INTEGER
+#undef COMPARE_FLOAT
+
+#define PREDICATE_NAME NE
+#define COMPARE_INTEGER(X, Y) ((X) != (Y))
+#define COMPARE_FLOAT(X, Y) float8_ne((float8) (X), (float8) (Y))
+#include "vector_const_predicate_types.c"
+#undef PREDICATE_NAME
+#undef COMPARE_INTEGER
+#undef COMPARE_FLOAT
+
+#define PREDICATE_NAME LT
+#define COMPARE_INTEGER(X, Y) ((X) < (Y))
+#define COMPARE_FLOAT(X, Y) float8_lt((float8) (X), (float8) (Y))
+#include "vector_const_predicate_types.c"
+#undef PREDICATE_NAME
+#undef COMPARE_INTEGER
+#undef COMPARE_FLOAT
+
+#define PREDICATE_NAME LE
+#define COMPARE_INTEGER(X, Y) ((X) <= (Y))
+#define COMPARE_FLOAT(X, Y) float8_le((float8) (X), (float8) (Y))
+#include "vector_const_predicate_types.c"
+#undef PREDICATE_NAME
+#undef COMPARE_INTEGER
+#undef COMPARE_FLOAT
+
+#define PREDICATE_NAME GT
+#define COMPARE_INTEGER(X, Y) ((X) > (Y))
+#define COMPARE_FLOAT(X, Y) float8_gt((float8) (X), (float8) (Y))
+#include "vector_const_predicate_types.c"
+#undef PREDICATE_NAME
+#undef COMPARE_INTEGER
+#undef COMPARE_FLOAT
+
+#define PREDICATE_NAME GE
+#define COMPARE_INTEGER(X, Y) ((X) >= (Y))
+#define COMPARE_FLOAT(X, Y) float8_ge((float8) (X), (float8) (Y))
+#include "vector_const_predicate_types.c"
+#undef PREDICATE_NAME
+#undef COMPARE_INTEGER
+#undef COMPARE_FLOAT
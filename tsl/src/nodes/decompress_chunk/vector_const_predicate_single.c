@@ -0,0 +1,69 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Compute a vector-const predicate and AND it to the filter bitmap.
+ * Specialized for particular arithmetic data types and predicate.
+ */
+
+#define FUNCTION_NAME_HELPER(PREDICATE, TYPES) predicate_##PREDICATE##_##TYPES##_vector_const
+#define FUNCTION_NAME(PREDICATE, TYPES) FUNCTION_NAME_HELPER(PREDICATE, TYPES)
+#define PG_PREDICATE_HELPER(X) PG_PREDICATE(X)
+
+#ifdef GENERATE_DISPATCH_TABLE
+case PG_PREDICATE_HELPER(PREDICATE_NAME):
+	return FUNCTION_NAME(PREDICATE_NAME, TYPE_PAIR_NAME);
+#else
+
+static void
+FUNCTION_NAME(PREDICATE_NAME, TYPE_PAIR_NAME)(const ArrowArray *arrow, const Datum constdatum,
+											  uint64 *restrict result)
+{
+	const size_t n = arrow->length;
+	const VECTOR_CTYPE *restrict vector = (const VECTOR_CTYPE *) arrow->buffers[1];
+	const CONST_CTYPE constvalue = CONST_CONVERSION(constdatum);
+
+	/*
+	 * Build the result bitmap 64 rows at a time. The inner loop has a fixed
+	 * number of iterations and no data dependencies between them, so that the
+	 * compiler can vectorize it.
+	 */
+	const size_t n_words = n / 64;
+	for (size_t outer = 0; outer < n_words; outer++)
+	{
+		uint64 word = 0;
+		for (size_t inner = 0; inner < 64; inner++)
+		{
+			const bool valid = PREDICATE_EXPRESSION(vector[outer * 64 + inner], constvalue);
+			word |= ((uint64) valid) << inner;
+		}
+		result[outer] &= word;
+	}
+
+	/* The tail, if the number of rows is not a multiple of 64. */
+	if (n % 64)
+	{
+		uint64 word = 0;
+		for (size_t i = n_words * 64; i < n; i++)
+		{
+			const bool valid = PREDICATE_EXPRESSION(vector[i], constvalue);
+			word |= ((uint64) valid) << (i % 64);
+		}
+		result[n_words] &= word;
+	}
+}
+
+#endif
+
+#undef FUNCTION_NAME
+#undef FUNCTION_NAME_HELPER
+#undef PG_PREDICATE_HELPER
+
+#undef VECTOR_CTYPE
+#undef CONST_CTYPE
+#undef CONST_CONVERSION
+#undef TYPE_PAIR_NAME
+#undef PG_PREDICATE
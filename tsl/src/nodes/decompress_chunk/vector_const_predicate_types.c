@@ -0,0 +1,144 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Instantiate the vector-const predicate given by PREDICATE_NAME for all the
+ * pairs of arithmetic types that have the respective Postgres comparison
+ * function. The comparison itself is given by COMPARE_INTEGER and
+ * COMPARE_FLOAT.
+ */
+
+#define PREDICATE_EXPRESSION(X, Y) COMPARE_INTEGER(X, Y)
+
+#define VECTOR_CTYPE int64
+#define CONST_CTYPE int64
+#define CONST_CONVERSION(X) DatumGetInt64(X)
+#define TYPE_PAIR_NAME int8
+#define PG_PREDICATE(X) F_INT8##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE int64
+#define CONST_CTYPE int32
+#define CONST_CONVERSION(X) DatumGetInt32(X)
+#define TYPE_PAIR_NAME int84
+#define PG_PREDICATE(X) F_INT84##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE int64
+#define CONST_CTYPE int16
+#define CONST_CONVERSION(X) DatumGetInt16(X)
+#define TYPE_PAIR_NAME int82
+#define PG_PREDICATE(X) F_INT82##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE int32
+#define CONST_CTYPE int64
+#define CONST_CONVERSION(X) DatumGetInt64(X)
+#define TYPE_PAIR_NAME int48
+#define PG_PREDICATE(X) F_INT48##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE int32
+#define CONST_CTYPE int32
+#define CONST_CONVERSION(X) DatumGetInt32(X)
+#define TYPE_PAIR_NAME int4
+#define PG_PREDICATE(X) F_INT4##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE int32
+#define CONST_CTYPE int16
+#define CONST_CONVERSION(X) DatumGetInt16(X)
+#define TYPE_PAIR_NAME int42
+#define PG_PREDICATE(X) F_INT42##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE int16
+#define CONST_CTYPE int64
+#define CONST_CONVERSION(X) DatumGetInt64(X)
+#define TYPE_PAIR_NAME int28
+#define PG_PREDICATE(X) F_INT28##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE int16
+#define CONST_CTYPE int32
+#define CONST_CONVERSION(X) DatumGetInt32(X)
+#define TYPE_PAIR_NAME int24
+#define PG_PREDICATE(X) F_INT24##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE int16
+#define CONST_CTYPE int16
+#define CONST_CONVERSION(X) DatumGetInt16(X)
+#define TYPE_PAIR_NAME int2
+#define PG_PREDICATE(X) F_INT2##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE DateADT
+#define CONST_CTYPE DateADT
+#define CONST_CONVERSION(X) DatumGetDateADT(X)
+#define TYPE_PAIR_NAME date
+#define PG_PREDICATE(X) F_DATE_##X
+#include "vector_const_predicate_single.c"
+
+/*
+ * Before PG14, the timestamp and timestamptz comparison functions share the
+ * same F_TIMESTAMP_* oid macros, because these macros were generated from the
+ * function prosrc. They compare the same int64 representation, so the
+ * predicate is the same anyway.
+ */
+#define VECTOR_CTYPE Timestamp
+#define CONST_CTYPE Timestamp
+#define CONST_CONVERSION(X) DatumGetTimestamp(X)
+#define TYPE_PAIR_NAME timestamp
+#define PG_PREDICATE(X) F_TIMESTAMP_##X
+#include "vector_const_predicate_single.c"
+
+#if PG14_GE
+#define VECTOR_CTYPE TimestampTz
+#define CONST_CTYPE TimestampTz
+#define CONST_CONVERSION(X) DatumGetTimestampTz(X)
+#define TYPE_PAIR_NAME timestamptz
+#define PG_PREDICATE(X) F_TIMESTAMPTZ_##X
+#include "vector_const_predicate_single.c"
+#endif
+
+#undef PREDICATE_EXPRESSION
+
+/*
+ * The float comparisons have to follow the Postgres semantics for NaN, which
+ * is equal to itself and greater than any other value.
+ */
+#define PREDICATE_EXPRESSION(X, Y) COMPARE_FLOAT(X, Y)
+
+#define VECTOR_CTYPE float8
+#define CONST_CTYPE float8
+#define CONST_CONVERSION(X) DatumGetFloat8(X)
+#define TYPE_PAIR_NAME float8
+#define PG_PREDICATE(X) F_FLOAT8##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE float8
+#define CONST_CTYPE float4
+#define CONST_CONVERSION(X) DatumGetFloat4(X)
+#define TYPE_PAIR_NAME float84
+#define PG_PREDICATE(X) F_FLOAT84##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE float4
+#define CONST_CTYPE float8
+#define CONST_CONVERSION(X) DatumGetFloat8(X)
+#define TYPE_PAIR_NAME float48
+#define PG_PREDICATE(X) F_FLOAT48##X
+#include "vector_const_predicate_single.c"
+
+#define VECTOR_CTYPE float4
+#define CONST_CTYPE float4
+#define CONST_CONVERSION(X) DatumGetFloat4(X)
+#define TYPE_PAIR_NAME float4
+#define PG_PREDICATE(X) F_FLOAT4##X
+#include "vector_const_predicate_single.c"
+
+#undef PREDICATE_EXPRESSION
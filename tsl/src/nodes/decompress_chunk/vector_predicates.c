@@ -0,0 +1,36 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Functions for working with vectorized predicates.
+ */
+
+#include <postgres.h>
+
+#include <utils/date.h>
+#include <utils/float.h>
+#include <utils/fmgroids.h>
+#include <utils/timestamp.h>
+
+#include "compat/compat.h"
+#include "compression/arrow_c_data_interface.h"
+#include "nodes/decompress_chunk/vector_predicates.h"
+
+/* Generate the predicate functions. */
+#include "vector_const_predicate_all.c"
+
+VectorPredicate *
+get_vector_const_predicate(Oid pg_predicate)
+{
+	switch (pg_predicate)
+	{
+#define GENERATE_DISPATCH_TABLE
+#include "vector_const_predicate_all.c"
+#undef GENERATE_DISPATCH_TABLE
+	}
+
+	return NULL;
+}
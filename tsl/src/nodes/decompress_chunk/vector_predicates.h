@@ -0,0 +1,27 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Functions for working with vectorized predicates.
+ */
+
+#pragma once
+
+#include "compression/arrow_c_data_interface.h"
+
+/*
+ * A vectorized predicate evaluates the comparison of every element of the
+ * given Arrow array with a constant, and ANDs the result into the given
+ * bitmap, which must have room for arrow->length bits. The validity bitmap of
+ * the array is not used, the caller has to account for the nulls separately.
+ */
+typedef void(VectorPredicate)(const ArrowArray *, Datum, uint64 *restrict);
+
+/*
+ * Returns the vectorized implementation of the given Postgres comparison
+ * function, or NULL if there is none.
+ */
+extern VectorPredicate *get_vector_const_predicate(Oid pg_predicate);
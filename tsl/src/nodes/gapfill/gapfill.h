@@ -16,6 +16,8 @@
 #define GAPFILL_INTERPOLATE_FUNCTION "interpolate"
 
 bool gapfill_in_expression(Expr *node);
+bool is_gapfill_function_call(FuncExpr *call);
+List *gapfill_bucket_args(FuncExpr *call);
 void plan_add_gapfill(PlannerInfo *root, RelOptInfo *group_rel);
 void gapfill_adjust_window_targetlist(PlannerInfo *root, RelOptInfo *input_rel,
 									  RelOptInfo *output_rel);
@@ -24,6 +26,7 @@ typedef struct GapFillPath
 {
 	CustomPath cpath;
 	FuncExpr *func; /* time_bucket_gapfill function call */
+	bool hashed;	/* collect the groups in a hash table instead of sorting */
 } GapFillPath;
 
 #endif /* TIMESCALEDB_TSL_NODES_GAPFILL_H */
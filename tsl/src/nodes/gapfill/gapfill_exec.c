@@ -11,6 +11,8 @@
 #include <catalog/pg_cast.h>
 #include <catalog/pg_collation.h>
 #include <catalog/pg_type.h>
+#include <commands/explain.h>
+#include <executor/executor.h>
 #include <miscadmin.h>
 #include <nodes/extensible.h>
 #include <nodes/makefuncs.h>
@@ -41,6 +43,23 @@ typedef enum GapFillBoundary
 	GAPFILL_END,
 } GapFillBoundary;
 
+/*
+ * A tuple of a group in hashed mode together with its time, so that the
+ * tuples of the group can be sorted without deforming them.
+ */
+typedef struct GapFillHashTuple
+{
+	int64 time;
+	MinimalTuple tuple;
+} GapFillHashTuple;
+
+typedef struct GapFillHashGroup
+{
+	int ntuples;
+	int maxtuples;
+	GapFillHashTuple *tuples;
+} GapFillHashGroup;
+
 typedef union GapFillColumnStateUnion
 {
 	GapFillColumnState *base;
@@ -59,6 +78,7 @@ static void gapfill_begin(CustomScanState *node, EState *estate, int eflags);
 static void gapfill_end(CustomScanState *node);
 static void gapfill_rescan(CustomScanState *node);
 static TupleTableSlot *gapfill_exec(CustomScanState *node);
+static void gapfill_explain(CustomScanState *node, List *ancestors, ExplainState *es);
 
 static void gapfill_state_reset_group(GapFillState *state, TupleTableSlot *slot);
 static TupleTableSlot *gapfill_state_gaptuple_create(GapFillState *state, int64 time);
@@ -66,6 +86,8 @@ static bool gapfill_state_is_new_group(GapFillState *state, TupleTableSlot *slot
 static void gapfill_state_set_next(GapFillState *state, TupleTableSlot *subslot);
 static TupleTableSlot *gapfill_state_return_subplan_slot(GapFillState *state);
 static TupleTableSlot *gapfill_fetch_next_tuple(GapFillState *state);
+static void gapfill_hash_init(GapFillState *state);
+static void gapfill_hash_reset(GapFillState *state);
 static void gapfill_state_initialize_columns(GapFillState *state);
 static GapFillColumnState *gapfill_column_state_create(GapFillColumnType ctype, Oid typeid);
 static bool gapfill_is_group_column(GapFillState *state, TargetEntry *tle);
@@ -76,6 +98,19 @@ static CustomExecMethods gapfill_state_methods = {
 	.ExecCustomScan = gapfill_exec,
 	.EndCustomScan = gapfill_end,
 	.ReScanCustomScan = gapfill_rescan,
+	.ExplainCustomScan = gapfill_explain,
+};
+
+typedef enum GapFillTimingPhase
+{
+	GAPFILL_TIMING_GAP_TUPLE = 0,
+	GAPFILL_TIMING_HASH_INSERT,
+	_GAPFILL_TIMING_PHASES,
+} GapFillTimingPhase;
+
+static const char *const gapfill_timing_names[_GAPFILL_TIMING_PHASES] = {
+	[GAPFILL_TIMING_GAP_TUPLE] = "Gap Tuple Time",
+	[GAPFILL_TIMING_HASH_INSERT] = "Hash Insert Time",
 };
 
 /*
@@ -796,6 +831,12 @@ gapfill_begin(CustomScanState *node, EState *estate, int eflags)
 										NULL);
 
 	state->csstate.custom_ps = list_make1(ExecInitNode(state->subplan, estate, eflags));
+
+	state->hashed = intVal(list_nth(cscan->custom_private, 4));
+	if (state->hashed)
+		gapfill_hash_init(state);
+
+	ts_node_timing_init(&state->timing, estate, gapfill_timing_names, _GAPFILL_TIMING_PHASES);
 }
 
 /*
@@ -858,8 +899,12 @@ gapfill_exec(CustomScanState *node)
 		/* if we are within gapfill boundaries we need to insert tuple */
 		if (state->next_timestamp < state->gapfill_end)
 		{
+			instr_time start;
+
 			Assert(state->state != FETCHED_NONE);
+			ts_node_timing_start(&state->timing, &start);
 			slot = gapfill_state_gaptuple_create(state, state->next_timestamp);
+			ts_node_timing_stop(&state->timing, GAPFILL_TIMING_GAP_TUPLE, &start);
 			gapfill_advance_timestamp(state);
 			return slot;
 		}
@@ -903,6 +948,15 @@ gapfill_rescan(CustomScanState *node)
 		ExecReScan(linitial(node->custom_ps));
 	}
 	((GapFillState *) node)->state = FETCHED_NONE;
+
+	if (((GapFillState *) node)->hashed)
+		gapfill_hash_reset((GapFillState *) node);
+}
+
+static void
+gapfill_explain(CustomScanState *node, List *ancestors, ExplainState *es)
+{
+	ts_node_timing_explain(&((GapFillState *) node)->timing, es);
 }
 
 static void
@@ -933,6 +987,8 @@ gapfill_state_reset_group(GapFillState *state, TupleTableSlot *slot)
 				if (!isnull)
 					column.group->value =
 						datumCopy(value, column.base->typbyval, column.base->typlen);
+				state->gap_values[i] = column.group->value;
+				state->gap_isnull[i] = column.group->isnull;
 				break;
 			default:
 				break;
@@ -954,28 +1010,14 @@ gapfill_state_gaptuple_create(GapFillState *state, int64 time)
 
 	/*
 	 * we need to fill in group columns first because locf and interpolation
-	 * might reference those columns when doing out of bounds lookup
+	 * might reference those columns when doing out of bounds lookup. The
+	 * group columns only change with the group, so they are copied from the
+	 * values prepared when the group became active.
 	 */
-	foreach_column(column.base, i, state)
-	{
-		switch (column.base->ctype)
-		{
-			case TIME_COLUMN:
-				slot->tts_values[i] = gapfill_internal_get_datum(time, state->gapfill_typid);
-				slot->tts_isnull[i] = false;
-				break;
-			case GROUP_COLUMN:
-			case DERIVED_COLUMN:
-				slot->tts_values[i] = column.group->value;
-				slot->tts_isnull[i] = column.group->isnull;
-				break;
-			case NULL_COLUMN:
-				slot->tts_isnull[i] = true;
-				break;
-			default:
-				break;
-		}
-	}
+	memcpy(slot->tts_values, state->gap_values, sizeof(Datum) * state->ncolumns);
+	memcpy(slot->tts_isnull, state->gap_isnull, sizeof(bool) * state->ncolumns);
+	slot->tts_values[state->time_index] = gapfill_internal_get_datum(time, state->gapfill_typid);
+	slot->tts_isnull[state->time_index] = false;
 
 	/*
 	 * mark slot as containing data so it can be used in locf and interpolate
@@ -983,8 +1025,11 @@ gapfill_state_gaptuple_create(GapFillState *state, int64 time)
 	 */
 	ExecStoreVirtualTuple(slot);
 
-	foreach_column(column.base, i, state)
+	for (int m = 0; m < state->nmarkers; m++)
 	{
+		i = state->marker_columns[m];
+		column.base = state->columns[i];
+
 		switch (column.base->ctype)
 		{
 			case LOCF_COLUMN:
@@ -1132,13 +1177,204 @@ gapfill_state_set_next(GapFillState *state, TupleTableSlot *subslot)
 	}
 }
 
-static TupleTableSlot *
-gapfill_fetch_next_tuple(GapFillState *state)
+static int64
+gapfill_slot_get_time(GapFillState *state, TupleTableSlot *slot)
 {
 	Datum time_value;
 	bool isnull;
-	PlanState *subplan = linitial(castNode(CustomScanState, state)->custom_ps);
-	TupleTableSlot *subslot = ExecProcNode(subplan);
+
+	time_value = slot_getattr(slot, AttrOffsetGetAttrNumber(state->time_index), &isnull);
+	if (isnull)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid time_bucket_gapfill argument: ts cannot be NULL")));
+
+	return gapfill_datum_get_internal(time_value, state->gapfill_typid);
+}
+
+/*
+ * Set up the hash table of the hashed mode. The groups are identified by the
+ * GROUP BY columns other than the time bucket.
+ */
+static void
+gapfill_hash_init(GapFillState *state)
+{
+	CustomScan *cscan = castNode(CustomScan, state->csstate.ss.ps.plan);
+	PlanState *subplan = linitial(state->csstate.custom_ps);
+	TupleDesc subdesc = ExecGetResultType(subplan);
+	List *groups = lsecond(cscan->custom_private);
+	AttrNumber *key_columns = palloc(sizeof(AttrNumber) * state->ncolumns);
+	Oid *eq_operators = palloc(sizeof(Oid) * state->ncolumns);
+	Oid *collations = palloc(sizeof(Oid) * state->ncolumns);
+	long nbuckets = Max(Min((long) subplan->plan->plan_rows, 1024L), 16L);
+	Oid *eq_funcs;
+	FmgrInfo *hash_funcs;
+	int num_keys = 0;
+	int i;
+
+	for (i = 0; i < state->ncolumns; i++)
+	{
+		TargetEntry *tle;
+		ListCell *lc;
+
+		if (state->columns[i]->ctype != GROUP_COLUMN)
+			continue;
+
+		tle = list_nth(cscan->custom_scan_tlist, i);
+
+		foreach (lc, groups)
+		{
+			SortGroupClause *sgc = lfirst_node(SortGroupClause, lc);
+
+			if (sgc->tleSortGroupRef == tle->ressortgroupref)
+			{
+				eq_operators[num_keys] = sgc->eqop;
+				break;
+			}
+		}
+
+		Assert(lc != NULL);
+		key_columns[num_keys] = AttrOffsetGetAttrNumber(i);
+		collations[num_keys] = exprCollation((Node *) tle->expr);
+		num_keys++;
+	}
+
+	execTuplesHashPrepare(num_keys, eq_operators, &eq_funcs, &hash_funcs);
+
+	state->hash_cxt =
+		AllocSetContextCreate(CurrentMemoryContext, "GapFill hash table", ALLOCSET_DEFAULT_SIZES);
+	state->hashtable =
+		BuildTupleHashTableExt(&state->csstate.ss.ps,
+							   subdesc,
+							   num_keys,
+							   key_columns,
+							   eq_funcs,
+							   hash_funcs,
+							   collations,
+							   nbuckets,
+							   0,
+							   CurrentMemoryContext,
+							   state->hash_cxt,
+							   state->csstate.ss.ps.ps_ExprContext->ecxt_per_tuple_memory,
+							   false);
+	state->hashslot = MakeSingleTupleTableSlot(subdesc, &TTSOpsMinimalTuple);
+	state->hash_built = false;
+}
+
+static void
+gapfill_hash_reset(GapFillState *state)
+{
+	if (!state->hash_built)
+		return;
+
+	ResetTupleHashTable(state->hashtable);
+	MemoryContextReset(state->hash_cxt);
+	state->hash_group = NULL;
+	state->hash_built = false;
+}
+
+/*
+ * Read all the subplan tuples into the groups of the hash table.
+ */
+static void
+gapfill_hash_build(GapFillState *state)
+{
+	PlanState *subplan = linitial(state->csstate.custom_ps);
+	TupleTableSlot *slot;
+
+	while (!TupIsNull(slot = ExecProcNode(subplan)))
+	{
+		int64 time = gapfill_slot_get_time(state, slot);
+		GapFillHashGroup *group;
+		TupleHashEntry entry;
+		MemoryContext oldcxt;
+		bool isnew;
+		instr_time start;
+
+		ts_node_timing_start(&state->timing, &start);
+		entry = LookupTupleHashEntry(state->hashtable, slot, &isnew, NULL);
+		oldcxt = MemoryContextSwitchTo(state->hash_cxt);
+
+		if (isnew)
+		{
+			group = palloc0(sizeof(GapFillHashGroup));
+			group->maxtuples = 8;
+			group->tuples = palloc(sizeof(GapFillHashTuple) * group->maxtuples);
+			entry->additional = group;
+		}
+		else
+			group = entry->additional;
+
+		if (group->ntuples == group->maxtuples)
+		{
+			group->maxtuples *= 2;
+			group->tuples = repalloc(group->tuples, sizeof(GapFillHashTuple) * group->maxtuples);
+		}
+
+		group->tuples[group->ntuples].time = time;
+		group->tuples[group->ntuples].tuple = ExecCopySlotMinimalTuple(slot);
+		group->ntuples++;
+
+		MemoryContextSwitchTo(oldcxt);
+		ts_node_timing_stop(&state->timing, GAPFILL_TIMING_HASH_INSERT, &start);
+	}
+
+	InitTupleHashIterator(state->hashtable, &state->hashiter);
+	state->hash_group = NULL;
+	state->hash_group_pos = 0;
+	state->hash_built = true;
+}
+
+static int
+gapfill_hash_tuple_cmp(const void *a, const void *b)
+{
+	int64 t1 = ((const GapFillHashTuple *) a)->time;
+	int64 t2 = ((const GapFillHashTuple *) b)->time;
+
+	return (t1 > t2) - (t1 < t2);
+}
+
+/*
+ * Return the next tuple in hashed mode. The groups are returned one after the
+ * other, in no particular order, and the tuples of a group are sorted by time
+ * when we get to the group.
+ */
+static TupleTableSlot *
+gapfill_hash_next_tuple(GapFillState *state)
+{
+	GapFillHashGroup *group;
+
+	if (!state->hash_built)
+		gapfill_hash_build(state);
+
+	while (state->hash_group == NULL || state->hash_group_pos >= state->hash_group->ntuples)
+	{
+		TupleHashEntry entry = ScanTupleHashTable(state->hashtable, &state->hashiter);
+
+		if (entry == NULL)
+			return NULL;
+
+		group = entry->additional;
+		qsort(group->tuples, group->ntuples, sizeof(GapFillHashTuple), gapfill_hash_tuple_cmp);
+		state->hash_group = group;
+		state->hash_group_pos = 0;
+	}
+
+	group = state->hash_group;
+	return ExecStoreMinimalTuple(group->tuples[state->hash_group_pos++].tuple,
+								 state->hashslot,
+								 false);
+}
+
+static TupleTableSlot *
+gapfill_fetch_next_tuple(GapFillState *state)
+{
+	TupleTableSlot *subslot;
+
+	if (state->hashed)
+		subslot = gapfill_hash_next_tuple(state);
+	else
+		subslot = ExecProcNode(linitial(castNode(CustomScanState, state)->custom_ps));
 
 	if (TupIsNull(subslot))
 		return NULL;
@@ -1148,13 +1384,7 @@ gapfill_fetch_next_tuple(GapFillState *state)
 	 * modify it
 	 */
 	ExecCopySlot(state->subslot, subslot);
-	time_value = slot_getattr(subslot, AttrOffsetGetAttrNumber(state->time_index), &isnull);
-	if (isnull)
-		ereport(ERROR,
-				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-				 errmsg("invalid time_bucket_gapfill argument: ts cannot be NULL")));
-
-	state->subslot_time = gapfill_datum_get_internal(time_value, state->gapfill_typid);
+	state->subslot_time = gapfill_slot_get_time(state, subslot);
 
 	return state->subslot;
 }
@@ -1173,6 +1403,13 @@ gapfill_state_initialize_columns(GapFillState *state)
 
 	state->ncolumns = tupledesc->natts;
 	state->columns = palloc(state->ncolumns * sizeof(GapFillColumnState *));
+	state->gap_values = palloc0(state->ncolumns * sizeof(Datum));
+	state->gap_isnull = palloc(state->ncolumns * sizeof(bool));
+	state->marker_columns = palloc(state->ncolumns * sizeof(int));
+	state->nmarkers = 0;
+
+	/* group columns are filled in when the first group becomes active */
+	memset(state->gap_isnull, true, state->ncolumns * sizeof(bool));
 
 	for (i = 0; i < state->ncolumns; i++)
 	{
@@ -1214,6 +1451,7 @@ gapfill_state_initialize_columns(GapFillState *state)
 				gapfill_locf_initialize((GapFillLocfColumnState *) state->columns[i],
 										state,
 										(FuncExpr *) expr);
+				state->marker_columns[state->nmarkers++] = i;
 				continue;
 			}
 			if (strncmp(get_func_name(castNode(FuncExpr, expr)->funcid),
@@ -1226,6 +1464,7 @@ gapfill_state_initialize_columns(GapFillState *state)
 				gapfill_interpolate_initialize((GapFillInterpolateColumnState *) state->columns[i],
 											   state,
 											   (FuncExpr *) expr);
+				state->marker_columns[state->nmarkers++] = i;
 				continue;
 			}
 		}
@@ -9,6 +9,8 @@
 #include <postgres.h>
 #include <nodes/execnodes.h>
 
+#include "nodes/node_timing.h"
+
 /*
  * GapFillFetchState describes the state of subslot in GapFillState:
  * FETCHED_NONE: no tuple in subslot
@@ -115,9 +117,35 @@ typedef struct GapFillState
 	int ncolumns;
 	GapFillColumnState **columns;
 
+	/*
+	 * Values of the gapfilled tuples that are the same for all the gapfilled
+	 * tuples of a group, and the locf and interpolate columns that have to be
+	 * computed for every gapfilled tuple.
+	 */
+	Datum *gap_values;
+	bool *gap_isnull;
+	int nmarkers;
+	int *marker_columns;
+
 	ProjectionInfo *pi;
 	TupleTableSlot *scanslot;
 	GapFillFetchState state;
+
+	/*
+	 * Hashed mode: the subplan tuples are collected per group in a hash table
+	 * and returned group by group in time order, so the subplan does not need
+	 * to be sorted.
+	 */
+	bool hashed;
+	bool hash_built;
+	TupleHashTable hashtable;
+	TupleHashIterator hashiter;
+	MemoryContext hash_cxt;
+	TupleTableSlot *hashslot;		  /* slot for the tuples from the hash table */
+	struct GapFillHashGroup *hash_group; /* group being returned */
+	int hash_group_pos;				  /* next tuple of the group to return */
+
+	TsNodeTiming timing;
 } GapFillState;
 
 Node *gapfill_state_create(CustomScan *);
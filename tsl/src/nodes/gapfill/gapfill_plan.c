@@ -5,10 +5,13 @@
  */
 
 #include <postgres.h>
+#include <access/htup_details.h>
+#include <miscadmin.h>
 #include <nodes/execnodes.h>
 #include <nodes/extensible.h>
 #include <nodes/nodeFuncs.h>
 #include <optimizer/clauses.h>
+#include <optimizer/cost.h>
 #include <optimizer/optimizer.h>
 #include <optimizer/pathnode.h>
 #include <optimizer/paths.h>
@@ -19,6 +22,7 @@
 #include "compat/compat.h"
 
 #include "gapfill.h"
+#include "guc.h"
 #include "gapfill_internal.h"
 
 static CustomScanMethods gapfill_plan_methods = {
@@ -41,13 +45,26 @@ typedef struct gapfill_walker_context
 /*
  * FuncExpr is time_bucket_gapfill function call
  */
-static inline bool
+bool
 is_gapfill_function_call(FuncExpr *call)
 {
 	char *func_name = get_func_name(call->funcid);
 	return strncmp(func_name, GAPFILL_FUNCTION, NAMEDATALEN) == 0;
 }
 
+/*
+ * Get the arguments of a time_bucket_gapfill call that time_bucket takes,
+ * i.e., all arguments except start and finish. The bucket of a
+ * time_bucket_gapfill call is the same as the bucket of time_bucket with
+ * these arguments.
+ */
+List *
+gapfill_bucket_args(FuncExpr *call)
+{
+	Assert(list_length(call->args) >= 4);
+	return list_truncate(list_copy(call->args), list_length(call->args) - 2);
+}
+
 /*
  * FuncExpr is locf or interpolate function call
  */
@@ -187,8 +204,11 @@ gapfill_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *path, List *
 	cscan->flags = path->flags;
 	cscan->methods = &gapfill_plan_methods;
 
-	cscan->custom_private =
-		list_make4(gfpath->func, root->parse->groupClause, root->parse->jointree, args);
+	cscan->custom_private = list_make5(gfpath->func,
+									   root->parse->groupClause,
+									   root->parse->jointree,
+									   args,
+									   makeInteger(gfpath->hashed));
 
 	return &cscan->scan.plan;
 }
@@ -328,9 +348,13 @@ gapfill_build_pathtarget(PathTarget *pt_upper, PathTarget *pt_path, PathTarget *
  * The gap fill node needs rows to be sorted by time ASC
  * so we insert sort pathes if the query order does not match
  * that
+ *
+ * A hashed gapfill node instead collects the rows of each group in a hash
+ * table and sorts the (much smaller) groups by time when returning them, so
+ * it takes unsorted input but does not return the groups in any order.
  */
 static Path *
-gapfill_path_create(PlannerInfo *root, Path *subpath, FuncExpr *func)
+gapfill_path_create(PlannerInfo *root, Path *subpath, FuncExpr *func, bool hashed)
 {
 	GapFillPath *path;
 
@@ -355,11 +379,33 @@ gapfill_path_create(PlannerInfo *root, Path *subpath, FuncExpr *func)
 							 path->cpath.path.pathtarget,
 							 subpath->pathtarget);
 
+	if (hashed)
+	{
+		int num_group_cols = list_length(root->parse->groupClause);
+
+		/*
+		 * Hash the non-time group columns of every row and sort the rows of
+		 * each group by time. The sort is charged as if the groups were of
+		 * the same size.
+		 */
+		path->cpath.path.startup_cost =
+			subpath->total_cost + subpath->rows * cpu_operator_cost * (num_group_cols - 1);
+		path->cpath.path.total_cost =
+			path->cpath.path.startup_cost + subpath->rows * cpu_tuple_cost;
+		path->cpath.path.pathkeys = NIL;
+		path->cpath.custom_paths = list_make1(subpath);
+		path->func = func;
+		path->hashed = true;
+
+		return &path->cpath.path;
+	}
+
 	if (!gapfill_correct_order(root, subpath, func))
 	{
 		List *new_order = NIL;
 		ListCell *lc;
 		PathKey *pk_func = NULL;
+		int presorted_keys;
 
 		/* subpath does not have correct order */
 		foreach (lc, root->group_pathkeys)
@@ -388,8 +434,24 @@ gapfill_path_create(PlannerInfo *root, Path *subpath, FuncExpr *func)
 					 errmsg("no top level time_bucket_gapfill in group by clause")));
 
 		new_order = lappend(new_order, pk_func);
-		subpath = (Path *)
-			create_sort_path(root, subpath->parent, subpath, new_order, root->limit_tuples);
+
+		/*
+		 * If the input is already sorted by the leading group columns, only
+		 * the rows of each of those groups have to be sorted, one group at a
+		 * time, instead of the whole input.
+		 */
+		(void) pathkeys_count_contained_in(new_order, subpath->pathkeys, &presorted_keys);
+
+		if (enable_incremental_sort && presorted_keys > 0)
+			subpath = (Path *) create_incremental_sort_path(root,
+															subpath->parent,
+															subpath,
+															new_order,
+															presorted_keys,
+															root->limit_tuples);
+		else
+			subpath = (Path *)
+				create_sort_path(root, subpath->parent, subpath, new_order, root->limit_tuples);
 	}
 
 	path->cpath.path.startup_cost = subpath->startup_cost;
@@ -401,6 +463,20 @@ gapfill_path_create(PlannerInfo *root, Path *subpath, FuncExpr *func)
 	return &path->cpath.path;
 }
 
+/*
+ * The hashed gapfill node keeps all of its input in memory, so we only
+ * consider it when the input fits in work_mem. Larger inputs go through the
+ * sorted gapfill node, whose Sort can spill to disk.
+ */
+static bool
+gapfill_hash_fits_in_memory(Path *subpath)
+{
+	double tuple_size = MAXALIGN(subpath->pathtarget->width) +
+						MAXALIGN(SizeofMinimalTupleHeader) + 2 * sizeof(Datum);
+
+	return subpath->rows * tuple_size < work_mem * 1024.0;
+}
+
 /*
  * Prepend GapFill node to every group_rel path.
  * The implementation assumes that TimescaleDB planning hook is called only once
@@ -447,9 +523,22 @@ plan_add_gapfill(PlannerInfo *root, RelOptInfo *group_rel)
 		list_free(group_rel->cheapest_parameterized_paths);
 		group_rel->cheapest_parameterized_paths = NULL;
 
+		/*
+		 * The hashed gapfill node only pays off when there are group columns
+		 * besides the time bucket, and the input is not already sorted.
+		 */
+		bool try_hashed = ts_guc_enable_hashed_gapfill && list_length(parse->groupClause) > 1 &&
+						  grouping_is_hashable(parse->groupClause);
+
 		foreach (lc, copy)
 		{
-			add_path(group_rel, gapfill_path_create(root, lfirst(lc), context.call.func));
+			Path *subpath = lfirst(lc);
+
+			if (try_hashed && !gapfill_correct_order(root, subpath, context.call.func) &&
+				gapfill_hash_fits_in_memory(subpath))
+				add_path(group_rel, gapfill_path_create(root, subpath, context.call.func, true));
+
+			add_path(group_rel, gapfill_path_create(root, subpath, context.call.func, false));
 		}
 		list_free(copy);
 	}
@@ -9,6 +9,7 @@
 #include <catalog/pg_type.h>
 #include <utils/builtins.h>
 #include <utils/datum.h>
+#include <utils/memutils.h>
 #include <utils/typcache.h>
 #include <utils/numeric.h>
 
@@ -27,6 +28,8 @@ gapfill_interpolate_initialize(GapFillInterpolateColumnState *interpolate, GapFi
 {
 	interpolate->prev.isnull = true;
 	interpolate->next.isnull = true;
+	interpolate->terms.valid = false;
+	interpolate->terms.mcxt = NULL;
 	if (list_length(((FuncExpr *) function)->args) > 1)
 		interpolate->lookup_before =
 			gapfill_adjust_varnos(state, lsecond(((FuncExpr *) function)->args));
@@ -44,6 +47,7 @@ gapfill_interpolate_group_change(GapFillInterpolateColumnState *column, int64 ti
 {
 	column->prev.isnull = true;
 	column->next.isnull = isnull;
+	column->terms.valid = false;
 	if (!isnull)
 	{
 		column->next.time = time;
@@ -59,6 +63,7 @@ gapfill_interpolate_tuple_fetched(GapFillInterpolateColumnState *column, int64 t
 								  bool isnull)
 {
 	column->next.isnull = isnull;
+	column->terms.valid = false;
 	if (!isnull)
 	{
 		column->next.time = time;
@@ -75,6 +80,7 @@ gapfill_interpolate_tuple_returned(GapFillInterpolateColumnState *column, int64
 {
 	column->next.isnull = true;
 	column->prev.isnull = isnull;
+	column->terms.valid = false;
 	if (!isnull)
 	{
 		column->prev.time = time;
@@ -96,6 +102,8 @@ gapfill_fetch_sample(GapFillState *state, GapFillInterpolateColumnState *column,
 	bool isnull;
 	Datum datum = gapfill_exec_expr(state, lookup, &isnull);
 
+	column->terms.valid = false;
+
 	if (isnull)
 	{
 		sample->isnull = true;
@@ -151,23 +159,79 @@ gapfill_fetch_sample(GapFillState *state, GapFillInterpolateColumnState *column,
 	ReleaseTupleDesc(tupdesc);
 }
 
-/* Calculate the interpolation using numerics, returning the result as a numeric datum */
+/*
+ * Calculate the interpolation of an integer column using numerics.
+ *
+ * Going from one gapfilled tuple at x to the next one at x', the numerator
+ * y0(x1-x) + y1(x-x0) changes by (x'-x)(y1-y0). So instead of converting all the
+ * operands to numerics for every gapfilled tuple, we compute the terms once per
+ * gap and only update the numerator. Numeric addition and multiplication are
+ * exact, so the result is the same as computing it from scratch.
+ */
 static Datum
-interpolate_numeric(int64 x_i, int64 x0_i, int64 x1_i, Datum y0, Datum y1)
+interpolate_integer(GapFillInterpolateColumnState *column, GapFillState *state, int64 x,
+					PGFunction to_numeric, PGFunction from_numeric)
 {
-	Datum x0 = DirectFunctionCall1(int8_numeric, Int64GetDatum(x0_i));
-	Datum x1 = DirectFunctionCall1(int8_numeric, Int64GetDatum(x1_i));
-	Datum x = DirectFunctionCall1(int8_numeric, Int64GetDatum(x_i));
+	GapFillInterpolateTerms *terms = &column->terms;
+	MemoryContext oldcxt;
+	Datum numerator;
+
+	if (terms->mcxt == NULL)
+		terms->mcxt =
+			AllocSetContextCreate(CurrentMemoryContext, "interpolate", ALLOCSET_SMALL_SIZES);
+
+	if (!terms->valid || x < terms->time)
+	{
+		Datum y0, y1, x0, x1, xx;
+
+		MemoryContextReset(terms->mcxt);
+		oldcxt = MemoryContextSwitchTo(terms->mcxt);
 
-	Datum x1_sub_x = DirectFunctionCall2(numeric_sub, x1, x);
-	Datum x_sub_x0 = DirectFunctionCall2(numeric_sub, x, x0);
-	Datum y0_mul_x1_sub_x = DirectFunctionCall2(numeric_mul, y0, x1_sub_x);
-	Datum y1_mul_x_sub_x0 = DirectFunctionCall2(numeric_mul, y1, x_sub_x0);
+		y0 = DirectFunctionCall1(to_numeric, column->prev.value);
+		y1 = DirectFunctionCall1(to_numeric, column->next.value);
+		x0 = DirectFunctionCall1(int8_numeric, Int64GetDatum(column->prev.time));
+		x1 = DirectFunctionCall1(int8_numeric, Int64GetDatum(column->next.time));
+		xx = DirectFunctionCall1(int8_numeric, Int64GetDatum(x));
+
+		terms->numerator =
+			DirectFunctionCall2(numeric_add,
+								DirectFunctionCall2(numeric_mul,
+													y0,
+													DirectFunctionCall2(numeric_sub, x1, xx)),
+								DirectFunctionCall2(numeric_mul,
+													y1,
+													DirectFunctionCall2(numeric_sub, xx, x0)));
+		terms->slope = DirectFunctionCall2(numeric_sub, y1, y0);
+		terms->denominator = DirectFunctionCall2(numeric_sub, x1, x0);
+		terms->time = x;
+		terms->valid = true;
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	else if (x > terms->time)
+	{
+		Datum old = terms->numerator;
+		Datum dx;
+
+		/* the intermediate results only live until the tuple is projected */
+		oldcxt = MemoryContextSwitchTo(state->csstate.ss.ps.ps_ExprContext->ecxt_per_tuple_memory);
+		dx = DirectFunctionCall1(int8_numeric, Int64GetDatum(x - terms->time));
+		numerator = DirectFunctionCall2(numeric_add,
+										old,
+										DirectFunctionCall2(numeric_mul, terms->slope, dx));
+
+		MemoryContextSwitchTo(terms->mcxt);
+		terms->numerator = datumCopy(numerator, false, -1);
+		terms->time = x;
+		pfree(DatumGetPointer(old));
+		MemoryContextSwitchTo(oldcxt);
+	}
 
-	Datum numerator = DirectFunctionCall2(numeric_add, y0_mul_x1_sub_x, y1_mul_x_sub_x0);
-	Datum denominator = DirectFunctionCall2(numeric_sub, x1, x0);
+	oldcxt = MemoryContextSwitchTo(state->csstate.ss.ps.ps_ExprContext->ecxt_per_tuple_memory);
+	numerator = DirectFunctionCall2(numeric_div, terms->numerator, terms->denominator);
+	MemoryContextSwitchTo(oldcxt);
 
-	return DirectFunctionCall2(numeric_div, numerator, denominator);
+	return DirectFunctionCall1(from_numeric, numerator);
 }
 
 /*
@@ -210,31 +274,13 @@ gapfill_interpolate_calculate(GapFillInterpolateColumnState *column, GapFillStat
 		 doesn't handle really big ints exactly. We can't use the Postgres INT128 implementation
 		 because it doesn't support division. */
 		case INT2OID:
-			*value =
-				DirectFunctionCall1(numeric_int2,
-									interpolate_numeric(x,
-														x0,
-														x1,
-														DirectFunctionCall1(int2_numeric, y0),
-														DirectFunctionCall1(int2_numeric, y1)));
+			*value = interpolate_integer(column, state, x, int2_numeric, numeric_int2);
 			break;
 		case INT4OID:
-			*value =
-				DirectFunctionCall1(numeric_int4,
-									interpolate_numeric(x,
-														x0,
-														x1,
-														DirectFunctionCall1(int4_numeric, y0),
-														DirectFunctionCall1(int4_numeric, y1)));
+			*value = interpolate_integer(column, state, x, int4_numeric, numeric_int4);
 			break;
 		case INT8OID:
-			*value =
-				DirectFunctionCall1(numeric_int8,
-									interpolate_numeric(x,
-														x0,
-														x1,
-														DirectFunctionCall1(int8_numeric, y0),
-														DirectFunctionCall1(int8_numeric, y1)));
+			*value = interpolate_integer(column, state, x, int8_numeric, numeric_int8);
 			break;
 		case FLOAT4OID:
 			/* Shortcircuit calculation when y0 == y1 for float because otherwise
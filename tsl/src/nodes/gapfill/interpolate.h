@@ -15,6 +15,20 @@ typedef struct GapFillInterpolateSample
 	bool isnull;
 } GapFillInterpolateSample;
 
+/*
+ * Numeric terms of the interpolation of an integer column between the prev
+ * and next samples, kept for all the gapfilled tuples of a gap.
+ */
+typedef struct GapFillInterpolateTerms
+{
+	bool valid;
+	int64 time;		   /* time the numerator was computed for */
+	Datum numerator;   /* y0(x1-x) + y1(x-x0) */
+	Datum slope;	   /* y1 - y0 */
+	Datum denominator; /* x1 - x0 */
+	MemoryContext mcxt;
+} GapFillInterpolateTerms;
+
 typedef struct GapFillInterpolateColumnState
 {
 	GapFillColumnState base;
@@ -22,6 +36,7 @@ typedef struct GapFillInterpolateColumnState
 	Expr *lookup_after;
 	GapFillInterpolateSample prev;
 	GapFillInterpolateSample next;
+	GapFillInterpolateTerms terms;
 } GapFillInterpolateColumnState;
 
 void gapfill_interpolate_initialize(GapFillInterpolateColumnState *, GapFillState *, FuncExpr *);
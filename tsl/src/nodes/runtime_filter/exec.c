@@ -0,0 +1,443 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * The RuntimeFilterBuild node sits between the Hash node of a hash join and
+ * its input, and passes the inner tuples through unchanged. While doing so,
+ * it collects the hash keys, and when the input ends, it builds a bloom filter
+ * and a min/max range of every key. The DecompressChunk nodes on the outer
+ * side of the join use them to skip the compressed batches that can't have
+ * any matching rows, before decompressing them.
+ */
+
+#include <postgres.h>
+
+#include <commands/explain.h>
+#include <common/hashfn.h>
+#include <executor/executor.h>
+#include <nodes/extensible.h>
+#include <nodes/nodeFuncs.h>
+#include <port/pg_bitutils.h>
+#include <utils/memutils.h>
+#include <utils/ruleutils.h>
+
+#include "nodes/runtime_filter/exec.h"
+
+/*
+ * With more keys, the bloom filter becomes too big, and it's unlikely to prune
+ * many batches anyway.
+ */
+#define RUNTIME_FILTER_MAX_KEYS (1024 * 1024)
+
+typedef struct RuntimeFilterBuildKey
+{
+	ExprState *expr;
+	Oid collation;
+	FmgrInfo hash_proc;
+	FmgrInfo cmp_proc;
+	RuntimeFilter filter;
+} RuntimeFilterBuildKey;
+
+typedef struct RuntimeFilterBuildState
+{
+	CustomScanState custom;
+	MemoryContext filter_context;
+	int num_keys;
+	RuntimeFilterBuildKey *keys;
+} RuntimeFilterBuildState;
+
+static inline uint64
+bloom_second_position(uint32 hash)
+{
+	return murmurhash32(hash);
+}
+
+static void
+runtime_filter_reset(RuntimeFilter *filter)
+{
+	if (filter->key_hashes != NULL)
+	{
+		pfree(filter->key_hashes);
+	}
+	if (filter->bloom_words != NULL)
+	{
+		pfree(filter->bloom_words);
+	}
+	memset(filter, 0, sizeof(*filter));
+}
+
+static void
+runtime_filter_add(RuntimeFilterBuildState *state, RuntimeFilterBuildKey *key, Datum value)
+{
+	RuntimeFilter *filter = &key->filter;
+	if (filter->overflow)
+	{
+		return;
+	}
+
+	if (filter->num_keys >= RUNTIME_FILTER_MAX_KEYS)
+	{
+		filter->overflow = true;
+		pfree(filter->key_hashes);
+		filter->key_hashes = NULL;
+		return;
+	}
+
+	if (filter->num_keys >= filter->key_hashes_capacity)
+	{
+		filter->key_hashes_capacity = Max(1024, filter->key_hashes_capacity * 2);
+		filter->key_hashes =
+			filter->key_hashes == NULL ?
+				MemoryContextAlloc(state->filter_context,
+								   sizeof(uint32) * filter->key_hashes_capacity) :
+				repalloc(filter->key_hashes, sizeof(uint32) * filter->key_hashes_capacity);
+	}
+
+	filter->key_hashes[filter->num_keys++] =
+		DatumGetUInt32(FunctionCall1Coll(&key->hash_proc, key->collation, value));
+
+	if (!OidIsValid(key->cmp_proc.fn_oid))
+	{
+		return;
+	}
+
+	/* The range is only kept for the by-value types, so no copying. */
+	if (!filter->have_range)
+	{
+		filter->min = value;
+		filter->max = value;
+		filter->have_range = true;
+		return;
+	}
+
+	if (DatumGetInt32(FunctionCall2Coll(&key->cmp_proc, key->collation, value, filter->min)) < 0)
+	{
+		filter->min = value;
+	}
+	else if (DatumGetInt32(FunctionCall2Coll(&key->cmp_proc, key->collation, value, filter->max)) >
+			 0)
+	{
+		filter->max = value;
+	}
+}
+
+static void
+runtime_filter_finish(RuntimeFilterBuildState *state, RuntimeFilter *filter)
+{
+	Assert(!filter->ready);
+	filter->ready = true;
+
+	if (filter->overflow || filter->num_keys == 0)
+	{
+		return;
+	}
+
+	/* About eight bits per key, which gives a few percent false positives. */
+	const uint64 num_bits = pg_nextpower2_64(Max(64, filter->num_keys * 8));
+	filter->bloom_mask = num_bits - 1;
+	filter->bloom_words =
+		MemoryContextAllocZero(state->filter_context, sizeof(uint64) * (num_bits / 64));
+
+	for (int64 i = 0; i < filter->num_keys; i++)
+	{
+		const uint32 hash = filter->key_hashes[i];
+		const uint64 first = hash & filter->bloom_mask;
+		const uint64 second = bloom_second_position(hash) & filter->bloom_mask;
+		filter->bloom_words[first / 64] |= UINT64CONST(1) << (first % 64);
+		filter->bloom_words[second / 64] |= UINT64CONST(1) << (second % 64);
+	}
+
+	pfree(filter->key_hashes);
+	filter->key_hashes = NULL;
+	filter->key_hashes_capacity = 0;
+}
+
+static inline bool
+runtime_filter_may_contain(const RuntimeFilter *filter, uint32 hash)
+{
+	const uint64 first = hash & filter->bloom_mask;
+	const uint64 second = bloom_second_position(hash) & filter->bloom_mask;
+	return (filter->bloom_words[first / 64] & (UINT64CONST(1) << (first % 64))) &&
+		   (filter->bloom_words[second / 64] & (UINT64CONST(1) << (second % 64)));
+}
+
+static void
+runtime_filter_build_begin(CustomScanState *node, EState *estate, int eflags)
+{
+	RuntimeFilterBuildState *state = (RuntimeFilterBuildState *) node;
+	CustomScan *cscan = castNode(CustomScan, node->ss.ps.plan);
+	Assert(list_length(cscan->custom_plans) == 1);
+
+	node->custom_ps =
+		lappend(node->custom_ps, ExecInitNode(linitial(cscan->custom_plans), estate, eflags));
+
+	state->filter_context = CurrentMemoryContext;
+	state->num_keys = list_length(cscan->custom_exprs);
+	state->keys = palloc0(sizeof(RuntimeFilterBuildKey) * state->num_keys);
+	Assert(list_length(cscan->custom_private) == state->num_keys);
+
+	for (int i = 0; i < state->num_keys; i++)
+	{
+		RuntimeFilterBuildKey *key = &state->keys[i];
+		List *spec = list_nth(cscan->custom_private, i);
+		Assert(list_length(spec) == 4);
+
+		key->expr = ExecInitExpr(list_nth(cscan->custom_exprs, i), &node->ss.ps);
+		fmgr_info((Oid) lsecond_int(spec), &key->hash_proc);
+		if (OidIsValid((Oid) lthird_int(spec)))
+		{
+			fmgr_info((Oid) lthird_int(spec), &key->cmp_proc);
+		}
+		key->collation = (Oid) lfourth_int(spec);
+
+		/* Publish the filter to the DecompressChunk nodes. */
+		ParamExecData *param = &estate->es_param_exec_vals[linitial_int(spec)];
+		param->execPlan = NULL;
+		param->value = PointerGetDatum(&key->filter);
+		param->isnull = false;
+	}
+}
+
+static TupleTableSlot *
+runtime_filter_build_exec(CustomScanState *node)
+{
+	RuntimeFilterBuildState *state = (RuntimeFilterBuildState *) node;
+	TupleTableSlot *slot = ExecProcNode(linitial(node->custom_ps));
+
+	if (TupIsNull(slot))
+	{
+		for (int i = 0; i < state->num_keys; i++)
+		{
+			if (!state->keys[i].filter.ready)
+			{
+				runtime_filter_finish(state, &state->keys[i].filter);
+			}
+		}
+		return NULL;
+	}
+
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	ResetExprContext(econtext);
+	econtext->ecxt_scantuple = slot;
+
+	for (int i = 0; i < state->num_keys; i++)
+	{
+		RuntimeFilterBuildKey *key = &state->keys[i];
+		bool isnull;
+		Datum value = ExecEvalExprSwitchContext(key->expr, econtext, &isnull);
+
+		/* The hash join operators are strict, so the nulls never match. */
+		if (!isnull)
+		{
+			MemoryContext old_context = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+			runtime_filter_add(state, key, value);
+			MemoryContextSwitchTo(old_context);
+		}
+	}
+
+	/* The tuple is passed through unchanged, the Hash node doesn't project. */
+	return slot;
+}
+
+static void
+runtime_filter_build_rescan(CustomScanState *node)
+{
+	RuntimeFilterBuildState *state = (RuntimeFilterBuildState *) node;
+
+	/* The hash table is going to be rebuilt, so rebuild the filters as well. */
+	for (int i = 0; i < state->num_keys; i++)
+	{
+		runtime_filter_reset(&state->keys[i].filter);
+	}
+
+	if (node->ss.ps.chgParam != NULL)
+		UpdateChangedParamSet(linitial(node->custom_ps), node->ss.ps.chgParam);
+
+	ExecReScan(linitial(node->custom_ps));
+}
+
+static void
+runtime_filter_build_end(CustomScanState *node)
+{
+	ExecEndNode(linitial(node->custom_ps));
+}
+
+static void
+runtime_filter_build_explain(CustomScanState *node, List *ancestors, ExplainState *es)
+{
+	RuntimeFilterBuildState *state = (RuntimeFilterBuildState *) node;
+	CustomScan *cscan = castNode(CustomScan, node->ss.ps.plan);
+
+	if (es->verbose)
+	{
+		List *context = set_deparse_context_plan(es->deparse_cxt, &cscan->scan.plan, ancestors);
+		ListCell *lc;
+		List *keys = NIL;
+		foreach (lc, cscan->custom_exprs)
+		{
+			keys = lappend(keys,
+						   deparse_expression(lfirst(lc),
+											  context,
+											  /* forceprefix = */ true,
+											  /* showimplicit = */ false));
+		}
+		ExplainPropertyList("Filter Keys", keys, es);
+	}
+
+	if (es->analyze && es->summary)
+	{
+		List *counts = NIL;
+		for (int i = 0; i < state->num_keys; i++)
+		{
+			const RuntimeFilter *filter = &state->keys[i].filter;
+			counts = lappend(counts,
+							 filter->overflow ? "overflow" :
+												psprintf(INT64_FORMAT, filter->num_keys));
+		}
+		ExplainPropertyList("Filter Keys Collected", counts, es);
+	}
+}
+
+static struct CustomExecMethods exec_methods = {
+	.CustomName = "RuntimeFilterBuild",
+	.BeginCustomScan = runtime_filter_build_begin,
+	.ExecCustomScan = runtime_filter_build_exec,
+	.EndCustomScan = runtime_filter_build_end,
+	.ReScanCustomScan = runtime_filter_build_rescan,
+	.ExplainCustomScan = runtime_filter_build_explain,
+};
+
+Node *
+runtime_filter_state_create(CustomScan *cscan)
+{
+	RuntimeFilterBuildState *state =
+		(RuntimeFilterBuildState *) newNode(sizeof(RuntimeFilterBuildState), T_CustomScanState);
+	state->custom.methods = &exec_methods;
+	return (Node *) state;
+}
+
+/*
+ * Create the DecompressChunk side of the runtime filters from the specs that
+ * the planner stored in its custom_private.
+ */
+RuntimeFilterProbe *
+runtime_filter_probes_create(List *probe_specs, int *num_probes)
+{
+	*num_probes = list_length(probe_specs);
+	if (*num_probes == 0)
+	{
+		return NULL;
+	}
+
+	RuntimeFilterProbe *probes = palloc0(sizeof(RuntimeFilterProbe) * *num_probes);
+	for (int i = 0; i < *num_probes; i++)
+	{
+		RuntimeFilterProbe *probe = &probes[i];
+		List *spec = list_nth(probe_specs, i);
+		Assert(list_length(spec) == 7);
+
+		probe->paramid = linitial_int(spec);
+		probe->value_attno = lsecond_int(spec);
+		probe->min_attno = lthird_int(spec);
+		probe->max_attno = lfourth_int(spec);
+		fmgr_info((Oid) lfifth_int(spec), &probe->hash_proc);
+		if (OidIsValid((Oid) list_nth_int(spec, 5)))
+		{
+			fmgr_info((Oid) list_nth_int(spec, 5), &probe->cmp_proc);
+		}
+		probe->collation = (Oid) list_nth_int(spec, 6);
+	}
+
+	return probes;
+}
+
+static inline int
+probe_compare(const RuntimeFilterProbe *probe, Datum a, Datum b)
+{
+	return DatumGetInt32(
+		FunctionCall2Coll((FmgrInfo *) &probe->cmp_proc, probe->collation, a, b));
+}
+
+/*
+ * Check whether the given compressed batch can have any rows that match the
+ * runtime filters. The filters that are not built yet don't prune anything,
+ * e.g. the hash join reads the first outer tuple before building the hash
+ * table.
+ */
+bool
+runtime_filter_batch_may_match(const RuntimeFilterProbe *probes, int num_probes, EState *estate,
+							   TupleTableSlot *compressed_slot)
+{
+	for (int i = 0; i < num_probes; i++)
+	{
+		const RuntimeFilterProbe *probe = &probes[i];
+		ParamExecData *param = &estate->es_param_exec_vals[probe->paramid];
+		if (param->isnull)
+		{
+			continue;
+		}
+
+		const RuntimeFilter *filter = (const RuntimeFilter *) DatumGetPointer(param->value);
+		if (!filter->ready || filter->overflow)
+		{
+			continue;
+		}
+
+		if (filter->num_keys == 0)
+		{
+			/* The inner side is empty, so nothing can match. */
+			return false;
+		}
+
+		const bool have_range = filter->have_range && OidIsValid(probe->cmp_proc.fn_oid);
+		bool isnull;
+		if (probe->value_attno != InvalidAttrNumber)
+		{
+			/* A segmentby column has the same value for the entire batch. */
+			Datum value = slot_getattr(compressed_slot, probe->value_attno, &isnull);
+			if (isnull)
+			{
+				return false;
+			}
+
+			if (have_range && (probe_compare(probe, value, filter->min) < 0 ||
+							   probe_compare(probe, value, filter->max) > 0))
+			{
+				return false;
+			}
+
+			const uint32 hash = DatumGetUInt32(
+				FunctionCall1Coll((FmgrInfo *) &probe->hash_proc, probe->collation, value));
+			if (!runtime_filter_may_contain(filter, hash))
+			{
+				return false;
+			}
+		}
+		else if (have_range)
+		{
+			/* A compressed column, check its min/max metadata. */
+			Datum batch_min = slot_getattr(compressed_slot, probe->min_attno, &isnull);
+			if (isnull)
+			{
+				continue;
+			}
+
+			Datum batch_max = slot_getattr(compressed_slot, probe->max_attno, &isnull);
+			if (isnull)
+			{
+				continue;
+			}
+
+			if (probe_compare(probe, batch_max, filter->min) < 0 ||
+				probe_compare(probe, batch_min, filter->max) > 0)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
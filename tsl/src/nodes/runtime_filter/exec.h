@@ -0,0 +1,74 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#pragma once
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <nodes/execnodes.h>
+
+/*
+ * The runtime filter over the values of one hash key of the inner side of a
+ * hash join. It is built by the RuntimeFilterBuild node below the Hash node,
+ * and is passed to the DecompressChunk nodes on the outer side through a
+ * PARAM_EXEC parameter that holds the pointer to it.
+ */
+typedef struct RuntimeFilter
+{
+	/* Whether the inner side has been read to the end. */
+	bool ready;
+
+	/* There are too many keys for the filter to be useful. */
+	bool overflow;
+
+	/* The number of non-null keys. */
+	int64 num_keys;
+
+	/* The hashes of the keys, until we build the bloom filter from them. */
+	uint32 *key_hashes;
+	int64 key_hashes_capacity;
+
+	/*
+	 * The bloom filter with two bit positions per key. The number of bits is a
+	 * power of two.
+	 */
+	uint64 *bloom_words;
+	uint64 bloom_mask;
+
+	/* The range of the keys, if the key type has a suitable ordering. */
+	bool have_range;
+	Datum min;
+	Datum max;
+} RuntimeFilter;
+
+/*
+ * The DecompressChunk side of a runtime filter, that checks the segmentby value
+ * or the min/max metadata of each compressed batch against the filter.
+ */
+typedef struct RuntimeFilterProbe
+{
+	int paramid;
+
+	/*
+	 * The attno of the segmentby column in the compressed scan output, or of
+	 * the min and max metadata columns for the compressed columns.
+	 */
+	AttrNumber value_attno;
+	AttrNumber min_attno;
+	AttrNumber max_attno;
+
+	Oid collation;
+	FmgrInfo hash_proc;
+
+	/* The comparison function of the key type, if fn_oid is valid. */
+	FmgrInfo cmp_proc;
+} RuntimeFilterProbe;
+
+extern Node *runtime_filter_state_create(CustomScan *cscan);
+
+extern RuntimeFilterProbe *runtime_filter_probes_create(List *probe_specs, int *num_probes);
+extern bool runtime_filter_batch_may_match(const RuntimeFilterProbe *probes, int num_probes,
+										   EState *estate, TupleTableSlot *compressed_slot);
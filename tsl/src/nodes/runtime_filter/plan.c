@@ -0,0 +1,504 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#include <postgres.h>
+
+#include <access/stratnum.h>
+#include <catalog/pg_type.h>
+#include <nodes/extensible.h>
+#include <nodes/makefuncs.h>
+#include <nodes/nodeFuncs.h>
+#include <utils/lsyscache.h>
+#include <utils/typcache.h>
+
+#include "compat/compat.h"
+#include "nodes/decompress_chunk/planner.h"
+#include "nodes/runtime_filter/exec.h"
+#include "nodes/runtime_filter/plan.h"
+
+static CustomScanMethods runtime_filter_plan_methods = {
+	.CustomName = "RuntimeFilterBuild",
+	.CreateCustomScanState = runtime_filter_state_create,
+};
+
+void
+_runtime_filter_init(void)
+{
+	TryRegisterCustomScanMethods(&runtime_filter_plan_methods);
+}
+
+typedef struct RuntimeFilterPlanContext
+{
+	PlannedStmt *stmt;
+	int last_plan_node_id;
+} RuntimeFilterPlanContext;
+
+static List *
+plan_children(Plan *plan)
+{
+	List *children = NIL;
+	if (plan->lefttree != NULL)
+		children = lappend(children, plan->lefttree);
+	if (plan->righttree != NULL)
+		children = lappend(children, plan->righttree);
+
+	switch (nodeTag(plan))
+	{
+		case T_Append:
+			children = list_concat(children, castNode(Append, plan)->appendplans);
+			break;
+		case T_MergeAppend:
+			children = list_concat(children, castNode(MergeAppend, plan)->mergeplans);
+			break;
+		case T_BitmapAnd:
+			children = list_concat(children, castNode(BitmapAnd, plan)->bitmapplans);
+			break;
+		case T_BitmapOr:
+			children = list_concat(children, castNode(BitmapOr, plan)->bitmapplans);
+			break;
+		case T_CustomScan:
+			children = list_concat(children, castNode(CustomScan, plan)->custom_plans);
+			break;
+		case T_SubqueryScan:
+			children = lappend(children, castNode(SubqueryScan, plan)->subplan);
+			break;
+#if PG14_LT
+		case T_ModifyTable:
+			children = list_concat(children, castNode(ModifyTable, plan)->plans);
+			break;
+#endif
+		default:
+			break;
+	}
+
+	return children;
+}
+
+static int
+max_plan_node_id(Plan *plan)
+{
+	if (plan == NULL)
+	{
+		return 0;
+	}
+
+	int result = plan->plan_node_id;
+	ListCell *lc;
+	foreach (lc, plan_children(plan))
+	{
+		result = Max(result, max_plan_node_id(lfirst(lc)));
+	}
+	return result;
+}
+
+/*
+ * Find the DecompressChunk nodes that produce the given output column of the
+ * plan, following the plain column references through the nodes that pass
+ * their input rows through, such as Append or Sort. Returns the list of such
+ * nodes, and the list of the respective uncompressed chunk attnos.
+ */
+static void
+find_decompress_chunk_columns(Plan *plan, AttrNumber attno, List **scans, List **chunk_attnos)
+{
+	if (attno <= 0 || attno > list_length(plan->targetlist))
+	{
+		return;
+	}
+
+	Expr *expr = list_nth_node(TargetEntry, plan->targetlist, AttrNumberGetAttrOffset(attno))->expr;
+	if (!IsA(expr, Var))
+	{
+		return;
+	}
+
+	Var *var = castNode(Var, expr);
+	List *children = NIL;
+	switch (nodeTag(plan))
+	{
+		case T_Append:
+			children = castNode(Append, plan)->appendplans;
+			break;
+		case T_MergeAppend:
+			children = castNode(MergeAppend, plan)->mergeplans;
+			break;
+		case T_Sort:
+		case T_Material:
+		case T_Result:
+			if (plan->lefttree != NULL)
+				children = list_make1(plan->lefttree);
+			break;
+		case T_CustomScan:
+		{
+			CustomScan *custom = castNode(CustomScan, plan);
+			if (strcmp(custom->methods->CustomName, "DecompressChunk") == 0)
+			{
+				bool is_segmentby;
+				AttrNumber compressed_scan_attno;
+				if (decompress_chunk_is_chunk_column(custom,
+													 expr,
+													 &is_segmentby,
+													 &compressed_scan_attno))
+				{
+					*scans = lappend(*scans, custom);
+					*chunk_attnos = lappend_int(*chunk_attnos, var->varattno);
+				}
+				return;
+			}
+
+			/* The ChunkAppend children produce its scan tuple columns. */
+			if (strcmp(custom->methods->CustomName, "ChunkAppend") == 0 && var->varno == INDEX_VAR)
+			{
+				children = custom->custom_plans;
+			}
+			break;
+		}
+		default:
+			break;
+	}
+
+	if (var->varno != OUTER_VAR && var->varno != INDEX_VAR)
+	{
+		return;
+	}
+
+	ListCell *lc;
+	foreach (lc, children)
+	{
+		find_decompress_chunk_columns(lfirst(lc), var->varattno, scans, chunk_attnos);
+	}
+}
+
+/*
+ * Get the btree comparison function for the min/max range of the join key, if
+ * the join operator is the btree equality of a by-value type.
+ */
+static Oid
+get_key_cmp_proc(OpExpr *clause)
+{
+	Oid lefttype;
+	Oid righttype;
+	op_input_types(clause->opno, &lefttype, &righttype);
+	if (lefttype != righttype || !get_typbyval(lefttype))
+	{
+		return InvalidOid;
+	}
+
+	TypeCacheEntry *tce =
+		lookup_type_cache(lefttype, TYPECACHE_BTREE_OPFAMILY | TYPECACHE_CMP_PROC);
+	if (!OidIsValid(tce->btree_opf) || !OidIsValid(tce->cmp_proc) ||
+		get_opfamily_member(tce->btree_opf, lefttype, lefttype, BTEqualStrategyNumber) !=
+			clause->opno)
+	{
+		return InvalidOid;
+	}
+
+	return tce->cmp_proc;
+}
+
+/*
+ * Build the DecompressChunk side of the runtime filter for the given column,
+ * or return NIL if the batches can't be checked against the filter. The first
+ * element is the param id that is filled in later.
+ */
+static List *
+make_probe_spec(CustomScan *decompress_chunk, AttrNumber chunk_attno, Oid hash_proc, Oid cmp_proc,
+				Oid collation, List *rtable)
+{
+	/* The batch sorted merge needs all the batches to be non-empty. */
+	List *settings = linitial(decompress_chunk->custom_private);
+	if (lfourth_int(settings))
+	{
+		return NIL;
+	}
+
+	Var *var =
+		makeVar(decompress_chunk->scan.scanrelid, chunk_attno, InvalidOid, -1, InvalidOid, 0);
+	bool is_segmentby = false;
+	AttrNumber compressed_scan_attno;
+	if (!decompress_chunk_is_chunk_column(decompress_chunk,
+										  (Expr *) var,
+										  &is_segmentby,
+										  &compressed_scan_attno))
+	{
+		return NIL;
+	}
+
+	AttrNumber value_attno = InvalidAttrNumber;
+	AttrNumber min_attno = InvalidAttrNumber;
+	AttrNumber max_attno = InvalidAttrNumber;
+	if (is_segmentby)
+	{
+		value_attno = compressed_scan_attno;
+	}
+	else
+	{
+		/* For the compressed columns, we can only check the min/max metadata. */
+		if (!OidIsValid(cmp_proc))
+		{
+			return NIL;
+		}
+
+		min_attno = decompress_chunk_get_segment_meta_attno(decompress_chunk,
+															rtable,
+															chunk_attno,
+															/* is_min = */ true);
+		max_attno = decompress_chunk_get_segment_meta_attno(decompress_chunk,
+															rtable,
+															chunk_attno,
+															/* is_min = */ false);
+		if (min_attno == InvalidAttrNumber || max_attno == InvalidAttrNumber)
+		{
+			return NIL;
+		}
+	}
+
+	List *spec = list_make5_int(-1, value_attno, min_attno, max_attno, hash_proc);
+	spec = lappend_int(spec, cmp_proc);
+	spec = lappend_int(spec, collation);
+	return spec;
+}
+
+/*
+ * Convert the inner hash key of the join clause, which references the Hash
+ * node output with INNER_VAR Vars, into an expression over the scan tuple of
+ * the RuntimeFilterBuild node, which has the same columns. Sets the failed flag
+ * if the key references anything else.
+ */
+static Node *
+inner_key_to_index_var_mutator(Node *node, bool *failed)
+{
+	if (node == NULL)
+	{
+		return NULL;
+	}
+
+	if (IsA(node, Var))
+	{
+		Var *var = (Var *) copyObject(node);
+		if (var->varno != INNER_VAR)
+		{
+			*failed = true;
+		}
+		var->varno = INDEX_VAR;
+		return (Node *) var;
+	}
+
+	if (IsA(node, Param) || IsA(node, SubPlan) || IsA(node, AlternativeSubPlan))
+	{
+		*failed = true;
+		return node;
+	}
+
+	return expression_tree_mutator(node, inner_key_to_index_var_mutator, failed);
+}
+
+static CustomScan *
+runtime_filter_build_create(Plan *inner, RuntimeFilterPlanContext *context)
+{
+	CustomScan *custom = (CustomScan *) makeNode(CustomScan);
+	custom->custom_plans = list_make1(inner);
+	custom->methods = &runtime_filter_plan_methods;
+
+	/*
+	 * The node passes its input tuples through, so its scan tuple is described
+	 * by the input targetlist, and the plan targetlist just references it.
+	 */
+	custom->custom_scan_tlist = copyObject(inner->targetlist);
+
+	List *output_tlist = NIL;
+	ListCell *lc;
+	foreach (lc, custom->custom_scan_tlist)
+	{
+		TargetEntry *input_tlentry = lfirst_node(TargetEntry, lc);
+		Var *output_var = makeVar(INDEX_VAR,
+								  input_tlentry->resno,
+								  exprType((Node *) input_tlentry->expr),
+								  exprTypmod((Node *) input_tlentry->expr),
+								  exprCollation((Node *) input_tlentry->expr),
+								  /* varlevelsup = */ 0);
+		output_tlist = lappend(output_tlist,
+							   makeTargetEntry((Expr *) output_var,
+											   input_tlentry->resno,
+											   input_tlentry->resname,
+											   input_tlentry->resjunk));
+	}
+	custom->scan.plan.targetlist = output_tlist;
+
+	custom->scan.plan.startup_cost = inner->startup_cost;
+	custom->scan.plan.total_cost = inner->total_cost;
+	custom->scan.plan.plan_rows = inner->plan_rows;
+	custom->scan.plan.plan_width = inner->plan_width;
+	custom->scan.plan.parallel_aware = false;
+	custom->scan.plan.parallel_safe = inner->parallel_safe;
+	custom->scan.plan.plan_node_id = ++context->last_plan_node_id;
+	custom->scan.plan.extParam = bms_copy(inner->extParam);
+	custom->scan.plan.allParam = bms_copy(inner->allParam);
+	custom->scan.scanrelid = 0;
+
+	return custom;
+}
+
+/*
+ * Add the runtime filters for the hash keys of the given hash join that
+ * reference the columns of the DecompressChunk nodes on its outer side.
+ */
+static void
+add_runtime_filters(HashJoin *hashjoin, RuntimeFilterPlanContext *context)
+{
+	/* The outer rows that have no match must be discarded by the join. */
+	if (hashjoin->join.jointype != JOIN_INNER && hashjoin->join.jointype != JOIN_SEMI &&
+		hashjoin->join.jointype != JOIN_RIGHT)
+	{
+		return;
+	}
+
+	/*
+	 * In a parallel hash join, every participant only sees a part of the inner
+	 * side. The inner side must also be the same on every rescan, otherwise
+	 * the filter could be stale when the join reads the first outer tuple
+	 * before rebuilding the hash table.
+	 */
+	Hash *hash = castNode(Hash, innerPlan(hashjoin));
+	Plan *inner = outerPlan(hash);
+	if (hashjoin->join.plan.parallel_aware || !bms_is_empty(hash->plan.allParam))
+	{
+		return;
+	}
+
+	/* We can only describe the inner tuples of a plain scan. */
+	if (!IsA(inner, SeqScan) && !IsA(inner, IndexScan) && !IsA(inner, BitmapHeapScan))
+	{
+		return;
+	}
+
+	CustomScan *build = NULL;
+	ListCell *lc;
+	foreach (lc, hashjoin->hashclauses)
+	{
+		OpExpr *clause = lfirst_node(OpExpr, lc);
+		Var *outer_var = linitial(clause->args);
+		if (!IsA(outer_var, Var) || outer_var->varno != OUTER_VAR || !op_strict(clause->opno))
+		{
+			continue;
+		}
+
+		RegProcedure outer_hash_proc;
+		RegProcedure inner_hash_proc;
+		if (!get_op_hash_functions(clause->opno, &outer_hash_proc, &inner_hash_proc))
+		{
+			continue;
+		}
+
+		bool failed = false;
+		Node *inner_key = inner_key_to_index_var_mutator(lsecond(clause->args), &failed);
+		if (failed)
+		{
+			continue;
+		}
+
+		List *scans = NIL;
+		List *chunk_attnos = NIL;
+		find_decompress_chunk_columns(outerPlan(hashjoin),
+									  outer_var->varattno,
+									  &scans,
+									  &chunk_attnos);
+
+		const Oid cmp_proc = get_key_cmp_proc(clause);
+		List *probe_scans = NIL;
+		List *probe_specs = NIL;
+		ListCell *lc_scan;
+		ListCell *lc_attno;
+		forboth (lc_scan, scans, lc_attno, chunk_attnos)
+		{
+			List *spec = make_probe_spec(lfirst(lc_scan),
+										 lfirst_int(lc_attno),
+										 outer_hash_proc,
+										 cmp_proc,
+										 clause->inputcollid,
+										 context->stmt->rtable);
+			if (spec != NIL)
+			{
+				probe_scans = lappend(probe_scans, lfirst(lc_scan));
+				probe_specs = lappend(probe_specs, spec);
+			}
+		}
+
+		if (probe_specs == NIL)
+		{
+			continue;
+		}
+
+		/* The filter is passed to the DecompressChunk nodes through a param. */
+		const int paramid = list_length(context->stmt->paramExecTypes);
+		context->stmt->paramExecTypes = lappend_oid(context->stmt->paramExecTypes, INTERNALOID);
+
+		if (build == NULL)
+		{
+			build = runtime_filter_build_create(inner, context);
+			hash->plan.lefttree = &build->scan.plan;
+		}
+		build->custom_exprs = lappend(build->custom_exprs, inner_key);
+		build->custom_private =
+			lappend(build->custom_private,
+					list_make4_int(paramid, inner_hash_proc, cmp_proc, clause->inputcollid));
+
+		forboth (lc_scan, probe_scans, lc_attno, probe_specs)
+		{
+			CustomScan *decompress_chunk = lfirst(lc_scan);
+			List *spec = lfirst(lc_attno);
+			lfirst_int(list_head(spec)) = paramid;
+
+			ListCell *filters_cell = list_nth_cell(decompress_chunk->custom_private, 5);
+			lfirst(filters_cell) = lappend(lfirst(filters_cell), spec);
+		}
+	}
+}
+
+static void
+runtime_filter_walk(Plan *plan, RuntimeFilterPlanContext *context)
+{
+	if (plan == NULL)
+	{
+		return;
+	}
+
+	ListCell *lc;
+	foreach (lc, plan_children(plan))
+	{
+		runtime_filter_walk(lfirst(lc), context);
+	}
+
+	if (IsA(plan, HashJoin))
+	{
+		add_runtime_filters(castNode(HashJoin, plan), context);
+	}
+}
+
+/*
+ * Walk the final plan and add the runtime filters from the inner side of the
+ * hash joins to the DecompressChunk nodes on their outer side.
+ */
+void
+try_insert_runtime_filters(PlannedStmt *stmt)
+{
+	RuntimeFilterPlanContext context = {
+		.stmt = stmt,
+		.last_plan_node_id = max_plan_node_id(stmt->planTree),
+	};
+
+	ListCell *lc;
+	foreach (lc, stmt->subplans)
+	{
+		context.last_plan_node_id =
+			Max(context.last_plan_node_id, max_plan_node_id(lfirst(lc)));
+	}
+
+	runtime_filter_walk(stmt->planTree, &context);
+	foreach (lc, stmt->subplans)
+	{
+		runtime_filter_walk(lfirst(lc), &context);
+	}
+}
@@ -0,0 +1,14 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#pragma once
+
+#include <postgres.h>
+#include <nodes/plannodes.h>
+
+extern void _runtime_filter_init(void);
+
+extern void try_insert_runtime_filters(PlannedStmt *stmt);
@@ -38,15 +38,22 @@
  *                    |   DONE    |
  *                    \===========/
  *
+ * For DISTINCT on multiple columns the skip qual is a row comparison like
+ *     WHERE (column1, column2) > ([previous value of column1], [previous value of column2])
+ * over NOT NULL columns. The search for non-NULL turns the row comparison into an
+ * IS NOT NULL key on the first column to find the first tuple, and there are no
+ * NULL stages.
  */
 
 #include <postgres.h>
 #include <access/genam.h>
+#include <commands/explain.h>
 #include <nodes/extensible.h>
 #include <nodes/pg_list.h>
 #include <utils/datum.h>
 
 #include "guc.h"
+#include "nodes/node_timing.h"
 #include "nodes/skip_scan/skip_scan.h"
 
 typedef enum SkipScanStage
@@ -59,6 +66,18 @@ typedef enum SkipScanStage
 	SS_END,
 } SkipScanStage;
 
+typedef enum SkipScanTimingPhase
+{
+	SKIP_SCAN_TIMING_INDEX_RESCAN = 0,
+	SKIP_SCAN_TIMING_KEY_UPDATE,
+	_SKIP_SCAN_TIMING_PHASES,
+} SkipScanTimingPhase;
+
+static const char *const skip_scan_timing_names[_SKIP_SCAN_TIMING_PHASES] = {
+	[SKIP_SCAN_TIMING_INDEX_RESCAN] = "Index Rescan Time",
+	[SKIP_SCAN_TIMING_KEY_UPDATE] = "Key Update Time",
+};
+
 typedef struct SkipScanState
 {
 	CustomScanState cscan_state;
@@ -72,14 +91,18 @@ typedef struct SkipScanState
 	int *num_scan_keys;
 	ScanKey *scan_keys;
 	ScanKey skip_key;
+	/* Subsidiary keys of the row comparison for DISTINCT on multiple columns */
+	ScanKey row_keys;
+	int row_flags;
 
-	Datum prev_datum;
+	Datum *prev_datums;
 	bool prev_is_null;
 
-	/* Info about the type we are performing DISTINCT on */
-	bool distinct_by_val;
-	int distinct_col_attnum;
-	int distinct_typ_len;
+	/* Info about the columns we are performing DISTINCT on */
+	int num_distinct_cols;
+	bool *distinct_by_vals;
+	int *distinct_col_attnums;
+	int *distinct_typ_lens;
 	int sk_attno;
 
 	SkipScanStage stage;
@@ -89,6 +112,8 @@ typedef struct SkipScanState
 	bool needs_rescan;
 
 	void *idx_scan;
+
+	TsNodeTiming timing;
 } SkipScanState;
 
 static bool has_nulls_first(SkipScanState *state);
@@ -101,6 +126,7 @@ skip_scan_begin(CustomScanState *node, EState *estate, int eflags)
 {
 	SkipScanState *state = (SkipScanState *) node;
 	state->ctx = AllocSetContextCreate(estate->es_query_cxt, "skipscan", ALLOCSET_DEFAULT_SIZES);
+	ts_node_timing_init(&state->timing, estate, skip_scan_timing_names, _SKIP_SCAN_TIMING_PHASES);
 
 	state->idx = (ScanState *) ExecInitNode(state->idx_scan, estate, eflags);
 	node->custom_ps = list_make1(state->idx);
@@ -132,9 +158,20 @@ skip_scan_begin(CustomScanState *node, EState *estate, int eflags)
 	ScanKey data = *state->scan_keys;
 	for (int i = 0; i < *state->num_scan_keys; i++)
 	{
-		if (data[i].sk_flags == SK_ISNULL && data[i].sk_attno == state->sk_attno)
+		if (data[i].sk_attno != state->sk_attno)
+			continue;
+
+		if (state->num_distinct_cols == 1 && data[i].sk_flags == SK_ISNULL)
+		{
+			state->skip_key = &data[i];
+			break;
+		}
+
+		if (state->num_distinct_cols > 1 && (data[i].sk_flags & SK_ROW_HEADER))
 		{
 			state->skip_key = &data[i];
+			state->row_keys = (ScanKey) DatumGetPointer(data[i].sk_argument);
+			state->row_flags = data[i].sk_flags;
 			break;
 		}
 	}
@@ -142,16 +179,17 @@ skip_scan_begin(CustomScanState *node, EState *estate, int eflags)
 		elog(ERROR, "ScanKey for skip qual not found");
 }
 
+/* the columns of a multi-column DISTINCT are NOT NULL so there are no NULL stages */
 static bool
 has_nulls_first(SkipScanState *state)
 {
-	return state->nulls_first;
+	return state->nulls_first && state->num_distinct_cols == 1;
 }
 
 static bool
 has_nulls_last(SkipScanState *state)
 {
-	return !has_nulls_first(state);
+	return !state->nulls_first && state->num_distinct_cols == 1;
 }
 
 static void
@@ -164,11 +202,17 @@ skip_scan_rescan_index(SkipScanState *state)
 	 * has not been initialized it will pick up
 	 * any ScanKey changes we did */
 	if (*state->scan_desc)
+	{
+		instr_time start;
+
+		ts_node_timing_start(&state->timing, &start);
 		index_rescan(*state->scan_desc,
 					 *state->scan_keys,
 					 *state->num_scan_keys,
 					 NULL /*orderbys*/,
 					 0 /*norderbys*/);
+		ts_node_timing_stop(&state->timing, SKIP_SCAN_TIMING_INDEX_RESCAN, &start);
+	}
 	state->needs_rescan = false;
 }
 
@@ -189,7 +233,13 @@ skip_scan_switch_stage(SkipScanState *state, SkipScanStage new_stage)
 			break;
 
 		case SS_VALUES:
-			state->skip_key->sk_flags = 0;
+			if (state->row_keys)
+			{
+				state->skip_key->sk_flags = state->row_flags;
+				state->skip_key->sk_argument = PointerGetDatum(state->row_keys);
+			}
+			else
+				state->skip_key->sk_flags = 0;
 			state->needs_rescan = true;
 			break;
 
@@ -208,17 +258,56 @@ skip_scan_switch_stage(SkipScanState *state, SkipScanStage new_stage)
 	state->stage = new_stage;
 }
 
+/*
+ * Update the subsidiary keys of the row comparison. The btree code adjusts
+ * the flags and strategy of these keys in place for DESC columns, so we only
+ * touch SK_ISNULL here.
+ */
+static void
+skip_scan_update_row_key(SkipScanState *state, TupleTableSlot *slot)
+{
+	/* only the previous values are allocated in this context */
+	MemoryContextReset(state->ctx);
+
+	MemoryContext old_ctx = MemoryContextSwitchTo(state->ctx);
+	for (int i = 0; i < state->num_distinct_cols; i++)
+	{
+		ScanKey key = &state->row_keys[i];
+		Datum value = slot_getattr(slot, state->distinct_col_attnums[i], &state->prev_is_null);
+
+		/* the columns of a multi-column DISTINCT are NOT NULL */
+		if (state->prev_is_null)
+			elog(ERROR, "unexpected NULL value in SkipScan");
+
+		state->prev_datums[i] =
+			datumCopy(value, state->distinct_by_vals[i], state->distinct_typ_lens[i]);
+		key->sk_argument = state->prev_datums[i];
+		key->sk_flags &= ~SK_ISNULL;
+	}
+	MemoryContextSwitchTo(old_ctx);
+}
+
 static void
 skip_scan_update_key(SkipScanState *state, TupleTableSlot *slot)
 {
-	if (!state->prev_is_null && !state->distinct_by_val)
+	if (state->row_keys)
+	{
+		skip_scan_update_row_key(state, slot);
+
+		/* we need to do a rescan whenever we modify the ScanKey */
+		state->needs_rescan = true;
+		return;
+	}
+
+	if (!state->prev_is_null && !state->distinct_by_vals[0])
 	{
 		Assert(state->stage == SS_VALUES);
-		pfree(DatumGetPointer(state->prev_datum));
+		pfree(DatumGetPointer(state->prev_datums[0]));
 	}
 
 	MemoryContext old_ctx = MemoryContextSwitchTo(state->ctx);
-	state->prev_datum = slot_getattr(slot, state->distinct_col_attnum, &state->prev_is_null);
+	state->prev_datums[0] =
+		slot_getattr(slot, state->distinct_col_attnums[0], &state->prev_is_null);
 	if (state->prev_is_null)
 	{
 		state->skip_key->sk_flags = SK_ISNULL;
@@ -226,9 +315,10 @@ skip_scan_update_key(SkipScanState *state, TupleTableSlot *slot)
 	}
 	else
 	{
-		state->prev_datum =
-			datumCopy(state->prev_datum, state->distinct_by_val, state->distinct_typ_len);
-		state->skip_key->sk_argument = state->prev_datum;
+		state->prev_datums[0] = datumCopy(state->prev_datums[0],
+										  state->distinct_by_vals[0],
+										  state->distinct_typ_lens[0]);
+		state->skip_key->sk_argument = state->prev_datums[0];
 	}
 
 	MemoryContextSwitchTo(old_ctx);
@@ -295,7 +385,10 @@ skip_scan_exec(CustomScanState *node)
 					if (state->stage == SS_NOT_NULL)
 						skip_scan_switch_stage(state, SS_VALUES);
 
+					instr_time start;
+					ts_node_timing_start(&state->timing, &start);
 					skip_scan_update_key(state, result);
+					ts_node_timing_stop(&state->timing, SKIP_SCAN_TIMING_KEY_UPDATE, &start);
 					return result;
 				}
 				else
@@ -349,19 +442,26 @@ skip_scan_rescan(CustomScanState *node)
 		skip_scan_switch_stage(state, SS_NOT_NULL);
 
 	state->prev_is_null = true;
-	state->prev_datum = 0;
+	memset(state->prev_datums, 0, sizeof(Datum) * state->num_distinct_cols);
 
 	state->needs_rescan = false;
 	ExecReScan(&state->idx->ps);
 	MemoryContextReset(state->ctx);
 }
 
+static void
+skip_scan_explain(CustomScanState *node, List *ancestors, ExplainState *es)
+{
+	ts_node_timing_explain(&((SkipScanState *) node)->timing, es);
+}
+
 static CustomExecMethods skip_scan_state_methods = {
 	.CustomName = "SkipScanState",
 	.BeginCustomScan = skip_scan_begin,
 	.EndCustomScan = skip_scan_end,
 	.ExecCustomScan = skip_scan_exec,
 	.ReScanCustomScan = skip_scan_rescan,
+	.ExplainCustomScan = skip_scan_explain,
 };
 
 Node *
@@ -372,11 +472,25 @@ tsl_skip_scan_state_create(CustomScan *cscan)
 	state->idx_scan = linitial(cscan->custom_plans);
 	state->stage = SS_BEGIN;
 
-	state->distinct_col_attnum = linitial_int(cscan->custom_private);
-	state->distinct_by_val = lsecond_int(cscan->custom_private);
-	state->distinct_typ_len = lthird_int(cscan->custom_private);
-	state->nulls_first = lfourth_int(cscan->custom_private);
-	state->sk_attno = list_nth_int(cscan->custom_private, 4);
+	List *settings = linitial(cscan->custom_private);
+	List *colnos = lsecond(cscan->custom_private);
+	List *by_vals = lthird(cscan->custom_private);
+	List *typ_lens = lfourth(cscan->custom_private);
+
+	state->nulls_first = linitial_int(settings);
+	state->sk_attno = lsecond_int(settings);
+
+	state->num_distinct_cols = list_length(colnos);
+	state->distinct_col_attnums = palloc(sizeof(int) * state->num_distinct_cols);
+	state->distinct_by_vals = palloc(sizeof(bool) * state->num_distinct_cols);
+	state->distinct_typ_lens = palloc(sizeof(int) * state->num_distinct_cols);
+	state->prev_datums = palloc0(sizeof(Datum) * state->num_distinct_cols);
+	for (int i = 0; i < state->num_distinct_cols; i++)
+	{
+		state->distinct_col_attnums[i] = list_nth_int(colnos, i);
+		state->distinct_by_vals[i] = list_nth_int(by_vals, i);
+		state->distinct_typ_lens[i] = list_nth_int(typ_lens, i);
+	}
 
 	state->prev_is_null = true;
 	state->cscan_state.methods = &skip_scan_state_methods;
@@ -6,6 +6,7 @@
 
 #include <postgres.h>
 #include <access/sysattr.h>
+#include <catalog/pg_am.h>
 #include <nodes/extensible.h>
 #include <nodes/nodeFuncs.h>
 #include <nodes/makefuncs.h>
@@ -19,16 +20,20 @@
 #include <optimizer/restrictinfo.h>
 #include <optimizer/tlist.h>
 #include <parser/parse_coerce.h>
+#include <parser/parse_func.h>
 #include <parser/parsetree.h>
 #include <rewrite/rewriteManip.h>
+#include <utils/lsyscache.h>
 #include <utils/syscache.h>
 #include <utils/typcache.h>
 
 #include <import/planner.h>
+#include "extension.h"
 #include "guc.h"
 #include "nodes/skip_scan/skip_scan.h"
 #include "nodes/constraint_aware_append/constraint_aware_append.h"
 #include "nodes/chunk_append/chunk_append.h"
+#include "nodes/decompress_chunk/decompress_chunk.h"
 #include "compat/compat.h"
 
 #include <math.h>
@@ -40,25 +45,46 @@ typedef struct SkipScanPath
 
 	/* Index clause which we'll use to skip past elements we've already seen */
 	RestrictInfo *skip_clause;
-	/* attribute number of the distinct column on the table/chunk */
-	AttrNumber distinct_attno;
-	/* The column offset on the index we are calling DISTINCT on */
+	/* The column offset on the index of the first column we are calling DISTINCT on */
 	AttrNumber scankey_attno;
-	int distinct_typ_len;
-	bool distinct_by_val;
-	/* Var referencing the distinct column on the relation */
-	Var *distinct_var;
+	/* Vars referencing the distinct columns on the relation, in index order */
+	List *distinct_vars;
 } SkipScanPath;
 
+/*
+ * The columns the SkipScan skips over. For DISTINCT these are the DISTINCT
+ * columns. For first()/last() aggregates grouped by plain columns these are the
+ * GROUP BY columns, and the index also has to return the row with the first or
+ * last value of the bookend column first for every group, so that the scan
+ * returns the row that the aggregates pick.
+ */
+typedef struct SkipScanKeys
+{
+	/* Expressions of the columns on the parent relation */
+	List *exprs;
+	/* Sort argument of the first()/last() aggregates, or NULL for DISTINCT */
+	Var *bookend_var;
+	/* true for last() */
+	bool bookend_desc;
+} SkipScanKeys;
+
 static int get_idx_key(IndexOptInfo *idxinfo, AttrNumber attno);
 static List *sort_indexquals(IndexOptInfo *indexinfo, List *quals);
-static OpExpr *fix_indexqual(IndexOptInfo *index, RestrictInfo *rinfo, AttrNumber scankey_attno);
+static Expr *fix_indexqual(IndexOptInfo *index, RestrictInfo *rinfo, AttrNumber scankey_attno);
 static bool build_skip_qual(PlannerInfo *root, SkipScanPath *skip_scan_path, IndexPath *index_path,
 							Var *var);
-static List *build_subpath(PlannerInfo *root, List *subpaths, double ndistinct);
+static bool build_skip_row_qual(PlannerInfo *root, SkipScanPath *skip_scan_path,
+								IndexPath *index_path, List *vars);
+static List *build_subpath(PlannerInfo *root, List *subpaths, double ndistinct,
+						   SkipScanKeys *keys);
 static ChunkAppendPath *copy_chunk_append_path(ChunkAppendPath *ca, List *subpaths);
-static Var *get_distinct_var(PlannerInfo *root, IndexPath *index_path,
-							 SkipScanPath *skip_scan_path);
+static List *get_distinct_exprs(PlannerInfo *root, List *clauses);
+static List *get_distinct_vars(PlannerInfo *root, RelOptInfo *rel, List *exprs);
+static Path *skip_scan_input_path_create(PlannerInfo *root, Path *subpath, double ndistinct,
+										 SkipScanKeys *keys);
+static Path *skip_scan_compressed_path_create(PlannerInfo *root, Path *path, double ndistinct,
+											  SkipScanKeys *keys);
+static bool has_bookend_order(PlannerInfo *root, SkipScanPath *skip_scan_path, SkipScanKeys *keys);
 static TargetEntry *tlist_member_match_var(Var *var, List *targetlist);
 
 /**************************
@@ -84,7 +110,11 @@ skip_scan_plan_create(PlannerInfo *root, RelOptInfo *relopt, CustomPath *best_pa
 	CustomScan *skip_plan = makeNode(CustomScan);
 	IndexPath *index_path = path->index_path;
 
-	OpExpr *op = fix_indexqual(index_path->indexinfo, path->skip_clause, path->scankey_attno);
+	Expr *op = fix_indexqual(index_path->indexinfo, path->skip_clause, path->scankey_attno);
+	List *colnos = NIL;
+	List *by_vals = NIL;
+	List *typ_lens = NIL;
+	ListCell *lc;
 
 	Plan *plan = linitial(custom_plans);
 	if (IsA(plan, IndexScan))
@@ -113,18 +143,30 @@ skip_scan_plan_create(PlannerInfo *root, RelOptInfo *relopt, CustomPath *best_pa
 	skip_plan->scan.plan.type = T_CustomScan;
 	skip_plan->methods = &skip_scan_plan_methods;
 	skip_plan->custom_plans = custom_plans;
-	/* get position of skipped column in tuples produced by child scan */
-	TargetEntry *tle = tlist_member_match_var(path->distinct_var, plan->targetlist);
+
+	foreach (lc, path->distinct_vars)
+	{
+		Var *var = lfirst_node(Var, lc);
+		int16 typ_len;
+		bool by_val;
+
+		/* get position of skipped column in tuples produced by child scan */
+		TargetEntry *tle = tlist_member_match_var(var, plan->targetlist);
+		if (!tle)
+			elog(ERROR, "distinct column not found in SkipScan child targetlist");
+
+		get_typlenbyval(var->vartype, &typ_len, &by_val);
+		colnos = lappend_int(colnos, tle->resno);
+		by_vals = lappend_int(by_vals, by_val);
+		typ_lens = lappend_int(typ_lens, typ_len);
+	}
 
 	bool nulls_first = index_path->indexinfo->nulls_first[path->scankey_attno - 1];
 	if (index_path->indexscandir == BackwardScanDirection)
 		nulls_first = !nulls_first;
 
-	skip_plan->custom_private = list_make5_int(tle->resno,
-											   path->distinct_by_val,
-											   path->distinct_typ_len,
-											   nulls_first,
-											   path->scankey_attno);
+	skip_plan->custom_private =
+		list_make4(list_make2_int(nulls_first, path->scankey_attno), colnos, by_vals, typ_lens);
 	return &skip_plan->scan.plan;
 }
 
@@ -137,7 +179,9 @@ static CustomPathMethods skip_scan_path_methods = {
 };
 
 static SkipScanPath *skip_scan_path_create(PlannerInfo *root, IndexPath *index_path,
-										   double ndistinct);
+										   double ndistinct, SkipScanKeys *keys);
+static SkipScanPath *skip_scan_path_create_for_vars(PlannerInfo *root, IndexPath *index_path,
+													double ndistinct, List *vars);
 
 /*
  * Create SkipScan paths based on existing Unique paths.
@@ -175,6 +219,7 @@ tsl_skip_scan_paths_add(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *ou
 {
 	ListCell *lc;
 	UpperUniquePath *unique = NULL;
+	SkipScanKeys keys = { 0 };
 
 	if (!ts_guc_enable_skip_scan)
 		return;
@@ -190,17 +235,6 @@ tsl_skip_scan_paths_add(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *ou
 		if (IsA(lfirst(lc), UpperUniquePath))
 		{
 			unique = lfirst_node(UpperUniquePath, lc);
-
-			/* currently we do not handle DISTINCT on more than one key. To do so,
-			 * we would need to break down the SkipScan into subproblems: first
-			 * find the minimal tuple then for each prefix find all unique suffix
-			 * tuples. For instance, if we are searching over (int, int), we would
-			 * first find (0, 0) then find (0, N) for all N in the domain, then
-			 * find (1, N), then (2, N), etc
-			 */
-			if (unique->numkeys > 1)
-				return;
-
 			break;
 		}
 	}
@@ -211,6 +245,10 @@ tsl_skip_scan_paths_add(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *ou
 	if (!unique)
 		return;
 
+	keys.exprs = get_distinct_exprs(root, root->parse->distinctClause);
+	if (keys.exprs == NIL)
+		return;
+
 	/* Need to make a copy of the unique path here because add_path() in the
 	 * pathlist loop below might prune it if the new unique path
 	 * (SkipScanPath) dominates the old one. When the unique path is pruned,
@@ -223,7 +261,6 @@ tsl_skip_scan_paths_add(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *ou
 	foreach (lc, input_rel->pathlist)
 	{
 		bool project = false;
-		bool has_caa = false;
 
 		Path *subpath = lfirst(lc);
 
@@ -241,68 +278,9 @@ tsl_skip_scan_paths_add(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *ou
 			project = true;
 		}
 
-		/* Path might be wrapped in a ConstraintAwareAppendPath if this
-		 * is a MergeAppend that could benefit from runtime exclusion.
-		 * We treat this similar to ProjectionPath and add it back
-		 * later
-		 */
-		if (ts_is_constraint_aware_append_path(subpath))
-		{
-			subpath = linitial(castNode(CustomPath, subpath)->custom_paths);
-			Assert(IsA(subpath, MergeAppendPath));
-			has_caa = true;
-		}
-
-		if (IsA(subpath, IndexPath))
-		{
-			IndexPath *index_path = castNode(IndexPath, subpath);
-
-			subpath = (Path *) skip_scan_path_create(root, index_path, unique->path.rows);
-			if (!subpath)
-				continue;
-		}
-		else if (IsA(subpath, MergeAppendPath))
-		{
-			MergeAppendPath *merge_path = castNode(MergeAppendPath, subpath);
-			List *new_paths = build_subpath(root, merge_path->subpaths, unique->path.rows);
-
-			/* build_subpath returns NULL when no SkipScanPath was created */
-			if (!new_paths)
-				continue;
-
-			subpath = (Path *) create_merge_append_path_compat(root,
-															   merge_path->path.parent,
-															   new_paths,
-															   merge_path->path.pathkeys,
-															   NULL,
-															   merge_path->partitioned_rels);
-			subpath->pathtarget = copy_pathtarget(merge_path->path.pathtarget);
-		}
-		else if (ts_is_chunk_append_path(subpath))
-		{
-			ChunkAppendPath *ca = (ChunkAppendPath *) subpath;
-			List *new_paths = build_subpath(root, ca->cpath.custom_paths, unique->path.rows);
-			/* ChunkAppend should never be wrapped in ConstraintAwareAppendPath */
-			Assert(!has_caa);
-
-			/* build_subpath returns NULL when no SkipScanPath was created */
-			if (!new_paths)
-				continue;
-
-			/* We copy the existing ChunkAppendPath here because we don't have all the
-			 * information used for creating the original one and we don't want to
-			 * duplicate all the checks done when creating the original one.
-			 */
-			subpath = (Path *) copy_chunk_append_path(ca, new_paths);
-		}
-		else
-		{
+		subpath = skip_scan_input_path_create(root, subpath, unique->path.rows, &keys);
+		if (!subpath)
 			continue;
-		}
-
-		/* add ConstraintAwareAppendPath if the original path had one */
-		if (has_caa)
-			subpath = ts_constraint_aware_append_path_create(root, subpath);
 
 		Path *new_unique = (Path *)
 			create_upper_unique_path(root, output_rel, subpath, unique->numkeys, unique->path.rows);
@@ -318,6 +296,237 @@ tsl_skip_scan_paths_add(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *ou
 	}
 }
 
+static Oid bookend_arg_types[] = { ANYELEMENTOID, ANYOID };
+static Oid first_func_oid = InvalidOid;
+static Oid last_func_oid = InvalidOid;
+
+/*
+ * Check that all the aggregates are first() or last() and pick the same end
+ * of the same column, and remember that column.
+ *
+ * Returns true if any other aggregate is found, following the convention of
+ * expression_tree_walker to abort the walk.
+ */
+static bool
+find_non_bookend_aggs_walker(Node *node, SkipScanKeys *keys)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Aggref))
+	{
+		Aggref *aggref = castNode(Aggref, node);
+		bool desc;
+
+		if (!OidIsValid(first_func_oid))
+		{
+			List *first_name =
+				list_make2(makeString(ts_extension_schema_name()), makeString("first"));
+			List *last_name =
+				list_make2(makeString(ts_extension_schema_name()), makeString("last"));
+
+			first_func_oid = LookupFuncName(first_name, 2, bookend_arg_types, false);
+			last_func_oid = LookupFuncName(last_name, 2, bookend_arg_types, false);
+		}
+
+		if (aggref->aggfnoid == first_func_oid)
+			desc = false;
+		else if (aggref->aggfnoid == last_func_oid)
+			desc = true;
+		else
+			return true;
+
+		if (aggref->aggorder != NIL || aggref->aggfilter != NULL || aggref->agglevelsup != 0 ||
+			list_length(aggref->args) != 2)
+			return true;
+
+		Expr *sort = lsecond_node(TargetEntry, aggref->args)->expr;
+		while (sort && IsA(sort, RelabelType))
+			sort = ((RelabelType *) sort)->arg;
+
+		if (!sort || !IsA(sort, Var))
+			return true;
+
+		if (keys->bookend_var == NULL)
+		{
+			keys->bookend_var = castNode(Var, sort);
+			keys->bookend_desc = desc;
+		}
+		else if (!equal(keys->bookend_var, sort) || keys->bookend_desc != desc)
+			return true;
+
+		/* the arguments of an aggregate can't contain other aggregates */
+		return false;
+	}
+
+	return expression_tree_walker(node, find_non_bookend_aggs_walker, keys);
+}
+
+/*
+ * Create SkipScan paths for a grouped aggregation that only uses first() or
+ * last() with the same sort column, like
+ *
+ *  SELECT device, last(value, time) FROM metrics GROUP BY device;
+ *
+ * With an index on (device, time DESC) the first row of every device in index
+ * order is the one last() picks, so we can skip to the next device after each
+ * row and aggregate a single row per group:
+ *
+ *  GroupAggregate
+ *    Group Key: device
+ *    ->  Custom Scan (SkipScan) on metrics
+ *          ->  Index Scan using metrics_device_time_idx on metrics
+ *
+ * The aggregation stays in the plan, so chunks that we can't use a SkipScan
+ * for still go through the regular aggregation.
+ */
+void
+tsl_skip_scan_agg_paths_add(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *output_rel)
+{
+	Query *parse = root->parse;
+	PathTarget *target = root->upper_targets[UPPERREL_GROUP_AGG];
+	SkipScanKeys keys = { 0 };
+	AggClauseCosts agg_costs;
+	ListCell *lc;
+
+	if (!ts_guc_enable_skip_scan)
+		return;
+
+	if (!parse->hasAggs || parse->groupClause == NIL || parse->groupingSets != NIL ||
+		output_rel->pathlist == NIL || !grouping_is_sortable(parse->groupClause))
+		return;
+
+	if (find_non_bookend_aggs_walker((Node *) target->exprs, &keys) ||
+		find_non_bookend_aggs_walker(parse->havingQual, &keys) || keys.bookend_var == NULL)
+		return;
+
+	/* this also rules out gapfill queries, which group by time_bucket_gapfill() */
+	keys.exprs = get_distinct_exprs(root, parse->groupClause);
+	if (keys.exprs == NIL)
+		return;
+
+	double num_groups = ((Path *) linitial(output_rel->pathlist))->rows;
+
+	MemSet(&agg_costs, 0, sizeof(AggClauseCosts));
+	get_agg_clause_costs_compat(root, (Node *) target->exprs, AGGSPLIT_SIMPLE, &agg_costs);
+	get_agg_clause_costs_compat(root, parse->havingQual, AGGSPLIT_SIMPLE, &agg_costs);
+
+	foreach (lc, input_rel->pathlist)
+	{
+		Path *subpath = lfirst(lc);
+		PathTarget *proj_target = NULL;
+
+		if (!pathkeys_contained_in(root->group_pathkeys, subpath->pathkeys))
+			continue;
+
+		if (IsA(subpath, ProjectionPath))
+		{
+			proj_target = subpath->pathtarget;
+			subpath = castNode(ProjectionPath, subpath)->subpath;
+		}
+
+		subpath = skip_scan_input_path_create(root, subpath, num_groups, &keys);
+		if (!subpath)
+			continue;
+
+		if (proj_target)
+			subpath = (Path *) create_projection_path(root, input_rel, subpath, proj_target);
+
+		add_path(output_rel,
+				 (Path *) create_agg_path(root,
+										  output_rel,
+										  subpath,
+										  target,
+										  AGG_SORTED,
+										  AGGSPLIT_SIMPLE,
+										  parse->groupClause,
+										  (List *) parse->havingQual,
+										  &agg_costs,
+										  num_groups));
+	}
+}
+
+/*
+ * Replace the index scans of an input path of the Unique or Agg node with
+ * SkipScans. Returns NULL if no SkipScan could be created.
+ */
+static Path *
+skip_scan_input_path_create(PlannerInfo *root, Path *subpath, double ndistinct, SkipScanKeys *keys)
+{
+	bool has_caa = false;
+
+	/* Path might be wrapped in a ConstraintAwareAppendPath if this
+	 * is a MergeAppend that could benefit from runtime exclusion.
+	 * We treat this similar to ProjectionPath and add it back
+	 * later
+	 */
+	if (ts_is_constraint_aware_append_path(subpath))
+	{
+		subpath = linitial(castNode(CustomPath, subpath)->custom_paths);
+		Assert(IsA(subpath, MergeAppendPath));
+		has_caa = true;
+	}
+
+	if (IsA(subpath, IndexPath))
+	{
+		IndexPath *index_path = castNode(IndexPath, subpath);
+
+		subpath = (Path *) skip_scan_path_create(root, index_path, ndistinct, keys);
+		if (!subpath)
+			return NULL;
+	}
+	else if (ts_is_decompress_chunk_path(subpath))
+	{
+		subpath = skip_scan_compressed_path_create(root, subpath, ndistinct, keys);
+		if (!subpath)
+			return NULL;
+	}
+	else if (IsA(subpath, MergeAppendPath))
+	{
+		MergeAppendPath *merge_path = castNode(MergeAppendPath, subpath);
+		List *new_paths = build_subpath(root, merge_path->subpaths, ndistinct, keys);
+
+		/* build_subpath returns NULL when no SkipScanPath was created */
+		if (!new_paths)
+			return NULL;
+
+		subpath = (Path *) create_merge_append_path_compat(root,
+														   merge_path->path.parent,
+														   new_paths,
+														   merge_path->path.pathkeys,
+														   NULL,
+														   merge_path->partitioned_rels);
+		subpath->pathtarget = copy_pathtarget(merge_path->path.pathtarget);
+	}
+	else if (ts_is_chunk_append_path(subpath))
+	{
+		ChunkAppendPath *ca = (ChunkAppendPath *) subpath;
+		List *new_paths = build_subpath(root, ca->cpath.custom_paths, ndistinct, keys);
+		/* ChunkAppend should never be wrapped in ConstraintAwareAppendPath */
+		Assert(!has_caa);
+
+		/* build_subpath returns NULL when no SkipScanPath was created */
+		if (!new_paths)
+			return NULL;
+
+		/* We copy the existing ChunkAppendPath here because we don't have all the
+		 * information used for creating the original one and we don't want to
+		 * duplicate all the checks done when creating the original one.
+		 */
+		subpath = (Path *) copy_chunk_append_path(ca, new_paths);
+	}
+	else
+	{
+		return NULL;
+	}
+
+	/* add ConstraintAwareAppendPath if the original path had one */
+	if (has_caa)
+		subpath = ts_constraint_aware_append_path_create(root, subpath);
+
+	return subpath;
+}
+
 static ChunkAppendPath *
 copy_chunk_append_path(ChunkAppendPath *ca, List *subpaths)
 {
@@ -340,7 +549,57 @@ copy_chunk_append_path(ChunkAppendPath *ca, List *subpaths)
 }
 
 static SkipScanPath *
-skip_scan_path_create(PlannerInfo *root, IndexPath *index_path, double ndistinct)
+skip_scan_path_create(PlannerInfo *root, IndexPath *index_path, double ndistinct,
+					  SkipScanKeys *keys)
+{
+	List *vars = get_distinct_vars(root, index_path->path.parent, keys->exprs);
+
+	if (vars == NIL)
+		return NULL;
+
+	SkipScanPath *skip_scan_path =
+		skip_scan_path_create_for_vars(root, index_path, ndistinct, vars);
+
+	if (skip_scan_path && keys->bookend_var && !has_bookend_order(root, skip_scan_path, keys))
+		return NULL;
+
+	return skip_scan_path;
+}
+
+/*
+ * Check that the index column after the distinct columns is the sort column of
+ * the first()/last() aggregates, in the direction the aggregates need. The
+ * column has to be NOT NULL, since the aggregates ignore rows where it is NULL.
+ */
+static bool
+has_bookend_order(PlannerInfo *root, SkipScanPath *skip_scan_path, SkipScanKeys *keys)
+{
+	IndexPath *index_path = skip_scan_path->index_path;
+	IndexOptInfo *info = index_path->indexinfo;
+	int idx_key = skip_scan_path->scankey_attno - 1 + list_length(skip_scan_path->distinct_vars);
+	List *vars = get_distinct_vars(root, info->rel, list_make1(keys->bookend_var));
+
+	if (vars == NIL || idx_key >= info->nkeycolumns)
+		return false;
+
+	Var *var = linitial_node(Var, vars);
+	TypeCacheEntry *tce = lookup_type_cache(var->vartype, TYPECACHE_BTREE_OPFAMILY);
+
+	if (info->indexkeys[idx_key] != var->varattno ||
+		info->sortopfamily[idx_key] != tce->btree_opf ||
+		!get_attnotnull(planner_rt_fetch(info->rel->relid, root)->relid, var->varattno))
+		return false;
+
+	bool desc = info->reverse_sort[idx_key];
+	if (index_path->indexscandir == BackwardScanDirection)
+		desc = !desc;
+
+	return desc == keys->bookend_desc;
+}
+
+static SkipScanPath *
+skip_scan_path_create_for_vars(PlannerInfo *root, IndexPath *index_path, double ndistinct,
+							   List *vars)
 {
 	double startup = index_path->path.startup_cost;
 	double total = index_path->path.total_cost;
@@ -386,30 +645,30 @@ skip_scan_path_create(PlannerInfo *root, IndexPath *index_path, double ndistinct
 	 * free so reusing the IndexPath here is safe. */
 	skip_scan_path->index_path = index_path;
 
-	Var *var = get_distinct_var(root, index_path, skip_scan_path);
-
-	if (!var)
-		return NULL;
-
-	skip_scan_path->distinct_var = var;
-
 	/* build skip qual this may fail if we cannot look up the operator */
-	if (!build_skip_qual(root, skip_scan_path, index_path, var))
+	if (list_length(vars) == 1)
+	{
+		skip_scan_path->distinct_vars = vars;
+		if (!build_skip_qual(root, skip_scan_path, index_path, linitial_node(Var, vars)))
+			return NULL;
+	}
+	else if (!build_skip_row_qual(root, skip_scan_path, index_path, vars))
 		return NULL;
 
 	return skip_scan_path;
 }
 
-/* Extract the Var to use for the SkipScan and do attno mapping if required. */
-static Var *
-get_distinct_var(PlannerInfo *root, IndexPath *index_path, SkipScanPath *skip_scan_path)
+/*
+ * Extract the expressions of the DISTINCT or GROUP BY clauses to use for the
+ * SkipScan. Returns NIL if any of the expressions is not a plain column.
+ */
+static List *
+get_distinct_exprs(PlannerInfo *root, List *clauses)
 {
 	ListCell *lc;
-	int num_vars = 0;
-	RelOptInfo *rel = index_path->path.parent;
-	Expr *tlexpr = NULL;
+	List *vars = NIL;
 
-	foreach (lc, root->parse->distinctClause)
+	foreach (lc, clauses)
 	{
 		SortGroupClause *clause = lfirst_node(SortGroupClause, lc);
 		Node *expr = get_sortgroupclause_expr(clause, root->parse->targetList);
@@ -419,76 +678,181 @@ get_distinct_var(PlannerInfo *root, IndexPath *index_path, SkipScanPath *skip_sc
 		if (IsA(estimate_expression_value(root, expr), Const))
 			continue;
 
-		num_vars++;
-
 		/* We ignore binary-compatible relabeling */
-		tlexpr = (Expr *) expr;
+		Expr *tlexpr = (Expr *) expr;
 		while (tlexpr && IsA(tlexpr, RelabelType))
 			tlexpr = ((RelabelType *) tlexpr)->arg;
+
+		/* SkipScan on expressions not supported */
+		if (!tlexpr || !IsA(tlexpr, Var))
+			return NIL;
+
+		vars = lappend(vars, tlexpr);
 	}
 
-	if (num_vars != 1)
-		return NULL;
+	return vars;
+}
 
-	/* SkipScan on expressions not supported */
-	if (!tlexpr || !IsA(tlexpr, Var))
-		return NULL;
+/* Map the Vars to use for the SkipScan to the relation if required. */
+static List *
+get_distinct_vars(PlannerInfo *root, RelOptInfo *rel, List *vars)
+{
+	ListCell *lc;
+	List *result = NIL;
 
-	Var *var = castNode(Var, tlexpr);
+	if (vars == NIL)
+		return NIL;
 
-	/* If we are dealing with a hypertable Var extracted from distinctClause will point to
+	/* If we are dealing with a hypertable Vars extracted from distinctClause will point to
 	 * the parent hypertable while the IndexPath will be on a Chunk.
 	 * For a normal table they point to the same relation and we are done here. */
-	if ((Index) var->varno == rel->relid)
-		return var;
+	Var *first = linitial_node(Var, vars);
+	if ((Index) first->varno == rel->relid)
+		return vars;
 
-	RangeTblEntry *ht_rte = planner_rt_fetch(var->varno, root);
+	RangeTblEntry *ht_rte = planner_rt_fetch(first->varno, root);
 	RangeTblEntry *chunk_rte = planner_rt_fetch(rel->relid, root);
 
 	/* Check for hypertable */
-	if (!ts_is_hypertable(ht_rte->relid) || !bms_is_member(var->varno, rel->top_parent_relids))
-		return NULL;
+	if (!ts_is_hypertable(ht_rte->relid) || !bms_is_member(first->varno, rel->top_parent_relids))
+		return NIL;
 
 	Relation ht_rel = table_open(ht_rte->relid, AccessShareLock);
 	Relation chunk_rel = table_open(chunk_rte->relid, AccessShareLock);
-	bool found_wholerow;
 	TupleConversionMap *map =
 		convert_tuples_by_name(RelationGetDescr(chunk_rel), RelationGetDescr(ht_rel));
 
-	/* attno mapping necessary */
-	if (map)
+	foreach (lc, vars)
 	{
-		var = (Var *) map_variable_attnos((Node *) var,
-										  var->varno,
-										  0,
-										  map->attrMap,
-										  InvalidOid,
-										  &found_wholerow);
+		Var *var = lfirst_node(Var, lc);
+		bool found_wholerow;
 
-		free_conversion_map(map);
-
-		/* If we found whole row here skipscan wouldn't be applicable
-		 * but this should have been caught already in previous checks */
-		Assert(!found_wholerow);
-		if (found_wholerow)
+		if (var->varno != first->varno)
 		{
-			table_close(ht_rel, NoLock);
-			table_close(chunk_rel, NoLock);
+			result = NIL;
+			break;
+		}
 
-			return NULL;
+		/* attno mapping necessary */
+		if (map)
+		{
+			var = (Var *) map_variable_attnos((Node *) var,
+											  var->varno,
+											  0,
+											  map->attrMap,
+											  InvalidOid,
+											  &found_wholerow);
+
+			/* If we found whole row here skipscan wouldn't be applicable
+			 * but this should have been caught already in previous checks */
+			Assert(!found_wholerow);
+			if (found_wholerow)
+			{
+				result = NIL;
+				break;
+			}
 		}
+		else
+		{
+			var = copyObject(var);
+		}
+
+		var->varno = rel->relid;
+		result = lappend(result, var);
 	}
-	else
-	{
-		var = copyObject(var);
-	}
+
+	if (map)
+		free_conversion_map(map);
 
 	table_close(ht_rel, NoLock);
 	table_close(chunk_rel, NoLock);
 
-	var->varno = rel->relid;
+	return result;
+}
+
+/*
+ * Create a SkipScan path over the index of the compressed chunk for a
+ * DecompressChunk path, when the distinct column is a segmentby column. Each
+ * compressed batch has a single value of a segmentby column, so we only have
+ * to decompress the first batch for every distinct value:
+ *
+ *  Custom Scan (DecompressChunk) on _hyper_1_1_chunk
+ *    ->  Custom Scan (SkipScan) on compress_hyper_2_2_chunk
+ *          ->  Index Scan using compress_hyper_2_2_chunk_idx on compress_hyper_2_2_chunk
+ *
+ * This only works when the first batch of every segment contains the first
+ * row of this segment in the requested order, so the compressed scan must
+ * already be in the right order, and all the quals have to be on the segmentby
+ * columns, so that they either pass or filter out the entire batch.
+ */
+static Path *
+skip_scan_compressed_path_create(PlannerInfo *root, Path *path, double ndistinct,
+								 SkipScanKeys *keys)
+{
+	DecompressChunkPath *dcpath = (DecompressChunkPath *) path;
+	CompressionInfo *info = dcpath->info;
+	Path *compressed_path = linitial(dcpath->custom_path.custom_paths);
+	ListCell *lc;
+
+	/* The first batch of a segment doesn't necessarily have the first row by
+	 * the sort column of first()/last() */
+	if (keys->bookend_var != NULL)
+		return NULL;
 
-	return var;
+	if (!IsA(compressed_path, IndexPath) || dcpath->batch_sorted_merge ||
+		dcpath->custom_path.path.pathkeys == NIL ||
+		!pathkeys_contained_in(dcpath->compressed_pathkeys, compressed_path->pathkeys))
+		return NULL;
+
+	foreach (lc, info->chunk_rel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = lfirst_node(RestrictInfo, lc);
+		Bitmapset *attnos = NULL;
+
+		pull_varattnos((Node *) rinfo->clause, info->chunk_rel->relid, &attnos);
+
+		/* pull_varattnos offsets the attnos to allow for system columns */
+		int attno = -1;
+		while ((attno = bms_next_member(attnos, attno)) >= 0)
+		{
+			if (!bms_is_member(attno + FirstLowInvalidHeapAttributeNumber,
+							   info->chunk_segmentby_attnos))
+				return NULL;
+		}
+	}
+
+	List *vars = get_distinct_vars(root, info->chunk_rel, keys->exprs);
+	List *compressed_vars = NIL;
+	if (vars == NIL)
+		return NULL;
+
+	foreach (lc, vars)
+	{
+		Var *var = lfirst_node(Var, lc);
+		char *column_name = get_attname(info->chunk_rte->relid, var->varattno, false);
+		FormData_hypertable_compression *ci =
+			get_column_compressioninfo(info->hypertable_compression_info, column_name);
+		if (ci->segmentby_column_index <= 0)
+			return NULL;
+
+		/* The segmentby columns have the same name in the compressed chunk. */
+		Var *compressed_var = makeVar(info->compressed_rel->relid,
+									  get_attnum(info->compressed_rte->relid, column_name),
+									  var->vartype,
+									  var->vartypmod,
+									  var->varcollid,
+									  0);
+		compressed_vars = lappend(compressed_vars, compressed_var);
+	}
+
+	SkipScanPath *skip_path = skip_scan_path_create_for_vars(root,
+															 castNode(IndexPath, compressed_path),
+															 ndistinct,
+															 compressed_vars);
+	if (!skip_path)
+		return NULL;
+
+	return decompress_chunk_path_replace_compressed_path(dcpath, &skip_path->cpath.path);
 }
 
 /*
@@ -497,7 +861,7 @@ get_distinct_var(PlannerInfo *root, IndexPath *index_path, SkipScanPath *skip_sc
  * otherwise returns list of new paths
  */
 static List *
-build_subpath(PlannerInfo *root, List *subpaths, double ndistinct)
+build_subpath(PlannerInfo *root, List *subpaths, double ndistinct, SkipScanKeys *keys)
 {
 	bool has_skip_path = false;
 	List *new_paths = NIL;
@@ -509,7 +873,7 @@ build_subpath(PlannerInfo *root, List *subpaths, double ndistinct)
 		if (IsA(child, IndexPath))
 		{
 			SkipScanPath *skip_path =
-				skip_scan_path_create(root, castNode(IndexPath, child), ndistinct);
+				skip_scan_path_create(root, castNode(IndexPath, child), ndistinct, keys);
 
 			if (skip_path)
 			{
@@ -517,6 +881,16 @@ build_subpath(PlannerInfo *root, List *subpaths, double ndistinct)
 				has_skip_path = true;
 			}
 		}
+		else if (ts_is_decompress_chunk_path(child))
+		{
+			Path *skip_path = skip_scan_compressed_path_create(root, child, ndistinct, keys);
+
+			if (skip_path)
+			{
+				child = skip_path;
+				has_skip_path = true;
+			}
+		}
 
 		new_paths = lappend(new_paths, child);
 	}
@@ -536,7 +910,6 @@ build_skip_qual(PlannerInfo *root, SkipScanPath *skip_scan_path, IndexPath *inde
 	IndexOptInfo *info = index_path->indexinfo;
 	Oid column_type = exprType((Node *) var);
 	Oid column_collation = get_typcollation(column_type);
-	TypeCacheEntry *tce = lookup_type_cache(column_type, 0);
 	bool need_coerce = false;
 
 	/*
@@ -558,9 +931,6 @@ build_skip_qual(PlannerInfo *root, SkipScanPath *skip_scan_path, IndexPath *inde
 	if (idx_key < 0)
 		return false;
 
-	skip_scan_path->distinct_attno = var->varattno;
-	skip_scan_path->distinct_by_val = tce->typbyval;
-	skip_scan_path->distinct_typ_len = tce->typlen;
 	/* sk_attno of the skip qual */
 	skip_scan_path->scankey_attno = idx_key + 1;
 
@@ -625,6 +995,107 @@ build_skip_qual(PlannerInfo *root, SkipScanPath *skip_scan_path, IndexPath *inde
 	return true;
 }
 
+/*
+ * Build the skip qual for DISTINCT on multiple columns. This is a row
+ * comparison like
+ *
+ *     (a, b) > (NULL, NULL)
+ *
+ * over the distinct columns in index order, so that a single btree descent
+ * finds the first tuple of the next distinct key. We only handle the case where
+ * the distinct columns are consecutive columns of a btree index with the same
+ * sort direction, and are all declared NOT NULL, so that the SkipScan doesn't
+ * need the NULL stages it uses for a single column.
+ */
+static bool
+build_skip_row_qual(PlannerInfo *root, SkipScanPath *skip_scan_path, IndexPath *index_path,
+					List *vars)
+{
+	IndexOptInfo *info = index_path->indexinfo;
+	Var *vars_by_key[INDEX_MAX_KEYS] = { 0 };
+	int first_key = INDEX_MAX_KEYS;
+	int nvars = list_length(vars);
+	List *opnos = NIL;
+	List *opfamilies = NIL;
+	List *inputcollids = NIL;
+	List *largs = NIL;
+	List *rargs = NIL;
+	ListCell *lc;
+
+	if (info->relam != BTREE_AM_OID)
+		return false;
+
+	foreach (lc, vars)
+	{
+		Var *var = lfirst_node(Var, lc);
+		int idx_key = get_idx_key(info, var->varattno);
+
+		/* see build_skip_qual for why the index might not contain the column */
+		if (idx_key < 0 || vars_by_key[idx_key] != NULL ||
+			!get_attnotnull(planner_rt_fetch(info->rel->relid, root)->relid, var->varattno))
+			return false;
+
+		vars_by_key[idx_key] = var;
+		first_key = Min(first_key, idx_key);
+	}
+
+	if (first_key + nvars > info->nkeycolumns)
+		return false;
+
+	int16 strategy =
+		info->reverse_sort[first_key] ? BTLessStrategyNumber : BTGreaterStrategyNumber;
+	if (index_path->indexscandir == BackwardScanDirection)
+	{
+		strategy =
+			(strategy == BTLessStrategyNumber) ? BTGreaterStrategyNumber : BTLessStrategyNumber;
+	}
+
+	skip_scan_path->distinct_vars = NIL;
+	for (int idx_key = first_key; idx_key < first_key + nvars; idx_key++)
+	{
+		Var *var = vars_by_key[idx_key];
+
+		if (var == NULL || info->reverse_sort[idx_key] != info->reverse_sort[first_key])
+			return false;
+
+		Oid column_type = exprType((Node *) var);
+		Oid column_collation = get_typcollation(column_type);
+		Oid comparator =
+			get_opfamily_member(info->sortopfamily[idx_key], column_type, column_type, strategy);
+
+		/* the row comparison needs Vars on the left side, so we can't coerce here */
+		if (!OidIsValid(comparator))
+			return false;
+
+		opnos = lappend_oid(opnos, comparator);
+		opfamilies = lappend_oid(opfamilies, info->sortopfamily[idx_key]);
+		inputcollids = lappend_oid(inputcollids, info->indexcollations[idx_key]);
+		largs = lappend(largs,
+						makeVar(info->rel->relid,
+								var->varattno,
+								column_type,
+								-1,
+								column_collation,
+								0));
+		rargs = lappend(rargs, makeNullConst(column_type, -1, column_collation));
+		skip_scan_path->distinct_vars = lappend(skip_scan_path->distinct_vars, var);
+	}
+
+	RowCompareExpr *rc = makeNode(RowCompareExpr);
+	rc->rctype = (RowCompareType) strategy;
+	rc->opnos = opnos;
+	rc->opfamilies = opfamilies;
+	rc->inputcollids = inputcollids;
+	rc->largs = largs;
+	rc->rargs = rargs;
+
+	/* sk_attno of the skip qual */
+	skip_scan_path->scankey_attno = first_key + 1;
+	skip_scan_path->skip_clause = make_simple_restrictinfo_compat(root, &rc->xpr);
+
+	return true;
+}
+
 static int
 get_idx_key(IndexOptInfo *idxinfo, AttrNumber attno)
 {
@@ -668,7 +1139,7 @@ sort_indexquals(IndexOptInfo *indexinfo, List *quals)
 	return ordered_list;
 }
 
-static OpExpr *
+static Expr *
 fix_indexqual(IndexOptInfo *index, RestrictInfo *rinfo, AttrNumber scankey_attno)
 {
 	/* technically our placeholder col > NULL is unsatisfiable, and in some instances
@@ -676,6 +1147,27 @@ fix_indexqual(IndexOptInfo *index, RestrictInfo *rinfo, AttrNumber scankey_attno
 	 * in order to prevent this, we prepare this qual ourselves.
 	 */
 
+	/* Row comparison for DISTINCT on multiple columns, the columns are
+	 * consecutive index columns starting with scankey_attno */
+	if (IsA(rinfo->clause, RowCompareExpr))
+	{
+		RowCompareExpr *rc = copyObject(castNode(RowCompareExpr, rinfo->clause));
+		AttrNumber attno = scankey_attno;
+		ListCell *lc;
+
+		foreach (lc, rc->largs)
+		{
+			Var *var = lfirst_node(Var, lc);
+
+			Assert((Index) var->varno == index->rel->relid &&
+				   var->varattno == index->indexkeys[attno - 1]);
+			var->varno = INDEX_VAR;
+			var->varattno = attno++;
+		}
+
+		return &rc->xpr;
+	}
+
 	/* fix_indexqual_references */
 	OpExpr *op = copyObject(castNode(OpExpr, rinfo->clause));
 	Assert(list_length(op->args) == 2);
@@ -694,7 +1186,7 @@ fix_indexqual(IndexOptInfo *index, RestrictInfo *rinfo, AttrNumber scankey_attno
 
 	linitial(op->args) = result;
 
-	return op;
+	return &op->xpr;
 }
 
 /*
@@ -11,6 +11,8 @@
 
 extern void tsl_skip_scan_paths_add(PlannerInfo *root, RelOptInfo *input_rel,
 									RelOptInfo *output_rel);
+extern void tsl_skip_scan_agg_paths_add(PlannerInfo *root, RelOptInfo *input_rel,
+										RelOptInfo *output_rel);
 extern Node *tsl_skip_scan_state_create(CustomScan *cscan);
 extern void _skip_scan_init(void);
 
@@ -0,0 +1,707 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * The VectorAgg node computes a partial aggregation directly over the
+ * compressed batches produced by its DecompressChunk child. Instead of building
+ * the decompressed tuples and feeding them one by one to the Partial Aggregate
+ * node, we run the aggregate transition over the entire bulk-decompressed
+ * columns, and emit the partial aggregation states in the same format as the
+ * Partial Aggregate node would.
+ */
+
+#include <postgres.h>
+
+#include <executor/executor.h>
+#include <nodes/extensible.h>
+#include <nodes/nodeFuncs.h>
+#include <port/pg_bitutils.h>
+#include <utils/timestamp.h>
+
+#include "compression/arrow_c_data_interface.h"
+#include "debug_assert.h"
+#include "nodes/decompress_chunk/batch_array.h"
+#include "nodes/decompress_chunk/compressed_batch.h"
+#include "nodes/decompress_chunk/exec.h"
+#include "nodes/vector_agg/exec.h"
+
+static void
+vector_agg_begin(CustomScanState *node, EState *estate, int eflags)
+{
+	VectorAggState *vector_agg_state = (VectorAggState *) node;
+	CustomScan *cscan = castNode(CustomScan, node->ss.ps.plan);
+	Assert(list_length(cscan->custom_plans) == 1);
+
+	node->custom_ps =
+		lappend(node->custom_ps, ExecInitNode(linitial(cscan->custom_plans), estate, eflags));
+
+	DecompressChunkState *chunk_state = (DecompressChunkState *) linitial(node->custom_ps);
+	Assert(!chunk_state->batch_sorted_merge);
+
+	/*
+	 * We need all the columns of every batch that has any rows passing the
+	 * quals, so there is no point in decompressing some of them lazily.
+	 */
+	chunk_state->num_eager_compressed_columns = chunk_state->num_compressed_columns;
+
+	/*
+	 * The custom scan targetlist contains the partial aggregates and the
+	 * grouping columns, with the aggregate arguments referencing the
+	 * uncompressed chunk columns.
+	 */
+	const int tlist_length = list_length(cscan->custom_scan_tlist);
+	List *segment_meta_attnos =
+		cscan->custom_private != NIL ? linitial(cscan->custom_private) : NIL;
+	Assert(segment_meta_attnos == NIL || list_length(segment_meta_attnos) == tlist_length);
+	vector_agg_state->use_segment_meta = segment_meta_attnos != NIL;
+
+	vector_agg_state->agg_defs = palloc0(sizeof(VectorAggDef) * tlist_length);
+	vector_agg_state->agg_states = palloc0(sizeof(VectorAggFunctionState) * tlist_length);
+	vector_agg_state->grouping_columns = palloc0(sizeof(VectorAggGroupingColumn) * tlist_length);
+	vector_agg_state->bucket_input_column = -1;
+
+	ListCell *lc;
+	foreach (lc, cscan->custom_scan_tlist)
+	{
+		TargetEntry *tlentry = lfirst_node(TargetEntry, lc);
+		const int output_offset = AttrNumberGetAttrOffset(tlentry->resno);
+
+		if (IsA(tlentry->expr, FuncExpr))
+		{
+			/*
+			 * The time_bucket() grouping column, the planner has checked that
+			 * it has a constant fixed-width period and the default origin.
+			 */
+			FuncExpr *func = castNode(FuncExpr, tlentry->expr);
+			Assert(vector_agg_state->bucket_input_column < 0);
+			VectorAggGroupingColumn *col =
+				&vector_agg_state->grouping_columns[vector_agg_state->num_grouping_columns++];
+			col->is_time_bucket = true;
+			col->output_offset = output_offset;
+
+			Const *period = castNode(Const, linitial(func->args));
+			Interval *interval = DatumGetIntervalP(period->constvalue);
+			Assert(interval->month == 0);
+			vector_agg_state->bucket_period = interval->time + interval->day * USECS_PER_DAY;
+			vector_agg_state->bucket_shift =
+				vector_agg_time_bucket_shift(vector_agg_state->bucket_period);
+
+			Var *var = castNode(Var, lsecond(func->args));
+			for (int i = 0; i < chunk_state->num_total_columns; i++)
+			{
+				if (chunk_state->template_columns[i].output_attno == var->varattno)
+				{
+					vector_agg_state->bucket_input_column = i;
+					break;
+				}
+			}
+			Ensure(vector_agg_state->bucket_input_column >= 0,
+				   "decompressed column %d not found for vectorized time_bucket",
+				   var->varattno);
+
+			vector_agg_state->bucket_values =
+				palloc(sizeof(int64) * GLOBAL_MAX_ROWS_PER_COMPRESSION);
+			continue;
+		}
+
+		if (IsA(tlentry->expr, Var))
+		{
+			Var *var = castNode(Var, tlentry->expr);
+			VectorAggGroupingColumn *col =
+				&vector_agg_state->grouping_columns[vector_agg_state->num_grouping_columns++];
+			col->input_offset = AttrNumberGetAttrOffset(var->varattno);
+			col->output_offset = output_offset;
+			for (int i = 0; i < chunk_state->num_total_columns; i++)
+			{
+				if (chunk_state->template_columns[i].output_attno == var->varattno)
+				{
+					col->compressed_scan_attno =
+						chunk_state->template_columns[i].compressed_scan_attno;
+					break;
+				}
+			}
+			Ensure(col->compressed_scan_attno != InvalidAttrNumber,
+				   "decompressed column %d not found for vectorized aggregation",
+				   var->varattno);
+			continue;
+		}
+
+		Aggref *aggref = castNode(Aggref, tlentry->expr);
+		VectorAggDef *def = &vector_agg_state->agg_defs[vector_agg_state->num_agg_defs++];
+		def->kind = vector_agg_get_function_kind(aggref);
+		Ensure(def->kind != VAGG_INVALID, "unsupported vectorized aggregate %u", aggref->aggfnoid);
+		def->output_offset = output_offset;
+		def->input_column = -1;
+		def->segment_meta_attno = vector_agg_state->use_segment_meta ?
+									  list_nth_int(segment_meta_attnos, output_offset) :
+									  InvalidAttrNumber;
+
+		if (aggref->aggstar)
+		{
+			continue;
+		}
+
+		Var *var = castNode(Var, castNode(TargetEntry, linitial(aggref->args))->expr);
+		def->input_type = var->vartype;
+		for (int i = 0; i < chunk_state->num_total_columns; i++)
+		{
+			if (chunk_state->template_columns[i].output_attno == var->varattno)
+			{
+				def->input_column = i;
+				break;
+			}
+		}
+		Ensure(def->input_column >= 0,
+			   "decompressed column %d not found for vectorized aggregate",
+			   var->varattno);
+
+		if (def->kind == VAGG_HISTOGRAM)
+		{
+			def->hist_min =
+				DatumGetFloat8(castNode(Const, lsecond_node(TargetEntry, aggref->args)->expr)
+								   ->constvalue);
+			def->hist_max =
+				DatumGetFloat8(castNode(Const, lthird_node(TargetEntry, aggref->args)->expr)
+								   ->constvalue);
+			def->hist_nbuckets =
+				DatumGetInt32(castNode(Const, lfourth_node(TargetEntry, aggref->args)->expr)
+								  ->constvalue);
+			const int agg_index = vector_agg_state->num_agg_defs - 1;
+			vector_agg_state_alloc(def, &vector_agg_state->agg_states[agg_index]);
+		}
+	}
+
+	for (int i = 0; i < chunk_state->num_total_columns; i++)
+	{
+		if (chunk_state->template_columns[i].type == COUNT_COLUMN)
+		{
+			vector_agg_state->count_column_attno =
+				chunk_state->template_columns[i].compressed_scan_attno;
+		}
+	}
+	Ensure(!vector_agg_state->use_segment_meta ||
+			   vector_agg_state->count_column_attno != InvalidAttrNumber,
+		   "count column not found for vectorized aggregation");
+}
+
+/*
+ * Aggregate the current batch using only its metadata, that is, the row count,
+ * the min/max metadata of the orderby columns and the segmentby column values.
+ * We don't have to decompress anything in this case.
+ */
+static int
+vector_agg_segment_meta(VectorAggState *vector_agg_state, TupleTableSlot *compressed_slot)
+{
+	bool isnull;
+	const int count =
+		DatumGetInt32(slot_getattr(compressed_slot, vector_agg_state->count_column_attno, &isnull));
+	if (isnull || count <= 0)
+	{
+		ereport(ERROR,
+				(errmsg("the compressed data is corrupt: got a segment with length %d", count)));
+	}
+
+	for (int i = 0; i < vector_agg_state->num_agg_defs; i++)
+	{
+		const VectorAggDef *def = &vector_agg_state->agg_defs[i];
+		VectorAggFunctionState *state = &vector_agg_state->agg_states[i];
+		if (def->input_column < 0)
+		{
+			vector_agg_add_count(def, state, count);
+			continue;
+		}
+
+		Assert(def->kind == VAGG_MIN || def->kind == VAGG_MAX);
+		Assert(def->segment_meta_attno != InvalidAttrNumber);
+		Datum value = slot_getattr(compressed_slot, def->segment_meta_attno, &isnull);
+		if (!isnull)
+		{
+			vector_agg_add_datum(def, state, value, 1);
+		}
+	}
+
+	return count;
+}
+
+/*
+ * Add the current row of the decompressed scan slot to the aggregates.
+ */
+static void
+vector_agg_add_row(VectorAggState *vector_agg_state, DecompressChunkState *chunk_state,
+				   TupleTableSlot *slot)
+{
+	for (int i = 0; i < vector_agg_state->num_agg_defs; i++)
+	{
+		const VectorAggDef *def = &vector_agg_state->agg_defs[i];
+		VectorAggFunctionState *state = &vector_agg_state->agg_states[i];
+		if (def->input_column < 0)
+		{
+			vector_agg_add_count(def, state, 1);
+			continue;
+		}
+
+		bool isnull;
+		Datum value = slot_getattr(slot,
+								   chunk_state->template_columns[def->input_column].output_attno,
+								   &isnull);
+		if (!isnull)
+		{
+			vector_agg_add_datum(def, state, value, 1);
+		}
+	}
+}
+
+/*
+ * Aggregate the rows of the current batch one by one. We have to do this when
+ * some quals are not vectorized, or when some columns are not
+ * bulk-decompressed.
+ */
+static int
+vector_agg_rows(VectorAggState *vector_agg_state, DecompressChunkState *chunk_state,
+				DecompressBatchState *batch_state)
+{
+	TupleTableSlot *slot = batch_state->decompressed_scan_slot;
+	int n_rows = 0;
+	for (compressed_batch_advance(chunk_state, batch_state); !TupIsNull(slot);
+		 compressed_batch_advance(chunk_state, batch_state))
+	{
+		n_rows++;
+		vector_agg_add_row(vector_agg_state, chunk_state, slot);
+	}
+
+	return n_rows;
+}
+
+/*
+ * Whether we have to aggregate the current batch row by row.
+ */
+static bool
+vector_agg_needs_row_by_row(VectorAggState *vector_agg_state, DecompressChunkState *chunk_state,
+							DecompressBatchState *batch_state)
+{
+	if (chunk_state->csstate.ss.ps.qual != NULL)
+	{
+		return true;
+	}
+
+	for (int i = 0; i < vector_agg_state->num_agg_defs; i++)
+	{
+		const int column = vector_agg_state->agg_defs[i].input_column;
+		if (column >= 0 && column < chunk_state->num_compressed_columns &&
+			batch_state->compressed_columns[column].iterator != NULL)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Aggregate the rows of the bulk-decompressed batch that pass the given
+ * filter, or all rows if it is NULL. Returns the number of aggregated rows.
+ */
+static int
+vector_agg_bulk(VectorAggState *vector_agg_state, DecompressChunkState *chunk_state,
+				DecompressBatchState *batch_state, const uint64 *filter)
+{
+	int n_passed = batch_state->total_batch_rows;
+	if (filter != NULL)
+	{
+		n_passed = 0;
+		const int n_words = (batch_state->total_batch_rows + 63) / 64;
+		for (int i = 0; i < n_words; i++)
+		{
+			n_passed += pg_popcount64(filter[i]);
+		}
+	}
+
+	for (int i = 0; i < vector_agg_state->num_agg_defs; i++)
+	{
+		const VectorAggDef *def = &vector_agg_state->agg_defs[i];
+		VectorAggFunctionState *state = &vector_agg_state->agg_states[i];
+		if (def->input_column < 0)
+		{
+			vector_agg_add_count(def, state, n_passed);
+			continue;
+		}
+
+		if (def->input_column < chunk_state->num_compressed_columns)
+		{
+			const CompressedColumnValues *column_values =
+				&batch_state->compressed_columns[def->input_column];
+			if (column_values->arrow != NULL)
+			{
+				vector_agg_add_arrow(def, state, column_values->arrow, filter);
+				continue;
+			}
+		}
+
+		/*
+		 * A segmentby column or a compressed column with the default value for
+		 * the entire batch. The value is already stored in the decompressed
+		 * scan slot.
+		 */
+		const AttrNumber attr =
+			AttrNumberGetAttrOffset(chunk_state->template_columns[def->input_column].output_attno);
+		TupleTableSlot *slot = batch_state->decompressed_scan_slot;
+		if (!slot->tts_isnull[attr])
+		{
+			vector_agg_add_datum(def, state, slot->tts_values[attr], n_passed);
+		}
+	}
+
+	return n_passed;
+}
+
+/*
+ * Aggregate the current batch, return the number of rows that passed the
+ * quals.
+ */
+static int
+vector_agg_batch(VectorAggState *vector_agg_state, DecompressChunkState *chunk_state,
+				 DecompressBatchState *batch_state)
+{
+	Assert(batch_state->next_batch_row < batch_state->total_batch_rows);
+
+	if (vector_agg_needs_row_by_row(vector_agg_state, chunk_state, batch_state))
+	{
+		return vector_agg_rows(vector_agg_state, chunk_state, batch_state);
+	}
+
+	const uint64 *filter = batch_state->vector_qual_result;
+	const int n_passed = vector_agg_bulk(vector_agg_state, chunk_state, batch_state, filter);
+
+	/* We're not going to produce any tuples from this batch. */
+	batch_state->next_batch_row = batch_state->total_batch_rows;
+
+	return n_passed;
+}
+
+/*
+ * Start aggregating a new batch by time bucket. If the bucketed timestamps
+ * are bulk-decompressed, compute the buckets for the entire batch at once.
+ */
+static void
+vector_agg_bucket_batch_init(VectorAggState *vector_agg_state, DecompressChunkState *chunk_state,
+							 DecompressBatchState *batch_state)
+{
+	Assert(batch_state->next_batch_row < batch_state->total_batch_rows);
+	Assert(vector_agg_state->bucket_input_column < chunk_state->num_compressed_columns);
+
+	const CompressedColumnValues *time_values =
+		&batch_state->compressed_columns[vector_agg_state->bucket_input_column];
+
+	vector_agg_state->batch_pending = true;
+	vector_agg_state->row_pending = false;
+	vector_agg_state->next_run_row = 0;
+	vector_agg_state->bucket_row_by_row =
+		time_values->arrow == NULL ||
+		vector_agg_needs_row_by_row(vector_agg_state, chunk_state, batch_state);
+
+	if (!vector_agg_state->bucket_row_by_row)
+	{
+		vector_agg_time_bucket_arrow(vector_agg_state->bucket_period,
+									 vector_agg_state->bucket_shift,
+									 time_values->arrow,
+									 vector_agg_state->bucket_values);
+	}
+}
+
+/*
+ * Aggregate the next run of rows with the same time bucket in the row-by-row
+ * mode. The first row of the next run is left pending in the decompressed
+ * scan slot.
+ */
+static int
+vector_agg_bucket_rows(VectorAggState *vector_agg_state, DecompressChunkState *chunk_state,
+					   DecompressBatchState *batch_state)
+{
+	TupleTableSlot *slot = batch_state->decompressed_scan_slot;
+	const AttrNumber time_attno =
+		chunk_state->template_columns[vector_agg_state->bucket_input_column].output_attno;
+	int n_rows = 0;
+
+	if (!vector_agg_state->row_pending)
+	{
+		compressed_batch_advance(chunk_state, batch_state);
+	}
+	vector_agg_state->row_pending = false;
+
+	for (; !TupIsNull(slot); compressed_batch_advance(chunk_state, batch_state))
+	{
+		bool isnull;
+		Datum value = slot_getattr(slot, time_attno, &isnull);
+		Ensure(!isnull, "unexpected null timestamp for vectorized time_bucket");
+		const int64 bucket = vector_agg_time_bucket(vector_agg_state->bucket_period,
+													vector_agg_state->bucket_shift,
+													DatumGetTimestamp(value));
+		if (n_rows > 0 && bucket != vector_agg_state->current_bucket)
+		{
+			vector_agg_state->row_pending = true;
+			return n_rows;
+		}
+
+		vector_agg_state->current_bucket = bucket;
+		n_rows++;
+		vector_agg_add_row(vector_agg_state, chunk_state, slot);
+	}
+
+	vector_agg_state->batch_pending = false;
+	return n_rows;
+}
+
+/*
+ * Aggregate the next run of rows with the same time bucket of the current
+ * batch, return the number of rows that passed the quals.
+ */
+static int
+vector_agg_bucket_run(VectorAggState *vector_agg_state, DecompressChunkState *chunk_state,
+					  DecompressBatchState *batch_state)
+{
+	if (vector_agg_state->bucket_row_by_row)
+	{
+		return vector_agg_bucket_rows(vector_agg_state, chunk_state, batch_state);
+	}
+
+	const int n = batch_state->total_batch_rows;
+	const int64 *restrict buckets = vector_agg_state->bucket_values;
+	const int start = vector_agg_state->next_run_row;
+	Assert(start < n);
+
+	int end = start + 1;
+	while (end < n && buckets[end] == buckets[start])
+	{
+		end++;
+	}
+
+	vector_agg_state->current_bucket = buckets[start];
+	vector_agg_state->next_run_row = end;
+	if (end == n)
+	{
+		vector_agg_state->batch_pending = false;
+
+		/* We're not going to produce any tuples from this batch. */
+		batch_state->next_batch_row = batch_state->total_batch_rows;
+	}
+
+	/*
+	 * Build the filter for the rows of the run that passed the vectorized
+	 * quals.
+	 */
+	uint64 run_filter[MAX_BITMAP_WORDS];
+	const uint64 *restrict qual_result = batch_state->vector_qual_result;
+	const int n_words = (n + 63) / 64;
+	for (int i = 0; i < n_words; i++)
+	{
+		const int word_start = i * 64;
+		uint64 mask = ~0ULL;
+		if (word_start + 64 > end)
+		{
+			mask = end <= word_start ? 0 : (~0ULL) >> (word_start + 64 - end);
+		}
+		if (word_start < start)
+		{
+			mask &= start >= word_start + 64 ? 0 : (~0ULL) << (start - word_start);
+		}
+		run_filter[i] = mask & (qual_result != NULL ? qual_result[i] : ~0ULL);
+	}
+
+	return vector_agg_bulk(vector_agg_state, chunk_state, batch_state, run_filter);
+}
+
+static TupleTableSlot *
+vector_agg_exec(CustomScanState *node)
+{
+	VectorAggState *vector_agg_state = (VectorAggState *) node;
+	DecompressChunkState *chunk_state = (DecompressChunkState *) linitial(node->custom_ps);
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+
+	ResetExprContext(econtext);
+
+	/*
+	 * The output tuple might reference the segmentby values of the batch we
+	 * used for the previous output tuple, so we only release it now. When
+	 * grouping by time bucket, the batch might still have more buckets.
+	 */
+	if (!vector_agg_state->batch_pending)
+	{
+		batch_array_free_at(chunk_state, 0);
+	}
+
+	if (vector_agg_state->input_ended)
+	{
+		return NULL;
+	}
+
+	for (int i = 0; i < vector_agg_state->num_agg_defs; i++)
+	{
+		vector_agg_state_init(&vector_agg_state->agg_states[i]);
+	}
+
+	DecompressBatchState *batch_state = NULL;
+	const bool grouped = vector_agg_state->num_grouping_columns > 0;
+	TupleTableSlot *compressed_slot = NULL;
+	for (;;)
+	{
+		int n_passed;
+		if (vector_agg_state->use_segment_meta)
+		{
+			compressed_slot = ExecProcNode(linitial(chunk_state->csstate.custom_ps));
+			if (TupIsNull(compressed_slot))
+			{
+				vector_agg_state->input_ended = true;
+				break;
+			}
+
+			n_passed = vector_agg_segment_meta(vector_agg_state, compressed_slot);
+		}
+		else if (vector_agg_state->bucket_input_column >= 0)
+		{
+			if (vector_agg_state->batch_pending)
+			{
+				batch_state = batch_array_get_at(chunk_state, 0);
+			}
+			else
+			{
+				batch_state = decompress_chunk_next_batch(chunk_state);
+				if (batch_state == NULL)
+				{
+					vector_agg_state->input_ended = true;
+					break;
+				}
+
+				vector_agg_bucket_batch_init(vector_agg_state, chunk_state, batch_state);
+			}
+
+			n_passed = vector_agg_bucket_run(vector_agg_state, chunk_state, batch_state);
+		}
+		else
+		{
+			batch_state = decompress_chunk_next_batch(chunk_state);
+			if (batch_state == NULL)
+			{
+				vector_agg_state->input_ended = true;
+				break;
+			}
+
+			n_passed = vector_agg_batch(vector_agg_state, chunk_state, batch_state);
+		}
+
+		/*
+		 * We group only by the segmentby columns and the time bucket, so every
+		 * batch or every run of rows with the same bucket belongs to one
+		 * group. We emit the partial aggregation state for each of them, and
+		 * the Finalize Aggregate node above will combine them.
+		 */
+		if (grouped && n_passed > 0)
+		{
+			break;
+		}
+
+		if (!vector_agg_state->batch_pending)
+		{
+			batch_array_free_at(chunk_state, 0);
+		}
+	}
+
+	if (grouped && vector_agg_state->input_ended)
+	{
+		return NULL;
+	}
+
+	/* Build the output tuple with the partial aggregation states. */
+	TupleTableSlot *aggregated_slot = node->ss.ss_ScanTupleSlot;
+	ExecClearTuple(aggregated_slot);
+
+	MemoryContext old_context = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+	for (int i = 0; i < vector_agg_state->num_agg_defs; i++)
+	{
+		const VectorAggDef *def = &vector_agg_state->agg_defs[i];
+		aggregated_slot->tts_values[def->output_offset] =
+			vector_agg_get_result(def,
+								  &vector_agg_state->agg_states[i],
+								  &aggregated_slot->tts_isnull[def->output_offset]);
+	}
+
+	for (int i = 0; i < vector_agg_state->num_grouping_columns; i++)
+	{
+		const VectorAggGroupingColumn *col = &vector_agg_state->grouping_columns[i];
+		if (col->is_time_bucket)
+		{
+			aggregated_slot->tts_values[col->output_offset] =
+				TimestampGetDatum(vector_agg_state->current_bucket);
+			aggregated_slot->tts_isnull[col->output_offset] = false;
+		}
+		else if (vector_agg_state->use_segment_meta)
+		{
+			/*
+			 * The compressed tuple stays valid until we fetch the next one on
+			 * the next call.
+			 */
+			aggregated_slot->tts_values[col->output_offset] =
+				slot_getattr(compressed_slot,
+							 col->compressed_scan_attno,
+							 &aggregated_slot->tts_isnull[col->output_offset]);
+		}
+		else
+		{
+			TupleTableSlot *decompressed_slot = batch_state->decompressed_scan_slot;
+			aggregated_slot->tts_values[col->output_offset] =
+				decompressed_slot->tts_values[col->input_offset];
+			aggregated_slot->tts_isnull[col->output_offset] =
+				decompressed_slot->tts_isnull[col->input_offset];
+		}
+	}
+	MemoryContextSwitchTo(old_context);
+
+	ExecStoreVirtualTuple(aggregated_slot);
+
+	if (node->ss.ps.ps_ProjInfo == NULL)
+	{
+		return aggregated_slot;
+	}
+
+	econtext->ecxt_scantuple = aggregated_slot;
+	return ExecProject(node->ss.ps.ps_ProjInfo);
+}
+
+static void
+vector_agg_rescan(CustomScanState *node)
+{
+	VectorAggState *vector_agg_state = (VectorAggState *) node;
+
+	if (node->ss.ps.chgParam != NULL)
+		UpdateChangedParamSet(linitial(node->custom_ps), node->ss.ps.chgParam);
+
+	ExecReScan(linitial(node->custom_ps));
+
+	vector_agg_state->input_ended = false;
+	vector_agg_state->batch_pending = false;
+	vector_agg_state->row_pending = false;
+}
+
+static void
+vector_agg_end(CustomScanState *node)
+{
+	ExecEndNode(linitial(node->custom_ps));
+}
+
+static struct CustomExecMethods exec_methods = {
+	.CustomName = "VectorAgg",
+	.BeginCustomScan = vector_agg_begin,
+	.ExecCustomScan = vector_agg_exec,
+	.EndCustomScan = vector_agg_end,
+	.ReScanCustomScan = vector_agg_rescan,
+};
+
+Node *
+vector_agg_state_create(CustomScan *cscan)
+{
+	VectorAggState *state = (VectorAggState *) newNode(sizeof(VectorAggState), T_CustomScanState);
+	state->custom.methods = &exec_methods;
+	return (Node *) state;
+}
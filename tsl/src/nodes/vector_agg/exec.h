@@ -0,0 +1,81 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#pragma once
+
+#include <postgres.h>
+#include <nodes/execnodes.h>
+
+#include "nodes/vector_agg/functions.h"
+
+/*
+ * A grouping column of the partial aggregation. They are either segmentby
+ * columns, so they have the same value for the entire compressed batch, or a
+ * time_bucket() over the leading orderby column, which has the same value for
+ * each contiguous run of rows in the batch.
+ */
+typedef struct VectorAggGroupingColumn
+{
+	bool is_time_bucket;
+
+	/* Offset of the column in the decompressed scan tuple. */
+	int input_offset;
+
+	/* Attno of the column in the compressed scan output. */
+	AttrNumber compressed_scan_attno;
+
+	/* Offset of the column in the output tuple. */
+	int output_offset;
+} VectorAggGroupingColumn;
+
+typedef struct VectorAggState
+{
+	CustomScanState custom;
+
+	int num_agg_defs;
+	VectorAggDef *agg_defs;
+	VectorAggFunctionState *agg_states;
+
+	int num_grouping_columns;
+	VectorAggGroupingColumn *grouping_columns;
+
+	/*
+	 * Whether we can compute all the aggregates from the batch metadata, that
+	 * is, the row count and the min/max metadata of the orderby columns. In
+	 * this case, we don't decompress the batches at all.
+	 */
+	bool use_segment_meta;
+	AttrNumber count_column_attno;
+
+	/*
+	 * When grouping by a time_bucket(), its fixed-width period and the shift
+	 * for the origin, and the index of the bucketed timestamp column in the
+	 * DecompressChunk column descriptions, or -1 if we don't group by it.
+	 */
+	int bucket_input_column;
+	int64 bucket_period;
+	int64 bucket_shift;
+
+	/*
+	 * The state of the batch we are emitting the time buckets for. We emit one
+	 * group for each run of rows with the same bucket, so the batch can span
+	 * several output tuples. The buckets of the bulk-decompressed timestamps
+	 * are computed for the entire batch at once. When we aggregate the batch
+	 * row by row, the first row of the next run is pending in the decompressed
+	 * scan slot.
+	 */
+	bool batch_pending;
+	bool bucket_row_by_row;
+	bool row_pending;
+	int next_run_row;
+	int64 current_bucket;
+	int64 *bucket_values;
+
+	/* Whether we have consumed all the compressed batches. */
+	bool input_ended;
+} VectorAggState;
+
+extern Node *vector_agg_state_create(CustomScan *cscan);
@@ -0,0 +1,730 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * The aggregate functions that are computed by the VectorAgg node directly
+ * over the bulk-decompressed batches. They produce exactly the same partial
+ * aggregation states as the respective Postgres transition functions, so that
+ * the results can be combined by the usual Finalize Aggregate node.
+ */
+
+#include <postgres.h>
+
+#include <access/htup_details.h>
+#include <catalog/pg_aggregate.h>
+#include <catalog/pg_type.h>
+#include <catalog/namespace.h>
+#include <libpq/pqformat.h>
+#include <nodes/nodeFuncs.h>
+#include <port/pg_bitutils.h>
+#include <utils/array.h>
+#include <utils/date.h>
+#include <utils/float.h>
+#include <utils/fmgroids.h>
+#include <utils/lsyscache.h>
+#include <utils/syscache.h>
+#include <utils/timestamp.h>
+
+#include "compat/compat.h"
+#include "compression/arrow_c_data_interface.h"
+#include "compression/compression.h"
+#include "debug_assert.h"
+#include "extension_constants.h"
+#include "histogram.h"
+#include "nodes/vector_agg/functions.h"
+
+/*
+ * Check for our histogram(float8, float8, float8, int4) aggregate with constant
+ * bounds and number of buckets, given its transition function.
+ */
+static bool
+is_vectorizable_histogram(Aggref *aggref, Oid transfn)
+{
+	if (list_length(aggref->args) != 4 ||
+		exprType((Node *) linitial_node(TargetEntry, aggref->args)->expr) != FLOAT8OID)
+	{
+		return false;
+	}
+
+	for (int i = 1; i < 4; i++)
+	{
+		Expr *arg = list_nth_node(TargetEntry, aggref->args, i)->expr;
+		if (!IsA(arg, Const) || castNode(Const, arg)->constisnull)
+		{
+			return false;
+		}
+	}
+
+	char *name = get_func_name(transfn);
+	return name != NULL && strcmp(name, "hist_sfunc") == 0 &&
+		   get_func_namespace(transfn) == get_namespace_oid(FUNCTIONS_SCHEMA_NAME, true);
+}
+
+/*
+ * Determine whether we can compute the given partial aggregate in a vectorized
+ * fashion. We support the simple aggregates without FILTER, DISTINCT, ORDER BY
+ * and with at most one argument.
+ */
+VectorAggFunctionKind
+vector_agg_get_function_kind(Aggref *aggref)
+{
+	if (aggref->aggfilter != NULL || aggref->aggdistinct != NIL || aggref->aggorder != NIL ||
+		aggref->aggkind != AGGKIND_NORMAL || aggref->agglevelsup != 0 || aggref->aggvariadic)
+	{
+		return VAGG_INVALID;
+	}
+
+	HeapTuple aggtuple = SearchSysCache1(AGGFNOID, ObjectIdGetDatum(aggref->aggfnoid));
+	if (!HeapTupleIsValid(aggtuple))
+	{
+		elog(ERROR, "cache lookup failed for aggregate %u", aggref->aggfnoid);
+	}
+	Form_pg_aggregate aggform = (Form_pg_aggregate) GETSTRUCT(aggtuple);
+	const Oid transfn = aggform->aggtransfn;
+	ReleaseSysCache(aggtuple);
+
+	if (aggref->aggstar ? aggref->args != NIL : list_length(aggref->args) != 1)
+	{
+		return is_vectorizable_histogram(aggref, transfn) ? VAGG_HISTOGRAM : VAGG_INVALID;
+	}
+
+	/*
+	 * Before PG14, the timestamptz min and max share the F_TIMESTAMP_* oid macros
+	 * with the timestamp ones, because these macros were generated from the
+	 * function prosrc.
+	 */
+	switch (transfn)
+	{
+		case F_INT8INC:
+			return aggref->aggstar ? VAGG_COUNT_STAR : VAGG_INVALID;
+		case F_INT8INC_ANY:
+			return VAGG_COUNT;
+		case F_INT2_SUM:
+		case F_INT4_SUM:
+			return VAGG_SUM_INT;
+		case F_FLOAT4PL:
+			return VAGG_SUM_FLOAT4;
+		case F_FLOAT8PL:
+			return VAGG_SUM_FLOAT8;
+		case F_INT2_AVG_ACCUM:
+		case F_INT4_AVG_ACCUM:
+			return VAGG_AVG_INT;
+		case F_FLOAT4_ACCUM:
+		case F_FLOAT8_ACCUM:
+			return VAGG_FLOAT8_ACCUM;
+		case F_INT2SMALLER:
+		case F_INT4SMALLER:
+		case F_INT8SMALLER:
+		case F_FLOAT4SMALLER:
+		case F_FLOAT8SMALLER:
+		case F_DATE_SMALLER:
+		case F_TIMESTAMP_SMALLER:
+#if PG14_GE
+		case F_TIMESTAMPTZ_SMALLER:
+#endif
+			return VAGG_MIN;
+		case F_INT2LARGER:
+		case F_INT4LARGER:
+		case F_INT8LARGER:
+		case F_FLOAT4LARGER:
+		case F_FLOAT8LARGER:
+		case F_DATE_LARGER:
+		case F_TIMESTAMP_LARGER:
+#if PG14_GE
+		case F_TIMESTAMPTZ_LARGER:
+#endif
+			return VAGG_MAX;
+		default:
+			return VAGG_INVALID;
+	}
+}
+
+void
+vector_agg_state_init(VectorAggFunctionState *state)
+{
+	int64 *hist_counts = state->hist_counts;
+	const int hist_size = state->hist_size;
+
+	memset(state, 0, sizeof(*state));
+
+	if (hist_counts != NULL)
+	{
+		memset(hist_counts, 0, sizeof(*hist_counts) * hist_size);
+		state->hist_counts = hist_counts;
+		state->hist_size = hist_size;
+	}
+}
+
+/*
+ * Allocate the parts of the state that depend on the aggregate arguments, in
+ * the current memory context.
+ */
+void
+vector_agg_state_alloc(const VectorAggDef *def, VectorAggFunctionState *state)
+{
+	/* The bad numbers of buckets are reported when we see the first row. */
+	if (def->kind == VAGG_HISTOGRAM && def->hist_nbuckets > 0 &&
+		def->hist_nbuckets <= PG_INT32_MAX - 2)
+	{
+		state->hist_size = def->hist_nbuckets + 2;
+		state->hist_counts = palloc0(sizeof(*state->hist_counts) * state->hist_size);
+	}
+}
+
+/*
+ * Count the values in the histogram buckets. We check the arguments for every
+ * batch, so that we report the errors for the same inputs as the row-by-row
+ * transition function.
+ */
+static void
+histogram_add(const VectorAggDef *def, VectorAggFunctionState *state, float8 value, int n)
+{
+	ts_hist_check_args(def->hist_min, def->hist_max, def->hist_nbuckets);
+	Assert(state->hist_counts != NULL);
+
+	if (isnan(value))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+				 errmsg("operand, lower bound, and upper bound cannot be NaN")));
+
+	state->hist_counts[ts_hist_bucket(value, def->hist_min, def->hist_max, def->hist_nbuckets)] +=
+		n;
+	state->isvalid = true;
+}
+
+/*
+ * Convert a fixed-width integer datum of the given type to int64.
+ */
+static pg_attribute_always_inline int64
+int_datum_to_int64(Oid type, Datum value)
+{
+	switch (type)
+	{
+		case INT2OID:
+			return DatumGetInt16(value);
+		case INT4OID:
+		case DATEOID:
+			return DatumGetInt32(value);
+		default:
+			Assert(type == INT8OID || type == TIMESTAMPOID || type == TIMESTAMPTZOID);
+			return DatumGetInt64(value);
+	}
+}
+
+static inline bool
+is_float_type(Oid type)
+{
+	return type == FLOAT4OID || type == FLOAT8OID;
+}
+
+static pg_attribute_always_inline float8
+float_datum_to_float8(Oid type, Datum value)
+{
+	return type == FLOAT4OID ? (float8) DatumGetFloat4(value) : DatumGetFloat8(value);
+}
+
+/*
+ * The Youngs-Cramer transition step, same as float8_accum().
+ */
+static pg_attribute_always_inline void
+float8_accum_step(VectorAggFunctionState *state, float8 newval)
+{
+	const float8 old_N = state->N;
+	const float8 old_Sx = state->Sx;
+
+	state->N += 1.0;
+	state->Sx += newval;
+	if (old_N > 0.0)
+	{
+		const float8 tmp = newval * state->N - state->Sx;
+		state->Sxx += tmp * tmp / (state->N * old_N);
+
+		if (isinf(state->Sx) || isinf(state->Sxx))
+		{
+			if (!isinf(old_Sx) && !isinf(newval))
+			{
+				float_overflow_error();
+			}
+
+			state->Sxx = get_float8_nan();
+		}
+	}
+	else
+	{
+		/*
+		 * At the first input, we normally can leave Sxx as 0. However, if the
+		 * first input is Inf or NaN, we'd better force Sxx to NaN.
+		 */
+		if (isnan(newval) || isinf(newval))
+		{
+			state->Sxx = get_float8_nan();
+		}
+	}
+}
+
+static pg_attribute_always_inline void
+minmax_step_int(VectorAggFunctionKind kind, VectorAggFunctionState *state, int64 value)
+{
+	if (!state->isvalid ||
+		(kind == VAGG_MIN ? value < state->int_minmax : value > state->int_minmax))
+	{
+		state->int_minmax = value;
+	}
+	state->isvalid = true;
+}
+
+/*
+ * The float comparisons have the special NaN semantics, same as
+ * float8smaller()/float8larger().
+ */
+static pg_attribute_always_inline void
+minmax_step_float(VectorAggFunctionKind kind, VectorAggFunctionState *state, float8 value)
+{
+	if (!state->isvalid || (kind == VAGG_MIN ? float8_lt(value, state->float_minmax) :
+											   float8_gt(value, state->float_minmax)))
+	{
+		state->float_minmax = value;
+	}
+	state->isvalid = true;
+}
+
+void
+vector_agg_add_count(const VectorAggDef *def, VectorAggFunctionState *state, int n)
+{
+	Assert(def->kind == VAGG_COUNT_STAR);
+	state->count += n;
+}
+
+/*
+ * Add the given non-null value to the aggregate, n times. This is used for
+ * row-by-row aggregation, and for the columns that have the same value for
+ * the entire batch, e.g. the segmentby columns.
+ */
+void
+vector_agg_add_datum(const VectorAggDef *def, VectorAggFunctionState *state, Datum value, int n)
+{
+	Assert(n > 0);
+
+	switch (def->kind)
+	{
+		case VAGG_COUNT:
+			state->count += n;
+			break;
+		case VAGG_SUM_INT:
+			state->int_sum += n * int_datum_to_int64(def->input_type, value);
+			state->isvalid = true;
+			break;
+		case VAGG_AVG_INT:
+			state->count += n;
+			state->int_sum += n * int_datum_to_int64(def->input_type, value);
+			break;
+		case VAGG_SUM_FLOAT4:
+		{
+			const float4 f = DatumGetFloat4(value);
+			for (int i = 0; i < n; i++)
+			{
+				state->float4_sum = state->isvalid ? float4_pl(state->float4_sum, f) : f;
+				state->isvalid = true;
+			}
+			break;
+		}
+		case VAGG_SUM_FLOAT8:
+		{
+			const float8 f = DatumGetFloat8(value);
+			for (int i = 0; i < n; i++)
+			{
+				state->float8_sum = state->isvalid ? float8_pl(state->float8_sum, f) : f;
+				state->isvalid = true;
+			}
+			break;
+		}
+		case VAGG_FLOAT8_ACCUM:
+		{
+			const float8 f = float_datum_to_float8(def->input_type, value);
+			for (int i = 0; i < n; i++)
+			{
+				float8_accum_step(state, f);
+			}
+			break;
+		}
+		case VAGG_MIN:
+		case VAGG_MAX:
+			if (is_float_type(def->input_type))
+			{
+				minmax_step_float(def->kind, state, float_datum_to_float8(def->input_type, value));
+			}
+			else
+			{
+				minmax_step_int(def->kind, state, int_datum_to_int64(def->input_type, value));
+			}
+			break;
+		case VAGG_HISTOGRAM:
+			histogram_add(def, state, DatumGetFloat8(value), n);
+			break;
+		default:
+			elog(ERROR, "unexpected vectorized aggregate kind %d", def->kind);
+	}
+}
+
+/*
+ * Integer sum of the valid rows of an arrow array. We multiply by the validity
+ * bit instead of branching, so that the compiler can vectorize the loop.
+ */
+#define SUM_INT_LOOP(CTYPE)                                                                        \
+	do                                                                                             \
+	{                                                                                              \
+		const CTYPE *restrict values = (const CTYPE *) arrow->buffers[1];                          \
+		for (int i = 0; i < n; i++)                                                                \
+		{                                                                                          \
+			sum += ((int64) values[i]) * (int64) arrow_row_is_valid(valid, i);                     \
+		}                                                                                          \
+	} while (0)
+
+#define MINMAX_LOOP(CTYPE, STEP)                                                                   \
+	do                                                                                             \
+	{                                                                                              \
+		const CTYPE *restrict values = (const CTYPE *) arrow->buffers[1];                          \
+		for (int i = 0; i < n; i++)                                                                \
+		{                                                                                          \
+			if (arrow_row_is_valid(valid, i))                                                      \
+			{                                                                                      \
+				STEP(def->kind, state, values[i]);                                                 \
+			}                                                                                      \
+		}                                                                                          \
+	} while (0)
+
+#define FLOAT_LOOP(CTYPE, BODY)                                                                    \
+	do                                                                                             \
+	{                                                                                              \
+		const CTYPE *restrict values = (const CTYPE *) arrow->buffers[1];                          \
+		for (int i = 0; i < n; i++)                                                                \
+		{                                                                                          \
+			if (arrow_row_is_valid(valid, i))                                                      \
+			{                                                                                      \
+				const CTYPE value = values[i];                                                     \
+				BODY;                                                                              \
+			}                                                                                      \
+		}                                                                                          \
+	} while (0)
+
+/*
+ * Count the valid rows of a bulk-decompressed float8 column in the histogram
+ * buckets. We first compute the buckets of all rows, and then add the valid
+ * ones to the counts, so that the bucket computation can be vectorized.
+ */
+static void
+histogram_add_arrow(const VectorAggDef *def, VectorAggFunctionState *state,
+					const ArrowArray *arrow, const uint64 *valid)
+{
+	const int n = arrow->length;
+	const float8 *restrict values = (const float8 *) arrow->buffers[1];
+	const float8 min = def->hist_min;
+	const float8 max = def->hist_max;
+	const int32 nbuckets = def->hist_nbuckets;
+	int32 buckets[GLOBAL_MAX_ROWS_PER_COMPRESSION];
+	bool has_nan = false;
+
+	ts_hist_check_args(min, max, nbuckets);
+	Assert(state->hist_counts != NULL);
+
+	for (int i = 0; i < n; i++)
+	{
+		/* The rows that don't pass the filter might contain anything. */
+		const bool is_nan = isnan(values[i]);
+		has_nan |= is_nan && arrow_row_is_valid(valid, i);
+		buckets[i] = ts_hist_bucket(is_nan ? min : values[i], min, max, nbuckets);
+	}
+
+	if (has_nan)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+				 errmsg("operand, lower bound, and upper bound cannot be NaN")));
+
+	int64 *restrict counts = state->hist_counts;
+	for (int i = 0; i < n; i++)
+	{
+		counts[buckets[i]] += arrow_row_is_valid(valid, i);
+	}
+	state->isvalid = true;
+}
+
+/*
+ * Add the rows of a bulk-decompressed column that pass the given filter bitmap
+ * to the aggregate. The filter can be NULL, which means all rows pass.
+ */
+void
+vector_agg_add_arrow(const VectorAggDef *def, VectorAggFunctionState *state,
+					 const ArrowArray *arrow, const uint64 *filter)
+{
+	const int n = arrow->length;
+	const int n_words = (n + 63) / 64;
+	Ensure(n_words <= MAX_BITMAP_WORDS, "too many rows in a compressed batch: %d", n);
+
+	/* Combine the filter and the validity bitmap into the bitmap of the valid rows. */
+	uint64 valid[MAX_BITMAP_WORDS];
+	const uint64 *validity = (const uint64 *) arrow->buffers[0];
+	for (int i = 0; i < n_words; i++)
+	{
+		valid[i] = (filter ? filter[i] : ~0ULL) & (validity ? validity[i] : ~0ULL);
+	}
+
+	if (n % 64 != 0)
+	{
+		valid[n_words - 1] &= ~0ULL >> (64 - n % 64);
+	}
+
+	int n_valid = 0;
+	for (int i = 0; i < n_words; i++)
+	{
+		n_valid += pg_popcount64(valid[i]);
+	}
+
+	if (n_valid == 0)
+	{
+		return;
+	}
+
+	switch (def->kind)
+	{
+		case VAGG_COUNT:
+			state->count += n_valid;
+			break;
+		case VAGG_SUM_INT:
+		case VAGG_AVG_INT:
+		{
+			int64 sum = 0;
+			if (def->input_type == INT2OID)
+			{
+				SUM_INT_LOOP(int16);
+			}
+			else
+			{
+				Assert(def->input_type == INT4OID);
+				SUM_INT_LOOP(int32);
+			}
+			state->int_sum += sum;
+			if (def->kind == VAGG_AVG_INT)
+			{
+				state->count += n_valid;
+			}
+			state->isvalid = true;
+			break;
+		}
+		case VAGG_SUM_FLOAT4:
+			FLOAT_LOOP(float4, {
+				state->float4_sum = state->isvalid ? float4_pl(state->float4_sum, value) : value;
+				state->isvalid = true;
+			});
+			break;
+		case VAGG_SUM_FLOAT8:
+			FLOAT_LOOP(float8, {
+				state->float8_sum = state->isvalid ? float8_pl(state->float8_sum, value) : value;
+				state->isvalid = true;
+			});
+			break;
+		case VAGG_FLOAT8_ACCUM:
+			if (def->input_type == FLOAT4OID)
+			{
+				FLOAT_LOOP(float4, float8_accum_step(state, value));
+			}
+			else
+			{
+				FLOAT_LOOP(float8, float8_accum_step(state, value));
+			}
+			break;
+		case VAGG_MIN:
+		case VAGG_MAX:
+			switch (def->input_type)
+			{
+				case INT2OID:
+					MINMAX_LOOP(int16, minmax_step_int);
+					break;
+				case INT4OID:
+				case DATEOID:
+					MINMAX_LOOP(int32, minmax_step_int);
+					break;
+				case INT8OID:
+				case TIMESTAMPOID:
+				case TIMESTAMPTZOID:
+					MINMAX_LOOP(int64, minmax_step_int);
+					break;
+				case FLOAT4OID:
+					MINMAX_LOOP(float4, minmax_step_float);
+					break;
+				case FLOAT8OID:
+					MINMAX_LOOP(float8, minmax_step_float);
+					break;
+				default:
+					elog(ERROR, "unexpected type %u for vectorized min/max", def->input_type);
+			}
+			break;
+		case VAGG_HISTOGRAM:
+			Assert(def->input_type == FLOAT8OID);
+			histogram_add_arrow(def, state, arrow, valid);
+			break;
+		default:
+			elog(ERROR, "unexpected vectorized aggregate kind %d", def->kind);
+	}
+}
+
+/*
+ * Build the Postgres partial aggregation state from our transition state.
+ */
+Datum
+vector_agg_get_result(const VectorAggDef *def, VectorAggFunctionState *state, bool *isnull)
+{
+	*isnull = false;
+
+	switch (def->kind)
+	{
+		case VAGG_COUNT_STAR:
+		case VAGG_COUNT:
+			return Int64GetDatum(state->count);
+		case VAGG_SUM_INT:
+			*isnull = !state->isvalid;
+			return Int64GetDatum(state->int_sum);
+		case VAGG_SUM_FLOAT4:
+			*isnull = !state->isvalid;
+			return Float4GetDatum(state->float4_sum);
+		case VAGG_SUM_FLOAT8:
+			*isnull = !state->isvalid;
+			return Float8GetDatum(state->float8_sum);
+		case VAGG_AVG_INT:
+		{
+			/* The layout of Int8TransTypeData used by int4_avg_accum(). */
+			Datum elements[2] = { Int64GetDatum(state->count), Int64GetDatum(state->int_sum) };
+			return PointerGetDatum(
+				construct_array(elements, 2, INT8OID, sizeof(int64), FLOAT8PASSBYVAL, 'd'));
+		}
+		case VAGG_FLOAT8_ACCUM:
+		{
+			Datum elements[3] = { Float8GetDatum(state->N),
+								  Float8GetDatum(state->Sx),
+								  Float8GetDatum(state->Sxx) };
+			return PointerGetDatum(
+				construct_array(elements, 3, FLOAT8OID, sizeof(float8), FLOAT8PASSBYVAL, 'd'));
+		}
+		case VAGG_MIN:
+		case VAGG_MAX:
+			*isnull = !state->isvalid;
+			switch (def->input_type)
+			{
+				case INT2OID:
+					return Int16GetDatum((int16) state->int_minmax);
+				case INT4OID:
+					return Int32GetDatum((int32) state->int_minmax);
+				case DATEOID:
+					return DateADTGetDatum((DateADT) state->int_minmax);
+				case INT8OID:
+					return Int64GetDatum(state->int_minmax);
+				case TIMESTAMPOID:
+				case TIMESTAMPTZOID:
+					return TimestampGetDatum((Timestamp) state->int_minmax);
+				case FLOAT4OID:
+					return Float4GetDatum((float4) state->float_minmax);
+				case FLOAT8OID:
+					return Float8GetDatum(state->float_minmax);
+				default:
+					elog(ERROR, "unexpected type %u for vectorized min/max", def->input_type);
+			}
+			pg_unreachable();
+		case VAGG_HISTOGRAM:
+		{
+			/* The serialized state of the histogram() aggregate, see ts_hist_serializefunc(). */
+			StringInfoData buf;
+
+			*isnull = !state->isvalid;
+			if (!state->isvalid)
+			{
+				return PointerGetDatum(NULL);
+			}
+
+			pq_begintypsend(&buf);
+			pq_sendint32(&buf, state->hist_size);
+			for (int i = 0; i < state->hist_size; i++)
+			{
+				if (state->hist_counts[i] > PG_INT32_MAX - 1)
+				{
+					elog(ERROR, "overflow in histogram");
+				}
+				pq_sendint32(&buf, (int32) state->hist_counts[i]);
+			}
+			return PointerGetDatum(pq_endtypsend(&buf));
+		}
+		default:
+			elog(ERROR, "unexpected vectorized aggregate kind %d", def->kind);
+	}
+
+	pg_unreachable();
+}
+
+/*
+ * The default origin of time_bucket() is Monday 2000-01-03, see time_bucket.c.
+ */
+#define TIME_BUCKET_DEFAULT_ORIGIN (2 * USECS_PER_DAY)
+
+/*
+ * Get the shift of the time buckets for the given period, with the default
+ * origin. This also checks the period the same way time_bucket() does.
+ */
+int64
+vector_agg_time_bucket_shift(int64 period)
+{
+	if (period <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("period must be greater than 0")));
+
+	return TIME_BUCKET_DEFAULT_ORIGIN % period;
+}
+
+/*
+ * Compute time_bucket() for a fixed-width period and the default origin, with
+ * the same results as ts_timestamp_bucket() and ts_timestamptz_bucket().
+ */
+static pg_attribute_always_inline int64
+time_bucket_impl(int64 period, int64 shift, int64 timestamp)
+{
+	if (TIMESTAMP_NOT_FINITE(timestamp))
+	{
+		return timestamp;
+	}
+
+	if (shift > 0 && timestamp < DT_NOBEGIN + shift)
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), errmsg("timestamp out of range")));
+
+	const int64 shifted = timestamp - shift;
+	const int64 quotient = shifted / period;
+
+	/* The division truncates toward zero, and we need the floor. */
+	const int64 bucket = (shifted - quotient * period < 0) ? quotient * period - period :
+															 quotient * period;
+	return bucket + shift;
+}
+
+int64
+vector_agg_time_bucket(int64 period, int64 shift, int64 timestamp)
+{
+	return time_bucket_impl(period, shift, timestamp);
+}
+
+/*
+ * Compute the time buckets for all the rows of the bulk-decompressed timestamp
+ * column. This is a simple integer division loop instead of a function call
+ * per row.
+ */
+void
+vector_agg_time_bucket_arrow(int64 period, int64 shift, const ArrowArray *arrow,
+							 int64 *restrict result)
+{
+	const int n = arrow->length;
+	const int64 *restrict values = (const int64 *) arrow->buffers[1];
+	for (int i = 0; i < n; i++)
+	{
+		result[i] = time_bucket_impl(period, shift, values[i]);
+	}
+}
@@ -0,0 +1,132 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#pragma once
+
+#include <postgres.h>
+#include <nodes/primnodes.h>
+
+#include "compression/compression.h"
+
+typedef struct ArrowArray ArrowArray;
+
+#define MAX_BITMAP_WORDS ((GLOBAL_MAX_ROWS_PER_COMPRESSION + 63) / 64)
+
+/*
+ * The aggregate functions we can compute over the bulk-decompressed batches.
+ * They are identified by the transition function of the aggregate, so e.g.
+ * VAGG_FLOAT8_ACCUM covers avg(), stddev() and variance() of float arguments,
+ * because they all share the same partial aggregation state.
+ */
+typedef enum VectorAggFunctionKind
+{
+	VAGG_INVALID = 0,
+	VAGG_COUNT_STAR,
+	VAGG_COUNT,
+	VAGG_SUM_INT,
+	VAGG_SUM_FLOAT4,
+	VAGG_SUM_FLOAT8,
+	VAGG_AVG_INT,
+	VAGG_FLOAT8_ACCUM,
+	VAGG_MIN,
+	VAGG_MAX,
+	VAGG_HISTOGRAM,
+} VectorAggFunctionKind;
+
+/*
+ * The description of an aggregate computed by the VectorAgg node.
+ */
+typedef struct VectorAggDef
+{
+	VectorAggFunctionKind kind;
+
+	/* The type of the aggregate argument, invalid for count(*). */
+	Oid input_type;
+
+	/*
+	 * Index of the argument column in the DecompressChunk column descriptions,
+	 * -1 for count(*).
+	 */
+	int input_column;
+
+	/* Offset of the partial aggregate result in the output tuple. */
+	int output_offset;
+
+	/*
+	 * For min() and max(), the attno of the respective segment metadata column
+	 * in the compressed scan output, or InvalidAttrNumber if there is none.
+	 */
+	AttrNumber segment_meta_attno;
+
+	/* The constant bounds and number of buckets of histogram(). */
+	float8 hist_min;
+	float8 hist_max;
+	int32 hist_nbuckets;
+} VectorAggDef;
+
+/*
+ * The transition state of a vectorized aggregate. It is converted to the
+ * Postgres partial aggregation state of the respective aggregate when we
+ * emit the result.
+ */
+typedef struct VectorAggFunctionState
+{
+	/*
+	 * Whether we have seen any non-null input, for the aggregates that return
+	 * null on empty input.
+	 */
+	bool isvalid;
+
+	/* Number of input rows for count() and avg() of integer arguments. */
+	int64 count;
+
+	/* Sum for sum() and avg() of integer arguments. */
+	int64 int_sum;
+
+	/* Sum for sum() of float arguments. */
+	float4 float4_sum;
+	float8 float8_sum;
+
+	/* The Youngs-Cramer transition state of the float8_accum() function. */
+	float8 N;
+	float8 Sx;
+	float8 Sxx;
+
+	/* The current value for min() and max(). */
+	int64 int_minmax;
+	float8 float_minmax;
+
+	/*
+	 * The bucket counts of histogram(), including the buckets below and above
+	 * the range. They are allocated once and kept when the state is reset.
+	 */
+	int64 *hist_counts;
+	int hist_size;
+} VectorAggFunctionState;
+
+extern VectorAggFunctionKind vector_agg_get_function_kind(Aggref *aggref);
+
+extern void vector_agg_state_init(VectorAggFunctionState *state);
+
+extern void vector_agg_state_alloc(const VectorAggDef *def, VectorAggFunctionState *state);
+
+extern void vector_agg_add_count(const VectorAggDef *def, VectorAggFunctionState *state, int n);
+
+extern void vector_agg_add_datum(const VectorAggDef *def, VectorAggFunctionState *state,
+								 Datum value, int n);
+
+extern void vector_agg_add_arrow(const VectorAggDef *def, VectorAggFunctionState *state,
+								 const ArrowArray *arrow, const uint64 *filter);
+
+extern Datum vector_agg_get_result(const VectorAggDef *def, VectorAggFunctionState *state,
+								   bool *isnull);
+
+extern int64 vector_agg_time_bucket_shift(int64 period);
+
+extern int64 vector_agg_time_bucket(int64 period, int64 shift, int64 timestamp);
+
+extern void vector_agg_time_bucket_arrow(int64 period, int64 shift, const ArrowArray *arrow,
+										 int64 *restrict result);
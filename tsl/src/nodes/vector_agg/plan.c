@@ -0,0 +1,521 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#include <postgres.h>
+
+#include <nodes/extensible.h>
+#include <nodes/makefuncs.h>
+#include <nodes/nodeFuncs.h>
+#include <nodes/pg_list.h>
+#include <optimizer/optimizer.h>
+#include <parser/parsetree.h>
+#include <utils/lsyscache.h>
+#include <utils/timestamp.h>
+
+#include "compat/compat.h"
+#include "compression/create.h"
+#include "func_cache.h"
+#include "ts_catalog/hypertable_compression.h"
+#include "nodes/decompress_chunk/planner.h"
+#include "nodes/vector_agg/exec.h"
+#include "nodes/vector_agg/functions.h"
+#include "nodes/vector_agg/plan.h"
+
+static CustomScanMethods vector_agg_plan_methods = {
+	.CustomName = "VectorAgg",
+	.CreateCustomScanState = vector_agg_state_create,
+};
+
+void
+_vector_agg_init(void)
+{
+	TryRegisterCustomScanMethods(&vector_agg_plan_methods);
+}
+
+/*
+ * Replace the OUTER_VAR references to the DecompressChunk output with the
+ * uncompressed chunk Vars they refer to. This is needed both for EXPLAIN and
+ * for the executor, which works with the decompressed scan tuples directly.
+ */
+static Node *
+resolve_outer_special_vars_mutator(Node *node, void *context)
+{
+	if (node == NULL)
+	{
+		return NULL;
+	}
+
+	if (IsA(node, Var))
+	{
+		Var *var = castNode(Var, node);
+		if (var->varno != OUTER_VAR)
+		{
+			return copyObject(node);
+		}
+
+		List *child_tlist = (List *) context;
+		TargetEntry *child_tlentry =
+			list_nth_node(TargetEntry, child_tlist, AttrNumberGetAttrOffset(var->varattno));
+		return (Node *) copyObject(child_tlentry->expr);
+	}
+
+	return expression_tree_mutator(node, resolve_outer_special_vars_mutator, context);
+}
+
+/*
+ * Find the DecompressChunk targetlist expression that is referenced by the
+ * given OUTER_VAR Var of the Agg node, or NULL if this is not such a Var.
+ */
+static Expr *
+get_decompress_chunk_tlist_expr(CustomScan *decompress_chunk, Expr *expr)
+{
+	if (!IsA(expr, Var) || castNode(Var, expr)->varno != OUTER_VAR)
+	{
+		return NULL;
+	}
+
+	Var *outer_var = castNode(Var, expr);
+	if (outer_var->varattno <= 0 ||
+		outer_var->varattno > list_length(decompress_chunk->scan.plan.targetlist))
+	{
+		return NULL;
+	}
+
+	TargetEntry *child_tlentry = list_nth_node(TargetEntry,
+											   decompress_chunk->scan.plan.targetlist,
+											   AttrNumberGetAttrOffset(outer_var->varattno));
+	return child_tlentry->expr;
+}
+
+/*
+ * Check that the given Agg expression is an OUTER_VAR reference to a plain
+ * column of the DecompressChunk scan, and find out whether that column is a
+ * segmentby one, and what is its attno in the compressed scan output.
+ */
+static bool
+is_decompressed_column_ref(CustomScan *decompress_chunk, Expr *expr, bool *is_segmentby,
+						   AttrNumber *compressed_scan_attno)
+{
+	return decompress_chunk_is_chunk_column(decompress_chunk,
+											get_decompress_chunk_tlist_expr(decompress_chunk, expr),
+											is_segmentby,
+											compressed_scan_attno);
+}
+
+/*
+ * Check whether the given Agg expression is an OUTER_VAR reference to a
+ * time_bucket() with a constant fixed-width interval and the default origin,
+ * over a timestamp column that is the leading orderby column of compression,
+ * so that the buckets form contiguous runs inside every compressed batch. We
+ * compute such buckets over the bulk-decompressed time column directly.
+ */
+static bool
+is_vectorizable_time_bucket_ref(CustomScan *decompress_chunk, Expr *expr)
+{
+	Expr *tlist_expr = get_decompress_chunk_tlist_expr(decompress_chunk, expr);
+	if (tlist_expr == NULL || !IsA(tlist_expr, FuncExpr))
+	{
+		return false;
+	}
+
+	FuncExpr *func = castNode(FuncExpr, tlist_expr);
+	FuncInfo *finfo = ts_func_cache_get_bucketing_func(func->funcid);
+	if (finfo == NULL || strcmp(finfo->funcname, "time_bucket") != 0 || finfo->nargs != 2 ||
+		list_length(func->args) != 2 ||
+		(finfo->arg_types[1] != TIMESTAMPOID && finfo->arg_types[1] != TIMESTAMPTZOID))
+	{
+		return false;
+	}
+
+	/* No month or year semantics. */
+	Const *period = linitial(func->args);
+	if (!IsA(period, Const) || period->constisnull ||
+		DatumGetIntervalP(period->constvalue)->month != 0 ||
+		DatumGetIntervalP(period->constvalue)->time +
+				DatumGetIntervalP(period->constvalue)->day * USECS_PER_DAY <=
+			0)
+	{
+		return false;
+	}
+
+	bool is_segmentby = false;
+	AttrNumber compressed_scan_attno;
+	Var *var = lsecond(func->args);
+	if (!decompress_chunk_is_chunk_column(decompress_chunk,
+										  (Expr *) var,
+										  &is_segmentby,
+										  &compressed_scan_attno) ||
+		is_segmentby)
+	{
+		return false;
+	}
+
+	/*
+	 * We don't handle the null buckets, and we need the rows to be sorted by
+	 * this column inside the batch.
+	 */
+	List *settings = linitial(decompress_chunk->custom_private);
+	const int32 hypertable_id = linitial_int(settings);
+	const Oid chunk_relid = lsecond_int(settings);
+	if (!get_attnotnull(chunk_relid, var->varattno))
+	{
+		return false;
+	}
+
+	char *attname = get_attname(chunk_relid, var->varattno, /* missing_ok = */ false);
+	FormData_hypertable_compression *compression_info =
+		ts_hypertable_compression_get_by_pkey(hypertable_id, attname);
+	return compression_info != NULL && compression_info->orderby_column_index == 1;
+}
+
+static bool
+can_vectorize_agg(Agg *agg, CustomScan *decompress_chunk)
+{
+	if (agg->aggsplit != AGGSPLIT_INITIAL_SERIAL || agg->plan.qual != NIL ||
+		agg->groupingSets != NIL)
+	{
+		return false;
+	}
+
+	/* We can't use the batch sorted merge, we consume the batches directly. */
+	List *settings = linitial(decompress_chunk->custom_private);
+	if (lfourth_int(settings))
+	{
+		return false;
+	}
+
+	/*
+	 * We support grouping by segmentby columns, which have one value for the
+	 * entire batch, and by at most one time_bucket() over the leading orderby
+	 * column, which has one value for each contiguous run of rows in the
+	 * batch. The hashed partial aggregation doesn't guarantee any output
+	 * order, so we can emit one partial aggregation state per such run.
+	 */
+	if (agg->aggstrategy == AGG_HASHED)
+	{
+		if (agg->numCols == 0)
+		{
+			return false;
+		}
+
+		int num_time_buckets = 0;
+		for (int i = 0; i < agg->numCols; i++)
+		{
+			/* Only the varno and varattno matter for the check. */
+			Var *outer_var =
+				makeVar(OUTER_VAR, agg->grpColIdx[i], InvalidOid, -1, InvalidOid, 0);
+			bool is_segmentby = false;
+			AttrNumber compressed_scan_attno;
+			if (is_decompressed_column_ref(decompress_chunk,
+										   (Expr *) outer_var,
+										   &is_segmentby,
+										   &compressed_scan_attno) &&
+				is_segmentby)
+			{
+				continue;
+			}
+
+			if (!is_vectorizable_time_bucket_ref(decompress_chunk, (Expr *) outer_var) ||
+				++num_time_buckets > 1)
+			{
+				return false;
+			}
+		}
+	}
+	else if (agg->aggstrategy != AGG_PLAIN || agg->numCols != 0)
+	{
+		return false;
+	}
+
+	ListCell *lc;
+	foreach (lc, agg->plan.targetlist)
+	{
+		TargetEntry *tlentry = lfirst_node(TargetEntry, lc);
+		bool is_segmentby = false;
+		AttrNumber compressed_scan_attno;
+
+		if (IsA(tlentry->expr, Var))
+		{
+			/* Must be one of the grouping columns. */
+			Var *var = castNode(Var, tlentry->expr);
+			bool found = false;
+			for (int i = 0; i < agg->numCols; i++)
+			{
+				found |= var->varno == OUTER_VAR && var->varattno == agg->grpColIdx[i];
+			}
+
+			if (!found ||
+				(!is_decompressed_column_ref(decompress_chunk,
+											 tlentry->expr,
+											 &is_segmentby,
+											 &compressed_scan_attno) &&
+				 !is_vectorizable_time_bucket_ref(decompress_chunk, tlentry->expr)))
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		if (!IsA(tlentry->expr, Aggref))
+		{
+			return false;
+		}
+
+		Aggref *aggref = castNode(Aggref, tlentry->expr);
+		if (vector_agg_get_function_kind(aggref) == VAGG_INVALID)
+		{
+			return false;
+		}
+
+		if (!aggref->aggstar &&
+			!is_decompressed_column_ref(decompress_chunk,
+										castNode(TargetEntry, linitial(aggref->args))->expr,
+										&is_segmentby,
+										&compressed_scan_attno))
+		{
+			return false;
+		}
+
+		/*
+		 * The row-by-row histogram() counts the null inputs as zeros, which we
+		 * don't do, so we only vectorize it over the columns without nulls.
+		 */
+		if (vector_agg_get_function_kind(aggref) == VAGG_HISTOGRAM)
+		{
+			Var *var = castNode(Var,
+								get_decompress_chunk_tlist_expr(decompress_chunk,
+																linitial_node(TargetEntry,
+																			  aggref->args)
+																	->expr));
+			const Oid chunk_relid = lsecond_int(linitial(decompress_chunk->custom_private));
+			if (!get_attnotnull(chunk_relid, var->varattno))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Check whether all the aggregates can be computed from the batch metadata
+ * alone: count(*) from the row count, and min() and max() from the min/max
+ * metadata of the orderby columns, or from the segmentby column values. This
+ * is possible only when there are no quals on the decompressed tuples. Returns
+ * the list of the compressed scan attnos of the columns holding the batch
+ * min/max, for every Agg output column, or NIL if the metadata can't be used.
+ */
+static List *
+get_segment_meta_attnos(Agg *agg, CustomScan *decompress_chunk, List *rtable)
+{
+	if (decompress_chunk->scan.plan.qual != NIL)
+	{
+		return NIL;
+	}
+
+	/* The time buckets require the decompressed time column. */
+	for (int i = 0; i < agg->numCols; i++)
+	{
+		Var *outer_var = makeVar(OUTER_VAR, agg->grpColIdx[i], InvalidOid, -1, InvalidOid, 0);
+		if (is_vectorizable_time_bucket_ref(decompress_chunk, (Expr *) outer_var))
+		{
+			return NIL;
+		}
+	}
+
+	ListCell *lc;
+	foreach (lc, agg->plan.targetlist)
+	{
+		TargetEntry *tlentry = lfirst_node(TargetEntry, lc);
+		if (!IsA(tlentry->expr, Aggref))
+		{
+			continue;
+		}
+
+		const VectorAggFunctionKind kind =
+			vector_agg_get_function_kind(castNode(Aggref, tlentry->expr));
+		if (kind != VAGG_COUNT_STAR && kind != VAGG_MIN && kind != VAGG_MAX)
+		{
+			return NIL;
+		}
+	}
+
+	List *result = NIL;
+	foreach (lc, agg->plan.targetlist)
+	{
+		TargetEntry *tlentry = lfirst_node(TargetEntry, lc);
+		if (!IsA(tlentry->expr, Aggref) || castNode(Aggref, tlentry->expr)->aggstar)
+		{
+			result = lappend_int(result, InvalidAttrNumber);
+			continue;
+		}
+
+		Aggref *aggref = castNode(Aggref, tlentry->expr);
+		Expr *arg = castNode(TargetEntry, linitial(aggref->args))->expr;
+		bool is_segmentby = false;
+		AttrNumber compressed_scan_attno = InvalidAttrNumber;
+		if (!is_decompressed_column_ref(decompress_chunk,
+										arg,
+										&is_segmentby,
+										&compressed_scan_attno))
+		{
+			return NIL;
+		}
+
+		if (!is_segmentby)
+		{
+			Var *outer_var = castNode(Var, arg);
+			TargetEntry *child_tlentry =
+				list_nth_node(TargetEntry,
+							  decompress_chunk->scan.plan.targetlist,
+							  AttrNumberGetAttrOffset(outer_var->varattno));
+			const AttrNumber chunk_attno = castNode(Var, child_tlentry->expr)->varattno;
+			compressed_scan_attno =
+				decompress_chunk_get_segment_meta_attno(decompress_chunk,
+														rtable,
+														chunk_attno,
+														vector_agg_get_function_kind(aggref) ==
+															VAGG_MIN);
+			if (compressed_scan_attno == InvalidAttrNumber)
+			{
+				return NIL;
+			}
+		}
+
+		result = lappend_int(result, compressed_scan_attno);
+	}
+
+	return result;
+}
+
+/*
+ * Build the VectorAgg plan node that replaces the given partial Agg on top of
+ * the DecompressChunk node.
+ */
+static Plan *
+vector_agg_plan_create(Agg *agg, CustomScan *decompress_chunk, List *rtable)
+{
+	CustomScan *custom = (CustomScan *) makeNode(CustomScan);
+	custom->custom_plans = list_make1(decompress_chunk);
+	custom->methods = &vector_agg_plan_methods;
+
+	/*
+	 * The output of the VectorAgg node is described by the custom scan
+	 * targetlist, which is the Agg targetlist with the aggregate arguments
+	 * referencing the uncompressed chunk columns. The plan targetlist just
+	 * references it with INDEX_VAR Vars.
+	 */
+	custom->custom_scan_tlist =
+		(List *) resolve_outer_special_vars_mutator((Node *) agg->plan.targetlist,
+													decompress_chunk->scan.plan.targetlist);
+
+	List *output_tlist = NIL;
+	ListCell *lc;
+	foreach (lc, custom->custom_scan_tlist)
+	{
+		TargetEntry *input_tlentry = lfirst_node(TargetEntry, lc);
+		Var *output_var = makeVar(INDEX_VAR,
+								  input_tlentry->resno,
+								  exprType((Node *) input_tlentry->expr),
+								  exprTypmod((Node *) input_tlentry->expr),
+								  exprCollation((Node *) input_tlentry->expr),
+								  /* varlevelsup = */ 0);
+		output_tlist = lappend(output_tlist,
+							   makeTargetEntry((Expr *) output_var,
+											   input_tlentry->resno,
+											   input_tlentry->resname,
+											   input_tlentry->resjunk));
+	}
+	custom->scan.plan.targetlist = output_tlist;
+
+	List *segment_meta_attnos = get_segment_meta_attnos(agg, decompress_chunk, rtable);
+	if (segment_meta_attnos != NIL)
+	{
+		custom->custom_private = list_make1(segment_meta_attnos);
+	}
+
+	custom->scan.plan.startup_cost = agg->plan.startup_cost;
+	custom->scan.plan.total_cost = agg->plan.total_cost;
+	custom->scan.plan.plan_rows = agg->plan.plan_rows;
+	custom->scan.plan.plan_width = agg->plan.plan_width;
+	custom->scan.plan.parallel_aware = false;
+	custom->scan.plan.parallel_safe = agg->plan.parallel_safe;
+	custom->scan.plan.plan_node_id = agg->plan.plan_node_id;
+	custom->scan.plan.initPlan = agg->plan.initPlan;
+	custom->scan.plan.extParam = bms_copy(agg->plan.extParam);
+	custom->scan.plan.allParam = bms_copy(agg->plan.allParam);
+	custom->scan.scanrelid = 0;
+
+	return &custom->scan.plan;
+}
+
+/*
+ * Walk the plan tree and replace the partial aggregation on top of the
+ * DecompressChunk nodes with the VectorAgg nodes where possible.
+ */
+Plan *
+try_insert_vector_agg_node(Plan *plan, List *rtable)
+{
+	if (plan == NULL)
+	{
+		return NULL;
+	}
+
+	plan->lefttree = try_insert_vector_agg_node(plan->lefttree, rtable);
+	plan->righttree = try_insert_vector_agg_node(plan->righttree, rtable);
+
+	List *children = NIL;
+	switch (nodeTag(plan))
+	{
+		case T_Append:
+			children = castNode(Append, plan)->appendplans;
+			break;
+		case T_MergeAppend:
+			children = castNode(MergeAppend, plan)->mergeplans;
+			break;
+		case T_CustomScan:
+			children = castNode(CustomScan, plan)->custom_plans;
+			break;
+		case T_SubqueryScan:
+			castNode(SubqueryScan, plan)->subplan =
+				try_insert_vector_agg_node(castNode(SubqueryScan, plan)->subplan, rtable);
+			break;
+#if PG14_LT
+		case T_ModifyTable:
+			children = castNode(ModifyTable, plan)->plans;
+			break;
+#endif
+		default:
+			break;
+	}
+
+	ListCell *lc;
+	foreach (lc, children)
+	{
+		lfirst(lc) = try_insert_vector_agg_node(lfirst(lc), rtable);
+	}
+
+	if (!IsA(plan, Agg) || plan->lefttree == NULL || !IsA(plan->lefttree, CustomScan))
+	{
+		return plan;
+	}
+
+	Agg *agg = castNode(Agg, plan);
+	CustomScan *custom = castNode(CustomScan, plan->lefttree);
+	if (strcmp(custom->methods->CustomName, "DecompressChunk") != 0)
+	{
+		return plan;
+	}
+
+	if (!can_vectorize_agg(agg, custom))
+	{
+		return plan;
+	}
+
+	return vector_agg_plan_create(agg, custom, rtable);
+}
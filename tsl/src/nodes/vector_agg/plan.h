@@ -0,0 +1,14 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#pragma once
+
+#include <postgres.h>
+#include <nodes/plannodes.h>
+
+extern void _vector_agg_init(void);
+
+extern Plan *try_insert_vector_agg_node(Plan *plan, List *rtable);
@@ -9,11 +9,14 @@
 #include <catalog/pg_aggregate.h>
 #include <catalog/pg_collation.h>
 #include <catalog/pg_type.h>
+#include <common/int.h>
 #include <fmgr.h>
+#include <libpq/pqformat.h>
 #include <parser/parse_agg.h>
 #include <parser/parse_coerce.h>
 #include <utils/builtins.h>
 #include <utils/datum.h>
+#include <utils/float.h>
 #include <utils/fmgroids.h>
 #include <utils/syscache.h>
 
@@ -65,6 +68,12 @@
  *
  * tsl_finalize_agg_sfunc is the state transition function
  * tsl_finalize_agg_ffunc is the finalize function
+ *
+ * For the common aggregates with a fixed-size, by-value transition state
+ * (count, and sum, min and max of integers and floats), the state is stored
+ * in the binary send format of its type. For those, the transition function
+ * has a fast path that decodes the partial and combines it inline, without
+ * calling the receive and combine functions through fmgr for each row.
  */
 
 /* State for calling the combine + deserialize functions of the inner aggregate */
@@ -82,7 +91,11 @@ typedef struct FACombineFnMeta
 	FunctionCallInfo deserialfn_fcinfo;
 	FunctionCallInfo internal_deserialfn_fcinfo;
 	FunctionCallInfo combfn_fcinfo;
-
+	/* Buffer for the receive function, reused between rows */
+	StringInfoData internal_deserialfn_buf;
+	/* Decode and combine the partials inline, see fast_path_combine() */
+	bool use_fast_path;
+	int16 translen;
 } FACombineFnMeta;
 
 /* State for calling the final function of the inner aggregate */
@@ -299,9 +312,10 @@ inner_agg_deserialize(FACombineFnMeta *combine_meta, bytea *volatile serialized_
 	else if (!serialized_isnull)
 	{
 		int32 typmod = -1;
-		StringInfo string = makeStringInfo();
+		StringInfo string = &combine_meta->internal_deserialfn_buf;
 		FunctionCallInfo internal_deserialfn_fcinfo = combine_meta->internal_deserialfn_fcinfo;
 
+		resetStringInfo(string);
 		appendBinaryStringInfo(string,
 							   VARDATA_ANY(serialized_partial),
 							   VARSIZE_ANY_EXHDR(serialized_partial));
@@ -317,6 +331,140 @@ inner_agg_deserialize(FACombineFnMeta *combine_meta, bytea *volatile serialized_
 	PG_RETURN_DATUM(deserialized);
 }
 
+/*
+ * Get the transition type of the combine functions that have a fast path, or
+ * InvalidOid if the combine function has none.
+ */
+static Oid
+fast_path_transtype(Oid combinefnoid)
+{
+	switch (combinefnoid)
+	{
+		case F_INT2LARGER:
+		case F_INT2SMALLER:
+			return INT2OID;
+		case F_INT4LARGER:
+		case F_INT4SMALLER:
+			return INT4OID;
+		case F_INT8PL:
+		case F_INT8LARGER:
+		case F_INT8SMALLER:
+			return INT8OID;
+		case F_FLOAT4PL:
+		case F_FLOAT4LARGER:
+		case F_FLOAT4SMALLER:
+			return FLOAT4OID;
+		case F_FLOAT8PL:
+		case F_FLOAT8LARGER:
+		case F_FLOAT8SMALLER:
+			return FLOAT8OID;
+		default:
+			return InvalidOid;
+	}
+}
+
+/*
+ * Decode a partial in the binary send format of its type, like the receive
+ * function of the type does, but without copying it to a separate buffer.
+ * The caller checks that the partial has the length of the type.
+ */
+static Datum
+fast_path_deserialize(const FACombineFnMeta *combine_meta, bytea *serialized_partial)
+{
+	StringInfoData buf = {
+		.data = VARDATA_ANY(serialized_partial),
+		.len = VARSIZE_ANY_EXHDR(serialized_partial),
+	};
+
+	Assert(buf.len == combine_meta->translen);
+
+	switch (combine_meta->transtype)
+	{
+		case INT2OID:
+			return Int16GetDatum((int16) pq_getmsgint(&buf, sizeof(int16)));
+		case INT4OID:
+			return Int32GetDatum((int32) pq_getmsgint(&buf, sizeof(int32)));
+		case INT8OID:
+			return Int64GetDatum(pq_getmsgint64(&buf));
+		case FLOAT4OID:
+			return Float4GetDatum(pq_getmsgfloat4(&buf));
+		case FLOAT8OID:
+			return Float8GetDatum(pq_getmsgfloat8(&buf));
+		default:
+			pg_unreachable();
+	}
+}
+
+/*
+ * Apply the combine function of the fast path inline. The functions are
+ * strict, so the caller handles the null values.
+ */
+static Datum
+fast_path_combine(Oid combinefnoid, Datum state, Datum value)
+{
+	switch (combinefnoid)
+	{
+		case F_INT2LARGER:
+			return Int16GetDatum(Max(DatumGetInt16(state), DatumGetInt16(value)));
+		case F_INT2SMALLER:
+			return Int16GetDatum(Min(DatumGetInt16(state), DatumGetInt16(value)));
+		case F_INT4LARGER:
+			return Int32GetDatum(Max(DatumGetInt32(state), DatumGetInt32(value)));
+		case F_INT4SMALLER:
+			return Int32GetDatum(Min(DatumGetInt32(state), DatumGetInt32(value)));
+		case F_INT8PL:
+		{
+			int64 result;
+
+			if (unlikely(pg_add_s64_overflow(DatumGetInt64(state), DatumGetInt64(value), &result)))
+				ereport(ERROR,
+						(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+						 errmsg("bigint out of range")));
+			return Int64GetDatum(result);
+		}
+		case F_INT8LARGER:
+			return Int64GetDatum(Max(DatumGetInt64(state), DatumGetInt64(value)));
+		case F_INT8SMALLER:
+			return Int64GetDatum(Min(DatumGetInt64(state), DatumGetInt64(value)));
+		case F_FLOAT4PL:
+			return Float4GetDatum(float4_pl(DatumGetFloat4(state), DatumGetFloat4(value)));
+		case F_FLOAT4LARGER:
+			return float4_gt(DatumGetFloat4(state), DatumGetFloat4(value)) ? state : value;
+		case F_FLOAT4SMALLER:
+			return float4_lt(DatumGetFloat4(state), DatumGetFloat4(value)) ? state : value;
+		case F_FLOAT8PL:
+			return Float8GetDatum(float8_pl(DatumGetFloat8(state), DatumGetFloat8(value)));
+		case F_FLOAT8LARGER:
+			return float8_gt(DatumGetFloat8(state), DatumGetFloat8(value)) ? state : value;
+		case F_FLOAT8SMALLER:
+			return float8_lt(DatumGetFloat8(state), DatumGetFloat8(value)) ? state : value;
+		default:
+			pg_unreachable();
+	}
+}
+
+/*
+ * Deserialize a partial, using the fast path if possible. A partial that does
+ * not have the length of the type goes through the receive function, which
+ * reports the error.
+ */
+static Datum
+finalize_agg_deserialize(FACombineFnMeta *combine_meta, bytea *serialized_partial,
+						 bool serialized_isnull, bool *deserialized_isnull)
+{
+	if (combine_meta->use_fast_path && !serialized_isnull &&
+		VARSIZE_ANY_EXHDR(serialized_partial) == (Size) combine_meta->translen)
+	{
+		*deserialized_isnull = false;
+		return fast_path_deserialize(combine_meta, serialized_partial);
+	}
+
+	return inner_agg_deserialize(combine_meta,
+								 serialized_partial,
+								 serialized_isnull,
+								 deserialized_isnull);
+}
+
 /* Convert a 2-dimensional array of schema, names to type OIDs */
 static Oid *
 get_input_types(ArrayType *input_types, size_t *number_types)
@@ -486,6 +634,24 @@ fa_perquery_state_init(FunctionCallInfo fcinfo)
 								 InvalidOid,
 								 NULL,
 								 NULL);
+		initStringInfo(&tstate->combine_meta.internal_deserialfn_buf);
+	}
+
+	/*
+	 * The combine functions of the fast path are strict and don't depend on
+	 * the collation, and the fast path only handles by-value states without
+	 * a deserialize function.
+	 */
+	tstate->combine_meta.use_fast_path = false;
+	if (!OidIsValid(tstate->combine_meta.deserialfnoid) &&
+		fast_path_transtype(tstate->combine_meta.combinefnoid) == tstate->combine_meta.transtype)
+	{
+		bool transbyval;
+
+		get_typlenbyval(tstate->combine_meta.transtype,
+						&tstate->combine_meta.translen,
+						&transbyval);
+		tstate->combine_meta.use_fast_path = transbyval && tstate->combine_meta.combinefn.fn_strict;
 	}
 	/* initialize finalfn specific state */
 	if (OidIsValid(tstate->final_meta.finalfnoid))
@@ -595,10 +761,10 @@ tsl_finalize_agg_sfunc(PG_FUNCTION_ARGS)
 		tstate = fa_transition_state_init(&fa_context, qstate, (AggState *) fcinfo->context);
 		/* initial trans_value = the partial state of the inner agg from first invocation */
 		tstate->per_group_state->trans_value =
-			inner_agg_deserialize(&tstate->per_query_state->combine_meta,
-								  inner_agg_serialized_state,
-								  inner_agg_serialized_state_isnull,
-								  &tstate->per_group_state->trans_value_isnull);
+			finalize_agg_deserialize(&tstate->per_query_state->combine_meta,
+									 inner_agg_serialized_state,
+									 inner_agg_serialized_state_isnull,
+									 &tstate->per_group_state->trans_value_isnull);
 		tstate->per_group_state->trans_value_initialized =
 			!(tstate->per_group_state->trans_value_isnull);
 	}
@@ -606,10 +772,12 @@ tsl_finalize_agg_sfunc(PG_FUNCTION_ARGS)
 	{
 		bool deser_isnull;
 		bool call_combine;
-		inner_agg_deserialized_state = inner_agg_deserialize(&tstate->per_query_state->combine_meta,
-															 inner_agg_serialized_state,
-															 inner_agg_serialized_state_isnull,
-															 &deser_isnull);
+		FACombineFnMeta *combine_meta = &tstate->per_query_state->combine_meta;
+
+		inner_agg_deserialized_state = finalize_agg_deserialize(combine_meta,
+																inner_agg_serialized_state,
+																inner_agg_serialized_state_isnull,
+																&deser_isnull);
 		/*
 		 * When we have a strict combine function, both arguments to combinefn
 		 * have to be non-null. It also means that if we initialized our
@@ -630,9 +798,14 @@ tsl_finalize_agg_sfunc(PG_FUNCTION_ARGS)
 			else if (deser_isnull || tstate->per_group_state->trans_value_isnull)
 				call_combine = false;
 		}
-		if (call_combine)
+		if (call_combine && combine_meta->use_fast_path)
+			tstate->per_group_state->trans_value =
+				fast_path_combine(combine_meta->combinefnoid,
+								  tstate->per_group_state->trans_value,
+								  inner_agg_deserialized_state);
+		else if (call_combine)
 			group_state_advance(tstate->per_group_state,
-								&tstate->per_query_state->combine_meta,
+								combine_meta,
 								inner_agg_deserialized_state,
 								deser_isnull);
 	}
@@ -30,6 +30,8 @@
 #include "nodes/data_node_dispatch.h"
 #include "nodes/data_node_copy.h"
 #include "nodes/gapfill/gapfill.h"
+#include "nodes/runtime_filter/plan.h"
+#include "nodes/vector_agg/plan.h"
 #include "planner.h"
 
 #include <math.h>
@@ -89,6 +91,7 @@ tsl_create_upper_paths_hook(PlannerInfo *root, UpperRelationKind stage, RelOptIn
 	switch (stage)
 	{
 		case UPPERREL_GROUP_AGG:
+			tsl_skip_scan_agg_paths_add(root, input_rel, output_rel);
 			if (input_reltype != TS_REL_HYPERTABLE_CHILD)
 				plan_add_gapfill(root, output_rel);
 			break;
@@ -436,3 +439,27 @@ tsl_create_distributed_insert_path(PlannerInfo *root, ModifyTablePath *mtpath, I
 
 	return data_node_dispatch_path_create(root, mtpath, hypertable_rti, subplan_index);
 }
+
+/*
+ * Run plan postprocessing transformations on the final plan, after
+ * set_plan_references() has finished.
+ */
+void
+tsl_postprocess_plan(PlannedStmt *stmt)
+{
+	if (ts_guc_enable_vectorized_aggregation)
+	{
+		stmt->planTree = try_insert_vector_agg_node(stmt->planTree, stmt->rtable);
+
+		ListCell *lc;
+		foreach (lc, stmt->subplans)
+		{
+			lfirst(lc) = try_insert_vector_agg_node((Plan *) lfirst(lc), stmt->rtable);
+		}
+	}
+
+	if (ts_guc_enable_runtime_filter)
+	{
+		try_insert_runtime_filters(stmt);
+	}
+}
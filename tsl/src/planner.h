@@ -17,6 +17,7 @@ void tsl_create_upper_paths_hook(PlannerInfo *, UpperRelationKind, RelOptInfo *,
 void tsl_set_rel_pathlist_query(PlannerInfo *, RelOptInfo *, Index, RangeTblEntry *, Hypertable *);
 void tsl_set_rel_pathlist_dml(PlannerInfo *, RelOptInfo *, Index, RangeTblEntry *, Hypertable *);
 void tsl_set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, Index rti, RangeTblEntry *rte);
+void tsl_postprocess_plan(PlannedStmt *stmt);
 Path *tsl_create_distributed_insert_path(PlannerInfo *root, ModifyTablePath *mtpath,
 										 Index hypertable_rti, int subplan_index);
 
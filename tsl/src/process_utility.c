@@ -91,6 +91,13 @@ tsl_process_rename_cmd(Oid relid, Cache *hcache, const RenameStmt *stmt)
 	}
 }
 
+void
+tsl_process_create_index(Hypertable *ht, const IndexStmt *stmt, Oid hypertable_indexrelid)
+{
+	if (TS_HYPERTABLE_HAS_COMPRESSION_TABLE(ht))
+		tsl_process_compress_table_create_index(ht, stmt, hypertable_indexrelid);
+}
+
 void
 tsl_ddl_command_end(EventTriggerData *command)
 {
@@ -16,5 +16,7 @@ extern void tsl_ddl_command_end(EventTriggerData *command);
 extern void tsl_sql_drop(List *dropped_objects);
 extern void tsl_process_altertable_cmd(Hypertable *ht, const AlterTableCmd *cmd);
 extern void tsl_process_rename_cmd(Oid relid, Cache *hcache, const RenameStmt *stmt);
+extern void tsl_process_create_index(Hypertable *ht, const IndexStmt *stmt,
+									 Oid hypertable_indexrelid);
 
 #endif /* TIMESCALEDB_TSL_PROCESS_UTILITY_H */
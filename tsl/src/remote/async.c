@@ -21,6 +21,7 @@
 #include "async.h"
 #include "connection.h"
 #include "utils.h"
+#include "wait_stats.h"
 
 /**
  * State machine for AsyncRequest:
@@ -710,6 +711,7 @@ wait_to_consume_data(AsyncRequestSet *set, TimestampTz end_time)
 	AsyncRequest *wait_req;
 	AsyncResponse *result;
 	long timeout_ms = -1L;
+	instr_time start;
 
 	Assert(list_length(set->requests) > 0);
 
@@ -745,7 +747,9 @@ wait_to_consume_data(AsyncRequestSet *set, TimestampTz end_time)
 	while (true)
 	{
 		wait_req = NULL;
+		ts_wait_stats_start(&start);
 		rc = WaitEventSetWait(we_set, timeout_ms, &event, 1, wait_event_info);
+		ts_wait_stats_end(TS_WAIT_REMOTE_RESPONSE, &start);
 
 		if (rc == 0)
 		{
@@ -173,8 +173,18 @@ typedef struct TSConnection
 	bool mcxt_cb_invoked;
 	WaitEventSet *wes;
 	int sockeventpos;
+	List *prepared_stmts; /* Statements kept prepared on the connection */
 } TSConnection;
 
+/* A statement kept prepared on a connection, see remote_connection_add_prepared_stmt */
+typedef struct CachedPreparedStmt
+{
+	char *sql;
+	char *name;
+} CachedPreparedStmt;
+
+#define MAX_CACHED_PREPARED_STMTS 64
+
 /*
  * List of all connections we create. Used to auto-free connections and/or
  * PGresults at transaction end.
@@ -848,6 +858,7 @@ remote_connection_create(PGconn *pg_conn, bool processing, const char *node_name
 	conn->results.prev = &conn->results;
 	conn->binary_copy = false;
 	conn->mcxt = mcxt;
+	conn->prepared_stmts = NIL;
 	conn->wes = CreateWaitEventSet(mcxt, 3);
 	AddWaitEventToSet(conn->wes, WL_LATCH_SET, PGINVALID_SOCKET, MyLatch, NULL);
 	AddWaitEventToSet(conn->wes, WL_EXIT_ON_PM_DEATH, PGINVALID_SOCKET, NULL, NULL);
@@ -2005,6 +2016,125 @@ remote_connection_ping(const char *node_name, TimestampTz endtime)
 	return success;
 }
 
+/*
+ * Check which of the given data nodes accept connections. Unlike
+ * remote_connection_ping(), the connections are opened in parallel, so that
+ * checking many nodes takes as long as checking the slowest one. A node that
+ * has not accepted the connection by the end time is considered down.
+ */
+void
+remote_connection_ping_nodes(List *server_oids, TimestampTz endtime, bool *alive)
+{
+	int num_nodes = list_length(server_oids);
+	PGconn **conns = palloc0(sizeof(PGconn *) * num_nodes);
+	PostgresPollingStatusType *status = palloc(sizeof(PostgresPollingStatusType) * num_nodes);
+	WaitEvent *events = palloc(sizeof(WaitEvent) * (num_nodes + 1));
+	int num_pending = 0;
+	ListCell *lc;
+	int i = 0;
+
+	foreach (lc, server_oids)
+	{
+		ForeignServer *server = GetForeignServer(lfirst_oid(lc));
+		List *connection_options = remote_connection_prepare_auth_options(server, GetUserId());
+		const char **keywords;
+		const char **values;
+
+		alive[i] = false;
+		status[i] = PGRES_POLLING_FAILED;
+		setup_full_connection_options(connection_options, &keywords, &values);
+		conns[i] = PQconnectStartParams(keywords, values, 0 /* Do not expand dbname param */);
+
+		/* Cast to (char **) to silence warning with MSVC compiler */
+		pfree((char **) keywords);
+		pfree((char **) values);
+
+		if (NULL != conns[i] && PQstatus(conns[i]) != CONNECTION_BAD)
+		{
+			status[i] = PGRES_POLLING_WRITING;
+			num_pending++;
+		}
+
+		i++;
+	}
+
+	while (num_pending > 0)
+	{
+		WaitEventSet *wes;
+		int nevents;
+
+		/*
+		 * The sockets can change across calls to PQconnectPoll(), so the wait
+		 * event set is created anew in every iteration, like in
+		 * remote_connection_open().
+		 */
+		wes = CreateWaitEventSet(CurrentMemoryContext, num_pending + 2);
+		AddWaitEventToSet(wes, WL_LATCH_SET, PGINVALID_SOCKET, MyLatch, NULL);
+		AddWaitEventToSet(wes, WL_EXIT_ON_PM_DEATH, PGINVALID_SOCKET, NULL, NULL);
+
+		for (i = 0; i < num_nodes; i++)
+		{
+			int io_flag;
+
+			if (status[i] == PGRES_POLLING_OK || status[i] == PGRES_POLLING_FAILED)
+				continue;
+
+			if (status[i] == PGRES_POLLING_READING)
+				io_flag = WL_SOCKET_READABLE;
+#ifdef WIN32
+			else if (PQstatus(conns[i]) == CONNECTION_STARTED)
+				io_flag = WL_SOCKET_CONNECTED;
+#endif
+			else
+				io_flag = WL_SOCKET_WRITEABLE;
+
+			AddWaitEventToSet(wes, io_flag, PQsocket(conns[i]), NULL, &status[i]);
+		}
+
+		nevents = WaitEventSetWait(wes,
+								   timeout_diff_ms(endtime),
+								   events,
+								   num_pending + 1,
+								   PG_WAIT_EXTENSION);
+		FreeWaitEventSet(wes);
+
+		/* Timeout */
+		if (nevents == 0)
+			break;
+
+		for (int j = 0; j < nevents; j++)
+		{
+			PostgresPollingStatusType *node_status = events[j].user_data;
+
+			if (events[j].events & WL_LATCH_SET)
+			{
+				ResetLatch(MyLatch);
+				CHECK_FOR_INTERRUPTS();
+				continue;
+			}
+
+			i = node_status - status;
+			status[i] = PQconnectPoll(conns[i]);
+
+			if (status[i] == PGRES_POLLING_OK || status[i] == PGRES_POLLING_FAILED)
+			{
+				alive[i] = (PQstatus(conns[i]) == CONNECTION_OK);
+				num_pending--;
+			}
+		}
+	}
+
+	for (i = 0; i < num_nodes; i++)
+	{
+		if (NULL != conns[i])
+			PQfinish(conns[i]);
+	}
+
+	pfree(conns);
+	pfree(status);
+	pfree(events);
+}
+
 void
 remote_connection_close(TSConnection *conn)
 {
@@ -2052,6 +2182,58 @@ remote_connection_get_prep_stmt_number()
 	return ++prep_stmt_number;
 }
 
+/*
+ * Get the name of the statement kept prepared on the connection for the given
+ * SQL text, or NULL if there is none.
+ */
+const char *
+remote_connection_find_prepared_stmt(const TSConnection *conn, const char *sql)
+{
+	ListCell *lc;
+
+	foreach (lc, conn->prepared_stmts)
+	{
+		CachedPreparedStmt *stmt = lfirst(lc);
+
+		if (strcmp(stmt->sql, sql) == 0)
+			return stmt->name;
+	}
+
+	return NULL;
+}
+
+/*
+ * Get a name for a new statement to keep prepared on the connection, or NULL
+ * if the connection already keeps the maximum number of statements. The
+ * statement must be added with remote_connection_add_prepared_stmt once it is
+ * prepared.
+ */
+char *
+remote_connection_prepared_stmt_name(const TSConnection *conn)
+{
+	if (list_length(conn->prepared_stmts) >= MAX_CACHED_PREPARED_STMTS)
+		return NULL;
+
+	return psprintf("ts_cached_prep_%u", remote_connection_get_prep_stmt_number());
+}
+
+/*
+ * Remember that a statement is prepared on the connection. Prepared
+ * statements are not transactional, so they are kept for the lifetime of the
+ * connection.
+ */
+void
+remote_connection_add_prepared_stmt(TSConnection *conn, const char *sql, const char *name)
+{
+	MemoryContext old = MemoryContextSwitchTo(conn->mcxt);
+	CachedPreparedStmt *stmt = palloc(sizeof(CachedPreparedStmt));
+
+	stmt->sql = pstrdup(sql);
+	stmt->name = pstrdup(name);
+	conn->prepared_stmts = lappend(conn->prepared_stmts, stmt);
+	MemoryContextSwitchTo(old);
+}
+
 #define MAX_CONN_WAIT_TIMEOUT_MS 60000
 
 /*
@@ -2273,6 +2455,22 @@ remote_connection_set_single_row_mode(TSConnection *conn)
 	return PQsetSingleRowMode(conn->pg_conn);
 }
 
+/*
+ * Return the rows of the current query in results of up to chunk_size rows,
+ * so that the rows are neither materialized in one result nor allocated as
+ * one result each. Versions of libpq before PostgreSQL 17 do not support
+ * chunked rows, so they fall back to single-row mode.
+ */
+bool
+remote_connection_set_chunked_rows_mode(TSConnection *conn, int chunk_size)
+{
+#ifdef LIBPQ_HAS_CHUNK_MODE
+	return PQsetChunkedRowsMode(conn->pg_conn, chunk_size);
+#else
+	return PQsetSingleRowMode(conn->pg_conn);
+#endif
+}
+
 static bool
 send_binary_copy_header(const TSConnection *conn, TSConnectionError *err)
 {
@@ -70,6 +70,7 @@ extern void remote_connection_xact_transition_begin(TSConnection *conn);
 extern void remote_connection_xact_transition_end(TSConnection *conn);
 extern bool remote_connection_xact_is_transitioning(const TSConnection *conn);
 extern bool remote_connection_ping(const char *node_name, TimestampTz endtime);
+extern void remote_connection_ping_nodes(List *server_oids, TimestampTz endtime, bool *alive);
 extern void remote_connection_close(TSConnection *conn);
 extern PGresult *remote_connection_get_result(const TSConnection *conn, TimestampTz endtime);
 extern PGresult *remote_connection_exec_timeout(TSConnection *conn, const char *cmd,
@@ -89,6 +90,11 @@ extern bool remote_connection_valid_node_option(const char *keyword);
 extern unsigned int remote_connection_get_cursor_number(void);
 extern void remote_connection_reset_cursor_number(void);
 extern unsigned int remote_connection_get_prep_stmt_number(void);
+extern const char *remote_connection_find_prepared_stmt(const TSConnection *conn,
+														const char *sql);
+extern char *remote_connection_prepared_stmt_name(const TSConnection *conn);
+extern void remote_connection_add_prepared_stmt(TSConnection *conn, const char *sql,
+												const char *name);
 extern bool remote_connection_configure(TSConnection *conn);
 extern bool remote_connection_check_extension(TSConnection *conn);
 extern void remote_validate_extension_version(TSConnection *conn, const char *data_node_version);
@@ -119,6 +125,7 @@ extern TSConnectionStatus remote_connection_get_status(const TSConnection *conn)
 extern bool remote_connection_configure_if_changed(TSConnection *conn);
 extern const char *remote_connection_node_name(const TSConnection *conn);
 extern bool remote_connection_set_single_row_mode(TSConnection *conn);
+extern bool remote_connection_set_chunked_rows_mode(TSConnection *conn, int chunk_size);
 
 /* Functions operating on PGresult objects */
 extern void remote_result_cmd_ok(PGresult *res);
@@ -12,6 +12,7 @@
 #include <utils/syscache.h>
 #include <utils/guc.h>
 #include <utils/acl.h>
+#include <utils/timestamp.h>
 #include <fmgr.h>
 #include <funcapi.h>
 #include <miscadmin.h>
@@ -21,6 +22,7 @@
 #include <cache.h>
 #include <compat/compat.h>
 #include "connection_cache.h"
+#include "guc.h"
 
 static Cache *connection_cache = NULL;
 static bool ignore_connection_invalidation = false;
@@ -32,6 +34,7 @@ typedef struct ConnectionCacheEntry
 	uint32 foreign_server_hashvalue; /* Hash of server OID for cache invalidation */
 	uint32 role_hashvalue;			 /* Hash of role OID for cache invalidation */
 	bool invalidated;
+	TimestampTz last_used; /* Last time the connection was fetched from the cache */
 } ConnectionCacheEntry;
 
 static void
@@ -173,6 +176,7 @@ connection_cache_create_entry(Cache *cache, CacheQuery *query)
 		GetSysCacheHashValue1(FOREIGNSERVEROID, ObjectIdGetDatum(id->server_id));
 	entry->role_hashvalue = GetSysCacheHashValue1(AUTHOID, ObjectIdGetDatum(id->user_id));
 	entry->invalidated = false;
+	entry->last_used = GetCurrentTimestamp();
 
 	return entry;
 }
@@ -203,6 +207,8 @@ connection_cache_update_entry(Cache *cache, CacheQuery *query)
 	if (status == CONN_IDLE)
 		remote_connection_configure_if_changed(entry->conn);
 
+	entry->last_used = GetCurrentTimestamp();
+
 	return entry;
 }
 
@@ -496,11 +502,55 @@ remote_connection_cache_show(PG_FUNCTION_ARGS)
 	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
 }
 
+/*
+ * Close the connections that have been idle for longer than
+ * timescaledb.data_node_connection_idle_timeout. Connections that are part of
+ * a remote transaction or are still processing are kept.
+ */
+static void
+connection_cache_close_idle_connections(void)
+{
+	HASH_SEQ_STATUS scan;
+	ConnectionCacheEntry *entry;
+	TimestampTz now;
+
+	if (ts_guc_data_node_connection_idle_timeout <= 0 || connection_cache == NULL)
+		return;
+
+	now = GetCurrentTimestamp();
+	hash_seq_init(&scan, connection_cache->htab);
+
+	while ((entry = hash_seq_search(&scan)) != NULL)
+	{
+		if (entry->conn == NULL || remote_connection_xact_depth_get(entry->conn) > 0 ||
+			remote_connection_get_status(entry->conn) != CONN_IDLE)
+			continue;
+
+		/* Removing the current entry does not disturb the sequential scan */
+		if (TimestampDifferenceExceeds(entry->last_used,
+									   now,
+									   ts_guc_data_node_connection_idle_timeout))
+			ts_cache_remove(connection_cache, &entry->id);
+	}
+}
+
 static void
 connection_cache_xact_callback(XactEvent event, void *arg)
 {
 	/* Reset ignore_connection_invalidation to default value */
 	remote_connection_cache_invalidation_ignore(false);
+
+	switch (event)
+	{
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_PARALLEL_ABORT:
+			connection_cache_close_idle_connections();
+			break;
+		default:
+			break;
+	}
 }
 
 void
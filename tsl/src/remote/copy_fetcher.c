@@ -496,6 +496,10 @@ copy_fetcher_complete(CopyFetcher *fetcher)
 
 				Datum *values = &fetcher->batch_values[tupdesc_natts * row];
 				bool *nulls = &fetcher->batch_nulls[tupdesc_natts * row];
+				instr_time conversion_start;
+
+				data_fetcher_conversion_start(&fetcher->state, &conversion_start);
+
 				for (int i = 0; i < tupdesc_natts; i++)
 				{
 					nulls[i] = true;
@@ -535,14 +539,9 @@ copy_fetcher_complete(CopyFetcher *fetcher)
 						continue;
 					}
 
-					StringInfoData att_data = { 0 };
-					att_data.data = copy_data_read_bytes(&copy_data, att_bytes);
-					att_data.len = att_bytes;
+					char *att_data = copy_data_read_bytes(&copy_data, att_bytes);
 
-					values[att] = ReceiveFunctionCall(&attconv->conv_funcs[att],
-													  &att_data,
-													  attconv->ioparams[att],
-													  attconv->typmods[att]);
+					values[att] = data_format_receive_binary(attconv, att, att_data, att_bytes);
 					nulls[att] = false;
 				}
 
@@ -551,6 +550,8 @@ copy_fetcher_complete(CopyFetcher *fetcher)
 				 * left.
 				 */
 				Assert(copy_data.cursor = copy_data.len);
+
+				data_fetcher_conversion_end(&fetcher->state, conversion_start, copy_data.len);
 			}
 			MemoryContextSwitchTo(fetcher->state.batch_mctx);
 			PQfreemem(copy_data.data);
@@ -597,14 +598,21 @@ static int
 copy_fetcher_fetch_data(DataFetcher *df)
 {
 	CopyFetcher *fetcher = cast_fetcher(CopyFetcher, df);
+	instr_time start;
+	int numrows;
 
 	if (fetcher->state.eof)
 		return 0;
 
+	INSTR_TIME_SET_CURRENT(start);
+
 	if (!fetcher->state.open)
 		copy_fetcher_send_fetch_request(df);
 
-	return copy_fetcher_complete(fetcher);
+	numrows = copy_fetcher_complete(fetcher);
+	data_fetcher_track_batch(df, numrows, start);
+
+	return numrows;
 }
 
 static void
@@ -13,6 +13,7 @@
 #include <lib/stringinfo.h>
 #include <utils/rel.h>
 #include <utils/guc.h>
+#include <utils/memutils.h>
 
 #include "utils.h"
 #include "async.h"
@@ -37,15 +38,31 @@
  * node cannot execute in parallel.
  *
  * https://www.postgresql.org/docs/current/when-can-parallel-query-be-used.html
+ *
+ * With pipelined fetching, the cursor requests the next batch as soon as the
+ * current one arrives, so that the data node produces the next batch while
+ * the executor consumes the current one. Since the connection is busy while a
+ * request is in flight, a cursor that needs the connection first reads the
+ * response of the in-flight request of another cursor into that cursor's
+ * second buffer ("parks" it), where it stays until that cursor needs it.
  */
 typedef struct CursorFetcher
 {
 	DataFetcher state;
 	unsigned int id;
 	char fetch_stmt[64];	  /* cursor fetch statement */
+	int req_fetch_size;		  /* fetch size of the in-flight fetch request */
 	AsyncRequest *create_req; /* a request to create cursor */
+	AsyncResponseResult *parked_response; /* response read ahead on behalf of this
+										   * cursor */
 } CursorFetcher;
 
+/*
+ * Cursors with a fetch request in flight. There is at most one per
+ * connection.
+ */
+static List *inflight_cursors = NIL;
+
 static void cursor_fetcher_send_fetch_request(DataFetcher *df);
 static int cursor_fetcher_fetch_data(DataFetcher *df);
 static void cursor_fetcher_set_fetch_size(DataFetcher *df, int fetch_size);
@@ -65,6 +82,88 @@ static DataFetcherFuncs funcs = {
 	.store_next_tuple = cursor_fetcher_store_next_tuple,
 };
 
+static void
+cursor_set_inflight(CursorFetcher *cursor, bool inflight)
+{
+	MemoryContext oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+
+	if (inflight)
+		inflight_cursors = lappend(inflight_cursors, cursor);
+	else
+		inflight_cursors = list_delete_ptr(inflight_cursors, cursor);
+
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * Forget the cursor when the memory it lives in goes away, e.g., on abort.
+ * The callback is allocated separately from the cursor, since the cursor can
+ * be freed before the memory context is reset, and only compares pointers.
+ */
+static void
+cursor_cleanup_callback(void *arg)
+{
+	cursor_set_inflight((CursorFetcher *) arg, false);
+}
+
+/*
+ * Read the response of an in-flight fetch request of another cursor on the
+ * connection, so that the connection can take a new request.
+ */
+static void
+cursor_park_inflight_request(TSConnection *conn)
+{
+	CursorFetcher *cursor = NULL;
+	MemoryContext oldcontext;
+	ListCell *lc;
+
+	foreach (lc, inflight_cursors)
+	{
+		CursorFetcher *other = lfirst(lc);
+
+		if (other->state.conn == conn)
+		{
+			cursor = other;
+			break;
+		}
+	}
+
+	if (cursor == NULL)
+		return;
+
+	Assert(cursor->state.data_req != NULL);
+	Assert(cursor->parked_response == NULL);
+
+	oldcontext = MemoryContextSwitchTo(cursor->state.req_mctx);
+	cursor->parked_response = async_request_wait_any_result(cursor->state.data_req);
+	MemoryContextSwitchTo(oldcontext);
+
+	pfree(cursor->state.data_req);
+	cursor->state.data_req = NULL;
+	cursor_set_inflight(cursor, false);
+}
+
+/*
+ * Throw away a fetch request that is in flight, or its parked response.
+ */
+static void
+cursor_discard_fetch_request(CursorFetcher *cursor)
+{
+	if (cursor->parked_response != NULL)
+	{
+		async_response_result_close(cursor->parked_response);
+		cursor->parked_response = NULL;
+	}
+
+	if (cursor->state.data_req != NULL)
+	{
+		async_request_discard_response(cursor->state.data_req);
+		pfree(cursor->state.data_req);
+		cursor->state.data_req = NULL;
+		cursor_set_inflight(cursor, false);
+	}
+}
+
 static void
 cursor_create_req(CursorFetcher *cursor)
 {
@@ -74,6 +173,7 @@ cursor_create_req(CursorFetcher *cursor)
 
 	initStringInfo(&buf);
 	appendStringInfo(&buf, "DECLARE c%u CURSOR FOR\n%s", cursor->id, cursor->state.stmt);
+	cursor_park_inflight_request(cursor->state.conn);
 	oldcontext = MemoryContextSwitchTo(cursor->state.req_mctx);
 
 	PG_TRY();
@@ -135,6 +235,7 @@ cursor_fetcher_create_for_scan(TSConnection *conn, const char *stmt, StmtParams
 							   TupleFactory *tf)
 {
 	CursorFetcher *fetcher = palloc0(sizeof(CursorFetcher));
+	MemoryContextCallback *cleanup_cb = palloc(sizeof(MemoryContextCallback));
 
 	data_fetcher_init(&fetcher->state, conn, stmt, params, tf);
 
@@ -142,6 +243,9 @@ cursor_fetcher_create_for_scan(TSConnection *conn, const char *stmt, StmtParams
 	/* Assign a unique ID for my cursor */
 	fetcher->id = remote_connection_get_cursor_number();
 	fetcher->create_req = NULL;
+	cleanup_cb->func = cursor_cleanup_callback;
+	cleanup_cb->arg = fetcher;
+	MemoryContextRegisterResetCallback(CurrentMemoryContext, cleanup_cb);
 	/* send a request to DECLARE cursor  */
 	cursor_create_req(fetcher);
 	fetcher->state.funcs = &funcs;
@@ -183,12 +287,14 @@ cursor_fetcher_send_fetch_request(DataFetcher *df)
 
 	Assert(cursor->state.open);
 
-	if (cursor->state.data_req != NULL)
+	if (cursor->state.data_req != NULL || cursor->parked_response != NULL)
 		ereport(ERROR,
 				(errcode(ERRCODE_INVALID_CURSOR_STATE),
 				 errmsg("invalid cursor state"),
 				 errdetail("Cannot fetch new data while previous request is ongoing.")));
 
+	cursor_park_inflight_request(cursor->state.conn);
+
 	PG_TRY();
 	{
 		TSConnection *conn = cursor->state.conn;
@@ -204,6 +310,8 @@ cursor_fetcher_send_fetch_request(DataFetcher *df)
 
 		Assert(NULL != req);
 		cursor->state.data_req = req;
+		cursor->req_fetch_size = cursor->state.fetch_size;
+		cursor_set_inflight(cursor, true);
 	}
 	PG_CATCH();
 	{
@@ -225,11 +333,15 @@ cursor_fetcher_fetch_data_complete(CursorFetcher *cursor)
 {
 	AsyncResponseResult *volatile response = NULL;
 	MemoryContext oldcontext;
+	instr_time wait_start;
+	instr_time wait_end;
+	instr_time conversion_start;
+	Size nbytes = 0;
 	int numrows = 0;
 	int format = 0;
 
 	Assert(cursor != NULL);
-	Assert(cursor->state.data_req != NULL);
+	Assert(cursor->state.data_req != NULL || cursor->parked_response != NULL);
 
 	Assert(cursor->state.open);
 	data_fetcher_validate(&cursor->state);
@@ -248,7 +360,17 @@ cursor_fetcher_fetch_data_complete(CursorFetcher *cursor)
 
 		oldcontext = MemoryContextSwitchTo(cursor->state.req_mctx);
 
-		response = async_request_wait_any_result(cursor->state.data_req);
+		INSTR_TIME_SET_CURRENT(wait_start);
+
+		if (cursor->parked_response != NULL)
+		{
+			response = cursor->parked_response;
+			cursor->parked_response = NULL;
+		}
+		else
+			response = async_request_wait_any_result(cursor->state.data_req);
+
+		INSTR_TIME_SET_CURRENT(wait_end);
 		Assert(NULL != response);
 
 		res = async_response_result_get_pg_result(response);
@@ -275,9 +397,15 @@ cursor_fetcher_fetch_data_complete(CursorFetcher *cursor)
 		/* Allow creating tuples in alternative memory context if user has set
 		 * it explicitly, otherwise same as batch_mctx */
 		MemoryContextSwitchTo(cursor->state.tuple_mctx);
+		data_fetcher_conversion_start(&cursor->state, &conversion_start);
 
 		for (i = 0; i < numrows; i++)
+		{
 			cursor->state.tuples[i] = tuplefactory_make_tuple(cursor->state.tf, res, i, format);
+			nbytes += cursor->state.tuples[i]->t_len;
+		}
+
+		data_fetcher_conversion_end(&cursor->state, conversion_start, nbytes);
 
 		tuplefactory_reset_mctx(cursor->state.tf);
 		MemoryContextSwitchTo(cursor->state.batch_mctx);
@@ -291,10 +419,14 @@ cursor_fetcher_fetch_data_complete(CursorFetcher *cursor)
 			cursor->state.batch_count++;
 
 		/* Must be EOF if we didn't get as many tuples as we asked for. */
-		cursor->state.eof = (numrows < cursor->state.fetch_size);
+		cursor->state.eof = (numrows < cursor->req_fetch_size);
 
-		pfree(cursor->state.data_req);
-		cursor->state.data_req = NULL;
+		if (NULL != cursor->state.data_req)
+		{
+			pfree(cursor->state.data_req);
+			cursor->state.data_req = NULL;
+			cursor_set_inflight(cursor, false);
+		}
 
 		async_response_result_close(response);
 		response = NULL;
@@ -305,6 +437,7 @@ cursor_fetcher_fetch_data_complete(CursorFetcher *cursor)
 		{
 			pfree(cursor->state.data_req);
 			cursor->state.data_req = NULL;
+			cursor_set_inflight(cursor, false);
 		}
 
 		if (NULL != response)
@@ -316,6 +449,18 @@ cursor_fetcher_fetch_data_complete(CursorFetcher *cursor)
 
 	MemoryContextSwitchTo(oldcontext);
 
+	if (ts_guc_enable_pipelined_fetching && !cursor->state.eof)
+	{
+		int fetch_size =
+			data_fetcher_adapt_fetch_size(&cursor->state, numrows, nbytes, wait_start, wait_end);
+
+		if (fetch_size != cursor->state.fetch_size)
+			cursor_fetcher_set_fetch_size(&cursor->state, fetch_size);
+
+		/* Have the data node work on the next batch while this one is consumed */
+		cursor_fetcher_send_fetch_request(&cursor->state);
+	}
+
 	return numrows;
 }
 
@@ -323,10 +468,14 @@ static int
 cursor_fetcher_fetch_data(DataFetcher *df)
 {
 	CursorFetcher *cursor = cast_fetcher(CursorFetcher, df);
+	instr_time start;
+	int numrows;
 
 	if (cursor->state.eof)
 		return 0;
 
+	INSTR_TIME_SET_CURRENT(start);
+
 	if (!cursor->state.open)
 	{
 		if (cursor->create_req == NULL)
@@ -337,10 +486,13 @@ cursor_fetcher_fetch_data(DataFetcher *df)
 		cursor_fetcher_wait_until_open(df);
 	}
 
-	if (cursor->state.data_req == NULL)
+	if (cursor->state.data_req == NULL && cursor->parked_response == NULL)
 		cursor_fetcher_send_fetch_request(df);
 
-	return cursor_fetcher_fetch_data_complete(cursor);
+	numrows = cursor_fetcher_fetch_data_complete(cursor);
+	data_fetcher_track_batch(df, numrows, start);
+
+	return numrows;
 }
 
 static void
@@ -360,6 +512,7 @@ remote_cursor_exec_cmd(CursorFetcher *cursor, const char *sql)
 	 * We don't use a PG_TRY block here, so be careful not to throw error
 	 * without releasing the PGresult.
 	 */
+	cursor_park_inflight_request(cursor->state.conn);
 	req = async_request_send(cursor->state.conn, sql);
 	Assert(NULL != req);
 	async_request_wait_ok_command(req);
@@ -379,8 +532,7 @@ cursor_fetcher_rewind(DataFetcher *df)
 	{
 		char sql[64];
 
-		if (!cursor->state.eof && cursor->state.data_req != NULL)
-			async_request_discard_response(cursor->state.data_req);
+		cursor_discard_fetch_request(cursor);
 
 		/* We are beyond the first fetch, so need to rewind the remote end */
 		snprintf(sql, sizeof(sql), "MOVE BACKWARD ALL IN c%u", cursor->id);
@@ -406,8 +558,7 @@ cursor_fetcher_close(DataFetcher *df)
 		return;
 	}
 
-	if (!cursor->state.eof && cursor->state.data_req != NULL)
-		async_request_discard_response(cursor->state.data_req);
+	cursor_discard_fetch_request(cursor);
 
 	snprintf(sql, sizeof(sql), "CLOSE c%u", cursor->id);
 	cursor->state.open = false;
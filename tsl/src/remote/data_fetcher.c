@@ -4,6 +4,9 @@
  * LICENSE-TIMESCALE for a copy of the license.
  */
 #include <postgres.h>
+#include <miscadmin.h>
+#include <utils/hsearch.h>
+#include <utils/memutils.h>
 
 #include "data_fetcher.h"
 #include "cursor_fetcher.h"
@@ -12,6 +15,24 @@
 #include "errors.h"
 
 #define DEFAULT_FETCH_SIZE 100
+#define MAX_ADAPTIVE_FETCH_SIZE 100000
+
+/* Weight of a new sample in the moving averages of the data node stats */
+#define NODE_STATS_SAMPLE_WEIGHT 0.2
+
+/*
+ * Observed times of the scans on a data node, kept for the lifetime of the
+ * backend and used to calibrate the cost estimates of later scans.
+ */
+typedef struct DataNodeScanStats
+{
+	NameData node_name; /* hash key */
+	double startup_ms;	/* time until the first batch of a scan arrives */
+	double row_ms;		/* time per row of the following batches */
+	bool has_row_ms;
+} DataNodeScanStats;
+
+static HTAB *node_stats = NULL;
 
 void
 data_fetcher_init(DataFetcher *df, TSConnection *conn, const char *stmt, StmtParams *params,
@@ -95,6 +116,55 @@ data_fetcher_set_fetch_size(DataFetcher *df, int fetch_size)
 	df->fetch_size = fetch_size;
 }
 
+/*
+ * Adapt the fetch size to the row width and the network round trip observed
+ * for the batch that just arrived, and return the fetch size to use for the
+ * next request.
+ *
+ * If the executor waited longer for the batch than it took to consume the
+ * previous one, fetching is bound by the round trip to the data node, so we
+ * double the fetch size to amortize the round trip over more rows. The batch
+ * is capped at work_mem, using the observed row width, so that wide rows do
+ * not overrun memory.
+ */
+int
+data_fetcher_adapt_fetch_size(DataFetcher *df, int numrows, Size nbytes, instr_time wait_start,
+							  instr_time wait_end)
+{
+	int fetch_size = df->fetch_size;
+	Size row_width;
+	Size max_rows;
+
+	/* A short batch is the last one, so there is nothing to adapt */
+	if (!ts_guc_enable_pipelined_fetching || numrows == 0 || numrows < df->fetch_size)
+	{
+		df->batch_ready = wait_end;
+		return fetch_size;
+	}
+
+	if (!INSTR_TIME_IS_ZERO(df->batch_ready))
+	{
+		instr_time consumed = wait_start;
+		instr_time waited = wait_end;
+
+		INSTR_TIME_SUBTRACT(consumed, df->batch_ready);
+		INSTR_TIME_SUBTRACT(waited, wait_start);
+
+		if (INSTR_TIME_GET_MICROSEC(waited) > INSTR_TIME_GET_MICROSEC(consumed))
+			fetch_size = Min(fetch_size * 2, MAX_ADAPTIVE_FETCH_SIZE);
+	}
+
+	row_width = Max(nbytes / numrows, 1);
+	max_rows = Max((work_mem * (Size) 1024) / row_width, 1);
+
+	if ((Size) fetch_size > max_rows)
+		fetch_size = (int) max_rows;
+
+	df->batch_ready = wait_end;
+
+	return fetch_size;
+}
+
 void
 data_fetcher_set_tuple_mctx(DataFetcher *df, MemoryContext mctx)
 {
@@ -102,6 +172,140 @@ data_fetcher_set_tuple_mctx(DataFetcher *df, MemoryContext mctx)
 	df->tuple_mctx = mctx;
 }
 
+/*
+ * Check if the fetcher can return the next tuple without waiting for the
+ * data node, i.e., it has buffered tuples, reached the end of the result, or
+ * the response to its request has arrived.
+ *
+ * Note that a COPY response is not busy once the data starts streaming, so
+ * the COPY fetcher is considered ready as soon as the data node has started
+ * to return data.
+ */
+bool
+data_fetcher_data_ready(DataFetcher *df)
+{
+	PGconn *pg_conn;
+
+	if (df->next_tuple_idx < df->num_tuples || df->eof)
+		return true;
+
+	pg_conn = remote_connection_get_pg_conn(df->conn);
+
+	/* Let the fetch report connection errors */
+	if (PQconsumeInput(pg_conn) == 0)
+		return true;
+
+	return PQisBusy(pg_conn) == 0;
+}
+
+static DataNodeScanStats *
+node_stats_lookup(const char *node_name, bool create)
+{
+	NameData key;
+	bool found;
+
+	if (node_stats == NULL)
+	{
+		HASHCTL ctl = {
+			.keysize = sizeof(NameData),
+			.entrysize = sizeof(DataNodeScanStats),
+			.hcxt = TopMemoryContext,
+		};
+
+		if (!create)
+			return NULL;
+
+		node_stats = hash_create("data node scan stats",
+								 16,
+								 &ctl,
+								 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+
+	namestrcpy(&key, node_name);
+
+	return hash_search(node_stats, &key, create ? HASH_ENTER : HASH_FIND, &found);
+}
+
+static double
+node_stats_average(double avg, double sample)
+{
+	return avg * (1.0 - NODE_STATS_SAMPLE_WEIGHT) + sample * NODE_STATS_SAMPLE_WEIGHT;
+}
+
+/*
+ * Record the time the executor waited for a batch of the data node, where
+ * start is the time the fetch started, in the fetcher stats and the data node
+ * stats. For the data node, the first batch of a scan measures the startup
+ * time of the scan, which includes planning the query on the data node, and
+ * the following batches measure the time per row.
+ */
+void
+data_fetcher_track_batch(DataFetcher *df, int numrows, instr_time start)
+{
+	DataNodeScanStats *stats;
+	instr_time elapsed;
+	double ms;
+
+	if (!df->stats.enabled && !ts_guc_enable_remote_cost_calibration)
+		return;
+
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+	ms = INSTR_TIME_GET_MILLISEC(elapsed);
+
+	if (df->stats.enabled)
+	{
+		if (df->stats.batches == 0)
+			df->stats.first_batch_time = elapsed;
+
+		INSTR_TIME_ADD(df->stats.fetch_time, elapsed);
+		df->stats.batches++;
+	}
+
+	if (!ts_guc_enable_remote_cost_calibration)
+		return;
+
+	stats = node_stats_lookup(remote_connection_node_name(df->conn), true);
+
+	if (!df->startup_tracked)
+	{
+		/* A new entry is zeroed except for the key */
+		if (stats->startup_ms == 0)
+			stats->startup_ms = ms;
+		else
+			stats->startup_ms = node_stats_average(stats->startup_ms, ms);
+
+		df->startup_tracked = true;
+	}
+	else if (numrows > 0)
+	{
+		if (!stats->has_row_ms)
+			stats->row_ms = ms / numrows;
+		else
+			stats->row_ms = node_stats_average(stats->row_ms, ms / numrows);
+
+		stats->has_row_ms = true;
+	}
+}
+
+/*
+ * Get the observed startup time and time per row of the scans on a data
+ * node. Returns false if there are not enough observations yet.
+ */
+bool
+data_fetcher_get_node_stats(const char *node_name, double *startup_ms, double *row_ms)
+{
+	DataNodeScanStats *stats = node_stats_lookup(node_name, false);
+
+	if (stats == NULL || !stats->has_row_ms || stats->row_ms <= 0)
+		return false;
+
+	*startup_ms = stats->startup_ms;
+	*row_ms = stats->row_ms;
+
+	return true;
+}
+
 void
 data_fetcher_reset(DataFetcher *df)
 {
@@ -110,6 +314,8 @@ data_fetcher_reset(DataFetcher *df)
 	df->next_tuple_idx = 0;
 	df->batch_count = 0;
 	df->eof = false;
+	df->startup_tracked = false;
+	INSTR_TIME_SET_ZERO(df->batch_ready);
 	MemoryContextReset(df->req_mctx);
 	MemoryContextReset(df->batch_mctx);
 }
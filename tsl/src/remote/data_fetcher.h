@@ -10,6 +10,7 @@
 #include <access/tupdesc.h>
 #include <utils/relcache.h>
 #include <nodes/execnodes.h>
+#include <portability/instr_time.h>
 
 #include "connection.h"
 #include "stmt_params.h"
@@ -18,6 +19,17 @@
 
 typedef struct DataFetcher DataFetcher;
 
+/* Statistics of a fetcher shown by EXPLAIN ANALYZE, kept across rescans */
+typedef struct DataFetcherStats
+{
+	bool enabled;
+	int64 batches;
+	int64 bytes;				/* size of the received rows */
+	instr_time first_batch_time; /* time to fetch the first batch */
+	instr_time fetch_time;		/* time to fetch all batches */
+	instr_time conversion_time; /* part of the fetch time spent converting rows */
+} DataFetcherStats;
+
 typedef struct DataFetcherFuncs
 {
 	void (*close)(DataFetcher *data_fetcher);
@@ -69,11 +81,15 @@ typedef struct DataFetcher
 	int next_tuple_idx; /* index of next one to return */
 	int fetch_size;		/* # of tuples to fetch */
 	int batch_count;	/* how many batches (parts of result set) we've done */
+	instr_time batch_ready; /* when the current batch became available */
+	bool startup_tracked;	/* whether the startup time of the scan is tracked */
 
 	bool open;
 	bool eof;
 
 	AsyncRequest *data_req; /* a request to fetch data */
+
+	DataFetcherStats stats;
 } DataFetcher;
 
 void data_fetcher_free(DataFetcher *df);
@@ -84,11 +100,38 @@ extern void data_fetcher_init(DataFetcher *df, TSConnection *conn, const char *s
 extern void data_fetcher_store_tuple(DataFetcher *df, int row, TupleTableSlot *slot);
 extern void data_fetcher_store_next_tuple(DataFetcher *df, TupleTableSlot *slot);
 extern void data_fetcher_set_fetch_size(DataFetcher *df, int fetch_size);
+extern int data_fetcher_adapt_fetch_size(DataFetcher *df, int numrows, Size nbytes,
+										 instr_time wait_start, instr_time wait_end);
 extern void data_fetcher_set_tuple_mctx(DataFetcher *df, MemoryContext mctx);
+extern bool data_fetcher_data_ready(DataFetcher *df);
+extern void data_fetcher_track_batch(DataFetcher *df, int numrows, instr_time start);
+extern bool data_fetcher_get_node_stats(const char *node_name, double *startup_ms,
+										double *row_ms);
 extern void data_fetcher_validate(DataFetcher *df);
 extern void data_fetcher_reset(DataFetcher *df);
 extern void data_fetcher_rescan(DataFetcher *df, StmtParams *params);
 
+static inline void
+data_fetcher_conversion_start(const DataFetcher *df, instr_time *start)
+{
+	if (df->stats.enabled)
+		INSTR_TIME_SET_CURRENT(*start);
+}
+
+/* Account for the conversion of received rows with the given size */
+static inline void
+data_fetcher_conversion_end(DataFetcher *df, instr_time start, Size nbytes)
+{
+	if (df->stats.enabled)
+	{
+		instr_time end;
+
+		INSTR_TIME_SET_CURRENT(end);
+		INSTR_TIME_ACCUM_DIFF(df->stats.conversion_time, end, start);
+		df->stats.bytes += nbytes;
+	}
+}
+
 #ifdef USE_ASSERT_CHECKING
 static inline DataFetcher *
 assert_df_type(DataFetcherType type, DataFetcher *df)
@@ -19,11 +19,15 @@ typedef struct AttConvInMetadata
 	FmgrInfo *conv_funcs; /* in functions for converting */
 	Oid *ioparams;
 	int32 *typmods;
-	bool binary; /* if we use function with binary input */
+	Oid *direct_types; /* type to decode without the receive function, or
+						* InvalidOid */
+	bool binary;	   /* if we use function with binary input */
 } AttConvInMetadata;
 
 extern AttConvInMetadata *data_format_create_att_conv_in_metadata(TupleDesc tupdesc,
 																  bool force_text);
+extern Datum data_format_receive_binary(const AttConvInMetadata *attconv, int att, char *data,
+										int len);
 
 extern Oid data_format_get_type_output_func(Oid type, bool *is_binary, bool force_text);
 extern Oid data_format_get_type_input_func(Oid type, bool *is_binary, bool force_text,
@@ -167,11 +167,33 @@ ts_dist_cmd_invoke_on_data_nodes(const char *sql, List *data_nodes, bool transac
 	return ts_dist_cmd_params_invoke_on_data_nodes(sql, NULL, data_nodes, transactional);
 }
 
+/*
+ * Set the search path on the data nodes, or reset it to pg_catalog if the
+ * search path is NULL.
+ *
+ * As a workaround for non-transactional execution, the same connections are
+ * expected to be used by the commands that follow, so the caller must ignore
+ * connection cache invalidations until the search path is reset.
+ */
+void
+ts_dist_cmd_set_search_path_on_data_nodes(const char *search_path, List *node_names,
+										  bool transactional)
+{
+	if (search_path != NULL)
+	{
+		char *set_request = psprintf("SET search_path = %s, pg_catalog", search_path);
+
+		ts_dist_cmd_run_on_data_nodes(set_request, node_names, transactional);
+		pfree(set_request);
+	}
+	else
+		ts_dist_cmd_run_on_data_nodes("SET search_path = pg_catalog", node_names, transactional);
+}
+
 DistCmdResult *
 ts_dist_cmd_invoke_on_data_nodes_using_search_path(const char *sql, const char *search_path,
 												   List *node_names, bool transactional)
 {
-	DistCmdResult *set_result;
 	DistCmdResult *results;
 	bool set_search_path = search_path != NULL;
 
@@ -184,28 +206,14 @@ ts_dist_cmd_invoke_on_data_nodes_using_search_path(const char *sql, const char *
 	remote_connection_cache_invalidation_ignore(true);
 
 	if (set_search_path)
-	{
-		char *set_request = psprintf("SET search_path = %s, pg_catalog", search_path);
-
-		set_result = ts_dist_cmd_invoke_on_data_nodes(set_request, node_names, transactional);
-		if (set_result)
-			ts_dist_cmd_close_response(set_result);
-
-		pfree(set_request);
-	}
+		ts_dist_cmd_set_search_path_on_data_nodes(search_path, node_names, transactional);
 
 	DEBUG_WAITPOINT("dist_cmd_using_search_path_2");
 
 	results = ts_dist_cmd_invoke_on_data_nodes(sql, node_names, transactional);
 
 	if (set_search_path)
-	{
-		set_result = ts_dist_cmd_invoke_on_data_nodes("SET search_path = pg_catalog",
-													  node_names,
-													  transactional);
-		if (set_result)
-			ts_dist_cmd_close_response(set_result);
-	}
+		ts_dist_cmd_set_search_path_on_data_nodes(NULL, node_names, transactional);
 
 	remote_connection_cache_invalidation_ignore(false);
 	return results;
@@ -216,34 +224,19 @@ ts_dist_multi_cmds_invoke_on_data_nodes_using_search_path(List *cmd_descriptors,
 														  const char *search_path, List *node_names,
 														  bool transactional)
 {
-	DistCmdResult *set_result;
 	DistCmdResult *results;
 	bool set_search_path = search_path != NULL;
 
 	remote_connection_cache_invalidation_ignore(true);
 
 	if (set_search_path)
-	{
-		char *set_request = psprintf("SET search_path = %s, pg_catalog", search_path);
-
-		set_result = ts_dist_cmd_invoke_on_data_nodes(set_request, node_names, transactional);
-		if (set_result)
-			ts_dist_cmd_close_response(set_result);
-
-		pfree(set_request);
-	}
+		ts_dist_cmd_set_search_path_on_data_nodes(search_path, node_names, transactional);
 
 	results =
 		ts_dist_multi_cmds_params_invoke_on_data_nodes(cmd_descriptors, node_names, transactional);
 
 	if (set_search_path)
-	{
-		set_result = ts_dist_cmd_invoke_on_data_nodes("SET search_path = pg_catalog",
-													  node_names,
-													  transactional);
-		if (set_result)
-			ts_dist_cmd_close_response(set_result);
-	}
+		ts_dist_cmd_set_search_path_on_data_nodes(NULL, node_names, transactional);
 
 	remote_connection_cache_invalidation_ignore(false);
 	return results;
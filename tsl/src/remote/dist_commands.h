@@ -32,6 +32,8 @@ extern DistCmdResult *ts_dist_cmd_invoke_on_data_nodes_using_search_path(const c
 																		 const char *search_path,
 																		 List *node_names,
 																		 bool transactional);
+extern void ts_dist_cmd_set_search_path_on_data_nodes(const char *search_path, List *node_names,
+													  bool transactional);
 extern DistCmdResult *ts_dist_cmd_invoke_on_all_data_nodes(const char *sql);
 extern DistCmdResult *ts_dist_cmd_invoke_func_call_on_all_data_nodes(FunctionCallInfo fcinfo);
 extern DistCmdResult *ts_dist_cmd_invoke_func_call_on_data_nodes(FunctionCallInfo fcinfo,
@@ -70,10 +70,18 @@ typedef struct DataNodeConnection
 	size_t bytes_in_message;
 	size_t rows_in_message;
 	size_t rows_sent;
+	size_t bytes_unflushed; /* bytes queued since the last complete flush */
 	size_t outbuf_size;
 	char *outbuf;
 } DataNodeConnection;
 
+/*
+ * Amount of data that can be queued for a data node that does not keep up,
+ * before we wait for it. Until then, we keep parsing and sending rows to the
+ * other data nodes, and drain the queue whenever we send to the node again.
+ */
+#define MAX_UNFLUSHED_BYTES_PER_DATA_NODE (8 * 1024 * 1024)
+
 /* This contains information about connections currently in use by the copy as well as how to create
  * and end the copy command.
  */
@@ -288,6 +296,7 @@ get_copy_connection_to_data_node(RemoteCopyContext *context, Oid data_node_oid)
 		entry->bytes_in_message = 0;
 		entry->rows_in_message = 0;
 		entry->rows_sent = 0;
+		entry->bytes_unflushed = 0;
 #ifdef TS_DEBUG
 		/* Use a small output buffer in tests to make sure we test growing the
 		 * buffer */
@@ -339,25 +348,12 @@ get_copy_connection_to_data_node(RemoteCopyContext *context, Oid data_node_oid)
 }
 
 /*
- * Flush the outgoing buffers on the active data node connections.
+ * Flush the outgoing buffers on the given data node connections, waiting
+ * until all of them are written out.
  */
 static void
-flush_active_connections(CopyConnectionState *state)
+flush_connections(List *to_flush)
 {
-	/*
-	 * The connections that we are going to flush on the current iteration.
-	 */
-	List *to_flush = NIL;
-	HASH_SEQ_STATUS status;
-	DataNodeConnection *dnc;
-
-	hash_seq_init(&status, state->data_node_connections);
-
-	for (dnc = hash_seq_search(&status); dnc != NULL; dnc = hash_seq_search(&status))
-	{
-		to_flush = lappend(to_flush, dnc->connection);
-	}
-
 	/*
 	 * The connections that were busy on the current iteration and that we have
 	 * to wait for.
@@ -370,7 +366,8 @@ flush_active_connections(CopyConnectionState *state)
 		ListCell *to_flush_cell;
 		foreach (to_flush_cell, to_flush)
 		{
-			TSConnection *conn = lfirst(to_flush_cell);
+			DataNodeConnection *dnc = lfirst(to_flush_cell);
+			TSConnection *conn = dnc->connection;
 			PGconn *pg_conn = remote_connection_get_pg_conn(conn);
 
 			if (remote_connection_get_status(conn) != CONN_COPY_IN)
@@ -400,12 +397,13 @@ flush_active_connections(CopyConnectionState *state)
 			else if (res == 0)
 			{
 				/* Flushed. */
+				dnc->bytes_unflushed = 0;
 			}
 			else
 			{
 				/* Busy. */
 				Assert(res == 1);
-				busy_connections = lappend(busy_connections, conn);
+				busy_connections = lappend(busy_connections, dnc);
 				continue;
 			}
 
@@ -438,8 +436,8 @@ flush_active_connections(CopyConnectionState *state)
 		ListCell *busy_cell;
 		foreach (busy_cell, busy_connections)
 		{
-			TSConnection *conn = lfirst(busy_cell);
-			PGconn *pg_conn = remote_connection_get_pg_conn(conn);
+			DataNodeConnection *dnc = lfirst(busy_cell);
+			PGconn *pg_conn = remote_connection_get_pg_conn(dnc->connection);
 			(void) AddWaitEventToSet(set,
 									 /* events = */ WL_SOCKET_WRITEABLE,
 									 PQsocket(pg_conn),
@@ -477,6 +475,26 @@ flush_active_connections(CopyConnectionState *state)
 	}
 }
 
+/*
+ * Flush the outgoing buffers on the active data node connections.
+ */
+static void
+flush_active_connections(CopyConnectionState *state)
+{
+	List *to_flush = NIL;
+	HASH_SEQ_STATUS status;
+	DataNodeConnection *dnc;
+
+	hash_seq_init(&status, state->data_node_connections);
+
+	for (dnc = hash_seq_search(&status); dnc != NULL; dnc = hash_seq_search(&status))
+	{
+		to_flush = lappend(to_flush, dnc);
+	}
+
+	flush_connections(to_flush);
+}
+
 /*
  * Flush all active data node connections and end COPY simultaneously, instead
  * of doing this one-by-one in remote_connection_end_copy(). Implies that there
@@ -1346,10 +1364,16 @@ write_copy_data(RemoteCopyContext *context, DataNodeConnection *dnc, const char
 		}
 
 		/* Clear output buffer and flush */
+		dnc->bytes_unflushed += dnc->bytes_in_message;
 		dnc->bytes_in_message = 0;
 		dnc->rows_in_message = 0;
 
-		return PQflush(conn);
+		ret = PQflush(conn);
+
+		if (ret == 0)
+			dnc->bytes_unflushed = 0;
+
+		return ret;
 	}
 
 	return 0;
@@ -1389,6 +1413,7 @@ write_copy_data_end(RemoteCopyContext *context)
 				Assert(ret == 1);
 			}
 
+			dnc->bytes_unflushed += dnc->bytes_in_message;
 			ret = PQflush(conn);
 
 			switch (ret)
@@ -1399,17 +1424,21 @@ write_copy_data_end(RemoteCopyContext *context)
 					break;
 				case 0:
 					/* flushed */
+					dnc->bytes_unflushed = 0;
 					break;
 				default:
 					Assert(ret == 1);
 					/* partial flush */
-					num_blocked_nodes++;
 					break;
 			}
 
 			dnc->bytes_in_message = 0;
 			dnc->rows_in_message = 0;
 		}
+
+		/* Also count data nodes that still have data queued from earlier rows */
+		if (dnc->bytes_unflushed > 0)
+			num_blocked_nodes++;
 	}
 
 	if (num_blocked_nodes > 0)
@@ -1421,7 +1450,7 @@ send_row_to_data_nodes(RemoteCopyContext *context, List *data_nodes, StringInfo
 					   bool endmsg)
 {
 	ListCell *lc;
-	int num_blocked_nodes = 0;
+	List *blocked_nodes = NIL;
 
 	foreach (lc, data_nodes)
 	{
@@ -1437,8 +1466,13 @@ send_row_to_data_nodes(RemoteCopyContext *context, List *data_nodes, StringInfo
 			remote_connection_elog(dnc->connection, ERROR);
 		else if (ret == 1)
 		{
-			/* Could not flush completely */
-			num_blocked_nodes++;
+			/*
+			 * Could not flush completely. The rest is written out on the
+			 * next flush, so only wait for the data node if it has fallen
+			 * too far behind.
+			 */
+			if (dnc->bytes_unflushed > MAX_UNFLUSHED_BYTES_PER_DATA_NODE)
+				blocked_nodes = lappend(blocked_nodes, dnc);
 		}
 		else
 		{
@@ -1446,8 +1480,11 @@ send_row_to_data_nodes(RemoteCopyContext *context, List *data_nodes, StringInfo
 		}
 	}
 
-	if (num_blocked_nodes > 0)
-		flush_active_connections(&context->connection_state);
+	if (blocked_nodes != NIL)
+	{
+		flush_connections(blocked_nodes);
+		list_free(blocked_nodes);
+	}
 }
 
 uint64
@@ -1022,6 +1022,19 @@ dist_ddl_execute(bool transactional)
 
 	search_path = GetConfigOption("search_path", false, false);
 
+	/*
+	 * Set the search path on the data nodes once for all the commands, instead
+	 * of setting and resetting it around each command, to save two round trips
+	 * to the data nodes per command. Each command is sent to all the data
+	 * nodes before waiting for any of them.
+	 */
+	remote_connection_cache_invalidation_ignore(true);
+
+	if (search_path != NULL)
+		ts_dist_cmd_set_search_path_on_data_nodes(search_path,
+												  dist_ddl_state.data_node_list,
+												  transactional);
+
 	foreach (lc, dist_ddl_state.remote_commands)
 	{
 		void *command = lfirst(lc);
@@ -1035,11 +1048,9 @@ dist_ddl_execute(bool transactional)
 				/* Execute single SQL command on each data node from the list */
 				const char *sql = strVal(command);
 
-				result = ts_dist_cmd_invoke_on_data_nodes_using_search_path(sql,
-																			search_path,
-																			dist_ddl_state
-																				.data_node_list,
-																			transactional);
+				result = ts_dist_cmd_invoke_on_data_nodes(sql,
+														  dist_ddl_state.data_node_list,
+														  transactional);
 				break;
 			}
 			case T_List:
@@ -1048,12 +1059,10 @@ dist_ddl_execute(bool transactional)
 				List *cmd_descriptors = command;
 				Assert(list_length(dist_ddl_state.data_node_list) == list_length(cmd_descriptors));
 
-				result =
-					ts_dist_multi_cmds_invoke_on_data_nodes_using_search_path(cmd_descriptors,
-																			  search_path,
-																			  dist_ddl_state
-																				  .data_node_list,
-																			  transactional);
+				result = ts_dist_multi_cmds_params_invoke_on_data_nodes(cmd_descriptors,
+																		dist_ddl_state
+																			.data_node_list,
+																		transactional);
 				break;
 			}
 			default:
@@ -1068,6 +1077,12 @@ dist_ddl_execute(bool transactional)
 		}
 	}
 
+	if (search_path != NULL)
+		ts_dist_cmd_set_search_path_on_data_nodes(NULL,
+												  dist_ddl_state.data_node_list,
+												  transactional);
+
+	remote_connection_cache_invalidation_ignore(false);
 	dist_ddl_state_reset();
 }
 
@@ -5,6 +5,7 @@
  */
 #include <postgres.h>
 #include <access/htup_details.h>
+#include <access/xact.h>
 #include <access/xlog.h>
 #include <storage/lmgr.h>
 #include <utils/hsearch.h>
@@ -307,16 +308,23 @@ dist_txn_send_prepare_transaction()
 	AsyncRequestSet *ars = async_request_set_create();
 	AsyncResponse *error_response = NULL;
 	AsyncResponse *res;
+	List *remote_txns = NIL;
+	ListCell *lc;
 
 	eventcallback(DTXN_EVENT_PRE_PREPARE);
 
-	/* send a prepare transaction to all connections */
 	remote_txn_store_foreach(store, remote_txn)
+		remote_txns = lappend(remote_txns, remote_txn);
+
+	/* write the persistent records of all connections in one go */
+	remote_txn_write_persistent_records(remote_txns);
+
+	/* send a prepare transaction to all connections */
+	foreach (lc, remote_txns)
 	{
 		AsyncRequest *req;
 
-		remote_txn_write_persistent_record(remote_txn);
-		req = remote_txn_async_send_prepare_transaction(remote_txn);
+		req = remote_txn_async_send_prepare_transaction(lfirst(lc));
 		async_request_set_add(ars, req);
 	}
 
@@ -514,8 +522,18 @@ dist_txn_xact_callback(XactEvent event, void *arg)
 	 * such a case since we send a COMMIT at "XACT_EVENT_PRE_COMMIT" event time to the DN, we might
 	 * end up with a COMMITTED DN but an aborted AN! Hence this optimization is not possible to
 	 * guarantee transactional semantics.
+	 *
+	 * 3) if ts_guc_enable_single_data_node_1pc is enabled, don't use it for a transaction that
+	 * involves one DN and has no transaction ID on the AN. Without an AN transaction ID there is no
+	 * AN data to lose, so the DN alone decides the outcome. This is common for small distributed
+	 * INSERTs into existing chunks, which then commit with a single round trip.
 	 */
 	use_2pc = (ts_guc_enable_2pc && strncmp(xactReadOnly, "on", sizeof("on")) != 0);
+
+	if (use_2pc && ts_guc_enable_single_data_node_1pc &&
+		hash_get_num_entries(store->hashtable) == 1 &&
+		!TransactionIdIsValid(GetTopTransactionIdIfAny()))
+		use_2pc = false;
 #ifdef TS_DEBUG
 	ereport(DEBUG3, (errmsg("use 2PC: %s", use_2pc ? "true" : "false")));
 #endif
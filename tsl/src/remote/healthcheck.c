@@ -6,13 +6,128 @@
 #include <postgres.h>
 #include <funcapi.h>
 #include <utils/builtins.h>
+#include <utils/hsearch.h>
 #include <utils/lsyscache.h>
+#include <utils/memutils.h>
 #include <utils/syscache.h>
+#include <utils/timestamp.h>
 
 #include "healthcheck.h"
+#include "connection.h"
 #include "data_node.h"
 #include "dist_commands.h"
 #include "dist_util.h"
+#include "guc.h"
+
+/* How long a health check waits for a data node to accept a connection */
+#define DATA_NODE_HEALTH_CHECK_TIMEOUT_MS 1000
+
+/*
+ * The last known health of a data node. The health is kept per backend and
+ * rechecked when it is older than the health check interval.
+ */
+typedef struct DataNodeHealth
+{
+	Oid server_oid; /* hash key */
+	TimestampTz checked_at;
+	bool healthy;
+} DataNodeHealth;
+
+static HTAB *data_node_health = NULL;
+
+static DataNodeHealth *
+data_node_health_lookup(Oid server_oid, bool create)
+{
+	bool found;
+
+	if (data_node_health == NULL)
+	{
+		HASHCTL ctl = {
+			.keysize = sizeof(Oid),
+			.entrysize = sizeof(DataNodeHealth),
+			.hcxt = TopMemoryContext,
+		};
+
+		if (!create)
+			return NULL;
+
+		data_node_health = hash_create("data node health",
+									   16,
+									   &ctl,
+									   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+
+	return hash_search(data_node_health, &server_oid, create ? HASH_ENTER : HASH_FIND, &found);
+}
+
+/*
+ * Check the health of the given data nodes, unless they have been checked
+ * within the health check interval. The data nodes are checked in parallel
+ * and a data node that does not accept a connection within the timeout is
+ * considered unhealthy, so that a dead data node delays planning by at most
+ * the timeout instead of failing the query when it connects.
+ */
+void
+remote_health_check_data_nodes(List *server_oids)
+{
+	TimestampTz now = GetCurrentTimestamp();
+	List *stale_oids = NIL;
+	ListCell *lc;
+	bool *alive;
+	int i = 0;
+
+	if (ts_guc_data_node_health_check_interval <= 0)
+		return;
+
+	foreach (lc, server_oids)
+	{
+		DataNodeHealth *health = data_node_health_lookup(lfirst_oid(lc), false);
+
+		if (health == NULL ||
+			TimestampDifferenceExceeds(health->checked_at,
+									   now,
+									   ts_guc_data_node_health_check_interval))
+			stale_oids = lappend_oid(stale_oids, lfirst_oid(lc));
+	}
+
+	if (stale_oids == NIL)
+		return;
+
+	alive = palloc(sizeof(bool) * list_length(stale_oids));
+	remote_connection_ping_nodes(stale_oids,
+								 TimestampTzPlusMilliseconds(now,
+															 DATA_NODE_HEALTH_CHECK_TIMEOUT_MS),
+								 alive);
+	now = GetCurrentTimestamp();
+
+	foreach (lc, stale_oids)
+	{
+		DataNodeHealth *health = data_node_health_lookup(lfirst_oid(lc), true);
+
+		health->checked_at = now;
+		health->healthy = alive[i++];
+	}
+
+	pfree(alive);
+	list_free(stale_oids);
+}
+
+/*
+ * Get the last known health of a data node. A data node that has not been
+ * checked is considered healthy.
+ */
+bool
+remote_data_node_is_healthy(Oid server_oid)
+{
+	DataNodeHealth *health;
+
+	if (ts_guc_data_node_health_check_interval <= 0)
+		return true;
+
+	health = data_node_health_lookup(server_oid, false);
+
+	return health == NULL || health->healthy;
+}
 
 /*
  * Functions and data structures for printing a health check result.
@@ -4,10 +4,14 @@
  * LICENSE-TIMESCALE for a copy of the license.
  */
 #ifndef TIMESCALEDB_TSL_REMOTE_HEALTHCHECK_H
+#define TIMESCALEDB_TSL_REMOTE_HEALTHCHECK_H
 
 #include <postgres.h>
 #include <fmgr.h>
+#include <nodes/pg_list.h>
 
 extern Datum ts_dist_health_check(PG_FUNCTION_ARGS);
+extern void remote_health_check_data_nodes(List *server_oids);
+extern bool remote_data_node_is_healthy(Oid server_oid);
 
 #endif /* TIMESCALEDB_TSL_REMOTE_HEALTHCHECK_H */
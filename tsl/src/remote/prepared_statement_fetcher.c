@@ -9,16 +9,49 @@
 #include "prepared_statement_fetcher.h"
 #include "tuplefactory.h"
 #include "async.h"
+#include "guc.h"
 
 typedef struct PreparedStatementFetcher
 {
 	DataFetcher state;
 
+	/* Name of the prepared statement, empty for the unnamed statement */
+	const char *stmt_name;
+
 	/* Data for virtual tuples of the current retrieved batch. */
 	Datum *batch_values;
 	bool *batch_nulls;
+
+	/* Result with rows that did not fit in the previous batch */
+	PGresult *pending_res;
+	int pending_row;
 } PreparedStatementFetcher;
 
+static Size
+result_row_size(const PGresult *res, int row)
+{
+	Size size = 0;
+
+	for (int i = 0; i < PQnfields(res); i++)
+		size += PQgetlength(res, row, i);
+
+	return size;
+}
+
+/*
+ * Check if a result holds some of the rows of the query, either in
+ * single-row mode or in chunked rows mode.
+ */
+static inline bool
+is_partial_rows_result(const PGresult *res)
+{
+#ifdef LIBPQ_HAS_CHUNK_MODE
+	if (PQresultStatus(res) == PGRES_TUPLES_CHUNK)
+		return true;
+#endif
+	return PQresultStatus(res) == PGRES_SINGLE_TUPLE;
+}
+
 static void prepared_statement_fetcher_send_fetch_request(DataFetcher *df);
 static void prepared_statement_fetcher_reset(PreparedStatementFetcher *fetcher);
 static int prepared_statement_fetcher_fetch_data(DataFetcher *df);
@@ -60,6 +93,13 @@ prepared_statement_fetcher_reset(PreparedStatementFetcher *fetcher)
 	/* Drain the connection, reporting any errors. */
 	TSConnection *conn = fetcher->state.conn;
 	PGresult *res;
+
+	if (fetcher->pending_res != NULL)
+	{
+		PQclear(fetcher->pending_res);
+		fetcher->pending_res = NULL;
+	}
+
 	while ((res = remote_connection_get_result(conn, TS_NO_TIMEOUT)) != NULL)
 	{
 		char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
@@ -112,7 +152,7 @@ prepared_statement_fetcher_send_fetch_request(DataFetcher *df)
 
 	PGconn *pg_conn = remote_connection_get_pg_conn(conn);
 	int ret = PQsendQueryPrepared(pg_conn,
-								  /* stmtName = */ "",
+								  fetcher->stmt_name,
 								  stmt_params_num_params(fetcher->state.stmt_params),
 								  stmt_params_values(fetcher->state.stmt_params),
 								  stmt_params_lengths(fetcher->state.stmt_params),
@@ -127,7 +167,7 @@ prepared_statement_fetcher_send_fetch_request(DataFetcher *df)
 		remote_connection_error_elog(&err, ERROR);
 	}
 
-	if (!remote_connection_set_single_row_mode(conn))
+	if (!remote_connection_set_chunked_rows_mode(conn, fetcher->state.fetch_size))
 		ereport(ERROR,
 				(errcode(ERRCODE_CONNECTION_FAILURE),
 				 errmsg("could not set single-row mode on connection to \"%s\"",
@@ -177,50 +217,77 @@ prepared_statement_fetcher_complete(PreparedStatementFetcher *fetcher)
 
 	PG_TRY();
 	{
-		int i;
-
-		for (i = 0; i < fetcher->state.fetch_size; i++)
+		int i = 0;
+
+		/*
+		 * A result can hold a single row or a chunk of rows. The rows of a
+		 * chunk that do not fit in this batch, because the fetch size changed
+		 * after the query was sent, are kept for the next batch.
+		 */
+		while (i < fetcher->state.fetch_size)
 		{
-			PGresult *res;
-
-			res = remote_connection_get_result(conn, TS_NO_TIMEOUT);
+			PGresult *res = fetcher->pending_res;
 
-			if (!(PQresultStatus(res) == PGRES_SINGLE_TUPLE ||
-				  PQresultStatus(res) == PGRES_TUPLES_OK))
+			if (res == NULL)
 			{
-				remote_result_elog(res, ERROR);
-			}
+				res = remote_connection_get_result(conn, TS_NO_TIMEOUT);
 
-			if (PQresultStatus(res) == PGRES_TUPLES_OK)
-			{
-				/* fetched all the data */
-				Assert(PQntuples(res) == 0);
-				PQclear(res);
+				if (!(is_partial_rows_result(res) || PQresultStatus(res) == PGRES_TUPLES_OK))
+				{
+					remote_result_elog(res, ERROR);
+				}
+
+				if (PQresultStatus(res) == PGRES_TUPLES_OK)
+				{
+					/* fetched all the data */
+					Assert(PQntuples(res) == 0);
+					PQclear(res);
+
+					fetcher->state.eof = true;
+					break;
+				}
 
-				fetcher->state.eof = true;
-				break;
+				fetcher->pending_res = res;
+				fetcher->pending_row = 0;
 			}
 
-			Assert(PQresultStatus(res) == PGRES_SINGLE_TUPLE);
 			/* Allow creating tuples in alternative memory context if user has set
 			 * it explicitly, otherwise same as batch_mctx */
 			MemoryContextSwitchTo(fetcher->state.tuple_mctx);
 
-			PG_USED_FOR_ASSERTS_ONLY ItemPointer ctid =
-				tuplefactory_make_virtual_tuple(fetcher->state.tf,
-												res,
-												0,
-												PQbinaryTuples(res),
-												&fetcher->batch_values[i * nattrs],
-												&fetcher->batch_nulls[i * nattrs]);
-
-			/*
-			 * This fetcher uses virtual tuples that can't hold ctid, so if we're
-			 * receiving a ctid here, we're doing something wrong.
-			 */
-			Assert(ctid == NULL);
-
-			PQclear(res);
+			for (; fetcher->pending_row < PQntuples(res) && i < fetcher->state.fetch_size;
+				 fetcher->pending_row++, i++)
+			{
+				instr_time conversion_start;
+
+				data_fetcher_conversion_start(&fetcher->state, &conversion_start);
+
+				PG_USED_FOR_ASSERTS_ONLY ItemPointer ctid =
+					tuplefactory_make_virtual_tuple(fetcher->state.tf,
+													res,
+													fetcher->pending_row,
+													PQbinaryTuples(res),
+													&fetcher->batch_values[i * nattrs],
+													&fetcher->batch_nulls[i * nattrs]);
+
+				/*
+				 * This fetcher uses virtual tuples that can't hold ctid, so if
+				 * we're receiving a ctid here, we're doing something wrong.
+				 */
+				Assert(ctid == NULL);
+
+				data_fetcher_conversion_end(&fetcher->state,
+											conversion_start,
+											fetcher->state.stats.enabled ?
+												result_row_size(res, fetcher->pending_row) :
+												0);
+			}
+
+			if (fetcher->pending_row >= PQntuples(res))
+			{
+				PQclear(res);
+				fetcher->pending_res = NULL;
+			}
 		}
 		/* We need to manually reset the context since we've turned off per tuple reset */
 		tuplefactory_reset_mctx(fetcher->state.tf);
@@ -254,14 +321,21 @@ static int
 prepared_statement_fetcher_fetch_data(DataFetcher *df)
 {
 	PreparedStatementFetcher *fetcher = cast_fetcher(PreparedStatementFetcher, df);
+	instr_time start;
+	int numrows;
 
 	if (fetcher->state.eof)
 		return 0;
 
+	INSTR_TIME_SET_CURRENT(start);
+
 	if (!fetcher->state.open)
 		prepared_statement_fetcher_send_fetch_request(df);
 
-	return prepared_statement_fetcher_complete(fetcher);
+	numrows = prepared_statement_fetcher_complete(fetcher);
+	data_fetcher_track_batch(df, numrows, start);
+
+	return numrows;
 }
 
 static void
@@ -308,6 +382,7 @@ prepared_statement_fetcher_create_for_scan(TSConnection *conn, const char *stmt,
 										   TupleFactory *tf)
 {
 	PreparedStatementFetcher *fetcher = palloc0(sizeof(PreparedStatementFetcher));
+	char *stmt_name = NULL;
 
 	data_fetcher_init(&fetcher->state, conn, stmt, params, tf);
 	fetcher->state.type = PreparedStatementFetcherType;
@@ -334,8 +409,29 @@ prepared_statement_fetcher_create_for_scan(TSConnection *conn, const char *stmt,
 	}
 	PQclear(res);
 
+	/*
+	 * With the plan cache, the statement is kept prepared on the connection,
+	 * so that repeated queries neither parse nor plan it again on the data
+	 * node.
+	 */
+	fetcher->stmt_name = "";
+	if (ts_guc_enable_remote_plan_cache)
+	{
+		const char *cached_name = remote_connection_find_prepared_stmt(conn, stmt);
+
+		if (cached_name != NULL)
+		{
+			fetcher->stmt_name = cached_name;
+			return &fetcher->state;
+		}
+
+		stmt_name = remote_connection_prepared_stmt_name(conn);
+		if (stmt_name != NULL)
+			fetcher->stmt_name = stmt_name;
+	}
+
 	if (1 != PQsendPrepare(pg_conn,
-						   /* stmtName = */ "",
+						   fetcher->stmt_name,
 						   stmt,
 						   stmt_params_num_params(params),
 						   /* paramTypes = */ NULL))
@@ -355,6 +451,9 @@ prepared_statement_fetcher_create_for_scan(TSConnection *conn, const char *stmt,
 
 	PQclear(res);
 
+	if (stmt_name != NULL)
+		remote_connection_add_prepared_stmt(conn, stmt, stmt_name);
+
 	return &fetcher->state;
 }
 
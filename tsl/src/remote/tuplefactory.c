@@ -320,13 +320,7 @@ tuplefactory_make_virtual_tuple(TupleFactory *tf, PGresult *res, int row, int fo
 			{
 				Assert(tf->attconv->binary);
 				if (valstr != NULL)
-				{
-					StringInfoData si = { .data = valstr, .len = len };
-					values[i - 1] = ReceiveFunctionCall(&tf->attconv->conv_funcs[i - 1],
-														&si,
-														tf->attconv->ioparams[i - 1],
-														tf->attconv->typmods[i - 1]);
-				}
+					values[i - 1] = data_format_receive_binary(tf->attconv, i - 1, valstr, len);
 				else
 					values[i - 1] = PointerGetDatum(NULL);
 			}
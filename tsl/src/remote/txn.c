@@ -5,6 +5,7 @@
  */
 #include "libpq-fe.h"
 #include <postgres.h>
+#include <access/htup_details.h>
 #include <access/xact.h>
 #include <storage/procarray.h>
 #include <utils/builtins.h>
@@ -780,23 +781,38 @@ remote_txn_persistent_record_delete_for_data_node(Oid foreign_server_oid, const
 	return ts_scanner_scan(&scanctx);
 }
 
+/*
+ * Insert a commit record without making it visible. The caller must be the
+ * catalog owner and increment the command counter.
+ */
 static void
-persistent_record_insert_relation(Relation rel, RemoteTxnId *id)
+persistent_record_insert_only(Relation rel, RemoteTxnId *id)
 {
 	TupleDesc desc = RelationGetDescr(rel);
 	Datum values[Natts_remote_txn];
 	bool nulls[Natts_remote_txn] = { false };
-	CatalogSecurityContext sec_ctx;
 	ForeignServer *server = GetForeignServer(id->id.server_id);
+	HeapTuple tuple;
 
 	values[AttrNumberGetAttrOffset(Anum_remote_txn_data_node_name)] =
 		DirectFunctionCall1(namein, CStringGetDatum(server->servername));
 	values[AttrNumberGetAttrOffset(Anum_remote_txn_remote_transaction_id)] =
 		CStringGetTextDatum(remote_txn_id_out(id));
 
+	tuple = heap_form_tuple(desc, values, nulls);
+	ts_catalog_insert_only(rel, tuple);
+	heap_freetuple(tuple);
+}
+
+static void
+persistent_record_insert_relation(Relation rel, RemoteTxnId *id)
+{
+	CatalogSecurityContext sec_ctx;
+
 	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
-	ts_catalog_insert_values(rel, desc, values, nulls);
+	persistent_record_insert_only(rel, id);
 	ts_catalog_restore_user(&sec_ctx);
+	CommandCounterIncrement();
 }
 
 /*
@@ -817,3 +833,41 @@ remote_txn_persistent_record_write(TSConnectionId cid)
 	table_close(rel, NoLock);
 	return id;
 }
+
+/*
+ * Add the commit records of a list of remote transactions to the catalog.
+ *
+ * This is the same as writing the record of each transaction in turn, but
+ * opens the catalog table and switches to the catalog owner only once, and
+ * makes all records visible with a single command counter increment.
+ */
+void
+remote_txn_write_persistent_records(List *remote_txns)
+{
+	Catalog *catalog;
+	CatalogSecurityContext sec_ctx;
+	Relation rel;
+	ListCell *lc;
+
+	if (remote_txns == NIL)
+		return;
+
+	catalog = ts_catalog_get();
+	rel = table_open(catalog->tables[REMOTE_TXN].id, RowExclusiveLock);
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+
+	foreach (lc, remote_txns)
+	{
+		RemoteTxn *entry = lfirst(lc);
+
+		entry->remote_txn_id = remote_txn_id_create(GetTopTransactionId(), entry->id);
+		persistent_record_insert_only(rel, entry->remote_txn_id);
+	}
+
+	ts_catalog_restore_user(&sec_ctx);
+	CommandCounterIncrement();
+
+	/* Keep the table lock until transaction completes in order to
+	 * synchronize with distributed restore point creation */
+	table_close(rel, NoLock);
+}
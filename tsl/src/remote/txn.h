@@ -27,6 +27,7 @@ extern RemoteTxn *remote_txn_begin_on_connection(TSConnection *conn);
 extern void remote_txn_begin(RemoteTxn *entry, int curlevel);
 extern bool remote_txn_abort(RemoteTxn *entry);
 extern void remote_txn_write_persistent_record(RemoteTxn *entry);
+extern void remote_txn_write_persistent_records(List *remote_txns);
 extern void remote_txn_deallocate_prepared_stmts_if_needed(RemoteTxn *entry);
 extern bool remote_txn_sub_txn_abort(RemoteTxn *entry, int curlevel);
 extern void remote_txn_sub_txn_pre_commit(RemoteTxn *entry, int curlevel);
@@ -19,6 +19,7 @@
 #include <access/multixact.h>
 #include <access/relscan.h>
 #include <access/rewriteheap.h>
+#include <access/tableam.h>
 #include <access/transam.h>
 #include <access/xact.h>
 #include <access/xlog.h>
@@ -66,6 +67,7 @@
 #include "chunk.h"
 #include "chunk_copy.h"
 #include "chunk_index.h"
+#include "guc.h"
 #include "hypertable_cache.h"
 #include "indexing.h"
 #include "reorder.h"
@@ -79,12 +81,13 @@ static void reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id,
 static void rebuild_relation(Relation OldHeap, Oid indexOid, bool verbose, Oid wait_id,
 							 Oid destination_tablespace, Oid index_tablespace);
 static void copy_heap_data(Oid OIDNewHeap, Oid OIDOldHeap, Oid OIDOldIndex, bool verbose,
-						   bool *pSwapToastByContent, TransactionId *pFreezeXid,
-						   MultiXactId *pCutoffMulti);
+						   LOCKMODE lockmode, bool *pSwapToastByContent,
+						   TransactionId *pFreezeXid, MultiXactId *pCutoffMulti);
 
 static void finish_heap_swaps(Oid OIDOldHeap, Oid OIDNewHeap, List *old_index_oids,
 							  List *new_index_oids, bool swap_toast_by_content, bool is_internal,
-							  TransactionId frozenXid, MultiXactId cutoffMulti, Oid wait_id);
+							  TransactionId frozenXid, MultiXactId cutoffMulti, Oid wait_id,
+							  Snapshot copy_snapshot);
 
 static void swap_relation_files(Oid r1, Oid r2, bool swap_toast_by_content, bool is_internal,
 								TransactionId frozenXid, MultiXactId cutoffMulti);
@@ -534,6 +537,7 @@ reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id, Oid destinati
 	Relation OldHeap;
 	HeapTuple tuple;
 	Form_pg_index indexForm;
+	LOCKMODE lockmode = ts_guc_enable_online_reorder ? ShareUpdateExclusiveLock : ExclusiveLock;
 
 	if (!OidIsValid(indexOid))
 		elog(ERROR, "Reorder must specify an index.");
@@ -546,8 +550,12 @@ reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id, Oid destinati
 	 * of the transaction.  (This is redundant for the single-transaction
 	 * case, since cluster() already did it.)  The index lock is taken inside
 	 * check_index_is_clusterable.
+	 *
+	 * An online reorder only takes a lock that conflicts with other DDL and
+	 * vacuum, so that the chunk can still be written to while it is copied.
+	 * The changes made during the copy are detected before the swap.
 	 */
-	OldHeap = try_relation_open(tableOid, ExclusiveLock);
+	OldHeap = try_relation_open(tableOid, lockmode);
 
 	/* If the table has gone away, we can skip processing it */
 	if (!OldHeap)
@@ -563,7 +571,7 @@ reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id, Oid destinati
 	/* Check that the user still owns the relation */
 	if (!object_ownercheck(RelationRelationId, tableOid, GetUserId()))
 	{
-		relation_close(OldHeap, ExclusiveLock);
+		relation_close(OldHeap, lockmode);
 		ereport(WARNING, (errcode(ERRCODE_WARNING), errmsg("ownership changed during reorder")));
 		return;
 	}
@@ -594,7 +602,7 @@ reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id, Oid destinati
 	if (!SearchSysCacheExists1(RELOID, ObjectIdGetDatum(indexOid)))
 	{
 		ereport(WARNING, (errcode(ERRCODE_WARNING), errmsg("index disappeared during reorder")));
-		relation_close(OldHeap, ExclusiveLock);
+		relation_close(OldHeap, lockmode);
 		return;
 	}
 
@@ -605,7 +613,7 @@ reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id, Oid destinati
 	if (!HeapTupleIsValid(tuple)) /* probably can't happen */
 	{
 		ereport(WARNING, (errcode(ERRCODE_WARNING), errmsg("invalid index heap during reorder")));
-		relation_close(OldHeap, ExclusiveLock);
+		relation_close(OldHeap, lockmode);
 		return;
 	}
 	indexForm = (Form_pg_index) GETSTRUCT(tuple);
@@ -626,7 +634,7 @@ reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id, Oid destinati
 	CheckTableNotInUse(OldHeap, "CLUSTER");
 
 	/* Check heap and index are valid to cluster on */
-	check_index_is_clusterable_compat(OldHeap, indexOid, ExclusiveLock);
+	check_index_is_clusterable_compat(OldHeap, indexOid, lockmode);
 
 	/* rebuild_relation does all the dirty work */
 	rebuild_relation(OldHeap, indexOid, verbose, wait_id, destination_tablespace, index_tablespace);
@@ -656,6 +664,8 @@ rebuild_relation(Relation OldHeap, Oid indexOid, bool verbose, Oid wait_id,
 	bool swap_toast_by_content;
 	TransactionId frozenXid;
 	MultiXactId cutoffMulti;
+	Snapshot copy_snapshot = NULL;
+	LOCKMODE lockmode = ExclusiveLock;
 
 	/* Mark the correct index as clustered */
 	mark_index_clustered(OldHeap, indexOid, true);
@@ -673,11 +683,23 @@ rebuild_relation(Relation OldHeap, Oid indexOid, bool verbose, Oid wait_id,
 									  relpersistence,
 									  ExclusiveLock);
 
+	/*
+	 * For an online reorder, remember which rows were visible when the copy
+	 * started, so that rows that are modified during the copy can be found
+	 * when the chunk is locked for the swap.
+	 */
+	if (ts_guc_enable_online_reorder)
+	{
+		copy_snapshot = RegisterSnapshot(GetLatestSnapshot());
+		lockmode = ShareUpdateExclusiveLock;
+	}
+
 	/* Copy the heap data into the new table in the desired order */
 	copy_heap_data(OIDNewHeap,
 				   tableOid,
 				   indexOid,
 				   verbose,
+				   lockmode,
 				   &swap_toast_by_content,
 				   &frozenXid,
 				   &cutoffMulti);
@@ -698,7 +720,8 @@ rebuild_relation(Relation OldHeap, Oid indexOid, bool verbose, Oid wait_id,
 					  true,
 					  frozenXid,
 					  cutoffMulti,
-					  wait_id);
+					  wait_id,
+					  copy_snapshot);
 }
 
 /*
@@ -710,7 +733,7 @@ rebuild_relation(Relation OldHeap, Oid indexOid, bool verbose, Oid wait_id,
  * *pCutoffMulti receives the MultiXactId used as a cutoff point.
  */
 static void
-copy_heap_data(Oid OIDNewHeap, Oid OIDOldHeap, Oid OIDOldIndex, bool verbose,
+copy_heap_data(Oid OIDNewHeap, Oid OIDOldHeap, Oid OIDOldIndex, bool verbose, LOCKMODE lockmode,
 			   bool *pSwapToastByContent, TransactionId *pFreezeXid, MultiXactId *pCutoffMulti)
 {
 	Relation NewHeap, OldHeap, OldIndex;
@@ -736,10 +759,10 @@ copy_heap_data(Oid OIDNewHeap, Oid OIDOldHeap, Oid OIDOldIndex, bool verbose,
 	 * Open the relations we need.
 	 */
 	NewHeap = table_open(OIDNewHeap, AccessExclusiveLock);
-	OldHeap = table_open(OIDOldHeap, ExclusiveLock);
+	OldHeap = table_open(OIDOldHeap, lockmode);
 
 	if (OidIsValid(OIDOldIndex))
-		OldIndex = index_open(OIDOldIndex, ExclusiveLock);
+		OldIndex = index_open(OIDOldIndex, lockmode);
 	else
 		OldIndex = NULL;
 
@@ -770,7 +793,7 @@ copy_heap_data(Oid OIDNewHeap, Oid OIDOldHeap, Oid OIDOldIndex, bool verbose,
 	 * will be held till end of transaction.
 	 */
 	if (OldHeap->rd_rel->reltoastrelid)
-		LockRelationOid(OldHeap->rd_rel->reltoastrelid, ExclusiveLock);
+		LockRelationOid(OldHeap->rd_rel->reltoastrelid, lockmode);
 
 	/* use_wal off requires smgr_targblock be initially invalid */
 	Assert(RelationGetTargetBlock(NewHeap) == InvalidBlockNumber);
@@ -921,6 +944,42 @@ copy_heap_data(Oid OIDNewHeap, Oid OIDOldHeap, Oid OIDOldIndex, bool verbose,
 	CommandCounterIncrement();
 }
 
+/*
+ * Check that no rows of a chunk were modified since the copy snapshot was
+ * taken, by comparing the visibility of each row version in the copy
+ * snapshot with its visibility now. The caller must hold an
+ * AccessExclusiveLock on the chunk, so that all the transactions that wrote
+ * to it during the copy have finished.
+ */
+static void
+check_no_concurrent_changes(Relation rel, Snapshot copy_snapshot)
+{
+	Snapshot snapshot = RegisterSnapshot(GetLatestSnapshot());
+	TableScanDesc scan = table_beginscan(rel, SnapshotAny, 0, NULL);
+	TupleTableSlot *slot = table_slot_create(rel, NULL);
+	bool changed = false;
+
+	while (!changed && table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		changed = table_tuple_satisfies_snapshot(rel, slot, copy_snapshot) !=
+				  table_tuple_satisfies_snapshot(rel, slot, snapshot);
+	}
+
+	ExecDropSingleTupleTableSlot(slot);
+	table_endscan(scan);
+	UnregisterSnapshot(snapshot);
+
+	if (changed)
+		ereport(ERROR,
+				(errcode(ERRCODE_T_R_SERIALIZATION_FAILURE),
+				 errmsg("chunk \"%s\" was modified during online reorder",
+						RelationGetRelationName(rel)),
+				 errhint("Retry the reorder, or disable timescaledb.enable_online_reorder to "
+						 "block writes to the chunk while it is reordered.")));
+}
+
 /*
  * Remove the transient table that was built by make_new_heap, and finish
  * cleaning up (including rebuilding all indexes on the old heap).
@@ -931,7 +990,7 @@ copy_heap_data(Oid OIDNewHeap, Oid OIDOldHeap, Oid OIDOldIndex, bool verbose,
 static void
 finish_heap_swaps(Oid OIDOldHeap, Oid OIDNewHeap, List *old_index_oids, List *new_index_oids,
 				  bool swap_toast_by_content, bool is_internal, TransactionId frozenXid,
-				  MultiXactId cutoffMulti, Oid wait_id)
+				  MultiXactId cutoffMulti, Oid wait_id, Snapshot copy_snapshot)
 {
 	ObjectAddress object;
 	Relation oldHeapRel;
@@ -987,6 +1046,12 @@ finish_heap_swaps(Oid OIDOldHeap, Oid OIDNewHeap, List *old_index_oids, List *ne
 
 	oldHeapRel = table_open(OIDOldHeap, AccessExclusiveLock);
 
+	if (copy_snapshot != NULL)
+	{
+		check_no_concurrent_changes(oldHeapRel, copy_snapshot);
+		UnregisterSnapshot(copy_snapshot);
+	}
+
 	/*
 	 * All predicate locks on the tuples or pages are about to be made
 	 * invalid, because we move tuples around.  Promote them to relation
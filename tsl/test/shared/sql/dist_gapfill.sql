@@ -99,3 +99,32 @@ SET enable_partitionwise_aggregate = 'off';
 :DIFF_CMD_PARTITIONWISE_OFF
 :DIFF_CMD_PARTITIONWISE_ON
 :DIFF_CMD_METRICS_PARTITIONWISE_OFF
+
+-- The aggregates of a gapfill query are pushed down to the data nodes, which
+-- compute the buckets with time_bucket. The gaps are filled on the access node.
+CREATE FUNCTION remote_sql(query text) RETURNS SETOF text LANGUAGE PLPGSQL AS
+$BODY$
+DECLARE
+  line text;
+BEGIN
+  FOR line IN EXECUTE 'EXPLAIN (VERBOSE, COSTS OFF) ' || query LOOP
+    IF line ~ 'Remote SQL' THEN
+      RETURN NEXT line;
+    END IF;
+  END LOOP;
+END
+$BODY$;
+
+SET enable_partitionwise_aggregate = 'on';
+SELECT count(*) > 0 AS remote_scans,
+       bool_and(sql ~ 'time_bucket\(' AND sql !~ 'time_bucket_gapfill' AND sql ~ 'GROUP BY') AS pushed_down
+FROM remote_sql($$
+SELECT time_bucket_gapfill('3 hours', time, start:='2017-01-01 06:00', finish:='2017-01-01 18:00'),
+       device,
+       first(value, time),
+       avg(value)
+FROM conditions_dist
+GROUP BY 1,2
+$$) sql;
+RESET enable_partitionwise_aggregate;
+DROP FUNCTION remote_sql;
@@ -1513,3 +1513,96 @@ FROM (
     FROM generate_series(1, 10, 100) as x
     ) t
 GROUP BY 1, 2
+
+-- Test hashed gapfill, which takes input that is not sorted by the group
+-- columns and time
+CREATE FUNCTION gapfill_input_nodes(query text, node_type text) RETURNS bigint
+LANGUAGE plpgsql AS $$
+DECLARE
+  plan jsonb;
+  matches bigint;
+BEGIN
+  EXECUTE 'EXPLAIN (FORMAT JSON) ' || query INTO plan;
+  WITH RECURSIVE nodes(node, below_gapfill) AS (
+    SELECT plan->0->'Plan', false
+    UNION ALL
+    SELECT child, below_gapfill OR node->>'Custom Plan Provider' = 'GapFill'
+    FROM nodes, jsonb_array_elements(node->'Plans') child
+  )
+  SELECT count(*) FILTER (WHERE below_gapfill AND node->>'Node Type' = node_type)
+  INTO matches FROM nodes;
+  RETURN matches;
+END
+$$;
+SET enable_sort TO off;
+SELECT gapfill_input_nodes($$
+SELECT time_bucket_gapfill(1, t, 0, 6) AS bucket, device, locf(min(v))
+FROM (VALUES (0, 2, 1), (0, 1, 2), (3, 1, 5), (5, 2, 7)) AS v(t, device, v)
+GROUP BY 1, 2
+$$, 'Sort') AS input_sorts;
+SELECT * FROM (
+SELECT time_bucket_gapfill(1, t, 0, 6) AS bucket, device, locf(min(v))
+FROM (VALUES (0, 2, 1), (0, 1, 2), (3, 1, 5), (5, 2, 7)) AS v(t, device, v)
+GROUP BY 1, 2
+) g ORDER BY device, bucket;
+SET timescaledb.enable_hashed_gapfill TO off;
+SELECT gapfill_input_nodes($$
+SELECT time_bucket_gapfill(1, t, 0, 6) AS bucket, device, locf(min(v))
+FROM (VALUES (0, 2, 1), (0, 1, 2), (3, 1, 5), (5, 2, 7)) AS v(t, device, v)
+GROUP BY 1, 2
+$$, 'Sort') > 0 AS input_sorted;
+RESET timescaledb.enable_hashed_gapfill;
+RESET enable_sort;
+
+-- Test that the gapfilled tuples of each group get the values of the group
+-- and that integer interpolation matches the formula in every bucket
+WITH gapfilled AS (
+  SELECT time_bucket_gapfill(1, t, 0, 100) AS x, device, device * 10 AS derived,
+    NULL::int AS nothing, interpolate(min(v)) AS interpolated, locf(min(v)) AS carried
+  FROM (VALUES (0, 1, 9000000000000000000), (99, 1, -123456789), (10, 2, 7), (80, 2, 1000)) AS d(t, device, v)
+  GROUP BY 1, 2
+)
+SELECT count(*) AS buckets,
+  count(*) FILTER (WHERE derived <> device * 10 OR nothing IS NOT NULL) AS wrong_group_values,
+  count(*) FILTER (WHERE interpolated IS DISTINCT FROM
+    CASE WHEN x BETWEEN x0 AND x1 THEN ((y0 * (x1 - x) + y1 * (x - x0)) / (x1 - x0))::bigint END) AS wrong_interpolated,
+  count(*) FILTER (WHERE carried IS DISTINCT FROM
+    CASE WHEN x >= x1 THEN y1 WHEN x >= x0 THEN y0 END::bigint) AS wrong_carried
+FROM gapfilled
+JOIN (VALUES (1, 0, 99, 9000000000000000000::numeric, -123456789::numeric), (2, 10, 80, 7, 1000)) AS p(device, x0, x1, y0, y1)
+USING (device);
+
+-- Test that the hashed gapfill node is only used when its input fits in
+-- work_mem, and that input sorted by the leading group columns only gets
+-- an incremental sort
+CREATE TEMP TABLE gapfill_work AS
+SELECT t, t % 100 AS device, t % 7 AS sensor, t::float AS value
+FROM generate_series(1, 100000) t;
+ANALYZE gapfill_work;
+SET enable_sort TO off;
+SET work_mem TO '1GB';
+SELECT gapfill_input_nodes($$
+SELECT time_bucket_gapfill(1, t, 0, 100000), device, sensor, min(value)
+FROM gapfill_work
+GROUP BY 1, 2, 3
+$$, 'Sort') AS input_sorts;
+SET work_mem TO '64kB';
+SELECT gapfill_input_nodes($$
+SELECT time_bucket_gapfill(1, t, 0, 100000), device, sensor, min(value)
+FROM gapfill_work
+GROUP BY 1, 2, 3
+$$, 'Sort') > 0 AS input_sorted;
+RESET work_mem;
+RESET enable_sort;
+SET enable_hashagg TO off;
+SET timescaledb.enable_hashed_gapfill TO off;
+-- the aggregate returns rows sorted by device, time and sensor
+SELECT gapfill_input_nodes($$
+SELECT time_bucket_gapfill(1, t, 0, 100000), device, sensor, min(value)
+FROM gapfill_work
+GROUP BY 2, 1, 3
+$$, 'Incremental Sort') > 0 AS incremental_sort;
+RESET timescaledb.enable_hashed_gapfill;
+RESET enable_hashagg;
+DROP TABLE gapfill_work;
+DROP FUNCTION gapfill_input_nodes(text, text);
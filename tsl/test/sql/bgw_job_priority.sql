@@ -0,0 +1,104 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+CREATE OR REPLACE FUNCTION ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(timeout INT = -1, mock_start_time INT = 0) RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_bgw_params_create() RETURNS VOID AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_bgw_params_reset_time(set_time BIGINT = 0, wait BOOLEAN = false) RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE FUNCTION insert_job(
+       application_name NAME,
+       job_type NAME,
+       schedule_interval INTERVAL,
+       max_runtime INTERVAL,
+       retry_period INTERVAL
+) RETURNS INT LANGUAGE SQL AS
+$$
+  INSERT INTO _timescaledb_config.bgw_job(application_name,schedule_interval,max_runtime,max_retries,
+  retry_period,proc_name,proc_schema,owner,scheduled)
+  VALUES($1,$3,$4,5,$5,$2,'public',CURRENT_ROLE::regrole,true) RETURNING id;
+$$;
+
+-- Remove any default jobs, e.g., telemetry
+DELETE FROM _timescaledb_config.bgw_job WHERE TRUE;
+TRUNCATE _timescaledb_internal.bgw_job_stat;
+
+CREATE TABLE public.bgw_log(
+    msg_no INT,
+    mock_time BIGINT,
+    application_name TEXT,
+    msg TEXT
+);
+
+CREATE TABLE public.bgw_dsm_handle_store(
+    handle BIGINT
+);
+
+INSERT INTO public.bgw_dsm_handle_store VALUES (0);
+SELECT ts_bgw_params_create();
+
+-- A job that records the order in which the jobs run
+CREATE TABLE job_runs(run SERIAL, job_id INTEGER);
+CREATE PROCEDURE record_run(job_id INTEGER, config JSONB) LANGUAGE SQL AS
+$$ INSERT INTO job_runs(job_id) VALUES (job_id) $$;
+
+-- Two jobs that are both due when the scheduler starts. The job that
+-- became due first has the longer average runtime.
+CREATE FUNCTION setup_jobs() RETURNS VOID LANGUAGE SQL AS
+$$
+  DELETE FROM _timescaledb_config.bgw_job;
+  TRUNCATE job_runs;
+  SELECT insert_job('slow', 'record_run', INTERVAL '1h', INTERVAL '100s', INTERVAL '100ms');
+  SELECT insert_job('fast', 'record_run', INTERVAL '1h', INTERVAL '100s', INTERVAL '100ms');
+  INSERT INTO _timescaledb_internal.bgw_job_stat(job_id, last_start, last_finish, next_start,
+    last_successful_finish, last_run_success, total_runs, total_duration,
+    total_duration_failures, total_successes, total_failures, total_crashes,
+    consecutive_failures, consecutive_crashes)
+  SELECT id, '1999-12-31 23:00:00+00', '1999-12-31 23:00:00+00'::timestamptz + d,
+    '1999-12-31 23:59:59+00'::timestamptz + n, '1999-12-31 23:00:00+00'::timestamptz + d,
+    true, 1, d, '0s', 1, 0, 0, 0, 0
+  FROM _timescaledb_config.bgw_job
+  JOIN (VALUES ('slow', INTERVAL '10s', INTERVAL '0s'),
+               ('fast', INTERVAL '1s', INTERVAL '0.5s')) AS v(name, d, n)
+  ON application_name = name;
+  SELECT ts_bgw_params_reset_time();
+$$;
+
+CREATE VIEW run_order AS
+SELECT string_agg(application_name, ', ' ORDER BY run) AS run_order
+FROM job_runs JOIN _timescaledb_config.bgw_job ON id = job_id;
+
+--
+-- With one job per class at a time, the jobs run one after the other in the
+-- order in which they became due
+--
+ALTER SYSTEM SET timescaledb.max_concurrent_jobs_per_class TO 1;
+SELECT pg_reload_conf();
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SHOW timescaledb.max_concurrent_jobs_per_class;
+
+SELECT setup_jobs();
+SELECT ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(500);
+SELECT * FROM run_order;
+
+--
+-- With prioritization, the job with the shorter average runtime goes first
+--
+ALTER SYSTEM SET timescaledb.enable_job_prioritization TO on;
+SELECT pg_reload_conf();
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SHOW timescaledb.enable_job_prioritization;
+
+SELECT setup_jobs();
+SELECT ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(500);
+SELECT * FROM run_order;
+SELECT application_name, total_runs, last_run_success
+FROM _timescaledb_internal.bgw_job_stat JOIN _timescaledb_config.bgw_job ON id = job_id
+ORDER BY application_name;
+
+ALTER SYSTEM RESET timescaledb.max_concurrent_jobs_per_class;
+ALTER SYSTEM RESET timescaledb.enable_job_prioritization;
+SELECT pg_reload_conf();
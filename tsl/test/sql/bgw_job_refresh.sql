@@ -0,0 +1,64 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT _timescaledb_internal.stop_background_workers();
+
+CREATE OR REPLACE FUNCTION ts_test_job_refresh() RETURNS TABLE(
+id INTEGER,
+application_name NAME,
+schedule_interval INTERVAL,
+max_runtime INTERVAL,
+max_retries INT,
+retry_period INTERVAL,
+next_start TIMESTAMPTZ,
+timeout_at TIMESTAMPTZ,
+reserved_worker BOOLEAN,
+may_next_mark_end BOOLEAN
+)
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE FUNCTION insert_job(
+       application_name NAME,
+       job_type NAME,
+       schedule_interval INTERVAL,
+       max_runtime INTERVAL,
+       retry_period INTERVAL
+) RETURNS INT LANGUAGE SQL AS
+$$
+  INSERT INTO _timescaledb_config.bgw_job(application_name,schedule_interval,max_runtime,max_retries,
+  retry_period,proc_name,proc_schema,owner,scheduled)
+  VALUES($1,$3,$4,5,$5,$2,'public',CURRENT_ROLE::regrole,true) RETURNING id;
+$$;
+
+DELETE FROM _timescaledb_config.bgw_job WHERE TRUE;
+TRUNCATE _timescaledb_internal.bgw_job_stat;
+
+SELECT insert_job('job_a', 'bgw_test_job_1', INTERVAL '1h', INTERVAL '100s', INTERVAL '1s') AS job_a \gset
+SELECT insert_job('job_b', 'bgw_test_job_1', INTERVAL '1h', INTERVAL '100s', INTERVAL '1s') AS job_b \gset
+SELECT application_name, next_start FROM ts_test_job_refresh() ORDER BY id;
+
+-- The job stats change without a change of the jobs, so the jobs keep
+-- their next start
+INSERT INTO _timescaledb_internal.bgw_job_stat(job_id, last_start, last_finish, next_start,
+  last_successful_finish, last_run_success, total_runs, total_duration,
+  total_duration_failures, total_successes, total_failures, total_crashes,
+  consecutive_failures, consecutive_crashes)
+SELECT id, '2000-01-01 00:00:00+00', '2000-01-01 00:00:01+00', '2000-01-01 02:00:00+00',
+  '2000-01-01 00:00:01+00', true, 1, '1s', '0s', 1, 0, 0, 0, 0
+FROM _timescaledb_config.bgw_job;
+SELECT application_name, next_start FROM ts_test_job_refresh() ORDER BY id;
+
+-- Altering a job reloads its next start, but not the next start of the
+-- other jobs
+SELECT next_start FROM alter_job(:job_a, next_start => '2000-01-01 01:00:00+00');
+SELECT application_name, next_start FROM ts_test_job_refresh() ORDER BY id;
+SELECT max_retries FROM alter_job(:job_b, max_retries => 6);
+SELECT application_name, next_start FROM ts_test_job_refresh() ORDER BY id;
+
+-- Without any change, the list stays the same
+SELECT application_name, next_start FROM ts_test_job_refresh() ORDER BY id;
+
+DELETE FROM _timescaledb_config.bgw_job;
+SELECT count(*) FROM ts_test_job_refresh();
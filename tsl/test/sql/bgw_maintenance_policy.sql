@@ -0,0 +1,89 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- The changes of a backend reach the cumulative statistics after it commits
+-- or exits, so wait for them before running the job
+CREATE FUNCTION wait_for_changes(chunk regclass, changes bigint) RETURNS bool
+LANGUAGE plpgsql AS
+$$
+BEGIN
+  FOR i IN 1 .. 100 LOOP
+    PERFORM pg_stat_clear_snapshot();
+    IF pg_stat_get_mod_since_analyze(chunk) >= changes THEN
+      RETURN true;
+    END IF;
+    PERFORM pg_sleep(0.1);
+  END LOOP;
+  RETURN false;
+END
+$$;
+
+CREATE TABLE metrics(time int NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 10);
+INSERT INTO metrics SELECT x, x % 2, x FROM generate_series(0, 29) x;
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+SELECT compress_chunk('_timescaledb_internal._hyper_1_1_chunk');
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT wait_for_changes('_timescaledb_internal._hyper_1_3_chunk', 10);
+
+SELECT add_maintenance_policy('metrics') AS job_id \gset
+SELECT application_name, schedule_interval, proc_schema, proc_name, config
+FROM _timescaledb_config.bgw_job WHERE id = :job_id;
+
+SELECT CASE WHEN reltuples > 0 THEN reltuples ELSE 0 END AS reltuples
+FROM pg_class WHERE oid = '_timescaledb_internal._hyper_1_3_chunk'::regclass;
+
+-- The latest chunk is analyzed, and one closed chunk per run is frozen, the
+-- oldest first. The compressed chunks are frozen through their compressed
+-- chunk.
+CALL run_job(:job_id);
+SELECT CASE WHEN reltuples > 0 THEN reltuples ELSE 0 END AS reltuples
+FROM pg_class WHERE oid = '_timescaledb_internal._hyper_1_3_chunk'::regclass;
+SELECT chunk_id, num_times_job_run FROM _timescaledb_internal.bgw_policy_chunk_stats
+WHERE job_id = :job_id ORDER BY chunk_id;
+CALL run_job(:job_id);
+SELECT chunk_id, num_times_job_run FROM _timescaledb_internal.bgw_policy_chunk_stats
+WHERE job_id = :job_id ORDER BY chunk_id;
+
+-- All the closed chunks are frozen
+CALL run_job(:job_id);
+SELECT chunk_id, num_times_job_run FROM _timescaledb_internal.bgw_policy_chunk_stats
+WHERE job_id = :job_id ORDER BY chunk_id;
+
+-- A frozen chunk is frozen once more after it is compressed
+SELECT compress_chunk('_timescaledb_internal._hyper_1_2_chunk');
+CALL run_job(:job_id);
+SELECT chunk_id, num_times_job_run FROM _timescaledb_internal.bgw_policy_chunk_stats
+WHERE job_id = :job_id ORDER BY chunk_id;
+
+-- The latest chunk is analyzed again once enough of its rows changed
+INSERT INTO metrics VALUES (25, 0, 25);
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT wait_for_changes('_timescaledb_internal._hyper_1_3_chunk', 1);
+CALL run_job(:job_id);
+SELECT CASE WHEN reltuples > 0 THEN reltuples ELSE 0 END AS reltuples
+FROM pg_class WHERE oid = '_timescaledb_internal._hyper_1_3_chunk'::regclass;
+SELECT config FROM alter_job(:job_id,
+  config => jsonb_set(config, '{analyze_scale_factor}', '100'));
+INSERT INTO metrics VALUES (26, 0, 26);
+CALL run_job(:job_id);
+SELECT CASE WHEN reltuples > 0 THEN reltuples ELSE 0 END AS reltuples
+FROM pg_class WHERE oid = '_timescaledb_internal._hyper_1_3_chunk'::regclass;
+
+\set ON_ERROR_STOP 0
+SELECT add_maintenance_policy('metrics');
+SELECT add_maintenance_policy('metrics', analyze_scale_factor => -1);
+SELECT add_maintenance_policy('metrics', max_vacuums_per_run => -1);
+SELECT FROM alter_job(:job_id,
+  config => '{"hypertable_id": 1, "analyze_scale_factor": -1}');
+SELECT remove_maintenance_policy('pg_class');
+\set ON_ERROR_STOP 1
+SELECT add_maintenance_policy('metrics', if_not_exists => true);
+SELECT remove_maintenance_policy('metrics');
+SELECT remove_maintenance_policy('metrics', if_exists => true);
+
+DROP TABLE metrics;
+DROP FUNCTION wait_for_changes(regclass, bigint);
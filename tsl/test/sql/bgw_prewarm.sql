@@ -0,0 +1,44 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE FUNCTION ts_test_prewarm_recent_chunks(num_chunks int, budget bigint)
+RETURNS TABLE(chunk regclass, compressed_chunk regclass, blocks bigint)
+AS :MODULE_PATHNAME, 'ts_test_prewarm_recent_chunks' LANGUAGE C VOLATILE STRICT;
+
+-- Prewarming is off by default
+SHOW timescaledb.prewarm_recent_chunks;
+SHOW timescaledb.prewarm_memory_limit;
+
+-- Every chunk has one heap block and two blocks of its time index
+CREATE TABLE a(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('a', 'time', chunk_time_interval => 10);
+INSERT INTO a SELECT x, x FROM generate_series(0, 29) x;
+CREATE TABLE b(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('b', 'time', chunk_time_interval => 10);
+INSERT INTO b SELECT x, x FROM generate_series(0, 19) x;
+
+-- The newest chunk of each hypertable comes first, then the second newest ones
+SELECT * FROM ts_test_prewarm_recent_chunks(2, 100);
+SELECT * FROM ts_test_prewarm_recent_chunks(1, 100);
+
+-- The indexes of a chunk are read before its heap, until the budget is used
+SELECT * FROM ts_test_prewarm_recent_chunks(2, 7);
+
+-- A compressed chunk is read through its compressed chunk, and the continuous
+-- aggregates through their materialized hypertable
+ALTER TABLE a SET (timescaledb.compress);
+SELECT compress_chunk('_timescaledb_internal._hyper_1_2_chunk');
+CREATE FUNCTION a_now() RETURNS int LANGUAGE SQL STABLE AS 'SELECT 30';
+SELECT set_integer_now_func('a', 'a_now');
+CREATE MATERIALIZED VIEW a_cagg WITH (timescaledb.continuous) AS
+SELECT time_bucket(10, time) AS bucket, sum(value) FROM a GROUP BY 1 WITH NO DATA;
+CALL refresh_continuous_aggregate('a_cagg', NULL, NULL);
+SELECT chunk, compressed_chunk, blocks > 0 AS read FROM ts_test_prewarm_recent_chunks(2, 100);
+
+DROP MATERIALIZED VIEW a_cagg;
+DROP TABLE a;
+DROP TABLE b;
+DROP FUNCTION a_now();
@@ -0,0 +1,83 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+CREATE OR REPLACE FUNCTION ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(timeout INT = -1, mock_start_time INT = 0) RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_bgw_params_create() RETURNS VOID AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_bgw_params_reset_time(set_time BIGINT = 0, wait BOOLEAN = false) RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE FUNCTION insert_job(
+       application_name NAME,
+       job_type NAME,
+       schedule_interval INTERVAL,
+       max_runtime INTERVAL,
+       retry_period INTERVAL
+) RETURNS INT LANGUAGE SQL AS
+$$
+  INSERT INTO _timescaledb_config.bgw_job(application_name,schedule_interval,max_runtime,max_retries,
+  retry_period,proc_name,proc_schema,owner,scheduled)
+  VALUES($1,$3,$4,5,$5,$2,'public',CURRENT_ROLE::regrole,true) RETURNING id;
+$$;
+
+-- Remove any default jobs, e.g., telemetry
+DELETE FROM _timescaledb_config.bgw_job WHERE TRUE;
+TRUNCATE _timescaledb_internal.bgw_job_stat;
+
+CREATE TABLE public.bgw_log(
+    msg_no INT,
+    mock_time BIGINT,
+    application_name TEXT,
+    msg TEXT
+);
+
+CREATE TABLE public.bgw_dsm_handle_store(
+    handle BIGINT
+);
+
+INSERT INTO public.bgw_dsm_handle_store VALUES (0);
+SELECT ts_bgw_params_create();
+
+-- A job that records the order in which the jobs run
+CREATE TABLE job_runs(run SERIAL, job_id INTEGER);
+CREATE PROCEDURE record_run(job_id INTEGER, config JSONB) LANGUAGE SQL AS
+$$ INSERT INTO job_runs(job_id) VALUES (job_id) $$;
+
+-- Twenty jobs. The odd jobs have run before and are due again since a
+-- second, the even jobs have never run and are due right away.
+INSERT INTO _timescaledb_config.bgw_job(application_name, schedule_interval, max_runtime,
+  max_retries, retry_period, proc_name, proc_schema, owner, scheduled)
+SELECT 'job_' || i, INTERVAL '1h', INTERVAL '100s', 5, INTERVAL '100ms', 'record_run', 'public',
+  CURRENT_ROLE::regrole, true
+FROM generate_series(1, 20) i;
+INSERT INTO _timescaledb_internal.bgw_job_stat(job_id, last_start, last_finish, next_start,
+  last_successful_finish, last_run_success, total_runs, total_duration,
+  total_duration_failures, total_successes, total_failures, total_crashes,
+  consecutive_failures, consecutive_crashes)
+SELECT id, '1999-12-31 23:00:00+00', '1999-12-31 23:00:01+00', '1999-12-31 23:59:59+00',
+  '1999-12-31 23:00:01+00', true, 1, '1s', '0s', 1, 0, 0, 0, 0
+FROM _timescaledb_config.bgw_job
+WHERE substring(application_name from 5)::integer % 2 = 1;
+SELECT ts_bgw_params_reset_time();
+
+--
+-- With one job at a time, the jobs start in the order of their next start
+-- and then of their job ID
+--
+ALTER SYSTEM SET timescaledb.max_concurrent_jobs_per_class TO 1;
+SELECT pg_reload_conf();
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SHOW timescaledb.max_concurrent_jobs_per_class;
+
+SELECT ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(1000);
+SELECT string_agg(application_name, ', ' ORDER BY run) AS run_order
+FROM job_runs JOIN _timescaledb_config.bgw_job ON id = job_id;
+SELECT count(*) AS jobs, sum(total_runs - total_successes) AS not_successful,
+  count(*) FILTER (WHERE last_run_success) AS succeeded_last
+FROM _timescaledb_internal.bgw_job_stat
+WHERE last_start >= '2000-01-01 00:00:00+00';
+
+ALTER SYSTEM RESET timescaledb.max_concurrent_jobs_per_class;
+SELECT pg_reload_conf();
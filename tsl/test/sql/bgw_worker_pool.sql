@@ -0,0 +1,175 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+CREATE OR REPLACE FUNCTION ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(timeout INT = -1, mock_start_time INT = 0) RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_bgw_db_scheduler_test_run(timeout INT = -1, mock_start_time INT = 0) RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_bgw_db_scheduler_test_wait_for_scheduler_finish() RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_bgw_params_create() RETURNS VOID AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_bgw_params_reset_time(set_time BIGINT = 0, wait BOOLEAN = false) RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_bgw_params_mock_wait_returns_immediately(new_val INTEGER) RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_test_bgw_num_unreserved() RETURNS INTEGER
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE FUNCTION insert_job(
+       application_name NAME,
+       job_type NAME,
+       schedule_interval INTERVAL,
+       max_runtime INTERVAL,
+       retry_period INTERVAL
+) RETURNS INT LANGUAGE SQL AS
+$$
+  INSERT INTO _timescaledb_config.bgw_job(application_name,schedule_interval,max_runtime,max_retries,
+  retry_period,proc_name,proc_schema,owner,scheduled)
+  VALUES($1,$3,$4,5,$5,$2,'public',CURRENT_ROLE::regrole,true) RETURNING id;
+$$;
+
+\set WAIT_ON_JOB 0
+\set IMMEDIATELY_SET_UNTIL 1
+\set WAIT_FOR_STANDARD_WAITLATCH 3
+
+-- Wait up to five seconds for the number of idle pooled workers to
+-- become the expected number and return the last number seen
+CREATE FUNCTION wait_for_pool_workers(expected INTEGER) RETURNS INTEGER LANGUAGE PLPGSQL AS
+$BODY$
+DECLARE
+    r INTEGER;
+BEGIN
+    FOR i in 1..50
+    LOOP
+        SELECT count(*) INTO r FROM pg_stat_activity
+        WHERE application_name = 'TimescaleDB Job Pool Worker';
+        EXIT WHEN r = expected;
+        PERFORM pg_sleep(0.1);
+        PERFORM pg_stat_clear_snapshot();
+    END LOOP;
+    RETURN r;
+END
+$BODY$;
+
+-- Same for the number of unreserved background workers
+CREATE FUNCTION wait_for_unreserved(expected INTEGER) RETURNS INTEGER LANGUAGE PLPGSQL AS
+$BODY$
+DECLARE
+    r INTEGER;
+BEGIN
+    FOR i in 1..50
+    LOOP
+        SELECT ts_test_bgw_num_unreserved() INTO r;
+        EXIT WHEN r = expected;
+        PERFORM pg_sleep(0.1);
+    END LOOP;
+    RETURN r;
+END
+$BODY$;
+
+-- Remove any default jobs, e.g., telemetry
+DELETE FROM _timescaledb_config.bgw_job WHERE TRUE;
+TRUNCATE _timescaledb_internal.bgw_job_stat;
+
+CREATE TABLE public.bgw_log(
+    msg_no INT,
+    mock_time BIGINT,
+    application_name TEXT,
+    msg TEXT
+);
+
+CREATE TABLE public.bgw_dsm_handle_store(
+    handle BIGINT
+);
+
+INSERT INTO public.bgw_dsm_handle_store VALUES (0);
+SELECT ts_bgw_params_create();
+
+-- A job that records the process it runs in
+CREATE TABLE job_pids(job_id INTEGER, pid INTEGER);
+CREATE PROCEDURE record_pid(job_id INTEGER, config JSONB) LANGUAGE SQL AS
+$$ INSERT INTO job_pids VALUES (job_id, pg_backend_pid()) $$;
+
+--
+-- Without the pool, every run of a job starts a new worker
+--
+SELECT insert_job('record_pid', 'record_pid', INTERVAL '100ms', INTERVAL '100s', INTERVAL '100ms') AS job_id \gset
+SELECT ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(500);
+SELECT count(*) > 1 AS several_runs, count(DISTINCT pid) = count(*) AS worker_per_run
+FROM job_pids WHERE job_id = :job_id;
+
+--
+-- With the pool, the runs of the job reuse the same worker
+--
+ALTER SYSTEM SET timescaledb.job_worker_pool_size TO 1;
+SELECT pg_reload_conf();
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SHOW timescaledb.job_worker_pool_size;
+
+TRUNCATE job_pids;
+TRUNCATE _timescaledb_internal.bgw_job_stat;
+SELECT ts_bgw_params_reset_time();
+SELECT ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(500);
+SELECT count(*) > 1 AS several_runs, count(DISTINCT pid) AS workers
+FROM job_pids WHERE job_id = :job_id;
+SELECT total_runs = total_successes AS all_succeeded, total_crashes
+FROM _timescaledb_internal.bgw_job_stat WHERE job_id = :job_id;
+
+--
+-- A job that fails takes its worker with it, so every run needs a new worker
+--
+DELETE FROM _timescaledb_config.bgw_job;
+TRUNCATE _timescaledb_internal.bgw_job_stat;
+TRUNCATE _timescaledb_internal.job_errors;
+SELECT ts_bgw_params_reset_time();
+SELECT insert_job('test_job_2', 'bgw_test_job_2_error', INTERVAL '100ms', INTERVAL '100s', INTERVAL '100ms') AS job_id \gset
+SELECT ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(500);
+SELECT total_runs > 1 AS several_runs, total_failures = total_runs AS all_failed, total_crashes
+FROM _timescaledb_internal.bgw_job_stat WHERE job_id = :job_id;
+SELECT count(DISTINCT pid) = count(*) AS worker_per_run
+FROM _timescaledb_internal.job_errors WHERE job_id = :job_id;
+
+--
+-- A job that times out is terminated with its worker like without the pool
+--
+DELETE FROM _timescaledb_config.bgw_job;
+TRUNCATE _timescaledb_internal.bgw_job_stat;
+SELECT ts_bgw_params_reset_time();
+SELECT insert_job('test_job_3_long', 'bgw_test_job_3_long', INTERVAL '5000ms', INTERVAL '20ms', INTERVAL '50ms') AS job_id \gset
+SELECT ts_bgw_params_mock_wait_returns_immediately(:IMMEDIATELY_SET_UNTIL);
+SELECT ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(200);
+SELECT last_run_success, total_runs, total_successes, total_failures, total_crashes
+FROM _timescaledb_internal.bgw_job_stat WHERE job_id = :job_id;
+SELECT ts_bgw_params_mock_wait_returns_immediately(:WAIT_ON_JOB);
+
+--
+-- An idle pooled worker does not hold a reserved background worker and
+-- exits after the idle timeout. The mock time is set to the current time
+-- so that the scheduler waits on its latch until the next run of the job.
+--
+ALTER SYSTEM SET timescaledb.job_worker_pool_idle_timeout TO '1s';
+SELECT pg_reload_conf();
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SHOW timescaledb.job_worker_pool_idle_timeout;
+
+DELETE FROM _timescaledb_config.bgw_job;
+TRUNCATE _timescaledb_internal.bgw_job_stat;
+TRUNCATE job_pids;
+SELECT ts_bgw_params_reset_time((extract(epoch FROM now() - '2000-01-01 UTC'::timestamptz) * 1000000)::bigint);
+SELECT insert_job('record_pid', 'record_pid', INTERVAL '1h', INTERVAL '100s', INTERVAL '100ms') AS job_id \gset
+SELECT ts_test_bgw_num_unreserved() AS unreserved \gset
+SELECT ts_bgw_params_mock_wait_returns_immediately(:WAIT_FOR_STANDARD_WAITLATCH);
+SELECT ts_bgw_db_scheduler_test_run(-1);
+SELECT wait_for_pool_workers(1);
+SELECT wait_for_unreserved(:unreserved) = :unreserved AS worker_released;
+SELECT wait_for_pool_workers(0);
+SELECT count(*) FROM job_pids WHERE job_id = :job_id;
+SELECT pg_terminate_backend(pid) FROM pg_stat_activity WHERE application_name = 'DB Scheduler Test';
+SELECT ts_bgw_db_scheduler_test_wait_for_scheduler_finish();
+SELECT ts_bgw_params_mock_wait_returns_immediately(:WAIT_ON_JOB);
+
+ALTER SYSTEM RESET timescaledb.job_worker_pool_size;
+ALTER SYSTEM RESET timescaledb.job_worker_pool_idle_timeout;
+SELECT pg_reload_conf();
@@ -0,0 +1,120 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- Plain inserts track the invalidated range of each chunk themselves
+-- instead of firing the invalidation trigger for each row, so check that
+-- they log the same invalidations as the trigger did
+CREATE TABLE conditions(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('conditions', 'time', chunk_time_interval => 10);
+CREATE FUNCTION conditions_now() RETURNS int LANGUAGE SQL STABLE AS 'SELECT 100';
+SELECT set_integer_now_func('conditions', 'conditions_now');
+INSERT INTO conditions SELECT x, x % 2, x FROM generate_series(0, 99) x;
+
+CREATE MATERIALIZED VIEW cond_10
+WITH (timescaledb.continuous, timescaledb.materialized_only = true) AS
+SELECT time_bucket(10, time) AS bucket, device, sum(value)
+FROM conditions
+GROUP BY 1, 2 WITH NO DATA;
+UPDATE _timescaledb_catalog.continuous_aggs_invalidation_threshold
+SET watermark = 100
+WHERE hypertable_id = 1;
+
+CREATE VIEW hyper_invals AS
+SELECT hypertable_id, lowest_modified_value AS lowest, greatest_modified_value AS greatest
+FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log
+ORDER BY 1, 2, 3;
+
+-- INSERT into several chunks
+INSERT INTO conditions VALUES (15, 0, 1), (42, 1, 1), (27, 0, 1);
+SELECT * FROM hyper_invals;
+DELETE FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log;
+-- values above the invalidation threshold are not logged
+INSERT INTO conditions VALUES (150, 0, 1);
+SELECT * FROM hyper_invals;
+-- the statements of a transaction are logged as one range
+BEGIN;
+INSERT INTO conditions VALUES (31, 0, 1);
+INSERT INTO conditions VALUES (73, 1, 1);
+SELECT * FROM hyper_invals;
+COMMIT;
+SELECT * FROM hyper_invals;
+DELETE FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log;
+
+-- COPY
+COPY conditions FROM STDIN;
+23	0	1
+67	1	1
+\.
+SELECT * FROM hyper_invals;
+DELETE FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log;
+-- COPY into several chunks, where the chunk insert states are evicted and
+-- created again
+SET timescaledb.max_open_chunks_per_insert = 1;
+COPY conditions FROM STDIN;
+35	0	1
+5	0	1
+88	1	1
+37	0	1
+\.
+RESET timescaledb.max_open_chunks_per_insert;
+SELECT * FROM hyper_invals;
+DELETE FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log;
+
+-- ON CONFLICT DO NOTHING only logs the inserted tuples, which is what the
+-- trigger does
+CREATE UNIQUE INDEX conditions_time_device ON conditions(time, device);
+INSERT INTO conditions VALUES (33, 1, 0) ON CONFLICT DO NOTHING;
+SELECT * FROM hyper_invals;
+INSERT INTO conditions VALUES (11, 1, 0), (44, 1, 0), (55, 1, 0) ON CONFLICT DO NOTHING;
+SELECT * FROM hyper_invals;
+DELETE FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log;
+INSERT INTO conditions VALUES (12, 0, 0) ON CONFLICT (time, device) DO UPDATE SET value = 1;
+SELECT * FROM hyper_invals;
+DELETE FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log;
+
+-- the trigger does not fire for replicated changes, and neither do we
+SET session_replication_role = replica;
+INSERT INTO conditions VALUES (66, 0, 1);
+COPY conditions FROM STDIN;
+68	0	1
+\.
+RESET session_replication_role;
+SELECT * FROM hyper_invals;
+SELECT count(*) FROM conditions WHERE time IN (66, 68);
+
+-- UPDATE and DELETE still go through the trigger
+UPDATE conditions SET value = 2 WHERE time = 77;
+DELETE FROM conditions WHERE time = 8;
+SELECT * FROM hyper_invals;
+
+-- A refresh moves the invalidation threshold forward in the catalog and in
+-- the shared memory, where the inserts read it
+CALL refresh_continuous_aggregate('cond_10', 0, 200);
+SELECT watermark FROM _timescaledb_catalog.continuous_aggs_invalidation_threshold
+WHERE hypertable_id = 1;
+SELECT * FROM hyper_invals;
+INSERT INTO conditions VALUES (160, 0, 1);
+SELECT * FROM hyper_invals;
+DELETE FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log;
+-- the cached threshold is used instead of the one in the catalog
+UPDATE _timescaledb_catalog.continuous_aggs_invalidation_threshold
+SET watermark = 100
+WHERE hypertable_id = 1;
+INSERT INTO conditions VALUES (170, 0, 1);
+SELECT * FROM hyper_invals;
+DELETE FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log;
+-- dropping the last continuous aggregate of the hypertable also removes the
+-- cached threshold
+SET client_min_messages TO error;
+DROP MATERIALIZED VIEW cond_10;
+RESET client_min_messages;
+CREATE MATERIALIZED VIEW cond_10
+WITH (timescaledb.continuous, timescaledb.materialized_only = true) AS
+SELECT time_bucket(10, time) AS bucket, device, sum(value)
+FROM conditions
+GROUP BY 1, 2 WITH NO DATA;
+INSERT INTO conditions VALUES (180, 0, 1);
+SELECT * FROM hyper_invals;
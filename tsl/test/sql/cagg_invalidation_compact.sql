@@ -0,0 +1,60 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT _timescaledb_internal.stop_background_workers();
+
+CREATE TABLE compacted(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('compacted', 'time', chunk_time_interval => 100);
+CREATE FUNCTION compacted_now() RETURNS int LANGUAGE SQL STABLE AS
+$$ SELECT coalesce(max(time), 0) FROM compacted $$;
+SELECT set_integer_now_func('compacted', 'compacted_now');
+INSERT INTO compacted SELECT t, t FROM generate_series(0, 299) t;
+
+CREATE MATERIALIZED VIEW compacted_10
+WITH (timescaledb.continuous, timescaledb.materialized_only = true) AS
+SELECT time_bucket(10, time) AS bucket, count(*), sum(value)
+FROM compacted GROUP BY 1 WITH NO DATA;
+CREATE MATERIALIZED VIEW compacted_20
+WITH (timescaledb.continuous, timescaledb.materialized_only = true) AS
+SELECT time_bucket(20, time) AS bucket, count(*), sum(value)
+FROM compacted GROUP BY 1 WITH NO DATA;
+CALL refresh_continuous_aggregate('compacted_10', 0, 300);
+CALL refresh_continuous_aggregate('compacted_20', 0, 300);
+
+CREATE VIEW cagg_invals AS
+SELECT ca.user_view_name AS cagg, l.lowest_modified_value AS start, l.greatest_modified_value AS end
+FROM _timescaledb_catalog.continuous_aggs_materialization_invalidation_log l
+JOIN _timescaledb_catalog.continuous_agg ca ON ca.mat_hypertable_id = l.materialization_id
+WHERE l.lowest_modified_value >= 0 AND l.greatest_modified_value < 300
+ORDER BY 1, 2;
+
+-- Every transaction logs its own invalidation, and the overlapping and
+-- adjacent ones are merged before they are moved to the logs of the
+-- continuous aggregates
+INSERT INTO compacted VALUES (5, 1), (15, 1);
+INSERT INTO compacted VALUES (12, 1), (30, 1);
+INSERT INTO compacted VALUES (31, 1);
+INSERT INTO compacted VALUES (100, 1);
+INSERT INTO compacted VALUES (90, 1), (99, 1);
+INSERT INTO compacted VALUES (200, 1);
+SELECT count(*) FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log;
+CALL refresh_continuous_aggregate('compacted_10', 0, 50);
+SELECT count(*) FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log;
+SELECT * FROM cagg_invals;
+
+CALL refresh_continuous_aggregate('compacted_10', 0, 300);
+CALL refresh_continuous_aggregate('compacted_20', 0, 300);
+SELECT * FROM cagg_invals;
+SELECT count(*) FROM (
+    (SELECT * FROM compacted_20
+     EXCEPT
+     SELECT time_bucket(20, time), count(*), sum(value) FROM compacted WHERE time < 300 GROUP BY 1)
+    UNION ALL
+    (SELECT * FROM compacted_10
+     EXCEPT
+     SELECT time_bucket(10, time), count(*), sum(value) FROM compacted WHERE time < 300 GROUP BY 1)) d;
+SELECT * FROM compacted_20 WHERE bucket IN (0, 20, 80, 200) ORDER BY 1;
+
+DROP VIEW cagg_invals;
@@ -0,0 +1,68 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT _timescaledb_internal.stop_background_workers();
+
+CREATE TABLE sparse(time int NOT NULL, value float);
+SELECT table_name FROM create_hypertable('sparse', 'time', chunk_time_interval => 100);
+CREATE FUNCTION sparse_now() RETURNS int LANGUAGE SQL STABLE AS
+$$ SELECT coalesce(max(time), 0) FROM sparse $$;
+SELECT set_integer_now_func('sparse', 'sparse_now');
+INSERT INTO sparse SELECT t, t FROM generate_series(0, 299) t;
+
+CREATE MATERIALIZED VIEW sparse_10
+WITH (timescaledb.continuous, timescaledb.materialized_only = true) AS
+SELECT time_bucket(10, time) AS bucket, count(*), sum(value)
+FROM sparse GROUP BY 1 WITH NO DATA;
+CALL refresh_continuous_aggregate('sparse_10', 0, 300);
+
+CREATE VIEW hyper_invals AS
+SELECT lowest_modified_value AS start, greatest_modified_value AS end
+FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log
+ORDER BY 1, 2;
+
+-- By default, a transaction invalidates everything between its modifications
+BEGIN;
+INSERT INTO sparse VALUES (5, 1), (56, 1), (57, 1), (153, 1), (271, 1);
+COMMIT;
+SELECT * FROM hyper_invals;
+CALL refresh_continuous_aggregate('sparse_10', 0, 300);
+
+-- With more ranges, only the buckets that were modified are invalidated, and
+-- the closest ranges are coalesced
+SET timescaledb.cagg_max_invalidation_ranges TO 3;
+BEGIN;
+INSERT INTO sparse VALUES (5, 1), (56, 1), (57, 1), (153, 1), (271, 1);
+COMMIT;
+SELECT * FROM hyper_invals;
+CALL refresh_continuous_aggregate('sparse_10', 0, 300);
+
+-- The ranges of all the modifications in the transaction are merged, and the
+-- ranges above the invalidation threshold are not logged
+SET timescaledb.cagg_max_invalidation_ranges TO 64;
+BEGIN;
+INSERT INTO sparse VALUES (5, 1), (56, 1), (57, 1), (153, 1), (271, 1);
+DELETE FROM sparse WHERE time = 123;
+UPDATE sparse SET value = value + 1 WHERE time = 58;
+INSERT INTO sparse VALUES (340, 1);
+COMMIT;
+SELECT * FROM hyper_invals;
+CALL refresh_continuous_aggregate('sparse_10', 0, 300);
+SELECT * FROM hyper_invals;
+
+-- The continuous aggregate is up to date with the raw data
+SELECT count(*) FROM (
+    (SELECT * FROM sparse_10
+     EXCEPT
+     SELECT time_bucket(10, time), count(*), sum(value) FROM sparse WHERE time < 300 GROUP BY 1)
+    UNION ALL
+    (SELECT time_bucket(10, time), count(*), sum(value) FROM sparse WHERE time < 300 GROUP BY 1
+     EXCEPT
+     SELECT * FROM sparse_10)
+) diff;
+SELECT * FROM sparse_10 WHERE bucket IN (0, 50, 120, 150, 270) ORDER BY 1;
+
+RESET timescaledb.cagg_max_invalidation_ranges;
+DROP VIEW hyper_invals;
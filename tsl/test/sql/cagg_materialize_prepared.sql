@@ -0,0 +1,79 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT _timescaledb_internal.stop_background_workers();
+
+CREATE TABLE readings(time timestamptz NOT NULL, device int, temp float);
+SELECT table_name FROM create_hypertable('readings', 'time', chunk_time_interval => interval '1 day');
+INSERT INTO readings
+SELECT t, d, extract(hour FROM t AT TIME ZONE 'UTC') + d
+FROM generate_series('2023-01-01 00:00 UTC'::timestamptz, '2023-01-10 23:00 UTC', '1 hour') t,
+     generate_series(1, 3) d;
+
+CREATE MATERIALIZED VIEW readings_1h
+WITH (timescaledb.continuous, timescaledb.materialized_only = true) AS
+SELECT time_bucket('1 hour', time) AS bucket, device, avg(temp), count(*)
+FROM readings GROUP BY 1, 2 WITH NO DATA;
+CREATE MATERIALIZED VIEW readings_1d
+WITH (timescaledb.continuous, timescaledb.materialized_only = true) AS
+SELECT time_bucket('1 day', time) AS bucket, max(temp), count(*)
+FROM readings GROUP BY 1 WITH NO DATA;
+
+SELECT mat_hypertable_id AS "MAT_ID_1H", format('%I.%I', h.schema_name, h.table_name) AS "MAT_TABLE_1H"
+FROM _timescaledb_catalog.continuous_agg ca
+JOIN _timescaledb_catalog.hypertable h ON h.id = ca.mat_hypertable_id
+WHERE user_view_name = 'readings_1h' \gset
+SELECT mat_hypertable_id AS "MAT_ID_1D"
+FROM _timescaledb_catalog.continuous_agg WHERE user_view_name = 'readings_1d' \gset
+
+-- The differences between the continuous aggregates and their queries on the
+-- raw data before the given time
+CREATE FUNCTION cagg_diff(before timestamptz) RETURNS TABLE(cagg text, rows bigint)
+LANGUAGE SQL AS $$
+    SELECT 'readings_1h', count(*) FROM (
+        (SELECT * FROM readings_1h WHERE bucket < before
+         EXCEPT
+         SELECT time_bucket('1 hour', time), device, avg(temp), count(*)
+         FROM readings WHERE time < before GROUP BY 1, 2)
+        UNION ALL
+        (SELECT time_bucket('1 hour', time), device, avg(temp), count(*)
+         FROM readings WHERE time < before GROUP BY 1, 2
+         EXCEPT
+         SELECT * FROM readings_1h WHERE bucket < before)) d
+    UNION ALL
+    SELECT 'readings_1d', count(*) FROM (
+        (SELECT * FROM readings_1d WHERE bucket < before
+         EXCEPT
+         SELECT time_bucket('1 day', time), max(temp), count(*)
+         FROM readings WHERE time < before GROUP BY 1)
+        UNION ALL
+        (SELECT time_bucket('1 day', time), max(temp), count(*)
+         FROM readings WHERE time < before GROUP BY 1
+         EXCEPT
+         SELECT * FROM readings_1d WHERE bucket < before)) d
+$$;
+
+-- The materialization statements are prepared once and reused for the
+-- following ranges and refreshes, also when refreshing another continuous
+-- aggregate in between
+CALL refresh_continuous_aggregate('readings_1h', '2023-01-01 UTC', '2023-01-04 UTC');
+CALL refresh_continuous_aggregate('readings_1d', '2023-01-01 UTC', '2023-01-04 UTC');
+CALL refresh_continuous_aggregate('readings_1h', '2023-01-04 UTC', '2023-01-08 UTC');
+SELECT * FROM cagg_diff('2023-01-08 UTC');
+SELECT _timescaledb_functions.to_timestamp(_timescaledb_internal.cagg_watermark(:MAT_ID_1H)) = '2023-01-08 UTC' AS watermark;
+SELECT _timescaledb_functions.to_timestamp(_timescaledb_internal.cagg_watermark(:MAT_ID_1D)) = '2023-01-04 UTC' AS watermark;
+
+-- The plans are revalidated when the materialization hypertable changes
+CREATE INDEX ON :MAT_TABLE_1H (avg);
+INSERT INTO readings VALUES ('2023-01-02 10:30 UTC', 1, 100), ('2023-01-06 10:30 UTC', 2, 100);
+DELETE FROM readings WHERE time = '2023-01-05 03:00 UTC' AND device = 3;
+CALL refresh_continuous_aggregate('readings_1h', '2023-01-01 UTC', '2023-01-11 UTC');
+CALL refresh_continuous_aggregate('readings_1d', '2023-01-01 UTC', '2023-01-11 UTC');
+SELECT * FROM cagg_diff('2023-01-11 UTC');
+SELECT _timescaledb_functions.to_timestamp(_timescaledb_internal.cagg_watermark(:MAT_ID_1H)) = '2023-01-11 UTC' AS watermark;
+SELECT _timescaledb_functions.to_timestamp(_timescaledb_internal.cagg_watermark(:MAT_ID_1D)) = '2023-01-11 UTC' AS watermark;
+SELECT count(*) AS rows, sum(count) AS raw_rows FROM readings_1h;
+
+DROP FUNCTION cagg_diff(timestamptz);
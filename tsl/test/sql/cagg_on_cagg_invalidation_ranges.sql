@@ -0,0 +1,48 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT _timescaledb_internal.stop_background_workers();
+
+CREATE TABLE hier(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('hier', 'time', chunk_time_interval => 100);
+CREATE FUNCTION hier_now() RETURNS int LANGUAGE SQL STABLE AS
+$$ SELECT coalesce(max(time), 0) FROM hier $$;
+SELECT set_integer_now_func('hier', 'hier_now');
+INSERT INTO hier SELECT t, t FROM generate_series(0, 299) t;
+
+CREATE MATERIALIZED VIEW hier_10
+WITH (timescaledb.continuous, timescaledb.materialized_only = true) AS
+SELECT time_bucket(10, time) AS bucket, count(*), sum(value)
+FROM hier GROUP BY 1 WITH NO DATA;
+CREATE MATERIALIZED VIEW hier_50
+WITH (timescaledb.continuous, timescaledb.materialized_only = true) AS
+SELECT time_bucket(50, bucket) AS bucket, sum(count) AS count, sum(sum) AS sum
+FROM hier_10 GROUP BY 1 WITH NO DATA;
+CALL refresh_continuous_aggregate('hier_10', 0, 300);
+CALL refresh_continuous_aggregate('hier_50', 0, 300);
+SELECT mat_hypertable_id AS "MAT_ID_10" FROM _timescaledb_catalog.continuous_agg
+WHERE user_view_name = 'hier_10' \gset
+
+-- A refresh of the lower continuous aggregate that materializes separate
+-- ranges only invalidates the buckets of the upper continuous aggregate that
+-- cover them, also with a single invalidation range per transaction
+SHOW timescaledb.cagg_max_invalidation_ranges;
+INSERT INTO hier VALUES (5, 1000);
+INSERT INTO hier VALUES (255, 1000);
+CALL refresh_continuous_aggregate('hier_10', 0, 300);
+SELECT lowest_modified_value AS start, greatest_modified_value AS end
+FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log
+WHERE hypertable_id = :MAT_ID_10 ORDER BY 1;
+
+CALL refresh_continuous_aggregate('hier_50', 0, 300);
+SELECT count(*) FROM (
+    (SELECT * FROM hier_50
+     EXCEPT
+     SELECT time_bucket(50, time), count(*), sum(value) FROM hier GROUP BY 1)
+    UNION ALL
+    (SELECT time_bucket(50, time), count(*), sum(value) FROM hier GROUP BY 1
+     EXCEPT
+     SELECT * FROM hier_50)) d;
+SELECT * FROM hier_50 WHERE bucket IN (0, 250) ORDER BY 1;
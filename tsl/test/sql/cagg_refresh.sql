@@ -311,3 +311,12 @@ SELECT time_bucket('7 days', time) AS day, device, avg(temp) AS avg_temp
 FROM conditions
 GROUP BY 1,2 WITH NO DATA;
 COMMIT;
+
+-- With diff materialization, a refresh only deletes and inserts the
+-- rows of the changed buckets
+SET timescaledb.enable_cagg_diff_materialization = true;
+INSERT INTO conditions VALUES ('2020-05-03 12:00 UTC', 1, 100.0);
+SET client_min_messages TO LOG;
+CALL refresh_continuous_aggregate('daily_temp', '2020-05-02 00:00 UTC', '2020-05-05 00:00 UTC');
+RESET client_min_messages;
+RESET timescaledb.enable_cagg_diff_materialization;
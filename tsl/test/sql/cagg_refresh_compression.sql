@@ -0,0 +1,64 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT _timescaledb_internal.stop_background_workers();
+
+CREATE TABLE backfilled(time timestamptz NOT NULL, value float);
+SELECT table_name FROM create_hypertable('backfilled', 'time', chunk_time_interval => interval '7 days');
+INSERT INTO backfilled
+SELECT t, 1 FROM generate_series('2020-01-01 UTC'::timestamptz, '2020-02-29 23:00 UTC', '1 hour') t;
+
+CREATE MATERIALIZED VIEW backfilled_1d
+WITH (timescaledb.continuous, timescaledb.materialized_only = true) AS
+SELECT time_bucket('1 day', time) AS bucket, count(*), sum(value)
+FROM backfilled GROUP BY 1 WITH NO DATA;
+ALTER MATERIALIZED VIEW backfilled_1d SET (timescaledb.compress = true);
+SELECT add_continuous_aggregate_policy('backfilled_1d', start_offset => interval '20 days',
+    end_offset => interval '1 day', schedule_interval => interval '1 hour') IS NOT NULL AS added;
+SELECT add_compression_policy('backfilled_1d', compress_after => interval '30 days') IS NOT NULL AS added;
+
+CREATE VIEW backfilled_chunks AS
+SELECT count(*) FILTER (WHERE c.status & 1 > 0) = count(*) AS all_compressed,
+    count(*) FILTER (WHERE c.status & 8 > 0) AS partial
+FROM show_chunks('backfilled_1d') ch
+JOIN _timescaledb_catalog.chunk c ON format('%I.%I', c.schema_name, c.table_name)::regclass = ch;
+CREATE VIEW backfilled_diff AS
+SELECT count(*) FROM (
+    (SELECT * FROM backfilled_1d
+     EXCEPT
+     SELECT time_bucket('1 day', time), count(*), sum(value) FROM backfilled GROUP BY 1)
+    UNION ALL
+    (SELECT time_bucket('1 day', time), count(*), sum(value) FROM backfilled GROUP BY 1
+     EXCEPT
+     SELECT * FROM backfilled_1d)) d;
+
+CALL refresh_continuous_aggregate('backfilled_1d', NULL, '2020-03-01 UTC');
+SELECT count(compress_chunk(ch)) > 0 AS compressed FROM show_chunks('backfilled_1d') ch;
+SELECT * FROM backfilled_chunks;
+
+-- By default, a refresh of a compressed window leaves the chunk partially compressed
+INSERT INTO backfilled VALUES ('2020-01-15 10:30 UTC', 1);
+CALL refresh_continuous_aggregate('backfilled_1d', NULL, '2020-03-01 UTC');
+SELECT * FROM backfilled_chunks;
+SELECT * FROM backfilled_diff;
+
+-- With the setting, the refresh recompresses the refreshed chunks that are
+-- older than the compress_after of the compression policy
+SET timescaledb.enable_cagg_refresh_compression TO on;
+INSERT INTO backfilled VALUES ('2020-01-16 10:30 UTC', 1);
+CALL refresh_continuous_aggregate('backfilled_1d', NULL, '2020-03-01 UTC');
+SELECT * FROM backfilled_chunks;
+SELECT * FROM backfilled_diff;
+SELECT count, sum FROM backfilled_1d WHERE bucket = '2020-01-16 UTC';
+
+-- New chunks of the refreshed window are compressed too
+INSERT INTO backfilled VALUES ('2019-06-01 UTC', 1);
+CALL refresh_continuous_aggregate('backfilled_1d', NULL, '2020-03-01 UTC');
+SELECT * FROM backfilled_chunks;
+SELECT * FROM backfilled_diff;
+RESET timescaledb.enable_cagg_refresh_compression;
+
+DROP VIEW backfilled_chunks;
+DROP VIEW backfilled_diff;
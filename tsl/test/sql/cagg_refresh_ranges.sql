@@ -0,0 +1,60 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT _timescaledb_internal.stop_background_workers();
+
+CREATE TABLE backfill(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('backfill', 'time', chunk_time_interval => 100);
+CREATE FUNCTION backfill_now() RETURNS int LANGUAGE SQL STABLE AS
+$$ SELECT coalesce(max(time), 0) FROM backfill $$;
+SELECT set_integer_now_func('backfill', 'backfill_now');
+INSERT INTO backfill SELECT t, t FROM generate_series(0, 499) t;
+
+CREATE MATERIALIZED VIEW backfill_10
+WITH (timescaledb.continuous, timescaledb.materialized_only = true) AS
+SELECT time_bucket(10, time) AS bucket, count(*), sum(value)
+FROM backfill GROUP BY 1 WITH NO DATA;
+CALL refresh_continuous_aggregate('backfill_10', 0, 500);
+
+CREATE FUNCTION cagg_diff() RETURNS bigint LANGUAGE SQL AS $$
+    SELECT count(*) FROM (
+        (SELECT * FROM backfill_10
+         EXCEPT
+         SELECT time_bucket(10, time), count(*), sum(value) FROM backfill WHERE time < 500 GROUP BY 1)
+        UNION ALL
+        (SELECT time_bucket(10, time), count(*), sum(value) FROM backfill WHERE time < 500 GROUP BY 1
+         EXCEPT
+         SELECT * FROM backfill_10)) d
+$$;
+CREATE VIEW cagg_invals AS
+SELECT count(*) FROM _timescaledb_catalog.continuous_aggs_materialization_invalidation_log
+WHERE lowest_modified_value >= 0 AND greatest_modified_value < 500;
+
+-- A sparse backfill leaves more disjoint invalidated ranges than a single
+-- materialization statement takes, and the refresh materializes all of them
+SET timescaledb.cagg_max_invalidation_ranges TO 64;
+BEGIN;
+INSERT INTO backfill SELECT t + 5, 1000 FROM generate_series(0, 399, 20) t;
+DELETE FROM backfill WHERE time = 493;
+COMMIT;
+SELECT count(*) FROM _timescaledb_catalog.continuous_aggs_hypertable_invalidation_log;
+SELECT cagg_diff();
+CALL refresh_continuous_aggregate('backfill_10', 0, 500);
+SELECT cagg_diff();
+SELECT * FROM cagg_invals;
+SELECT * FROM backfill_10 WHERE bucket IN (0, 10, 380, 490) ORDER BY 1;
+
+-- A refresh window that covers only some of the ranges
+BEGIN;
+UPDATE backfill SET value = value + 1 WHERE time % 50 = 7;
+COMMIT;
+CALL refresh_continuous_aggregate('backfill_10', 100, 300);
+SELECT cagg_diff();
+CALL refresh_continuous_aggregate('backfill_10', 0, 500);
+SELECT cagg_diff();
+
+RESET timescaledb.cagg_max_invalidation_ranges;
+DROP VIEW cagg_invals;
+DROP FUNCTION cagg_diff();
@@ -0,0 +1,119 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- Check if the query reads a continuous aggregate instead of the hypertable
+CREATE FUNCTION uses_cagg(query text) RETURNS boolean LANGUAGE plpgsql AS
+$$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (costs off) ' || query LOOP
+        IF line ~ '_materialized_hypertable_' THEN
+            RETURN true;
+        END IF;
+    END LOOP;
+    RETURN false;
+END
+$$;
+
+CREATE TABLE metrics(time int NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 10);
+CREATE FUNCTION metrics_now() RETURNS int LANGUAGE SQL STABLE AS 'SELECT coalesce(max(time), 0) FROM metrics';
+SELECT set_integer_now_func('metrics', 'metrics_now');
+INSERT INTO metrics SELECT x, x % 2, x FROM generate_series(0, 39) x;
+
+CREATE MATERIALIZED VIEW metrics_10
+WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+SELECT time_bucket(10, time) AS bucket, device, sum(value) AS total, count(*) AS n
+FROM metrics
+GROUP BY 1, 2 WITH NO DATA;
+CALL refresh_continuous_aggregate('metrics_10', NULL, 30);
+SET timescaledb.enable_cagg_rewrite TO on;
+
+-- the groups of the query are the rows of the continuous aggregate
+SELECT uses_cagg('SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2');
+SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2;
+SELECT uses_cagg('SELECT device, time_bucket(10, time), count(*), sum(value) * 2 FROM metrics GROUP BY device, time_bucket(10, time)');
+SELECT uses_cagg('SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 HAVING sum(value) > 100 ORDER BY 1, 2');
+SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 HAVING sum(value) > 100 ORDER BY 1, 2;
+
+-- a WHERE clause, a different grouping or other aggregates are not rewritten
+SELECT uses_cagg('SELECT time_bucket(10, time), device, sum(value) FROM metrics WHERE device = 0 GROUP BY 1, 2');
+SELECT uses_cagg('SELECT time_bucket(10, time), sum(value) FROM metrics GROUP BY 1');
+SELECT uses_cagg('SELECT time_bucket(10, time), device, max(value) FROM metrics GROUP BY 1, 2');
+SELECT uses_cagg('SELECT time_bucket(10, time), device, sum(value), value FROM metrics GROUP BY 1, 2, 4');
+SET timescaledb.enable_cagg_rewrite TO off;
+SELECT uses_cagg('SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2');
+SET timescaledb.enable_cagg_rewrite TO on;
+
+-- the rewritten query sees the materialized data, so it only returns the same
+-- as the hypertable after a refresh
+INSERT INTO metrics VALUES (5, 0, 100);
+SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2 LIMIT 2;
+SET timescaledb.enable_cagg_rewrite TO off;
+SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2 LIMIT 2;
+SET timescaledb.enable_cagg_rewrite TO on;
+CALL refresh_continuous_aggregate('metrics_10', NULL, 30);
+SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2 LIMIT 2;
+-- the data above the watermark comes from the real-time part of the view
+INSERT INTO metrics VALUES (35, 1, 1000);
+SELECT uses_cagg('SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2');
+SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2;
+
+-- materialized only continuous aggregates are not rewritten
+ALTER MATERIALIZED VIEW metrics_10 SET (timescaledb.materialized_only = true);
+SELECT uses_cagg('SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2');
+ALTER MATERIALIZED VIEW metrics_10 SET (timescaledb.materialized_only = false);
+SELECT uses_cagg('SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2');
+
+-- neither are the continuous aggregates in the old format
+CREATE MATERIALIZED VIEW metrics_20_old
+WITH (timescaledb.continuous, timescaledb.materialized_only = false, timescaledb.finalized = false) AS
+SELECT time_bucket(20, time) AS bucket, device, sum(value) AS total
+FROM metrics
+GROUP BY 1, 2 WITH NO DATA;
+SELECT uses_cagg('SELECT time_bucket(20, time), device, sum(value) FROM metrics GROUP BY 1, 2');
+CREATE MATERIALIZED VIEW metrics_20
+WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+SELECT time_bucket(20, time) AS bucket, device, sum(value) AS total
+FROM metrics
+GROUP BY 1, 2 WITH NO DATA;
+SELECT uses_cagg('SELECT time_bucket(20, time), device, sum(value) FROM metrics GROUP BY 1, 2');
+
+-- the user needs SELECT on the continuous aggregate, otherwise the query reads
+-- the hypertable
+GRANT SELECT ON metrics TO :ROLE_DEFAULT_PERM_USER;
+SET ROLE :ROLE_DEFAULT_PERM_USER;
+SELECT uses_cagg('SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2');
+SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2 LIMIT 2;
+RESET ROLE;
+GRANT SELECT ON metrics_10 TO :ROLE_DEFAULT_PERM_USER;
+SET ROLE :ROLE_DEFAULT_PERM_USER;
+SELECT uses_cagg('SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2');
+SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2 LIMIT 2;
+-- and the permissions on the hypertable are still checked
+RESET ROLE;
+REVOKE SELECT ON metrics FROM :ROLE_DEFAULT_PERM_USER;
+SET ROLE :ROLE_DEFAULT_PERM_USER;
+\set ON_ERROR_STOP 0
+SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2;
+\set ON_ERROR_STOP 1
+RESET ROLE;
+GRANT SELECT ON metrics TO :ROLE_DEFAULT_PERM_USER;
+
+-- the row security policies of the hypertable would not apply to the
+-- continuous aggregate
+CREATE POLICY device_0 ON metrics FOR SELECT USING (device = 0);
+ALTER TABLE metrics ENABLE ROW LEVEL SECURITY;
+SET ROLE :ROLE_DEFAULT_PERM_USER;
+SELECT uses_cagg('SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2');
+SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2;
+RESET ROLE;
+ALTER TABLE metrics DISABLE ROW LEVEL SECURITY;
+DROP POLICY device_0 ON metrics;
+SET ROLE :ROLE_DEFAULT_PERM_USER;
+SELECT uses_cagg('SELECT time_bucket(10, time) AS bucket, device, sum(value) FROM metrics GROUP BY 1, 2 ORDER BY 1, 2');
+RESET ROLE;
@@ -0,0 +1,48 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT _timescaledb_internal.stop_background_workers();
+
+CREATE TABLE marks(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('marks', 'time', chunk_time_interval => 50);
+CREATE FUNCTION marks_now() RETURNS int LANGUAGE SQL STABLE AS
+$$ SELECT coalesce(max(time), 0) FROM marks $$;
+SELECT set_integer_now_func('marks', 'marks_now');
+INSERT INTO marks SELECT t, t FROM generate_series(0, 199) t;
+
+CREATE MATERIALIZED VIEW marks_10
+WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+SELECT time_bucket(10, time) AS bucket, count(*), sum(value)
+FROM marks GROUP BY 1 WITH NO DATA;
+CREATE MATERIALIZED VIEW marks_20
+WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+SELECT time_bucket(20, time) AS bucket, count(*), sum(value)
+FROM marks GROUP BY 1 WITH NO DATA;
+CALL refresh_continuous_aggregate('marks_10', 0, 100);
+CALL refresh_continuous_aggregate('marks_20', 0, 60);
+SELECT
+    (SELECT mat_hypertable_id FROM _timescaledb_catalog.continuous_agg WHERE user_view_name = 'marks_10') AS "MAT_ID_10",
+    (SELECT mat_hypertable_id FROM _timescaledb_catalog.continuous_agg WHERE user_view_name = 'marks_20') AS "MAT_ID_20" \gset
+
+-- The watermarks of the continuous aggregates of a query are cached
+-- together, so the calls for one don't evict the watermark of the other
+SELECT _timescaledb_internal.cagg_watermark(:MAT_ID_10) AS w10_1,
+    _timescaledb_internal.cagg_watermark(:MAT_ID_20) AS w20_1,
+    _timescaledb_internal.cagg_watermark(:MAT_ID_10) AS w10_2,
+    _timescaledb_internal.cagg_watermark(:MAT_ID_20) AS w20_2;
+
+-- A join of the real-time continuous aggregates uses the right watermark for each
+SELECT count(*), sum(a.count) AS count_10, sum(a.sum) AS sum_10, sum(b.count) AS count_20, sum(b.sum) AS sum_20
+FROM marks_10 a JOIN marks_20 b ON a.bucket = b.bucket;
+
+-- The watermarks are read again in the next command of the transaction
+BEGIN;
+SELECT _timescaledb_internal.cagg_watermark(:MAT_ID_10) AS w10,
+    _timescaledb_internal.cagg_watermark(:MAT_ID_20) AS w20;
+DELETE FROM _timescaledb_catalog.continuous_aggs_watermark WHERE mat_hypertable_id = :MAT_ID_20;
+INSERT INTO _timescaledb_catalog.continuous_aggs_watermark VALUES (:MAT_ID_20, 40);
+SELECT _timescaledb_internal.cagg_watermark(:MAT_ID_10) AS w10,
+    _timescaledb_internal.cagg_watermark(:MAT_ID_20) AS w20;
+ROLLBACK;
@@ -0,0 +1,105 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE FUNCTION scanned_chunks(query text) RETURNS SETOF text LANGUAGE plpgsql AS
+$$
+DECLARE
+    line text;
+    chunk text;
+    seen text[] = '{}';
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (costs off) ' || query LOOP
+        chunk := substring(line from ' on (_hyper_[0-9]+_[0-9]+_chunk)');
+        IF chunk IS NOT NULL AND NOT chunk = ANY(seen) THEN
+            seen := seen || chunk;
+            RETURN NEXT chunk;
+        END IF;
+    END LOOP;
+END;
+$$;
+
+CREATE VIEW chunk_ranges AS
+SELECT chunk_id, column_name, range_start, range_end, valid
+FROM _timescaledb_catalog.chunk_column_stats ORDER BY chunk_id, column_name;
+
+CREATE TABLE sensors(time timestamptz NOT NULL, device int, reading int);
+SELECT table_name FROM create_hypertable('sensors', 'time', chunk_time_interval => interval '1 day');
+ALTER TABLE sensors SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+
+\set ON_ERROR_STOP 0
+SELECT enable_chunk_skipping('sensors', 'time');
+SELECT enable_chunk_skipping('sensors', 'missing');
+\set ON_ERROR_STOP 1
+
+SELECT enable_chunk_skipping('sensors', 'reading');
+
+-- two chunks with the readings 0 to 23 and 24 to 47
+INSERT INTO sensors SELECT '2023-01-01 00:00:00+00'::timestamptz + x * interval '1 hour', x % 2, x
+FROM generate_series(0, 47) x;
+SELECT count(compress_chunk(c)) FROM show_chunks('sensors') c;
+SELECT * FROM chunk_ranges;
+
+-- the chunks outside of the range of the restriction are skipped
+SELECT scanned_chunks('SELECT * FROM sensors WHERE reading < 10');
+SELECT scanned_chunks('SELECT * FROM sensors WHERE reading > 30');
+SELECT scanned_chunks('SELECT * FROM sensors WHERE reading BETWEEN 20 AND 30');
+SELECT count(*) FROM sensors WHERE reading < 10;
+SELECT count(*) FROM sensors WHERE reading > 30;
+
+SET timescaledb.enable_chunk_skipping TO off;
+SELECT scanned_chunks('SELECT * FROM sensors WHERE reading < 10');
+RESET timescaledb.enable_chunk_skipping;
+
+-- an insert into a compressed chunk makes it partial and its ranges invalid
+INSERT INTO sensors VALUES ('2023-01-01 12:30:00+00', 0, 40);
+SELECT * FROM chunk_ranges;
+SELECT scanned_chunks('SELECT * FROM sensors WHERE reading > 30');
+SELECT count(*) FROM sensors WHERE reading > 30;
+
+-- compressing the chunk again computes its ranges
+SELECT decompress_chunk('_timescaledb_internal._hyper_1_1_chunk');
+SELECT compress_chunk('_timescaledb_internal._hyper_1_1_chunk');
+SELECT * FROM chunk_ranges;
+
+-- the direct inserts into the compressed chunk don't make it partial, but
+-- make its ranges invalid
+SET timescaledb.enable_direct_compress_insert TO on;
+INSERT INTO sensors VALUES ('2023-01-01 13:30:00+00', 1, 45);
+RESET timescaledb.enable_direct_compress_insert;
+SELECT status FROM _timescaledb_catalog.chunk WHERE id = 1;
+SELECT * FROM chunk_ranges;
+SELECT scanned_chunks('SELECT * FROM sensors WHERE reading > 42');
+SELECT count(*) FROM sensors WHERE reading > 42;
+
+-- merging another chunk into a chunk makes its ranges invalid
+SELECT decompress_chunk('_timescaledb_internal._hyper_1_1_chunk');
+SELECT compress_chunk('_timescaledb_internal._hyper_1_1_chunk');
+SELECT * FROM chunk_ranges;
+SELECT merge_chunks('_timescaledb_internal._hyper_1_1_chunk', '_timescaledb_internal._hyper_1_2_chunk');
+SELECT * FROM chunk_ranges;
+SELECT scanned_chunks('SELECT * FROM sensors WHERE reading > 45');
+SELECT count(*) FROM sensors WHERE reading > 45;
+
+-- dropping a tracked column removes its ranges
+ALTER TABLE sensors ADD COLUMN extra int;
+SELECT enable_chunk_skipping('sensors', 'extra');
+SELECT * FROM chunk_ranges;
+ALTER TABLE sensors DROP COLUMN extra;
+SELECT * FROM chunk_ranges;
+
+-- renaming a tracked column removes its ranges, so that they don't apply to
+-- another column that gets its name
+ALTER TABLE sensors RENAME COLUMN reading TO value;
+SELECT * FROM chunk_ranges;
+ALTER TABLE sensors ADD COLUMN reading int;
+SELECT count(*) FROM sensors WHERE reading IS NULL;
+SELECT enable_chunk_skipping('sensors', 'value');
+SELECT * FROM chunk_ranges;
+SELECT scanned_chunks('SELECT * FROM sensors WHERE value > 50');
+SELECT count(*) FROM sensors WHERE value > 45;
+
+SELECT disable_chunk_skipping('sensors', 'value');
+SELECT * FROM chunk_ranges;
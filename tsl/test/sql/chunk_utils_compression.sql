@@ -67,3 +67,22 @@ SELECT show_chunks(:'TABLENAME');
 SELECT drop_chunks(:'TABLENAME',now());
 \set ON_ERROR_STOP 1
 
+-- drop_chunks drops the compressed chunks of the dropped chunks with them
+CREATE TABLE batch_drop(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('batch_drop', 'time', chunk_time_interval => 10);
+ALTER TABLE batch_drop SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+INSERT INTO batch_drop SELECT t, t % 2, t FROM generate_series(0, 39) t;
+SELECT count(compress_chunk(c)) FROM show_chunks('batch_drop', older_than => 20) c;
+SELECT count(compress_chunk(c)) FROM show_chunks('batch_drop', newer_than => 30) c;
+SELECT h.id AS ht_id, c.id AS compressed_ht_id, format('%I.%I', c.schema_name, c.table_name) AS compressed_ht
+FROM _timescaledb_catalog.hypertable h
+JOIN _timescaledb_catalog.hypertable c ON c.id = h.compressed_hypertable_id
+WHERE h.table_name = 'batch_drop' \gset
+-- two compressed chunks and one uncompressed chunk
+SELECT count(*) FROM drop_chunks('batch_drop', older_than => 30);
+SELECT count(*) FROM _timescaledb_catalog.chunk WHERE hypertable_id = :compressed_ht_id;
+SELECT count(*) FROM pg_inherits WHERE inhparent = :'compressed_ht'::regclass;
+SELECT count(*) FROM _timescaledb_catalog.compression_chunk_size
+WHERE chunk_id IN (SELECT id FROM _timescaledb_catalog.chunk WHERE hypertable_id = :ht_id);
+SELECT count(*), min(time) FROM batch_drop;
+DROP TABLE batch_drop;
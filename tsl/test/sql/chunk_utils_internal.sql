@@ -375,6 +375,22 @@ INSERT INTO ht_try VALUES ('2022-06-05 01:00', 222, 222);
 \set ON_ERROR_STOP 1
 SELECT ts_undo_osm_hook();
 
+--TEST the OSM chunk is excluded by the range of its data once OSM sets it
+SELECT _timescaledb_functions.hypertable_osm_range_update('ht_try', '2020-01-01 00:00'::timestamptz, '2020-01-02 00:00'::timestamptz);
+EXPLAIN (COSTS OFF) SELECT * from ht_try WHERE timec > '2022-01-01 01:00';
+EXPLAIN (COSTS OFF) SELECT * from ht_try WHERE timec < '2021-01-01 01:00';
+SELECT * from ht_try WHERE timec < '2021-01-01 01:00' ORDER BY 1;
+-- the same range again changes nothing
+SELECT _timescaledb_functions.hypertable_osm_range_update('ht_try', '2020-01-01 00:00'::timestamptz, '2020-01-02 00:00'::timestamptz);
+\set ON_ERROR_STOP 0
+SELECT _timescaledb_functions.hypertable_osm_range_update('ht_try', '2022-01-01 00:00'::timestamptz, '2023-01-01 00:00'::timestamptz);
+SELECT _timescaledb_functions.hypertable_osm_range_update('ht_try', '2020-01-02 00:00'::timestamptz, '2020-01-01 00:00'::timestamptz);
+SELECT _timescaledb_functions.hypertable_osm_range_update('ht_try', 1, 2);
+\set ON_ERROR_STOP 1
+-- NULL restores the placeholder range, and the OSM chunk is always scanned again
+SELECT _timescaledb_functions.hypertable_osm_range_update('ht_try');
+SELECT * from ht_try WHERE timec < '2021-01-01 01:00' ORDER BY 1;
+
 -- TEST error have to be hypertable owner to attach a chunk to it
 \c :TEST_DBNAME :ROLE_DEFAULT_PERM_USER
 \set ON_ERROR_STOP 0
@@ -909,3 +909,143 @@ INSERT INTO ht_metrics_partially_compressed VALUES ('2020-01-01'::timestamptz, 1
 
 :explain
 SELECT * FROM ht_metrics_partially_compressed ORDER BY time DESC, device LIMIT 1;
+
+-- Test the toast compression method of the compressed columns
+CREATE TABLE toast_compression(time timestamptz NOT NULL, device int, message text);
+SELECT table_name FROM create_hypertable('toast_compression', 'time');
+ALTER TABLE toast_compression SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_toast_compression = 'pglz');
+-- The columns added later use the same method
+ALTER TABLE toast_compression ADD COLUMN extra text;
+INSERT INTO toast_compression SELECT '2020-01-01'::timestamptz + i * interval '1 minute', i % 2, repeat('message ' || i % 3, 100), 'extra' FROM generate_series(1, 100) i;
+SELECT count(compress_chunk(c)) FROM show_chunks('toast_compression') c;
+SELECT a.attname, a.attcompression, count(*) AS relations
+FROM pg_attribute a
+WHERE a.attrelid IN (
+    SELECT format('%I.%I', ht.schema_name, ht.table_name)::regclass
+    FROM _timescaledb_catalog.hypertable ht
+    JOIN _timescaledb_catalog.hypertable uht ON uht.compressed_hypertable_id = ht.id
+    WHERE uht.table_name = 'toast_compression'
+    UNION ALL
+    SELECT format('%I.%I', ch.schema_name, ch.table_name)::regclass
+    FROM _timescaledb_catalog.chunk ch
+    JOIN _timescaledb_catalog.hypertable uht ON uht.compressed_hypertable_id = ch.hypertable_id
+    WHERE uht.table_name = 'toast_compression')
+  AND a.attnum > 0 AND NOT a.attisdropped
+GROUP BY 1, 2 ORDER BY 1;
+SELECT count(*), count(DISTINCT message), count(extra) FROM toast_compression;
+-- The option is not allowed when disabling compression
+\set ON_ERROR_STOP 0
+ALTER TABLE toast_compression SET (timescaledb.compress = false, timescaledb.compress_toast_compression = 'pglz');
+\set ON_ERROR_STOP 1
+
+-- Test the compressed batch size
+CREATE TABLE batch_rows(time timestamptz NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('batch_rows', 'time');
+ALTER TABLE batch_rows SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+INSERT INTO batch_rows SELECT '2020-01-01'::timestamptz + i * interval '1 second', i % 2, i FROM generate_series(1, 20000) i;
+\set ON_ERROR_STOP 0
+SET timescaledb.compression_batch_rows = 20000;
+\set ON_ERROR_STOP 1
+SET timescaledb.compression_batch_rows = 4096;
+SELECT count(compress_chunk(c)) FROM show_chunks('batch_rows') c;
+RESET timescaledb.compression_batch_rows;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.hypertable uht ON uht.compressed_hypertable_id = ch.hypertable_id
+WHERE uht.table_name = 'batch_rows' \gset
+SELECT device, _ts_meta_count FROM :COMPRESSED_CHUNK ORDER BY device, _ts_meta_sequence_num;
+SELECT count(*), sum(value) FROM batch_rows;
+SELECT count(*) FROM batch_rows WHERE device = 0 AND value > 19990;
+
+-- decompress_chunk inserts the decompressed rows in groups and rebuilds the
+-- indexes at the end when the chunk is not partial
+CREATE TABLE decomp_bulk(time int NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('decomp_bulk', 'time', chunk_time_interval => 100000);
+CREATE INDEX decomp_bulk_device_idx ON decomp_bulk (device, time);
+ALTER TABLE decomp_bulk SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+INSERT INTO decomp_bulk SELECT t, t % 3, t FROM generate_series(1, 2500) t;
+SELECT count(compress_chunk(c)) FROM show_chunks('decomp_bulk') c;
+SELECT c AS "CHUNK" FROM show_chunks('decomp_bulk') c \gset
+SELECT count(decompress_chunk(c)) FROM show_chunks('decomp_bulk') c;
+SELECT count(*), sum(value) FROM :CHUNK;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*) FROM :CHUNK WHERE device = 1;
+SELECT count(*) FROM :CHUNK WHERE time > 2000;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+-- a partial chunk keeps its indexes and gets the decompressed rows inserted
+SELECT count(compress_chunk(c)) FROM show_chunks('decomp_bulk') c;
+INSERT INTO decomp_bulk SELECT t, t % 3, t FROM generate_series(2501, 2510) t;
+SELECT count(decompress_chunk(c)) FROM show_chunks('decomp_bulk') c;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*) FROM :CHUNK WHERE device = 1;
+SELECT count(*) FROM :CHUNK WHERE time > 2000;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+SELECT count(*), sum(value) FROM :CHUNK;
+DROP TABLE decomp_bulk;
+
+-- The chunk is sorted with a radix sort when all the segmentby and orderby
+-- columns are integers, and with a tuplesort when it doesn't fit in memory
+CREATE TABLE radix_sort(time int NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('radix_sort', 'time', chunk_time_interval => 1000000);
+ALTER TABLE radix_sort SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'value, time DESC');
+INSERT INTO radix_sort
+SELECT t, CASE WHEN t % 50 = 0 THEN NULL ELSE t % 5 - 2 END, t % 11 - 5 FROM generate_series(1, 50000) t;
+SELECT count(compress_chunk(c)) FROM show_chunks('radix_sort') c;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.hypertable uht ON uht.compressed_hypertable_id = ch.hypertable_id
+WHERE uht.table_name = 'radix_sort' \gset
+-- the batches of each segment follow each other in the orderby order
+SELECT count(*) FROM (
+    SELECT _ts_meta_max_1 > lead(_ts_meta_min_1) OVER (PARTITION BY device ORDER BY _ts_meta_sequence_num) AS unordered
+    FROM :COMPRESSED_CHUNK
+) s WHERE unordered;
+SELECT count(*), sum(value), count(DISTINCT device) FROM radix_sort;
+SELECT count(decompress_chunk(c)) FROM show_chunks('radix_sort') c;
+SET maintenance_work_mem = '1MB';
+SELECT count(compress_chunk(c)) FROM show_chunks('radix_sort') c;
+RESET maintenance_work_mem;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.hypertable uht ON uht.compressed_hypertable_id = ch.hypertable_id
+WHERE uht.table_name = 'radix_sort' \gset
+-- the batches of each segment follow each other in the orderby order
+SELECT count(*) FROM (
+    SELECT _ts_meta_max_1 > lead(_ts_meta_min_1) OVER (PARTITION BY device ORDER BY _ts_meta_sequence_num) AS unordered
+    FROM :COMPRESSED_CHUNK
+) s WHERE unordered;
+SELECT count(*), sum(value), count(DISTINCT device) FROM radix_sort;
+DROP TABLE radix_sort;
+
+-- The tuples of a new compressed chunk are inserted frozen, and the pages are
+-- all-visible without a vacuum from PG 14 on
+CREATE TABLE frozen(time int NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('frozen', 'time', chunk_time_interval => 100000);
+ALTER TABLE frozen SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+INSERT INTO frozen SELECT t, t % 2000, t FROM generate_series(1, 10000) t;
+SELECT count(compress_chunk(c)) FROM show_chunks('frozen') c;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.hypertable uht ON uht.compressed_hypertable_id = ch.hypertable_id
+WHERE uht.table_name = 'frozen' \gset
+ANALYZE :COMPRESSED_CHUNK;
+SELECT relpages > 1 AS pages,
+    relallvisible = relpages OR current_setting('server_version_num')::int < 140000 AS all_visible
+FROM pg_class WHERE oid = :'COMPRESSED_CHUNK'::regclass;
+SELECT count(decompress_chunk(c)) FROM show_chunks('frozen') c;
+SET timescaledb.enable_compression_freeze = off;
+SELECT count(compress_chunk(c)) FROM show_chunks('frozen') c;
+RESET timescaledb.enable_compression_freeze;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.hypertable uht ON uht.compressed_hypertable_id = ch.hypertable_id
+WHERE uht.table_name = 'frozen' \gset
+ANALYZE :COMPRESSED_CHUNK;
+SELECT relpages > 1 AS pages, relallvisible = 0 AS not_visible
+FROM pg_class WHERE oid = :'COMPRESSED_CHUNK'::regclass;
+SELECT count(*), sum(value) FROM frozen;
+DROP TABLE frozen;
@@ -0,0 +1,63 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE TABLE metrics(time int NOT NULL, device int, value float8, label text);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 1000);
+INSERT INTO metrics SELECT x, x % 4, x % 10, 'label ' || x % 3 FROM generate_series(0, 999) x;
+SELECT show_chunks('metrics') AS chunk \gset
+
+-- Without compression settings, the chunk is ordered by time, and every
+-- column is tried with every algorithm that supports its type
+SELECT segmentby, orderby, column_name, algorithm, is_default, sampled_rows, batches,
+    uncompressed_bytes
+FROM compression_advisor(:'chunk')
+ORDER BY column_name, algorithm;
+-- every combination of the candidates is estimated
+SELECT segmentby, orderby, sampled_rows, batches, count(*)
+FROM compression_advisor(:'chunk', ARRAY['', 'device'], ARRAY['time', 'value, time'])
+GROUP BY 1, 2, 3, 4
+ORDER BY 1, 2;
+-- a segmentby column is stored once per batch
+SELECT column_name, algorithm, is_default, uncompressed_bytes, compressed_bytes, compression_ratio,
+    decompress_ns_per_value
+FROM compression_advisor(:'chunk', ARRAY['device'], ARRAY['time'])
+WHERE column_name = 'device';
+SELECT column_name, algorithm, compressed_bytes < uncompressed_bytes AS smaller,
+    decompress_ns_per_value >= 0 AS timed
+FROM compression_advisor(:'chunk', ARRAY[''], ARRAY['time'])
+WHERE (column_name, algorithm) IN (('time', 'deltadelta'), ('label', 'dictionary'))
+ORDER BY 1;
+
+-- The batches are split like the compression does
+SET timescaledb.compression_batch_rows TO 100;
+SELECT DISTINCT segmentby, sampled_rows, batches
+FROM compression_advisor(:'chunk', ARRAY['', 'device'], ARRAY['time'])
+ORDER BY 1;
+RESET timescaledb.compression_batch_rows;
+-- the sample is bounded
+SELECT DISTINCT sampled_rows, batches
+FROM compression_advisor(:'chunk', ARRAY[''], ARRAY['time'], 100);
+
+-- The candidates default to the current settings
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'time DESC');
+SELECT DISTINCT segmentby, orderby, batches FROM compression_advisor(:'chunk');
+SELECT DISTINCT segmentby, orderby, batches
+FROM compression_advisor(:'chunk', orderby => ARRAY['value']);
+
+-- Errors
+SELECT * FROM compression_advisor(:'chunk', sample_rows => 0);
+SELECT * FROM compression_advisor(:'chunk', ARRAY[]::text[]);
+SELECT * FROM compression_advisor(:'chunk', ARRAY['device'], ARRAY['device']);
+SELECT * FROM compression_advisor(:'chunk', ARRAY['missing']);
+SELECT * FROM compression_advisor('metrics');
+\c :TEST_DBNAME :ROLE_DEFAULT_PERM_USER
+SELECT * FROM compression_advisor(:'chunk');
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT count(compress_chunk(:'chunk'));
+SELECT * FROM compression_advisor(:'chunk');
+
+DROP TABLE metrics;
@@ -0,0 +1,71 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- The algorithm of a compressed datum is the first byte of its binary form:
+-- 2 is dictionary, 3 is gorilla and 4 is deltadelta
+CREATE FUNCTION compression_algorithm(_timescaledb_internal.compressed_data) RETURNS int
+AS $$ SELECT get_byte(decode($1::text, 'base64'), 0) $$ LANGUAGE SQL;
+
+CREATE TABLE metrics(time int NOT NULL, device int, value float, status int);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 100000);
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'time');
+-- 15 batches with a few distinct values in the float and in the integer
+-- column, which the dictionary compresses better than gorilla and deltadelta
+INSERT INTO metrics SELECT t, 1, t % 4, (t % 2) * 1000000 FROM generate_series(1, 15000) t;
+
+-- The first batches choose the smaller result, and the later batches keep
+-- using the algorithm that was smaller in total
+SHOW timescaledb.enable_compression_algorithm_selection;
+SELECT compress_chunk(show_chunks('metrics'));
+SELECT format('%I.%I', c2.schema_name, c2.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk c1
+JOIN _timescaledb_catalog.chunk c2 ON c1.compressed_chunk_id = c2.id
+WHERE c1.table_name = '_hyper_1_1_chunk' \gset
+SELECT compression_algorithm(time) AS time, compression_algorithm(value) AS value,
+       compression_algorithm(status) AS status, count(*)
+FROM :COMPRESSED_CHUNK GROUP BY 1, 2, 3 ORDER BY 1, 2, 3;
+
+-- The batches that switched to the dictionary decompress to the same data
+SELECT count(*), sum(time), sum(value), sum(status) FROM metrics;
+SELECT count(*), sum(value) FROM metrics WHERE value > 1;
+SELECT time, value, status FROM metrics WHERE time IN (1, 2, 1000, 1001, 15000) ORDER BY time;
+
+-- Without the selection, the columns use the default algorithm of their type
+SELECT decompress_chunk(show_chunks('metrics'));
+SET timescaledb.enable_compression_algorithm_selection TO off;
+SELECT compress_chunk(show_chunks('metrics'));
+SELECT format('%I.%I', c2.schema_name, c2.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk c1
+JOIN _timescaledb_catalog.chunk c2 ON c1.compressed_chunk_id = c2.id
+WHERE c1.table_name = '_hyper_1_1_chunk' \gset
+SELECT compression_algorithm(time) AS time, compression_algorithm(value) AS value,
+       compression_algorithm(status) AS status, count(*)
+FROM :COMPRESSED_CHUNK GROUP BY 1, 2, 3 ORDER BY 1, 2, 3;
+SELECT count(*), sum(time), sum(value), sum(status) FROM metrics;
+RESET timescaledb.enable_compression_algorithm_selection;
+
+-- The dictionary would merge the NaN values, so a NaN stops the trial and
+-- the float column keeps gorilla
+CREATE TABLE nan_metrics(time int NOT NULL, device int, value float, status int);
+SELECT table_name FROM create_hypertable('nan_metrics', 'time', chunk_time_interval => 100000);
+ALTER TABLE nan_metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'time');
+INSERT INTO nan_metrics SELECT t, 1, CASE WHEN t = 1 THEN 'NaN' ELSE t % 4 END, (t % 2) * 1000000
+FROM generate_series(1, 3000) t;
+SELECT compress_chunk(show_chunks('nan_metrics'));
+SELECT format('%I.%I', c2.schema_name, c2.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk c1
+JOIN _timescaledb_catalog.chunk c2 ON c1.compressed_chunk_id = c2.id
+WHERE c1.table_name = '_hyper_3_4_chunk' \gset
+SELECT compression_algorithm(time) AS time, compression_algorithm(value) AS value,
+       compression_algorithm(status) AS status, count(*)
+FROM :COMPRESSED_CHUNK GROUP BY 1, 2, 3 ORDER BY 1, 2, 3;
+SELECT count(*) FILTER (WHERE value = 'NaN'), sum(value) FILTER (WHERE value <> 'NaN') FROM nan_metrics;
+
+DROP TABLE metrics;
+DROP TABLE nan_metrics;
+DROP FUNCTION compression_algorithm(_timescaledb_internal.compressed_data);
@@ -391,4 +391,54 @@ group by 2 order by 1 desc;
 create or replace function ts_read_compressed_data_file(cstring, regtype, cstring) returns int
 as :TSL_MODULE_PATHNAME, 'ts_read_compressed_data_file' language c;
 
-select ts_read_compressed_data_file('gorilla', 'float8', '--nonexistent');
\ No newline at end of file
+select ts_read_compressed_data_file('gorilla', 'float8', '--nonexistent');
+
+-- The compression micro-benchmark runs every phase over one batch for each
+-- iteration
+create or replace function ts_bench_compression(algorithm cstring, type regtype,
+    dataset cstring, iterations int)
+returns table(phase text, "values" bigint, uncompressed_bytes bigint, compressed_bytes bigint,
+    ratio float8, ns_per_value float8, mb_per_s float8)
+as :TSL_MODULE_PATHNAME, 'ts_bench_compression' language c strict;
+select phase, "values", uncompressed_bytes, ratio > 1 as compresses, ns_per_value >= 0 as timed
+from ts_bench_compression('deltadelta', 'int8', 'sequential', 2);
+-- the nulls are decompressed as well
+select phase, "values" from ts_bench_compression('gorilla', 'float8', 'sparse', 3);
+\set ON_ERROR_STOP 0
+select * from ts_bench_compression('lz4', 'int8', 'sequential', 1);
+select * from ts_bench_compression('deltadelta', 'int8', 'sequential', 0);
+select * from ts_bench_compression('deltadelta', 'int8', 'unknown', 1);
+\set ON_ERROR_STOP 1
+
+-- The dictionary compressor hashes the values with a hash table specialized
+-- for the type and keeps one dictionary entry for each distinct value
+create table dict_types as select t,
+    (t % 4)::int8 as i8,
+    '2020-01-01'::date + t % 4 as d,
+    '2020-01-01'::timestamp + (t % 4) * interval '1 hour' as ts,
+    case when t % 10 = 0 then null else repeat('value ' || t % 4, 500) end as txt,
+    ('value ' || t % 4)::bytea as b,
+    ('v' || t % 4)::char(4) as bp,
+    (t % 4)::float8 as f
+from generate_series(1, 1000) t;
+create or replace function dict_roundtrip(col text, typ regtype)
+returns table(col_name text, mismatches bigint, small bool) language plpgsql as $$
+begin
+    return query execute format($q$
+        with compressed as (
+            select _timescaledb_internal.compress_dictionary(%1$I order by t) as c from dict_types
+        ), decompressed as (
+            select row_number() over () as t, item
+            from compressed, _timescaledb_internal.decompress_forward(c::_timescaledb_internal.compressed_data, null::%2$s) item
+        )
+        select %1$L::text, count(*) filter (where o.%1$I is distinct from d.item),
+            (select pg_column_size(c) from compressed) < 4 * max(octet_length(o.%1$I::text)) + 2000
+        from dict_types o full join decompressed d on d.t = o.t
+    $q$, col, typ);
+end
+$$;
+select r.* from (values ('i8', 'int8'), ('d', 'date'), ('ts', 'timestamp'), ('txt', 'text'),
+    ('b', 'bytea'), ('bp', 'bpchar'), ('f', 'float8')) v(col, typ),
+    dict_roundtrip(v.col, v.typ::regtype) r;
+drop function dict_roundtrip(text, regtype);
+drop table dict_types;
@@ -0,0 +1,100 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- Read the exported stream back, so that we can compare it with the chunk
+CREATE FUNCTION arrow_ipc_schema(stream bytea) RETURNS TABLE(name text, type text, nullable bool)
+AS :TSL_MODULE_PATHNAME, 'ts_test_arrow_ipc_schema' LANGUAGE C STRICT;
+CREATE FUNCTION arrow_ipc_rows(stream bytea) RETURNS TABLE(batch int, "values" text[])
+AS :TSL_MODULE_PATHNAME, 'ts_test_arrow_ipc_rows' LANGUAGE C STRICT;
+CREATE FUNCTION arrow_ipc_stream(chunk regclass) RETURNS bytea LANGUAGE SQL AS
+$$
+SELECT string_agg(message, ''::bytea ORDER BY n)
+FROM export_chunk_arrow_ipc(chunk) WITH ORDINALITY AS m(message, n)
+$$;
+
+CREATE TABLE arrow_types(time timestamptz NOT NULL, device int, b bool, i2 int2, i8 int8,
+    f4 float4, f8 float8, d date, t time, ts timestamp, txt text, vc varchar(10), ch char(3),
+    bin bytea);
+SELECT table_name FROM create_hypertable('arrow_types', 'time', chunk_time_interval => interval '1 day');
+-- One chunk with two batches for each device, and one batch with a null
+-- segmentby value. Most of the columns have nulls, and the date and the
+-- timestamp have infinite values.
+INSERT INTO arrow_types
+SELECT '2023-01-01 00:00:00+00'::timestamptz + x * interval '10 s',
+    CASE WHEN x <= 2400 THEN x % 2 END,
+    CASE WHEN x % 7 <> 0 THEN x % 3 = 0 END,
+    x % 100,
+    CASE WHEN x % 5 <> 0 THEN x * 1000000000::bigint END,
+    x / 4.0,
+    CASE WHEN x % 11 <> 0 THEN x * 1.5 END,
+    CASE WHEN x = 1 THEN 'infinity' ELSE '2023-01-01'::date + x % 30 END,
+    '00:00'::time + x * interval '1 s',
+    CASE WHEN x = 2 THEN '-infinity' ELSE '1999-12-31 23:00'::timestamp + x * interval '1 min' END,
+    CASE WHEN x % 13 <> 0 THEN 'text ' || x % 20 END,
+    left(md5(x::text), 10),
+    lpad((x % 1000)::text, 3, '0'),
+    CASE WHEN x % 17 <> 0 THEN decode(lpad(to_hex(x), 4, '0'), 'hex') END
+FROM generate_series(1, 2410) x;
+ALTER TABLE arrow_types SET (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'time');
+SELECT count(compress_chunk(c)) FROM show_chunks('arrow_types') c;
+-- a column that was added after the compression is null in every batch
+ALTER TABLE arrow_types ADD COLUMN added int;
+SELECT show_chunks('arrow_types') AS chunk \gset
+
+SELECT * FROM arrow_ipc_schema(arrow_ipc_stream(:'chunk'));
+-- the schema, one message per compressed batch and the end of the stream
+SELECT count(*) FROM export_chunk_arrow_ipc(:'chunk');
+SELECT batch, count(*) FROM arrow_ipc_rows(arrow_ipc_stream(:'chunk')) GROUP BY 1 ORDER BY 1;
+SELECT "values"[3:7] FROM arrow_ipc_rows(arrow_ipc_stream(:'chunk')) WHERE batch = 1 LIMIT 3;
+SELECT count(*) FILTER (WHERE "values"[2] IS NULL) AS device,
+    count(*) FILTER (WHERE "values"[3] IS NULL) AS b,
+    count(*) FILTER (WHERE "values"[5] IS NULL) AS i8,
+    count(*) FILTER (WHERE "values"[7] IS NULL) AS f8,
+    count(*) FILTER (WHERE "values"[11] IS NULL) AS txt,
+    count(*) FILTER (WHERE "values"[14] IS NULL) AS bin,
+    count(*) FILTER (WHERE "values"[15] IS NULL) AS added
+FROM arrow_ipc_rows(arrow_ipc_stream(:'chunk'));
+
+-- All the values read back as the rows of the chunk
+CREATE VIEW arrow_types_text AS
+SELECT ARRAY[time::text, device::text, b::text, i2::text, i8::text, f4::text, f8::text, d::text,
+    t::text, ts::text, txt, vc::text, ch::text, bin::text, added::text] AS "values"
+FROM arrow_types;
+SELECT count(*) FROM (
+    SELECT "values" FROM arrow_ipc_rows(arrow_ipc_stream(:'chunk'))
+    EXCEPT ALL
+    SELECT "values" FROM arrow_types_text) AS missing;
+SELECT count(*) FROM (
+    SELECT "values" FROM arrow_types_text
+    EXCEPT ALL
+    SELECT "values" FROM arrow_ipc_rows(arrow_ipc_stream(:'chunk'))) AS missing;
+
+-- A compressed chunk without batches has only the schema
+SELECT format('%I.%I', c.schema_name, c.table_name) AS compressed_chunk
+FROM _timescaledb_catalog.chunk c
+JOIN _timescaledb_catalog.chunk u ON u.compressed_chunk_id = c.id
+WHERE format('%I.%I', u.schema_name, u.table_name)::regclass = :'chunk'::regclass \gset
+DELETE FROM :compressed_chunk;
+SELECT count(*) FROM export_chunk_arrow_ipc(:'chunk');
+SELECT count(*) FROM arrow_ipc_schema(arrow_ipc_stream(:'chunk'));
+SELECT count(*) FROM arrow_ipc_rows(arrow_ipc_stream(:'chunk'));
+
+-- Only the compressed chunks with the supported types can be exported
+CREATE TABLE arrow_numeric(time int NOT NULL, n numeric);
+SELECT table_name FROM create_hypertable('arrow_numeric', 'time', chunk_time_interval => 10);
+INSERT INTO arrow_numeric VALUES (1, 1.5);
+SELECT show_chunks('arrow_numeric') AS chunk \gset
+SELECT count(*) FROM export_chunk_arrow_ipc(:'chunk');
+ALTER TABLE arrow_numeric SET (timescaledb.compress);
+SELECT count(compress_chunk(c)) FROM show_chunks('arrow_numeric') c;
+SELECT count(*) FROM export_chunk_arrow_ipc(:'chunk');
+
+DROP VIEW arrow_types_text;
+DROP TABLE arrow_types, arrow_numeric;
+DROP FUNCTION arrow_ipc_stream(regclass);
+DROP FUNCTION arrow_ipc_rows(bytea);
+DROP FUNCTION arrow_ipc_schema(bytea);
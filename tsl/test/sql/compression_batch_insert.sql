@@ -0,0 +1,50 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+-- Compressing a chunk with many small segments buffers the compressed
+-- tuples and inserts them into the compressed chunk in batches
+CREATE TABLE metrics(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 100000);
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+
+-- More segments than fit in one batch, and one segment with several
+-- compressed tuples
+INSERT INTO metrics SELECT t, d, 1.0 FROM generate_series(1, 2500) d, generate_series(1, 2) t;
+INSERT INTO metrics SELECT t, 0, 1.0 FROM generate_series(1, 3000) t;
+
+SELECT compress_chunk(show_chunks('metrics'));
+SELECT format('%I.%I', c2.schema_name, c2.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk c1
+JOIN _timescaledb_catalog.chunk c2 ON c1.compressed_chunk_id = c2.id
+WHERE c1.table_name = '_hyper_1_1_chunk' \gset
+
+SELECT count(*), count(DISTINCT device) AS segments, min(_ts_meta_count), max(_ts_meta_count),
+       sum(_ts_meta_count)
+FROM :COMPRESSED_CHUNK;
+SELECT _ts_meta_count, _ts_meta_sequence_num FROM :COMPRESSED_CHUNK WHERE device = 0
+ORDER BY _ts_meta_sequence_num;
+
+-- The indexes of the compressed chunk have all the tuples of all the batches
+SET enable_seqscan TO off;
+SELECT device, _ts_meta_count FROM :COMPRESSED_CHUNK WHERE device IN (0, 1, 1000, 1001, 2500)
+ORDER BY device, _ts_meta_sequence_num;
+SELECT count(*) FROM :COMPRESSED_CHUNK WHERE device > 0;
+RESET enable_seqscan;
+
+SELECT count(*), count(DISTINCT device), sum(value) FROM metrics;
+SELECT time, value FROM metrics WHERE device = 2500 ORDER BY time;
+
+-- Compressing again gives the same compressed chunk
+SELECT decompress_chunk(show_chunks('metrics'));
+SELECT compress_chunk(show_chunks('metrics'));
+SELECT format('%I.%I', c2.schema_name, c2.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk c1
+JOIN _timescaledb_catalog.chunk c2 ON c1.compressed_chunk_id = c2.id
+WHERE c1.table_name = '_hyper_1_1_chunk' \gset
+SELECT count(*), count(DISTINCT device) AS segments, min(_ts_meta_count), max(_ts_meta_count),
+       sum(_ts_meta_count)
+FROM :COMPRESSED_CHUNK;
+SELECT count(*), count(DISTINCT device), sum(value) FROM metrics;
+
+DROP TABLE metrics;
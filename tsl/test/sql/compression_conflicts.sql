@@ -386,3 +386,27 @@ DO NOTHING;
 -- Even a regular insert will fail due to unique constrant checks for dml decompression
 INSERT INTO compressed_ht VALUES ('2022-01-24 01:10:28.192199+05:30', '7', 0.876, 4.123, 'new insert row');
 \set ON_ERROR_STOP 1
+
+RESET timescaledb.enable_dml_decompression;
+
+-- Test that the sparse min/max and bloom filter metadata of a unique key
+-- column that is neither segmentby nor orderby limit the batches that are
+-- decompressed for the uniqueness checks.
+CREATE TABLE sparse_conflicts(time int NOT NULL, device int, serial int, value float, UNIQUE (time, serial));
+SELECT table_name FROM create_hypertable('sparse_conflicts', 'time', chunk_time_interval => 100000);
+ALTER TABLE sparse_conflicts SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time, value', timescaledb.compress_minmax = 'serial', timescaledb.compress_bloomfilter = 'serial');
+INSERT INTO sparse_conflicts SELECT 1, i % 2, i, i FROM generate_series(1, 10000) i;
+SELECT count(compress_chunk(c)) FROM show_chunks('sparse_conflicts') c;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "CHUNK"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.hypertable ht ON ht.id = ch.hypertable_id
+WHERE ht.table_name = 'sparse_conflicts' \gset
+
+-- no batch can contain the key, so nothing is decompressed
+INSERT INTO sparse_conflicts VALUES (1, 0, 20000, 0);
+SELECT count(*) FROM ONLY :CHUNK;
+
+-- only the batch that contains the key is decompressed
+INSERT INTO sparse_conflicts VALUES (1, 1, 4001, 0) ON CONFLICT DO NOTHING;
+SELECT count(*) FROM ONLY :CHUNK;
+SELECT count(*), sum(value) FROM sparse_conflicts;
@@ -965,3 +965,50 @@ EXPLAIN (COSTS OFF) SELECT * FROM space_part ORDER BY time;
 INSERT INTO space_part VALUES
 ('2022-01-01 00:02', 1, 1, 1);
 EXPLAIN (COSTS OFF) SELECT * FROM space_part ORDER BY time;
+
+-- An index on segmentby columns that the default segmentby index does not
+-- cover is added to the compressed hypertable, and to the compressed chunks
+-- when they are compressed the next time
+CREATE FUNCTION index_columns(rel regclass) RETURNS SETOF text LANGUAGE sql AS $$
+    SELECT string_agg(a.attname, ', ' ORDER BY k.ord)
+    FROM pg_index i, unnest(i.indkey) WITH ORDINALITY k(attnum, ord), pg_attribute a
+    WHERE i.indrelid = rel AND a.attrelid = rel AND a.attnum = k.attnum
+    GROUP BY i.indexrelid
+    ORDER BY 1
+$$;
+CREATE TABLE seg_index(time timestamptz NOT NULL, device int, location int, value float);
+SELECT table_name FROM create_hypertable('seg_index', 'time', chunk_time_interval => interval '1 day');
+ALTER TABLE seg_index SET (timescaledb.compress, timescaledb.compress_segmentby = 'device, location');
+INSERT INTO seg_index
+SELECT '2000-01-01'::timestamptz + t * interval '1 hour', t % 3, t % 5, t FROM generate_series(0, 47) t;
+SELECT count(compress_chunk(c)) FROM show_chunks('seg_index') c;
+SELECT h.id AS seg_index_id, format('%I.%I', c.schema_name, c.table_name) AS compressed_ht
+FROM _timescaledb_catalog.hypertable h
+JOIN _timescaledb_catalog.hypertable c ON c.id = h.compressed_hypertable_id
+WHERE h.table_name = 'seg_index' \gset
+SELECT format('%I.%I', cc.schema_name, cc.table_name) AS compressed_chunk
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.chunk cc ON cc.id = ch.compressed_chunk_id
+WHERE ch.hypertable_id = :seg_index_id
+ORDER BY ch.id LIMIT 1 \gset
+-- a prefix of the segmentby columns is covered by the default index
+CREATE INDEX seg_index_device_idx ON seg_index (device);
+SELECT index_columns(:'compressed_ht');
+CREATE INDEX seg_index_location_idx ON seg_index (location);
+SELECT index_columns(:'compressed_ht');
+-- the existing compressed chunks are not indexed at CREATE INDEX time
+SELECT index_columns(:'compressed_chunk');
+SELECT count(decompress_chunk(c)) FROM (SELECT c FROM show_chunks('seg_index') c ORDER BY c LIMIT 1) s;
+SELECT count(compress_chunk(c)) FROM (SELECT c FROM show_chunks('seg_index') c ORDER BY c LIMIT 1) s;
+SELECT format('%I.%I', cc.schema_name, cc.table_name) AS compressed_chunk
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.chunk cc ON cc.id = ch.compressed_chunk_id
+WHERE ch.hypertable_id = :seg_index_id
+ORDER BY ch.id LIMIT 1 \gset
+SELECT index_columns(:'compressed_chunk');
+SELECT count(*) FROM seg_index WHERE location = 2;
+-- the index is dropped with the hypertable index
+DROP INDEX seg_index_location_idx;
+SELECT index_columns(:'compressed_ht');
+DROP TABLE seg_index;
+DROP FUNCTION index_columns(regclass);
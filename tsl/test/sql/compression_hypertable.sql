@@ -296,4 +296,27 @@ select distinct on (id) * from test8
 order by id, ts desc, value
 ;
 
-drop table test8;
\ No newline at end of file
+drop table test8;
+
+-- The bulk decompression of gorilla reads the xors of every bit width from
+-- the words that contain them, also when they span two words
+create table gorilla_bulk(ts int not null, device int, value float8);
+select table_name from create_hypertable('gorilla_bulk', 'ts', chunk_time_interval => 100000);
+alter table gorilla_bulk set (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'ts');
+insert into gorilla_bulk
+select t, t % 3,
+    case when t % 13 = 0 then null
+         when t % 5 = 0 then t
+         when t % 7 = 0 then (t / 70) * 1.5
+         else sin(t) * 10 ^ (t % 17 - 8) end
+from generate_series(1, 3000) t;
+create table gorilla_bulk_orig as select * from gorilla_bulk;
+select count(compress_chunk(x)) from show_chunks('gorilla_bulk') x;
+select count(*) from (select * from gorilla_bulk except all select * from gorilla_bulk_orig) s;
+select count(*) from (select * from gorilla_bulk_orig except all select * from gorilla_bulk) s;
+set timescaledb.enable_bulk_decompression to false;
+select count(*) from (select * from gorilla_bulk except all select * from gorilla_bulk_orig) s;
+select count(*) from (select * from gorilla_bulk_orig except all select * from gorilla_bulk) s;
+reset timescaledb.enable_bulk_decompression;
+drop table gorilla_bulk;
+drop table gorilla_bulk_orig;
@@ -245,12 +245,31 @@ ALTER TABLE tab1 SET(timescaledb.compress, timescaledb.compress_segmentby = 'id,
 SELECT compress_chunk(show_chunks('tab1'));
 SELECT decompress_chunk(show_chunks('tab1'));
 DROP INDEX idx_asc_null_first;
---Index Column out of order
+--Segmentby columns in a different order
 CREATE INDEX idx_asc_null_first ON tab1(c1, id, time ASC NULLS FIRST);
 SELECT compress_chunk(show_chunks('tab1'));
 SELECT decompress_chunk(show_chunks('tab1'));
 DROP INDEX idx_asc_null_first;
 
+--Partial index
+CREATE INDEX idx_asc_null_first ON tab1(id, c1, time ASC NULLS FIRST) WHERE c2 > 50;
+SELECT compress_chunk(show_chunks('tab1'));
+SELECT decompress_chunk(show_chunks('tab1'));
+DROP INDEX idx_asc_null_first;
+
+--Test Set 10
+--Parallel sort of the chunks without a matching index
+SET min_parallel_table_scan_size TO 0;
+SET max_parallel_maintenance_workers TO 2;
+CREATE TABLE tab1_uncompressed AS SELECT * FROM tab1;
+SELECT compress_chunk(show_chunks('tab1'));
+SELECT count(*) FROM (SELECT * FROM tab1 EXCEPT ALL SELECT * FROM tab1_uncompressed) t;
+SELECT count(*) FROM (SELECT * FROM tab1_uncompressed EXCEPT ALL SELECT * FROM tab1) t;
+SELECT decompress_chunk(show_chunks('tab1'));
+DROP TABLE tab1_uncompressed;
+RESET min_parallel_table_scan_size;
+RESET max_parallel_maintenance_workers;
+
 --Tear down
 DROP TABLE tab1;
 DROP TABLE tab2;
@@ -659,3 +659,117 @@ ALTER TABLE test4 DROP COLUMN two;
 INSERT INTO test4 VALUES ('2021-10-14 17:50:16.207', '7', NULL);
 INSERT INTO test4 (timestamp, ident) VALUES ('2021-10-14 17:50:16.207', '7');
 
+-- Test that the rows copied into a compressed chunk can be compressed
+-- directly into new batches, without going through the uncompressed chunk.
+CREATE TABLE direct_compress(time timestamptz NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('direct_compress', 'time');
+ALTER TABLE direct_compress SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+INSERT INTO direct_compress
+SELECT '2023-01-01 00:00:00+00'::timestamptz + x * interval '1 minute', x % 2, x
+FROM generate_series(1, 10) x;
+SELECT count(compress_chunk(ch)) FROM show_chunks('direct_compress') ch;
+
+SET timescaledb.enable_direct_compress_insert TO on;
+COPY direct_compress FROM STDIN DELIMITER ',';
+2023-01-01 00:11:00+00,1,11
+2023-01-01 00:12:00+00,0,12
+2023-01-01 00:13:00+00,1,13
+2023-01-01 00:14:00+00,0,14
+2023-01-01 00:15:00+00,1,15
+2023-01-01 00:16:00+00,0,16
+2023-01-01 00:17:00+00,1,17
+2023-01-01 00:18:00+00,0,18
+2023-01-01 00:19:00+00,1,19
+2023-01-01 00:20:00+00,0,20
+\.
+RESET timescaledb.enable_direct_compress_insert;
+
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "CHUNK",
+    format('%I.%I', comp.schema_name, comp.table_name) AS "COMPRESSED_CHUNK",
+    ch.status AS "CHUNK_STATUS"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.chunk comp ON comp.id = ch.compressed_chunk_id
+JOIN _timescaledb_catalog.hypertable ht ON ht.id = ch.hypertable_id
+WHERE ht.table_name = 'direct_compress' \gset
+
+-- the chunk is unordered but not partial
+SELECT :CHUNK_STATUS AS status;
+SELECT count(*) FROM ONLY :CHUNK;
+SELECT device, _ts_meta_count FROM :COMPRESSED_CHUNK ORDER BY device, _ts_meta_sequence_num;
+SELECT count(*), sum(value) FROM direct_compress;
+
+-- the new batches continue the sequence numbers of their segments
+SELECT device, _ts_meta_sequence_num, _ts_meta_count FROM :COMPRESSED_CHUNK ORDER BY device, _ts_meta_sequence_num;
+SET timescaledb.enable_direct_compress_insert TO on;
+COPY direct_compress FROM STDIN DELIMITER ',';
+2023-01-01 00:21:00+00,1,21
+2023-01-01 00:22:00+00,0,22
+2023-01-01 00:23:00+00,1,23
+2023-01-01 00:24:00+00,0,24
+2023-01-01 00:25:00+00,1,25
+2023-01-01 00:26:00+00,0,26
+2023-01-01 00:27:00+00,1,27
+2023-01-01 00:28:00+00,0,28
+2023-01-01 00:29:00+00,1,29
+2023-01-01 00:30:00+00,0,30
+\.
+RESET timescaledb.enable_direct_compress_insert;
+SELECT device, _ts_meta_sequence_num, _ts_meta_count FROM :COMPRESSED_CHUNK ORDER BY device, _ts_meta_sequence_num;
+SELECT count(*), sum(value) FROM direct_compress;
+
+-- The rows inserted into empty chunks are compressed right away
+CREATE TABLE direct_empty(time timestamptz NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('direct_empty', 'time');
+ALTER TABLE direct_empty SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+SET timescaledb.enable_direct_compress_empty_chunks TO on;
+COPY direct_empty FROM STDIN DELIMITER ',';
+2023-01-01 00:01:00+00,0,1
+2023-01-01 00:02:00+00,0,2
+2023-01-01 00:03:00+00,0,3
+2023-01-01 00:04:00+00,0,4
+2023-01-01 00:05:00+00,0,5
+2023-01-01 00:01:00+00,1,6
+2023-01-01 00:02:00+00,1,7
+2023-01-01 00:03:00+00,1,8
+2023-01-01 00:04:00+00,1,9
+2023-01-01 00:05:00+00,1,10
+\.
+RESET timescaledb.enable_direct_compress_empty_chunks;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "CHUNK",
+    format('%I.%I', comp.schema_name, comp.table_name) AS "COMPRESSED_CHUNK",
+    ch.status AS "CHUNK_STATUS"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.chunk comp ON comp.id = ch.compressed_chunk_id
+JOIN _timescaledb_catalog.hypertable ht ON ht.id = ch.hypertable_id
+WHERE ht.table_name = 'direct_empty' ORDER BY ch.id DESC LIMIT 1 \gset
+-- the rows came in order, so the chunk is ordered
+SELECT :CHUNK_STATUS AS status;
+SELECT count(*) FROM ONLY :CHUNK;
+SELECT device, _ts_meta_count FROM :COMPRESSED_CHUNK ORDER BY device, _ts_meta_sequence_num;
+SET timescaledb.enable_direct_compress_empty_chunks TO on;
+COPY direct_empty FROM STDIN DELIMITER ',';
+2023-02-01 00:01:00+00,1,11
+2023-02-01 00:02:00+00,0,12
+2023-02-01 00:03:00+00,1,13
+2023-02-01 00:04:00+00,0,14
+2023-02-01 00:05:00+00,1,15
+2023-02-01 00:06:00+00,0,16
+2023-02-01 00:07:00+00,1,17
+2023-02-01 00:08:00+00,0,18
+2023-02-01 00:09:00+00,1,19
+2023-02-01 00:10:00+00,0,20
+\.
+RESET timescaledb.enable_direct_compress_empty_chunks;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "CHUNK",
+    format('%I.%I', comp.schema_name, comp.table_name) AS "COMPRESSED_CHUNK",
+    ch.status AS "CHUNK_STATUS"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.chunk comp ON comp.id = ch.compressed_chunk_id
+JOIN _timescaledb_catalog.hypertable ht ON ht.id = ch.hypertable_id
+WHERE ht.table_name = 'direct_empty' ORDER BY ch.id DESC LIMIT 1 \gset
+-- the rows of a new chunk came out of order
+SELECT :CHUNK_STATUS AS status;
+SELECT count(*) FROM ONLY :CHUNK;
+SELECT device, _ts_meta_count FROM :COMPRESSED_CHUNK ORDER BY device, _ts_meta_sequence_num;
+SELECT count(*), sum(value) FROM direct_empty;
+DROP TABLE direct_empty;
@@ -0,0 +1,48 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- The number of bytes that the DecompressChunk nodes detoast
+CREATE FUNCTION detoasted_bytes(stmt text) RETURNS bigint LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+    bytes bigint = 0;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF) ' || stmt LOOP
+        IF line ~ 'Detoasted Bytes' THEN
+            bytes = bytes + substring(line from 'Detoasted Bytes: (\d+)')::bigint;
+        END IF;
+    END LOOP;
+    RETURN bytes;
+END
+$$;
+
+-- Every value needs a Simple8b block of its own, so the deltadelta data of a
+-- batch takes about 8 kB and is stored in the TOAST table
+CREATE TABLE metrics(time int NOT NULL, value bigint);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 100000);
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_orderby = 'time');
+INSERT INTO metrics SELECT t, (t * 7919) % 10007 * 1000000007 FROM generate_series(1, 3000) t;
+SELECT compress_chunk(show_chunks('metrics'));
+
+-- A LIMIT without quals on the compressed columns only needs the first rows of
+-- the batch, so only the part of the data that holds them is detoasted
+SELECT detoasted_bytes('SELECT * FROM metrics LIMIT 5') < 1000 AS prefix_only;
+SELECT * FROM (SELECT time, value FROM metrics LIMIT 5) s ORDER BY time;
+
+-- The quals on the compressed columns and the limits above the batch size need
+-- the entire data
+SELECT detoasted_bytes('SELECT * FROM metrics WHERE value > 0 LIMIT 5') > 8000 AS entire_batch;
+SELECT detoasted_bytes('SELECT * FROM metrics LIMIT 1500') > 16000 AS entire_batches;
+SELECT count(*), sum(value) FROM (SELECT * FROM metrics LIMIT 1500) s;
+
+-- The same with the row-by-row decompression
+SET timescaledb.enable_bulk_decompression TO off;
+SELECT detoasted_bytes('SELECT * FROM metrics LIMIT 5') < 1000 AS prefix_only;
+SELECT * FROM (SELECT time, value FROM metrics LIMIT 5) s ORDER BY time;
+RESET timescaledb.enable_bulk_decompression;
+
+DROP TABLE metrics;
+DROP FUNCTION detoasted_bytes(text);
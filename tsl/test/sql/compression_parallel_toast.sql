@@ -0,0 +1,51 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE FUNCTION planned_workers(stmt text) RETURNS SETOF text LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (COSTS OFF) ' || stmt LOOP
+        IF line ~ 'Workers Planned' THEN
+            RETURN NEXT trim(line);
+        END IF;
+    END LOOP;
+END
+$$;
+
+-- A single compressed chunk that stores nearly all of its data in the TOAST
+-- table: the random floats do not compress, and every batch is toasted
+CREATE TABLE metrics(time int NOT NULL, value float);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 1000000);
+ALTER TABLE metrics SET (timescaledb.compress);
+INSERT INTO metrics SELECT t, random() FROM generate_series(1, 100000) t;
+SELECT compress_chunk(show_chunks('metrics'));
+SELECT format('%I.%I', c2.schema_name, c2.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk c1
+JOIN _timescaledb_catalog.chunk c2 ON c1.compressed_chunk_id = c2.id
+WHERE c1.table_name = '_hyper_1_1_chunk' \gset
+VACUUM ANALYZE :COMPRESSED_CHUNK;
+
+-- With the scan threshold of 16 pages, the heap of the compressed chunk only
+-- gets one worker, its heap together with the TOAST table gets two
+SELECT c.relpages < 16 AS heap_pages_below_threshold, t.relpages >= 48 AS toast_pages_above_threshold
+FROM pg_class c JOIN pg_class t ON t.oid = c.reltoastrelid
+WHERE c.oid = :'COMPRESSED_CHUNK'::regclass;
+
+SET parallel_setup_cost TO 0;
+SET parallel_tuple_cost TO 0;
+SET min_parallel_table_scan_size TO '128kB';
+SET max_parallel_workers_per_gather TO 2;
+SELECT planned_workers('SELECT count(*), sum(time) FROM metrics');
+SELECT count(*), sum(time) FROM metrics;
+SELECT count(*) FROM metrics WHERE value < 0 OR value >= 1;
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET min_parallel_table_scan_size;
+RESET max_parallel_workers_per_gather;
+
+DROP TABLE metrics;
+DROP FUNCTION planned_workers(text);
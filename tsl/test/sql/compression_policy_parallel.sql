@@ -0,0 +1,61 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+CREATE OR REPLACE FUNCTION ts_test_bgw_num_unreserved() RETURNS INTEGER
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_test_bgw_worker_reserve(num_workers INTEGER) RETURNS INTEGER
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION ts_test_bgw_worker_release(num_workers INTEGER) RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+
+CREATE TABLE metrics(time timestamptz NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => INTERVAL '1 day');
+INSERT INTO metrics
+SELECT t, d, 1.0
+FROM generate_series('2020-01-01 00:00'::timestamptz, '2020-01-04 23:00', '1 hour') t,
+     generate_series(1, 3) d;
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+
+SELECT add_compression_policy('metrics', INTERVAL '1 day') AS job_id \gset
+SELECT config->'parallel_workers' AS parallel_workers
+FROM alter_job(:job_id, config => (SELECT config FROM _timescaledb_config.bgw_job WHERE id = :job_id)
+                                  || '{"parallel_workers": 2}');
+
+-- The policy compresses all the chunks with two workers, which release their
+-- reservations when they are done
+SELECT ts_test_bgw_num_unreserved() AS unreserved \gset
+CALL run_job(:job_id);
+SELECT chunk_name, is_compressed FROM timescaledb_information.chunks
+WHERE hypertable_name = 'metrics' ORDER BY chunk_name;
+SELECT ts_test_bgw_num_unreserved() = :unreserved AS released;
+
+-- The workers compress the chunks that they are given
+SELECT decompress_chunk('_timescaledb_internal._hyper_1_1_chunk');
+SELECT _timescaledb_functions.policy_compression_parallel(
+  :job_id, ARRAY['_timescaledb_internal._hyper_1_1_chunk']::regclass[], 2, false, true
+);
+SELECT chunk_name, is_compressed FROM timescaledb_information.chunks
+WHERE hypertable_name = 'metrics' ORDER BY chunk_name;
+SELECT ts_test_bgw_num_unreserved() = :unreserved AS released;
+
+-- Without any background worker left, no chunk is compressed by workers
+-- and the policy falls back to compressing the chunks itself
+SELECT decompress_chunk('_timescaledb_internal._hyper_1_1_chunk');
+SELECT ts_test_bgw_worker_reserve(:unreserved) = :unreserved AS reserved_all;
+SELECT _timescaledb_functions.policy_compression_parallel(
+  :job_id, ARRAY['_timescaledb_internal._hyper_1_1_chunk']::regclass[], 2, false, true
+);
+SELECT chunk_name, is_compressed FROM timescaledb_information.chunks
+WHERE hypertable_name = 'metrics' ORDER BY chunk_name;
+CALL run_job(:job_id);
+SELECT chunk_name, is_compressed FROM timescaledb_information.chunks
+WHERE hypertable_name = 'metrics' ORDER BY chunk_name;
+SELECT ts_test_bgw_worker_release(:unreserved);
+SELECT ts_test_bgw_num_unreserved() = :unreserved AS released;
+
+-- The data is the same as before
+SELECT count(*), count(DISTINCT device), sum(value) FROM metrics;
+
+DROP TABLE metrics;
@@ -153,3 +153,95 @@ EXPLAIN (costs off) SELECT '1' FROM deleteme_with_bytea WHERE bdata::text = '123
 
 DROP table deleteme;
 DROP table deleteme_with_bytea;
+
+-- Test the bloom filter metadata for the point lookups on non-segmentby columns
+CREATE TABLE bloom(time int NOT NULL, device int, serial int, trace_id text, value float);
+SELECT table_name FROM create_hypertable('bloom', 'time', chunk_time_interval => 100000);
+\set ON_ERROR_STOP 0
+ALTER TABLE bloom SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_bloomfilter = 'device');
+ALTER TABLE bloom SET (timescaledb.compress, timescaledb.compress_bloomfilter = 'nonexistent');
+\set ON_ERROR_STOP 1
+ALTER TABLE bloom SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_bloomfilter = 'serial, trace_id');
+INSERT INTO bloom SELECT i, i % 2, i + 100000, md5(i::text), i FROM generate_series(1, 10000) i;
+SELECT count(compress_chunk(c)) FROM show_chunks('bloom') c;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.hypertable uht ON uht.compressed_hypertable_id = ch.hypertable_id
+WHERE uht.table_name = 'bloom' \gset
+SELECT count(*), count(_ts_meta_bloom_serial), count(_ts_meta_bloom_trace_id) FROM :COMPRESSED_CHUNK;
+-- every batch matches the values it contains
+SELECT count(*) FROM :COMPRESSED_CHUNK
+WHERE _timescaledb_functions.bloom1_contains(_ts_meta_bloom_serial, _ts_meta_min_1 + 100000)
+AND _timescaledb_functions.bloom1_contains(_ts_meta_bloom_serial, _ts_meta_max_1 + 100000)
+AND _timescaledb_functions.bloom1_contains(_ts_meta_bloom_trace_id, md5(_ts_meta_min_1::text));
+-- and most of the other batches are skipped
+SELECT count(*) < 5 FROM :COMPRESSED_CHUNK
+WHERE _timescaledb_functions.bloom1_contains(_ts_meta_bloom_serial, 104242);
+EXPLAIN (costs off) SELECT * FROM bloom WHERE serial = 104242;
+SELECT * FROM bloom WHERE serial = 104242;
+SELECT time FROM bloom WHERE trace_id = md5('4243');
+-- the bloom filter follows the renamed column
+ALTER TABLE bloom RENAME COLUMN serial TO serial_number;
+EXPLAIN (costs off) SELECT * FROM bloom WHERE serial_number = 104242;
+SELECT time FROM bloom WHERE serial_number = 104242;
+DROP TABLE bloom;
+
+-- Test the min/max metadata for the columns that are not orderby
+CREATE TABLE sensors(time int NOT NULL, device int, temperature float, pressure float);
+SELECT table_name FROM create_hypertable('sensors', 'time', chunk_time_interval => 100000);
+\set ON_ERROR_STOP 0
+ALTER TABLE sensors SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_minmax = 'device');
+\set ON_ERROR_STOP 1
+ALTER TABLE sensors SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_minmax = 'temperature, pressure');
+INSERT INTO sensors SELECT i, i % 2, i / 100.0, 200 - i / 100.0 FROM generate_series(1, 10000) i;
+SELECT count(compress_chunk(c)) FROM show_chunks('sensors') c;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.hypertable uht ON uht.compressed_hypertable_id = ch.hypertable_id
+WHERE uht.table_name = 'sensors' \gset
+SELECT count(*) FROM :COMPRESSED_CHUNK WHERE _ts_meta_sparse_max_temperature > 95;
+EXPLAIN (costs off) SELECT * FROM sensors WHERE temperature > 95;
+SELECT count(*), min(temperature) FROM sensors WHERE temperature > 95;
+SELECT count(*) FROM sensors WHERE pressure BETWEEN 150 AND 151;
+DROP TABLE sensors;
+
+-- ANALYZE of the hypertable computes the statistics of the compressed chunks
+-- from the decompressed rows
+CREATE TABLE analyzed(time int NOT NULL, device int, value float, note text);
+SELECT table_name FROM create_hypertable('analyzed', 'time', chunk_time_interval => 100000);
+ALTER TABLE analyzed SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+INSERT INTO analyzed SELECT t, t % 5, t, CASE WHEN t % 4 = 0 THEN NULL ELSE 'n' END FROM generate_series(1, 1000) t;
+SELECT count(compress_chunk(c)) FROM show_chunks('analyzed') c;
+SELECT c AS chunk FROM show_chunks('analyzed') c \gset
+ANALYZE analyzed;
+SELECT attname, null_frac, n_distinct, most_common_vals::text
+FROM pg_stats WHERE format('%I.%I', schemaname, tablename)::regclass = :'chunk'::regclass
+ORDER BY attname;
+DROP TABLE analyzed;
+
+-- The rows of the compressed batches are estimated from the statistics of
+-- the count metadata column of the compressed chunk
+CREATE FUNCTION decompress_chunk_rows(stmt text) RETURNS SETOF text LANGUAGE plpgsql AS $$
+DECLARE
+    plan json;
+BEGIN
+    EXECUTE 'EXPLAIN (FORMAT JSON) ' || stmt INTO plan;
+    RETURN QUERY SELECT jsonb_path_query(plan::jsonb,
+        'strict $.**?(@."Custom Plan Provider" == "DecompressChunk")."Plan Rows"')::text;
+END
+$$;
+CREATE TABLE small_batches(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('small_batches', 'time', chunk_time_interval => 100000);
+ALTER TABLE small_batches SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+INSERT INTO small_batches SELECT t, t % 100, t FROM generate_series(1, 1000) t;
+SELECT count(compress_chunk(c)) FROM show_chunks('small_batches') c;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS compressed_chunk
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.hypertable uht ON uht.compressed_hypertable_id = ch.hypertable_id
+WHERE uht.table_name = 'small_batches' \gset
+ANALYZE :compressed_chunk;
+-- 100 batches of 10 rows each
+SELECT decompress_chunk_rows('SELECT * FROM small_batches');
+SELECT decompress_chunk_rows('SELECT * FROM small_batches WHERE device = 1');
+DROP TABLE small_batches;
+DROP FUNCTION decompress_chunk_rows(text);
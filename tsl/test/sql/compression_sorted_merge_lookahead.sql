@@ -0,0 +1,78 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE FUNCTION batches_read(stmt text) RETURNS SETOF text LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, COSTS OFF, TIMING OFF) ' || stmt LOOP
+        IF line ~ 'Sorted merge append|Batches Read' THEN
+            RETURN NEXT trim(line);
+        END IF;
+    END LOOP;
+END
+$$;
+
+-- Four segments with two batches each. The first batches of all segments
+-- cover the times up to 4000, the second ones the times after it
+CREATE TABLE metrics(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 100000);
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'time');
+INSERT INTO metrics SELECT t, t % 4, t FROM generate_series(1, 8000) t;
+SELECT compress_chunk(show_chunks('metrics'));
+ANALYZE metrics;
+
+-- The sorted merge only decompresses the batches that can contain the next
+-- tuple, so the batch after the last returned tuple stays compressed
+SELECT batches_read('SELECT time FROM metrics ORDER BY time LIMIT 1');
+SELECT batches_read('SELECT time FROM metrics ORDER BY time LIMIT 10');
+SELECT batches_read('SELECT time FROM metrics ORDER BY time DESC LIMIT 3');
+SELECT batches_read('SELECT time FROM metrics ORDER BY time');
+
+SELECT time, device FROM metrics ORDER BY time LIMIT 5;
+SELECT time, device FROM metrics ORDER BY time DESC LIMIT 3;
+SELECT time, device FROM metrics ORDER BY time OFFSET 3998 LIMIT 4;
+
+DROP TABLE metrics;
+DROP FUNCTION batches_read(text);
+
+-- When the open batches of the sorted merge use more memory than allowed, the
+-- rest of the chunk is sorted instead, which returns the same order
+CREATE FUNCTION merge_fallbacks(stmt text) RETURNS SETOF text LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, COSTS OFF, TIMING OFF) ' || stmt LOOP
+        IF line ~ 'Sorted merge append|Sorted Merge Fallbacks' THEN
+            RETURN NEXT trim(line);
+        END IF;
+    END LOOP;
+END
+$$;
+-- Fifty segments with one batch each, which all overlap
+CREATE TABLE fallback(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('fallback', 'time', chunk_time_interval => 100000);
+ALTER TABLE fallback SET (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'time');
+INSERT INTO fallback SELECT t, t % 50, t FROM generate_series(1, 5000) t;
+SELECT count(compress_chunk(c)) FROM show_chunks('fallback') c;
+ANALYZE fallback;
+SELECT merge_fallbacks('SELECT time FROM fallback ORDER BY time');
+SET timescaledb.decompression_sorted_merge_memory TO '64kB';
+SELECT merge_fallbacks('SELECT time FROM fallback ORDER BY time');
+SELECT (SELECT array_agg(time) FROM (SELECT time FROM fallback ORDER BY time) s) =
+    (SELECT array_agg(t ORDER BY t) FROM generate_series(1, 5000) t) AS ordered;
+SELECT time, device FROM fallback ORDER BY time LIMIT 3;
+SELECT time, device FROM fallback ORDER BY time DESC LIMIT 3;
+-- zero disables the limit
+SET timescaledb.decompression_sorted_merge_memory TO 0;
+SELECT merge_fallbacks('SELECT time FROM fallback ORDER BY time');
+SELECT (SELECT array_agg(time) FROM (SELECT time FROM fallback ORDER BY time) s) =
+    (SELECT array_agg(t ORDER BY t) FROM generate_series(1, 5000) t) AS ordered;
+RESET timescaledb.decompression_sorted_merge_memory;
+DROP TABLE fallback;
+DROP FUNCTION merge_fallbacks(text);
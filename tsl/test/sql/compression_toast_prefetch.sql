@@ -0,0 +1,40 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- The md5 strings don't compress, so the compressed batches of the tag column
+-- are stored in the TOAST table
+CREATE TABLE metrics(time int NOT NULL, device int, value float, tag text);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 100000);
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'time');
+INSERT INTO metrics SELECT t, t % 2, (t * 7919) % 10007, md5(t::text) FROM generate_series(1, 10000) t;
+SELECT compress_chunk(show_chunks('metrics'));
+SELECT format('%I.%I', c2.schema_name, c2.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk c1
+JOIN _timescaledb_catalog.chunk c2 ON c1.compressed_chunk_id = c2.id
+WHERE c1.table_name = '_hyper_1_1_chunk' \gset
+SELECT pg_relation_size(reltoastrelid) > 0 AS toasted FROM pg_class WHERE oid = :'COMPRESSED_CHUNK'::regclass;
+
+-- With the read-ahead of the TOAST pages
+SET effective_io_concurrency TO 1;
+-- all columns decompressed together
+SELECT count(*), sum(value), sum(length(tag)) FROM metrics;
+-- the columns of the vectorized quals first, the rest after them
+SELECT count(*), sum(value), count(*) FILTER (WHERE tag LIKE '0%') FROM metrics WHERE value < 100;
+SELECT count(*) FROM metrics WHERE tag LIKE '00%';
+SELECT time, device, value, tag FROM metrics WHERE value < 10 ORDER BY time;
+
+-- The same results without the read-ahead
+SET effective_io_concurrency TO 0;
+-- all columns decompressed together
+SELECT count(*), sum(value), sum(length(tag)) FROM metrics;
+-- the columns of the vectorized quals first, the rest after them
+SELECT count(*), sum(value), count(*) FILTER (WHERE tag LIKE '0%') FROM metrics WHERE value < 100;
+SELECT count(*) FROM metrics WHERE tag LIKE '00%';
+SELECT time, device, value, tag FROM metrics WHERE value < 10 ORDER BY time;
+RESET effective_io_concurrency;
+
+DROP TABLE metrics;
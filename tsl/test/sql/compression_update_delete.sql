@@ -1301,3 +1301,55 @@ ROLLBACK;
 
 RESET client_min_messages;
 DROP TABLE tab1;
+
+-- Test that the batches are filtered on the sparse min/max and bloom filter
+-- metadata of the columns that are neither segmentby nor orderby
+CREATE TABLE sparse_update(time int NOT NULL, device int, serial int, trace text, value float);
+SELECT table_name FROM create_hypertable('sparse_update', 'time', chunk_time_interval => 100000);
+ALTER TABLE sparse_update SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time', timescaledb.compress_minmax = 'serial', timescaledb.compress_bloomfilter = 'trace');
+INSERT INTO sparse_update SELECT i, i % 2, i + 100000, md5(i::text), i FROM generate_series(1, 10000) i;
+SELECT count(compress_chunk(ch)) FROM show_chunks('sparse_update') ch;
+SELECT format('%I.%I', ch.schema_name, ch.table_name) AS "CHUNK"
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.hypertable ht ON ht.id = ch.hypertable_id
+WHERE ht.table_name = 'sparse_update' \gset
+
+-- only the batch with the matching serial range is decompressed
+DELETE FROM sparse_update WHERE serial = 104001;
+SELECT count(*) FROM ONLY :CHUNK;
+
+-- the bloom filter excludes almost all the other batches
+UPDATE sparse_update SET value = 0 WHERE trace = md5('6000');
+SELECT count(*) < 5000 FROM ONLY :CHUNK;
+SELECT count(*), count(*) FILTER (WHERE value = 0) FROM sparse_update;
+DROP TABLE sparse_update;
+
+-- The row decompressor decompresses the batches in bulk when the algorithm
+-- supports it, and row by row otherwise, with the same rows as a result
+CREATE TABLE bulk_rows(time int NOT NULL, device int, value float, label text);
+SELECT table_name FROM create_hypertable('bulk_rows', 'time', chunk_time_interval => 100000);
+ALTER TABLE bulk_rows SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+INSERT INTO bulk_rows
+SELECT t, t % 2, CASE WHEN t % 7 = 0 THEN NULL ELSE t * 0.5 END, 'label ' || t % 4 FROM generate_series(1, 1500) t;
+CREATE TABLE bulk_rows_orig AS SELECT * FROM bulk_rows;
+SELECT count(compress_chunk(c)) FROM show_chunks('bulk_rows') c;
+SELECT c AS "CHUNK" FROM show_chunks('bulk_rows') c \gset
+-- the batch of device 1 is decompressed in bulk
+UPDATE bulk_rows SET value = value WHERE device = 1 AND time = 1;
+SELECT count(*) FROM ONLY :CHUNK;
+SELECT count(*) FROM (SELECT * FROM bulk_rows EXCEPT ALL SELECT * FROM bulk_rows_orig) s;
+SELECT count(*) FROM (SELECT * FROM bulk_rows_orig EXCEPT ALL SELECT * FROM bulk_rows) s;
+SELECT count(compress_chunk(c)) FROM show_chunks('bulk_rows') c;
+-- the batch of device 0 is decompressed row by row
+SET timescaledb.enable_bulk_decompression = off;
+DELETE FROM bulk_rows WHERE device = 0 AND time = 2;
+DELETE FROM bulk_rows_orig WHERE device = 0 AND time = 2;
+SELECT count(*) FROM ONLY :CHUNK;
+RESET timescaledb.enable_bulk_decompression;
+SELECT count(*) FROM (SELECT * FROM bulk_rows EXCEPT ALL SELECT * FROM bulk_rows_orig) s;
+SELECT count(*) FROM (SELECT * FROM bulk_rows_orig EXCEPT ALL SELECT * FROM bulk_rows) s;
+SELECT count(decompress_chunk(c)) FROM show_chunks('bulk_rows') c;
+SELECT count(*) FROM (SELECT * FROM bulk_rows EXCEPT ALL SELECT * FROM bulk_rows_orig) s;
+SELECT count(*) FROM (SELECT * FROM bulk_rows_orig EXCEPT ALL SELECT * FROM bulk_rows) s;
+DROP TABLE bulk_rows;
+DROP TABLE bulk_rows_orig;
@@ -12,7 +12,10 @@
 SELECT format('include/%s_run.sql', :'TEST_BASE_NAME') as "TEST_QUERY_NAME",
        format('%s/results/%s_results_cursor.out', :'TEST_OUTPUT_DIR', :'TEST_BASE_NAME') as "TEST_RESULTS_CURSOR",
        format('%s/results/%s_results_copy.out', :'TEST_OUTPUT_DIR', :'TEST_BASE_NAME') as "TEST_RESULTS_COPY",
-       format('%s/results/%s_results_prepared.out', :'TEST_OUTPUT_DIR', :'TEST_BASE_NAME') as "TEST_RESULTS_PREPARED"
+       format('%s/results/%s_results_prepared.out', :'TEST_OUTPUT_DIR', :'TEST_BASE_NAME') as "TEST_RESULTS_PREPARED",
+       format('%s/results/%s_results_pipelined.out', :'TEST_OUTPUT_DIR', :'TEST_BASE_NAME') as "TEST_RESULTS_PIPELINED",
+       format('%s/results/%s_results_ready_first.out', :'TEST_OUTPUT_DIR', :'TEST_BASE_NAME') as "TEST_RESULTS_READY_FIRST",
+       format('%s/results/%s_results_plan_cache.out', :'TEST_OUTPUT_DIR', :'TEST_BASE_NAME') as "TEST_RESULTS_PLAN_CACHE"
 \gset
 
 SET ROLE :ROLE_CLUSTER_SUPERUSER;
@@ -76,6 +79,150 @@ SELECT format('\! diff %s %s', :'TEST_RESULTS_CURSOR', :'TEST_RESULTS_PREPARED')
 \gset
 :DIFF_CMD
 
+-- run queries using cursor fetcher with pipelined fetching
+SET timescaledb.remote_data_fetcher = 'cursor';
+SET timescaledb.enable_pipelined_fetching TO on;
+\o :TEST_RESULTS_PIPELINED
+\ir :TEST_QUERY_NAME
+\o
+-- compare results
+SELECT format('\! diff %s %s', :'TEST_RESULTS_CURSOR', :'TEST_RESULTS_PIPELINED') as "DIFF_CMD"
+\gset
+:DIFF_CMD
+
+-- two cursors on the same connections, so that one cursor has to read the
+-- in-flight response of the other cursor before it can fetch
+SET enable_hashjoin TO off;
+SET enable_nestloop TO off;
+SELECT count(*) FROM disttable d1 JOIN disttable d2 ON d1.time = d2.time AND d1.device = d2.device;
+RESET enable_hashjoin;
+RESET enable_nestloop;
+RESET timescaledb.enable_pipelined_fetching;
+
+-- run queries using the copy fetcher, reading from the data node that has
+-- data ready first
+SET timescaledb.remote_data_fetcher = 'copy';
+SET timescaledb.enable_async_append_ready_first TO on;
+\o :TEST_RESULTS_READY_FIRST
+\ir :TEST_QUERY_NAME
+\o
+-- compare results
+SELECT format('\! diff %s %s', :'TEST_RESULTS_CURSOR', :'TEST_RESULTS_READY_FIRST') as "DIFF_CMD"
+\gset
+:DIFF_CMD
+
+-- run queries using the cursor fetcher, reading from the data node that has
+-- data ready first
+SET timescaledb.remote_data_fetcher = 'cursor';
+\o :TEST_RESULTS_READY_FIRST
+\ir :TEST_QUERY_NAME
+\o
+-- compare results
+SELECT format('\! diff %s %s', :'TEST_RESULTS_CURSOR', :'TEST_RESULTS_READY_FIRST') as "DIFF_CMD"
+\gset
+:DIFF_CMD
+
+-- unordered scan of all rows, in multiple batches from every data node
+SELECT count(*) FROM (SELECT * FROM disttable LIMIT 100000) d;
+RESET timescaledb.enable_async_append_ready_first;
+
+-- run queries using the prepared statement fetcher, keeping the statements
+-- prepared on the data node connections
+\ir include/remote_exec.sql
+SET timescaledb.remote_data_fetcher = 'prepared';
+SET timescaledb.enable_remote_plan_cache TO on;
+\o :TEST_RESULTS_PLAN_CACHE
+\ir :TEST_QUERY_NAME
+\o
+SELECT sum(table_record[1]::text::int) AS cached_stmts
+FROM test.remote_exec_get_result_strings(NULL, $$
+  SELECT count(*) FROM pg_prepared_statements WHERE name LIKE 'ts_cached_prep_%'
+$$) \gset
+SELECT :cached_stmts > 0 AS statements_cached;
+-- the second run executes the cached statements
+\o :TEST_RESULTS_PLAN_CACHE
+\ir :TEST_QUERY_NAME
+\o
+-- compare results
+SELECT format('\! diff %s %s', :'TEST_RESULTS_CURSOR', :'TEST_RESULTS_PLAN_CACHE') as "DIFF_CMD"
+\gset
+:DIFF_CMD
+SELECT sum(table_record[1]::text::int) - :cached_stmts AS new_stmts
+FROM test.remote_exec_get_result_strings(NULL, $$
+  SELECT count(*) FROM pg_prepared_statements WHERE name LIKE 'ts_cached_prep_%'
+$$);
+RESET timescaledb.enable_remote_plan_cache;
+
+-- calibrate the startup cost of data node scans from the observed times of
+-- earlier scans
+CREATE FUNCTION data_node_scan_startup_costs(query text) RETURNS SETOF float LANGUAGE PLPGSQL AS
+$BODY$
+DECLARE
+  plan json;
+BEGIN
+  EXECUTE 'EXPLAIN (FORMAT JSON) ' || query INTO plan;
+  RETURN QUERY
+  WITH RECURSIVE nodes(node) AS (
+    SELECT plan->0->'Plan'
+    UNION ALL
+    SELECT json_array_elements(node->'Plans') FROM nodes WHERE node->'Plans' IS NOT NULL
+  )
+  SELECT (node->>'Startup Cost')::float FROM nodes
+  WHERE node->>'Custom Plan Provider' = 'DataNodeScan';
+END
+$BODY$;
+SET timescaledb.remote_data_fetcher = 'cursor';
+SET timescaledb.enable_remote_cost_calibration TO on;
+-- no scans observed yet, so the default startup cost is used
+SELECT min(c) AS default_startup_cost FROM data_node_scan_startup_costs('SELECT * FROM disttable') c \gset
+-- scan all rows, in multiple batches from every data node
+SELECT count(*) FROM (SELECT * FROM disttable LIMIT 100000) d;
+SELECT count(*) > 0 AS data_node_scans, bool_and(c <> :default_startup_cost) AS calibrated
+FROM data_node_scan_startup_costs('SELECT * FROM disttable') c;
+RESET timescaledb.enable_remote_cost_calibration;
+SELECT bool_and(c = :default_startup_cost) AS default_cost
+FROM data_node_scan_startup_costs('SELECT * FROM disttable') c;
+DROP FUNCTION data_node_scan_startup_costs;
+
+-- the prepared statement fetcher returns the rows in chunks of the fetch size,
+-- test results that end at and right after a batch boundary
+SET timescaledb.remote_data_fetcher = 'prepared';
+SELECT count(*) FROM (SELECT * FROM disttable LIMIT 100) d;
+SELECT count(*) FROM (SELECT * FROM disttable LIMIT 101) d;
+SELECT count(*) FROM (SELECT * FROM disttable LIMIT 250) d;
+
+-- EXPLAIN ANALYZE shows where the time of the data node scans went
+CREATE FUNCTION explain_analyze_nodes(query text) RETURNS SETOF jsonb LANGUAGE PLPGSQL AS
+$BODY$
+DECLARE
+  plan json;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN QUERY
+  WITH RECURSIVE nodes(node) AS (
+    SELECT plan->0->'Plan'
+    UNION ALL
+    SELECT json_array_elements(node->'Plans') FROM nodes WHERE node->'Plans' IS NOT NULL
+  )
+  SELECT node::jsonb FROM nodes;
+END
+$BODY$;
+SET timescaledb.remote_data_fetcher = 'cursor';
+SET timescaledb.enable_remote_explain_timing TO on;
+SELECT count(*) > 0 AS scans,
+       bool_and(node ?& ARRAY['Connection Time', 'First Batch Time', 'Fetch Time', 'Conversion Time']) AS times,
+       bool_and((node->>'Batches')::int > 1) AS batches,
+       bool_and((node->>'Bytes Received')::bigint > 0) AS bytes
+FROM explain_analyze_nodes('SELECT * FROM disttable') node
+WHERE node->>'Custom Plan Provider' = 'DataNodeScan';
+SELECT bool_and(node ? 'Data Node Wait Time') AS wait_time
+FROM explain_analyze_nodes('SELECT * FROM disttable') node
+WHERE node->>'Custom Plan Provider' = 'AsyncAppend';
+RESET timescaledb.enable_remote_explain_timing;
+SELECT bool_or(node ? 'Batches' OR node ? 'Data Node Wait Time') AS stats
+FROM explain_analyze_nodes('SELECT * FROM disttable') node;
+DROP FUNCTION explain_analyze_nodes;
+
 -- Test custom FDW settings. Instead of the tests above, we are not interersted
 -- in comparing the results of the fetchers. In the following tests we are
 -- interested in the actual outputs (e.g., costs). It's enough to only test them
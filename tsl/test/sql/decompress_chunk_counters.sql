@@ -0,0 +1,47 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- The decompression counters of EXPLAIN ANALYZE, without the values that depend
+-- on the data size and the timing
+CREATE FUNCTION decompress_counters(stmt text, options text = '') RETURNS SETOF text
+LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE format('EXPLAIN (ANALYZE, COSTS OFF%s) %s', options, stmt) LOOP
+        IF line ~ '^\s*(Batches|Columns|Detoasted|Peak|Bulk Decompression Time)' THEN
+            RETURN NEXT regexp_replace(trim(line), '^(Detoasted|Peak|Bulk)(.*): .*$', '\1\2');
+        END IF;
+    END LOOP;
+END
+$$;
+
+-- Three segments with one batch each
+CREATE TABLE metrics(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 100000);
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'time');
+INSERT INTO metrics SELECT t, (t - 1) / 1000, t FROM generate_series(1, 3000) t;
+SELECT compress_chunk(show_chunks('metrics'));
+
+SELECT decompress_counters('SELECT * FROM metrics', ', TIMING OFF');
+
+-- The batches without any rows passing the vectorized quals only decompress the
+-- columns of these quals
+SELECT decompress_counters('SELECT * FROM metrics WHERE value > 2500', ', TIMING OFF');
+
+-- The time spent in the bulk decompression is only shown with TIMING
+SELECT decompress_counters('SELECT * FROM metrics');
+
+SET timescaledb.enable_bulk_decompression TO off;
+SELECT decompress_counters('SELECT * FROM metrics', ', TIMING OFF');
+RESET timescaledb.enable_bulk_decompression;
+
+-- The counters are not shown without the summary
+SELECT decompress_counters('SELECT * FROM metrics', ', TIMING OFF, SUMMARY OFF');
+
+DROP TABLE metrics;
+DROP FUNCTION decompress_counters(text, text);
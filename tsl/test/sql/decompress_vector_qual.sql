@@ -0,0 +1,120 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+create table vectorqual(metric1 int8, ts timestamp, metric2 int8, device int8);
+
+select create_hypertable('vectorqual', 'ts');
+
+alter table vectorqual set (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+
+insert into vectorqual(ts, device, metric1, metric2) values
+    ('2020-01-01 00:00:00', 1, 11, 12),
+    ('2020-01-01 01:00:00', 1, 13, 14),
+    ('2020-01-01 02:00:00', 2, 21, 22),
+    ('2020-01-01 03:00:00', 2, 23, null),
+    ('2020-01-01 04:00:00', 3, 31, 32);
+
+select count(compress_chunk(x, true)) from show_chunks('vectorqual') x;
+
+set timescaledb.debug_require_vector_qual to true;
+
+select count(*) from vectorqual where metric1 > 20;
+select count(*) from vectorqual where metric2 > 20;
+select count(*) from vectorqual where metric2 = 14;
+select count(*) from vectorqual where 20 < metric1;
+select count(*) from vectorqual where metric1 <= 13 and metric2 != 12;
+select count(*) from vectorqual where metric1 > 1::int2;
+select count(*) from vectorqual where ts > '2020-01-01 01:30:00';
+select metric1 from vectorqual where metric2 < 20 order by metric1;
+
+-- some batches don't pass the vectorized quals at all
+select count(*) from vectorqual where metric1 > 30;
+select count(*) from vectorqual where metric1 > 100;
+select metric2 from vectorqual where metric1 < 22 order by metric2;
+
+-- the batches where the column has a default value
+alter table vectorqual add column metric3 int4 default 777;
+select count(*) from vectorqual where metric3 = 777;
+select count(*) from vectorqual where metric3 > 777;
+
+-- check that the GUC actually works
+\set ON_ERROR_STOP 0
+select count(*) from vectorqual where metric1 + 1 > 20;
+\set ON_ERROR_STOP 1
+
+reset timescaledb.debug_require_vector_qual;
+
+-- the output-only columns are decompressed lazily
+select ts from vectorqual where metric1 + 1 > 22 order by ts;
+select ts from vectorqual where metric1 > 22 and metric2 + 1 > 0;
+select ts from vectorqual where metric1 + 1 > 100;
+
+-- the same results without vectorized quals
+set timescaledb.enable_bulk_decompression to off;
+select count(*) from vectorqual where metric1 > 20;
+select metric1 from vectorqual where metric2 < 20 order by metric1;
+reset timescaledb.enable_bulk_decompression;
+
+-- varlena columns with dictionary and array compression
+create table vectortext(ts timestamp, tag text, payload text, value numeric);
+select create_hypertable('vectortext', 'ts');
+alter table vectortext set (timescaledb.compress);
+insert into vectortext select '2020-01-01'::timestamp + interval '1 minute' * x,
+    case when x % 100 = 0 then null else 'tag' || (x % 3) end,
+    'payload' || x, x * 0.1
+from generate_series(1, 1000) x;
+select count(compress_chunk(x, true)) from show_chunks('vectortext') x;
+
+select tag, count(*) from vectortext group by tag order by tag;
+select tag from vectortext where ts > '2020-01-01 16:37' order by ts desc limit 3;
+select count(distinct payload), sum(value) from vectortext;
+select payload, value from vectortext where ts > '2020-01-01 16:37' order by ts desc limit 3;
+
+-- vectorized quals on varlena columns
+set timescaledb.debug_require_vector_qual to true;
+select count(*) from vectortext where tag = 'tag1';
+select count(*) from vectortext where 'tag1' = tag;
+select count(*) from vectortext where tag in ('tag1', 'tag2');
+select count(*) from vectortext where tag != 'tag1';
+select count(*) from vectortext where tag <> all(array['tag1', 'tag2']);
+select count(*) from vectortext where tag = any(array['tag1', null]);
+select count(*) from vectortext where tag <> all(array['tag1', null]);
+select count(*) from vectortext where payload like 'payload99%';
+select count(*) from vectortext where tag = 'tag1' and payload like '%5';
+select count(*) from vectortext where value > 99.5;
+reset timescaledb.debug_require_vector_qual;
+
+set timescaledb.enable_bulk_decompression to off;
+select tag, count(*) from vectortext group by tag order by tag;
+select count(distinct payload), sum(value) from vectortext;
+select count(*) from vectortext where tag in ('tag1', 'tag2');
+select count(*) from vectortext where tag = 'tag1' and payload like '%5';
+reset timescaledb.enable_bulk_decompression;
+
+-- The decompressed batches are cached, and the cached batches are not used
+-- after the data is updated or truncated
+create table batch_cache(ts int not null, device int, value float8, label text);
+select table_name from create_hypertable('batch_cache', 'ts', chunk_time_interval => 100000);
+alter table batch_cache set (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'ts');
+insert into batch_cache select t, t % 3, t, 'label ' || t % 5 from generate_series(1, 3000) t;
+select count(compress_chunk(x)) from show_chunks('batch_cache') x;
+set timescaledb.decompressed_batch_cache_size to '16MB';
+select sum(value), count(distinct label) from batch_cache;
+-- the second time, the batches come from the cache
+select sum(value), count(distinct label) from batch_cache;
+select device, sum(value) from batch_cache where value > 1500 group by device order by device;
+select device, sum(value) from batch_cache where value > 1500 group by device order by device;
+begin;
+select count(decompress_chunk(x)) from show_chunks('batch_cache') x;
+update batch_cache set value = value * 2;
+select count(compress_chunk(x)) from show_chunks('batch_cache') x;
+select sum(value), count(distinct label) from batch_cache;
+commit;
+select sum(value), count(distinct label) from batch_cache;
+truncate batch_cache;
+insert into batch_cache select t, t % 3, -t, 'other' from generate_series(1, 3000) t;
+select count(compress_chunk(x)) from show_chunks('batch_cache') x;
+select sum(value), count(distinct label) from batch_cache;
+reset timescaledb.decompressed_batch_cache_size;
+drop table batch_cache;
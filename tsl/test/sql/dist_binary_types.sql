@@ -0,0 +1,51 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
+
+\set DATA_NODE_1 :TEST_DBNAME _1
+\set DATA_NODE_2 :TEST_DBNAME _2
+
+SELECT node_name, database, node_created, database_created, extension_created
+FROM (
+  SELECT (add_data_node(name, host => 'localhost', DATABASE => name)).*
+  FROM (VALUES (:'DATA_NODE_1'), (:'DATA_NODE_2')) v(name)
+) a;
+
+CREATE TABLE binary_types(time timestamptz NOT NULL, device int, b bool, i2 int2, i4 int4,
+  i8 int8, o oid, f4 float4, f8 float8, d date, ts timestamp, ts3 timestamp(3));
+SELECT table_name FROM create_distributed_hypertable('binary_types', 'time', 'device');
+INSERT INTO binary_types VALUES
+  ('2020-01-01 00:00:00+00', 1, true, 32767, 2147483647, 9223372036854775807, 4294967295,
+   'NaN', 'Infinity', 'infinity', 'infinity', '2020-01-01 00:00:00.1239'),
+  ('2020-01-01 00:00:00+00', 2, false, -32768, -2147483648, -9223372036854775808, 0,
+   '-Infinity', '-0', '-infinity', '-infinity', '2020-01-01 00:00:00.1234'),
+  ('2020-01-02 00:00:00+00', 3, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL),
+  ('2020-01-03 00:00:00+00', 4, true, 0, 0, 0, 1,
+   1.5, 3.14159265358979, '2000-01-01', '1999-12-31 23:59:59.999999', '1999-12-31 23:59:59.9999');
+
+-- The values decoded from the binary format with each fetcher
+SET timescaledb.remote_data_fetcher = 'copy';
+SELECT device, b, i2, i4, i8, o FROM binary_types ORDER BY device;
+SELECT device, f4, f8, d, ts, ts3 FROM binary_types ORDER BY device;
+
+SET timescaledb.remote_data_fetcher = 'cursor';
+SELECT device, b, i2, i4, i8, o FROM binary_types ORDER BY device;
+SELECT device, f4, f8, d, ts, ts3 FROM binary_types ORDER BY device;
+
+SET timescaledb.remote_data_fetcher = 'prepared';
+SELECT device, b, i2, i4, i8, o FROM binary_types ORDER BY device;
+SELECT device, f4, f8, d, ts, ts3 FROM binary_types ORDER BY device;
+
+-- The same values in text format
+SET timescaledb.enable_connection_binary_data TO false;
+SELECT device, b, i2, i4, i8, o FROM binary_types ORDER BY device;
+SELECT device, f4, f8, d, ts, ts3 FROM binary_types ORDER BY device;
+RESET timescaledb.enable_connection_binary_data;
+RESET timescaledb.remote_data_fetcher;
+
+DROP TABLE binary_types;
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
+DROP DATABASE :DATA_NODE_1;
+DROP DATABASE :DATA_NODE_2;
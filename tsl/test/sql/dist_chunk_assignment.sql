@@ -0,0 +1,77 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
+
+\set DATA_NODE_1 :TEST_DBNAME _1
+\set DATA_NODE_2 :TEST_DBNAME _2
+\set DATA_NODE_3 :TEST_DBNAME _3
+
+SELECT node_name, database, node_created, database_created, extension_created
+FROM (
+  SELECT (add_data_node(name, host => 'localhost', DATABASE => name)).*
+  FROM (VALUES (:'DATA_NODE_1'), (:'DATA_NODE_2'), (:'DATA_NODE_3')) v(name)
+) a;
+
+-- Count the data nodes that a query reads from
+CREATE FUNCTION data_node_scans(query text) RETURNS bigint LANGUAGE PLPGSQL AS
+$BODY$
+DECLARE
+  plan json;
+  scans bigint;
+BEGIN
+  EXECUTE 'EXPLAIN (FORMAT JSON) ' || query INTO plan;
+  WITH RECURSIVE nodes(node) AS (
+    SELECT plan->0->'Plan'
+    UNION ALL
+    SELECT json_array_elements(node->'Plans') FROM nodes WHERE node->'Plans' IS NOT NULL
+  )
+  SELECT count(*) INTO scans FROM nodes
+  WHERE node->>'Custom Plan Provider' = 'DataNodeScan';
+  RETURN scans;
+END
+$BODY$;
+
+-- Every space partition is replicated on two of the three data nodes
+CREATE TABLE replicated(time timestamptz NOT NULL, device int, value float);
+SELECT table_name FROM create_distributed_hypertable('replicated', 'time', 'device',
+    chunk_time_interval => interval '1 day', replication_factor => 2);
+
+-- Use devices of two space partitions, so that the data node they share
+-- holds all chunks and each of the other two data nodes half of them
+SELECT
+    min(device) FILTER (WHERE slice = 0) AS device_a,
+    min(device) FILTER (WHERE slice = 1) AS device_b
+FROM (
+  SELECT device, least(_timescaledb_internal.get_partition_hash(device) / (2147483647 / 3), 2) AS slice
+  FROM generate_series(1, 100) device
+) d \gset
+INSERT INTO replicated
+SELECT t, d, 1.0
+FROM generate_series('2020-01-01'::timestamptz, '2020-01-04 12:00', '1 hour') t,
+     unnest(ARRAY[:device_a, :device_b]) d;
+SELECT count(*) FROM show_chunks('replicated');
+
+-- The chunks of a space partition are attached to its first data node
+SET timescaledb.data_node_chunk_assignment = 'attached';
+SELECT data_node_scans('SELECT * FROM replicated');
+SELECT count(*) FROM replicated;
+
+-- All chunks can be read from the shared data node
+SET timescaledb.data_node_chunk_assignment = 'fewest_nodes';
+SELECT data_node_scans('SELECT * FROM replicated');
+SELECT count(*) FROM replicated;
+
+-- Spread the chunks over their replicas
+SET timescaledb.data_node_chunk_assignment = 'balanced';
+SELECT data_node_scans('SELECT * FROM replicated') > 1 AS spread;
+SELECT count(*) FROM replicated;
+RESET timescaledb.data_node_chunk_assignment;
+
+DROP FUNCTION data_node_scans;
+DROP TABLE replicated;
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
+DROP DATABASE :DATA_NODE_1;
+DROP DATABASE :DATA_NODE_2;
+DROP DATABASE :DATA_NODE_3;
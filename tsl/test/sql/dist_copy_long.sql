@@ -117,6 +117,25 @@ select count(*) from uk_price_paid;
 
 select count(*) from uk_price_paid;
 
+-- A data node that is slower than the others must not break the COPY. Rows
+-- for the other data nodes keep flowing while its output is queued.
+create table uk_price_paid_slow(like uk_price_paid);
+select table_name from create_distributed_hypertable('uk_price_paid_slow', 'date', 'postcode2', 3,
+    chunk_time_interval => interval '270 day');
+call distributed_exec($$
+create function slow_insert() returns trigger language plpgsql as
+$body$ begin perform pg_sleep(0.0005); return new; end $body$
+$$, array['data_node_1']);
+call distributed_exec($$
+create trigger slow_insert before insert on uk_price_paid_slow
+    for each row execute function slow_insert()
+$$, array['data_node_1']);
+
+\copy uk_price_paid_slow from program 'zcat < data/prices-10k-random-1.tsv.gz';
+select count(*) from uk_price_paid_slow;
+select count(*) from (select * from uk_price_paid_slow
+    except all select * from uk_price_paid_r2) missing;
+
 -- Teardown
 \c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER
 DROP DATABASE :DN_DBNAME_1;
@@ -1041,6 +1041,29 @@ SELECT * from show_chunks('dist_test');
 
 DROP TABLE dist_test;
 
+-- Distributed DDL runs with the local search_path on the data nodes, which
+-- is reset once all the commands have been executed
+CREATE SCHEMA path_schema;
+SET search_path = path_schema, public;
+CREATE TABLE path_test(time timestamptz NOT NULL, device int, temp float);
+SELECT table_name FROM create_distributed_hypertable('path_test', 'time', 'device');
+CREATE INDEX path_test_temp_idx ON path_test(temp);
+ALTER TABLE path_test ADD COLUMN humidity float;
+SELECT count(*) AS data_nodes, array_agg(DISTINCT table_record[1]::text) AS index_schema
+FROM test.remote_exec_get_result_strings(NULL, $$
+  SELECT schemaname FROM pg_indexes WHERE indexname = 'path_test_temp_idx'
+$$);
+SELECT count(*) AS data_nodes
+FROM test.remote_exec_get_result_strings(NULL, $$
+  SELECT attname FROM pg_attribute
+  WHERE attrelid = 'path_schema.path_test'::regclass AND attname = 'humidity'
+$$);
+SELECT array_agg(DISTINCT table_record[1]::text) AS data_node_search_path
+FROM test.remote_exec_get_result_strings(NULL, $$ SHOW search_path $$);
+RESET search_path;
+DROP TABLE path_schema.path_test;
+DROP SCHEMA path_schema;
+
 -- cleanup
 \c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
 DROP DATABASE :DATA_NODE_1;
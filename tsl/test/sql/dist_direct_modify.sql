@@ -0,0 +1,84 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
+
+\set DATA_NODE_1 :TEST_DBNAME _1
+\set DATA_NODE_2 :TEST_DBNAME _2
+
+SELECT node_name, database, node_created, database_created, extension_created
+FROM (
+  SELECT (add_data_node(name, host => 'localhost', DATABASE => name)).*
+  FROM (VALUES (:'DATA_NODE_1'), (:'DATA_NODE_2')) v(name)
+) a;
+
+-- The statements sent to the data nodes to modify the chunks
+CREATE FUNCTION remote_modify_sql(stmt TEXT) RETURNS SETOF TEXT LANGUAGE PLPGSQL AS
+$BODY$
+DECLARE
+    line TEXT;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (VERBOSE, COSTS OFF) ' || stmt
+    LOOP
+        IF line ~ 'Remote SQL: (UPDATE|DELETE)' THEN
+            RETURN NEXT trim(line);
+        END IF;
+    END LOOP;
+END
+$BODY$;
+
+CREATE FUNCTION modified_rows(stmt TEXT) RETURNS BIGINT LANGUAGE PLPGSQL AS
+$BODY$
+DECLARE
+    num_rows BIGINT;
+BEGIN
+    EXECUTE stmt;
+    GET DIAGNOSTICS num_rows = ROW_COUNT;
+    RETURN num_rows;
+END
+$BODY$;
+
+-- Both chunks are on both data nodes
+CREATE TABLE metrics(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_distributed_hypertable('metrics', 'time',
+  chunk_time_interval => 10, replication_factor => 2);
+INSERT INTO metrics SELECT x, x % 3, 1.0 FROM generate_series(0, 19) x;
+
+-- Without the GUC, the rows are modified one at a time
+SELECT remote_modify_sql('UPDATE metrics SET value = 2.5 WHERE device = 1');
+SELECT remote_modify_sql('DELETE FROM metrics WHERE device = 2');
+
+SET timescaledb.enable_remote_direct_modify TO on;
+
+-- Each chunk is modified with a single statement
+SELECT remote_modify_sql('UPDATE metrics SET value = 2.5 WHERE device = 1');
+SELECT remote_modify_sql('UPDATE metrics SET value = value * 2 WHERE device = 1');
+SELECT remote_modify_sql('DELETE FROM metrics WHERE device = 2');
+SELECT remote_modify_sql('DELETE FROM metrics');
+
+-- RETURNING needs the modified rows
+SELECT remote_modify_sql('DELETE FROM metrics WHERE device = 2 RETURNING time');
+-- Volatile and stable new values would differ between the replicas
+SELECT remote_modify_sql('UPDATE metrics SET value = random()');
+SELECT remote_modify_sql('UPDATE metrics SET value = extract(epoch FROM now())');
+-- Conditions evaluated on the access node
+SELECT remote_modify_sql('DELETE FROM metrics WHERE value > random()');
+-- Conditions with parameters
+SELECT remote_modify_sql('DELETE FROM metrics WHERE device = (SELECT 2)');
+
+-- The number of modified rows is counted once, not per replica
+SELECT modified_rows('UPDATE metrics SET value = value * 2 WHERE device = 1');
+SELECT modified_rows('DELETE FROM metrics WHERE device = 2');
+SELECT device, count(*), sum(value) FROM metrics GROUP BY device ORDER BY device;
+
+-- Both replicas are modified
+\c :DATA_NODE_1 :ROLE_CLUSTER_SUPERUSER
+SELECT device, count(*), sum(value) FROM metrics GROUP BY device ORDER BY device;
+\c :DATA_NODE_2 :ROLE_CLUSTER_SUPERUSER
+SELECT device, count(*), sum(value) FROM metrics GROUP BY device ORDER BY device;
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER
+
+DROP TABLE metrics;
+DROP DATABASE :DATA_NODE_1;
+DROP DATABASE :DATA_NODE_2;
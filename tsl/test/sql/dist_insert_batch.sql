@@ -0,0 +1,83 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
+
+\set DATA_NODE_1 :TEST_DBNAME _1
+\set DATA_NODE_2 :TEST_DBNAME _2
+\set DATA_NODE_3 :TEST_DBNAME _3
+
+SELECT node_name, database, node_created, database_created, extension_created
+FROM (
+  SELECT (add_data_node(name, host => 'localhost', DATABASE => name)).*
+  FROM (VALUES (:'DATA_NODE_1'), (:'DATA_NODE_2'), (:'DATA_NODE_3')) v(name)
+) a;
+
+CREATE TABLE batched(time timestamptz NOT NULL, device int, value float);
+SELECT table_name FROM create_distributed_hypertable('batched', 'time', 'device');
+
+-- Log the rows of every batch that a data node receives. Each batch is a
+-- separate INSERT statement on the data node.
+CALL distributed_exec($$ CREATE SEQUENCE batch_seq $$);
+CALL distributed_exec($$ CREATE TABLE batch_log(batch int, device int) $$);
+CALL distributed_exec($$
+CREATE FUNCTION next_batch() RETURNS TRIGGER LANGUAGE PLPGSQL AS
+$BODY$ BEGIN PERFORM nextval('batch_seq'); RETURN NULL; END $BODY$
+$$);
+CALL distributed_exec($$
+CREATE FUNCTION log_row() RETURNS TRIGGER LANGUAGE PLPGSQL AS
+$BODY$ BEGIN INSERT INTO batch_log VALUES (currval('batch_seq'), NEW.device); RETURN NEW; END $BODY$
+$$);
+CALL distributed_exec($$
+CREATE TRIGGER next_batch BEFORE INSERT ON batched
+    FOR EACH STATEMENT EXECUTE FUNCTION next_batch()
+$$);
+CALL distributed_exec($$
+CREATE TRIGGER log_row BEFORE INSERT ON batched
+    FOR EACH ROW EXECUTE FUNCTION log_row()
+$$);
+
+-- Pick one device for each space partition, and thus for each data node
+SELECT
+    min(device) FILTER (WHERE slice = 0) AS device_a,
+    min(device) FILTER (WHERE slice = 1) AS device_b,
+    min(device) FILTER (WHERE slice = 2) AS device_c
+FROM (
+  SELECT device, least(_timescaledb_internal.get_partition_hash(device) / (2147483647 / 3), 2) AS slice
+  FROM generate_series(1, 100) device
+) d \gset
+
+-- Send the rows round-robin to the data nodes. ON CONFLICT makes the insert
+-- go through DataNodeDispatch instead of COPY. The first data node fills its
+-- batch of 4 rows at the 10th row, when the other two data nodes have 3 rows
+-- each. Their half-full batches are flushed in the same round trip, and the
+-- last row for each of them goes out with the final flush.
+SET timescaledb.max_insert_batch_size = 4;
+INSERT INTO batched
+SELECT '2020-01-01'::timestamptz + i * interval '1 minute',
+       (ARRAY[:device_a, :device_b, :device_c])[i % 3 + 1], i
+FROM generate_series(0, 11) i
+ORDER BY i
+ON CONFLICT DO NOTHING;
+RESET timescaledb.max_insert_batch_size;
+SELECT count(*) FROM batched;
+
+\c :DATA_NODE_1
+SELECT string_agg(rows::text, ',' ORDER BY batch) AS batches_1
+FROM (SELECT batch, count(*) AS rows FROM batch_log GROUP BY batch) b \gset
+\c :DATA_NODE_2
+SELECT string_agg(rows::text, ',' ORDER BY batch) AS batches_2
+FROM (SELECT batch, count(*) AS rows FROM batch_log GROUP BY batch) b \gset
+\c :DATA_NODE_3
+SELECT string_agg(rows::text, ',' ORDER BY batch) AS batches_3
+FROM (SELECT batch, count(*) AS rows FROM batch_log GROUP BY batch) b \gset
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
+
+-- The rows in each batch, for every data node
+SELECT batches FROM unnest(ARRAY[:'batches_1', :'batches_2', :'batches_3']) batches
+ORDER BY batches;
+
+DROP DATABASE :DATA_NODE_1;
+DROP DATABASE :DATA_NODE_2;
+DROP DATABASE :DATA_NODE_3;
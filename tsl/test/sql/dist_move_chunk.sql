@@ -255,6 +255,29 @@ SELECT chunk_schema || '.' ||  chunk_name, data_nodes
 FROM timescaledb_information.chunks
 WHERE hypertable_name = 'dist_test';
 
+-- Copy an uncompressed and a compressed chunk with parallel COPY streams
+-- instead of logical replication
+SET timescaledb.chunk_copy_streams = 2;
+CALL timescaledb_experimental.copy_chunk(chunk=>'_timescaledb_internal._dist_hyper_3_9_chunk', source_node=> :'DATA_NODE_1', destination_node => :'DATA_NODE_2');
+CALL timescaledb_experimental.copy_chunk(chunk=>'_timescaledb_internal._dist_hyper_3_12_chunk', source_node=> :'DATA_NODE_3', destination_node => :'DATA_NODE_1');
+RESET timescaledb.chunk_copy_streams;
+SELECT src.table_record[1]::text = dst.table_record[1]::text AS same_count,
+       src.table_record[2]::text = dst.table_record[2]::text AS same_sum
+FROM test.remote_exec_get_result_strings(ARRAY[:'DATA_NODE_1'], $$
+  SELECT count(*), sum(device) FROM _timescaledb_internal._dist_hyper_3_9_chunk $$) src,
+     test.remote_exec_get_result_strings(ARRAY[:'DATA_NODE_2'], $$
+  SELECT count(*), sum(device) FROM _timescaledb_internal._dist_hyper_3_9_chunk $$) dst;
+SELECT src.table_record[1]::text = dst.table_record[1]::text AS same_count,
+       src.table_record[2]::text = dst.table_record[2]::text AS same_sum
+FROM test.remote_exec_get_result_strings(ARRAY[:'DATA_NODE_3'], $$
+  SELECT count(*), sum(device) FROM _timescaledb_internal._dist_hyper_3_12_chunk $$) src,
+     test.remote_exec_get_result_strings(ARRAY[:'DATA_NODE_1'], $$
+  SELECT count(*), sum(device) FROM _timescaledb_internal._dist_hyper_3_12_chunk $$) dst;
+SELECT chunk_schema || '.' ||  chunk_name, data_nodes
+FROM timescaledb_information.chunks
+WHERE hypertable_name = 'dist_test';
+SELECT sum(device) FROM dist_test;
+
 RESET ROLE;
 DROP DATABASE :DATA_NODE_1;
 DROP DATABASE :DATA_NODE_2;
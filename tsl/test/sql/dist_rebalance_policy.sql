@@ -0,0 +1,69 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
+
+\set DATA_NODE_1 :TEST_DBNAME _1
+\set DATA_NODE_2 :TEST_DBNAME _2
+
+SELECT node_name, database, node_created, database_created, extension_created
+FROM (
+  SELECT (add_data_node(name, host => 'localhost', DATABASE => name)).*
+  FROM (VALUES (:'DATA_NODE_1'), (:'DATA_NODE_2')) v(name)
+) a;
+
+-- All the chunks are created on the first data node before the second one
+-- is attached. The chunks have the same number of rows, so the same size.
+CREATE TABLE metrics(time int NOT NULL, value int);
+SELECT table_name FROM create_distributed_hypertable('metrics', 'time',
+  chunk_time_interval => 10, data_nodes => ARRAY[:'DATA_NODE_1']);
+INSERT INTO metrics SELECT x, x FROM generate_series(0, 49) x;
+SELECT node_name FROM attach_data_node(:'DATA_NODE_2', 'metrics');
+
+SELECT chunk_name, data_nodes FROM timescaledb_information.chunks
+WHERE hypertable_name = 'metrics' ORDER BY chunk_name;
+
+-- Nothing fits in the bytes per run
+SELECT add_rebalance_policy('metrics', max_moves_per_run => 2, max_bytes_per_run => 1)
+  AS job_id \gset
+SELECT config FROM _timescaledb_config.bgw_job WHERE id = :job_id;
+CALL run_job(:job_id);
+SELECT chunk_name, data_nodes FROM timescaledb_information.chunks
+WHERE hypertable_name = 'metrics' ORDER BY chunk_name;
+
+-- The newest closed chunks are moved first and the latest chunk stays. With
+-- five chunks of the same size, the first run moves two of them.
+SELECT config FROM alter_job(:job_id,
+  config => (SELECT config - 'max_bytes_per_run'
+             FROM _timescaledb_config.bgw_job WHERE id = :job_id));
+CALL run_job(:job_id);
+SELECT chunk_name, data_nodes FROM timescaledb_information.chunks
+WHERE hypertable_name = 'metrics' ORDER BY chunk_name;
+
+-- Moving another chunk would only swap the skew between the data nodes, so
+-- the next run moves nothing
+CALL run_job(:job_id);
+SELECT chunk_name, data_nodes FROM timescaledb_information.chunks
+WHERE hypertable_name = 'metrics' ORDER BY chunk_name;
+SELECT count(*) FROM metrics;
+
+\set ON_ERROR_STOP 0
+SELECT add_rebalance_policy('metrics');
+SELECT add_rebalance_policy('metrics', max_moves_per_run => 0);
+SELECT add_rebalance_policy('metrics', max_skew => -1);
+SELECT add_rebalance_policy('metrics', max_bytes_per_run => 0);
+CREATE TABLE plain(time int NOT NULL);
+SELECT table_name FROM create_hypertable('plain', 'time', chunk_time_interval => 10);
+SELECT add_rebalance_policy('plain');
+SELECT add_rebalance_policy('pg_class');
+SELECT remove_rebalance_policy('plain');
+\set ON_ERROR_STOP 1
+SELECT add_rebalance_policy('metrics', if_not_exists => true);
+SELECT remove_rebalance_policy('metrics');
+SELECT remove_rebalance_policy('metrics', if_exists => true);
+
+DROP TABLE metrics;
+DROP TABLE plain;
+DROP DATABASE :DATA_NODE_1;
+DROP DATABASE :DATA_NODE_2;
@@ -0,0 +1,41 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
+
+\set DATA_NODE_1 :TEST_DBNAME _1
+\set DATA_NODE_2 :TEST_DBNAME _2
+
+SELECT node_name, database, node_created, database_created, extension_created
+FROM (
+  SELECT (add_data_node(name, host => 'localhost', DATABASE => name)).*
+  FROM (VALUES (:'DATA_NODE_1'), (:'DATA_NODE_2')) v(name)
+) a;
+
+CREATE TABLE replicated(time timestamptz NOT NULL, device int, value float);
+SELECT table_name FROM create_distributed_hypertable('replicated', 'time', 'device', replication_factor => 2);
+INSERT INTO replicated
+SELECT t, d, 1.0
+FROM generate_series('2020-01-01'::timestamptz, '2020-01-10', '1 day') t, generate_series(1, 4) d;
+SELECT count(*) FROM replicated;
+
+-- simulate a data node being down by renaming its database, but for that
+-- to work we need to reconnect the backend to clear out the connection cache
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
+ALTER DATABASE :DATA_NODE_2 RENAME TO data_node_2_unavailable;
+\set ON_ERROR_STOP 0
+SELECT count(*) FROM replicated;
+\set ON_ERROR_STOP 1
+
+-- with health checks, the chunks of the data node that is down are read
+-- from their replicas on the other data node
+SET timescaledb.data_node_health_check_interval = '1min';
+SELECT count(*) FROM replicated;
+SELECT device, count(*) FROM replicated GROUP BY device ORDER BY device;
+RESET timescaledb.data_node_health_check_interval;
+
+\c :TEST_DBNAME :ROLE_CLUSTER_SUPERUSER;
+ALTER DATABASE data_node_2_unavailable RENAME TO :DATA_NODE_2;
+DROP DATABASE :DATA_NODE_1;
+DROP DATABASE :DATA_NODE_2;
@@ -0,0 +1,75 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE TABLE metrics(time int NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 10);
+SELECT _timescaledb_functions.hypertable_stats_reset();
+
+-- The counts of a statement are visible once it commits. The chunk insert
+-- states are reused for the rows of the same chunk.
+INSERT INTO metrics SELECT x, x % 2, x FROM generate_series(0, 39) x;
+SELECT hypertable_name, rows_inserted, rows_copied, rows_compressed_chunks, chunks_created,
+    chunk_cache_hit_ratio
+FROM timescaledb_information.hypertable_stats;
+COPY metrics FROM STDIN;
+40	0	40
+41	1	41
+42	0	42
+43	1	43
+44	0	44
+\.
+SELECT hypertable_name, rows_inserted, rows_copied, rows_compressed_chunks, chunks_created,
+    chunk_cache_hit_ratio
+FROM timescaledb_information.hypertable_stats;
+SELECT hypertable_cache_hit_ratio > 0 AS cached FROM timescaledb_information.hypertable_stats;
+
+-- The chunks excluded by the planner, at startup and at runtime
+SELECT count(*) FROM metrics WHERE time < 10;
+SELECT chunks_excluded_plan, chunks_excluded_startup, chunks_excluded_runtime
+FROM timescaledb_information.hypertable_stats;
+CREATE FUNCTION ten() RETURNS int LANGUAGE plpgsql STABLE AS
+$$
+BEGIN
+    RETURN 10;
+END
+$$;
+SELECT * FROM metrics WHERE time = ten();
+SELECT chunks_excluded_plan, chunks_excluded_startup, chunks_excluded_runtime
+FROM timescaledb_information.hypertable_stats;
+SELECT * FROM metrics WHERE time = (SELECT 15);
+SELECT chunks_excluded_plan, chunks_excluded_startup, chunks_excluded_runtime
+FROM timescaledb_information.hypertable_stats;
+
+-- The compressed batches that are read, and the rows inserted into compressed chunks
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+SELECT compress_chunk(c) FROM show_chunks('metrics') c ORDER BY c LIMIT 1;
+SELECT _timescaledb_functions.hypertable_stats_reset();
+SELECT count(*) FROM timescaledb_information.hypertable_stats;
+SELECT count(DISTINCT value) FROM metrics;
+SELECT batches_decompressed FROM timescaledb_information.hypertable_stats;
+INSERT INTO metrics VALUES (5, 0, 5);
+SELECT hypertable_name, rows_inserted, rows_copied, rows_compressed_chunks, chunks_created,
+    chunk_cache_hit_ratio
+FROM timescaledb_information.hypertable_stats;
+
+-- Nothing is collected when the stats are off
+SET timescaledb.enable_hypertable_stats TO off;
+INSERT INTO metrics VALUES (6, 0, 6), (50, 0, 50);
+SELECT hypertable_name, rows_inserted, rows_copied, rows_compressed_chunks, chunks_created,
+    chunk_cache_hit_ratio
+FROM timescaledb_information.hypertable_stats;
+RESET timescaledb.enable_hypertable_stats;
+
+-- Only the superuser can reset the stats, and everyone can read them
+\c :TEST_DBNAME :ROLE_DEFAULT_PERM_USER
+SELECT _timescaledb_functions.hypertable_stats_reset();
+SELECT hypertable_name, rows_inserted FROM timescaledb_information.hypertable_stats;
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- The stats of a dropped hypertable are removed
+DROP TABLE metrics;
+SELECT count(*) FROM _timescaledb_functions.hypertable_stats();
+DROP FUNCTION ten();
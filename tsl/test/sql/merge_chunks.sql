@@ -0,0 +1,107 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+CREATE VIEW chunk_slices AS
+SELECT h.table_name AS hypertable, c.table_name AS chunk, c.status, ds.range_start, ds.range_end
+FROM _timescaledb_catalog.chunk c
+JOIN _timescaledb_catalog.hypertable h ON h.id = c.hypertable_id
+JOIN _timescaledb_catalog.chunk_constraint cc ON cc.chunk_id = c.id
+JOIN _timescaledb_catalog.dimension_slice ds ON ds.id = cc.dimension_slice_id
+WHERE NOT c.dropped
+ORDER BY h.table_name, ds.range_start;
+
+CREATE TABLE metrics(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 10);
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+INSERT INTO metrics SELECT x, x % 2, x FROM generate_series(0, 59) x;
+
+CREATE TABLE other(time int NOT NULL, value float);
+SELECT table_name FROM create_hypertable('other', 'time', chunk_time_interval => 10);
+INSERT INTO other VALUES (0, 0);
+
+SELECT chunk, status, range_start, range_end FROM chunk_slices WHERE hypertable = 'metrics';
+
+\set ON_ERROR_STOP 0
+SELECT merge_chunks('_timescaledb_internal._hyper_1_1_chunk', '_timescaledb_internal._hyper_1_1_chunk');
+SELECT merge_chunks('_timescaledb_internal._hyper_1_1_chunk', '_timescaledb_internal._hyper_1_3_chunk');
+SELECT merge_chunks('_timescaledb_internal._hyper_1_1_chunk', '_timescaledb_internal._hyper_3_7_chunk');
+SELECT merge_chunks('metrics', '_timescaledb_internal._hyper_1_1_chunk');
+\set ON_ERROR_STOP 1
+
+-- uncompressed chunks, the later chunk is merged into the earlier one
+SELECT merge_chunks('_timescaledb_internal._hyper_1_1_chunk', '_timescaledb_internal._hyper_1_2_chunk');
+SELECT merge_chunks('_timescaledb_internal._hyper_1_4_chunk', '_timescaledb_internal._hyper_1_3_chunk');
+SELECT chunk, status, range_start, range_end FROM chunk_slices WHERE hypertable = 'metrics';
+SELECT count(*) FROM _timescaledb_internal._hyper_1_1_chunk;
+SELECT count(*), sum(value) FROM metrics;
+-- the merged chunk takes the inserts for its new range
+INSERT INTO metrics VALUES (15, 0, -1);
+SELECT count(*) FROM _timescaledb_internal._hyper_1_1_chunk;
+DELETE FROM metrics WHERE value = -1;
+
+-- compressed chunks, the merged batches get the following sequence numbers
+SELECT count(compress_chunk(c)) FROM show_chunks('metrics', newer_than => 40) c;
+SELECT format('%I.%I', cc.schema_name, cc.table_name) AS compressed_chunk
+FROM _timescaledb_catalog.chunk c
+JOIN _timescaledb_catalog.chunk cc ON cc.id = c.compressed_chunk_id
+WHERE c.table_name = '_hyper_1_5_chunk' \gset
+SELECT max(_ts_meta_sequence_num) AS max_seqnum FROM :compressed_chunk \gset
+SELECT merge_chunks('_timescaledb_internal._hyper_1_5_chunk', '_timescaledb_internal._hyper_1_6_chunk');
+SELECT _ts_meta_min_1 >= 50 AS merged, count(*),
+    bool_and(_ts_meta_sequence_num > :max_seqnum) AS after_existing
+FROM :compressed_chunk GROUP BY 1 ORDER BY 1;
+SELECT count(DISTINCT (device, _ts_meta_sequence_num)) FROM :compressed_chunk;
+-- the chunk is unordered, because the merged batches are later on time, which
+-- is ordered descending
+SELECT chunk, status, range_start, range_end FROM chunk_slices WHERE hypertable = 'metrics';
+SELECT numrows_pre_compression FROM _timescaledb_catalog.compression_chunk_size
+WHERE chunk_id = 5;
+SELECT count(*), sum(value) FROM metrics WHERE time >= 40;
+
+\set ON_ERROR_STOP 0
+SELECT merge_chunks('_timescaledb_internal._hyper_1_3_chunk', '_timescaledb_internal._hyper_1_5_chunk');
+\set ON_ERROR_STOP 1
+
+-- the uncompressed rows of a partial chunk make the merged chunk partial
+SELECT count(compress_chunk(c)) FROM show_chunks('metrics', older_than => 40) c;
+INSERT INTO metrics VALUES (25, 0, -1);
+SELECT chunk, status, range_start, range_end FROM chunk_slices WHERE hypertable = 'metrics';
+SELECT merge_chunks('_timescaledb_internal._hyper_1_1_chunk', '_timescaledb_internal._hyper_1_3_chunk');
+SELECT chunk, status, range_start, range_end FROM chunk_slices WHERE hypertable = 'metrics';
+SELECT count(*), sum(value) FROM metrics;
+SELECT count(*), sum(value) FROM metrics WHERE time < 40;
+
+-- merge chunks policy
+CREATE TABLE policy_ht(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('policy_ht', 'time', chunk_time_interval => 10);
+CREATE FUNCTION policy_ht_now() RETURNS int LANGUAGE SQL STABLE AS 'SELECT 100';
+SELECT set_integer_now_func('policy_ht', 'policy_ht_now');
+INSERT INTO policy_ht SELECT x, x FROM generate_series(0, 79) x;
+
+\set ON_ERROR_STOP 0
+SELECT add_merge_chunks_policy('policy_ht', interval '1 day', interval '2 days');
+\set ON_ERROR_STOP 1
+
+SELECT add_merge_chunks_policy('policy_ht', 30, 40) AS job_id \gset
+SELECT config->>'merge_after' AS merge_after, config->>'max_chunk_interval' AS max_chunk_interval
+FROM _timescaledb_config.bgw_job WHERE id = :job_id;
+\set ON_ERROR_STOP 0
+SELECT add_merge_chunks_policy('policy_ht', 30, 40);
+\set ON_ERROR_STOP 1
+SELECT add_merge_chunks_policy('policy_ht', 30, 40, if_not_exists => true);
+
+-- the chunks older than 70 are merged up to 40 wide, the chunk from 70 to 80
+-- stays as it is
+CALL run_job(:job_id);
+SELECT range_start, range_end FROM chunk_slices WHERE hypertable = 'policy_ht';
+SELECT count(*), sum(value) FROM policy_ht;
+-- nothing more to merge
+CALL run_job(:job_id);
+SELECT range_start, range_end FROM chunk_slices WHERE hypertable = 'policy_ht';
+
+SELECT remove_merge_chunks_policy('policy_ht');
+SELECT remove_merge_chunks_policy('policy_ht', if_exists => true);
+SELECT count(*) FROM _timescaledb_config.bgw_job WHERE id = :job_id;
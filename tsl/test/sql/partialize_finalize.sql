@@ -380,3 +380,88 @@ SELECT
   _timescaledb_internal.finalize_agg('pg_catalog.max(integer)'::text, NULL::name, NULL::name, '{{pg_catalog,int4}}'::name[], partial_max, NULL::integer) AS max,
   _timescaledb_internal.finalize_agg('pg_catalog.count()'::text, NULL::name, NULL::name, '{}'::name[], partial_count, NULL::bigint) AS count
 FROM issue4922_partials_parallel;
+
+-- The partials of count, and of sum, min and max of the integer and float
+-- types are decoded and combined inline
+CREATE TABLE fast_path(g int, sub int, i2 int2, i4 int4, i8 int8, f4 float4, f8 float8);
+INSERT INTO fast_path
+SELECT i % 3, i % 4, (i * 7 % 100 - 50)::int2, i * 1000, i::int8 * 10000000000, i * 0.5, i * 0.25
+FROM generate_series(1, 1000) i;
+INSERT INTO fast_path VALUES (2, 5, NULL, NULL, NULL, 'NaN', 'NaN'), (1, 9, NULL, NULL, NULL, NULL, NULL);
+
+CREATE TABLE fast_path_partials AS
+SELECT g, sub,
+    _timescaledb_internal.partialize_agg(count(*)) AS p0,
+    _timescaledb_internal.partialize_agg(count(i4)) AS p1,
+    _timescaledb_internal.partialize_agg(sum(i2)) AS p2,
+    _timescaledb_internal.partialize_agg(sum(i4)) AS p3,
+    _timescaledb_internal.partialize_agg(min(i2)) AS p4,
+    _timescaledb_internal.partialize_agg(max(i2)) AS p5,
+    _timescaledb_internal.partialize_agg(min(i4)) AS p6,
+    _timescaledb_internal.partialize_agg(max(i4)) AS p7,
+    _timescaledb_internal.partialize_agg(min(i8)) AS p8,
+    _timescaledb_internal.partialize_agg(max(i8)) AS p9,
+    _timescaledb_internal.partialize_agg(sum(f4)) AS p10,
+    _timescaledb_internal.partialize_agg(min(f4)) AS p11,
+    _timescaledb_internal.partialize_agg(max(f4)) AS p12,
+    _timescaledb_internal.partialize_agg(sum(f8)) AS p13,
+    _timescaledb_internal.partialize_agg(min(f8)) AS p14,
+    _timescaledb_internal.partialize_agg(max(f8)) AS p15
+FROM fast_path GROUP BY g, sub;
+
+CREATE VIEW fast_path_finalized AS
+SELECT g,
+    _timescaledb_internal.finalize_agg('pg_catalog.count()', NULL, NULL, '{}', p0, NULL::bigint) AS a0,
+    _timescaledb_internal.finalize_agg('pg_catalog.count("any")', NULL, NULL, NULL, p1, NULL::bigint) AS a1,
+    _timescaledb_internal.finalize_agg('pg_catalog.sum(smallint)', NULL, NULL, '{{pg_catalog,int2}}', p2, NULL::bigint) AS a2,
+    _timescaledb_internal.finalize_agg('pg_catalog.sum(integer)', NULL, NULL, '{{pg_catalog,int4}}', p3, NULL::bigint) AS a3,
+    _timescaledb_internal.finalize_agg('pg_catalog.min(smallint)', NULL, NULL, '{{pg_catalog,int2}}', p4, NULL::smallint) AS a4,
+    _timescaledb_internal.finalize_agg('pg_catalog.max(smallint)', NULL, NULL, '{{pg_catalog,int2}}', p5, NULL::smallint) AS a5,
+    _timescaledb_internal.finalize_agg('pg_catalog.min(integer)', NULL, NULL, '{{pg_catalog,int4}}', p6, NULL::integer) AS a6,
+    _timescaledb_internal.finalize_agg('pg_catalog.max(integer)', NULL, NULL, '{{pg_catalog,int4}}', p7, NULL::integer) AS a7,
+    _timescaledb_internal.finalize_agg('pg_catalog.min(bigint)', NULL, NULL, '{{pg_catalog,int8}}', p8, NULL::bigint) AS a8,
+    _timescaledb_internal.finalize_agg('pg_catalog.max(bigint)', NULL, NULL, '{{pg_catalog,int8}}', p9, NULL::bigint) AS a9,
+    _timescaledb_internal.finalize_agg('pg_catalog.sum(real)', NULL, NULL, '{{pg_catalog,float4}}', p10, NULL::real) AS a10,
+    _timescaledb_internal.finalize_agg('pg_catalog.min(real)', NULL, NULL, '{{pg_catalog,float4}}', p11, NULL::real) AS a11,
+    _timescaledb_internal.finalize_agg('pg_catalog.max(real)', NULL, NULL, '{{pg_catalog,float4}}', p12, NULL::real) AS a12,
+    _timescaledb_internal.finalize_agg('pg_catalog.sum(double precision)', NULL, NULL, '{{pg_catalog,float8}}', p13, NULL::double precision) AS a13,
+    _timescaledb_internal.finalize_agg('pg_catalog.min(double precision)', NULL, NULL, '{{pg_catalog,float8}}', p14, NULL::double precision) AS a14,
+    _timescaledb_internal.finalize_agg('pg_catalog.max(double precision)', NULL, NULL, '{{pg_catalog,float8}}', p15, NULL::double precision) AS a15
+FROM fast_path_partials GROUP BY g;
+CREATE VIEW fast_path_direct AS
+SELECT g,
+    count(*) AS a0,
+    count(i4) AS a1,
+    sum(i2) AS a2,
+    sum(i4) AS a3,
+    min(i2) AS a4,
+    max(i2) AS a5,
+    min(i4) AS a6,
+    max(i4) AS a7,
+    min(i8) AS a8,
+    max(i8) AS a9,
+    sum(f4) AS a10,
+    min(f4) AS a11,
+    max(f4) AS a12,
+    sum(f8) AS a13,
+    min(f8) AS a14,
+    max(f8) AS a15
+FROM fast_path GROUP BY g;
+
+SELECT count(*) FROM (
+    (SELECT * FROM fast_path_finalized EXCEPT SELECT * FROM fast_path_direct)
+    UNION ALL
+    (SELECT * FROM fast_path_direct EXCEPT SELECT * FROM fast_path_finalized)) d;
+SELECT g, a0 AS count, a3 AS sum_i4, a4 AS min_i2, a5 AS max_i2, a15 AS max_f8 FROM fast_path_finalized ORDER BY g;
+
+-- The combination overflows like the built-in combine function
+SELECT _timescaledb_internal.finalize_agg('pg_catalog.sum(integer)', NULL, NULL, '{{pg_catalog,int4}}', p, NULL::bigint)
+FROM (VALUES ('\x7fffffffffffffff'::bytea), ('\x0000000000000001'::bytea)) v(p);
+-- A partial of the wrong length is rejected by the receive function
+SELECT _timescaledb_internal.finalize_agg('pg_catalog.sum(integer)', NULL, NULL, '{{pg_catalog,int4}}', p, NULL::bigint)
+FROM (VALUES ('\x0000000000000001'::bytea), ('\x0001'::bytea)) v(p);
+
+DROP VIEW fast_path_finalized;
+DROP VIEW fast_path_direct;
+DROP TABLE fast_path_partials;
+DROP TABLE fast_path;
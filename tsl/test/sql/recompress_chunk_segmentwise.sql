@@ -64,7 +64,7 @@ SELECT ctid, * FROM :compressed_chunk_name_1;
 select numrows_pre_compression, numrows_post_compression from _timescaledb_catalog.compression_chunk_size;
 
 ---------------- test1: one affected segment, one unaffected --------------
--- unaffected segment will still be recompressed in a future PR we want to avoid doing this
+-- the unaffected segment is left as it is
 create table mytab_twoseg (time timestamptz not null, a int, b int, c int);
 
 SELECT create_hypertable('mytab_twoseg', 'time', chunk_time_interval => interval '1 day');
@@ -269,3 +269,19 @@ select * from :compressed_chunk_name;
 insert into nullseg_many values (:'start_time', 1, NULL, NULL);
 call recompress_chunk(:'chunk_to_compress');
 select * from :compressed_chunk_name;
+
+-- only the batches that overlap the new rows are rewritten, and the new
+-- compressed rows get the sequence numbers between the remaining batches
+create table mytab_batches (time int not null, device int, value int);
+select table_name from create_hypertable('mytab_batches', 'time', chunk_time_interval => 100000);
+alter table mytab_batches set (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+insert into mytab_batches select t, d, t from generate_series(1, 3000) t, generate_series(1, 2) d;
+select count(compress_chunk(c)) from show_chunks('mytab_batches') c;
+select show_chunks as chunk_to_compress from show_chunks('mytab_batches') limit 1 \gset
+select compressed_chunk_schema || '.' || compressed_chunk_name as compressed_chunk_name from compressed_chunk_info_view where hypertable_name = 'mytab_batches' \gset
+-- overlaps the second batch of device 1, and follows the last batch of device 2
+insert into mytab_batches values (1500, 1, -1), (3500, 2, -1);
+select _timescaledb_internal.recompress_chunk_segmentwise(:'chunk_to_compress') is not null as recompressed;
+select ctid, device, _ts_meta_count, _ts_meta_sequence_num, _ts_meta_min_1, _ts_meta_max_1 from :compressed_chunk_name order by device, _ts_meta_sequence_num;
+select numrows_pre_compression, numrows_post_compression from compression_rowcnt_view where chunk_name = :'chunk_to_compress';
+select * from mytab_batches where time between 1499 and 1501 or time > 2999 order by device, time, value;
@@ -0,0 +1,53 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT _timescaledb_internal.stop_background_workers();
+
+CREATE TABLE readings(time timestamptz NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('readings', 'time', chunk_time_interval => interval '1 day');
+ALTER TABLE readings SET (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+INSERT INTO readings
+SELECT time, device, device
+FROM generate_series('2000-01-01 00:00:00+00'::timestamptz, '2000-01-03 23:59:00+00', '1 minute') time,
+  generate_series(1, 4) device;
+SELECT count(compress_chunk(c)) FROM show_chunks('readings') c;
+
+CREATE VIEW readings_chunks AS
+SELECT c.table_name, c.status
+FROM _timescaledb_catalog.chunk c
+JOIN _timescaledb_catalog.hypertable h ON h.id = c.hypertable_id
+WHERE h.table_name = 'readings'
+ORDER BY c.id;
+
+-- A few rows in the first chunk, many rows in the second chunk
+INSERT INTO readings SELECT '2000-01-01 12:00:30+00', device, 0 FROM generate_series(1, 10) device;
+INSERT INTO readings
+SELECT time, device, 0
+FROM generate_series('2000-01-02 00:00:30+00'::timestamptz, '2000-01-02 23:59:30+00', '1 minute') time,
+  generate_series(1, 4) device;
+SELECT * FROM readings_chunks;
+
+-- With a byte limit, a run recompresses the chunk with the most
+-- uncompressed data first, and always at least one chunk
+SELECT add_job('_timescaledb_internal.policy_recompression', '1w',
+  config => '{"hypertable_id": 1, "recompress_after": "@ 7 days", "maxbytes_to_recompress": 1}') AS job_id \gset
+CALL run_job(:job_id);
+SELECT * FROM readings_chunks;
+SELECT count(*), sum(value) FROM readings;
+
+-- Without the limit, the remaining chunk is recompressed
+SELECT config ? 'maxbytes_to_recompress' AS limited
+FROM alter_job(:job_id, config => (SELECT config - 'maxbytes_to_recompress' FROM _timescaledb_config.bgw_job WHERE id = :job_id));
+CALL run_job(:job_id);
+SELECT * FROM readings_chunks;
+SELECT count(*), sum(value) FROM readings;
+SELECT device, count(*) FROM readings
+WHERE time >= '2000-01-01 00:00:00+00' AND time < '2000-01-02 00:00:00+00'
+GROUP BY device ORDER BY device;
+
+-- Nothing is left to do
+CALL run_job(:job_id);
+SELECT * FROM readings_chunks;
+SELECT delete_job(:job_id);
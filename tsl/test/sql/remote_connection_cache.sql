@@ -56,5 +56,16 @@ WHERE user_name='bob'
 ORDER BY 1,2;
 ROLLBACK;
 
+-- Cached connections that have not been used for longer than the idle timeout
+-- are closed at the end of a transaction
+SET timescaledb.data_node_connection_idle_timeout = '1s';
+CALL distributed_exec('SELECT 1');
+SELECT node_name FROM _timescaledb_functions.show_connection_cache()
+WHERE user_name = current_user
+ORDER BY 1;
+SELECT pg_sleep(1.1);
+SELECT count(*) FROM _timescaledb_functions.show_connection_cache();
+RESET timescaledb.data_node_connection_idle_timeout;
+
 DROP DATABASE :DN_DBNAME_1;
 DROP DATABASE :DN_DBNAME_2;
@@ -565,6 +565,38 @@ SELECT count(*) FROM "S 1"."T 1" WHERE "C 1" > 10016;
 SELECT count(*) FROM pg_prepared_xacts;
 
 
+-- a transaction on both data nodes writes the commit records of both with
+-- the same transaction of the access node
+BEGIN;
+    SELECT test.remote_exec('{loopback}', $$ INSERT INTO "S 1"."T 1" VALUES (10052,1,'bleh', '2001-01-01', '2001-01-01', 'bleh') $$);
+    SELECT test.remote_exec('{loopback2}', $$ INSERT INTO "S 1"."T 1" VALUES (10053,1,'bleh', '2001-01-01', '2001-01-01', 'bleh') $$);
+    SELECT pg_current_xact_id()::xid::text AS xid \gset
+COMMIT;
+SELECT data_node_name FROM _timescaledb_catalog.remote_txn
+WHERE split_part(remote_transaction_id, '-', 3) = :'xid' ORDER BY 1;
+SELECT count(*) FROM "S 1"."T 1" WHERE "C 1" IN (10052, 10053);
+SELECT count(*) FROM pg_prepared_xacts;
+
+-- with one-phase commit for single data node transactions, a transaction
+-- that only writes on one data node does not write a commit record
+SET timescaledb.enable_single_data_node_1pc TO on;
+SELECT count(*) AS records FROM _timescaledb_catalog.remote_txn \gset
+BEGIN;
+    SELECT test.remote_exec('{loopback}', $$ INSERT INTO "S 1"."T 1" VALUES (10054,1,'bleh', '2001-01-01', '2001-01-01', 'bleh') $$);
+COMMIT;
+SELECT count(*) - :records AS new_records FROM _timescaledb_catalog.remote_txn;
+SELECT count(*) FROM "S 1"."T 1" WHERE "C 1" = 10054;
+-- a transaction that also writes on the access node still uses 2PC
+CREATE TABLE local_writes(i int);
+BEGIN;
+    INSERT INTO local_writes VALUES (1);
+    SELECT test.remote_exec('{loopback}', $$ INSERT INTO "S 1"."T 1" VALUES (10055,1,'bleh', '2001-01-01', '2001-01-01', 'bleh') $$);
+COMMIT;
+SELECT count(*) - :records AS new_records FROM _timescaledb_catalog.remote_txn;
+SELECT count(*) FROM "S 1"."T 1" WHERE "C 1" = 10055;
+DROP TABLE local_writes;
+RESET timescaledb.enable_single_data_node_1pc;
+
 --block preparing transactions on the frontend
 BEGIN;
     SELECT test.remote_exec('{loopback}', $$ INSERT INTO "S 1"."T 1" VALUES (10051,1,'bleh', '2001-01-01', '2001-01-01', 'bleh') $$);
@@ -0,0 +1,114 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- Count the runtime filter nodes in the plan of the query, and the compressed
+-- batches they pruned in the DecompressChunk nodes
+CREATE FUNCTION runtime_filters(query text)
+RETURNS TABLE(filters int, batches_filtered bigint, parallel boolean) LANGUAGE plpgsql AS
+$$
+DECLARE
+    line text;
+BEGIN
+    filters := 0;
+    parallel := false;
+    FOR line IN EXECUTE 'EXPLAIN (analyze, costs off, timing off, summary on) ' || query LOOP
+        IF line ~ 'RuntimeFilterBuild' THEN
+            filters := filters + 1;
+        ELSIF line ~ 'Batches Filtered by Runtime Filters' THEN
+            batches_filtered := coalesce(batches_filtered, 0) +
+                substring(line FROM '(\d+)$')::bigint;
+        ELSIF line ~ 'Parallel Hash' THEN
+            parallel := true;
+        END IF;
+    END LOOP;
+    RETURN NEXT;
+END
+$$;
+
+-- Two chunks with one compressed batch per device each
+CREATE TABLE metrics(time int NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 500);
+INSERT INTO metrics SELECT x, x % 10, x FROM generate_series(0, 999) x;
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'time');
+SELECT count(compress_chunk(c)) FROM show_chunks('metrics') c;
+CREATE TABLE devices(id int, name text);
+INSERT INTO devices SELECT x, 'device ' || x FROM generate_series(0, 9) x;
+INSERT INTO devices VALUES (-1, 'unknown');
+CREATE TABLE devices8(id bigint, name text);
+INSERT INTO devices8 SELECT id, name FROM devices;
+CREATE TABLE times(time int);
+INSERT INTO times VALUES (10), (20);
+CREATE TABLE times8(time bigint);
+INSERT INTO times8 VALUES (10), (20);
+ANALYZE devices, devices8, times, times8;
+
+SET timescaledb.enable_runtime_filter TO on;
+SET enable_mergejoin TO off;
+SET enable_nestloop TO off;
+
+-- A segmentby key is checked against the range and the bloom filter of the
+-- inner keys, which leaves the batches of device 0 in both chunks
+SELECT count(*) FROM metrics m JOIN devices d ON m.device = d.id WHERE d.name = 'device 0';
+SELECT * FROM runtime_filters($$SELECT count(*) FROM metrics m JOIN devices d ON m.device = d.id WHERE d.name = 'device 0'$$);
+-- a semi join
+SELECT count(*) FROM metrics m WHERE m.device IN (SELECT id FROM devices WHERE name = 'device 0');
+SELECT * FROM runtime_filters($$SELECT count(*) FROM metrics m WHERE m.device IN (SELECT id FROM devices WHERE name = 'device 0')$$);
+-- a right join, which keeps the inner rows without a match but still discards
+-- the outer ones
+SELECT count(*), count(m.value) FROM metrics m RIGHT JOIN devices d ON m.device = d.id
+WHERE d.name IN ('device 0', 'unknown');
+SELECT * FROM runtime_filters($$SELECT count(*), count(m.value) FROM metrics m RIGHT JOIN devices d ON m.device = d.id
+WHERE d.name IN ('device 0', 'unknown')$$);
+
+-- A compressed column is checked against the min/max metadata of the batches,
+-- only the batches of the second chunk are past the inner keys
+SELECT count(*) FROM metrics m JOIN times t ON m.time = t.time;
+SELECT * FROM runtime_filters($$SELECT count(*) FROM metrics m JOIN times t ON m.time = t.time$$);
+-- without the metadata the batches of a compressed column can't be checked
+SELECT count(*) FROM metrics m JOIN times t ON m.value = t.time;
+SELECT * FROM runtime_filters($$SELECT count(*) FROM metrics m JOIN times t ON m.value = t.time$$);
+
+-- A cross-type operator has no comparison function for the range, so a
+-- compressed column gets no filter, and a segmentby key only the bloom filter
+SELECT count(*) FROM metrics m JOIN times8 t ON m.time = t.time;
+SELECT * FROM runtime_filters($$SELECT count(*) FROM metrics m JOIN times8 t ON m.time = t.time$$);
+SELECT count(*) FROM metrics m JOIN devices8 d ON m.device = d.id WHERE d.name = 'device 0';
+SELECT filters, batches_filtered > 0 AS pruned FROM runtime_filters($$SELECT count(*) FROM metrics m JOIN devices8 d ON m.device = d.id WHERE d.name = 'device 0'$$);
+
+-- A left join has to return the outer rows without a match
+SELECT count(*), count(d.name) FROM metrics m
+LEFT JOIN devices d ON m.device = d.id AND d.name = 'device 0';
+SELECT * FROM runtime_filters($$SELECT count(*), count(d.name) FROM metrics m
+LEFT JOIN devices d ON m.device = d.id AND d.name = 'device 0'$$);
+-- A parameterized inner side can change on every rescan of the join
+SELECT d.name, (SELECT count(*) FROM metrics m JOIN devices i ON m.device = i.id
+    WHERE i.name = d.name)
+FROM devices d WHERE d.id IN (0, 1) ORDER BY 1;
+SELECT * FROM runtime_filters($$SELECT d.name, (SELECT count(*) FROM metrics m JOIN devices i ON m.device = i.id
+    WHERE i.name = d.name)
+FROM devices d WHERE d.id IN (0, 1) ORDER BY 1$$);
+-- The participants of a parallel hash join only see a part of the inner side
+SET parallel_setup_cost TO 0;
+SET parallel_tuple_cost TO 0;
+SET min_parallel_table_scan_size TO 0;
+SET max_parallel_workers_per_gather TO 2;
+SELECT count(*) FROM metrics m JOIN devices d ON m.device = d.id WHERE d.name = 'device 0';
+SELECT * FROM runtime_filters($$SELECT count(*) FROM metrics m JOIN devices d ON m.device = d.id WHERE d.name = 'device 0'$$);
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET min_parallel_table_scan_size;
+RESET max_parallel_workers_per_gather;
+
+-- The filters are off by default
+RESET timescaledb.enable_runtime_filter;
+SELECT count(*) FROM metrics m JOIN devices d ON m.device = d.id WHERE d.name = 'device 0';
+SELECT * FROM runtime_filters($$SELECT count(*) FROM metrics m JOIN devices d ON m.device = d.id WHERE d.name = 'device 0'$$);
+RESET enable_mergejoin;
+RESET enable_nestloop;
+
+DROP TABLE metrics, devices, devices8, times, times8;
+DROP FUNCTION runtime_filters(text);
@@ -47,3 +47,41 @@ RESET timescaledb.enable_skipscan;
 -- compare SkipScan results on hypertable
 :DIFF_CMD
 
+-- SkipScan for DISTINCT on multiple NOT NULL columns, like the latest
+-- state of every device of every tenant
+CREATE TABLE skip_scan_multi(tenant int NOT NULL, dev int NOT NULL, time int NOT NULL, val int);
+CREATE INDEX ON skip_scan_multi(tenant, dev, time DESC);
+INSERT INTO skip_scan_multi SELECT t, d, tm, t * 100000 + d * 10000 + tm FROM generate_series(1, 2) t, generate_series(1, 3) d, generate_series(1, 1000) tm;
+ANALYZE skip_scan_multi;
+UPDATE pg_statistic SET stadistinct=1 WHERE starelid='skip_scan_multi'::regclass;
+CREATE FUNCTION uses_skip_scan(query text) RETURNS bool LANGUAGE plpgsql AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (FORMAT JSON) ' || query INTO plan;
+  RETURN plan::text LIKE '%"Custom Plan Provider": "SkipScan"%';
+END
+$$;
+SELECT uses_skip_scan('SELECT DISTINCT ON (tenant, dev) * FROM skip_scan_multi ORDER BY tenant, dev, time DESC') AS skip_scan;
+SELECT DISTINCT ON (tenant, dev) * FROM skip_scan_multi ORDER BY tenant, dev, time DESC;
+SELECT uses_skip_scan('SELECT DISTINCT tenant, dev FROM skip_scan_multi ORDER BY tenant, dev') AS skip_scan;
+SELECT DISTINCT tenant, dev FROM skip_scan_multi ORDER BY tenant, dev;
+-- the scan would not step past NULLs in a nullable column
+ALTER TABLE skip_scan_multi ALTER COLUMN dev DROP NOT NULL;
+SELECT uses_skip_scan('SELECT DISTINCT ON (tenant, dev) * FROM skip_scan_multi ORDER BY tenant, dev, time DESC') AS skip_scan;
+DROP TABLE skip_scan_multi;
+
+-- SkipScan for last() per group, with an index that returns the row
+-- last() picks first for every group
+CREATE TABLE skip_scan_bookend(dev int, time int NOT NULL, val int);
+CREATE INDEX ON skip_scan_bookend(dev, time DESC);
+INSERT INTO skip_scan_bookend SELECT d, t, d * 10000 + t FROM generate_series(1, 4) d, generate_series(1, 1000) t;
+ANALYZE skip_scan_bookend;
+UPDATE pg_statistic SET stadistinct=1 WHERE starelid='skip_scan_bookend'::regclass;
+SELECT uses_skip_scan('SELECT dev, last(val, time) FROM skip_scan_bookend GROUP BY dev ORDER BY dev') AS skip_scan;
+SELECT dev, last(val, time) FROM skip_scan_bookend GROUP BY dev ORDER BY dev;
+-- first() would need a backward scan of the index
+SELECT uses_skip_scan('SELECT dev, first(val, time) FROM skip_scan_bookend GROUP BY dev ORDER BY dev') AS skip_scan;
+SELECT dev, first(val, time) FROM skip_scan_bookend GROUP BY dev ORDER BY dev;
+DROP TABLE skip_scan_bookend;
+DROP FUNCTION uses_skip_scan(text);
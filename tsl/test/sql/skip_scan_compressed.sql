@@ -0,0 +1,50 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- The custom scan nodes of the plan and the batches they decompress
+CREATE FUNCTION decompress_plan(stmt text) RETURNS SETOF text LANGUAGE plpgsql AS $$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF) ' || stmt LOOP
+        IF line ~ 'DecompressChunk|SkipScan|Batches Read' THEN
+            RETURN NEXT regexp_replace(trim(line), '^->  | on .*$', '', 'g');
+        END IF;
+    END LOOP;
+END
+$$;
+
+-- Two chunks with five segments of two batches each
+CREATE TABLE metrics(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 10000);
+ALTER TABLE metrics SET (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'time');
+INSERT INTO metrics SELECT t, t % 5, t FROM generate_series(0, 19999) t;
+SELECT count(compress_chunk(c)) FROM show_chunks('metrics') c;
+ANALYZE metrics;
+
+-- DISTINCT ON the segmentby column only decompresses the first batch of every
+-- segment
+SELECT decompress_plan('SELECT DISTINCT ON (device) device, time FROM metrics ORDER BY device, time');
+SELECT DISTINCT ON (device) device, time FROM metrics ORDER BY device, time;
+
+-- The quals on the segmentby columns filter out entire batches
+SELECT decompress_plan('SELECT DISTINCT ON (device) device, time FROM metrics WHERE device > 2 ORDER BY device, time');
+SELECT DISTINCT ON (device) device, time FROM metrics WHERE device > 2 ORDER BY device, time;
+
+-- The quals on the other columns might filter out the first rows of the
+-- segment, so the SkipScan is not used
+SELECT decompress_plan('SELECT DISTINCT ON (device) device, time FROM metrics WHERE value > 10 ORDER BY device, time');
+SELECT DISTINCT ON (device) device, time FROM metrics WHERE value > 10 ORDER BY device, time;
+
+-- The same results without the SkipScan
+SET timescaledb.enable_skipscan TO off;
+SELECT decompress_plan('SELECT DISTINCT ON (device) device, time FROM metrics ORDER BY device, time');
+SELECT DISTINCT ON (device) device, time FROM metrics ORDER BY device, time;
+RESET timescaledb.enable_skipscan;
+
+DROP TABLE metrics;
+DROP FUNCTION decompress_plan(text);
@@ -0,0 +1,131 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+create table aggmetrics(ts timestamptz not null, device int4, metric_i4 int4, metric_i2 int2,
+    metric_f8 float8, metric_f4 float4);
+
+select create_hypertable('aggmetrics', 'ts');
+
+alter table aggmetrics set (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+
+insert into aggmetrics select '2021-01-01 00:00:00+00'::timestamptz + interval '1 minute' * x,
+    x % 3,
+    case when x % 10 = 0 then null else x end,
+    x % 100,
+    x * 0.5,
+    x * 0.5
+from generate_series(1, 3000) x;
+
+select count(compress_chunk(x, true)) from show_chunks('aggmetrics') x;
+
+-- The partial aggregation on top of DecompressChunk appears in the parallel
+-- plans.
+set parallel_setup_cost = 0;
+set parallel_tuple_cost = 0;
+set min_parallel_table_scan_size = 0;
+set max_parallel_workers_per_gather = 1;
+set enable_parallel_append = false;
+
+explain (costs off) select sum(metric_i4) from aggmetrics;
+
+select count(*), count(metric_i4), sum(metric_i4), sum(metric_i2), min(metric_i4),
+    max(metric_i4), sum(metric_f8), sum(metric_f4)::int8, round(avg(metric_i4), 2),
+    avg(metric_f8), max(metric_f4)
+from aggmetrics;
+
+-- vectorized quals
+select count(*), sum(metric_i4) from aggmetrics where metric_i4 > 2000;
+select count(*), sum(metric_i4), min(metric_i2) from aggmetrics where metric_i4 > 10000;
+
+-- the batches in which no rows pass the vectorized quals are skipped
+select count(*), sum(metric_i4), min(metric_f8) from aggmetrics
+where metric_i4 > 2996 and metric_i4 < 2999;
+select device, count(*), sum(metric_i4), max(metric_f4) from aggmetrics
+where metric_i4 > 2996 and metric_i4 < 2999 group by device order by device;
+
+-- the batch counters of the same queries, without the parallel workers that
+-- keep their own counters; the counters are only shown with the summary
+set max_parallel_workers_per_gather = 0;
+create function batch_counters(stmt text) returns setof text language plpgsql as $$
+declare
+    line text;
+begin
+    for line in execute 'explain (analyze, costs off, timing off) ' || stmt loop
+        if line ~ '^\s*Batches' then
+            return next trim(line);
+        end if;
+    end loop;
+end
+$$;
+select batch_counters('select count(*), sum(metric_i4), min(metric_f8) from aggmetrics
+where metric_i4 > 2996 and metric_i4 < 2999');
+select batch_counters('select device, count(*), sum(metric_i4), max(metric_f4) from aggmetrics
+where metric_i4 > 2996 and metric_i4 < 2999 group by device');
+drop function batch_counters(text);
+set max_parallel_workers_per_gather = 1;
+
+-- the quals that are not vectorized
+select count(*), sum(metric_i4) from aggmetrics where metric_i4 % 2 = 0;
+
+-- the segmentby columns
+select count(*), count(metric_i4), sum(metric_i4) from aggmetrics where device = 1;
+select sum(device), min(device), max(device) from aggmetrics;
+select device, count(*), sum(metric_i4), min(metric_i4), max(metric_f8)
+from aggmetrics group by device order by device;
+
+-- min/max and count(*) are computed from the batch metadata
+select min(ts) = '2021-01-01 00:01:00+00', max(ts) = '2021-01-03 02:00:00+00', count(*)
+from aggmetrics;
+select count(*), min(ts) = '2021-01-01 00:01:00+00' from aggmetrics where device = 1;
+select device, count(*), extract(minute from min(ts)), extract(minute from max(ts)),
+    min(device), max(device)
+from aggmetrics group by device order by device;
+
+-- min/max over a timestamptz column that are computed from the decompressed
+-- values, because of the vectorized qual
+select min(ts) = '2021-01-02 09:21:00+00', max(ts) = '2021-01-03 01:59:00+00', count(*)
+from aggmetrics where metric_i4 > 2000;
+
+-- grouping by time_bucket() over the orderby column
+select extract(epoch from b - '2021-01-01 00:00:00+00')::int / 86400 as day, c, cm, s
+from (select time_bucket('1 day', ts) b, count(*) c, count(metric_i4) cm, sum(metric_i4) s
+    from aggmetrics group by b) t order by day;
+select extract(epoch from b - '2021-01-01 00:00:00+00')::int / 86400 as day, c, s
+from (select time_bucket('1 day', ts) b, count(*) c, sum(metric_i4) s
+    from aggmetrics where metric_i4 > 2000 group by b) t order by day;
+select extract(epoch from b - '2021-01-01 00:00:00+00')::int / 86400 as day, c, s
+from (select time_bucket('1 day', ts) b, count(*) c, sum(metric_i4) s
+    from aggmetrics where metric_i4 % 2 = 0 group by b) t order by day;
+
+-- the same results without vectorized aggregation
+set timescaledb.enable_vectorized_aggregation to off;
+
+select count(*), count(metric_i4), sum(metric_i4), sum(metric_i2), min(metric_i4),
+    max(metric_i4), sum(metric_f8), sum(metric_f4)::int8, round(avg(metric_i4), 2),
+    avg(metric_f8), max(metric_f4)
+from aggmetrics;
+
+select count(*), sum(metric_i4) from aggmetrics where metric_i4 % 2 = 0;
+
+select min(ts) = '2021-01-02 09:21:00+00', max(ts) = '2021-01-03 01:59:00+00', count(*)
+from aggmetrics where metric_i4 > 2000;
+
+reset timescaledb.enable_vectorized_aggregation;
+
+-- histogram() over a NOT NULL float8 column, with bucket bounds that the
+-- values don't fall on
+create table aggmetrics_hist(ts timestamptz not null, device int4, metric_f8 float8 not null);
+select table_name from create_hypertable('aggmetrics_hist', 'ts');
+alter table aggmetrics_hist set (timescaledb.compress, timescaledb.compress_segmentby = 'device');
+insert into aggmetrics_hist select '2021-01-01 00:00:00+00'::timestamptz + interval '1 minute' * x,
+    x % 3, x * 0.5
+from generate_series(1, 3000) x;
+select count(compress_chunk(x, true)) from show_chunks('aggmetrics_hist') x;
+explain (costs off) select histogram(metric_f8, 0.25, 1500.25, 10) from aggmetrics_hist;
+select histogram(metric_f8, 0.25, 1500.25, 10) from aggmetrics_hist;
+select histogram(metric_f8, 0.25, 1500.25, 10) from aggmetrics_hist where metric_f8 > 1000;
+set timescaledb.enable_vectorized_aggregation to off;
+select histogram(metric_f8, 0.25, 1500.25, 10) from aggmetrics_hist;
+select histogram(metric_f8, 0.25, 1500.25, 10) from aggmetrics_hist where metric_f8 > 1000;
+reset timescaledb.enable_vectorized_aggregation;
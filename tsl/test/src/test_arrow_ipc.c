@@ -0,0 +1,568 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * A minimal reader of the Arrow IPC streams produced by
+ * export_chunk_arrow_ipc(), so that the tests can check that the exported
+ * data reads back as the rows of the chunk. It only understands the types and
+ * the layout that the export writes, and validates every offset it follows.
+ */
+
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <catalog/pg_type.h>
+#include <datatype/timestamp.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <utils/array.h>
+#include <utils/builtins.h>
+#include <utils/date.h>
+#include <utils/lsyscache.h>
+
+#include "export.h"
+
+TS_FUNCTION_INFO_V1(ts_test_arrow_ipc_schema);
+TS_FUNCTION_INFO_V1(ts_test_arrow_ipc_rows);
+
+#define ARROW_HEADER_SCHEMA 1
+#define ARROW_HEADER_RECORD_BATCH 3
+
+#define ARROW_TYPE_INT 2
+#define ARROW_TYPE_FLOATING_POINT 3
+#define ARROW_TYPE_BINARY 4
+#define ARROW_TYPE_UTF8 5
+#define ARROW_TYPE_BOOL 6
+#define ARROW_TYPE_DATE 8
+#define ARROW_TYPE_TIME 9
+#define ARROW_TYPE_TIMESTAMP 10
+
+#define ARROW_IPC_CONTINUATION 0xFFFFFFFF
+
+#define ARROW_EPOCH_DAYS (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE)
+#define ARROW_EPOCH_USECS ((int64) ARROW_EPOCH_DAYS * USECS_PER_DAY)
+
+typedef struct IpcReader
+{
+	const char *data;
+	int len;
+} IpcReader;
+
+typedef struct IpcColumn
+{
+	char *name;
+	char *type_name;
+	bool nullable;
+	uint8 type_type;
+	Oid typid;
+	int value_bytes;
+} IpcColumn;
+
+typedef struct IpcStream
+{
+	IpcColumn *columns;
+	int num_columns;
+	/* The rows of all the record batches, as (batch, values) tuples */
+	List *rows;
+} IpcStream;
+
+static void
+ipc_check(const IpcReader *reader, int64 pos, int64 bytes)
+{
+	if (pos < 0 || bytes < 0 || pos + bytes > reader->len)
+		elog(ERROR, "Arrow IPC offset %ld out of bounds", (long) pos);
+}
+
+static uint64
+ipc_read(const IpcReader *reader, int64 pos, int bytes)
+{
+	uint64 value = 0;
+
+	ipc_check(reader, pos, bytes);
+	memcpy(&value, reader->data + pos, bytes);
+	return value;
+}
+
+/* Follow the offset at the given position */
+static int64
+ipc_deref(const IpcReader *reader, int64 pos)
+{
+	return pos + (uint32) ipc_read(reader, pos, sizeof(uint32));
+}
+
+/* Get the position of a field of a flatbuffers table, or -1 if it's absent */
+static int64
+ipc_field(const IpcReader *reader, int64 table, int field)
+{
+	const int64 vtable = table - (int32) ipc_read(reader, table, sizeof(int32));
+	const int vtable_bytes = ipc_read(reader, vtable, sizeof(uint16));
+	int offset;
+
+	if ((int) sizeof(uint16) * (2 + field) >= vtable_bytes)
+		return -1;
+
+	offset = ipc_read(reader, vtable + sizeof(uint16) * (2 + field), sizeof(uint16));
+	return offset == 0 ? -1 : table + offset;
+}
+
+static uint64
+ipc_scalar(const IpcReader *reader, int64 table, int field, int bytes, uint64 missing)
+{
+	const int64 pos = ipc_field(reader, table, field);
+
+	return pos < 0 ? missing : ipc_read(reader, pos, bytes);
+}
+
+static int64
+ipc_child(const IpcReader *reader, int64 table, int field)
+{
+	const int64 pos = ipc_field(reader, table, field);
+
+	if (pos < 0)
+		elog(ERROR, "missing field %d in Arrow IPC table", field);
+
+	return ipc_deref(reader, pos);
+}
+
+static char *
+ipc_string(const IpcReader *reader, int64 pos)
+{
+	const uint32 len = ipc_read(reader, pos, sizeof(uint32));
+
+	ipc_check(reader, pos + sizeof(uint32), len + 1);
+	if (reader->data[pos + sizeof(uint32) + len] != '\0')
+		elog(ERROR, "unterminated string in Arrow IPC message");
+
+	return pnstrdup(reader->data + pos + sizeof(uint32), len);
+}
+
+static void
+ipc_read_field(const IpcReader *reader, int64 field, IpcColumn *column)
+{
+	const int64 type = ipc_child(reader, field, 3);
+
+	column->name = ipc_string(reader, ipc_child(reader, field, 0));
+	column->nullable = ipc_scalar(reader, field, 1, sizeof(bool), false);
+	column->type_type = ipc_scalar(reader, field, 2, sizeof(uint8), 0);
+
+	switch (column->type_type)
+	{
+		case ARROW_TYPE_BOOL:
+			column->type_name = "bool";
+			column->typid = BOOLOID;
+			break;
+		case ARROW_TYPE_INT:
+		{
+			const int bit_width = ipc_scalar(reader, type, 0, sizeof(int32), 0);
+
+			if (!ipc_scalar(reader, type, 1, sizeof(bool), false))
+				elog(ERROR, "unexpected unsigned integer in Arrow IPC schema");
+
+			column->type_name = psprintf("int%d", bit_width);
+			column->value_bytes = bit_width / 8;
+			column->typid = bit_width == 16 ? INT2OID : bit_width == 32 ? INT4OID : INT8OID;
+			if (bit_width != 16 && bit_width != 32 && bit_width != 64)
+				elog(ERROR, "unexpected integer width %d in Arrow IPC schema", bit_width);
+			break;
+		}
+		case ARROW_TYPE_FLOATING_POINT:
+		{
+			const int precision = ipc_scalar(reader, type, 0, sizeof(int16), 0);
+
+			column->type_name = precision == 1 ? "float32" : "float64";
+			column->value_bytes = precision == 1 ? 4 : 8;
+			column->typid = precision == 1 ? FLOAT4OID : FLOAT8OID;
+			break;
+		}
+		case ARROW_TYPE_DATE:
+			column->type_name = "date32[day]";
+			column->value_bytes = 4;
+			column->typid = DATEOID;
+			break;
+		case ARROW_TYPE_TIME:
+			column->type_name = "time64[us]";
+			column->value_bytes = 8;
+			column->typid = TIMEOID;
+			break;
+		case ARROW_TYPE_TIMESTAMP:
+		{
+			const int64 timezone = ipc_field(reader, type, 1);
+
+			column->value_bytes = 8;
+			if (timezone < 0)
+			{
+				column->type_name = "timestamp[us]";
+				column->typid = TIMESTAMPOID;
+			}
+			else
+			{
+				column->type_name = psprintf("timestamp[us, tz=%s]",
+											 ipc_string(reader, ipc_deref(reader, timezone)));
+				column->typid = TIMESTAMPTZOID;
+			}
+			break;
+		}
+		case ARROW_TYPE_UTF8:
+			column->type_name = "utf8";
+			column->value_bytes = -1;
+			column->typid = TEXTOID;
+			break;
+		case ARROW_TYPE_BINARY:
+			column->type_name = "binary";
+			column->value_bytes = -1;
+			column->typid = BYTEAOID;
+			break;
+		default:
+			elog(ERROR, "unexpected type %d in Arrow IPC schema", column->type_type);
+	}
+}
+
+static void
+ipc_read_schema(const IpcReader *reader, int64 schema, IpcStream *stream)
+{
+	const int64 fields = ipc_child(reader, schema, 1);
+
+	stream->num_columns = ipc_read(reader, fields, sizeof(uint32));
+	stream->columns = palloc0(sizeof(IpcColumn) * stream->num_columns);
+	for (int i = 0; i < stream->num_columns; i++)
+		ipc_read_field(reader,
+					   ipc_deref(reader, fields + sizeof(uint32) * (1 + i)),
+					   &stream->columns[i]);
+}
+
+/*
+ * Convert a value of the record batch back to the PostgreSQL type, and return
+ * it as the cast of the value to text would.
+ */
+static char *
+ipc_value_text(const IpcColumn *column, const char *values, const int32 *offsets, int row)
+{
+	Datum value;
+	Oid typoutput;
+	bool typisvarlena;
+
+	switch (column->type_type)
+	{
+		case ARROW_TYPE_BOOL:
+			/* The cast of bool to text doesn't use the output function */
+			return pstrdup((values[row / 8] >> (row % 8)) & 1 ? "true" : "false");
+		case ARROW_TYPE_DATE:
+		{
+			int32 days;
+
+			memcpy(&days, values + sizeof(int32) * row, sizeof(int32));
+			value = DateADTGetDatum(DATE_NOT_FINITE(days) ? days : days - ARROW_EPOCH_DAYS);
+			break;
+		}
+		case ARROW_TYPE_TIMESTAMP:
+		{
+			int64 usecs;
+
+			memcpy(&usecs, values + sizeof(int64) * row, sizeof(int64));
+			value = Int64GetDatum(TIMESTAMP_NOT_FINITE(usecs) ? usecs : usecs - ARROW_EPOCH_USECS);
+			break;
+		}
+		case ARROW_TYPE_UTF8:
+			value = PointerGetDatum(cstring_to_text_with_len(values + offsets[row],
+															 offsets[row + 1] - offsets[row]));
+			break;
+		case ARROW_TYPE_BINARY:
+		{
+			const int len = offsets[row + 1] - offsets[row];
+			bytea *bytes = palloc(VARHDRSZ + len);
+
+			SET_VARSIZE(bytes, VARHDRSZ + len);
+			memcpy(VARDATA(bytes), values + offsets[row], len);
+			value = PointerGetDatum(bytes);
+			break;
+		}
+		case ARROW_TYPE_FLOATING_POINT:
+			if (column->value_bytes == 4)
+			{
+				float4 f;
+
+				memcpy(&f, values + sizeof(float4) * row, sizeof(float4));
+				value = Float4GetDatum(f);
+			}
+			else
+			{
+				float8 f;
+
+				memcpy(&f, values + sizeof(float8) * row, sizeof(float8));
+				value = Float8GetDatum(f);
+			}
+			break;
+		default:
+		{
+			/* The integers and the time, which is an int64 of microseconds */
+			int64 fixed = 0;
+
+			memcpy(&fixed, values + column->value_bytes * row, column->value_bytes);
+			value = column->value_bytes == 2 ? Int16GetDatum((int16) fixed) :
+					column->value_bytes == 4 ? Int32GetDatum((int32) fixed) :
+											   Int64GetDatum(fixed);
+			break;
+		}
+	}
+
+	getTypeOutputInfo(column->typid, &typoutput, &typisvarlena);
+	return OidOutputFunctionCall(typoutput, value);
+}
+
+static void
+ipc_read_record_batch(const IpcReader *reader, int64 record_batch, const IpcReader *body,
+					  int batch_number, IpcStream *stream, TupleDesc tupdesc)
+{
+	const int64 length = ipc_scalar(reader, record_batch, 0, sizeof(int64), 0);
+	const int64 nodes = ipc_child(reader, record_batch, 1);
+	const int64 buffers = ipc_child(reader, record_batch, 2);
+	const int num_nodes = ipc_read(reader, nodes, sizeof(uint32));
+	const int num_buffers = ipc_read(reader, buffers, sizeof(uint32));
+	Datum **texts = palloc(sizeof(Datum *) * length);
+	bool **nulls = palloc(sizeof(bool *) * length);
+	int buffer = 0;
+
+	if (num_nodes != stream->num_columns)
+		elog(ERROR, "record batch has %d columns instead of %d", num_nodes, stream->num_columns);
+
+	for (int64 row = 0; row < length; row++)
+	{
+		texts[row] = palloc0(sizeof(Datum) * stream->num_columns);
+		nulls[row] = palloc0(sizeof(bool) * stream->num_columns);
+	}
+
+	for (int i = 0; i < stream->num_columns; i++)
+	{
+		const IpcColumn *column = &stream->columns[i];
+		const int64 node = nodes + sizeof(uint32) + 2 * sizeof(int64) * i;
+		const int num_column_buffers = column->value_bytes == -1 ? 3 : 2;
+		const char *column_buffers[3];
+		int64 null_count = 0;
+
+		if ((int64) ipc_read(reader, node, sizeof(int64)) != length)
+			elog(ERROR, "column \"%s\" has a different length than the batch", column->name);
+
+		if (buffer + num_column_buffers > num_buffers)
+			elog(ERROR, "missing buffers for column \"%s\"", column->name);
+
+		for (int j = 0; j < num_column_buffers; j++)
+		{
+			const int64 entry = buffers + sizeof(uint32) + 2 * sizeof(int64) * (buffer + j);
+			const int64 offset = ipc_read(reader, entry, sizeof(int64));
+			const int64 bytes = ipc_read(reader, entry + sizeof(int64), sizeof(int64));
+
+			if (offset % 8 != 0)
+				elog(ERROR, "unaligned buffer for column \"%s\"", column->name);
+
+			/* An empty validity bitmap means that there are no nulls */
+			ipc_check(body, offset, bytes);
+			column_buffers[j] = j == 0 && bytes == 0 ? NULL : body->data + offset;
+		}
+		buffer += num_column_buffers;
+
+		for (int64 row = 0; row < length; row++)
+		{
+			const char *validity = column_buffers[0];
+			const char *values = column_buffers[num_column_buffers - 1];
+			const int32 *offsets = (const int32 *) column_buffers[1];
+
+			if (validity != NULL && !((validity[row / 8] >> (row % 8)) & 1))
+			{
+				nulls[row][i] = true;
+				null_count++;
+				continue;
+			}
+
+			texts[row][i] = CStringGetTextDatum(ipc_value_text(column, values, offsets, row));
+		}
+
+		if (null_count != (int64) ipc_read(reader, node + sizeof(int64), sizeof(int64)))
+			elog(ERROR, "wrong null count for column \"%s\"", column->name);
+	}
+
+	if (buffer != num_buffers)
+		elog(ERROR, "record batch has %d buffers instead of %d", num_buffers, buffer);
+
+	for (int64 row = 0; row < length; row++)
+	{
+		int dims[1] = { stream->num_columns };
+		int lbs[1] = { 1 };
+		Datum values[2] = { Int32GetDatum(batch_number) };
+		bool tuple_nulls[2] = { false };
+
+		values[1] = PointerGetDatum(construct_md_array(texts[row],
+													   nulls[row],
+													   1,
+													   dims,
+													   lbs,
+													   TEXTOID,
+													   -1,
+													   false,
+													   TYPALIGN_INT));
+		stream->rows = lappend(stream->rows, heap_form_tuple(tupdesc, values, tuple_nulls));
+	}
+}
+
+/*
+ * Read the whole stream. The messages must start with the schema, and the
+ * stream must end exactly after the end-of-stream marker.
+ */
+static IpcStream *
+ipc_read_stream(bytea *data, TupleDesc rows_tupdesc)
+{
+	IpcStream *stream = palloc0(sizeof(IpcStream));
+	IpcReader reader = { .data = VARDATA_ANY(data), .len = VARSIZE_ANY_EXHDR(data) };
+	int64 pos = 0;
+	int batch_number = 0;
+
+	for (;;)
+	{
+		int32 metadata_bytes;
+		int64 message;
+		uint8 header_type;
+		int64 header;
+		int64 body_bytes;
+		IpcReader metadata;
+		IpcReader body;
+
+		if ((uint32) ipc_read(&reader, pos, sizeof(uint32)) != ARROW_IPC_CONTINUATION)
+			elog(ERROR, "missing continuation marker at offset %ld", (long) pos);
+
+		metadata_bytes = ipc_read(&reader, pos + sizeof(uint32), sizeof(int32));
+		pos += sizeof(uint32) + sizeof(int32);
+		if (metadata_bytes == 0)
+			break;
+
+		if (metadata_bytes % 8 != 0)
+			elog(ERROR, "unaligned message metadata of %d bytes", metadata_bytes);
+
+		ipc_check(&reader, pos, metadata_bytes);
+		metadata = (IpcReader){ .data = reader.data + pos, .len = metadata_bytes };
+		message = ipc_deref(&metadata, 0);
+		header_type = ipc_scalar(&metadata, message, 1, sizeof(uint8), 0);
+		header = ipc_child(&metadata, message, 2);
+		body_bytes = ipc_scalar(&metadata, message, 3, sizeof(int64), 0);
+		pos += metadata_bytes;
+
+		ipc_check(&reader, pos, body_bytes);
+		body = (IpcReader){ .data = reader.data + pos, .len = body_bytes };
+		pos += body_bytes;
+
+		if (header_type == ARROW_HEADER_SCHEMA)
+		{
+			if (stream->columns != NULL)
+				elog(ERROR, "more than one schema in Arrow IPC stream");
+			ipc_read_schema(&metadata, header, stream);
+		}
+		else if (header_type == ARROW_HEADER_RECORD_BATCH)
+		{
+			if (stream->columns == NULL)
+				elog(ERROR, "record batch before the schema in Arrow IPC stream");
+			if (rows_tupdesc != NULL)
+				ipc_read_record_batch(&metadata,
+									  header,
+									  &body,
+									  ++batch_number,
+									  stream,
+									  rows_tupdesc);
+		}
+		else
+			elog(ERROR, "unexpected message type %d in Arrow IPC stream", header_type);
+	}
+
+	if (pos != reader.len)
+		elog(ERROR, "data after the end of the Arrow IPC stream");
+
+	if (stream->columns == NULL)
+		elog(ERROR, "missing schema in Arrow IPC stream");
+
+	return stream;
+}
+
+static TupleDesc
+ipc_result_tupdesc(FunctionCallInfo fcinfo)
+{
+	TupleDesc tupdesc;
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("function returning record called in context "
+						"that cannot accept type record")));
+
+	return BlessTupleDesc(tupdesc);
+}
+
+/*
+ * Return the fields of the schema of an Arrow IPC stream, with the Arrow type
+ * names.
+ */
+Datum
+ts_test_arrow_ipc_schema(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	IpcStream *stream;
+	int i;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		funcctx->tuple_desc = ipc_result_tupdesc(fcinfo);
+		funcctx->user_fctx = ipc_read_stream(PG_GETARG_BYTEA_PP(0), NULL);
+		funcctx->max_calls = ((IpcStream *) funcctx->user_fctx)->num_columns;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	stream = funcctx->user_fctx;
+	i = funcctx->call_cntr;
+
+	if (i < (int) funcctx->max_calls)
+	{
+		Datum values[3] = { CStringGetTextDatum(stream->columns[i].name),
+							CStringGetTextDatum(stream->columns[i].type_name),
+							BoolGetDatum(stream->columns[i].nullable) };
+		bool nulls[3] = { false };
+
+		SRF_RETURN_NEXT(funcctx,
+						HeapTupleGetDatum(heap_form_tuple(funcctx->tuple_desc, values, nulls)));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+/*
+ * Return the rows of all the record batches of an Arrow IPC stream, as the
+ * number of the batch and the text representation of the values.
+ */
+Datum
+ts_test_arrow_ipc_rows(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	IpcStream *stream;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		funcctx->tuple_desc = ipc_result_tupdesc(fcinfo);
+		funcctx->user_fctx = ipc_read_stream(PG_GETARG_BYTEA_PP(0), funcctx->tuple_desc);
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	stream = funcctx->user_fctx;
+
+	if (funcctx->call_cntr < (uint64) list_length(stream->rows))
+		SRF_RETURN_NEXT(funcctx,
+						HeapTupleGetDatum(list_nth(stream->rows, funcctx->call_cntr)));
+
+	SRF_RETURN_DONE(funcctx);
+}
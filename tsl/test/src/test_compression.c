@@ -26,6 +26,7 @@
 
 #include "compression/array.h"
 #include "compression/arrow_c_data_interface.h"
+#include "compression/bitpacking.h"
 #include "compression/dictionary.h"
 #include "compression/gorilla.h"
 #include "compression/deltadelta.h"
@@ -392,8 +393,9 @@ test_gorilla_double(bool have_nulls, bool have_random)
 	/* Forward decompression. */
 	DecompressionIterator *iter =
 		gorilla_decompression_iterator_from_datum_forward(PointerGetDatum(compressed), FLOAT8OID);
+	DecompressionArena arena = { .mctx = CurrentMemoryContext };
 	ArrowArray *bulk_result =
-		gorilla_decompress_all(PointerGetDatum(compressed), FLOAT8OID, CurrentMemoryContext);
+		gorilla_decompress_all(PointerGetDatum(compressed), FLOAT8OID, &arena);
 	for (int i = 0; i < TEST_ELEMENTS; i++)
 	{
 		DecompressResult r = gorilla_decompression_iterator_try_next_forward(iter);
@@ -552,9 +554,9 @@ test_delta3(bool have_nulls, bool have_random)
 	DecompressionIterator *iter =
 		delta_delta_decompression_iterator_from_datum_forward(PointerGetDatum((void *) compressed),
 															  INT8OID);
-	ArrowArray *bulk_result = delta_delta_decompress_all(PointerGetDatum((void *) compressed),
-														 INT8OID,
-														 CurrentMemoryContext);
+	DecompressionArena arena = { .mctx = CurrentMemoryContext };
+	ArrowArray *bulk_result =
+		delta_delta_decompress_all(PointerGetDatum((void *) compressed), INT8OID, &arena);
 	for (int i = 0; i < TEST_ELEMENTS; i++)
 	{
 		DecompressResult r = delta_delta_decompression_iterator_try_next_forward(iter);
@@ -615,7 +617,8 @@ test_delta4(const int32 *values, int n)
 	}
 	Datum compressed = (Datum) compressor->finish(compressor);
 
-	ArrowArray *arrow = delta_delta_decompress_all(compressed, INT4OID, CurrentMemoryContext);
+	DecompressionArena arena = { .mctx = CurrentMemoryContext };
+	ArrowArray *arrow = delta_delta_decompress_all(compressed, INT4OID, &arena);
 	DecompressionIterator *iter =
 		delta_delta_decompression_iterator_from_datum_forward(compressed, INT4OID);
 	int i = 0;
@@ -633,6 +636,111 @@ test_delta4(const int32 *values, int n)
 	TestAssertTrue(i == n);
 }
 
+static void
+test_bitpacking(bool have_nulls, int64 range)
+{
+	BitpackingCompressor *compressor = bitpacking_compressor_alloc();
+	Datum compressed;
+
+	int64 values[TEST_ELEMENTS];
+	bool nulls[TEST_ELEMENTS];
+	for (int i = 0; i < TEST_ELEMENTS; i++)
+	{
+		/* Values in the given range around a negative base, not monotonic. */
+		values[i] = -1000 + (range == 0 ? 0 : (int64) (test_hash64(i) % (uint64) range));
+		nulls[i] = have_nulls && i % 29 == 0;
+
+		if (nulls[i])
+		{
+			bitpacking_compressor_append_null(compressor);
+		}
+		else
+		{
+			bitpacking_compressor_append_value(compressor, values[i]);
+		}
+	}
+
+	compressed = PointerGetDatum(bitpacking_compressor_finish(compressor));
+	TestAssertTrue(DatumGetPointer(compressed) != NULL);
+
+	if (!have_nulls && range == 16)
+	{
+		/* 24 bytes of header and 4 bits per value. */
+		TestAssertInt64Eq(VARSIZE(DatumGetPointer(compressed)),
+						  24 + (TEST_ELEMENTS * 4 + 63) / 64 * 8);
+	}
+
+	/* Forward decompression. */
+	DecompressionIterator *iter =
+		bitpacking_decompression_iterator_from_datum_forward(compressed, INT8OID);
+
+	/*
+	 * Decompress into a preallocated arena, the way the DecompressChunk node
+	 * does it. The arena is too small for the narrower result below, so that
+	 * one has to fall back to the memory context.
+	 */
+	const Size arena_capacity = 16 * 1024;
+	DecompressionArena arena = { .mctx = CurrentMemoryContext,
+								 .buffer = palloc(arena_capacity),
+								 .capacity = arena_capacity };
+	ArrowArray *bulk_result = bitpacking_decompress_all(compressed, INT8OID, &arena);
+	TestAssertTrue((char *) bulk_result >= arena.buffer &&
+				   (char *) bulk_result < arena.buffer + arena.capacity);
+	TestAssertTrue(arena.used <= arena.capacity);
+	TestAssertInt64Eq(bulk_result->length, TEST_ELEMENTS);
+	for (int i = 0; i < TEST_ELEMENTS; i++)
+	{
+		DecompressResult r = bitpacking_decompression_iterator_try_next_forward(iter);
+		TestAssertTrue(!r.is_done);
+		if (r.is_null)
+		{
+			TestAssertTrue(nulls[i]);
+			TestAssertTrue(!arrow_row_is_valid(bulk_result->buffers[0], i));
+		}
+		else
+		{
+			TestAssertTrue(!nulls[i]);
+			TestAssertTrue(arrow_row_is_valid(bulk_result->buffers[0], i));
+			TestAssertTrue(values[i] == DatumGetInt64(r.val));
+			TestAssertTrue(values[i] == ((int64 *) bulk_result->buffers[1])[i]);
+		}
+	}
+	DecompressResult r = bitpacking_decompression_iterator_try_next_forward(iter);
+	TestAssertTrue(r.is_done);
+
+	/* Bulk decompression of a narrower type. */
+	arena.capacity = arena.used;
+	ArrowArray *bulk_int16 = bitpacking_decompress_all(compressed, INT2OID, &arena);
+	TestAssertTrue((char *) bulk_int16 < arena.buffer ||
+				   (char *) bulk_int16 >= arena.buffer + arena.capacity);
+	for (int i = 0; i < TEST_ELEMENTS; i++)
+	{
+		if (!nulls[i] && values[i] >= PG_INT16_MIN && values[i] <= PG_INT16_MAX)
+		{
+			TestAssertTrue(values[i] == ((int16 *) bulk_int16->buffers[1])[i]);
+		}
+	}
+
+	/* Reverse decompression. */
+	iter = bitpacking_decompression_iterator_from_datum_reverse(compressed, INT8OID);
+	for (int i = TEST_ELEMENTS - 1; i >= 0; i--)
+	{
+		DecompressResult r = bitpacking_decompression_iterator_try_next_reverse(iter);
+		TestAssertTrue(!r.is_done);
+		if (r.is_null)
+		{
+			TestAssertTrue(nulls[i]);
+		}
+		else
+		{
+			TestAssertTrue(!nulls[i]);
+			TestAssertTrue(values[i] == DatumGetInt64(r.val));
+		}
+	}
+	r = bitpacking_decompression_iterator_try_next_reverse(iter);
+	TestAssertTrue(r.is_done);
+}
+
 Datum
 ts_test_compression(PG_FUNCTION_ARGS)
 {
@@ -657,6 +765,12 @@ ts_test_compression(PG_FUNCTION_ARGS)
 	test_delta4(test_delta4_case1, sizeof(test_delta4_case1) / sizeof(*test_delta4_case1));
 	test_delta4(test_delta4_case2, sizeof(test_delta4_case2) / sizeof(*test_delta4_case2));
 
+	test_bitpacking(/* have_nulls = */ false, /* range = */ 0);
+	test_bitpacking(/* have_nulls = */ false, /* range = */ 16);
+	test_bitpacking(/* have_nulls = */ false, /* range = */ 1000000);
+	test_bitpacking(/* have_nulls = */ true, /* range = */ 16);
+	test_bitpacking(/* have_nulls = */ true, /* range = */ PG_INT64_MAX);
+
 	PG_RETURN_VOID();
 }
 